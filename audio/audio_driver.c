@@ -19,8 +19,10 @@
 #include <retro_assert.h>
 
 #include <lists/string_list.h>
+#include <queues/fifo_spsc.h>
 #include <audio/conversion/float_to_s16.h>
 #include <audio/conversion/s16_to_float.h>
+#include <audio/audio_mix.h>
 #include <audio/dsp_filter.h>
 #include <file/file_path.h>
 #include <lists/dir_list.h>
@@ -30,6 +32,10 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "audio_driver.h"
 #include "audio_thread_wrapper.h"
 #include "../gfx/video_driver.h"
@@ -41,10 +47,20 @@
 #include "../configuration.h"
 #include "../retroarch.h"
 #include "../verbosity.h"
+#include "../performance_counters.h"
 #include "../list_special.h"
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 
+/* Frames taken through the whole flush chain at a time, so a block
+ * and its resampled output stay in L1 from one stage to the next. */
+#define AUDIO_FLUSH_BLOCK_FRAMES        256
+
+/* A blocking write gives up after this long without the
+ * driver pulling anything, so a stalled device can't hang
+ * the main thread. */
+#define AUDIO_PULL_STALL_USEC           (250 * 1000)
+
 /**
  * db_to_gain:
  * @db          : Decibels.
@@ -101,6 +117,9 @@ static const audio_driver_t *audio_drivers[] = {
 #ifdef HAVE_PULSE
    &audio_pulse,
 #endif
+#ifdef HAVE_PIPEWIRE
+   &audio_pipewire,
+#endif
 #ifdef __CELLOS_LV2__
    &audio_ps3,
 #endif
@@ -113,6 +132,9 @@ static const audio_driver_t *audio_drivers[] = {
 #ifdef WIIU
    &audio_ax,
 #endif
+#ifdef HAVE_AUDIOWORKLET
+   &audio_audioworklet,
+#endif
 #ifdef EMSCRIPTEN
    &audio_rwebaudio,
 #endif
@@ -142,9 +164,13 @@ static size_t audio_driver_rewind_size                   = 0;
 
 static int16_t *audio_driver_rewind_buf                  = NULL;
 static int16_t *audio_driver_output_samples_conv_buf     = NULL;
+/* audio_driver_sample() batches here, as the flush writes its
+ * s16 output while it is still reading the input. */
+static int16_t *audio_driver_sample_buf                  = NULL;
 
 static unsigned audio_driver_free_samples_buf[AUDIO_BUFFER_FREE_SAMPLES_COUNT];
 static uint64_t audio_driver_free_samples_count          = 0;
+static uint64_t audio_driver_underruns                   = 0;
 
 static size_t audio_driver_buffer_size                   = 0;
 static size_t audio_driver_data_ptr                      = 0;
@@ -180,6 +206,16 @@ static void *audio_driver_context_audio_data             = NULL;
 
 static bool audio_suspended                              = false;
 
+#ifdef HAVE_THREADS
+/* Pull mode: filled by audio_driver_flush(), drained by the
+ * driver's callback through audio_driver_pull(). */
+static fifo_spsc_t *audio_driver_pull_fifo               = NULL;
+static slock_t *audio_driver_pull_lock                   = NULL;
+static scond_t *audio_driver_pull_cond                   = NULL;
+static bool audio_driver_pull_nonblock                   = false;
+static size_t audio_driver_pull_frame_size               = 0;
+#endif
+
 static void audio_mixer_play_stop_sequential_cb(
       audio_mixer_sound_t *sound, unsigned reason);
 static void audio_mixer_play_stop_cb(
@@ -217,6 +253,11 @@ const char *audio_driver_mixer_get_stream_name(unsigned i)
  * Computes audio buffer statistics.
  *
  **/
+uint64_t audio_driver_get_underruns(void)
+{
+   return audio_driver_underruns;
+}
+
 bool compute_audio_buffer_statistics(audio_statistics_t *stats)
 {
    unsigned i, low_water_size, high_water_size, avg, stddev;
@@ -340,6 +381,105 @@ const char *config_get_audio_driver_options(void)
    return char_list_new_special(STRING_LIST_AUDIO_DRIVERS, NULL);
 }
 
+#ifdef HAVE_THREADS
+/* Runs on the driver's callback thread. */
+static size_t audio_driver_pull(void *buf, size_t size)
+{
+   size_t read = fifo_spsc_read_avail(audio_driver_pull_fifo);
+
+   /* Both sides only move whole frames, so the channels
+    * can never get swapped. */
+   if (read > size)
+      read = size;
+   read -= read % audio_driver_pull_frame_size;
+   read  = fifo_spsc_read(audio_driver_pull_fifo, buf, read);
+
+   if (read < size)
+      memset((uint8_t*)buf + read, 0, size - read);
+
+   /* Without the lock a wakeup can be missed, the writer
+    * only ever waits with a timeout. */
+   scond_signal(audio_driver_pull_cond);
+   return read;
+}
+
+static void audio_driver_pull_write(const void *data, size_t size)
+{
+   const uint8_t *buf  = (const uint8_t*)data;
+   unsigned waited     = 0;
+
+   for (;;)
+   {
+      size_t written = fifo_spsc_write_avail(audio_driver_pull_fifo);
+
+      if (written > size)
+         written = size;
+      written -= written % audio_driver_pull_frame_size;
+      written  = fifo_spsc_write(audio_driver_pull_fifo, buf, written);
+
+      buf  += written;
+      size -= written;
+
+      if (!size || audio_driver_pull_nonblock)
+         break;
+
+      if (written)
+         waited = 0;
+      else if (waited >= AUDIO_PULL_STALL_USEC)
+         break;
+
+      slock_lock(audio_driver_pull_lock);
+      if (!fifo_spsc_write_avail(audio_driver_pull_fifo))
+         scond_wait_timeout(audio_driver_pull_cond,
+               audio_driver_pull_lock, 1000);
+      slock_unlock(audio_driver_pull_lock);
+      waited += 1000;
+   }
+}
+
+static void audio_driver_pull_deinit(void)
+{
+   fifo_spsc_free(audio_driver_pull_fifo);
+   slock_free(audio_driver_pull_lock);
+   scond_free(audio_driver_pull_cond);
+   audio_driver_pull_fifo = NULL;
+   audio_driver_pull_lock = NULL;
+   audio_driver_pull_cond = NULL;
+}
+
+/* The ring holds @latency ms of output, on top of whatever
+ * the driver buffers itself. */
+static bool audio_driver_pull_init(unsigned out_rate, unsigned latency)
+{
+   size_t frame_size = 2 * (audio_driver_use_float
+         ? sizeof(float) : sizeof(int16_t));
+   size_t size       = (size_t)out_rate * latency / 1000 * frame_size;
+
+   audio_driver_pull_frame_size = frame_size;
+
+   audio_driver_pull_fifo = fifo_spsc_new(size);
+   audio_driver_pull_lock = slock_new();
+   audio_driver_pull_cond = scond_new();
+
+   if (!audio_driver_pull_fifo || !audio_driver_pull_lock
+         || !audio_driver_pull_cond)
+      goto error;
+
+   if (!current_audio->set_pull(audio_driver_context_audio_data,
+            audio_driver_pull))
+      goto error;
+
+   RARCH_LOG("[Audio]: Pull mode, %u ms (%u bytes) ring.\n",
+         latency, (unsigned)size);
+   return true;
+
+error:
+   RARCH_WARN("[Audio]: Pull mode is not available, using blocking writes.\n");
+   audio_driver_pull_deinit();
+   return false;
+}
+#endif
+
 static bool audio_driver_deinit_internal(void)
 {
    settings_t *settings = config_get_ptr();
@@ -351,10 +491,19 @@ static bool audio_driver_deinit_internal(void)
       audio_driver_context_audio_data = NULL;
    }
 
+#ifdef HAVE_THREADS
+   /* The driver's callback is gone now. */
+   audio_driver_pull_deinit();
+#endif
+
    if (audio_driver_output_samples_conv_buf)
       free(audio_driver_output_samples_conv_buf);
    audio_driver_output_samples_conv_buf = NULL;
 
+   if (audio_driver_sample_buf)
+      free(audio_driver_sample_buf);
+   audio_driver_sample_buf              = NULL;
+
    audio_driver_data_ptr                = 0;
 
    if (audio_driver_rewind_buf)
@@ -395,9 +544,14 @@ static void audio_driver_mixer_init(unsigned out_rate)
 static bool audio_driver_init_internal(bool audio_cb_inited)
 {
    unsigned new_rate     = 0;
+   unsigned latency      = 0;
+#ifdef HAVE_THREADS
+   bool pull             = false;
+#endif
    float   *aud_inp_data = NULL;
    float *samples_buf    = NULL;
    int16_t *conv_buf     = NULL;
+   int16_t *sample_buf   = NULL;
    int16_t *rewind_buf   = NULL;
    size_t max_bufsamples = AUDIO_CHUNK_SIZE_NONBLOCKING * 2;
    settings_t *settings  = config_get_ptr();
@@ -417,6 +571,15 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
       goto error;
 
    audio_driver_output_samples_conv_buf = conv_buf;
+
+   sample_buf = (int16_t*)malloc(AUDIO_CHUNK_SIZE_NONBLOCKING
+         * sizeof(int16_t));
+   retro_assert(sample_buf != NULL);
+
+   if (!sample_buf)
+      goto error;
+
+   audio_driver_sample_buf              = sample_buf;
    audio_driver_chunk_block_size        = AUDIO_CHUNK_SIZE_BLOCKING;
    audio_driver_chunk_nonblock_size     = AUDIO_CHUNK_SIZE_NONBLOCKING;
    audio_driver_chunk_size              = audio_driver_chunk_block_size;
@@ -439,6 +602,20 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
    }
 
    audio_driver_find_driver();
+
+   latency               = settings->uints.audio_latency;
+#ifdef HAVE_THREADS
+   /* In pull mode the driver only needs enough buffering to cover
+    * its callback period, the rest of the latency goes to our ring. */
+   if (     !audio_cb_inited
+         && settings->bools.audio_pull
+         && current_audio->set_pull)
+   {
+      pull               = true;
+      latency            = settings->uints.audio_latency / 2;
+   }
+#endif
+
 #ifdef HAVE_THREADS
    if (audio_cb_inited)
    {
@@ -464,7 +641,7 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
          current_audio->init(*settings->arrays.audio_device ?
                settings->arrays.audio_device : NULL,
                settings->uints.audio_out_rate,
-               settings->uints.audio_latency,
+               latency,
                settings->uints.audio_block_frames,
                &new_rate);
    }
@@ -485,6 +662,13 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
          && current_audio->use_float(audio_driver_context_audio_data))
       audio_driver_use_float = true;
 
+#ifdef HAVE_THREADS
+   audio_driver_pull_nonblock = false;
+   if (pull && audio_driver_active)
+      pull = audio_driver_pull_init(settings->uints.audio_out_rate,
+            settings->uints.audio_latency - latency);
+#endif
+
    if (!settings->bools.audio_sync && audio_driver_active)
    {
       command_event(CMD_EVENT_AUDIO_SET_NONBLOCKING_STATE, NULL);
@@ -542,6 +726,16 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
          && settings->bools.audio_rate_control
          )
    {
+#ifdef HAVE_THREADS
+      /* In pull mode, keep our own ring half full instead. */
+      if (pull)
+      {
+         audio_driver_buffer_size =
+            fifo_spsc_size(audio_driver_pull_fifo);
+         audio_driver_control     = true;
+      }
+      else
+#endif
       /* Audio rate control requires write_avail
        * and buffer_size to be implemented. */
       if (current_audio->buffer_size)
@@ -557,6 +751,7 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
    command_event(CMD_EVENT_DSP_FILTER_INIT, NULL);
 
    audio_driver_free_samples_count = 0;
+   audio_driver_underruns          = 0;
 
    audio_driver_mixer_init(settings->uints.audio_out_rate);
 
@@ -584,6 +779,10 @@ void audio_driver_set_nonblocking_state(bool enable)
             audio_driver_context_audio_data,
             settings->bools.audio_sync ? enable : true);
 
+#ifdef HAVE_THREADS
+   audio_driver_pull_nonblock = settings->bools.audio_sync ? enable : true;
+#endif
+
    audio_driver_chunk_size = enable ?
       audio_driver_chunk_nonblock_size :
       audio_driver_chunk_block_size;
@@ -596,18 +795,32 @@ void audio_driver_set_nonblocking_state(bool enable)
  *
  * Writes audio samples to audio driver. Will first
  * perform DSP processing (if enabled) and resampling.
+ *
+ * The input is taken through conversion, DSP, resampling,
+ * gain and the s16 conversion AUDIO_FLUSH_BLOCK_FRAMES at a time
+ * instead of one full pass per stage. The mixer locks and decodes
+ * per call, so while it is active it and the s16 conversion after
+ * it still run once over the whole output.
  **/
 static void audio_driver_flush(const int16_t *data, size_t samples)
 {
    struct resampler_data src_data;
+   size_t offset;
    bool is_perfcnt_enable            = false;
    bool is_paused                    = false;
    bool is_idle                      = false;
    bool is_slowmotion                = false;
    const void *output_data           = NULL;
    unsigned output_frames            = 0;
+   size_t out_samples                = 0;
+   const audio_mix_kernels_t *kernels = NULL;
    float audio_volume_gain           = !audio_driver_mute_enable ?
       audio_driver_volume_gain : 0.0f;
+   /* With a DSP filter, the gain is applied to its output instead,
+    * so muting or turning down the volume doesn't leave echo and
+    * reverb tails ringing out at the old level. */
+   float input_gain                  = audio_driver_dsp ?
+      1.0f : audio_volume_gain;
 
    src_data.data_out                 = NULL;
    src_data.output_frames            = 0;
@@ -624,41 +837,17 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 		   !audio_driver_output_samples_buf)
       return;
 
-   convert_s16_to_float(audio_driver_input_data, data, samples,
-         audio_volume_gain);
-
-   src_data.data_in                  = audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
-
-
-   if (audio_driver_dsp)
-   {
-      struct retro_dsp_data dsp_data;
-
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
-
-      dsp_data.input                 = audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
-
-      retro_dsp_filter_process(audio_driver_dsp, &dsp_data);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
-   }
-
-   src_data.data_out = audio_driver_output_samples_buf;
+   performance_zone_begin(PERF_ZONE_AUDIO_FLUSH);
 
    if (audio_driver_control)
    {
       /* Readjust the audio input rate. */
       int      half_size   = (int)(audio_driver_buffer_size / 2);
       int      avail       =
+#ifdef HAVE_THREADS
+         audio_driver_pull_fifo
+         ? (int)fifo_spsc_write_avail(audio_driver_pull_fifo) :
+#endif
          (int)current_audio->write_avail(audio_driver_context_audio_data);
       int      delta_mid   = avail - half_size;
       double   direction   = (double)delta_mid / half_size;
@@ -668,6 +857,8 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 
       audio_driver_free_samples_buf
          [write_idx]               = avail;
+      if (avail >= (int)audio_driver_buffer_size)
+         audio_driver_underruns++;
       audio_source_ratio_current   =
          audio_source_ratio_original * adjust;
 
@@ -691,7 +882,69 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
       src_data.ratio       *= settings->floats.slowmotion_ratio;
    }
 
-   audio_driver_resampler->process(audio_driver_resampler_data, &src_data);
+   if (audio_driver_dsp)
+      kernels = audio_mix_kernels_find();
+
+   for (offset = 0; offset < samples;
+         offset += AUDIO_FLUSH_BLOCK_FRAMES * 2)
+   {
+      size_t block_samples = samples - offset;
+      float *block_out     = audio_driver_output_samples_buf + out_samples;
+
+      if (block_samples > AUDIO_FLUSH_BLOCK_FRAMES * 2)
+         block_samples     = AUDIO_FLUSH_BLOCK_FRAMES * 2;
+
+      convert_s16_to_float(audio_driver_input_data, data + offset,
+            block_samples, input_gain);
+
+      src_data.data_in      = audio_driver_input_data;
+      src_data.input_frames = block_samples >> 1;
+
+      if (audio_driver_dsp)
+      {
+         struct retro_dsp_data dsp_data;
+
+         dsp_data.input         = audio_driver_input_data;
+         dsp_data.input_frames  = (unsigned)(block_samples >> 1);
+         dsp_data.output        = NULL;
+         dsp_data.output_frames = 0;
+
+         retro_dsp_filter_process(audio_driver_dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in      = dsp_data.output;
+            src_data.input_frames = dsp_data.output_frames;
+         }
+      }
+
+      src_data.data_out = block_out;
+
+      audio_driver_resampler->process(audio_driver_resampler_data,
+            &src_data);
+
+      block_samples = src_data.output_frames * 2;
+
+      if (audio_driver_dsp)
+      {
+         if (audio_volume_gain != 1.0f)
+            kernels->scale(block_out, block_out,
+                  audio_volume_gain, block_samples);
+
+         /* The filters can overshoot full scale. The s16 conversion
+          * saturates and the mixer clamps on its own, float drivers
+          * would pass it through. */
+         if (audio_driver_use_float && !audio_mixer_active)
+            kernels->clamp(block_out, block_samples);
+      }
+
+      if (!audio_driver_use_float && !audio_mixer_active)
+         convert_float_to_s16(
+               audio_driver_output_samples_conv_buf + out_samples,
+               block_out, block_samples);
+
+      out_samples += block_samples;
+   }
 
    if (audio_mixer_active)
    {
@@ -700,26 +953,40 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
       float mixer_gain  = !audio_driver_mixer_mute_enable ?
          audio_driver_mixer_volume_gain : 0.0f;
       audio_mixer_mix(audio_driver_output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
+            out_samples >> 1, mixer_gain, override);
+
+      if (!audio_driver_use_float)
+         convert_float_to_s16(audio_driver_output_samples_conv_buf,
+               audio_driver_output_samples_buf, out_samples);
    }
 
-   output_data        = audio_driver_output_samples_buf;
-   output_frames      = (unsigned)src_data.output_frames;
+   output_frames      = (unsigned)(out_samples >> 1);
 
    if (audio_driver_use_float)
+   {
+      output_data     = audio_driver_output_samples_buf;
       output_frames  *= sizeof(float);
+   }
    else
    {
-      convert_float_to_s16(audio_driver_output_samples_conv_buf,
-            (const float*)output_data, output_frames * 2);
-
       output_data     = audio_driver_output_samples_conv_buf;
       output_frames  *= sizeof(int16_t);
    }
 
+#ifdef HAVE_THREADS
+   if (audio_driver_pull_fifo)
+   {
+      audio_driver_pull_write(output_data, output_frames * 2);
+      performance_zone_end(PERF_ZONE_AUDIO_FLUSH);
+      return;
+   }
+#endif
+
    if (current_audio->write(audio_driver_context_audio_data,
             output_data, output_frames * 2) < 0)
       audio_driver_active = false;
+
+   performance_zone_end(PERF_ZONE_AUDIO_FLUSH);
 }
 
 /**
@@ -734,13 +1001,13 @@ void audio_driver_sample(int16_t left, int16_t right)
    if (audio_suspended)
       return;
 
-   audio_driver_output_samples_conv_buf[audio_driver_data_ptr++] = left;
-   audio_driver_output_samples_conv_buf[audio_driver_data_ptr++] = right;
+   audio_driver_sample_buf[audio_driver_data_ptr++] = left;
+   audio_driver_sample_buf[audio_driver_data_ptr++] = right;
 
    if (audio_driver_data_ptr < audio_driver_chunk_size)
       return;
 
-   audio_driver_flush(audio_driver_output_samples_conv_buf,
+   audio_driver_flush(audio_driver_sample_buf,
          audio_driver_data_ptr);
 
    audio_driver_data_ptr = 0;
@@ -913,11 +1180,11 @@ void audio_driver_setup_rewind(void)
    {
       if (audio_driver_rewind_ptr > 0)
          audio_driver_rewind_buf[--audio_driver_rewind_ptr] =
-            audio_driver_output_samples_conv_buf[i + 1];
+            audio_driver_sample_buf[i + 1];
 
       if (audio_driver_rewind_ptr > 0)
          audio_driver_rewind_buf[--audio_driver_rewind_ptr] =
-            audio_driver_output_samples_conv_buf[i + 0];
+            audio_driver_sample_buf[i + 0];
    }
 
    audio_driver_data_ptr = 0;
@@ -78,6 +78,12 @@ typedef struct audio_statistics
    unsigned samples;
 } audio_statistics_t;
 
+/* Fills @buf with @size bytes of output for a driver in pull mode,
+ * padding with silence on underrun.
+ *
+ * Returns: number of bytes that were real samples. */
+typedef size_t (*audio_driver_pull_t)(void *buf, size_t size);
+
 typedef struct audio_driver
 {
    /* Creates and initializes handle to audio driver.
@@ -158,6 +164,13 @@ typedef struct audio_driver
    size_t (*write_avail)(void *data);
 
    size_t (*buffer_size)(void *data);
+
+   /* Optional. Pull mode: instead of write(), the driver fetches
+    * samples with @pull from its own callback thread, whenever the
+    * device wants more. NULL goes back to write().
+    *
+    * Returns: false if the driver can't run in pull mode. */
+   bool (*set_pull)(void *data, audio_driver_pull_t pull);
 } audio_driver_t;
 
 typedef struct audio_mixer_stream_params
@@ -315,6 +328,10 @@ const char *audio_driver_mixer_get_stream_name(unsigned i);
 
 bool compute_audio_buffer_statistics(audio_statistics_t *stats);
 
+/* Times the output buffer was found empty when writing
+ * since the driver was initialized. Needs rate control. */
+uint64_t audio_driver_get_underruns(void);
+
 extern audio_driver_t audio_rsound;
 extern audio_driver_t audio_oss;
 extern audio_driver_t audio_alsa;
@@ -327,6 +344,7 @@ extern audio_driver_t audio_jack;
 extern audio_driver_t audio_sdl;
 extern audio_driver_t audio_xa;
 extern audio_driver_t audio_pulse;
+extern audio_driver_t audio_pipewire;
 extern audio_driver_t audio_dsound;
 extern audio_driver_t audio_wasapi;
 extern audio_driver_t audio_coreaudio;
@@ -341,6 +359,7 @@ extern audio_driver_t audio_ctr_dsp;
 extern audio_driver_t audio_switch;
 extern audio_driver_t audio_switch_thread;
 extern audio_driver_t audio_rwebaudio;
+extern audio_driver_t audio_audioworklet;
 extern audio_driver_t audio_null;
 
 RETRO_END_DECLS
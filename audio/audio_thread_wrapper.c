@@ -17,11 +17,11 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <queues/fifo_queue.h>
 #include <rthreads/rthreads.h>
 
 #include "audio_thread_wrapper.h"
 #include "../verbosity.h"
+#include "../performance_counters.h"
 
 typedef struct audio_thread
 {
@@ -76,6 +76,8 @@ static void audio_thread_loop(void *data)
    slock_unlock(thr->lock);
 
    RARCH_LOG("[Audio Thread]: Starting audio.\n");
+   performance_trace_thread("audio");
+   sthread_set_role(STHREAD_ROLE_AUDIO);
 
    for (;;)
    {
@@ -105,7 +107,10 @@ static void audio_thread_loop(void *data)
       }
 
       slock_unlock(thr->lock);
+
+      performance_trace_begin("audio_callback");
       audio_driver_callback();
+      performance_trace_end();
    }
 
    RARCH_LOG("[Audio Thread]: Tearing down driver.\n");
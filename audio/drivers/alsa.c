@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <lists/string_list.h>
 #include <string/stdstring.h>
@@ -22,13 +23,18 @@
 #include <alsa/asoundlib.h>
 
 #include "../audio_driver.h"
+#include "../../configuration.h"
 #include "../../verbosity.h"
 
 typedef struct alsa
 {
    snd_pcm_t *pcm;
    size_t buffer_size;
+   snd_pcm_uframes_t buffer_frames;
+   snd_pcm_uframes_t start_threshold;
    bool nonblock;
+   /* Written through snd_pcm_mmap_begin/commit instead of writei. */
+   bool mmap;
    unsigned int frame_bits;
    bool has_float;
    bool can_pause;
@@ -63,6 +69,7 @@ static void *alsa_init(const char *device, unsigned rate, unsigned latency,
    snd_pcm_uframes_t buffer_size;
    snd_pcm_hw_params_t *params    = NULL;
    snd_pcm_sw_params_t *sw_params = NULL;
+   settings_t *settings           = config_get_ptr();
    unsigned latency_usec          = latency * 1000;
    unsigned channels              = 2;
    unsigned periods               = 4;
@@ -89,10 +96,18 @@ static void *alsa_init(const char *device, unsigned rate, unsigned latency,
    if (snd_pcm_hw_params_any(alsa->pcm, params) < 0)
       goto error;
 
-   if (snd_pcm_hw_params_set_access(
+   /* Plugins that can't map the buffer just fail this,
+    * and leave params untouched. */
+   alsa->mmap = settings->bools.audio_alsa_mmap
+      && snd_pcm_hw_params_set_access(
+            alsa->pcm, params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+
+   if (!alsa->mmap && snd_pcm_hw_params_set_access(
             alsa->pcm, params, SND_PCM_ACCESS_RW_INTERLEAVED) < 0)
       goto error;
 
+   RARCH_LOG("[ALSA]: Using %s access.\n", alsa->mmap ? "mmap" : "read/write");
+
    /* channels hardcoded to 2 for now */
    alsa->frame_bits = snd_pcm_format_physical_width(format) * 2;
 
@@ -133,8 +148,10 @@ static void *alsa_init(const char *device, unsigned rate, unsigned latency,
 
    RARCH_LOG("[ALSA]: Buffer size: %d frames\n", (int)buffer_size);
 
-   alsa->buffer_size = snd_pcm_frames_to_bytes(alsa->pcm, buffer_size);
-   alsa->can_pause = snd_pcm_hw_params_can_pause(params);
+   alsa->buffer_size     = snd_pcm_frames_to_bytes(alsa->pcm, buffer_size);
+   alsa->buffer_frames   = buffer_size;
+   alsa->start_threshold = buffer_size / 2;
+   alsa->can_pause       = snd_pcm_hw_params_can_pause(params);
 
    RARCH_LOG("[ALSA]: Can pause: %s.\n", alsa->can_pause ? "yes" : "no");
 
@@ -145,7 +162,7 @@ static void *alsa_init(const char *device, unsigned rate, unsigned latency,
       goto error;
 
    if (snd_pcm_sw_params_set_start_threshold(
-            alsa->pcm, sw_params, buffer_size / 2) < 0)
+            alsa->pcm, sw_params, alsa->start_threshold) < 0)
       goto error;
 
    if (snd_pcm_sw_params(alsa->pcm, sw_params) < 0)
@@ -180,6 +197,76 @@ error:
 #define BYTES_TO_FRAMES(bytes, frame_bits)  ((bytes) * 8 / frame_bits)
 #define FRAMES_TO_BYTES(frames, frame_bits) ((frames) * frame_bits / 8)
 
+/* Same contract as snd_pcm_writei on a non-blocking stream, but copies
+ * straight into the mapped DMA buffer, without a syscall per write on
+ * hw devices. Unlike writei, committing doesn't start the stream by
+ * itself, so that's done here once the start threshold is reached. */
+static snd_pcm_sframes_t alsa_mmap_writei(alsa_t *alsa,
+      const uint8_t *buf, snd_pcm_uframes_t size)
+{
+   snd_pcm_sframes_t avail;
+   snd_pcm_sframes_t written = 0;
+
+   while (size)
+   {
+      const snd_pcm_channel_area_t *areas;
+      snd_pcm_uframes_t offset;
+      snd_pcm_sframes_t committed;
+      snd_pcm_uframes_t frames = size;
+      int                   rc = 0;
+
+      avail = snd_pcm_avail_update(alsa->pcm);
+      if (avail < 0)
+         return written ? written : avail;
+      if (avail == 0)
+         break;
+
+      if (frames > (snd_pcm_uframes_t)avail)
+         frames = avail;
+
+      rc = snd_pcm_mmap_begin(alsa->pcm, &areas, &offset, &frames);
+      if (rc < 0)
+         return written ? written : rc;
+
+      /* Interleaved, so every channel sits in the first area. */
+      memcpy((uint8_t*)areas[0].addr
+            + (areas[0].first + offset * areas[0].step) / 8,
+            buf, FRAMES_TO_BYTES(frames, alsa->frame_bits));
+
+      committed = snd_pcm_mmap_commit(alsa->pcm, offset, frames);
+      if (committed < 0)
+         return written ? written : committed;
+
+      written += committed;
+      buf     += FRAMES_TO_BYTES(committed, alsa->frame_bits);
+      size    -= committed;
+
+      if ((snd_pcm_uframes_t)committed != frames)
+         break;
+   }
+
+   if (!written)
+      return -EAGAIN;
+
+   if (snd_pcm_state(alsa->pcm) == SND_PCM_STATE_PREPARED)
+   {
+      avail = snd_pcm_avail_update(alsa->pcm);
+      if (     avail >= 0
+            && alsa->buffer_frames - avail >= alsa->start_threshold)
+         snd_pcm_start(alsa->pcm);
+   }
+
+   return written;
+}
+
+static snd_pcm_sframes_t alsa_writei(alsa_t *alsa,
+      const uint8_t *buf, snd_pcm_uframes_t size)
+{
+   if (alsa->mmap)
+      return alsa_mmap_writei(alsa, buf, size);
+   return snd_pcm_writei(alsa->pcm, buf, size);
+}
+
 static ssize_t alsa_write(void *data, const void *buf_, size_t size_)
 {
    alsa_t *alsa              = (alsa_t*)data;
@@ -192,7 +279,7 @@ static ssize_t alsa_write(void *data, const void *buf_, size_t size_)
    {
       while (size)
       {
-         snd_pcm_sframes_t frames = snd_pcm_writei(alsa->pcm, buf, size);
+         snd_pcm_sframes_t frames = alsa_writei(alsa, buf, size);
 
          if (frames == -EPIPE || frames == -EINTR || frames == -ESTRPIPE)
          {
@@ -227,7 +314,7 @@ static ssize_t alsa_write(void *data, const void *buf_, size_t size_)
             continue;
          }
 
-         frames = snd_pcm_writei(alsa->pcm, buf, size);
+         frames = alsa_writei(alsa, buf, size);
 
          if (frames == -EPIPE || frames == -EINTR || frames == -ESTRPIPE)
          {
@@ -331,7 +418,27 @@ static void alsa_free(void *data)
 static size_t alsa_write_avail(void *data)
 {
    alsa_t *alsa            = (alsa_t*)data;
-   snd_pcm_sframes_t avail = snd_pcm_avail(alsa->pcm);
+   snd_pcm_sframes_t avail;
+
+   if (alsa->mmap)
+   {
+      /* One call syncs the hardware pointer and reports what's still
+       * queued ahead of the DAC, which is what rate control should
+       * keep half full. */
+      snd_pcm_sframes_t delay;
+
+      if (snd_pcm_avail_delay(alsa->pcm, &avail, &delay) < 0)
+         return alsa->buffer_size;
+
+      if (delay < 0)
+         delay = 0;
+      if ((snd_pcm_uframes_t)delay > alsa->buffer_frames)
+         delay = alsa->buffer_frames;
+      if (avail > (snd_pcm_sframes_t)(alsa->buffer_frames - delay))
+         avail = alsa->buffer_frames - delay;
+   }
+   else
+      avail = snd_pcm_avail(alsa->pcm);
 
    if (avail < 0)
       return alsa->buffer_size;
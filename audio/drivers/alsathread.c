@@ -21,10 +21,11 @@
 #include <alsa/asoundlib.h>
 
 #include <rthreads/rthreads.h>
-#include <queues/fifo_queue.h>
+#include <queues/fifo_spsc.h>
 #include <string/stdstring.h>
 
 #include "../audio_driver.h"
+#include "../../configuration.h"
 #include "../../verbosity.h"
 
 #define TRY_ALSA(x) if (x < 0) \
@@ -37,23 +38,103 @@ typedef struct alsa_thread
    bool is_paused;
    bool has_float;
    volatile bool thread_dead;
+   /* The worker reads the fifo straight into the mapped DMA
+    * buffer instead of through writei. */
+   bool mmap;
 
    size_t buffer_size;
    size_t period_size;
    snd_pcm_uframes_t period_frames;
+   snd_pcm_uframes_t buffer_frames;
 
-   fifo_buffer_t *buffer;
+   /* Written by alsa_thread_write, read by the worker; cond_lock
+    * only guards the wait for room, not the data. */
+   fifo_spsc_t *buffer;
    sthread_t *worker_thread;
-   slock_t *fifo_lock;
    scond_t *cond;
    slock_t *cond_lock;
 } alsa_thread_t;
 
+static void alsa_thread_signal(alsa_thread_t *alsa)
+{
+   /* Signalling under cond_lock means a writer that saw a full
+    * buffer is either already waiting or will see this read. */
+   slock_lock(alsa->cond_lock);
+   scond_signal(alsa->cond);
+   slock_unlock(alsa->cond_lock);
+}
+
+/* Fills one period of the mapped ring from the fifo, padding an
+ * underrun with silence. Returns frames committed, 0 when it had to
+ * wait for room, or a negative error for snd_pcm_recover. */
+static snd_pcm_sframes_t alsa_thread_mmap_period(alsa_thread_t *alsa)
+{
+   snd_pcm_sframes_t written = 0;
+   snd_pcm_sframes_t avail   = snd_pcm_avail_update(alsa->pcm);
+
+   if (avail < 0)
+      return avail;
+
+   if ((snd_pcm_uframes_t)avail < alsa->period_frames)
+   {
+      /* Commits don't start the stream, and a prepared stream
+       * never frees room, so waiting would block forever. */
+      int rc = (snd_pcm_state(alsa->pcm) == SND_PCM_STATE_PREPARED)
+         ? snd_pcm_start(alsa->pcm)
+         : snd_pcm_wait(alsa->pcm, -1);
+      return rc < 0 ? rc : 0;
+   }
+
+   /* Might take two goes where the period wraps around the ring. */
+   while ((snd_pcm_uframes_t)written < alsa->period_frames)
+   {
+      const snd_pcm_channel_area_t *areas;
+      snd_pcm_uframes_t offset;
+      snd_pcm_sframes_t committed;
+      size_t bytes, read;
+      uint8_t *dst;
+      snd_pcm_uframes_t frames = alsa->period_frames - written;
+      int                   rc = snd_pcm_mmap_begin(
+            alsa->pcm, &areas, &offset, &frames);
+
+      if (rc < 0)
+         return rc;
+
+      /* Interleaved, so every channel sits in the first area. */
+      dst   = (uint8_t*)areas[0].addr
+         + (areas[0].first + offset * areas[0].step) / 8;
+      bytes = snd_pcm_frames_to_bytes(alsa->pcm, frames);
+      read  = fifo_spsc_read(alsa->buffer, dst, bytes);
+      memset(dst + read, 0, bytes - read);
+
+      committed = snd_pcm_mmap_commit(alsa->pcm, offset, frames);
+      if (committed < 0)
+         return committed;
+
+      written += committed;
+      if ((snd_pcm_uframes_t)committed != frames)
+         break;
+   }
+
+   alsa_thread_signal(alsa);
+
+   if (snd_pcm_state(alsa->pcm) == SND_PCM_STATE_PREPARED)
+   {
+      avail = snd_pcm_avail_update(alsa->pcm);
+      if (avail >= 0 && alsa->buffer_frames - avail >= alsa->buffer_frames / 2)
+         snd_pcm_start(alsa->pcm);
+   }
+
+   return written;
+}
+
 static void alsa_worker_thread(void *data)
 {
    alsa_thread_t *alsa = (alsa_thread_t*)data;
    uint8_t        *buf = (uint8_t *)calloc(1, alsa->period_size);
 
+   sthread_set_role(STHREAD_ROLE_AUDIO);
+
    if (!buf)
    {
       RARCH_ERR("failed to allocate audio buffer");
@@ -62,20 +143,22 @@ static void alsa_worker_thread(void *data)
 
    while (!alsa->thread_dead)
    {
-      size_t avail;
-      size_t fifo_size;
       snd_pcm_sframes_t frames;
-      slock_lock(alsa->fifo_lock);
-      avail = fifo_read_avail(alsa->buffer);
-      fifo_size = MIN(alsa->period_size, avail);
-      fifo_read(alsa->buffer, buf, fifo_size);
-      scond_signal(alsa->cond);
-      slock_unlock(alsa->fifo_lock);
 
-      /* If underrun, fill rest with silence. */
-      memset(buf + fifo_size, 0, alsa->period_size - fifo_size);
+      if (alsa->mmap)
+         frames = alsa_thread_mmap_period(alsa);
+      else
+      {
+         size_t fifo_size = fifo_spsc_read(alsa->buffer, buf,
+               alsa->period_size);
+
+         alsa_thread_signal(alsa);
 
-      frames = snd_pcm_writei(alsa->pcm, buf, alsa->period_frames);
+         /* If underrun, fill rest with silence. */
+         memset(buf + fifo_size, 0, alsa->period_size - fifo_size);
+
+         frames = snd_pcm_writei(alsa->pcm, buf, alsa->period_frames);
+      }
 
       if (frames == -EPIPE || frames == -EINTR ||
             frames == -ESTRPIPE)
@@ -137,11 +220,9 @@ static void alsa_thread_free(void *data)
          sthread_join(alsa->worker_thread);
       }
       if (alsa->buffer)
-         fifo_free(alsa->buffer);
+         fifo_spsc_free(alsa->buffer);
       if (alsa->cond)
          scond_free(alsa->cond);
-      if (alsa->fifo_lock)
-         slock_free(alsa->fifo_lock);
       if (alsa->cond_lock)
          slock_free(alsa->cond_lock);
       if (alsa->pcm)
@@ -166,6 +247,7 @@ static void *alsa_thread_init(const char *device,
    unsigned latency_usec          = latency * 1000 / 2;
    unsigned channels              = 2;
    unsigned periods               = 4;
+   settings_t *settings           = config_get_ptr();
    alsa_thread_t            *alsa = (alsa_thread_t*)
       calloc(1, sizeof(alsa_thread_t));
 
@@ -179,8 +261,15 @@ static void *alsa_thread_init(const char *device,
    format = alsa->has_float ? SND_PCM_FORMAT_FLOAT : SND_PCM_FORMAT_S16;
 
    TRY_ALSA(snd_pcm_hw_params_any(alsa->pcm, params));
-   TRY_ALSA(snd_pcm_hw_params_set_access(
-            alsa->pcm, params, SND_PCM_ACCESS_RW_INTERLEAVED));
+   /* Plugins that can't map the buffer just fail this,
+    * and leave params untouched. */
+   alsa->mmap = settings->bools.audio_alsa_mmap
+      && snd_pcm_hw_params_set_access(
+            alsa->pcm, params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+   if (!alsa->mmap)
+      TRY_ALSA(snd_pcm_hw_params_set_access(
+               alsa->pcm, params, SND_PCM_ACCESS_RW_INTERLEAVED));
+   RARCH_LOG("ALSA: Using %s access.\n", alsa->mmap ? "mmap" : "read/write");
    TRY_ALSA(snd_pcm_hw_params_set_format(alsa->pcm, params, format));
    TRY_ALSA(snd_pcm_hw_params_set_channels(alsa->pcm, params, channels));
    TRY_ALSA(snd_pcm_hw_params_set_rate(alsa->pcm, params, rate, 0));
@@ -202,7 +291,8 @@ static void *alsa_thread_init(const char *device,
       snd_pcm_hw_params_get_buffer_size_max(params, &buffer_size);
    RARCH_LOG("ALSA: Buffer size: %d frames\n", (int)buffer_size);
 
-   alsa->buffer_size = snd_pcm_frames_to_bytes(alsa->pcm, buffer_size);
+   alsa->buffer_size   = snd_pcm_frames_to_bytes(alsa->pcm, buffer_size);
+   alsa->buffer_frames = buffer_size;
    alsa->period_size = snd_pcm_frames_to_bytes(alsa->pcm, alsa->period_frames);
 
    TRY_ALSA(snd_pcm_sw_params_malloc(&sw_params));
@@ -214,11 +304,10 @@ static void *alsa_thread_init(const char *device,
    snd_pcm_hw_params_free(params);
    snd_pcm_sw_params_free(sw_params);
 
-   alsa->fifo_lock = slock_new();
    alsa->cond_lock = slock_new();
-   alsa->cond = scond_new();
-   alsa->buffer = fifo_new(alsa->buffer_size);
-   if (!alsa->fifo_lock || !alsa->cond_lock || !alsa->cond || !alsa->buffer)
+   alsa->cond      = scond_new();
+   alsa->buffer    = fifo_spsc_new(alsa->buffer_size);
+   if (!alsa->cond_lock || !alsa->cond || !alsa->buffer)
       goto error;
 
    alsa->worker_thread = sthread_create(alsa_worker_thread, alsa);
@@ -252,43 +341,25 @@ static ssize_t alsa_thread_write(void *data, const void *buf, size_t size)
 
    if (alsa->nonblock)
    {
-      size_t avail;
-      size_t write_amt;
-
-      slock_lock(alsa->fifo_lock);
-      avail           = fifo_write_avail(alsa->buffer);
-      write_amt       = MIN(avail, size);
-
-      fifo_write(alsa->buffer, buf, write_amt);
-      slock_unlock(alsa->fifo_lock);
-
-      return write_amt;
+      return fifo_spsc_write(alsa->buffer, buf, size);
    }
    else
    {
       size_t written = 0;
       while (written < size && !alsa->thread_dead)
       {
-         size_t avail;
-         slock_lock(alsa->fifo_lock);
-         avail = fifo_write_avail(alsa->buffer);
+         size_t write_amt = fifo_spsc_write(alsa->buffer,
+               (const char*)buf + written, size - written);
 
-         if (avail == 0)
+         if (write_amt == 0)
          {
-            slock_unlock(alsa->fifo_lock);
             slock_lock(alsa->cond_lock);
-            if (!alsa->thread_dead)
+            if (!alsa->thread_dead && !fifo_spsc_write_avail(alsa->buffer))
                scond_wait(alsa->cond, alsa->cond_lock);
             slock_unlock(alsa->cond_lock);
          }
-         else
-         {
-            size_t write_amt = MIN(size - written, avail);
-            fifo_write(alsa->buffer,
-                  (const char*)buf + written, write_amt);
-            slock_unlock(alsa->fifo_lock);
-            written += write_amt;
-         }
+
+         written += write_amt;
       }
       return written;
    }
@@ -329,14 +400,10 @@ static bool alsa_thread_start(void *data, bool is_shutdown)
 static size_t alsa_thread_write_avail(void *data)
 {
    alsa_thread_t *alsa = (alsa_thread_t*)data;
-   size_t val;
 
    if (alsa->thread_dead)
       return 0;
-   slock_lock(alsa->fifo_lock);
-   val = fifo_write_avail(alsa->buffer);
-   slock_unlock(alsa->fifo_lock);
-   return val;
+   return fifo_spsc_write_avail(alsa->buffer);
 }
 
 static size_t alsa_thread_buffer_size(void *data)
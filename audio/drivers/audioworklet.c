@@ -0,0 +1,208 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <boolean.h>
+
+#include "../audio_driver.h"
+#include "../../verbosity.h"
+
+/* Web Audio through an AudioWorklet. The worklet runs on the browser's
+ * audio thread and reads straight out of a ring in the wasm heap, so
+ * this needs a threaded build where the heap is a SharedArrayBuffer.
+ *
+ * The ring is interleaved stereo float. pos[0] is the write position,
+ * owned by us, and pos[1] the read position, owned by the worklet.
+ * Both are frame counters that only ever grow and wrap at 2^32; the
+ * capacity is a power of two so the difference is always the fill. */
+
+#define AUDIOWORKLET_MIN_FRAMES 1024
+
+/* emscripten/library_audioworklet.js */
+unsigned RWebAudioWorkletInit(void);
+bool RWebAudioWorkletConnect(float *ring, unsigned capacity,
+      uint32_t *pos);
+bool RWebAudioWorkletStart(void);
+bool RWebAudioWorkletStop(void);
+bool RWebAudioWorkletRunning(void);
+void RWebAudioWorkletFree(void);
+
+typedef struct audioworklet
+{
+   float *ring;
+   uint32_t pos[2];
+   unsigned capacity;
+   bool nonblock;
+   bool paused;
+} audioworklet_t;
+
+static void audioworklet_free(void *data)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+
+   if (!aw)
+      return;
+
+   /* Stops the worklet before the ring it reads from goes away */
+   RWebAudioWorkletFree();
+   free(aw->ring);
+   free(aw);
+}
+
+static void *audioworklet_init(const char *device, unsigned rate,
+      unsigned latency, unsigned block_frames, unsigned *new_rate)
+{
+   unsigned frames;
+   unsigned out_rate  = RWebAudioWorkletInit();
+   audioworklet_t *aw = NULL;
+
+   if (!out_rate)
+   {
+      RARCH_ERR("[AudioWorklet] Not available, needs a threaded build "
+            "and a cross-origin isolated page.\n");
+      return NULL;
+   }
+
+   if (!(aw = (audioworklet_t*)calloc(1, sizeof(*aw))))
+      goto error;
+
+   frames = (unsigned)((uint64_t)latency * out_rate / 1000);
+   for (aw->capacity = AUDIOWORKLET_MIN_FRAMES;
+         aw->capacity < frames; aw->capacity <<= 1);
+
+   if (!(aw->ring = (float*)calloc(aw->capacity, 2 * sizeof(float))))
+      goto error;
+
+   if (!RWebAudioWorkletConnect(aw->ring, aw->capacity, aw->pos))
+      goto error;
+
+   RARCH_LOG("[AudioWorklet] %u Hz, %u frames of buffer.\n",
+         out_rate, aw->capacity);
+
+   *new_rate = out_rate;
+   return aw;
+
+error:
+   audioworklet_free(aw);
+   return NULL;
+}
+
+static size_t audioworklet_avail_frames(audioworklet_t *aw)
+{
+   uint32_t r = __atomic_load_n(&aw->pos[1], __ATOMIC_ACQUIRE);
+   return aw->capacity - (uint32_t)(aw->pos[0] - r);
+}
+
+static ssize_t audioworklet_write(void *data, const void *buf, size_t len)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   const float *in    = (const float*)buf;
+   size_t frames      = len / (2 * sizeof(float));
+   size_t written     = 0;
+
+   while (written < frames)
+   {
+      size_t avail = audioworklet_avail_frames(aw);
+      size_t chunk, first;
+      unsigned w;
+
+      if (!avail)
+      {
+         /* A suspended context never drains, waiting on it from the
+          * main thread would hang the page */
+         if (aw->nonblock || !RWebAudioWorkletRunning())
+            break;
+         continue;
+      }
+
+      chunk = frames - written;
+      if (chunk > avail)
+         chunk = avail;
+
+      w     = aw->pos[0] & (aw->capacity - 1);
+      first = aw->capacity - w;
+      if (first > chunk)
+         first = chunk;
+
+      memcpy(aw->ring + w * 2, in + written * 2,
+            first * 2 * sizeof(float));
+      memcpy(aw->ring, in + (written + first) * 2,
+            (chunk - first) * 2 * sizeof(float));
+
+      __atomic_store_n(&aw->pos[0], aw->pos[0] + (uint32_t)chunk,
+            __ATOMIC_RELEASE);
+      written += chunk;
+   }
+
+   return written * 2 * sizeof(float);
+}
+
+static bool audioworklet_stop(void *data)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   aw->paused         = true;
+   return RWebAudioWorkletStop();
+}
+
+static bool audioworklet_start(void *data, bool is_shutdown)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   aw->paused         = false;
+   return RWebAudioWorkletStart();
+}
+
+static bool audioworklet_alive(void *data)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   return !aw->paused;
+}
+
+static void audioworklet_set_nonblock_state(void *data, bool state)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   aw->nonblock       = state;
+}
+
+static bool audioworklet_use_float(void *data) { return true; }
+
+static size_t audioworklet_write_avail(void *data)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   return audioworklet_avail_frames(aw) * 2 * sizeof(float);
+}
+
+static size_t audioworklet_buffer_size(void *data)
+{
+   audioworklet_t *aw = (audioworklet_t*)data;
+   return aw->capacity * 2 * sizeof(float);
+}
+
+audio_driver_t audio_audioworklet = {
+   audioworklet_init,
+   audioworklet_write,
+   audioworklet_stop,
+   audioworklet_start,
+   audioworklet_alive,
+   audioworklet_set_nonblock_state,
+   audioworklet_free,
+   audioworklet_use_float,
+   "audioworklet",
+   NULL,
+   NULL,
+   audioworklet_write_avail,
+   audioworklet_buffer_size,
+};
@@ -27,7 +27,7 @@
 #include <AudioUnit/AUComponent.h>
 
 #include <boolean.h>
-#include <queues/fifo_queue.h>
+#include <queues/fifo_spsc.h>
 #include <rthreads/rthreads.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
@@ -37,6 +37,8 @@
 
 typedef struct coreaudio
 {
+   /* Guards pull and the wait for room; the fifo itself is only
+    * written by coreaudio_write and read by the render callback. */
    slock_t *lock;
    scond_t *cond;
 
@@ -48,7 +50,8 @@ typedef struct coreaudio
    bool dev_alive;
    bool is_paused;
 
-   fifo_buffer_t *buffer;
+   fifo_spsc_t *buffer;
+   audio_driver_pull_t pull;
    bool nonblock;
    size_t buffer_size;
 } coreaudio_t;
@@ -73,7 +76,7 @@ static void coreaudio_free(void *data)
    }
 
    if (dev->buffer)
-      fifo_free(dev->buffer);
+      fifo_spsc_free(dev->buffer);
 
    slock_free(dev->lock);
    scond_free(dev->cond);
@@ -102,23 +105,31 @@ static OSStatus audio_write_cb(void *userdata,
 
    slock_lock(dev->lock);
 
-   if (fifo_read_avail(dev->buffer) < write_avail)
+   if (dev->pull)
+   {
+      audio_driver_pull_t pull = dev->pull;
+      slock_unlock(dev->lock);
+
+      if (!pull(outbuf, write_avail))
+         *action_flags = kAudioUnitRenderAction_OutputIsSilence;
+      return noErr;
+   }
+
+   if (fifo_spsc_read_avail(dev->buffer) < write_avail)
    {
       *action_flags = kAudioUnitRenderAction_OutputIsSilence;
 
       /* Seems to be needed. */
       memset(outbuf, 0, write_avail);
-
-      slock_unlock(dev->lock);
-
-      /* Technically possible to deadlock without. */
-      scond_signal(dev->cond);
-      return noErr;
    }
+   else
+      fifo_spsc_read(dev->buffer, outbuf, write_avail);
 
-   fifo_read(dev->buffer, outbuf, write_avail);
-   slock_unlock(dev->lock);
+   /* Signalled under the lock, so a writer that saw a full buffer is
+    * either already waiting or will see this read. Also technically
+    * possible to deadlock without on underrun. */
    scond_signal(dev->cond);
+   slock_unlock(dev->lock);
    return noErr;
 }
 
@@ -319,7 +330,7 @@ static void *coreaudio_init(const char *device,
    fifo_size        *= 2 * sizeof(float);
    dev->buffer_size  = fifo_size;
 
-   dev->buffer       = fifo_new(fifo_size);
+   dev->buffer       = fifo_spsc_new(fifo_size);
    if (!dev->buffer)
       goto error;
 
@@ -345,34 +356,28 @@ static ssize_t coreaudio_write(void *data, const void *buf_, size_t size)
 
    while (!g_interrupted && size > 0)
    {
-      size_t write_avail;
-
-      slock_lock(dev->lock);
-
-      write_avail = fifo_write_avail(dev->buffer);
-      if (write_avail > size)
-         write_avail = size;
+      size_t write_avail = fifo_spsc_write(dev->buffer, buf, size);
 
-      fifo_write(dev->buffer, buf, write_avail);
-      buf += write_avail;
+      buf     += write_avail;
       written += write_avail;
-      size -= write_avail;
+      size    -= write_avail;
 
       if (dev->nonblock)
-      {
-         slock_unlock(dev->lock);
          break;
-      }
 
+      if (write_avail == 0)
+      {
+         slock_lock(dev->lock);
 #if TARGET_OS_IPHONE
-      if (write_avail == 0 && !scond_wait_timeout(
-               dev->cond, dev->lock, 3000000))
-         g_interrupted = true;
+         if (!fifo_spsc_write_avail(dev->buffer) && !scond_wait_timeout(
+                  dev->cond, dev->lock, 3000000))
+            g_interrupted = true;
 #else
-      if (write_avail == 0)
-         scond_wait(dev->cond, dev->lock);
+         if (!fifo_spsc_write_avail(dev->buffer))
+            scond_wait(dev->cond, dev->lock);
 #endif
-      slock_unlock(dev->lock);
+         slock_unlock(dev->lock);
+      }
    }
 
    return written;
@@ -419,14 +424,8 @@ static bool coreaudio_use_float(void *data)
 
 static size_t coreaudio_write_avail(void *data)
 {
-   size_t avail;
    coreaudio_t *dev = (coreaudio_t*)data;
-
-   slock_lock(dev->lock);
-   avail = fifo_write_avail(dev->buffer);
-   slock_unlock(dev->lock);
-
-   return avail;
+   return fifo_spsc_write_avail(dev->buffer);
 }
 
 static size_t coreaudio_buffer_size(void *data)
@@ -435,6 +434,19 @@ static size_t coreaudio_buffer_size(void *data)
    return dev->buffer_size;
 }
 
+/* The render callback reads straight from the frontend,
+ * our fifo is left unused. */
+static bool coreaudio_set_pull(void *data, audio_driver_pull_t pull)
+{
+   coreaudio_t *dev = (coreaudio_t*)data;
+
+   slock_lock(dev->lock);
+   dev->pull = pull;
+   slock_unlock(dev->lock);
+
+   return true;
+}
+
 static void *coreaudio_device_list_new(void *data)
 {
    /* TODO/FIXME */
@@ -460,4 +472,5 @@ audio_driver_t audio_coreaudio = {
    coreaudio_device_list_free,
    coreaudio_write_avail,
    coreaudio_buffer_size,
+   coreaudio_set_pull,
 };
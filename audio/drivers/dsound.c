@@ -35,7 +35,7 @@
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
 #endif
-#include <queues/fifo_queue.h>
+#include <queues/fifo_spsc.h>
 
 #include "../audio_driver.h"
 #include "../../verbosity.h"
@@ -57,8 +57,8 @@ typedef struct dsound
    LPDIRECTSOUND ds;
    LPDIRECTSOUNDBUFFER dsb;
 
-   fifo_buffer_t *buffer;
-   CRITICAL_SECTION crit;
+   /* Written by dsound_write, read by dsound_thread. */
+   fifo_spsc_t *buffer;
 
    HANDLE      event;
 #ifdef HAVE_THREADS
@@ -153,6 +153,9 @@ static DWORD CALLBACK dsound_thread(PVOID data)
    dsound_t *ds = (dsound_t*)data;
 
    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#ifdef HAVE_THREADS
+   sthread_set_role(STHREAD_ROLE_AUDIO);
+#endif
 
    get_positions(ds, NULL, &write_ptr);
    write_ptr = (write_ptr + ds->buffer_size / 2) % ds->buffer_size;
@@ -165,9 +168,7 @@ static DWORD CALLBACK dsound_thread(PVOID data)
 
       avail = write_avail(read_ptr, write_ptr, ds->buffer_size);
 
-      EnterCriticalSection(&ds->crit);
-      fifo_avail = fifo_read_avail(ds->buffer);
-      LeaveCriticalSection(&ds->crit);
+      fifo_avail = fifo_spsc_read_avail(ds->buffer);
 
       if (avail < CHUNK_SIZE || ((fifo_avail < CHUNK_SIZE) && (avail < ds->buffer_size / 2)))
       {
@@ -205,12 +206,10 @@ static DWORD CALLBACK dsound_thread(PVOID data)
       {
          /* All is good. Pull from it and notify FIFO. */
 
-         EnterCriticalSection(&ds->crit);
          if (region.chunk1)
-            fifo_read(ds->buffer, region.chunk1, region.size1);
+            fifo_spsc_read(ds->buffer, region.chunk1, region.size1);
          if (region.chunk2)
-            fifo_read(ds->buffer, region.chunk2, region.size2);
-         LeaveCriticalSection(&ds->crit);
+            fifo_spsc_read(ds->buffer, region.chunk2, region.size2);
 
          release_region(ds, &region);
          write_ptr = (write_ptr + region.size1 + region.size2) % ds->buffer_size;
@@ -290,8 +289,6 @@ static void dsound_free(void *data)
 #endif
    }
 
-   DeleteCriticalSection(&ds->crit);
-
    if (ds->dsb)
    {
       IDirectSoundBuffer_Stop(ds->dsb);
@@ -305,7 +302,7 @@ static void dsound_free(void *data)
       CloseHandle(ds->event);
 
    if (ds->buffer)
-      fifo_free(ds->buffer);
+      fifo_spsc_free(ds->buffer);
 
    free(ds);
 }
@@ -341,8 +338,6 @@ static void *dsound_init(const char *device, unsigned rate, unsigned latency,
    if (!ds)
       goto error;
 
-   InitializeCriticalSection(&ds->crit);
-
    if (device)
       dev.device = strtoul(device, NULL, 0);
 
@@ -391,7 +386,7 @@ static void *dsound_init(const char *device, unsigned rate, unsigned latency,
    if (!ds->event)
       goto error;
 
-   ds->buffer = fifo_new(4 * 1024);
+   ds->buffer = fifo_spsc_new(4 * 1024);
    if (!ds->buffer)
       goto error;
 
@@ -468,15 +463,7 @@ static ssize_t dsound_write(void *data, const void *buf_, size_t size)
 
    while (size > 0)
    {
-      size_t avail;
-
-      EnterCriticalSection(&ds->crit);
-      avail = fifo_write_avail(ds->buffer);
-      if (avail > size)
-         avail = size;
-
-      fifo_write(ds->buffer, buf, avail);
-      LeaveCriticalSection(&ds->crit);
+      size_t avail = fifo_spsc_write(ds->buffer, buf, size);
 
       buf     += avail;
       size    -= avail;
@@ -494,13 +481,8 @@ static ssize_t dsound_write(void *data, const void *buf_, size_t size)
 
 static size_t dsound_write_avail(void *data)
 {
-   size_t avail;
    dsound_t *ds = (dsound_t*)data;
-
-   EnterCriticalSection(&ds->crit);
-   avail = fifo_write_avail(ds->buffer);
-   LeaveCriticalSection(&ds->crit);
-   return avail;
+   return fifo_spsc_write_avail(ds->buffer);
 }
 
 static size_t dsound_buffer_size(void *data)
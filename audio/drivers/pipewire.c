@@ -0,0 +1,449 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <spa/param/audio/format-utils.h>
+#include <pipewire/pipewire.h>
+
+#include <boolean.h>
+#include <queues/fifo_spsc.h>
+#include <rthreads/rthreads.h>
+#include <string/stdstring.h>
+
+#include "../audio_driver.h"
+#include "../../gfx/video_pacing.h"
+#include "../../verbosity.h"
+
+#define PIPEWIRE_CHANNELS   2
+#define PIPEWIRE_FRAME_SIZE (PIPEWIRE_CHANNELS * sizeof(float))
+/* Smallest quantum worth asking the graph for. */
+#define PIPEWIRE_MIN_QUANTUM 64
+/* A blocking write gives up after this long without the graph
+ * pulling anything, e.g. when the sink went away. */
+#define PIPEWIRE_STALL_USEC  100000
+
+#ifndef PW_KEY_TARGET_OBJECT
+#define PW_KEY_TARGET_OBJECT PW_KEY_NODE_TARGET
+#endif
+
+typedef struct
+{
+   struct pw_thread_loop *loop;
+   struct pw_stream *stream;
+
+   /* Written by pipewire_write, read by the process callback on
+    * the graph's data thread; lock only guards the wait for room. */
+   fifo_spsc_t *buffer;
+   slock_t *lock;
+   scond_t *cond;
+
+   /* Set from the main thread and read by the process callback,
+    * a pointer store is atomic on everything PipeWire runs on. */
+   audio_driver_pull_t volatile pull;
+
+   size_t buffer_size;
+   unsigned rate;
+   enum pw_stream_state state;
+   bool nonblock;
+   bool is_paused;
+} pw_t;
+
+static void pipewire_signal(pw_t *pw)
+{
+   /* Signalling under the lock means a writer that saw a full
+    * buffer is either already waiting or will see this read. */
+   slock_lock(pw->lock);
+   scond_signal(pw->cond);
+   slock_unlock(pw->lock);
+}
+
+/* Runs on the graph's data thread, once per quantum. */
+static void pipewire_process(void *data)
+{
+   uint8_t *dst;
+   size_t size, read;
+   struct spa_buffer *buf;
+   pw_t *pw             = (pw_t*)data;
+   audio_driver_pull_t pull;
+   struct pw_buffer *b  = pw_stream_dequeue_buffer(pw->stream);
+
+   if (!b)
+      return;
+
+   buf = b->buffer;
+   dst = (uint8_t*)buf->datas[0].data;
+
+   if (!dst)
+   {
+      pw_stream_queue_buffer(pw->stream, b);
+      return;
+   }
+
+   size  = buf->datas[0].maxsize;
+   size -= size % PIPEWIRE_FRAME_SIZE;
+#if PW_CHECK_VERSION(0, 3, 49)
+   /* Only hand over what this cycle needs, the rest would
+    * just sit in the graph as extra latency. */
+   if (b->requested && b->requested * PIPEWIRE_FRAME_SIZE < size)
+      size = b->requested * PIPEWIRE_FRAME_SIZE;
+#endif
+
+   pull = pw->pull;
+   if (pull)
+      pull(dst, size);
+   else
+   {
+      read = fifo_spsc_read(pw->buffer, dst, size);
+
+      /* If underrun, fill rest with silence. */
+      memset(dst + read, 0, size - read);
+      pipewire_signal(pw);
+   }
+
+   buf->datas[0].chunk->offset = 0;
+   buf->datas[0].chunk->stride = PIPEWIRE_FRAME_SIZE;
+   buf->datas[0].chunk->size   = (uint32_t)size;
+
+   pw_stream_queue_buffer(pw->stream, b);
+}
+
+static void pipewire_state_changed(void *data, enum pw_stream_state old,
+      enum pw_stream_state state, const char *error)
+{
+   pw_t *pw  = (pw_t*)data;
+
+   (void)old;
+
+   pw->state = state;
+   if (state == PW_STREAM_STATE_ERROR)
+      RARCH_ERR("[PipeWire]: Stream error: %s.\n", error ? error : "unknown");
+
+   pw_thread_loop_signal(pw->loop, false);
+}
+
+static void pipewire_param_changed(void *data, uint32_t id,
+      const struct spa_pod *param)
+{
+   struct spa_audio_info_raw info;
+   pw_t *pw = (pw_t*)data;
+
+   if (!param || id != SPA_PARAM_Format)
+      return;
+
+   if (spa_format_audio_raw_parse(param, &info) < 0)
+      return;
+
+   /* The graph resamples for us if this differs from the sink. */
+   RARCH_LOG("[PipeWire]: Negotiated %u Hz, %u channels (asked for %u Hz).\n",
+         info.rate, info.channels, pw->rate);
+}
+
+static const struct pw_stream_events pipewire_stream_events = {
+   PW_VERSION_STREAM_EVENTS,
+   .state_changed = pipewire_state_changed,
+   .param_changed = pipewire_param_changed,
+   .process       = pipewire_process,
+};
+
+/* Queued audio is whatever sits in our ring plus what the graph
+ * reports as still ahead of the DAC. */
+static void pipewire_report_latency(pw_t *pw)
+{
+   struct pw_time time;
+   retro_time_t usec = 0;
+
+   memset(&time, 0, sizeof(time));
+#if PW_CHECK_VERSION(0, 3, 50)
+   if (pw_stream_get_time_n(pw->stream, &time, sizeof(time)) < 0)
+      return;
+#else
+   if (pw_stream_get_time(pw->stream, &time) < 0)
+      return;
+#endif
+
+   if (time.rate.denom && time.delay > 0)
+      usec = (retro_time_t)time.delay * 1000000
+         * time.rate.num / time.rate.denom;
+
+   if (pw->rate)
+      usec += (retro_time_t)(fifo_spsc_read_avail(pw->buffer)
+            / PIPEWIRE_FRAME_SIZE) * 1000000 / pw->rate;
+
+   video_pacing_set_audio_latency(usec);
+}
+
+static void pipewire_free(void *data)
+{
+   pw_t *pw = (pw_t*)data;
+
+   if (!pw)
+      return;
+
+   if (pw->loop)
+      pw_thread_loop_stop(pw->loop);
+
+   if (pw->stream)
+      pw_stream_destroy(pw->stream);
+
+   if (pw->loop)
+      pw_thread_loop_destroy(pw->loop);
+
+   fifo_spsc_free(pw->buffer);
+   slock_free(pw->lock);
+   scond_free(pw->cond);
+   free(pw);
+
+   video_pacing_set_audio_latency(0);
+   pw_deinit();
+}
+
+static void *pipewire_init(const char *device, unsigned rate,
+      unsigned latency,
+      unsigned block_frames,
+      unsigned *new_rate)
+{
+   uint8_t pod[1024];
+   struct spa_audio_info_raw info;
+   const struct spa_pod *params[1];
+   struct pw_properties *props = NULL;
+   struct spa_pod_builder b    = SPA_POD_BUILDER_INIT(pod, sizeof(pod));
+   unsigned quantum            = PIPEWIRE_MIN_QUANTUM;
+   /* Quarter of the latency per cycle, the ring holds the rest. */
+   unsigned target             = rate * latency / 4000;
+   pw_t *pw                    = (pw_t*)calloc(1, sizeof(*pw));
+
+   if (!pw)
+      return NULL;
+
+   pw_init(NULL, NULL);
+
+   if (block_frames)
+      target = block_frames;
+   while (quantum < target)
+      quantum <<= 1;
+
+   pw->rate        = rate;
+   pw->buffer_size = (size_t)rate * latency / 1000 * PIPEWIRE_FRAME_SIZE;
+   if (pw->buffer_size < 2 * quantum * PIPEWIRE_FRAME_SIZE)
+      pw->buffer_size = 2 * quantum * PIPEWIRE_FRAME_SIZE;
+
+   pw->buffer = fifo_spsc_new(pw->buffer_size);
+   pw->lock   = slock_new();
+   pw->cond   = scond_new();
+   if (!pw->buffer || !pw->lock || !pw->cond)
+      goto error;
+
+   pw->loop = pw_thread_loop_new("RetroArch audio", NULL);
+   if (!pw->loop)
+      goto error;
+
+   props = pw_properties_new(
+         PW_KEY_MEDIA_TYPE,     "Audio",
+         PW_KEY_MEDIA_CATEGORY, "Playback",
+         PW_KEY_MEDIA_ROLE,     "Game",
+         PW_KEY_APP_NAME,       "RetroArch",
+         PW_KEY_NODE_NAME,      "RetroArch",
+         NULL);
+   if (!props)
+      goto error;
+
+   /* The graph runs at the smallest quantum any node asks for,
+    * within the limits of its configuration. */
+   pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%u/%u", quantum, rate);
+   if (!string_is_empty(device))
+      pw_properties_set(props, PW_KEY_TARGET_OBJECT, device);
+
+   pw->stream = pw_stream_new_simple(pw_thread_loop_get_loop(pw->loop),
+         "audio", props, &pipewire_stream_events, pw);
+   if (!pw->stream)
+      goto error;
+
+   memset(&info, 0, sizeof(info));
+   info.format      = SPA_AUDIO_FORMAT_F32;
+   info.channels    = PIPEWIRE_CHANNELS;
+   info.rate        = rate;
+   info.position[0] = SPA_AUDIO_CHANNEL_FL;
+   info.position[1] = SPA_AUDIO_CHANNEL_FR;
+   params[0]        = spa_format_audio_raw_build(&b,
+         SPA_PARAM_EnumFormat, &info);
+
+   if (pw_thread_loop_start(pw->loop) < 0)
+      goto error;
+
+   pw_thread_loop_lock(pw->loop);
+
+   if (pw_stream_connect(pw->stream, PW_DIRECTION_OUTPUT, PW_ID_ANY,
+            (enum pw_stream_flags)(PW_STREAM_FLAG_AUTOCONNECT
+            | PW_STREAM_FLAG_MAP_BUFFERS
+            | PW_STREAM_FLAG_RT_PROCESS),
+            params, 1) < 0)
+      goto unlock_error;
+
+   while (     pw->state == PW_STREAM_STATE_UNCONNECTED
+            || pw->state == PW_STREAM_STATE_CONNECTING)
+      pw_thread_loop_wait(pw->loop);
+
+   if (pw->state == PW_STREAM_STATE_ERROR)
+      goto unlock_error;
+
+   pw_thread_loop_unlock(pw->loop);
+
+   RARCH_LOG("[PipeWire]: Requested a %u frame quantum, %u bytes buffer.\n",
+         quantum, (unsigned)pw->buffer_size);
+
+   return pw;
+
+unlock_error:
+   pw_thread_loop_unlock(pw->loop);
+error:
+   RARCH_ERR("[PipeWire]: Failed to initialize...\n");
+   pipewire_free(pw);
+   return NULL;
+}
+
+static ssize_t pipewire_write(void *data, const void *buf_, size_t size)
+{
+   pw_t           *pw = (pw_t*)data;
+   const uint8_t *buf = (const uint8_t*)buf_;
+   size_t     written = 0;
+   unsigned    waited = 0;
+
+   if (pw->state == PW_STREAM_STATE_ERROR)
+      return -1;
+
+   while (size)
+   {
+      size_t write_amt = fifo_spsc_write(pw->buffer, buf, size);
+
+      buf     += write_amt;
+      size    -= write_amt;
+      written += write_amt;
+
+      if (!size || pw->nonblock)
+         break;
+
+      if (write_amt)
+         waited = 0;
+      else if (waited >= PIPEWIRE_STALL_USEC)
+         break;
+
+      slock_lock(pw->lock);
+      if (!fifo_spsc_write_avail(pw->buffer))
+         scond_wait_timeout(pw->cond, pw->lock, 10000);
+      slock_unlock(pw->lock);
+      waited += 10000;
+   }
+
+   pipewire_report_latency(pw);
+
+   return written;
+}
+
+static bool pipewire_set_active(pw_t *pw, bool active)
+{
+   int ret;
+
+   pw_thread_loop_lock(pw->loop);
+   ret = pw_stream_set_active(pw->stream, active);
+   pw_thread_loop_unlock(pw->loop);
+
+   return ret >= 0;
+}
+
+static bool pipewire_stop(void *data)
+{
+   pw_t *pw = (pw_t*)data;
+
+   RARCH_LOG("[PipeWire]: Pausing.\n");
+
+   if (!pipewire_set_active(pw, false))
+      return false;
+   pw->is_paused = true;
+   return true;
+}
+
+static bool pipewire_alive(void *data)
+{
+   pw_t *pw = (pw_t*)data;
+
+   if (!pw)
+      return false;
+   return !pw->is_paused;
+}
+
+static bool pipewire_start(void *data, bool is_shutdown)
+{
+   pw_t *pw = (pw_t*)data;
+
+   RARCH_LOG("[PipeWire]: Unpausing.\n");
+
+   if (!pipewire_set_active(pw, true))
+      return false;
+   pw->is_paused = false;
+   return true;
+}
+
+static void pipewire_set_nonblock_state(void *data, bool state)
+{
+   pw_t *pw = (pw_t*)data;
+   if (pw)
+      pw->nonblock = state;
+}
+
+static bool pipewire_use_float(void *data)
+{
+   (void)data;
+   return true;
+}
+
+static size_t pipewire_write_avail(void *data)
+{
+   pw_t *pw = (pw_t*)data;
+   return fifo_spsc_write_avail(pw->buffer);
+}
+
+static size_t pipewire_buffer_size(void *data)
+{
+   pw_t *pw = (pw_t*)data;
+   return pw->buffer_size;
+}
+
+static bool pipewire_set_pull(void *data, audio_driver_pull_t pull)
+{
+   pw_t *pw = (pw_t*)data;
+   pw->pull = pull;
+   return true;
+}
+
+audio_driver_t audio_pipewire = {
+   pipewire_init,
+   pipewire_write,
+   pipewire_stop,
+   pipewire_start,
+   pipewire_alive,
+   pipewire_set_nonblock_state,
+   pipewire_free,
+   pipewire_use_float,
+   "pipewire",
+   NULL,
+   NULL,
+   pipewire_write_avail,
+   pipewire_buffer_size,
+   pipewire_set_pull,
+};
@@ -31,6 +31,7 @@ typedef struct
    pa_threaded_mainloop *mainloop;
    pa_context *context;
    pa_stream *stream;
+   audio_driver_pull_t pull;
    size_t buffer_size;
    bool nonblock;
    bool success;
@@ -105,13 +106,36 @@ static void stream_state_cb(pa_stream *s, void *data)
    }
 }
 
+/* Pull mode, called with the mainloop locked. */
+static void pulse_pull(pa_t *pa, size_t length)
+{
+   while (length)
+   {
+      void *buf   = NULL;
+      size_t size = length;
+
+      if (pa_stream_begin_write(pa->stream, &buf, &size) < 0
+            || !buf || !size)
+         break;
+
+      if (size > length)
+         size = length;
+
+      pa->pull(buf, size);
+      pa_stream_write(pa->stream, buf, size, NULL, 0, PA_SEEK_RELATIVE);
+      length -= size;
+   }
+}
+
 static void stream_request_cb(pa_stream *s, size_t length, void *data)
 {
    pa_t *pa = (pa_t*)data;
 
-   (void)length;
    (void)s;
 
+   if (pa->pull)
+      pulse_pull(pa, length);
+
    pa_threaded_mainloop_signal(pa->mainloop, 0);
 }
 
@@ -126,15 +150,14 @@ static void stream_latency_update_cb(pa_stream *s, void *data)
 
 static void underrun_update_cb(pa_stream *s, void *data)
 {
-#if 0
    pa_t *pa = (pa_t*)data;
 
    (void)s;
 
-   RARCH_LOG("[PulseAudio]: Underrun (Buffer: %u, Writable size: %u).\n",
+   RARCH_LOG_RATELIMITED(1000000, 5,
+         "[PulseAudio]: Underrun (Buffer: %u, Writable size: %u).\n",
          (unsigned)pa->buffer_size,
          (unsigned)pa_stream_writable_size(pa->stream));
-#endif
 }
 
 static void buffer_attr_cb(pa_stream *s, void *data)
@@ -341,6 +364,21 @@ static size_t pulse_buffer_size(void *data)
    return pa->buffer_size;
 }
 
+static bool pulse_set_pull(void *data, audio_driver_pull_t pull)
+{
+   pa_t *pa = (pa_t*)data;
+
+   pa_threaded_mainloop_lock(pa->mainloop);
+   pa->pull = pull;
+
+   /* Requests made so far won't be repeated. */
+   if (pull)
+      pulse_pull(pa, pa_stream_writable_size(pa->stream));
+   pa_threaded_mainloop_unlock(pa->mainloop);
+
+   return true;
+}
+
 audio_driver_t audio_pulse = {
    pulse_init,
    pulse_write,
@@ -355,4 +393,5 @@ audio_driver_t audio_pulse = {
    NULL,
    pulse_write_avail,
    pulse_buffer_size,
+   pulse_set_pull,
 };
@@ -16,7 +16,7 @@
 
 #include <boolean.h>
 #include <rthreads/rthreads.h>
-#include <queues/fifo_queue.h>
+#include <queues/fifo_spsc.h>
 #include <retro_inline.h>
 #include <retro_math.h>
 
@@ -40,18 +40,21 @@ typedef struct sdl_audio
    slock_t *lock;
    scond_t *cond;
 #endif
-   fifo_buffer_t *buffer;
+   /* Written by sdl_audio_write, read by the SDL callback thread. */
+   fifo_spsc_t *buffer;
 } sdl_audio_t;
 
 static void sdl_audio_cb(void *data, Uint8 *stream, int len)
 {
    sdl_audio_t  *sdl = (sdl_audio_t*)data;
-   size_t      avail = fifo_read_avail(sdl->buffer);
-   size_t write_size = len > (int)avail ? avail : len;
+   size_t write_size = fifo_spsc_read(sdl->buffer, stream, len);
 
-   fifo_read(sdl->buffer, stream, write_size);
 #ifdef HAVE_THREADS
+   /* Signalling under the lock means a writer that saw a full
+    * buffer is either already waiting or will see this read. */
+   slock_lock(sdl->lock);
    scond_signal(sdl->cond);
+   slock_unlock(sdl->lock);
 #endif
 
    /* If underrun, fill rest with silence. */
@@ -125,11 +128,11 @@ static void *sdl_audio_init(const char *device,
    /* Create a buffer twice as big as needed and prefill the buffer. */
    bufsize     = out.samples * 4 * sizeof(int16_t);
    tmp         = calloc(1, bufsize);
-   sdl->buffer = fifo_new(bufsize);
+   sdl->buffer = fifo_spsc_new(bufsize);
 
    if (tmp)
    {
-      fifo_write(sdl->buffer, tmp, bufsize);
+      fifo_spsc_write(sdl->buffer, tmp, bufsize);
       free(tmp);
    }
 
@@ -147,43 +150,27 @@ static ssize_t sdl_audio_write(void *data, const void *buf, size_t size)
    sdl_audio_t *sdl = (sdl_audio_t*)data;
 
    if (sdl->nonblock)
-   {
-      size_t avail, write_amt;
-
-      SDL_LockAudio();
-      avail = fifo_write_avail(sdl->buffer);
-      write_amt = avail > size ? size : avail;
-      fifo_write(sdl->buffer, buf, write_amt);
-      SDL_UnlockAudio();
-      ret = write_amt;
-   }
+      ret = fifo_spsc_write(sdl->buffer, buf, size);
    else
    {
       size_t written = 0;
 
       while (written < size)
       {
-         size_t avail;
-
-         SDL_LockAudio();
-         avail = fifo_write_avail(sdl->buffer);
+         size_t write_amt = fifo_spsc_write(sdl->buffer,
+               (const char*)buf + written, size - written);
 
-         if (avail == 0)
-         {
-            SDL_UnlockAudio();
 #ifdef HAVE_THREADS
+         if (write_amt == 0)
+         {
             slock_lock(sdl->lock);
-            scond_wait(sdl->cond, sdl->lock);
+            if (!fifo_spsc_write_avail(sdl->buffer))
+               scond_wait(sdl->cond, sdl->lock);
             slock_unlock(sdl->lock);
-#endif
-         }
-         else
-         {
-            size_t write_amt = size - written > avail ? avail : size - written;
-            fifo_write(sdl->buffer, (const char*)buf + written, write_amt);
-            SDL_UnlockAudio();
-            written += write_amt;
          }
+#endif
+
+         written += write_amt;
       }
       ret = written;
    }
@@ -232,7 +219,7 @@ static void sdl_audio_free(void *data)
 
    if (sdl)
    {
-      fifo_free(sdl->buffer);
+      fifo_spsc_free(sdl->buffer);
 #ifdef HAVE_THREADS
       slock_free(sdl->lock);
       scond_free(sdl->cond);
@@ -27,7 +27,7 @@
 #include <libtransistor/nx.h>
 #endif
 
-#include <queues/fifo_queue.h>
+#include <queues/fifo_spsc.h>
 #include "../audio_driver.h"
 #include "../../verbosity.h"
 
@@ -45,8 +45,9 @@ static const size_t frame_size = channel_count * sample_size;
 
 typedef struct
 {
-   fifo_buffer_t* fifo;
-   compat_mutex fifoLock;
+   /* Written by switch_thread_audio_write, read by mainLoop;
+    * condLock only guards the wait for room, not the data. */
+   fifo_spsc_t* fifo;
    compat_condvar cond;
    compat_mutex condLock;
 
@@ -107,9 +108,7 @@ static void mainLoop(void* data)
 
       buf_avail = released_out_buffer->buffer_size - released_out_buffer->data_size;
 
-      compat_mutex_lock(&swa->fifoLock);
-
-      avail    = fifo_read_avail(swa->fifo);
+      avail    = fifo_spsc_read_avail(swa->fifo);
       to_write = MIN(avail, buf_avail);
       if (to_write > 0)
       {
@@ -119,11 +118,12 @@ static void mainLoop(void* data)
 #else
 	      base = (uint8_t*) released_out_buffer->sample_data;
 #endif
-         fifo_read(swa->fifo, base + released_out_buffer->data_size, to_write);
+         fifo_spsc_read(swa->fifo, base + released_out_buffer->data_size, to_write);
       }
 
-      compat_mutex_unlock(&swa->fifoLock);
+      compat_mutex_lock(&swa->condLock);
       compat_condvar_wake_all(&swa->cond);
+      compat_mutex_unlock(&swa->condLock);
 
       released_out_buffer->data_size += to_write;
       if (released_out_buffer->data_size >= released_out_buffer->buffer_size / 2)
@@ -239,8 +239,7 @@ static void *switch_thread_audio_init(const char *device, unsigned rate, unsigne
          goto fail_audio_output;
    }
    
-   compat_mutex_create(&swa->fifoLock);
-   swa->fifo = fifo_new(swa->fifoSize);
+   swa->fifo = fifo_spsc_new(swa->fifoSize);
 
    compat_condvar_create(&swa->cond);
 
@@ -321,7 +320,7 @@ static void switch_thread_audio_free(void *data)
 
    if (swa->fifo)
    {
-         fifo_free(swa->fifo);
+         fifo_spsc_free(swa->fifo);
          swa->fifo = NULL;
    }
 
@@ -340,7 +339,7 @@ static void switch_thread_audio_free(void *data)
 
 static ssize_t switch_thread_audio_write(void *data, const void *buf, size_t size)
 {
-   size_t avail, written;
+   size_t written;
    switch_thread_audio_t *swa = (switch_thread_audio_t *)data;
 
    if (!swa || !swa->running)
@@ -348,35 +347,23 @@ static ssize_t switch_thread_audio_write(void *data, const void *buf, size_t siz
 
    if (swa->nonblocking)
    {
-      compat_mutex_lock(&swa->fifoLock);
-      avail = fifo_write_avail(swa->fifo);
-      written = MIN(avail, size);
-      if (written > 0)
-         fifo_write(swa->fifo, buf, written);
-      compat_mutex_unlock(&swa->fifoLock);
+      written = fifo_spsc_write(swa->fifo, buf, size);
    }
    else
    {
       written = 0;
       while (written < size && swa->running)
       {
-         compat_mutex_lock(&swa->fifoLock);
-         avail = fifo_write_avail(swa->fifo);
-         if (avail == 0)
+         size_t write_amt = fifo_spsc_write(swa->fifo,
+               (const char*)buf + written, size - written);
+         if (write_amt == 0)
          {
-            compat_mutex_unlock(&swa->fifoLock);
             compat_mutex_lock(&swa->condLock);
-            if (swa->running)
+            if (swa->running && !fifo_spsc_write_avail(swa->fifo))
                compat_condvar_wait(&swa->cond, &swa->condLock);
             compat_mutex_unlock(&swa->condLock);
          }
-         else
-         {
-            size_t write_amt = MIN(size - written, avail);
-            fifo_write(swa->fifo, (const char*)buf + written, write_amt);
-            compat_mutex_unlock(&swa->fifoLock);
-            written += write_amt;
-         }
+         written += write_amt;
       }
    }
 
@@ -409,14 +396,9 @@ static bool switch_thread_audio_use_float(void *data)
 
 static size_t switch_thread_audio_write_avail(void *data)
 {
-   size_t val;
    switch_thread_audio_t* swa = (switch_thread_audio_t*)data;
 
-   compat_mutex_lock(&swa->fifoLock);
-   val = fifo_write_avail(swa->fifo);
-   compat_mutex_unlock(&swa->fifoLock);
-
-   return val;
+   return fifo_spsc_write_avail(swa->fifo);
 }
 
 size_t switch_thread_audio_buffer_size(void *data)
@@ -18,10 +18,6 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-#ifdef __SSE__
-#include <xmmintrin.h>
-#endif
-
 #include <retro_inline.h>
 #include <retro_miscellaneous.h>
 #include <memalign.h>
@@ -47,6 +43,40 @@
 #define CC_RESAMPLER_PRECISION 1
 #endif
 
+/* SSE and AVX are picked at runtime from the SIMD mask, so build
+ * them even when the rest of the frontend isn't compiled for them
+ * (32-bit x86 builds don't assume SSE). */
+#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
+#define CC_CPU_X86
+#endif
+
+#if defined(CC_CPU_X86) && defined(__GNUC__) && \
+   (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define CC_TARGET_ATTR
+#endif
+
+#if defined(__SSE__)
+#define CC_SSE
+#define CC_SSE_TARGET
+#elif defined(CC_TARGET_ATTR)
+#define CC_SSE
+#define CC_SSE_TARGET __attribute__((target("sse")))
+#endif
+
+#if defined(__AVX__)
+#define CC_AVX
+#define CC_AVX_TARGET
+#elif defined(CC_TARGET_ATTR)
+#define CC_AVX
+#define CC_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+#if defined(CC_AVX)
+#include <immintrin.h>
+#elif defined(CC_SSE)
+#include <xmmintrin.h>
+#endif
+
 typedef struct rarch_CC_resampler
 {
    audio_frame_float_t buffer[4];
@@ -175,10 +205,9 @@ static void *resampler_CC_init(const struct resampler_config *config,
 }
 #else
 
-#if defined(__SSE__)
-#define CC_RESAMPLER_IDENT "SSE"
-
-static void resampler_CC_downsample(void *re_, struct resampler_data *data)
+#if defined(CC_SSE)
+static CC_SSE_TARGET void resampler_CC_downsample_sse(
+      void *re_, struct resampler_data *data)
 {
    rarch_CC_resampler_t *re     = (rarch_CC_resampler_t*)re_;
 
@@ -268,7 +297,8 @@ static void resampler_CC_downsample(void *re_, struct resampler_data *data)
    data->output_frames = outp - (audio_frame_float_t*)data->data_out;
 }
 
-static void resampler_CC_upsample(void *re_, struct resampler_data *data)
+static CC_SSE_TARGET void resampler_CC_upsample_sse(
+      void *re_, struct resampler_data *data)
 {
    rarch_CC_resampler_t *re     = (rarch_CC_resampler_t*)re_;
    audio_frame_float_t *inp     = (audio_frame_float_t*)data->data_in;
@@ -350,33 +380,136 @@ static void resampler_CC_upsample(void *re_, struct resampler_data *data)
 }
 
 
-#elif defined (__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#endif
+
+#if defined(CC_AVX)
+/* Same kernel as the SSE upsampler, but while two output frames fall
+ * within the same four input frames their weights are worked out
+ * together, one in each 128-bit lane. */
+static CC_AVX_TARGET void resampler_CC_upsample_avx(
+      void *re_, struct resampler_data *data)
+{
+   rarch_CC_resampler_t *re     = (rarch_CC_resampler_t*)re_;
+   audio_frame_float_t *inp     = (audio_frame_float_t*)data->data_in;
+   audio_frame_float_t *inp_max = (audio_frame_float_t*)(inp + data->input_frames);
+   audio_frame_float_t *outp    = (audio_frame_float_t*)data->data_out;
+   float b                      = float_min(data->ratio, 1.00); /* cutoff frequency. */
+   float ratio                  = 1.0 / data->ratio;
+   __m128 vec_previous          = _mm_loadu_ps((float*)&re->buffer[0]);
+   __m128 vec_current           = _mm_loadu_ps((float*)&re->buffer[2]);
+   __m256 vec_b                 = _mm256_set1_ps(b);
+   __m256 vec_taps              = _mm256_set_ps(
+         -2.0, -1.0, 0.0, 1.0, -2.0, -1.0, 0.0, 1.0);
+
+   while (inp != inp_max)
+   {
+      __m256 vec_previous2, vec_current2;
+      __m128 vec_in = _mm_loadl_pi(_mm_setzero_ps(),(__m64*)inp);
+      vec_previous =
+         _mm_shuffle_ps(vec_previous,vec_current,_MM_SHUFFLE(1, 0, 3, 2));
+      vec_current  =
+         _mm_shuffle_ps(vec_current,vec_in,_MM_SHUFFLE(1, 0, 3, 2));
+
+      vec_previous2 = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(vec_previous), vec_previous, 1);
+      vec_current2  = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(vec_current), vec_current, 1);
+
+      while (re->distance < 1.0)
+      {
+         __m256 vec_w, vec_w1, vec_w2, vec_w_previous, vec_w_current, vec_out;
+#if (CC_RESAMPLER_PRECISION > 0)
+         __m256 vec_ww1, vec_ww2;
+#endif
+         float next = re->distance + ratio;
+         bool pair  = next < 1.0;
+
+         vec_w  = _mm256_add_ps(_mm256_insertf128_ps(
+                  _mm256_castps128_ps256(_mm_set_ps1(re->distance)),
+                  _mm_set_ps1(next), 1), vec_taps);
+
+         vec_w1 = _mm256_add_ps(vec_w, _mm256_set1_ps(0.5));
+         vec_w2 = _mm256_sub_ps(vec_w, _mm256_set1_ps(0.5));
+
+         vec_w1 = _mm256_mul_ps(vec_w1, vec_b);
+         vec_w2 = _mm256_mul_ps(vec_w2, vec_b);
+
+#if (CC_RESAMPLER_PRECISION > 0)
+         vec_ww1 = _mm256_mul_ps(vec_w1, vec_w1);
+         vec_ww2 = _mm256_mul_ps(vec_w2, vec_w2);
+
+         vec_ww1 = _mm256_mul_ps(vec_ww1,_mm256_sub_ps(_mm256_set1_ps(3.0),vec_ww1));
+         vec_ww2 = _mm256_mul_ps(vec_ww2,_mm256_sub_ps(_mm256_set1_ps(3.0),vec_ww2));
+
+         vec_ww1 = _mm256_mul_ps(_mm256_set1_ps(1.0 / 4.0), vec_ww1);
+         vec_ww2 = _mm256_mul_ps(_mm256_set1_ps(1.0 / 4.0), vec_ww2);
+
+         vec_w1  = _mm256_mul_ps(vec_w1, _mm256_sub_ps(_mm256_set1_ps(1.0), vec_ww1));
+         vec_w2  = _mm256_mul_ps(vec_w2, _mm256_sub_ps(_mm256_set1_ps(1.0), vec_ww2));
+#endif
+
+         vec_w1  = _mm256_min_ps(vec_w1, _mm256_set1_ps( 0.5));
+         vec_w2  = _mm256_min_ps(vec_w2, _mm256_set1_ps( 0.5));
+         vec_w1  = _mm256_max_ps(vec_w1, _mm256_set1_ps(-0.5));
+         vec_w2  = _mm256_max_ps(vec_w2, _mm256_set1_ps(-0.5));
 
-#define CC_RESAMPLER_IDENT "NEON"
+         vec_w   = _mm256_sub_ps(vec_w1, vec_w2);
 
+         /* In-lane shuffles, each lane is one output frame */
+         vec_w_previous = _mm256_shuffle_ps(vec_w,vec_w,_MM_SHUFFLE(1, 1, 0, 0));
+         vec_w_current  = _mm256_shuffle_ps(vec_w,vec_w,_MM_SHUFFLE(3, 3, 2, 2));
+
+         vec_out = _mm256_mul_ps(vec_previous2, vec_w_previous);
+         vec_out = _mm256_add_ps(vec_out, _mm256_mul_ps(vec_current2, vec_w_current));
+         vec_out = _mm256_add_ps(vec_out,
+               _mm256_shuffle_ps(vec_out,vec_out,_MM_SHUFFLE(3, 2, 3, 2)));
+
+         _mm_storel_pi((__m64*)outp, _mm256_castps256_ps128(vec_out));
+         outp++;
+         re->distance = next;
+
+         if (pair)
+         {
+            _mm_storel_pi((__m64*)outp, _mm256_extractf128_ps(vec_out, 1));
+            outp++;
+            re->distance += ratio;
+         }
+      }
+
+      re->distance -= 1.0;
+      inp++;
+   }
+
+   _mm_storeu_ps((float*)&re->buffer[0], vec_previous);
+   _mm_storeu_ps((float*)&re->buffer[2],  vec_current);
+
+   data->output_frames = outp - (audio_frame_float_t*)data->data_out;
+}
+#endif
+
+#if defined (__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
 size_t resampler_CC_downsample_neon(float *outp, const float *inp,
       rarch_CC_resampler_t* re_, size_t input_frames, float ratio);
 size_t resampler_CC_upsample_neon  (float *outp, const float *inp,
       rarch_CC_resampler_t* re_, size_t input_frames, float ratio);
 
-static void resampler_CC_downsample(void *re_, struct resampler_data *data)
+static void resampler_CC_downsample_neon_process(void *re_,
+      struct resampler_data *data)
 {
    data->output_frames = resampler_CC_downsample_neon(
          data->data_out, data->data_in, re_, data->input_frames, data->ratio);
 }
 
-static void resampler_CC_upsample(void *re_, struct resampler_data *data)
+static void resampler_CC_upsample_neon_process(void *re_,
+      struct resampler_data *data)
 {
    data->output_frames = resampler_CC_upsample_neon(
          data->data_out, data->data_in, re_, data->input_frames, data->ratio);
 }
-
-#else
+#endif
 
 /* C reference version. Not optimized. */
 
-#define CC_RESAMPLER_IDENT "C"
-
 #if (CC_RESAMPLER_PRECISION > 4)
 static INLINE float cc_int(float x, float b)
 {
@@ -405,7 +538,7 @@ static INLINE void add_to(const audio_frame_float_t *source,
    target->r += source->r * ratio;
 }
 
-static void resampler_CC_downsample(void *re_, struct resampler_data *data)
+static void resampler_CC_downsample_c(void *re_, struct resampler_data *data)
 {
    rarch_CC_resampler_t *re     = (rarch_CC_resampler_t*)re_;
    audio_frame_float_t *inp     = (audio_frame_float_t*)data->data_in;
@@ -442,7 +575,7 @@ static void resampler_CC_downsample(void *re_, struct resampler_data *data)
    data->output_frames = outp - (audio_frame_float_t*)data->data_out;
 }
 
-static void resampler_CC_upsample(void *re_, struct resampler_data *data)
+static void resampler_CC_upsample_c(void *re_, struct resampler_data *data)
 {
    rarch_CC_resampler_t *re     = (rarch_CC_resampler_t*)re_;
    audio_frame_float_t *inp     = (audio_frame_float_t*)data->data_in;
@@ -483,7 +616,6 @@ static void resampler_CC_upsample(void *re_, struct resampler_data *data)
 
    data->output_frames = outp - (audio_frame_float_t*)data->data_out;
 }
-#endif
 
 static void resampler_CC_process(void *re_, struct resampler_data *data)
 {
@@ -502,11 +634,6 @@ static void *resampler_CC_init(const struct resampler_config *config,
    rarch_CC_resampler_t *re = (rarch_CC_resampler_t*)
       memalign_alloc(32, sizeof(rarch_CC_resampler_t));
 
-   /* TODO: lookup if NEON support can be detected at
-    * runtime and a funcptr set at runtime for either
-    * C codepath or NEON codepath. This will help out
-    * Android. */
-   (void)mask;
    (void)config;
    if (!re)
       return NULL;
@@ -519,14 +646,34 @@ static void *resampler_CC_init(const struct resampler_config *config,
 
    /* Variations of data->ratio around 0.75 are safer
     * than around 1.0 for both up/downsampler. */
+   /* Later checks override earlier ones, so keep them
+    * ordered from slowest to fastest. */
    if (bandwidth_mod < 0.75)
    {
-      re->process = resampler_CC_downsample;
+      re->process = resampler_CC_downsample_c;
+#if defined (__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+      re->process = resampler_CC_downsample_neon_process;
+#endif
+#if defined(CC_SSE)
+      if (mask & RESAMPLER_SIMD_SSE)
+         re->process = resampler_CC_downsample_sse;
+#endif
       re->distance = 0.0;
    }
    else
    {
-      re->process = resampler_CC_upsample;
+      re->process = resampler_CC_upsample_c;
+#if defined (__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+      re->process = resampler_CC_upsample_neon_process;
+#endif
+#if defined(CC_SSE)
+      if (mask & RESAMPLER_SIMD_SSE)
+         re->process = resampler_CC_upsample_sse;
+#endif
+#if defined(CC_AVX)
+      if (mask & RESAMPLER_SIMD_AVX)
+         re->process = resampler_CC_upsample_avx;
+#endif
       re->distance = 2.0;
    }
 
@@ -48,10 +48,60 @@
 #include "../camera_driver.h"
 #include "../../verbosity.h"
 
+/* Cores asking for OpenGL textures get the capture buffers exported as
+ * DMABUFs and imported as external EGLImages, so the YUYV to RGB
+ * conversion happens in the sampler and the frame never goes through
+ * the CPU. Drivers or contexts that can't import fall back to uploading
+ * the CPU converted frame. */
+#if defined(HAVE_EGL) && (defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)) && defined(VIDIOC_EXPBUF)
+#define HAVE_V4L2_GL
+#endif
+
+#ifdef HAVE_V4L2_GL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "../../gfx/common/gl_common.h"
+
+#ifndef GL_TEXTURE_EXTERNAL_OES
+#define GL_TEXTURE_EXTERNAL_OES 0x8D65
+#endif
+
+#ifndef EGL_LINUX_DMA_BUF_EXT
+#define EGL_LINUX_DMA_BUF_EXT          0x3270
+#define EGL_LINUX_DRM_FOURCC_EXT       0x3271
+#define EGL_DMA_BUF_PLANE0_FD_EXT      0x3272
+#define EGL_DMA_BUF_PLANE0_OFFSET_EXT  0x3273
+#define EGL_DMA_BUF_PLANE0_PITCH_EXT   0x3274
+#endif
+
+typedef EGLImageKHR (EGLAPIENTRY *v4l_egl_create_image_t)(EGLDisplay,
+      EGLContext, EGLenum, EGLClientBuffer, const EGLint*);
+typedef EGLBoolean (EGLAPIENTRY *v4l_egl_destroy_image_t)(EGLDisplay,
+      EGLImageKHR);
+typedef void (EGLAPIENTRY *v4l_gl_image_target_texture_t)(GLenum, void*);
+
+enum v4l_gl_mode
+{
+   V4L_GL_NONE = 0,
+   /* Not tried yet, needs the video context current */
+   V4L_GL_PENDING,
+   /* Capture buffers are sampled directly */
+   V4L_GL_DMABUF,
+   /* CPU converted frame uploaded to one texture */
+   V4L_GL_UPLOAD
+};
+#endif
+
 struct buffer
 {
    void *start;
    size_t length;
+#ifdef HAVE_V4L2_GL
+   int dmabuf_fd;
+   EGLImageKHR image;
+   GLuint tex;
+#endif
 };
 
 typedef struct video4linux
@@ -66,6 +116,17 @@ typedef struct video4linux
    struct scaler_ctx scaler;
    uint32_t *buffer_output;
    bool ready;
+   bool raw_output;
+
+#ifdef HAVE_V4L2_GL
+   enum v4l_gl_mode gl_mode;
+   /* Buffer the core's last texture samples from, kept
+    * out of the queue until the next frame replaces it */
+   int held_index;
+   GLuint upload_tex;
+   EGLDisplay egl_display;
+   v4l_egl_destroy_image_t egl_destroy_image;
+#endif
 
    char dev_name[255];
 } video4linux_t;
@@ -139,11 +200,163 @@ static bool init_mmap(void *data)
          RARCH_ERR("[V4L2]: Error - mmap.\n");
          return false;
       }
+
+#ifdef HAVE_V4L2_GL
+      v4l->buffers[v4l->n_buffers].dmabuf_fd = -1;
+
+      if (v4l->gl_mode == V4L_GL_PENDING)
+      {
+         struct v4l2_exportbuffer expbuf = {0};
+
+         expbuf.type  = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+         expbuf.index = v4l->n_buffers;
+         expbuf.flags = O_RDONLY | O_CLOEXEC;
+
+         if (xioctl(v4l->fd, VIDIOC_EXPBUF, &expbuf) == 0)
+            v4l->buffers[v4l->n_buffers].dmabuf_fd = expbuf.fd;
+         else
+         {
+            RARCH_WARN("[V4L2]: %s can't export DMABUFs, uploading frames instead.\n",
+                  v4l->dev_name);
+            v4l->gl_mode = V4L_GL_UPLOAD;
+         }
+      }
+#endif
+   }
+
+   return true;
+}
+
+#ifdef HAVE_V4L2_GL
+static void v4l_gl_release(video4linux_t *v4l)
+{
+   unsigned i;
+   /* Textures can only go away with the context they were made in;
+    * if that is already gone, so are they. */
+   bool current = v4l->egl_display != EGL_NO_DISPLAY
+      && eglGetCurrentDisplay() == v4l->egl_display;
+
+   for (i = 0; i < v4l->n_buffers; i++)
+   {
+      struct buffer *b = &v4l->buffers[i];
+
+      if (b->tex && current)
+         glDeleteTextures(1, &b->tex);
+      if (b->image != EGL_NO_IMAGE_KHR && current && v4l->egl_destroy_image)
+         v4l->egl_destroy_image(v4l->egl_display, b->image);
+
+      b->tex   = 0;
+      b->image = EGL_NO_IMAGE_KHR;
+   }
+
+   if (v4l->upload_tex && current)
+      glDeleteTextures(1, &v4l->upload_tex);
+   v4l->upload_tex = 0;
+}
+
+/* Called from the first poll, when the video driver's context
+ * is current on this thread. */
+static bool v4l_gl_import(video4linux_t *v4l)
+{
+   unsigned i;
+   v4l_egl_create_image_t create_image           = NULL;
+   v4l_gl_image_target_texture_t target_texture  = NULL;
+
+   v4l->egl_display = eglGetCurrentDisplay();
+   if (v4l->egl_display == EGL_NO_DISPLAY)
+      return false;
+
+   create_image           = (v4l_egl_create_image_t)
+      eglGetProcAddress("eglCreateImageKHR");
+   v4l->egl_destroy_image = (v4l_egl_destroy_image_t)
+      eglGetProcAddress("eglDestroyImageKHR");
+   target_texture         = (v4l_gl_image_target_texture_t)
+      eglGetProcAddress("glEGLImageTargetTexture2DOES");
+
+   if (!create_image || !v4l->egl_destroy_image || !target_texture)
+      return false;
+
+   for (i = 0; i < v4l->n_buffers; i++)
+   {
+      struct buffer *b      = &v4l->buffers[i];
+      /* V4L2 and DRM share the YUYV fourcc */
+      const EGLint attribs[] = {
+         EGL_WIDTH,                     (EGLint)v4l->width,
+         EGL_HEIGHT,                    (EGLint)v4l->height,
+         EGL_LINUX_DRM_FOURCC_EXT,      (EGLint)V4L2_PIX_FMT_YUYV,
+         EGL_DMA_BUF_PLANE0_FD_EXT,     b->dmabuf_fd,
+         EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
+         EGL_DMA_BUF_PLANE0_PITCH_EXT,  (EGLint)v4l->pitch,
+         EGL_NONE
+      };
+
+      if (b->dmabuf_fd < 0)
+         return false;
+
+      b->image = create_image(v4l->egl_display, EGL_NO_CONTEXT,
+            EGL_LINUX_DMA_BUF_EXT, (EGLClientBuffer)NULL, attribs);
+      if (b->image == EGL_NO_IMAGE_KHR)
+         return false;
+
+      glGenTextures(1, &b->tex);
+      glBindTexture(GL_TEXTURE_EXTERNAL_OES, b->tex);
+      glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      target_texture(GL_TEXTURE_EXTERNAL_OES, b->image);
+      glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
+
+      if (glGetError() != GL_NO_ERROR)
+         return false;
    }
 
    return true;
 }
 
+static void v4l_gl_init_upload(video4linux_t *v4l)
+{
+   glGenTextures(1, &v4l->upload_tex);
+   glBindTexture(GL_TEXTURE_2D, v4l->upload_tex);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glTexImage2D(GL_TEXTURE_2D, 0, RARCH_GL_INTERNAL_FORMAT32,
+         v4l->width, v4l->height, 0, RARCH_GL_TEXTURE_TYPE32,
+         RARCH_GL_FORMAT32, NULL);
+   glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static void v4l_gl_upload(video4linux_t *v4l)
+{
+   glBindTexture(GL_TEXTURE_2D, v4l->upload_tex);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, v4l->width, v4l->height,
+         RARCH_GL_TEXTURE_TYPE32, RARCH_GL_FORMAT32, v4l->buffer_output);
+   glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static void v4l_gl_setup(video4linux_t *v4l)
+{
+   if (v4l->gl_mode == V4L_GL_PENDING)
+   {
+      if (v4l_gl_import(v4l))
+      {
+         RARCH_LOG("[V4L2]: Sampling capture buffers through DMABUF.\n");
+         v4l->gl_mode = V4L_GL_DMABUF;
+         return;
+      }
+
+      RARCH_WARN("[V4L2]: DMABUF import failed, uploading frames instead.\n");
+      v4l_gl_release(v4l);
+      v4l->gl_mode = V4L_GL_UPLOAD;
+   }
+
+   v4l_gl_init_upload(v4l);
+}
+#endif
+
 static bool init_device(void *data)
 {
    struct v4l2_crop crop;
@@ -231,6 +444,10 @@ static void v4l_stop(void *data)
    if (xioctl(v4l->fd, VIDIOC_STREAMOFF, &type) == -1)
       RARCH_ERR("[V4L2]: Error - VIDIOC_STREAMOFF.\n");
 
+   /* STREAMOFF takes every buffer back, held or not */
+#ifdef HAVE_V4L2_GL
+   v4l->held_index = -1;
+#endif
    v4l->ready = false;
 }
 
@@ -273,9 +490,23 @@ static void v4l_free(void *data)
    video4linux_t *v4l = (video4linux_t*)data;
 
    unsigned i;
+
+#ifdef HAVE_V4L2_GL
+   if (v4l->buffers)
+      v4l_gl_release(v4l);
+#endif
+
    for (i = 0; i < v4l->n_buffers; i++)
+   {
+#ifdef HAVE_V4L2_GL
+      if (v4l->buffers[i].dmabuf_fd >= 0)
+         close(v4l->buffers[i].dmabuf_fd);
+#endif
       if (munmap(v4l->buffers[i].start, v4l->buffers[i].length) == -1)
          RARCH_ERR("[V4L2]: munmap failed.\n");
+   }
+
+   free(v4l->buffers);
 
    if (v4l->fd >= 0)
       close(v4l->fd);
@@ -289,10 +520,22 @@ static void *v4l_init(const char *device, uint64_t caps,
       unsigned width, unsigned height)
 {
    video4linux_t *v4l = NULL;
+   bool raw_output    = (caps &
+         (UINT64_C(1) << RETRO_CAMERA_BUFFER_RAW_FRAMEBUFFER)) != 0;
+   bool gl_output     = (caps &
+         (UINT64_C(1) << RETRO_CAMERA_BUFFER_OPENGL_TEXTURE)) != 0;
+
+#ifndef HAVE_V4L2_GL
+   gl_output          = false;
+#endif
 
-   if ((caps & (UINT64_C(1) << RETRO_CAMERA_BUFFER_RAW_FRAMEBUFFER)) == 0)
+   if (!raw_output && !gl_output)
    {
+#ifdef HAVE_V4L2_GL
+      RARCH_ERR("[V4L2]: Returns raw framebuffers or OpenGL textures.\n");
+#else
       RARCH_ERR("[V4L2]: Returns raw framebuffers.\n");
+#endif
       return NULL;
    }
 
@@ -300,6 +543,14 @@ static void *v4l_init(const char *device, uint64_t caps,
    if (!v4l)
       return NULL;
 
+   v4l->fd         = -1;
+   v4l->raw_output = raw_output;
+#ifdef HAVE_V4L2_GL
+   v4l->gl_mode    = gl_output ? V4L_GL_PENDING : V4L_GL_NONE;
+   v4l->held_index = -1;
+   v4l->egl_display = EGL_NO_DISPLAY;
+#endif
+
    strlcpy(v4l->dev_name, device ? device : "/dev/video0",
          sizeof(v4l->dev_name));
 
@@ -355,16 +606,14 @@ error:
    return NULL;
 }
 
-static bool preprocess_image(void *data)
+static bool preprocess_image(void *data, struct v4l2_buffer *buf)
 {
-   struct scaler_ctx *ctx = NULL;
    video4linux_t     *v4l = (video4linux_t*)data;
-   struct v4l2_buffer buf = {0};
 
-   buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-   buf.memory = V4L2_MEMORY_MMAP;
+   buf->type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+   buf->memory = V4L2_MEMORY_MMAP;
 
-   if (xioctl(v4l->fd, VIDIOC_DQBUF, &buf) == -1)
+   if (xioctl(v4l->fd, VIDIOC_DQBUF, buf) == -1)
    {
       switch (errno)
       {
@@ -378,37 +627,91 @@ static bool preprocess_image(void *data)
       return false;
    }
 
-   retro_assert(buf.index < v4l->n_buffers);
-
-   ctx = &v4l->scaler;
+   retro_assert(buf->index < v4l->n_buffers);
 
-   scaler_ctx_scale_direct(ctx, v4l->buffer_output, (const uint8_t*)v4l->buffers[buf.index].start);
+   return true;
+}
 
-   if (xioctl(v4l->fd, VIDIOC_QBUF, &buf) == -1)
-      RARCH_ERR("[V4L2]: VIDIOC_QBUF\n");
+static void v4l_convert(video4linux_t *v4l, unsigned index)
+{
+   struct scaler_ctx *ctx = &v4l->scaler;
 
-   return true;
+   scaler_ctx_scale_direct(ctx, v4l->buffer_output,
+         (const uint8_t*)v4l->buffers[index].start);
 }
 
 static bool v4l_poll(void *data,
       retro_camera_frame_raw_framebuffer_t frame_raw_cb,
       retro_camera_frame_opengl_texture_t frame_gl_cb)
 {
-   video4linux_t *v4l = (video4linux_t*)data;
+   struct v4l2_buffer buf = {0};
+   bool requeue           = true;
+   bool converted         = false;
+   video4linux_t *v4l     = (video4linux_t*)data;
    if (!v4l->ready)
       return false;
 
-   (void)frame_gl_cb;
+   if (!preprocess_image(data, &buf))
+      return false;
 
-   if (preprocess_image(data))
+#ifdef HAVE_V4L2_GL
+   if (frame_gl_cb && v4l->gl_mode != V4L_GL_NONE)
    {
-      if (frame_raw_cb != NULL)
-         frame_raw_cb(v4l->buffer_output, v4l->width,
-               v4l->height, v4l->width * 4);
-      return true;
+      static const float affine[] = {
+         1.0f, 0.0f, 0.0f,
+         0.0f, 1.0f, 0.0f,
+         0.0f, 0.0f, 1.0f
+      };
+
+      if (v4l->gl_mode == V4L_GL_PENDING)
+         v4l_gl_setup(v4l);
+
+      if (v4l->gl_mode == V4L_GL_DMABUF)
+      {
+         frame_gl_cb(v4l->buffers[buf.index].tex,
+               GL_TEXTURE_EXTERNAL_OES, affine);
+
+         /* The GPU may still be reading the previous frame's buffer
+          * until this one is drawn, so swap which one is held. */
+         if (v4l->held_index >= 0)
+         {
+            struct v4l2_buffer held = {0};
+
+            held.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            held.memory = V4L2_MEMORY_MMAP;
+            held.index  = v4l->held_index;
+
+            if (xioctl(v4l->fd, VIDIOC_QBUF, &held) == -1)
+               RARCH_ERR("[V4L2]: VIDIOC_QBUF\n");
+         }
+
+         v4l->held_index = buf.index;
+         requeue         = false;
+      }
+      else
+      {
+         v4l_convert(v4l, buf.index);
+         converted = true;
+
+         v4l_gl_upload(v4l);
+         frame_gl_cb(v4l->upload_tex, GL_TEXTURE_2D, affine);
+      }
    }
+#endif
 
-   return false;
+   if (frame_raw_cb && v4l->raw_output)
+   {
+      if (!converted)
+         v4l_convert(v4l, buf.index);
+
+      frame_raw_cb(v4l->buffer_output, v4l->width,
+            v4l->height, v4l->width * 4);
+   }
+
+   if (requeue && xioctl(v4l->fd, VIDIOC_QBUF, &buf) == -1)
+      RARCH_ERR("[V4L2]: VIDIOC_QBUF\n");
+
+   return true;
 }
 
 camera_driver_t camera_v4l2 = {
@@ -108,11 +108,44 @@ typedef struct
    int format;
 } cheevos_lboard_t;
 
+enum
+{
+   CHEEVOS_EVENT_AWARD,
+   CHEEVOS_EVENT_LBOARD_START,
+   CHEEVOS_EVENT_LBOARD_SUBMIT,
+   CHEEVOS_EVENT_LBOARD_CANCEL
+};
+
+/* Outcome of testing a frame, acted upon on the main thread. */
+typedef struct
+{
+   int type;
+   int mode;
+   void* target;
+} cheevos_event_t;
+
+/* What to test, captured on the main thread. */
+typedef struct
+{
+   int mode;
+   bool unofficial;
+   bool lboards;
+} cheevos_eval_t;
+
 typedef struct
 {
    retro_task_t* task;
 #ifdef HAVE_THREADS
    slock_t* task_lock;
+
+   /* Tests a snapshot of the previous frame while the core runs. */
+   sthread_t* eval_thread;
+   slock_t* eval_lock;
+   scond_t* eval_cond;
+   cheevos_eval_t eval;
+   bool eval_pending;
+   bool eval_quit;
+   uint8_t* snapshot;
 #endif
 
    bool core_supports;
@@ -124,6 +157,9 @@ typedef struct
 
    cheevos_fixups_t fixups;
 
+   cheevos_event_t* events;
+   unsigned num_events;
+
    char token[32];
 } cheevos_locals_t;
 
@@ -149,6 +185,13 @@ static cheevos_locals_t cheevos_locals =
    NULL, /* task */
 #ifdef HAVE_THREADS
    NULL, /* task_lock */
+   NULL, /* eval_thread */
+   NULL, /* eval_lock */
+   NULL, /* eval_cond */
+   {0},  /* eval */
+   false,/* eval_pending */
+   false,/* eval_quit */
+   NULL, /* snapshot */
 #endif
    true, /* core_supports */
    {0},  /* patchdata */
@@ -156,6 +199,8 @@ static cheevos_locals_t cheevos_locals =
    NULL, /* unofficial */
    NULL, /* lboards */
    {0},  /* fixups */
+   NULL, /* events */
+   0,    /* num_events */
    {0},  /* token */
 };
 
@@ -278,6 +323,106 @@ static const char* cheevos_rc_error(int ret)
    }
 }
 
+typedef bool (*cheevos_operand_visitor_t)(rc_operand_t* operand);
+
+static bool cheevos_visit_condsets(rc_condset_t* condset,
+      cheevos_operand_visitor_t visit)
+{
+   rc_condition_t* cond;
+
+   for (; condset; condset = condset->next)
+   {
+      for (cond = condset->conditions; cond; cond = cond->next)
+      {
+         if (!visit(&cond->operand1) || !visit(&cond->operand2))
+            return false;
+      }
+   }
+
+   return true;
+}
+
+static bool cheevos_visit_trigger(rc_trigger_t* trigger,
+      cheevos_operand_visitor_t visit)
+{
+   return cheevos_visit_condsets(trigger->requirement, visit)
+       && cheevos_visit_condsets(trigger->alternative, visit);
+}
+
+static bool cheevos_visit_value(rc_value_t* value,
+      cheevos_operand_visitor_t visit)
+{
+   rc_expression_t* expr;
+   rc_term_t* term;
+
+   for (expr = value->expressions; expr; expr = expr->next)
+   {
+      for (term = expr->terms; term; term = term->next)
+      {
+         if (!visit(&term->operand1) || !visit(&term->operand2))
+            return false;
+      }
+   }
+
+   return true;
+}
+
+/* Calls visit for every operand of the parsed achievements
+ * and leaderboards, stopping if it returns false. */
+static bool cheevos_visit_operands(cheevos_operand_visitor_t visit)
+{
+   unsigned i;
+
+   for (i = 0; i < cheevos_locals.patchdata.core_count; i++)
+   {
+      if (!cheevos_visit_trigger(cheevos_locals.core[i].trigger, visit))
+         return false;
+   }
+
+   for (i = 0; i < cheevos_locals.patchdata.unofficial_count; i++)
+   {
+      if (!cheevos_visit_trigger(cheevos_locals.unofficial[i].trigger, visit))
+         return false;
+   }
+
+   for (i = 0; i < cheevos_locals.patchdata.lboard_count; i++)
+   {
+      rc_lboard_t* lboard = cheevos_locals.lboards[i].lboard;
+
+      if (   !cheevos_visit_trigger(&lboard->start, visit)
+          || !cheevos_visit_trigger(&lboard->submit, visit)
+          || !cheevos_visit_trigger(&lboard->cancel, visit)
+          || !cheevos_visit_value(&lboard->value, visit)
+          || (lboard->progress && !cheevos_visit_value(lboard->progress, visit)))
+         return false;
+   }
+
+   return true;
+}
+
+static bool cheevos_add_fixup(rc_operand_t* operand)
+{
+   unsigned size = 1;
+
+   if (operand->type != RC_OPERAND_ADDRESS && operand->type != RC_OPERAND_DELTA)
+      return true;
+
+   if (operand->size == RC_OPERAND_16_BITS)
+      size = 2;
+   else if (operand->size == RC_OPERAND_24_BITS || operand->size == RC_OPERAND_32_BITS)
+      size = 4;
+
+   return cheevos_fixup_add(&cheevos_locals.fixups, operand->value, size);
+}
+
+static bool cheevos_index_fixup(rc_operand_t* operand)
+{
+   if (operand->type == RC_OPERAND_ADDRESS || operand->type == RC_OPERAND_DELTA)
+      operand->value = cheevos_fixup_index(&cheevos_locals.fixups, operand->value);
+
+   return true;
+}
+
 static int cheevos_parse(const char* json)
 {
    int res                  = 0;
@@ -399,6 +544,32 @@ static int cheevos_parse(const char* json)
       lboard->format = rc_parse_format(lboard->info->format);
    }
 
+   /* Operands now read memory through the fixups, see cheevos_peek.
+    * Locations are resolved on the main thread by cheevos_test. */
+   if (!cheevos_visit_operands(cheevos_add_fixup))
+   {
+      CHEEVOS_ERR(CHEEVOS_TAG "Error allocating memory for cheevos");
+      goto error;
+   }
+
+   cheevos_fixup_finish(&cheevos_locals.fixups);
+   cheevos_visit_operands(cheevos_index_fixup);
+   cheevos_locals.fixups.dirty = true;
+
+   /* At most one event per achievement, and two per leaderboard */
+   cheevos_locals.num_events = 0;
+   cheevos_locals.events     = (cheevos_event_t*)calloc(
+         cheevos_locals.patchdata.core_count
+       + cheevos_locals.patchdata.unofficial_count
+       + cheevos_locals.patchdata.lboard_count * 2 + 1,
+         sizeof(cheevos_event_t));
+
+   if (!cheevos_locals.events)
+   {
+      CHEEVOS_ERR(CHEEVOS_TAG "Error allocating memory for cheevos");
+      goto error;
+   }
+
    return 0;
 
 error:
@@ -521,12 +692,24 @@ static void cheevos_award(cheevos_cheevo_t* cheevo, int mode)
    }
 }
 
+/* address is an index into the fixups, see cheevos_parse. ud is the
+ * snapshot to read from when testing on the thread, or NULL. */
 static unsigned cheevos_peek(unsigned address, unsigned num_bytes, void* ud)
 {
-   const uint8_t* data = cheevos_fixup_find(&cheevos_locals.fixups,
-      address, cheevos_locals.patchdata.console_id);
+   const uint8_t* data = NULL;
    unsigned value = 0;
 
+   if (address >= cheevos_locals.fixups.count)
+      return 0;
+
+   if (ud)
+      data = (const uint8_t*)ud + address * 4;
+   else
+      data = cheevos_locals.fixups.elements[address].location;
+
+   if (!data)
+      return 0;
+
    switch (num_bytes)
    {
       case 4: value |= data[2] << 16 | data[3] << 24;
@@ -537,16 +720,20 @@ static unsigned cheevos_peek(unsigned address, unsigned num_bytes, void* ud)
    return value;
 }
 
-static void cheevos_test_cheevo_set(bool official)
+static void cheevos_post_event(int type, int mode, void* target)
+{
+   cheevos_event_t* event = cheevos_locals.events + cheevos_locals.num_events++;
+
+   event->type   = type;
+   event->mode   = mode;
+   event->target = target;
+}
+
+static void cheevos_test_cheevo_set(bool official, int mode, uint8_t* snapshot)
 {
-   settings_t *settings = config_get_ptr();
-   int mode = CHEEVOS_ACTIVE_SOFTCORE;
    cheevos_cheevo_t* cheevo;
    int i, count;
 
-   if (settings && settings->bools.cheevos_hardcore_mode_enable && !cheevos_hardcore_paused)
-      mode = CHEEVOS_ACTIVE_HARDCORE;
-
    if (official)
    {
       cheevo = cheevos_locals.core;
@@ -566,12 +753,12 @@ static void cheevos_test_cheevo_set(bool official)
 
       if (cheevo->active & mode)
       {
-         int valid = rc_test_trigger(cheevo->trigger, cheevos_peek, NULL, NULL);
+         int valid = rc_test_trigger(cheevo->trigger, cheevos_peek, snapshot, NULL);
 
          if (cheevo->last)
             rc_reset_trigger(cheevo->trigger);
          else if (valid)
-            cheevos_award(cheevo, mode);
+            cheevos_post_event(CHEEVOS_EVENT_AWARD, mode, cheevo);
 
          cheevo->last = valid;
       }
@@ -648,7 +835,7 @@ static void cheevos_lboard_submit(cheevos_lboard_t* lboard)
    cheevos_lboard_submit_task(NULL, lboard, "no error, first try");
 }
 
-static void cheevos_test_leaderboards(void)
+static void cheevos_test_leaderboards(uint8_t* snapshot)
 {
    cheevos_lboard_t* lboard = cheevos_locals.lboards;
    unsigned	 i;
@@ -658,7 +845,7 @@ static void cheevos_test_leaderboards(void)
    {
       if (lboard->active)
       {
-         value = rc_evaluate_value(&lboard->lboard->value, cheevos_peek, NULL, NULL);
+         value = rc_evaluate_value(&lboard->lboard->value, cheevos_peek, snapshot, NULL);
 
          if (value != lboard->last_value)
          {
@@ -666,20 +853,62 @@ static void cheevos_test_leaderboards(void)
             lboard->last_value = value;
          }
 
-         if (rc_test_trigger(&lboard->lboard->submit, cheevos_peek, NULL, NULL))
+         if (rc_test_trigger(&lboard->lboard->submit, cheevos_peek, snapshot, NULL))
+            cheevos_post_event(CHEEVOS_EVENT_LBOARD_SUBMIT, 0, lboard);
+
+         if (rc_test_trigger(&lboard->lboard->cancel, cheevos_peek, snapshot, NULL))
+            cheevos_post_event(CHEEVOS_EVENT_LBOARD_CANCEL, 0, lboard);
+      }
+      else
+      {
+         if (rc_test_trigger(&lboard->lboard->start, cheevos_peek, snapshot, NULL))
+            cheevos_post_event(CHEEVOS_EVENT_LBOARD_START, 0, lboard);
+      }
+   }
+}
+
+/* Tests one frame, against snapshot if not NULL. Only posts events,
+ * so it can run on the evaluation thread. */
+static void cheevos_evaluate(const cheevos_eval_t* eval, uint8_t* snapshot)
+{
+   cheevos_locals.num_events = 0;
+
+   cheevos_test_cheevo_set(true, eval->mode, snapshot);
+
+   if (eval->unofficial)
+      cheevos_test_cheevo_set(false, eval->mode, snapshot);
+
+   if (eval->lboards)
+      cheevos_test_leaderboards(snapshot);
+}
+
+static void cheevos_process_events(void)
+{
+   unsigned i;
+
+   for (i = 0; i < cheevos_locals.num_events; i++)
+   {
+      const cheevos_event_t* event = cheevos_locals.events + i;
+      cheevos_lboard_t* lboard     = (cheevos_lboard_t*)event->target;
+
+      switch (event->type)
+      {
+         case CHEEVOS_EVENT_AWARD:
+            cheevos_award((cheevos_cheevo_t*)event->target, event->mode);
+            break;
+
+         case CHEEVOS_EVENT_LBOARD_SUBMIT:
             cheevos_lboard_submit(lboard);
+            break;
 
-         if (rc_test_trigger(&lboard->lboard->cancel, cheevos_peek, NULL, NULL))
-         {
+         case CHEEVOS_EVENT_LBOARD_CANCEL:
             CHEEVOS_LOG(CHEEVOS_TAG "Cancel leaderboard %s\n", lboard->info->title);
             lboard->active = 0;
             runloop_msg_queue_push("Leaderboard attempt cancelled!",
                   0, 2 * 60, false);
-         }
-      }
-      else
-      {
-         if (rc_test_trigger(&lboard->lboard->start, cheevos_peek, NULL, NULL))
+            break;
+
+         case CHEEVOS_EVENT_LBOARD_START:
          {
             char buffer[256];
 
@@ -691,16 +920,118 @@ static void cheevos_test_leaderboards(void)
                   "Leaderboard Active: %s", lboard->info->title);
             runloop_msg_queue_push(buffer, 0, 2 * 60, false);
             runloop_msg_queue_push(lboard->info->description, 0, 3 * 60, false);
+            break;
          }
       }
    }
+
+   cheevos_locals.num_events = 0;
+}
+
+#ifdef HAVE_THREADS
+static void cheevos_eval_thread(void* data)
+{
+   performance_trace_thread("cheevos");
+
+   slock_lock(cheevos_locals.eval_lock);
+
+   for (;;)
+   {
+      while (!cheevos_locals.eval_pending && !cheevos_locals.eval_quit)
+         scond_wait(cheevos_locals.eval_cond, cheevos_locals.eval_lock);
+
+      if (cheevos_locals.eval_quit)
+         break;
+
+      slock_unlock(cheevos_locals.eval_lock);
+      cheevos_evaluate(&cheevos_locals.eval, cheevos_locals.snapshot);
+      slock_lock(cheevos_locals.eval_lock);
+
+      cheevos_locals.eval_pending = false;
+      scond_signal(cheevos_locals.eval_cond);
+   }
+
+   slock_unlock(cheevos_locals.eval_lock);
+}
+
+/* Waits for the thread to finish testing the previous frame,
+ * its events are then safe to process. */
+static void cheevos_eval_wait(void)
+{
+   if (!cheevos_locals.eval_thread)
+      return;
+
+   slock_lock(cheevos_locals.eval_lock);
+   while (cheevos_locals.eval_pending)
+      scond_wait(cheevos_locals.eval_cond, cheevos_locals.eval_lock);
+   slock_unlock(cheevos_locals.eval_lock);
+}
+
+static bool cheevos_eval_start(void)
+{
+   cheevos_locals.snapshot = (uint8_t*)calloc(
+         cheevos_locals.fixups.count + 1, 4);
+   cheevos_locals.eval_lock = slock_new();
+   cheevos_locals.eval_cond = scond_new();
+   cheevos_locals.eval_pending = false;
+   cheevos_locals.eval_quit    = false;
+
+   if (   cheevos_locals.snapshot
+       && cheevos_locals.eval_lock
+       && cheevos_locals.eval_cond)
+      cheevos_locals.eval_thread = sthread_create(cheevos_eval_thread, NULL);
+
+   if (!cheevos_locals.eval_thread)
+   {
+      CHEEVOS_ERR(CHEEVOS_TAG "Error starting the evaluation thread\n");
+      CHEEVOS_FREE(cheevos_locals.snapshot);
+      scond_free(cheevos_locals.eval_cond);
+      slock_free(cheevos_locals.eval_lock);
+      cheevos_locals.snapshot  = NULL;
+      cheevos_locals.eval_cond = NULL;
+      cheevos_locals.eval_lock = NULL;
+      return false;
+   }
+
+   CHEEVOS_LOG(CHEEVOS_TAG "Testing achievements on a thread\n");
+   return true;
 }
 
+/* Stops the thread, events of the last frame it tested
+ * are left for the caller. */
+static void cheevos_eval_stop(void)
+{
+   if (!cheevos_locals.eval_thread)
+      return;
+
+   cheevos_eval_wait();
+
+   slock_lock(cheevos_locals.eval_lock);
+   cheevos_locals.eval_quit = true;
+   scond_signal(cheevos_locals.eval_cond);
+   slock_unlock(cheevos_locals.eval_lock);
+
+   sthread_join(cheevos_locals.eval_thread);
+   scond_free(cheevos_locals.eval_cond);
+   slock_free(cheevos_locals.eval_lock);
+   CHEEVOS_FREE(cheevos_locals.snapshot);
+
+   cheevos_locals.eval_thread = NULL;
+   cheevos_locals.eval_cond   = NULL;
+   cheevos_locals.eval_lock   = NULL;
+   cheevos_locals.snapshot    = NULL;
+}
+#endif
+
 void cheevos_reset_game(void)
 {
    cheevos_cheevo_t* cheevo = NULL;
    int i, count;
 
+#ifdef HAVE_THREADS
+   cheevos_eval_wait();
+#endif
+
    cheevo = cheevos_locals.core;
 
    for (i = 0, count = cheevos_locals.patchdata.core_count; i < count; i++, cheevo++)
@@ -901,6 +1232,11 @@ bool cheevos_unload(void)
 
    if (cheevos_loaded)
    {
+#ifdef HAVE_THREADS
+      /* Pending events are dropped with the sets they point to */
+      cheevos_eval_stop();
+#endif
+
       for (i = 0, count = cheevos_locals.patchdata.core_count; i < count; i++)
       {
          CHEEVOS_FREE(cheevos_locals.core[i].trigger);
@@ -919,12 +1255,15 @@ bool cheevos_unload(void)
       CHEEVOS_FREE(cheevos_locals.core);
       CHEEVOS_FREE(cheevos_locals.unofficial);
       CHEEVOS_FREE(cheevos_locals.lboards);
+      CHEEVOS_FREE(cheevos_locals.events);
       cheevos_free_patchdata(&cheevos_locals.patchdata);
       cheevos_fixup_destroy(&cheevos_locals.fixups);
 
       cheevos_locals.core       = NULL;
       cheevos_locals.unofficial = NULL;
       cheevos_locals.lboards    = NULL;
+      cheevos_locals.events     = NULL;
+      cheevos_locals.num_events = 0;
 
       cheevos_loaded            = false;
       cheevos_hardcore_paused   = false;
@@ -972,19 +1311,64 @@ bool cheevos_toggle_hardcore_mode(void)
 void cheevos_test(void)
 {
    settings_t *settings = config_get_ptr();
+   cheevos_eval_t eval;
 
-   cheevos_test_cheevo_set(true);
+   eval.mode       = CHEEVOS_ACTIVE_SOFTCORE;
+   eval.unofficial = false;
+   eval.lboards    = false;
 
    if (settings)
    {
-      if (settings->bools.cheevos_test_unofficial)
-         cheevos_test_cheevo_set(false);
-      
-      if (settings->bools.cheevos_hardcore_mode_enable &&
-          settings->bools.cheevos_leaderboards_enable  &&
-          !cheevos_hardcore_paused)
-         cheevos_test_leaderboards();
+      if (settings->bools.cheevos_hardcore_mode_enable && !cheevos_hardcore_paused)
+         eval.mode = CHEEVOS_ACTIVE_HARDCORE;
+
+      eval.unofficial = settings->bools.cheevos_test_unofficial;
+      eval.lboards    = settings->bools.cheevos_hardcore_mode_enable
+         && settings->bools.cheevos_leaderboards_enable
+         && !cheevos_hardcore_paused;
+   }
+
+#ifdef HAVE_THREADS
+   if (settings && settings->bools.cheevos_threaded)
+   {
+      if (!cheevos_locals.eval_thread && !cheevos_eval_start())
+         configuration_set_bool(settings, settings->bools.cheevos_threaded, false);
+   }
+   else if (cheevos_locals.eval_thread)
+   {
+      cheevos_eval_stop();
+      cheevos_process_events();
+   }
+
+   if (cheevos_locals.eval_thread)
+   {
+      /* Report what the thread found in the previous frame, then
+       * hand it this one. The core doesn't run in between, so
+       * the snapshot is a consistent frame. */
+      cheevos_eval_wait();
+      cheevos_process_events();
+
+      if (cheevos_locals.fixups.dirty)
+         cheevos_fixup_resolve(&cheevos_locals.fixups,
+               cheevos_locals.patchdata.console_id);
+
+      cheevos_fixup_snapshot(&cheevos_locals.fixups, cheevos_locals.snapshot);
+
+      slock_lock(cheevos_locals.eval_lock);
+      cheevos_locals.eval         = eval;
+      cheevos_locals.eval_pending = true;
+      scond_signal(cheevos_locals.eval_cond);
+      slock_unlock(cheevos_locals.eval_lock);
+      return;
    }
+#endif
+
+   if (cheevos_locals.fixups.dirty)
+      cheevos_fixup_resolve(&cheevos_locals.fixups,
+            cheevos_locals.patchdata.console_id);
+
+   cheevos_evaluate(&eval, NULL);
+   cheevos_process_events();
 }
 
 bool cheevos_set_cheats(void)
@@ -1008,6 +1392,11 @@ int cheevos_get_console(void)
    return cheevos_locals.patchdata.console_id;
 }
 
+void cheevos_memory_map_changed(void)
+{
+   cheevos_locals.fixups.dirty = true;
+}
+
 static void cheevos_unlock_cb(unsigned id, void* userdata)
 {
    cheevos_cheevo_t* cheevo = NULL;
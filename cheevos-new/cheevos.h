@@ -64,6 +64,10 @@ bool cheevos_get_support_cheevos(void);
 
 int cheevos_get_console(void);
 
+/* Called when the core sets a new memory map,
+ * addresses get resolved again before the next test. */
+void cheevos_memory_map_changed(void);
+
 extern bool cheevos_loaded;
 extern bool cheevos_hardcore_active;
 extern bool cheevos_hardcore_paused;
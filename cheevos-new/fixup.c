@@ -13,6 +13,8 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "fixup.h"
 #include "cheevos.h"
 #include "util.h"
@@ -77,26 +79,8 @@ void cheevos_fixup_destroy(cheevos_fixups_t* fixups)
    cheevos_fixup_init(fixups);
 }
 
-const uint8_t* cheevos_fixup_find(cheevos_fixups_t* fixups, unsigned address, int console)
+bool cheevos_fixup_add(cheevos_fixups_t* fixups, unsigned address, unsigned size)
 {
-   cheevos_fixup_t key;
-   cheevos_fixup_t* found;
-   const uint8_t* location;
-
-   if (fixups->dirty)
-   {
-      qsort(fixups->elements, fixups->count, sizeof(cheevos_fixup_t), cheevos_cmpaddr);
-      fixups->dirty = false;
-   }
-
-   key.address = address;
-   found = (cheevos_fixup_t*)bsearch(&key, fixups->elements, fixups->count, sizeof(cheevos_fixup_t), cheevos_cmpaddr);
-
-   if (found != NULL)
-   {
-      return found->location;
-   }
-
    if (fixups->count == fixups->capacity)
    {
       unsigned new_capacity = fixups->capacity == 0 ? 16 : fixups->capacity * 2;
@@ -105,7 +89,7 @@ const uint8_t* cheevos_fixup_find(cheevos_fixups_t* fixups, unsigned address, in
 
       if (new_elements == NULL)
       {
-         return NULL;
+         return false;
       }
 
       fixups->elements = new_elements;
@@ -113,11 +97,71 @@ const uint8_t* cheevos_fixup_find(cheevos_fixups_t* fixups, unsigned address, in
    }
 
    fixups->elements[fixups->count].address = address;
-   fixups->elements[fixups->count++].location = location =
-      cheevos_patch_address(address, console);
+   fixups->elements[fixups->count].size = size;
+   fixups->elements[fixups->count++].location = NULL;
    fixups->dirty = true;
 
-   return location;
+   return true;
+}
+
+void cheevos_fixup_finish(cheevos_fixups_t* fixups)
+{
+   unsigned i, count = 0;
+
+   qsort(fixups->elements, fixups->count, sizeof(cheevos_fixup_t), cheevos_cmpaddr);
+
+   for (i = 0; i < fixups->count; i++)
+   {
+      if (count == 0 || fixups->elements[count - 1].address != fixups->elements[i].address)
+      {
+         fixups->elements[count++] = fixups->elements[i];
+      }
+      else if (fixups->elements[count - 1].size < fixups->elements[i].size)
+      {
+         fixups->elements[count - 1].size = fixups->elements[i].size;
+      }
+   }
+
+   fixups->count = count;
+}
+
+unsigned cheevos_fixup_index(const cheevos_fixups_t* fixups, unsigned address)
+{
+   cheevos_fixup_t key;
+   const cheevos_fixup_t* found;
+
+   key.address = address;
+   found = (const cheevos_fixup_t*)bsearch(&key, fixups->elements, fixups->count, sizeof(cheevos_fixup_t), cheevos_cmpaddr);
+
+   /* Out of range indices read as 0 */
+   return found != NULL ? (unsigned)(found - fixups->elements) : fixups->count;
+}
+
+void cheevos_fixup_resolve(cheevos_fixups_t* fixups, int console)
+{
+   unsigned i;
+
+   for (i = 0; i < fixups->count; i++)
+   {
+      fixups->elements[i].location = cheevos_patch_address(fixups->elements[i].address, console);
+   }
+
+   fixups->dirty = false;
+}
+
+void cheevos_fixup_snapshot(const cheevos_fixups_t* fixups, uint8_t* snapshot)
+{
+   unsigned i;
+
+   memset(snapshot, 0, fixups->count * 4);
+
+   for (i = 0; i < fixups->count; i++, snapshot += 4)
+   {
+      if (fixups->elements[i].location != NULL)
+      {
+         memcpy(snapshot, fixups->elements[i].location, fixups->elements[i].size);
+      }
+   }
 }
 
 const uint8_t* cheevos_patch_address(unsigned address, int console)
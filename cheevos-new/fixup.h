@@ -26,20 +26,41 @@ RETRO_BEGIN_DECLS
 typedef struct
 {
    unsigned address;
+   /* Widest read made at address, in bytes */
+   unsigned size;
    const uint8_t* location;
 } cheevos_fixup_t;
 
+/* Every address read by the loaded sets, sorted. Operands are
+ * rewritten to index this table so reading memory while testing
+ * doesn't need any search. */
 typedef struct
 {
    cheevos_fixup_t* elements;
    unsigned capacity, count;
+   /* Locations have to be (re)computed before use */
    bool dirty;
 } cheevos_fixups_t;
 
 void cheevos_fixup_init(cheevos_fixups_t* fixups);
 void cheevos_fixup_destroy(cheevos_fixups_t* fixups);
 
-const uint8_t* cheevos_fixup_find(cheevos_fixups_t* fixups, unsigned address, int console);
+/* Adds an address read size bytes at a time, duplicates are merged
+ * by cheevos_fixup_finish. */
+bool cheevos_fixup_add(cheevos_fixups_t* fixups, unsigned address, unsigned size);
+
+/* Sorts the table once every address has been added. */
+void cheevos_fixup_finish(cheevos_fixups_t* fixups);
+
+/* Index of an added address in the table. */
+unsigned cheevos_fixup_index(const cheevos_fixups_t* fixups, unsigned address);
+
+/* Points every entry at the memory it refers to. */
+void cheevos_fixup_resolve(cheevos_fixups_t* fixups, int console);
+
+/* Copies the memory of entry i to snapshot + i * 4, zeroes where
+ * unresolved. snapshot must hold fixups->count * 4 bytes. */
+void cheevos_fixup_snapshot(const cheevos_fixups_t* fixups, uint8_t* snapshot);
 
 const uint8_t* cheevos_patch_address(unsigned address, int console);
 
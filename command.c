@@ -27,6 +27,10 @@
 #include <streams/file_stream.h>
 #include <streams/stdin_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rjob.h>
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -147,7 +151,7 @@ static struct sockaddr_storage lastcmd_net_source;
 static socklen_t lastcmd_net_source_len;
 #endif
 
-#if defined(HAVE_CHEEVOS) && (defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING))
+#if (defined(HAVE_CHEEVOS) || defined(HAVE_NETWORKING)) && (defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING))
 static void command_reply(const char * data, size_t len)
 {
    switch (lastcmd_source)
@@ -182,6 +186,85 @@ static bool command_version(const char* arg)
    return true;
 }
 
+#ifdef HAVE_NETWORKING
+static bool command_netplay_stats(const char *arg)
+{
+#if defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD)
+   unsigned i;
+   size_t len = 0;
+   char reply[4096];
+   struct netplay_stats stats;
+
+   if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_GET_STATS, &stats))
+   {
+      command_reply("NETPLAY_STATS -1\n", strlen("NETPLAY_STATS -1\n"));
+      return true;
+   }
+
+   len += snprintf(reply + len, sizeof(reply) - len,
+         "NETPLAY_STATS frame=%u latency=%d run_time=%u rollbacks=%llu"
+         " replayed=%llu depths=",
+         (unsigned)stats.frame, stats.input_latency_frames,
+         stats.frame_run_time, (unsigned long long)stats.rollbacks,
+         (unsigned long long)stats.replayed_frames);
+   for (i = 0; i < NETPLAY_STATS_ROLLBACK_DEPTHS && len < sizeof(reply); i++)
+      len += snprintf(reply + len, sizeof(reply) - len, "%s%u",
+            i ? "," : "", (unsigned)stats.rollback_depths[i]);
+
+   /* One line per peer */
+   for (i = 0; i < stats.connection_count && len < sizeof(reply); i++)
+   {
+      const struct netplay_connection_stats *cs = &stats.connections[i];
+      len += snprintf(reply + len, sizeof(reply) - len,
+            "\nPEER %u playing=%d rtt=%u jitter=%u slack=%d slack_avg=%.2f"
+            " nick=%s",
+            (unsigned)cs->client_num, cs->playing ? 1 : 0, cs->rtt,
+            cs->jitter, cs->input_slack, cs->input_slack_avg, cs->nick);
+   }
+
+   if (len >= sizeof(reply) - 1)
+      len = sizeof(reply) - 2;
+   reply[len++] = '\n';
+   command_reply(reply, len);
+#endif
+
+   return true;
+}
+#endif
+
+#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+/* Batched memory reads reply with one binary datagram: a text
+ * header line, then for each range its length as a 32-bit little
+ * endian value, 0 if unmapped, followed by the bytes read. */
+#define COMMAND_MEMORY_MAX_RANGES      64
+#define COMMAND_MEMORY_MAX_REPLY       65000
+#define COMMAND_MEMORY_MAX_SUBSCRIBERS 4
+
+typedef struct command_memory_range
+{
+   size_t address;
+   size_t len;
+} command_memory_range_t;
+
+/* Peer which gets the ranges pushed every interval frames */
+typedef struct command_memory_subscriber
+{
+   struct sockaddr_storage addr;
+   socklen_t addr_len;
+   unsigned interval;
+   unsigned num_ranges;
+   uint64_t last_frame;
+   command_memory_range_t ranges[COMMAND_MEMORY_MAX_RANGES];
+} command_memory_subscriber_t;
+
+static command_memory_subscriber_t
+command_memory_subscribers[COMMAND_MEMORY_MAX_SUBSCRIBERS];
+static char command_memory_reply[COMMAND_MEMORY_MAX_REPLY];
+
+static bool command_read_memory_batch(const char *arg);
+static bool command_subscribe_memory(const char *arg);
+#endif
+
 #if defined(HAVE_CHEEVOS)
 static bool command_read_ram(const char *arg);
 static bool command_write_ram(const char *arg);
@@ -190,6 +273,15 @@ static bool command_write_ram(const char *arg);
 static const struct cmd_action_map action_map[] = {
    { "SET_SHADER",      command_set_shader,  "<shader path>" },
    { "VERSION",         command_version,     "No argument"},
+#ifdef HAVE_NETWORKING
+   { "NETPLAY_STATS",   command_netplay_stats, "No argument" },
+#endif
+#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+   { "READ_CORE_MEMORY_BATCH", command_read_memory_batch,
+      "<address> <number of bytes> [<address> <number of bytes> ...]" },
+   { "SUBSCRIBE_CORE_MEMORY",  command_subscribe_memory,
+      "<frames> <address> <number of bytes> ..., 0 to unsubscribe" },
+#endif
 #if defined(HAVE_CHEEVOS)
    { "READ_CORE_RAM",   command_read_ram,    "<address> <number of bytes>" },
    { "WRITE_CORE_RAM",  command_write_ram,   "<address> <byte1> <byte2> ..." },
@@ -274,6 +366,190 @@ bool command_set_shader(const char *arg)
 }
 
 
+#if defined(HAVE_COMMAND) && defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD)
+/* Parses hexadecimal address and decimal length pairs. */
+static unsigned command_memory_parse_ranges(const char *arg,
+      command_memory_range_t *ranges)
+{
+   unsigned count = 0;
+
+   while (count < COMMAND_MEMORY_MAX_RANGES)
+   {
+      char *end      = NULL;
+      size_t address = strtoul(arg, &end, 16);
+
+      if (end == arg)
+         break;
+      arg                  = end;
+      ranges[count].len    = strtoul(arg, &end, 10);
+      if (end == arg)
+         break;
+      arg                  = end;
+      ranges[count].address = address;
+      count++;
+   }
+
+   return count;
+}
+
+/* Goes through the memory map like httpserver's memoryMap,
+ * cores without one only expose their system RAM. */
+static const uint8_t *command_memory_lookup(size_t address, size_t *len)
+{
+   retro_ctx_memory_info_t mem;
+   rarch_system_info_t *system = runloop_get_system_info();
+
+   if (system && system->mmaps.num_descriptors)
+      return rarch_memory_map_find(&system->mmaps, address, len);
+
+   mem.id = RETRO_MEMORY_SYSTEM_RAM;
+   if (!core_get_memory(&mem) || !mem.data || address >= mem.size)
+      return NULL;
+
+   if (*len > mem.size - address)
+      *len = mem.size - address;
+
+   return (const uint8_t*)mem.data + address;
+}
+
+/* Builds the reply in command_memory_reply, ranges which don't
+ * fit in one datagram anymore get truncated. */
+static size_t command_memory_build_reply(const char *header,
+      const command_memory_range_t *ranges, unsigned count)
+{
+   unsigned i;
+   size_t pos  = strlcpy(command_memory_reply, header,
+         sizeof(command_memory_reply));
+   size_t room = sizeof(command_memory_reply) - pos - 4 * count;
+
+   for (i = 0; i < count; i++)
+   {
+      size_t len          = MIN(ranges[i].len, room);
+      const uint8_t *data = core_is_game_loaded()
+         ? command_memory_lookup(ranges[i].address, &len) : NULL;
+      uint8_t *out        = (uint8_t*)command_memory_reply + pos;
+
+      if (!data)
+         len = 0;
+
+      out[0] = (uint8_t)(len >>  0);
+      out[1] = (uint8_t)(len >>  8);
+      out[2] = (uint8_t)(len >> 16);
+      out[3] = (uint8_t)(len >> 24);
+      if (len)
+         memcpy(out + 4, data, len);
+
+      pos  += 4 + len;
+      room -= len;
+   }
+
+   return pos;
+}
+
+static bool command_read_memory_batch(const char *arg)
+{
+   char header[64];
+   command_memory_range_t ranges[COMMAND_MEMORY_MAX_RANGES];
+   unsigned count = command_memory_parse_ranges(arg, ranges);
+
+   if (!count)
+      return false;
+
+   snprintf(header, sizeof(header), "READ_CORE_MEMORY_BATCH %u\n", count);
+   command_reply(command_memory_reply,
+         command_memory_build_reply(header, ranges, count));
+   return true;
+}
+
+static bool command_subscribe_memory(const char *arg)
+{
+   unsigned i;
+   char reply[64];
+   char *end                        = NULL;
+   unsigned interval                = strtoul(arg, &end, 10);
+   command_memory_subscriber_t *sub = NULL;
+
+   if (end == arg || lastcmd_source != CMD_NETWORK)
+      return false;
+
+   for (i = 0; i < COMMAND_MEMORY_MAX_SUBSCRIBERS; i++)
+   {
+      command_memory_subscriber_t *cur = &command_memory_subscribers[i];
+
+      if (cur->interval
+            && cur->addr_len == lastcmd_net_source_len
+            && !memcmp(&cur->addr, &lastcmd_net_source, cur->addr_len))
+      {
+         sub = cur;
+         break;
+      }
+      if (!sub && !cur->interval)
+         sub = cur;
+   }
+
+   if (!interval)
+   {
+      /* Unsubscribing, sub is either this peer or a free slot */
+      if (sub)
+         sub->interval = 0;
+      command_reply("SUBSCRIBE_CORE_MEMORY 0\n",
+            strlen("SUBSCRIBE_CORE_MEMORY 0\n"));
+      return true;
+   }
+
+   if (!sub)
+   {
+      command_reply("SUBSCRIBE_CORE_MEMORY -1\n",
+            strlen("SUBSCRIBE_CORE_MEMORY -1\n"));
+      return false;
+   }
+
+   sub->num_ranges = command_memory_parse_ranges(end, sub->ranges);
+   if (!sub->num_ranges)
+   {
+      sub->interval = 0;
+      return false;
+   }
+
+   memcpy(&sub->addr, &lastcmd_net_source, lastcmd_net_source_len);
+   sub->addr_len   = lastcmd_net_source_len;
+   sub->interval   = interval;
+   sub->last_frame = 0;
+
+   snprintf(reply, sizeof(reply), "SUBSCRIBE_CORE_MEMORY %u\n",
+         sub->num_ranges);
+   command_reply(reply, strlen(reply));
+   return true;
+}
+
+static void command_memory_push(command_t *handle)
+{
+   unsigned i;
+   uint64_t frame_count = 0;
+   bool is_alive        = false;
+   bool is_focused      = false;
+
+   video_driver_get_status(&frame_count, &is_alive, &is_focused);
+
+   for (i = 0; i < COMMAND_MEMORY_MAX_SUBSCRIBERS; i++)
+   {
+      char header[64];
+      size_t len;
+      command_memory_subscriber_t *sub = &command_memory_subscribers[i];
+
+      if (!sub->interval || frame_count - sub->last_frame < sub->interval)
+         continue;
+
+      sub->last_frame = frame_count;
+      snprintf(header, sizeof(header), "CORE_MEMORY_UPDATE %llu %u\n",
+            (unsigned long long)frame_count, sub->num_ranges);
+      len = command_memory_build_reply(header, sub->ranges, sub->num_ranges);
+      sendto(handle->net_fd, command_memory_reply, len, 0,
+            (struct sockaddr*)&sub->addr, sub->addr_len);
+   }
+}
+#endif
+
 #if defined(HAVE_COMMAND) && defined(HAVE_CHEEVOS)
 #define SMY_CMD_STR "READ_CORE_RAM"
 static bool command_read_ram(const char *arg)
@@ -703,6 +979,8 @@ bool command_poll(command_t *handle)
    memset(handle->state, 0, sizeof(handle->state));
 #if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD) && defined(HAVE_COMMAND)
    command_network_poll(handle);
+   if (handle->net_fd >= 0)
+      command_memory_push(handle);
 #endif
 
 #ifdef HAVE_STDIN_CMD
@@ -735,6 +1013,8 @@ bool command_free(command_t *handle)
 #if defined(HAVE_NETWORKING) && defined(HAVE_NETWORK_CMD) && defined(HAVE_COMMAND)
    if (handle && handle->net_fd >= 0)
       socket_close(handle->net_fd);
+   memset(command_memory_subscribers, 0,
+         sizeof(command_memory_subscribers));
 #endif
 
    free(handle);
@@ -1824,6 +2104,43 @@ void command_playlist_update_write(
    playlist_write_file(playlist);
 }
 
+struct command_history_load
+{
+   const char *path;
+   playlist_t **playlist;
+};
+
+struct command_history_loads
+{
+   struct command_history_load list[5];
+   unsigned size;
+};
+
+static void command_event_load_history(void *data,
+      unsigned begin, unsigned end)
+{
+   unsigned i;
+   struct command_history_loads *loads =
+      (struct command_history_loads*)data;
+   settings_t *settings                = config_get_ptr();
+
+   for (i = begin; i < end; i++)
+      *loads->list[i].playlist = playlist_init(loads->list[i].path,
+            settings->uints.content_history_size);
+}
+
+static void command_event_add_history(
+      struct command_history_loads *loads,
+      const char *path, playlist_t **playlist)
+{
+   RARCH_LOG("%s: [%s].\n",
+         msg_hash_to_str(MSG_LOADING_HISTORY_FILE), path);
+
+   loads->list[loads->size].path     = path;
+   loads->list[loads->size].playlist = playlist;
+   loads->size++;
+}
+
 /**
  * command_event:
  * @cmd                  : Event command index.
@@ -2117,7 +2434,9 @@ TODO: Add a setting for these tweaks */
                if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
 #endif
                {
-                  state_manager_event_init((unsigned)settings->sizes.rewind_buffer_size);
+                  state_manager_event_init(
+                        (unsigned)settings->sizes.rewind_buffer_size,
+                        settings->bools.rewind_threaded);
                }
             }
          }
@@ -2294,51 +2613,43 @@ TODO: Add a setting for these tweaks */
          break;
       case CMD_EVENT_HISTORY_INIT:
          {
+            struct command_history_loads loads;
             settings_t *settings          = config_get_ptr();
-            unsigned content_history_size = settings->uints.content_history_size;
 
             command_event(CMD_EVENT_HISTORY_DEINIT, NULL);
 
             if (!settings->bools.history_list_enable)
                return false;
 
-            RARCH_LOG("%s: [%s].\n",
-                  msg_hash_to_str(MSG_LOADING_HISTORY_FILE),
-                  settings->paths.path_content_history);
-            g_defaults.content_history = playlist_init(
-                  settings->paths.path_content_history,
-                  content_history_size);
+            loads.size = 0;
 
-            RARCH_LOG("%s: [%s].\n",
-                  msg_hash_to_str(MSG_LOADING_HISTORY_FILE),
-                  settings->paths.path_content_favorites);
-            g_defaults.content_favorites = playlist_init(
+            command_event_add_history(&loads,
+                  settings->paths.path_content_history,
+                  &g_defaults.content_history);
+            command_event_add_history(&loads,
                   settings->paths.path_content_favorites,
-                  content_history_size);
-
-            RARCH_LOG("%s: [%s].\n",
-                  msg_hash_to_str(MSG_LOADING_HISTORY_FILE),
-                  settings->paths.path_content_music_history);
-            g_defaults.music_history = playlist_init(
+                  &g_defaults.content_favorites);
+            command_event_add_history(&loads,
                   settings->paths.path_content_music_history,
-                  content_history_size);
-
+                  &g_defaults.music_history);
 #if defined(HAVE_FFMPEG) || defined(HAVE_MPV)
-            RARCH_LOG("%s: [%s].\n",
-                  msg_hash_to_str(MSG_LOADING_HISTORY_FILE),
-                  settings->paths.path_content_video_history);
-            g_defaults.video_history = playlist_init(
+            command_event_add_history(&loads,
                   settings->paths.path_content_video_history,
-                  content_history_size);
+                  &g_defaults.video_history);
 #endif
-
 #ifdef HAVE_IMAGEVIEWER
-            RARCH_LOG("%s: [%s].\n",
-                  msg_hash_to_str(MSG_LOADING_HISTORY_FILE),
-                  settings->paths.path_content_image_history);
-            g_defaults.image_history = playlist_init(
+            command_event_add_history(&loads,
                   settings->paths.path_content_image_history,
-                  content_history_size);
+                  &g_defaults.image_history);
+#endif
+
+            /* The playlists share nothing, each one
+             * is read on a thread of its own */
+#ifdef HAVE_THREADS
+            rjob_parallel_for(loads.size, 1,
+                  command_event_load_history, &loads);
+#else
+            command_event_load_history(&loads, 0, loads.size);
 #endif
          }
          break;
@@ -143,6 +143,10 @@ static const bool load_dummy_on_core_shutdown = false;
 static const bool load_dummy_on_core_shutdown = true;
 #endif
 static const bool check_firmware_before_loading = false;
+/* Keep the last few cores loaded after unloading them, so switching
+ * back skips loading the library. Off since some cores only clean
+ * up properly when they are unloaded. */
+static const bool core_cache_enable = false;
 /* Forcibly disable composition.
  * Only valid on Windows Vista/7/8 for now. */
 static const bool disable_composition = false;
@@ -170,6 +174,11 @@ static const unsigned hard_sync_frames = 0;
  */
 static const unsigned frame_delay = 0;
 
+/* Measures frame and present times and picks the longest
+ * frame delay which doesn't miss VSync, instead of frame_delay.
+ */
+static const bool frame_delay_auto = false;
+
 /* Inserts a black frame inbetween frames.
  * Useful for 120 Hz monitors who want to play 60 Hz material with eliminated
  * ghosting. video_refresh_rate should still be configured as if it
@@ -281,6 +290,9 @@ static bool menu_use_preferred_system_color_theme = true;
 static bool menu_use_preferred_system_color_theme = false;
 #endif
 
+/* Only present menu frames that differ from the one on screen. */
+static bool menu_skip_unchanged_frames   = true;
+
 static bool quick_menu_show_take_screenshot             = true;
 static bool quick_menu_show_save_load_state             = true;
 static bool quick_menu_show_undo_save_load_state        = true;
@@ -455,18 +467,41 @@ static const bool post_filter_record = false;
 /* Screenshots post-shaded GPU output if available. */
 static const bool gpu_screenshot = true;
 
+/* Encode screenshots quickly, at the cost of bigger files. */
+static const bool screenshot_fast_encode = false;
+
 /* Watch shader files for changes and auto-apply as necessary. */
 static const bool video_shader_watch_files = false;
 
+/* Record the passes of multi-pass shaders on several threads.
+ * Only used by the Vulkan driver. */
+static const bool video_shader_parallel_record = false;
+
+/* Lowest scale, in percent, the intermediate passes of a shader
+ * may drop to when they don't fit in the frame time. 100 disables
+ * it. Only used by the Vulkan driver. */
+static const unsigned video_shader_dynamic_scale_min = 100;
+
 /* Screenshots named automatically. */
 static const bool auto_screenshot_filename = true;
 
 /* Record post-shaded GPU output instead of raw game footage if available. */
 static const bool gpu_record = false;
 
+/* Use VA-API/NVENC/QSV/VideoToolbox for H.264/HEVC recording
+ * presets if FFmpeg was built with them. */
+static const bool record_hw_encoder = false;
+
+/* Save a local copy of streams, muxed from the same encode. */
+static const bool stream_record = false;
+
 /* OSD-messages. */
 static const bool font_enable = true;
 
+/* Render OSD text from a signed distance field atlas shared
+ * by every font size (GLSL only). */
+static const bool font_sdf = false;
+
 /* The accurate refresh rate of your monitor (Hz).
  * This is used to calculate audio input rate with the formula:
  * audio_input_rate = game_input_rate * display_refresh_rate /
@@ -524,6 +559,10 @@ static const int out_latency = 64;
 /* Will sync audio. (recommended) */
 static const bool audio_sync = true;
 
+/* Let callback-driven audio drivers pull samples from a ring
+ * buffer instead of blocking on writes. */
+static const bool audio_pull = false;
+
 /* Audio rate control. */
 #if !defined(RARCH_CONSOLE)
 static const bool rate_control = true;
@@ -545,6 +584,12 @@ static const float audio_volume = 0.0;
 /* Default audio volume of the audio mixer in dB. (0.0 dB == unity gain). */
 static const float audio_mixer_volume = 0.0;
 
+#ifdef HAVE_ALSA
+/* Let the ALSA drivers write straight into the mapped device buffer,
+ * where the device or plugin supports it. */
+static const bool alsa_mmap = false;
+#endif
+
 #ifdef HAVE_WASAPI
 /* WASAPI defaults */
 static const bool wasapi_exclusive_mode  = true;
@@ -580,9 +625,28 @@ static const unsigned rewind_buffer_size = 20 << 20; /* 20MiB */
 /* The amount of MB to increase/decrease the rewind_buffer_size when it is changed via the UI. */
 static const unsigned rewind_buffer_size_step = 10; /* 10MB */
 
+/* Compress rewind states on a worker thread, so the
+ * main thread only pays for serializing the core. */
+#ifdef HAVE_THREADS
+static const bool rewind_threaded = true;
+#else
+static const bool rewind_threaded = false;
+#endif
+
 /* How many frames to rewind at a time. */
 static const unsigned rewind_granularity = 1;
 
+/* Number of frames between rewind keyframes. Once the rewind
+ * buffer runs out, rewinding continues one keyframe at a time. */
+static const unsigned rewind_keyframe_interval = 600;
+
+/* The buffer size for rewind keyframes. 0 disables the keyframe history. */
+static const unsigned rewind_keyframe_buffer_size = 0;
+
+/* Number of keyframes to spill to the cache directory
+ * once the keyframe buffer is full. */
+static const unsigned rewind_keyframe_spill_count = 0;
+
 /* Pause gameplay when gameplay loses focus. */
 #ifdef EMSCRIPTEN
 static const bool pause_nonactive = false;
@@ -621,6 +685,9 @@ static const bool netplay_client_swap_input = true;
 
 static const bool netplay_nat_traversal = false;
 
+/* Send input over UDP as well as TCP, with redundancy against packet loss. */
+static const bool netplay_udp_input = false;
+
 static const unsigned netplay_delay_frames = 16;
 
 static const int netplay_check_frames = 600;
@@ -654,6 +721,9 @@ static const bool savestate_auto_load = false;
 
 static const bool savestate_thumbnail_enable = false;
 
+/* Compress savestates when writing them. */
+static const bool savestate_file_compression = false;
+
 /* Slowmotion ratio. */
 static const float slowmotion_ratio = 3.0;
 
@@ -669,6 +739,21 @@ static const unsigned run_ahead_frames = 1;
 /* When using the Run Ahead feature, use a secondary instance of the core. */
 static const bool run_ahead_secondary_instance = true;
 
+/* Run the secondary instance on a worker thread, overlapped with the main one. */
+static const bool run_ahead_secondary_threaded = false;
+
+/* Lower the number of Run Ahead frames while running them all would miss
+ * vsync, and raise it back up to the configured count when there is room. */
+static const bool run_ahead_frames_auto = false;
+
+/* Measure the game's input lag by flipping inputs from a savestate, and
+ * run ahead by that many frames instead of the configured count. */
+static const bool run_ahead_detect_lag = false;
+
+/* When using Run Ahead without a secondary instance, keep the core at the
+ * speculated frames and only roll back when the input changes. */
+static const bool run_ahead_skip_rollback = false;
+
 /* Hide warning messages when using the Run Ahead feature. */
 static const bool run_ahead_hide_warnings = false;
 
@@ -729,6 +814,10 @@ static const unsigned input_max_users = 5;
 
 static const unsigned input_poll_type_behavior = 2;
 
+/* Read joypads on their own thread at 1 kHz rather than
+ * once per frame (drivers that support it). */
+static const bool input_poll_thread = false;
+
 static const unsigned input_bind_timeout = 5;
 
 static const unsigned input_bind_hold = 2;
@@ -27,6 +27,8 @@
 #include <retro_assert.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
+#include <features/features_cpu.h>
+#include <queues/task_queue.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -182,6 +184,7 @@ enum audio_driver_enum
    AUDIO_SDL2,
    AUDIO_XAUDIO,
    AUDIO_PULSE,
+   AUDIO_PIPEWIRE,
    AUDIO_EXT,
    AUDIO_DSOUND,
    AUDIO_WASAPI,
@@ -191,6 +194,7 @@ enum audio_driver_enum
    AUDIO_WII,
    AUDIO_WIIU,
    AUDIO_RWEBAUDIO,
+   AUDIO_AUDIOWORKLET,
    AUDIO_PSP,
    AUDIO_PS2,
    AUDIO_CTR,
@@ -391,6 +395,8 @@ static enum audio_driver_enum AUDIO_DEFAULT_DRIVER = AUDIO_WASAPI;
 static enum audio_driver_enum AUDIO_DEFAULT_DRIVER = AUDIO_AL;
 #elif defined(HAVE_SL)
 static enum audio_driver_enum AUDIO_DEFAULT_DRIVER = AUDIO_SL;
+#elif defined(HAVE_AUDIOWORKLET)
+static enum audio_driver_enum AUDIO_DEFAULT_DRIVER = AUDIO_AUDIOWORKLET;
 #elif defined(EMSCRIPTEN)
 static enum audio_driver_enum AUDIO_DEFAULT_DRIVER = AUDIO_RWEBAUDIO;
 #elif defined(HAVE_SDL)
@@ -596,9 +602,21 @@ static enum menu_driver_enum MENU_DEFAULT_DRIVER = MENU_NULL;
 #define SETTING_OVERRIDE(override_setting) \
    tmp[count-1].override = override_setting
 
+/* Deferred saves wait this long for more changes before writing. */
+#define CONFIG_SAVE_DEBOUNCE_USEC 2000000
+
 struct defaults g_defaults;
 static settings_t *configuration_settings = NULL;
 
+/* The main config as last read or written, so a save only updates
+ * the keys that changed and skips the disk when none did. */
+static config_file_t *config_save_cache             = NULL;
+static char config_save_cache_path[PATH_MAX_LENGTH] = {0};
+static char config_save_pending_path[PATH_MAX_LENGTH] = {0};
+static retro_time_t config_save_deadline            = 0;
+/* A background write owns the cached config until it is done. */
+static bool config_save_writing                     = false;
+
 settings_t *config_get_ptr(void)
 {
    return configuration_settings;
@@ -608,6 +626,12 @@ void config_free(void)
 {
    free(configuration_settings);
    configuration_settings = NULL;
+
+   if (config_save_cache)
+      config_file_free(config_save_cache);
+   config_save_cache         = NULL;
+   config_save_cache_path[0] = '\0';
+   config_save_deadline      = 0;
 }
 
 bool config_init(void)
@@ -662,6 +686,8 @@ const char *config_get_default_audio(void)
          return "xaudio";
       case AUDIO_PULSE:
          return "pulse";
+      case AUDIO_PIPEWIRE:
+         return "pipewire";
       case AUDIO_EXT:
          return "ext";
       case AUDIO_XENON360:
@@ -686,6 +712,8 @@ const char *config_get_default_audio(void)
          return "switch";
       case AUDIO_RWEBAUDIO:
          return "rwebaudio";
+      case AUDIO_AUDIOWORKLET:
+         return "audioworklet";
       case AUDIO_JACK:
          return "jack";
       case AUDIO_NULL:
@@ -1284,6 +1312,8 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("ui_companion_toggle",           &settings->bools.ui_companion_toggle, false, ui_companion_toggle, false);
    SETTING_BOOL("desktop_menu_enable",           &settings->bools.desktop_menu_enable, true, desktop_menu_enable, false);
    SETTING_BOOL("video_gpu_record",              &settings->bools.video_gpu_record, true, gpu_record, false);
+   SETTING_BOOL("video_stream_record",           &settings->bools.video_stream_record, true, stream_record, false);
+   SETTING_BOOL("video_record_hw_encoder",       &settings->bools.video_record_hw_encoder, true, record_hw_encoder, false);
    SETTING_BOOL("input_remap_binds_enable",      &settings->bools.input_remap_binds_enable, true, true, false);
    SETTING_BOOL("all_users_control_menu",        &settings->bools.input_all_users_control_menu, true, all_users_control_menu, false);
    SETTING_BOOL("menu_swap_ok_cancel_buttons",   &settings->bools.input_menu_swap_ok_cancel_buttons, true, menu_swap_ok_cancel_buttons, false);
@@ -1314,26 +1344,41 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
 #endif
    SETTING_BOOL("input_descriptor_label_show",   &settings->bools.input_descriptor_label_show, true, input_descriptor_label_show, false);
    SETTING_BOOL("input_descriptor_hide_unbound", &settings->bools.input_descriptor_hide_unbound, true, input_descriptor_hide_unbound, false);
+#ifdef HAVE_THREADS
+   SETTING_BOOL("input_poll_thread",             &settings->bools.input_poll_thread, true, input_poll_thread, false);
+   SETTING_BOOL("thread_priority_enable",        &settings->bools.thread_priority_enable, true, false, false);
+#endif
    SETTING_BOOL("load_dummy_on_core_shutdown",   &settings->bools.load_dummy_on_core_shutdown, true, load_dummy_on_core_shutdown, false);
+   SETTING_BOOL("core_cache_enable",             &settings->bools.core_cache_enable, true, core_cache_enable, false);
    SETTING_BOOL("check_firmware_before_loading", &settings->bools.check_firmware_before_loading, true, check_firmware_before_loading, false);
    SETTING_BOOL("builtin_mediaplayer_enable",    &settings->bools.multimedia_builtin_mediaplayer_enable, false, false /* TODO */, false);
    SETTING_BOOL("builtin_imageviewer_enable",    &settings->bools.multimedia_builtin_imageviewer_enable, true, true, false);
    SETTING_BOOL("fps_show",                      &settings->bools.video_fps_show, true, false, false);
    SETTING_BOOL("statistics_show",               &settings->bools.video_statistics_show, true, false, false);
+   SETTING_BOOL("perf_overlay_show",             &settings->bools.video_perf_overlay_show, true, false, false);
    SETTING_BOOL("framecount_show",               &settings->bools.video_framecount_show, true, false, false);
    SETTING_BOOL("memory_show",                   &settings->bools.video_memory_show, true, false, false);
    SETTING_BOOL("ui_menubar_enable",             &settings->bools.ui_menubar_enable, true, true, false);
    SETTING_BOOL("suspend_screensaver_enable",    &settings->bools.ui_suspend_screensaver_enable, true, true, false);
    SETTING_BOOL("rewind_enable",                 &settings->bools.rewind_enable, true, rewind_enable, false);
+   SETTING_BOOL("rewind_threaded",               &settings->bools.rewind_threaded, true, rewind_threaded, false);
    SETTING_BOOL("vrr_runloop_enable",            &settings->bools.vrr_runloop_enable, true, vrr_runloop_enable, false);
    SETTING_BOOL("apply_cheats_after_toggle",     &settings->bools.apply_cheats_after_toggle, true, apply_cheats_after_toggle, false);
    SETTING_BOOL("apply_cheats_after_load",       &settings->bools.apply_cheats_after_load, true, apply_cheats_after_load, false);
    SETTING_BOOL("run_ahead_enabled",             &settings->bools.run_ahead_enabled, true, false, false);
    SETTING_BOOL("run_ahead_secondary_instance",  &settings->bools.run_ahead_secondary_instance, true, false, false);
+   SETTING_BOOL("run_ahead_secondary_threaded",  &settings->bools.run_ahead_secondary_threaded, true, run_ahead_secondary_threaded, false);
+   SETTING_BOOL("run_ahead_skip_rollback",       &settings->bools.run_ahead_skip_rollback, true, run_ahead_skip_rollback, false);
+   SETTING_BOOL("run_ahead_frames_auto",         &settings->bools.run_ahead_frames_auto, true, run_ahead_frames_auto, false);
+   SETTING_BOOL("run_ahead_detect_lag",          &settings->bools.run_ahead_detect_lag, true, run_ahead_detect_lag, false);
    SETTING_BOOL("run_ahead_hide_warnings",       &settings->bools.run_ahead_hide_warnings, true, false, false);
    SETTING_BOOL("audio_sync",                    &settings->bools.audio_sync, true, audio_sync, false);
+   SETTING_BOOL("audio_pull",                    &settings->bools.audio_pull, true, audio_pull, false);
    SETTING_BOOL("video_shader_enable",           &settings->bools.video_shader_enable, true, shader_enable, false);
    SETTING_BOOL("video_shader_watch_files",      &settings->bools.video_shader_watch_files, true, video_shader_watch_files, false);
+#ifdef HAVE_VULKAN
+   SETTING_BOOL("video_shader_parallel_record",  &settings->bools.video_shader_parallel_record, true, video_shader_parallel_record, false);
+#endif
 
    /* Let implementation decide if automatic, or 1:1 PAR. */
    SETTING_BOOL("video_aspect_ratio_auto",       &settings->bools.video_aspect_ratio_auto, true, aspect_ratio_auto, false);
@@ -1354,9 +1399,11 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("video_adaptive_vsync",          &settings->bools.video_adaptive_vsync, true, adaptive_vsync, false);
    SETTING_BOOL("video_hard_sync",               &settings->bools.video_hard_sync, true, hard_sync, false);
    SETTING_BOOL("video_black_frame_insertion",   &settings->bools.video_black_frame_insertion, true, black_frame_insertion, false);
+   SETTING_BOOL("video_frame_delay_auto",        &settings->bools.video_frame_delay_auto, true, frame_delay_auto, false);
    SETTING_BOOL("video_disable_composition",     &settings->bools.video_disable_composition, true, disable_composition, false);
    SETTING_BOOL("pause_nonactive",               &settings->bools.pause_nonactive, true, pause_nonactive, false);
    SETTING_BOOL("video_gpu_screenshot",          &settings->bools.video_gpu_screenshot, true, gpu_screenshot, false);
+   SETTING_BOOL("screenshot_fast_encode",        &settings->bools.screenshot_fast_encode, true, screenshot_fast_encode, false);
    SETTING_BOOL("video_post_filter_record",      &settings->bools.video_post_filter_record, true, post_filter_record, false);
    SETTING_BOOL("keyboard_gamepad_enable",       &settings->bools.input_keyboard_gamepad_enable, true, true, false);
    SETTING_BOOL("core_set_supports_no_game_enable", &settings->bools.set_supports_no_game_enable, true, true, false);
@@ -1366,6 +1413,7 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("audio_mixer_mute_enable",       audio_get_bool_ptr(AUDIO_ACTION_MIXER_MUTE_ENABLE), true, false, false);
    SETTING_BOOL("location_allow",                &settings->bools.location_allow, true, false, false);
    SETTING_BOOL("video_font_enable",             &settings->bools.video_font_enable, true, font_enable, false);
+   SETTING_BOOL("video_font_sdf",                &settings->bools.video_font_sdf, true, font_sdf, false);
    SETTING_BOOL("core_updater_auto_extract_archive", &settings->bools.network_buildbot_auto_extract_archive, true, true, false);
    SETTING_BOOL("camera_allow",                  &settings->bools.camera_allow, true, false, false);
    SETTING_BOOL("discord_allow",                  &settings->bools.discord_enable, true, false, false);
@@ -1385,6 +1433,7 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("threaded_data_runloop_enable",  &settings->bools.threaded_data_runloop_enable, true, threaded_data_runloop_enable, false);
 #endif
    SETTING_BOOL("menu_throttle_framerate",       &settings->bools.menu_throttle_framerate, true, true, false);
+   SETTING_BOOL("menu_skip_unchanged_frames",    &settings->bools.menu_skip_unchanged_frames, true, menu_skip_unchanged_frames, false);
    SETTING_BOOL("menu_linear_filter",            &settings->bools.menu_linear_filter, true, true, false);
    SETTING_BOOL("menu_horizontal_animation",     &settings->bools.menu_horizontal_animation, true, true, false);
    SETTING_BOOL("dpi_override_enable",           &settings->bools.menu_dpi_override_enable, true, menu_dpi_override_enable, false);
@@ -1471,6 +1520,7 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("cheevos_leaderboards_enable",  &settings->bools.cheevos_leaderboards_enable, true, false, false);
    SETTING_BOOL("cheevos_verbose_enable",       &settings->bools.cheevos_verbose_enable, true, false, false);
    SETTING_BOOL("cheevos_auto_screenshot",      &settings->bools.cheevos_auto_screenshot, true, false, false);
+   SETTING_BOOL("cheevos_threaded",             &settings->bools.cheevos_threaded, true, false, false);
 #ifdef HAVE_XMB
    SETTING_BOOL("cheevos_badges_enable",        &settings->bools.cheevos_badges_enable, true, false, false);
 #endif
@@ -1490,12 +1540,14 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
 #endif
 #ifdef HAVE_NETWORKING
    SETTING_BOOL("netplay_nat_traversal",        &settings->bools.netplay_nat_traversal, true, true, false);
+   SETTING_BOOL("netplay_udp_input",            &settings->bools.netplay_udp_input, true, netplay_udp_input, false);
 #endif
    SETTING_BOOL("block_sram_overwrite",         &settings->bools.block_sram_overwrite, true, block_sram_overwrite, false);
    SETTING_BOOL("savestate_auto_index",         &settings->bools.savestate_auto_index, true, savestate_auto_index, false);
    SETTING_BOOL("savestate_auto_save",          &settings->bools.savestate_auto_save, true, savestate_auto_save, false);
    SETTING_BOOL("savestate_auto_load",          &settings->bools.savestate_auto_load, true, savestate_auto_load, false);
    SETTING_BOOL("savestate_thumbnail_enable",   &settings->bools.savestate_thumbnail_enable, true, savestate_thumbnail_enable, false);
+   SETTING_BOOL("savestate_file_compression",   &settings->bools.savestate_file_compression, true, savestate_file_compression, false);
    SETTING_BOOL("history_list_enable",          &settings->bools.history_list_enable, true, def_history_list_enable, false);
    SETTING_BOOL("playlist_entry_remove",        &settings->bools.playlist_entry_remove, true, def_playlist_entry_remove, false);
    SETTING_BOOL("playlist_entry_rename",        &settings->bools.playlist_entry_rename, true, def_playlist_entry_rename, false);
@@ -1513,6 +1565,9 @@ static struct config_bool_setting *populate_settings_bool(settings_t *settings,
    SETTING_BOOL("audio_wasapi_exclusive_mode",  &settings->bools.audio_wasapi_exclusive_mode, true, wasapi_exclusive_mode, false);
    SETTING_BOOL("audio_wasapi_float_format",    &settings->bools.audio_wasapi_float_format, true, wasapi_float_format, false);
 #endif
+#ifdef HAVE_ALSA
+   SETTING_BOOL("audio_alsa_mmap",              &settings->bools.audio_alsa_mmap, true, alsa_mmap, false);
+#endif
 
    SETTING_BOOL("savestates_in_content_dir",     &settings->bools.savestates_in_content_dir, true, default_savestates_in_content_dir, false);
    SETTING_BOOL("savefiles_in_content_dir",      &settings->bools.savefiles_in_content_dir, true, default_savefiles_in_content_dir, false);
@@ -1590,6 +1645,8 @@ static struct config_uint_setting *populate_settings_uint(settings_t *settings,
    SETTING_UINT("audio_block_frames",           &settings->uints.audio_block_frames, true, 0, false);
    SETTING_UINT("rewind_granularity",           &settings->uints.rewind_granularity, true, rewind_granularity, false);
    SETTING_UINT("rewind_buffer_size_step",      &settings->uints.rewind_buffer_size_step, true, rewind_buffer_size_step, false);
+   SETTING_UINT("rewind_keyframe_interval",     &settings->uints.rewind_keyframe_interval, true, rewind_keyframe_interval, false);
+   SETTING_UINT("rewind_keyframe_spill_count",  &settings->uints.rewind_keyframe_spill_count, true, rewind_keyframe_spill_count, false);
    SETTING_UINT("autosave_interval",            &settings->uints.autosave_interval,  true, autosave_interval, false);
    SETTING_UINT("libretro_log_level",           &settings->uints.libretro_log_level, true, libretro_log_level, false);
    SETTING_UINT("keyboard_gamepad_mapping_type",&settings->uints.input_keyboard_gamepad_mapping_type, true, 1, false);
@@ -1646,6 +1703,7 @@ static struct config_uint_setting *populate_settings_uint(settings_t *settings,
    SETTING_UINT("custom_viewport_y",            (unsigned*)&settings->video_viewport_custom.y, false, 0 /* TODO */, false);
    SETTING_UINT("content_history_size",         &settings->uints.content_history_size,   true, default_content_history_size, false);
    SETTING_UINT("video_hard_sync_frames",       &settings->uints.video_hard_sync_frames, true, hard_sync_frames, false);
+   SETTING_UINT("video_shader_dynamic_scale_min", &settings->uints.video_shader_dynamic_scale_min, true, video_shader_dynamic_scale_min, false);
    SETTING_UINT("video_frame_delay",            &settings->uints.video_frame_delay,      true, frame_delay, false);
    SETTING_UINT("video_max_swapchain_images",   &settings->uints.video_max_swapchain_images, true, max_swapchain_images, false);
    SETTING_UINT("video_swap_interval",          &settings->uints.video_swap_interval, true, swap_interval, false);
@@ -1685,6 +1743,13 @@ static struct config_uint_setting *populate_settings_uint(settings_t *settings,
 
    SETTING_UINT("video_record_threads",            &settings->uints.video_record_threads,    true, video_record_threads, false);
 
+#ifdef HAVE_THREADS
+   SETTING_UINT("thread_affinity_core",         &settings->uints.thread_affinity_core, true, 0, false);
+   SETTING_UINT("thread_affinity_video",        &settings->uints.thread_affinity_video, true, 0, false);
+   SETTING_UINT("thread_affinity_audio",        &settings->uints.thread_affinity_audio, true, 0, false);
+   SETTING_UINT("thread_affinity_background",   &settings->uints.thread_affinity_background, true, 0, false);
+#endif
+
 #ifdef HAVE_LIBNX
    SETTING_UINT("libnx_overclock",  &settings->uints.libnx_overclock, true, SWITCH_DEFAULT_CPU_PROFILE, false);
 #endif
@@ -1700,6 +1765,7 @@ static struct config_size_setting *populate_settings_size(settings_t *settings,
    struct config_size_setting  *tmp   = (struct config_size_setting*)calloc((*size + 1), sizeof(struct config_size_setting));
 
    SETTING_SIZE("rewind_buffer_size",           &settings->sizes.rewind_buffer_size, true, rewind_buffer_size, false);
+   SETTING_SIZE("rewind_keyframe_buffer_size",  &settings->sizes.rewind_keyframe_buffer_size, true, rewind_keyframe_buffer_size, false);
 
    *size = count;
 
@@ -2650,6 +2716,14 @@ static bool config_load_file(const char *path, bool set_defaults,
 
    tmp_str[0] = '\0';
 
+   /* The file may have been edited since it was cached */
+   if (path && config_save_cache && !config_save_writing
+         && string_is_equal(config_save_cache_path, path))
+   {
+      config_file_free(config_save_cache);
+      config_save_cache = NULL;
+   }
+
    if (path)
    {
       conf = config_file_new(path);
@@ -4138,19 +4212,12 @@ error:
 }
 
 
-/**
- * config_save_file:
- * @path            : Path that shall be written to.
- *
- * Writes a config file to disk.
- *
- * Returns: true (1) on success, otherwise returns false (0).
- **/
-bool config_save_file(const char *path)
+/* Sets every saved setting in @conf, which only ends up modified
+ * if one of them differs from what it already holds. */
+static void config_save_file_fill(config_file_t *conf)
 {
    float msg_color;
    unsigned i                                        = 0;
-   bool ret                                          = false;
    struct config_bool_setting     *bool_settings     = NULL;
    struct config_int_setting     *int_settings       = NULL;
    struct config_uint_setting     *uint_settings     = NULL;
@@ -4158,7 +4225,6 @@ bool config_save_file(const char *path)
    struct config_float_setting     *float_settings   = NULL;
    struct config_array_setting     *array_settings   = NULL;
    struct config_path_setting     *path_settings     = NULL;
-   config_file_t                              *conf  = config_file_new(path);
    settings_t                              *settings = config_get_ptr();
    int bool_settings_size                            = sizeof(settings->bools) / sizeof(settings->bools.placeholder);
    int float_settings_size                           = sizeof(settings->floats)/ sizeof(settings->floats.placeholder);
@@ -4168,16 +4234,6 @@ bool config_save_file(const char *path)
    int array_settings_size                           = sizeof(settings->arrays)/ sizeof(settings->arrays.placeholder);
    int path_settings_size                            = sizeof(settings->paths) / sizeof(settings->paths.placeholder);
 
-   if (!conf)
-      conf = config_file_new(NULL);
-
-   if (!conf || rarch_ctl(RARCH_CTL_IS_OVERRIDES_ACTIVE, NULL))
-   {
-      if (conf)
-         config_file_free(conf);
-      return false;
-   }
-
    bool_settings   = populate_settings_bool  (settings, &bool_settings_size);
    int_settings    = populate_settings_int   (settings, &int_settings_size);
    uint_settings   = populate_settings_uint  (settings, &uint_settings_size);
@@ -4363,13 +4419,199 @@ bool config_save_file(const char *path)
 
    for (i = 0; i < MAX_USERS; i++)
       save_keybinds_user(conf, i);
+}
 
-   ret = config_file_write(conf, path);
-   config_file_free(conf);
+static bool config_save_is_writing(void *data)
+{
+   return config_save_writing;
+}
+
+/* Hands out the cached config for @path, or reads it from disk.
+ * Give it back with config_save_file_keep(). */
+static config_file_t *config_save_file_take(const char *path)
+{
+   config_file_t *conf = NULL;
+
+   /* A background write still owns the cache */
+   if (config_save_writing)
+      task_queue_wait(config_save_is_writing, NULL);
+
+   if (config_save_cache && string_is_equal(config_save_cache_path, path))
+   {
+      conf              = config_save_cache;
+      config_save_cache = NULL;
+      return conf;
+   }
+
+   if (config_save_cache)
+      config_file_free(config_save_cache);
+   config_save_cache = NULL;
+
+   if (!(conf = config_file_new(path)))
+   {
+      /* Nothing on disk yet, an empty config has to be written
+       * even if the settings match it */
+      if ((conf = config_file_new(NULL)))
+         conf->modified = true;
+   }
+
+   return conf;
+}
+
+static void config_save_file_keep(config_file_t *conf, const char *path)
+{
+   if (config_save_cache)
+      config_file_free(config_save_cache);
+   config_save_cache = conf;
+   strlcpy(config_save_cache_path, path, sizeof(config_save_cache_path));
+}
+
+/**
+ * config_save_file:
+ * @path            : Path that shall be written to.
+ *
+ * Writes a config file to disk.
+ *
+ * Returns: true (1) on success, otherwise returns false (0).
+ **/
+bool config_save_file(const char *path)
+{
+   bool ret            = true;
+   config_file_t *conf = NULL;
+
+   if (rarch_ctl(RARCH_CTL_IS_OVERRIDES_ACTIVE, NULL))
+      return false;
+
+   if (!(conf = config_save_file_take(path)))
+      return false;
+
+   /* Anything deferred for this file goes out now */
+   if (string_is_equal(config_save_pending_path, path))
+      config_save_deadline = 0;
+
+   config_save_file_fill(conf);
+
+   if (conf->modified)
+      ret = config_file_write(conf, path);
+
+   config_save_file_keep(conf, path);
 
    return ret;
 }
 
+typedef struct config_save_state
+{
+   config_file_t *conf;
+   char path[PATH_MAX_LENGTH];
+   bool success;
+} config_save_state_t;
+
+static void config_save_file_task_handler(retro_task_t *task)
+{
+   config_save_state_t *state = (config_save_state_t*)task->state;
+
+   state->success = config_file_write(state->conf, state->path);
+   task_set_finished(task, true);
+}
+
+static void config_save_file_task_cb(void *task_data,
+      void *user_data, const char *err)
+{
+   config_save_state_t *state = (config_save_state_t*)user_data;
+
+   config_save_writing = false;
+
+   if (!state->success)
+      RARCH_ERR("%s \"%s\".\n",
+            msg_hash_to_str(MSG_FAILED_SAVING_CONFIG_TO), state->path);
+
+   /* A failed write stays modified and is retried by the next save */
+   if (!config_save_cache)
+      config_save_file_keep(state->conf, state->path);
+   else
+      config_file_free(state->conf);
+
+   free(state);
+}
+
+void config_save_file_deferred(const char *path)
+{
+   if (string_is_empty(path))
+      return;
+
+   /* A different file can't share the pending write */
+   if (config_save_deadline &&
+         !string_is_equal(config_save_pending_path, path))
+      config_save_file_flush();
+
+   strlcpy(config_save_pending_path, path, sizeof(config_save_pending_path));
+   config_save_deadline = cpu_features_get_time_usec()
+      + CONFIG_SAVE_DEBOUNCE_USEC;
+}
+
+void config_save_file_iterate(void)
+{
+   retro_task_t *task         = NULL;
+   config_save_state_t *state = NULL;
+   config_file_t *conf        = NULL;
+
+   if (     !config_save_deadline
+         || config_save_writing
+         || cpu_features_get_time_usec() < config_save_deadline)
+      return;
+
+   config_save_deadline = 0;
+
+   if (rarch_ctl(RARCH_CTL_IS_OVERRIDES_ACTIVE, NULL))
+      return;
+
+   /* Reading the settings has to happen here on the main thread,
+    * only the write goes to the background */
+   if (!(conf = config_save_file_take(config_save_pending_path)))
+      return;
+
+   config_save_file_fill(conf);
+
+   if (!conf->modified)
+   {
+      config_save_file_keep(conf, config_save_pending_path);
+      return;
+   }
+
+   task  = (retro_task_t*)calloc(1, sizeof(*task));
+   state = (config_save_state_t*)calloc(1, sizeof(*state));
+
+   if (!task || !state)
+   {
+      free(task);
+      free(state);
+      config_file_write(conf, config_save_pending_path);
+      config_save_file_keep(conf, config_save_pending_path);
+      return;
+   }
+
+   state->conf = conf;
+   strlcpy(state->path, config_save_pending_path, sizeof(state->path));
+
+   task->type     = TASK_TYPE_NONE;
+   task->state     = state;
+   task->user_data = state;
+   task->handler   = config_save_file_task_handler;
+   task->callback  = config_save_file_task_cb;
+   task->mute     = true;
+
+   config_save_writing = true;
+   task_queue_push(task);
+}
+
+void config_save_file_flush(void)
+{
+   if (config_save_deadline)
+      config_save_file(config_save_pending_path);
+   else if (config_save_writing)
+      task_queue_wait(config_save_is_writing, NULL);
+}
+
 /**
  * config_save_overrides:
  * @path            : Path that shall be written to.
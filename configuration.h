@@ -83,6 +83,7 @@ typedef struct settings
       bool video_adaptive_vsync;
       bool video_hard_sync;
       bool video_black_frame_insertion;
+      bool video_frame_delay_auto;
       bool video_vfilter;
       bool video_smooth;
       bool video_force_aspect;
@@ -91,17 +92,23 @@ typedef struct settings
       bool video_scale_integer;
       bool video_shader_enable;
       bool video_shader_watch_files;
+      bool video_shader_parallel_record;
       bool video_threaded;
       bool video_font_enable;
+      bool video_font_sdf;
       bool video_disable_composition;
       bool video_post_filter_record;
       bool video_gpu_record;
+      bool video_stream_record;
+      bool video_record_hw_encoder;
       bool video_gpu_screenshot;
+      bool screenshot_fast_encode;
       bool video_allow_rotate;
       bool video_shared_context;
       bool video_force_srgb_disable;
       bool video_fps_show;
       bool video_statistics_show;
+      bool video_perf_overlay_show;
       bool video_framecount_show;
       bool video_memory_show;
       bool video_msg_bgcolor_enable;
@@ -111,9 +118,11 @@ typedef struct settings
       bool audio_enable;
       bool audio_enable_menu;
       bool audio_sync;
+      bool audio_pull;
       bool audio_rate_control;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
+      bool audio_alsa_mmap;
 
       /* Input */
       bool input_remap_binds_enable;
@@ -124,6 +133,7 @@ typedef struct settings
       bool input_overlay_show_physical_inputs;
       bool input_descriptor_label_show;
       bool input_descriptor_hide_unbound;
+      bool input_poll_thread;
       bool input_all_users_control_menu;
       bool input_menu_swap_ok_cancel_buttons;
       bool input_backtouch_enable;
@@ -147,6 +157,7 @@ typedef struct settings
       bool menu_dpi_override_enable;
       bool menu_show_advanced_settings;
       bool menu_throttle_framerate;
+      bool menu_skip_unchanged_frames;
       bool menu_linear_filter;
       bool menu_horizontal_animation;
       bool menu_show_online_updater;
@@ -208,6 +219,7 @@ typedef struct settings
       bool netplay_require_slaves;
       bool netplay_stateless_mode;
       bool netplay_nat_traversal;
+      bool netplay_udp_input;
       bool netplay_use_mitm_server;
       bool netplay_request_devices[MAX_USERS];
 
@@ -230,6 +242,7 @@ typedef struct settings
       bool cheevos_badges_enable;
       bool cheevos_verbose_enable;
       bool cheevos_auto_screenshot;
+      bool cheevos_threaded;
 
       /* Camera */
       bool camera_allow;
@@ -251,17 +264,23 @@ typedef struct settings
       /* Misc. */
       bool discord_enable;
       bool threaded_data_runloop_enable;
+      bool thread_priority_enable;
       bool set_supports_no_game_enable;
       bool auto_screenshot_filename;
       bool history_list_enable;
       bool playlist_entry_remove;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_threaded;
       bool vrr_runloop_enable;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_secondary_threaded;
+      bool run_ahead_skip_rollback;
+      bool run_ahead_frames_auto;
+      bool run_ahead_detect_lag;
       bool run_ahead_hide_warnings;
       bool pause_nonactive;
       bool block_sram_overwrite;
@@ -269,6 +288,7 @@ typedef struct settings
       bool savestate_auto_save;
       bool savestate_auto_load;
       bool savestate_thumbnail_enable;
+      bool savestate_file_compression;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
       bool keymapper_enable;
@@ -276,6 +296,7 @@ typedef struct settings
       bool network_remote_enable_user[MAX_USERS];
       bool load_dummy_on_core_shutdown;
       bool check_firmware_before_loading;
+      bool core_cache_enable;
 
       bool game_specific_options;
       bool auto_overrides_enable;
@@ -373,6 +394,8 @@ typedef struct settings
       unsigned libretro_log_level;
       unsigned rewind_granularity;
       unsigned rewind_buffer_size_step;
+      unsigned rewind_keyframe_interval;
+      unsigned rewind_keyframe_spill_count;
       unsigned autosave_interval;
       unsigned network_cmd_port;
       unsigned network_remote_base_port;
@@ -386,6 +409,7 @@ typedef struct settings
       unsigned video_max_swapchain_images;
       unsigned video_swap_interval;
       unsigned video_hard_sync_frames;
+      unsigned video_shader_dynamic_scale_min;
       unsigned video_frame_delay;
       unsigned video_viwidth;
       unsigned video_aspect_ratio_idx;
@@ -450,6 +474,11 @@ typedef struct settings
 
       unsigned video_record_threads;
 
+      unsigned thread_affinity_core;
+      unsigned thread_affinity_video;
+      unsigned thread_affinity_audio;
+      unsigned thread_affinity_background;
+
       unsigned libnx_overclock;
    } uints;
 
@@ -457,6 +486,7 @@ typedef struct settings
    {
       size_t placeholder;
       size_t rewind_buffer_size;
+      size_t rewind_keyframe_buffer_size;
    } sizes;
 
    struct
@@ -715,12 +745,31 @@ bool config_save_autoconf_profile(const char *path, unsigned user);
  * config_save_file:
  * @path            : Path that shall be written to.
  *
- * Writes a config file to disk.
+ * Writes a config file to disk. Only the settings which changed
+ * since the last save are updated, and the file isn't touched at
+ * all if none did.
  *
  * Returns: true (1) on success, otherwise returns false (0).
  **/
 bool config_save_file(const char *path);
 
+/**
+ * config_save_file_deferred:
+ * @path            : Path that shall be written to.
+ *
+ * Like config_save_file(), but waits for a couple of seconds
+ * without further calls and then writes from a background task,
+ * for saves nobody waits on.
+ **/
+void config_save_file_deferred(const char *path);
+
+/* Starts a deferred save once it is due, called every frame. */
+void config_save_file_iterate(void);
+
+/* Writes out any deferred save right away and waits for
+ * background writes to finish. */
+void config_save_file_flush(void);
+
 /**
  * config_save_overrides:
  * @path            : Path that shall be written to.
@@ -241,6 +241,34 @@ bool core_is_inited(void);
 
 bool core_is_game_loaded(void);
 
+/**
+ * rarch_memory_map_get:
+ * @mmaps               : memory map set by the core.
+ * @id                  : descriptor index.
+ * @start               : offset into the descriptor.
+ * @len                 : bytes wanted, clamped to what the
+ *                        descriptor holds past @start.
+ *
+ * Returns: pointer to the memory, or NULL if @id or @start
+ * is out of range or the descriptor isn't backed by memory.
+ **/
+uint8_t *rarch_memory_map_get(const rarch_memory_map_t *mmaps,
+      unsigned id, size_t start, size_t *len);
+
+/**
+ * rarch_memory_map_find:
+ * @mmaps               : memory map set by the core.
+ * @address             : address in the emulated system.
+ * @len                 : bytes wanted, clamped to the end of
+ *                        the descriptor mapping @address.
+ *
+ * Resolves @address like the core would, mirrors included.
+ *
+ * Returns: pointer to the memory, or NULL if unmapped.
+ **/
+uint8_t *rarch_memory_map_find(const rarch_memory_map_t *mmaps,
+      size_t address, size_t *len);
+
 extern struct retro_callbacks retro_ctx;
 
 RETRO_END_DECLS
@@ -41,6 +41,7 @@
 #include "msg_hash.h"
 #include "managers/state_manager.h"
 #include "verbosity.h"
+#include "performance_counters.h"
 #include "gfx/video_driver.h"
 #include "audio/audio_driver.h"
 #include "tasks/tasks_internal.h"
@@ -422,6 +423,8 @@ bool core_unload_game(void)
 
 bool core_run(void)
 {
+   performance_zone_begin(PERF_ZONE_CORE_RUN);
+
 #ifdef HAVE_NETWORKING
    if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_PRE_FRAME, NULL))
    {
@@ -429,6 +432,7 @@ bool core_run(void)
        * netplay peer pausing doesn't just hang. */
       input_poll();
       video_driver_cached_frame();
+      performance_zone_end(PERF_ZONE_CORE_RUN);
       return true;
    }
 #endif
@@ -454,6 +458,8 @@ bool core_run(void)
    netplay_driver_ctl(RARCH_NETPLAY_CTL_POST_FRAME, NULL);
 #endif
 
+   performance_zone_end(PERF_ZONE_CORE_RUN);
+
    return true;
 }
 
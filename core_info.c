@@ -78,61 +78,480 @@ static void core_info_list_resolve_all_extensions(
 #endif
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
+#define CORE_INFO_CACHE_FILE   "core_info.cache"
+#define CORE_INFO_CACHE_HEADER "#core_info_cache 1"
+
+#define CORE_INFO_CACHE_SUPPORTS_NO_GAME              (1 << 0)
+#define CORE_INFO_CACHE_DATABASE_MATCH_ARCHIVE_MEMBER (1 << 1)
+
+/* The string keys of a .info file that the list needs,
+ * in the order they're stored in the cache. */
+enum core_info_field
+{
+   CORE_INFO_FIELD_DISPLAY_NAME = 0,
+   CORE_INFO_FIELD_DISPLAY_VERSION,
+   CORE_INFO_FIELD_CORE_NAME,
+   CORE_INFO_FIELD_SYSTEM_NAME,
+   CORE_INFO_FIELD_SYSTEM_ID,
+   CORE_INFO_FIELD_MANUFACTURER,
+   CORE_INFO_FIELD_SUPPORTED_EXTENSIONS,
+   CORE_INFO_FIELD_AUTHORS,
+   CORE_INFO_FIELD_PERMISSIONS,
+   CORE_INFO_FIELD_LICENSES,
+   CORE_INFO_FIELD_CATEGORIES,
+   CORE_INFO_FIELD_DATABASES,
+   CORE_INFO_FIELD_NOTES,
+   CORE_INFO_FIELD_LAST
+};
+
+static const char *core_info_field_keys[CORE_INFO_FIELD_LAST] = {
+   "display_name",
+   "display_version",
+   "corename",
+   "systemname",
+   "systemid",
+   "manufacturer",
+   "supported_extensions",
+   "authors",
+   "permissions",
+   "license",
+   "categories",
+   "database",
+   "notes"
+};
+
+/* What core_info_list_new() read from a .info file the last
+ * time its size and modification time were these. */
+typedef struct core_info_cache_entry
+{
+   int32_t size;
+   int64_t mtime;
+   unsigned flags;
+   size_t firmware_count;
+   char *name;
+   char *fields[CORE_INFO_FIELD_LAST];
+   core_info_firmware_t *firmware;
+} core_info_cache_entry_t;
+
+typedef struct core_info_cache
+{
+   size_t count;
+   core_info_cache_entry_t *entries;
+} core_info_cache_t;
+
+static char **core_info_field_ptr(core_info_t *info, unsigned field)
+{
+   switch (field)
+   {
+      case CORE_INFO_FIELD_DISPLAY_NAME:
+         return &info->display_name;
+      case CORE_INFO_FIELD_DISPLAY_VERSION:
+         return &info->display_version;
+      case CORE_INFO_FIELD_CORE_NAME:
+         return &info->core_name;
+      case CORE_INFO_FIELD_SYSTEM_NAME:
+         return &info->systemname;
+      case CORE_INFO_FIELD_SYSTEM_ID:
+         return &info->system_id;
+      case CORE_INFO_FIELD_MANUFACTURER:
+         return &info->system_manufacturer;
+      case CORE_INFO_FIELD_SUPPORTED_EXTENSIONS:
+         return &info->supported_extensions;
+      case CORE_INFO_FIELD_AUTHORS:
+         return &info->authors;
+      case CORE_INFO_FIELD_PERMISSIONS:
+         return &info->permissions;
+      case CORE_INFO_FIELD_LICENSES:
+         return &info->licenses;
+      case CORE_INFO_FIELD_CATEGORIES:
+         return &info->categories;
+      case CORE_INFO_FIELD_DATABASES:
+         return &info->databases;
+      case CORE_INFO_FIELD_NOTES:
+         return &info->notes;
+      default:
+         break;
+   }
+
+   return NULL;
+}
+
+static struct string_list **core_info_field_list_ptr(core_info_t *info,
+      unsigned field)
+{
+   switch (field)
+   {
+      case CORE_INFO_FIELD_SUPPORTED_EXTENSIONS:
+         return &info->supported_extensions_list;
+      case CORE_INFO_FIELD_AUTHORS:
+         return &info->authors_list;
+      case CORE_INFO_FIELD_PERMISSIONS:
+         return &info->permissions_list;
+      case CORE_INFO_FIELD_LICENSES:
+         return &info->licenses_list;
+      case CORE_INFO_FIELD_CATEGORIES:
+         return &info->categories_list;
+      case CORE_INFO_FIELD_DATABASES:
+         return &info->databases_list;
+      case CORE_INFO_FIELD_NOTES:
+         return &info->note_list;
+      default:
+         break;
+   }
+
+   return NULL;
+}
+
+static void core_info_set_field(core_info_t *info, unsigned field,
+      const char *value)
+{
+   char **str               = core_info_field_ptr(info, field);
+   struct string_list **lst = core_info_field_list_ptr(info, field);
+
+   if (!str || string_is_empty(value))
+      return;
+
+   *str = strdup(value);
+
+   if (lst && *str)
+      *lst = string_split(*str, "|");
+}
+
+static void core_info_read_firmware(core_info_t *info, config_file_t *conf)
 {
-   size_t i;
    unsigned c;
+   unsigned count = 0;
 
-   for (i = 0; i < core_info_list->count; i++)
+   config_get_uint(conf, "firmware_count", &count);
+
+   if (!count)
+      return;
+
+   if (!(info->firmware = (core_info_firmware_t*)
+            calloc(count, sizeof(*info->firmware))))
+      return;
+
+   info->firmware_count = count;
+
+   for (c = 0; c < count; c++)
    {
-      unsigned count                  = 0;
-      core_info_firmware_t *firmware  = NULL;
-      core_info_t *info               = (core_info_t*)&core_info_list->list[i];
-      config_file_t *config           = (config_file_t*)info->config_data;
+      char path_key[64];
+      char desc_key[64];
+      char opt_key[64];
+      bool tmp_bool     = false;
+      char *tmp         = NULL;
+      path_key[0]       = desc_key[0] = opt_key[0] = '\0';
+
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
+
+      if (config_get_string(conf, path_key, &tmp) && !string_is_empty(tmp))
+      {
+         info->firmware[c].path = strdup(tmp);
+         free(tmp);
+         tmp = NULL;
+      }
+      if (config_get_string(conf, desc_key, &tmp) && !string_is_empty(tmp))
+      {
+         info->firmware[c].desc = strdup(tmp);
+         free(tmp);
+         tmp = NULL;
+      }
+      if (tmp)
+         free(tmp);
+      tmp = NULL;
+      if (config_get_bool(conf, opt_key , &tmp_bool))
+         info->firmware[c].optional = tmp_bool;
+   }
+}
 
-      if (!config || !config_get_uint(config, "firmware_count", &count))
-         continue;
+static void core_info_read_config(core_info_t *info, config_file_t *conf)
+{
+   unsigned i;
+   bool tmp_bool = false;
 
-      firmware = (core_info_firmware_t*)calloc(count, sizeof(*firmware));
+   for (i = 0; i < CORE_INFO_FIELD_LAST; i++)
+   {
+      char *tmp = NULL;
 
-      if (!firmware)
-         continue;
+      if (config_get_string(conf, core_info_field_keys[i], &tmp))
+         core_info_set_field(info, i, tmp);
+
+      free(tmp);
+   }
+
+   if (config_get_bool(conf, "supports_no_game",
+            &tmp_bool))
+      info->supports_no_game = tmp_bool;
+
+   if (config_get_bool(conf, "database_match_archive_member",
+            &tmp_bool))
+      info->database_match_archive_member = tmp_bool;
+
+   core_info_read_firmware(info, conf);
+}
+
+static void core_info_read_cache(core_info_t *info,
+      const core_info_cache_entry_t *entry)
+{
+   size_t i;
+
+   for (i = 0; i < CORE_INFO_FIELD_LAST; i++)
+      core_info_set_field(info, (unsigned)i, entry->fields[i]);
+
+   info->supports_no_game              =
+      !!(entry->flags & CORE_INFO_CACHE_SUPPORTS_NO_GAME);
+   info->database_match_archive_member =
+      !!(entry->flags & CORE_INFO_CACHE_DATABASE_MATCH_ARCHIVE_MEMBER);
+
+   if (!entry->firmware_count)
+      return;
+
+   if (!(info->firmware = (core_info_firmware_t*)
+            calloc(entry->firmware_count, sizeof(*info->firmware))))
+      return;
+
+   info->firmware_count = entry->firmware_count;
+
+   for (i = 0; i < entry->firmware_count; i++)
+   {
+      const core_info_firmware_t *fw = &entry->firmware[i];
+
+      if (fw->path)
+         info->firmware[i].path  = strdup(fw->path);
+      if (fw->desc)
+         info->firmware[i].desc  = strdup(fw->desc);
+      info->firmware[i].optional = fw->optional;
+   }
+}
+
+static int core_info_cache_cmp(const void *a, const void *b)
+{
+   const core_info_cache_entry_t *ea = (const core_info_cache_entry_t*)a;
+   const core_info_cache_entry_t *eb = (const core_info_cache_entry_t*)b;
+   return strcmp(ea->name, eb->name);
+}
+
+static const core_info_cache_entry_t *core_info_cache_find(
+      const core_info_cache_t *cache, const char *info_path,
+      int32_t size, int64_t mtime)
+{
+   core_info_cache_entry_t key;
+   const core_info_cache_entry_t *entry = NULL;
+
+   if (!cache || !cache->count || mtime < 0)
+      return NULL;
+
+   key.name = (char*)path_basename(info_path);
+   entry    = (const core_info_cache_entry_t*)bsearch(&key,
+         cache->entries, cache->count, sizeof(*cache->entries),
+         core_info_cache_cmp);
+
+   if (entry && entry->size == size && entry->mtime == mtime)
+      return entry;
+   return NULL;
+}
 
-      info->firmware = firmware;
+static void core_info_cache_free(core_info_cache_t *cache)
+{
+   size_t i, j;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      core_info_cache_entry_t *entry = &cache->entries[i];
+
+      for (j = 0; j < CORE_INFO_FIELD_LAST; j++)
+         free(entry->fields[j]);
 
-      for (c = 0; c < count; c++)
+      for (j = 0; j < entry->firmware_count; j++)
       {
-         char path_key[64];
-         char desc_key[64];
-         char opt_key[64];
-         bool tmp_bool     = false;
-         char *tmp         = NULL;
-         path_key[0]       = desc_key[0] = opt_key[0] = '\0';
-
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
-
-         if (config_get_string(config, path_key, &tmp) && !string_is_empty(tmp))
-         {
-            info->firmware[c].path = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(config, desc_key, &tmp) && !string_is_empty(tmp))
+         free(entry->firmware[j].path);
+         free(entry->firmware[j].desc);
+      }
+
+      free(entry->firmware);
+      free(entry->name);
+   }
+
+   free(cache->entries);
+   free(cache);
+}
+
+/* Each entry is a line 'size \t mtime \t flags \t firmware count
+ * \t .info file name', then one line per field, then one line
+ * per firmware: 'optional \t path \t description'. */
+static core_info_cache_t *core_info_cache_load(const char *path)
+{
+   char *line               = NULL;
+   size_t cap               = 0;
+   RFILE *file              = NULL;
+   core_info_cache_t *cache = NULL;
+
+   if (string_is_empty(path) || !path_is_valid(path))
+      return NULL;
+
+   if (!(file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return NULL;
+
+   line = filestream_getline(file);
+   if (!line || !string_is_equal(line, CORE_INFO_CACHE_HEADER))
+      goto end;
+
+   if (!(cache = (core_info_cache_t*)calloc(1, sizeof(*cache))))
+      goto end;
+
+   for (free(line); (line = filestream_getline(file)); free(line))
+   {
+      size_t i;
+      char *fields[5];
+      char *tok                      = line;
+      core_info_cache_entry_t *entry = NULL;
+
+      for (i = 0; i < 4 && tok; i++)
+      {
+         fields[i] = tok;
+         if ((tok = strchr(tok, '\t')))
+            *tok++ = '\0';
+      }
+
+      if (i < 4 || string_is_empty(tok))
+         break;
+      fields[4] = tok;
+
+      if (cache->count == cap)
+      {
+         size_t new_cap                    = cap ? cap * 2 : 128;
+         core_info_cache_entry_t *entries  = (core_info_cache_entry_t*)
+            realloc(cache->entries, new_cap * sizeof(*entries));
+
+         if (!entries)
+            break;
+
+         cache->entries = entries;
+         cap            = new_cap;
+      }
+
+      entry                 = &cache->entries[cache->count++];
+      memset(entry, 0, sizeof(*entry));
+      entry->size           = (int32_t)strtol(fields[0], NULL, 10);
+      entry->mtime          = (int64_t)strtoll(fields[1], NULL, 10);
+      entry->flags          = (unsigned)strtoul(fields[2], NULL, 10);
+      entry->name           = strdup(fields[4]);
+
+      for (i = 0; i < CORE_INFO_FIELD_LAST; i++)
+      {
+         char *value = filestream_getline(file);
+
+         if (!value)
+            goto error;
+
+         if (*value)
+            entry->fields[i] = value;
+         else
+            free(value);
+      }
+
+      entry->firmware_count = (size_t)strtoul(fields[3], NULL, 10);
+
+      if (entry->firmware_count)
+      {
+         if (!(entry->firmware = (core_info_firmware_t*)calloc(
+                     entry->firmware_count, sizeof(*entry->firmware))))
+            goto error;
+
+         for (i = 0; i < entry->firmware_count; i++)
          {
-            info->firmware[c].desc = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
+            char *desc = NULL;
+            char *fw   = filestream_getline(file);
+
+            if (!fw)
+               goto error;
+
+            if ((tok = strchr(fw, '\t')) && (desc = strchr(tok + 1, '\t')))
+            {
+               *tok++  = '\0';
+               *desc++ = '\0';
+
+               entry->firmware[i].optional = string_is_equal(fw, "1");
+               if (*tok)
+                  entry->firmware[i].path  = strdup(tok);
+               if (*desc)
+                  entry->firmware[i].desc  = strdup(desc);
+            }
+
+            free(fw);
          }
-         if (tmp)
-            free(tmp);
-         tmp = NULL;
-         if (config_get_bool(config, opt_key , &tmp_bool))
-            info->firmware[c].optional = tmp_bool;
       }
    }
+
+   if (cache->count)
+      qsort(cache->entries, cache->count, sizeof(*cache->entries),
+            core_info_cache_cmp);
+
+end:
+   free(line);
+   filestream_close(file);
+   return cache;
+
+error:
+   /* A truncated cache is as good as none. */
+   free(line);
+   filestream_close(file);
+   core_info_cache_free(cache);
+   return NULL;
+}
+
+static void core_info_cache_save(const char *path,
+      core_info_list_t *core_info_list,
+      const int32_t *sizes, const int64_t *mtimes)
+{
+   size_t i, j;
+   RFILE *file = filestream_open(path, RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   /* Info directories shipped with the system are read-only. */
+   if (!file)
+      return;
+
+   filestream_printf(file, "%s\n", CORE_INFO_CACHE_HEADER);
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      core_info_t *info = &core_info_list->list[i];
+      unsigned flags    = 0;
+
+      if (!info->has_info || mtimes[i] < 0)
+         continue;
+
+      if (info->supports_no_game)
+         flags |= CORE_INFO_CACHE_SUPPORTS_NO_GAME;
+      if (info->database_match_archive_member)
+         flags |= CORE_INFO_CACHE_DATABASE_MATCH_ARCHIVE_MEMBER;
+
+      filestream_printf(file, "%d\t%lld\t%u\t%u\t%s\n",
+            (int)sizes[i], (long long)mtimes[i], flags,
+            (unsigned)info->firmware_count,
+            path_basename(info->info_path));
+
+      for (j = 0; j < CORE_INFO_FIELD_LAST; j++)
+      {
+         const char *value = *core_info_field_ptr(info, (unsigned)j);
+         filestream_printf(file, "%s\n", value ? value : "");
+      }
+
+      for (j = 0; j < info->firmware_count; j++)
+         filestream_printf(file, "%d\t%s\t%s\n",
+               info->firmware[j].optional ? 1 : 0,
+               info->firmware[j].path ? info->firmware[j].path : "",
+               info->firmware[j].desc ? info->firmware[j].desc : "");
+   }
+
+   filestream_close(file);
 }
 
 static void core_info_list_free(core_info_list_t *core_info_list)
@@ -147,6 +566,7 @@ static void core_info_list_free(core_info_list_t *core_info_list)
       core_info_t *info = (core_info_t*)&core_info_list->list[i];
 
       free(info->path);
+      free(info->info_path);
       free(info->core_name);
       free(info->systemname);
       free(info->system_id);
@@ -229,6 +649,12 @@ static core_info_list_t *core_info_list_new(const char *path,
       bool show_hidden_files)
 {
    size_t i;
+   size_t cache_hits                = 0;
+   bool cache_dirty                 = false;
+   char *cache_path                 = NULL;
+   int32_t *sizes                   = NULL;
+   int64_t *mtimes                  = NULL;
+   core_info_cache_t *cache         = NULL;
    core_info_t *core_info           = NULL;
    core_info_list_t *core_info_list = NULL;
    const char       *path_basedir   = libretro_info_dir;
@@ -251,167 +677,63 @@ static core_info_list_t *core_info_list_new(const char *path,
    core_info_list->list  = core_info;
    core_info_list->count = contents->size;
 
+   sizes      = (int32_t*)calloc(contents->size + 1, sizeof(*sizes));
+   mtimes     = (int64_t*)calloc(contents->size + 1, sizeof(*mtimes));
+   cache_path = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
+
+   if (!sizes || !mtimes || !cache_path)
+      goto error;
+
+   fill_pathname_join(cache_path, path_basedir, CORE_INFO_CACHE_FILE,
+         PATH_MAX_LENGTH * sizeof(char));
+   cache = core_info_cache_load(cache_path);
+
    for (i = 0; i < contents->size; i++)
    {
       size_t info_path_size = PATH_MAX_LENGTH * sizeof(char);
       char *info_path       = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
 
       info_path[0]          = '\0';
+      mtimes[i]             = -1;
 
       if (
             core_info_list_iterate(info_path, info_path_size,
                path_basedir, contents, i)
             && path_is_valid(info_path))
       {
-         char *tmp           = NULL;
-         bool tmp_bool       = false;
-         unsigned count      = 0;
-         config_file_t *conf = config_file_new(info_path);
-
-         free(info_path);
-
-         if (!conf)
-            continue;
-
-         if (config_get_string(conf, "display_name", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].display_name = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(conf, "display_version", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].display_version = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(conf, "corename", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].core_name = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (config_get_string(conf, "systemname", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].systemname = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (config_get_string(conf, "systemid", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].system_id = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (config_get_string(conf, "manufacturer", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].system_manufacturer = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-
-         config_get_uint(conf, "firmware_count", &count);
-
-         core_info[i].firmware_count = count;
-
-         if (config_get_string(conf, "supported_extensions", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].supported_extensions      = strdup(tmp);
-            core_info[i].supported_extensions_list =
-               string_split(core_info[i].supported_extensions, "|");
-
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (config_get_string(conf, "authors", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].authors      = strdup(tmp);
-            core_info[i].authors_list =
-               string_split(core_info[i].authors, "|");
+         const core_info_cache_entry_t *entry = NULL;
 
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (config_get_string(conf, "permissions", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].permissions      = strdup(tmp);
-            core_info[i].permissions_list =
-               string_split(core_info[i].permissions, "|");
-
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (config_get_string(conf, "license", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].licenses      = strdup(tmp);
-            core_info[i].licenses_list =
-               string_split(core_info[i].licenses, "|");
+         sizes[i]  = path_get_size(info_path);
+         mtimes[i] = path_get_mtime(info_path);
+         entry     = core_info_cache_find(cache, info_path,
+               sizes[i], mtimes[i]);
 
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (config_get_string(conf, "categories", &tmp)
-               && !string_is_empty(tmp))
+         /* The full config is only read back in when
+          * core_info_load() is asked for this core. */
+         if (entry)
          {
-            core_info[i].categories      = strdup(tmp);
-            core_info[i].categories_list =
-               string_split(core_info[i].categories, "|");
-
-            free(tmp);
-            tmp = NULL;
+            cache_hits++;
+            core_info_read_cache(&core_info[i], entry);
+            core_info[i].has_info  = true;
+            core_info[i].info_path = info_path;
          }
-
-         if (config_get_string(conf, "database", &tmp)
-               && !string_is_empty(tmp))
+         else
          {
-            core_info[i].databases      = strdup(tmp);
-            core_info[i].databases_list =
-               string_split(core_info[i].databases, "|");
-
-            free(tmp);
-            tmp = NULL;
+            config_file_t *conf = config_file_new(info_path);
+
+            if (mtimes[i] >= 0)
+               cache_dirty      = true;
+
+            if (conf)
+            {
+               core_info_read_config(&core_info[i], conf);
+               core_info[i].has_info    = true;
+               core_info[i].info_path   = info_path;
+               core_info[i].config_data = conf;
+            }
+            else
+               free(info_path);
          }
-
-         if (config_get_string(conf, "notes", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].notes     = strdup(tmp);
-            core_info[i].note_list = string_split(core_info[i].notes, "|");
-
-            free(tmp);
-            tmp = NULL;
-         }
-
-         if (tmp)
-            free(tmp);
-         tmp    = NULL;
-
-         if (config_get_bool(conf, "supports_no_game",
-               &tmp_bool))
-            core_info[i].supports_no_game = tmp_bool;
-
-         if (config_get_bool(conf, "database_match_archive_member",
-               &tmp_bool))
-            core_info[i].database_match_archive_member = tmp_bool;
-
-         core_info[i].config_data = conf;
       }
       else
          free(info_path);
@@ -424,16 +746,23 @@ static core_info_list_t *core_info_list_new(const char *path,
             strdup(path_basename(core_info[i].path));
    }
 
-   if (core_info_list)
-   {
-      core_info_list_resolve_all_extensions(core_info_list);
-      core_info_list_resolve_all_firmware(core_info_list);
-   }
+   /* Also drops the entries of cores that are gone. */
+   if (cache_dirty || (cache && cache->count != cache_hits))
+      core_info_cache_save(cache_path, core_info_list, sizes, mtimes);
+
+   core_info_list_resolve_all_extensions(core_info_list);
 
+   core_info_cache_free(cache);
+   free(cache_path);
+   free(sizes);
+   free(mtimes);
    dir_list_free(contents);
    return core_info_list;
 
 error:
+   free(cache_path);
+   free(sizes);
+   free(mtimes);
    if (contents)
       dir_list_free(contents);
    core_info_list_free(core_info_list);
@@ -455,11 +784,14 @@ static bool core_info_list_get_info(core_info_list_t *core_info_list,
 
    for (i = 0; i < core_info_list->count; i++)
    {
-      const core_info_t *info = &core_info_list->list[i];
+      core_info_t *info = &core_info_list->list[i];
 
       if (string_is_equal(path_basename(info->path),
                path_basename(path)))
       {
+         if (info->has_info && !info->config_data)
+            info->config_data = config_file_new(info->info_path);
+
          *out_info = *info;
          return true;
       }
@@ -838,11 +1170,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
       return 0;
 
    for (i = 0; i < core_info_list->count; i++)
-   {
-      config_file_t *conf = (config_file_t*)
-         core_info_list->list[i].config_data;
-      num += !!conf;
-   }
+      num += core_info_list->list[i].has_info;
 
    return num;
 }
@@ -39,8 +39,13 @@ typedef struct
 {
    bool supports_no_game;
    bool database_match_archive_member;
+   /* Whether the core has a .info file. */
+   bool has_info;
    size_t firmware_count;
    char *path;
+   char *info_path;
+   /* The parsed .info file. Cores read from the core info
+    * cache only get this once core_info_load() is called. */
    void *config_data;
    char *display_name;
    char *display_version;
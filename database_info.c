@@ -156,14 +156,12 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
    struct rmsgpack_dom_value item;
    const char* str                = NULL;
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
+   /* Everything kept from the record is copied out below. */
+   if (libretrodb_cursor_read_item_view(cur, &item) != 0)
       return -1;
 
    if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
       return 1;
-   }
 
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
@@ -298,8 +296,6 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
       }
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
@@ -440,8 +436,47 @@ void database_info_free(database_info_handle_t *db)
    string_list_free(db->list);
 }
 
-database_info_list_t *database_info_list_new(
-      const char *rdb_path, const char *query)
+struct database_info_crc_set
+{
+   const uint32_t *crcs;
+   size_t count;
+};
+
+static int database_info_crc_cmp(const void *a, const void *b)
+{
+   uint32_t ca = *(const uint32_t*)a;
+   uint32_t cb = *(const uint32_t*)b;
+   return (ca > cb) - (ca < cb);
+}
+
+static int database_info_crc_filter(const struct rmsgpack_dom_value *item,
+      void *data)
+{
+   uint32_t crc;
+   struct rmsgpack_dom_value key;
+   const struct rmsgpack_dom_value *value = NULL;
+   struct database_info_crc_set *set      =
+      (struct database_info_crc_set*)data;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = 3;
+   key.val.string.buff = (char*)"crc";
+
+   value = rmsgpack_dom_value_map_value(item, &key);
+
+   if (!value || value->type != RDT_BINARY || value->val.binary.len != 4)
+      return 0;
+
+   memcpy(&crc, value->val.binary.buff, sizeof(crc));
+   crc = swap_if_little32(crc);
+
+   return bsearch(&crc, set->crcs, set->count,
+         sizeof(*set->crcs), database_info_crc_cmp) != NULL;
+}
+
+static database_info_list_t *database_info_list_new_internal(
+      const char *rdb_path, const char *query,
+      libretrodb_filter_t filter, void *userdata)
 {
    int ret                                  = 0;
    unsigned k                               = 0;
@@ -456,6 +491,9 @@ database_info_list_t *database_info_list_new(
    if ((database_cursor_open(db, cur, rdb_path, query) != 0))
       goto end;
 
+   if (filter)
+      libretrodb_cursor_set_filter(cur, filter, userdata);
+
    database_info_list = (database_info_list_t*)
       malloc(sizeof(*database_info_list));
 
@@ -539,6 +577,24 @@ end:
    return database_info_list;
 }
 
+database_info_list_t *database_info_list_new(
+      const char *rdb_path, const char *query)
+{
+   return database_info_list_new_internal(rdb_path, query, NULL, NULL);
+}
+
+database_info_list_t *database_info_list_new_crcs(const char *rdb_path,
+      const uint32_t *crcs, size_t count)
+{
+   struct database_info_crc_set set;
+
+   set.crcs  = crcs;
+   set.count = count;
+
+   return database_info_list_new_internal(rdb_path, NULL,
+         database_info_crc_filter, &set);
+}
+
 void database_info_list_free(database_info_list_t *database_info_list)
 {
    size_t i;
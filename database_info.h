@@ -123,6 +123,11 @@ typedef struct
 database_info_list_t *database_info_list_new(const char *rdb_path,
       const char *query);
 
+/* Entries whose CRC is in @crcs, which must be sorted.
+ * Reads the database once however many CRCs are asked for. */
+database_info_list_t *database_info_list_new_crcs(const char *rdb_path,
+      const uint32_t *crcs, size_t count);
+
 void database_info_list_free(database_info_list_t *list);
 
 database_info_handle_t *database_info_dir_init(const char *dir,
@@ -352,6 +352,8 @@ void drivers_init(int flags)
       struct retro_hw_render_callback *hwr =
          video_driver_get_hw_context();
 
+      retroarch_startup_step("video");
+
       video_driver_monitor_reset();
       video_driver_init(&video_is_threaded);
 
@@ -365,10 +367,13 @@ void drivers_init(int flags)
 
    if (flags & DRIVER_AUDIO_MASK)
    {
+      retroarch_startup_step("audio");
       audio_driver_init();
       audio_driver_new_devices_list();
    }
 
+   retroarch_startup_step("drivers");
+
    /* Only initialize camera driver if we're ever going to use it. */
    if ((flags & DRIVER_CAMERA_MASK) && camera_driver_ctl(RARCH_CAMERA_CTL_IS_ACTIVE, NULL))
       camera_driver_ctl(RARCH_CAMERA_CTL_INIT, NULL);
@@ -383,10 +388,15 @@ void drivers_init(int flags)
    if (flags & DRIVER_VIDEO_MASK)
    {
       if (flags & DRIVER_MENU_MASK)
+      {
+         retroarch_startup_step("menu");
          menu_driver_init(video_is_threaded);
+      }
    }
 #endif
 
+   retroarch_startup_step("drivers");
+
    if (flags & (DRIVER_VIDEO_MASK | DRIVER_AUDIO_MASK))
    {
       /* Keep non-throttled state as good as possible. */
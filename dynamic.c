@@ -82,6 +82,22 @@
 } while (0)
 
 static dylib_t lib_handle;
+static char lib_handle_path[PATH_MAX_LENGTH];
+
+/* Recently unloaded cores, still open and with their symbols
+ * resolved, so going back to one skips the dlopen and relocation. */
+#define CORE_CACHE_SIZE 4
+
+struct core_cache_entry
+{
+   char path[PATH_MAX_LENGTH];
+   dylib_t handle;
+   struct retro_core_t symbols;
+   unsigned last_used;
+};
+
+static struct core_cache_entry core_cache[CORE_CACHE_SIZE];
+static unsigned core_cache_clock = 0;
 #else
 #define SYMBOL(x) current_core->x = x
 #endif
@@ -304,7 +320,77 @@ static void libretro_get_environment_info(void (*func)(retro_environment_t),
    ignore_environment_cb = false;
 }
 
-static bool load_dynamic_core(void)
+static void core_cache_flush(void)
+{
+   unsigned i;
+
+   for (i = 0; i < CORE_CACHE_SIZE; i++)
+   {
+      if (core_cache[i].handle)
+         dylib_close(core_cache[i].handle);
+      memset(&core_cache[i], 0, sizeof(core_cache[i]));
+   }
+}
+
+/* Keeps @handle open for next time, closing the least recently used
+ * core if the cache is full. */
+static void core_cache_put(const char *path, dylib_t handle,
+      const struct retro_core_t *symbols)
+{
+   unsigned i;
+   struct core_cache_entry *entry = &core_cache[0];
+
+   for (i = 0; i < CORE_CACHE_SIZE; i++)
+   {
+      if (!core_cache[i].handle)
+      {
+         entry = &core_cache[i];
+         break;
+      }
+      if (core_cache[i].last_used < entry->last_used)
+         entry = &core_cache[i];
+   }
+
+   if (entry->handle)
+   {
+      RARCH_LOG("[Core Cache]: Closing \"%s\".\n", entry->path);
+      dylib_close(entry->handle);
+   }
+
+   strlcpy(entry->path, path, sizeof(entry->path));
+   entry->handle                            = handle;
+   entry->symbols                           = *symbols;
+   entry->symbols.poll_type                 = 0;
+   entry->symbols.inited                    = false;
+   entry->symbols.symbols_inited            = false;
+   entry->symbols.game_loaded               = false;
+   entry->symbols.input_polled              = false;
+   entry->symbols.has_set_input_descriptors = false;
+   entry->symbols.serialization_quirks_v    = 0;
+   entry->last_used                         = ++core_cache_clock;
+}
+
+static bool core_cache_take(const char *path, dylib_t *handle,
+      struct retro_core_t *symbols)
+{
+   unsigned i;
+
+   for (i = 0; i < CORE_CACHE_SIZE; i++)
+   {
+      if (core_cache[i].handle && string_is_equal(core_cache[i].path, path))
+      {
+         *handle  = core_cache[i].handle;
+         *symbols = core_cache[i].symbols;
+         memset(&core_cache[i], 0, sizeof(core_cache[i]));
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static bool load_dynamic_core(struct retro_core_t *current_core,
+      bool *cached)
 {
    function_t sym       = dylib_proc(NULL, "retro_init");
 
@@ -334,6 +420,16 @@ static bool load_dynamic_core(void)
          path_get_ptr(RARCH_PATH_CORE),
          path_get_realsize(RARCH_PATH_CORE));
 
+   strlcpy(lib_handle_path, path_get(RARCH_PATH_CORE),
+         sizeof(lib_handle_path));
+
+   if (core_cache_take(lib_handle_path, &lib_handle, current_core))
+   {
+      RARCH_LOG("Reusing loaded libretro core: \"%s\"\n", lib_handle_path);
+      *cached = true;
+      return true;
+   }
+
    RARCH_LOG("Loading dynamic libretro core from: \"%s\"\n",
          path_get(RARCH_PATH_CORE));
    lib_handle = dylib_load(path_get(RARCH_PATH_CORE));
@@ -501,8 +597,12 @@ bool init_libretro_sym_custom(enum rarch_core_type type, struct retro_core_t *cu
          if (!lib_path || !lib_handle_p)
 #endif
          {
-            if (!load_dynamic_core())
+            bool cached = false;
+            if (!load_dynamic_core(current_core, &cached))
                return false;
+            /* A cached core comes with its symbols */
+            if (cached)
+               break;
             lib_handle_local = lib_handle;
          }
 #ifdef HAVE_RUNAHEAD
@@ -824,10 +924,29 @@ bool libretro_get_shared_context(void)
  **/
 void uninit_libretro_sym(struct retro_core_t *current_core)
 {
+   /* Reads the core left in flight still write to its memory. */
+   retro_vfs_async_deinit_impl();
+
 #ifdef HAVE_DYNAMIC
-   if (lib_handle)
-      dylib_close(lib_handle);
-   lib_handle = NULL;
+   {
+      settings_t *settings = config_get_ptr();
+      bool keep            = settings && settings->bools.core_cache_enable;
+
+      /* Only the handle is kept, the core has been through
+       * retro_deinit() like any other unload. */
+      if (lib_handle)
+      {
+         if (keep && !string_is_empty(lib_handle_path))
+            core_cache_put(lib_handle_path, lib_handle, current_core);
+         else
+            dylib_close(lib_handle);
+      }
+      lib_handle         = NULL;
+      lib_handle_path[0] = '\0';
+
+      if (!keep)
+         core_cache_flush();
+   }
 #endif
 
    memset(current_core, 0, sizeof(struct retro_core_t));
@@ -983,6 +1102,50 @@ static bool mmap_preprocess_descriptors(rarch_memory_descriptor_t *first, unsign
    return true;
 }
 
+uint8_t *rarch_memory_map_get(const rarch_memory_map_t *mmaps,
+      unsigned id, size_t start, size_t *len)
+{
+   const rarch_memory_descriptor_t *desc = NULL;
+
+   if (id >= mmaps->num_descriptors)
+      return NULL;
+
+   desc = &mmaps->descriptors[id];
+
+   if (!desc->core.ptr || start >= desc->core.len)
+      return NULL;
+
+   if (*len > desc->core.len - start)
+      *len = desc->core.len - start;
+
+   return (uint8_t*)desc->core.ptr + desc->core.offset + start;
+}
+
+uint8_t *rarch_memory_map_find(const rarch_memory_map_t *mmaps,
+      size_t address, size_t *len)
+{
+   unsigned i;
+
+   for (i = 0; i < mmaps->num_descriptors; i++)
+   {
+      size_t offset;
+      const rarch_memory_descriptor_t *desc = &mmaps->descriptors[i];
+
+      if (((desc->core.start ^ address) & desc->core.select) != 0)
+         continue;
+
+      offset = mmap_reduce((address - desc->core.start)
+            & desc->disconnect_mask, desc->core.disconnect);
+
+      if (offset >= desc->core.len)
+         offset -= mmap_highest_bit(offset);
+
+      return rarch_memory_map_get(mmaps, i, offset, len);
+   }
+
+   return NULL;
+}
+
 static bool dynamic_request_hw_context(enum retro_hw_context_type type,
       unsigned minor, unsigned major)
 {
@@ -1750,6 +1913,10 @@ bool rarch_environment_cb(unsigned cmd, void *data)
 
             mmap_preprocess_descriptors(descriptors, mmaps->num_descriptors);
 
+#if defined(HAVE_CHEEVOS) && defined(HAVE_NEW_CHEEVOS)
+            cheevos_memory_map_changed();
+#endif
+
             if (sizeof(void *) == 8)
                RARCH_LOG("   ndx flags  ptr              offset   start    select   disconn  len      addrspace\n");
             else
@@ -1880,7 +2047,7 @@ bool rarch_environment_cb(unsigned cmd, void *data)
  
       case RETRO_ENVIRONMENT_GET_VFS_INTERFACE:
       {
-         const uint32_t supported_vfs_version = 1;
+         const uint32_t supported_vfs_version = 3;
          static struct retro_vfs_interface vfs_iface =
          {
             retro_vfs_file_get_path_impl,
@@ -1892,7 +2059,11 @@ bool rarch_environment_cb(unsigned cmd, void *data)
             retro_vfs_file_read_impl,
             retro_vfs_file_write_impl,
             retro_vfs_file_flush_impl,
-            retro_vfs_file_remove_impl
+            retro_vfs_file_remove_impl,
+            retro_vfs_file_rename_impl,
+            retro_vfs_file_truncate_impl,
+            retro_vfs_file_read_async_impl,
+            retro_vfs_async_poll_impl
          };
 
          struct retro_vfs_interface_info *vfs_iface_info = (struct retro_vfs_interface_info *) data;
@@ -1900,6 +2071,7 @@ bool rarch_environment_cb(unsigned cmd, void *data)
          {
             vfs_iface_info->required_interface_version = supported_vfs_version;
             vfs_iface_info->iface                      = &vfs_iface;
+            retro_vfs_async_init_impl();
          }
 
          break;
@@ -0,0 +1,106 @@
+//"use strict";
+
+// AudioWorklet side of audio/drivers/audioworklet.c. The processor
+// reads the ring in the shared wasm heap from the audio thread, so
+// nothing here runs per sample on the main thread.
+
+var LibraryAudioWorklet = {
+   $RAW: {
+      context: null,
+      node: null,
+      ready: false,
+
+      // Loaded from a Blob URL so the build doesn't ship a second file.
+      processor: [
+         "class RetroArchRing extends AudioWorkletProcessor {",
+         "   constructor(options) {",
+         "      super();",
+         "      var o = options.processorOptions;",
+         "      this.ring = new Float32Array(o.memory, o.ring, o.capacity * 2);",
+         "      this.pos = new Int32Array(o.memory, o.pos, 2);",
+         "      this.mask = o.capacity - 1;",
+         "   }",
+         "   process(inputs, outputs) {",
+         "      var left = outputs[0][0], right = outputs[0][1];",
+         "      var w = Atomics.load(this.pos, 0);",
+         "      var r = this.pos[1];",
+         "      var n = Math.min(left.length, (w - r) | 0);",
+         "      var i = 0;",
+         "      for (; i < n; i++, r++) {",
+         "         var s = (r & this.mask) * 2;",
+         "         left[i] = this.ring[s];",
+         "         right[i] = this.ring[s + 1];",
+         "      }",
+         "      for (; i < left.length; i++)",
+         "         left[i] = right[i] = 0;",
+         "      Atomics.store(this.pos, 1, r);",
+         "      return true;",
+         "   }",
+         "}",
+         "registerProcessor('retroarch-ring', RetroArchRing);"
+      ].join("\n")
+   },
+
+   RWebAudioWorkletInit: function() {
+      var ac = window['AudioContext'] || window['webkitAudioContext'];
+
+      if (!ac || typeof SharedArrayBuffer === 'undefined' ||
+            !(HEAP8.buffer instanceof SharedArrayBuffer)) return 0;
+
+      RAW.context = new ac({ latencyHint: 'interactive' });
+      if (!RAW.context.audioWorklet) {
+         RAW.context.close();
+         RAW.context = null;
+         return 0;
+      }
+      return RAW.context.sampleRate;
+   },
+
+   RWebAudioWorkletConnect: function(ring, capacity, pos) {
+      var url = URL.createObjectURL(new Blob([RAW.processor],
+               { type: 'application/javascript' }));
+
+      RAW.context.audioWorklet.addModule(url).then(function() {
+         URL.revokeObjectURL(url);
+         if (!RAW.context) return;
+         RAW.node = new AudioWorkletNode(RAW.context, 'retroarch-ring', {
+            numberOfInputs: 0,
+            outputChannelCount: [2],
+            processorOptions: {
+               memory: HEAP8.buffer, ring: ring, capacity: capacity, pos: pos
+            }
+         });
+         RAW.node.connect(RAW.context.destination);
+         RAW.ready = true;
+      }, function(err) {
+         URL.revokeObjectURL(url);
+         console.error('[AudioWorklet] ' + err);
+      });
+      return true;
+   },
+
+   RWebAudioWorkletStart: function() {
+      if (RAW.context) RAW.context.resume();
+      return true;
+   },
+
+   RWebAudioWorkletStop: function() {
+      if (RAW.context) RAW.context.suspend();
+      return true;
+   },
+
+   RWebAudioWorkletRunning: function() {
+      return RAW.ready && RAW.context.state === 'running';
+   },
+
+   RWebAudioWorkletFree: function() {
+      if (RAW.node) RAW.node.disconnect();
+      if (RAW.context) RAW.context.close();
+      RAW.node = null;
+      RAW.context = null;
+      RAW.ready = false;
+   }
+};
+
+autoAddDeps(LibraryAudioWorklet, '$RAW');
+mergeInto(LibraryManager.library, LibraryAudioWorklet);
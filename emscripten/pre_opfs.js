@@ -0,0 +1,3 @@
+// Tells the web player that userdata is mounted on OPFS by the
+// frontend, so it doesn't set up its own BrowserFS mirror.
+Module['opfs'] = true;
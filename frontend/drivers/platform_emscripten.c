@@ -17,6 +17,9 @@
 
 #include <emscripten/emscripten.h>
 #include <emscripten/html5.h>
+#ifdef HAVE_OPFS
+#include <emscripten/wasmfs.h>
+#endif
 #include <string.h>
 
 #include <file/config_file.h>
@@ -76,15 +79,9 @@ static void emscripten_mainloop(void)
 
    video_driver_build_info(&video_info);
 
-   /* Disable BFI during fast forward, slow-motion,
-    * and pause to prevent flicker. */
-   if (
-         video_info.black_frame_insertion
-         && !video_info.input_driver_nonblock_state
-         && !video_info.runloop_is_slowmotion
-         && !video_info.runloop_is_paused)
+   if (video_info.black_frames)
    {
-      if ((emscripten_frame_count & 1) == 0)
+      if (emscripten_frame_count % (video_info.black_frames + 1) != 0)
       {
          glClear(GL_COLOR_BUFFER_BIT);
          video_info.cb_swap_buffers(video_info.context_data, &video_info);
@@ -155,6 +152,21 @@ static void frontend_emscripten_get_env(int *argc, char *argv[],
       snprintf(user_path, sizeof(user_path), "retroarch/userdata");
    }
 
+#ifdef HAVE_OPFS
+   /* Saves, states and downloaded content live in the origin private
+    * file system, which doesn't have to be loaded into memory up front
+    * like the IndexedDB mirror does. The rest of the tree stays in
+    * memory. */
+   if (!path_is_directory(user_path))
+   {
+      path_mkdir(base_path);
+      if (wasmfs_create_directory(user_path, 0777,
+               wasmfs_create_opfs_backend()) != 0)
+         RARCH_WARN("[OPFS] Could not mount %s, userdata will not "
+               "persist.\n", user_path);
+   }
+#endif
+
    fill_pathname_join(g_defaults.dirs[DEFAULT_DIR_CORE], base_path,
          "cores", sizeof(g_defaults.dirs[DEFAULT_DIR_CORE]));
 
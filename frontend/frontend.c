@@ -35,6 +35,7 @@
 
 #include "../driver.h"
 #include "../paths.h"
+#include "../performance_counters.h"
 #include "../retroarch.h"
 
 /* griffin hack */
@@ -63,6 +64,8 @@ void main_exit(void *args)
    if (settings->bools.config_save_on_exit)
       command_event(CMD_EVENT_MENU_SAVE_CURRENT_CONFIG, NULL);
 
+   config_save_file_flush();
+
 #ifdef HAVE_MENU
    /* Do not want menu context to live any more. */
    menu_driver_ctl(RARCH_MENU_CTL_UNSET_OWN_DRIVER, NULL);
@@ -70,6 +73,7 @@ void main_exit(void *args)
    rarch_ctl(RARCH_CTL_MAIN_DEINIT, NULL);
 
    command_event(CMD_EVENT_PERFCNT_REPORT_FRONTEND_LOG, NULL);
+   performance_trace_deinit();
 
 #if defined(HAVE_LOGGER) && !defined(ANDROID)
    logger_shutdown();
@@ -48,6 +48,10 @@ typedef enum
    CTR_VIDEO_MODE_3D
 }ctr_video_mode_enum;
 
+/* Linear buffers handed to the core as its software framebuffer,
+ * one being tiled by the GPU while the core draws the other. */
+#define CTR_FRAME_POOL_SIZE 2
+
 typedef struct ctr_video
 {
    struct
@@ -79,6 +83,9 @@ typedef struct ctr_video
    int texture_width;
    int texture_height;
 
+   void* frame_pool[CTR_FRAME_POOL_SIZE];
+   int frame_pool_index;
+
    ctr_scale_vector_t scale_vector;
    ctr_vertex_t* frame_coords;
 
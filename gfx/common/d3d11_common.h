@@ -2495,6 +2495,8 @@ typedef struct
 {
    unsigned              cur_mon_id;
    DXGISwapChain         swapChain;
+   UINT                  swapchain_flags;
+   HANDLE                frame_latency;
    D3D11Device           device;
    D3D_FEATURE_LEVEL     supportedFeatureLevel;
    D3D11DeviceContext    context;
@@ -15,6 +15,9 @@
 
 #define CINTERFACE
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <boolean.h>
 
 #include "d3d12_common.h"
@@ -22,6 +25,7 @@
 #include "d3dcompiler_common.h"
 
 #include "../verbosity.h"
+#include "../../configuration.h"
 
 #ifdef HAVE_DYNAMIC
 #include <dynamic/dylib.h>
@@ -181,6 +185,8 @@ bool d3d12_init_base(d3d12_video_t* d3d12)
 
 bool d3d12_init_queue(d3d12_video_t* d3d12)
 {
+   unsigned i;
+
    {
       static const D3D12_COMMAND_QUEUE_DESC desc = { D3D12_COMMAND_LIST_TYPE_DIRECT, 0,
                                                      D3D12_COMMAND_QUEUE_FLAG_NONE, 0 };
@@ -188,11 +194,12 @@ bool d3d12_init_queue(d3d12_video_t* d3d12)
             d3d12->device, (D3D12_COMMAND_QUEUE_DESC*)&desc, &d3d12->queue.handle);
    }
 
-   D3D12CreateCommandAllocator(
-         d3d12->device, D3D12_COMMAND_LIST_TYPE_DIRECT, &d3d12->queue.allocator);
+   for (i = 0; i < D3D12_MAX_FRAMES_IN_FLIGHT; i++)
+      D3D12CreateCommandAllocator(
+            d3d12->device, D3D12_COMMAND_LIST_TYPE_DIRECT, &d3d12->queue.allocator[i]);
 
    D3D12CreateGraphicsCommandList(
-         d3d12->device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT, d3d12->queue.allocator,
+         d3d12->device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT, d3d12->queue.allocator[0],
          d3d12->pipes[VIDEO_SHADER_STOCK_BLEND], &d3d12->queue.cmd);
 
    D3D12CloseGraphicsCommandList(d3d12->queue.cmd);
@@ -203,14 +210,145 @@ bool d3d12_init_queue(d3d12_video_t* d3d12)
 
    D3D12SignalCommandQueue(d3d12->queue.handle, d3d12->queue.fence, d3d12->queue.fenceValue);
 
+   return d3d12_init_upload_ring(d3d12->device, &d3d12->upload_ring, D3D12_UPLOAD_RING_SIZE);
+}
+
+void d3d12_wait_for_fence(d3d12_video_t* d3d12, UINT64 value)
+{
+   if (D3D12GetCompletedValue(d3d12->queue.fence) < value)
+   {
+      D3D12SetEventOnCompletion(d3d12->queue.fence, value, d3d12->queue.fenceEvent);
+      WaitForSingleObject(d3d12->queue.fenceEvent, INFINITE);
+   }
+}
+
+bool d3d12_init_upload_ring(D3D12Device device, d3d12_upload_ring_t* ring, UINT64 size)
+{
+   D3D12_RANGE read_range = { 0, 0 };
+
+   memset(ring, 0, sizeof(*ring));
+
+   ring->gpu = d3d12_create_buffer(device, (UINT)size, &ring->handle);
+   if (!ring->handle)
+      return false;
+
+   /* upload heaps can stay mapped while the GPU reads them */
+   if (FAILED(D3D12Map(ring->handle, 0, &read_range, (void**)&ring->map)))
+   {
+      Release(ring->handle);
+      return false;
+   }
+
+   ring->size = size;
    return true;
 }
 
+void d3d12_release_upload_ring(d3d12_upload_ring_t* ring)
+{
+   if (ring->map)
+      D3D12Unmap(ring->handle, 0, NULL);
+   Release(ring->handle);
+   memset(ring, 0, sizeof(*ring));
+}
+
+static void d3d12_upload_ring_retire(d3d12_upload_ring_t* ring, UINT64 completed)
+{
+   unsigned i = 0;
+
+   while (i < ring->pending_count && ring->pending[i].fence <= completed)
+      i++;
+
+   if (!i)
+      return;
+
+   ring->tail           = ring->pending[i - 1].head;
+   ring->pending_count -= i;
+   memmove(ring->pending, ring->pending + i, ring->pending_count * sizeof(*ring->pending));
+}
+
+void* d3d12_upload_ring_alloc(
+      d3d12_video_t* d3d12, UINT64 size, UINT64 align, D3D12_GPU_VIRTUAL_ADDRESS* gpu)
+{
+   UINT64               start;
+   UINT64               offset;
+   d3d12_upload_ring_t* ring = &d3d12->upload_ring;
+
+   if (!ring->map || !size || size > ring->size)
+      return NULL;
+
+   start  = (ring->head + align - 1) & ~(align - 1);
+   offset = start % ring->size;
+
+   /* allocations never wrap around the end of the buffer */
+   if (offset + size > ring->size)
+   {
+      start += ring->size - offset;
+      offset = 0;
+   }
+
+   d3d12_upload_ring_retire(ring, D3D12GetCompletedValue(d3d12->queue.fence));
+
+   while (start + size - ring->tail > ring->size)
+   {
+      UINT64 fence;
+
+      /* what's left is in use by the frame being recorded */
+      if (!ring->pending_count)
+         return NULL;
+
+      fence = ring->pending[0].fence;
+      d3d12_wait_for_fence(d3d12, fence);
+      d3d12_upload_ring_retire(ring, fence);
+   }
+
+   ring->head = start + size;
+
+   if (gpu)
+      *gpu = ring->gpu + offset;
+
+   return ring->map + offset;
+}
+
+void d3d12_upload_ring_end_frame(d3d12_video_t* d3d12)
+{
+   d3d12_upload_ring_t* ring = &d3d12->upload_ring;
+
+   d3d12_upload_ring_retire(ring, D3D12GetCompletedValue(d3d12->queue.fence));
+
+   if (ring->pending_count == countof(ring->pending))
+   {
+      d3d12_wait_for_fence(d3d12, ring->pending[0].fence);
+      d3d12_upload_ring_retire(ring, ring->pending[0].fence);
+   }
+
+   ring->pending[ring->pending_count].fence = d3d12->queue.fenceValue;
+   ring->pending[ring->pending_count].head  = ring->head;
+   ring->pending_count++;
+}
+
+d3d12_sprite_t* d3d12_alloc_sprites(d3d12_video_t* d3d12, unsigned count)
+{
+   D3D12_GPU_VIRTUAL_ADDRESS gpu;
+   d3d12_sprite_t*           sprites = (d3d12_sprite_t*)d3d12_upload_ring_alloc(
+         d3d12, count * sizeof(*sprites), 16, &gpu);
+
+   if (!sprites)
+      return NULL;
+
+   d3d12->sprites.vbo_view.BufferLocation = gpu;
+   d3d12->sprites.vbo_view.SizeInBytes    = count * sizeof(*sprites);
+   d3d12->sprites.vbo_view.StrideInBytes  = sizeof(*sprites);
+   D3D12IASetVertexBuffers(d3d12->queue.cmd, 0, 1, &d3d12->sprites.vbo_view);
+
+   return sprites;
+}
+
 bool d3d12_init_swapchain(d3d12_video_t* d3d12,
       int width, int height, HWND hwnd)
 {
    unsigned i;
    DXGI_SWAP_CHAIN_DESC desc;
+   settings_t* settings = config_get_ptr();
 
    memset(&desc, 0, sizeof(DXGI_SWAP_CHAIN_DESC));
 
@@ -232,7 +370,21 @@ bool d3d12_init_swapchain(d3d12_video_t* d3d12,
 #else
    desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
 #endif
-   DXGICreateSwapChain(d3d12->factory, d3d12->queue.handle, &desc, &d3d12->chain.handle);
+   if (settings->bools.video_hard_sync)
+      desc.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+   if (dxgi_check_tearing_support())
+      desc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+
+   if (FAILED(DXGICreateSwapChain(d3d12->factory, d3d12->queue.handle, &desc, &d3d12->chain.handle)))
+      return false;
+
+   d3d12->chain.flags = desc.Flags;
+
+   if (desc.Flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT)
+      d3d12->chain.frame_latency = dxgi_init_frame_latency(d3d12->chain.handle,
+            settings->uints.video_hard_sync_frames + 1);
+   if (desc.Flags & DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING)
+      RARCH_LOG("[D3D12]: Tearing allowed with vsync off.\n");
 
    DXGIMakeWindowAssociation(d3d12->factory, hwnd, DXGI_MWA_NO_ALT_ENTER);
 
@@ -255,36 +407,37 @@ bool d3d12_init_swapchain(d3d12_video_t* d3d12,
 
 static void d3d12_init_descriptor_heap(D3D12Device device, d3d12_descriptor_heap_t* out)
 {
+   UINT i;
+
    D3D12CreateDescriptorHeap(device, &out->desc, &out->handle);
-   out->cpu    = D3D12GetCPUDescriptorHandleForHeapStart(out->handle);
-   out->gpu    = D3D12GetGPUDescriptorHandleForHeapStart(out->handle);
-   out->stride = D3D12GetDescriptorHandleIncrementSize(device, out->desc.Type);
-   out->map    = (bool*)calloc(out->desc.NumDescriptors, sizeof(bool));
+   out->cpu        = D3D12GetCPUDescriptorHandleForHeapStart(out->handle);
+   out->gpu        = D3D12GetGPUDescriptorHandleForHeapStart(out->handle);
+   out->stride     = D3D12GetDescriptorHandleIncrementSize(device, out->desc.Type);
+   out->free_slots = (UINT*)malloc(out->desc.NumDescriptors * sizeof(UINT));
+   out->free_count = out->free_slots ? out->desc.NumDescriptors : 0;
+
+   /* consecutive allocations on a fresh heap return consecutive slots,
+    * the slang descriptor tables rely on that */
+   for (i = 0; i < out->free_count; i++)
+      out->free_slots[i] = out->free_count - 1 - i;
 }
 
 static inline void d3d12_release_descriptor_heap(d3d12_descriptor_heap_t* heap)
 {
-   free(heap->map);
+   free(heap->free_slots);
    Release(heap->handle);
 }
 
 static D3D12_CPU_DESCRIPTOR_HANDLE d3d12_descriptor_heap_slot_alloc(d3d12_descriptor_heap_t* heap)
 {
-   int                         i;
    D3D12_CPU_DESCRIPTOR_HANDLE handle = { 0 };
 
-   for (i = heap->start; i < (int)heap->desc.NumDescriptors; i++)
-   {
-      if (!heap->map[i])
-      {
-         heap->map[i] = true;
-         handle.ptr   = heap->cpu.ptr + i * heap->stride;
-         heap->start  = i + 1;
-         return handle;
-      }
-   }
    /* if you get here try increasing NumDescriptors for this heap */
-   assert(0);
+   assert(heap->free_count);
+
+   if (heap->free_count)
+      handle.ptr = heap->cpu.ptr + heap->free_slots[--heap->free_count] * heap->stride;
+
    return handle;
 }
 
@@ -300,11 +453,9 @@ d3d12_descriptor_heap_slot_free(d3d12_descriptor_heap_t* heap, D3D12_CPU_DESCRIP
 
    i = (handle.ptr - heap->cpu.ptr) / heap->stride;
    assert(i >= 0 && i < heap->desc.NumDescriptors);
-   assert(heap->map[i]);
+   assert(heap->free_count < heap->desc.NumDescriptors);
 
-   heap->map[i] = false;
-   if (heap->start > i)
-      heap->start = i;
+   heap->free_slots[heap->free_count++] = i;
 }
 
 bool d3d12_create_root_signature(
@@ -416,13 +567,14 @@ bool d3d12_init_descriptors(d3d12_video_t* d3d12)
    d3d12_init_descriptor_heap(d3d12->device, &d3d12->desc.rtv_heap);
 
    d3d12->desc.srv_heap.desc.Type           = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-   d3d12->desc.srv_heap.desc.NumDescriptors = SLANG_NUM_BINDINGS * GFX_MAX_SHADERS + 1024;
+   d3d12->desc.srv_heap.desc.NumDescriptors =
+         SLANG_NUM_BINDINGS * GFX_MAX_SHADERS * D3D12_MAX_FRAMES_IN_FLIGHT + 1024;
    d3d12->desc.srv_heap.desc.Flags          = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
    d3d12_init_descriptor_heap(d3d12->device, &d3d12->desc.srv_heap);
 
    d3d12->desc.sampler_heap.desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
    d3d12->desc.sampler_heap.desc.NumDescriptors =
-         SLANG_NUM_BINDINGS * GFX_MAX_SHADERS + 2 * RARCH_WRAP_MAX;
+         SLANG_NUM_BINDINGS * GFX_MAX_SHADERS * D3D12_MAX_FRAMES_IN_FLIGHT + 2 * RARCH_WRAP_MAX;
    d3d12->desc.sampler_heap.desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
    d3d12_init_descriptor_heap(d3d12->device, &d3d12->desc.sampler_heap);
 
@@ -433,18 +585,16 @@ bool d3d12_init_descriptors(d3d12_video_t* d3d12)
    }
 
    for (i = 0; i < GFX_MAX_SHADERS; i++)
-   {
       d3d12->pass[i].rt.rt_view.ptr =
             d3d12->desc.rtv_heap.cpu.ptr +
             (countof(d3d12->chain.renderTargets) + i) * d3d12->desc.rtv_heap.stride;
 
-      d3d12->pass[i].textures.ptr = d3d12_descriptor_heap_slot_alloc(&d3d12->desc.srv_heap).ptr -
-                                    d3d12->desc.srv_heap.cpu.ptr + d3d12->desc.srv_heap.gpu.ptr;
-      d3d12->pass[i].samplers.ptr =
-            d3d12_descriptor_heap_slot_alloc(&d3d12->desc.sampler_heap).ptr -
-            d3d12->desc.sampler_heap.cpu.ptr + d3d12->desc.sampler_heap.gpu.ptr;
-
-      for (j = 1; j < SLANG_NUM_BINDINGS; j++)
+   /* Reserve the slang pass tables at the start of both heaps, one
+    * SLANG_NUM_BINDINGS block per pass and frame in flight, see
+    * d3d12_gfx_set_shader. */
+   for (i = 0; i < GFX_MAX_SHADERS * D3D12_MAX_FRAMES_IN_FLIGHT; i++)
+   {
+      for (j = 0; j < SLANG_NUM_BINDINGS; j++)
       {
          d3d12_descriptor_heap_slot_alloc(&d3d12->desc.srv_heap);
          d3d12_descriptor_heap_slot_alloc(&d3d12->desc.sampler_heap);
@@ -747,18 +897,63 @@ void d3d12_update_texture(
 
    D3D12Unmap(texture->upload_buffer, 0, NULL);
 
-   texture->dirty = true;
+   texture->streamed = false;
+   texture->dirty    = true;
+}
+
+void d3d12_stream_texture(
+      d3d12_video_t*   d3d12,
+      int              width,
+      int              height,
+      int              pitch,
+      DXGI_FORMAT      format,
+      const void*      data,
+      d3d12_texture_t* texture)
+{
+   D3D12_GPU_VIRTUAL_ADDRESS gpu;
+   uint8_t*                  dst;
+
+   if (!texture || !texture->upload_buffer)
+      return;
+
+   dst = (uint8_t*)d3d12_upload_ring_alloc(
+         d3d12, texture->total_bytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, &gpu);
+
+   if (!dst)
+   {
+      /* too big for the ring, upload_buffer may still be read by the
+       * GPU so wait for it to go idle */
+      d3d12_wait_for_fence(d3d12, d3d12->queue.fenceValue);
+      d3d12_update_texture(width, height, pitch, format, data, texture);
+      return;
+   }
+
+   dxgi_copy(
+         width, height, format, pitch, data, texture->desc.Format,
+         texture->layout.Footprint.RowPitch, dst + texture->layout.Offset);
+
+   texture->ring_offset = gpu - d3d12->upload_ring.gpu;
+   texture->streamed    = true;
+   texture->dirty       = true;
 }
 void d3d12_upload_texture(D3D12GraphicsCommandList cmd,
       d3d12_texture_t* texture, void *userdata)
 {
-   D3D12_TEXTURE_COPY_LOCATION src = { 0 };
-   D3D12_TEXTURE_COPY_LOCATION dst = { 0 };
+   D3D12_TEXTURE_COPY_LOCATION src   = { 0 };
+   D3D12_TEXTURE_COPY_LOCATION dst   = { 0 };
+   d3d12_video_t*              d3d12 = (d3d12_video_t*)userdata;
 
    src.pResource       = texture->upload_buffer;
    src.Type            = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
    src.PlacedFootprint = texture->layout;
 
+   if (texture->streamed)
+   {
+      src.pResource               = d3d12->upload_ring.handle;
+      src.PlacedFootprint.Offset += texture->ring_offset;
+      texture->streamed           = false;
+   }
+
    dst.pResource        = texture->handle;
    dst.Type             = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
    dst.SubresourceIndex = 0;
@@ -775,8 +970,7 @@ void d3d12_upload_texture(D3D12GraphicsCommandList cmd,
 
    if (texture->desc.MipLevels > 1)
    {
-      unsigned       i;
-      d3d12_video_t* d3d12 = (d3d12_video_t*)userdata;
+      unsigned i;
 
       D3D12SetComputeRootSignature(cmd, d3d12->desc.cs_rootSignature);
       D3D12SetPipelineState(cmd, d3d12->mipmapgen_pipe);
@@ -1261,6 +1261,14 @@ D3D12GetGPUDescriptorHandleForHeapStart(D3D12DescriptorHeap descriptor_heap)
 #include "../video_driver.h"
 #include "../drivers_shader/slang_process.h"
 
+/* Frames the CPU may record while the GPU is still busy with older ones */
+#define D3D12_MAX_FRAMES_IN_FLIGHT 2
+
+/* Streamed uploads (core frames, menu textures, sprites, uniforms)
+ * that don't fit fall back to a full sync and the texture's own
+ * upload buffer. */
+#define D3D12_UPLOAD_RING_SIZE (16 * 1024 * 1024)
+
 typedef struct d3d12_vertex_t
 {
    float position[2];
@@ -1293,10 +1301,30 @@ typedef struct
    D3D12_CPU_DESCRIPTOR_HANDLE cpu; /* descriptor */
    D3D12_GPU_DESCRIPTOR_HANDLE gpu; /* descriptor */
    UINT                        stride;
-   bool*                       map;
-   int                         start;
+   /* stack of unused slots, the lowest ones on top */
+   UINT*                       free_slots;
+   UINT                        free_count;
 } d3d12_descriptor_heap_t;
 
+typedef struct
+{
+   D3D12Resource             handle;
+   uint8_t*                  map; /* mapped for the lifetime of the ring */
+   D3D12_GPU_VIRTUAL_ADDRESS gpu;
+   UINT64                    size;
+   /* head and tail only ever grow, the offset in the buffer is
+    * taken modulo size */
+   UINT64                    head;
+   UINT64                    tail;
+   /* where the allocations of each submitted frame end */
+   struct
+   {
+      UINT64 fence;
+      UINT64 head;
+   } pending[D3D12_MAX_FRAMES_IN_FLIGHT];
+   unsigned                  pending_count;
+} d3d12_upload_ring_t;
+
 typedef struct
 {
    D3D12Resource                      handle;
@@ -1312,6 +1340,10 @@ typedef struct
    UINT64                             row_size_in_bytes;
    UINT64                             total_bytes;
    d3d12_descriptor_heap_t*           srv_heap;
+   /* set by d3d12_stream_texture, the next upload reads from the
+    * upload ring at ring_offset instead of upload_buffer */
+   UINT64                             ring_offset;
+   bool                               streamed;
    bool                               dirty;
    float4_t                           size_data;
 } d3d12_texture_t;
@@ -1348,13 +1380,18 @@ typedef struct
    struct
    {
       D3D12CommandQueue        handle;
-      D3D12CommandAllocator    allocator;
+      D3D12CommandAllocator    allocator[D3D12_MAX_FRAMES_IN_FLIGHT];
+      /* fence value of the last frame recorded with each allocator */
+      UINT64                   allocator_fence[D3D12_MAX_FRAMES_IN_FLIGHT];
+      unsigned                 frame;
       D3D12GraphicsCommandList cmd;
       D3D12Fence               fence;
       HANDLE                   fenceEvent;
       UINT64                   fenceValue;
    } queue;
 
+   d3d12_upload_ring_t upload_ring;
+
    struct
    {
       D3D12RootSignature      cs_rootSignature; /* descriptor layout */
@@ -1374,6 +1411,8 @@ typedef struct
       D3D12_RECT                  scissorRect;
       float                       clearcolor[4];
       int                         frame_index;
+      UINT                        flags;
+      HANDLE                      frame_latency;
       bool                        vsync;
    } chain;
 
@@ -1407,9 +1446,8 @@ typedef struct
       D3D12PipelineState       pipe_blend;
       D3D12PipelineState       pipe_noblend;
       D3D12PipelineState       pipe_font;
-      D3D12Resource            vbo;
+      /* points at the last d3d12_alloc_sprites() allocation */
       D3D12_VERTEX_BUFFER_VIEW vbo_view;
-      int                      offset;
       int                      capacity;
       bool                     enabled;
    } sprites;
@@ -1430,16 +1468,15 @@ typedef struct
    {
       D3D12PipelineState              pipe;
       D3D12_GPU_DESCRIPTOR_HANDLE     sampler;
-      D3D12Resource                   buffers[SLANG_CBUFFER_MAX];
-      D3D12_CONSTANT_BUFFER_VIEW_DESC buffer_view[SLANG_CBUFFER_MAX];
       d3d12_texture_t                 rt;
       d3d12_texture_t                 feedback;
       D3D12_VIEWPORT                  viewport;
       D3D12_RECT                      scissorRect;
       pass_semantics_t                semantics;
       uint32_t                        frame_count;
-      D3D12_GPU_DESCRIPTOR_HANDLE     textures;
-      D3D12_GPU_DESCRIPTOR_HANDLE     samplers;
+      /* rewritten every frame, so one table per frame in flight */
+      D3D12_GPU_DESCRIPTOR_HANDLE     textures[D3D12_MAX_FRAMES_IN_FLIGHT];
+      D3D12_GPU_DESCRIPTOR_HANDLE     samplers[D3D12_MAX_FRAMES_IN_FLIGHT];
    } pass[GFX_MAX_SHADERS];
 
    struct video_shader* shader_preset;
@@ -1503,6 +1540,25 @@ bool d3d12_init_swapchain(d3d12_video_t* d3d12, int width, int height, HWND hwnd
 
 bool d3d12_init_queue(d3d12_video_t* d3d12);
 
+void d3d12_wait_for_fence(d3d12_video_t* d3d12, UINT64 value);
+
+bool d3d12_init_upload_ring(D3D12Device device, d3d12_upload_ring_t* ring, UINT64 size);
+void d3d12_release_upload_ring(d3d12_upload_ring_t* ring);
+
+/* Returns @size bytes of mapped upload memory aligned to @align (a power
+ * of two), valid until the frame they are used in completes. Waits only
+ * if the ring would run into data the GPU may still read, returns NULL
+ * if the allocation can't fit at all. */
+void* d3d12_upload_ring_alloc(
+      d3d12_video_t* d3d12, UINT64 size, UINT64 align, D3D12_GPU_VIRTUAL_ADDRESS* gpu);
+
+/* Call after signaling the fence for a submitted frame. */
+void d3d12_upload_ring_end_frame(d3d12_video_t* d3d12);
+
+/* Room for @count sprites bound as the current vertex buffer, draw them
+ * starting at vertex 0. */
+d3d12_sprite_t* d3d12_alloc_sprites(d3d12_video_t* d3d12, unsigned count);
+
 D3D12_GPU_VIRTUAL_ADDRESS
 d3d12_create_buffer(D3D12Device device, UINT size_in_bytes, D3D12Resource* buffer);
 
@@ -1517,6 +1573,16 @@ void d3d12_update_texture(
       const void*      data,
       d3d12_texture_t* texture);
 
+/* Like d3d12_update_texture, for textures updated every frame. */
+void d3d12_stream_texture(
+      d3d12_video_t*   d3d12,
+      int              width,
+      int              height,
+      int              pitch,
+      DXGI_FORMAT      format,
+      const void*      data,
+      d3d12_texture_t* texture);
+
 void d3d12_upload_texture(D3D12GraphicsCommandList cmd,
       d3d12_texture_t* texture, void *userdata);
 
@@ -334,6 +334,57 @@ void dxgi_update_title(video_frame_info_t* video_info)
    }
 }
 
+bool dxgi_check_tearing_support(void)
+{
+   BOOL           allow    = FALSE;
+   IDXGIFactory1* factory1 = NULL;
+   IDXGIFactory5* factory5 = NULL;
+
+   if (FAILED(CreateDXGIFactory1(uuidof(IDXGIFactory1), (void**)&factory1)))
+      return false;
+
+   if (SUCCEEDED(factory1->lpVtbl->QueryInterface(
+               factory1, uuidof(IDXGIFactory5), (void**)&factory5)))
+   {
+      if (FAILED(factory5->lpVtbl->CheckFeatureSupport(factory5,
+                  DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allow, sizeof(allow))))
+         allow = FALSE;
+      factory5->lpVtbl->Release(factory5);
+   }
+
+   factory1->lpVtbl->Release(factory1);
+
+   return allow == TRUE;
+}
+
+HANDLE dxgi_init_frame_latency(DXGISwapChain swap_chain, unsigned frames)
+{
+   HANDLE           frame_latency = NULL;
+   IDXGISwapChain2* swap_chain2   = NULL;
+
+   if (FAILED(swap_chain->lpVtbl->QueryInterface(
+               swap_chain, uuidof(IDXGISwapChain2), (void**)&swap_chain2)))
+      return NULL;
+
+   if (SUCCEEDED(swap_chain2->lpVtbl->SetMaximumFrameLatency(swap_chain2, frames)))
+      frame_latency = swap_chain2->lpVtbl->GetFrameLatencyWaitableObject(swap_chain2);
+
+   swap_chain2->lpVtbl->Release(swap_chain2);
+
+   if (frame_latency)
+      RARCH_LOG("[DXGI]: Waiting for the swapchain, %u frame(s) of latency.\n",
+            frames);
+
+   return frame_latency;
+}
+
+void dxgi_wait_frame_latency(HANDLE frame_latency)
+{
+   /* Time out after a second so a lost device can't hang us. */
+   if (frame_latency)
+      WaitForSingleObjectEx(frame_latency, 1000, TRUE);
+}
+
 void dxgi_input_driver(const char* name, const input_driver_t** input, void** input_data)
 {
 #ifndef __WINRT__
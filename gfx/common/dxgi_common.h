@@ -793,6 +793,16 @@ void dxgi_copy(
       void*       dst_data);
 
 void dxgi_update_title(video_frame_info_t* video_info);
+
+/* Whether flip model swapchains may tear (DXGI 1.5), which lets
+ * a variable refresh display follow the frame rate with vsync off. */
+bool dxgi_check_tearing_support(void);
+
+/* Caps the frames queued on a swapchain created with
+ * DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT and returns
+ * the object to wait on before starting a frame, NULL on failure. */
+HANDLE dxgi_init_frame_latency(DXGISwapChain swap_chain, unsigned frames);
+void dxgi_wait_frame_latency(HANDLE frame_latency);
 void dxgi_input_driver(const char* name, const input_driver_t** input, void** input_data);
 
 DXGI_FORMAT glslang_format_to_dxgi(glslang_format fmt);
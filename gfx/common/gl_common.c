@@ -21,6 +21,159 @@
 #endif
 
 #include "gl_common.h"
+#include "../../verbosity.h"
+
+#define GL_STATE_TEXTURE_UNITS 32
+
+enum gl_state_flags
+{
+   GL_STATE_PROGRAM    = (1 << 0),
+   GL_STATE_UNIT       = (1 << 1),
+   GL_STATE_BLEND      = (1 << 2),
+   GL_STATE_BLEND_FUNC = (1 << 3),
+   GL_STATE_VIEWPORT   = (1 << 4),
+   GL_STATE_VAO        = (1 << 5)
+};
+
+static struct
+{
+   uint32_t known;
+   uint32_t textures_known;
+   GLuint program;
+   GLuint vao;
+   GLuint textures[GL_STATE_TEXTURE_UNITS];
+   unsigned unit;
+   GLenum blend_src;
+   GLenum blend_dst;
+   GLint viewport[4];
+   bool blend;
+   unsigned calls;
+   unsigned avoided;
+} gl_state;
+
+#define GL_STATE_CHANGED(flag, same) \
+   (gl_state.calls++, \
+    ((gl_state.known & (flag)) && (same)) ? (gl_state.avoided++, false) \
+    : (gl_state.known |= (flag), true))
+
+void gl_state_invalidate(void)
+{
+   gl_state.known          = 0;
+   gl_state.textures_known = 0;
+}
+
+void gl_state_use_program(GLuint program)
+{
+   if (!GL_STATE_CHANGED(GL_STATE_PROGRAM, gl_state.program == program))
+      return;
+   gl_state.program = program;
+   glUseProgram(program);
+}
+
+void gl_state_active_texture(GLenum unit)
+{
+   if (!GL_STATE_CHANGED(GL_STATE_UNIT,
+            gl_state.unit == (unsigned)(unit - GL_TEXTURE0)))
+      return;
+   gl_state.unit = (unsigned)(unit - GL_TEXTURE0);
+   glActiveTexture(unit);
+}
+
+void gl_state_bind_texture(GLenum target, GLuint texture)
+{
+   unsigned unit = gl_state.unit;
+
+   /* Only GL_TEXTURE_2D on a known unit is tracked. */
+   if (     target != GL_TEXTURE_2D
+         || !(gl_state.known & GL_STATE_UNIT)
+         || unit >= GL_STATE_TEXTURE_UNITS)
+   {
+      glBindTexture(target, texture);
+      return;
+   }
+
+   gl_state.calls++;
+   if (     (gl_state.textures_known & (1u << unit))
+         && gl_state.textures[unit] == texture)
+   {
+      gl_state.avoided++;
+      return;
+   }
+
+   gl_state.textures_known |= 1u << unit;
+   gl_state.textures[unit]  = texture;
+   glBindTexture(target, texture);
+}
+
+void gl_state_delete_textures(GLsizei n, const GLuint *textures)
+{
+   GLsizei i;
+   unsigned unit;
+
+   /* Deleting a texture unbinds it, and its name can come
+    * back from the next glGenTextures. */
+   for (i = 0; i < n; i++)
+      for (unit = 0; unit < GL_STATE_TEXTURE_UNITS; unit++)
+         if (gl_state.textures[unit] == textures[i])
+            gl_state.textures[unit] = 0;
+
+   glDeleteTextures(n, textures);
+}
+
+void gl_state_blend(bool enable)
+{
+   if (!GL_STATE_CHANGED(GL_STATE_BLEND, gl_state.blend == enable))
+      return;
+   gl_state.blend = enable;
+   if (enable)
+      glEnable(GL_BLEND);
+   else
+      glDisable(GL_BLEND);
+}
+
+void gl_state_blend_func(GLenum sfactor, GLenum dfactor)
+{
+   if (!GL_STATE_CHANGED(GL_STATE_BLEND_FUNC,
+            gl_state.blend_src == sfactor && gl_state.blend_dst == dfactor))
+      return;
+   gl_state.blend_src = sfactor;
+   gl_state.blend_dst = dfactor;
+   glBlendFunc(sfactor, dfactor);
+}
+
+void gl_state_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+   if (!GL_STATE_CHANGED(GL_STATE_VIEWPORT,
+               gl_state.viewport[0] == x
+            && gl_state.viewport[1] == y
+            && gl_state.viewport[2] == width
+            && gl_state.viewport[3] == height))
+      return;
+   gl_state.viewport[0] = x;
+   gl_state.viewport[1] = y;
+   gl_state.viewport[2] = width;
+   gl_state.viewport[3] = height;
+   glViewport(x, y, width, height);
+}
+
+#ifndef HAVE_OPENGLES
+void gl_state_bind_vertex_array(GLuint vao)
+{
+   if (!GL_STATE_CHANGED(GL_STATE_VAO, gl_state.vao == vao))
+      return;
+   gl_state.vao = vao;
+   glBindVertexArray(vao);
+}
+#endif
+
+void gl_state_log_stats(void)
+{
+   if (gl_state.calls)
+      RARCH_LOG("[GL]: State cache kept %u of %u calls from the driver.\n",
+            gl_state.avoided, gl_state.calls);
+   gl_state.calls   = 0;
+   gl_state.avoided = 0;
+}
 
 static void gl_size_format(GLint* internalFormat)
 {
@@ -200,6 +200,10 @@ struct gl_renderchain_driver
    void (*deinit_fbo)(gl_t *gl, void *chain_data);
    bool (*read_viewport)(
          gl_t *gl, void *chain_data, uint8_t *buffer, bool is_idle);
+   /* Reads the last frame of a hardware rendered core from its
+    * framebuffer, bottom-up in BGR24 like read_viewport. */
+   bool (*read_hw_frame)(gl_t *gl, void *chain_data, uint8_t *buffer,
+         unsigned width, unsigned height);
    void (*bind_prev_texture)(
          gl_t *gl,
          void *chain_data,
@@ -225,6 +229,8 @@ struct gl_renderchain_driver
          uint64_t frame_count,
          const struct video_tex_info *tex_info,
          const struct video_tex_info *feedback_info);
+   /* Marks the start of the first pass, for GPU timings */
+   void (*start_timer)(gl_t *gl, void *chain_data);
    void (*resolve_extensions)(
          gl_t *gl,
          void *chain_data,
@@ -260,6 +266,7 @@ struct gl
 
    bool overlay_enable;
    bool overlay_full_screen;
+   bool overlay_atlas;
    bool menu_texture_enable;
    bool menu_texture_full_screen;
    bool have_sync;
@@ -293,6 +300,11 @@ struct gl
    unsigned pbo_readback_index;
    unsigned last_width[GFX_MAX_TEXTURES];
    unsigned last_height[GFX_MAX_TEXTURES];
+   /* What menu_texture was last allocated with */
+   unsigned menu_texture_width;
+   unsigned menu_texture_height;
+   unsigned menu_texture_base_size;
+   enum texture_filter_type menu_texture_filter;
 
    float menu_texture_alpha;
 
@@ -304,6 +316,7 @@ struct gl
    float *overlay_vertex_coord;
    float *overlay_tex_coord;
    float *overlay_color_coord;
+   GLushort *overlay_indices;
 
    struct video_tex_info tex_info;
    struct scaler_ctx pbo_readback_scaler;
@@ -321,10 +334,37 @@ struct gl
    const gfx_ctx_driver_t *ctx_driver;
 };
 
+/* Shadow copy of the state the frontend changes all the time, the
+ * gl_state_* calls only reach the driver when something changes.
+ * Whatever changes this state behind our back (hardware rendered
+ * cores, context switches, Cg) has to call gl_state_invalidate(). */
+void gl_state_invalidate(void);
+
+void gl_state_use_program(GLuint program);
+
+void gl_state_active_texture(GLenum unit);
+
+void gl_state_bind_texture(GLenum target, GLuint texture);
+
+void gl_state_delete_textures(GLsizei n, const GLuint *textures);
+
+void gl_state_blend(bool enable);
+
+void gl_state_blend_func(GLenum sfactor, GLenum dfactor);
+
+void gl_state_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+#ifndef HAVE_OPENGLES
+void gl_state_bind_vertex_array(GLuint vao);
+#endif
+
+/* Logs how many calls the cache kept from the driver and resets the counters. */
+void gl_state_log_stats(void);
+
 static INLINE void gl_bind_texture(GLuint id, GLint wrap_mode, GLint mag_filter,
       GLint min_filter)
 {
-   glBindTexture(GL_TEXTURE_2D, id);
+   gl_state_bind_texture(GL_TEXTURE_2D, id);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_mode);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_mode);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
@@ -34,6 +34,11 @@ typedef struct
 /*! @brief Specifies whether rendering is synchronized with the display */
 @property (nonatomic, readwrite) bool displaySyncEnabled;
 
+/*! @brief Shortest time a frame stays on screen, in seconds, 0 to present
+ * on the next vsync. Lets a ProMotion display run at the content rate.
+ * */
+@property (nonatomic, readwrite) NSTimeInterval minimumPresentInterval;
+
 /*! @brief captureEnabled allows previous frames to be read */
 @property (nonatomic, readwrite) bool captureEnabled;
 
@@ -70,6 +75,13 @@ typedef struct
 
 - (bool)allocRange:(BufferRange *)range length:(NSUInteger)length;
 
+/*! @brief copies @a src into @a dst through the current frame's buffer chain, so
+ * the CPU never writes a texture the GPU may still be reading
+ * */
+- (void)uploadBytes:(void const *)src pitch:(NSUInteger)pitch
+              width:(NSUInteger)width height:(NSUInteger)height
+          toTexture:(id<MTLTexture>)dst;
+
 /*! @brief begin marks the beginning of a frame */
 - (void)begin;
 
@@ -10,6 +10,8 @@
 #import "Filter.h"
 #import <QuartzCore/QuartzCore.h>
 
+#include "../../video_pacing.h"
+
 @interface BufferNode : NSObject
 @property (nonatomic, readonly) id<MTLBuffer> src;
 @property (nonatomic, readwrite) NSUInteger allocated;
@@ -23,6 +25,16 @@
 - (void)discard;
 @end
 
+/* Written from the drawables' presented handlers, which run on
+ * another thread and may outlive the context. */
+@interface PresentTimes : NSObject
+{
+@public
+   CFTimeInterval time;
+   uint64_t count;
+}
+@end
+
 @interface Texture()
 @property (nonatomic, readwrite) id<MTLTexture> texture;
 @property (nonatomic, readwrite) id<MTLSamplerState> sampler;
@@ -36,6 +48,7 @@
 {
    dispatch_semaphore_t _inflightSemaphore;
    id<MTLCommandQueue> _commandQueue;
+   bool _displaySyncEnabled;
    CAMetalLayer *_layer;
    id<CAMetalDrawable> _drawable;
    video_viewport_t _viewport;
@@ -46,9 +59,11 @@
    id<MTLRenderCommandEncoder> _rce;
    
    id<MTLCommandBuffer> _blitCommandBuffer;
+   id<MTLCommandBuffer> _lastCommandBuffer;
    
    NSUInteger _currentChain;
    BufferChain *_chain[CHAIN_LENGTH];
+   bool _chainAcquired;
    MTLClearColor _clearColor;
    
    id<MTLRenderPipelineState> _states[GFX_MAX_SHADERS][2];
@@ -63,6 +78,10 @@
    
    Uniforms _uniforms;
    Uniforms _uniformsNoRotate;
+   
+   PresentTimes *_presents;
+   uint64_t _reportedCount;
+   bool _displayTiming;
 }
 
 - (instancetype)initWithDevice:(id<MTLDevice>)d
@@ -72,8 +91,10 @@
    if (self = [super init])
    {
       _inflightSemaphore = dispatch_semaphore_create(MAX_INFLIGHT);
+      _presents = [PresentTimes new];
       _device = d;
       _layer = layer;
+      _displaySyncEnabled = YES;
 #if TARGET_OS_OSX
       _layer.displaySyncEnabled = YES;
 #endif
@@ -162,8 +183,15 @@
    _uniformsNoRotate.projectionMatrix = _mvp_no_rot;
 }
 
+- (void)dealloc
+{
+   if (_displayTiming)
+      video_pacing_set_display_timing(false);
+}
+
 - (void)setDisplaySyncEnabled:(bool)displaySyncEnabled
 {
+   _displaySyncEnabled = displaySyncEnabled;
 #if TARGET_OS_OSX
    _layer.displaySyncEnabled = displaySyncEnabled;
 #endif
@@ -171,9 +199,7 @@
 
 - (bool)displaySyncEnabled
 {
-#if TARGET_OS_OSX
-   return _layer.displaySyncEnabled;
-#endif
+   return _displaySyncEnabled;
 }
 
 #pragma mark - shaders
@@ -499,10 +525,22 @@
    return _blitCommandBuffer;
 }
 
+/* Waits for the frame which last used the current chain. Uploads may
+ * come in before begin, e.g. the menu texture, so allocations do this
+ * too. */
+- (void)_acquireChain
+{
+   if (_chainAcquired)
+      return;
+   dispatch_semaphore_wait(_inflightSemaphore, DISPATCH_TIME_FOREVER);
+   [_chain[_currentChain] discard];
+   _chainAcquired = YES;
+}
+
 - (void)_nextChain
 {
    _currentChain = (_currentChain + 1) % CHAIN_LENGTH;
-   [_chain[_currentChain] discard];
+   _chainAcquired = NO;
 }
 
 - (void)setCaptureEnabled:(bool)captureEnabled
@@ -524,6 +562,9 @@
    if (!_captureEnabled || _backBuffer == nil)
       return NO;
    
+   // the frame is still in flight
+   [_lastCommandBuffer waitUntilCompleted];
+   
    if (_backBuffer.pixelFormat != MTLPixelFormatBGRA8Unorm)
    {
       RARCH_WARN("[Metal]: unexpected pixel format %d\n", _backBuffer.pixelFormat);
@@ -558,10 +599,35 @@
    return YES;
 }
 
+- (void)_reportPresents
+{
+   CFTimeInterval time;
+   uint64_t count;
+   
+   @synchronized (_presents)
+   {
+      time = _presents->time;
+      count = _presents->count;
+   }
+   
+   if (count == _reportedCount)
+      return;
+   
+   if (!_displayTiming)
+   {
+      video_pacing_set_display_timing(true);
+      _displayTiming = YES;
+   }
+   
+   video_pacing_present((retro_time_t)(time * 1000000.0), (unsigned)(count - _reportedCount));
+   _reportedCount = count;
+}
+
 - (void)begin
 {
    assert(_commandBuffer == nil);
-   dispatch_semaphore_wait(_inflightSemaphore, DISPATCH_TIME_FOREVER);
+   [self _acquireChain];
+   [self _reportPresents];
    _commandBuffer = [_commandQueue commandBuffer];
    _backBuffer = nil;
 }
@@ -638,9 +704,9 @@
    
    if (_blitCommandBuffer)
    {
-      // pending blits for mipmaps or render passes for slang shaders
+      // pending uploads, blits for mipmaps or render passes for slang shaders,
+      // the queue runs it ahead of the frame's command buffer
       [_blitCommandBuffer commit];
-      [_blitCommandBuffer waitUntilCompleted];
       _blitCommandBuffer = nil;
    }
    
@@ -655,13 +721,38 @@
       dispatch_semaphore_signal(inflight);
    }];
    
-   if (self.nextDrawable)
+   id<CAMetalDrawable> drawable = self.nextDrawable;
+   if (drawable)
    {
-      [_commandBuffer presentDrawable:self.nextDrawable];
+      if ([drawable respondsToSelector:@selector(addPresentedHandler:)])
+      {
+         PresentTimes *presents = _presents;
+         [drawable addPresentedHandler:^(id<MTLDrawable> d) {
+            // 0 means the frame was dropped and never shown
+            if (d.presentedTime == 0)
+               return;
+            @synchronized (presents)
+            {
+               presents->time = d.presentedTime;
+               presents->count++;
+            }
+         }];
+      }
+      
+      if (_minimumPresentInterval > 0 && _displaySyncEnabled &&
+          [_commandBuffer respondsToSelector:@selector(presentDrawable:afterMinimumDuration:)])
+      {
+         [_commandBuffer presentDrawable:drawable afterMinimumDuration:_minimumPresentInterval];
+      }
+      else
+      {
+         [_commandBuffer presentDrawable:drawable];
+      }
    }
    
    [_commandBuffer commit];
    
+   _lastCommandBuffer = _commandBuffer;
    _commandBuffer = nil;
    _drawable = nil;
    [self _nextChain];
@@ -669,14 +760,47 @@
 
 - (bool)allocRange:(BufferRange *)range length:(NSUInteger)length
 {
+   [self _acquireChain];
    return [_chain[_currentChain] allocRange:range length:length];
 }
 
+- (void)uploadBytes:(void const *)src pitch:(NSUInteger)pitch
+              width:(NSUInteger)width height:(NSUInteger)height
+          toTexture:(id<MTLTexture>)dst
+{
+   BufferRange range;
+   
+   if (![self allocRange:&range length:pitch * height])
+   {
+      [dst replaceRegion:MTLRegionMake2D(0, 0, width, height)
+             mipmapLevel:0 withBytes:src
+             bytesPerRow:pitch];
+      return;
+   }
+   
+   memcpy(range.data, src, pitch * height);
+   
+   id<MTLBlitCommandEncoder> bce = [self.blitCommandBuffer blitCommandEncoder];
+   [bce copyFromBuffer:range.buffer
+          sourceOffset:range.offset
+     sourceBytesPerRow:pitch
+   sourceBytesPerImage:pitch * height
+            sourceSize:MTLSizeMake(width, height, 1)
+             toTexture:dst
+      destinationSlice:0
+      destinationLevel:0
+     destinationOrigin:MTLOriginMake(0, 0, 0)];
+   [bce endEncoding];
+}
+
 @end
 
 @implementation Texture
 @end
 
+@implementation PresentTimes
+@end
+
 @implementation BufferNode
 
 - (instancetype)initWithBuffer:(id<MTLBuffer>)src
@@ -699,6 +823,7 @@
    BufferNode *_current;
    NSUInteger _length;
    NSUInteger _allocated;
+   bool _shared;
 }
 
 /* macOS requires constants in a buffer to have a 256 byte alignment. */
@@ -715,6 +840,14 @@ static const NSUInteger kConstantAlignment = 4;
    {
       _device = device;
       _blockLen = blockLen;
+#if TARGET_OS_OSX
+      // Apple Silicon: CPU and GPU see the same memory, managed
+      // buffers would only add a copy
+      if ([device respondsToSelector:@selector(hasUnifiedMemory)])
+         _shared = device.hasUnifiedMemory;
+#else
+      _shared = YES;
+#endif
    }
    return self;
 }
@@ -727,6 +860,9 @@ static const NSUInteger kConstantAlignment = 4;
 - (void)commitRanges
 {
 #if TARGET_OS_OSX
+   if (_shared)
+      return;
+   
    for (BufferNode *n = _head; n != nil; n = n.next)
    {
       if (n.allocated > 0)
@@ -749,7 +885,7 @@ static const NSUInteger kConstantAlignment = 4;
    bzero(range, sizeof(*range));
 
 #if TARGET_OS_OSX
-   MTLResourceOptions opts = MTLResourceStorageModeManaged;
+   MTLResourceOptions opts = _shared ? MTLResourceStorageModeShared : MTLResourceStorageModeManaged;
 #else
    MTLResourceOptions opts = MTLResourceStorageModeShared;
 #endif
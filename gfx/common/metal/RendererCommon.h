@@ -12,10 +12,9 @@
 #import <Foundation/Foundation.h>
 #import "ShaderTypes.h"
 
-// TODO(sgc): implement triple buffering
-/*! @brief maximum inflight frames */
-#define MAX_INFLIGHT 1
-#define CHAIN_LENGTH 3
+/*! @brief maximum inflight frames, each one gets its own buffer chain */
+#define MAX_INFLIGHT 3
+#define CHAIN_LENGTH MAX_INFLIGHT
 
 /* macOS requires constants in a buffer to have a 256 byte alignment. */
 #ifdef TARGET_OS_MAC
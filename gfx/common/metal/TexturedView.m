@@ -131,17 +131,18 @@
 
 - (void)updateFrame:(void const *)src pitch:(NSUInteger)pitch
 {
+   /* pitch is in bytes, like FrameView's */
    if (_format == RPixelFormatBGRA8Unorm || _format == RPixelFormatBGRX8Unorm)
    {
-      [_texture replaceRegion:MTLRegionMake2D(0, 0, (NSUInteger)_size.width, (NSUInteger)_size.height)
-                  mipmapLevel:0 withBytes:src
-                  bytesPerRow:(NSUInteger)(4 * pitch)];
+      [_context uploadBytes:src pitch:pitch
+                      width:(NSUInteger)_size.width height:(NSUInteger)_size.height
+                  toTexture:_texture];
    }
    else
    {
-      [_src replaceRegion:MTLRegionMake2D(0, 0, (NSUInteger)_size.width, (NSUInteger)_size.height)
-              mipmapLevel:0 withBytes:src
-              bytesPerRow:(NSUInteger)(pitch)];
+      [_context uploadBytes:src pitch:pitch
+                      width:(NSUInteger)_size.width height:(NSUInteger)_size.height
+                  toTexture:_src];
       _srcDirty = YES;
    }
 }
@@ -74,6 +74,9 @@
    // other state
    Uniforms _uniforms;
    Uniforms _viewportMVP;
+   
+   // fastest refresh rate of the display, above 60 on ProMotion ones
+   NSInteger _maximumFramesPerSecond;
 }
 
 - (instancetype)initWithVideo:(const video_info_t *)video
@@ -88,6 +91,14 @@
       view.delegate = self;
       _layer = (CAMetalLayer *)view.layer;
       
+#if TARGET_OS_OSX
+      NSScreen *screen = NSScreen.mainScreen;
+#else
+      UIScreen *screen = UIScreen.mainScreen;
+#endif
+      if ([screen respondsToSelector:@selector(maximumFramesPerSecond)])
+         _maximumFramesPerSecond = screen.maximumFramesPerSecond;
+      
       if (![self _initMetal])
       {
          return nil;
@@ -287,6 +298,7 @@
       if (msg && *msg)
          [self _renderMessage:msg info:video_info];
       
+      _context.minimumPresentInterval = [self _minimumPresentInterval:video_info];
       [self _endFrame];
    }
    
@@ -329,6 +341,20 @@
    font_driver_render_msg(video_info, NULL, msg, NULL);
 }
 
+/* A ProMotion display can hold each frame for exactly as long as the
+ * content wants instead of presenting on the next 120 Hz vsync, which
+ * makes 24 or 50 fps content judder. Elsewhere vsync alone paces. */
+- (NSTimeInterval)_minimumPresentInterval:(video_frame_info_t *)video_info
+{
+   struct retro_system_av_info *av_info = video_viewport_get_system_av_info();
+   
+   if (_maximumFramesPerSecond <= 60 || !_context.displaySyncEnabled ||
+       !av_info || av_info->timing.fps <= 0)
+      return 0;
+   
+   return MAX(_video.swap_interval, 1) / av_info->timing.fps;
+}
+
 - (void)_beginFrame
 {
    video_viewport_t vp = *_viewport;
@@ -532,7 +558,6 @@ typedef struct MTLALIGN(16)
    
    struct
    {
-      __unsafe_unretained id<MTLBuffer> buffers[SLANG_CBUFFER_MAX];
       texture_t rt;
       texture_t feedback;
       uint32_t frame_count;
@@ -808,18 +833,19 @@ typedef struct MTLALIGN(16)
    
    [self _updateHistory];
    
+   /* Earlier frames may still be in flight, so the frame goes through
+    * the context's buffer chain rather than straight into the texture */
    if (_format == RPixelFormatBGRA8Unorm || _format == RPixelFormatBGRX8Unorm)
    {
-      id<MTLTexture> tex = _engine.frame.texture[0].view;
-      [tex replaceRegion:MTLRegionMake2D(0, 0, (NSUInteger)_size.width, (NSUInteger)_size.height)
-             mipmapLevel:0 withBytes:src
-             bytesPerRow:pitch];
+      [_context uploadBytes:src pitch:pitch
+                      width:(NSUInteger)_size.width height:(NSUInteger)_size.height
+                  toTexture:_engine.frame.texture[0].view];
    }
    else
    {
-      [_src replaceRegion:MTLRegionMake2D(0, 0, (NSUInteger)_size.width, (NSUInteger)_size.height)
-              mipmapLevel:0 withBytes:src
-              bytesPerRow:(NSUInteger)(pitch)];
+      [_context uploadBytes:src pitch:pitch
+                      width:(NSUInteger)_size.width height:(NSUInteger)_size.height
+                  toTexture:_src];
       _srcDirty = YES;
    }
 }
@@ -913,27 +939,28 @@ typedef struct MTLALIGN(16)
       
       for (unsigned j = 0; j < SLANG_CBUFFER_MAX; j++)
       {
-         id<MTLBuffer> buffer = _engine.pass[i].buffers[j];
+         BufferRange range;
          cbuffer_sem_t *buffer_sem = &_engine.pass[i].semantics.cbuffers[j];
          
-         if (buffer_sem->stage_mask && buffer_sem->uniforms)
+         /* a fresh range per frame, the previous ones may still be read */
+         if (buffer_sem->stage_mask && buffer_sem->uniforms && buffer_sem->size &&
+             [_context allocRange:&range length:buffer_sem->size])
          {
-            void *data = buffer.contents;
             uniform_sem_t *uniform = buffer_sem->uniforms;
             
+            memset(range.data, 0, buffer_sem->size);
             while (uniform->size)
             {
                if (uniform->data)
-                  memcpy((uint8_t *)data + uniform->offset, uniform->data, uniform->size);
+                  memcpy((uint8_t *)range.data + uniform->offset, uniform->data, uniform->size);
                uniform++;
             }
             
             if (buffer_sem->stage_mask & SLANG_STAGE_VERTEX_MASK)
-               [rce setVertexBuffer:buffer offset:0 atIndex:buffer_sem->binding];
+               [rce setVertexBuffer:range.buffer offset:range.offset atIndex:buffer_sem->binding];
             
             if (buffer_sem->stage_mask & SLANG_STAGE_FRAGMENT_MASK)
-               [rce setFragmentBuffer:buffer offset:0 atIndex:buffer_sem->binding];
-            [buffer didModifyRange:NSMakeRange(0, buffer.length)];
+               [rce setFragmentBuffer:range.buffer offset:range.offset atIndex:buffer_sem->binding];
          }
       }
       
@@ -1097,11 +1124,6 @@ typedef struct MTLALIGN(16)
       memset(&_engine.pass[i].feedback, 0, sizeof(_engine.pass[i].feedback));
       
       STRUCT_ASSIGN(_engine.pass[i]._state, nil);
-      
-      for (unsigned j = 0; j < SLANG_CBUFFER_MAX; j++)
-      {
-         STRUCT_ASSIGN(_engine.pass[i].buffers[j], nil);
-      }
    }
    
    for (int i = 0; i < GFX_MAX_TEXTURES; i++)
@@ -1250,18 +1272,6 @@ typedef struct MTLALIGN(16)
                          err.localizedDescription.UTF8String);
                return NO;
             }
-            
-            for (unsigned j = 0; j < SLANG_CBUFFER_MAX; j++)
-            {
-               unsigned int size = _engine.pass[i].semantics.cbuffers[j].size;
-               if (size == 0)
-               {
-                  continue;
-               }
-               
-               id<MTLBuffer> buf = [_context.device newBufferWithLength:size options:MTLResourceStorageModeManaged];
-               STRUCT_ASSIGN(_engine.pass[i].buffers[j], buf);
-            }
          } @finally
          {
             if (save_msl)
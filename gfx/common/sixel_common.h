@@ -31,6 +31,18 @@ typedef struct sixel
    unsigned screen_height;
    void *ctx_data;
    const gfx_ctx_driver_t *ctx_driver;
+
+   /* Incremental output, see sixel_output_frame() */
+   sixel_output_t *output;
+   sixel_dither_t *dither;
+   unsigned *prev_buf;
+   unsigned *region_buf;
+   unsigned *band_spans;
+   unsigned cell_width;
+   unsigned cell_height;
+   unsigned band_height;
+   int prev_pixfmt;
+   bool full_redraw;
 } sixel_t;
 
 #endif
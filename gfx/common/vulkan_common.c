@@ -28,6 +28,7 @@
 #endif
 
 #include "vulkan_common.h"
+#include "../video_pacing.h"
 #include "../../libretro-common/include/retro_timers.h"
 #include "../../configuration.h"
 #include "../include/vulkan/vulkan.h"
@@ -595,14 +596,31 @@ struct vk_texture vulkan_create_texture(vk_t *vk,
          break;
 
       default:
+         alloc.memoryTypeIndex = VK_MAX_MEMORY_TYPES;
+
+         /* On unified memory the image we write the frame into
+          * is sampled in place, so it has to be device local too. */
+         if (type == VULKAN_TEXTURE_STREAMED && vk->context->unified_memory)
+            alloc.memoryTypeIndex = vulkan_find_memory_type_fallback(
+                  &vk->context->memory_properties,
+                  mem_reqs.memoryTypeBits,
+                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                  VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+
          /* Try to find a memory type which is cached, even if it means manual cache management. */
-         alloc.memoryTypeIndex = vulkan_find_memory_type_fallback(
-               &vk->context->memory_properties,
-               mem_reqs.memoryTypeBits,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-               VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+         if (alloc.memoryTypeIndex >= VK_MAX_MEMORY_TYPES ||
+               (vk->context->memory_properties.memoryTypes[alloc.memoryTypeIndex].propertyFlags &
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0)
+            alloc.memoryTypeIndex = vulkan_find_memory_type_fallback(
+                  &vk->context->memory_properties,
+                  mem_reqs.memoryTypeBits,
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                  VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
          tex.need_manual_cache_management =
             (vk->context->memory_properties.memoryTypes[alloc.memoryTypeIndex].propertyFlags &
@@ -918,7 +936,7 @@ static void vulkan_write_quad_descriptors(
    write.dstSet                    = set;
    write.dstBinding                = 0;
    write.descriptorCount           = 1;
-   write.descriptorType            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+   write.descriptorType            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
    write.pBufferInfo               = &buffer_info;
    vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
 
@@ -939,6 +957,134 @@ static void vulkan_write_quad_descriptors(
    }
 }
 
+void vulkan_descriptor_cache_reset(struct vk_descriptor_cache *cache)
+{
+   cache->count = 0;
+
+   /* Entries are only valid for the frame they were added in */
+   if (++cache->frame == 0)
+   {
+      memset(cache->entries, 0, sizeof(cache->entries));
+      cache->frame = 1;
+   }
+}
+
+static uint32_t vulkan_descriptor_cache_hash(
+      const struct vk_descriptor_cache_key *key)
+{
+   size_t i;
+   const uint8_t *p = (const uint8_t*)key;
+   uint32_t hash    = 2166136261u;
+
+   for (i = 0; i < sizeof(*key); i++)
+      hash = (hash ^ p[i]) * 16777619u;
+
+   return hash;
+}
+
+/* Returns the set for @key, writing a new one the first time it is
+ * needed this frame. */
+static VkDescriptorSet vulkan_descriptor_cache_get(vk_t *vk,
+      const struct vk_descriptor_cache_key *key,
+      const struct vk_texture *texture)
+{
+   VkDescriptorSet set;
+   struct vk_descriptor_cache *cache = &vk->chain->descriptor_cache;
+   struct vk_descriptor_cache_entry *free_entry = NULL;
+   uint32_t hash = vulkan_descriptor_cache_hash(key);
+   unsigned i;
+
+   for (i = 0; i < VULKAN_DESCRIPTOR_CACHE_SIZE; i++)
+   {
+      struct vk_descriptor_cache_entry *entry = &cache->entries[
+         (hash + i) & (VULKAN_DESCRIPTOR_CACHE_SIZE - 1)];
+
+      if (entry->frame != cache->frame)
+      {
+         free_entry = entry;
+         break;
+      }
+
+      if (!memcmp(&entry->key, key, sizeof(*key)))
+         return entry->set;
+   }
+
+   set = vulkan_descriptor_manager_alloc(vk->context->device,
+         &vk->chain->descriptor_manager);
+
+   vulkan_write_quad_descriptors(vk->context->device, set,
+         key->buffer, 0, key->range, texture, key->sampler);
+
+   /* Keep probes short, a frame with more different sets than that
+    * writes the rest every time. */
+   if (free_entry && cache->count < VULKAN_DESCRIPTOR_CACHE_SIZE * 3 / 4)
+   {
+      free_entry->key   = *key;
+      free_entry->set   = set;
+      free_entry->frame = cache->frame;
+      cache->count++;
+   }
+
+   return set;
+}
+
+/* Uploads @uniform unless it is the same as the last one, and binds
+ * a set with it and @texture. */
+static bool vulkan_bind_descriptors(vk_t *vk,
+      const void *uniform, size_t uniform_size,
+      const struct vk_texture *texture, VkSampler sampler)
+{
+   struct vk_descriptor_cache_key key;
+   VkDescriptorSet set;
+   uint32_t offset;
+
+   if (     vk->tracker.uniform_buffer == VK_NULL_HANDLE
+         || vk->tracker.uniform_size   != uniform_size
+         || uniform_size > VULKAN_TRACKER_UNIFORM_SIZE
+         || memcmp(vk->tracker.uniform, uniform, uniform_size))
+   {
+      struct vk_buffer_range range;
+
+      if (!vulkan_buffer_chain_alloc(vk->context, &vk->chain->ubo,
+               uniform_size, &range))
+         return false;
+
+      memcpy(range.data, uniform, uniform_size);
+
+      vk->tracker.uniform_buffer = range.buffer;
+      vk->tracker.uniform_offset = range.offset;
+      vk->tracker.uniform_size   = uniform_size;
+      if (uniform_size <= VULKAN_TRACKER_UNIFORM_SIZE)
+         memcpy(vk->tracker.uniform, uniform, uniform_size);
+   }
+
+   /* Padding is hashed too */
+   memset(&key, 0, sizeof(key));
+   key.buffer  = vk->tracker.uniform_buffer;
+   key.range   = uniform_size;
+   if (texture)
+   {
+      key.view    = texture->view;
+      key.layout  = texture->layout;
+      key.sampler = sampler;
+   }
+
+   set    = vulkan_descriptor_cache_get(vk, &key, texture);
+   offset = (uint32_t)vk->tracker.uniform_offset;
+
+   if (set != vk->tracker.set || offset != vk->tracker.set_offset)
+   {
+      vkCmdBindDescriptorSets(vk->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            vk->pipelines.layout, 0,
+            1, &set, 1, &offset);
+
+      vk->tracker.set        = set;
+      vk->tracker.set_offset = offset;
+   }
+
+   return true;
+}
+
 void vulkan_transition_texture(vk_t *vk, VkCommandBuffer cmd, struct vk_texture *texture)
 {
    if (!texture->image)
@@ -1016,39 +1162,9 @@ void vulkan_draw_triangles(vk_t *vk, const struct vk_draw_triangles *call)
 
    vulkan_check_dynamic_state(vk);
 
-   /* Upload descriptors */
-   {
-      VkDescriptorSet set;
-
-      /* Upload UBO */
-      struct vk_buffer_range range;
-      if (!vulkan_buffer_chain_alloc(vk->context, &vk->chain->ubo,
-               call->uniform_size, &range))
-         return;
-
-      memcpy(range.data, call->uniform, call->uniform_size);
-
-      set = vulkan_descriptor_manager_alloc(
-            vk->context->device,
-            &vk->chain->descriptor_manager);
-
-      vulkan_write_quad_descriptors(
-            vk->context->device,
-            set,
-            range.buffer,
-            range.offset,
-            call->uniform_size,
-            call->texture,
-            call->sampler);
-
-      vkCmdBindDescriptorSets(vk->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-            vk->pipelines.layout, 0,
-            1, &set, 0, NULL);
-
-      vk->tracker.view = VK_NULL_HANDLE;
-      vk->tracker.sampler = VK_NULL_HANDLE;
-      memset(&vk->tracker.mvp, 0, sizeof(vk->tracker.mvp));
-   }
+   if (!vulkan_bind_descriptors(vk, call->uniform, call->uniform_size,
+            call->texture, call->sampler))
+      return;
 
    /* VBO is already uploaded. */
    vkCmdBindVertexBuffers(vk->cmd, 0, 1,
@@ -1074,52 +1190,9 @@ void vulkan_draw_quad(vk_t *vk, const struct vk_draw_quad *quad)
 
    vulkan_check_dynamic_state(vk);
 
-   /* Upload descriptors */
-   {
-      VkDescriptorSet set;
-      struct vk_buffer_range range;
-
-      if (!vulkan_buffer_chain_alloc(vk->context, &vk->chain->ubo,
-               sizeof(*quad->mvp), &range))
-         return;
-
-      if (
-               string_is_equal_fast(quad->mvp,
-                  &vk->tracker.mvp, sizeof(*quad->mvp))
-            || quad->texture->view != vk->tracker.view
-            || quad->sampler != vk->tracker.sampler)
-      {
-         /* Upload UBO */
-         struct vk_buffer_range range;
-
-         if (!vulkan_buffer_chain_alloc(vk->context, &vk->chain->ubo,
-                  sizeof(*quad->mvp), &range))
-            return;
-
-         memcpy(range.data, quad->mvp, sizeof(*quad->mvp));
-
-         set = vulkan_descriptor_manager_alloc(
-               vk->context->device,
-               &vk->chain->descriptor_manager);
-
-         vulkan_write_quad_descriptors(
-               vk->context->device,
-               set,
-               range.buffer,
-               range.offset,
-               sizeof(*quad->mvp),
-               quad->texture,
-               quad->sampler);
-
-         vkCmdBindDescriptorSets(vk->cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-               vk->pipelines.layout, 0,
-               1, &set, 0, NULL);
-
-         vk->tracker.view    = quad->texture->view;
-         vk->tracker.sampler = quad->sampler;
-         vk->tracker.mvp     = *quad->mvp;
-      }
-   }
+   if (!vulkan_bind_descriptors(vk, quad->mvp, sizeof(*quad->mvp),
+            quad->texture, quad->sampler))
+      return;
 
    /* Upload VBO */
    {
@@ -1489,6 +1562,17 @@ static bool vulkan_load_device_symbols(gfx_ctx_vulkan_data_t *vk)
    VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(vk->context.device, vkGetSwapchainImagesKHR);
    VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(vk->context.device, vkAcquireNextImageKHR);
    VULKAN_SYMBOL_WRAPPER_LOAD_DEVICE_EXTENSION_SYMBOL(vk->context.device, vkQueuePresentKHR);
+
+   if (vk->context.display_timing)
+   {
+      vulkan_symbol_wrapper_load_device_symbol(vk->context.device,
+            "vkGetPastPresentationTimingGOOGLE",
+            (PFN_vkVoidFunction*)&vk->context.get_past_presentation_timing);
+      vk->context.display_timing =
+         vk->context.get_past_presentation_timing != NULL;
+   }
+
+   video_pacing_set_display_timing(vk->context.display_timing);
    return true;
 }
 
@@ -1635,6 +1719,29 @@ static bool vulkan_context_init_gpu(gfx_ctx_vulkan_data_t *vk)
    return true;
 }
 
+/* Integrated GPUs, or GPUs whose every heap is device local,
+ * with a memory type that is both device local and host visible. */
+static bool vulkan_context_unified_memory(const vulkan_context_t *ctx)
+{
+   uint32_t i;
+   bool all_local    = true;
+   bool host_visible = false;
+   const VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+   for (i = 0; i < ctx->memory_properties.memoryHeapCount; i++)
+      if (!(ctx->memory_properties.memoryHeaps[i].flags &
+               VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+         all_local = false;
+
+   for (i = 0; i < ctx->memory_properties.memoryTypeCount; i++)
+      if ((ctx->memory_properties.memoryTypes[i].propertyFlags & flags) == flags)
+         host_visible = true;
+
+   return host_visible && (all_local ||
+         ctx->gpu_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU);
+}
+
 static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
 {
    bool use_device_ext;
@@ -1656,6 +1763,7 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
 
    static const char *optional_device_extensions[] = {
       "VK_KHR_sampler_mirror_clamp_to_edge",
+      VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME,
    };
 
 #ifdef VULKAN_DEBUG
@@ -1731,6 +1839,7 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
          &vk->context.gpu_properties);
    vkGetPhysicalDeviceMemoryProperties(vk->context.gpu,
          &vk->context.memory_properties);
+   vk->context.unified_memory = vulkan_context_unified_memory(&vk->context);
 
 #ifdef VULKAN_EMULATE_MAILBOX
    /* Win32 windowed mode seems to deal just fine with toggling VSync.
@@ -1739,6 +1848,8 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
 #endif
 
    RARCH_LOG("[Vulkan]: Using GPU: %s\n", vk->context.gpu_properties.deviceName);
+   if (vk->context.unified_memory)
+      RARCH_LOG("[Vulkan]: GPU has unified memory, sampling software frames in place.\n");
 
    if (vk->context.device == VK_NULL_HANDLE)
    {
@@ -1825,6 +1936,15 @@ static bool vulkan_context_init_device(gfx_ctx_vulkan_data_t *vk)
          RARCH_ERR("[Vulkan]: Failed to create device.\n");
          return false;
       }
+      else
+      {
+         /* Only known for devices we created ourselves. */
+         unsigned i;
+         for (i = 0; i < enabled_device_extension_count; i++)
+            if (string_is_equal(enabled_device_extensions[i],
+                     VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME))
+               vk->context.display_timing = true;
+      }
    }
 
    if (!vulkan_load_device_symbols(vk))
@@ -2521,9 +2641,34 @@ static void vulkan_destroy_swapchain(gfx_ctx_vulkan_data_t *vk)
    memset(vk->context.swapchain_fences, 0, sizeof(vk->context.swapchain_fences));
 }
 
+static void vulkan_poll_display_timing(gfx_ctx_vulkan_data_t *vk)
+{
+   unsigned i;
+   VkPastPresentationTimingGOOGLE timings[8];
+   uint32_t count = ARRAY_SIZE(timings);
+   VkResult res   = vk->context.get_past_presentation_timing(
+         vk->context.device, vk->swapchain, &count, timings);
+
+   /* VK_INCOMPLETE just leaves the rest for the next frame. */
+   if (res != VK_SUCCESS && res != VK_INCOMPLETE)
+      return;
+
+   for (i = 0; i < count; i++)
+   {
+      uint32_t frames = timings[i].presentID - vk->context.last_present_id;
+
+      vk->context.last_present_id = timings[i].presentID;
+      video_pacing_present(
+            (retro_time_t)(timings[i].actualPresentTime / 1000), frames);
+   }
+}
+
 void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
 {
+   VkPresentTimeGOOGLE present_time;
    VkPresentInfoKHR present           = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+   VkPresentTimesInfoGOOGLE present_times =
+   { VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE };
    VkResult result                    = VK_SUCCESS;
    VkResult err                       = VK_SUCCESS;
 
@@ -2545,6 +2690,16 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
    present.waitSemaphoreCount      = 1;
    present.pWaitSemaphores         = &vk->context.swapchain_semaphores[index];
 
+   if (vk->context.display_timing)
+   {
+      /* Only tag the present, we don't ask for a target time. */
+      present_time.presentID          = ++vk->context.present_id;
+      present_time.desiredPresentTime = 0;
+      present_times.swapchainCount    = 1;
+      present_times.pTimes            = &present_time;
+      present.pNext                   = &present_times;
+   }
+
    /* Better hope QueuePresent doesn't block D: */
 #ifdef HAVE_THREADS
    slock_lock(vk->context.queue_lock);
@@ -2564,6 +2719,9 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index)
 #ifdef HAVE_THREADS
    slock_unlock(vk->context.queue_lock);
 #endif
+
+   if (vk->context.display_timing && vk->swapchain != VK_NULL_HANDLE)
+      vulkan_poll_display_timing(vk);
 }
 
 void vulkan_context_destroy(gfx_ctx_vulkan_data_t *vk,
@@ -2577,6 +2735,9 @@ void vulkan_context_destroy(gfx_ctx_vulkan_data_t *vk,
 
    vulkan_destroy_swapchain(vk);
 
+   if (vk->context.display_timing)
+      video_pacing_set_display_timing(false);
+
    if (destroy_surface && vk->vk_surface != VK_NULL_HANDLE)
    {
       vkDestroySurfaceKHR(vk->context.instance,
@@ -2628,6 +2789,7 @@ static void vulkan_acquire_clear_fences(gfx_ctx_vulkan_data_t *vk)
       }
       vk->context.swapchain_fences_signalled[i] = false;
    }
+   vk->context.hard_sync_count = 0;
 }
 
 static void vulkan_acquire_wait_fences(gfx_ctx_vulkan_data_t *vk)
@@ -2778,6 +2940,29 @@ retry:
    vulkan_acquire_wait_fences(vk);
 }
 
+void vulkan_hard_sync(vulkan_context_t *context,
+      unsigned index, unsigned frames)
+{
+   if (context->hard_sync_count >= VULKAN_MAX_SWAPCHAIN_IMAGES)
+      context->hard_sync_count = VULKAN_MAX_SWAPCHAIN_IMAGES - 1;
+   context->hard_sync_queue[context->hard_sync_count++] = index;
+
+   while (context->hard_sync_count > frames)
+   {
+      uint32_t oldest = context->hard_sync_queue[0];
+
+      /* An acquire of the same image resets the fence,
+       * it has waited for the frame before doing so. */
+      if (context->swapchain_fences_signalled[oldest])
+         vkWaitForFences(context->device, 1,
+               &context->swapchain_fences[oldest], true, UINT64_MAX);
+
+      context->hard_sync_count--;
+      memmove(context->hard_sync_queue, context->hard_sync_queue + 1,
+            context->hard_sync_count * sizeof(*context->hard_sync_queue));
+   }
+}
+
 bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
       unsigned width, unsigned height,
       unsigned swap_interval)
@@ -2798,6 +2983,7 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
    VkPresentModeKHR swapchain_present_mode = VK_PRESENT_MODE_FIFO_KHR;
    settings_t                    *settings = config_get_ptr();
    VkCompositeAlphaFlagBitsKHR composite   = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+   bool adaptive_vsync                     = settings->bools.video_adaptive_vsync;
    VkResult res;
 
    vkDeviceWaitIdle(vk->context.device);
@@ -2816,7 +3002,8 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
          !vk->context.invalid_swapchain &&
          vk->context.swapchain_width == width &&
          vk->context.swapchain_height == height &&
-         vk->context.swap_interval == swap_interval)
+         vk->context.swap_interval == swap_interval &&
+         vk->context.adaptive_vsync == adaptive_vsync)
    {
       /* Do not bother creating a swapchain redundantly. */
       RARCH_LOG("[Vulkan]: Do not need to re-create swapchain.\n");
@@ -2883,7 +3070,8 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
             present_modes[i]);
    }
 
-   vk->context.swap_interval = swap_interval;
+   vk->context.swap_interval  = swap_interval;
+   vk->context.adaptive_vsync = adaptive_vsync;
    for (i = 0; i < present_mode_count; i++)
    {
       if (!swap_interval && present_modes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
@@ -2905,6 +3093,19 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
       }
    }
 
+   /* Late frames tear instead of waiting a whole refresh. */
+   if (swap_interval && adaptive_vsync)
+   {
+      for (i = 0; i < present_mode_count; i++)
+      {
+         if (present_modes[i] == VK_PRESENT_MODE_FIFO_RELAXED_KHR)
+         {
+            swapchain_present_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            break;
+         }
+      }
+   }
+
    RARCH_LOG("[Vulkan]: Creating swapchain with present mode: %u\n",
          (unsigned)swapchain_present_mode);
 
@@ -2983,7 +3184,8 @@ bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
       vk->context.num_swapchain_images = 1;
 
       memset(vk->context.swapchain_images, 0, sizeof(vk->context.swapchain_images));
-      RARCH_LOG("[Vulkan]: Cannot create a swapchain yet. Will try again later ...\n");
+      RARCH_LOG_RATELIMITED(5000000, 1,
+            "[Vulkan]: Cannot create a swapchain yet. Will try again later ...\n");
       return true;
    }
 
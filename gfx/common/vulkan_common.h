@@ -23,6 +23,10 @@
 #define VULKAN_DESCRIPTOR_MANAGER_BLOCK_SETS    16
 #define VULKAN_MAX_DESCRIPTOR_POOL_SIZES        16
 #define VULKAN_BUFFER_BLOCK_SIZE                (64 * 1024)
+/* Power of two */
+#define VULKAN_DESCRIPTOR_CACHE_SIZE            256
+/* Uniforms up to this size are compared with the last one uploaded */
+#define VULKAN_TRACKER_UNIFORM_SIZE             256
 
 #define VULKAN_MAX_SWAPCHAIN_IMAGES             8
 
@@ -113,16 +117,32 @@ typedef struct vulkan_context
 
    VkPhysicalDeviceProperties gpu_properties;
    VkPhysicalDeviceMemoryProperties memory_properties;
+   /* Integrated GPU which samples host visible memory at full
+    * speed, software frames are written straight into linear
+    * images instead of going through a staging buffer. */
+   bool unified_memory;
 
    VkImage swapchain_images[VULKAN_MAX_SWAPCHAIN_IMAGES];
    VkFence swapchain_fences[VULKAN_MAX_SWAPCHAIN_IMAGES];
    bool swapchain_fences_signalled[VULKAN_MAX_SWAPCHAIN_IMAGES];
+   /* Swapchain indices of the submitted frames hard sync
+    * hasn't waited for yet, oldest first. */
+   uint32_t hard_sync_queue[VULKAN_MAX_SWAPCHAIN_IMAGES];
+   unsigned hard_sync_count;
+   /* FIFO_RELAXED was asked for, see video_adaptive_vsync. */
+   bool adaptive_vsync;
    VkSemaphore swapchain_semaphores[VULKAN_MAX_SWAPCHAIN_IMAGES];
    VkFormat swapchain_format;
 
    slock_t *queue_lock;
    retro_vulkan_destroy_device_t destroy_device;
 
+   /* VK_GOOGLE_display_timing, feeds present times to video_pacing. */
+   bool display_timing;
+   uint32_t present_id;
+   uint32_t last_present_id;
+   PFN_vkGetPastPresentationTimingGOOGLE get_past_presentation_timing;
+
 #ifdef VULKAN_DEBUG
    VkDebugReportCallbackEXT debug_callback;
 #endif
@@ -283,6 +303,32 @@ struct vk_descriptor_manager
    unsigned num_sizes;
 };
 
+/* Descriptor sets written so far this frame. The uniform buffer is
+ * bound with a dynamic offset, so every draw with the same buffer,
+ * uniform size, texture and sampler can share a set. */
+struct vk_descriptor_cache_key
+{
+   VkBuffer buffer;
+   VkDeviceSize range;
+   VkImageView view;
+   VkImageLayout layout;
+   VkSampler sampler;
+};
+
+struct vk_descriptor_cache_entry
+{
+   struct vk_descriptor_cache_key key;
+   VkDescriptorSet set;
+   unsigned frame;
+};
+
+struct vk_descriptor_cache
+{
+   struct vk_descriptor_cache_entry entries[VULKAN_DESCRIPTOR_CACHE_SIZE];
+   unsigned frame;
+   unsigned count;
+};
+
 struct vk_per_frame
 {
    struct vk_image backbuffer;
@@ -291,6 +337,7 @@ struct vk_per_frame
    struct vk_buffer_chain vbo;
    struct vk_buffer_chain ubo;
    struct vk_descriptor_manager descriptor_manager;
+   struct vk_descriptor_cache descriptor_cache;
 
    VkCommandPool cmd_pool;
    VkCommandBuffer cmd;
@@ -354,7 +401,13 @@ typedef struct vk
       bool pending;
       bool streamed;
       struct scaler_ctx scaler;
+      /* One persistently mapped buffer per swapchain image,
+       * guarded by that image's fence. */
       struct vk_texture staging[VULKAN_MAX_SWAPCHAIN_IMAGES];
+      /* Set once a copy has been recorded into staging[i]. */
+      bool valid[VULKAN_MAX_SWAPCHAIN_IMAGES];
+      /* Slot written by the most recent readback. */
+      unsigned last_index;
    } readback;
 
    struct
@@ -427,12 +480,22 @@ typedef struct vk
       VkRect2D scissor;
       bool use_scissor;
       VkPipeline pipeline;
-      VkImageView view;
-      VkSampler sampler;
-      math_matrix_4x4 mvp;
+      /* Last set bound and where its uniforms are */
+      VkDescriptorSet set;
+      uint32_t set_offset;
+      /* Last uniforms uploaded, uniform_buffer is VK_NULL_HANDLE
+       * until the first upload of the frame. */
+      VkBuffer uniform_buffer;
+      VkDeviceSize uniform_offset;
+      size_t uniform_size;
+      uint8_t uniform[VULKAN_TRACKER_UNIFORM_SIZE];
    } tracker;
 
    void *filter_chain;
+#ifdef HAVE_THREADS
+   /* Preset being built in the background, see vulkan_set_shader(). */
+   struct vk_shader_compile *shader_compile;
+#endif
 } vk_t;
 
 uint32_t vulkan_find_memory_type(
@@ -506,6 +569,7 @@ static INLINE unsigned vulkan_format_to_bpp(VkFormat format)
       case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
       case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
       case VK_FORMAT_R5G6B5_UNORM_PACK16:
+      case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
          return 2;
 
       case VK_FORMAT_R8_UNORM:
@@ -557,6 +621,10 @@ VkDescriptorSet vulkan_descriptor_manager_alloc(
 void vulkan_descriptor_manager_restart(
       struct vk_descriptor_manager *manager);
 
+/* Forgets the sets of the previous use of this frame, along with
+ * vulkan_descriptor_manager_restart(). */
+void vulkan_descriptor_cache_reset(struct vk_descriptor_cache *cache);
+
 struct vk_descriptor_manager vulkan_create_descriptor_manager(
       VkDevice device,
       const VkDescriptorPoolSize *sizes, unsigned num_sizes,
@@ -582,6 +650,19 @@ void vulkan_present(gfx_ctx_vulkan_data_t *vk, unsigned index);
 
 void vulkan_acquire_next_image(gfx_ctx_vulkan_data_t *vk);
 
+/**
+ * vulkan_hard_sync:
+ * @context             : Vulkan context.
+ * @index               : swapchain index of the frame just submitted.
+ * @frames              : frames the CPU may run ahead of the GPU.
+ *
+ * Waits for the GPU to finish all but the last @frames submitted
+ * frames, so the driver queue can't grow deeper than that no
+ * matter how many swapchain images there are.
+ **/
+void vulkan_hard_sync(vulkan_context_t *context,
+      unsigned index, unsigned frames);
+
 bool vulkan_create_swapchain(gfx_ctx_vulkan_data_t *vk,
       unsigned width, unsigned height,
       unsigned swap_interval);
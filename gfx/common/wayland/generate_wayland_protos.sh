@@ -22,3 +22,7 @@ $WAYSCAN private-code $WAYLAND_PROTOS/unstable/idle-inhibit/idle-inhibit-unstabl
 #Generate xdg-decoration header and .c files
 $WAYSCAN client-header $WAYLAND_PROTOS/unstable/xdg-decoration/xdg-decoration-unstable-v1.xml $OUTPUT/xdg-decoration-unstable-v1.h
 $WAYSCAN private-code $WAYLAND_PROTOS/unstable/xdg-decoration/xdg-decoration-unstable-v1.xml $OUTPUT/xdg-decoration-unstable-v1.c
+
+#Generate presentation-time header and .c files
+$WAYSCAN client-header $WAYLAND_PROTOS/stable/presentation-time/presentation-time.xml $OUTPUT/presentation-time.h
+$WAYSCAN private-code $WAYLAND_PROTOS/stable/presentation-time/presentation-time.xml $OUTPUT/presentation-time.c
@@ -32,103 +32,71 @@
 #include "../video_driver.h" /* needed to set refresh rate in set resolution */
 #include "../video_crt_switch.h" /* needed to set aspect for low res in linux */
 
+/* Modes that were created for the CRT so far. Creating one is
+ * the slow part of a switch, so they stay around until the display
+ * server is destroyed and switching back to one only sets it. */
+#define X11_CRT_MODES   16
+#define X11_CRT_OUTPUTS 8
+
+typedef struct
+{
+   unsigned width;
+   unsigned height;
+   float hz;
+   float pixel_clock;
+   int hfp;
+   int hsp;
+   int hbp;
+   int vfp;
+   int vsp;
+   int vbp;
+   bool interlaced;
+   bool created;
+#ifdef HAVE_XRANDR
+   RRMode id;
+   RROutput outputs[X11_CRT_OUTPUTS];
+   unsigned num_outputs;
+#endif
+   char name[64];
+} x11_crt_mode_t;
+
+static x11_crt_mode_t x11_crt_modes[X11_CRT_MODES];
+static unsigned x11_crt_num_modes    = 0;
+static unsigned x11_crt_next_mode    = 0;
+static x11_crt_mode_t *x11_crt_mode  = NULL;
+
 static unsigned orig_width      = 0;
 static unsigned orig_height     = 0;
-static char old_mode[250]       = {0};
-static char new_mode[250]       = {0};
-static char xrandr[250]         = {0};
-static char fbset[150]          = {0};
 static char output[500]         = {0};
 static bool crt_en              = false;
 
+#ifdef HAVE_XRANDR
+/* Own connection, the CRT may be switched before the
+ * video driver opens a window. */
+static Display *x11_crt_dpy          = NULL;
+static RRCrtc x11_crt_orig_crtc      = None;
+static RRMode x11_crt_orig_mode      = None;
+static int x11_crt_orig_width_mm     = 0;
+static int x11_crt_orig_height_mm    = 0;
+#endif
+
 typedef struct
 {
    unsigned opacity;
    bool decorations;
 } dispserv_x11_t;
 
-static void* x11_display_server_init(void)
+/* Outputs the CRT can be connected to,
+ * modes are only added to these. */
+static bool x11_crt_is_output(const char *name)
 {
-   dispserv_x11_t *dispserv = (dispserv_x11_t*)calloc(1, sizeof(*dispserv));
-
-   if (!dispserv)
-      return NULL;
-
-   return dispserv;
+   return !strncmp(name, "VGA", 3) || !strncmp(name, "DVI", 3);
 }
 
-static void x11_display_server_destroy(void *data)
+/* Computes the modeline for a CRT at the given resolution. */
+static void x11_crt_modeline(x11_crt_mode_t *mode,
+      unsigned width, unsigned height, float hz)
 {
-   dispserv_x11_t *dispserv = (dispserv_x11_t*)data;
-   int i          = 0;
-
-   if (crt_en)
-   {
-      snprintf(output, sizeof(output),
-		      "xrandr -s %dx%d", orig_width, orig_height);
-      system(output);
-
-      for (i = 0; i < 3; i++)
-      {
-         snprintf(output, sizeof(output),
-			 "xrandr --delmode %s%d %s", "VGA", i, old_mode);
-         system(output);
-         snprintf(output, sizeof(output),
-			 "xrandr --delmode %s-%d %s", "VGA", i, old_mode);
-         system(output);
-
-         snprintf(output, sizeof(output),
-			 "xrandr --delmode %s%d %s", "DVI", i, old_mode);
-         system(output);
-         snprintf(output, sizeof(output),
-			 "xrandr --delmode %s-%d %s", "DVI", i, old_mode);
-         system(output);
-      }
-
-      snprintf(output, sizeof(output), "xrandr --rmmode %s", old_mode);
-      system(output);
-   }
-
-   if (dispserv)
-      free(dispserv);
-}
-
-static bool x11_display_server_set_window_opacity(void *data, unsigned opacity)
-{
-   dispserv_x11_t *serv = (dispserv_x11_t*)data;
-   Atom net_wm_opacity  = XInternAtom(g_x11_dpy, "_NET_WM_WINDOW_OPACITY", False);
-   Atom cardinal        = XInternAtom(g_x11_dpy, "CARDINAL", False);
-
-   serv->opacity        = opacity;
-
-   opacity              = opacity * ((unsigned)-1 / 100.0);
-
-   if (opacity == (unsigned)-1)
-      XDeleteProperty(g_x11_dpy, g_x11_win, net_wm_opacity);
-   else
-      XChangeProperty(g_x11_dpy, g_x11_win, net_wm_opacity, cardinal,
-            32, PropModeReplace, (const unsigned char*)&opacity, 1);
-
-   return true;
-}
-
-static bool x11_display_server_set_window_decorations(void *data, bool on)
-{
-   dispserv_x11_t *serv = (dispserv_x11_t*)data;
-
-   if (serv)
-      serv->decorations = on;
-
-   /* menu_setting performs a reinit instead to properly apply 
-    * decoration changes */
-
-   return true;
-}
-
-static bool x11_display_server_set_resolution(void *data,
-      unsigned width, unsigned height, int int_hz, float hz, int center)
-{
-   int i              = 0;
    int hfp            = 0;
    int hsp            = 0;
    int hbp            = 0;
@@ -139,17 +107,9 @@ static bool x11_display_server_set_resolution(void *data,
    int vmax           = 0;
    int pdefault       = 8;
    int pwidth         = 0;
-   float roundw     = 0.0f;
-   float roundh     = 0.0f;
+   float roundw       = 0.0f;
    float pixel_clock  = 0;
 
-   crt_en = true;
-
-   /* set core refresh from hz */
-   video_monitor_set_refresh_rate(hz);
-
-   /* following code is the mode line generator */
-
    hsp = width * 1.140;
    hfp = width * 1.055;
 
@@ -213,81 +173,446 @@ static bool x11_display_server_set_resolution(void *data,
 
    if (height > 300)
       pixel_clock = ((hmax * vmax * hz) / 1000000) / 2;
-   /* above code is the modeline generator */
 
-   /* create interlaced newmode from modline variables */
-   if (height < 300)
+   mode->width       = width;
+   mode->height      = height;
+   mode->hz          = hz;
+   mode->pixel_clock = pixel_clock;
+   mode->hfp         = hfp;
+   mode->hsp         = hsp;
+   mode->hbp         = hbp;
+   mode->vfp         = vfp;
+   mode->vsp         = vsp;
+   mode->vbp         = vbp;
+   mode->interlaced  = height > 300;
+   mode->created     = false;
+
+   snprintf(mode->name, sizeof(mode->name), "%dx%d_%0.2f",
+         width, height, hz);
+}
+
+#ifdef HAVE_XRANDR
+static int x11_crt_error_handler(Display *dpy, XErrorEvent *event)
+{
+   (void)dpy;
+   (void)event;
+   return 0;
+}
+
+/* Resizes the screen, keeping the DPI of the original one. */
+static void x11_crt_set_screen_size(Window root,
+      unsigned width, unsigned height)
+{
+   int width_mm  = x11_crt_orig_width_mm;
+   int height_mm = x11_crt_orig_height_mm;
+
+   if (orig_width && orig_height)
    {
-      snprintf(xrandr, sizeof(xrandr), "xrandr --newmode \"%dx%d_%0.2f\" %f %d %d %d %d %d %d %d %d -hsync -vsync", width, height, hz, pixel_clock,
-            width, hfp, hsp, hbp, height, vfp, vsp, vbp);
-      system(xrandr);
+      width_mm  = width_mm  * (int)width  / (int)orig_width;
+      height_mm = height_mm * (int)height / (int)orig_height;
    }
-   /* create interlaced newmode from modline variables */
-   if (height > 300)
+
+   XRRSetScreenSize(x11_crt_dpy, root, width, height,
+         width_mm > 0 ? width_mm : 1, height_mm > 0 ? height_mm : 1);
+}
+
+static void x11_crt_release_mode(x11_crt_mode_t *mode)
+{
+   unsigned i;
+
+   if (!mode->created)
+      return;
+
+   for (i = 0; i < mode->num_outputs; i++)
+      XRRDeleteOutputMode(x11_crt_dpy, mode->outputs[i], mode->id);
+   XRRDestroyMode(x11_crt_dpy, mode->id);
+
+   mode->num_outputs = 0;
+   mode->created     = false;
+}
+
+/* Sets the mode on every connected CRT output through XRandR,
+ * creating it and adding it to the outputs the first time. */
+static bool x11_crt_apply_mode(x11_crt_mode_t *mode)
+{
+   int i;
+   Window root;
+   XRRScreenResources *res = NULL;
+   bool applied            = false;
+   int (*old_handler)(Display*, XErrorEvent*);
+
+   if (!x11_crt_dpy && !(x11_crt_dpy = XOpenDisplay(NULL)))
+      return false;
+
+   root = RootWindow(x11_crt_dpy, DefaultScreen(x11_crt_dpy));
+
+   if (!(res = XRRGetScreenResourcesCurrent(x11_crt_dpy, root)))
+      return false;
+
+   /* A mode the server refuses must not take RetroArch down. */
+   old_handler = XSetErrorHandler(x11_crt_error_handler);
+
+   if (!orig_width)
    {
-      snprintf(xrandr, sizeof(xrandr), "xrandr --newmode \"%dx%d_%0.2f\" %f %d %d %d %d %d %d %d %d interlace -hsync -vsync", width, height, hz, pixel_clock,
-            width, hfp, hsp, hbp, height, vfp, vsp, vbp);
-      system(xrandr);
+      orig_width             = DisplayWidth(x11_crt_dpy, DefaultScreen(x11_crt_dpy));
+      orig_height            = DisplayHeight(x11_crt_dpy, DefaultScreen(x11_crt_dpy));
+      x11_crt_orig_width_mm  = DisplayWidthMM(x11_crt_dpy, DefaultScreen(x11_crt_dpy));
+      x11_crt_orig_height_mm = DisplayHeightMM(x11_crt_dpy, DefaultScreen(x11_crt_dpy));
    }
 
-   /* variable for new mode */
-   snprintf(new_mode, sizeof(new_mode), "%dx%d_%0.2f", width, height, hz);
+   if (!mode->created)
+   {
+      XRRModeInfo info;
+
+      memset(&info, 0, sizeof(info));
+      info.width      = mode->width;
+      info.height     = mode->height;
+      info.dotClock   = (unsigned long)(mode->pixel_clock * 1000000.0f);
+      info.hSyncStart = mode->hfp;
+      info.hSyncEnd   = mode->hsp;
+      info.hTotal     = mode->hbp;
+      info.vSyncStart = mode->vfp;
+      info.vSyncEnd   = mode->vsp;
+      info.vTotal     = mode->vbp;
+      info.name       = mode->name;
+      info.nameLength = strlen(mode->name);
+      info.modeFlags  = RR_HSyncNegative | RR_VSyncNegative;
+      if (mode->interlaced)
+         info.modeFlags |= RR_Interlace;
+
+      mode->id          = XRRCreateMode(x11_crt_dpy, root, &info);
+      mode->num_outputs = 0;
+      mode->created     = mode->id != None;
+   }
 
-   /* need to run loops for DVI0 - DVI-2 and VGA0 - VGA-2 outputs to 
-    * add and delete modes */
-   for (i = 0; i < 3; i++)
+   /* The screen has to fit the mode before the CRTC is set */
+   if (mode->created && (  mode->width  > (unsigned)DisplayWidth(x11_crt_dpy, DefaultScreen(x11_crt_dpy))
+                        || mode->height > (unsigned)DisplayHeight(x11_crt_dpy, DefaultScreen(x11_crt_dpy))))
+      x11_crt_set_screen_size(root, mode->width, mode->height);
+
+   for (i = 0; mode->created && i < res->noutput; i++)
    {
-      snprintf(output, sizeof(output), "xrandr --addmode %s%d %s", "DVI", i,
-            new_mode);
-      system(output);
-      snprintf(output, sizeof(output), "xrandr --delmode %s%d %s", "DVI", i,
-            old_mode);
-      system(output);
+      unsigned j;
+      XRRCrtcInfo *crtc    = NULL;
+      XRROutputInfo *info  = XRRGetOutputInfo(x11_crt_dpy, res, res->outputs[i]);
+
+      if (!info)
+         continue;
+
+      if (     info->connection != RR_Connected
+            || !info->crtc
+            || !x11_crt_is_output(info->name))
+      {
+         XRRFreeOutputInfo(info);
+         continue;
+      }
+
+      for (j = 0; j < mode->num_outputs; j++)
+         if (mode->outputs[j] == res->outputs[i])
+            break;
+
+      if (j == mode->num_outputs && j < X11_CRT_OUTPUTS)
+      {
+         XRRAddOutputMode(x11_crt_dpy, res->outputs[i], mode->id);
+         mode->outputs[mode->num_outputs++] = res->outputs[i];
+      }
+
+      if ((crtc = XRRGetCrtcInfo(x11_crt_dpy, res, info->crtc)))
+      {
+         if (x11_crt_orig_crtc == None)
+         {
+            x11_crt_orig_crtc = info->crtc;
+            x11_crt_orig_mode = crtc->mode;
+         }
+
+         if (XRRSetCrtcConfig(x11_crt_dpy, res, info->crtc, CurrentTime,
+                  crtc->x, crtc->y, mode->id, crtc->rotation,
+                  crtc->outputs, crtc->noutput) == RRSetConfigSuccess)
+            applied = true;
+
+         XRRFreeCrtcInfo(crtc);
+      }
+
+      XRRFreeOutputInfo(info);
    }
 
-   for (i = 0; i < 3; i++)
+   if (applied)
+      x11_crt_set_screen_size(root, mode->width, mode->height);
+
+   XSync(x11_crt_dpy, False);
+   XSetErrorHandler(old_handler);
+   XRRFreeScreenResources(res);
+
+   /* Take the input focus back after the screen changed size */
+   if (applied && g_x11_dpy && g_x11_win)
    {
-      snprintf(output, sizeof(output), "xrandr --addmode %s-%d %s", "DVI", i,
-            new_mode);
-      system(output);
-      snprintf(output, sizeof(output), "xrandr --delmode %s-%d %s", "DVI", i,
-            old_mode);
-      system(output);
+      old_handler = XSetErrorHandler(x11_crt_error_handler);
+      XRaiseWindow(g_x11_dpy, g_x11_win);
+      XSetInputFocus(g_x11_dpy, g_x11_win, RevertToParent, CurrentTime);
+      XSync(g_x11_dpy, False);
+      XSetErrorHandler(old_handler);
    }
 
-   for (i = 0; i < 3; i++)
+   return applied;
+}
+
+static void x11_crt_restore(void)
+{
+   unsigned i;
+   Window root;
+   XRRScreenResources *res = NULL;
+   int (*old_handler)(Display*, XErrorEvent*);
+
+   if (!x11_crt_dpy)
+      return;
+
+   root        = RootWindow(x11_crt_dpy, DefaultScreen(x11_crt_dpy));
+   old_handler = XSetErrorHandler(x11_crt_error_handler);
+
+   if (     x11_crt_orig_crtc != None
+         && (res = XRRGetScreenResourcesCurrent(x11_crt_dpy, root)))
    {
-      snprintf(output, sizeof(output), "xrandr --addmode %s%d %s", "VGA", i, new_mode);
-      system(output);
-      snprintf(output, sizeof(output), "xrandr --delmode %s%d %s", "VGA", i, old_mode);
-      system(output);
+      XRRCrtcInfo *crtc = XRRGetCrtcInfo(x11_crt_dpy, res, x11_crt_orig_crtc);
+
+      if (crtc)
+      {
+         if (     orig_width  > (unsigned)DisplayWidth(x11_crt_dpy, DefaultScreen(x11_crt_dpy))
+               || orig_height > (unsigned)DisplayHeight(x11_crt_dpy, DefaultScreen(x11_crt_dpy)))
+            x11_crt_set_screen_size(root, orig_width, orig_height);
+
+         XRRSetCrtcConfig(x11_crt_dpy, res, x11_crt_orig_crtc, CurrentTime,
+               crtc->x, crtc->y, x11_crt_orig_mode, crtc->rotation,
+               crtc->outputs, crtc->noutput);
+         x11_crt_set_screen_size(root, orig_width, orig_height);
+         XRRFreeCrtcInfo(crtc);
+      }
+
+      XRRFreeScreenResources(res);
    }
 
+   for (i = 0; i < x11_crt_num_modes; i++)
+      x11_crt_release_mode(&x11_crt_modes[i]);
+
+   XSync(x11_crt_dpy, False);
+   XSetErrorHandler(old_handler);
+   XCloseDisplay(x11_crt_dpy);
+
+   x11_crt_dpy       = NULL;
+   x11_crt_orig_crtc = None;
+   x11_crt_orig_mode = None;
+}
+#else
+static void x11_crt_release_mode(x11_crt_mode_t *mode)
+{
+   int i;
+
+   if (!mode->created)
+      return;
+
+   /* need to run loops for DVI0 - DVI-2 and VGA0 - VGA-2 outputs */
    for (i = 0; i < 3; i++)
    {
-      snprintf(output, sizeof(output), "xrandr --addmode %s-%d %s", "VGA", i, new_mode);
+      snprintf(output, sizeof(output),
+            "xrandr --delmode %s%d %s", "VGA", i, mode->name);
+      system(output);
+      snprintf(output, sizeof(output),
+            "xrandr --delmode %s-%d %s", "VGA", i, mode->name);
       system(output);
-      snprintf(output, sizeof(output), "xrandr --delmode %s-%d %s", "VGA", i, old_mode);
+
+      snprintf(output, sizeof(output),
+            "xrandr --delmode %s%d %s", "DVI", i, mode->name);
+      system(output);
+      snprintf(output, sizeof(output),
+            "xrandr --delmode %s-%d %s", "DVI", i, mode->name);
       system(output);
    }
 
-   snprintf(output, sizeof(output), "xrandr -s %s", new_mode);
+   snprintf(output, sizeof(output), "xrandr --rmmode %s", mode->name);
    system(output);
 
-   /* remove old mode */
-   snprintf(output, sizeof(output), "xrandr --rmmode %s", old_mode);
+   mode->created = false;
+}
+
+/* Without XRandR, the xrandr tool does the work. A new mode is
+ * created and added to the outputs once, after that setting it
+ * takes a single call. */
+static bool x11_crt_apply_mode(x11_crt_mode_t *mode)
+{
+   int i;
+
+   if (!orig_width && g_x11_dpy)
+   {
+      orig_width  = DisplayWidth(g_x11_dpy, DefaultScreen(g_x11_dpy));
+      orig_height = DisplayHeight(g_x11_dpy, DefaultScreen(g_x11_dpy));
+   }
+
+   if (!mode->created)
+   {
+      /* create newmode from modeline variables */
+      snprintf(output, sizeof(output),
+            "xrandr --newmode \"%s\" %f %d %d %d %d %d %d %d %d%s -hsync -vsync",
+            mode->name, mode->pixel_clock,
+            mode->width, mode->hfp, mode->hsp, mode->hbp,
+            mode->height, mode->vfp, mode->vsp, mode->vbp,
+            mode->interlaced ? " interlace" : "");
+      system(output);
+
+      /* need to run loops for DVI0 - DVI-2 and VGA0 - VGA-2 outputs */
+      for (i = 0; i < 3; i++)
+      {
+         snprintf(output, sizeof(output), "xrandr --addmode %s%d %s",
+               "DVI", i, mode->name);
+         system(output);
+         snprintf(output, sizeof(output), "xrandr --addmode %s-%d %s",
+               "DVI", i, mode->name);
+         system(output);
+         snprintf(output, sizeof(output), "xrandr --addmode %s%d %s",
+               "VGA", i, mode->name);
+         system(output);
+         snprintf(output, sizeof(output), "xrandr --addmode %s-%d %s",
+               "VGA", i, mode->name);
+         system(output);
+      }
+
+      mode->created = true;
+   }
+
+   snprintf(output, sizeof(output), "xrandr -s %s", mode->name);
    system(output);
 
    /* needs xdotool installed. needed to recapture window. */
    system("xdotool windowactivate $(xdotool search --class RetroArch)");
 
-   /* variable for old mode */
-   snprintf(old_mode, sizeof(old_mode), "%s", new_mode);
+   return true;
+}
 
-   /* needs xdotool installed. needed to recapture window. */
-   system("xdotool windowactivate $(xdotool search --class RetroArch)");
-   /* Second run needed as some times it runs to fast to capture first time */
+static void x11_crt_restore(void)
+{
+   unsigned i;
+
+   if (orig_width && orig_height)
+   {
+      snprintf(output, sizeof(output),
+            "xrandr -s %dx%d", orig_width, orig_height);
+      system(output);
+   }
+
+   for (i = 0; i < x11_crt_num_modes; i++)
+      x11_crt_release_mode(&x11_crt_modes[i]);
+}
+#endif
+
+/* Looks the mode up in the cache, computing it on a miss.
+ * A full cache gives up the oldest mode that isn't in use. */
+static x11_crt_mode_t *x11_crt_get_mode(unsigned width,
+      unsigned height, float hz)
+{
+   unsigned i;
+   x11_crt_mode_t *mode = NULL;
+
+   for (i = 0; i < x11_crt_num_modes; i++)
+   {
+      mode = &x11_crt_modes[i];
+      if (mode->width == width && mode->height == height && mode->hz == hz)
+         return mode;
+   }
+
+   if (x11_crt_num_modes < X11_CRT_MODES)
+      mode = &x11_crt_modes[x11_crt_num_modes++];
+   else
+   {
+      mode = &x11_crt_modes[x11_crt_next_mode++ % X11_CRT_MODES];
+      if (mode == x11_crt_mode)
+         mode = &x11_crt_modes[x11_crt_next_mode++ % X11_CRT_MODES];
+      x11_crt_release_mode(mode);
+   }
+
+   x11_crt_modeline(mode, width, height, hz);
+   return mode;
+}
+
+static void* x11_display_server_init(void)
+{
+   dispserv_x11_t *dispserv = (dispserv_x11_t*)calloc(1, sizeof(*dispserv));
+
+   if (!dispserv)
+      return NULL;
+
+   return dispserv;
+}
+
+static void x11_display_server_destroy(void *data)
+{
+   dispserv_x11_t *dispserv = (dispserv_x11_t*)data;
+
+   if (crt_en)
+   {
+      x11_crt_restore();
+
+      x11_crt_num_modes = 0;
+      x11_crt_next_mode = 0;
+      x11_crt_mode      = NULL;
+      orig_width        = 0;
+      orig_height       = 0;
+      crt_en            = false;
+   }
+
+   if (dispserv)
+      free(dispserv);
+}
+
+static bool x11_display_server_set_window_opacity(void *data, unsigned opacity)
+{
+   dispserv_x11_t *serv = (dispserv_x11_t*)data;
+   Atom net_wm_opacity  = XInternAtom(g_x11_dpy, "_NET_WM_WINDOW_OPACITY", False);
+   Atom cardinal        = XInternAtom(g_x11_dpy, "CARDINAL", False);
+
+   serv->opacity        = opacity;
+
+   opacity              = opacity * ((unsigned)-1 / 100.0);
+
+   if (opacity == (unsigned)-1)
+      XDeleteProperty(g_x11_dpy, g_x11_win, net_wm_opacity);
+   else
+      XChangeProperty(g_x11_dpy, g_x11_win, net_wm_opacity, cardinal,
+            32, PropModeReplace, (const unsigned char*)&opacity, 1);
+
+   return true;
+}
+
+static bool x11_display_server_set_window_decorations(void *data, bool on)
+{
+   dispserv_x11_t *serv = (dispserv_x11_t*)data;
+
+   if (serv)
+      serv->decorations = on;
+
+   /* menu_setting performs a reinit instead to properly apply 
+    * decoration changes */
+
+   return true;
+}
+
+static bool x11_display_server_set_resolution(void *data,
+      unsigned width, unsigned height, int int_hz, float hz, int center)
+{
+   x11_crt_mode_t *mode = NULL;
+
+   crt_en = true;
+
+   /* set core refresh from hz */
+   video_monitor_set_refresh_rate(hz);
+
+   mode = x11_crt_get_mode(width, height, hz);
+
+   /* Already on the screen, nothing to do */
+   if (mode == x11_crt_mode && mode->created)
+      return true;
+
+   if (!x11_crt_apply_mode(mode))
+      return false;
 
+   x11_crt_mode = mode;
    return true;
 }
 
@@ -646,6 +646,8 @@ static bool ctr_frame(void* data, const void* frame,
 
    if(frame)
    {
+      /* Frames from the pool (ctr_get_current_software_framebuffer)
+       * always take this path, the core wrote them in place. */
       if(((((u32)(frame)) >= 0x14000000 && ((u32)(frame)) < 0x40000000)) /* frame in linear memory */
          && !((u32)frame & 0x7F)                                         /* 128-byte aligned */
          && !(pitch & 0xF)                                               /* 16-byte aligned */
@@ -901,6 +903,7 @@ static bool ctr_suppress_screensaver(void* data, bool enable)
 
 static void ctr_free(void* data)
 {
+   int i;
    ctr_video_t* ctr = (ctr_video_t*)data;
 
    if (!ctr)
@@ -914,6 +917,8 @@ static void ctr_free(void* data)
    linearFree(ctr->display_list);
    linearFree(ctr->texture_linear);
    linearFree(ctr->texture_swizzled);
+   for (i = 0; i < CTR_FRAME_POOL_SIZE; i++)
+      linearFree(ctr->frame_pool[i]);
    linearFree(ctr->frame_coords);
    linearFree(ctr->menu.texture_linear);
    linearFree(ctr->menu.texture_swizzled);
@@ -1152,6 +1157,45 @@ static void ctr_set_osd_msg(void *data,
       font_driver_render_msg(video_info, font, msg, params);
 }
 
+static bool ctr_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   void *buffer     = NULL;
+   ctr_video_t *ctr = (ctr_video_t*)data;
+   unsigned bpp     = ctr->rgb32 ? 4 : 2;
+
+   /* Filtered or converted frames never reach us as the
+    * core wrote them, so those keep going through a copy. */
+   if (     framebuffer->width  > (unsigned)ctr->texture_width
+         || framebuffer->height > (unsigned)ctr->texture_height
+         || video_driver_frame_filter_alive()
+         || video_driver_get_pixel_format() == RETRO_PIXEL_FORMAT_0RGB1555)
+      return false;
+
+   /* The GPU reads the previous frame's buffer until the next
+    * ctr_frame waits on PPF, so alternating between two is enough. */
+   ctr->frame_pool_index = (ctr->frame_pool_index + 1) % CTR_FRAME_POOL_SIZE;
+
+   /* Allocated on first use, linear memory is scarce on Old 3DS
+    * and most cores never ask. */
+   buffer = ctr->frame_pool[ctr->frame_pool_index];
+   if (!buffer)
+   {
+      buffer = linearMemAlign(ctr->texture_width * ctr->texture_height * bpp, 128);
+      if (!buffer)
+         return false;
+      ctr->frame_pool[ctr->frame_pool_index] = buffer;
+   }
+
+   framebuffer->data         = buffer;
+   framebuffer->pitch        = ctr->texture_width * bpp;
+   framebuffer->format       = ctr->rgb32
+      ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+   return true;
+}
+
 static const video_poke_interface_t ctr_poke_interface = {
    NULL, /* get_flags */
    NULL,                                  /* set_coords */
@@ -1174,7 +1218,7 @@ static const video_poke_interface_t ctr_poke_interface = {
    NULL,                   /* show_mouse */
    NULL,                   /* grab_mouse_toggle */
    NULL,                   /* get_current_shader */
-   NULL,                   /* get_current_software_framebuffer */
+   ctr_get_current_software_framebuffer,
    NULL                    /* get_hw_render_interface */
 };
 
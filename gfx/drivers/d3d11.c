@@ -550,6 +550,8 @@ static void d3d11_gfx_free(void* data)
 
    Release(d3d11->state);
    Release(d3d11->renderTargetView);
+   if (d3d11->frame_latency)
+      CloseHandle(d3d11->frame_latency);
    Release(d3d11->swapChain);
 
    font_driver_free_osd();
@@ -571,6 +573,13 @@ static void d3d11_gfx_free(void* data)
    free(d3d11);
 }
 
+static void d3d11_swapchain_desc_blit(DXGI_SWAP_CHAIN_DESC* desc)
+{
+   desc->BufferCount = 1;
+   desc->SwapEffect  = DXGI_SWAP_EFFECT_SEQUENTIAL;
+   desc->Flags       = 0;
+}
+
    static void*
 d3d11_gfx_init(const video_info_t* video, const input_driver_t** input, void** input_data)
 {
@@ -619,6 +628,8 @@ d3d11_gfx_init(const video_info_t* video, const input_driver_t** input, void** i
          };
       DXGI_SWAP_CHAIN_DESC desc               = { 0 };
       UINT number_feature_levels              = ARRAY_SIZE(requested_feature_levels);
+      bool waitable                           = settings->bools.video_hard_sync;
+      bool tearing                            = dxgi_check_tearing_support();
 
       desc.BufferCount                        = 1;
       desc.BufferDesc.Width                   = d3d11->vp.full_width;
@@ -639,6 +650,17 @@ d3d11_gfx_init(const video_info_t* video, const input_driver_t** input, void** i
       desc.SwapEffect                         = DXGI_SWAP_EFFECT_DISCARD;
 #else
       desc.SwapEffect                         = DXGI_SWAP_EFFECT_SEQUENTIAL;
+
+      /* The frame latency object and tearing both need the flip model. */
+      if (waitable || tearing)
+      {
+         desc.BufferCount                     = 2;
+         desc.SwapEffect                      = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+         if (waitable)
+            desc.Flags                       |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+         if (tearing)
+            desc.Flags                       |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+      }
 #endif
 
 #ifdef DEBUG
@@ -659,9 +681,17 @@ d3d11_gfx_init(const video_info_t* video, const input_driver_t** input, void** i
          dxgiDevice->lpVtbl->GetAdapter(dxgiDevice, &adapter);
          adapter->lpVtbl->GetParent(
                adapter, uuidof(IDXGIFactory1), (void**)&dxgiFactory);
-         dxgiFactory->lpVtbl->CreateSwapChain(
+         if (FAILED(dxgiFactory->lpVtbl->CreateSwapChain(
                dxgiFactory, (IUnknown*)d3d11->device,
-               &desc, (IDXGISwapChain**)&d3d11->swapChain);
+               &desc, (IDXGISwapChain**)&d3d11->swapChain))
+               && desc.Flags)
+         {
+            /* Flip model needs Windows 8, fall back to blitting. */
+            d3d11_swapchain_desc_blit(&desc);
+            dxgiFactory->lpVtbl->CreateSwapChain(
+                  dxgiFactory, (IUnknown*)d3d11->device,
+                  &desc, (IDXGISwapChain**)&d3d11->swapChain);
+         }
 
          dxgiFactory->lpVtbl->Release(dxgiFactory);
          adapter->lpVtbl->Release(adapter);
@@ -669,14 +699,35 @@ d3d11_gfx_init(const video_info_t* video, const input_driver_t** input, void** i
       }
       else
       {
-         if (FAILED(D3D11CreateDeviceAndSwapChain(
-                     NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, flags,
-                     requested_feature_levels, number_feature_levels,
-                     D3D11_SDK_VERSION, &desc,
-                     (IDXGISwapChain**)&d3d11->swapChain, &d3d11->device,
-                     &d3d11->supportedFeatureLevel, &d3d11->context)))
+         HRESULT hr = D3D11CreateDeviceAndSwapChain(
+               NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, flags,
+               requested_feature_levels, number_feature_levels,
+               D3D11_SDK_VERSION, &desc,
+               (IDXGISwapChain**)&d3d11->swapChain, &d3d11->device,
+               &d3d11->supportedFeatureLevel, &d3d11->context);
+
+         if (FAILED(hr) && desc.Flags)
+         {
+            d3d11_swapchain_desc_blit(&desc);
+            hr = D3D11CreateDeviceAndSwapChain(
+                  NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, flags,
+                  requested_feature_levels, number_feature_levels,
+                  D3D11_SDK_VERSION, &desc,
+                  (IDXGISwapChain**)&d3d11->swapChain, &d3d11->device,
+                  &d3d11->supportedFeatureLevel, &d3d11->context);
+         }
+
+         if (FAILED(hr))
             goto error;
       }
+
+      d3d11->swapchain_flags = desc.Flags;
+
+      if (desc.Flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT)
+         d3d11->frame_latency = dxgi_init_frame_latency(d3d11->swapChain,
+               settings->uints.video_hard_sync_frames + 1);
+      if (desc.Flags & DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING)
+         RARCH_LOG("[D3D11]: Tearing allowed with vsync off.\n");
    }
 
    {
@@ -1122,7 +1173,8 @@ static bool d3d11_gfx_frame(
       D3D11Texture2D backBuffer;
 
       Release(d3d11->renderTargetView);
-      DXGIResizeBuffers(d3d11->swapChain, 0, 0, 0, DXGI_FORMAT_UNKNOWN, 0);
+      DXGIResizeBuffers(d3d11->swapChain, 0, 0, 0, DXGI_FORMAT_UNKNOWN,
+            d3d11->swapchain_flags);
 
       DXGIGetSwapChainBufferD3D11(d3d11->swapChain, 0, &backBuffer);
       D3D11CreateTexture2DRenderTargetView(
@@ -1141,6 +1193,9 @@ static bool d3d11_gfx_frame(
       d3d11->resize_viewport = true;
       video_driver_set_size(&video_info->width, &video_info->height);
    }
+   /* Flip model swapchains unbind the back buffer on present. */
+   else if (d3d11->swapchain_flags)
+      D3D11SetRenderTargets(context, 1, &d3d11->renderTargetView, NULL);
 
    PERF_START();
 
@@ -1402,7 +1457,14 @@ static bool d3d11_gfx_frame(
    d3d11->sprites.enabled = false;
 
    PERF_STOP();
-   DXGIPresent(d3d11->swapChain, !!d3d11->vsync, 0);
+   DXGIPresent(d3d11->swapChain, !!d3d11->vsync,
+         (!d3d11->vsync &&
+          (d3d11->swapchain_flags & DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING))
+         ? DXGI_PRESENT_ALLOW_TEARING : 0);
+
+   /* Return once the swapchain takes another frame,
+    * the next input poll then happens as late as possible. */
+   dxgi_wait_frame_latency(d3d11->frame_latency);
 
    return true;
 }
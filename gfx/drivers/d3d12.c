@@ -37,12 +37,7 @@
 
 static void d3d12_gfx_sync(d3d12_video_t* d3d12)
 {
-   if (D3D12GetCompletedValue(d3d12->queue.fence) < d3d12->queue.fenceValue)
-   {
-      D3D12SetEventOnCompletion(
-            d3d12->queue.fence, d3d12->queue.fenceValue, d3d12->queue.fenceEvent);
-      WaitForSingleObject(d3d12->queue.fenceEvent, INFINITE);
-   }
+   d3d12_wait_for_fence(d3d12, d3d12->queue.fenceValue);
 }
 
 #ifdef HAVE_OVERLAY
@@ -294,10 +289,7 @@ static void d3d12_free_shader_preset(d3d12_video_t* d3d12)
       d3d12_release_texture(&d3d12->pass[i].feedback);
 
       for (j = 0; j < SLANG_CBUFFER_MAX; j++)
-      {
          free(d3d12->pass[i].semantics.cbuffers[j].uniforms);
-         Release(d3d12->pass[i].buffers[j]);
-      }
 
       Release(d3d12->pass[i].pipe);
    }
@@ -479,21 +471,16 @@ static bool d3d12_gfx_set_shader(void* data, enum rarch_shader_type type, const
                d3d12->desc.rtv_heap.cpu.ptr +
                (countof(d3d12->chain.renderTargets) + i) * d3d12->desc.rtv_heap.stride;
 
-         d3d12->pass[i].textures.ptr =
-               d3d12->desc.srv_heap.gpu.ptr + i * SLANG_NUM_SEMANTICS * d3d12->desc.srv_heap.stride;
-         d3d12->pass[i].samplers.ptr = d3d12->desc.sampler_heap.gpu.ptr +
-                                       i * SLANG_NUM_SEMANTICS * d3d12->desc.sampler_heap.stride;
-      }
-
-      for (j = 0; j < SLANG_CBUFFER_MAX; j++)
-      {
-         if (!d3d12->pass[i].semantics.cbuffers[j].size)
-            continue;
+         /* tables reserved by d3d12_init_descriptors */
+         for (j = 0; j < D3D12_MAX_FRAMES_IN_FLIGHT; j++)
+         {
+            UINT64 slot = (j * GFX_MAX_SHADERS + i) * SLANG_NUM_BINDINGS;
 
-         d3d12->pass[i].buffer_view[j].SizeInBytes    = d3d12->pass[i].semantics.cbuffers[j].size;
-         d3d12->pass[i].buffer_view[j].BufferLocation = d3d12_create_buffer(
-               d3d12->device, d3d12->pass[i].buffer_view[j].SizeInBytes,
-               &d3d12->pass[i].buffers[j]);
+            d3d12->pass[i].textures[j].ptr =
+                  d3d12->desc.srv_heap.gpu.ptr + slot * d3d12->desc.srv_heap.stride;
+            d3d12->pass[i].samplers[j].ptr =
+                  d3d12->desc.sampler_heap.gpu.ptr + slot * d3d12->desc.sampler_heap.stride;
+         }
       }
    }
 
@@ -819,7 +806,6 @@ static void d3d12_gfx_free(void* data)
 
    font_driver_free_osd();
 
-   Release(d3d12->sprites.vbo);
    Release(d3d12->menu_pipeline_vbo);
 
    Release(d3d12->frame.ubo);
@@ -830,9 +816,11 @@ static void d3d12_gfx_free(void* data)
    Release(d3d12->menu.texture.handle);
    Release(d3d12->menu.texture.upload_buffer);
 
-   free(d3d12->desc.sampler_heap.map);
-   free(d3d12->desc.srv_heap.map);
-   free(d3d12->desc.rtv_heap.map);
+   d3d12_release_upload_ring(&d3d12->upload_ring);
+
+   free(d3d12->desc.sampler_heap.free_slots);
+   free(d3d12->desc.srv_heap.free_slots);
+   free(d3d12->desc.rtv_heap.free_slots);
    Release(d3d12->desc.sampler_heap.handle);
    Release(d3d12->desc.srv_heap.handle);
    Release(d3d12->desc.rtv_heap.handle);
@@ -854,10 +842,13 @@ static void d3d12_gfx_free(void* data)
    Release(d3d12->queue.fence);
    Release(d3d12->chain.renderTargets[0]);
    Release(d3d12->chain.renderTargets[1]);
+   if (d3d12->chain.frame_latency)
+      CloseHandle(d3d12->chain.frame_latency);
    Release(d3d12->chain.handle);
 
    Release(d3d12->queue.cmd);
-   Release(d3d12->queue.allocator);
+   for (i = 0; i < D3D12_MAX_FRAMES_IN_FLIGHT; i++)
+      Release(d3d12->queue.allocator[i]);
    Release(d3d12->queue.handle);
 
    Release(d3d12->factory);
@@ -926,11 +917,8 @@ d3d12_gfx_init(const video_info_t* video, const input_driver_t** input, void** i
    d3d12_create_fullscreen_quad_vbo(d3d12->device, &d3d12->frame.vbo_view, &d3d12->frame.vbo);
    d3d12_create_fullscreen_quad_vbo(d3d12->device, &d3d12->menu.vbo_view, &d3d12->menu.vbo);
 
-   d3d12->sprites.capacity                = 4096;
-   d3d12->sprites.vbo_view.SizeInBytes    = sizeof(d3d12_sprite_t) * d3d12->sprites.capacity;
-   d3d12->sprites.vbo_view.StrideInBytes  = sizeof(d3d12_sprite_t);
-   d3d12->sprites.vbo_view.BufferLocation = d3d12_create_buffer(
-         d3d12->device, d3d12->sprites.vbo_view.SizeInBytes, &d3d12->sprites.vbo);
+   d3d12->sprites.capacity               = 4096;
+   d3d12->sprites.vbo_view.StrideInBytes = sizeof(d3d12_sprite_t);
 
    d3d12->ubo_view.SizeInBytes = sizeof(d3d12_uniform_t);
    d3d12->ubo_view.BufferLocation =
@@ -1127,17 +1115,23 @@ static bool d3d12_gfx_frame(
    d3d12_texture_t* texture = NULL;
    d3d12_video_t*   d3d12   = (d3d12_video_t*)data;
 
-   d3d12_gfx_sync(d3d12);
+   /* Only wait for the frame that last used this allocator, the one
+    * before this may still be running on the GPU. */
+   d3d12->queue.frame = (d3d12->queue.frame + 1) % D3D12_MAX_FRAMES_IN_FLIGHT;
+   d3d12_wait_for_fence(d3d12, d3d12->queue.allocator_fence[d3d12->queue.frame]);
    PERF_START();
 
    if (d3d12->resize_chain)
    {
       unsigned i;
 
+      d3d12_gfx_sync(d3d12);
+
       for (i = 0; i < countof(d3d12->chain.renderTargets); i++)
          Release(d3d12->chain.renderTargets[i]);
 
-      DXGIResizeBuffers(d3d12->chain.handle, 0, 0, 0, DXGI_FORMAT_UNKNOWN, 0);
+      DXGIResizeBuffers(d3d12->chain.handle, 0, 0, 0, DXGI_FORMAT_UNKNOWN,
+            d3d12->chain.flags);
 
       for (i = 0; i < countof(d3d12->chain.renderTargets); i++)
       {
@@ -1159,10 +1153,11 @@ static bool d3d12_gfx_frame(
       video_driver_set_size(&video_info->width, &video_info->height);
    }
 
-   D3D12ResetCommandAllocator(d3d12->queue.allocator);
+   D3D12ResetCommandAllocator(d3d12->queue.allocator[d3d12->queue.frame]);
 
    D3D12ResetGraphicsCommandList(
-         d3d12->queue.cmd, d3d12->queue.allocator, d3d12->pipes[VIDEO_SHADER_STOCK_BLEND]);
+         d3d12->queue.cmd, d3d12->queue.allocator[d3d12->queue.frame],
+         d3d12->pipes[VIDEO_SHADER_STOCK_BLEND]);
 
    {
       D3D12DescriptorHeap desc_heaps[] = { d3d12->desc.srv_heap.handle,
@@ -1179,6 +1174,12 @@ static bool d3d12_gfx_frame(
 
    if (frame && width && height)
    {
+      /* everything below releases textures older frames may still use */
+      if (d3d12->frame.texture[0].desc.Width != width ||
+          d3d12->frame.texture[0].desc.Height != height ||
+          d3d12->resize_render_targets || d3d12->init_history)
+         d3d12_gfx_sync(d3d12);
+
       if (d3d12->shader_preset)
       {
          if (d3d12->shader_preset->luts && d3d12->luts[0].dirty)
@@ -1232,7 +1233,8 @@ static bool d3d12_gfx_frame(
       if (d3d12->resize_render_targets)
          d3d12_init_render_targets(d3d12, width, height);
 
-      d3d12_update_texture(width, height, pitch, d3d12->format, frame, &d3d12->frame.texture[0]);
+      d3d12_stream_texture(d3d12, width, height, pitch, d3d12->format, frame,
+            &d3d12->frame.texture[0]);
 
       d3d12_upload_texture(d3d12->queue.cmd, &d3d12->frame.texture[0],
             video_info->userdata);
@@ -1273,22 +1275,26 @@ static bool d3d12_gfx_frame(
 
             if (buffer_sem->stage_mask && buffer_sem->uniforms)
             {
-               D3D12_RANGE    range       = { 0, 0 };
-               uint8_t*       mapped_data = NULL;
-               uniform_sem_t* uniform     = buffer_sem->uniforms;
+               D3D12_GPU_VIRTUAL_ADDRESS gpu;
+               uniform_sem_t*            uniform     = buffer_sem->uniforms;
+               uint8_t*                  mapped_data = (uint8_t*)d3d12_upload_ring_alloc(
+                     d3d12, buffer_sem->size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT,
+                     &gpu);
 
-               D3D12Map(d3d12->pass[i].buffers[j], 0, &range, (void**)&mapped_data);
+               if (!mapped_data)
+                  continue;
+
+               /* fresh memory every frame, uniforms without data read as 0 */
+               memset(mapped_data, 0, buffer_sem->size);
                while (uniform->size)
                {
                   if (uniform->data)
                      memcpy(mapped_data + uniform->offset, uniform->data, uniform->size);
                   uniform++;
                }
-               D3D12Unmap(d3d12->pass[i].buffers[j], 0, NULL);
 
                D3D12SetGraphicsRootConstantBufferView(
-                     d3d12->queue.cmd, j == SLANG_CBUFFER_UBO ? ROOT_ID_UBO : ROOT_ID_PC,
-                     d3d12->pass[i].buffer_view[j].BufferLocation);
+                     d3d12->queue.cmd, j == SLANG_CBUFFER_UBO ? ROOT_ID_UBO : ROOT_ID_PC, gpu);
             }
          }
 #if 0
@@ -1301,7 +1307,8 @@ static bool d3d12_gfx_frame(
             {
                {
                   D3D12_CPU_DESCRIPTOR_HANDLE handle   = {
-                     d3d12->pass[i].textures.ptr - d3d12->desc.srv_heap.gpu.ptr +
+                     d3d12->pass[i].textures[d3d12->queue.frame].ptr -
+                        d3d12->desc.srv_heap.gpu.ptr +
                         d3d12->desc.srv_heap.cpu.ptr +
                         texture_sem->binding * d3d12->desc.srv_heap.stride
                   };
@@ -1318,7 +1325,8 @@ static bool d3d12_gfx_frame(
 
                {
                   D3D12_CPU_DESCRIPTOR_HANDLE handle = {
-                     d3d12->pass[i].samplers.ptr - d3d12->desc.sampler_heap.gpu.ptr +
+                     d3d12->pass[i].samplers[d3d12->queue.frame].ptr -
+                     d3d12->desc.sampler_heap.gpu.ptr +
                      d3d12->desc.sampler_heap.cpu.ptr +
                      texture_sem->binding * d3d12->desc.sampler_heap.stride
                   };
@@ -1361,9 +1369,11 @@ static bool d3d12_gfx_frame(
             }
 
             D3D12SetGraphicsRootDescriptorTable(
-                  d3d12->queue.cmd, ROOT_ID_TEXTURE_T, d3d12->pass[i].textures);
+                  d3d12->queue.cmd, ROOT_ID_TEXTURE_T,
+                  d3d12->pass[i].textures[d3d12->queue.frame]);
             D3D12SetGraphicsRootDescriptorTable(
-                  d3d12->queue.cmd, ROOT_ID_SAMPLER_T, d3d12->pass[i].samplers);
+                  d3d12->queue.cmd, ROOT_ID_SAMPLER_T,
+                  d3d12->pass[i].samplers[d3d12->queue.frame]);
          }
 
          if (d3d12->pass[i].rt.handle)
@@ -1424,12 +1434,14 @@ static bool d3d12_gfx_frame(
    D3D12SetPipelineState(d3d12->queue.cmd, d3d12->pipes[VIDEO_SHADER_STOCK_BLEND]);
    D3D12SetGraphicsRootSignature(d3d12->queue.cmd, d3d12->desc.rootSignature);
 
+   /* uploaded even while hidden, a streamed update only lives in the
+    * upload ring until this frame completes */
+   if (d3d12->menu.texture.handle && d3d12->menu.texture.dirty)
+      d3d12_upload_texture(d3d12->queue.cmd, &d3d12->menu.texture,
+            video_info->userdata);
+
    if (d3d12->menu.enabled && d3d12->menu.texture.handle)
    {
-      if (d3d12->menu.texture.dirty)
-         d3d12_upload_texture(d3d12->queue.cmd, &d3d12->menu.texture,
-               video_info->userdata);
-
       D3D12SetGraphicsRootConstantBufferView(
             d3d12->queue.cmd, ROOT_ID_UBO, d3d12->ubo_view.BufferLocation);
 
@@ -1527,10 +1539,19 @@ static bool d3d12_gfx_frame(
 
    D3D12ExecuteGraphicsCommandLists(d3d12->queue.handle, 1, &d3d12->queue.cmd);
    D3D12SignalCommandQueue(d3d12->queue.handle, d3d12->queue.fence, ++d3d12->queue.fenceValue);
+   d3d12->queue.allocator_fence[d3d12->queue.frame] = d3d12->queue.fenceValue;
+   d3d12_upload_ring_end_frame(d3d12);
 
    PERF_STOP();
 #if 1
-   DXGIPresent(d3d12->chain.handle, !!d3d12->chain.vsync, 0);
+   DXGIPresent(d3d12->chain.handle, !!d3d12->chain.vsync,
+         (!d3d12->chain.vsync &&
+          (d3d12->chain.flags & DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING))
+         ? DXGI_PRESENT_ALLOW_TEARING : 0);
+
+   /* Return once the swapchain takes another frame,
+    * the next input poll then happens as late as possible. */
+   dxgi_wait_frame_latency(d3d12->chain.frame_latency);
 #else
    DXGI_PRESENT_PARAMETERS pp = { 0 };
    DXGIPresent1(d3d12->swapchain, 0, 0, &pp);
@@ -1613,6 +1634,7 @@ static void d3d12_set_menu_texture_frame(
          d3d12->menu.texture.desc.Width  != width || 
          d3d12->menu.texture.desc.Height != height)
    {
+      d3d12_gfx_sync(d3d12);
       d3d12->menu.texture.desc.Width  = width;
       d3d12->menu.texture.desc.Height = height;
       d3d12->menu.texture.desc.Format = format;
@@ -1620,7 +1642,7 @@ static void d3d12_set_menu_texture_frame(
       d3d12_init_texture(d3d12->device, &d3d12->menu.texture);
    }
 
-   d3d12_update_texture(width, height, pitch,
+   d3d12_stream_texture(d3d12, width, height, pitch,
          format, frame, &d3d12->menu.texture);
 
    d3d12->menu.alpha = alpha;
@@ -1604,9 +1604,9 @@ static bool d3d8_frame(void *data, const void *frame,
    d3d8_set_viewports(d3d->dev, &screen_vp);
    d3d8_clear(d3d->dev, 0, 0, D3DCLEAR_TARGET, 0, 1, 0);
 
-   /* Insert black frame first, so we
+   /* Insert black frames first, so we
     * can screenshot, etc. */
-   if (video_info->black_frame_insertion)
+   for (i = 0; i < video_info->black_frames; i++)
    {
       if (!d3d8_swap(d3d, d3d->dev) || d3d->needs_restore)
          return true;
@@ -21,6 +21,7 @@
 #include <xf86drmMode.h>
 #include <libdrm/drm_fourcc.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/mman.h>
 #include <errno.h>
 
@@ -94,6 +95,8 @@ struct drm_surface
 
    /* the page that's currently on screen */
    struct drm_page *current_page;
+   /* the page of a commit whose flip hasn't happened yet */
+   struct drm_page *pending_page;
    unsigned int bpp;
    uint32_t pixformat;
 
@@ -111,7 +114,9 @@ struct drm_surface
    int total_pitch;
 
    float aspect;
-   bool flip_page;
+   /* Index of the page the next frame goes to, never
+    * current_page or pending_page once a frame is written. */
+   unsigned flip_page;
 };
 
 struct drm_struct
@@ -127,6 +132,13 @@ struct drm_struct
    uint32_t plane_id;
    uint32_t plane_fb_prop_id;
 
+   /* Only one atomic commit can be in flight on the CRTC,
+    * this is set until the flip event of the last one. */
+   bool flip_pending;
+   /* The kernel takes DRM_MODE_PAGE_FLIP_ASYNC, used
+    * with vsync off. Cleared if a commit rejects it. */
+   bool async_flip;
+
    drmModeEncoder *encoder;
    drmModeRes *resources;
 } drm;
@@ -151,6 +163,8 @@ struct drm_video
    bool menu_active;
 
    bool rgb32;
+   /* Vsync is off, flips don't wait for the last one */
+   bool nonblock;
 
    /* We use this to keep track of internal resolution changes
     * done by cores in the main surface or in the menu.
@@ -192,15 +206,121 @@ static void deinit_drm(void)
 #endif
 }
 
+static void drm_page_flip_handler(int fd, unsigned frame,
+      unsigned sec, unsigned usec, void *data)
+{
+   struct drm_surface *surface = (struct drm_surface*)data;
+
+   drm.flip_pending = false;
+
+   if (surface && surface->pending_page)
+   {
+      surface->current_page = surface->pending_page;
+      surface->pending_page = NULL;
+   }
+}
+
+/* Handles the flip event of the last commit, waiting up to
+ * timeout ms for it, or until it arrives if timeout is -1.
+ * Returns false if the flip is still pending. */
+static bool drm_gfx_wait_flip(int timeout)
+{
+   while (drm.flip_pending)
+   {
+      int ret;
+      struct pollfd fds;
+      drmEventContext evctx;
+
+      fds.fd      = drm.fd;
+      fds.events  = POLLIN;
+      fds.revents = 0;
+
+      ret         = poll(&fds, 1, timeout);
+      if (ret < 0 && errno == EINTR)
+         continue;
+      if (ret <= 0 || !(fds.revents & POLLIN))
+         return false;
+
+      memset(&evctx, 0, sizeof(evctx));
+      evctx.version           = 2;
+      evctx.page_flip_handler = drm_page_flip_handler;
+
+      if (drmHandleEvent(drm.fd, &evctx) != 0)
+      {
+         /* Don't hang on a lost event */
+         drm.flip_pending = false;
+         return true;
+      }
+   }
+
+   return true;
+}
+
+/* Next page which is neither on screen nor about to be */
+static unsigned drm_surface_next_page(struct drm_surface *surface)
+{
+   unsigned i;
+
+   for (i = 1; i <= surface->numpages; i++)
+   {
+      unsigned index        = (surface->flip_page + i) % surface->numpages;
+      struct drm_page *page = &surface->pages[index];
+
+      if (page != surface->current_page && page != surface->pending_page)
+         return index;
+   }
+
+   return surface->flip_page;
+}
+
+/* Returns the page to write the next frame to, waiting for the
+ * pending flip if every other page is on screen or about to be. */
+static struct drm_page *drm_surface_free_page(struct drm_surface *surface)
+{
+   struct drm_page *page = &surface->pages[surface->flip_page];
+
+   if (page == surface->current_page || page == surface->pending_page)
+   {
+      drm_gfx_wait_flip(-1);
+      surface->flip_page = drm_surface_next_page(surface);
+      page               = &surface->pages[surface->flip_page];
+   }
+
+   return page;
+}
+
 static void drm_surface_free(void *data, struct drm_surface **sp)
 {
    int i;
    struct drm_video *_drmvars = data;
    struct drm_surface *surface = *sp;
 
+   if (!surface)
+      return;
+
+   /* The kernel may still flip to one of these pages */
+   drm_gfx_wait_flip(-1);
+
    for (i = 0; i < surface->numpages; i++)
+   {
+      struct drm_mode_destroy_dumb destroy_dumb = {0};
+      struct modeset_buf *buf                   = &surface->pages[i].buf;
+
       surface->pages[i].used = false;
 
+      if (buf->map && buf->map != MAP_FAILED)
+         munmap(buf->map, buf->size);
+      if (buf->fb_id)
+         drmModeRmFB(drm.fd, buf->fb_id);
+      if (buf->handle)
+      {
+         destroy_dumb.handle = buf->handle;
+         drmIoctl(drm.fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy_dumb);
+      }
+      if (surface->pages[i].page_used_mutex)
+         slock_free(surface->pages[i].page_used_mutex);
+   }
+
    free(surface->pages);
 
    free(surface);
@@ -271,15 +391,27 @@ static void drm_surface_setup(void *data,  int src_width, int src_height,
    surface->flip_page = 0;
 }
 
-static void drm_page_flip(struct drm_surface *surface)
+/* Puts the page at flip_page on the plane. Returns false if the
+ * frame was dropped, its page is then written again next frame. */
+static bool drm_page_flip(struct drm_surface *surface, bool nonblock)
 {
    /* We alredy have the id of the FB_ID property of
     * the plane on which we are going to do a pageflip:
     * we got it back in drm_plane_setup()  */
    int ret;
-   static drmModeAtomicReqPtr req = NULL;
+   drmModeAtomicReqPtr req = NULL;
+   struct drm_page *page   = &surface->pages[surface->flip_page];
+   uint32_t flags          = DRM_MODE_ATOMIC_NONBLOCK
+      | DRM_MODE_PAGE_FLIP_EVENT;
+
+   /* Without vsync don't wait on the last flip, the
+    * frame that can't be flipped yet is dropped. */
+   if (!drm_gfx_wait_flip(nonblock ? 0 : -1))
+      return false;
 
    req = drmModeAtomicAlloc();
+   if (!req)
+      return false;
 
    /* We add the buffer to the plane properties we want to
     * set on an atomically, in a single step.
@@ -287,33 +419,54 @@ static void drm_page_flip(struct drm_surface *surface)
    ret = drmModeAtomicAddProperty(req,
          drm.plane_id,
          drm.plane_fb_prop_id,
-         surface->pages[surface->flip_page].buf.fb_id);
+         page->buf.fb_id);
 
    if (ret < 0)
    {
       RARCH_ERR ("DRM: failed to add atomic property for pageflip\n");
+      drmModeAtomicFree(req);
+      return false;
    }
-   /*... now we just need to do the commit */
 
-   /* REMEMBER!!! The DRM_MODE_PAGE_FLIP_EVENT flag asks the kernel
+   /* The commit returns right away, the core can run the
+    * next frame while the flip waits for vblank.
+    *
+    * REMEMBER!!! The DRM_MODE_PAGE_FLIP_EVENT flag asks the kernel
     * to send you an event to the drm.fd once the
     * pageflip is complete. If you don't want -12 errors
     * (ENOMEM), namely "Cannot allocate memory", then
-    * you must drain the event queue of that fd. */
-   ret = drmModeAtomicCommit(drm.fd, req, 0, NULL);
+    * you must drain the event queue of that fd,
+    * which drm_gfx_wait_flip() does. */
+   if (nonblock && drm.async_flip)
+      flags |= DRM_MODE_PAGE_FLIP_ASYNC;
+
+   ret = drmModeAtomicCommit(drm.fd, req, flags, surface);
+
+   if (ret < 0 && (flags & DRM_MODE_PAGE_FLIP_ASYNC))
+   {
+      RARCH_WARN("[DRM]: Async page flips rejected, flipping on vblank instead.\n");
+      drm.async_flip = false;
+      flags         &= ~DRM_MODE_PAGE_FLIP_ASYNC;
+      ret            = drmModeAtomicCommit(drm.fd, req, flags, surface);
+   }
+
+   drmModeAtomicFree(req);
 
    if (ret < 0)
    {
       RARCH_ERR ("DRM: failed to commit for pageflip: %s\n", strerror(errno));
+      return false;
    }
 
-   surface->flip_page = !(surface->flip_page);
+   drm.flip_pending      = true;
+   surface->pending_page = page;
+   surface->flip_page    = drm_surface_next_page(surface);
 
-   drmModeAtomicFree(req);
+   return true;
 }
 
 static void drm_surface_update(void *data, const void *frame,
-      struct drm_surface *surface)
+      unsigned pitch, struct drm_surface *surface)
 {
    struct drm_video *_drmvars  = data;
    struct drm_page       *page = NULL;
@@ -321,19 +474,40 @@ static void drm_surface_update(void *data, const void *frame,
    int line                    = 0;
    int src_offset              = 0;
    int dst_offset              = 0;
+   unsigned i;
+
+   /* Frames the core rendered straight into one of the pages,
+    * through get_current_software_framebuffer, are flipped
+    * without a copy. */
+   for (i = 0; i < surface->numpages; i++)
+   {
+      page = &surface->pages[i];
+
+      if (     frame == page->buf.map
+            && page != surface->current_page
+            && page != surface->pending_page)
+      {
+         surface->flip_page = i;
+         drm_page_flip(surface, _drmvars->nonblock);
+         return;
+      }
+   }
+
+   page                 = drm_surface_free_page(surface);
+   surface->total_pitch = pitch;
 
    for (line = 0; line < surface->src_height; line++)
    {
       memcpy (
-            surface->pages[surface->flip_page].buf.map + dst_offset,
+            page->buf.map + dst_offset,
             (uint8_t*)frame + src_offset,
             surface->pitch);
       src_offset += surface->total_pitch;
-      dst_offset += surface->pitch;
+      dst_offset += page->buf.stride;
    }
 
    /* Page flipping */
-   drm_page_flip(surface);
+   drm_page_flip(surface, _drmvars->nonblock);
 }
 
 
@@ -537,8 +711,13 @@ static void drm_plane_setup(struct drm_surface *surface)
    uint32_t src_x = 0;
    uint32_t src_y = 0;
 
+   /* The last commit has to land before the plane is changed. */
+   drm_gfx_wait_flip(-1);
+
    /* We have to set a buffer for the plane, whatever buffer we want,
-    * but we must set a buffer so the plane starts reading from it now. */
+    * but we must set a buffer so the plane starts reading from it now.
+    * The plane scales the frame to the CRTC rectangle, so no
+    * scaling is done on the CPU. */
    if (drmModeSetPlane(drm.fd, drm.plane_id, drm.crtc_id,
             surface->pages[surface->flip_page].buf.fb_id,
             plane_flags, plane_x, plane_y, plane_w, plane_h,
@@ -547,6 +726,11 @@ static void drm_plane_setup(struct drm_surface *surface)
       RARCH_ERR("[DRM]: failed to enable plane: %s\n", strerror(errno));
    }
 
+   /* That page is on screen now, the next frame goes elsewhere. */
+   surface->current_page = &surface->pages[surface->flip_page];
+   surface->pending_page = NULL;
+   surface->flip_page    = drm_surface_next_page(surface);
+
    RARCH_LOG("[DRM]: src_w %d, src_h %d, plane_w %d, plane_h %d\n",
          src_w, src_h, plane_w, plane_h);
 
@@ -637,6 +821,14 @@ static bool init_drm(void)
    else
       RARCH_LOG ("DRM: ATOMIC caps set\n");
 
+   {
+      uint64_t cap = 0;
+
+      drm.flip_pending = false;
+      drm.async_flip   = drmGetCap(drm.fd,
+            DRM_CAP_ASYNC_PAGE_FLIP, &cap) == 0 && cap;
+   }
+
    drm.resources = drmModeGetResources(drm.fd);
    if (!drm.resources)
    {
@@ -718,6 +910,7 @@ static void *drm_gfx_init(const video_info_t *video,
    /* Setup surface parameters */
    _drmvars->menu_active      = false;
    _drmvars->rgb32            = video->rgb32;
+   _drmvars->nonblock         = !video->vsync;
 
    /* It's very important that we set aspect here because the
     * call seq when a core is loaded is gfx_init()->set_aspect()->gfx_frame()
@@ -797,8 +990,12 @@ static bool drm_gfx_frame(void *data, const void *frame, unsigned width,
    menu_driver_frame(video_info);
 #endif
 
+   /* Duplicated frames stay on screen. */
+   if (!frame)
+      return true;
+
    /* Update main surface: locate free page, blit and flip. */
-   drm_surface_update(_drmvars, frame, _drmvars->main_surface);
+   drm_surface_update(_drmvars, frame, pitch, _drmvars->main_surface);
    return true;
 }
 
@@ -877,17 +1074,18 @@ static void drm_set_texture_frame(void *data, const void *frame, bool rgb32,
    }
 
    /* We update the menu surface if menu is active. */
-   drm_surface_update(_drmvars, frame_output, _drmvars->menu_surface);
+   drm_surface_update(_drmvars, frame_output,
+         dst_pitch, _drmvars->menu_surface);
+
+   free(frame_output);
 }
 
 static void drm_gfx_set_nonblock_state(void *data, bool state)
 {
    struct drm_video *vid = data;
 
-   (void)data;
-   (void)vid;
-
-   /* TODO */
+   if (vid)
+      vid->nonblock = state;
 }
 
 static bool drm_gfx_alive(void *data)
@@ -965,6 +1163,37 @@ static void drm_set_aspect_ratio (void *data, unsigned aspect_ratio_idx)
    }
 }
 
+static bool drm_gfx_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   struct drm_page *page       = NULL;
+   struct drm_video *_drmvars  = data;
+   struct drm_surface *surface = _drmvars ? _drmvars->main_surface : NULL;
+
+   /* Surfaces are created by the first frame of a size, and
+    * converted or filtered frames never reach us as written
+    * by the core, so those go through a copy. */
+   if (     !surface
+         || framebuffer->width  != (unsigned)surface->src_width
+         || framebuffer->height != (unsigned)surface->src_height
+         || video_driver_frame_filter_alive()
+         || video_driver_get_pixel_format() == RETRO_PIXEL_FORMAT_0RGB1555)
+      return false;
+
+   page                      = drm_surface_free_page(surface);
+   if (!page->buf.map || page->buf.map == MAP_FAILED)
+      return false;
+
+   framebuffer->data         = page->buf.map;
+   framebuffer->pitch        = page->buf.stride;
+   framebuffer->format       = _drmvars->rgb32
+      ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   /* Dumb buffers are mapped write-combined */
+   framebuffer->memory_flags = 0;
+
+   return true;
+}
+
 static const video_poke_interface_t drm_poke_interface = {
    NULL, /* get_flags */
    NULL, /* set_coords */
@@ -987,7 +1216,7 @@ static const video_poke_interface_t drm_poke_interface = {
    NULL,                         /* drm_show_mouse */
    NULL,                         /* grab_mouse_toggle */
    NULL,                         /* get_current_shader */
-   NULL,                         /* get_current_software_framebuffer */
+   drm_gfx_get_current_software_framebuffer,
    NULL                          /* get_hw_render_interface */
 };
 
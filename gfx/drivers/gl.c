@@ -55,6 +55,7 @@
 #endif
 
 #include "../font_driver.h"
+#include "../video_perf_overlay.h"
 
 #ifdef HAVE_GLSL
 #include "../drivers_shader/shader_glsl.h"
@@ -118,9 +119,16 @@ static const GLfloat white_color[] = {
 
 static bool gl_shared_context_use = false;
 
+/* The core renders into the other context, so
+ * nothing we know about the GL state holds anymore. */
 #define gl_context_bind_hw_render(gl, enable) \
-   if (gl_shared_context_use) \
-      gl->ctx_driver->bind_hw_render(gl->ctx_data, enable)
+   do { \
+      if (gl_shared_context_use) \
+      { \
+         gl->ctx_driver->bind_hw_render(gl->ctx_data, enable); \
+         gl_state_invalidate(); \
+      } \
+   } while (0)
 
 void context_bind_hw_render(void *data, bool enable)
 {
@@ -132,16 +140,21 @@ void context_bind_hw_render(void *data, bool enable)
 #ifdef HAVE_OVERLAY
 static void gl_free_overlay(gl_t *gl)
 {
-   glDeleteTextures(gl->overlays, gl->overlay_tex);
+   if (gl->overlay_tex)
+      gl_state_delete_textures(gl->overlay_atlas ? 1 : gl->overlays,
+            gl->overlay_tex);
 
    free(gl->overlay_tex);
    free(gl->overlay_vertex_coord);
    free(gl->overlay_tex_coord);
    free(gl->overlay_color_coord);
+   free(gl->overlay_indices);
    gl->overlay_tex          = NULL;
    gl->overlay_vertex_coord = NULL;
    gl->overlay_tex_coord    = NULL;
    gl->overlay_color_coord  = NULL;
+   gl->overlay_indices      = NULL;
+   gl->overlay_atlas        = false;
    gl->overlays             = 0;
 }
 
@@ -208,10 +221,10 @@ static void gl_render_overlay(gl_t *gl, video_frame_info_t *video_info)
    unsigned width                      = video_info->width;
    unsigned height                     = video_info->height;
 
-   glEnable(GL_BLEND);
+   gl_state_blend(true);
 
    if (gl->overlay_full_screen)
-      glViewport(0, 0, width, height);
+      gl_state_viewport(0, 0, width, height);
 
    /* Ensure that we reset the attrib array. */
    if (video_info->shader_driver && video_info->shader_driver->use)
@@ -231,19 +244,28 @@ static void gl_render_overlay(gl_t *gl, video_frame_info_t *video_info)
    video_info->cb_set_mvp(gl,
          video_info->shader_data, &gl->mvp_no_rot);
 
-   for (i = 0; i < gl->overlays; i++)
+   if (gl->overlay_atlas)
    {
-      glBindTexture(GL_TEXTURE_2D, gl->overlay_tex[i]);
-      glDrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
+      gl_state_bind_texture(GL_TEXTURE_2D, gl->overlay_tex[0]);
+      glDrawElements(GL_TRIANGLES, 6 * gl->overlays,
+            GL_UNSIGNED_SHORT, gl->overlay_indices);
+   }
+   else
+   {
+      for (i = 0; i < gl->overlays; i++)
+      {
+         gl_state_bind_texture(GL_TEXTURE_2D, gl->overlay_tex[i]);
+         glDrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
+      }
    }
 
-   glDisable(GL_BLEND);
+   gl_state_blend(false);
    gl->coords.vertex    = gl->vertex_ptr;
    gl->coords.tex_coord = gl->tex_info.coord;
    gl->coords.color     = gl->white_color_ptr;
    gl->coords.vertices  = 4;
    if (gl->overlay_full_screen)
-      glViewport(gl->vp.x, gl->vp.y, gl->vp.width, gl->vp.height);
+      gl_state_viewport(gl->vp.x, gl->vp.y, gl->vp.width, gl->vp.height);
 }
 #endif
 
@@ -350,7 +372,7 @@ void gl_set_viewport(gl_t *gl,
       gl->vp.y *= 2;
 #endif
 
-   glViewport(gl->vp.x, gl->vp.y, gl->vp.width, gl->vp.height);
+   gl_state_viewport(gl->vp.x, gl->vp.y, gl->vp.width, gl->vp.height);
    gl_set_projection(gl, &default_ortho, allow_rotate);
 
    /* Set last backbuffer viewport. */
@@ -579,7 +601,7 @@ static void gl_init_textures(gl_t *gl, const video_info_t *video)
                texture_fmt, texture_type);
    }
 
-   glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
 }
 
 static INLINE void gl_set_shader_viewports(gl_t *gl)
@@ -695,8 +717,54 @@ static void gl_set_texture_frame(void *data,
          width, height, frame,
          base_size);
 
+   gl->menu_texture_width     = width;
+   gl->menu_texture_height    = height;
+   gl->menu_texture_base_size = base_size;
+   gl->menu_texture_filter    = menu_filter;
+   gl->menu_texture_alpha     = alpha;
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+
+   gl_context_bind_hw_render(gl, true);
+}
+
+static void gl_set_texture_frame_rows(void *data,
+      const void *frame, bool rgb32, unsigned width, unsigned height,
+      unsigned y, unsigned rows, float alpha)
+{
+   enum texture_filter_type menu_filter;
+   settings_t *settings            = config_get_ptr();
+   unsigned base_size              = rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+   bool use_rgba                   = video_driver_supports_rgba();
+   gl_t *gl                        = (gl_t*)data;
+   if (!gl)
+      return;
+
+   menu_filter = settings->bools.menu_linear_filter ? TEXTURE_FILTER_LINEAR : TEXTURE_FILTER_NEAREST;
+
+   if (     !gl->menu_texture
+         || gl->menu_texture_width     != width
+         || gl->menu_texture_height    != height
+         || gl->menu_texture_base_size != base_size
+         || gl->menu_texture_filter    != menu_filter
+         || y + rows > height)
+   {
+      gl_set_texture_frame(gl, frame, rgb32, width, height, alpha);
+      return;
+   }
+
+   gl_context_bind_hw_render(gl, false);
+
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->menu_texture);
+   glPixelStorei(GL_UNPACK_ALIGNMENT,
+         video_pixel_get_alignment(width * base_size));
+   glTexSubImage2D(GL_TEXTURE_2D,
+         0, 0, y, width, rows,
+         (use_rgba || !rgb32) ? GL_RGBA : RARCH_GL_TEXTURE_TYPE32,
+         (rgb32) ? RARCH_GL_FORMAT32 : GL_UNSIGNED_SHORT_4_4_4_4,
+         (const uint8_t*)frame + y * width * base_size);
+
    gl->menu_texture_alpha = alpha;
-   glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
 
    gl_context_bind_hw_render(gl, true);
 }
@@ -786,8 +854,8 @@ static void gl_render_osd_background(
 
    video_driver_set_coords(&coords_data);
 
-   glEnable(GL_BLEND);
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   gl_state_blend(true);
+   gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    glBlendEquation(GL_FUNC_ADD);
 
    video_info->cb_set_mvp(gl,
@@ -879,7 +947,7 @@ static INLINE void gl_draw_texture(gl_t *gl, video_frame_info_t *video_info)
    gl->coords.tex_coord   = tex_coords;
    gl->coords.color       = color;
 
-   glBindTexture(GL_TEXTURE_2D, gl->menu_texture);
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->menu_texture);
 
    if (video_info->shader_driver && video_info->shader_driver->use)
       video_info->shader_driver->use(gl,
@@ -895,18 +963,18 @@ static INLINE void gl_draw_texture(gl_t *gl, video_frame_info_t *video_info)
    video_info->cb_set_mvp(gl,
          video_info->shader_data, &gl->mvp_no_rot);
 
-   glEnable(GL_BLEND);
+   gl_state_blend(true);
 
    if (gl->menu_texture_full_screen)
    {
-      glViewport(0, 0, width, height);
+      gl_state_viewport(0, 0, width, height);
       glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-      glViewport(gl->vp.x, gl->vp.y, gl->vp.width, gl->vp.height);
+      gl_state_viewport(gl->vp.x, gl->vp.y, gl->vp.width, gl->vp.height);
    }
    else
       glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-   glDisable(GL_BLEND);
+   gl_state_blend(false);
 
    gl->coords.vertex      = gl->vertex_ptr;
    gl->coords.tex_coord   = gl->tex_info.coord;
@@ -959,6 +1027,10 @@ static bool gl_frame(void *data, const void *frame,
 
    gl_context_bind_hw_render(gl, false);
 
+   /* A core without a shared context rendered right
+    * into ours since the last frame. */
+   gl_state_invalidate();
+
    if (gl->core_context_in_use && gl->renderchain_driver->bind_vao)
       gl->renderchain_driver->bind_vao(gl, gl->renderchain_data);
 
@@ -1015,7 +1087,7 @@ static bool gl_frame(void *data, const void *frame,
    if (frame)
       gl->tex_index = ((gl->tex_index + 1) % gl->textures);
 
-   glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
 
    /* Can be NULL for frame dupe / NULL render. */
    if (frame)
@@ -1051,8 +1123,8 @@ static bool gl_frame(void *data, const void *frame,
          gl->renderchain_driver->restore_default_state(gl, gl->renderchain_data);
 
       glDisable(GL_STENCIL_TEST);
-      glDisable(GL_BLEND);
-      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      gl_state_blend(false);
+      gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
       glBlendEquation(GL_FUNC_ADD);
       glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
    }
@@ -1107,6 +1179,9 @@ static bool gl_frame(void *data, const void *frame,
 
    video_info->cb_set_mvp(gl, video_info->shader_data, &gl->mvp);
 
+   if (gl->fbo_inited && gl->renderchain_driver->start_timer)
+      gl->renderchain_driver->start_timer(gl, gl->renderchain_data);
+
    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
    if (gl->fbo_inited && gl->renderchain_driver->renderchain_render)
@@ -1147,6 +1222,10 @@ static bool gl_frame(void *data, const void *frame,
    }
 #endif
 
+   /* Also over the menu, so its draw calls can be counted */
+   if (video_info->perf_overlay_show)
+      video_perf_overlay_render(video_info);
+
    if (!string_is_empty(msg))
    {
       if (video_info->msg_bgcolor_enable)
@@ -1169,7 +1248,7 @@ static bool gl_frame(void *data, const void *frame,
          video_info->shader_driver->use(gl,
                video_info->shader_data, 0, true);
 
-      glBindTexture(GL_TEXTURE_2D, 0);
+      gl_state_bind_texture(GL_TEXTURE_2D, 0);
       if (gl->renderchain_driver->disable_client_arrays)
          gl->renderchain_driver->disable_client_arrays(gl,
                gl->renderchain_data);
@@ -1195,16 +1274,13 @@ static bool gl_frame(void *data, const void *frame,
 
    /* emscripten has to do black frame insertion in its main loop */
 #ifndef EMSCRIPTEN
-   /* Disable BFI during fast forward, slow-motion,
-    * and pause to prevent flicker. */
-   if (
-         video_info->black_frame_insertion
-         && !video_info->input_driver_nonblock_state
-         && !video_info->runloop_is_slowmotion
-         && !video_info->runloop_is_paused)
    {
-      video_info->cb_swap_buffers(video_info->context_data, video_info);
-      glClear(GL_COLOR_BUFFER_BIT);
+      unsigned i;
+      for (i = 0; i < video_info->black_frames; i++)
+      {
+         video_info->cb_swap_buffers(video_info->context_data, video_info);
+         glClear(GL_COLOR_BUFFER_BIT);
+      }
    }
 #endif
 
@@ -1271,6 +1347,8 @@ static void gl_free(void *data)
 
    gl_context_bind_hw_render(gl, false);
 
+   gl_state_log_stats();
+
    if (gl->have_sync)
    {
       if (gl->renderchain_driver->fence_free)
@@ -1283,11 +1361,11 @@ static void gl_free(void *data)
    if (gl->renderchain_driver->disable_client_arrays)
       gl->renderchain_driver->disable_client_arrays(gl, gl->renderchain_data);
 
-   glDeleteTextures(gl->textures, gl->texture);
+   gl_state_delete_textures(gl->textures, gl->texture);
 
 #if defined(HAVE_MENU)
    if (gl->menu_texture)
-      glDeleteTextures(1, &gl->menu_texture);
+      gl_state_delete_textures(1, &gl->menu_texture);
 #endif
 
 #ifdef HAVE_OVERLAY
@@ -1739,6 +1817,8 @@ static void *gl_init(const video_info_t *video,
    gl->ctx_driver                       = ctx_driver;
    gl->video_info                       = *video;
 
+   gl_state_invalidate();
+
    RARCH_LOG("[GL]: Found GL context: %s\n", ctx_driver->ident);
 
    video_context_driver_get_video_size(&mode);
@@ -1820,7 +1900,7 @@ static void *gl_init(const video_info_t *video,
       if (gl->renderchain_driver->new_vao)
          gl->renderchain_driver->new_vao(gl, gl->renderchain_data);
 
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    glBlendEquation(GL_FUNC_ADD);
 
    gl->hw_render_use    = false;
@@ -2104,7 +2184,7 @@ static void gl_update_tex_filter_frame(gl_t *gl)
             gl->tex_min_filter);
    }
 
-   glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
    gl_context_bind_hw_render(gl, true);
 }
 
@@ -2149,7 +2229,7 @@ static bool gl_set_shader(void *data,
       if (gl->renderchain_driver->deinit_fbo)
          gl->renderchain_driver->deinit_fbo(gl, gl->renderchain_data);
 
-      glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+      gl_state_bind_texture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
    }
 
    init_data.shader_type = type;
@@ -2181,7 +2261,7 @@ static bool gl_set_shader(void *data,
             gl->renderchain_driver->deinit_hw_render)
          gl->renderchain_driver->deinit_hw_render(gl, gl->renderchain_data);
 
-      glDeleteTextures(gl->textures, gl->texture);
+      gl_state_delete_textures(gl->textures, gl->texture);
 #if defined(HAVE_PSGL)
       glBindBuffer(GL_TEXTURE_REFERENCE_BUFFER_SCE, 0);
       glDeleteBuffers(1, &gl->pbo);
@@ -2240,66 +2320,84 @@ static bool gl_read_viewport(void *data, uint8_t *buffer, bool is_idle)
          buffer, is_idle);
 }
 
-#if 0
-#define READ_RAW_GL_FRAME_TEST
-#endif
-
-#if defined(READ_RAW_GL_FRAME_TEST)
 static void* gl_read_frame_raw(void *data, unsigned *width_p,
-unsigned *height_p, size_t *pitch_p)
+      unsigned *height_p, size_t *pitch_p)
 {
-   gl_t *gl             = (gl_t*)data;
-   unsigned width       = gl->last_width[gl->tex_index];
-   unsigned height      = gl->last_height[gl->tex_index];
-   size_t pitch         = gl->tex_w * gl->base_size;
-   void* buffer         = NULL;
-   void* buffer_texture = NULL;
+   gl_t *gl        = (gl_t*)data;
+   unsigned width  = gl->tex_info.input_size[0];
+   unsigned height = gl->tex_info.input_size[1];
+   uint8_t *buffer = NULL;
 
-   if (gl->hw_render_use)
-   {
-      buffer = malloc(pitch * height);
-      if (!buffer)
-         return NULL;
-   }
+   if (     !gl->hw_render_use
+         || !gl->renderchain_driver->read_hw_frame)
+      return NULL;
 
-   buffer_texture = malloc(pitch * gl->tex_h);
+   buffer = (uint8_t*)malloc(width * height * 3);
+   if (!buffer)
+      return NULL;
 
-   if (!buffer_texture)
+   if (!gl->renderchain_driver->read_hw_frame(gl, gl->renderchain_data,
+            buffer, width, height))
    {
-      if (buffer)
-         free(buffer);
+      free(buffer);
       return NULL;
    }
 
-   glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
-   glGetTexImage(GL_TEXTURE_2D, 0,
-         gl->texture_type, gl->texture_fmt, buffer_texture);
-
    *width_p  = width;
    *height_p = height;
-   *pitch_p  = pitch;
+   *pitch_p  = width * 3;
 
-   if (gl->hw_render_use)
+   return buffer;
+}
+
+#ifdef HAVE_OVERLAY
+/* Allocates the quads and @num_textures texture names, with every
+ * quad stretched over the whole screen and the whole texture. */
+static bool gl_overlay_alloc(gl_t *gl,
+      unsigned num_images, unsigned num_textures)
+{
+   unsigned i, j;
+
+   gl_free_overlay(gl);
+
+   gl->overlay_tex          = (GLuint*)
+      calloc(num_textures, sizeof(*gl->overlay_tex));
+   gl->overlay_vertex_coord = (GLfloat*)
+      calloc(2 * 4 * num_images, sizeof(GLfloat));
+   gl->overlay_tex_coord    = (GLfloat*)
+      calloc(2 * 4 * num_images, sizeof(GLfloat));
+   gl->overlay_color_coord  = (GLfloat*)
+      calloc(4 * 4 * num_images, sizeof(GLfloat));
+
+   if (     !gl->overlay_tex
+         || !gl->overlay_vertex_coord
+         || !gl->overlay_tex_coord
+         || !gl->overlay_color_coord)
    {
-      unsigned i;
+      gl_free_overlay(gl);
+      return false;
+   }
 
-      for(i = 0; i < height ; i++)
-         memcpy((uint8_t*)buffer + i * pitch,
-            (uint8_t*)buffer_texture + (height - 1 - i) * pitch, pitch);
+   gl->overlays             = num_images;
+   glGenTextures(num_textures, gl->overlay_tex);
+
+   for (i = 0; i < num_images; i++)
+   {
+      /* Default. Stretch to whole screen. */
+      gl_overlay_tex_geom(gl, i, 0, 0, 1, 1);
+      gl_overlay_vertex_geom(gl, i, 0, 0, 1, 1);
 
-      free(buffer_texture);
-      return buffer;
+      for (j = 0; j < 16; j++)
+         gl->overlay_color_coord[16 * i + j] = 1.0f;
    }
 
-   return buffer_texture;
+   return true;
 }
-#endif
 
-#ifdef HAVE_OVERLAY
 static bool gl_overlay_load(void *data,
       const void *image_data, unsigned num_images)
 {
-   unsigned i, j;
+   unsigned i;
    gl_t *gl = (gl_t*)data;
    const struct texture_image *images =
       (const struct texture_image*)image_data;
@@ -2309,31 +2407,12 @@ static bool gl_overlay_load(void *data,
 
    gl_context_bind_hw_render(gl, false);
 
-   gl_free_overlay(gl);
-   gl->overlay_tex = (GLuint*)
-      calloc(num_images, sizeof(*gl->overlay_tex));
-
-   if (!gl->overlay_tex)
+   if (!gl_overlay_alloc(gl, num_images, num_images))
    {
       gl_context_bind_hw_render(gl, true);
       return false;
    }
 
-   gl->overlay_vertex_coord = (GLfloat*)
-      calloc(2 * 4 * num_images, sizeof(GLfloat));
-   gl->overlay_tex_coord    = (GLfloat*)
-      calloc(2 * 4 * num_images, sizeof(GLfloat));
-   gl->overlay_color_coord  = (GLfloat*)
-      calloc(4 * 4 * num_images, sizeof(GLfloat));
-
-   if (     !gl->overlay_vertex_coord
-         || !gl->overlay_tex_coord
-         || !gl->overlay_color_coord)
-      return false;
-
-   gl->overlays             = num_images;
-   glGenTextures(num_images, gl->overlay_tex);
-
    for (i = 0; i < num_images; i++)
    {
       unsigned alignment = video_pixel_get_alignment(images[i].width
@@ -2344,20 +2423,70 @@ static bool gl_overlay_load(void *data,
             alignment,
             images[i].width, images[i].height, images[i].pixels,
             sizeof(uint32_t));
-
-      /* Default. Stretch to whole screen. */
-      gl_overlay_tex_geom(gl, i, 0, 0, 1, 1);
-      gl_overlay_vertex_geom(gl, i, 0, 0, 1, 1);
-
-      for (j = 0; j < 16; j++)
-         gl->overlay_color_coord[16 * i + j] = 1.0f;
    }
 
    gl_context_bind_hw_render(gl, true);
    return true;
 }
 
+/* One texture for the whole overlay, and an index list turning
+ * the quads' strips into triangles, so it draws in one call. */
+static bool gl_overlay_load_atlas(void *data,
+      const void *atlas_data, unsigned num_images)
+{
+   unsigned i;
+   GLint max_size = 0;
+   gl_t *gl       = (gl_t*)data;
+   const struct texture_image *atlas =
+      (const struct texture_image*)atlas_data;
+
+   /* Indices are 16-bit. */
+   if (!gl || !num_images || num_images > 65536 / 4)
+      return false;
+
+   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+   if (     atlas->width  > (unsigned)max_size
+         || atlas->height > (unsigned)max_size)
+      return false;
+
+   gl_context_bind_hw_render(gl, false);
+
+   if (!gl_overlay_alloc(gl, num_images, 1))
+      goto error;
+
+   gl->overlay_indices = (GLushort*)
+      malloc(6 * num_images * sizeof(*gl->overlay_indices));
+   if (!gl->overlay_indices)
+      goto error;
+
+   for (i = 0; i < num_images; i++)
+   {
+      GLushort *idx = &gl->overlay_indices[6 * i];
+      GLushort base = (GLushort)(4 * i);
+
+      idx[0] = base;
+      idx[1] = base + 1;
+      idx[2] = base + 2;
+      idx[3] = base + 2;
+      idx[4] = base + 1;
+      idx[5] = base + 3;
+   }
 
+   gl_load_texture_data(gl->overlay_tex[0],
+         RARCH_WRAP_EDGE, TEXTURE_FILTER_LINEAR,
+         video_pixel_get_alignment(atlas->width * sizeof(uint32_t)),
+         atlas->width, atlas->height, atlas->pixels,
+         sizeof(uint32_t));
+
+   gl->overlay_atlas = true;
+   gl_context_bind_hw_render(gl, true);
+   return true;
+
+error:
+   gl_free_overlay(gl);
+   gl_context_bind_hw_render(gl, true);
+   return false;
+}
 
 static void gl_overlay_enable(void *data, bool state)
 {
@@ -2403,6 +2532,7 @@ static const video_overlay_interface_t gl_overlay_interface = {
    gl_overlay_vertex_geom,
    gl_overlay_full_screen,
    gl_overlay_set_alpha,
+   gl_overlay_load_atlas,
 };
 
 static void gl_get_overlay_interface(void *data,
@@ -2560,7 +2690,7 @@ static void gl_unload_texture(void *data, uintptr_t id)
       return;
 
    glid = (GLuint)id;
-   glDeleteTextures(1, &glid);
+   gl_state_delete_textures(1, &glid);
 }
 
 static void gl_set_coords(void *handle_data, void *shader_data,
@@ -2623,7 +2753,8 @@ static const video_poke_interface_t gl_poke_interface = {
    NULL,
    gl_get_current_shader,
    NULL,                      /* get_current_software_framebuffer */
-   NULL                       /* get_hw_render_interface */
+   NULL,                      /* get_hw_render_interface */
+   gl_set_texture_frame_rows
 };
 
 static void gl_get_poke_interface(void *data,
@@ -2653,11 +2784,7 @@ video_driver_t video_gl = {
    gl_viewport_info,
 
    gl_read_viewport,
-#if defined(READ_RAW_GL_FRAME_TEST)
    gl_read_frame_raw,
-#else
-   NULL,
-#endif
 
 #ifdef HAVE_OVERLAY
    gl_get_overlay_interface,
@@ -0,0 +1,15 @@
+#include "shaders_common.h"
+
+static const char *stock_fragment_core_font_sdf = GLSL(
+   uniform sampler2D Texture;
+   in vec2 tex_coord;
+   in vec4 color;
+   out vec4 FragColor;
+
+   void main() {
+      float dist  = texture(Texture, tex_coord).a;
+      float width = fwidth(dist);
+      float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+      FragColor = vec4(color.rgb, color.a * alpha);
+   }
+);
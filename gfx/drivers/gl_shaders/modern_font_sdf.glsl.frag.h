@@ -0,0 +1,13 @@
+#include "shaders_common.h"
+
+static const char *stock_fragment_modern_font_sdf = GLSL(
+   uniform sampler2D Texture;
+   varying vec2 tex_coord;
+   varying vec4 color;
+   void main() {
+      float dist  = texture2D(Texture, tex_coord).a;
+      float width = fwidth(dist);
+      float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+      gl_FragColor = vec4(color.rgb, color.a * alpha);
+   }
+);
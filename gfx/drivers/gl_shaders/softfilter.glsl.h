@@ -0,0 +1,86 @@
+/* GPU versions of the gfx/video_filters softfilters, run as a hidden
+ * first pass over the core frame. Plain strings instead of GLSL()
+ * since they need the preprocessor to cover legacy, core and GLES.
+ *
+ * The fragment shader is Scale2x (EPX is the same rule) unless
+ * SOFTFILTER_LQ2X is defined, and wants SOFTFILTER_RGB565 for
+ * 16-bit cores. Neighbours are clamped to the frame like the CPU
+ * versions do, and LQ2x blends on the channel levels of the packed
+ * pixel so the output matches them exactly. */
+
+#define SOFTFILTER_GLSL_COMMON \
+   "#if __VERSION__ >= 130\n" \
+   "#ifdef VERTEX\n" \
+   "#define COMPAT_VARYING out\n" \
+   "#else\n" \
+   "#define COMPAT_VARYING in\n" \
+   "#endif\n" \
+   "#define COMPAT_ATTRIBUTE in\n" \
+   "#define COMPAT_TEXTURE texture\n" \
+   "#else\n" \
+   "#define COMPAT_VARYING varying\n" \
+   "#define COMPAT_ATTRIBUTE attribute\n" \
+   "#define COMPAT_TEXTURE texture2D\n" \
+   "#endif\n" \
+   "#ifdef GL_ES\n" \
+   "#ifdef GL_FRAGMENT_PRECISION_HIGH\n" \
+   "precision highp float;\n" \
+   "#else\n" \
+   "precision mediump float;\n" \
+   "#endif\n" \
+   "#endif\n"
+
+static const char *stock_vertex_softfilter =
+   SOFTFILTER_GLSL_COMMON
+   "COMPAT_ATTRIBUTE vec2 VertexCoord;\n"
+   "COMPAT_ATTRIBUTE vec2 TexCoord;\n"
+   "uniform mat4 MVPMatrix;\n"
+   "COMPAT_VARYING vec2 tex_coord;\n"
+   "void main() {\n"
+   "   gl_Position = MVPMatrix * vec4(VertexCoord, 0.0, 1.0);\n"
+   "   tex_coord = TexCoord;\n"
+   "}\n";
+
+static const char *stock_fragment_softfilter =
+   SOFTFILTER_GLSL_COMMON
+   "uniform sampler2D Texture;\n"
+   "uniform vec2 TextureSize;\n"
+   "uniform vec2 InputSize;\n"
+   "COMPAT_VARYING vec2 tex_coord;\n"
+   "#if __VERSION__ >= 130\n"
+   "out vec4 FragColor;\n"
+   "#else\n"
+   "#define FragColor gl_FragColor\n"
+   "#endif\n"
+   "#ifdef SOFTFILTER_RGB565\n"
+   "#define LEVELS vec3(31.0, 63.0, 31.0)\n"
+   "#else\n"
+   "#define LEVELS vec3(255.0)\n"
+   "#endif\n"
+   "vec3 fetch(vec2 texel, vec2 offset) {\n"
+   "   vec2 pos = clamp(texel + offset, vec2(0.0), InputSize - vec2(1.0));\n"
+   "   return COMPAT_TEXTURE(Texture, (pos + vec2(0.5)) / TextureSize).rgb;\n"
+   "}\n"
+   "void main() {\n"
+   "   vec2 pos   = tex_coord * TextureSize;\n"
+   "   vec2 texel = floor(pos);\n"
+   "   bool right = pos.x - texel.x >= 0.5;\n"
+   "   bool down  = pos.y - texel.y >= 0.5;\n"
+   "   vec3 A = fetch(texel, vec2( 0.0, -1.0));\n"
+   "   vec3 B = fetch(texel, vec2(-1.0,  0.0));\n"
+   "   vec3 C = fetch(texel, vec2( 0.0,  0.0));\n"
+   "   vec3 D = fetch(texel, vec2( 1.0,  0.0));\n"
+   "   vec3 E = fetch(texel, vec2( 0.0,  1.0));\n"
+   "   vec3 h = right ? D : B;\n"
+   "   vec3 v = down  ? E : A;\n"
+   "   vec3 c = C;\n"
+   "   if (A != E && B != D && h == v) {\n"
+   "#ifdef SOFTFILTER_LQ2X\n"
+   "      vec3 l = floor(C * LEVELS + vec3(0.5)) + floor(v * LEVELS + vec3(0.5));\n"
+   "      c = floor(l * 0.5) / LEVELS;\n"
+   "#else\n"
+   "      c = v;\n"
+   "#endif\n"
+   "   }\n"
+   "   FragColor = vec4(c, 1.0);\n"
+   "}\n";
@@ -76,33 +76,210 @@ static int sixel_write(char *data, int size, void *priv)
    return fwrite(data, 1, size, (FILE*)priv);
 }
 
-static SIXELSTATUS output_sixel(unsigned char *pixbuf, int width, int height,
-      int ncolors, int pixelformat)
+static SIXELSTATUS sixel_quantize(sixel_t *sixel,
+      unsigned char *pixbuf, int width, int height, int pixelformat)
 {
-   sixel_output_t *context;
-   sixel_dither_t *dither;
    SIXELSTATUS status;
 
-   context = sixel_output_create(sixel_write, stdout);
-   dither = sixel_dither_create(ncolors);
-   status = sixel_dither_initialize(dither, pixbuf,
+   if (sixel->dither)
+      sixel_dither_unref(sixel->dither);
+
+   sixel->dither = sixel_dither_create(SIXEL_COLORS);
+   if (!sixel->dither)
+      return SIXEL_BAD_ALLOCATION;
+
+   status = sixel_dither_initialize(sixel->dither, pixbuf,
          width, height,
          pixelformat,
          SIXEL_LARGE_AUTO,
          SIXEL_REP_AUTO,
          SIXEL_QUALITY_AUTO);
+
    if (SIXEL_FAILED(status))
-      return status;
-   status = sixel_encode(pixbuf, width, height,
-         pixelformat, dither, context);
-   if (SIXEL_FAILED(status))
-      return status;
-   sixel_output_unref(context);
-   sixel_dither_unref(dither);
+   {
+      sixel_dither_unref(sixel->dither);
+      sixel->dither = NULL;
+   }
 
    return status;
 }
 
+static SIXELSTATUS output_sixel(sixel_t *sixel, unsigned char *pixbuf,
+      int width, int height, int pixelformat)
+{
+   if (!sixel->output)
+   {
+      sixel->output = sixel_output_create(sixel_write, stdout);
+      if (!sixel->output)
+         return SIXEL_BAD_ALLOCATION;
+   }
+
+   return sixel_encode(pixbuf, width, height,
+         pixelformat, sixel->dither, sixel->output);
+}
+
+/* Finds the first and last pixel that changed in one band,
+ * returns false if the band is unchanged. */
+static bool sixel_band_span(sixel_t *sixel, const unsigned *pixels,
+      unsigned y0, unsigned y1, unsigned *x0, unsigned *x1)
+{
+   unsigned y;
+   unsigned width = sixel->screen_width;
+   unsigned first = width;
+   unsigned last  = 0;
+
+   for (y = y0; y < y1; y++)
+   {
+      unsigned l, r;
+      const unsigned *cur  = pixels + y * width;
+      const unsigned *prev = sixel->prev_buf + y * width;
+
+      if (!memcmp(cur, prev, width * sizeof(unsigned)))
+         continue;
+
+      for (l = 0; cur[l] == prev[l]; l++);
+      for (r = width - 1; cur[r] == prev[r]; r--);
+
+      if (l < first)
+         first = l;
+      if (r + 1 > last)
+         last  = r + 1;
+   }
+
+   if (first >= last)
+      return false;
+
+   *x0 = first;
+   *x1 = last;
+   return true;
+}
+
+/* Sends the part of the frame that differs from the last one.
+ *
+ * The image is cut into bands that are a whole number of text rows and
+ * of sixel rows (6 pixels) high, so each band can be placed with plain
+ * cursor movement from the saved origin and never overdraws the band
+ * below it. Runs of changed bands go out as one image, trimmed
+ * horizontally to the changed text columns. The palette is only
+ * recomputed for full redraws, which saves the median cut on every
+ * frame and keeps colours stable between partial updates. */
+static void sixel_output_frame(sixel_t *sixel, unsigned *pixels,
+      int pixfmt)
+{
+   unsigned band, dirty;
+   unsigned bands     = 0;
+   SIXELSTATUS status = SIXEL_OK;
+   unsigned width     = sixel->screen_width;
+   unsigned height    = sixel->screen_height;
+   unsigned bh        = sixel->band_height;
+   bool full          = sixel->full_redraw
+      || !bh
+      || !sixel->dither
+      || !sixel->prev_buf
+      || !sixel->band_spans
+      || pixfmt != sixel->prev_pixfmt;
+
+   if (!full)
+   {
+      bands = (height + bh - 1) / bh;
+      dirty = 0;
+
+      for (band = 0; band < bands; band++)
+      {
+         unsigned *span = &sixel->band_spans[band * 2];
+         unsigned y1    = MIN((band + 1) * bh, height);
+
+         if (sixel_band_span(sixel, pixels, band * bh, y1,
+                  &span[0], &span[1]))
+            dirty++;
+         else
+            span[0] = span[1] = 0;
+      }
+
+      if (!dirty)
+         return;
+
+      /* Past this the partial images cost about as much as a full one,
+       * and a scene change is a good time to refresh the palette. */
+      if (dirty * 2 > bands)
+         full = true;
+   }
+
+   if (full)
+   {
+      status = sixel_quantize(sixel, (unsigned char*)pixels,
+            width, height, pixfmt);
+
+      if (!SIXEL_FAILED(status))
+      {
+         printf("\0338");
+         status = output_sixel(sixel, (unsigned char*)pixels,
+               width, height, pixfmt);
+      }
+   }
+   else
+   {
+      for (band = 0; band < bands && !SIXEL_FAILED(status); )
+      {
+         unsigned y, x0, x1, y0, y1, last;
+
+         if (sixel->band_spans[band * 2] == sixel->band_spans[band * 2 + 1])
+         {
+            band++;
+            continue;
+         }
+
+         x0 = sixel->band_spans[band * 2];
+         x1 = sixel->band_spans[band * 2 + 1];
+
+         for (last = band + 1; last < bands
+               && sixel->band_spans[last * 2] != sixel->band_spans[last * 2 + 1];
+               last++)
+         {
+            x0 = MIN(x0, sixel->band_spans[last * 2]);
+            x1 = MAX(x1, sixel->band_spans[last * 2 + 1]);
+         }
+
+         /* Snap to text columns, the cursor can't go anywhere else */
+         x0 = x0 / sixel->cell_width * sixel->cell_width;
+         x1 = MIN(width, (x1 + sixel->cell_width - 1)
+               / sixel->cell_width * sixel->cell_width);
+         y0 = band * bh;
+         y1 = MIN(last * bh, height);
+
+         for (y = y0; y < y1; y++)
+            memcpy(sixel->region_buf + (y - y0) * (x1 - x0),
+                  pixels + y * width + x0, (x1 - x0) * sizeof(unsigned));
+
+         printf("\0338");
+         if (y0)
+            printf("\033[%uB", y0 / sixel->cell_height);
+         if (x0)
+            printf("\033[%uC", x0 / sixel->cell_width);
+
+         status = output_sixel(sixel, (unsigned char*)sixel->region_buf,
+               x1 - x0, y1 - y0, pixfmt);
+
+         band = last;
+      }
+   }
+
+   sixel->sixel_status = status;
+
+   if (SIXEL_FAILED(status))
+   {
+      fprintf(stderr, "%s\n%s\n",
+            sixel_helper_format_error(status),
+            sixel_helper_get_additional_message());
+      sixel->full_redraw = true;
+      return;
+   }
+
+   memcpy(sixel->prev_buf, pixels, width * height * sizeof(unsigned));
+   sixel->prev_pixfmt = pixfmt;
+   sixel->full_redraw = false;
+}
+
 #ifdef HAVE_SYS_IOCTL_H
 # ifdef HAVE_TERMIOS_H
 static int wait_stdin(int usec)
@@ -186,6 +363,35 @@ static void scroll_on_demand(int pixelheight)
 #endif  /* HAVE_SYS_IOCTL_H */
 }
 
+/* Text cell size in pixels, needed to place partial images.
+ * Leaves band_height at 0 (full frames only) if the terminal
+ * doesn't report its pixel size. */
+static void sixel_measure_cells(sixel_t *sixel)
+{
+#ifdef HAVE_SYS_IOCTL_H
+   struct winsize size = {0, 0, 0, 0};
+#endif
+
+   sixel->cell_width  = 0;
+   sixel->cell_height = 0;
+   sixel->band_height = 0;
+
+#ifdef HAVE_SYS_IOCTL_H
+   if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == -1
+         || !size.ws_col || !size.ws_row
+         || size.ws_xpixel < size.ws_col || size.ws_ypixel < size.ws_row)
+      return;
+
+   sixel->cell_width  = size.ws_xpixel / size.ws_col;
+   sixel->cell_height = size.ws_ypixel / size.ws_row;
+
+   /* Smallest multiple of the cell height that is also whole sixel rows */
+   sixel->band_height = sixel->cell_height;
+   while (sixel->band_height % 6)
+      sixel->band_height += sixel->cell_height;
+#endif
+}
+
 static void *sixel_gfx_init(const video_info_t *video,
       const input_driver_t **input, void **input_data)
 {
@@ -320,6 +526,18 @@ static bool sixel_gfx_frame(void *data, const void *frame,
       }
 
       sixel_temp_buf = (unsigned*)malloc(sixel->screen_width * sixel->screen_height * sizeof(unsigned));
+
+      free(sixel->prev_buf);
+      free(sixel->region_buf);
+      free(sixel->band_spans);
+
+      sixel_measure_cells(sixel);
+
+      sixel->prev_buf    = (unsigned*)malloc(sixel->screen_width * sixel->screen_height * sizeof(unsigned));
+      sixel->region_buf  = (unsigned*)malloc(sixel->screen_width * sixel->screen_height * sizeof(unsigned));
+      sixel->band_spans  = sixel->band_height ? (unsigned*)malloc(
+            2 * ((sixel->screen_height + sixel->band_height - 1) / sixel->band_height) * sizeof(unsigned)) : NULL;
+      sixel->full_redraw = true;
    }
 
    if (bits == 16)
@@ -406,19 +624,11 @@ static bool sixel_gfx_frame(void *data, const void *frame,
       frame_to_copy = sixel_temp_buf;
    }
 
-   if (draw && sixel->screen_width > 0 && sixel->screen_height > 0)
+   if (draw && sixel->screen_width > 0 && sixel->screen_height > 0
+         && frame_to_copy == sixel_temp_buf)
    {
-      printf("\0338");
-
-      sixel->sixel_status = output_sixel((unsigned char*)frame_to_copy, sixel->screen_width, sixel->screen_height,
-            SIXEL_COLORS, pixfmt);
-
-      if (SIXEL_FAILED(sixel->sixel_status))
-      {
-         fprintf(stderr, "%s\n%s\n",
-               sixel_helper_format_error(sixel->sixel_status),
-               sixel_helper_get_additional_message());
-      }
+      sixel_output_frame(sixel, sixel_temp_buf, pixfmt);
+      fflush(stdout);
    }
 
    if (msg)
@@ -495,7 +705,16 @@ static void sixel_gfx_free(void *data)
    font_driver_free_osd();
 
    if (sixel)
+   {
+      if (sixel->dither)
+         sixel_dither_unref(sixel->dither);
+      if (sixel->output)
+         sixel_output_unref(sixel->output);
+      free(sixel->prev_buf);
+      free(sixel->region_buf);
+      free(sixel->band_spans);
       free(sixel);
+   }
 }
 
 static bool sixel_gfx_set_shader(void *data,
@@ -20,6 +20,8 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <formats/image.h>
@@ -27,6 +29,8 @@
 #include <retro_miscellaneous.h>
 #include <retro_math.h>
 #include <retro_assert.h>
+#include <features/features_cpu.h>
+#include <queues/task_queue.h>
 #include <libretro.h>
 
 #ifdef HAVE_CONFIG_H
@@ -38,6 +42,7 @@
 #endif
 
 #include "../font_driver.h"
+#include "../video_perf_overlay.h"
 
 #include "../common/vulkan_common.h"
 
@@ -182,7 +187,8 @@ static void vulkan_init_pipeline_layout(
    VkDescriptorSetLayoutBinding bindings[2]        = {{0}};
 
    bindings[0].binding            = 0;
-   bindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+   /* Dynamic, so draws can share sets, see vulkan_bind_descriptors() */
+   bindings[0].descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
    bindings[0].descriptorCount    = 1;
    bindings[0].stageFlags         = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
    bindings[0].pImmutableSamplers = NULL;
@@ -620,7 +626,7 @@ static void vulkan_init_descriptor_pool(vk_t *vk)
 {
    unsigned i;
    static const VkDescriptorPoolSize pool_sizes[2] = {
-      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VULKAN_DESCRIPTOR_MANAGER_BLOCK_SETS },
+      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VULKAN_DESCRIPTOR_MANAGER_BLOCK_SETS },
       { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VULKAN_DESCRIPTOR_MANAGER_BLOCK_SETS },
    };
 
@@ -642,6 +648,22 @@ static void vulkan_deinit_descriptor_pool(vk_t *vk)
             &vk->swapchain[i].descriptor_manager);
 }
 
+/* 0RGB1555 is uploaded as A1R5G5B5, its unused top bit
+ * must not end up in the alpha channel. */
+static const VkComponentMapping *vulkan_get_tex_swizzle(vk_t *vk)
+{
+   static const VkComponentMapping swizzle_rgb1555 = {
+      VK_COMPONENT_SWIZZLE_R,
+      VK_COMPONENT_SWIZZLE_G,
+      VK_COMPONENT_SWIZZLE_B,
+      VK_COMPONENT_SWIZZLE_ONE,
+   };
+
+   if (vk->tex_fmt == VK_FORMAT_A1R5G5B5_UNORM_PACK16)
+      return &swizzle_rgb1555;
+   return NULL;
+}
+
 static void vulkan_init_textures(vk_t *vk)
 {
    unsigned i;
@@ -654,7 +676,7 @@ static void vulkan_init_textures(vk_t *vk)
       {
          vk->swapchain[i].texture = vulkan_create_texture(vk, NULL,
                vk->tex_w, vk->tex_h, vk->tex_fmt,
-               NULL, NULL, VULKAN_TEXTURE_STREAMED);
+               NULL, vulkan_get_tex_swizzle(vk), VULKAN_TEXTURE_STREAMED);
 
          vulkan_map_persistent_texture(
                vk->context->device,
@@ -663,7 +685,7 @@ static void vulkan_init_textures(vk_t *vk)
          if (vk->swapchain[i].texture.type == VULKAN_TEXTURE_STAGING)
             vk->swapchain[i].texture_optimal = vulkan_create_texture(vk, NULL,
                   vk->tex_w, vk->tex_h, vk->tex_fmt,
-                  NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
+                  NULL, vulkan_get_tex_swizzle(vk), VULKAN_TEXTURE_DYNAMIC);
       }
    }
 
@@ -766,6 +788,7 @@ static bool vulkan_init_default_filter_chain(vk_t *vk)
    info.pipeline_cache        = vk->pipelines.cache;
    info.queue                 = vk->context->queue;
    info.command_pool          = vk->swapchain[vk->context->current_swapchain_index].cmd_pool;
+   info.queue_family_index    = vk->context->graphics_queue_index;
    info.max_input_size.width  = vk->tex_w;
    info.max_input_size.height = vk->tex_h;
    info.swapchain.viewport    = vk->vk_vp;
@@ -788,25 +811,56 @@ static bool vulkan_init_default_filter_chain(vk_t *vk)
    return true;
 }
 
+static unsigned vulkan_filter_chain_record_threads(void)
+{
+#ifdef HAVE_THREADS
+   settings_t *settings = config_get_ptr();
+
+   if (settings->bools.video_shader_parallel_record)
+      return cpu_features_get_core_amount();
+#endif
+   return 0;
+}
+
+static void vulkan_filter_chain_preset_info(vk_t *vk,
+      struct vulkan_filter_chain_create_info *info)
+{
+   settings_t *settings = config_get_ptr();
+
+   memset(info, 0, sizeof(*info));
+
+   /* Keep some of the frame for the final pass and
+    * whatever else the frame has to draw. */
+   info->dynamic_scale_min     = settings->uints.video_shader_dynamic_scale_min;
+   if (settings->floats.video_refresh_rate > 0.0f)
+      info->frame_time_target_us = (unsigned)
+         (750000.0f / settings->floats.video_refresh_rate);
+
+   info->device                = vk->context->device;
+   info->gpu                   = vk->context->gpu;
+   info->memory_properties     = &vk->context->memory_properties;
+   info->pipeline_cache        = vk->pipelines.cache;
+   info->queue                 = vk->context->queue;
+   info->command_pool          = vk->swapchain[vk->context->current_swapchain_index].cmd_pool;
+   info->queue_family_index    = vk->context->graphics_queue_index;
+   info->max_input_size.width  = vk->tex_w;
+   info->max_input_size.height = vk->tex_h;
+   info->swapchain.viewport    = vk->vk_vp;
+   info->swapchain.format      = vk->context->swapchain_format;
+   info->swapchain.render_pass = vk->render_pass;
+   info->swapchain.num_indices = vk->context->num_swapchain_images;
+   info->original_format       = vk->tex_fmt;
+   info->record_threads        = vulkan_filter_chain_record_threads();
+#ifdef HAVE_THREADS
+   info->queue_lock            = vk->context->queue_lock;
+#endif
+}
+
 static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
 {
    struct vulkan_filter_chain_create_info info;
 
-   memset(&info, 0, sizeof(info));
-
-   info.device                = vk->context->device;
-   info.gpu                   = vk->context->gpu;
-   info.memory_properties     = &vk->context->memory_properties;
-   info.pipeline_cache        = vk->pipelines.cache;
-   info.queue                 = vk->context->queue;
-   info.command_pool          = vk->swapchain[vk->context->current_swapchain_index].cmd_pool;
-   info.max_input_size.width  = vk->tex_w;
-   info.max_input_size.height = vk->tex_h;
-   info.swapchain.viewport    = vk->vk_vp;
-   info.swapchain.format      = vk->context->swapchain_format;
-   info.swapchain.render_pass = vk->render_pass;
-   info.swapchain.num_indices = vk->context->num_swapchain_images;
-   info.original_format       = vk->tex_fmt;
+   vulkan_filter_chain_preset_info(vk, &info);
 
    vk->filter_chain           = vulkan_filter_chain_create_from_preset(
          &info, shader_path,
@@ -861,6 +915,89 @@ static void vulkan_init_resources(vk_t *vk)
    vulkan_init_command_buffers(vk);
 }
 
+/* The pipeline cache is kept next to the compiled slang shaders,
+ * one file per GPU. The driver puts its own UUID in the cache
+ * header, check it before handing the data back. */
+static bool vulkan_pipeline_cache_path(vk_t *vk, char *s, size_t len)
+{
+   char dir[PATH_MAX_LENGTH];
+   char name[64];
+   const VkPhysicalDeviceProperties *props = &vk->context->gpu_properties;
+
+   dir[0] = name[0] = '\0';
+
+   if (!video_shader_get_cache_dir(dir, sizeof(dir)))
+      return false;
+
+   snprintf(name, sizeof(name), "vulkan_pipeline_%04x_%04x.bin",
+         (unsigned)props->vendorID, (unsigned)props->deviceID);
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+static void *vulkan_pipeline_cache_read(vk_t *vk, size_t *size)
+{
+   char path[PATH_MAX_LENGTH];
+   uint32_t header[4];
+   void *buf                               = NULL;
+   int64_t len                             = 0;
+   const VkPhysicalDeviceProperties *props = &vk->context->gpu_properties;
+
+   *size = 0;
+
+   if (!vulkan_pipeline_cache_path(vk, path, sizeof(path)))
+      return NULL;
+   if (!path_is_valid(path) || !filestream_read_file(path, &buf, &len))
+      return NULL;
+
+   /* VkPipelineCacheHeaderVersionOne. */
+   if ((size_t)len < sizeof(header) + VK_UUID_SIZE)
+      goto error;
+
+   memcpy(header, buf, sizeof(header));
+
+   if (     header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+         || header[2] != props->vendorID
+         || header[3] != props->deviceID
+         || memcmp((const uint8_t*)buf + sizeof(header),
+            props->pipelineCacheUUID, VK_UUID_SIZE))
+      goto error;
+
+   *size = (size_t)len;
+   return buf;
+
+error:
+   RARCH_LOG("[Vulkan]: Ignoring stale pipeline cache \"%s\".\n", path);
+   free(buf);
+   return NULL;
+}
+
+static void vulkan_pipeline_cache_write(vk_t *vk)
+{
+   char path[PATH_MAX_LENGTH];
+   size_t size = 0;
+   void *data  = NULL;
+
+   if (vk->pipelines.cache == VK_NULL_HANDLE)
+      return;
+   if (!vulkan_pipeline_cache_path(vk, path, sizeof(path)))
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, NULL) != VK_SUCCESS || !size)
+      return;
+
+   data = malloc(size);
+   if (!data)
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, data) == VK_SUCCESS)
+      filestream_write_file(path, data, size);
+
+   free(data);
+}
+
 static void vulkan_init_static_resources(vk_t *vk)
 {
    unsigned i;
@@ -872,12 +1009,17 @@ static void vulkan_init_static_resources(vk_t *vk)
    /* Create the pipeline cache. */
    VkPipelineCacheCreateInfo cache   = {
       VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+   void *cache_data                  = NULL;
 
    if (!vk->context)
       return;
 
+   cache_data = vulkan_pipeline_cache_read(vk, &cache.initialDataSize);
+   cache.pInitialData = cache_data;
+
    vkCreatePipelineCache(vk->context->device,
          &cache, NULL, &vk->pipelines.cache);
+   free(cache_data);
 
    pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
 
@@ -895,6 +1037,7 @@ static void vulkan_init_static_resources(vk_t *vk)
 static void vulkan_deinit_static_resources(vk_t *vk)
 {
    unsigned i;
+   vulkan_pipeline_cache_write(vk);
    vkDestroyPipelineCache(vk->context->device,
          vk->pipelines.cache, NULL);
    vulkan_destroy_texture(
@@ -907,10 +1050,13 @@ static void vulkan_deinit_static_resources(vk_t *vk)
    free(vk->hw.wait_dst_stages);
 
    for (i = 0; i < VULKAN_MAX_SWAPCHAIN_IMAGES; i++)
+   {
       if (vk->readback.staging[i].memory != VK_NULL_HANDLE)
          vulkan_destroy_texture(
                vk->context->device,
                &vk->readback.staging[i]);
+      vk->readback.valid[i] = false;
+   }
 }
 
 static void vulkan_deinit_resources(vk_t *vk)
@@ -937,6 +1083,129 @@ static void vulkan_deinit_menu(vk_t *vk)
    }
 }
 
+#ifdef HAVE_THREADS
+/* Presets are built into a new filter chain on a task queue worker.
+ * The current chain keeps rendering until vulkan_frame() swaps the
+ * new one in; all fields but 'done' belong to the video thread
+ * until the handler is done. */
+struct vk_shader_compile
+{
+   slock_t *lock;
+   scond_t *cond;
+   bool done;
+
+   void *filter_chain;
+   VkCommandPool cmd_pool;
+   struct vulkan_filter_chain_create_info info;
+   enum vulkan_filter_chain_filter filter;
+   char path[PATH_MAX_LENGTH];
+};
+
+static void vulkan_shader_compile_handler(retro_task_t *task)
+{
+   struct vk_shader_compile *compile = (struct vk_shader_compile*)task->state;
+
+   compile->filter_chain = vulkan_filter_chain_create_from_preset(
+         &compile->info, compile->path, compile->filter);
+
+   slock_lock(compile->lock);
+   compile->done = true;
+   scond_signal(compile->cond);
+   slock_unlock(compile->lock);
+
+   task_set_finished(task, true);
+}
+
+static bool vulkan_shader_compile_is_done(struct vk_shader_compile *compile)
+{
+   bool done;
+
+   slock_lock(compile->lock);
+   done = compile->done;
+   slock_unlock(compile->lock);
+
+   return done;
+}
+
+static void vulkan_shader_compile_free(vk_t *vk,
+      struct vk_shader_compile *compile)
+{
+   slock_lock(compile->lock);
+   while (!compile->done)
+      scond_wait(compile->cond, compile->lock);
+   slock_unlock(compile->lock);
+
+   if (compile->filter_chain)
+      vulkan_filter_chain_free(
+            (vulkan_filter_chain_t*)compile->filter_chain);
+   if (compile->cmd_pool != VK_NULL_HANDLE)
+      vkDestroyCommandPool(vk->context->device, compile->cmd_pool, NULL);
+
+   scond_free(compile->cond);
+   slock_free(compile->lock);
+   free(compile);
+}
+
+static bool vulkan_shader_compile_start(vk_t *vk, const char *path)
+{
+   retro_task_t *task                = NULL;
+   struct vk_shader_compile *compile = NULL;
+   VkCommandPoolCreateInfo pool_info = {
+      VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+
+   if (!task_queue_is_threaded())
+      return false;
+
+   compile = (struct vk_shader_compile*)calloc(1, sizeof(*compile));
+   task    = (retro_task_t*)calloc(1, sizeof(*task));
+
+   if (!compile || !task)
+      goto error;
+
+   compile->lock = slock_new();
+   compile->cond = scond_new();
+
+   if (!compile->lock || !compile->cond)
+      goto error;
+
+   /* LUTs are uploaded from the worker, which
+    * can't share the swapchain's command pools. */
+   pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
+
+   if (vkCreateCommandPool(vk->context->device,
+            &pool_info, NULL, &compile->cmd_pool) != VK_SUCCESS)
+      goto error;
+
+   vulkan_filter_chain_preset_info(vk, &compile->info);
+   compile->info.command_pool = compile->cmd_pool;
+   compile->filter            = vk->video.smooth ?
+      VULKAN_FILTER_CHAIN_LINEAR : VULKAN_FILTER_CHAIN_NEAREST;
+   strlcpy(compile->path, path, sizeof(compile->path));
+
+   task->handler = vulkan_shader_compile_handler;
+   task->state   = compile;
+   task->mute    = true;
+
+   vk->shader_compile = compile;
+   task_queue_push(task);
+   return true;
+
+error:
+   if (compile)
+   {
+      if (compile->cmd_pool != VK_NULL_HANDLE)
+         vkDestroyCommandPool(vk->context->device, compile->cmd_pool, NULL);
+      if (compile->cond)
+         scond_free(compile->cond);
+      if (compile->lock)
+         slock_free(compile->lock);
+      free(compile);
+   }
+   free(task);
+   return false;
+}
+#endif
+
 static void vulkan_free(void *data)
 {
    vk_t *vk = (vk_t*)data;
@@ -945,6 +1214,11 @@ static void vulkan_free(void *data)
 
    if (vk->context && vk->context->device)
    {
+#ifdef HAVE_THREADS
+      if (vk->shader_compile)
+         vulkan_shader_compile_free(vk, vk->shader_compile);
+      vk->shader_compile = NULL;
+#endif
 #ifdef HAVE_THREADS
       slock_lock(vk->context->queue_lock);
 #endif
@@ -1204,7 +1478,19 @@ static void *vulkan_init(const video_info_t *video,
    vk->tex_fmt           = video->rgb32
       ? VK_FORMAT_B8G8R8A8_UNORM : VK_FORMAT_R5G6B5_UNORM_PACK16;
    vk->keep_aspect       = video->force_aspect;
-   RARCH_LOG("[Vulkan]: Using %s format.\n", video->rgb32 ? "BGRA8888" : "RGB565");
+
+   if (video->rgb1555)
+   {
+      VkFormatProperties props;
+      vkGetPhysicalDeviceFormatProperties(vk->context->gpu,
+            VK_FORMAT_A1R5G5B5_UNORM_PACK16, &props);
+
+      if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
+         vk->tex_fmt     = VK_FORMAT_A1R5G5B5_UNORM_PACK16;
+   }
+
+   RARCH_LOG("[Vulkan]: Using %s format.\n", video->rgb32 ? "BGRA8888"
+         : vk->tex_fmt == VK_FORMAT_A1R5G5B5_UNORM_PACK16 ? "0RGB1555" : "RGB565");
 
    /* Set the viewport to fix recording, since it needs to know
     * the viewport sizes before we start running. */
@@ -1250,6 +1536,46 @@ static void vulkan_update_filter_chain(vk_t *vk)
       RARCH_ERR("Failed to update filter chain info. This will probably lead to a crash ...\n");
 }
 
+#ifdef HAVE_THREADS
+/* Called at the start of a frame, before anything is recorded. */
+static void vulkan_shader_compile_poll(vk_t *vk)
+{
+   struct vk_shader_compile *compile = vk->shader_compile;
+   const struct vulkan_filter_chain_swapchain_info *swapchain =
+      &compile->info.swapchain;
+
+   if (!vulkan_shader_compile_is_done(compile))
+      return;
+
+   vk->shader_compile = NULL;
+
+   if (compile->filter_chain)
+   {
+      /* Freeing waits for the device to go idle, keep other
+       * users of the queue out meanwhile. */
+      slock_lock(vk->context->queue_lock);
+      if (vk->filter_chain)
+         vulkan_filter_chain_free((vulkan_filter_chain_t*)vk->filter_chain);
+      slock_unlock(vk->context->queue_lock);
+
+      vk->filter_chain      = compile->filter_chain;
+      compile->filter_chain = NULL;
+
+      /* The swapchain may have changed while compiling. */
+      if (     memcmp(&swapchain->viewport, &vk->vk_vp, sizeof(vk->vk_vp))
+            || swapchain->format      != vk->context->swapchain_format
+            || swapchain->render_pass != vk->render_pass
+            || swapchain->num_indices != vk->context->num_swapchain_images)
+         vulkan_update_filter_chain(vk);
+   }
+   else
+      RARCH_ERR("[Vulkan]: Failed to create filter chain: \"%s\". Keeping the current one.\n",
+            compile->path);
+
+   vulkan_shader_compile_free(vk, compile);
+}
+#endif
+
 static void vulkan_check_swapchain(vk_t *vk)
 {
    if (vk->context->invalid_swapchain)
@@ -1340,6 +1666,18 @@ static bool vulkan_set_shader(void *data,
       path = NULL;
    }
 
+#ifdef HAVE_THREADS
+   /* A newer preset replaces whatever is still compiling. */
+   if (vk->shader_compile)
+      vulkan_shader_compile_free(vk, vk->shader_compile);
+   vk->shader_compile = NULL;
+
+   /* Keep rendering with the current chain while the new one
+    * builds. Errors are reported when it is swapped in. */
+   if (path && vk->filter_chain && vulkan_shader_compile_start(vk, path))
+      return true;
+#endif
+
    if (vk->filter_chain)
       vulkan_filter_chain_free((vulkan_filter_chain_t*)vk->filter_chain);
    vk->filter_chain = NULL;
@@ -1525,6 +1863,7 @@ static void vulkan_readback(vk_t *vk)
    struct vk_texture *staging;
    struct video_viewport vp;
    VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+   unsigned index          = vk->context->current_swapchain_index;
 
    vulkan_viewport_info(vk, &vp);
    memset(&region, 0, sizeof(region));
@@ -1541,12 +1880,21 @@ static void vulkan_readback(vk_t *vk)
    if (vk->context->swapchain_format != VK_FORMAT_B8G8R8A8_UNORM)
       RARCH_WARN("[Vulkan]: Backbuffer is not BGRA8888, readbacks might not work properly.\n");
 
-   staging  = &vk->readback.staging[vk->context->current_swapchain_index];
-   *staging = vulkan_create_texture(vk,
-         staging->memory != VK_NULL_HANDLE ? staging : NULL,
-         vk->vp.width, vk->vp.height,
-         VK_FORMAT_B8G8R8A8_UNORM,
-         NULL, NULL, VULKAN_TEXTURE_READBACK);
+   staging  = &vk->readback.staging[index];
+
+   /* Keep the buffer mapped across frames, only
+    * reallocate it when the viewport changes size. */
+   if (     staging->memory == VK_NULL_HANDLE
+         || staging->width  != vk->vp.width
+         || staging->height != vk->vp.height)
+   {
+      *staging = vulkan_create_texture(vk,
+            staging->memory != VK_NULL_HANDLE ? staging : NULL,
+            vk->vp.width, vk->vp.height,
+            VK_FORMAT_B8G8R8A8_UNORM,
+            NULL, NULL, VULKAN_TEXTURE_READBACK);
+      vulkan_map_persistent_texture(vk->context->device, staging);
+   }
 
    vkCmdCopyImageToBuffer(vk->cmd, vk->chain->backbuffer.image,
          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
@@ -1560,6 +1908,9 @@ static void vulkan_readback(vk_t *vk)
          VK_PIPELINE_STAGE_TRANSFER_BIT,
          VK_PIPELINE_STAGE_HOST_BIT, 0,
          1, &barrier, 0, NULL, 0, NULL);
+
+   vk->readback.valid[index] = true;
+   vk->readback.last_index   = index;
 }
 
 static void vulkan_inject_black_frame(vk_t *vk, video_frame_info_t *video_info)
@@ -1639,11 +1990,17 @@ static bool vulkan_frame(void *data, const void *frame,
    unsigned frame_index                          =
       vk->context->current_swapchain_index;
 
+#ifdef HAVE_THREADS
+   if (vk->shader_compile)
+      vulkan_shader_compile_poll(vk);
+#endif
+
    /* Bookkeeping on start of frame. */
    chain     = &vk->swapchain[frame_index];
    vk->chain = chain;
 
    vulkan_descriptor_manager_restart(&chain->descriptor_manager);
+   vulkan_descriptor_cache_reset(&chain->descriptor_cache);
    vulkan_buffer_chain_discard(&chain->vbo);
    vulkan_buffer_chain_discard(&chain->ubo);
 
@@ -1688,7 +2045,8 @@ static bool vulkan_frame(void *data, const void *frame,
             || chain->texture.height != frame_height)
       {
          chain->texture = vulkan_create_texture(vk, &chain->texture,
-               frame_width, frame_height, chain->texture.format, NULL, NULL,
+               frame_width, frame_height, chain->texture.format, NULL,
+               vulkan_get_tex_swizzle(vk),
                chain->texture_optimal.memory
                ? VULKAN_TEXTURE_STAGING : VULKAN_TEXTURE_STREAMED);
 
@@ -1701,7 +2059,7 @@ static bool vulkan_frame(void *data, const void *frame,
                   vk,
                   &chain->texture_optimal,
                   frame_width, frame_height, chain->texture_optimal.format,
-                  NULL, NULL, VULKAN_TEXTURE_DYNAMIC);
+                  NULL, vulkan_get_tex_swizzle(vk), VULKAN_TEXTURE_DYNAMIC);
          }
       }
 
@@ -1731,6 +2089,7 @@ static bool vulkan_frame(void *data, const void *frame,
    /* Notify filter chain about the new sync index. */
    vulkan_filter_chain_notify_sync_index((vulkan_filter_chain_t*)vk->filter_chain, frame_index);
    vulkan_filter_chain_set_frame_count((vulkan_filter_chain_t*)vk->filter_chain, frame_count);
+   vulkan_filter_chain_set_frame_dupe((vulkan_filter_chain_t*)vk->filter_chain, !frame);
 
    /* Render offscreen filter chain passes. */
    {
@@ -1859,6 +2218,10 @@ static bool vulkan_frame(void *data, const void *frame,
             (vulkan_filter_chain_t*)vk->filter_chain, vk->cmd,
             &vk->vk_vp, vk->mvp.data);
 
+      /* The chain binds its own pipelines and sets */
+      vk->tracker.pipeline = VK_NULL_HANDLE;
+      vk->tracker.set      = VK_NULL_HANDLE;
+
 #if defined(HAVE_MENU)
       if (vk->menu.enable)
       {
@@ -1901,6 +2264,10 @@ static bool vulkan_frame(void *data, const void *frame,
       }
 #endif
 
+      /* Also over the menu, so its draw calls can be counted */
+      if (video_info->perf_overlay_show)
+         video_perf_overlay_render(video_info);
+
       if (msg)
          font_driver_render_msg(video_info, NULL, msg, NULL);
 
@@ -2037,6 +2404,13 @@ static bool vulkan_frame(void *data, const void *frame,
 
    video_info->cb_swap_buffers(video_info->context_data, video_info);
 
+   /* Ignore hard sync while fast forwarding or in the menu. */
+   if (     video_info->hard_sync
+         && !video_info->input_driver_nonblock_state
+         && !vk->menu.enable)
+      vulkan_hard_sync(vk->context, frame_index,
+            video_info->hard_sync_frames);
+
    if (!vk->context->swap_interval_emulation_lock)
       video_info->cb_update_window_title(
             video_info->context_data, video_info);
@@ -2055,17 +2429,12 @@ static bool vulkan_frame(void *data, const void *frame,
    }
    vulkan_check_swapchain(vk);
 
-   /* Disable BFI during fast forward, slow-motion,
-    * and pause to prevent flicker. */
-   if (
-         chain->backbuffer.image != VK_NULL_HANDLE
-         && vk->context->has_acquired_swapchain
-         && video_info->black_frame_insertion
-         && !video_info->input_driver_nonblock_state
-         && !video_info->runloop_is_slowmotion
-         && !video_info->runloop_is_paused)
+   if (     chain->backbuffer.image != VK_NULL_HANDLE
+         && vk->context->has_acquired_swapchain)
    {
-      vulkan_inject_black_frame(vk, video_info);
+      unsigned i;
+      for (i = 0; i < video_info->black_frames; i++)
+         vulkan_inject_black_frame(vk, video_info);
    }
 
    /* Vulkan doesn't directly support swap_interval > 1, so we fake it by duping out more frames. */
@@ -2362,10 +2731,13 @@ static float vulkan_get_refresh_rate(void *data)
 
 static uint32_t vulkan_get_flags(void *data)
 {
+   vk_t                   *vk = (vk_t*)data;
    uint32_t             flags = 0;
 
    BIT32_SET(flags, GFX_CTX_FLAGS_CUSTOMIZABLE_SWAPCHAIN_IMAGES);
    BIT32_SET(flags, GFX_CTX_FLAGS_BLACK_FRAME_INSERTION);
+   if (vk && vk->tex_fmt == VK_FORMAT_A1R5G5B5_UNORM_PACK16)
+      BIT32_SET(flags, GFX_CTX_FLAGS_RGB1555);
 
    return flags;
 }
@@ -2423,25 +2795,31 @@ static void vulkan_viewport_info(void *data, struct video_viewport *vp)
 
 static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
 {
+   unsigned index;
    struct vk_texture *staging       = NULL;
    vk_t *vk                         = (vk_t*)data;
 
    if (!vk)
       return false;
 
-   staging = &vk->readback.staging[vk->context->current_swapchain_index];
-
    if (vk->readback.streamed)
    {
-      const uint8_t *src     = NULL;
       struct scaler_ctx *ctx = NULL;
 
-      if (staging->memory == VK_NULL_HANDLE)
+      /* The image we're about to render to was acquired after
+       * waiting on its fence, so the copy made the last time it
+       * was used is complete. Recording runs num_swapchain_images
+       * frames behind, but never stalls the GPU. */
+      index   = vk->context->current_swapchain_index;
+      staging = &vk->readback.staging[index];
+
+      if (     !vk->readback.valid[index]
+            || !staging->mapped
+            || staging->width  != vk->vp.width
+            || staging->height != vk->vp.height)
          return false;
 
       buffer += 3 * (vk->vp.height - 1) * vk->vp.width;
-      vkMapMemory(vk->context->device, staging->memory,
-            staging->offset, staging->size, 0, (void**)&src);
 
       vulkan_sync_texture_to_cpu(vk, staging);
 
@@ -2450,13 +2828,12 @@ static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
 
       ctx                            = &vk->readback.scaler;
 
-      scaler_ctx_scale_direct(ctx, buffer, src);
-
-      vkUnmapMemory(vk->context->device, staging->memory);
+      scaler_ctx_scale_direct(ctx, buffer, staging->mapped);
    }
    else
    {
-      /* Synchronous path only for now. */
+      VkFence fence;
+
       /* TODO: How will we deal with format conversion?
        * For now, take the simplest route and use image blitting
        * with conversion. */
@@ -2466,17 +2843,21 @@ static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
       if (!is_idle)
          video_driver_cached_frame();
 
-#ifdef HAVE_THREADS
-      slock_lock(vk->context->queue_lock);
-#endif
-      vkQueueWaitIdle(vk->context->queue);
-#ifdef HAVE_THREADS
-      slock_unlock(vk->context->queue_lock);
-#endif
+      index   = vk->readback.last_index;
+      staging = &vk->readback.staging[index];
 
-      if (!staging->mapped)
-         vulkan_map_persistent_texture(
-               vk->context->device, staging);
+      if (!vk->readback.valid[index] || !staging->mapped)
+         return false;
+
+      /* Only wait for the frame which did the copy, not
+       * for everything else in flight on the queue. If the
+       * fence has been reset it was already waited on when its
+       * image was acquired again. */
+      fence = vk->context->swapchain_fences[index];
+      if (fence != VK_NULL_HANDLE &&
+            vk->context->swapchain_fences_signalled[index])
+         vkWaitForFences(vk->context->device, 1, &fence,
+               VK_TRUE, UINT64_MAX);
 
       vulkan_sync_texture_to_cpu(vk, staging);
 
@@ -2499,6 +2880,7 @@ static bool vulkan_read_viewport(void *data, uint8_t *buffer, bool is_idle)
       }
       vulkan_destroy_texture(
             vk->context->device, staging);
+      vk->readback.valid[index] = false;
    }
    return true;
 }
@@ -32,6 +32,8 @@
 #include <sys/poll.h>
 
 #include <libdrm/drm.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
 #include <gbm.h>
 
 #include <lists/dir_list.h>
@@ -75,6 +77,28 @@ static struct gbm_device *g_gbm_dev       = NULL;
 
 static bool waiting_for_flip              = false;
 
+#if defined(HAVE_EGL) && defined(EGL_ANDROID_native_fence_sync)
+#define HAVE_DRM_FENCE
+#endif
+
+#ifdef HAVE_DRM_FENCE
+/* Explicit fencing. Flips are atomic commits on the primary
+ * plane that hand the kernel a native fence of the frame's GPU
+ * work, so scanout waits on the GPU rather than the CPU or
+ * the driver's implicit sync. Used when the kernel has atomic
+ * modesetting with IN_FENCE_FD and EGL exports fences. */
+static struct
+{
+   bool enable;
+   uint32_t plane_id;
+   uint32_t fb_prop;
+   uint32_t in_fence_prop;
+   PFNEGLCREATESYNCKHRPROC create_sync;
+   PFNEGLDESTROYSYNCKHRPROC destroy_sync;
+   PFNEGLDUPNATIVEFENCEFDANDROIDPROC dup_fence_fd;
+} g_drm_fence;
+#endif
+
 typedef struct gfx_ctx_drm_data
 {
 #ifdef HAVE_EGL
@@ -212,21 +236,199 @@ static bool gfx_ctx_drm_wait_flip(bool block)
    return false;
 }
 
-static bool gfx_ctx_drm_queue_flip(void)
+#ifdef HAVE_DRM_FENCE
+static uint32_t drm_fence_get_prop(int fd, uint32_t plane_id,
+      const char *name, uint64_t *value)
+{
+   unsigned i;
+   uint32_t prop_id                   = 0;
+   drmModeObjectPropertiesPtr props   = drmModeObjectGetProperties(fd,
+         plane_id, DRM_MODE_OBJECT_PLANE);
+
+   if (!props)
+      return 0;
+
+   for (i = 0; i < props->count_props && !prop_id; i++)
+   {
+      drmModePropertyPtr prop = drmModeGetProperty(fd, props->props[i]);
+
+      if (!prop)
+         continue;
+
+      if (string_is_equal(prop->name, name))
+      {
+         prop_id = prop->prop_id;
+         if (value)
+            *value = props->prop_values[i];
+      }
+
+      drmModeFreeProperty(prop);
+   }
+
+   drmModeFreeObjectProperties(props);
+   return prop_id;
+}
+
+/* Looks for the primary plane scanning out our CRTC, must be
+ * called after the mode is set. */
+static void drm_fence_init(gfx_ctx_drm_data_t *drm)
+{
+   unsigned i;
+   const char *exts           = NULL;
+   drmModePlaneResPtr planes  = NULL;
+
+   memset(&g_drm_fence, 0, sizeof(g_drm_fence));
+
+   if (drm_api != GFX_CTX_OPENGL_API && drm_api != GFX_CTX_OPENGL_ES_API)
+      return;
+
+   exts = eglQueryString(drm->egl.dpy, EGL_EXTENSIONS);
+   if (!exts || !strstr(exts, "EGL_ANDROID_native_fence_sync"))
+      return;
+
+   g_drm_fence.create_sync  = (PFNEGLCREATESYNCKHRPROC)
+      egl_get_proc_address("eglCreateSyncKHR");
+   g_drm_fence.destroy_sync = (PFNEGLDESTROYSYNCKHRPROC)
+      egl_get_proc_address("eglDestroySyncKHR");
+   g_drm_fence.dup_fence_fd = (PFNEGLDUPNATIVEFENCEFDANDROIDPROC)
+      egl_get_proc_address("eglDupNativeFenceFDANDROID");
+
+   if (     !g_drm_fence.create_sync
+         || !g_drm_fence.destroy_sync
+         || !g_drm_fence.dup_fence_fd)
+      return;
+
+   if (drmSetClientCap(g_drm_fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0)
+      return;
+
+   planes = drmModeGetPlaneResources(g_drm_fd);
+   if (!planes)
+      return;
+
+   for (i = 0; i < planes->count_planes && !g_drm_fence.plane_id; i++)
+   {
+      uint64_t type         = 0;
+      drmModePlanePtr plane = drmModeGetPlane(g_drm_fd, planes->planes[i]);
+
+      if (!plane)
+         continue;
+
+      if (     plane->crtc_id == g_crtc_id
+            && drm_fence_get_prop(g_drm_fd, plane->plane_id, "type", &type)
+            && type == DRM_PLANE_TYPE_PRIMARY)
+         g_drm_fence.plane_id = plane->plane_id;
+
+      drmModeFreePlane(plane);
+   }
+
+   drmModeFreePlaneResources(planes);
+
+   if (!g_drm_fence.plane_id)
+      return;
+
+   g_drm_fence.fb_prop       = drm_fence_get_prop(g_drm_fd,
+         g_drm_fence.plane_id, "FB_ID", NULL);
+   g_drm_fence.in_fence_prop = drm_fence_get_prop(g_drm_fd,
+         g_drm_fence.plane_id, "IN_FENCE_FD", NULL);
+
+   g_drm_fence.enable = g_drm_fence.fb_prop && g_drm_fence.in_fence_prop;
+
+   if (g_drm_fence.enable)
+      RARCH_LOG("[KMS]: Using atomic page flips with explicit fences on plane %u.\n",
+            g_drm_fence.plane_id);
+}
+
+/* Fence of the GPU work queued so far. To be called before
+ * eglSwapBuffers(), which flushes it along with the frame. */
+static EGLSyncKHR drm_fence_create(gfx_ctx_drm_data_t *drm)
+{
+   static const EGLint attribs[] = {
+      EGL_SYNC_NATIVE_FENCE_FD_ANDROID, EGL_NO_NATIVE_FENCE_FD_ANDROID,
+      EGL_NONE
+   };
+
+   if (!g_drm_fence.enable)
+      return EGL_NO_SYNC_KHR;
+
+   return g_drm_fence.create_sync(drm->egl.dpy,
+         EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+}
+
+static int drm_fence_export(gfx_ctx_drm_data_t *drm, EGLSyncKHR sync)
+{
+   int fd;
+
+   if (sync == EGL_NO_SYNC_KHR)
+      return -1;
+
+   fd = g_drm_fence.dup_fence_fd(drm->egl.dpy, sync);
+   g_drm_fence.destroy_sync(drm->egl.dpy, sync);
+
+   return fd == EGL_NO_NATIVE_FENCE_FD_ANDROID ? -1 : fd;
+}
+
+static bool drm_fence_commit(struct drm_fb *fb, int fence_fd)
+{
+   int ret;
+   drmModeAtomicReqPtr req = drmModeAtomicAlloc();
+
+   if (!req)
+      return false;
+
+   drmModeAtomicAddProperty(req, g_drm_fence.plane_id,
+         g_drm_fence.fb_prop, fb->fb_id);
+   drmModeAtomicAddProperty(req, g_drm_fence.plane_id,
+         g_drm_fence.in_fence_prop, (uint64_t)fence_fd);
+
+   /* Returns right away, the flip event arrives like
+    * the one of drmModePageFlip(). */
+   ret = drmModeAtomicCommit(g_drm_fd, req,
+         DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT,
+         &waiting_for_flip);
+
+   drmModeAtomicFree(req);
+
+   return ret == 0;
+}
+#endif
+
+static bool gfx_ctx_drm_queue_flip(int fence_fd)
 {
    struct drm_fb *fb = NULL;
 
    g_next_bo         = gbm_surface_lock_front_buffer(g_gbm_surface);
+   if (!g_next_bo)
+      return false;
+
    fb                = (struct drm_fb*)gbm_bo_get_user_data(g_next_bo);
 
    if (!fb)
       fb             = (struct drm_fb*)drm_fb_get_from_bo(g_next_bo);
 
+   if (!fb)
+      goto error;
+
+#ifdef HAVE_DRM_FENCE
+   if (fence_fd >= 0)
+   {
+      if (drm_fence_commit(fb, fence_fd))
+         return true;
+
+      RARCH_WARN("[KMS]: Atomic page flip failed (%s), using legacy page flips.\n",
+            strerror(errno));
+      g_drm_fence.enable = false;
+   }
+#endif
+
    if (drmModePageFlip(g_drm_fd, g_crtc_id, fb->fb_id,
          DRM_MODE_PAGE_FLIP_EVENT, &waiting_for_flip) == 0)
       return true;
 
-   /* Failed to queue page flip. */
+error:
+   /* Failed to queue page flip, the buffer
+    * has to go back to GBM. */
+   gbm_surface_release_buffer(g_gbm_surface, g_next_bo);
+   g_next_bo = g_bo;
    return false;
 }
 
@@ -234,6 +436,10 @@ static void gfx_ctx_drm_swap_buffers(void *data, void *data2)
 {
    gfx_ctx_drm_data_t        *drm = (gfx_ctx_drm_data_t*)data;
    video_frame_info_t *video_info = (video_frame_info_t*)data2;
+   int fence_fd                   = -1;
+#ifdef HAVE_DRM_FENCE
+   EGLSyncKHR sync                = drm_fence_create(drm);
+#endif
 
    switch (drm_api)
    {
@@ -248,15 +454,27 @@ static void gfx_ctx_drm_swap_buffers(void *data, void *data2)
          break;
    }
 
+#ifdef HAVE_DRM_FENCE
+   fence_fd = drm_fence_export(drm, sync);
+#endif
+
    /* I guess we have to wait for flip to have taken
     * place before another flip can be queued up.
     *
     * If true, we are still waiting for a flip
     * (nonblocking mode, so just drop the frame). */
    if (gfx_ctx_drm_wait_flip(drm->interval))
+   {
+      if (fence_fd >= 0)
+         close(fence_fd);
       return;
+   }
 
-   waiting_for_flip = gfx_ctx_drm_queue_flip();
+   waiting_for_flip = gfx_ctx_drm_queue_flip(fence_fd);
+
+   /* The commit holds its own reference to the fence. */
+   if (fence_fd >= 0)
+      close(fence_fd);
 
    /* Triple-buffered page flips */
    if (video_info->max_swapchain_images >= 3 &&
@@ -341,6 +559,10 @@ static void gfx_ctx_drm_destroy_resources(gfx_ctx_drm_data_t *drm)
 
    g_bo                = NULL;
    g_next_bo           = NULL;
+
+#ifdef HAVE_DRM_FENCE
+   memset(&g_drm_fence, 0, sizeof(g_drm_fence));
+#endif
 }
 
 static void *gfx_ctx_drm_init(video_frame_info_t *video_info, void *video_driver)
@@ -735,6 +957,10 @@ static bool gfx_ctx_drm_set_video_mode(void *data,
    if (ret < 0)
       goto error;
 
+#ifdef HAVE_DRM_FENCE
+   drm_fence_init(drm);
+#endif
+
    return true;
 
 error:
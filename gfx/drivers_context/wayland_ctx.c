@@ -15,6 +15,7 @@
  */
 
 #include <sys/poll.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <wayland-client.h>
@@ -43,6 +44,7 @@
 #endif
 
 #include "../common/wayland_common.h"
+#include "../video_pacing.h"
 #include "../../frontend/frontend_driver.h"
 #include "../../input/input_driver.h"
 #include "../../input/input_keymaps.h"
@@ -59,6 +61,13 @@
 /* Generated from xdg-decoration-unstable-v1.h */
 #include "../common/wayland/xdg-decoration-unstable-v1.h"
 
+/* Generated from presentation-time.xml */
+#include "../common/wayland/presentation-time.h"
+
+/* Frames the compositor hasn't reported on yet. Anything
+ * beyond that is presented without feedback. */
+#define WL_PRESENTATION_FEEDBACKS 8
+
 
 typedef struct touch_pos
 {
@@ -110,6 +119,11 @@ typedef struct gfx_ctx_wayland_data
    struct zxdg_toplevel_decoration_v1 *deco;
    struct zwp_idle_inhibit_manager_v1 *idle_inhibit_manager;
    struct zwp_idle_inhibitor_v1 *idle_inhibitor;
+   struct wp_presentation *presentation;
+   struct wp_presentation_feedback *feedbacks[WL_PRESENTATION_FEEDBACKS];
+   clockid_t presentation_clock;
+   bool presentation_timing;
+   unsigned presentation_frames;
    int swap_interval;
    bool core_hw_context_enable;
 
@@ -809,6 +823,111 @@ static const struct wl_output_listener output_listener = {
    display_handle_scale,
 };
 
+/* Presentation time callbacks. */
+static void presentation_handle_clock_id(void *data,
+      struct wp_presentation *presentation, uint32_t clk_id)
+{
+   gfx_ctx_wayland_data_t *wl = (gfx_ctx_wayland_data_t*)data;
+   wl->presentation_clock     = (clockid_t)clk_id;
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+   presentation_handle_clock_id,
+};
+
+static void presentation_feedback_release(gfx_ctx_wayland_data_t *wl,
+      struct wp_presentation_feedback *feedback)
+{
+   unsigned i;
+
+   for (i = 0; i < WL_PRESENTATION_FEEDBACKS; i++)
+   {
+      if (wl->feedbacks[i] == feedback)
+      {
+         wl->feedbacks[i] = NULL;
+         break;
+      }
+   }
+
+   wp_presentation_feedback_destroy(feedback);
+}
+
+static void presentation_feedback_sync_output(void *data,
+      struct wp_presentation_feedback *feedback, struct wl_output *output)
+{
+}
+
+static void presentation_feedback_presented(void *data,
+      struct wp_presentation_feedback *feedback,
+      uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+      uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags)
+{
+   gfx_ctx_wayland_data_t *wl = (gfx_ctx_wayland_data_t*)data;
+   uint64_t sec               = ((uint64_t)tv_sec_hi << 32) | tv_sec_lo;
+
+   /* Frames the compositor dropped count towards this one,
+    * like skipped present IDs do with VK_GOOGLE_display_timing. */
+   video_pacing_present((retro_time_t)(sec * 1000000 + tv_nsec / 1000),
+         wl->presentation_frames + 1);
+   wl->presentation_frames = 0;
+
+   presentation_feedback_release(wl, feedback);
+}
+
+static void presentation_feedback_discarded(void *data,
+      struct wp_presentation_feedback *feedback)
+{
+   gfx_ctx_wayland_data_t *wl = (gfx_ctx_wayland_data_t*)data;
+
+   wl->presentation_frames++;
+   presentation_feedback_release(wl, feedback);
+}
+
+static const struct wp_presentation_feedback_listener
+presentation_feedback_listener = {
+   presentation_feedback_sync_output,
+   presentation_feedback_presented,
+   presentation_feedback_discarded,
+};
+
+/* Asks for the time the next commit of the surface reaches
+ * the screen. Must be called before swapping buffers. */
+static void gfx_ctx_wl_request_feedback(gfx_ctx_wayland_data_t *wl)
+{
+   unsigned i;
+
+   /* The timestamps are compared against cpu_features_get_time_usec(). */
+   if (!wl->presentation || wl->presentation_clock != CLOCK_MONOTONIC)
+      return;
+
+#ifdef HAVE_VULKAN
+   /* VK_GOOGLE_display_timing already reports these. */
+   if (wl_api == GFX_CTX_VULKAN_API && wl->vk.context.display_timing)
+      return;
+#endif
+
+   if (!wl->presentation_timing)
+   {
+      RARCH_LOG("[Wayland]: Using presentation timestamps for frame pacing.\n");
+      video_pacing_set_display_timing(true);
+      wl->presentation_timing = true;
+   }
+
+   for (i = 0; i < WL_PRESENTATION_FEEDBACKS; i++)
+   {
+      if (!wl->feedbacks[i])
+      {
+         wl->feedbacks[i] = wp_presentation_feedback(
+               wl->presentation, wl->surface);
+         wp_presentation_feedback_add_listener(wl->feedbacks[i],
+               &presentation_feedback_listener, wl);
+         return;
+      }
+   }
+
+   wl->presentation_frames++;
+}
+
 /* Registry callbacks. */
 static void registry_handle_global(void *data, struct wl_registry *reg,
       uint32_t id, const char *interface, uint32_t version)
@@ -850,6 +969,13 @@ static void registry_handle_global(void *data, struct wl_registry *reg,
    else if (string_is_equal(interface, "zxdg_decoration_manager_v1"))
       wl->deco_manager = (struct zxdg_decoration_manager_v1*)wl_registry_bind(
                                   reg, id, &zxdg_decoration_manager_v1_interface, 1);
+   else if (string_is_equal(interface, "wp_presentation"))
+   {
+      wl->presentation = (struct wp_presentation*)wl_registry_bind(
+                                  reg, id, &wp_presentation_interface, 1);
+      wp_presentation_add_listener(wl->presentation,
+            &presentation_listener, wl);
+   }
 }
 
 static void registry_handle_global_remove(void *data,
@@ -876,9 +1002,24 @@ static void gfx_ctx_wl_get_video_size(void *data,
 
 static void gfx_ctx_wl_destroy_resources(gfx_ctx_wayland_data_t *wl)
 {
+   unsigned i;
+
    if (!wl)
       return;
 
+   for (i = 0; i < WL_PRESENTATION_FEEDBACKS; i++)
+   {
+      if (wl->feedbacks[i])
+         wp_presentation_feedback_destroy(wl->feedbacks[i]);
+      wl->feedbacks[i] = NULL;
+   }
+   if (wl->presentation)
+      wp_presentation_destroy(wl->presentation);
+   if (wl->presentation_timing)
+      video_pacing_set_display_timing(false);
+   wl->presentation        = NULL;
+   wl->presentation_timing = false;
+
    switch (wl_api)
    {
       case GFX_CTX_OPENGL_API:
@@ -1294,6 +1435,11 @@ static void *gfx_ctx_wl_init(video_frame_info_t *video_info, void *video_driver)
 	   RARCH_WARN("[Wayland]: Compositor doesn't support zxdg_decoration_manager_v1 protocol!\n");
    }
 
+   if (!wl->presentation)
+   {
+	   RARCH_WARN("[Wayland]: Compositor doesn't support wp_presentation protocol!\n");
+   }
+
    wl->input.fd = wl_display_get_fd(wl->input.dpy);
 
    switch (wl_api)
@@ -1765,6 +1911,8 @@ static void gfx_ctx_wl_swap_buffers(void *data, void *data2)
 {
    gfx_ctx_wayland_data_t *wl = (gfx_ctx_wayland_data_t*)data;
 
+   gfx_ctx_wl_request_feedback(wl);
+
    switch (wl_api)
    {
       case GFX_CTX_OPENGL_API:
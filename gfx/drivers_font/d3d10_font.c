@@ -21,6 +21,7 @@
 #include <malloc.h>
 #include <math.h>
 #include <encodings/utf.h>
+#include <retro_miscellaneous.h>
 
 #include "../font_driver.h"
 #include "../video_driver.h"
@@ -34,6 +35,13 @@ typedef struct
    const font_renderer_driver_t* font_driver;
    void*                         font_data;
    struct font_atlas*            atlas;
+
+   /* While a block is bound, sprites are gathered here and only
+    * drawn by flush. */
+   video_font_raster_block_t*    block;
+   d3d10_sprite_t*               batch;
+   unsigned                      batch_count;
+   unsigned                      batch_capacity;
 } d3d10_font_t;
 
 static void*
@@ -81,9 +89,53 @@ static void d3d10_font_free_font(void* data, bool is_threaded)
    Release(font->texture.handle);
    Release(font->texture.staging);
    Release(font->texture.view);
+   free(font->batch);
    free(font);
 }
 
+static bool d3d10_font_reserve_batch(d3d10_font_t* font, unsigned count)
+{
+   d3d10_sprite_t* batch    = NULL;
+   unsigned        capacity = font->batch_capacity ? font->batch_capacity : 256;
+
+   if (count <= font->batch_capacity)
+      return true;
+
+   while (capacity < count)
+      capacity *= 2;
+
+   batch = (d3d10_sprite_t*)realloc(font->batch, capacity * sizeof(*batch));
+
+   if (!batch)
+      return false;
+
+   font->batch          = batch;
+   font->batch_capacity = capacity;
+   return true;
+}
+
+static void d3d10_font_draw_sprites(
+      d3d10_video_t* d3d10, d3d10_font_t* font, unsigned count)
+{
+   if (font->atlas->dirty)
+   {
+      d3d10_update_texture(
+            d3d10->device,
+            font->atlas->width, font->atlas->height, font->atlas->width,
+            DXGI_FORMAT_A8_UNORM, font->atlas->buffer, &font->texture);
+      font->atlas->dirty = false;
+   }
+
+   d3d10_set_texture_and_sampler(d3d10->device, 0, &font->texture);
+   D3D10SetBlendState(d3d10->device, d3d10->blend_enable, NULL, D3D10_DEFAULT_SAMPLE_MASK);
+
+   D3D10SetPShader(d3d10->device, d3d10->sprites.shader_font.ps);
+   D3D10Draw(d3d10->device, count, d3d10->sprites.offset);
+   D3D10SetPShader(d3d10->device, d3d10->sprites.shader.ps);
+
+   d3d10->sprites.offset += count;
+}
+
 static int d3d10_font_get_message_width(void* data, const char* msg, unsigned msg_len, float scale)
 {
    d3d10_font_t* font = (d3d10_font_t*)data;
@@ -132,6 +184,7 @@ static void d3d10_font_render_line(
    unsigned                 i, count;
    void*                    mapped_vbo;
    d3d10_sprite_t*          v;
+   d3d10_sprite_t*          v_start;
    d3d10_video_t*           d3d10  = (d3d10_video_t*)video_info->userdata;
    unsigned                 width  = video_info->width;
    unsigned                 height = video_info->height;
@@ -143,9 +196,6 @@ static void d3d10_font_render_line(
          msg_len > (unsigned)d3d10->sprites.capacity)
       return;
 
-   if (d3d10->sprites.offset + msg_len > (unsigned)d3d10->sprites.capacity)
-      d3d10->sprites.offset = 0;
-
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
@@ -157,8 +207,23 @@ static void d3d10_font_render_line(
          break;
    }
 
-   D3D10MapBuffer(d3d10->sprites.vbo, D3D10_MAP_WRITE_NO_OVERWRITE, 0, (void**)&mapped_vbo);
-   v = (d3d10_sprite_t*)mapped_vbo + d3d10->sprites.offset;
+   if (font->block)
+   {
+      if (!d3d10_font_reserve_batch(font, font->batch_count + msg_len))
+         return;
+
+      v = font->batch + font->batch_count;
+   }
+   else
+   {
+      if (d3d10->sprites.offset + msg_len > (unsigned)d3d10->sprites.capacity)
+         d3d10->sprites.offset = 0;
+
+      D3D10MapBuffer(d3d10->sprites.vbo, D3D10_MAP_WRITE_NO_OVERWRITE, 0, (void**)&mapped_vbo);
+      v = (d3d10_sprite_t*)mapped_vbo + d3d10->sprites.offset;
+   }
+
+   v_start = v;
 
    for (i = 0; i < msg_len; i++)
    {
@@ -202,29 +267,20 @@ static void d3d10_font_render_line(
       y += glyph->advance_y * scale;
    }
 
-   count = v - ((d3d10_sprite_t*)mapped_vbo + d3d10->sprites.offset);
-   D3D10UnmapBuffer(d3d10->sprites.vbo);
+   count = v - v_start;
 
-   if (!count)
-      return;
-
-   if (font->atlas->dirty)
+   if (font->block)
    {
-      d3d10_update_texture(
-            d3d10->device,
-            font->atlas->width, font->atlas->height, font->atlas->width,
-            DXGI_FORMAT_A8_UNORM, font->atlas->buffer, &font->texture);
-      font->atlas->dirty = false;
+      font->batch_count += count;
+      return;
    }
 
-   d3d10_set_texture_and_sampler(d3d10->device, 0, &font->texture);
-   D3D10SetBlendState(d3d10->device, d3d10->blend_enable, NULL, D3D10_DEFAULT_SAMPLE_MASK);
+   D3D10UnmapBuffer(d3d10->sprites.vbo);
 
-   D3D10SetPShader(d3d10->device, d3d10->sprites.shader_font.ps);
-   D3D10Draw(d3d10->device, count, d3d10->sprites.offset);
-   D3D10SetPShader(d3d10->device, d3d10->sprites.shader.ps);
+   if (!count)
+      return;
 
-   d3d10->sprites.offset += count;
+   d3d10_font_draw_sprites(d3d10, font, count);
 }
 
 static void d3d10_font_render_message(
@@ -362,13 +418,60 @@ static const struct font_glyph* d3d10_font_get_glyph(void *data, uint32_t code)
    return font->font_driver->get_glyph((void*)font->font_driver, code);
 }
 
+static void d3d10_font_flush_block(unsigned width, unsigned height,
+      void* data, video_frame_info_t* video_info)
+{
+   d3d10_font_t*         font  = (d3d10_font_t*)data;
+   d3d10_video_t*        d3d10 = (d3d10_video_t*)video_info->userdata;
+   const d3d10_sprite_t* src   = font ? font->batch : NULL;
+   unsigned              left  = font ? font->batch_count : 0;
+
+   if (!font || !font->block || !left)
+      return;
+
+   font->batch_count = 0;
+
+   if (!d3d10 || !d3d10->sprites.enabled)
+      return;
+
+   while (left)
+   {
+      void*    mapped_vbo;
+      unsigned count = MIN(left, (unsigned)d3d10->sprites.capacity);
+
+      if (d3d10->sprites.offset + count > (unsigned)d3d10->sprites.capacity)
+         d3d10->sprites.offset = 0;
+
+      D3D10MapBuffer(d3d10->sprites.vbo, D3D10_MAP_WRITE_NO_OVERWRITE, 0, (void**)&mapped_vbo);
+      memcpy((d3d10_sprite_t*)mapped_vbo + d3d10->sprites.offset,
+            src, count * sizeof(*src));
+      D3D10UnmapBuffer(d3d10->sprites.vbo);
+
+      d3d10_font_draw_sprites(d3d10, font, count);
+
+      src  += count;
+      left -= count;
+   }
+}
+
+static void d3d10_font_bind_block(void* data, void* userdata)
+{
+   d3d10_font_t* font = (d3d10_font_t*)data;
+
+   if (!font)
+      return;
+
+   font->block       = (video_font_raster_block_t*)userdata;
+   font->batch_count = 0;
+}
+
 font_renderer_t d3d10_font = {
    d3d10_font_init_font,
    d3d10_font_free_font,
    d3d10_font_render_msg,
    "d3d10font",
    d3d10_font_get_glyph,
-   NULL, /* bind_block */
-   NULL, /* flush */
+   d3d10_font_bind_block,
+   d3d10_font_flush_block,
    d3d10_font_get_message_width,
 };
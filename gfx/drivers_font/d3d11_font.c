@@ -20,6 +20,7 @@
 #include <malloc.h>
 #include <math.h>
 #include <encodings/utf.h>
+#include <retro_miscellaneous.h>
 
 #include "../font_driver.h"
 #include "../video_driver.h"
@@ -33,6 +34,13 @@ typedef struct
    const font_renderer_driver_t* font_driver;
    void*                         font_data;
    struct font_atlas*            atlas;
+
+   /* While a block is bound, sprites are gathered here and only
+    * drawn by flush. */
+   video_font_raster_block_t*    block;
+   d3d11_sprite_t*               batch;
+   unsigned                      batch_count;
+   unsigned                      batch_capacity;
 } d3d11_font_t;
 
 static void*
@@ -79,9 +87,52 @@ static void d3d11_font_free_font(void* data, bool is_threaded)
    Release(font->texture.handle);
    Release(font->texture.staging);
    Release(font->texture.view);
+   free(font->batch);
    free(font);
 }
 
+static bool d3d11_font_reserve_batch(d3d11_font_t* font, unsigned count)
+{
+   d3d11_sprite_t* batch    = NULL;
+   unsigned        capacity = font->batch_capacity ? font->batch_capacity : 256;
+
+   if (count <= font->batch_capacity)
+      return true;
+
+   while (capacity < count)
+      capacity *= 2;
+
+   batch = (d3d11_sprite_t*)realloc(font->batch, capacity * sizeof(*batch));
+
+   if (!batch)
+      return false;
+
+   font->batch          = batch;
+   font->batch_capacity = capacity;
+   return true;
+}
+
+static void d3d11_font_draw_sprites(
+      d3d11_video_t* d3d11, d3d11_font_t* font, unsigned count)
+{
+   if (font->atlas->dirty)
+   {
+      d3d11_update_texture(
+            d3d11->context, font->atlas->width, font->atlas->height, font->atlas->width,
+            DXGI_FORMAT_A8_UNORM, font->atlas->buffer, &font->texture);
+      font->atlas->dirty = false;
+   }
+
+   d3d11_set_texture_and_sampler(d3d11->context, 0, &font->texture);
+   D3D11SetBlendState(d3d11->context, d3d11->blend_enable, NULL, D3D11_DEFAULT_SAMPLE_MASK);
+
+   D3D11SetPShader(d3d11->context, d3d11->sprites.shader_font.ps, NULL, 0);
+   D3D11Draw(d3d11->context, count, d3d11->sprites.offset);
+   D3D11SetPShader(d3d11->context, d3d11->sprites.shader.ps, NULL, 0);
+
+   d3d11->sprites.offset += count;
+}
+
 static int d3d11_font_get_message_width(void* data, const char* msg, unsigned msg_len, float scale)
 {
    d3d11_font_t* font = (d3d11_font_t*)data;
@@ -130,6 +181,7 @@ static void d3d11_font_render_line(
    unsigned                 i, count;
    D3D11_MAPPED_SUBRESOURCE mapped_vbo;
    d3d11_sprite_t*          v;
+   d3d11_sprite_t*          v_start;
    d3d11_video_t*           d3d11  = (d3d11_video_t*)video_info->userdata;
    unsigned                 width  = video_info->width;
    unsigned                 height = video_info->height;
@@ -141,9 +193,6 @@ static void d3d11_font_render_line(
          msg_len > (unsigned)d3d11->sprites.capacity)
       return;
 
-   if (d3d11->sprites.offset + msg_len > (unsigned)d3d11->sprites.capacity)
-      d3d11->sprites.offset = 0;
-
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
@@ -155,8 +204,23 @@ static void d3d11_font_render_line(
          break;
    }
 
-   D3D11MapBuffer(d3d11->context, d3d11->sprites.vbo, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped_vbo);
-   v = (d3d11_sprite_t*)mapped_vbo.pData + d3d11->sprites.offset;
+   if (font->block)
+   {
+      if (!d3d11_font_reserve_batch(font, font->batch_count + msg_len))
+         return;
+
+      v = font->batch + font->batch_count;
+   }
+   else
+   {
+      if (d3d11->sprites.offset + msg_len > (unsigned)d3d11->sprites.capacity)
+         d3d11->sprites.offset = 0;
+
+      D3D11MapBuffer(d3d11->context, d3d11->sprites.vbo, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped_vbo);
+      v = (d3d11_sprite_t*)mapped_vbo.pData + d3d11->sprites.offset;
+   }
+
+   v_start = v;
 
    for (i = 0; i < msg_len; i++)
    {
@@ -200,28 +264,20 @@ static void d3d11_font_render_line(
       y += glyph->advance_y * scale;
    }
 
-   count = v - ((d3d11_sprite_t*)mapped_vbo.pData + d3d11->sprites.offset);
-   D3D11UnmapBuffer(d3d11->context, d3d11->sprites.vbo, 0);
+   count = v - v_start;
 
-   if (!count)
-      return;
-
-   if (font->atlas->dirty)
+   if (font->block)
    {
-      d3d11_update_texture(
-            d3d11->context, font->atlas->width, font->atlas->height, font->atlas->width,
-            DXGI_FORMAT_A8_UNORM, font->atlas->buffer, &font->texture);
-      font->atlas->dirty = false;
+      font->batch_count += count;
+      return;
    }
 
-   d3d11_set_texture_and_sampler(d3d11->context, 0, &font->texture);
-   D3D11SetBlendState(d3d11->context, d3d11->blend_enable, NULL, D3D11_DEFAULT_SAMPLE_MASK);
+   D3D11UnmapBuffer(d3d11->context, d3d11->sprites.vbo, 0);
 
-   D3D11SetPShader(d3d11->context, d3d11->sprites.shader_font.ps, NULL, 0);
-   D3D11Draw(d3d11->context, count, d3d11->sprites.offset);
-   D3D11SetPShader(d3d11->context, d3d11->sprites.shader.ps, NULL, 0);
+   if (!count)
+      return;
 
-   d3d11->sprites.offset += count;
+   d3d11_font_draw_sprites(d3d11, font, count);
 }
 
 static void d3d11_font_render_message(
@@ -359,13 +415,60 @@ static const struct font_glyph* d3d11_font_get_glyph(void *data, uint32_t code)
    return font->font_driver->get_glyph((void*)font->font_driver, code);
 }
 
+static void d3d11_font_flush_block(unsigned width, unsigned height,
+      void* data, video_frame_info_t* video_info)
+{
+   d3d11_font_t*         font  = (d3d11_font_t*)data;
+   d3d11_video_t*        d3d11 = (d3d11_video_t*)video_info->userdata;
+   const d3d11_sprite_t* src   = font ? font->batch : NULL;
+   unsigned              left  = font ? font->batch_count : 0;
+
+   if (!font || !font->block || !left)
+      return;
+
+   font->batch_count = 0;
+
+   if (!d3d11 || !d3d11->sprites.enabled)
+      return;
+
+   while (left)
+   {
+      D3D11_MAPPED_SUBRESOURCE mapped_vbo;
+      unsigned count = MIN(left, (unsigned)d3d11->sprites.capacity);
+
+      if (d3d11->sprites.offset + count > (unsigned)d3d11->sprites.capacity)
+         d3d11->sprites.offset = 0;
+
+      D3D11MapBuffer(d3d11->context, d3d11->sprites.vbo, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped_vbo);
+      memcpy((d3d11_sprite_t*)mapped_vbo.pData + d3d11->sprites.offset,
+            src, count * sizeof(*src));
+      D3D11UnmapBuffer(d3d11->context, d3d11->sprites.vbo, 0);
+
+      d3d11_font_draw_sprites(d3d11, font, count);
+
+      src  += count;
+      left -= count;
+   }
+}
+
+static void d3d11_font_bind_block(void* data, void* userdata)
+{
+   d3d11_font_t* font = (d3d11_font_t*)data;
+
+   if (!font)
+      return;
+
+   font->block       = (video_font_raster_block_t*)userdata;
+   font->batch_count = 0;
+}
+
 font_renderer_t d3d11_font = {
    d3d11_font_init_font,
    d3d11_font_free_font,
    d3d11_font_render_msg,
    "d3d11font",
    d3d11_font_get_glyph,
-   NULL, /* bind_block */
-   NULL, /* flush */
+   d3d11_font_bind_block,
+   d3d11_font_flush_block,
    d3d11_font_get_message_width,
 };
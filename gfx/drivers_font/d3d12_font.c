@@ -20,6 +20,7 @@
 #include <malloc.h>
 #include <math.h>
 #include <encodings/utf.h>
+#include <retro_miscellaneous.h>
 
 #include "../font_driver.h"
 #include "../video_driver.h"
@@ -29,10 +30,18 @@
 
 typedef struct
 {
+   d3d12_video_t*                d3d12;
    d3d12_texture_t               texture;
    const font_renderer_driver_t* font_driver;
    void*                         font_data;
    struct font_atlas*            atlas;
+
+   /* While a block is bound, sprites are gathered here and only
+    * drawn by flush. */
+   video_font_raster_block_t*    block;
+   d3d12_sprite_t*               batch;
+   unsigned                      batch_count;
+   unsigned                      batch_capacity;
 } d3d12_font_t;
 
 static void*
@@ -54,6 +63,7 @@ d3d12_font_init_font(void* data, const char* font_path,
       return NULL;
    }
 
+   font->d3d12               = d3d12;
    font->atlas               = font->font_driver->get_atlas(font->font_data);
    font->texture.sampler     = d3d12->samplers[RARCH_FILTER_LINEAR][RARCH_WRAP_BORDER];
    font->texture.desc.Width  = font->atlas->width;
@@ -80,11 +90,58 @@ static void d3d12_font_free_font(void* data, bool is_threaded)
    if (font->font_driver && font->font_data && font->font_driver->free)
       font->font_driver->free(font->font_data);
 
+   /* frames still in flight may sample the atlas */
+   d3d12_wait_for_fence(font->d3d12, font->d3d12->queue.fenceValue);
    d3d12_release_texture(&font->texture);
 
+   free(font->batch);
    free(font);
 }
 
+static bool d3d12_font_reserve_batch(d3d12_font_t* font, unsigned count)
+{
+   d3d12_sprite_t* batch    = NULL;
+   unsigned        capacity = font->batch_capacity ? font->batch_capacity : 256;
+
+   if (count <= font->batch_capacity)
+      return true;
+
+   while (capacity < count)
+      capacity *= 2;
+
+   batch = (d3d12_sprite_t*)realloc(font->batch, capacity * sizeof(*batch));
+
+   if (!batch)
+      return false;
+
+   font->batch          = batch;
+   font->batch_capacity = capacity;
+   return true;
+}
+
+static void d3d12_font_draw_sprites(video_frame_info_t* video_info,
+      d3d12_video_t* d3d12, d3d12_font_t* font, unsigned count)
+{
+   if (font->atlas->dirty)
+   {
+      d3d12_stream_texture(d3d12,
+            font->atlas->width, font->atlas->height,
+            font->atlas->width, DXGI_FORMAT_A8_UNORM,
+            font->atlas->buffer, &font->texture);
+      font->atlas->dirty = false;
+   }
+
+   if(font->texture.dirty)
+      d3d12_upload_texture(d3d12->queue.cmd, &font->texture,
+            video_info->userdata);
+
+   D3D12SetPipelineState(d3d12->queue.cmd, d3d12->sprites.pipe_font);
+   d3d12_set_texture_and_sampler(d3d12->queue.cmd, &font->texture);
+   D3D12DrawInstanced(d3d12->queue.cmd, count, 1, 0, 0);
+
+   D3D12SetPipelineState(d3d12->queue.cmd, d3d12->sprites.pipe);
+}
+
 static int d3d12_font_get_message_width(void* data,
       const char* msg, unsigned msg_len, float scale)
 {
@@ -140,16 +197,12 @@ static void d3d12_font_render_line(
    unsigned        height     = video_info->height;
    int             x          = roundf(pos_x * width);
    int             y          = roundf((1.0 - pos_y) * height);
-   D3D12_RANGE     range      = { 0, 0 };
 
    if (  !d3d12                  || 
          !d3d12->sprites.enabled || 
          msg_len > (unsigned)d3d12->sprites.capacity)
       return;
 
-   if (d3d12->sprites.offset + msg_len > (unsigned)d3d12->sprites.capacity)
-      d3d12->sprites.offset = 0;
-
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
@@ -161,10 +214,23 @@ static void d3d12_font_render_line(
          break;
    }
 
-   D3D12Map(d3d12->sprites.vbo, 0, &range, (void**)&vbo_start);
+   if (font->block)
+   {
+      if (!d3d12_font_reserve_batch(font, font->batch_count + msg_len))
+         return;
+
+      vbo_start = font->batch + font->batch_count;
+      v         = vbo_start;
+   }
+   else
+   {
+      vbo_start = d3d12_alloc_sprites(d3d12, msg_len);
+
+      if (!vbo_start)
+         return;
 
-   v           = vbo_start + d3d12->sprites.offset;
-   range.Begin = (uintptr_t)v - (uintptr_t)vbo_start;
+      v = vbo_start;
+   }
 
    for (i = 0; i < msg_len; i++)
    {
@@ -208,34 +274,18 @@ static void d3d12_font_render_line(
       y += glyph->advance_y * scale;
    }
 
-   range.End = (uintptr_t)v - (uintptr_t)vbo_start;
-   D3D12Unmap(d3d12->sprites.vbo, 0, &range);
-
-   count = v - vbo_start - d3d12->sprites.offset;
-
-   if (!count)
-      return;
-
-   if (font->atlas->dirty)
+   if (font->block)
    {
-      d3d12_update_texture(
-            font->atlas->width, font->atlas->height,
-            font->atlas->width, DXGI_FORMAT_A8_UNORM,
-            font->atlas->buffer, &font->texture);
-      font->atlas->dirty = false;
+      font->batch_count += v - vbo_start;
+      return;
    }
 
-   if(font->texture.dirty)
-      d3d12_upload_texture(d3d12->queue.cmd, &font->texture,
-            video_info->userdata);
-
-   D3D12SetPipelineState(d3d12->queue.cmd, d3d12->sprites.pipe_font);
-   d3d12_set_texture_and_sampler(d3d12->queue.cmd, &font->texture);
-   D3D12DrawInstanced(d3d12->queue.cmd, count, 1, d3d12->sprites.offset, 0);
+   count = v - vbo_start;
 
-   D3D12SetPipelineState(d3d12->queue.cmd, d3d12->sprites.pipe);
+   if (!count)
+      return;
 
-   d3d12->sprites.offset += count;
+   d3d12_font_draw_sprites(video_info, d3d12, font, count);
 }
 
 static void d3d12_font_render_message(
@@ -376,13 +426,57 @@ static const struct font_glyph* d3d12_font_get_glyph(
    return font->font_driver->get_glyph((void*)font->font_driver, code);
 }
 
+static void d3d12_font_flush_block(unsigned width, unsigned height,
+      void* data, video_frame_info_t* video_info)
+{
+   d3d12_font_t*         font  = (d3d12_font_t*)data;
+   d3d12_video_t*        d3d12 = (d3d12_video_t*)video_info->userdata;
+   const d3d12_sprite_t* src   = font ? font->batch : NULL;
+   unsigned              left  = font ? font->batch_count : 0;
+
+   if (!font || !font->block || !left)
+      return;
+
+   font->batch_count = 0;
+
+   if (!d3d12 || !d3d12->sprites.enabled)
+      return;
+
+   while (left)
+   {
+      unsigned        count     = MIN(left, (unsigned)d3d12->sprites.capacity);
+      d3d12_sprite_t* vbo_start = d3d12_alloc_sprites(d3d12, count);
+
+      if (!vbo_start)
+         return;
+
+      memcpy(vbo_start, src, count * sizeof(*src));
+
+      d3d12_font_draw_sprites(video_info, d3d12, font, count);
+
+      src  += count;
+      left -= count;
+   }
+}
+
+static void d3d12_font_bind_block(void* data, void* userdata)
+{
+   d3d12_font_t* font = (d3d12_font_t*)data;
+
+   if (!font)
+      return;
+
+   font->block       = (video_font_raster_block_t*)userdata;
+   font->batch_count = 0;
+}
+
 font_renderer_t d3d12_font = {
    d3d12_font_init_font,
    d3d12_font_free_font,
    d3d12_font_render_msg,
    "d3d12font",
    d3d12_font_get_glyph,
-   NULL, /* bind_block */
-   NULL, /* flush */
+   d3d12_font_bind_block,
+   d3d12_font_flush_block,
    d3d12_font_get_message_width,
 };
@@ -24,14 +24,15 @@
 #include "../common/gl_common.h"
 #include "../font_driver.h"
 #include "../video_driver.h"
+#include "../../configuration.h"
 
 /* TODO: Move viewport side effects to the caller: it's a source of bugs. */
 
 #define gl_raster_font_emit(c, vx, vy) do { \
    font_vertex[     2 * (6 * i + c) + 0] = (x + (delta_x + off_x + vx * width) * scale) * inv_win_width; \
    font_vertex[     2 * (6 * i + c) + 1] = (y + (delta_y - off_y - vy * height) * scale) * inv_win_height; \
-   font_tex_coords[ 2 * (6 * i + c) + 0] = (tex_x + vx * width) * inv_tex_size_x; \
-   font_tex_coords[ 2 * (6 * i + c) + 1] = (tex_y + vy * height) * inv_tex_size_y; \
+   font_tex_coords[ 2 * (6 * i + c) + 0] = (tex_x + vx * tex_width) * inv_tex_size_x; \
+   font_tex_coords[ 2 * (6 * i + c) + 1] = (tex_y + vy * tex_height) * inv_tex_size_y; \
    font_color[      4 * (6 * i + c) + 0] = color[0]; \
    font_color[      4 * (6 * i + c) + 1] = color[1]; \
    font_color[      4 * (6 * i + c) + 2] = color[2]; \
@@ -51,6 +52,7 @@ typedef struct
    const font_renderer_driver_t *font_driver;
    void *font_data;
    struct font_atlas *atlas;
+   bool sdf;
 
    video_font_raster_block_t *block;
 } gl_raster_t;
@@ -68,7 +70,7 @@ static void gl_raster_font_free_font(void *data,
    if (is_threaded)
       video_context_driver_make_current(true);
 
-   glDeleteTextures(1, &font->tex);
+   gl_state_delete_textures(1, &font->tex);
 
    free(font);
 }
@@ -108,49 +110,45 @@ static bool gl_raster_font_upload_atlas_components_4(gl_raster_t *font)
 }
 #endif
 
-static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+static size_t gl_raster_font_atlas_components(gl_raster_t *font)
 {
-   unsigned i, j;
-   GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
-   GLenum gl_format                     = GL_LUMINANCE_ALPHA;
-   size_t ncomponents                   = 2;
-   uint8_t       *tmp                   = NULL;
 #if defined(GL_VERSION_3_0)
    struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
 
     if (font->gl->core_context_in_use ||
         (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
          hwr->version_major >= 3))
-   {
-      GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
-      glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
-
-      gl_internal = GL_R8;
-      gl_format   = GL_RED;
-      ncomponents = 1;
-   }
+      return 1;
 #endif
+   return 2;
+}
 
-   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
+static void gl_raster_font_convert_atlas(gl_raster_t *font,
+      uint8_t *tmp, size_t pitch, size_t ncomponents,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   unsigned i, j;
 
    switch (ncomponents)
    {
       case 1:
-         for (i = 0; i < font->atlas->height; ++i)
+         for (i = 0; i < height; ++i)
          {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
+            const uint8_t *src = &font->atlas->buffer[
+               (y + i) * font->atlas->width + x];
+            uint8_t       *dst = &tmp[i * pitch];
 
-            memcpy(dst, src, font->atlas->width);
+            memcpy(dst, src, width);
          }
          break;
       case 2:
-         for (i = 0; i < font->atlas->height; ++i)
+         for (i = 0; i < height; ++i)
          {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
+            const uint8_t *src = &font->atlas->buffer[
+               (y + i) * font->atlas->width + x];
+            uint8_t       *dst = &tmp[i * pitch];
 
-            for (j = 0; j < font->atlas->width; ++j)
+            for (j = 0; j < width; ++j)
             {
                *dst++ = 0xff;
                *dst++ = *src++;
@@ -158,6 +156,32 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
          }
          break;
    }
+}
+
+static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+{
+   GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
+   GLenum gl_format                     = GL_LUMINANCE_ALPHA;
+   size_t ncomponents                   = gl_raster_font_atlas_components(font);
+   uint8_t       *tmp                   = NULL;
+#if defined(GL_VERSION_3_0)
+   if (ncomponents == 1)
+   {
+      GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+      glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+
+      gl_internal = GL_R8;
+      gl_format   = GL_RED;
+   }
+#endif
+
+   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
+
+   if (!tmp)
+      return false;
+
+   gl_raster_font_convert_atlas(font, tmp, font->tex_width * ncomponents,
+         ncomponents, 0, 0, font->atlas->width, font->atlas->height);
 
    glTexImage2D(GL_TEXTURE_2D, 0, gl_internal, font->tex_width, font->tex_height,
          0, gl_format, GL_UNSIGNED_BYTE, tmp);
@@ -167,10 +191,57 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    return true;
 }
 
+/* Only sends the rectangle the renderer touched since the last
+ * upload, which for a newly rasterized glyph is a few hundred
+ * bytes instead of the whole atlas. */
+static bool gl_raster_font_upload_atlas_rect(gl_raster_t *font)
+{
+   GLenum gl_format   = GL_LUMINANCE_ALPHA;
+   size_t ncomponents = gl_raster_font_atlas_components(font);
+   unsigned x         = font->atlas->dirty_x;
+   unsigned y         = font->atlas->dirty_y;
+   unsigned width     = font->atlas->dirty_width;
+   unsigned height    = font->atlas->dirty_height;
+   uint8_t *tmp       = (uint8_t*)malloc(width * height * ncomponents);
+
+   if (!tmp)
+      return false;
+
+#if defined(GL_VERSION_3_0)
+   if (ncomponents == 1)
+      gl_format = GL_RED;
+#endif
+
+   gl_raster_font_convert_atlas(font, tmp, width * ncomponents,
+         ncomponents, x, y, width, height);
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+         gl_format, GL_UNSIGNED_BYTE, tmp);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+   free(tmp);
+
+   return true;
+}
+
+/* Distance fields need the smoothstep shader, which only the
+ * GLSL backend has. */
+static bool gl_raster_font_sdf_supported(void)
+{
+   video_shader_ctx_ident_t ident_info;
+
+   ident_info.ident = NULL;
+
+   return video_shader_driver_get_ident(&ident_info)
+      && string_is_equal(ident_info.ident, "glsl");
+}
+
 static void *gl_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
 {
+   settings_t *settings = config_get_ptr();
    gl_raster_t   *font  = (gl_raster_t*)calloc(1, sizeof(*font));
 
    if (!font)
@@ -178,7 +249,12 @@ static void *gl_raster_font_init_font(void *data,
 
    font->gl = (gl_t*)data;
 
-   if (!font_renderer_create_default(
+   if (settings->bools.video_font_sdf && gl_raster_font_sdf_supported())
+      font->sdf = font_renderer_create_sdf(
+            &font->font_driver,
+            &font->font_data, font_path, font_size);
+
+   if (!font->sdf && !font_renderer_create_default(
             &font->font_driver,
             &font->font_data, font_path, font_size))
    {
@@ -201,9 +277,10 @@ static void *gl_raster_font_init_font(void *data,
    if (!gl_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font->atlas->dirty       = false;
+   font->atlas->dirty_width = 0;
 
-   glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
+   gl_state_bind_texture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
 
    return font;
 
@@ -253,8 +330,12 @@ static void gl_raster_font_draw_vertices(gl_raster_t *font,
 
    if (font->atlas->dirty)
    {
-      gl_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
+      if (font->atlas->dirty_width)
+         gl_raster_font_upload_atlas_rect(font);
+      else
+         gl_raster_font_upload_atlas(font);
+      font->atlas->dirty       = false;
+      font->atlas->dirty_width = 0;
    }
 
    coords_data.handle_data = NULL;
@@ -307,6 +388,7 @@ static void gl_raster_font_render_line(
       while ((i < MAX_MSG_LEN_CHUNK) && (msg < msg_end))
       {
          int off_x, off_y, tex_x, tex_y, width, height;
+         int tex_width, tex_height;
          unsigned                  code = utf8_walk(&msg);
          const struct font_glyph *glyph = font->font_driver->get_glyph(
                font->font_data, code);
@@ -324,6 +406,11 @@ static void gl_raster_font_render_line(
          width  = glyph->width;
          height = glyph->height;
 
+         /* Distance field glyphs are stored at their own size and
+          * stretched to the requested one. */
+         tex_width  = glyph->atlas_width  ? glyph->atlas_width  : width;
+         tex_height = glyph->atlas_height ? glyph->atlas_height : height;
+
          gl_raster_font_emit(0, 0, 1); /* Bottom-left */
          gl_raster_font_emit(1, 1, 1); /* Bottom-right */
          gl_raster_font_emit(2, 0, 0); /* Top-left */
@@ -400,14 +487,15 @@ static void gl_raster_font_setup_viewport(unsigned width, unsigned height,
 
    video_driver_set_viewport(width, height, full_screen, false);
 
-   glEnable(GL_BLEND);
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   gl_state_blend(true);
+   gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    glBlendEquation(GL_FUNC_ADD);
 
-   glBindTexture(GL_TEXTURE_2D, font->tex);
+   gl_state_bind_texture(GL_TEXTURE_2D, font->tex);
 
    shader_info.data       = NULL;
-   shader_info.idx        = VIDEO_SHADER_STOCK_BLEND;
+   shader_info.idx        = font->sdf
+      ? VIDEO_SHADER_STOCK_SDF : VIDEO_SHADER_STOCK_BLEND;
    shader_info.set_active = true;
 
    video_shader_driver_use(&shader_info);
@@ -502,9 +590,9 @@ static void gl_raster_font_render_msg(
    if (!font->block && font->gl)
    {
       /* restore viewport */
-      glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
+      gl_state_bind_texture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
 
-      glDisable(GL_BLEND);
+      gl_state_blend(false);
       video_driver_set_viewport(width, height, false, true);
    }
 }
@@ -537,9 +625,9 @@ static void gl_raster_font_flush_block(unsigned width, unsigned height,
    if (font->gl)
    {
       /* restore viewport */
-      glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
+      gl_state_bind_texture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
 
-      glDisable(GL_BLEND);
+      gl_state_blend(false);
       video_driver_set_viewport(width, height, block->fullscreen, true);
    }
 }
@@ -13,6 +13,7 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <encodings/utf.h>
@@ -35,6 +36,12 @@ typedef struct
    struct vk_vertex *pv;
    struct vk_buffer_range range;
    unsigned vertices;
+
+   /* While a block is bound, messages are written to batch and
+    * only drawn by flush_block. */
+   video_font_raster_block_t *block;
+   struct vk_vertex *batch;
+   unsigned batch_capacity;
 } vulkan_raster_t;
 
 static void vulkan_raster_font_free_font(void *data, bool is_threaded);
@@ -101,9 +108,33 @@ static void vulkan_raster_font_free_font(void *data, bool is_threaded)
    vulkan_destroy_texture(
          font->vk->context->device, &font->texture_optimal);
 
+   free(font->batch);
    free(font);
 }
 
+static bool vulkan_raster_font_reserve_batch(vulkan_raster_t *font,
+      unsigned vertices)
+{
+   struct vk_vertex *batch = NULL;
+   unsigned capacity       = font->batch_capacity ? font->batch_capacity : 1024;
+
+   if (vertices <= font->batch_capacity)
+      return true;
+
+   while (capacity < vertices)
+      capacity *= 2;
+
+   batch = (struct vk_vertex*)realloc(font->batch,
+         capacity * sizeof(*batch));
+
+   if (!batch)
+      return false;
+
+   font->batch          = batch;
+   font->batch_capacity = capacity;
+   return true;
+}
+
 static INLINE void vulkan_raster_font_update_glyph(vulkan_raster_t *font, const struct font_glyph *glyph)
 {
    if(font->atlas->dirty)
@@ -387,18 +418,29 @@ static void vulkan_raster_font_render_msg(
       color[3]    = 1.0f;
    }
 
-   video_driver_set_viewport(width, height, full_screen, false);
-
    max_glyphs = strlen(msg);
    if (drop_x || drop_y)
       max_glyphs *= 2;
 
-   if (!vulkan_buffer_chain_alloc(font->vk->context, &font->vk->chain->vbo,
-         6 * sizeof(struct vk_vertex) * max_glyphs, &font->range))
-      return;
+   if (font->block)
+   {
+      if (!vulkan_raster_font_reserve_batch(font,
+               font->vertices + 6 * max_glyphs))
+         return;
 
-   font->vertices   = 0;
-   font->pv         = (struct vk_vertex*)font->range.data;
+      font->pv      = font->batch;
+   }
+   else
+   {
+      video_driver_set_viewport(width, height, full_screen, false);
+
+      if (!vulkan_buffer_chain_alloc(font->vk->context, &font->vk->chain->vbo,
+               6 * sizeof(struct vk_vertex) * max_glyphs, &font->range))
+         return;
+
+      font->vertices   = 0;
+      font->pv         = (struct vk_vertex*)font->range.data;
+   }
 
    if (drop_x || drop_y)
    {
@@ -414,7 +456,41 @@ static void vulkan_raster_font_render_msg(
 
    vulkan_raster_font_render_message(font, msg, scale,
          color, x, y, text_align);
-   vulkan_raster_font_flush(font);
+
+   if (!font->block)
+      vulkan_raster_font_flush(font);
+}
+
+static void vulkan_raster_font_flush_block(unsigned width, unsigned height,
+      void *data, video_frame_info_t *video_info)
+{
+   vulkan_raster_t *font = (vulkan_raster_t*)data;
+
+   if (!font || !font->block || !font->vertices)
+      return;
+
+   video_driver_set_viewport(width, height, font->block->fullscreen, false);
+
+   if (vulkan_buffer_chain_alloc(font->vk->context, &font->vk->chain->vbo,
+            font->vertices * sizeof(struct vk_vertex), &font->range))
+   {
+      memcpy(font->range.data, font->batch,
+            font->vertices * sizeof(struct vk_vertex));
+      vulkan_raster_font_flush(font);
+   }
+
+   font->vertices = 0;
+}
+
+static void vulkan_raster_font_bind_block(void *data, void *userdata)
+{
+   vulkan_raster_t *font = (vulkan_raster_t*)data;
+
+   if (!font)
+      return;
+
+   font->block    = (video_font_raster_block_t*)userdata;
+   font->vertices = 0;
 }
 
 static const struct font_glyph *vulkan_raster_font_get_glyph(
@@ -442,7 +518,7 @@ font_renderer_t vulkan_raster_font = {
    vulkan_raster_font_render_msg,
    "Vulkan raster",
    vulkan_raster_font_get_glyph,
-   NULL,                            /* bind_block */
-   NULL,                            /* flush_block */
+   vulkan_raster_font_bind_block,
+   vulkan_raster_font_flush_block,
    vulkan_get_message_width
 };
@@ -161,7 +161,9 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
             dst[c] = src[c];
    }
 
-   handle->atlas.dirty = true;
+   font_atlas_mark_dirty(&handle->atlas,
+         atlas_slot->glyph.atlas_offset_x, atlas_slot->glyph.atlas_offset_y,
+         atlas_slot->glyph.width, atlas_slot->glyph.height);
    atlas_slot->last_used = handle->usage_counter++;
    return &atlas_slot->glyph;
 }
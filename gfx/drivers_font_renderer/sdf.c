@@ -0,0 +1,583 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Signed distance field glyphs, shared by every size of a font.
+ *
+ * Each font path gets one atlas. Glyphs are rasterized once, by
+ * whatever font_renderer_create_default() picks, at
+ * SDF_FONT_OVERSAMPLE times SDF_FONT_SIZE. They are turned into
+ * distance fields SDF_FONT_SIZE texels to the em, and every size the
+ * font is asked for reads those same texels. A texel holds
+ * 128 - 128 * distance / SDF_FONT_SPREAD, with the distance to the
+ * outline in texels and negative inside. Drivers threshold at 128
+ * and scale the quads.
+ *
+ * Each instance (i.e. size) has its own struct font_atlas view of
+ * the shared buffer, with its own dirty rectangle, so each consumer
+ * uploads only the glyphs added since it last looked.
+ *
+ * Only the video thread should call into this. */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+
+#include "../font_driver.h"
+#include "../../verbosity.h"
+
+/* Texels to the em of the shared glyphs. */
+#define SDF_FONT_SIZE        32
+
+/* The outlines are traced at this many times SDF_FONT_SIZE. */
+#define SDF_FONT_OVERSAMPLE  2
+
+/* Texels of distance kept on either side of the outline, which is
+ * also how far a glyph can be outlined or blurred. */
+#define SDF_FONT_SPREAD      4
+
+#define SDF_FONT_ATLAS_SIZE  1024
+#define SDF_FONT_MAX_GLYPHS  1024
+
+#define SDF_FONT_INF         1e20f
+
+typedef struct sdf_font_glyph
+{
+   uint32_t code;
+   int next;
+
+   /* Padded distance field, in texels. */
+   unsigned x;
+   unsigned y;
+   unsigned width;
+   unsigned height;
+
+   /* Metrics at the oversampled size. */
+   int draw_offset_x;
+   int draw_offset_y;
+   int advance_x;
+   int advance_y;
+} sdf_font_glyph_t;
+
+typedef struct sdf_font_renderer sdf_font_renderer_t;
+
+typedef struct sdf_font_atlas
+{
+   char *font_path;
+
+   const font_renderer_driver_t *driver;
+   void *handle;
+   int line_height;
+
+   uint8_t *buffer;
+
+   sdf_font_glyph_t glyphs[SDF_FONT_MAX_GLYPHS];
+   int buckets[0x100];
+   unsigned num_glyphs;
+
+   unsigned shelf_x;
+   unsigned shelf_y;
+   unsigned shelf_height;
+
+   /* Bumped whenever the atlas starts over, which invalidates the
+    * scaled glyphs of every view. Never 0. */
+   unsigned generation;
+
+   sdf_font_renderer_t *views;
+   struct sdf_font_atlas *next;
+} sdf_font_atlas_t;
+
+struct sdf_font_renderer
+{
+   sdf_font_atlas_t *shared;
+   struct font_atlas atlas;
+
+   /* Pixels per texel and pixels per oversampled pixel. */
+   float texel_scale;
+   float metric_scale;
+
+   struct font_glyph glyphs[SDF_FONT_MAX_GLYPHS];
+   unsigned glyph_generation[SDF_FONT_MAX_GLYPHS];
+
+   sdf_font_renderer_t *next;
+};
+
+static sdf_font_atlas_t *sdf_font_atlases = NULL;
+
+/* Squared distance transform of one row or column, from
+ * "Distance Transforms of Sampled Functions" (Felzenszwalb and
+ * Huttenlocher). @v and @z are scratch space for @n and @n + 1. */
+static void sdf_font_transform_1d(float *f, unsigned stride, unsigned n,
+      float *d, int *v, float *z)
+{
+   unsigned q;
+   int k = 0;
+
+   v[0]  = 0;
+   z[0]  = -SDF_FONT_INF;
+   z[1]  = SDF_FONT_INF;
+
+   for (q = 1; q < n; q++)
+   {
+      float s;
+
+      /* z[0] is -inf, so this stops at k == 0 at the latest. */
+      for (;;)
+      {
+         int r = v[k];
+         s     = ((f[q * stride] + (float)(q * q))
+               - (f[r * stride] + (float)(r * r))) / (float)(2 * ((int)q - r));
+         if (s > z[k])
+            break;
+         k--;
+      }
+
+      k++;
+      v[k]     = q;
+      z[k]     = s;
+      z[k + 1] = SDF_FONT_INF;
+   }
+
+   k = 0;
+   for (q = 0; q < n; q++)
+   {
+      float dq;
+
+      while (z[k + 1] < (float)q)
+         k++;
+      dq   = (float)((int)q - v[k]);
+      d[q] = dq * dq + f[v[k] * stride];
+   }
+
+   for (q = 0; q < n; q++)
+      f[q * stride] = d[q];
+}
+
+static void sdf_font_transform(float *f, unsigned width, unsigned height,
+      float *d, int *v, float *z)
+{
+   unsigned i;
+
+   for (i = 0; i < width; i++)
+      sdf_font_transform_1d(f + i, width, height, d, v, z);
+   for (i = 0; i < height; i++)
+      sdf_font_transform_1d(f + i * width, 1, width, d, v, z);
+}
+
+/* Traces the coverage bitmap at @src into a distance field of
+ * @width x @height texels at @dst, SDF_FONT_SPREAD of them being
+ * padding on each side. */
+static bool sdf_font_build_field(uint8_t *dst, unsigned dst_pitch,
+      unsigned width, unsigned height,
+      const uint8_t *src, unsigned src_pitch,
+      unsigned src_width, unsigned src_height)
+{
+   unsigned x, y;
+   unsigned hi_width  = width  * SDF_FONT_OVERSAMPLE;
+   unsigned hi_height = height * SDF_FONT_OVERSAMPLE;
+   unsigned pad       = SDF_FONT_SPREAD * SDF_FONT_OVERSAMPLE;
+   unsigned longest   = MAX(hi_width, hi_height);
+   size_t size        = (size_t)hi_width * hi_height;
+   float *outside     = (float*)malloc(size * sizeof(float));
+   float *inside      = (float*)malloc(size * sizeof(float));
+   float *d           = (float*)malloc(longest * sizeof(float));
+   float *z           = (float*)malloc((longest + 1) * sizeof(float));
+   int *v             = (int*)malloc(longest * sizeof(int));
+   bool ret           = false;
+
+   if (!outside || !inside || !d || !z || !v)
+      goto end;
+
+   /* outside: 0 on glyph pixels, becomes the squared distance to the
+    * glyph. inside: the other way around. */
+   for (y = 0; y < hi_height; y++)
+   {
+      for (x = 0; x < hi_width; x++)
+      {
+         bool on = false;
+         size_t i = (size_t)y * hi_width + x;
+
+         if (     x >= pad && x - pad < src_width
+               && y >= pad && y - pad < src_height)
+            on = src[(y - pad) * src_pitch + (x - pad)] >= 128;
+
+         outside[i] = on ? 0.0f : SDF_FONT_INF;
+         inside[i]  = on ? SDF_FONT_INF : 0.0f;
+      }
+   }
+
+   sdf_font_transform(outside, hi_width, hi_height, d, v, z);
+   sdf_font_transform(inside,  hi_width, hi_height, d, v, z);
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         unsigned sx, sy;
+         int value;
+         float dist = 0.0f;
+
+         for (sy = 0; sy < SDF_FONT_OVERSAMPLE; sy++)
+         {
+            for (sx = 0; sx < SDF_FONT_OVERSAMPLE; sx++)
+            {
+               size_t i = (size_t)(y * SDF_FONT_OVERSAMPLE + sy) * hi_width
+                  + x * SDF_FONT_OVERSAMPLE + sx;
+
+               /* The outline runs half a pixel off the centers. */
+               if (outside[i] > 0.0f)
+                  dist += sqrtf(outside[i]) - 0.5f;
+               else
+                  dist -= sqrtf(inside[i]) - 0.5f;
+            }
+         }
+
+         dist /= (float)(SDF_FONT_OVERSAMPLE * SDF_FONT_OVERSAMPLE
+               * SDF_FONT_OVERSAMPLE);
+         value = (int)(128.0f - dist * (128.0f / SDF_FONT_SPREAD) + 0.5f);
+
+         dst[y * dst_pitch + x] = (uint8_t)MAX(0, MIN(255, value));
+      }
+   }
+
+   ret = true;
+
+end:
+   free(outside);
+   free(inside);
+   free(d);
+   free(z);
+   free(v);
+   return ret;
+}
+
+static void sdf_font_atlas_mark_dirty(sdf_font_atlas_t *shared,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   sdf_font_renderer_t *view;
+
+   for (view = shared->views; view; view = view->next)
+      font_atlas_mark_dirty(&view->atlas, x, y, width, height);
+}
+
+static void sdf_font_atlas_reset(sdf_font_atlas_t *shared)
+{
+   sdf_font_renderer_t *view;
+
+   memset(shared->buffer, 0, SDF_FONT_ATLAS_SIZE * SDF_FONT_ATLAS_SIZE);
+   memset(shared->buckets, -1, sizeof(shared->buckets));
+
+   shared->num_glyphs   = 0;
+   shared->shelf_x      = 0;
+   shared->shelf_y      = 0;
+   shared->shelf_height = 0;
+
+   if (!++shared->generation)
+      shared->generation = 1;
+
+   for (view = shared->views; view; view = view->next)
+   {
+      view->atlas.dirty       = true;
+      view->atlas.dirty_width = 0;
+   }
+}
+
+/* Finds room for @width x @height texels, with a gap so that
+ * filtering never reads a neighbour. */
+static bool sdf_font_atlas_alloc(sdf_font_atlas_t *shared,
+      unsigned width, unsigned height, unsigned *x, unsigned *y)
+{
+   if (shared->shelf_x + width > SDF_FONT_ATLAS_SIZE)
+   {
+      shared->shelf_x      = 0;
+      shared->shelf_y     += shared->shelf_height;
+      shared->shelf_height = 0;
+   }
+
+   if (     width > SDF_FONT_ATLAS_SIZE
+         || shared->shelf_y + height > SDF_FONT_ATLAS_SIZE)
+      return false;
+
+   *x                   = shared->shelf_x;
+   *y                   = shared->shelf_y;
+   shared->shelf_x     += width + 1;
+   shared->shelf_height = MAX(shared->shelf_height, height + 1);
+
+   return true;
+}
+
+static int sdf_font_atlas_find(sdf_font_atlas_t *shared, uint32_t code)
+{
+   int i;
+
+   for (i = shared->buckets[code & 0xFF]; i >= 0;
+         i = shared->glyphs[i].next)
+      if (shared->glyphs[i].code == code)
+         return i;
+
+   return -1;
+}
+
+static int sdf_font_atlas_add(sdf_font_atlas_t *shared, uint32_t code)
+{
+   sdf_font_glyph_t *glyph;
+   const struct font_atlas *src_atlas;
+   unsigned x = 0, y = 0, width = 0, height = 0;
+   const struct font_glyph *src = shared->driver->get_glyph(
+         shared->handle, code);
+
+   if (!src)
+      return -1;
+
+   /* Blank glyphs (spaces) take no room. */
+   if (src->width && src->height)
+   {
+      width  = (src->width  + SDF_FONT_OVERSAMPLE - 1)
+         / SDF_FONT_OVERSAMPLE + 2 * SDF_FONT_SPREAD;
+      height = (src->height + SDF_FONT_OVERSAMPLE - 1)
+         / SDF_FONT_OVERSAMPLE + 2 * SDF_FONT_SPREAD;
+   }
+
+   if (shared->num_glyphs >= SDF_FONT_MAX_GLYPHS
+         || (width && !sdf_font_atlas_alloc(shared, width, height, &x, &y)))
+   {
+      RARCH_LOG("[Font]: Distance field atlas is full, starting over.\n");
+      sdf_font_atlas_reset(shared);
+
+      /* Resetting doesn't touch the source renderer, src is fine. */
+      if (width && !sdf_font_atlas_alloc(shared, width, height, &x, &y))
+         return -1;
+   }
+
+   if (width)
+   {
+      src_atlas = shared->driver->get_atlas(shared->handle);
+
+      if (!sdf_font_build_field(
+               shared->buffer + y * SDF_FONT_ATLAS_SIZE + x,
+               SDF_FONT_ATLAS_SIZE, width, height,
+               src_atlas->buffer + src->atlas_offset_y * src_atlas->width
+               + src->atlas_offset_x,
+               src_atlas->width, src->width, src->height))
+         return -1;
+
+      sdf_font_atlas_mark_dirty(shared, x, y, width, height);
+   }
+
+   glyph                       = &shared->glyphs[shared->num_glyphs];
+   glyph->code                 = code;
+   glyph->x                    = x;
+   glyph->y                    = y;
+   glyph->width                = width;
+   glyph->height               = height;
+   glyph->draw_offset_x        = src->draw_offset_x;
+   glyph->draw_offset_y        = src->draw_offset_y;
+   glyph->advance_x            = src->advance_x;
+   glyph->advance_y            = src->advance_y;
+   glyph->next                 = shared->buckets[code & 0xFF];
+   shared->buckets[code & 0xFF] = shared->num_glyphs;
+
+   return shared->num_glyphs++;
+}
+
+static void sdf_font_atlas_free(sdf_font_atlas_t *shared)
+{
+   sdf_font_atlas_t **prev;
+
+   for (prev = &sdf_font_atlases; *prev; prev = &(*prev)->next)
+   {
+      if (*prev == shared)
+      {
+         *prev = shared->next;
+         break;
+      }
+   }
+
+   if (shared->driver && shared->handle)
+      shared->driver->free(shared->handle);
+
+   free(shared->font_path);
+   free(shared->buffer);
+   free(shared);
+}
+
+static sdf_font_atlas_t *sdf_font_atlas_get(const char *font_path)
+{
+   unsigned i;
+   sdf_font_atlas_t *shared;
+
+   for (shared = sdf_font_atlases; shared; shared = shared->next)
+      if (string_is_equal(shared->font_path, font_path ? font_path : ""))
+         return shared;
+
+   shared = (sdf_font_atlas_t*)calloc(1, sizeof(*shared));
+
+   if (!shared)
+      return NULL;
+
+   shared->font_path = strdup(font_path ? font_path : "");
+   shared->buffer    = (uint8_t*)calloc(
+         SDF_FONT_ATLAS_SIZE, SDF_FONT_ATLAS_SIZE);
+
+   if (!shared->font_path || !shared->buffer
+         || !font_renderer_create_default(&shared->driver, &shared->handle,
+            font_path, SDF_FONT_SIZE * SDF_FONT_OVERSAMPLE))
+   {
+      sdf_font_atlas_free(shared);
+      return NULL;
+   }
+
+   if (shared->driver->get_line_height)
+      shared->line_height = shared->driver->get_line_height(shared->handle);
+
+   memset(shared->buckets, -1, sizeof(shared->buckets));
+   shared->generation = 1;
+   shared->next       = sdf_font_atlases;
+   sdf_font_atlases   = shared;
+
+   for (i = ' '; i < 0x7f; i++)
+      sdf_font_atlas_add(shared, i);
+
+   return shared;
+}
+
+static void *font_renderer_sdf_init(const char *font_path, float font_size)
+{
+   sdf_font_renderer_t *self = NULL;
+   sdf_font_atlas_t *shared  = sdf_font_atlas_get(font_path);
+
+   if (!shared)
+      return NULL;
+
+   self = (sdf_font_renderer_t*)calloc(1, sizeof(*self));
+
+   if (!self)
+   {
+      if (!shared->views)
+         sdf_font_atlas_free(shared);
+      return NULL;
+   }
+
+   self->shared       = shared;
+   self->texel_scale  = font_size / SDF_FONT_SIZE;
+   self->metric_scale = font_size / (SDF_FONT_SIZE * SDF_FONT_OVERSAMPLE);
+
+   self->atlas.buffer = shared->buffer;
+   self->atlas.width  = SDF_FONT_ATLAS_SIZE;
+   self->atlas.height = SDF_FONT_ATLAS_SIZE;
+   self->atlas.dirty  = true;
+
+   self->next         = shared->views;
+   shared->views      = self;
+
+   return self;
+}
+
+static struct font_atlas *font_renderer_sdf_get_atlas(void *data)
+{
+   sdf_font_renderer_t *self = (sdf_font_renderer_t*)data;
+   return &self->atlas;
+}
+
+static const struct font_glyph *font_renderer_sdf_get_glyph(
+      void *data, uint32_t code)
+{
+   int i;
+   struct font_glyph *glyph;
+   const sdf_font_glyph_t *src;
+   sdf_font_renderer_t *self = (sdf_font_renderer_t*)data;
+
+   if (!self)
+      return NULL;
+
+   i = sdf_font_atlas_find(self->shared, code);
+
+   if (i < 0 && (i = sdf_font_atlas_add(self->shared, code)) < 0)
+      return NULL;
+
+   glyph = &self->glyphs[i];
+
+   if (self->glyph_generation[i] == self->shared->generation)
+      return glyph;
+
+   src                          = &self->shared->glyphs[i];
+   glyph->atlas_offset_x        = src->x;
+   glyph->atlas_offset_y        = src->y;
+   glyph->atlas_width           = src->width;
+   glyph->atlas_height          = src->height;
+   glyph->width                 = (unsigned)
+      (src->width  * self->texel_scale + 0.5f);
+   glyph->height                = (unsigned)
+      (src->height * self->texel_scale + 0.5f);
+   glyph->draw_offset_x         = (int)floorf(src->draw_offset_x
+         * self->metric_scale - SDF_FONT_SPREAD * self->texel_scale + 0.5f);
+   glyph->draw_offset_y         = (int)floorf(src->draw_offset_y
+         * self->metric_scale - SDF_FONT_SPREAD * self->texel_scale + 0.5f);
+   glyph->advance_x             = (int)floorf(src->advance_x
+         * self->metric_scale + 0.5f);
+   glyph->advance_y             = (int)floorf(src->advance_y
+         * self->metric_scale + 0.5f);
+
+   self->glyph_generation[i]    = self->shared->generation;
+
+   return glyph;
+}
+
+static void font_renderer_sdf_free(void *data)
+{
+   sdf_font_renderer_t **prev;
+   sdf_font_renderer_t *self = (sdf_font_renderer_t*)data;
+
+   if (!self)
+      return;
+
+   for (prev = &self->shared->views; *prev; prev = &(*prev)->next)
+   {
+      if (*prev == self)
+      {
+         *prev = self->next;
+         break;
+      }
+   }
+
+   if (!self->shared->views)
+      sdf_font_atlas_free(self->shared);
+
+   free(self);
+}
+
+static const char *font_renderer_sdf_get_default_font(void)
+{
+   /* The wrapped renderer picks one. */
+   return NULL;
+}
+
+static int font_renderer_sdf_get_line_height(void *data)
+{
+   sdf_font_renderer_t *self = (sdf_font_renderer_t*)data;
+   return (int)(self->shared->line_height * self->metric_scale + 0.5f);
+}
+
+font_renderer_driver_t sdf_font_renderer = {
+   font_renderer_sdf_init,
+   font_renderer_sdf_get_atlas,
+   font_renderer_sdf_get_glyph,
+   font_renderer_sdf_free,
+   font_renderer_sdf_get_default_font,
+   "sdf",
+   font_renderer_sdf_get_line_height,
+};
@@ -160,7 +160,9 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
    atlas_slot->glyph.draw_offset_y  = -y1 * self->scale_factor;
 
 
-   self->atlas.dirty = true;
+   font_atlas_mark_dirty(&self->atlas,
+         atlas_slot->glyph.atlas_offset_x, atlas_slot->glyph.atlas_offset_y,
+         self->max_glyph_width, self->max_glyph_height);
    atlas_slot->last_used = self->usage_counter++;
    return &atlas_slot->glyph;
 
@@ -286,6 +286,7 @@ gl_renderchain_driver_t gl1_renderchain = {
    NULL,                                  /* bind_backbuffer */
    NULL,                                  /* deinit_fbo */
    gl1_renderchain_read_viewport,
+   NULL,                                  /* read_hw_frame */
    NULL,                                  /* bind_prev_texture */
    gl1_renderchain_free_internal,
    gl1_renderchain_new,
@@ -297,6 +298,7 @@ gl_renderchain_driver_t gl1_renderchain = {
    NULL,                                  /* check_fbo_dimensions */
    NULL,                                  /* recompute_pass_sizes */
    gl1_renderchain_render,
+   NULL,                                  /* start_timer          */
    NULL,                                  /* resolve_extensions   */
    "gl1",
 };
@@ -49,6 +49,7 @@
 
 #include "../../driver.h"
 #include "../../configuration.h"
+#include "../../performance_counters.h"
 #include "../../verbosity.h"
 
 #define MAX_FENCES 4
@@ -67,6 +68,35 @@ typedef struct __GLsync *GLsync;
 #endif
 #endif
 
+#if (!defined(HAVE_OPENGLES) || defined(HAVE_OPENGLES3)) && !defined(HAVE_PSGL)
+#ifdef GL_PIXEL_UNPACK_BUFFER
+#define HAVE_GL_UPLOAD_PBO
+#endif
+#endif
+
+/* Frames in flight for the persistently mapped upload buffer */
+#define UPLOAD_PBO_SLOTS 3
+
+enum gl2_upload_mode
+{
+   GL2_UPLOAD_DIRECT = 0,
+   /* Orphan a pixel unpack buffer and map it every frame */
+   GL2_UPLOAD_ORPHAN,
+   /* Map one buffer once and cycle through its slots,
+    * a fence per slot keeps us from overwriting a frame
+    * the GPU hasn't copied yet */
+   GL2_UPLOAD_PERSISTENT
+};
+
+#ifndef HAVE_OPENGLES
+/* Frames the GPU may lag behind before the timer
+ * queries of a frame are read back */
+#define TIMER_QUERY_FRAMES 4
+/* A timestamp before the first pass and one after each
+ * pass, the last FBO being drawn to the back buffer */
+#define TIMER_QUERY_COUNT  (GFX_MAX_SHADERS + 2)
+#endif
+
 typedef struct gl2_renderchain
 {
    bool egl_images;
@@ -88,6 +118,23 @@ typedef struct gl2_renderchain
    GLsync fences[MAX_FENCES];
 #endif
 
+#ifdef HAVE_GL_UPLOAD_PBO
+   enum gl2_upload_mode upload_mode;
+   GLuint upload_pbo;
+   unsigned upload_index;
+   size_t upload_slot_size;
+   uint8_t *upload_map;
+   GLsync upload_fences[UPLOAD_PBO_SLOTS];
+#endif
+
+#ifndef HAVE_OPENGLES
+   bool has_timer_query;
+   unsigned timer_frame;
+   unsigned timer_written;
+   unsigned timer_counts[TIMER_QUERY_FRAMES];
+   GLuint timer_queries[TIMER_QUERY_FRAMES][TIMER_QUERY_COUNT];
+#endif
+
    struct gfx_fbo_scale fbo_scale[GFX_MAX_SHADERS];
 } gl2_renderchain_t;
 
@@ -231,9 +278,9 @@ static bool gl_recreate_fbo(
       )
 {
    gl2_bind_fb(fbo);
-   glDeleteTextures(1, texture);
+   gl_state_delete_textures(1, texture);
    glGenTextures(1, texture);
-   glBindTexture(GL_TEXTURE_2D, *texture);
+   gl_state_bind_texture(GL_TEXTURE_2D, *texture);
    gl_load_texture_image(GL_TEXTURE_2D,
          0, RARCH_GL_INTERNAL_FORMAT32,
          fbo_rect->width,
@@ -315,6 +362,85 @@ static void gl2_renderchain_check_fbo_dimensions(
    }
 }
 
+#ifndef HAVE_OPENGLES
+static void gl2_renderchain_timestamp(gl2_renderchain_t *chain)
+{
+   if (!chain->has_timer_query || !chain->timer_written
+         || chain->timer_written >= TIMER_QUERY_COUNT)
+      return;
+
+   glQueryCounter(chain->timer_queries[chain->timer_frame]
+         [chain->timer_written++], GL_TIMESTAMP);
+}
+
+/* Reads back the timestamps of the oldest frame in the ring,
+ * unless the GPU hasn't got that far yet. */
+static void gl2_renderchain_read_timer(gl2_renderchain_t *chain)
+{
+   unsigned i;
+   GLuint available;
+   video_shader_ctx_t shader_info;
+   GLuint64 ts[TIMER_QUERY_COUNT];
+   uint32_t times[TIMER_QUERY_COUNT];
+   const char *names[TIMER_QUERY_COUNT];
+   unsigned count  = chain->timer_counts[chain->timer_frame];
+   GLuint *queries = chain->timer_queries[chain->timer_frame];
+
+   chain->timer_counts[chain->timer_frame] = 0;
+
+   if (count < 2)
+      return;
+
+   available = 0;
+   glGetQueryObjectuiv(queries[count - 1],
+         GL_QUERY_RESULT_AVAILABLE, &available);
+   if (!available)
+      return;
+
+   for (i = 0; i < count; i++)
+      glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ts[i]);
+
+   shader_info.data = NULL;
+   video_shader_driver_get_current_shader(&shader_info);
+
+   for (i = 0; i < count - 1; i++)
+   {
+      times[i] = ts[i + 1] > ts[i]
+         ? (uint32_t)((ts[i + 1] - ts[i]) / 1000) : 0;
+      names[i] = NULL;
+      if (shader_info.data && i < shader_info.data->passes)
+         names[i] = shader_info.data->pass[i].alias;
+   }
+
+   performance_gpu_passes_submit(names, times, count - 1);
+}
+
+static void gl2_renderchain_start_timer(gl_t *gl, void *chain_data)
+{
+   gl2_renderchain_t *chain = (gl2_renderchain_t*)chain_data;
+
+   if (!chain->has_timer_query)
+      return;
+
+   gl2_renderchain_read_timer(chain);
+
+   chain->timer_written = 0;
+   glQueryCounter(chain->timer_queries[chain->timer_frame][0],
+         GL_TIMESTAMP);
+   chain->timer_written = 1;
+}
+
+static void gl2_renderchain_end_timer(gl2_renderchain_t *chain)
+{
+   if (!chain->has_timer_query || !chain->timer_written)
+      return;
+
+   chain->timer_counts[chain->timer_frame] = chain->timer_written;
+   chain->timer_written                    = 0;
+   chain->timer_frame = (chain->timer_frame + 1) % TIMER_QUERY_FRAMES;
+}
+#endif
+
 static void gl2_renderchain_render(
       gl_t *gl,
       void *chain_data,
@@ -339,6 +465,10 @@ static void gl2_renderchain_render(
    unsigned width                         = video_info->width;
    unsigned height                        = video_info->height;
 
+#ifndef HAVE_OPENGLES
+   gl2_renderchain_timestamp(chain);
+#endif
+
    /* Render the rest of our passes. */
    gl->coords.tex_coord      = fbo_tex_coords;
 
@@ -373,7 +503,7 @@ static void gl2_renderchain_render(
       shader_info.set_active = true;
 
       video_shader_driver_use(&shader_info);
-      glBindTexture(GL_TEXTURE_2D, chain->fbo_texture[i - 1]);
+      gl_state_bind_texture(GL_TEXTURE_2D, chain->fbo_texture[i - 1]);
 
       mip_level = i + 1;
 
@@ -414,6 +544,10 @@ static void gl2_renderchain_render(
             video_info->shader_data, &gl->mvp);
 
       glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+#ifndef HAVE_OPENGLES
+      gl2_renderchain_timestamp(chain);
+#endif
    }
 
 #if defined(GL_FRAMEBUFFER_SRGB) && !defined(HAVE_OPENGLES)
@@ -448,7 +582,7 @@ static void gl2_renderchain_render(
 
    video_shader_driver_use(&shader_info);
 
-   glBindTexture(GL_TEXTURE_2D, chain->fbo_texture[chain->fbo_pass - 1]);
+   gl_state_bind_texture(GL_TEXTURE_2D, chain->fbo_texture[chain->fbo_pass - 1]);
 
    mip_level = chain->fbo_pass + 1;
 
@@ -490,6 +624,11 @@ static void gl2_renderchain_render(
 
    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
+#ifndef HAVE_OPENGLES
+   gl2_renderchain_timestamp(chain);
+   gl2_renderchain_end_timer(chain);
+#endif
+
    gl->coords.tex_coord = gl->tex_info.coord;
 }
 
@@ -503,7 +642,7 @@ static void gl2_renderchain_deinit_fbo(gl_t *gl,
       if (gl->fbo_feedback)
          gl2_delete_fb(1, &gl->fbo_feedback);
       if (gl->fbo_feedback_texture)
-         glDeleteTextures(1, &gl->fbo_feedback_texture);
+         gl_state_delete_textures(1, &gl->fbo_feedback_texture);
 
       gl->fbo_inited           = false;
       gl->fbo_feedback_enable  = false;
@@ -515,7 +654,7 @@ static void gl2_renderchain_deinit_fbo(gl_t *gl,
    if (chain)
    {
       gl2_delete_fb(chain->fbo_pass, chain->fbo);
-      glDeleteTextures(chain->fbo_pass, chain->fbo_texture);
+      gl_state_delete_textures(chain->fbo_pass, chain->fbo_texture);
 
       memset(chain->fbo_texture, 0, sizeof(chain->fbo_texture));
       memset(chain->fbo,         0, sizeof(chain->fbo));
@@ -543,10 +682,192 @@ static void gl2_renderchain_deinit_hw_render(
    context_bind_hw_render(gl, false);
 }
 
+#ifdef HAVE_GL_UPLOAD_PBO
+static void gl2_renderchain_deinit_upload_pbo(gl2_renderchain_t *chain)
+{
+   unsigned i;
+
+   for (i = 0; i < UPLOAD_PBO_SLOTS; i++)
+   {
+      if (chain->upload_fences[i])
+         glDeleteSync(chain->upload_fences[i]);
+      chain->upload_fences[i] = NULL;
+   }
+
+   if (chain->upload_pbo)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, chain->upload_pbo);
+      if (chain->upload_map)
+         glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers(1, &chain->upload_pbo);
+   }
+
+   chain->upload_pbo       = 0;
+   chain->upload_map       = NULL;
+   chain->upload_index     = 0;
+   chain->upload_slot_size = 0;
+}
+
+static bool gl2_renderchain_init_upload_pbo(gl2_renderchain_t *chain,
+      size_t slot_size)
+{
+   glGenBuffers(1, &chain->upload_pbo);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, chain->upload_pbo);
+
+#if !defined(HAVE_OPENGLES) && defined(GL_MAP_PERSISTENT_BIT)
+   if (chain->upload_mode == GL2_UPLOAD_PERSISTENT)
+   {
+      GLbitfield flags = GL_MAP_WRITE_BIT
+         | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER,
+            slot_size * UPLOAD_PBO_SLOTS, NULL, flags);
+      chain->upload_map = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+            0, slot_size * UPLOAD_PBO_SLOTS, flags);
+   }
+   else
+#endif
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, slot_size, NULL, GL_STREAM_DRAW);
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   chain->upload_slot_size = slot_size;
+
+   if (chain->upload_mode == GL2_UPLOAD_PERSISTENT && !chain->upload_map)
+   {
+      gl2_renderchain_deinit_upload_pbo(chain);
+      return false;
+   }
+
+   return true;
+}
+
+/* Copies the frame, converting it to 32-bit if @convert is set,
+ * into a pixel unpack buffer and uploads the texture from there.
+ * The driver can then copy the frame to the texture whenever it
+ * likes instead of stalling glTexSubImage2D on a client pointer.
+ *
+ * Returns false if the caller has to upload the frame itself. */
+static bool gl2_renderchain_upload_pbo(gl_t *gl,
+      gl2_renderchain_t *chain,
+      const void *frame, unsigned width, unsigned height,
+      unsigned pitch, bool convert)
+{
+   uint8_t *dst           = NULL;
+   size_t offset          = 0;
+   size_t line_bytes      = width * (convert
+         ? sizeof(uint32_t) : gl->base_size);
+   size_t slot_size       = ((size_t)gl->tex_w * gl->tex_h
+         * sizeof(uint32_t) + 63) & ~(size_t)63;
+
+   if (chain->upload_mode == GL2_UPLOAD_DIRECT)
+      return false;
+
+   if (chain->upload_slot_size != slot_size)
+   {
+      gl2_renderchain_deinit_upload_pbo(chain);
+
+      if (!gl2_renderchain_init_upload_pbo(chain, slot_size))
+      {
+         RARCH_WARN("[GL]: Failed to map the upload buffer, "
+               "uploading frames directly.\n");
+         chain->upload_mode = GL2_UPLOAD_DIRECT;
+         return false;
+      }
+   }
+
+   if (line_bytes * height > slot_size)
+      return false;
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, chain->upload_pbo);
+
+   if (chain->upload_mode == GL2_UPLOAD_PERSISTENT)
+   {
+      unsigned index      = (chain->upload_index + 1) % UPLOAD_PBO_SLOTS;
+      chain->upload_index = index;
+      offset              = index * slot_size;
+
+      if (chain->upload_fences[index])
+      {
+         glClientWaitSync(chain->upload_fences[index],
+               GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+         glDeleteSync(chain->upload_fences[index]);
+         chain->upload_fences[index] = NULL;
+      }
+
+      dst = chain->upload_map + offset;
+   }
+   else
+   {
+      /* Orphan the old storage, the driver hands us fresh
+       * memory while the GPU still reads the last frame. */
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, slot_size, NULL, GL_STREAM_DRAW);
+      dst = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+            0, line_bytes * height,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+      if (!dst)
+      {
+         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+         return false;
+      }
+   }
+
+   if (convert)
+      video_frame_convert_rgb16_to_rgb32(
+            &gl->scaler, dst, frame, width, height, pitch);
+   else if (pitch == line_bytes)
+      memcpy(dst, frame, line_bytes * height);
+   else
+   {
+      unsigned h;
+      const uint8_t *src = (const uint8_t*)frame;
+
+      for (h = 0; h < height; h++, src += pitch, dst += line_bytes)
+         memcpy(dst, src, line_bytes);
+   }
+
+   if (chain->upload_mode == GL2_UPLOAD_ORPHAN)
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, video_pixel_get_alignment(line_bytes));
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glTexSubImage2D(GL_TEXTURE_2D,
+         0, 0, 0, width, height, gl->texture_type,
+         gl->texture_fmt, (const GLvoid*)offset);
+
+   if (chain->upload_mode == GL2_UPLOAD_PERSISTENT)
+      chain->upload_fences[chain->upload_index] =
+         glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   return true;
+}
+#endif
+
 static void gl2_renderchain_free(gl_t *gl, void *chain_data)
 {
+#ifdef HAVE_GL_UPLOAD_PBO
+   gl2_renderchain_deinit_upload_pbo((gl2_renderchain_t*)chain_data);
+#endif
    gl2_renderchain_deinit_fbo(gl, chain_data);
    gl2_renderchain_deinit_hw_render(gl, chain_data);
+
+#ifndef HAVE_OPENGLES
+   if (chain_data && ((gl2_renderchain_t*)chain_data)->has_timer_query)
+   {
+      gl2_renderchain_t *chain = (gl2_renderchain_t*)chain_data;
+
+      glDeleteQueries(TIMER_QUERY_FRAMES * TIMER_QUERY_COUNT,
+            &chain->timer_queries[0][0]);
+      memset(chain->timer_counts, 0, sizeof(chain->timer_counts));
+      chain->has_timer_query = false;
+      chain->timer_written   = 0;
+      performance_gpu_passes_clear();
+   }
+#endif
 }
 
 static bool gl_create_fbo_targets(gl_t *gl, void *chain_data)
@@ -554,7 +875,7 @@ static bool gl_create_fbo_targets(gl_t *gl, void *chain_data)
    int i;
    gl2_renderchain_t *chain = (gl2_renderchain_t*)chain_data;
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+   gl_state_bind_texture(GL_TEXTURE_2D, 0);
    gl2_gen_fb(chain->fbo_pass, chain->fbo);
 
    for (i = 0; i < chain->fbo_pass; i++)
@@ -723,7 +1044,7 @@ static void gl_create_fbo_textures(gl_t *gl, gl2_renderchain_t *chain)
             gl->fbo_feedback_pass, gl->fbo_feedback_texture);
    }
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+   gl_state_bind_texture(GL_TEXTURE_2D, 0);
 }
 
 /* Compute FBO geometry.
@@ -810,7 +1131,7 @@ static void gl2_renderchain_start_render(
    };
    gl2_renderchain_t *chain = (gl2_renderchain_t*)chain_data;
 
-   glBindTexture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
+   gl_state_bind_texture(GL_TEXTURE_2D, gl->texture[gl->tex_index]);
    gl2_bind_fb(chain->fbo[0]);
 
    gl_set_viewport(gl,
@@ -931,7 +1252,7 @@ void gl2_renderchain_init(
    gl_create_fbo_textures(gl, chain);
    if (!gl || !gl_create_fbo_targets(gl, chain))
    {
-      glDeleteTextures(chain->fbo_pass, chain->fbo_texture);
+      gl_state_delete_textures(chain->fbo_pass, chain->fbo_texture);
       RARCH_ERR("[GL]: Failed to create FBO targets. Will continue without FBO.\n");
       return;
    }
@@ -969,7 +1290,7 @@ static bool gl2_renderchain_init_hw_render(
 
    RARCH_LOG("[GL]: Supports FBO (render-to-texture).\n");
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+   gl_state_bind_texture(GL_TEXTURE_2D, 0);
    gl2_gen_fb(gl->textures, gl->hw_render_fbo);
 
    depth   = hwr->depth;
@@ -1169,6 +1490,53 @@ error:
    return false;
 }
 
+/* The core's framebuffer holds the frame at its own resolution,
+ * without shaders applied, so it can be read right away. There is
+ * no need to render the cached frame again like read_viewport. */
+static bool gl2_renderchain_read_hw_frame(
+      gl_t *gl,
+      void *chain_data,
+      uint8_t *buffer,
+      unsigned width, unsigned height)
+{
+   unsigned y;
+   uint8_t *rgba                         = NULL;
+   struct retro_hw_render_callback *hwr  = video_driver_get_hw_context();
+
+   if (!gl || !gl->hw_render_fbo_init || !width || !height)
+      return false;
+
+   rgba = (uint8_t*)malloc(width * height * sizeof(uint32_t));
+   if (!rgba)
+      return false;
+
+   context_bind_hw_render(gl, false);
+
+   /* GLES2 only guarantees GL_RGBA/GL_UNSIGNED_BYTE readbacks */
+   gl2_bind_fb(gl->hw_render_fbo[gl->tex_index]);
+   glPixelStorei(GL_PACK_ALIGNMENT, 4);
+   glReadPixels(0, 0, width, height,
+         GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+   gl2_renderchain_bind_backbuffer(gl, chain_data);
+
+   context_bind_hw_render(gl, true);
+
+   /* Cores rendering with a top-left origin have the
+    * rows the other way around. */
+   for (y = 0; y < height; y++)
+   {
+      unsigned row = hwr && !hwr->bottom_left_origin ? height - 1 - y : y;
+
+      video_frame_convert_rgba_to_bgr(
+            rgba   + row * width * sizeof(uint32_t),
+            buffer + y   * width * 3,
+            width);
+   }
+
+   free(rgba);
+   return true;
+}
+
 void gl2_renderchain_free_internal(void *data, void *chain_data)
 {
    gl2_renderchain_t *chain = (gl2_renderchain_t*)chain_data;
@@ -1195,13 +1563,13 @@ static void gl2_renderchain_bind_vao(void *data,
    gl2_renderchain_t *chain = (gl2_renderchain_t*)chain_data;
    if (!chain)
       return;
-   glBindVertexArray(chain->vao);
+   gl_state_bind_vertex_array(chain->vao);
 }
 
 static void gl2_renderchain_unbind_vao(void *data,
       void *chain_data)
 {
-   glBindVertexArray(0);
+   gl_state_bind_vertex_array(0);
 }
 
 static void gl2_renderchain_new_vao(void *data,
@@ -1220,6 +1588,7 @@ static void gl2_renderchain_free_vao(void *data,
    if (!chain)
       return;
    glDeleteVertexArrays(1, &chain->vao);
+   gl_state_invalidate();
 }
 #endif
 
@@ -1294,6 +1663,13 @@ static void gl2_renderchain_copy_frame(
          glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, (GLeglImageOES)img);
    }
    else
+#endif
+#ifdef HAVE_GL_UPLOAD_PBO
+   if (!(gl->base_size == 4 && video_info->use_rgba) &&
+         gl2_renderchain_upload_pbo(gl, chain,
+            frame, width, height, pitch, false))
+      return;
+   else
 #endif
    {
       glPixelStorei(GL_UNPACK_ALIGNMENT,
@@ -1348,6 +1724,12 @@ static void gl2_renderchain_copy_frame(
       }
    }
 #else
+#ifdef HAVE_GL_UPLOAD_PBO
+   if (gl2_renderchain_upload_pbo(gl, chain, frame, width, height, pitch,
+            gl->base_size == 2 && !gl->have_es2_compat))
+      return;
+#endif
+
    {
       const GLvoid *data_buf = frame;
       glPixelStorei(GL_UNPACK_ALIGNMENT, video_pixel_get_alignment(pitch));
@@ -1511,6 +1893,34 @@ static void gl2_renderchain_resolve_extensions(gl_t *gl,
    /* Use regular textures if we use HW render. */
    chain->egl_images                = !gl->hw_render_use && gl_check_capability(GL_CAPS_EGLIMAGE) &&
       video_context_driver_init_image_buffer(video);
+
+#ifdef HAVE_GL_UPLOAD_PBO
+   chain->upload_mode               = GL2_UPLOAD_DIRECT;
+
+   if (!gl->hw_render_use && !chain->egl_images)
+   {
+#if !defined(HAVE_OPENGLES) && defined(GL_MAP_PERSISTENT_BIT)
+      if (gl_check_capability(GL_CAPS_BUFFER_STORAGE) &&
+            gl_check_capability(GL_CAPS_SYNC))
+         chain->upload_mode         = GL2_UPLOAD_PERSISTENT;
+      else
+#endif
+      if (gl_check_capability(GL_CAPS_MAP_BUFFER_RANGE))
+         chain->upload_mode         = GL2_UPLOAD_ORPHAN;
+   }
+
+   if (chain->upload_mode == GL2_UPLOAD_PERSISTENT)
+      RARCH_LOG("[GL]: Uploading frames through a persistently mapped buffer.\n");
+   else if (chain->upload_mode == GL2_UPLOAD_ORPHAN)
+      RARCH_LOG("[GL]: Uploading frames through an orphaned pixel buffer.\n");
+#endif
+
+#ifndef HAVE_OPENGLES
+   chain->has_timer_query           = gl_check_capability(GL_CAPS_TIMER_QUERY);
+   if (chain->has_timer_query)
+      glGenQueries(TIMER_QUERY_FRAMES * TIMER_QUERY_COUNT,
+            &chain->timer_queries[0][0]);
+#endif
 }
 
 gl_renderchain_driver_t gl2_renderchain = {
@@ -1553,6 +1963,7 @@ gl_renderchain_driver_t gl2_renderchain = {
    gl2_renderchain_bind_backbuffer,
    gl2_renderchain_deinit_fbo,
    gl2_renderchain_read_viewport,
+   gl2_renderchain_read_hw_frame,
    gl2_renderchain_bind_prev_texture,
    gl2_renderchain_free_internal,
    gl2_renderchain_new,
@@ -1564,6 +1975,11 @@ gl_renderchain_driver_t gl2_renderchain = {
    gl2_renderchain_check_fbo_dimensions,
    gl2_renderchain_recompute_pass_sizes,
    gl2_renderchain_render,
+#ifdef HAVE_OPENGLES
+   NULL,
+#else
+   gl2_renderchain_start_timer,
+#endif
    gl2_renderchain_resolve_extensions,
    "gl2",
 };
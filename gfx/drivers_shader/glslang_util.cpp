@@ -20,6 +20,7 @@
 #include <algorithm>
 
 #include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <lists/string_list.h>
@@ -29,15 +30,90 @@
 #include "config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "glslang_util.h"
 #if defined(HAVE_GLSLANG)
 #include <glslang.hpp>
 #endif
+#include "../video_shader_parse.h"
+#include "../../managers/memory_budget.h"
 #include "../../verbosity.h"
 
 using namespace std;
 
-bool glslang_read_shader_file(const char *path, vector<string> *output, bool root_file)
+/* Preprocessed sources of recently read root shader files. Presets
+ * are reloaded on every shader menu preview and parameters are
+ * resolved again after that, each of which used to read and split
+ * the pass and all its #includes. An entry is reused while every
+ * file it was built from keeps its size and mtime. */
+#define GLSLANG_SOURCE_CACHE_SIZE 16
+
+struct glslang_source_file
+{
+   string path;
+   int64_t mtime;
+   int32_t size;
+};
+
+struct glslang_source_cache_entry
+{
+   string path;
+   vector<glslang_source_file> files;
+   vector<string> lines;
+   size_t bytes;
+   unsigned last_used;
+};
+
+static vector<glslang_source_cache_entry> glslang_source_cache;
+static unsigned glslang_source_cache_clock;
+static unsigned glslang_source_cache_budget_id;
+
+#ifdef HAVE_THREADS
+/* Passes are read from the video thread, parameters from the menu */
+static slock_t *glslang_source_cache_lock(void)
+{
+   static slock_t *lock = slock_new();
+   return lock;
+}
+#endif
+
+static size_t glslang_source_cache_bytes(void)
+{
+   size_t bytes = 0;
+
+   for (auto &entry : glslang_source_cache)
+      bytes += entry.bytes;
+
+   return bytes;
+}
+
+/* The entries are small next to a texture, so whatever the budget
+ * wants, all of them go. */
+static size_t glslang_source_cache_budget_evict(void *userdata, size_t want)
+{
+   size_t freed;
+
+#ifdef HAVE_THREADS
+   slock_lock(glslang_source_cache_lock());
+#endif
+
+   freed = glslang_source_cache_bytes();
+   glslang_source_cache.clear();
+   memory_budget_update(glslang_source_cache_budget_id, 0);
+
+#ifdef HAVE_THREADS
+   slock_unlock(glslang_source_cache_lock());
+#endif
+
+   return freed;
+}
+
+static bool glslang_read_shader_file_internal(const char *path,
+      vector<string> *output, bool root_file,
+      vector<glslang_source_file> *files)
 {
    vector<const char *> lines;
    char include_path[PATH_MAX_LENGTH];
@@ -49,6 +125,17 @@ bool glslang_read_shader_file(const char *path, vector<string> *output, bool roo
 
    include_path[0] = tmp[0] = '\0';
 
+   /* Stat before reading, so a write racing with us
+    * shows up as a change next time. */
+   if (files)
+   {
+      glslang_source_file file;
+
+      file.path = path;
+      path_get_size_mtime(path, &file.size, &file.mtime);
+      files->push_back(file);
+   }
+
    if (!filestream_read_file(path, (void**)&buf, &len))
    {
       RARCH_ERR("Failed to open shader file: \"%s\".\n", path);
@@ -135,7 +222,8 @@ bool glslang_read_shader_file(const char *path, vector<string> *output, bool roo
 
          fill_pathname_resolve_relative(include_path, path, c, sizeof(include_path));
 
-         if (!glslang_read_shader_file(include_path, output, false))
+         if (!glslang_read_shader_file_internal(include_path,
+                  output, false, files))
             goto error;
 
          /* After including a file, use line directive 
@@ -166,6 +254,111 @@ error:
    return false;
 }
 
+static bool glslang_source_cache_find(const char *path, vector<string> *output)
+{
+   for (auto &entry : glslang_source_cache)
+   {
+      if (entry.path != path)
+         continue;
+
+      for (auto &file : entry.files)
+      {
+         int32_t size  = 0;
+         int64_t mtime = 0;
+
+         if (     !path_get_size_mtime(file.path.c_str(), &size, &mtime)
+               || size  != file.size
+               || mtime != file.mtime)
+            return false;
+      }
+
+      output->insert(output->end(), entry.lines.begin(), entry.lines.end());
+      entry.last_used = ++glslang_source_cache_clock;
+      return true;
+   }
+
+   return false;
+}
+
+static void glslang_source_cache_store(const char *path,
+      vector<glslang_source_file> &files, const vector<string> &lines)
+{
+   glslang_source_cache_entry *slot = nullptr;
+
+   for (auto &entry : glslang_source_cache)
+   {
+      if (entry.path == path)
+      {
+         slot = &entry;
+         break;
+      }
+
+      if (!slot || entry.last_used < slot->last_used)
+         slot = &entry;
+   }
+
+   if (     glslang_source_cache.size() < GLSLANG_SOURCE_CACHE_SIZE
+         && (!slot || slot->path != path))
+   {
+      glslang_source_cache.push_back(glslang_source_cache_entry());
+      slot = &glslang_source_cache.back();
+   }
+
+   slot->path      = path;
+   slot->files.swap(files);
+   slot->lines     = lines;
+   slot->bytes     = slot->path.size();
+   slot->last_used = ++glslang_source_cache_clock;
+
+   for (auto &line : slot->lines)
+      slot->bytes += sizeof(line) + line.capacity();
+
+   if (!glslang_source_cache_budget_id)
+      glslang_source_cache_budget_id = memory_budget_register(
+            "shader sources", glslang_source_cache_budget_evict, nullptr);
+   memory_budget_update(glslang_source_cache_budget_id,
+         glslang_source_cache_bytes());
+}
+
+bool glslang_read_shader_file(const char *path, vector<string> *output, bool root_file)
+{
+   bool ret;
+   vector<glslang_source_file> files;
+   vector<string> lines;
+
+   if (!root_file)
+      return glslang_read_shader_file_internal(path, output, false, nullptr);
+
+#ifdef HAVE_THREADS
+   slock_lock(glslang_source_cache_lock());
+#endif
+
+   ret = glslang_source_cache_find(path, output);
+
+#ifdef HAVE_THREADS
+   slock_unlock(glslang_source_cache_lock());
+#endif
+
+   if (ret)
+      return true;
+
+   if (!glslang_read_shader_file_internal(path, &lines, true, &files))
+      return false;
+
+#ifdef HAVE_THREADS
+   slock_lock(glslang_source_cache_lock());
+#endif
+
+   glslang_source_cache_store(path, files, lines);
+
+#ifdef HAVE_THREADS
+   slock_unlock(glslang_source_cache_lock());
+#endif
+
+   output->insert(output->end(), lines.begin(), lines.end());
+   return true;
+}
+
 static string build_stage_source(const vector<string> &lines, const char *stage)
 {
    ostringstream str;
@@ -379,11 +572,112 @@ bool glslang_parse_meta(const vector<string> &lines, glslang_meta *meta)
 
 
 #if defined(HAVE_GLSLANG)
+/* Compiled SPIR-V is cached on disk, keyed by the shader source
+ * with all includes resolved. The file is named after the CRC
+ * of that source and also stores the source itself, so a CRC
+ * collision just means a cache miss.
+ *
+ * Layout, all native endian:
+ *    uint32_t magic, version, source size,
+ *             vertex words, fragment words
+ *    source, vertex SPIR-V, fragment SPIR-V
+ *
+ * Bump the version whenever glslang is updated. */
+#define GLSLANG_CACHE_MAGIC   0x43565053 /* "SPVC" */
+#define GLSLANG_CACHE_VERSION 1
+
+static bool glslang_cache_path(const string &source, char *s, size_t len)
+{
+   char dir[PATH_MAX_LENGTH];
+   char name[16];
+
+   dir[0] = name[0] = '\0';
+
+   if (!video_shader_get_cache_dir(dir, sizeof(dir)))
+      return false;
+
+   snprintf(name, sizeof(name), "%08x.spv",
+         (unsigned)encoding_crc32(0,
+            (const uint8_t*)source.data(), source.size()));
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+static bool glslang_cache_read(const char *path,
+      const string &source, glslang_output *output)
+{
+   uint32_t header[5];
+   void *buf       = NULL;
+   int64_t len     = 0;
+   bool ret        = false;
+   const uint8_t *data;
+
+   if (!path_is_valid(path) || !filestream_read_file(path, &buf, &len))
+      return false;
+
+   data = (const uint8_t*)buf;
+
+   if ((size_t)len < sizeof(header))
+      goto end;
+
+   memcpy(header, data, sizeof(header));
+
+   if (     header[0] != GLSLANG_CACHE_MAGIC
+         || header[1] != GLSLANG_CACHE_VERSION
+         || header[2] != source.size()
+         || (size_t)len != sizeof(header) + header[2]
+            + ((size_t)header[3] + header[4]) * sizeof(uint32_t)
+         || memcmp(data + sizeof(header), source.data(), source.size()))
+      goto end;
+
+   data += sizeof(header) + header[2];
+   output->vertex.resize(header[3]);
+   output->fragment.resize(header[4]);
+   memcpy(output->vertex.data(), data, header[3] * sizeof(uint32_t));
+   data += header[3] * sizeof(uint32_t);
+   memcpy(output->fragment.data(), data, header[4] * sizeof(uint32_t));
+
+   ret = true;
+
+end:
+   free(buf);
+   return ret;
+}
+
+static void glslang_cache_write(const char *path,
+      const string &source, const glslang_output *output)
+{
+   uint32_t header[5];
+   string data;
+
+   header[0] = GLSLANG_CACHE_MAGIC;
+   header[1] = GLSLANG_CACHE_VERSION;
+   header[2] = source.size();
+   header[3] = output->vertex.size();
+   header[4] = output->fragment.size();
+
+   data.reserve(sizeof(header) + source.size()
+         + (output->vertex.size() + output->fragment.size())
+         * sizeof(uint32_t));
+   data.append((const char*)header, sizeof(header));
+   data.append(source);
+   data.append((const char*)output->vertex.data(),
+         output->vertex.size() * sizeof(uint32_t));
+   data.append((const char*)output->fragment.data(),
+         output->fragment.size() * sizeof(uint32_t));
+
+   if (!filestream_write_file(path, data.data(), data.size()))
+      RARCH_WARN("[slang]: Failed to write shader cache \"%s\".\n", path);
+}
+
 bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
+   char cache_path[PATH_MAX_LENGTH];
    vector<string> lines;
+   string source;
+   bool cached = false;
 
-   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+   cache_path[0] = '\0';
 
    if (!glslang_read_shader_file(shader_path, &lines, true))
       return false;
@@ -391,6 +685,23 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
    if (!glslang_parse_meta(lines, &output->meta))
       return false;
 
+   for (auto &line : lines)
+   {
+      source += line;
+      source += '\n';
+   }
+
+   if (glslang_cache_path(source, cache_path, sizeof(cache_path)))
+      cached = glslang_cache_read(cache_path, source, output);
+
+   if (cached)
+   {
+      RARCH_LOG("[slang]: Using cached shader \"%s\".\n", shader_path);
+      return true;
+   }
+
+   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+
    if (    !glslang::compile_spirv(build_stage_source(lines, "vertex"),
             glslang::StageVertex, &output->vertex))
    {
@@ -405,6 +716,9 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
       return false;
    }
 
+   if (*cache_path)
+      glslang_cache_write(cache_path, source, output);
+
    return true;
 }
 #else
@@ -398,6 +398,9 @@ static void gl_cg_set_params(void *dat, void *shader_data)
       cg_gl_set_param_1f(param_f, cg->shader->parameters[i].current);
    }
 
+   /* Cg picks the texture units and binds them itself. */
+   gl_state_invalidate();
+
    /* Set state parameters. */
    if (cg->state_tracker)
    {
@@ -462,7 +465,7 @@ static void gl_cg_destroy_resources(void *data)
 
    if (cg->shader && cg->shader->luts)
    {
-      glDeleteTextures(cg->shader->luts, cg->lut_textures);
+      gl_state_delete_textures(cg->shader->luts, cg->lut_textures);
       memset(cg->lut_textures, 0, sizeof(cg->lut_textures));
    }
 
@@ -825,7 +828,7 @@ static bool gl_cg_load_luts(
          return false;
    }
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+   gl_state_bind_texture(GL_TEXTURE_2D, 0);
    return true;
 }
 
@@ -1193,6 +1196,7 @@ static void gl_cg_use(void *data, void *shader_data, unsigned idx, bool set_acti
       }
 
       gl_cg_set_shaders(cg->prg[idx].fprg, cg->prg[idx].vprg);
+      gl_state_invalidate();
    }
 }
 
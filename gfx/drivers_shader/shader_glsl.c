@@ -65,6 +65,43 @@ struct glsl_attrib
    GLsizei offset;
 };
 
+/* Must be a power of two */
+#define GLSL_VERTEX_CACHE_ENTRIES 1024
+#define GLSL_VERTEX_CACHE_FLOATS  (64 * 1024)
+
+/* Vertex data passed to set_coords (menu, overlay and font draws) is
+ * appended to one buffer and looked up by content, so geometry which
+ * stays the same from frame to frame is only uploaded once. The
+ * buffer is orphaned and the cache emptied when it fills up. */
+struct glsl_vertex_cache
+{
+   GLuint vbo;
+   size_t used;
+   GLfloat *shadow;
+   struct
+   {
+      uint32_t hash;
+      uint32_t elems;
+      uint32_t offset;
+   } entries[GLSL_VERTEX_CACHE_ENTRIES];
+};
+
+/* Must be a power of two */
+#define GLSL_UNIFORM_CACHE_SIZE 256
+
+/* Uniform values are program state, so anything set_params
+ * uploads is remembered per program and location, and only
+ * sent again when it changes. */
+struct glsl_uniform_cache
+{
+   struct
+   {
+      GLint loc;
+      GLenum type;
+      GLfloat value[2];
+   } slots[GLSL_UNIFORM_CACHE_SIZE];
+};
+
 static gfx_ctx_proc_t (*glsl_get_proc_address)(const char*);
 
 struct shader_uniforms_frame
@@ -91,6 +128,8 @@ struct shader_uniforms
    int frame_direction;
 
    int lut_texture[GFX_MAX_TEXTURES];
+   int parameter[GFX_MAX_PARAMETERS];
+   int state[GFX_MAX_VARIABLES];
    unsigned frame_count_mod;
 
    struct shader_uniforms_frame orig;
@@ -115,6 +154,9 @@ static const char *glsl_prefixes[] = {
 #include "../drivers/gl_shaders/modern_alpha_blend.glsl.frag.h"
 #include "../drivers/gl_shaders/core_alpha_blend.glsl.vert.h"
 #include "../drivers/gl_shaders/core_alpha_blend.glsl.frag.h"
+#include "../drivers/gl_shaders/modern_font_sdf.glsl.frag.h"
+#include "../drivers/gl_shaders/core_font_sdf.glsl.frag.h"
+#include "../drivers/gl_shaders/softfilter.glsl.h"
 
 #ifdef HAVE_SHADERPIPELINE
 #include "../drivers/gl_shaders/core_pipeline_snow.glsl.frag.h"
@@ -144,12 +186,15 @@ typedef struct glsl_shader_data
    GLint attribs_elems[32 * PREV_TEXTURES + 2 + 4 + GFX_MAX_SHADERS];
    unsigned attribs_index;
    unsigned active_idx;
+   unsigned softfilter_passes;
    unsigned current_idx;
    GLuint lut_textures[GFX_MAX_TEXTURES];
    float  current_mat_data[GFX_MAX_SHADERS];
    float* current_mat_data_pointer[GFX_MAX_SHADERS];
    struct shader_uniforms uniforms[GFX_MAX_SHADERS];
    struct cache_vbo vbo[GFX_MAX_SHADERS];
+   struct glsl_vertex_cache vertex_cache;
+   struct glsl_uniform_cache uniform_cache[GFX_MAX_SHADERS];
    struct shader_program_glsl_data prg[GFX_MAX_SHADERS];
    struct video_shader *shader;
    state_tracker_t *state_tracker;
@@ -221,7 +266,7 @@ static bool gl_glsl_load_luts(
          return false;
    }
 
-   glBindTexture(GL_TEXTURE_2D, 0);
+   gl_state_bind_texture(GL_TEXTURE_2D, 0);
    return true;
 }
 
@@ -397,7 +442,7 @@ static bool gl_glsl_link_program(GLuint prog)
    if (status != GL_TRUE)
       return false;
 
-   glUseProgram(prog);
+   gl_state_use_program(prog);
    return true;
 }
 
@@ -465,9 +510,9 @@ static bool gl_glsl_compile_program(
       program->vprg = 0;
       program->fprg = 0;
 
-      glUseProgram(prog);
+      gl_state_use_program(prog);
       glUniform1i(gl_glsl_get_uniform(glsl, prog, "Texture"), 0);
-      glUseProgram(0);
+      gl_state_use_program(0);
    }
 
    program->id = prog;
@@ -587,20 +632,11 @@ static void gl_glsl_set_vbo(GLfloat **buffer, size_t *buffer_elems,
    *buffer_elems = elems;
 }
 
-static INLINE void gl_glsl_set_attribs(glsl_shader_data_t *glsl,
-      GLuint vbo,
-      GLfloat **buffer, size_t *buffer_elems,
-      const GLfloat *data, size_t elems,
-      const struct glsl_attrib *attrs, size_t num_attrs)
+static void gl_glsl_set_attrib_pointers(glsl_shader_data_t *glsl,
+      const struct glsl_attrib *attrs, size_t num_attrs, size_t base)
 {
    size_t i;
 
-   glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-   if (elems != *buffer_elems ||
-         memcmp(data, *buffer, elems * sizeof(GLfloat)))
-      gl_glsl_set_vbo(buffer, buffer_elems, data, elems);
-
    for (i = 0; i < num_attrs; i++)
    {
       if (glsl->attribs_index < ARRAY_SIZE(glsl->attribs_elems))
@@ -609,16 +645,86 @@ static INLINE void gl_glsl_set_attribs(glsl_shader_data_t *glsl,
 
          glEnableVertexAttribArray(loc);
          glVertexAttribPointer(loc, attrs[i].size, GL_FLOAT, GL_FALSE, 0,
-               (const GLvoid*)(uintptr_t)attrs[i].offset);
+               (const GLvoid*)(uintptr_t)(base + attrs[i].offset));
          glsl->attribs_elems[glsl->attribs_index++] = loc;
       }
       else
          RARCH_WARN("Attrib array buffer was overflown!\n");
    }
+}
+
+static INLINE void gl_glsl_set_attribs(glsl_shader_data_t *glsl,
+      GLuint vbo,
+      GLfloat **buffer, size_t *buffer_elems,
+      const GLfloat *data, size_t elems,
+      const struct glsl_attrib *attrs, size_t num_attrs)
+{
+   glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+   if (elems != *buffer_elems ||
+         memcmp(data, *buffer, elems * sizeof(GLfloat)))
+      gl_glsl_set_vbo(buffer, buffer_elems, data, elems);
+
+   gl_glsl_set_attrib_pointers(glsl, attrs, num_attrs, 0);
 
    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+/* Binds the cached copy of @data, uploading it first if it isn't
+ * in the cache yet. Returns false if @data doesn't fit at all. */
+static bool gl_glsl_set_attribs_cached(glsl_shader_data_t *glsl,
+      const GLfloat *data, size_t elems,
+      const struct glsl_attrib *attrs, size_t num_attrs)
+{
+   size_t i;
+   uint32_t hash                  = 0x811c9dc5;
+   const uint8_t *bytes           = (const uint8_t*)data;
+   struct glsl_vertex_cache *cache = &glsl->vertex_cache;
+   unsigned slot;
+
+   if (!cache->vbo || !cache->shadow || elems > GLSL_VERTEX_CACHE_FLOATS)
+      return false;
+
+   for (i = 0; i < elems * sizeof(GLfloat); i++)
+      hash = (hash ^ bytes[i]) * 0x01000193;
+
+   slot = hash & (GLSL_VERTEX_CACHE_ENTRIES - 1);
+
+   glBindBuffer(GL_ARRAY_BUFFER, cache->vbo);
+
+   if (     cache->entries[slot].elems != elems
+         || cache->entries[slot].hash  != hash
+         || memcmp(cache->shadow + cache->entries[slot].offset,
+            data, elems * sizeof(GLfloat)))
+   {
+      if (cache->used + elems > GLSL_VERTEX_CACHE_FLOATS)
+      {
+         /* Draws still in flight keep the old storage. */
+         glBufferData(GL_ARRAY_BUFFER,
+               GLSL_VERTEX_CACHE_FLOATS * sizeof(GLfloat),
+               NULL, GL_DYNAMIC_DRAW);
+         memset(cache->entries, 0, sizeof(cache->entries));
+         cache->used = 0;
+      }
+
+      glBufferSubData(GL_ARRAY_BUFFER, cache->used * sizeof(GLfloat),
+            elems * sizeof(GLfloat), data);
+      memcpy(cache->shadow + cache->used, data, elems * sizeof(GLfloat));
+
+      cache->entries[slot].hash   = hash;
+      cache->entries[slot].elems  = (uint32_t)elems;
+      cache->entries[slot].offset = (uint32_t)cache->used;
+      cache->used                += elems;
+   }
+
+   gl_glsl_set_attrib_pointers(glsl, attrs, num_attrs,
+         cache->entries[slot].offset * sizeof(GLfloat));
+
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+   return true;
+}
+
 static void gl_glsl_clear_uniforms_frame(struct shader_uniforms_frame *frame)
 {
    frame->texture      = -1;
@@ -662,7 +768,7 @@ static void gl_glsl_find_uniforms(glsl_shader_data_t *glsl,
 
    frame_base[0] = '\0';
 
-   glUseProgram(prog);
+   gl_state_use_program(prog);
 
    uni->mvp             = gl_glsl_get_uniform(glsl, prog, "MVPMatrix");
    uni->tex_coord       = gl_glsl_get_attrib(glsl, prog, "TexCoord");
@@ -680,21 +786,34 @@ static void gl_glsl_find_uniforms(glsl_shader_data_t *glsl,
    for (i = 0; i < glsl->shader->luts; i++)
       uni->lut_texture[i] = glGetUniformLocation(prog, glsl->shader->lut[i].id);
 
+   for (i = 0; i < glsl->shader->num_parameters; i++)
+      uni->parameter[i]   = glGetUniformLocation(prog,
+            glsl->shader->parameters[i].id);
+
+   for (i = 0; i < glsl->shader->variables; i++)
+      uni->state[i]       = glGetUniformLocation(prog,
+            glsl->shader->variable[i].id);
+
    gl_glsl_clear_uniforms_frame(&uni->orig);
    gl_glsl_find_uniforms_frame(glsl, prog, &uni->orig, "Orig");
    gl_glsl_clear_uniforms_frame(&uni->feedback);
    gl_glsl_find_uniforms_frame(glsl, prog, &uni->feedback, "Feedback");
 
-   if (pass > 1)
+   /* Passes are numbered as in the preset, without the softfilter */
+   if (pass > 1 + glsl->softfilter_passes)
    {
-      snprintf(frame_base, sizeof(frame_base), "PassPrev%u", pass);
+      snprintf(frame_base, sizeof(frame_base), "PassPrev%u",
+            pass - glsl->softfilter_passes);
       gl_glsl_find_uniforms_frame(glsl, prog, &uni->orig, frame_base);
    }
 
    for (i = 0; i + 1 < pass; i++)
    {
-      snprintf(frame_base, sizeof(frame_base), "Pass%u", i + 1);
       gl_glsl_clear_uniforms_frame(&uni->pass[i]);
+      if (i < glsl->softfilter_passes)
+         continue;
+      snprintf(frame_base, sizeof(frame_base), "Pass%u",
+            i + 1 - glsl->softfilter_passes);
       gl_glsl_find_uniforms_frame(glsl, prog, &uni->pass[i], frame_base);
       snprintf(frame_base, sizeof(frame_base), "PassPrev%u", pass - (i + 1));
       gl_glsl_find_uniforms_frame(glsl, prog, &uni->pass[i], frame_base);
@@ -712,7 +831,7 @@ static void gl_glsl_find_uniforms(glsl_shader_data_t *glsl,
       gl_glsl_find_uniforms_frame(glsl, prog, &uni->prev[i], frame_base);
    }
 
-   glUseProgram(0);
+   gl_state_use_program(0);
 }
 
 static void gl_glsl_deinit_shader(glsl_shader_data_t *glsl)
@@ -742,7 +861,7 @@ static void gl_glsl_destroy_resources(glsl_shader_data_t *glsl)
 
    glsl->current_idx = 0;
 
-   glUseProgram(0);
+   gl_state_use_program(0);
 
    for (i = 0; i < GFX_MAX_SHADERS; i++)
    {
@@ -754,11 +873,15 @@ static void gl_glsl_destroy_resources(glsl_shader_data_t *glsl)
       glDeleteProgram(glsl->prg[i].id);
    }
 
+   /* The names can be handed out again by glCreateProgram. */
+   gl_state_invalidate();
+
    if (glsl->shader && glsl->shader->luts)
-      glDeleteTextures(glsl->shader->luts, glsl->lut_textures);
+      gl_state_delete_textures(glsl->shader->luts, glsl->lut_textures);
 
    memset(glsl->prg, 0, sizeof(glsl->prg));
    memset(glsl->uniforms, 0, sizeof(glsl->uniforms));
+   memset(glsl->uniform_cache, 0, sizeof(glsl->uniform_cache));
    glsl->active_idx = 0;
 
    gl_glsl_deinit_shader(glsl);
@@ -780,6 +903,11 @@ static void gl_glsl_destroy_resources(glsl_shader_data_t *glsl)
       free(glsl->vbo[i].buffer_secondary);
    }
    memset(&glsl->vbo, 0, sizeof(glsl->vbo));
+
+   if (glsl->vertex_cache.vbo)
+      glDeleteBuffers(1, &glsl->vertex_cache.vbo);
+   free(glsl->vertex_cache.shadow);
+   memset(&glsl->vertex_cache, 0, sizeof(glsl->vertex_cache));
 }
 
 static void gl_glsl_deinit(void *data)
@@ -911,6 +1039,71 @@ static void gl_glsl_init_menu_shaders(void *data)
 #endif
 }
 
+/* Puts the GPU version of the configured softfilter in front of
+ * the preset, see video_driver_init_filter(). The core frame is
+ * uploaded as is and the preset sees the filtered image as its
+ * input, Orig and Prev stay the core's frames. */
+static bool gl_glsl_insert_softfilter(glsl_shader_data_t *glsl)
+{
+   unsigned i;
+   size_t vertex_len, fragment_len;
+   char defines[128];
+   struct video_shader *shader     = glsl->shader;
+   struct video_shader_pass *pass  = &shader->pass[0];
+   enum video_gpu_filter_type type = video_driver_get_gpu_filter();
+
+   if (type == VIDEO_GPU_FILTER_NONE)
+      return true;
+
+   if (shader->passes + 1 > GFX_MAX_SHADERS)
+   {
+      RARCH_WARN("[GLSL]: No room for the softfilter pass, running without it.\n");
+      return true;
+   }
+
+   defines[0] = '\0';
+   if (type == VIDEO_GPU_FILTER_LQ2X)
+      strlcat(defines, "#define SOFTFILTER_LQ2X\n", sizeof(defines));
+   if (video_driver_get_pixel_format() != RETRO_PIXEL_FORMAT_XRGB8888)
+      strlcat(defines, "#define SOFTFILTER_RGB565\n", sizeof(defines));
+
+   memmove(&shader->pass[1], &shader->pass[0],
+         shader->passes * sizeof(*pass));
+   memset(pass, 0, sizeof(*pass));
+   shader->passes++;
+
+   for (i = 0; i < shader->num_parameters; i++)
+      shader->parameters[i].pass++;
+   if (shader->feedback_pass >= 0)
+      shader->feedback_pass++;
+
+   vertex_len   = strlen(stock_vertex_softfilter) + 1;
+   fragment_len = strlen(defines) + strlen(stock_fragment_softfilter) + 1;
+
+   pass->source.string.vertex   = (char*)malloc(vertex_len);
+   pass->source.string.fragment = (char*)malloc(fragment_len);
+   if (!pass->source.string.vertex || !pass->source.string.fragment)
+      return false;
+
+   strlcpy(pass->source.string.vertex, stock_vertex_softfilter, vertex_len);
+   strlcpy(pass->source.string.fragment, defines, fragment_len);
+   strlcat(pass->source.string.fragment, stock_fragment_softfilter,
+         fragment_len);
+
+   pass->filter         = RARCH_FILTER_NEAREST;
+   pass->wrap           = RARCH_WRAP_EDGE;
+   pass->fbo.type_x     = RARCH_SCALE_INPUT;
+   pass->fbo.type_y     = RARCH_SCALE_INPUT;
+   pass->fbo.scale_x    = 2.0f;
+   pass->fbo.scale_y    = 2.0f;
+   pass->fbo.valid      = true;
+
+   glsl->softfilter_passes = 1;
+
+   RARCH_LOG("[GLSL]: Added softfilter pass.\n");
+   return true;
+}
+
 static void *gl_glsl_init(void *data, const char *path)
 {
    unsigned i;
@@ -1006,6 +1199,9 @@ static void *gl_glsl_init(void *data, const char *path)
       conf = NULL;
    }
 
+   if (!gl_glsl_insert_softfilter(glsl))
+      goto error;
+
    stock_vertex = (glsl->shader->modern) ?
       stock_vertex_modern : stock_vertex_legacy;
    stock_fragment = (glsl->shader->modern) ?
@@ -1129,11 +1325,27 @@ static void *gl_glsl_init(void *data, const char *path)
 
       gl_glsl_find_uniforms(glsl, 0, glsl->prg[VIDEO_SHADER_STOCK_BLEND].id,
             &glsl->uniforms[VIDEO_SHADER_STOCK_BLEND]);
+
+      shader_prog_info.fragment =
+            glsl_core ?
+            stock_fragment_core_font_sdf : stock_fragment_modern_font_sdf;
+
+      gl_glsl_compile_program(
+            glsl,
+            VIDEO_SHADER_STOCK_SDF,
+            &glsl->prg[VIDEO_SHADER_STOCK_SDF],
+            &shader_prog_info
+            );
+
+      gl_glsl_find_uniforms(glsl, 0, glsl->prg[VIDEO_SHADER_STOCK_SDF].id,
+            &glsl->uniforms[VIDEO_SHADER_STOCK_SDF]);
    }
    else
    {
       glsl->prg[VIDEO_SHADER_STOCK_BLEND] = glsl->prg[0];
       glsl->uniforms[VIDEO_SHADER_STOCK_BLEND] = glsl->uniforms[0];
+      glsl->prg[VIDEO_SHADER_STOCK_SDF]   = glsl->prg[0];
+      glsl->uniforms[VIDEO_SHADER_STOCK_SDF]   = glsl->uniforms[0];
    }
 
    gl_glsl_reset_attrib(glsl);
@@ -1144,6 +1356,13 @@ static void *gl_glsl_init(void *data, const char *path)
       glGenBuffers(1, &glsl->vbo[i].vbo_secondary);
    }
 
+   glsl->vertex_cache.shadow = (GLfloat*)
+      malloc(GLSL_VERTEX_CACHE_FLOATS * sizeof(GLfloat));
+   if (glsl->vertex_cache.shadow)
+      glGenBuffers(1, &glsl->vertex_cache.vbo);
+   /* Get storage on the first draw */
+   glsl->vertex_cache.used = GLSL_VERTEX_CACHE_FLOATS;
+
    return glsl;
 
 error:
@@ -1157,6 +1376,94 @@ error:
    return NULL;
 }
 
+/* Passes can share a program with pass 0, they
+ * use the cache of the first pass that has it. */
+static struct glsl_uniform_cache *gl_glsl_get_uniform_cache(
+      glsl_shader_data_t *glsl, unsigned idx)
+{
+   unsigned i;
+
+   for (i = 0; i < idx; i++)
+      if (glsl->prg[i].id == glsl->prg[idx].id)
+         break;
+
+   return &glsl->uniform_cache[i];
+}
+
+/* Returns true if @loc already holds @value. */
+static bool gl_glsl_uniform_cached(struct glsl_uniform_cache *cache,
+      GLint loc, GLenum type, const void *value, size_t size)
+{
+   unsigned i;
+
+   for (i = 0; i < GLSL_UNIFORM_CACHE_SIZE; i++)
+   {
+      unsigned slot = ((unsigned)loc + i) & (GLSL_UNIFORM_CACHE_SIZE - 1);
+
+      if (cache->slots[slot].type && cache->slots[slot].loc != loc)
+         continue;
+
+      if (     cache->slots[slot].type == type
+            && !memcmp(cache->slots[slot].value, value, size))
+         return true;
+
+      cache->slots[slot].loc  = loc;
+      cache->slots[slot].type = type;
+      memcpy(cache->slots[slot].value, value, size);
+      return false;
+   }
+
+   /* Full, don't cache this one */
+   return false;
+}
+
+/* Something set @loc without going through the cache. */
+static void gl_glsl_uniform_forget(struct glsl_uniform_cache *cache,
+      GLint loc)
+{
+   unsigned i;
+
+   for (i = 0; i < GLSL_UNIFORM_CACHE_SIZE; i++)
+   {
+      unsigned slot = ((unsigned)loc + i) & (GLSL_UNIFORM_CACHE_SIZE - 1);
+
+      if (!cache->slots[slot].type)
+         return;
+
+      if (cache->slots[slot].loc == loc)
+      {
+         /* Not a type we store, but keeps the slot taken
+          * so lookups for other locations still find theirs */
+         cache->slots[slot].type = (GLenum)-1;
+         return;
+      }
+   }
+}
+
+static void gl_glsl_uniform1i(struct glsl_uniform_cache *cache,
+      GLint loc, GLint value)
+{
+   if (loc >= 0 && !gl_glsl_uniform_cached(cache, loc,
+            GL_INT, &value, sizeof(value)))
+      glUniform1i(loc, value);
+}
+
+static void gl_glsl_uniform1f(struct glsl_uniform_cache *cache,
+      GLint loc, GLfloat value)
+{
+   if (loc >= 0 && !gl_glsl_uniform_cached(cache, loc,
+            GL_FLOAT, &value, sizeof(value)))
+      glUniform1f(loc, value);
+}
+
+static void gl_glsl_uniform2fv(struct glsl_uniform_cache *cache,
+      GLint loc, const GLfloat *value)
+{
+   if (loc >= 0 && !gl_glsl_uniform_cached(cache, loc,
+            GL_FLOAT_VEC2, value, 2 * sizeof(*value)))
+      glUniform2fv(loc, 1, value);
+}
+
 static void gl_glsl_set_uniform_parameter(
       void *data,
       struct uniform_info *param,
@@ -1173,6 +1480,10 @@ static void gl_glsl_set_uniform_parameter(
    else
       location = param->location;
 
+   gl_glsl_uniform_forget(gl_glsl_get_uniform_cache(glsl,
+            param->lookup.enable ? param->lookup.idx : glsl->active_idx),
+         location);
+
    switch (param->type)
    {
       case UNIFORM_1F:
@@ -1230,6 +1541,7 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
    unsigned fbo_info_cnt                      = params->fbo_info_cnt;
    unsigned                           texunit = 1;
    const struct          shader_uniforms *uni = NULL;
+   struct glsl_uniform_cache           *cache = NULL;
    size_t                                size = 0;
    size_t                        attribs_size = 0;
    const struct video_tex_info          *info = (const struct video_tex_info*)_info;
@@ -1247,6 +1559,8 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
    if (glsl->prg[glsl->active_idx].id == 0)
       return;
 
+   cache           = gl_glsl_get_uniform_cache(glsl, glsl->active_idx);
+
    input_size [0]  = (float)width;
    input_size [1]  = (float)height;
    output_size[0]  = (float)out_width;
@@ -1255,13 +1569,13 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
    texture_size[1] = (float)tex_height;
 
    if (uni->input_size >= 0)
-      glUniform2fv(uni->input_size, 1, input_size);
+      gl_glsl_uniform2fv(cache, uni->input_size, input_size);
 
    if (uni->output_size >= 0)
-      glUniform2fv(uni->output_size, 1, output_size);
+      gl_glsl_uniform2fv(cache, uni->output_size, output_size);
 
    if (uni->texture_size >= 0)
-      glUniform2fv(uni->texture_size, 1, texture_size);
+      gl_glsl_uniform2fv(cache, uni->texture_size, texture_size);
 
    if (uni->frame_count >= 0 && glsl->active_idx)
    {
@@ -1270,11 +1584,11 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
       if (modulo)
          frame_count %= modulo;
 
-      glUniform1i(uni->frame_count, frame_count);
+      gl_glsl_uniform1i(cache, uni->frame_count, frame_count);
    }
 
    if (uni->frame_direction >= 0)
-      glUniform1i(uni->frame_direction, state_manager_frame_is_reversed() ? -1 : 1);
+      gl_glsl_uniform1i(cache, uni->frame_direction, state_manager_frame_is_reversed() ? -1 : 1);
 
    /* Set lookup textures. */
    for (i = 0; i < glsl->shader->luts; i++)
@@ -1283,9 +1597,9 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
          continue;
 
       /* Have to rebind as HW render could override this. */
-      glActiveTexture(GL_TEXTURE0 + texunit);
-      glBindTexture(GL_TEXTURE_2D, glsl->lut_textures[i]);
-      glUniform1i(uni->lut_texture[i], texunit);
+      gl_state_active_texture(GL_TEXTURE0 + texunit);
+      gl_state_bind_texture(GL_TEXTURE_2D, glsl->lut_textures[i]);
+      gl_glsl_uniform1i(cache, uni->lut_texture[i], texunit);
       texunit++;
    }
 
@@ -1295,17 +1609,17 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
       if (uni->orig.texture >= 0)
       {
          /* Bind original texture. */
-         glActiveTexture(GL_TEXTURE0 + texunit);
-         glUniform1i(uni->orig.texture, texunit);
-         glBindTexture(GL_TEXTURE_2D, info->tex);
+         gl_state_active_texture(GL_TEXTURE0 + texunit);
+         gl_glsl_uniform1i(cache, uni->orig.texture, texunit);
+         gl_state_bind_texture(GL_TEXTURE_2D, info->tex);
          texunit++;
       }
 
       if (uni->orig.texture_size >= 0)
-         glUniform2fv(uni->orig.texture_size, 1, info->tex_size);
+         gl_glsl_uniform2fv(cache, uni->orig.texture_size, info->tex_size);
 
       if (uni->orig.input_size >= 0)
-         glUniform2fv(uni->orig.input_size, 1, info->input_size);
+         gl_glsl_uniform2fv(cache, uni->orig.input_size, info->input_size);
 
       /* Pass texture coordinates. */
       if (uni->orig.tex_coord >= 0)
@@ -1331,17 +1645,17 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
       if (uni->feedback.texture >= 0)
       {
          /* Bind original texture. */
-         glActiveTexture(GL_TEXTURE0 + texunit);
-         glUniform1i(uni->feedback.texture, texunit);
-         glBindTexture(GL_TEXTURE_2D, feedback_info->tex);
+         gl_state_active_texture(GL_TEXTURE0 + texunit);
+         gl_glsl_uniform1i(cache, uni->feedback.texture, texunit);
+         gl_state_bind_texture(GL_TEXTURE_2D, feedback_info->tex);
          texunit++;
       }
 
       if (uni->feedback.texture_size >= 0)
-         glUniform2fv(uni->feedback.texture_size, 1, feedback_info->tex_size);
+         gl_glsl_uniform2fv(cache, uni->feedback.texture_size, feedback_info->tex_size);
 
       if (uni->feedback.input_size >= 0)
-         glUniform2fv(uni->feedback.input_size, 1, feedback_info->input_size);
+         gl_glsl_uniform2fv(cache, uni->feedback.input_size, feedback_info->input_size);
 
       /* Pass texture coordinates. */
       if (uni->feedback.tex_coord >= 0)
@@ -1368,17 +1682,17 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
       {
          if (uni->pass[i].texture)
          {
-            glActiveTexture(GL_TEXTURE0 + texunit);
-            glBindTexture(GL_TEXTURE_2D, fbo_info[i].tex);
-            glUniform1i(uni->pass[i].texture, texunit);
+            gl_state_active_texture(GL_TEXTURE0 + texunit);
+            gl_state_bind_texture(GL_TEXTURE_2D, fbo_info[i].tex);
+            gl_glsl_uniform1i(cache, uni->pass[i].texture, texunit);
             texunit++;
          }
 
           if (uni->pass[i].texture_size >= 0)
-            glUniform2fv(uni->pass[i].texture_size, 1, fbo_info[i].tex_size);
+            gl_glsl_uniform2fv(cache, uni->pass[i].texture_size, fbo_info[i].tex_size);
 
          if (uni->pass[i].input_size >= 0)
-            glUniform2fv(uni->pass[i].input_size, 1, fbo_info[i].input_size);
+            gl_glsl_uniform2fv(cache, uni->pass[i].input_size, fbo_info[i].input_size);
 
          if (uni->pass[i].tex_coord >= 0)
          {
@@ -1406,18 +1720,18 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
    {
       if (uni->prev[i].texture >= 0)
       {
-         glActiveTexture(GL_TEXTURE0 + texunit);
-         glBindTexture(GL_TEXTURE_2D, prev_info[i].tex);
-         glUniform1i(uni->prev[i].texture, texunit);
+         gl_state_active_texture(GL_TEXTURE0 + texunit);
+         gl_state_bind_texture(GL_TEXTURE_2D, prev_info[i].tex);
+         gl_glsl_uniform1i(cache, uni->prev[i].texture, texunit);
          texunit++;
       }
 
 
       if (uni->prev[i].texture_size >= 0)
-         glUniform2fv(uni->prev[i].texture_size, 1, prev_info[i].tex_size);
+         gl_glsl_uniform2fv(cache, uni->prev[i].texture_size, prev_info[i].tex_size);
 
       if (uni->prev[i].input_size >= 0)
-         glUniform2fv(uni->prev[i].input_size, 1, prev_info[i].input_size);
+         gl_glsl_uniform2fv(cache, uni->prev[i].input_size, prev_info[i].input_size);
 
       /* Pass texture coordinates. */
       if (uni->prev[i].tex_coord >= 0)
@@ -1446,17 +1760,12 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
             &glsl->vbo[glsl->active_idx].size_secondary,
             buffer, size, attribs, attribs_size);
 
-   glActiveTexture(GL_TEXTURE0);
+   gl_state_active_texture(GL_TEXTURE0);
 
    /* #pragma parameters. */
    for (i = 0; i < glsl->shader->num_parameters; i++)
-   {
-
-      int location = glGetUniformLocation(
-            glsl->prg[glsl->active_idx].id,
-            glsl->shader->parameters[i].id);
-      glUniform1f(location, glsl->shader->parameters[i].current);
-   }
+      gl_glsl_uniform1f(cache, uni->parameter[i],
+            glsl->shader->parameters[i].current);
 
    /* Set state parameters. */
    if (glsl->state_tracker)
@@ -1469,12 +1778,7 @@ static void gl_glsl_set_params(void *dat, void *shader_data)
                GFX_MAX_VARIABLES, frame_count);
 
       for (i = 0; i < cnt; i++)
-      {
-         int location = glGetUniformLocation(
-               glsl->prg[glsl->active_idx].id,
-               state_info[i].id);
-         glUniform1f(location, state_info[i].value);
-      }
+         gl_glsl_uniform1f(cache, uni->state[i], state_info[i].value);
    }
 }
 
@@ -1581,7 +1885,8 @@ static bool gl_glsl_set_coords(void *handle_data, void *shader_data,
       attribs_size++;
    }
 
-   if (size)
+   if (size && !gl_glsl_set_attribs_cached(glsl,
+            buffer, size, attribs, attribs_size))
       gl_glsl_set_attribs(glsl,
             glsl->vbo[glsl->active_idx].vbo_primary,
             &glsl->vbo[glsl->active_idx].buffer_primary,
@@ -1612,7 +1917,7 @@ static void gl_glsl_use(void *data, void *shader_data, unsigned idx, bool set_ac
    else
       id = (GLuint)idx;
 
-   glUseProgram(id);
+   gl_state_use_program(id);
 }
 
 static unsigned gl_glsl_num(void *data)
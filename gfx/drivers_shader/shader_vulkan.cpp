@@ -25,14 +25,21 @@
 #include <math.h>
 
 #include <compat/strl.h>
+#include <file/file_path.h>
 #include <formats/image.h>
 #include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "slang_reflection.h"
 
 #include "../video_driver.h"
 #include "../../verbosity.h"
 #include "../../msg_hash.h"
+#include "../../performance_counters.h"
 
 using namespace std;
 
@@ -44,6 +51,10 @@ static const uint32_t opaque_frag[] =
 #include "../drivers/vulkan_shaders/opaque.frag.inc"
 ;
 
+static const uint32_t blit_comp[] =
+#include "../drivers/vulkan_shaders/blit.comp.inc"
+;
+
 static unsigned num_miplevels(unsigned width, unsigned height)
 {
    unsigned size   = MAX(width, height);
@@ -204,7 +215,8 @@ class Framebuffer
    public:
       Framebuffer(VkDevice device,
             const VkPhysicalDeviceMemoryProperties &mem_props,
-            const Size2D &max_size, VkFormat format, unsigned max_levels);
+            const Size2D &max_size, VkFormat format, unsigned max_levels,
+            bool storage = false);
 
       ~Framebuffer();
       Framebuffer(Framebuffer&&) = delete;
@@ -235,6 +247,7 @@ class Framebuffer
       VkFormat format;
       unsigned max_levels;
       unsigned levels           = 0;
+      bool storage;
 
       VkFramebuffer framebuffer = VK_NULL_HANDLE;
       VkRenderPass render_pass  = VK_NULL_HANDLE;
@@ -275,6 +288,10 @@ struct CommonResources
    unordered_map<string, slang_texture_semantic_map> texture_semantic_uniform_map;
    unique_ptr<video_shader> shader_preset;
 
+   // Applied on top of the preset's scale by offscreen passes
+   // which aren't relative to the previous pass.
+   float dynamic_scale = 1.0f;
+
    VkDevice device;
 };
 
@@ -327,6 +344,22 @@ class Pass
             const VkViewport &vp,
             const float *mvp);
 
+      // build_commands() split in two for parallel recording.
+      // prepare_commands() resizes the framebuffer and must run in
+      // pass order on one thread, record_commands() only touches
+      // state owned by this pass and can run on any thread.
+      void prepare_commands(
+            DeferredDisposer &disposer,
+            const Texture &original,
+            const Texture &source);
+
+      void record_commands(
+            VkCommandBuffer cmd,
+            const Texture &original,
+            const Texture &source,
+            const VkViewport &vp,
+            const float *mvp);
+
       void notify_sync_index(unsigned index)
       {
          sync_index = index;
@@ -377,11 +410,20 @@ class Pass
          return reflection;
       }
 
+      bool is_time_dependent() const;
+
       void set_pass_number(unsigned pass)
       {
          pass_number = pass;
       }
 
+      // Passes which only copy Source, like stock.slang, can be
+      // run as a compute dispatch instead of a render pass.
+      void set_blit(bool enable)
+      {
+         blit_requested = enable;
+      }
+
       void add_parameter(unsigned parameter_index, const std::string &id);
 
       void end_frame();
@@ -420,6 +462,12 @@ class Pass
       bool init_pipeline();
       bool init_pipeline_layout();
 
+      bool blit_requested = false;
+      bool blit = false;
+      bool can_blit() const;
+      bool init_blit_pipeline();
+      void record_blit(VkCommandBuffer cmd, const Texture &source);
+
       void set_texture(VkDescriptorSet set, unsigned binding,
             const Texture &texture);
 
@@ -513,11 +561,20 @@ struct vulkan_filter_chain
       void set_frame_count(uint64_t count);
       void set_frame_count_period(unsigned pass, unsigned period);
       void set_pass_name(unsigned pass, const char *name);
+      void set_pass_blit(unsigned pass, bool blit);
+      void set_frame_dupe(bool dupe)
+      {
+         frame_dupe = dupe;
+      }
 
       void add_static_texture(unique_ptr<StaticTexture> texture);
       void add_parameter(unsigned pass, unsigned parameter_index, const std::string &id);
       void release_staging_buffers();
 
+#ifdef HAVE_THREADS
+      void record_worker();
+#endif
+
    private:
       VkDevice device;
       VkPhysicalDevice gpu;
@@ -552,6 +609,82 @@ struct vulkan_filter_chain
       void clear_history_and_feedback(VkCommandBuffer cmd);
       void update_feedback_info();
       void update_history_info();
+
+      // Parallel recording of the offscreen passes.
+      // Every offscreen pass gets its own command pool so that
+      // any thread can record it, record_cmds holds one secondary
+      // command buffer per pass and sync index, laid out as
+      // [sync_index * num_offscreen_passes + pass].
+      unsigned record_threads = 0;
+      uint32_t queue_family_index;
+#ifdef HAVE_THREADS
+      vector<sthread_t*> record_workers;
+      slock_t *record_lock = nullptr;
+      scond_t *record_cond = nullptr;
+      scond_t *record_done = nullptr;
+      unsigned record_next = 0;
+      unsigned record_count = 0;
+      unsigned record_pending = 0;
+      bool record_quit = false;
+
+      vector<VkCommandPool> record_pools;
+      vector<VkCommandBuffer> record_cmds;
+      vector<Texture> record_sources;
+      Texture record_original;
+      VkViewport record_viewport;
+
+      void start_record_workers();
+      void stop_record_workers();
+      void record_pass(unsigned pass);
+      void record_offscreen_passes(VkCommandBuffer cmd, unsigned first);
+#endif
+      bool init_record();
+      void clear_record();
+
+      // GPU timings. Each sync index has a timestamp before the
+      // first pass and one after every pass, which are read back
+      // once the index comes around again.
+      VkQueryPool timestamp_pool = VK_NULL_HANDLE;
+      vector<bool> timestamps_started;
+      vector<bool> timestamps_pending;
+      vector<uint64_t> timestamp_results;
+      vector<uint32_t> timestamp_times;
+      vector<const char*> timestamp_names;
+      unsigned timestamp_count = 0;
+      float timestamp_period = 0.0f;
+      uint64_t timestamp_mask = 0;
+
+      bool init_timestamps();
+      void clear_timestamps();
+      void read_timestamps();
+      void write_timestamp(VkCommandBuffer cmd, unsigned index);
+
+      // Dynamic scale, driven by the time of the offscreen passes.
+      unsigned dynamic_scale_min = 100;
+      unsigned dynamic_scale = 100;
+      unsigned frame_time_target_us = 0;
+      unsigned frames_over = 0;
+      unsigned frames_under = 0;
+
+      void update_dynamic_scale(uint64_t us);
+
+      // Leading offscreen passes which only depend on the input,
+      // the viewport and the parameters. On repeated frames their
+      // framebuffers still hold the right output, so they are
+      // skipped as long as none of those changed.
+      unsigned static_passes = 0;
+      bool static_valid = false;
+      bool frame_dupe = false;
+      VkImageView static_input_view = VK_NULL_HANDLE;
+      unsigned static_input_width = 0;
+      unsigned static_input_height = 0;
+      float static_viewport_width = 0.0f;
+      float static_viewport_height = 0.0f;
+      float static_scale = 1.0f;
+      vector<float> static_parameters;
+
+      void init_static_passes();
+      unsigned update_static_passes(const VkViewport &vp);
 };
 
 vulkan_filter_chain::vulkan_filter_chain(
@@ -561,16 +694,250 @@ vulkan_filter_chain::vulkan_filter_chain(
      memory_properties(*info.memory_properties),
      cache(info.pipeline_cache),
      common(info.device, *info.memory_properties),
-     original_format(info.original_format)
+     original_format(info.original_format),
+     queue_family_index(info.queue_family_index),
+     dynamic_scale_min(info.dynamic_scale_min),
+     frame_time_target_us(info.frame_time_target_us)
 {
    max_input_size = { info.max_input_size.width, info.max_input_size.height };
    set_swapchain_info(info.swapchain);
    set_num_passes(info.num_passes);
+
+#ifdef HAVE_THREADS
+   // One thread per offscreen pass at most, and it is not
+   // worth the synchronization for a single offscreen pass.
+   record_threads = min(info.record_threads,
+         info.num_passes ? info.num_passes - 1 : 0);
+   if (record_threads < 2)
+      record_threads = 0;
+   start_record_workers();
+#endif
 }
 
 vulkan_filter_chain::~vulkan_filter_chain()
 {
+#ifdef HAVE_THREADS
+   stop_record_workers();
+#endif
    flush();
+   clear_record();
+   clear_timestamps();
+   performance_gpu_passes_clear();
+}
+
+#ifdef HAVE_THREADS
+static void vulkan_filter_chain_record_thread(void *data)
+{
+   static_cast<vulkan_filter_chain*>(data)->record_worker();
+}
+
+void vulkan_filter_chain::start_record_workers()
+{
+   unsigned i;
+
+   if (!record_threads)
+      return;
+
+   record_lock = slock_new();
+   record_cond = scond_new();
+   record_done = scond_new();
+
+   if (!record_lock || !record_cond || !record_done)
+   {
+      stop_record_workers();
+      return;
+   }
+
+   // The thread building the frame records passes as well.
+   for (i = 1; i < record_threads; i++)
+   {
+      sthread_t *thread = sthread_create(
+            vulkan_filter_chain_record_thread, this);
+      if (!thread)
+         break;
+      record_workers.push_back(thread);
+   }
+
+   RARCH_LOG("[Vulkan filter chain]: Recording passes on %u threads.\n",
+         unsigned(record_workers.size() + 1));
+}
+
+void vulkan_filter_chain::stop_record_workers()
+{
+   if (record_lock)
+   {
+      slock_lock(record_lock);
+      record_quit = true;
+      scond_broadcast(record_cond);
+      slock_unlock(record_lock);
+   }
+
+   for (auto thread : record_workers)
+      sthread_join(thread);
+   record_workers.clear();
+
+   if (record_done)
+      scond_free(record_done);
+   if (record_cond)
+      scond_free(record_cond);
+   if (record_lock)
+      slock_free(record_lock);
+
+   record_done    = nullptr;
+   record_cond    = nullptr;
+   record_lock    = nullptr;
+   record_threads = 0;
+}
+
+void vulkan_filter_chain::record_worker()
+{
+   slock_lock(record_lock);
+
+   for (;;)
+   {
+      unsigned pass;
+
+      while (!record_quit && record_next >= record_count)
+         scond_wait(record_cond, record_lock);
+
+      if (record_quit)
+         break;
+
+      pass = record_next++;
+      slock_unlock(record_lock);
+
+      record_pass(pass);
+
+      slock_lock(record_lock);
+      if (--record_pending == 0)
+         scond_signal(record_done);
+   }
+
+   slock_unlock(record_lock);
+}
+
+void vulkan_filter_chain::record_pass(unsigned pass)
+{
+   VkCommandBufferInheritanceInfo inherit = {
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+   VkCommandBufferBeginInfo begin_info    = {
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+   VkCommandBuffer cmd = record_cmds[
+      current_sync_index * record_sources.size() + pass];
+
+   // Each secondary buffer contains whole render passes,
+   // so there is nothing to inherit.
+   begin_info.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+   begin_info.pInheritanceInfo = &inherit;
+
+   vkBeginCommandBuffer(cmd, &begin_info);
+   passes[pass]->record_commands(cmd, record_original,
+         record_sources[pass], record_viewport, nullptr);
+   if (     current_sync_index < timestamps_started.size()
+         && timestamps_started[current_sync_index])
+      write_timestamp(cmd, pass + 1);
+   vkEndCommandBuffer(cmd);
+}
+
+void vulkan_filter_chain::record_offscreen_passes(VkCommandBuffer cmd,
+      unsigned first)
+{
+   unsigned count = record_sources.size();
+
+   if (first >= count)
+      return;
+
+   slock_lock(record_lock);
+   record_next    = first;
+   record_count   = count;
+   record_pending = count - first;
+   scond_broadcast(record_cond);
+
+   while (record_next < record_count)
+   {
+      unsigned pass = record_next++;
+      slock_unlock(record_lock);
+
+      record_pass(pass);
+
+      slock_lock(record_lock);
+      record_pending--;
+   }
+
+   while (record_pending)
+      scond_wait(record_done, record_lock);
+   slock_unlock(record_lock);
+
+   // Secondary command buffers execute in array order,
+   // so the barriers between passes still apply.
+   vkCmdExecuteCommands(cmd, count - first,
+         &record_cmds[current_sync_index * count + first]);
+}
+#endif
+
+bool vulkan_filter_chain::init_record()
+{
+#ifdef HAVE_THREADS
+   unsigned i, j;
+   unsigned count = passes.size() - 1;
+
+   clear_record();
+
+   if (!record_threads)
+      return true;
+
+   record_pools.resize(count);
+   record_cmds.resize(count * deferred_calls.size());
+   record_sources.resize(count);
+
+   for (i = 0; i < count; i++)
+   {
+      vector<VkCommandBuffer> cmds(deferred_calls.size());
+      VkCommandPoolCreateInfo pool_info = {
+         VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+      VkCommandBufferAllocateInfo info  = {
+         VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+
+      pool_info.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+      pool_info.queueFamilyIndex = queue_family_index;
+
+      if (vkCreateCommandPool(device, &pool_info,
+               nullptr, &record_pools[i]) != VK_SUCCESS)
+      {
+         record_pools[i] = VK_NULL_HANDLE;
+         clear_record();
+         return false;
+      }
+
+      info.commandPool        = record_pools[i];
+      info.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+      info.commandBufferCount = cmds.size();
+
+      if (vkAllocateCommandBuffers(device, &info, cmds.data()) != VK_SUCCESS)
+      {
+         clear_record();
+         return false;
+      }
+
+      for (j = 0; j < cmds.size(); j++)
+         record_cmds[j * count + i] = cmds[j];
+   }
+#endif
+
+   return true;
+}
+
+void vulkan_filter_chain::clear_record()
+{
+#ifdef HAVE_THREADS
+   // Destroying the pools frees the command buffers.
+   for (auto pool : record_pools)
+      if (pool != VK_NULL_HANDLE)
+         vkDestroyCommandPool(device, pool, nullptr);
+   record_pools.clear();
+   record_cmds.clear();
+   record_sources.clear();
+#endif
 }
 
 void vulkan_filter_chain::set_swapchain_info(
@@ -673,6 +1040,11 @@ void vulkan_filter_chain::set_pass_name(unsigned pass, const char *name)
    passes[pass]->set_name(name);
 }
 
+void vulkan_filter_chain::set_pass_blit(unsigned pass, bool blit)
+{
+   passes[pass]->set_blit(blit);
+}
+
 void vulkan_filter_chain::execute_deferred()
 {
    for (auto &calls : deferred_calls)
@@ -754,10 +1126,14 @@ bool vulkan_filter_chain::init_history()
    original_history.reserve(required_images);
    common.original_history.resize(required_images);
 
+   // update_history() resizes each image to the input it receives,
+   // so don't reserve max_input_size up front only to reallocate it
+   // a frame later. Slots that haven't received a frame yet are cleared
+   // like before, just smaller.
    for (unsigned i = 0; i < required_images; i++)
    {
       original_history.emplace_back(new Framebuffer(device, memory_properties,
-               max_input_size, original_format, 1));
+               { 1, 1 }, original_format, 1));
    }
 
    RARCH_LOG("[Vulkan filter chain]: Using history of %u frames.\n", required_images);
@@ -904,6 +1280,9 @@ bool vulkan_filter_chain::init()
 {
    Size2D source = max_input_size;
 
+   // Build the passes at the preset's own scale.
+   clear_timestamps();
+
    if (!init_alias())
       return false;
 
@@ -928,10 +1307,222 @@ bool vulkan_filter_chain::init()
       return false;
    if (!init_feedback())
       return false;
+   if (!init_record())
+      return false;
+   if (!init_timestamps())
+      return false;
    common.pass_outputs.resize(passes.size());
+   init_static_passes();
    return true;
 }
 
+void vulkan_filter_chain::init_static_passes()
+{
+   static_passes = 0;
+   static_valid  = false;
+
+   // The final pass renders to the swapchain image, it always runs.
+   while (static_passes + 1 < passes.size()
+         && !passes[static_passes]->is_time_dependent())
+      static_passes++;
+
+   if (static_passes)
+      RARCH_LOG("[Vulkan filter chain]: Reusing %u pass(es) on repeated frames.\n",
+            static_passes);
+}
+
+unsigned vulkan_filter_chain::update_static_passes(const VkViewport &vp)
+{
+   unsigned i;
+   const video_shader *preset = common.shader_preset.get();
+   unsigned num_parameters    = preset ? preset->num_parameters : 0;
+   bool reuse                 = frame_dupe && static_valid
+      && input_texture.view   == static_input_view
+      && input_texture.width  == static_input_width
+      && input_texture.height == static_input_height
+      && vp.width             == static_viewport_width
+      && vp.height            == static_viewport_height
+      && common.dynamic_scale == static_scale
+      && num_parameters       == static_parameters.size();
+
+   if (!static_passes)
+      return 0;
+
+   static_parameters.resize(num_parameters);
+   for (i = 0; i < num_parameters; i++)
+   {
+      if (static_parameters[i] != preset->parameters[i].current)
+         reuse = false;
+      static_parameters[i] = preset->parameters[i].current;
+   }
+
+   static_input_view      = input_texture.view;
+   static_input_width     = input_texture.width;
+   static_input_height    = input_texture.height;
+   static_viewport_width  = vp.width;
+   static_viewport_height = vp.height;
+   static_scale           = common.dynamic_scale;
+   static_valid           = true;
+
+   return reuse ? static_passes : 0;
+}
+
+bool vulkan_filter_chain::init_timestamps()
+{
+   VkPhysicalDeviceProperties props;
+   VkQueueFamilyProperties queue_props[16];
+   uint32_t queue_count = 16;
+   VkQueryPoolCreateInfo info = {
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+   bool dynamic = dynamic_scale_min
+      && dynamic_scale_min < 100
+      && frame_time_target_us
+      && passes.size() >= 2;
+
+   if (passes.empty())
+      return true;
+
+   vkGetPhysicalDeviceProperties(gpu, &props);
+   vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queue_count, queue_props);
+
+   if (     !props.limits.timestampComputeAndGraphics
+         || queue_family_index >= queue_count
+         || !queue_props[queue_family_index].timestampValidBits)
+   {
+      if (dynamic)
+         RARCH_WARN("[Vulkan filter chain]: No timestamp queries, dynamic scale disabled.\n");
+      return true;
+   }
+
+   timestamp_count = passes.size() + 1;
+   info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+   info.queryCount = timestamp_count * deferred_calls.size();
+   if (vkCreateQueryPool(device, &info, nullptr,
+            &timestamp_pool) != VK_SUCCESS)
+   {
+      timestamp_pool  = VK_NULL_HANDLE;
+      timestamp_count = 0;
+      return true;
+   }
+
+   timestamps_started.assign(deferred_calls.size(), false);
+   timestamps_pending.assign(deferred_calls.size(), false);
+   timestamp_results.resize(timestamp_count);
+   timestamp_times.resize(passes.size());
+   timestamp_names.clear();
+   for (auto &pass : passes)
+      timestamp_names.push_back(pass->get_name().empty()
+            ? nullptr : pass->get_name().c_str());
+   timestamp_period = props.limits.timestampPeriod;
+   timestamp_mask   =
+      queue_props[queue_family_index].timestampValidBits >= 64
+      ? ~uint64_t(0)
+      : (uint64_t(1) << queue_props[queue_family_index].timestampValidBits) - 1;
+
+   if (dynamic)
+      RARCH_LOG("[Vulkan filter chain]: Dynamic scale down to %u%% for a %u us target.\n",
+            dynamic_scale_min, frame_time_target_us);
+   return true;
+}
+
+void vulkan_filter_chain::clear_timestamps()
+{
+   if (timestamp_pool != VK_NULL_HANDLE)
+      vkDestroyQueryPool(device, timestamp_pool, nullptr);
+   timestamp_pool  = VK_NULL_HANDLE;
+   timestamp_count = 0;
+   timestamps_started.clear();
+   timestamps_pending.clear();
+   timestamp_names.clear();
+
+   dynamic_scale        = 100;
+   common.dynamic_scale = 1.0f;
+   frames_over          = 0;
+   frames_under         = 0;
+}
+
+void vulkan_filter_chain::write_timestamp(VkCommandBuffer cmd, unsigned index)
+{
+   vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+         timestamp_pool, current_sync_index * timestamp_count + index);
+}
+
+void vulkan_filter_chain::read_timestamps()
+{
+   unsigned i;
+   unsigned index = current_sync_index;
+   bool pending   = timestamps_pending[index];
+
+   timestamps_started[index] = false;
+   timestamps_pending[index] = false;
+   if (!pending)
+      return;
+
+   // The fence of this sync index has been waited for,
+   // so the results are there unless the frame was lost.
+   if (vkGetQueryPoolResults(device, timestamp_pool,
+            index * timestamp_count, timestamp_count,
+            timestamp_count * sizeof(uint64_t), timestamp_results.data(),
+            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+      return;
+
+   for (i = 0; i < passes.size(); i++)
+      timestamp_times[i] = uint32_t(double(
+               (timestamp_results[i + 1] - timestamp_results[i])
+               & timestamp_mask) * timestamp_period / 1000.0);
+
+   performance_gpu_passes_submit(timestamp_names.data(),
+         timestamp_times.data(), passes.size());
+
+   if (     dynamic_scale_min
+         && dynamic_scale_min < 100
+         && frame_time_target_us
+         && passes.size() >= 2)
+      update_dynamic_scale(uint64_t(double(
+                  (timestamp_results[passes.size() - 1] - timestamp_results[0])
+                  & timestamp_mask) * timestamp_period / 1000.0));
+}
+
+void vulkan_filter_chain::update_dynamic_scale(uint64_t us)
+{
+   unsigned next;
+
+   // Step down quickly when over the target, come back up slowly,
+   // and only when the next step up is expected to still fit.
+   // The cost of a pass goes with its area, so with the square
+   // of the scale.
+   if (us > frame_time_target_us)
+   {
+      frames_under = 0;
+      if (++frames_over < 3 || dynamic_scale <= dynamic_scale_min)
+         return;
+      next = dynamic_scale > dynamic_scale_min + 10
+         ? dynamic_scale - 10 : dynamic_scale_min;
+   }
+   else if (dynamic_scale < 100 && us * (dynamic_scale + 10) * (dynamic_scale + 10)
+         < uint64_t(frame_time_target_us) * dynamic_scale * dynamic_scale * 85 / 100)
+   {
+      frames_over = 0;
+      if (++frames_under < 60)
+         return;
+      next = min(100u, dynamic_scale + 10);
+   }
+   else
+   {
+      frames_over  = 0;
+      frames_under = 0;
+      return;
+   }
+
+   frames_over          = 0;
+   frames_under         = 0;
+   dynamic_scale        = next;
+   common.dynamic_scale = dynamic_scale / 100.0f;
+
+   RARCH_LOG("[Vulkan filter chain]: Offscreen passes took %u us, scale now %u%%.\n",
+         unsigned(us), dynamic_scale);
+}
+
 void vulkan_filter_chain::clear_history_and_feedback(VkCommandBuffer cmd)
 {
    for (auto &texture : original_history)
@@ -957,6 +1548,26 @@ void vulkan_filter_chain::build_offscreen_passes(VkCommandBuffer cmd,
    update_history_info();
    update_feedback_info();
 
+   unsigned reused = update_static_passes(vp);
+
+   // Partial frames would skew the pass timings.
+   bool timed = timestamp_pool != VK_NULL_HANDLE
+      && current_sync_index < timestamps_pending.size()
+      && !reused;
+
+   if (!timed && current_sync_index < timestamps_started.size())
+      timestamps_started[current_sync_index] = false;
+
+   if (timed)
+   {
+      read_timestamps();
+      vkCmdResetQueryPool(cmd, timestamp_pool,
+            current_sync_index * timestamp_count, timestamp_count);
+      vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            timestamp_pool, current_sync_index * timestamp_count);
+      timestamps_started[current_sync_index] = true;
+   }
+
    unsigned i;
    DeferredDisposer disposer(deferred_calls[current_sync_index]);
    const Texture original = { 
@@ -968,10 +1579,35 @@ void vulkan_filter_chain::build_offscreen_passes(VkCommandBuffer cmd,
 
    Texture source = original;
 
+#ifdef HAVE_THREADS
+   bool parallel = !record_cmds.empty();
+
+   record_original = original;
+   record_viewport = vp;
+#endif
+
    for (i = 0; i < passes.size() - 1; i++)
    {
-      passes[i]->build_commands(disposer, cmd,
-            original, source, vp, nullptr);
+      if (i < reused)
+      {
+         // Output of the last frame is still in the framebuffer.
+      }
+#ifdef HAVE_THREADS
+      else if (parallel)
+      {
+         // Resizing goes through the disposer, so do it here in
+         // pass order; the next pass needs the final framebuffer.
+         passes[i]->prepare_commands(disposer, original, source);
+         record_sources[i] = source;
+      }
+      else
+#endif
+      {
+         passes[i]->build_commands(disposer, cmd,
+               original, source, vp, nullptr);
+         if (timed)
+            write_timestamp(cmd, i + 1);
+      }
 
       auto &fb = passes[i]->get_framebuffer();
       source.texture.view     = fb.get_view();
@@ -984,6 +1620,11 @@ void vulkan_filter_chain::build_offscreen_passes(VkCommandBuffer cmd,
 
       common.pass_outputs[i] = source;
    }
+
+#ifdef HAVE_THREADS
+   if (parallel)
+      record_offscreen_passes(cmd, reused);
+#endif
 }
 
 void vulkan_filter_chain::update_history(DeferredDisposer &disposer, VkCommandBuffer cmd)
@@ -1091,6 +1732,15 @@ void vulkan_filter_chain::build_viewport_pass(
    passes.back()->build_commands(disposer, cmd,
          original, source, vp, mvp);
 
+   // Inside the render pass of the caller, which is allowed
+   // for timestamps; the queries were reset before it began.
+   if (     current_sync_index < timestamps_started.size()
+         && timestamps_started[current_sync_index])
+   {
+      write_timestamp(cmd, passes.size());
+      timestamps_pending[current_sync_index] = true;
+   }
+
    // For feedback FBOs, swap current and previous.
    for (auto &pass : passes)
       pass->end_frame();
@@ -1264,6 +1914,15 @@ Size2D Pass::get_output_size(const Size2D &original,
          height = 0.0f;
    }
 
+   // Source relative passes already follow the scaled pass before them.
+   if (common && !final_pass && common->dynamic_scale != 1.0f)
+   {
+      if (pass_info.scale_type_x != VULKAN_FILTER_CHAIN_SCALE_SOURCE)
+         width  = max(width * common->dynamic_scale, 1.0f);
+      if (pass_info.scale_type_y != VULKAN_FILTER_CHAIN_SCALE_SOURCE)
+         height = max(height * common->dynamic_scale, 1.0f);
+   }
+
    return { unsigned(roundf(width)), unsigned(roundf(height)) };
 }
 
@@ -1534,6 +2193,117 @@ bool Pass::init_pipeline()
    return true;
 }
 
+bool Pass::can_blit() const
+{
+   unsigned i;
+   const slang_semantic_meta &frame_count =
+      reflection.semantics[SLANG_SEMANTIC_FRAME_COUNT];
+   const vector<slang_texture_semantic_meta> &source =
+      reflection.semantic_textures[SLANG_TEXTURE_SEMANTIC_SOURCE];
+
+   // The kernel writes one rgba8 level and only knows about Source.
+   if (     !blit_requested
+         || final_pass
+         || pass_info.rt_format != VK_FORMAT_R8G8B8A8_UNORM
+         || pass_info.max_levels > 1
+         || !filtered_parameters.empty()
+         || frame_count.uniform
+         || frame_count.push_constant
+         || source.empty()
+         || !source[0].texture)
+      return false;
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+   {
+      if (i == SLANG_TEXTURE_SEMANTIC_SOURCE)
+         continue;
+
+      for (auto &texture : reflection.semantic_textures[i])
+         if (texture.texture)
+            return false;
+   }
+
+   return true;
+}
+
+bool Pass::init_blit_pipeline()
+{
+   static const VkDescriptorSetLayoutBinding bindings[] = {
+      { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1,
+         VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+      { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1,
+         VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+   };
+   const VkDescriptorPoolSize desc_counts[] = {
+      { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, num_sync_indices },
+      { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, num_sync_indices },
+   };
+   const VkPushConstantRange push_range = {
+      VK_SHADER_STAGE_COMPUTE_BIT, 0, 4 * sizeof(float) };
+
+   VkDescriptorSetLayoutCreateInfo set_layout_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+   set_layout_info.bindingCount = 2;
+   set_layout_info.pBindings    = bindings;
+
+   if (vkCreateDescriptorSetLayout(device,
+            &set_layout_info, NULL, &set_layout) != VK_SUCCESS)
+      return false;
+
+   VkPipelineLayoutCreateInfo layout_info = {
+      VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+   layout_info.setLayoutCount         = 1;
+   layout_info.pSetLayouts            = &set_layout;
+   layout_info.pushConstantRangeCount = 1;
+   layout_info.pPushConstantRanges    = &push_range;
+
+   if (vkCreatePipelineLayout(device,
+            &layout_info, NULL, &pipeline_layout) != VK_SUCCESS)
+      return false;
+
+   VkDescriptorPoolCreateInfo pool_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+   pool_info.maxSets       = num_sync_indices;
+   pool_info.poolSizeCount = 2;
+   pool_info.pPoolSizes    = desc_counts;
+   if (vkCreateDescriptorPool(device, &pool_info, nullptr, &pool) != VK_SUCCESS)
+      return false;
+
+   VkDescriptorSetAllocateInfo alloc_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+   alloc_info.descriptorPool     = pool;
+   alloc_info.descriptorSetCount = 1;
+   alloc_info.pSetLayouts        = &set_layout;
+
+   sets.resize(num_sync_indices);
+
+   for (unsigned i = 0; i < num_sync_indices; i++)
+      vkAllocateDescriptorSets(device, &alloc_info, &sets[i]);
+
+   VkShaderModuleCreateInfo module_info = {
+      VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+   module_info.codeSize = sizeof(blit_comp);
+   module_info.pCode    = blit_comp;
+
+   VkComputePipelineCreateInfo pipe = {
+      VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+   pipe.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+   pipe.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+   pipe.stage.pName = "main";
+   pipe.layout      = pipeline_layout;
+   vkCreateShaderModule(device, &module_info, NULL, &pipe.stage.module);
+
+   if (vkCreateComputePipelines(device,
+            cache, 1, &pipe, NULL, &pipeline) != VK_SUCCESS)
+   {
+      vkDestroyShaderModule(device, pipe.stage.module, NULL);
+      return false;
+   }
+
+   vkDestroyShaderModule(device, pipe.stage.module, NULL);
+   return true;
+}
+
 CommonResources::CommonResources(VkDevice device,
       const VkPhysicalDeviceMemoryProperties &memory_properties)
    : device(device)
@@ -1666,6 +2436,31 @@ void Pass::allocate_buffers()
    }
 }
 
+bool Pass::is_time_dependent() const
+{
+   unsigned i;
+   const slang_semantic_meta &frame_count =
+      reflection.semantics[SLANG_SEMANTIC_FRAME_COUNT];
+   const vector<slang_texture_semantic_meta> &history =
+      reflection.semantic_textures[SLANG_TEXTURE_SEMANTIC_ORIGINAL_HISTORY];
+   const vector<slang_texture_semantic_meta> &feedback =
+      reflection.semantic_textures[SLANG_TEXTURE_SEMANTIC_PASS_FEEDBACK];
+
+   if (frame_count.uniform || frame_count.push_constant)
+      return true;
+
+   // OriginalHistory0 is the input itself.
+   for (i = 1; i < history.size(); i++)
+      if (history[i].texture)
+         return true;
+
+   for (i = 0; i < feedback.size(); i++)
+      if (feedback[i].texture)
+         return true;
+
+   return framebuffer_feedback != nullptr;
+}
+
 void Pass::end_frame()
 {
    if (framebuffer_feedback)
@@ -1680,7 +2475,7 @@ bool Pass::init_feedback()
    framebuffer_feedback = unique_ptr<Framebuffer>(
          new Framebuffer(device, memory_properties,
             current_framebuffer_size,
-            pass_info.rt_format, pass_info.max_levels));
+            pass_info.rt_format, pass_info.max_levels, blit));
    return true;
 }
 
@@ -1693,14 +2488,6 @@ bool Pass::build()
    framebuffer.reset();
    framebuffer_feedback.reset();
 
-   if (!final_pass)
-   {
-      framebuffer = unique_ptr<Framebuffer>(
-            new Framebuffer(device, memory_properties,
-               current_framebuffer_size,
-               pass_info.rt_format, pass_info.max_levels));
-   }
-
    for (auto &param : parameters)
    {
       if (!vk_shader_set_unique_map(semantic_map, param.id,
@@ -1728,6 +2515,23 @@ bool Pass::build()
          filtered_parameters.push_back(parameters[i]);
    }
 
+   blit = can_blit();
+
+   if (!final_pass)
+   {
+      framebuffer = unique_ptr<Framebuffer>(
+            new Framebuffer(device, memory_properties,
+               current_framebuffer_size,
+               pass_info.rt_format, pass_info.max_levels, blit));
+   }
+
+   if (blit)
+   {
+      RARCH_LOG("[Vulkan filter chain]: Pass #%u runs as a compute blit.\n",
+            pass_number);
+      return init_blit_pipeline();
+   }
+
    if (!init_pipeline())
       return false;
 
@@ -1966,7 +2770,15 @@ void Pass::build_commands(
       const VkViewport &vp,
       const float *mvp)
 {
-   current_viewport = vp;
+   prepare_commands(disposer, original, source);
+   record_commands(cmd, original, source, vp, mvp);
+}
+
+void Pass::prepare_commands(
+      DeferredDisposer &disposer,
+      const Texture &original,
+      const Texture &source)
+{
    auto size = get_output_size(
          { original.texture.width, original.texture.height },
          { source.texture.width, source.texture.height });
@@ -1978,6 +2790,22 @@ void Pass::build_commands(
       framebuffer->set_size(disposer, size);
    }
    current_framebuffer_size = size;
+}
+
+void Pass::record_commands(
+      VkCommandBuffer cmd,
+      const Texture &original,
+      const Texture &source,
+      const VkViewport &vp,
+      const float *mvp)
+{
+   current_viewport = vp;
+
+   if (blit)
+   {
+      record_blit(cmd, source);
+      return;
+   }
 
    if (reflection.ubo_stage_mask && common->ubo_mapped)
    {
@@ -2099,16 +2927,95 @@ void Pass::build_commands(
    }
 }
 
+void Pass::record_blit(VkCommandBuffer cmd, const Texture &source)
+{
+   VkDescriptorImageInfo image_info[2];
+   VkWriteDescriptorSet writes[2] = {
+      { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET },
+      { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET },
+   };
+   VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+   const float output_size[4] = {
+      float(current_framebuffer_size.width),
+      float(current_framebuffer_size.height),
+      1.0f / current_framebuffer_size.width,
+      1.0f / current_framebuffer_size.height,
+   };
+
+   image_info[0].sampler     = common->samplers[source.filter][source.mip_filter][source.address];
+   image_info[0].imageView   = source.texture.view;
+   image_info[0].imageLayout = source.texture.layout;
+   image_info[1].sampler     = VK_NULL_HANDLE;
+   image_info[1].imageView   = framebuffer->get_view();
+   image_info[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+   writes[0].dstSet          = sets[sync_index];
+   writes[0].dstBinding      = 0;
+   writes[0].descriptorCount = 1;
+   writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+   writes[0].pImageInfo      = &image_info[0];
+   writes[1].dstSet          = sets[sync_index];
+   writes[1].dstBinding      = 1;
+   writes[1].descriptorCount = 1;
+   writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+   writes[1].pImageInfo      = &image_info[1];
+   vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+
+   // Whatever wrote Source only made it visible to fragment shaders.
+   barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+      | VK_ACCESS_SHADER_WRITE_BIT
+      | VK_ACCESS_TRANSFER_WRITE_BIT;
+   barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+   vkCmdPipelineBarrier(cmd,
+         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+         | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+         | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+         | VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+   vulkan_image_layout_transition_levels(cmd,
+         framebuffer->get_image(), 1,
+         VK_IMAGE_LAYOUT_UNDEFINED,
+         VK_IMAGE_LAYOUT_GENERAL,
+         0,
+         VK_ACCESS_SHADER_WRITE_BIT,
+         VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT
+         | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+   vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+   vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout,
+         0, 1, &sets[sync_index], 0, nullptr);
+   vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+         0, sizeof(output_size), output_size);
+   vkCmdDispatch(cmd,
+         (current_framebuffer_size.width  + 7) / 8,
+         (current_framebuffer_size.height + 7) / 8, 1);
+
+   // Barrier to sync with next pass.
+   vulkan_image_layout_transition_levels(cmd,
+         framebuffer->get_image(), 1,
+         VK_IMAGE_LAYOUT_GENERAL,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         VK_ACCESS_SHADER_WRITE_BIT,
+         VK_ACCESS_SHADER_READ_BIT,
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+         | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+}
+
 Framebuffer::Framebuffer(
       VkDevice device,
       const VkPhysicalDeviceMemoryProperties &mem_props,
       const Size2D &max_size, VkFormat format,
-      unsigned max_levels) :
+      unsigned max_levels, bool storage) :
    memory_properties(mem_props),
    device(device),
    size(max_size),
    format(format),
-   max_levels(max(max_levels, 1u))
+   max_levels(max(max_levels, 1u)),
+   storage(storage)
 {
    RARCH_LOG("[Vulkan filter chain]: Creating framebuffer %u x %u (max %u level(s)).\n",
          max_size.width, max_size.height, max_levels);
@@ -2320,6 +3227,8 @@ void Framebuffer::init(DeferredDisposer *disposer)
       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
       VK_IMAGE_USAGE_TRANSFER_DST_BIT |
       VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+   if (storage)
+      info.usage          |= VK_IMAGE_USAGE_STORAGE_BIT;
 
    info.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
    info.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -2756,6 +3665,9 @@ static bool vulkan_filter_chain_load_luts(
       VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
    VkSubmitInfo submit_info                      = {
       VK_STRUCTURE_TYPE_SUBMIT_INFO };
+   VkFenceCreateInfo fence_info                  = {
+      VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+   VkFence fence                                 = VK_NULL_HANDLE;
    VkCommandBuffer cmd                           = VK_NULL_HANDLE;
    VkCommandBufferAllocateInfo cmd_info          = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
    bool recording                                = false;
@@ -2784,8 +3696,21 @@ static bool vulkan_filter_chain_load_luts(
    vkEndCommandBuffer(cmd);
    submit_info.commandBufferCount = 1;
    submit_info.pCommandBuffers    = &cmd;
-   vkQueueSubmit(info->queue, 1, &submit_info, VK_NULL_HANDLE);
-   vkQueueWaitIdle(info->queue);
+
+   // Wait on a fence rather than the queue, so that only
+   // the submission itself needs the queue lock.
+   vkCreateFence(info->device, &fence_info, nullptr, &fence);
+#ifdef HAVE_THREADS
+   if (info->queue_lock)
+      slock_lock(info->queue_lock);
+#endif
+   vkQueueSubmit(info->queue, 1, &submit_info, fence);
+#ifdef HAVE_THREADS
+   if (info->queue_lock)
+      slock_unlock(info->queue_lock);
+#endif
+   vkWaitForFences(info->device, 1, &fence, VK_TRUE, UINT64_MAX);
+   vkDestroyFence(info->device, fence, nullptr);
    vkFreeCommandBuffers(info->device, info->command_pool, 1, &cmd);
    chain->release_staging_buffers();
    return true;
@@ -2909,6 +3834,8 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
             output.fragment.size());
 
       chain->set_frame_count_period(i, pass->frame_count_mod);
+      chain->set_pass_blit(i,
+            string_is_equal(path_basename(pass->source.path), "stock.slang"));
 
       if (!output.meta.name.empty())
          chain->set_pass_name(i, output.meta.name.c_str());
@@ -3127,6 +4054,13 @@ void vulkan_filter_chain_set_frame_count(
    chain->set_frame_count(count);
 }
 
+void vulkan_filter_chain_set_frame_dupe(
+      vulkan_filter_chain_t *chain,
+      bool dupe)
+{
+   chain->set_frame_dupe(dupe);
+}
+
 void vulkan_filter_chain_set_frame_count_period(
       vulkan_filter_chain_t *chain,
       unsigned pass,
@@ -100,9 +100,27 @@ struct vulkan_filter_chain_create_info
    const VkPhysicalDeviceMemoryProperties *memory_properties;
    VkPipelineCache pipeline_cache;
    VkQueue queue;
+   /* Held around submissions to queue if not NULL, needed
+    * when the chain is created off the video thread. */
+   slock_t *queue_lock;
    VkCommandPool command_pool;
    unsigned num_passes;
 
+   /* Queue family of command_pool. Only needed when
+    * record_threads is non-zero. */
+   uint32_t queue_family_index;
+   /* Number of threads recording the offscreen passes
+    * into secondary command buffers. 0 records everything
+    * into the frame's command buffer on the calling thread. */
+   unsigned record_threads;
+
+   /* Lowest scale, in percent, the intermediate passes may
+    * be rendered at to keep their GPU time under
+    * frame_time_target_us. 0 or 100 keeps the preset's
+    * scales as they are. */
+   unsigned dynamic_scale_min;
+   unsigned frame_time_target_us;
+
    VkFormat original_format;
    struct
    {
@@ -139,6 +157,11 @@ void vulkan_filter_chain_set_input_texture(vulkan_filter_chain_t *chain,
 void vulkan_filter_chain_set_frame_count(vulkan_filter_chain_t *chain,
       uint64_t count);
 
+/* Repeated frames reuse the output of passes which
+ * don't depend on the frame count or older frames. */
+void vulkan_filter_chain_set_frame_dupe(vulkan_filter_chain_t *chain,
+      bool dupe);
+
 void vulkan_filter_chain_set_frame_count_period(vulkan_filter_chain_t *chain,
       unsigned pass,
       unsigned period);
@@ -16,6 +16,8 @@
 
 #include <stdlib.h>
 
+#include <retro_miscellaneous.h>
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -46,6 +48,10 @@ static const font_renderer_driver_t *font_backends[] = {
 
 static void *video_font_driver = NULL;
 
+/* Messages drawn with the OSD font, which is never bound to a block,
+ * so each one is a draw call of its own. */
+static unsigned font_driver_osd_draw_calls = 0;
+
 int font_renderer_create_default(
       const font_renderer_driver_t **drv,
       void **handle,
@@ -81,6 +87,53 @@ int font_renderer_create_default(
    return 0;
 }
 
+int font_renderer_create_sdf(
+      const font_renderer_driver_t **drv,
+      void **handle,
+      const char *font_path, unsigned font_size)
+{
+   *handle = sdf_font_renderer.init(font_path, font_size);
+
+   if (!*handle)
+   {
+      *drv = NULL;
+      return 0;
+   }
+
+   *drv = &sdf_font_renderer;
+   return 1;
+}
+
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   unsigned right, bottom;
+
+   if (!width || !height)
+      return;
+
+   if (!atlas->dirty)
+   {
+      atlas->dirty        = true;
+      atlas->dirty_x      = x;
+      atlas->dirty_y      = y;
+      atlas->dirty_width  = width;
+      atlas->dirty_height = height;
+      return;
+   }
+
+   /* Already due for a full upload. */
+   if (!atlas->dirty_width)
+      return;
+
+   right               = MAX(atlas->dirty_x + atlas->dirty_width, x + width);
+   bottom              = MAX(atlas->dirty_y + atlas->dirty_height, y + height);
+   atlas->dirty_x      = MIN(atlas->dirty_x, x);
+   atlas->dirty_y      = MIN(atlas->dirty_y, y);
+   atlas->dirty_width  = right  - atlas->dirty_x;
+   atlas->dirty_height = bottom - atlas->dirty_y;
+}
+
 #ifdef HAVE_D3D8
 static const font_renderer_t *d3d8_font_backends[] = {
 #if defined(_XBOX1)
@@ -939,9 +992,22 @@ void font_driver_render_msg(
 #ifdef HAVE_LANGEXTRA
       free(new_msg);
 #endif
+
+      if (font == video_font_driver)
+         font_driver_osd_draw_calls++;
    }
 }
 
+unsigned font_driver_get_osd_draw_calls(bool reset)
+{
+   unsigned calls = font_driver_osd_draw_calls;
+
+   if (reset)
+      font_driver_osd_draw_calls = 0;
+
+   return calls;
+}
+
 void font_driver_bind_block(void *font_data, void *block)
 {
    font_data_t *font = (font_data_t*)(font_data ? font_data : video_font_driver);
@@ -51,6 +51,11 @@ struct font_glyph
    /* Advance X/Y draw coordinates after drawing this glyph. */
    int advance_x;
    int advance_y;
+
+   /* Texels covered in the atlas, when that isn't width x height,
+    * i.e. a distance field glyph drawn at another size. 0 otherwise. */
+   unsigned atlas_width;
+   unsigned atlas_height;
 };
 
 struct font_atlas
@@ -58,6 +63,13 @@ struct font_atlas
    uint8_t *buffer; /* Alpha channel. */
    unsigned width;
    unsigned height;
+
+   /* What changed since the last upload, see font_atlas_mark_dirty().
+    * A dirty atlas with dirty_width 0 needs a full upload. */
+   unsigned dirty_x;
+   unsigned dirty_y;
+   unsigned dirty_width;
+   unsigned dirty_height;
    bool dirty;
 };
 
@@ -129,11 +141,26 @@ int font_renderer_create_default(
       void **handle,
       const char *font_path, unsigned font_size);
 
+/* Same, but the glyphs are signed distance fields shared by every
+ * size of the font (alpha 128 on the outline, see sdf.c), so only
+ * drivers that render those should ask. */
+int font_renderer_create_sdf(
+      const font_renderer_driver_t **drv,
+      void **handle,
+      const char *font_path, unsigned font_size);
+
+/* Adds a rectangle to what the next upload of @atlas must cover. */
+void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height);
+
 void font_driver_render_msg(video_frame_info_t *video_info,
       void *font_data, const char *msg, const struct font_params *params);
 
 void font_driver_bind_block(void *font_data, void *block);
 
+/* OSD messages drawn so far, optionally starting the count over. */
+unsigned font_driver_get_osd_draw_calls(bool reset);
+
 int font_driver_get_message_width(void *font_data, const char *msg, unsigned len, float scale);
 
 void font_driver_flush(unsigned width, unsigned height, void *font_data,
@@ -180,6 +207,7 @@ extern font_renderer_driver_t stb_unicode_font_renderer;
 extern font_renderer_driver_t freetype_font_renderer;
 extern font_renderer_driver_t coretext_font_renderer;
 extern font_renderer_driver_t bitmap_font_renderer;
+extern font_renderer_driver_t sdf_font_renderer;
 
 RETRO_END_DECLS
 
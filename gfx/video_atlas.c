@@ -0,0 +1,158 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_math.h>
+
+#include "video_atlas.h"
+
+typedef struct
+{
+   unsigned index;
+   unsigned w, h;
+} video_atlas_item_t;
+
+static int video_atlas_item_cmp(const void *a, const void *b)
+{
+   const video_atlas_item_t *x = (const video_atlas_item_t*)a;
+   const video_atlas_item_t *y = (const video_atlas_item_t*)b;
+
+   if (x->h != y->h)
+      return x->h < y->h ? 1 : -1;
+   return x->index < y->index ? -1 : 1;
+}
+
+/* Returns the height used, or 0 if an item is wider than @width. */
+static unsigned video_atlas_pack_shelves(const video_atlas_item_t *items,
+      unsigned count, unsigned width, unsigned *xs, unsigned *ys)
+{
+   unsigned i;
+   unsigned x       = 0;
+   unsigned y       = 0;
+   unsigned shelf_h = 0;
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned idx = items[i].index;
+
+      if (items[i].w > width)
+         return 0;
+
+      if (x + items[i].w > width)
+      {
+         x        = 0;
+         y       += shelf_h;
+         shelf_h  = 0;
+      }
+
+      xs[idx]  = x + VIDEO_ATLAS_PADDING;
+      ys[idx]  = y + VIDEO_ATLAS_PADDING;
+      x       += items[i].w;
+      if (items[i].h > shelf_h)
+         shelf_h = items[i].h;
+   }
+
+   return y + shelf_h;
+}
+
+bool video_atlas_pack(const unsigned *widths, const unsigned *heights,
+      unsigned count, unsigned max_size,
+      unsigned *atlas_width, unsigned *atlas_height,
+      unsigned *xs, unsigned *ys)
+{
+   unsigned i;
+   unsigned n                = 0;
+   unsigned width            = 0;
+   unsigned height           = 0;
+   uint64_t area             = 0;
+   video_atlas_item_t *items = (video_atlas_item_t*)
+      malloc(count * sizeof(*items));
+
+   if (!items)
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      xs[i] = ys[i] = 0;
+
+      if (!widths[i] || !heights[i])
+         continue;
+
+      items[n].index = i;
+      items[n].w     = widths[i]  + 2 * VIDEO_ATLAS_PADDING;
+      items[n].h     = heights[i] + 2 * VIDEO_ATLAS_PADDING;
+      area          += (uint64_t)items[n].w * items[n].h;
+      if (items[n].w > width)
+         width       = items[n].w;
+      n++;
+   }
+
+   if (!n)
+   {
+      free(items);
+      return false;
+   }
+
+   qsort(items, n, sizeof(*items), video_atlas_item_cmp);
+
+   /* Start from the smallest power of two that could hold it all
+    * and widen until it comes out roughly square. */
+   width = next_pow2(width);
+   while ((uint64_t)width * width < area)
+      width <<= 1;
+
+   for (;;)
+   {
+      height = video_atlas_pack_shelves(items, n, width, xs, ys);
+      if ((height && height <= width) || width >= max_size)
+         break;
+      width <<= 1;
+   }
+
+   free(items);
+
+   if (width > max_size || !height || height > max_size)
+      return false;
+
+   *atlas_width  = width;
+   *atlas_height = height;
+   return true;
+}
+
+void video_atlas_blit(struct texture_image *atlas,
+      const struct texture_image *img, unsigned x, unsigned y)
+{
+   unsigned row;
+   const unsigned pad = VIDEO_ATLAS_PADDING;
+
+   for (row = 0; row < img->height + 2 * pad; row++)
+   {
+      unsigned i;
+      unsigned src_row    = (row < pad) ? 0
+         : (row - pad >= img->height) ? img->height - 1 : row - pad;
+      const uint32_t *src = img->pixels + src_row * img->width;
+      uint32_t *dst       = atlas->pixels
+         + (y - pad + row) * atlas->width + x;
+
+      for (i = 1; i <= pad; i++)
+      {
+         dst[-(int)i]                 = src[0];
+         dst[img->width + i - 1]      = src[img->width - 1];
+      }
+      memcpy(dst, src, img->width * sizeof(uint32_t));
+   }
+}
@@ -0,0 +1,60 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VIDEO_ATLAS_H
+#define __VIDEO_ATLAS_H
+
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+#include <formats/image.h>
+
+RETRO_BEGIN_DECLS
+
+/* Border around each image, filled with its edge pixels so linear
+ * filtering never picks up a neighbour. */
+#define VIDEO_ATLAS_PADDING 1
+
+/**
+ * video_atlas_pack:
+ * @widths, @heights     : size of each image, 0 x 0 for none.
+ * @count                : number of images.
+ * @max_size             : largest atlas side allowed.
+ * @atlas_width, @atlas_height : size of the atlas.
+ * @xs, @ys              : where each image goes, padding excluded.
+ *
+ * Shelf packs the images, tallest first, into a power-of-two wide
+ * atlas that comes out roughly square.
+ *
+ * Returns: false if they don't fit in @max_size.
+ **/
+bool video_atlas_pack(const unsigned *widths, const unsigned *heights,
+      unsigned count, unsigned max_size,
+      unsigned *atlas_width, unsigned *atlas_height,
+      unsigned *xs, unsigned *ys);
+
+/**
+ * video_atlas_blit:
+ *
+ * Copies @img into @atlas at @x, @y and fills the padding around
+ * it with its edge pixels.
+ **/
+void video_atlas_blit(struct texture_image *atlas,
+      const struct texture_image *img, unsigned x, unsigned y);
+
+RETRO_END_DECLS
+
+#endif
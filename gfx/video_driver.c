@@ -53,6 +53,8 @@
 #include "video_driver.h"
 #include "video_display_server.h"
 #include "video_crt_switch.h"
+#include "video_pacing.h"
+#include "video_perf_overlay.h"
 
 #include "../frontend/frontend_driver.h"
 #include "../record/record_driver.h"
@@ -66,6 +68,7 @@
 #include "../command.h"
 #include "../msg_hash.h"
 #include "../verbosity.h"
+#include "../performance_counters.h"
 
 #define MEASURE_FRAME_TIME_SAMPLES_COUNT (2 * 1024)
 
@@ -143,6 +146,7 @@ static rarch_softfilter_t *video_driver_state_filter     = NULL;
 static void               *video_driver_state_buffer     = NULL;
 static unsigned            video_driver_state_scale      = 0;
 static unsigned            video_driver_state_out_bpp    = 0;
+static enum video_gpu_filter_type video_driver_state_gpu_filter = VIDEO_GPU_FILTER_NONE;
 static bool                video_driver_state_out_rgb32      = false;
 static bool                video_driver_crt_switching_active = false;
 
@@ -170,6 +174,8 @@ static bool video_driver_window_title_update             = true;
 static retro_time_t video_driver_frame_time_samples[MEASURE_FRAME_TIME_SAMPLES_COUNT];
 static uint64_t video_driver_frame_time_count            = 0;
 static uint64_t video_driver_frame_count                 = 0;
+/* Frames the core passed as NULL to have the last one shown again. */
+static uint64_t video_driver_frame_dupes                 = 0;
 
 static void *video_driver_data                           = NULL;
 static video_driver_t *current_video                     = NULL;
@@ -181,6 +187,10 @@ static const video_poke_interface_t *video_driver_poke   = NULL;
  * being passed to video driver. */
 static video_pixel_scaler_t *video_driver_scaler_ptr     = NULL;
 
+/* The driver samples 0RGB1555 itself, the conversion above
+ * is then only run for recording. */
+static bool video_driver_native_rgb1555                  = false;
+
 static struct retro_hw_render_callback hw_render;
 
 static const struct
@@ -698,7 +708,54 @@ static void video_driver_filter_free(void)
    video_driver_state_scale     = 0;
    video_driver_state_out_bpp   = 0;
    video_driver_state_out_rgb32 = false;
+   video_driver_state_gpu_filter = VIDEO_GPU_FILTER_NONE;
+}
+
+#ifdef HAVE_GLSL
+/* The GL driver can run some filters as a hidden first GLSL pass
+ * instead, which avoids uploading a frame several times the size
+ * of the core's. The filter is picked before the driver is up, so
+ * go by the configured driver and preset type. */
+static enum video_gpu_filter_type video_driver_find_gpu_filter(
+      const char *path)
+{
+   unsigned i;
+   char ident[64];
+   config_file_t *conf     = NULL;
+   settings_t *settings    = config_get_ptr();
+   const char *shader_path = retroarch_get_shader_preset();
+   static const struct
+   {
+      const char *ident;
+      enum video_gpu_filter_type type;
+   } gpu_filters[] = {
+      { "scale2x", VIDEO_GPU_FILTER_SCALE2X },
+      { "epx",     VIDEO_GPU_FILTER_EPX     },
+      { "lq2x",    VIDEO_GPU_FILTER_LQ2X    },
+   };
+
+   if (!string_is_equal(settings->arrays.video_driver, "gl"))
+      return VIDEO_GPU_FILTER_NONE;
+
+   if (!string_is_empty(shader_path) && video_shader_parse_type(
+            shader_path, RARCH_SHADER_NONE) != RARCH_SHADER_GLSL)
+      return VIDEO_GPU_FILTER_NONE;
+
+   conf = config_file_new(path);
+   if (!conf)
+      return VIDEO_GPU_FILTER_NONE;
+
+   ident[0] = '\0';
+   config_get_array(conf, "filter", ident, sizeof(ident));
+   config_file_free(conf);
+
+   for (i = 0; i < ARRAY_SIZE(gpu_filters); i++)
+      if (string_is_equal(ident, gpu_filters[i].ident))
+         return gpu_filters[i].type;
+
+   return VIDEO_GPU_FILTER_NONE;
 }
+#endif
 
 static void video_driver_init_filter(enum retro_pixel_format colfmt_int)
 {
@@ -719,6 +776,17 @@ static void video_driver_init_filter(enum retro_pixel_format colfmt_int)
       return;
    }
 
+#ifdef HAVE_GLSL
+   video_driver_state_gpu_filter        = video_driver_find_gpu_filter(
+         settings->paths.path_softfilter_plugin);
+
+   if (video_driver_state_gpu_filter != VIDEO_GPU_FILTER_NONE)
+   {
+      RARCH_LOG("[Video]: Running filter as a GLSL pass.\n");
+      return;
+   }
+#endif
+
    video_driver_state_filter            = rarch_softfilter_new(
          settings->paths.path_softfilter_plugin,
          RARCH_SOFTFILTER_THREADS_AUTO, colfmt, width, height);
@@ -870,6 +938,9 @@ static void video_driver_free_internal(void)
 
    command_event(CMD_EVENT_SHADER_DIR_DEINIT, NULL);
 
+   video_pacing_deinit();
+   video_perf_overlay_deinit();
+
 #ifdef HAVE_THREADS
    if (is_threaded)
       return;
@@ -1038,12 +1109,18 @@ static bool video_driver_init_internal(bool *video_is_threaded)
    video.rgb32         = video_driver_state_filter ?
       video_driver_state_out_rgb32 :
       (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888);
+   video.rgb1555       = video_driver_scaler_ptr && !video_driver_state_filter;
    video.parent        = 0;
 
    video_started_fullscreen = video.fullscreen;
 
    /* Reset video frame count */
    video_driver_frame_count = 0;
+   video_driver_frame_dupes = 0;
+
+   /* Before the driver, which may enable display timing. */
+   video_pacing_init();
+   video_perf_overlay_init();
 
    tmp = input_get_ptr();
    /* Need to grab the "real" video driver interface on a reinit. */
@@ -1086,6 +1163,18 @@ static bool video_driver_init_internal(bool *video_is_threaded)
    if (current_video->poke_interface)
       current_video->poke_interface(video_driver_data, &video_driver_poke);
 
+   video_driver_native_rgb1555 = false;
+   if (video.rgb1555)
+   {
+      gfx_ctx_flags_t flags;
+
+      if (video_driver_get_all_flags(&flags, GFX_CTX_FLAGS_RGB1555))
+      {
+         RARCH_LOG("[Video]: Driver samples 0RGB1555 frames directly.\n");
+         video_driver_native_rgb1555 = true;
+      }
+   }
+
    if (current_video->viewport_info &&
          (!custom_vp->width  ||
           !custom_vp->height))
@@ -1199,6 +1288,17 @@ void video_driver_set_texture_frame(const void *frame, bool rgb32,
             frame, rgb32, width, height, alpha);
 }
 
+void video_driver_set_texture_frame_rows(const void *frame, bool rgb32,
+      unsigned width, unsigned height, unsigned y, unsigned rows,
+      float alpha)
+{
+   if (video_driver_poke && video_driver_poke->set_texture_frame_rows)
+      video_driver_poke->set_texture_frame_rows(video_driver_data,
+            frame, rgb32, width, height, y, rows, alpha);
+   else
+      video_driver_set_texture_frame(frame, rgb32, width, height, alpha);
+}
+
 #ifdef HAVE_OVERLAY
 bool video_driver_overlay_interface(const video_overlay_interface_t **iface)
 {
@@ -1408,6 +1508,14 @@ enum retro_pixel_format video_driver_get_pixel_format(void)
    return video_driver_pix_fmt;
 }
 
+enum retro_pixel_format video_driver_get_frame_pixel_format(void)
+{
+   if (     video_driver_pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555
+         && !video_driver_native_rgb1555)
+      return RETRO_PIXEL_FORMAT_RGB565;
+   return video_driver_pix_fmt;
+}
+
 void video_driver_set_pixel_format(enum retro_pixel_format fmt)
 {
    video_driver_pix_fmt = fmt;
@@ -2033,6 +2141,11 @@ bool video_driver_frame_filter_is_32bit(void)
    return video_driver_state_out_rgb32;
 }
 
+enum video_gpu_filter_type video_driver_get_gpu_filter(void)
+{
+   return video_driver_state_gpu_filter;
+}
+
 void video_driver_default_settings(void)
 {
    global_t *global    = global_get_ptr();
@@ -2402,17 +2515,37 @@ void video_driver_frame(const void *data, unsigned width,
    unsigned output_height                            = 0;
    unsigned output_pitch                             = 0;
    const char *msg                                   = NULL;
+   const void *record_data                           = NULL;
+   size_t record_pitch                               = 0;
    retro_time_t        new_time                      =
       cpu_features_get_time_usec();
 
    if (!video_driver_active)
       return;
 
+   performance_zone_begin(PERF_ZONE_VIDEO_FRAME);
+
+   if (!data)
+      video_driver_frame_dupes++;
+
    if (video_driver_scaler_ptr && data &&
          (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555) &&
          (data != RETRO_HW_FRAME_BUFFER_VALID))
    {
-      if (video_pixel_frame_scale(
+      /* A driver sampling 0RGB1555 gets the core's frame,
+       * recording still wants RGB565. */
+      if (video_driver_native_rgb1555)
+      {
+         if (recording_data && video_pixel_frame_scale(
+                  video_driver_scaler_ptr->scaler,
+                  video_driver_scaler_ptr->scaler_out,
+                  data, width, height, pitch))
+         {
+            record_data      = video_driver_scaler_ptr->scaler_out;
+            record_pitch     = video_driver_scaler_ptr->scaler->out_stride;
+         }
+      }
+      else if (video_pixel_frame_scale(
                video_driver_scaler_ptr->scaler,
                video_driver_scaler_ptr->scaler_out,
                data, width, height, pitch))
@@ -2422,6 +2555,12 @@ void video_driver_frame(const void *data, unsigned width,
       }
    }
 
+   if (!record_data)
+   {
+      record_data            = data;
+      record_pitch           = pitch;
+   }
+
 
    if (data)
       frame_cache_data = data;
@@ -2551,8 +2690,8 @@ void video_driver_frame(const void *data, unsigned width,
           || video_driver_record_gpu_buffer
          ) && recording_data
       )
-      recording_dump_frame(data, width, height,
-            pitch, video_info.runloop_is_idle);
+      recording_dump_frame(record_data, width, height,
+            record_pitch, video_info.runloop_is_idle);
 
    if (data && video_driver_state_filter &&
          video_driver_frame_filter(data, &video_info, width, height, pitch,
@@ -2580,9 +2719,22 @@ void video_driver_frame(const void *data, unsigned width,
 #endif
    }
 
+   {
+      settings_t *settings = config_get_ptr();
+      video_pacing_set_refresh(video_info.refresh_rate,
+            settings->uints.video_swap_interval,
+            settings->bools.video_vsync
+            && !video_info.input_driver_nonblock_state);
+   }
+   video_pacing_frame_submit(new_time);
+
+   if (video_info.perf_overlay_show)
+      video_perf_overlay_update(video_driver_frame_dupes);
+
    if (video_info.statistics_show)
    {
       audio_statistics_t audio_stats         = {0.0f};
+      video_pacing_stats_t pacing_stats;
       double stddev                          = 0.0;
       struct retro_system_av_info *av_info   = &video_driver_av_info;
       unsigned red                           = 255;
@@ -2604,11 +2756,13 @@ void video_driver_frame(const void *data, unsigned width,
             red, green, blue, alpha);
 
       compute_audio_buffer_statistics(&audio_stats);
+      video_pacing_get_stats(&pacing_stats);
 
       snprintf(video_info.stat_text,
             sizeof(video_info.stat_text),
             "Video Statistics:\n -Frame rate: %6.2f fps\n -Frame time: %6.2f ms\n -Frame time deviation: %.3f %%\n"
             " -Frame count: %" PRIu64"\n -Viewport: %d x %d x %3.2f\n"
+            "Frame Pacing:\n -Present interval: %6.2f ms (%s)\n -Missed vsyncs: %u\n -Frame work time: %6.2f ms\n -Auto frame delay: %u ms\n -Audio latency: %6.2f ms\n"
             "Audio Statistics:\n -Average buffer saturation: %.2f %%\n -Standard deviation: %.2f %%\n -Time spent close to underrun: %.2f %%\n -Time spent close to blocking: %.2f %%\n -Sample count: %d\n"
             "Core Geometry:\n -Size: %u x %u\n -Max Size: %u x %u\n -Aspect: %3.2f\nCore Timing:\n -FPS: %3.2f\n -Sample Rate: %6.2f\n",
             video_info.frame_rate,
@@ -2618,6 +2772,12 @@ void video_driver_frame(const void *data, unsigned width,
             video_info.width,
             video_info.height,
             video_info.refresh_rate,
+            pacing_stats.present_interval,
+            pacing_stats.display_timing ? "display" : "CPU",
+            pacing_stats.missed_vsyncs,
+            pacing_stats.work_time,
+            pacing_stats.frame_delay,
+            pacing_stats.audio_latency,
             audio_stats.average_buffer_saturation,
             audio_stats.std_deviation_percentage,
             audio_stats.close_to_underrun,
@@ -2643,6 +2803,13 @@ void video_driver_frame(const void *data, unsigned width,
          video_driver_frame_count,
          (unsigned)pitch, video_driver_msg, &video_info);
 
+   /* Without display timestamps, the best we have is when the
+    * driver returns, which with vsync is right after the flip.
+    * The threaded driver returns before it even renders. */
+   if (     !video_pacing_has_display_timing()
+         && !video_driver_is_threaded_internal())
+      video_pacing_present(cpu_features_get_time_usec(), 1);
+
    video_driver_frame_count++;
 
    /* Display the FPS, with a higher priority. */
@@ -2666,6 +2833,8 @@ void video_driver_frame(const void *data, unsigned width,
       video_driver_crt_switching_active = false;
 
    /* trigger set resolution*/
+
+   performance_zone_end(PERF_ZONE_VIDEO_FRAME);
 }
 
 void video_driver_display_type_set(enum rarch_display_type type)
@@ -2766,6 +2935,7 @@ void video_driver_build_info(video_frame_info_t *video_info)
    video_info->hard_sync_frames      = settings->uints.video_hard_sync_frames;
    video_info->fps_show              = settings->bools.video_fps_show;
    video_info->statistics_show       = settings->bools.video_statistics_show;
+   video_info->perf_overlay_show     = settings->bools.video_perf_overlay_show;
    video_info->framecount_show       = settings->bools.video_framecount_show;
    video_info->scale_integer         = settings->bools.video_scale_integer;
    video_info->aspect_ratio_idx      = settings->uints.video_aspect_ratio_idx;
@@ -2845,6 +3015,24 @@ void video_driver_build_info(video_frame_info_t *video_info)
 
    video_info->input_driver_nonblock_state = input_driver_is_nonblock_state();
 
+   /* Disable BFI during fast forward, slow-motion,
+    * and pause to prevent flicker. */
+   video_info->black_frames           = 0;
+   if (     video_info->black_frame_insertion
+         && !video_info->input_driver_nonblock_state
+         && !is_slowmotion
+         && !is_paused)
+   {
+      float display_hz = 0.0f;
+
+      if (!video_context_driver_get_refresh_rate(&display_hz))
+         display_hz    = 0.0f;
+
+      video_info->black_frames = video_pacing_black_frames(display_hz,
+            (float)video_driver_av_info.timing.fps,
+            settings->bools.vrr_runloop_enable);
+   }
+
    video_info->context_data           = video_context_data;
    video_info->shader_driver          = current_shader;
    video_info->shader_data            = current_shader_data;
@@ -52,6 +52,7 @@
 #define VIDEO_SHADER_MENU_4      (GFX_MAX_SHADERS - 5)
 #define VIDEO_SHADER_MENU_5      (GFX_MAX_SHADERS - 6)
 #define VIDEO_SHADER_MENU_6      (GFX_MAX_SHADERS - 7)
+#define VIDEO_SHADER_STOCK_SDF   (GFX_MAX_SHADERS - 8)
 
 #if defined(_XBOX360)
 #define DEFAULT_SHADER_TYPE RARCH_SHADER_HLSL
@@ -119,7 +120,8 @@ enum display_flags
    GFX_CTX_FLAGS_HARD_SYNC,
    GFX_CTX_FLAGS_BLACK_FRAME_INSERTION,
    GFX_CTX_FLAGS_MENU_FRAME_FILTERING,
-   GFX_CTX_FLAGS_ADAPTIVE_VSYNC
+   GFX_CTX_FLAGS_ADAPTIVE_VSYNC,
+   GFX_CTX_FLAGS_RGB1555
 };
 
 enum shader_uniform_type
@@ -142,6 +144,15 @@ enum shader_program_type
    SHADER_PROGRAM_COMBINED
 };
 
+/* Softfilters that have a GPU version, see video_driver_init_filter(). */
+enum video_gpu_filter_type
+{
+   VIDEO_GPU_FILTER_NONE = 0,
+   VIDEO_GPU_FILTER_SCALE2X,
+   VIDEO_GPU_FILTER_EPX,
+   VIDEO_GPU_FILTER_LQ2X
+};
+
 struct shader_program_info
 {
    bool is_file;
@@ -377,6 +388,12 @@ typedef struct video_info
     * */
    bool rgb32;
 
+   /* The core outputs 0RGB1555 and rgb32 is false. A driver
+    * which can sample it directly reports GFX_CTX_FLAGS_RGB1555
+    * and gets the frames as written by the core, every other
+    * driver keeps getting them converted to RGB565. */
+   bool rgb1555;
+
 #ifdef GEKKO
    /* TODO - we can't really have driver system-specific
     * variables in here. There should be some
@@ -404,6 +421,10 @@ typedef struct video_info
 
 typedef struct video_frame_info
 {
+   /* Black frames to present after this one, 0 whenever
+    * black frame insertion is off or would flicker,
+    * see video_pacing_black_frames(). */
+   unsigned black_frames;
    bool input_menu_swap_ok_cancel_buttons;
    bool input_driver_nonblock_state;
    bool shared_context;
@@ -411,6 +432,7 @@ typedef struct video_frame_info
    bool hard_sync;
    bool fps_show;
    bool statistics_show;
+   bool perf_overlay_show;
    bool framecount_show;
    bool scale_integer;
    bool post_filter_record;
@@ -464,7 +486,7 @@ typedef struct video_frame_info
    float xmb_alpha_factor;
 
    char fps_text[128];
-   char stat_text[512];
+   char stat_text[1024];
    char chat_text[256];
 
    uint64_t frame_count;
@@ -747,6 +769,12 @@ typedef struct video_poke_interface
          struct retro_framebuffer *framebuffer);
    bool (*get_hw_render_interface)(void *data,
          const struct retro_hw_render_interface **iface);
+   /* Update @rows rows of the texture starting at @y. @frame still
+    * points at the whole image, which is uploaded in full whenever
+    * the texture doesn't hold an earlier one of the same size. */
+   void (*set_texture_frame_rows)(void *data, const void *frame,
+         bool rgb32, unsigned width, unsigned height,
+         unsigned y, unsigned rows, float alpha);
 } video_poke_interface_t;
 
 
@@ -819,7 +847,8 @@ typedef struct video_driver
 
    /* Returns a pointer to a newly allocated buffer that can
     * (and must) be passed to free() by the caller, containing a
-    * copy of the current raw frame in the active pixel format
+    * copy of the last hardware rendered frame before any shader,
+    * bottom-up in BGR byte order (24bpp) like read_viewport,
     * and sets width, height and pitch to the correct values. */
    void* (*read_frame_raw)(void *data, unsigned *width,
    unsigned *height, size_t *pitch);
@@ -872,6 +901,7 @@ bool video_driver_read_viewport(uint8_t *buffer, bool is_idle);
 bool video_driver_cached_frame(void);
 bool video_driver_frame_filter_alive(void);
 bool video_driver_frame_filter_is_32bit(void);
+enum video_gpu_filter_type video_driver_get_gpu_filter(void);
 void video_driver_default_settings(void);
 void video_driver_load_settings(config_file_t *conf);
 void video_driver_save_settings(config_file_t *conf);
@@ -968,6 +998,10 @@ void video_driver_set_texture_enable(bool enable, bool full_screen);
 void video_driver_set_texture_frame(const void *frame, bool rgb32,
       unsigned width, unsigned height, float alpha);
 
+void video_driver_set_texture_frame_rows(const void *frame, bool rgb32,
+      unsigned width, unsigned height, unsigned y, unsigned rows,
+      float alpha);
+
 #ifdef HAVE_OVERLAY
 bool video_driver_overlay_interface(
       const video_overlay_interface_t **iface);
@@ -997,6 +1031,10 @@ rarch_softfilter_t *video_driver_frame_filter_get_ptr(void);
 
 enum retro_pixel_format video_driver_get_pixel_format(void);
 
+/* Format of the frames the driver receives, and of the cached
+ * frame. Differs from the core's when 0RGB1555 gets converted. */
+enum retro_pixel_format video_driver_get_frame_pixel_format(void);
+
 void video_driver_set_pixel_format(enum retro_pixel_format fmt);
 
 void video_driver_cached_frame_set(const void *data, unsigned width,
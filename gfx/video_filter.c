@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <file/file_path.h>
 #include <file/config_file_userdata.h>
@@ -44,44 +45,7 @@ struct rarch_soft_plug
 };
 
 #ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
-
-struct filter_thread_data
-{
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
-};
-
-static void filter_thread_loop(void *data)
-{
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
-
-   for (;;)
-   {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
-         break;
-
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
-
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
-   }
-}
+#include <rthreads/rjob.h>
 #endif
 
 struct rarch_softfilter
@@ -101,10 +65,20 @@ struct rarch_softfilter
    unsigned threads;
 
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   bool pooled;
 #endif
 };
 
+static void softfilter_run_packets(void *data,
+      unsigned begin, unsigned end)
+{
+   unsigned i;
+   rarch_softfilter_t *filt = (rarch_softfilter_t*)data;
+
+   for (i = begin; i < end; i++)
+      filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
+}
+
 static const struct softfilter_implementation *
 softfilter_find_implementation(rarch_softfilter_t *filt, const char *ident)
 {
@@ -207,11 +181,23 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+#ifdef HAVE_THREADS
+   /* Packets run on the frontend job pool, which also serves
+    * other features, instead of threads of our own. */
+   if (!rjob_init(0))
+      return false;
+   filt->pooled = true;
+
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = rjob_worker_count() + 1;
+#else
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = cpu_features_get_core_amount();
+#endif
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
-         &userdata);
+         threads, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
@@ -236,30 +222,6 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       return false;
    }
 
-#ifdef HAVE_THREADS
-   filt->thread_data = (struct filter_thread_data*)
-      calloc(threads, sizeof(*filt->thread_data));
-   if (!filt->thread_data)
-      return false;
-
-   for (i = 0; i < threads; i++)
-   {
-      filt->thread_data[i].userdata = filt->impl_data;
-      filt->thread_data[i].done = true;
-
-      filt->thread_data[i].lock = slock_new();
-      if (!filt->thread_data[i].lock)
-         return false;
-      filt->thread_data[i].cond = scond_new();
-      if (!filt->thread_data[i].cond)
-         return false;
-      filt->thread_data[i].thread = sthread_create(
-            filter_thread_loop, &filt->thread_data[i]);
-      if (!filt->thread_data[i].thread)
-         return false;
-   }
-#endif
-
    return true;
 }
 
@@ -474,19 +436,8 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
 #endif
 
 #ifdef HAVE_THREADS
-   for (i = 0; i < filt->threads; i++)
-   {
-      if (!filt->thread_data[i].thread)
-         continue;
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].die = true;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-      sthread_join(filt->thread_data[i].thread);
-      slock_free(filt->thread_data[i].lock);
-      scond_free(filt->thread_data[i].cond);
-   }
-   free(filt->thread_data);
+   if (filt->pooled)
+      rjob_deinit();
 #endif
    free(filt);
 }
@@ -518,8 +469,6 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
       const void *input, unsigned width, unsigned height,
       size_t input_stride)
 {
-   unsigned i;
-
    if (!filt)
       return;
 
@@ -528,33 +477,9 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
             output, output_stride, input, width, height, input_stride);
 
 #ifdef HAVE_THREADS
-   /* Fire off workers */
-   for (i = 0; i < filt->threads; i++)
-   {
-#if 0
-      RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-      filt->thread_data[i].packet = &filt->packets[i];
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].done = false;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-   }
-
-   /* Wait for workers */
-   for (i = 0; i < filt->threads; i++)
-   {
-#if 0
-      RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-      slock_lock(filt->thread_data[i].lock);
-      while (!filt->thread_data[i].done)
-         scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-      slock_unlock(filt->thread_data[i].lock);
-   }
+   rjob_parallel_for(filt->threads, 1, softfilter_run_packets, filt);
 #else
-   for (i = 0; i < filt->threads; i++)
-      filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
+   softfilter_run_packets(filt, 0, filt->threads);
 #endif
 }
 
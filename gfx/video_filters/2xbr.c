@@ -57,6 +57,7 @@ struct softfilter_thread_data
    unsigned height;
    int first;
    int last;
+   unsigned src_height;
 };
 
 struct filter_data
@@ -232,7 +233,9 @@ static void *twoxbr_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   /* Packets read up to two rows of their neighbours,
+    * which are clamped against the whole image. */
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -549,10 +552,10 @@ int eq8(uint32_t A, uint32_t B,
 
 
 static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+      int first, unsigned src_height, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned nextline, finish;
+   unsigned y, x;
    uint32_t pg_red_mask      = RED_MASK8888;
    uint32_t pg_green_mask    = GREEN_MASK8888;
    uint32_t pg_blue_mask     = BLUE_MASK8888;
@@ -562,38 +565,52 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
 
    (void)filt;
 
-   nextline = (last) ? 0 : src_stride;
-
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
-
-      for (finish = width; finish; finish -= 1)
+      /* Neighbours outside the image are clamped to the edge.
+       * Rows from other packets are only read, never written. */
+      unsigned row   = first + y;
+      unsigned up1   = row >= 1 ? 1 : 0;
+      unsigned up2   = row >= 2 ? 2 : up1;
+      unsigned down1 = row + 1 < src_height ? 1 : 0;
+      unsigned down2 = row + 2 < src_height ? 2 : down1;
+      const uint32_t *r0  = src - up2   * src_stride;
+      const uint32_t *r1  = src - up1   * src_stride;
+      const uint32_t *r2  = src;
+      const uint32_t *r3  = src + down1 * src_stride;
+      const uint32_t *r4  = src + down2 * src_stride;
+      uint32_t *in        = src;
+      uint32_t *out       = dst;
+
+      for (x = 0; x < width; x++)
       {
          uint32_t E[4];
          uint32_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint32_t A1 = *(in - nextline - nextline - 1);
-         uint32_t B1 = *(in - nextline - nextline);
-         uint32_t C1 = *(in - nextline - nextline + 1);
-         uint32_t A0 = *(in - nextline - 2);
-         uint32_t PA = *(in - nextline - 1);
-         uint32_t PB = *(in - nextline);
-         uint32_t PC = *(in - nextline + 1);
-         uint32_t C4 = *(in - nextline + 2);
-         uint32_t D0 = *(in - 2);
-         uint32_t PD = *(in - 1);
-         uint32_t PE = *(in);
-         uint32_t PF = *(in + 1);
-         uint32_t F4 = *(in + 2);
-         uint32_t G0 = *(in + nextline - 2);
-         uint32_t PG = *(in + nextline - 1);
-         uint32_t PH = *(in + nextline);
-         uint32_t _PI = *(in + nextline + 1);
-         uint32_t I4 = *(in + nextline + 2);
-         uint32_t G5 = *(in + nextline + nextline - 1);
-         uint32_t H5 = *(in + nextline + nextline);
-         uint32_t I5 = *(in + nextline + nextline + 1);
+         unsigned xm1 = x >= 1 ? x - 1 : 0;
+         unsigned xm2 = x >= 2 ? x - 2 : xm1;
+         unsigned xp1 = x + 1 < width ? x + 1 : x;
+         unsigned xp2 = x + 2 < width ? x + 2 : xp1;
+         uint32_t A1  = r0[xm1];
+         uint32_t B1  = r0[x];
+         uint32_t C1  = r0[xp1];
+         uint32_t A0  = r1[xm2];
+         uint32_t PA  = r1[xm1];
+         uint32_t PB  = r1[x];
+         uint32_t PC  = r1[xp1];
+         uint32_t C4  = r1[xp2];
+         uint32_t D0  = r2[xm2];
+         uint32_t PD  = r2[xm1];
+         uint32_t PE  = r2[x];
+         uint32_t PF  = r2[xp1];
+         uint32_t F4  = r2[xp2];
+         uint32_t G0  = r3[xm2];
+         uint32_t PG  = r3[xm1];
+         uint32_t PH  = r3[x];
+         uint32_t _PI = r3[xp1];
+         uint32_t I4  = r3[xp2];
+         uint32_t G5  = r4[xm1];
+         uint32_t H5  = r4[x];
+         uint32_t I5  = r4[xp1];
 
          /*
           * Map of the pixels:          A1 B1 C1
@@ -612,47 +629,64 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
 }
 
 static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      int first, unsigned src_height, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
+   unsigned y, x;
+   uint16_t pg_red_mask      = RED_MASK565;
+   uint16_t pg_green_mask    = GREEN_MASK565;
+   uint16_t pg_blue_mask     = BLUE_MASK565;
+   uint16_t pg_lbmask        = PG_LBMASK565;
    struct filter_data *filt = (struct filter_data*)data;
-   uint16_t pg_red_mask     = RED_MASK565;
-   uint16_t pg_green_mask   = GREEN_MASK565;
-   uint16_t pg_blue_mask    = BLUE_MASK565;
-   uint16_t pg_lbmask       = PG_LBMASK565;
-   unsigned nextline        = (last) ? 0 : src_stride;
 
-   for (; height; height--)
-   {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
+   (void)filt;
 
-      for (finish = width; finish; finish -= 1)
+   for (y = 0; y < height; y++)
+   {
+      /* Neighbours outside the image are clamped to the edge.
+       * Rows from other packets are only read, never written. */
+      unsigned row   = first + y;
+      unsigned up1   = row >= 1 ? 1 : 0;
+      unsigned up2   = row >= 2 ? 2 : up1;
+      unsigned down1 = row + 1 < src_height ? 1 : 0;
+      unsigned down2 = row + 2 < src_height ? 2 : down1;
+      const uint16_t *r0  = src - up2   * src_stride;
+      const uint16_t *r1  = src - up1   * src_stride;
+      const uint16_t *r2  = src;
+      const uint16_t *r3  = src + down1 * src_stride;
+      const uint16_t *r4  = src + down2 * src_stride;
+      uint16_t *in        = src;
+      uint16_t *out       = dst;
+
+      for (x = 0; x < width; x++)
       {
          uint16_t E[4];
          uint16_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint16_t A1 = *(in - nextline - nextline - 1);
-         uint16_t B1 = *(in - nextline - nextline);
-         uint16_t C1 = *(in - nextline - nextline + 1);
-         uint16_t A0 = *(in - nextline - 2);
-         uint16_t PA = *(in - nextline - 1);
-         uint16_t PB = *(in - nextline);
-         uint16_t PC = *(in - nextline + 1);
-         uint16_t C4 = *(in - nextline + 2);
-         uint16_t D0 = *(in - 2);
-         uint16_t PD = *(in - 1);
-         uint16_t PE = *(in);
-         uint16_t PF = *(in + 1);
-         uint16_t F4 = *(in + 2);
-         uint16_t G0 = *(in + nextline - 2);
-         uint16_t PG = *(in + nextline - 1);
-         uint16_t PH = *(in + nextline);
-         uint16_t _PI = *(in + nextline + 1);
-         uint16_t I4 = *(in + nextline + 2);
-         uint16_t G5 = *(in + nextline + nextline - 1);
-         uint16_t H5 = *(in + nextline + nextline);
-         uint16_t I5 = *(in + nextline + nextline + 1);
+         unsigned xm1 = x >= 1 ? x - 1 : 0;
+         unsigned xm2 = x >= 2 ? x - 2 : xm1;
+         unsigned xp1 = x + 1 < width ? x + 1 : x;
+         unsigned xp2 = x + 2 < width ? x + 2 : xp1;
+         uint16_t A1  = r0[xm1];
+         uint16_t B1  = r0[x];
+         uint16_t C1  = r0[xp1];
+         uint16_t A0  = r1[xm2];
+         uint16_t PA  = r1[xm1];
+         uint16_t PB  = r1[x];
+         uint16_t PC  = r1[xp1];
+         uint16_t C4  = r1[xp2];
+         uint16_t D0  = r2[xm2];
+         uint16_t PD  = r2[xm1];
+         uint16_t PE  = r2[x];
+         uint16_t PF  = r2[xp1];
+         uint16_t F4  = r2[xp2];
+         uint16_t G0  = r3[xm2];
+         uint16_t PG  = r3[xm1];
+         uint16_t PH  = r3[x];
+         uint16_t _PI = r3[xp1];
+         uint16_t I4  = r3[xp2];
+         uint16_t G5  = r4[xm1];
+         uint16_t H5  = r4[x];
+         uint16_t I5  = r4[xp1];
 
          /*
           * Map of the pixels:          A1 B1 C1
@@ -680,7 +714,7 @@ static void twoxbr_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    twoxbr_generic_rgb565(data, width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->src_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -696,7 +730,7 @@ static void twoxbr_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned height = thr->height;
 
    twoxbr_generic_xrgb8888(data, width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->src_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
         output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -731,6 +765,7 @@ static void twoxbr_generic_packets(void *data,
        * pixels outside their given buffer. */
       thr->first = y_start;
       thr->last = y_end == height;
+      thr->src_height = height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = twoxbr_work_cb_rgb565;
@@ -42,6 +42,7 @@ struct softfilter_thread_data
    unsigned height;
    int first;
    int last;
+   int burst;
 };
 
 struct filter_data
@@ -130,7 +131,9 @@ static void *blargg_ntsc_snes_generic_create(const struct softfilter_config *con
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   /* Rows are filtered independently, packets only need
+    * to start at the right burst phase. */
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -167,26 +170,24 @@ static void blargg_ntsc_snes_generic_destroy(void *data)
 }
 
 static void blargg_ntsc_snes_render_rgb565(void *data, int width, int height,
-      int first, int last,
+      int first, int last, int burst,
       uint16_t *input, int pitch, uint16_t *output, int outpitch)
 {
    struct filter_data *filt = (struct filter_data*)data;
    if(width <= 256)
-      snes_ntsc_blit(filt->ntsc, input, pitch, filt->burst,
+      snes_ntsc_blit(filt->ntsc, input, pitch, burst,
             width, height, output, outpitch * 2, first, last);
    else
-      snes_ntsc_blit_hires(filt->ntsc, input, pitch, filt->burst,
+      snes_ntsc_blit_hires(filt->ntsc, input, pitch, burst,
             width, height, output, outpitch * 2, first, last);
-
-   filt->burst ^= filt->burst_toggle;
 }
 
 static void blargg_ntsc_snes_rgb565(void *data, unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      int first, int last, int burst, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    blargg_ntsc_snes_render_rgb565(data, width, height,
-         first, last,
+         first, last, burst,
          src, src_stride,
          dst, dst_stride);
 
@@ -202,7 +203,7 @@ static void blargg_ntsc_snes_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    blargg_ntsc_snes_rgb565(data, width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->last, thr->burst, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -234,10 +235,15 @@ static void blargg_ntsc_snes_generic_packets(void *data,
       thr->first = y_start;
       thr->last = y_end == height;
 
+      /* The burst phase advances by one every row. */
+      thr->burst = (filt->burst + y_start) % snes_ntsc_burst_count;
+
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = blargg_ntsc_snes_work_cb_rgb565;
       packets[i].thread_data = thr;
    }
+
+   filt->burst ^= filt->burst_toggle;
 }
 
 static const struct softfilter_implementation blargg_ntsc_snes_generic = {
@@ -17,6 +17,16 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LQ2X_SSE2
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LQ2X_NEON
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation lq2x_get_implementation
 #define softfilter_thread_data lq2x_softfilter_thread_data
@@ -43,8 +53,254 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+
+   void (*row_rgb565)(const uint16_t *prev, const uint16_t *cur,
+         const uint16_t *next, uint16_t *out0, uint16_t *out1,
+         unsigned width);
+   void (*row_xrgb8888)(const uint32_t *prev, const uint32_t *cur,
+         const uint32_t *next, uint32_t *out0, uint32_t *out1,
+         unsigned width);
 };
 
+static uint16_t lq2x_blend_rgb565(uint16_t c, uint16_t a)
+{
+   return (c & a) + (((c ^ a) & 0xf7de) >> 1);
+}
+
+static uint32_t lq2x_blend_xrgb8888(uint32_t c, uint32_t a)
+{
+   return (c & a) + (((c ^ a) & 0xfefefefe) >> 1);
+}
+
+/* Filters pixels [x, end) of a row. 'prev' and 'next' are the
+ * rows above and below, or 'cur' itself at the image edges. */
+#define LQ2X_SPAN(type, blend) \
+   for (; x < end; x++) \
+   { \
+      type A = prev[x]; \
+      type B = cur[x > 0 ? x - 1 : x]; \
+      type C = cur[x]; \
+      type D = cur[x < width - 1 ? x + 1 : x]; \
+      type E = next[x]; \
+      \
+      if (A != E && B != D) \
+      { \
+         out0[2 * x + 0] = (A == B) ? blend(C, A) : C; \
+         out0[2 * x + 1] = (A == D) ? blend(C, A) : C; \
+         out1[2 * x + 0] = (E == B) ? blend(C, E) : C; \
+         out1[2 * x + 1] = (E == D) ? blend(C, E) : C; \
+      } \
+      else \
+      { \
+         out0[2 * x + 0] = C; \
+         out0[2 * x + 1] = C; \
+         out1[2 * x + 0] = C; \
+         out1[2 * x + 1] = C; \
+      } \
+   }
+
+static void lq2x_span_rgb565(const uint16_t *prev, const uint16_t *cur,
+      const uint16_t *next, uint16_t *out0, uint16_t *out1,
+      unsigned x, unsigned end, unsigned width)
+{
+   LQ2X_SPAN(uint16_t, lq2x_blend_rgb565)
+}
+
+static void lq2x_span_xrgb8888(const uint32_t *prev, const uint32_t *cur,
+      const uint32_t *next, uint32_t *out0, uint32_t *out1,
+      unsigned x, unsigned end, unsigned width)
+{
+   LQ2X_SPAN(uint32_t, lq2x_blend_xrgb8888)
+}
+
+static void lq2x_row_rgb565_c(const uint16_t *prev, const uint16_t *cur,
+      const uint16_t *next, uint16_t *out0, uint16_t *out1, unsigned width)
+{
+   lq2x_span_rgb565(prev, cur, next, out0, out1, 0, width, width);
+}
+
+static void lq2x_row_xrgb8888_c(const uint32_t *prev, const uint32_t *cur,
+      const uint32_t *next, uint32_t *out0, uint32_t *out1, unsigned width)
+{
+   lq2x_span_xrgb8888(prev, cur, next, out0, out1, 0, width, width);
+}
+
+/* The vector rows do the same as the spans above. The first and
+ * last pixel need clamped neighbours, so they're left to the
+ * scalar code along with whatever doesn't fill a vector. */
+#ifdef LQ2X_SSE2
+#define LQ2X_SELECT_SSE2(m, a, b) \
+   _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b))
+
+static void lq2x_row_rgb565_sse2(const uint16_t *prev, const uint16_t *cur,
+      const uint16_t *next, uint16_t *out0, uint16_t *out1, unsigned width)
+{
+   unsigned x;
+   const __m128i lbmask = _mm_set1_epi16((short)0xf7de);
+
+   if (!width)
+      return;
+
+   lq2x_span_rgb565(prev, cur, next, out0, out1, 0, 1, width);
+
+   for (x = 1; x + 8 < width; x += 8)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(prev + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(cur  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(cur  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(cur  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(next + x));
+      __m128i skip = _mm_or_si128(_mm_cmpeq_epi16(A, E),
+            _mm_cmpeq_epi16(B, D));
+      __m128i CA   = _mm_add_epi16(_mm_and_si128(C, A), _mm_srli_epi16(
+               _mm_and_si128(_mm_xor_si128(C, A), lbmask), 1));
+      __m128i CE   = _mm_add_epi16(_mm_and_si128(C, E), _mm_srli_epi16(
+               _mm_and_si128(_mm_xor_si128(C, E), lbmask), 1));
+      __m128i o00  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi16(A, B)), CA, C);
+      __m128i o01  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi16(A, D)), CA, C);
+      __m128i o10  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi16(E, B)), CE, C);
+      __m128i o11  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi16(E, D)), CE, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x),
+            _mm_unpacklo_epi16(o00, o01));
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x + 8),
+            _mm_unpackhi_epi16(o00, o01));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x),
+            _mm_unpacklo_epi16(o10, o11));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x + 8),
+            _mm_unpackhi_epi16(o10, o11));
+   }
+
+   lq2x_span_rgb565(prev, cur, next, out0, out1, x, width, width);
+}
+
+static void lq2x_row_xrgb8888_sse2(const uint32_t *prev, const uint32_t *cur,
+      const uint32_t *next, uint32_t *out0, uint32_t *out1, unsigned width)
+{
+   unsigned x;
+   const __m128i lbmask = _mm_set1_epi32((int)0xfefefefe);
+
+   if (!width)
+      return;
+
+   lq2x_span_xrgb8888(prev, cur, next, out0, out1, 0, 1, width);
+
+   for (x = 1; x + 4 < width; x += 4)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(prev + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(cur  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(cur  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(cur  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(next + x));
+      __m128i skip = _mm_or_si128(_mm_cmpeq_epi32(A, E),
+            _mm_cmpeq_epi32(B, D));
+      __m128i CA   = _mm_add_epi32(_mm_and_si128(C, A), _mm_srli_epi32(
+               _mm_and_si128(_mm_xor_si128(C, A), lbmask), 1));
+      __m128i CE   = _mm_add_epi32(_mm_and_si128(C, E), _mm_srli_epi32(
+               _mm_and_si128(_mm_xor_si128(C, E), lbmask), 1));
+      __m128i o00  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi32(A, B)), CA, C);
+      __m128i o01  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi32(A, D)), CA, C);
+      __m128i o10  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi32(E, B)), CE, C);
+      __m128i o11  = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(skip, _mm_cmpeq_epi32(E, D)), CE, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x),
+            _mm_unpacklo_epi32(o00, o01));
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x + 4),
+            _mm_unpackhi_epi32(o00, o01));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x),
+            _mm_unpacklo_epi32(o10, o11));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x + 4),
+            _mm_unpackhi_epi32(o10, o11));
+   }
+
+   lq2x_span_xrgb8888(prev, cur, next, out0, out1, x, width, width);
+}
+#endif
+
+#ifdef LQ2X_NEON
+static void lq2x_row_rgb565_neon(const uint16_t *prev, const uint16_t *cur,
+      const uint16_t *next, uint16_t *out0, uint16_t *out1, unsigned width)
+{
+   unsigned x;
+   const uint16x8_t lbmask = vdupq_n_u16(0xf7de);
+
+   if (!width)
+      return;
+
+   lq2x_span_rgb565(prev, cur, next, out0, out1, 0, 1, width);
+
+   for (x = 1; x + 8 < width; x += 8)
+   {
+      uint16x8x2_t row0, row1;
+      uint16x8_t A    = vld1q_u16(prev + x);
+      uint16x8_t B    = vld1q_u16(cur  + x - 1);
+      uint16x8_t C    = vld1q_u16(cur  + x);
+      uint16x8_t D    = vld1q_u16(cur  + x + 1);
+      uint16x8_t E    = vld1q_u16(next + x);
+      uint16x8_t skip = vorrq_u16(vceqq_u16(A, E), vceqq_u16(B, D));
+      uint16x8_t CA   = vaddq_u16(vandq_u16(C, A),
+            vshrq_n_u16(vandq_u16(veorq_u16(C, A), lbmask), 1));
+      uint16x8_t CE   = vaddq_u16(vandq_u16(C, E),
+            vshrq_n_u16(vandq_u16(veorq_u16(C, E), lbmask), 1));
+
+      row0.val[0] = vbslq_u16(vbicq_u16(vceqq_u16(A, B), skip), CA, C);
+      row0.val[1] = vbslq_u16(vbicq_u16(vceqq_u16(A, D), skip), CA, C);
+      row1.val[0] = vbslq_u16(vbicq_u16(vceqq_u16(E, B), skip), CE, C);
+      row1.val[1] = vbslq_u16(vbicq_u16(vceqq_u16(E, D), skip), CE, C);
+
+      vst2q_u16(out0 + 2 * x, row0);
+      vst2q_u16(out1 + 2 * x, row1);
+   }
+
+   lq2x_span_rgb565(prev, cur, next, out0, out1, x, width, width);
+}
+
+static void lq2x_row_xrgb8888_neon(const uint32_t *prev, const uint32_t *cur,
+      const uint32_t *next, uint32_t *out0, uint32_t *out1, unsigned width)
+{
+   unsigned x;
+   const uint32x4_t lbmask = vdupq_n_u32(0xfefefefe);
+
+   if (!width)
+      return;
+
+   lq2x_span_xrgb8888(prev, cur, next, out0, out1, 0, 1, width);
+
+   for (x = 1; x + 4 < width; x += 4)
+   {
+      uint32x4x2_t row0, row1;
+      uint32x4_t A    = vld1q_u32(prev + x);
+      uint32x4_t B    = vld1q_u32(cur  + x - 1);
+      uint32x4_t C    = vld1q_u32(cur  + x);
+      uint32x4_t D    = vld1q_u32(cur  + x + 1);
+      uint32x4_t E    = vld1q_u32(next + x);
+      uint32x4_t skip = vorrq_u32(vceqq_u32(A, E), vceqq_u32(B, D));
+      uint32x4_t CA   = vaddq_u32(vandq_u32(C, A),
+            vshrq_n_u32(vandq_u32(veorq_u32(C, A), lbmask), 1));
+      uint32x4_t CE   = vaddq_u32(vandq_u32(C, E),
+            vshrq_n_u32(vandq_u32(veorq_u32(C, E), lbmask), 1));
+
+      row0.val[0] = vbslq_u32(vbicq_u32(vceqq_u32(A, B), skip), CA, C);
+      row0.val[1] = vbslq_u32(vbicq_u32(vceqq_u32(A, D), skip), CA, C);
+      row1.val[0] = vbslq_u32(vbicq_u32(vceqq_u32(E, B), skip), CE, C);
+      row1.val[1] = vbslq_u32(vbicq_u32(vceqq_u32(E, D), skip), CE, C);
+
+      vst2q_u32(out0 + 2 * x, row0);
+      vst2q_u32(out1 + 2 * x, row1);
+   }
+
+   lq2x_span_xrgb8888(prev, cur, next, out0, out1, x, width, width);
+}
+#endif
+
 static unsigned lq2x_generic_input_fmts(void)
 {
    return SOFTFILTER_FMT_RGB565 | SOFTFILTER_FMT_XRGB8888;
@@ -74,13 +330,30 @@ static void *lq2x_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   /* Each packet reads one row past either end of its rows,
+    * so the image can be split any number of ways. */
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
       free(filt);
       return NULL;
    }
+
+   filt->row_rgb565   = lq2x_row_rgb565_c;
+   filt->row_xrgb8888 = lq2x_row_xrgb8888_c;
+#ifdef LQ2X_SSE2
+   filt->row_rgb565   = lq2x_row_rgb565_sse2;
+   filt->row_xrgb8888 = lq2x_row_xrgb8888_sse2;
+#endif
+#ifdef LQ2X_NEON
+   if (simd & SOFTFILTER_SIMD_NEON)
+   {
+      filt->row_rgb565   = lq2x_row_rgb565_neon;
+      filt->row_xrgb8888 = lq2x_row_xrgb8888_neon;
+   }
+#endif
+
    return filt;
 }
 
@@ -103,92 +376,42 @@ static void lq2x_generic_destroy(void *data)
    free(filt);
 }
 
-static void lq2x_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+/* 'first' is the first row of this packet and 'last' is set for
+ * the packet holding the bottom row, rows outside the image are
+ * replaced by the edge row. */
+static void lq2x_generic_rgb565(struct filter_data *filt,
+      unsigned width, unsigned height,
+      int first, int last, const uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned x, y;
-   uint16_t *out0 = (uint16_t*)dst;
-   uint16_t *out1 = (uint16_t*)(dst + dst_stride);
+   unsigned y;
 
-   for(y = 0; y < height; y++)
+   for (y = 0; y < height; y++, src += src_stride, dst += 2 * dst_stride)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for(x = 0; x < width; x++)
-      {
-         uint16_t A, B, C, D, E, c;
-         A = *(src - prevline);
-         B = (x > 0) ? *(src - 1) : *src;
-         C = *src;
-         D = (x < width - 1) ? *(src + 1) : *src;
-         E = *(src++ + nextline);
-         c = C;
-
-         if(A != E && B != D)
-         {
-            *out0++ = (A == B ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out0++ = (A == D ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out1++ = (E == B ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-            *out1++ = (E == D ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
-      }
-
-      src += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
+      const uint16_t *prev = (first == 0 && y == 0)
+         ? src : src - src_stride;
+      const uint16_t *next = (last && y == height - 1)
+         ? src : src + src_stride;
+
+      filt->row_rgb565(prev, src, next, dst, dst + dst_stride, width);
    }
 }
 
-static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+static void lq2x_generic_xrgb8888(struct filter_data *filt,
+      unsigned width, unsigned height,
+      int first, int last, const uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned x, y;
-   uint32_t *out0 = (uint32_t*)dst;
-   uint32_t *out1 = (uint32_t*)(dst + dst_stride);
+   unsigned y;
 
-   for(y = 0; y < height; y++)
+   for (y = 0; y < height; y++, src += src_stride, dst += 2 * dst_stride)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for(x = 0; x < width; x++)
-      {
-         uint32_t A = *(src - prevline);
-         uint32_t B = (x > 0) ? *(src - 1) : *src;
-         uint32_t C = *src;
-         uint32_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint32_t E = *(src++ + nextline);
-         uint32_t c = C;
-
-         if(A != E && B != D)
-         {
-            *out0++ = (A == B ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out0++ = (A == D ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out1++ = (E == B ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-            *out1++ = (E == D ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
-      }
-
-      src += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
+      const uint32_t *prev = (first == 0 && y == 0)
+         ? src : src - src_stride;
+      const uint32_t *next = (last && y == height - 1)
+         ? src : src + src_stride;
+
+      filt->row_xrgb8888(prev, src, next, dst, dst + dst_stride, width);
    }
 }
 
@@ -196,12 +419,12 @@ static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
-   uint16_t *input = (uint16_t*)thr->in_data;
+   const uint16_t *input = (const uint16_t*)thr->in_data;
    uint16_t *output = (uint16_t*)thr->out_data;
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   lq2x_generic_rgb565(width, height,
+   lq2x_generic_rgb565((struct filter_data*)data, width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
@@ -212,14 +435,12 @@ static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
-   uint32_t *input = (uint32_t*)thr->in_data;
+   const uint32_t *input = (const uint32_t*)thr->in_data;
    uint32_t *output = (uint32_t*)thr->out_data;
    unsigned width = thr->width;
    unsigned height = thr->height;
 
-   (void)data;
-
-   lq2x_generic_xrgb8888(width, height,
+   lq2x_generic_xrgb8888((struct filter_data*)data, width, height,
          thr->first, thr->last, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
          output,
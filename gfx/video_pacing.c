@@ -0,0 +1,337 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "video_pacing.h"
+#include "../verbosity.h"
+
+/* Frames between two frame delay adjustments. */
+#define VIDEO_PACING_WINDOW       64
+/* Windows to wait after a missed vsync before
+ * trying a longer frame delay again. */
+#define VIDEO_PACING_HOLD         4
+/* Same limit as the video_frame_delay setting. */
+#define VIDEO_PACING_MAX_DELAY    15
+/* 60 fps content on a 480 Hz display. */
+#define VIDEO_PACING_MAX_BLACK_FRAMES 7
+
+/* Tight around the usual 60 Hz period, coarse elsewhere. */
+static const retro_time_t
+video_pacing_histogram_bounds[VIDEO_PACING_HISTOGRAM_BUCKETS - 1] = {
+   5000, 10000, 15000, 16000, 17000, 18000,
+   20000, 25000, 34000, 50000, 100000
+};
+
+#ifdef HAVE_THREADS
+/* Presents can be reported from the video thread. */
+static slock_t *video_pacing_lock                 = NULL;
+#endif
+
+static retro_time_t video_pacing_period           = 0;
+static retro_time_t video_pacing_frame_start      = 0;
+static retro_time_t video_pacing_last_present     = 0;
+static retro_time_t video_pacing_work_peak        = 0;
+static retro_time_t video_pacing_last_work_peak   = 0;
+static retro_time_t video_pacing_interval_sum     = 0;
+static unsigned video_pacing_interval_frames      = 0;
+static float video_pacing_interval_avg            = 0.0f;
+static unsigned video_pacing_window_frames        = 0;
+static unsigned video_pacing_missed               = 0;
+static unsigned video_pacing_hold                 = 0;
+static unsigned video_pacing_frame_delay          = 0;
+static bool video_pacing_display_timing           = false;
+/* Owned by the audio driver, survives video reinits. */
+static retro_time_t video_pacing_audio_latency    = 0;
+static uint64_t video_pacing_histogram_counts[VIDEO_PACING_HISTOGRAM_BUCKETS];
+static uint64_t video_pacing_histogram_sum        = 0;
+static uint64_t video_pacing_histogram_frames     = 0;
+
+static void video_pacing_lock_state(void)
+{
+#ifdef HAVE_THREADS
+   if (video_pacing_lock)
+      slock_lock(video_pacing_lock);
+#endif
+}
+
+static void video_pacing_unlock_state(void)
+{
+#ifdef HAVE_THREADS
+   if (video_pacing_lock)
+      slock_unlock(video_pacing_lock);
+#endif
+}
+
+void video_pacing_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!video_pacing_lock)
+      video_pacing_lock = slock_new();
+#endif
+
+   video_pacing_lock_state();
+   video_pacing_frame_start     = 0;
+   video_pacing_last_present    = 0;
+   video_pacing_work_peak       = 0;
+   video_pacing_last_work_peak  = 0;
+   video_pacing_interval_sum    = 0;
+   video_pacing_interval_frames = 0;
+   video_pacing_interval_avg    = 0.0f;
+   video_pacing_window_frames   = 0;
+   video_pacing_missed          = 0;
+   video_pacing_hold            = 0;
+   video_pacing_frame_delay     = 0;
+   video_pacing_display_timing  = false;
+   video_pacing_histogram_sum   = 0;
+   video_pacing_histogram_frames = 0;
+   memset(video_pacing_histogram_counts, 0,
+         sizeof(video_pacing_histogram_counts));
+   video_pacing_unlock_state();
+}
+
+void video_pacing_deinit(void)
+{
+#ifdef HAVE_THREADS
+   if (video_pacing_lock)
+      slock_free(video_pacing_lock);
+   video_pacing_lock = NULL;
+#endif
+}
+
+void video_pacing_set_refresh(float refresh_rate,
+      unsigned swap_interval, bool vsync)
+{
+   retro_time_t period = 0;
+
+   if (vsync && refresh_rate > 0.0f)
+      period = (retro_time_t)(1000000.0f
+            * (swap_interval ? swap_interval : 1) / refresh_rate);
+
+   video_pacing_lock_state();
+   video_pacing_period = period;
+   if (!period)
+      video_pacing_frame_delay = 0;
+   video_pacing_unlock_state();
+}
+
+unsigned video_pacing_black_frames(float display_hz, float core_fps,
+      bool vrr)
+{
+   unsigned refreshes;
+
+   if (vrr || display_hz <= 0.0f || core_fps <= 0.0f)
+      return 1;
+
+   /* Refreshes per core frame. A display that isn't an exact
+    * multiple, like 144 Hz for 60 fps, gets the nearest one. */
+   refreshes = (unsigned)(display_hz / core_fps + 0.5f);
+   if (refreshes < 2)
+      return 0;
+   if (refreshes > VIDEO_PACING_MAX_BLACK_FRAMES + 1)
+      refreshes = VIDEO_PACING_MAX_BLACK_FRAMES + 1;
+
+   return refreshes - 1;
+}
+
+void video_pacing_frame_begin(void)
+{
+   video_pacing_frame_start = cpu_features_get_time_usec();
+}
+
+/* Longest frame delay which leaves a frame taking @work,
+ * plus some margin for the GPU and the compositor,
+ * before the next vsync. */
+static unsigned video_pacing_delay_for(retro_time_t work)
+{
+   retro_time_t budget = video_pacing_period
+      - work - video_pacing_period / 8;
+   unsigned target     = budget > 0 ? (unsigned)(budget / 1000) : 0;
+
+   if (target > VIDEO_PACING_MAX_DELAY)
+      target = VIDEO_PACING_MAX_DELAY;
+   return target;
+}
+
+static void video_pacing_set_delay(unsigned delay)
+{
+   if (delay == video_pacing_frame_delay)
+      return;
+
+   RARCH_LOG("[Video]: Automatic frame delay: %u ms.\n", delay);
+   video_pacing_frame_delay = delay;
+}
+
+/* Longer delays are approached one millisecond per window,
+ * shorter ones are applied right away. */
+static void video_pacing_update_delay(void)
+{
+   unsigned target = video_pacing_delay_for(video_pacing_work_peak);
+
+   if (target < video_pacing_frame_delay)
+      video_pacing_set_delay(target);
+   else if (video_pacing_hold)
+      video_pacing_hold--;
+   else if (target > video_pacing_frame_delay)
+      video_pacing_set_delay(video_pacing_frame_delay + 1);
+}
+
+void video_pacing_frame_submit(retro_time_t time)
+{
+   retro_time_t work;
+
+   if (!video_pacing_frame_start)
+      return;
+
+   video_pacing_lock_state();
+
+   work                     = time - video_pacing_frame_start;
+   video_pacing_frame_start = 0;
+
+   if (work > video_pacing_work_peak)
+      video_pacing_work_peak = work;
+
+   /* A frame which couldn't have made it with the current
+    * delay backs off right away, not at the end of the window. */
+   if (video_pacing_period && video_pacing_frame_delay)
+   {
+      unsigned target = video_pacing_delay_for(work);
+
+      if (target < video_pacing_frame_delay)
+      {
+         video_pacing_set_delay(target);
+         video_pacing_hold = VIDEO_PACING_HOLD;
+      }
+   }
+
+   if (++video_pacing_window_frames >= VIDEO_PACING_WINDOW)
+   {
+      if (video_pacing_period)
+         video_pacing_update_delay();
+
+      if (video_pacing_interval_frames)
+         video_pacing_interval_avg = (float)video_pacing_interval_sum
+            / video_pacing_interval_frames / 1000.0f;
+
+      video_pacing_last_work_peak  = video_pacing_work_peak;
+      video_pacing_work_peak       = 0;
+      video_pacing_interval_sum    = 0;
+      video_pacing_interval_frames = 0;
+      video_pacing_window_frames   = 0;
+   }
+
+   video_pacing_unlock_state();
+}
+
+void video_pacing_present(retro_time_t time, unsigned frames)
+{
+   video_pacing_lock_state();
+
+   if (video_pacing_last_present && frames && time > video_pacing_last_present)
+   {
+      unsigned bucket       = 0;
+      retro_time_t interval = time - video_pacing_last_present;
+
+      video_pacing_interval_sum    += interval;
+      video_pacing_interval_frames += frames;
+
+      while (     bucket < VIDEO_PACING_HISTOGRAM_BUCKETS - 1
+               && video_pacing_histogram_bounds[bucket] < interval / frames)
+         bucket++;
+      video_pacing_histogram_counts[bucket] += frames;
+      video_pacing_histogram_sum            += interval;
+      video_pacing_histogram_frames         += frames;
+
+      if (video_pacing_period)
+      {
+         unsigned vsyncs = (unsigned)((interval + video_pacing_period / 2)
+               / video_pacing_period);
+
+         if (vsyncs > frames)
+         {
+            video_pacing_missed += vsyncs - frames;
+
+            /* Back off and stay there for a while. */
+            if (video_pacing_frame_delay)
+               video_pacing_set_delay(video_pacing_frame_delay - 1);
+            video_pacing_hold = VIDEO_PACING_HOLD;
+         }
+      }
+   }
+
+   video_pacing_last_present = time;
+
+   video_pacing_unlock_state();
+}
+
+void video_pacing_set_display_timing(bool enable)
+{
+   video_pacing_lock_state();
+   video_pacing_display_timing = enable;
+   video_pacing_last_present   = 0;
+   video_pacing_unlock_state();
+}
+
+bool video_pacing_has_display_timing(void)
+{
+   return video_pacing_display_timing;
+}
+
+unsigned video_pacing_get_frame_delay(void)
+{
+   return video_pacing_frame_delay;
+}
+
+retro_time_t video_pacing_get_period(void)
+{
+   return video_pacing_period;
+}
+
+void video_pacing_set_audio_latency(retro_time_t usec)
+{
+   video_pacing_lock_state();
+   video_pacing_audio_latency = usec;
+   video_pacing_unlock_state();
+}
+
+void video_pacing_get_stats(video_pacing_stats_t *stats)
+{
+   video_pacing_lock_state();
+   stats->present_interval = video_pacing_interval_avg;
+   stats->work_time        = video_pacing_last_work_peak / 1000.0f;
+   stats->missed_vsyncs    = video_pacing_missed;
+   stats->frame_delay      = video_pacing_frame_delay;
+   stats->audio_latency    = video_pacing_audio_latency / 1000.0f;
+   stats->display_timing   = video_pacing_display_timing;
+   video_pacing_unlock_state();
+}
+
+void video_pacing_get_histogram(video_pacing_histogram_t *histogram)
+{
+   video_pacing_lock_state();
+   histogram->bounds = video_pacing_histogram_bounds;
+   histogram->sum    = video_pacing_histogram_sum;
+   histogram->frames = video_pacing_histogram_frames;
+   memcpy(histogram->counts, video_pacing_histogram_counts,
+         sizeof(histogram->counts));
+   video_pacing_unlock_state();
+}
@@ -0,0 +1,135 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VIDEO_PACING_H
+#define __VIDEO_PACING_H
+
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+#include <libretro.h>
+
+RETRO_BEGIN_DECLS
+
+typedef struct video_pacing_stats
+{
+   /* Average time between two presents, in ms. */
+   float present_interval;
+   /* Slowest frame of the last window, from core_run()
+    * to the frame reaching the video driver, in ms. */
+   float work_time;
+   unsigned missed_vsyncs;
+   /* Frame delay picked by video_frame_delay_auto, in ms. */
+   unsigned frame_delay;
+   /* How far ahead of the speakers audio runs, in ms,
+    * 0 if the audio driver doesn't report it. */
+   float audio_latency;
+   /* Present times come from the display instead of
+    * being sampled after the driver returns. */
+   bool display_timing;
+} video_pacing_stats_t;
+
+#define VIDEO_PACING_HISTOGRAM_BUCKETS 12
+
+/* Cumulative since video_pacing_init(), each present
+ * interval is counted once per frame it covers. */
+typedef struct video_pacing_histogram
+{
+   /* Upper bound of each bucket but the last in usec,
+    * the last one takes everything slower. */
+   const retro_time_t *bounds;
+   uint64_t counts[VIDEO_PACING_HISTOGRAM_BUCKETS];
+   /* Total of all intervals, in usec. */
+   uint64_t sum;
+   uint64_t frames;
+} video_pacing_histogram_t;
+
+void video_pacing_init(void);
+
+void video_pacing_deinit(void);
+
+/**
+ * video_pacing_set_refresh:
+ * @refresh_rate        : display refresh rate in Hz.
+ * @swap_interval       : vsyncs per frame.
+ * @vsync               : false disables miss detection
+ *                        and the automatic frame delay.
+ **/
+void video_pacing_set_refresh(float refresh_rate,
+      unsigned swap_interval, bool vsync);
+
+/**
+ * video_pacing_black_frames:
+ * @display_hz          : refresh rate the display runs at,
+ *                        0 if the context can't tell.
+ * @core_fps            : frame rate of the content.
+ * @vrr                 : the display follows the frame rate.
+ *
+ * Picks the black frame insertion pattern: how many black
+ * frames follow each frame, so the image is shown for a single
+ * refresh per core frame. A 60 fps core gets one on a 120 Hz
+ * display and three on a 240 Hz one. An unknown or variable
+ * refresh rate gets one, as before.
+ *
+ * Returns: number of black frames, 0 if the display is too
+ * slow to fit any.
+ **/
+unsigned video_pacing_black_frames(float display_hz, float core_fps,
+      bool vrr);
+
+/* Called right before the core runs, after any frame delay. */
+void video_pacing_frame_begin(void);
+
+/* Called when the frame is handed to the video driver. */
+void video_pacing_frame_submit(retro_time_t time);
+
+/**
+ * video_pacing_present:
+ * @time                : when the frame hit the display, in usec.
+ *                        Only differences between calls are used,
+ *                        so any monotonic clock will do.
+ * @frames              : number of frames presented since the
+ *                        previous call, usually 1.
+ **/
+void video_pacing_present(retro_time_t time, unsigned frames);
+
+/* Drivers which call video_pacing_present() with real
+ * display timestamps set this, the frontend then stops
+ * sampling present times on its own. */
+void video_pacing_set_display_timing(bool enable);
+
+bool video_pacing_has_display_timing(void);
+
+/* Audio drivers which can tell how long a sample takes from
+ * write() to the speakers report it here, in usec, and reset
+ * it to 0 when they go away. May be called from any thread. */
+void video_pacing_set_audio_latency(retro_time_t usec);
+
+/* Latest frame delay (in ms) which still makes vsync. */
+unsigned video_pacing_get_frame_delay(void);
+
+/* Time between two vsyncs the frame has to fit in, in usec,
+ * 0 without vsync. */
+retro_time_t video_pacing_get_period(void);
+
+void video_pacing_get_stats(video_pacing_stats_t *stats);
+
+void video_pacing_get_histogram(video_pacing_histogram_t *histogram);
+
+RETRO_END_DECLS
+
+#endif
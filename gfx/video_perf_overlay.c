@@ -0,0 +1,419 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "video_perf_overlay.h"
+#include "video_pacing.h"
+#include "font_driver.h"
+
+#ifdef HAVE_MENU
+#include "../menu/menu_driver.h"
+#endif
+
+#ifdef HAVE_NETWORKING
+#include "../network/netplay/netplay.h"
+#endif
+
+#ifdef HAVE_RUNAHEAD
+#include "../runahead/run_ahead.h"
+#endif
+
+#ifdef HAVE_NETWORKGAMEPAD
+#include "../input/input_remote.h"
+#endif
+
+#include "../audio/audio_driver.h"
+#include "../configuration.h"
+#include "../performance_counters.h"
+#include "../managers/memory_budget.h"
+
+/* Frames shown in the graph. */
+#define VIDEO_PERF_OVERLAY_FRAMES        120
+/* Frames between two text updates, so the numbers stay readable. */
+#define VIDEO_PERF_OVERLAY_TEXT_INTERVAL 15
+
+typedef struct video_perf_overlay_state
+{
+   uint32_t frame[VIDEO_PERF_OVERLAY_FRAMES];
+   uint32_t core[VIDEO_PERF_OVERLAY_FRAMES];
+   uint32_t video[VIDEO_PERF_OVERLAY_FRAMES];
+   uint32_t audio[VIDEO_PERF_OVERLAY_FRAMES];
+   /* Frame time of the core's frame rate, in usec. */
+   uint32_t target;
+   unsigned count;
+   char text[1024];
+} video_perf_overlay_state_t;
+
+#ifdef HAVE_THREADS
+/* Updated on the main thread, drawn on the video thread. */
+static slock_t *video_perf_overlay_lock             = NULL;
+#endif
+
+static video_perf_overlay_state_t video_perf_overlay;
+static unsigned video_perf_overlay_text_frames      = 0;
+
+void video_perf_overlay_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!video_perf_overlay_lock)
+      video_perf_overlay_lock = slock_new();
+
+   if (video_perf_overlay_lock)
+      slock_lock(video_perf_overlay_lock);
+#endif
+   memset(&video_perf_overlay, 0, sizeof(video_perf_overlay));
+   video_perf_overlay_text_frames = 0;
+#ifdef HAVE_THREADS
+   if (video_perf_overlay_lock)
+      slock_unlock(video_perf_overlay_lock);
+#endif
+}
+
+void video_perf_overlay_deinit(void)
+{
+#ifdef HAVE_THREADS
+   if (video_perf_overlay_lock)
+      slock_free(video_perf_overlay_lock);
+   video_perf_overlay_lock = NULL;
+#endif
+}
+
+static void video_perf_overlay_build_text(char *s, size_t len,
+      const video_perf_overlay_state_t *state, uint64_t frame_dupes)
+{
+   unsigned i;
+   video_pacing_stats_t pacing_stats;
+   memory_budget_stats_t budget;
+   audio_statistics_t audio_stats = {0.0f};
+   uint64_t frame_sum             = 0;
+   uint64_t core_sum              = 0;
+   uint64_t video_sum             = 0;
+   uint64_t audio_sum             = 0;
+   uint32_t frame_max             = 0;
+   float gpu_sum                  = 0.0f;
+   unsigned gpu_count             = 0;
+   perf_gpu_pass_t gpu_passes[PERF_GPU_PASSES];
+   unsigned count                 = MAX(state->count, 1);
+   size_t pos                     = 0;
+#ifdef HAVE_RUNAHEAD
+   settings_t *settings           = config_get_ptr();
+#endif
+#ifdef HAVE_NETWORKING
+   struct netplay_stats netplay_stats;
+#endif
+
+   for (i = 0; i < state->count; i++)
+   {
+      frame_sum += state->frame[i];
+      core_sum  += state->core[i];
+      video_sum += state->video[i];
+      audio_sum += state->audio[i];
+      frame_max  = MAX(frame_max, state->frame[i]);
+   }
+
+   compute_audio_buffer_statistics(&audio_stats);
+   video_pacing_get_stats(&pacing_stats);
+
+   pos += snprintf(s + pos, len - pos,
+         "Frame: %6.2f ms (max %6.2f, target %6.2f)\n"
+         "Core: %5.2f ms  Video: %5.2f ms  Audio: %5.2f ms\n"
+         "Audio buffer: %5.1f %% (underrun %4.1f %%, blocking %4.1f %%)\n"
+         "Dropped: %u  Duplicated: %" PRIu64 "\n",
+         frame_sum / 1000.0 / count,
+         frame_max / 1000.0,
+         state->target / 1000.0,
+         core_sum  / 1000.0 / count,
+         video_sum / 1000.0 / count,
+         audio_sum / 1000.0 / count,
+         audio_stats.average_buffer_saturation,
+         audio_stats.close_to_underrun,
+         audio_stats.close_to_blocking,
+         pacing_stats.missed_vsyncs,
+         frame_dupes);
+
+#ifdef HAVE_RUNAHEAD
+   if (settings->bools.run_ahead_enabled && pos < len)
+   {
+      runahead_stats_t runahead_stats;
+
+      runahead_get_stats(&runahead_stats);
+      pos += snprintf(s + pos, len - pos,
+            "Runahead: %u frames, %" PRIu64 " rollbacks, %" PRIu64 " hidden\n",
+            runahead_stats.frames,
+            runahead_stats.rollbacks,
+            runahead_stats.hidden_frames);
+   }
+#endif
+
+#ifdef HAVE_NETWORKING
+   if (     pos < len
+         && netplay_driver_ctl(RARCH_NETPLAY_CTL_GET_STATS, &netplay_stats))
+      pos += snprintf(s + pos, len - pos,
+            "Netplay: %" PRIu64 " rollbacks, %" PRIu64 " replayed frames\n",
+            netplay_stats.rollbacks,
+            netplay_stats.replayed_frames);
+#endif
+
+#ifdef HAVE_NETWORKGAMEPAD
+   for (i = 0; i < MAX_USERS && pos < len; i++)
+   {
+      input_remote_stats_t remote_stats;
+
+      if (!input_remote_get_stats(i, &remote_stats))
+         continue;
+
+      pos += snprintf(s + pos, len - pos,
+            "Remote %u: age %5.2f ms, jitter %5.2f ms, "
+            "%" PRIu64 " lost, %" PRIu64 " late\n",
+            i + 1,
+            remote_stats.age / 1000.0,
+            remote_stats.jitter / 1000.0,
+            remote_stats.lost,
+            remote_stats.reordered);
+   }
+#endif
+
+   memory_budget_get_stats(&budget);
+   if (budget.caches && pos < len)
+      pos += snprintf(s + pos, len - pos,
+            "Caches: %5.1f of %5.1f MB, %u evictions\n",
+            budget.used / (1024.0 * 1024.0),
+            budget.budget / (1024.0 * 1024.0),
+            budget.evictions);
+
+   gpu_count = performance_gpu_passes_get(gpu_passes, PERF_GPU_PASSES);
+   if (!gpu_count || pos >= len)
+      return;
+
+   for (i = 0; i < gpu_count; i++)
+      gpu_sum += gpu_passes[i].time_us;
+
+   pos += snprintf(s + pos, len - pos,
+         "GPU passes: %5.2f ms", gpu_sum / 1000.0);
+
+   /* Four passes to a line */
+   for (i = 0; i < gpu_count && pos < len; i++)
+      pos += snprintf(s + pos, len - pos, "%s#%u %5.2f",
+            i % 4 ? "  " : "\n  ",
+            i, gpu_passes[i].time_us / 1000.0);
+
+   if (pos < len)
+      pos += snprintf(s + pos, len - pos, "\n");
+}
+
+void video_perf_overlay_update(uint64_t frame_dupes)
+{
+   static video_perf_overlay_state_t state;
+   struct retro_system_av_info *av_info = video_viewport_get_system_av_info();
+
+   state.count  = performance_zone_history(PERF_ZONE_FRAME, false,
+         state.frame, VIDEO_PERF_OVERLAY_FRAMES);
+   performance_zone_history(PERF_ZONE_CORE_RUN, true,
+         state.core, state.count);
+   performance_zone_history(PERF_ZONE_VIDEO_FRAME, false,
+         state.video, state.count);
+   performance_zone_history(PERF_ZONE_AUDIO_FLUSH, false,
+         state.audio, state.count);
+   state.target = (av_info && av_info->timing.fps > 0.0)
+      ? (uint32_t)(1000000.0 / av_info->timing.fps)
+      : 16667;
+
+   if (video_perf_overlay_text_frames++ % VIDEO_PERF_OVERLAY_TEXT_INTERVAL == 0)
+      video_perf_overlay_build_text(state.text, sizeof(state.text),
+            &state, frame_dupes);
+
+#ifdef HAVE_THREADS
+   if (video_perf_overlay_lock)
+      slock_lock(video_perf_overlay_lock);
+#endif
+   video_perf_overlay = state;
+#ifdef HAVE_THREADS
+   if (video_perf_overlay_lock)
+      slock_unlock(video_perf_overlay_lock);
+#endif
+}
+
+#ifdef HAVE_MENU
+static void video_perf_overlay_set_color(float *color,
+      float r, float g, float b, float a)
+{
+   unsigned i;
+
+   for (i = 0; i < 4; i++)
+   {
+      color[i * 4 + 0] = r;
+      color[i * 4 + 1] = g;
+      color[i * 4 + 2] = b;
+      color[i * 4 + 3] = a;
+   }
+}
+
+/* Draws 'time' at 'pos' pixels up a bar, returns the new top. */
+static unsigned video_perf_overlay_draw_segment(
+      video_frame_info_t *video_info,
+      int x, int bottom, unsigned bar_width, unsigned graph_height,
+      unsigned pos, uint32_t time, uint32_t scale, float *color)
+{
+   unsigned height = (unsigned)((uint64_t)time * graph_height / scale);
+
+   if (pos >= graph_height)
+      return pos;
+   if (height > graph_height - pos)
+      height = graph_height - pos;
+   if (height)
+      menu_display_draw_quad(video_info, x, bottom - (int)(pos + height),
+            bar_width, height, video_info->width, video_info->height,
+            color);
+
+   return pos + height;
+}
+
+/* Stacked bars, oldest frame on the left. The graph is two target
+ * frame times high, so the middle line is the frame budget. */
+static void video_perf_overlay_draw_graph(video_frame_info_t *video_info,
+      const video_perf_overlay_state_t *state,
+      int x, int y, unsigned bar_width, unsigned graph_height)
+{
+   unsigned i;
+   float color[16];
+   uint32_t scale = state->target * 2;
+   int bottom     = y + (int)graph_height;
+   int left       = x + (int)((VIDEO_PERF_OVERLAY_FRAMES - state->count)
+         * bar_width);
+
+   if (!menu_display_white_texture || !scale)
+      return;
+
+   video_perf_overlay_set_color(color, 0.0f, 0.0f, 0.0f, 0.6f);
+   menu_display_draw_quad(video_info, x, y,
+         bar_width * VIDEO_PERF_OVERLAY_FRAMES, graph_height,
+         video_info->width, video_info->height, color);
+
+   for (i = 0; i < state->count; i++)
+   {
+      unsigned pos = 0;
+      int bar_x    = left + (int)(i * bar_width);
+      /* Whatever isn't core, video or audio: input,
+       * frontend work and waiting for vsync. */
+      uint32_t rest = state->frame[i];
+
+      rest = rest > state->core[i]  ? rest - state->core[i]  : 0;
+      rest = rest > state->video[i] ? rest - state->video[i] : 0;
+      rest = rest > state->audio[i] ? rest - state->audio[i] : 0;
+
+      video_perf_overlay_set_color(color, 0.30f, 0.55f, 1.00f, 0.9f);
+      pos = video_perf_overlay_draw_segment(video_info, bar_x, bottom,
+            bar_width, graph_height, pos, state->core[i], scale, color);
+      video_perf_overlay_set_color(color, 0.35f, 0.85f, 0.35f, 0.9f);
+      pos = video_perf_overlay_draw_segment(video_info, bar_x, bottom,
+            bar_width, graph_height, pos, state->video[i], scale, color);
+      video_perf_overlay_set_color(color, 1.00f, 0.65f, 0.20f, 0.9f);
+      pos = video_perf_overlay_draw_segment(video_info, bar_x, bottom,
+            bar_width, graph_height, pos, state->audio[i], scale, color);
+
+      /* Frames which blew the budget by half stand out. */
+      if (state->frame[i] > state->target + state->target / 2)
+         video_perf_overlay_set_color(color, 1.0f, 0.2f, 0.2f, 0.9f);
+      else
+         video_perf_overlay_set_color(color, 0.6f, 0.6f, 0.6f, 0.6f);
+      video_perf_overlay_draw_segment(video_info, bar_x, bottom,
+            bar_width, graph_height, pos, rest, scale, color);
+   }
+
+   video_perf_overlay_set_color(color, 1.0f, 1.0f, 1.0f, 0.5f);
+   menu_display_draw_quad(video_info, x, y + (int)graph_height / 2,
+         bar_width * VIDEO_PERF_OVERLAY_FRAMES, 1,
+         video_info->width, video_info->height, color);
+}
+#endif
+
+void video_perf_overlay_render(video_frame_info_t *video_info)
+{
+   struct font_params params;
+   static video_perf_overlay_state_t state;
+   char text[sizeof(state.text) + 32];
+   unsigned draw_calls;
+   settings_t *settings  = config_get_ptr();
+   unsigned width        = video_info->width;
+   unsigned height       = video_info->height;
+   unsigned margin       = height / 50;
+   unsigned bar_width    = MAX(width * 3 / 10 / VIDEO_PERF_OVERLAY_FRAMES, 1);
+   unsigned graph_height = height * 3 / 20;
+   int x                 = (int)width - (int)margin
+      - (int)(bar_width * VIDEO_PERF_OVERLAY_FRAMES);
+
+   if (!width || !height)
+      return;
+
+#ifdef HAVE_THREADS
+   if (video_perf_overlay_lock)
+      slock_lock(video_perf_overlay_lock);
+#endif
+   state = video_perf_overlay;
+#ifdef HAVE_THREADS
+   if (video_perf_overlay_lock)
+      slock_unlock(video_perf_overlay_lock);
+#endif
+
+   if (x < 0)
+      x = 0;
+
+   /* Everything drawn since the last time, the overlay's own
+    * graph and text are counted towards the next frame. */
+   draw_calls = font_driver_get_osd_draw_calls(true);
+#ifdef HAVE_MENU
+   draw_calls += menu_display_get_draw_calls(true);
+
+   menu_display_quad_batch_begin();
+   video_perf_overlay_draw_graph(video_info, &state,
+         x, (int)margin, bar_width, graph_height);
+   menu_display_quad_batch_end(video_info);
+#endif
+
+   if (!*state.text)
+      return;
+
+   snprintf(text, sizeof(text), "%sDraw calls: %u\n",
+         state.text, draw_calls);
+
+   /* Font positions count up from the bottom of the screen,
+    * to the baseline of the first line. */
+   params.scale       = 0.75f;
+   params.x           = (float)x / width;
+   params.y           = 1.0f - (float)(margin * 2 + graph_height) / height
+      - settings->floats.video_font_size * params.scale / height;
+   params.drop_mod    = 0.3f;
+   params.drop_x      = -2;
+   params.drop_y      = -2;
+   params.drop_alpha  = 1.0f;
+   params.color       = COLOR_ABGR(255, 255, 255, 255);
+   params.full_screen = true;
+   params.text_align  = TEXT_ALIGN_LEFT;
+
+   font_driver_render_msg(video_info, NULL, text, &params);
+}
@@ -0,0 +1,57 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VIDEO_PERF_OVERLAY_H
+#define __VIDEO_PERF_OVERLAY_H
+
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+#include "video_driver.h"
+
+RETRO_BEGIN_DECLS
+
+void video_perf_overlay_init(void);
+
+void video_perf_overlay_deinit(void);
+
+/**
+ * video_perf_overlay_update:
+ * @frame_dupes         : frames the core asked to have
+ *                        duplicated so far.
+ *
+ * Samples the frame profiler and the audio, pacing, runahead
+ * and netplay statistics. Called from video_driver_frame(),
+ * on the main thread.
+ **/
+void video_perf_overlay_update(uint64_t frame_dupes);
+
+/**
+ * video_perf_overlay_render:
+ * @video_info          : frame info passed to the driver.
+ *
+ * Draws a frame time graph and the timings of the last
+ * update. Called by video drivers from their frame function,
+ * which may run on the video thread. The graph needs a menu
+ * display driver, without one only the text is shown.
+ **/
+void video_perf_overlay_render(video_frame_info_t *video_info);
+
+RETRO_END_DECLS
+
+#endif
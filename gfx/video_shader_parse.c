@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 
 #ifdef HAVE_CONFIG_H
@@ -34,6 +35,7 @@
 
 #include "../verbosity.h"
 #include "../configuration.h"
+#include "../paths.h"
 #include "../frontend/frontend_driver.h"
 #include "../command.h"
 #include "video_driver.h"
@@ -45,6 +47,146 @@
 
 static path_change_data_t *file_change_data = NULL;
 
+/* Presets parsed recently. The shader menu reloads the preset for
+ * every preview, and a miss costs a realpath and an exists check for
+ * every pass and LUT on top of the parse. Entries are keyed on the
+ * preset path and dropped when its size or mtime changes.
+ *
+ * Only what video_shader_read_conf_cgp fills in is kept: a full
+ * struct video_shader is mostly unused pass and parameter slots. */
+#define VIDEO_SHADER_PRESET_CACHE_SIZE 4
+
+typedef struct video_shader_preset_cache_entry
+{
+   char *path;
+   struct video_shader_pass *pass;
+   struct video_shader_lut *lut;
+   struct state_tracker_uniform_info *variable;
+   int64_t mtime;
+   int32_t size;
+   unsigned last_used;
+   /* Everything in struct video_shader before the pass array */
+   char header[offsetof(struct video_shader, pass)];
+} video_shader_preset_cache_entry_t;
+
+static video_shader_preset_cache_entry_t
+   video_shader_preset_cache[VIDEO_SHADER_PRESET_CACHE_SIZE];
+static unsigned video_shader_preset_cache_clock = 0;
+
+static void video_shader_preset_cache_entry_free(
+      video_shader_preset_cache_entry_t *entry)
+{
+   free(entry->path);
+   free(entry->pass);
+   free(entry->lut);
+   free(entry->variable);
+   memset(entry, 0, sizeof(*entry));
+}
+
+/* Presets pulling in other files through #include aren't cached,
+ * only the top-level file would be checked for changes. */
+static bool video_shader_preset_cache_key(config_file_t *conf,
+      int32_t *size, int64_t *mtime)
+{
+   if (!conf || string_is_empty(conf->path) || conf->includes)
+      return false;
+
+   return path_get_size_mtime(conf->path, size, mtime);
+}
+
+static bool video_shader_preset_cache_find(config_file_t *conf,
+      struct video_shader *shader)
+{
+   unsigned i;
+   int32_t size  = 0;
+   int64_t mtime = 0;
+
+   if (!video_shader_preset_cache_key(conf, &size, &mtime))
+      return false;
+
+   for (i = 0; i < VIDEO_SHADER_PRESET_CACHE_SIZE; i++)
+   {
+      video_shader_preset_cache_entry_t *entry =
+         &video_shader_preset_cache[i];
+
+      if (!entry->path || !string_is_equal(entry->path, conf->path))
+         continue;
+
+      if (entry->size != size || entry->mtime != mtime)
+      {
+         video_shader_preset_cache_entry_free(entry);
+         return false;
+      }
+
+      memcpy(shader, entry->header, sizeof(entry->header));
+      memcpy(shader->pass, entry->pass,
+            shader->passes * sizeof(*shader->pass));
+      memcpy(shader->lut, entry->lut,
+            shader->luts * sizeof(*shader->lut));
+      memcpy(shader->variable, entry->variable,
+            shader->variables * sizeof(*shader->variable));
+
+      entry->last_used = ++video_shader_preset_cache_clock;
+      return true;
+   }
+
+   return false;
+}
+
+static void video_shader_preset_cache_store(config_file_t *conf,
+      const struct video_shader *shader)
+{
+   unsigned i;
+   int32_t size                             = 0;
+   int64_t mtime                            = 0;
+   video_shader_preset_cache_entry_t *entry = &video_shader_preset_cache[0];
+
+   if (!video_shader_preset_cache_key(conf, &size, &mtime))
+      return;
+
+   for (i = 0; i < VIDEO_SHADER_PRESET_CACHE_SIZE; i++)
+   {
+      video_shader_preset_cache_entry_t *cur = &video_shader_preset_cache[i];
+
+      if (cur->path && string_is_equal(cur->path, conf->path))
+      {
+         entry = cur;
+         break;
+      }
+
+      if (cur->last_used < entry->last_used)
+         entry = cur;
+   }
+
+   video_shader_preset_cache_entry_free(entry);
+
+   entry->path     = strdup(conf->path);
+   entry->pass     = (struct video_shader_pass*)
+      malloc(MAX(shader->passes, 1) * sizeof(*entry->pass));
+   entry->lut      = (struct video_shader_lut*)
+      malloc(MAX(shader->luts, 1) * sizeof(*entry->lut));
+   entry->variable = (struct state_tracker_uniform_info*)
+      malloc(MAX(shader->variables, 1) * sizeof(*entry->variable));
+
+   if (!entry->path || !entry->pass || !entry->lut || !entry->variable)
+   {
+      video_shader_preset_cache_entry_free(entry);
+      return;
+   }
+
+   memcpy(entry->header, shader, sizeof(entry->header));
+   memcpy(entry->pass, shader->pass,
+         shader->passes * sizeof(*shader->pass));
+   memcpy(entry->lut, shader->lut,
+         shader->luts * sizeof(*shader->lut));
+   memcpy(entry->variable, shader->variable,
+         shader->variables * sizeof(*shader->variable));
+
+   entry->size      = size;
+   entry->mtime     = mtime;
+   entry->last_used = ++video_shader_preset_cache_clock;
+}
+
 /**
  * wrap_mode_to_str:
  * @type              : Wrap type.
@@ -715,18 +857,58 @@ error:
  *
  * Returns: true (1) if successful, otherwise false (0).
  **/
+static void video_shader_watch_files(const char *preset_path,
+      const struct video_shader *shader)
+{
+   unsigned i;
+   union string_list_elem_attr attr;
+   struct string_list *file_list = NULL;
+   int flags                     = PATH_CHANGE_TYPE_MODIFIED          |
+                                   PATH_CHANGE_TYPE_WRITE_FILE_CLOSED |
+                                   PATH_CHANGE_TYPE_FILE_MOVED        |
+                                   PATH_CHANGE_TYPE_FILE_DELETED;
+
+   attr.i = 0;
+
+   if (file_change_data)
+      frontend_driver_watch_path_for_changes(NULL,
+            0, &file_change_data);
+
+   file_change_data = NULL;
+   file_list        = string_list_new();
+
+   if (!file_list)
+      return;
+
+   string_list_append(file_list, preset_path, attr);
+
+   for (i = 0; i < shader->passes; i++)
+      string_list_append(file_list,
+            shader->pass[i].source.path, attr);
+
+   frontend_driver_watch_path_for_changes(file_list,
+         flags, &file_change_data);
+   string_list_free(file_list);
+}
+
 bool video_shader_read_conf_cgp(config_file_t *conf,
       struct video_shader *shader)
 {
    unsigned i;
-   union string_list_elem_attr attr;
    unsigned shaders                 = 0;
    settings_t *settings             = config_get_ptr();
-   struct string_list *file_list    = NULL;
-
-   (void)file_list;
 
    memset(shader, 0, sizeof(*shader));
+
+   if (video_shader_preset_cache_find(conf, shader))
+   {
+      if (settings->bools.video_shader_watch_files)
+         video_shader_watch_files(conf->path, shader);
+
+      command_event(CMD_EVENT_SHADER_PRESET_LOADED, NULL);
+      return true;
+   }
+
    shader->type = RARCH_SHADER_CG;
 
    if (!config_get_uint(conf, "shaders", &shaders))
@@ -746,50 +928,17 @@ bool video_shader_read_conf_cgp(config_file_t *conf,
       shader->feedback_pass = -1;
 
    shader->passes = MIN(shaders, GFX_MAX_SHADERS);
-   attr.i         = 0;
 
    strlcpy(shader->path, conf->path, sizeof(shader->path));
 
-   if (settings->bools.video_shader_watch_files)
-   {
-      if (file_change_data)
-         frontend_driver_watch_path_for_changes(NULL,
-               0, &file_change_data);
-
-      file_change_data = NULL;
-      file_list        = string_list_new();
-      string_list_append(file_list, conf->path, attr);
-   }
-
    for (i = 0; i < shader->passes; i++)
    {
       if (!video_shader_parse_pass(conf, &shader->pass[i], i))
-      {
-         if (file_list)
-         {
-            string_list_free(file_list);
-            file_list = NULL;
-         }
          return false;
-      }
-
-      if (settings->bools.video_shader_watch_files && file_list)
-         string_list_append(file_list,
-               shader->pass[i].source.path, attr);
    }
 
    if (settings->bools.video_shader_watch_files)
-   {
-      int flags = PATH_CHANGE_TYPE_MODIFIED          |
-                  PATH_CHANGE_TYPE_WRITE_FILE_CLOSED |
-                  PATH_CHANGE_TYPE_FILE_MOVED        |
-                  PATH_CHANGE_TYPE_FILE_DELETED;
-
-      frontend_driver_watch_path_for_changes(file_list,
-            flags, &file_change_data);
-      if (file_list)
-         string_list_free(file_list);
-   }
+      video_shader_watch_files(conf->path, shader);
 
    command_event(CMD_EVENT_SHADER_PRESET_LOADED, NULL);
 
@@ -799,6 +948,8 @@ bool video_shader_read_conf_cgp(config_file_t *conf,
    if (!video_shader_parse_imports(conf, shader))
       return false;
 
+   video_shader_preset_cache_store(conf, shader);
+
    return true;
 }
 
@@ -1347,3 +1498,26 @@ bool video_shader_check_for_changes(void)
 
    return frontend_driver_check_for_path_changes(file_change_data);
 }
+
+bool video_shader_get_cache_dir(char *s, size_t len)
+{
+   char base[PATH_MAX_LENGTH];
+   settings_t *settings = config_get_ptr();
+
+   base[0] = '\0';
+
+   if (settings && !string_is_empty(settings->paths.directory_cache))
+      strlcpy(base, settings->paths.directory_cache, sizeof(base));
+   else if (!path_is_empty(RARCH_PATH_CONFIG))
+      fill_pathname_basedir(base, path_get(RARCH_PATH_CONFIG), sizeof(base));
+
+   if (string_is_empty(base))
+      return false;
+
+   fill_pathname_join(s, base, "shaders", len);
+
+   if (!path_is_directory(s) && !path_mkdir(s))
+      return false;
+
+   return true;
+}
@@ -177,6 +177,10 @@ struct video_shader
  * Loads preset file and all associated state (passes,
  * textures, imports, etc).
  *
+ * The last few presets parsed are cached by path, size and mtime.
+ * A preset that hasn't changed on disk is copied out of the cache
+ * instead of being parsed again.
+ *
  * Returns: true (1) if successful, otherwise false (0).
  **/
 bool video_shader_read_conf_cgp(config_file_t *conf,
@@ -251,6 +255,19 @@ bool video_shader_any_supported(void);
 
 bool video_shader_check_for_changes(void);
 
+/**
+ * video_shader_get_cache_dir:
+ * @s                    : output directory path.
+ * @len                  : size of @s.
+ *
+ * Directory for compiled shader caches: "shaders" inside the
+ * cache directory, or next to the config file if no cache
+ * directory is set. Created if it does not exist yet.
+ *
+ * Returns: true if the directory can be used.
+ **/
+bool video_shader_get_cache_dir(char *s, size_t len);
+
 RETRO_END_DECLS
 
 #endif
@@ -28,6 +28,7 @@
 
 #include "../retroarch.h"
 #include "../verbosity.h"
+#include "../performance_counters.h"
 
 enum thread_cmd
 {
@@ -144,6 +145,19 @@ struct thread_packet
    } data;
 };
 
+/* Commands queued ahead of the video thread. Anything that doesn't
+ * return data is fire-and-forget and gets picked up in one go before
+ * the next frame; the rest still waits for its reply. */
+#define THREAD_CMD_RING_SIZE 64
+
+typedef struct thread_cmd_entry
+{
+   thread_packet_t pkt;
+   /* NULL for fire-and-forget commands. */
+   thread_packet_t *reply;
+   bool *done;
+} thread_cmd_entry_t;
+
 struct thread_video
 {
    slock_t *lock;
@@ -194,9 +208,15 @@ struct thread_video
    slock_t *alpha_lock;
 
    void (*send_and_wait)(struct thread_video *, thread_packet_t*);
-   enum thread_cmd send_cmd;
-   enum thread_cmd reply_cmd;
-   thread_packet_t cmd_data;
+
+   /* Protected by lock. */
+   thread_cmd_entry_t cmd_ring[THREAD_CMD_RING_SIZE];
+   unsigned cmd_head;
+   unsigned cmd_count;
+
+   /* Reply target of the command the video thread is running. */
+   thread_packet_t *cmd_reply;
+   bool *cmd_done;
 
    struct video_viewport vp;
    struct video_viewport read_vp; /* Last viewport reported to caller. */
@@ -204,7 +224,12 @@ struct thread_video
    struct
    {
       slock_t *lock;
+      /* Points to one of buffers[], the video thread reads it
+       * while updated is set. The other one is handed to cores
+       * through get_current_software_framebuffer. */
       uint8_t *buffer;
+      uint8_t *buffers[2];
+      size_t buffer_size;
       unsigned width;
       unsigned height;
       unsigned pitch;
@@ -232,52 +257,62 @@ static void *video_thread_init_never_call(const video_info_t *video,
 /* thread -> user */
 static void video_thread_reply(thread_video_t *thr, const thread_packet_t *pkt)
 {
-   slock_lock(thr->lock);
+   /* Fire-and-forget, nobody is waiting. */
+   if (!thr->cmd_reply)
+      return;
 
-   thr->cmd_data  = *pkt;
+   slock_lock(thr->lock);
 
-   thr->reply_cmd = pkt->type;
-   thr->send_cmd  = CMD_VIDEO_NONE;
+   *thr->cmd_reply = *pkt;
+   *thr->cmd_done  = true;
+   thr->cmd_reply  = NULL;
+   thr->cmd_done   = NULL;
 
-   scond_signal(thr->cond_cmd);
+   scond_broadcast(thr->cond_cmd);
    slock_unlock(thr->lock);
 }
 
 /* user -> thread */
 static void video_thread_send_packet(thread_video_t *thr,
-      const thread_packet_t *pkt)
+      const thread_packet_t *pkt, thread_packet_t *reply, bool *done)
 {
+   thread_cmd_entry_t *entry = NULL;
+
    slock_lock(thr->lock);
 
-   thr->cmd_data  = *pkt;
+   /* Only blocks if the video thread is this far behind. */
+   while (thr->cmd_count == THREAD_CMD_RING_SIZE)
+      scond_wait(thr->cond_cmd, thr->lock);
 
-   thr->send_cmd  = pkt->type;
-   thr->reply_cmd = CMD_VIDEO_NONE;
+   entry        = &thr->cmd_ring[(thr->cmd_head + thr->cmd_count)
+      % THREAD_CMD_RING_SIZE];
+   entry->pkt   = *pkt;
+   entry->reply = reply;
+   entry->done  = done;
+   thr->cmd_count++;
 
    scond_signal(thr->cond_thread);
    slock_unlock(thr->lock);
-
 }
 
 /* user -> thread */
-static void video_thread_wait_reply(thread_video_t *thr, thread_packet_t *pkt)
+static void video_thread_send_async(thread_video_t *thr,
+      const thread_packet_t *pkt)
 {
-   slock_lock(thr->lock);
-
-   while (pkt->type != thr->reply_cmd)
-      scond_wait(thr->cond_cmd, thr->lock);
-
-   *pkt               = thr->cmd_data;
-   thr->cmd_data.type = CMD_VIDEO_NONE;
-
-   slock_unlock(thr->lock);
+   video_thread_send_packet(thr, pkt, NULL, NULL);
 }
 
 /* user -> thread */
 static void video_thread_send_and_wait_user_to_thread(thread_video_t *thr, thread_packet_t *pkt)
 {
-   video_thread_send_packet(thr, pkt);
-   video_thread_wait_reply(thr, pkt);
+   bool done = false;
+
+   video_thread_send_packet(thr, pkt, pkt, &done);
+
+   slock_lock(thr->lock);
+   while (!done)
+      scond_wait(thr->cond_cmd, thr->lock);
+   slock_unlock(thr->lock);
 }
 
 static void thread_update_driver_state(thread_video_t *thr)
@@ -550,28 +585,60 @@ static bool video_thread_handle_packet(
    return false;
 }
 
+/* Runs every queued command, returns true when
+ * video_thread_loop should quit. */
+static bool video_thread_run_commands(thread_video_t *thr)
+{
+   for (;;)
+   {
+      thread_cmd_entry_t entry;
+
+      slock_lock(thr->lock);
+      if (!thr->cmd_count)
+      {
+         slock_unlock(thr->lock);
+         return false;
+      }
+
+      entry          = thr->cmd_ring[thr->cmd_head];
+      thr->cmd_head  = (thr->cmd_head + 1) % THREAD_CMD_RING_SIZE;
+      if (thr->cmd_count-- == THREAD_CMD_RING_SIZE)
+         scond_broadcast(thr->cond_cmd);
+      slock_unlock(thr->lock);
+
+      thr->cmd_reply = entry.reply;
+      thr->cmd_done  = entry.done;
+
+      if (video_thread_handle_packet(thr, &entry.pkt))
+         return true;
+
+      /* Commands that don't reply themselves. */
+      video_thread_reply(thr, &entry.pkt);
+   }
+}
+
 static void video_thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
 
+   performance_trace_thread("video");
+   sthread_set_role(STHREAD_ROLE_VIDEO);
+
    for (;;)
    {
-      thread_packet_t pkt;
       bool updated = false;
 
+      performance_trace_begin("video_thread_wait");
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
+      while (!thr->cmd_count && !thr->frame.updated)
          scond_wait(thr->cond_thread, thr->lock);
       if (thr->frame.updated)
          updated = true;
-
-      /* To avoid race condition where send_cmd is updated
-       * right after the switch is checked. */
-      pkt = thr->cmd_data;
-
       slock_unlock(thr->lock);
+      performance_trace_end();
 
-      if (video_thread_handle_packet(thr, &pkt))
+      /* Everything queued so far applies before the frame. */
+      if (video_thread_run_commands(thr))
          return;
 
       if (updated)
@@ -598,11 +665,13 @@ static void video_thread_loop(void *data)
             video_frame_info_t video_info;
             video_driver_build_info(&video_info);
 
+            performance_trace_begin("video_thread_frame");
             ret = thr->driver->frame(thr->driver_data,
                   thr->frame.buffer, thr->frame.width, thr->frame.height,
                   thr->frame.count,
                   thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL,
                   &video_info);
+            performance_trace_end();
          }
 
          slock_unlock(thr->frame.lock);
@@ -625,7 +694,7 @@ static void video_thread_loop(void *data)
          thr->has_windowed  = has_windowed;
          thr->frame.updated = false;
          thr->vp            = vp;
-         scond_signal(thr->cond_cmd);
+         scond_broadcast(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
    }
@@ -687,13 +756,21 @@ static bool video_thread_has_windowed(void *data)
    return ret;
 }
 
+/* frame.buffer is only changed by video_thread_frame() on the
+ * main thread, and the video thread never reads the other one. */
+static uint8_t *video_thread_free_buffer(thread_video_t *thr)
+{
+   if (thr->frame.buffer == thr->frame.buffers[0])
+      return thr->frame.buffers[1];
+   return thr->frame.buffers[0];
+}
+
 static bool video_thread_frame(void *data, const void *frame_,
       unsigned width, unsigned height, uint64_t frame_count,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
 {
    unsigned copy_stride;
    const uint8_t *src                  = NULL;
-   uint8_t *dst                        = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
 
    /* If called from within read_viewport, we're actually in the
@@ -712,8 +789,8 @@ static bool video_thread_frame(void *data, const void *frame_,
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
    src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
 
+   performance_trace_begin("video_thread_frame_wait");
    slock_lock(thr->lock);
 
    if (!thr->nonblock)
@@ -741,9 +818,17 @@ static bool video_thread_frame(void *data, const void *frame_,
     * still working on last frame. */
    if (!thr->frame.updated)
    {
-      if (src)
+      if (src && src == video_thread_free_buffer(thr))
+      {
+         /* The core rendered straight into the free buffer,
+          * hand it to the video thread as is. */
+         thr->frame.buffer = (uint8_t*)src;
+         copy_stride       = pitch;
+      }
+      else if (src)
       {
          unsigned h;
+         uint8_t *dst = thr->frame.buffer;
          for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
             memcpy(dst, src, copy_stride);
       }
@@ -774,6 +859,7 @@ static bool video_thread_frame(void *data, const void *frame_,
       thr->miss_count++;
 
    slock_unlock(thr->lock);
+   performance_trace_end();
 
    thr->last_time = cpu_features_get_time_usec();
    return true;
@@ -810,6 +896,8 @@ static bool video_thread_init(thread_video_t *thr,
    max_size                 *= max_size;
    max_size                 *= info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
    thr->frame.buffer         = (uint8_t*)malloc(max_size);
+   thr->frame.buffers[0]     = thr->frame.buffer;
+   thr->frame.buffer_size    = max_size;
 
    if (!thr->frame.buffer)
       return false;
@@ -870,7 +958,7 @@ static void video_thread_set_rotation(void *data, unsigned rotation)
 
    pkt.data.i = rotation;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 /* This value is set async as stalling on the video driver for
@@ -924,7 +1012,8 @@ static void video_thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
-   free(thr->frame.buffer);
+   free(thr->frame.buffers[0]);
+   free(thr->frame.buffers[1]);
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
@@ -950,7 +1039,7 @@ static void thread_overlay_enable(void *data, bool state)
 
    pkt.data.b = state;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 static bool thread_overlay_load(void *data,
@@ -986,7 +1075,7 @@ static void thread_overlay_tex_geom(void *data,
    pkt.data.rect.w = w;
    pkt.data.rect.h = h;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 static void thread_overlay_vertex_geom(void *data,
@@ -1004,7 +1093,7 @@ static void thread_overlay_vertex_geom(void *data,
    pkt.data.rect.w = w;
    pkt.data.rect.h = h;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 static void thread_overlay_full_screen(void *data, bool enable)
@@ -1014,7 +1103,7 @@ static void thread_overlay_full_screen(void *data, bool enable)
 
    pkt.data.b = enable;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 /* We cannot wait for this to complete. Totally blocks the main thread. */
@@ -1064,7 +1153,7 @@ static void thread_set_video_mode(void *data, unsigned width, unsigned height,
    pkt.data.new_mode.height     = height;
    pkt.data.new_mode.fullscreen = fullscreen;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 static void thread_set_filtering(void *data, unsigned idx, bool smooth)
@@ -1077,7 +1166,7 @@ static void thread_set_filtering(void *data, unsigned idx, bool smooth)
    pkt.data.filtering.index  = idx;
    pkt.data.filtering.smooth = smooth;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 static void thread_get_video_output_size(void *data,
@@ -1125,7 +1214,7 @@ static void thread_set_aspect_ratio(void *data, unsigned aspectratio_idx)
       return;
    pkt.data.i = aspectratio_idx;
 
-   video_thread_send_and_wait_user_to_thread(thr, &pkt);
+   video_thread_send_async(thr, &pkt);
 }
 
 static void thread_set_texture_frame(void *data, const void *frame,
@@ -1236,6 +1325,43 @@ static uint32_t thread_get_flags(void *data)
    return thr->poke->get_flags(thr->driver_data);
 }
 
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   unsigned bpp;
+   thread_video_t *thr = (thread_video_t*)data;
+
+   if (!thr)
+      return false;
+
+   /* Converted or filtered frames never reach the wrapper as
+    * written by the core, so there is nothing to save. */
+   if (video_driver_frame_filter_alive() ||
+         video_driver_get_pixel_format() == RETRO_PIXEL_FORMAT_0RGB1555)
+      return false;
+
+   bpp = thr->info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+
+   if ((size_t)framebuffer->width * framebuffer->height * bpp
+         > thr->frame.buffer_size)
+      return false;
+
+   if (!thr->frame.buffers[1])
+   {
+      thr->frame.buffers[1] = (uint8_t*)malloc(thr->frame.buffer_size);
+      if (!thr->frame.buffers[1])
+         return false;
+   }
+
+   framebuffer->data         = video_thread_free_buffer(thr);
+   framebuffer->pitch        = framebuffer->width * bpp;
+   framebuffer->format       = thr->info.rgb32
+      ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+   return true;
+}
+
 static const video_poke_interface_t thread_poke = {
    thread_get_flags,
    NULL,                            /* set_coords */
@@ -1260,7 +1386,7 @@ static const video_poke_interface_t thread_poke = {
    NULL,
 
    thread_get_current_shader,
-   NULL,                      /* get_current_software_framebuffer */
+   thread_get_current_software_framebuffer,
    NULL                       /* get_hw_render_interface */
 };
 
@@ -61,6 +61,7 @@ COMPATIBILITY
 #include "../libretro-common/compat/compat_fnmatch.c"
 #include "../libretro-common/compat/fopen_utf8.c"
 #include "../libretro-common/memmap/memalign.c"
+#include "../libretro-common/memmap/rarena.c"
 
 /*============================================================
 CONSOLE EXTENSIONS
@@ -467,6 +468,7 @@ FONTS
 ============================================================ */
 
 #include "../gfx/drivers_font_renderer/bitmapfont.c"
+#include "../gfx/drivers_font_renderer/sdf.c"
 #include "../gfx/font_driver.c"
 
 #if defined(HAVE_D3D9) && defined(HAVE_D3DX)
@@ -626,6 +628,10 @@ INPUT
 #include "../input/drivers/x11_input.c"
 #endif
 
+#ifdef HAVE_THREADS
+#include "../input/common/input_poll_thread.c"
+#endif
+
 #ifdef HAVE_UDEV
 #include "../input/drivers/udev_input.c"
 #include "../input/drivers_joypad/udev_joypad.c"
@@ -694,6 +700,7 @@ STATE TRACKER
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/fifo_spsc.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -767,6 +774,9 @@ AUDIO
 #include "../audio/drivers/wiiu_audio.c"
 #elif defined(EMSCRIPTEN)
 #include "../audio/drivers/rwebaudio.c"
+#ifdef HAVE_AUDIOWORKLET
+#include "../audio/drivers/audioworklet.c"
+#endif
 #elif defined(PSP) || defined(VITA)
 #include "../audio/drivers/psp_audio.c"
 #elif defined(PS2)
@@ -834,9 +844,12 @@ MIDI
 DRIVERS
 ============================================================ */
 #include "../gfx/video_driver.c"
+#include "../gfx/video_pacing.c"
+#include "../gfx/video_perf_overlay.c"
 #include "../gfx/video_crt_switch.c"
 #include "../gfx/video_display_server.c"
 #include "../gfx/video_coord_array.c"
+#include "../gfx/video_atlas.c"
 #include "../input/input_driver.c"
 #include "../audio/audio_driver.c"
 #include "../libretro-common/audio/audio_mixer.c"
@@ -920,8 +933,10 @@ FILE
 #include "../libretro-common/vfs/vfs_implementation.c"
 #include "../list_special.c"
 #include "../libretro-common/string/stdstring.c"
+#include "../libretro-common/string/string_pool.c"
 #include "../libretro-common/file/nbio/nbio_stdio.c"
 #include "../libretro-common/file/nbio/nbio_linux.c"
+#include "../libretro-common/file/nbio/nbio_uring.c"
 #include "../libretro-common/file/nbio/nbio_unixmmap.c"
 #include "../libretro-common/file/nbio/nbio_windowsmmap.c"
 #include "../libretro-common/file/nbio/nbio_intf.c"
@@ -939,7 +954,9 @@ CONFIGURATION
 /*============================================================
 STATE MANAGER
 ============================================================ */
+#include "../managers/state_delta.c"
 #include "../managers/state_manager.c"
+#include "../managers/memory_budget.c"
 
 /*============================================================
 FRONTEND
@@ -1102,6 +1119,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/rjob.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -1130,6 +1148,7 @@ NETPLAY
 #include "../libretro-common/net/net_ifinfo.c"
 #endif
 #include "../tasks/task_http.c"
+#include "../tasks/task_thumbnail_sync.c"
 #include "../tasks/task_netplay_lan_scan.c"
 #include "../tasks/task_netplay_nat_traversal.c"
 #include "../tasks/task_wifi.c"
@@ -1140,6 +1159,7 @@ NETPLAY
 DATA RUNLOOP
 ============================================================ */
 #include "../tasks/task_powerstate.c"
+#include "../tasks/task_content_prefetch.c"
 #include "../tasks/task_content.c"
 #include "../tasks/task_save.c"
 #include "../tasks/task_image.c"
@@ -1201,6 +1221,7 @@ MENU
 #include "../menu/menu_shader.c"
 #include "../menu/menu_displaylist.c"
 #include "../menu/menu_animation.c"
+#include "../menu/menu_thumbnail_cache.c"
 
 #include "../menu/drivers/null.c"
 #include "../menu/drivers/menu_generic.c"
@@ -1320,6 +1341,7 @@ MENU
 #ifdef HAVE_RUNAHEAD
 #include "../runahead/mem_util.c"
 #include "../runahead/secondary_core.c"
+#include "../runahead/core_host.c"
 #include "../runahead/run_ahead.c"
 #include "../runahead/copy_load_info.c"
 #include "../runahead/dirty_input.c"
@@ -44,6 +44,7 @@ UI
 #include "../ui/drivers/qt/ui_qt_msg_window.cpp"
 #include "../ui/drivers/qt/ui_qt_application.cpp"
 #include "../ui/drivers/qt/flowlayout.cpp"
+#include "../ui/drivers/qt/gridview.cpp"
 #include "../ui/drivers/qt/shaderparamsdialog.cpp"
 #include "../ui/drivers/qt/coreoptionsdialog.cpp"
 #include "../ui/drivers/qt/filedropwidget.cpp"
@@ -60,6 +61,7 @@ UI
 #include "../ui/drivers/qt/moc_coreoptionsdialog.cpp"
 #include "../ui/drivers/qt/moc_filedropwidget.cpp"
 #include "../ui/drivers/qt/moc_flowlayout.cpp"
+#include "../ui/drivers/qt/moc_gridview.cpp"
 #include "../ui/drivers/qt/moc_playlistentrydialog.cpp"
 #include "../ui/drivers/qt/moc_shaderparamsdialog.cpp"
 #include "../ui/drivers/qt/moc_ui_qt_load_core_window.cpp"
@@ -0,0 +1,154 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <rthreads/rthreads.h>
+
+#include "input_poll_thread.h"
+
+/* The writer bumps the sequence to odd before touching the state
+ * and back to even after; a reader that saw the same even value on
+ * both sides of its copy got a consistent one. */
+#if defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define INPUT_SEQLOCK_LOAD_ACQUIRE(ptr)   __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define INPUT_SEQLOCK_LOAD_RELAXED(ptr)   __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define INPUT_SEQLOCK_STORE_RELAXED(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELAXED)
+#define INPUT_SEQLOCK_STORE_RELEASE(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#define INPUT_SEQLOCK_FENCE_ACQUIRE()     __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define INPUT_SEQLOCK_FENCE_RELEASE()     __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+#if defined(__GNUC__)
+#define INPUT_SEQLOCK_BARRIER()           __sync_synchronize()
+#elif defined(_MSC_VER)
+#include <windows.h>
+#define INPUT_SEQLOCK_BARRIER()           MemoryBarrier()
+#else
+/* Good enough for the single-core targets left over. */
+#define INPUT_SEQLOCK_BARRIER()
+#endif
+static unsigned input_seqlock_load(volatile unsigned *ptr)
+{
+   unsigned val = *ptr;
+   INPUT_SEQLOCK_BARRIER();
+   return val;
+}
+#define INPUT_SEQLOCK_LOAD_ACQUIRE(ptr)   input_seqlock_load(ptr)
+#define INPUT_SEQLOCK_LOAD_RELAXED(ptr)   (*(ptr))
+#define INPUT_SEQLOCK_STORE_RELAXED(ptr, val) (*(ptr) = (val))
+#define INPUT_SEQLOCK_STORE_RELEASE(ptr, val) do { INPUT_SEQLOCK_BARRIER(); *(ptr) = (val); } while (0)
+#define INPUT_SEQLOCK_FENCE_ACQUIRE()     INPUT_SEQLOCK_BARRIER()
+#define INPUT_SEQLOCK_FENCE_RELEASE()     INPUT_SEQLOCK_BARRIER()
+#endif
+
+struct input_poll_thread
+{
+   sthread_t *thread;
+   slock_t *lock;
+   input_poll_thread_cb_t poll;
+   void *data;
+   volatile bool alive;
+};
+
+void input_seqlock_write_begin(input_seqlock_t *lock)
+{
+   INPUT_SEQLOCK_STORE_RELAXED(&lock->seq, lock->seq + 1);
+   /* Keeps the odd sequence ahead of the state stores. */
+   INPUT_SEQLOCK_FENCE_RELEASE();
+}
+
+void input_seqlock_write_end(input_seqlock_t *lock)
+{
+   INPUT_SEQLOCK_STORE_RELEASE(&lock->seq, lock->seq + 1);
+}
+
+unsigned input_seqlock_read_begin(input_seqlock_t *lock)
+{
+   unsigned seq;
+
+   /* The writer never holds it for more than a memcpy. */
+   while ((seq = INPUT_SEQLOCK_LOAD_ACQUIRE(&lock->seq)) & 1);
+
+   return seq;
+}
+
+bool input_seqlock_read_retry(input_seqlock_t *lock, unsigned start)
+{
+   /* Keeps the state loads ahead of the second sequence load. */
+   INPUT_SEQLOCK_FENCE_ACQUIRE();
+   return INPUT_SEQLOCK_LOAD_RELAXED(&lock->seq) != start;
+}
+
+static void input_poll_thread_loop(void *data)
+{
+   input_poll_thread_t *thread = (input_poll_thread_t*)data;
+
+   while (thread->alive)
+      thread->poll(thread, thread->data);
+}
+
+input_poll_thread_t *input_poll_thread_new(input_poll_thread_cb_t poll,
+      void *data)
+{
+   input_poll_thread_t *thread = (input_poll_thread_t*)
+      calloc(1, sizeof(*thread));
+
+   if (!thread)
+      return NULL;
+
+   thread->poll  = poll;
+   thread->data  = data;
+   thread->alive = true;
+   thread->lock  = slock_new();
+
+   if (!thread->lock)
+      goto error;
+
+   thread->thread = sthread_create(input_poll_thread_loop, thread);
+
+   if (!thread->thread)
+      goto error;
+
+   return thread;
+
+error:
+   if (thread->lock)
+      slock_free(thread->lock);
+   free(thread);
+   return NULL;
+}
+
+void input_poll_thread_free(input_poll_thread_t *thread)
+{
+   if (!thread)
+      return;
+
+   /* The callback returns within INPUT_POLL_THREAD_PERIOD_MS. */
+   thread->alive = false;
+   sthread_join(thread->thread);
+   slock_free(thread->lock);
+   free(thread);
+}
+
+void input_poll_thread_lock(input_poll_thread_t *thread)
+{
+   slock_lock(thread->lock);
+}
+
+void input_poll_thread_unlock(input_poll_thread_t *thread)
+{
+   slock_unlock(thread->lock);
+}
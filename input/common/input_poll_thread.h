@@ -0,0 +1,75 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INPUT_POLL_THREAD_H
+#define _INPUT_POLL_THREAD_H
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* How long a poll thread callback may block waiting for events,
+ * i.e. the state is refreshed at least at 1 kHz. */
+#define INPUT_POLL_THREAD_PERIOD_MS 1
+
+/* Sequence lock for state written by exactly one thread and read
+ * by any other, without the reader ever blocking the writer:
+ *
+ *    do
+ *    {
+ *       seq = input_seqlock_read_begin(&lock);
+ *       copy = state;
+ *    } while (input_seqlock_read_retry(&lock, seq));
+ *
+ * Readers must only ever work on their copy. */
+typedef struct input_seqlock
+{
+   volatile unsigned seq;
+} input_seqlock_t;
+
+void input_seqlock_write_begin(input_seqlock_t *lock);
+
+void input_seqlock_write_end(input_seqlock_t *lock);
+
+unsigned input_seqlock_read_begin(input_seqlock_t *lock);
+
+bool input_seqlock_read_retry(input_seqlock_t *lock, unsigned start);
+
+/* Thread that calls @poll over and over until freed. @poll should
+ * wait at most INPUT_POLL_THREAD_PERIOD_MS for new events, handle
+ * them and publish the result, typically through a seqlock.
+ *
+ * input_poll_thread_lock() excludes the callback, for the main
+ * thread to change the device set (hotplug) under its feet. The
+ * callback takes the same lock around anything touching that set. */
+typedef struct input_poll_thread input_poll_thread_t;
+
+typedef void (*input_poll_thread_cb_t)(input_poll_thread_t *thread,
+      void *data);
+
+input_poll_thread_t *input_poll_thread_new(input_poll_thread_cb_t poll,
+      void *data);
+
+void input_poll_thread_free(input_poll_thread_t *thread);
+
+void input_poll_thread_lock(input_poll_thread_t *thread);
+
+void input_poll_thread_unlock(input_poll_thread_t *thread);
+
+RETRO_END_DECLS
+
+#endif
@@ -238,4 +238,6 @@ pad_connection_interface_t pad_connection_ps3 = {
    hidpad_ps3_get_buttons,
    hidpad_ps3_get_axis,
    hidpad_ps3_get_name,
+   NULL, /* button */
+   true, /* snapshot_reports */
 };
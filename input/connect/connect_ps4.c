@@ -291,4 +291,6 @@ pad_connection_interface_t pad_connection_ps4 = {
    hidpad_ps4_get_buttons,
    hidpad_ps4_get_axis,
    NULL,
+   NULL, /* button */
+   true, /* snapshot_reports */
 };
@@ -121,6 +121,8 @@ static void hidpad_wiiugca_packet_handler(void *data, uint8_t *packet, uint16_t
    if (!device)
       return;
 
+   if (size > sizeof(device->data))
+      size = sizeof(device->data);
    memcpy(device->data, packet, size);
 
    device->buttons = 0;
@@ -155,4 +157,6 @@ pad_connection_interface_t pad_connection_wiiugca = {
    hidpad_wiiugca_get_buttons,
    hidpad_wiiugca_get_axis,
    hidpad_wiiugca_get_name,
+   NULL, /* button */
+   true, /* snapshot_reports */
 };
@@ -18,6 +18,7 @@
 #include <string.h>
 
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
 
 #include "../input_driver.h"
 #include "../../verbosity.h"
@@ -172,6 +173,11 @@ int32_t pad_connection_pad_init(joypad_connection_t *joyconn,
 
          if (name_match || (pad_map[i].vid == vid && pad_map[i].pid == pid))
          {
+#ifdef HAVE_THREADS
+            s->parsed_seq    = input_seqlock_read_begin(&s->report_lock);
+            s->parsed_length = 0;
+#endif
+            s->parsed_time   = 0;
             s->iface      = pad_map[i].iface;
             s->data       = s->iface->init(data, pad, driver);
             s->connected  = true;
@@ -224,15 +230,82 @@ void pad_connection_packet(joypad_connection_t *joyconn, uint32_t pad,
 {
    if (!joyconn || !joyconn->connected)
        return;
-   if (joyconn->iface && joyconn->data && joyconn->iface->packet_handler)
-      joyconn->iface->packet_handler(joyconn->data, data, length);
+   if (!joyconn->iface || !joyconn->data || !joyconn->iface->packet_handler)
+      return;
+
+#ifdef HAVE_THREADS
+   /* Snapshot reports are only stored here; the reader parses the
+    * newest one when it next asks for the pad state, so the HID
+    * thread never touches the interface state the reader sees. */
+   if (joyconn->iface->snapshot_reports
+         && length <= PAD_CONNECTION_REPORT_SIZE)
+   {
+      retro_time_t now = cpu_features_get_time_usec();
+
+      input_seqlock_write_begin(&joyconn->report_lock);
+      memcpy(joyconn->report, data, length);
+      joyconn->report_length = length;
+      joyconn->report_time   = now;
+      input_seqlock_write_end(&joyconn->report_lock);
+      return;
+   }
+#endif
+
+   joyconn->parsed_time = cpu_features_get_time_usec();
+   joyconn->iface->packet_handler(joyconn->data, data, length);
 }
 
+#ifdef HAVE_THREADS
+static void pad_connection_parse_report(joypad_connection_t *joyconn)
+{
+   unsigned seq;
+   uint32_t length;
+   retro_time_t time;
+   uint8_t report[PAD_CONNECTION_REPORT_SIZE];
+
+   if (!joyconn->iface->snapshot_reports
+         || !joyconn->iface->packet_handler)
+      return;
+
+   /* Nothing published since the last parse */
+   if (input_seqlock_read_begin(&joyconn->report_lock)
+         == joyconn->parsed_seq)
+      return;
+
+   do
+   {
+      seq    = input_seqlock_read_begin(&joyconn->report_lock);
+      length = joyconn->report_length;
+      time   = joyconn->report_time;
+      if (length > PAD_CONNECTION_REPORT_SIZE)
+         length = PAD_CONNECTION_REPORT_SIZE;
+      memcpy(report, joyconn->report, length);
+   } while (input_seqlock_read_retry(&joyconn->report_lock, seq));
+
+   joyconn->parsed_seq  = seq;
+   joyconn->parsed_time = time;
+
+   /* Pads resend the same report while nothing is held or moved */
+   if (     length == joyconn->parsed_length
+         && !memcmp(report, joyconn->parsed, length))
+      return;
+
+   memcpy(joyconn->parsed, report, length);
+   joyconn->parsed_length = length;
+   joyconn->iface->packet_handler(joyconn->data, report, length);
+}
+#endif
+
 void pad_connection_get_buttons(joypad_connection_t *joyconn,
       unsigned pad, input_bits_t *state)
 {
 	if (joyconn && joyconn->iface)
+   {
+#ifdef HAVE_THREADS
+      pad_connection_parse_report(joyconn);
+#endif
 		joyconn->iface->get_buttons(joyconn->data, state);
+   }
    else
 		BIT256_CLEAR_ALL_PTR( state );
 }
@@ -242,9 +315,23 @@ int16_t pad_connection_get_axis(joypad_connection_t *joyconn,
 {
    if (!joyconn || !joyconn->iface)
       return 0;
+#ifdef HAVE_THREADS
+   pad_connection_parse_report(joyconn);
+#endif
    return joyconn->iface->get_axis(joyconn->data, i);
 }
 
+retro_time_t pad_connection_get_report_time(joypad_connection_t *joyconn,
+   unsigned idx)
+{
+   if (!joyconn || !joyconn->iface)
+      return 0;
+#ifdef HAVE_THREADS
+   pad_connection_parse_report(joyconn);
+#endif
+   return joyconn->parsed_time;
+}
+
 bool pad_connection_has_interface(joypad_connection_t *joyconn, unsigned pad)
 {
    if (     joyconn && pad < MAX_USERS
@@ -24,6 +24,9 @@
 #include <retro_miscellaneous.h>
 #include <retro_endianness.h>
 #include "../input_driver.h"
+#ifdef HAVE_THREADS
+#include "../common/input_poll_thread.h"
+#endif
 
 #define VID_NONE          0x0000
 #define VID_NINTENDO      swap_if_big16(0x057e)
@@ -44,11 +47,27 @@
 #define PID_PCS_PS2PSX    swap_if_big16(0x0001)
 #define PID_PCS_PSX2PS3   swap_if_big16(0x0003)
 
+/* Largest report kept in the per-pad slot; bigger ones
+ * are handed to the interface straight away. */
+#define PAD_CONNECTION_REPORT_SIZE 128
+
 struct joypad_connection
 {
     bool connected;
     struct pad_connection_interface *iface;
     void* data;
+#ifdef HAVE_THREADS
+    /* Newest report from the HID thread, published under report_lock */
+    input_seqlock_t report_lock;
+    retro_time_t report_time;
+    uint32_t report_length;
+    uint8_t report[PAD_CONNECTION_REPORT_SIZE];
+    /* Last report handed to the interface, owned by the reader */
+    unsigned parsed_seq;
+    uint32_t parsed_length;
+    uint8_t parsed[PAD_CONNECTION_REPORT_SIZE];
+#endif
+    retro_time_t parsed_time;
 };
 
 typedef struct pad_connection_interface
@@ -62,6 +81,9 @@ typedef struct pad_connection_interface
    int16_t  	(*get_axis)(void *data, unsigned axis);
    const char*	(*get_name)(void *data);
    bool         (*button)(void *data, uint16_t joykey);
+   /* Every report is a full snapshot of the pad, so only the newest
+    * one needs parsing and an unchanged one can be skipped. */
+   bool         snapshot_reports;
 } pad_connection_interface_t;
 
 extern pad_connection_interface_t pad_connection_wii;
@@ -94,6 +116,11 @@ void pad_connection_get_buttons(joypad_connection_t *joyconn,
 int16_t pad_connection_get_axis(joypad_connection_t *joyconn,
    unsigned idx, unsigned i);
 
+/* Arrival time in microseconds of the report the pad state
+ * currently reflects, or 0 if none has been seen yet. */
+retro_time_t pad_connection_get_report_time(joypad_connection_t *joyconn,
+   unsigned idx);
+
 /* Determine if connected joypad is a hidpad backed device.
  * If false, pad_connection_packet cannot be used */
 
@@ -29,11 +29,17 @@
 #include <linux/input.h>
 
 #include <retro_inline.h>
+#include <retro_timers.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
 
 #include "../input_driver.h"
 
+#ifdef HAVE_THREADS
+#include "../common/input_poll_thread.h"
+#endif
+
+#include "../../configuration.h"
 #include "../../tasks/tasks_internal.h"
 
 #include "../../verbosity.h"
@@ -55,15 +61,20 @@
    (((1UL << ((nr) % (sizeof(long) * CHAR_BIT))) & ((addr)[(nr) / (sizeof(long) * CHAR_BIT)])) != 0)
 #define NBITS(x) ((((x) - 1) / (sizeof(long) * CHAR_BIT)) + 1)
 
+/* Input state polled. */
+struct udev_joypad_state
+{
+   uint64_t buttons;
+   int16_t axes[NUM_AXES];
+   int8_t hats[NUM_HATS][2];
+};
+
 struct udev_joypad
 {
    int fd;
    dev_t device;
 
-   /* Input state polled. */
-   uint64_t buttons;
-   int16_t axes[NUM_AXES];
-   int8_t hats[NUM_HATS][2];
+   struct udev_joypad_state state;
 
    /* Maps keycodes -> button/axes */
    uint8_t button_bind[KEY_MAX];
@@ -94,6 +105,21 @@ static struct udev *udev_joypad_fd             = NULL;
 static struct udev_monitor *udev_joypad_mon    = NULL;
 static struct udev_joypad udev_pads[MAX_USERS];
 
+#ifdef HAVE_THREADS
+/* With input_poll_thread, the pads are read on their own thread,
+ * which publishes the state here. udev_joypad_poll() only latches
+ * the newest copy, so with the 'Late' poll type the core gets the
+ * state as of its first input_state call of the frame, and the same
+ * state for every call after that. Hotplug stays on the main
+ * thread, under the poll thread lock. */
+static input_poll_thread_t *udev_joypad_thread = NULL;
+static input_seqlock_t udev_joypad_seqlock;
+static struct udev_joypad_state udev_pads_state[MAX_USERS];
+static struct udev_joypad_state udev_pads_latched[MAX_USERS];
+/* Set under the lock when the device set changed. */
+static bool udev_joypad_republish               = false;
+#endif
+
 static INLINE int16_t udev_compute_axis(const struct input_absinfo *info, int value)
 {
    int range = info->maximum - info->minimum;
@@ -218,7 +244,7 @@ static int udev_add_pad(struct udev_device *dev, unsigned p, int fd, const char
             continue;
          if (abs->maximum > abs->minimum)
          {
-            pad->axes[axes]   = udev_compute_axis(abs, abs->value);
+            pad->state.axes[axes] = udev_compute_axis(abs, abs->value);
             /* Deal with analog triggers that report -32767 to 32767
                by testing if the axis initial value is negative, allowing for
                for some slop (1300 =~ 4%)in an axis centred around 0.
@@ -348,6 +374,13 @@ static void udev_joypad_destroy(void)
 {
    unsigned i;
 
+#ifdef HAVE_THREADS
+   input_poll_thread_free(udev_joypad_thread);
+   udev_joypad_thread = NULL;
+   memset(udev_pads_state, 0, sizeof(udev_pads_state));
+   memset(udev_pads_latched, 0, sizeof(udev_pads_latched));
+#endif
+
    for (i = 0; i < MAX_USERS; i++)
       udev_free_pad(i);
 
@@ -442,6 +475,125 @@ static bool udev_joypad_poll_hotplug_available(struct udev_monitor *dev)
    return (poll(&fds, 1, 0) == 1) && (fds.revents & POLLIN);
 }
 
+/* Returns true if any event was read. */
+static bool udev_joypad_read_pad(struct udev_joypad *pad)
+{
+   int i, len;
+   bool ret = false;
+   struct input_event events[32];
+
+   while ((len = read(pad->fd, events, sizeof(events))) > 0)
+   {
+      ret  = true;
+      len /= sizeof(*events);
+      for (i = 0; i < len; i++)
+      {
+         uint16_t type = events[i].type;
+         uint16_t code = events[i].code;
+         int32_t value = events[i].value;
+
+         switch (type)
+         {
+            case EV_KEY:
+               if (code > 0 && code < KEY_MAX)
+               {
+                  if (value)
+                     BIT64_SET(pad->state.buttons, pad->button_bind[code]);
+                  else
+                     BIT64_CLEAR(pad->state.buttons, pad->button_bind[code]);
+               }
+               break;
+
+            case EV_ABS:
+               if (code >= ABS_MISC)
+                  break;
+
+               switch (code)
+               {
+                  case ABS_HAT0X:
+                  case ABS_HAT0Y:
+                  case ABS_HAT1X:
+                  case ABS_HAT1Y:
+                  case ABS_HAT2X:
+                  case ABS_HAT2Y:
+                  case ABS_HAT3X:
+                  case ABS_HAT3Y:
+                     code                                 -= ABS_HAT0X;
+                     pad->state.hats[code >> 1][code & 1]  = value;
+                     break;
+                  default:
+                     {
+                        unsigned axis         = pad->axes_bind[code];
+                        pad->state.axes[axis] = udev_compute_axis(
+                              &pad->absinfo[axis], value);
+                        break;
+                     }
+               }
+               break;
+
+            default:
+               break;
+         }
+      }
+   }
+
+   return ret;
+}
+
+#ifdef HAVE_THREADS
+static void udev_joypad_poll_thread(input_poll_thread_t *thread, void *data)
+{
+   unsigned p;
+   int ready;
+   struct pollfd fds[MAX_USERS];
+   unsigned count = 0;
+   bool changed   = false;
+
+   (void)data;
+
+   input_poll_thread_lock(thread);
+   for (p = 0; p < MAX_USERS; p++)
+   {
+      if (udev_pads[p].fd < 0)
+         continue;
+
+      fds[count].fd      = udev_pads[p].fd;
+      fds[count].events  = POLLIN;
+      fds[count].revents = 0;
+      count++;
+   }
+   input_poll_thread_unlock(thread);
+
+   /* A pad unplugged while we wait here is only closed once we've
+    * let go of the lock, so the worst case is an early wakeup. */
+   ready = poll(fds, count, INPUT_POLL_THREAD_PERIOD_MS);
+
+   input_poll_thread_lock(thread);
+
+   if (ready > 0)
+      for (p = 0; p < MAX_USERS; p++)
+         if (udev_pads[p].fd >= 0 && udev_joypad_read_pad(&udev_pads[p]))
+            changed = true;
+
+   if (changed || udev_joypad_republish)
+   {
+      input_seqlock_write_begin(&udev_joypad_seqlock);
+      for (p = 0; p < MAX_USERS; p++)
+         udev_pads_state[p] = udev_pads[p].state;
+      input_seqlock_write_end(&udev_joypad_seqlock);
+
+      udev_joypad_republish = false;
+   }
+
+   input_poll_thread_unlock(thread);
+
+   /* Don't spin on a pad that keeps erroring out until
+    * hotplug gets around to removing it. */
+   if (ready > 0 && !changed)
+      retro_sleep(INPUT_POLL_THREAD_PERIOD_MS);
+}
+#endif
+
 static void udev_joypad_poll(void)
 {
    unsigned p;
@@ -458,6 +610,11 @@ static void udev_joypad_poll(void)
 
          if (val && string_is_equal(val, "1") && devnode)
          {
+#ifdef HAVE_THREADS
+            if (udev_joypad_thread)
+               input_poll_thread_lock(udev_joypad_thread);
+#endif
+
             if (string_is_equal(action, "add"))
             {
                RARCH_LOG("[udev]: Hotplug add: %s.\n", devnode);
@@ -468,75 +625,38 @@ static void udev_joypad_poll(void)
                RARCH_LOG("[udev]: Hotplug remove: %s.\n", devnode);
                udev_joypad_remove_device(devnode);
             }
+
+#ifdef HAVE_THREADS
+            if (udev_joypad_thread)
+            {
+               udev_joypad_republish = true;
+               input_poll_thread_unlock(udev_joypad_thread);
+            }
+#endif
          }
 
          udev_device_unref(dev);
       }
    }
 
-   for (p = 0; p < MAX_USERS; p++)
+#ifdef HAVE_THREADS
+   if (udev_joypad_thread)
    {
-      int i, len;
-      struct input_event events[32];
-      struct udev_joypad *pad = &udev_pads[p];
-
-      if (pad->fd < 0)
-         continue;
+      unsigned seq;
 
-      while ((len = read(pad->fd, events, sizeof(events))) > 0)
+      do
       {
-         len /= sizeof(*events);
-         for (i = 0; i < len; i++)
-         {
-            uint16_t type = events[i].type;
-            uint16_t code = events[i].code;
-            int32_t value = events[i].value;
-
-            switch (type)
-            {
-               case EV_KEY:
-                  if (code > 0 && code < KEY_MAX)
-                  {
-                     if (value)
-                        BIT64_SET(pad->buttons, pad->button_bind[code]);
-                     else
-                        BIT64_CLEAR(pad->buttons, pad->button_bind[code]);
-                  }
-                  break;
-
-               case EV_ABS:
-                  if (code >= ABS_MISC)
-                     break;
-
-                  switch (code)
-                  {
-                     case ABS_HAT0X:
-                     case ABS_HAT0Y:
-                     case ABS_HAT1X:
-                     case ABS_HAT1Y:
-                     case ABS_HAT2X:
-                     case ABS_HAT2Y:
-                     case ABS_HAT3X:
-                     case ABS_HAT3Y:
-                        code                           -= ABS_HAT0X;
-                        pad->hats[code >> 1][code & 1]  = value;
-                        break;
-                     default:
-                        {
-                           unsigned axis   = pad->axes_bind[code];
-                           pad->axes[axis] = udev_compute_axis(
-                                 &pad->absinfo[axis], value);
-                           break;
-                        }
-                  }
-                  break;
-
-               default:
-                  break;
-            }
-         }
-      }
+         seq = input_seqlock_read_begin(&udev_joypad_seqlock);
+         memcpy(udev_pads_latched, udev_pads_state,
+               sizeof(udev_pads_latched));
+      } while (input_seqlock_read_retry(&udev_joypad_seqlock, seq));
+      return;
    }
+#endif
+
+   for (p = 0; p < MAX_USERS; p++)
+      if (udev_pads[p].fd >= 0)
+         udev_joypad_read_pad(&udev_pads[p]);
 }
 
 /* Used for sorting devnodes to appear in the correct order */
@@ -613,6 +733,19 @@ static bool udev_joypad_init(void *data)
    }
 
    udev_enumerate_unref(enumerate);
+
+#ifdef HAVE_THREADS
+   if (config_get_ptr()->bools.input_poll_thread)
+   {
+      udev_joypad_republish = true;
+      udev_joypad_thread    = input_poll_thread_new(
+            udev_joypad_poll_thread, NULL);
+
+      if (!udev_joypad_thread)
+         RARCH_WARN("[udev]: Failed to start input poll thread, polling once per frame.\n");
+   }
+#endif
+
    return true;
 
 error:
@@ -620,10 +753,21 @@ error:
    return false;
 }
 
+static INLINE const struct udev_joypad_state *udev_joypad_get_state(
+      unsigned port)
+{
+#ifdef HAVE_THREADS
+   if (udev_joypad_thread)
+      return &udev_pads_latched[port];
+#endif
+
+   return &udev_pads[port].state;
+}
+
 static bool udev_joypad_button(unsigned port, uint16_t joykey)
 {
-   const struct udev_joypad *pad = (const struct udev_joypad*)&udev_pads[port];
-   unsigned hat_dir              = GET_HAT_DIR(joykey);
+   const struct udev_joypad_state *pad = udev_joypad_get_state(port);
+   unsigned hat_dir                    = GET_HAT_DIR(joykey);
 
    if (hat_dir)
    {
@@ -649,8 +793,7 @@ static bool udev_joypad_button(unsigned port, uint16_t joykey)
 
 static void udev_joypad_get_buttons(unsigned port, input_bits_t *state)
 {
-	const struct udev_joypad *pad = (const struct udev_joypad*)
-      &udev_pads[port];
+	const struct udev_joypad_state *pad = udev_joypad_get_state(port);
 
 	if (pad)
    {
@@ -663,18 +806,20 @@ static void udev_joypad_get_buttons(unsigned port, input_bits_t *state)
 static int16_t udev_joypad_axis(unsigned port, uint32_t joyaxis)
 {
    int16_t val = 0;
-   const struct udev_joypad *pad;
+   const struct udev_joypad_state *pad;
+   const struct udev_joypad *dev;
    if (joyaxis == AXIS_NONE)
       return 0;
 
-   pad = (const struct udev_joypad*)&udev_pads[port];
+   dev = (const struct udev_joypad*)&udev_pads[port];
+   pad = udev_joypad_get_state(port);
 
    if (AXIS_NEG_GET(joyaxis) < NUM_AXES)
    {
       val = pad->axes[AXIS_NEG_GET(joyaxis)];
       /* Deal with analog triggers that report -32767 to 32767 */
       if (((AXIS_NEG_GET(joyaxis) == ABS_Z) || (AXIS_NEG_GET(joyaxis) == ABS_RZ))
-            && (pad->neg_trigger[AXIS_NEG_GET(joyaxis)]))
+            && (dev->neg_trigger[AXIS_NEG_GET(joyaxis)]))
          val = (val + 0x7fff) / 2;
       if (val > 0)
          val = 0;
@@ -684,7 +829,7 @@ static int16_t udev_joypad_axis(unsigned port, uint32_t joyaxis)
       val = pad->axes[AXIS_POS_GET(joyaxis)];
       /* Deal with analog triggers that report -32767 to 32767 */
       if (((AXIS_POS_GET(joyaxis) == ABS_Z) || (AXIS_POS_GET(joyaxis) == ABS_RZ))
-            && (pad->neg_trigger[AXIS_POS_GET(joyaxis)]))
+            && (dev->neg_trigger[AXIS_POS_GET(joyaxis)]))
          val = (val + 0x7fff) / 2;
       if (val < 0)
          val = 0;
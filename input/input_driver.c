@@ -60,6 +60,7 @@
 #include "../movie.h"
 #include "../list_special.h"
 #include "../verbosity.h"
+#include "../performance_counters.h"
 #include "../tasks/tasks_internal.h"
 #include "../command.h"
 #include "include/gamepad.h"
@@ -595,6 +596,8 @@ void input_poll(void)
    settings_t *settings           = config_get_ptr();
    uint8_t max_users              = (uint8_t)input_driver_max_users;
 
+   performance_zone_begin(PERF_ZONE_INPUT_POLL);
+
    current_input->poll(current_input_data);
 
    input_driver_turbo_btns.count++;
@@ -603,9 +606,10 @@ void input_poll(void)
       input_driver_turbo_btns.frame_enable[i] = 0;
 
    if (input_driver_block_libretro_input)
+   {
+      performance_zone_end(PERF_ZONE_INPUT_POLL);
       return;
-
-
+   }
 
    for (i = 0; i < max_users; i++)
    {
@@ -643,6 +647,8 @@ void input_poll(void)
    if (input_driver_remote)
       input_remote_poll(input_driver_remote, max_users);
 #endif
+
+   performance_zone_end(PERF_ZONE_INPUT_POLL);
 }
 
 /**
@@ -682,7 +688,10 @@ int16_t input_state(unsigned port, unsigned device,
    {
       settings_t *settings = config_get_ptr();
 
-      if (settings->bools.input_remap_binds_enable)
+      if (settings->bools.input_remap_binds_enable && input_driver_mapper)
+         reset_state = input_mapper_is_remapped(input_driver_mapper,
+               port, device, idx, id);
+      else if (settings->bools.input_remap_binds_enable)
       {
          switch (device)
          {
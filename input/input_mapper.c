@@ -52,6 +52,38 @@
 #define MAPPER_GET_KEY(state, key) (((state)->keys[(key) / 32] >> ((key) % 32)) & 1)
 #define MAPPER_SET_KEY(state, key) (state)->keys[(key) / 32] |= 1 << ((key) % 32)
 
+/* The remap of one port, compiled from the settings whenever they
+ * change, so input_mapper_poll() only ever looks at binds that are
+ * actually remapped. */
+typedef struct input_mapper_port
+{
+   /* Settings the tables below were compiled from. */
+   unsigned device;
+   unsigned remap_ids[RARCH_CUSTOM_BIND_LIST_END];
+   unsigned keymapper_ids[RARCH_CUSTOM_BIND_LIST_END];
+
+   /* Bit (1 << bind) for every bind whose own input input_state()
+    * has to drop, see input_mapper_is_remapped(). */
+   uint32_t reset_mask;
+
+   /* Joypad ports. Source buttons (bit j) remapped to another button
+    * or to an analog direction, and source analog directions (bit j
+    * for bind RARCH_FIRST_CUSTOM_BIND + j) remapped to a button or to
+    * another direction. target[]/invert[] are indexed by source bind;
+    * analog targets are relative to RARCH_FIRST_CUSTOM_BIND. */
+   uint16_t button_button_mask;
+   uint16_t button_analog_mask;
+   uint8_t analog_button_mask;
+   uint8_t analog_analog_mask;
+   uint8_t target[RARCH_ANALOG_BIND_LIST_END];
+   int8_t invert[RARCH_ANALOG_BIND_LIST_END];
+
+   /* Keyboard ports. Binds with a key assigned, in bind order. */
+   unsigned num_keys;
+   uint8_t key_bind[RARCH_CUSTOM_BIND_LIST_END];
+   unsigned key_code[RARCH_CUSTOM_BIND_LIST_END];
+} input_mapper_port_t;
+
 struct input_mapper
 {
    /* Left X, Left Y, Right X, Right Y */
@@ -60,6 +92,9 @@ struct input_mapper
    uint32_t keys[RETROK_LAST / 32 + 1];
    /* This is a bitmask of (1 << key_bind_id). */
    input_bits_t buttons[MAX_USERS];
+
+   bool compiled;
+   input_mapper_port_t ports[MAX_USERS];
 };
 
 static bool input_mapper_button_pressed(input_mapper_t *handle, unsigned port, unsigned id)
@@ -67,6 +102,101 @@ static bool input_mapper_button_pressed(input_mapper_t *handle, unsigned port, u
    return BIT256_GET(handle->buttons[port], id);
 }
 
+static void input_mapper_compile_port(input_mapper_t *handle,
+      const settings_t *settings, unsigned port)
+{
+   unsigned j;
+   input_mapper_port_t *p = &handle->ports[port];
+
+   memset(p, 0, sizeof(*p));
+
+   p->device = settings->uints.input_libretro_device[port];
+   memcpy(p->remap_ids, settings->uints.input_remap_ids[port],
+         sizeof(p->remap_ids));
+   memcpy(p->keymapper_ids, settings->uints.input_keymapper_ids[port],
+         sizeof(p->keymapper_ids));
+
+   for (j = 0; j < RARCH_ANALOG_BIND_LIST_END; j++)
+      if (p->remap_ids[j] != j)
+         p->reset_mask |= 1 << j;
+
+   /* A port changing device type mustn't keep pressing buttons. */
+   BIT256_CLEAR_ALL(handle->buttons[port]);
+   memset(handle->analog_value[port], 0,
+         sizeof(handle->analog_value[port]));
+
+   switch (p->device & RETRO_DEVICE_MASK)
+   {
+      case RETRO_DEVICE_KEYBOARD:
+         for (j = 0; j < RARCH_CUSTOM_BIND_LIST_END; j++)
+         {
+            if (p->keymapper_ids[j] == RETROK_UNKNOWN)
+               continue;
+
+            p->key_bind[p->num_keys] = j;
+            p->key_code[p->num_keys] = p->keymapper_ids[j];
+            p->num_keys++;
+         }
+         break;
+
+      case RETRO_DEVICE_JOYPAD:
+      case RETRO_DEVICE_ANALOG:
+         for (j = 0; j < RARCH_FIRST_CUSTOM_BIND; j++)
+         {
+            unsigned remap = p->remap_ids[j];
+
+            if (remap == j || remap == RARCH_UNMAPPED)
+               continue;
+
+            if (remap < RARCH_FIRST_CUSTOM_BIND)
+            {
+               p->button_button_mask |= 1 << j;
+               p->target[j]           = remap;
+            }
+            else if (remap < RARCH_ANALOG_BIND_LIST_END)
+            {
+               p->button_analog_mask |= 1 << j;
+               p->target[j]           = remap - RARCH_FIRST_CUSTOM_BIND;
+               p->invert[j]           = (remap % 2 != 0) ? -1 : 1;
+            }
+         }
+
+         for (j = 0; j < 8; j++)
+         {
+            unsigned k     = j + RARCH_FIRST_CUSTOM_BIND;
+            unsigned remap = p->remap_ids[k];
+
+            if (remap == k || remap == RARCH_UNMAPPED)
+               continue;
+
+            if (remap < RARCH_FIRST_CUSTOM_BIND)
+            {
+               p->analog_button_mask |= 1 << j;
+               p->target[k]           = remap;
+            }
+            else if (remap < RARCH_ANALOG_BIND_LIST_END)
+            {
+               p->analog_analog_mask |= 1 << j;
+               p->target[k]           = remap - RARCH_FIRST_CUSTOM_BIND;
+               p->invert[k]           = ((k % 2) != (remap % 2)) ? -1 : 1;
+            }
+         }
+         break;
+      default:
+         break;
+   }
+}
+
+static bool input_mapper_port_changed(const input_mapper_port_t *p,
+      const settings_t *settings, unsigned port)
+{
+   return p->device != settings->uints.input_libretro_device[port]
+      || memcmp(p->remap_ids, settings->uints.input_remap_ids[port],
+            sizeof(p->remap_ids))
+      || memcmp(p->keymapper_ids, settings->uints.input_keymapper_ids[port],
+            sizeof(p->keymapper_ids));
+}
+
 input_mapper_t *input_mapper_new(void)
 {
    input_mapper_t* handle = (input_mapper_t*)
@@ -85,18 +215,138 @@ void input_mapper_free(input_mapper_t *handle)
    free (handle);
 }
 
-void input_mapper_poll(input_mapper_t *handle)
+static void input_mapper_poll_keyboard(input_mapper_t *handle,
+      const input_mapper_port_t *p, settings_t *settings, unsigned port,
+      bool poll_overlay, bool *key_event)
+{
+   unsigned n;
+   input_bits_t current_input;
+
+   BIT256_CLEAR_ALL_PTR(&current_input);
+   input_get_state_for_port(settings, port, &current_input);
+
+   for (n = 0; n < p->num_keys; n++)
+   {
+      unsigned j                    = p->key_bind[n];
+      unsigned remap_button         = p->key_code[n];
+      unsigned current_button_value = BIT256_GET(current_input, j);
+#ifdef HAVE_OVERLAY
+      if (poll_overlay && port == 0)
+         current_button_value |= input_overlay_key_pressed(overlay_ptr, j);
+#endif
+      if ((current_button_value == 1) && (j != remap_button))
+      {
+         MAPPER_SET_KEY (handle,
+               remap_button);
+         input_keyboard_event(true,
+               remap_button,
+               0, 0, RETRO_DEVICE_KEYBOARD);
+         key_event[j] = true;
+      }
+      /* key_event tracks if a key is pressed for ANY PLAYER, so we must check
+         if the key was used by any player before releasing */
+      else if (!key_event[j])
+      {
+         input_keyboard_event(false,
+               remap_button,
+               0, 0, RETRO_DEVICE_KEYBOARD);
+      }
+   }
+}
+
+static void input_mapper_poll_joypad(input_mapper_t *handle,
+      const input_mapper_port_t *p, settings_t *settings, unsigned port,
+      bool poll_overlay, float axis_threshold)
 {
-   unsigned i, j;
+   unsigned j;
+   uint32_t mask;
+   uint32_t pressed;
    input_bits_t current_input;
+   int16_t *analog_value = handle->analog_value[port];
+
+   /* The mapper input bitmap only holds the remapped buttons; the
+    * original input is cleared in input_state(). */
+   BIT256_CLEAR_ALL(handle->buttons[port]);
+
+   for (j = 0; j < 8; j++)
+      analog_value[j] = 0;
+
+   if (!(p->button_button_mask | p->button_analog_mask
+            | p->analog_button_mask | p->analog_analog_mask))
+      return;
+
+   BIT256_CLEAR_ALL_PTR(&current_input);
+   input_get_state_for_port(settings, port, &current_input);
+
+   pressed = BITS_GET_ELEM(current_input, 0) & 0xffff;
+#ifdef HAVE_OVERLAY
+   if (poll_overlay && port == 0)
+      for (j = 0, mask = p->button_button_mask | p->button_analog_mask;
+            mask; j++, mask >>= 1)
+         if ((mask & 1) && input_overlay_key_pressed(overlay_ptr, j))
+            pressed |= 1 << j;
+#endif
+
+   for (j = 0, mask = pressed & (p->button_button_mask | p->button_analog_mask);
+         mask; j++, mask >>= 1)
+   {
+      if (!(mask & 1))
+         continue;
+
+      if (p->button_button_mask & (1 << j))
+         BIT256_SET(handle->buttons[port], p->target[j]);
+      else
+         analog_value[p->target[j]] = (current_input.analog_buttons[j]
+               ? current_input.analog_buttons[j] : 32767) * p->invert[j];
+   }
+
+   for (j = 0, mask = p->analog_button_mask | p->analog_analog_mask;
+         mask; j++, mask >>= 1)
+   {
+      unsigned k;
+      int16_t current_axis_value;
+
+      if (!(mask & 1))
+         continue;
+
+      k                  = j + RARCH_FIRST_CUSTOM_BIND;
+      current_axis_value = current_input.analogs[j];
+
+      if (!current_axis_value)
+         continue;
+
+      if (p->analog_button_mask & (1 << j))
+      {
+         if (abs(current_axis_value) > axis_threshold * 32767)
+            BIT256_SET(handle->buttons[port], p->target[k]);
+      }
+      else
+         analog_value[p->target[k]] = current_axis_value * p->invert[k];
+   }
+}
+
+void input_mapper_poll(input_mapper_t *handle)
+{
+   unsigned i;
    settings_t *settings                       = config_get_ptr();
    unsigned max_users                         =
       *(input_driver_get_uint(INPUT_ACTION_MAX_USERS));
+   float axis_threshold                       =
+      *input_driver_get_float(INPUT_ACTION_AXIS_THRESHOLD);
    bool key_event[RARCH_CUSTOM_BIND_LIST_END] = { false };
+   bool poll_overlay                          = false;
 #ifdef HAVE_OVERLAY
-   bool poll_overlay = input_overlay_is_alive(overlay_ptr) ? true : false;
+   poll_overlay = input_overlay_is_alive(overlay_ptr) ? true : false;
 #endif
 
+   /* Remaps are edited in place all over the menu, a compare is
+    * cheaper than tracking every one of those. */
+   for (i = 0; i < MAX_USERS; i++)
+      if (!handle->compiled
+            || input_mapper_port_changed(&handle->ports[i], settings, i))
+         input_mapper_compile_port(handle, settings, i);
+   handle->compiled = true;
+
 #ifdef HAVE_MENU
    if (menu_driver_is_alive())
       return;
@@ -106,144 +356,22 @@ void input_mapper_poll(input_mapper_t *handle)
 
    for (i = 0; i < max_users; i++)
    {
-      unsigned device  = settings->uints.input_libretro_device[i];
-      device          &= RETRO_DEVICE_MASK;
+      const input_mapper_port_t *p = &handle->ports[i];
 
-      switch (device)
+      switch (p->device & RETRO_DEVICE_MASK)
       {
             /* keyboard to gamepad remapping */
          case RETRO_DEVICE_KEYBOARD:
-            BIT256_CLEAR_ALL_PTR(&current_input);
-            input_get_state_for_port(settings, i, &current_input);
-            for (j = 0; j < RARCH_CUSTOM_BIND_LIST_END; j++)
-            {
-               unsigned remap_button         =
-                  settings->uints.input_keymapper_ids[i][j];
-               bool remap_valid              = remap_button != RETROK_UNKNOWN;
-
-               if (remap_valid)
-               {
-                  unsigned current_button_value = BIT256_GET(current_input, j);
-#ifdef HAVE_OVERLAY
-               if (poll_overlay && i == 0)
-                  current_button_value |= input_overlay_key_pressed(overlay_ptr, j);
-#endif
-                  if ((current_button_value == 1) && (j != remap_button))
-                  {
-                     MAPPER_SET_KEY (handle,
-                           remap_button);
-                     input_keyboard_event(true,
-                           remap_button,
-                           0, 0, RETRO_DEVICE_KEYBOARD);
-                     key_event[j] = true;
-                  }
-                  /* key_event tracks if a key is pressed for ANY PLAYER, so we must check
-                     if the key was used by any player before releasing */
-                  else if (!key_event[j])
-                  {
-                     input_keyboard_event(false,
-                           remap_button,
-                           0, 0, RETRO_DEVICE_KEYBOARD);
-                  }
-               }
-            }
+            if (p->num_keys)
+               input_mapper_poll_keyboard(handle, p, settings, i,
+                     poll_overlay, key_event);
             break;
 
             /* gamepad remapping */
          case RETRO_DEVICE_JOYPAD:
          case RETRO_DEVICE_ANALOG:
-            /* this loop iterates on all users and all buttons,
-             * and checks if a pressed button is assigned to any
-             * other button than the default one, then it sets
-             * the bit on the mapper input bitmap, later on the
-             * original input is cleared in input_state */
-            BIT256_CLEAR_ALL(handle->buttons[i]);
-            BIT256_CLEAR_ALL_PTR(&current_input);
-
-            for (j = 0; j < 8; j++)
-               handle->analog_value[i][j] = 0;
-
-            input_get_state_for_port(settings, i, &current_input);
-
-            for (j = 0; j < RARCH_FIRST_CUSTOM_BIND; j++)
-            {
-               bool remap_valid;
-               unsigned remap_button;
-               unsigned current_button_value = BIT256_GET(current_input, j);
-#ifdef HAVE_OVERLAY
-               if (poll_overlay && i == 0)
-                  current_button_value |= input_overlay_key_pressed(overlay_ptr, j);
-#endif
-
-               remap_button                  =
-                  settings->uints.input_remap_ids[i][j];
-               remap_valid                   = (current_button_value == 1) &&
-                  (j != remap_button) && (remap_button != RARCH_UNMAPPED);
-
-               if (remap_valid)
-               {
-                  if (remap_button < RARCH_FIRST_CUSTOM_BIND)
-                  {
-                     BIT256_SET(handle->buttons[i], remap_button);
-                  }
-                  else if (remap_button >= RARCH_FIRST_CUSTOM_BIND)
-                  {
-                     int invert = 1;
-
-                     if (remap_button % 2 != 0)
-                        invert = -1;
-
-                     handle->analog_value[i][
-                        remap_button - RARCH_FIRST_CUSTOM_BIND] =
-                           (current_input.analog_buttons[j] ? current_input.analog_buttons[j] : 32767) * invert;
-                  }
-               }
-            }
-
-            for (j = 0; j < 8; j++)
-            {
-               unsigned k                 = j + RARCH_FIRST_CUSTOM_BIND;
-               int16_t current_axis_value = current_input.analogs[j];
-               unsigned remap_axis        =
-                  settings->uints.input_remap_ids[i][k];
-
-               if (
-                     (abs(current_axis_value) > 0 &&
-                     (k != remap_axis)            &&
-                     (remap_axis != RARCH_UNMAPPED)
-                  ))
-               {
-                  if (remap_axis < RARCH_FIRST_CUSTOM_BIND &&
-                     abs(current_axis_value) > *input_driver_get_float(INPUT_ACTION_AXIS_THRESHOLD) * 32767)
-                  {
-                     BIT256_SET(handle->buttons[i], remap_axis);
-                  }
-                  else
-                  {
-                     int invert = 1;
-                     unsigned remap_axis_bind = remap_axis - RARCH_FIRST_CUSTOM_BIND;
-
-                     if (  (k % 2 == 0 && remap_axis % 2 != 0) ||
-                           (k % 2 != 0 && remap_axis % 2 == 0)
-                        )
-                        invert = -1;
-
-                     if (remap_axis_bind < sizeof(handle->analog_value[i]))
-                     {
-                        handle->analog_value[i][
-                           remap_axis_bind] =
-                              current_axis_value * invert;
-                     }
-#if 0
-                     RARCH_LOG("axis %d(%d) remapped to axis %d val %d\n",
-                           j, k,
-                           remap_axis - RARCH_FIRST_CUSTOM_BIND,
-                           current_axis_value);
-#endif
-                  }
-               }
-
-            }
+            input_mapper_poll_joypad(handle, p, settings, i,
+                  poll_overlay, axis_threshold);
             break;
          default:
             break;
@@ -251,6 +379,27 @@ void input_mapper_poll(input_mapper_t *handle)
    }
 }
 
+bool input_mapper_is_remapped(input_mapper_t *handle,
+      unsigned port, unsigned device, unsigned idx, unsigned id)
+{
+   uint32_t reset_mask = handle->ports[port].reset_mask;
+
+   switch (device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         return id < RARCH_ANALOG_BIND_LIST_END && (reset_mask & (1 << id));
+      case RETRO_DEVICE_ANALOG:
+         if (idx < 2 && id < 2)
+         {
+            unsigned offset = RARCH_FIRST_CUSTOM_BIND + (idx * 4) + (id * 2);
+            return (reset_mask & (3 << offset)) != 0;
+         }
+         break;
+   }
+
+   return false;
+}
+
 void input_mapper_state(
       input_mapper_t *handle,
       int16_t *ret,
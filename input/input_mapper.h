@@ -37,6 +37,11 @@ void input_mapper_free(input_mapper_t *handle);
 
 void input_mapper_poll(input_mapper_t *handle);
 
+/* Whether the remap replaces the core's own input for @id,
+ * as of the last input_mapper_poll(). */
+bool input_mapper_is_remapped(input_mapper_t *handle,
+      unsigned port, unsigned device, unsigned idx, unsigned id);
+
 bool input_mapper_key_pressed(input_mapper_t *handle, int key);
 
 void input_mapper_state(
@@ -20,6 +20,7 @@
 #include <math.h>
 
 #include <clamping.h>
+#include <retro_miscellaneous.h>
 
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
@@ -32,6 +33,7 @@
 
 #include "../verbosity.h"
 #include "../gfx/video_driver.h"
+#include "../gfx/video_atlas.h"
 #include "input_overlay.h"
 
 #define OVERLAY_GET_KEY(state, key) (((state)->keys[(key) / 32] >> ((key) % 32)) & 1)
@@ -40,6 +42,21 @@
 #define MAX_VISIBILITY 32
 static enum overlay_visibility* visibility = NULL;
 
+/* Hit-testing only looks at the descriptors whose hitbox overlaps
+ * the grid cell the pointer is in. The grid covers [0, 1] of the
+ * overlay, anything outside is clamped to the border cells. */
+#define OVERLAY_GRID_SIZE 8
+
+#define OVERLAY_ATLAS_MAX_SIZE 4096
+
+typedef struct input_overlay_grid
+{
+   /* Descriptors of cell c are descs[offsets[c]] up to
+    * descs[offsets[c + 1]], in overlay order. */
+   unsigned offsets[OVERLAY_GRID_SIZE * OVERLAY_GRID_SIZE + 1];
+   unsigned *descs;
+} input_overlay_grid_t;
+
 typedef struct input_overlay_state
 {
    /* Left X, Left Y, Right X, Right Y */
@@ -67,11 +84,21 @@ struct input_overlay
    void *iface_data;
    const video_overlay_interface_t *iface;
 
+   /* One per overlay, NULL if they couldn't be built. */
+   input_overlay_grid_t *grids;
+
+   /* Opacity the unpressed alpha was last set with,
+    * unless it has been reset since. */
+   float alpha_opacity;
+   bool alpha_dirty;
+
    input_overlay_state_t overlay_state;
 };
 
 input_overlay_t *overlay_ptr = NULL;
 
+static bool input_overlay_is_hidden(int overlay_idx);
+
 /**
  * input_overlay_add_inputs:
  * @ol : pointer to overlay
@@ -238,6 +265,9 @@ static void input_overlay_set_vertex_geom(input_overlay_t *ol)
       {
          struct overlay_desc *desc = &ol->active->descs[i];
 
+         desc->geom_delta_x = 0.0f;
+         desc->geom_delta_y = 0.0f;
+
          if (!desc->image.pixels)
             continue;
 
@@ -246,6 +276,103 @@ static void input_overlay_set_vertex_geom(input_overlay_t *ol)
       }
 }
 
+static unsigned input_overlay_grid_cell(float v)
+{
+   /* Also takes care of NaN, which can't hit anything anyway. */
+   if (!(v > 0.0f))
+      return 0;
+   if (v >= 1.0f)
+      return OVERLAY_GRID_SIZE - 1;
+   return MIN((unsigned)(v * OVERLAY_GRID_SIZE), OVERLAY_GRID_SIZE - 1);
+}
+
+static void input_overlay_grid_desc_cells(const struct overlay_desc *desc,
+      unsigned *x0, unsigned *y0, unsigned *x1, unsigned *y1)
+{
+   /* Big enough for the pressed hitbox too (see range_mod),
+    * plus some slack so rounding can't lose a hit. */
+   float range_mod = MAX(desc->range_mod, 1.0f);
+   float range_x   = desc->range_x * range_mod + 1.0f / 1024.0f;
+   float range_y   = desc->range_y * range_mod + 1.0f / 1024.0f;
+
+   *x0 = input_overlay_grid_cell(desc->x - range_x);
+   *x1 = input_overlay_grid_cell(desc->x + range_x);
+   *y0 = input_overlay_grid_cell(desc->y - range_y);
+   *y1 = input_overlay_grid_cell(desc->y + range_y);
+}
+
+static bool input_overlay_grid_build(input_overlay_grid_t *grid,
+      const struct overlay *overlay)
+{
+   size_t i;
+   unsigned c, x, y, x0, y0, x1, y1;
+   unsigned fill[OVERLAY_GRID_SIZE * OVERLAY_GRID_SIZE];
+   unsigned total = 0;
+
+   memset(grid->offsets, 0, sizeof(grid->offsets));
+
+   for (i = 0; i < overlay->size; i++)
+   {
+      input_overlay_grid_desc_cells(&overlay->descs[i], &x0, &y0, &x1, &y1);
+      for (y = y0; y <= y1; y++)
+         for (x = x0; x <= x1; x++)
+            grid->offsets[y * OVERLAY_GRID_SIZE + x + 1]++;
+   }
+
+   for (c = 0; c < OVERLAY_GRID_SIZE * OVERLAY_GRID_SIZE; c++)
+   {
+      total                 += grid->offsets[c + 1];
+      grid->offsets[c + 1]   = total;
+      fill[c]                = grid->offsets[c];
+   }
+
+   grid->descs = (unsigned*)malloc(MAX(total, 1) * sizeof(*grid->descs));
+   if (!grid->descs)
+      return false;
+
+   for (i = 0; i < overlay->size; i++)
+   {
+      input_overlay_grid_desc_cells(&overlay->descs[i], &x0, &y0, &x1, &y1);
+      for (y = y0; y <= y1; y++)
+         for (x = x0; x <= x1; x++)
+            grid->descs[fill[y * OVERLAY_GRID_SIZE + x]++] = (unsigned)i;
+   }
+
+   return true;
+}
+
+static void input_overlay_grids_free(input_overlay_t *ol)
+{
+   size_t i;
+
+   if (!ol->grids)
+      return;
+
+   for (i = 0; i < ol->size; i++)
+      free(ol->grids[i].descs);
+   free(ol->grids);
+   ol->grids = NULL;
+}
+
+static void input_overlay_grids_build(input_overlay_t *ol)
+{
+   size_t i;
+
+   ol->grids = (input_overlay_grid_t*)calloc(ol->size, sizeof(*ol->grids));
+   if (!ol->grids)
+      return;
+
+   for (i = 0; i < ol->size; i++)
+   {
+      if (!input_overlay_grid_build(&ol->grids[i], &ol->overlays[i]))
+      {
+         /* Hit-testing falls back to checking every descriptor. */
+         input_overlay_grids_free(ol);
+         return;
+      }
+   }
+}
+
 /**
  * input_overlay_set_scale_factor:
  * @ol                    : Overlay handle.
@@ -283,6 +410,10 @@ void input_overlay_free_overlay(struct overlay *overlay)
       free(overlay->descs);
    overlay->descs       = NULL;
    image_texture_free(&overlay->image);
+   image_texture_free(&overlay->atlas);
+   if (overlay->atlas_rects)
+      free(overlay->atlas_rects);
+   overlay->atlas_rects = NULL;
 
    if (overlay_ptr)
       free(overlay_ptr);
@@ -304,14 +435,98 @@ static void input_overlay_free_overlays(input_overlay_t *ol)
    ol->overlays = NULL;
 }
 
+bool input_overlay_build_atlas(struct overlay *overlay)
+{
+   unsigned i;
+   unsigned width    = 0;
+   unsigned height   = 0;
+   unsigned count    = overlay->load_images_size;
+   unsigned *sizes   = NULL;
+   bool ret          = false;
+
+   if (count < 2)
+      return false;
+
+   /* widths, heights, xs, ys */
+   sizes = (unsigned*)malloc(4 * count * sizeof(*sizes));
+   if (!sizes)
+      return false;
+
+   for (i = 0; i < count; i++)
+   {
+      sizes[i]         = overlay->load_images[i].width;
+      sizes[count + i] = overlay->load_images[i].height;
+   }
+
+   if (!video_atlas_pack(sizes, sizes + count, count,
+            OVERLAY_ATLAS_MAX_SIZE, &width, &height,
+            sizes + 2 * count, sizes + 3 * count))
+      goto end;
+
+   overlay->atlas_rects  = (float*)malloc(4 * count * sizeof(float));
+   overlay->atlas.pixels = (uint32_t*)calloc(
+         (size_t)width * height, sizeof(uint32_t));
+   if (!overlay->atlas_rects || !overlay->atlas.pixels)
+   {
+      free(overlay->atlas_rects);
+      free(overlay->atlas.pixels);
+      overlay->atlas_rects  = NULL;
+      overlay->atlas.pixels = NULL;
+      goto end;
+   }
+
+   overlay->atlas.width         = width;
+   overlay->atlas.height        = height;
+   overlay->atlas.supports_rgba = overlay->load_images[0].supports_rgba;
+
+   for (i = 0; i < count; i++)
+   {
+      const struct texture_image *img = &overlay->load_images[i];
+      unsigned x                      = sizes[2 * count + i];
+      unsigned y                      = sizes[3 * count + i];
+      float *rect                     = &overlay->atlas_rects[4 * i];
+
+      video_atlas_blit(&overlay->atlas, img, x, y);
+
+      rect[0] = (float)x / width;
+      rect[1] = (float)y / height;
+      rect[2] = (float)img->width  / width;
+      rect[3] = (float)img->height / height;
+   }
+
+   ret = true;
+
+end:
+   free(sizes);
+   return ret;
+}
+
 static void input_overlay_load_active(input_overlay_t *ol, float opacity)
 {
+   const struct overlay *active = NULL;
+
    if (!ol)
       return;
 
-   if (ol->iface->load)
-      ol->iface->load(ol->iface_data, ol->active->load_images,
-            ol->active->load_images_size);
+   active = ol->active;
+
+   if (     active->atlas.pixels
+         && ol->iface->load_atlas
+         && ol->iface->tex_geom
+         && ol->iface->load_atlas(ol->iface_data, &active->atlas,
+            active->load_images_size))
+   {
+      unsigned i;
+      for (i = 0; i < active->load_images_size; i++)
+      {
+         const float *rect = &active->atlas_rects[4 * i];
+         ol->iface->tex_geom(ol->iface_data, i,
+               rect[0], rect[1], rect[2], rect[3]);
+      }
+   }
+   else if (ol->iface->load)
+      ol->iface->load(ol->iface_data, active->load_images,
+            active->load_images_size);
 
    input_overlay_set_alpha_mod(ol, opacity);
    input_overlay_set_vertex_geom(ol);
@@ -388,6 +603,9 @@ static void input_overlay_poll(
       int16_t norm_x, int16_t norm_y)
 {
    size_t i;
+   size_t first                = 0;
+   size_t last                 = ol->active->size;
+   const unsigned *candidates  = NULL;
 
    /* norm_x and norm_y is in [-0x7fff, 0x7fff] range,
     * like RETRO_DEVICE_POINTER. */
@@ -399,10 +617,24 @@ static void input_overlay_poll(
    x /= ol->active->mod_w;
    y /= ol->active->mod_h;
 
-   for (i = 0; i < ol->active->size; i++)
+   if (ol->grids)
+   {
+      const input_overlay_grid_t *grid =
+         &ol->grids[ol->active - ol->overlays];
+      unsigned cell                    =
+           input_overlay_grid_cell(y) * OVERLAY_GRID_SIZE
+         + input_overlay_grid_cell(x);
+
+      first      = grid->offsets[cell];
+      last       = grid->offsets[cell + 1];
+      candidates = grid->descs;
+   }
+
+   for (i = first; i < last; i++)
    {
       float x_dist, y_dist;
-      struct overlay_desc *desc = &ol->active->descs[i];
+      struct overlay_desc *desc = &ol->active->descs[
+         candidates ? candidates[i] : i];
 
       if (!inside_hitbox(desc, x, y))
          continue;
@@ -476,27 +708,64 @@ static void input_overlay_update_desc_geom(input_overlay_t *ol,
    if (!desc->movable)
       return;
 
-   if (ol->iface->vertex_geom)
-      ol->iface->vertex_geom(ol->iface_data, desc->image_index,
-            desc->mod_x + desc->delta_x, desc->mod_y + desc->delta_y,
-            desc->mod_w, desc->mod_h);
+   if (     desc->delta_x != desc->geom_delta_x
+         || desc->delta_y != desc->geom_delta_y)
+   {
+      if (ol->iface->vertex_geom)
+         ol->iface->vertex_geom(ol->iface_data, desc->image_index,
+               desc->mod_x + desc->delta_x, desc->mod_y + desc->delta_y,
+               desc->mod_w, desc->mod_h);
+
+      desc->geom_delta_x = desc->delta_x;
+      desc->geom_delta_y = desc->delta_y;
+   }
 
    desc->delta_x = 0.0f;
    desc->delta_y = 0.0f;
 }
 
+/**
+ * input_overlay_update_desc_alpha:
+ * @ol                    : overlay handle.
+ * @desc                  : overlay descriptors handle.
+ * @opacity               : overlay opacity.
+ *
+ * Switch the descriptor's image between pressed and
+ * unpressed alpha, if it changed state.
+ **/
+static void input_overlay_update_desc_alpha(input_overlay_t *ol,
+      struct overlay_desc *desc, float opacity)
+{
+   if (desc->updated == desc->alpha_pressed)
+      return;
+
+   desc->alpha_pressed = desc->updated;
+
+   if (!desc->image.pixels || !ol->iface->set_alpha)
+      return;
+
+   if (desc->updated)
+      ol->iface->set_alpha(ol->iface_data, desc->image_index,
+            desc->alpha_mod * opacity);
+   else
+      ol->iface->set_alpha(ol->iface_data, desc->image_index,
+            input_overlay_is_hidden(desc->image_index) ? 0.0f : opacity);
+}
+
 /**
  * input_overlay_post_poll:
  *
  * Called after all the input_overlay_poll() calls to
  * update the range modifiers for pressed/unpressed regions
- * and alpha mods.
+ * and alpha mods. Only descriptors that changed state since
+ * the last call are sent to the video driver.
  **/
 static void input_overlay_post_poll(input_overlay_t *ol, float opacity)
 {
    size_t i;
 
-   input_overlay_set_alpha_mod(ol, opacity);
+   if (ol->alpha_dirty || ol->alpha_opacity != opacity)
+      input_overlay_set_alpha_mod(ol, opacity);
 
    for (i = 0; i < ol->active->size; i++)
    {
@@ -510,15 +779,9 @@ static void input_overlay_post_poll(input_overlay_t *ol, float opacity)
          /* If pressed this frame, change the hitbox. */
          desc->range_x_mod *= desc->range_mod;
          desc->range_y_mod *= desc->range_mod;
-
-         if (desc->image.pixels)
-         {
-            if (ol->iface->set_alpha)
-               ol->iface->set_alpha(ol->iface_data, desc->image_index,
-                     desc->alpha_mod * opacity);
-         }
       }
 
+      input_overlay_update_desc_alpha(ol, desc, opacity);
       input_overlay_update_desc_geom(ol, desc);
       desc->updated = false;
    }
@@ -537,20 +800,16 @@ static void input_overlay_poll_clear(input_overlay_t *ol, float opacity)
 
    ol->blocked = false;
 
-   input_overlay_set_alpha_mod(ol, opacity);
-
    for (i = 0; i < ol->active->size; i++)
    {
       struct overlay_desc *desc = &ol->active->descs[i];
 
-      desc->range_x_mod = desc->range_x;
-      desc->range_y_mod = desc->range_y;
       desc->updated     = false;
-
       desc->delta_x     = 0.0f;
       desc->delta_y     = 0.0f;
-      input_overlay_update_desc_geom(ol, desc);
    }
+
+   input_overlay_post_poll(ol, opacity);
 }
 
 /**
@@ -586,6 +845,7 @@ void input_overlay_free(input_overlay_t *ol)
       return;
    overlay_ptr = NULL;
 
+   input_overlay_grids_free(ol);
    input_overlay_free_overlays(ol);
 
    if (ol->iface->enable)
@@ -630,6 +890,7 @@ void input_overlay_loaded(void *task_data, void *user_data, const char *err)
    ol->iface      = iface;
    ol->iface_data = video_driver_get_ptr(true);
 
+   input_overlay_grids_build(ol);
    input_overlay_load_active(ol, data->overlay_opacity);
    input_overlay_enable(ol, data->overlay_enable);
 
@@ -672,6 +933,9 @@ void input_overlay_set_visibility(int overlay_idx,
        return;
     if (vis == OVERLAY_VISIBILITY_HIDDEN)
       ol->iface->set_alpha(ol->iface_data, overlay_idx, 0.0);
+
+    /* The next poll restores everything else. */
+    ol->alpha_dirty = true;
 }
 
 static enum overlay_visibility input_overlay_get_visibility(int overlay_idx)
@@ -711,6 +975,12 @@ void input_overlay_set_alpha_mod(input_overlay_t *ol, float mod)
       else
           ol->iface->set_alpha(ol->iface_data, i, mod);
    }
+
+   for (i = 0; i < ol->active->size; i++)
+      ol->active->descs[i].alpha_pressed = false;
+
+   ol->alpha_opacity = mod;
+   ol->alpha_dirty   = false;
 }
 
 bool input_overlay_is_alive(input_overlay_t *ol)
@@ -49,6 +49,12 @@ typedef struct video_overlay_interface
          float x, float y, float w, float h);
    void (*full_screen)(void *data, bool enable);
    void (*set_alpha)(void *data, unsigned image, float mod);
+   /* Optional. Uploads @atlas as the only texture and sets up
+    * @num_images quads drawing from it, which the caller then
+    * places in it with tex_geom. Returns false (e.g. atlas too big)
+    * to make the caller fall back to load(). */
+   bool (*load_atlas)(void *data,
+         const void *atlas, unsigned num_images);
 } video_overlay_interface_t;
 
 enum overlay_hitbox
@@ -117,6 +123,11 @@ struct overlay
 
    struct texture_image image;
 
+   /* All of load_images packed into one texture, with the
+    * x, y, w, h of each in texture coordinates. */
+   struct texture_image atlas;
+   float *atlas_rects;
+
    char name[64];
 
    struct
@@ -159,6 +170,8 @@ struct overlay_desc
 
    bool updated;
    bool movable;
+   /* Whether the pressed alpha is what the video driver has now. */
+   bool alpha_pressed;
 
    unsigned next_index;
    unsigned image_index;
@@ -170,6 +183,8 @@ struct overlay_desc
    float range_x_mod, range_y_mod;
    float mod_x, mod_y, mod_w, mod_h;
    float delta_x, delta_y;
+   /* Delta the video driver's vertex geometry was last set with. */
+   float geom_delta_x, geom_delta_y;
    float x;
    float y;
 
@@ -208,6 +223,17 @@ void input_overlay_free(input_overlay_t *ol);
 
 void input_overlay_free_overlay(struct overlay *overlay);
 
+/**
+ * input_overlay_build_atlas:
+ * @overlay               : overlay with its images loaded.
+ *
+ * Packs the overlay's load_images into overlay->atlas, for video
+ * drivers that can draw the whole overlay from one texture.
+ *
+ * Returns: true if the atlas was built.
+ **/
+bool input_overlay_build_atlas(struct overlay *overlay);
+
 /**
  * input_overlay_init
  *
@@ -27,6 +27,7 @@
 
 #include <compat/strl.h>
 #include <compat/posix_string.h>
+#include <features/features_cpu.h>
 #include <file/file_path.h>
 #include <retro_miscellaneous.h>
 #include <libretro.h>
@@ -37,6 +38,10 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include "common/input_poll_thread.h"
+#endif
+
 #include "input_remote.h"
 
 #include "../configuration.h"
@@ -46,6 +51,13 @@
 #define DEFAULT_NETWORK_GAMEPAD_PORT 55400
 #define UDP_FRAME_PACKETS 16
 
+/* A user whose batched packets stop coming for this long is
+ * released, like a legacy socket error would. */
+#define INPUT_REMOTE_TIMEOUT_USEC 500000
+/* Gap after which a sequence number going backwards is taken as
+ * the sender having restarted rather than as a late packet. */
+#define INPUT_REMOTE_RESTART_USEC 1000000
+
 struct remote_message
 {
    uint16_t state;
@@ -55,14 +67,6 @@ struct remote_message
    int id;
 };
 
-struct input_remote
-{
-   bool state[RARCH_BIND_LIST_END];
-#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
-   int net_fd[MAX_USERS];
-#endif
-};
-
 typedef struct input_remote_state
 {
    /* Left X, Left Y, Right X, Right Y */
@@ -71,12 +75,52 @@ typedef struct input_remote_state
    uint64_t buttons[MAX_USERS];
 } input_remote_state_t;
 
+/* Everything the receiver writes and input_remote_poll() reads. */
+typedef struct input_remote_shared
+{
+   input_remote_state_t state;
+   input_remote_stats_t stats[MAX_USERS];
+   /* Local time the last batched packet for a user came in, 0 if
+    * the user only ever got legacy messages. */
+   retro_time_t arrival[MAX_USERS];
+   /* Sender clock and sequence number of that packet. */
+   uint64_t timestamp[MAX_USERS];
+   uint32_t sequence[MAX_USERS];
+} input_remote_shared_t;
+
+struct input_remote
+{
+   bool state[RARCH_BIND_LIST_END];
+#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
+   int net_fd[MAX_USERS];
+   /* Only touched by the receiver. */
+   input_remote_shared_t shared;
+#ifdef HAVE_THREADS
+   input_poll_thread_t *thread;
+   input_seqlock_t lock;
+#endif
+#endif
+   bool enabled[MAX_USERS];
+};
+
 static input_remote_state_t remote_st_ptr;
+static input_remote_stats_t remote_stats[MAX_USERS];
+
 static input_remote_state_t *input_remote_get_state_ptr(void)
 {
    return &remote_st_ptr;
 }
 
+static void input_remote_clear_user(input_remote_state_t *state,
+      unsigned user)
+{
+   state->buttons[user]   = 0;
+   state->analog[0][user] = 0;
+   state->analog[1][user] = 0;
+   state->analog[2][user] = 0;
+   state->analog[3][user] = 0;
+}
+
 #if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
 static bool input_remote_init_network(input_remote_t *handle,
       uint16_t port, unsigned user)
@@ -116,14 +160,197 @@ error:
       freeaddrinfo_retro(res);
    return false;
 }
+
+static void input_remote_parse_packet(input_remote_state_t *input_state,
+      struct remote_message *msg, unsigned user)
+{
+   /* Parse message */
+   switch (msg->device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         input_state->buttons[user] &= ~(1 << msg->id);
+         if (msg->state)
+            input_state->buttons[user] |= 1 << msg->id;
+         break;
+      case RETRO_DEVICE_ANALOG:
+         input_state->analog[msg->index * 2 + msg->id][user] = msg->state;
+         break;
+   }
+}
+
+static uint16_t input_remote_read16(const uint8_t *p)
+{
+   return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t input_remote_read32(const uint8_t *p)
+{
+   return ((uint32_t)input_remote_read16(p) << 16)
+      | input_remote_read16(p + 2);
+}
+
+static bool input_remote_is_batch(const uint8_t *buf, ssize_t len)
+{
+   return len >= INPUT_REMOTE_HEADER_SIZE
+      && input_remote_read32(buf) == INPUT_REMOTE_MAGIC;
+}
+
+static void input_remote_parse_batch(input_remote_t *handle,
+      const uint8_t *buf, ssize_t len, retro_time_t now)
+{
+   unsigned i;
+   input_remote_shared_t *shared = &handle->shared;
+   unsigned version              = buf[4];
+   unsigned count                = buf[5];
+   uint32_t sequence             = input_remote_read32(buf + 8);
+   uint64_t timestamp            =
+        ((uint64_t)input_remote_read32(buf + 12) << 32)
+      | input_remote_read32(buf + 16);
+
+   /* Newer versions only ever append to an entry. */
+   if (version < INPUT_REMOTE_VERSION)
+      return;
+   if (len < INPUT_REMOTE_HEADER_SIZE
+         + (ssize_t)count * INPUT_REMOTE_ENTRY_SIZE)
+      return;
+
+   for (i = 0; i < count; i++)
+   {
+      const uint8_t *entry   = buf + INPUT_REMOTE_HEADER_SIZE
+         + i * INPUT_REMOTE_ENTRY_SIZE;
+      unsigned user          = entry[0];
+      input_remote_stats_t *stats;
+      int32_t delta;
+
+      if (user >= MAX_USERS || !handle->enabled[user])
+         continue;
+
+      stats = &shared->stats[user];
+      delta = (int32_t)(sequence - shared->sequence[user]);
+
+      if (shared->arrival[user])
+      {
+         if (delta <= 0
+               && now - shared->arrival[user] < INPUT_REMOTE_RESTART_USEC)
+         {
+            /* Late or duplicate, what came after it is newer. */
+            stats->reordered++;
+            continue;
+         }
+
+         if (delta > 1)
+            stats->lost += delta - 1;
+
+         if (delta > 0)
+         {
+            /* Interarrival jitter as in RFC 3550, which works with
+             * the sender's clock being offset from ours. */
+            int64_t d = (int64_t)(now - shared->arrival[user])
+               - (int64_t)(timestamp - shared->timestamp[user]);
+
+            if (d < 0)
+               d = -d;
+            stats->jitter = (uint32_t)((int64_t)stats->jitter
+                  + (d - (int64_t)stats->jitter) / 16);
+         }
+      }
+
+      shared->sequence[user]          = sequence;
+      shared->timestamp[user]         = timestamp;
+      shared->arrival[user]           = now;
+      stats->packets++;
+
+      shared->state.buttons[user]     = input_remote_read16(entry + 2);
+      shared->state.analog[0][user]   = (int16_t)input_remote_read16(entry + 4);
+      shared->state.analog[1][user]   = (int16_t)input_remote_read16(entry + 6);
+      shared->state.analog[2][user]   = (int16_t)input_remote_read16(entry + 8);
+      shared->state.analog[3][user]   = (int16_t)input_remote_read16(entry + 10);
+   }
+}
+
+/* Reads every datagram waiting on the sockets, waiting up to
+ * @timeout_ms for the first one. */
+static void input_remote_receive(input_remote_t *handle,
+      unsigned timeout_ms)
+{
+   unsigned user;
+   fd_set fds;
+   struct timeval tv;
+   int max_fd = -1;
+
+   FD_ZERO(&fds);
+   for (user = 0; user < MAX_USERS; user++)
+   {
+      if (handle->net_fd[user] < 0)
+         continue;
+      FD_SET(handle->net_fd[user], &fds);
+      if (handle->net_fd[user] > max_fd)
+         max_fd = handle->net_fd[user];
+   }
+
+   if (max_fd < 0)
+      return;
+
+   tv.tv_sec  = 0;
+   tv.tv_usec = timeout_ms * 1000;
+
+   if (socket_select(max_fd + 1, &fds, NULL, NULL, &tv) <= 0)
+      return;
+
+#ifdef HAVE_THREADS
+   input_seqlock_write_begin(&handle->lock);
+#endif
+
+   for (user = 0; user < MAX_USERS; user++)
+   {
+      uint8_t buf[INPUT_REMOTE_HEADER_SIZE
+         + MAX_USERS * INPUT_REMOTE_ENTRY_SIZE];
+
+      if (handle->net_fd[user] < 0 || !FD_ISSET(handle->net_fd[user], &fds))
+         continue;
+
+      for (;;)
+      {
+         ssize_t ret = recvfrom(handle->net_fd[user], (char*)buf,
+               sizeof(buf), 0, NULL, NULL);
+
+         if (input_remote_is_batch(buf, ret))
+            input_remote_parse_batch(handle, buf, ret,
+                  cpu_features_get_time_usec());
+         else if (ret == sizeof(struct remote_message))
+         {
+            struct remote_message msg;
+            memcpy(&msg, buf, sizeof(msg));
+            input_remote_parse_packet(&handle->shared.state, &msg, user);
+         }
+         else
+         {
+            if ((ret != -1) || ((errno != EAGAIN) && (errno != ENOENT)))
+               input_remote_clear_user(&handle->shared.state, user);
+            break;
+         }
+      }
+   }
+
+#ifdef HAVE_THREADS
+   input_seqlock_write_end(&handle->lock);
+#endif
+}
+
+#ifdef HAVE_THREADS
+static void input_remote_thread_poll(input_poll_thread_t *thread,
+      void *data)
+{
+   input_remote_receive((input_remote_t*)data,
+         INPUT_POLL_THREAD_PERIOD_MS);
+}
+#endif
 #endif
 
 input_remote_t *input_remote_new(uint16_t port, unsigned max_users)
 {
    unsigned user;
-#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
    settings_t   *settings = config_get_ptr();
-#endif
    input_remote_t *handle = (input_remote_t*)
       calloc(1, sizeof(*handle));
 
@@ -132,14 +359,32 @@ input_remote_t *input_remote_new(uint16_t port, unsigned max_users)
 
    (void)port;
 
+   for (user = 0; user < max_users && user < MAX_USERS; user++)
+      handle->enabled[user] = settings->bools.network_remote_enable_user[user];
+
+   memset(remote_stats, 0, sizeof(remote_stats));
+
 #if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
-   for(user = 0; user < max_users; user ++)
-   {
+   for (user = 0; user < MAX_USERS; user++)
       handle->net_fd[user] = -1;
-      if(settings->bools.network_remote_enable_user[user])
+
+   for (user = 0; user < max_users; user++)
+      if (handle->enabled[user])
          if (!input_remote_init_network(handle, port, user))
             goto error;
+
+#ifdef HAVE_THREADS
+   /* Without the thread, input_remote_poll() does the reading */
+   for (user = 0; user < max_users; user++)
+   {
+      if (handle->net_fd[user] >= 0)
+      {
+         handle->thread = input_poll_thread_new(
+               input_remote_thread_poll, handle);
+         break;
+      }
    }
+#endif
 #endif
 
    return handle;
@@ -155,6 +400,9 @@ void input_remote_free(input_remote_t *handle, unsigned max_users)
 {
    unsigned user;
 #if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
+#ifdef HAVE_THREADS
+   input_poll_thread_free(handle->thread);
+#endif
 
    for(user = 0; user < max_users; user ++)
       socket_close(handle->net_fd[user]);
@@ -163,26 +411,6 @@ void input_remote_free(input_remote_t *handle, unsigned max_users)
    free(handle);
 }
 
-#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
-static void input_remote_parse_packet(struct remote_message *msg, unsigned user)
-{
-   input_remote_state_t *input_state  = input_remote_get_state_ptr();
-
-   /* Parse message */
-   switch (msg->device)
-   {
-      case RETRO_DEVICE_JOYPAD:
-         input_state->buttons[user] &= ~(1 << msg->id);
-         if (msg->state)
-            input_state->buttons[user] |= 1 << msg->id;
-         break;
-      case RETRO_DEVICE_ANALOG:
-         input_state->analog[msg->index * 2 + msg->id][user] = msg->state;
-         break;
-   }
-}
-#endif
-
 void input_remote_state(
       int16_t *ret,
       unsigned port,
@@ -225,41 +453,77 @@ bool input_remote_key_pressed(int key, unsigned port)
    return (input_state->buttons[port] & (UINT64_C(1) << key));
 }
 
+bool input_remote_get_stats(unsigned user, input_remote_stats_t *stats)
+{
+   if (user >= MAX_USERS || !remote_stats[user].packets)
+      return false;
+
+   *stats = remote_stats[user];
+   return true;
+}
+
 void input_remote_poll(input_remote_t *handle, unsigned max_users)
 {
    unsigned user;
    settings_t *settings            = config_get_ptr();
    input_remote_state_t *input_state  = input_remote_get_state_ptr();
+#if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
+   input_remote_shared_t shared;
+   retro_time_t now;
 
-   for(user = 0; user < max_users; user++)
+#ifdef HAVE_THREADS
+   if (handle->thread)
    {
-      if (settings->bools.network_remote_enable_user[user])
+      unsigned seq;
+
+      do
       {
+         seq    = input_seqlock_read_begin(&handle->lock);
+         shared = handle->shared;
+      } while (input_seqlock_read_retry(&handle->lock, seq));
+   }
+   else
+#endif
+   {
+      input_remote_receive(handle, 0);
+      shared = handle->shared;
+   }
+
+   now = cpu_features_get_time_usec();
+#endif
+
+   for(user = 0; user < max_users; user++)
+   {
+      if (!settings->bools.network_remote_enable_user[user])
+         continue;
+
 #if defined(HAVE_NETWORKING) && defined(HAVE_NETWORKGAMEPAD)
-         struct remote_message msg;
-         ssize_t ret;
-         fd_set fds;
+      if (handle->net_fd[user] < 0)
+      {
+         input_remote_clear_user(input_state, user);
+         continue;
+      }
 
-         if (handle->net_fd[user] < 0)
-            return;
+      input_state->buttons[user]   = shared.state.buttons[user];
+      input_state->analog[0][user] = shared.state.analog[0][user];
+      input_state->analog[1][user] = shared.state.analog[1][user];
+      input_state->analog[2][user] = shared.state.analog[2][user];
+      input_state->analog[3][user] = shared.state.analog[3][user];
 
-         FD_ZERO(&fds);
-         FD_SET(handle->net_fd[user], &fds);
+      remote_stats[user]           = shared.stats[user];
 
-         ret = recvfrom(handle->net_fd[user], (char*)&msg,
-               sizeof(msg), 0, NULL, NULL);
+      if (shared.arrival[user])
+      {
+         retro_time_t age = now - shared.arrival[user];
 
-         if (ret == sizeof(msg))
-            input_remote_parse_packet(&msg, user);
-         else if ((ret != -1) || ((errno != EAGAIN) && (errno != ENOENT)))
-#endif
-         {
-            input_state->buttons[user]   = 0;
-            input_state->analog[0][user] = 0;
-            input_state->analog[1][user] = 0;
-            input_state->analog[2][user] = 0;
-            input_state->analog[3][user] = 0;
-         }
+         remote_stats[user].age = (uint32_t)age;
+
+         /* The sender went away, don't leave buttons held */
+         if (age > INPUT_REMOTE_TIMEOUT_USEC)
+            input_remote_clear_user(input_state, user);
       }
+#else
+      input_remote_clear_user(input_state, user);
+#endif
    }
 }
@@ -28,6 +28,45 @@
 
 RETRO_BEGIN_DECLS
 
+/* Besides the legacy one message per button or axis change, each
+ * user's port takes batched packets carrying any number of users,
+ * all fields big endian:
+ *
+ * header, INPUT_REMOTE_HEADER_SIZE bytes
+ *    0  uint32  INPUT_REMOTE_MAGIC
+ *    4  uint8   version, INPUT_REMOTE_VERSION or newer
+ *    5  uint8   number of entries
+ *    6  uint16  reserved, 0
+ *    8  uint32  sequence number, one up for every packet sent
+ *   12  uint64  sender timestamp in usec, any epoch
+ *
+ * then per entry, INPUT_REMOTE_ENTRY_SIZE bytes
+ *    0  uint8   user
+ *    1  uint8   reserved, 0
+ *    2  uint16  buttons, 1 << RETRO_DEVICE_ID_JOYPAD_*
+ *    4  int16   left X, left Y, right X, right Y
+ *
+ * Each entry is the whole state of its user. Packets older than
+ * the last one seen for a user are dropped. */
+#define INPUT_REMOTE_MAGIC       0x52414952 /* "RAIR" */
+#define INPUT_REMOTE_VERSION     1
+#define INPUT_REMOTE_HEADER_SIZE 20
+#define INPUT_REMOTE_ENTRY_SIZE  12
+
+typedef struct input_remote_stats
+{
+   /* Batched packets applied */
+   uint64_t packets;
+   /* Sequence numbers never received */
+   uint64_t lost;
+   /* Late or duplicate packets, dropped */
+   uint64_t reordered;
+   /* Interarrival jitter, in usec */
+   uint32_t jitter;
+   /* Time since the last packet, at the last poll, in usec */
+   uint32_t age;
+} input_remote_stats_t;
+
 typedef struct input_remote input_remote_t;
 
 input_remote_t *input_remote_new(uint16_t port, unsigned max_users);
@@ -38,6 +77,9 @@ void input_remote_poll(input_remote_t *handle, unsigned max_users);
 
 bool input_remote_key_pressed(int key, unsigned port);
 
+/* False if @user hasn't had a batched packet yet. */
+bool input_remote_get_stats(unsigned user, input_remote_stats_t *stats);
+
 void input_remote_state(
       int16_t *ret,
       unsigned port,
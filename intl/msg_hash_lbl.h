@@ -62,8 +62,12 @@ MSG_HASH(MENU_ENUM_LABEL_AUDIO_SETTINGS,
       "audio_settings")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_SYNC,
       "audio_sync")
+MSG_HASH(MENU_ENUM_LABEL_AUDIO_PULL,
+      "audio_pull")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_VOLUME,
       "audio_volume")
+MSG_HASH(MENU_ENUM_LABEL_AUDIO_ALSA_MMAP,
+      "audio_alsa_mmap")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE,
       "audio_wasapi_exclusive_mode")
 MSG_HASH(MENU_ENUM_LABEL_AUDIO_WASAPI_FLOAT_FORMAT,
@@ -176,6 +180,8 @@ MSG_HASH(MENU_ENUM_LABEL_CHEEVOS_VERBOSE_ENABLE,
       "cheevos_verbose_enable")
 MSG_HASH(MENU_ENUM_LABEL_CHEEVOS_AUTO_SCREENSHOT,
       "cheevos_auto_screenshot")
+MSG_HASH(MENU_ENUM_LABEL_CHEEVOS_THREADED,
+      "cheevos_threaded")
 MSG_HASH(MENU_ENUM_LABEL_CLOSE_CONTENT,
       "unload_core")
 MSG_HASH(MENU_ENUM_LABEL_COLLECTION,
@@ -431,6 +437,8 @@ MSG_HASH(MENU_ENUM_LABEL_CHECK_FOR_MISSING_FIRMWARE,
       "check_for_missing_firmware")
 MSG_HASH(MENU_ENUM_LABEL_DUMMY_ON_CORE_SHUTDOWN,
       "dummy_on_core_shutdown")
+MSG_HASH(MENU_ENUM_LABEL_CORE_CACHE_ENABLE,
+      "core_cache_enable")
 MSG_HASH(MENU_ENUM_LABEL_DYNAMIC_WALLPAPER,
       "menu_dynamic_wallpaper_enable")
 MSG_HASH(MENU_ENUM_LABEL_DYNAMIC_WALLPAPERS_DIRECTORY,
@@ -473,6 +481,8 @@ MSG_HASH(MENU_ENUM_LABEL_FPS_SHOW,
       "fps_show")
 MSG_HASH(MENU_ENUM_LABEL_STATISTICS_SHOW,
       "statistics_show")
+MSG_HASH(MENU_ENUM_LABEL_PERF_OVERLAY_SHOW,
+      "perf_overlay_show")
 MSG_HASH(MENU_ENUM_LABEL_FRAME_THROTTLE_ENABLE,
       "fastforward_ratio_throttle_enable")
 MSG_HASH(MENU_ENUM_LABEL_FRAME_THROTTLE_SETTINGS,
@@ -565,6 +575,8 @@ MSG_HASH(MENU_ENUM_LABEL_INPUT_PLAYER_ANALOG_DPAD_MODE,
       "input_player%u_analog_dpad_mode")
 MSG_HASH(MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR,
       "input_poll_type_behavior")
+MSG_HASH(MENU_ENUM_LABEL_INPUT_POLL_THREAD,
+      "input_poll_thread")
 MSG_HASH(MENU_ENUM_LABEL_INPUT_PREFER_FRONT_TOUCH,
       "input_prefer_front_touch")
 MSG_HASH(MENU_ENUM_LABEL_INPUT_REMAPPING_DIRECTORY,
@@ -713,6 +725,8 @@ MSG_HASH(MENU_ENUM_LABEL_NETPLAY_MODE,
       "netplay_mode")
 MSG_HASH(MENU_ENUM_LABEL_NETPLAY_NAT_TRAVERSAL,
       "netplay_nat_traversal")
+MSG_HASH(MENU_ENUM_LABEL_NETPLAY_UDP_INPUT,
+      "netplay_udp_input")
 MSG_HASH(MENU_ENUM_LABEL_NETPLAY_NICKNAME,
       "netplay_nickname")
 MSG_HASH(MENU_ENUM_LABEL_NETPLAY_PASSWORD,
@@ -743,6 +757,10 @@ MSG_HASH(MENU_ENUM_LABEL_NETWORK_INFORMATION,
       "network_information")
 MSG_HASH(MENU_ENUM_LABEL_NETWORK_INFO_ENTRY,
       "network_info_entry")
+MSG_HASH(MENU_ENUM_LABEL_SHADER_PASS_TIMES,
+      "shader_pass_times")
+MSG_HASH(MENU_ENUM_LABEL_SHADER_PASS_TIMES_ENTRY,
+      "shader_pass_times_entry")
 MSG_HASH(MENU_ENUM_LABEL_NETWORK_REMOTE_ENABLE,
       "network_remote_enable")
 MSG_HASH(MENU_ENUM_LABEL_NETWORK_REMOTE_PORT,
@@ -971,6 +989,8 @@ MSG_HASH(MENU_ENUM_LABEL_INPUT_META_REWIND,
       "input_meta_rewind")
 MSG_HASH(MENU_ENUM_LABEL_REWIND_ENABLE,
       "rewind_enable")
+MSG_HASH(MENU_ENUM_LABEL_REWIND_THREADED,
+      "rewind_threaded")
 MSG_HASH(MENU_ENUM_LABEL_CHEAT_APPLY_AFTER_TOGGLE,
       "cheat_apply_after_toggle")
 MSG_HASH(MENU_ENUM_LABEL_CHEAT_APPLY_AFTER_LOAD,
@@ -981,10 +1001,18 @@ MSG_HASH(MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,
       "rewind_buffer_size")
 MSG_HASH(MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
       "rewind_buffer_size_step")
+MSG_HASH(MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL,
+      "rewind_keyframe_interval")
+MSG_HASH(MENU_ENUM_LABEL_REWIND_KEYFRAME_BUFFER_SIZE,
+      "rewind_keyframe_buffer_size")
+MSG_HASH(MENU_ENUM_LABEL_REWIND_KEYFRAME_SPILL_COUNT,
+      "rewind_keyframe_spill_count")
 MSG_HASH(MENU_ENUM_LABEL_REWIND_SETTINGS,
       "rewind_settings")
 MSG_HASH(MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE,
       "vrr_runloop_enable")
+MSG_HASH(MENU_ENUM_LABEL_MENU_SKIP_UNCHANGED_FRAMES,
+      "menu_skip_unchanged_frames")
 MSG_HASH(MENU_ENUM_LABEL_CHEAT_SETTINGS,
       "cheat_settings")
 MSG_HASH(MENU_ENUM_LABEL_RGUI_BROWSER_DIRECTORY,
@@ -1013,6 +1041,8 @@ MSG_HASH(MENU_ENUM_LABEL_SAVESTATE_AUTO_LOAD,
       "savestate_auto_load")
 MSG_HASH(MENU_ENUM_LABEL_SAVESTATE_THUMBNAIL_ENABLE,
       "savestate_thumbnails")
+MSG_HASH(MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,
+      "savestate_file_compression")
 MSG_HASH(MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,
       "savestate_auto_save")
 MSG_HASH(MENU_ENUM_LABEL_SAVESTATE_DIRECTORY,
@@ -1067,6 +1097,14 @@ MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_ENABLED,
       "run_ahead_enabled")
 MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,
       "run_ahead_secondary_instance")
+MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED,
+      "run_ahead_secondary_threaded")
+MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_SKIP_ROLLBACK,
+      "run_ahead_skip_rollback")
+MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_FRAMES_AUTO,
+      "run_ahead_frames_auto")
+MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_DETECT_LAG,
+      "run_ahead_detect_lag")
 MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,
       "run_ahead_hide_warnings")
 MSG_HASH(MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
@@ -1209,20 +1247,30 @@ MSG_HASH(MENU_ENUM_LABEL_VIDEO_FONT_PATH,
       "video_font_path")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_FONT_SIZE,
       "video_font_size")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_FONT_SDF,
+      "video_font_sdf")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_FORCE_ASPECT,
       "video_force_aspect")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_FORCE_SRGB_DISABLE,
       "video_force_srgb_disable")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
       "video_frame_delay")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+      "video_frame_delay_auto")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_FULLSCREEN,
       "video_fullscreen")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_GAMMA,
       "video_gamma")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_GPU_RECORD,
       "video_gpu_record")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_STREAM_RECORD,
+      "video_stream_record")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_RECORD_HW_ENCODER,
+      "video_record_hw_encoder")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,
       "video_gpu_screenshot")
+MSG_HASH(MENU_ENUM_LABEL_SCREENSHOT_FAST_ENCODE,
+      "screenshot_fast_encode")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_HARD_SYNC,
       "video_hard_sync")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_HARD_SYNC_FRAMES,
@@ -1283,6 +1331,10 @@ MSG_HASH(MENU_ENUM_LABEL_VIDEO_TAB,
       "video_tab")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_THREADED,
       "video_threaded")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_SHADER_PARALLEL_RECORD,
+      "video_shader_parallel_record")
+MSG_HASH(MENU_ENUM_LABEL_VIDEO_SHADER_DYNAMIC_SCALE_MIN,
+      "video_shader_dynamic_scale_min")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_VFILTER,
       "video_vfilter")
 MSG_HASH(MENU_ENUM_LABEL_VIDEO_VIEWPORT_CUSTOM_HEIGHT,
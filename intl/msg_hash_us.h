@@ -185,6 +185,14 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_THREADED,
     "Improves performance at the cost of latency and more video stuttering. Use only if you cannot obtain full speed otherwise."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_SHADER_PARALLEL_RECORD,
+    "Vulkan only. Records the passes of a multi-pass shader on several threads. Can help heavy presets on CPUs with many slow cores."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_SHADER_DYNAMIC_SCALE_MIN,
+    "Vulkan only. Lets the intermediate passes of a shader render at a lower resolution, down to this percentage, when the GPU can't keep up with the refresh rate. 100% disables it."
+    )
 MSG_HASH(
     MSG_AUDIO_VOLUME,
     "Audio volume"
@@ -341,10 +349,18 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUDIO_SYNC,
     "Audio Sync"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_AUDIO_PULL,
+    "Audio Pull Mode"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUDIO_VOLUME,
     "Audio Volume Level (dB)"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_AUDIO_ALSA_MMAP,
+    "ALSA Memory-Mapped Output"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUDIO_WASAPI_EXCLUSIVE_MODE,
     "WASAPI Exclusive Mode"
@@ -557,6 +573,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_CHEEVOS_AUTO_SCREENSHOT,
     "Automatic Screenshot"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_CHEEVOS_THREADED,
+    "Threaded Evaluation"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_CLOSE_CONTENT,
     "Close Content"
@@ -817,6 +837,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_DUMMY_ON_CORE_SHUTDOWN,
     "Load Dummy on Core Shutdown"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_CORE_CACHE_ENABLE,
+    "Keep Recent Cores Loaded"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_CHECK_FOR_MISSING_FIRMWARE,
     "Check for Missing Firmware Before Loading"
@@ -869,6 +893,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VRR_RUNLOOP_ENABLE,
     "Sync to Exact Content Framerate (G-Sync, FreeSync)"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_MENU_SKIP_UNCHANGED_FRAMES,
+    "Skip Unchanged Menu Frames"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_FRAME_THROTTLE_SETTINGS,
     "Frame Throttle"
@@ -1397,6 +1425,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_INPUT_POLL_TYPE_BEHAVIOR,
     "Poll Type Behavior"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_INPUT_POLL_THREAD,
+    "Threaded Input Polling"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_INPUT_POLL_TYPE_BEHAVIOR_EARLY,
     "Early"
@@ -1845,6 +1877,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_NETPLAY_NAT_TRAVERSAL,
     "Netplay NAT Traversal"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_NETPLAY_UDP_INPUT,
+    "Send Input over UDP"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_NETWORK_CMD_ENABLE,
     "Network Commands"
@@ -1857,6 +1893,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_NETWORK_INFORMATION,
     "Network Information"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_SHADER_PASS_TIMES,
+    "Shader Pass Breakdown"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_NETWORK_REMOTE_ENABLE,
     "Network Gamepad"
@@ -2308,6 +2348,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_REWIND_ENABLE,
     "Rewind Enable"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+    "Threaded Rewind"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_CHEAT_APPLY_AFTER_TOGGLE,
     "Apply After Toggle"
@@ -2328,6 +2372,18 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_REWIND_BUFFER_SIZE_STEP,
     "Rewind Buffer Size Step (MB)"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_INTERVAL,
+    "Rewind Keyframe Interval"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_BUFFER_SIZE,
+    "Rewind Keyframe Buffer Size (MB)"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_SPILL_COUNT,
+    "Rewind Keyframes On Disk"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_REWIND_SETTINGS,
     "Rewind"
@@ -2408,6 +2464,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_SAVESTATE_THUMBNAIL_ENABLE,
     "Savestate Thumbnails"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_SAVESTATE_FILE_COMPRESSION,
+    "Savestate Compression"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_SAVE_CURRENT_CONFIG,
     "Save Current Configuration"
@@ -2528,6 +2588,22 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_INSTANCE,
     "RunAhead Use Second Instance"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREADED,
+    "Run Secondary Instance on a Thread"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SKIP_ROLLBACK,
+    "Skip Rollback When Input Is Unchanged"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_RUN_AHEAD_FRAMES_AUTO,
+    "Automatic Number of Frames"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_RUN_AHEAD_DETECT_LAG,
+    "Detect Input Lag"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_RUN_AHEAD_HIDE_WARNINGS,
     "RunAhead Hide Warnings"
@@ -3152,6 +3228,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_FONT_SIZE,
     "Notification Size"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_FONT_SDF,
+    "Distance Field Fonts"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_FORCE_ASPECT,
     "Force aspect ratio"
@@ -3164,6 +3244,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY,
     "Frame Delay"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+    "Automatic Frame Delay"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_FULLSCREEN,
     "Start in Fullscreen Mode"
@@ -3176,10 +3260,22 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_GPU_RECORD,
     "Use GPU Recording"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_STREAM_RECORD,
+    "Record While Streaming"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_HW_ENCODER,
+    "Hardware Video Encoder"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_GPU_SCREENSHOT,
     "GPU Screenshot Enable"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_SCREENSHOT_FAST_ENCODE,
+    "Fast Screenshot Encoding"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_HARD_SYNC,
     "Hard GPU Sync"
@@ -3296,6 +3392,14 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_THREADED,
     "Threaded Video"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_PARALLEL_RECORD,
+    "Parallel Shader Recording"
+    )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_DYNAMIC_SCALE_MIN,
+    "Shader Dynamic Scale Minimum"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_VIDEO_VFILTER,
     "Deflicker"
@@ -3560,6 +3664,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_CHEEVOS_AUTO_SCREENSHOT,
     "Automatically take a screenshot when an achievement is triggered."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_CHEEVOS_THREADED,
+    "Test achievements against a copy of the memory they use on a separate thread. Unlocks are reported one frame later."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_DRIVER_SETTINGS,
     "Change drivers used by the system."
@@ -3736,6 +3844,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY,
     "Reduces latency at the cost of a higher risk of video stuttering. Adds a delay after V-Sync (in ms)."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO,
+    "Pick the longest frame delay that still makes VSync, based on measured frame and present times. Overrides Frame Delay."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_HARD_SYNC_FRAMES,
     "Sets how many frames the CPU can run ahead of the GPU when using 'Hard GPU Sync'."
@@ -4592,6 +4704,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_INPUT_POLL_TYPE_BEHAVIOR,
     "Influence how input polling is done inside RetroArch. Setting it to 'Early' or 'Late' can result in less latency, depending on your configuration."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_INPUT_POLL_THREAD,
+    "Read joypads on a dedicated thread at 1 kHz instead of once per frame. Combined with the 'Late' poll type, the core gets the joypad state as of its first input read of each frame. Currently supported by the udev joypad driver."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_INPUT_ALL_USERS_CONTROL_MENU,
     "Allows any user to control the menu. If disabled, only User 1 can control the menu."
@@ -4600,6 +4716,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_AUDIO_VOLUME,
     "Audio volume (in dB). 0 dB is normal volume, and no gain is applied."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_AUDIO_ALSA_MMAP,
+    "Write audio straight into the device buffer instead of copying it through the kernel. Lowers latency on hardware devices; falls back to normal output if the device doesn't support it."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_AUDIO_WASAPI_EXCLUSIVE_MODE,
     "Allow the WASAPI driver to take exclusive control of the audio device. If disabled, it will use shared mode instead."
@@ -4616,6 +4736,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_AUDIO_SYNC,
     "Synchronize audio. Recommended."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_AUDIO_PULL,
+    "Let the audio driver fetch samples from its own callback instead of blocking on writes. Half of Audio Latency goes to the driver, half to a lock-free ring kept half full by rate control, so lower latencies work without underruns. Supported by the PulseAudio and CoreAudio drivers."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_INPUT_AXIS_THRESHOLD,
     "How far an axis must be tilted to result in a button press."
@@ -4648,6 +4772,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_DUMMY_ON_CORE_SHUTDOWN,
     "Some cores might have a shutdown feature. If enabled, it will prevent the core from shutting RetroArch down. Instead, it loads a dummy core."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_CORE_CACHE_ENABLE,
+    "Leave the last 4 cores loaded in memory after closing them, so switching back to one is faster. Some cores misbehave when started again without being reloaded."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_CHECK_FOR_MISSING_FIRMWARE,
     "Check if all the required firmware is present before attempting to load content."
@@ -4914,6 +5042,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_NETWORK_INFORMATION,
     "Show network interface(s) and associated IP addresses."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_SHADER_PASS_TIMES,
+    "Show how long the GPU spends on each pass of the loaded shader, averaged over recent frames."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_SYSTEM_INFORMATION,
     "Show information specific to the device."
@@ -4954,6 +5086,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_FONT_SIZE,
     "Specify the font size in points."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_FONT_SDF,
+    "Render on-screen text from one signed distance field atlas shared by every size, which stays sharp when scaled. Needs the GLSL shader backend."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_INPUT_OVERLAY_HIDE_IN_MENU,
     "Hide the overlay while inside the menu, and show it again when exiting the menu."
@@ -4978,6 +5114,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_GPU_SCREENSHOT,
     "Screenshots output of GPU shaded material if available."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_SCREENSHOT_FAST_ENCODE,
+    "Encode screenshots and savestate thumbnails much faster. The files are bigger."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_ROTATION,
     "Forces a certain rotation of the screen. The rotation is added to rotations which the core sets."
@@ -4998,6 +5138,14 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VIDEO_GPU_RECORD,
     "Records output of GPU shaded material if available."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_STREAM_RECORD,
+    "Also saves streams to a local MKV file in the recording directory. The file is muxed from the same encoded packets, so it costs no extra encoding."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_VIDEO_RECORD_HW_ENCODER,
+    "Encodes H.264/HEVC recordings and streams on the GPU (VA-API, NVENC, Quick Sync or VideoToolbox) when available. Falls back to the software encoder otherwise."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_SAVESTATE_AUTO_INDEX,
     "When making a savestate, save state index is automatically increased before it is saved. When loading content, the index will be set to the highest existing index."
@@ -5026,6 +5174,22 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE,
     "Use a second instance of the RetroArch core to run ahead. Prevents audio problems due to loading state."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREADED,
+    "Let the secondary instance speculate the next frame on its own thread while the main instance runs. Only used with software rendered cores."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_RUN_AHEAD_FRAMES_AUTO,
+    "Run fewer frames ahead when running them all would miss vsync, and go back up to the number of frames set above when there is time left."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_RUN_AHEAD_DETECT_LAG,
+    "Measure how many frames the game takes to react to input, by pressing buttons from a savestate and watching the picture. Runs ahead by that many frames instead of the number set above. The game may pause for a moment while it is measured."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_RUN_AHEAD_SKIP_ROLLBACK,
+    "Keep the core at the speculated frames while the input matches and only roll back when it changes. Uses one savestate per Run-Ahead frame. Savestates and rewind will capture the speculated frame."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS,
     "Hides the warning message that appears when using RunAhead and the core does not support savestates."
@@ -5034,6 +5198,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_REWIND_ENABLE,
     "Enable rewinding. This will take a performance hit when playing."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_REWIND_THREADED,
+    "Compress rewind states on a separate thread. Reduces the per-frame cost of rewind for cores with large save states."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_CHEAT_APPLY_AFTER_TOGGLE,
     "Apply cheat immediately after toggling."
@@ -5067,6 +5235,18 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
     "Each time you increase or decrease the rewind buffer size value via this UI it will change by this amount"
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_INTERVAL,
+    "Number of frames between the full keyframes kept after the rewind buffer runs out. Rewinding further than the buffer jumps back one keyframe at a time."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_BUFFER_SIZE,
+    "The amount of memory (in MB) to reserve for rewind keyframes. Set to 0 to disable the keyframe history."
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_SPILL_COUNT,
+    "Number of older rewind keyframes to spill to the cache directory once the keyframe buffer is full. Set to 0 to keep the history in RAM only."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_CHEAT_IDX,
     "Index position in list."
@@ -5180,6 +5360,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_SAVESTATE_THUMBNAIL_ENABLE,
     "Show thumbnails of save states inside the menu."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION,
+    "Compress save states while they are written. Both compressed and uncompressed states can be loaded."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_AUTOSAVE_INTERVAL,
     "Autosaves the non-volatile Save RAM at a regular interval. This is disabled by default unless set otherwise. The interval is measured in seconds. A value of 0 disables autosave."
@@ -5328,6 +5512,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_NETPLAY_NAT_TRAVERSAL,
     "When hosting, attempt to listen for connections from the public Internet, using UPnP or similar technologies to escape LANs."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_NETPLAY_UDP_INPUT,
+    "Also send input over UDP, repeating the last few frames in every packet, so a lost packet doesn't hold up the following frames. Both sides must enable it."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_STDIN_CMD_ENABLE,
     "Enable stdin command interface."
@@ -5620,6 +5808,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_VRR_RUNLOOP_ENABLE,
     "No deviation from core requested timing. Use for Variable Refresh Rate screens, G-Sync, FreeSync."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_MENU_SKIP_UNCHANGED_FRAMES,
+    "Only draws the menu when something on it changes, saving power while it sits idle."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_XMB_LAYOUT,
     "Select a different layout for the XMB interface."
@@ -6353,6 +6545,18 @@ MSG_HASH(
     MSG_RUNAHEAD_FAILED_TO_CREATE_SECONDARY_INSTANCE,
     "Failed to create second instance.  RunAhead will now use only one instance."
     )
+MSG_HASH(
+    MSG_RUNAHEAD_LAG_DETECTED,
+    "RunAhead: game reacts to input after %u frames."
+    )
+MSG_HASH(
+    MSG_RUNAHEAD_NO_LAG_DETECTED,
+    "RunAhead: game reacts to input right away, nothing to run ahead."
+    )
+MSG_HASH(
+    MSG_RUNAHEAD_LAG_DETECTION_FAILED,
+    "RunAhead: can't detect input lag, the core doesn't replay the same frames from a savestate."
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_AUTOMATICALLY_ADD_CONTENT_TO_PLAYLIST,
     "Automatically add content to playlist"
@@ -6397,6 +6601,14 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_STATISTICS_SHOW,
     "Show onscreen technical statistics."
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_PERF_OVERLAY_SHOW,
+    "Display Performance Overlay"
+    )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_PERF_OVERLAY_SHOW,
+    "Show a frame time graph with core, video and audio timings, audio buffer fill, dropped and duplicated frames, and runahead and netplay rollbacks."
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_MENU_RGUI_BORDER_FILLER_ENABLE,
     "Enable border filler"
@@ -28,6 +28,30 @@
 #include <altivec.h>
 #endif
 
+#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
+#define AUDIO_MIX_CPU_X86
+#endif
+
+/* AVX is dispatched at runtime, so build it even when
+ * the rest of the frontend isn't compiled with -mavx. */
+#if defined(__AVX__)
+#define AUDIO_MIX_AVX
+#define AUDIO_MIX_AVX_TARGET
+#elif defined(AUDIO_MIX_CPU_X86) && defined(__GNUC__) && \
+   (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define AUDIO_MIX_AVX
+#define AUDIO_MIX_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+#ifdef AUDIO_MIX_AVX
+#include <immintrin.h>
+#endif
+
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define AUDIO_MIX_NEON
+#include <arm_neon.h>
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +59,7 @@
 #include <retro_miscellaneous.h>
 #include <audio/audio_mix.h>
 #include <streams/file_stream.h>
+#include <features/features_cpu.h>
 #include <audio/conversion/float_to_s16.h>
 #include <audio/conversion/s16_to_float.h>
 
@@ -75,6 +100,234 @@ void audio_mix_volume_SSE2(float *out, const float *in, float vol, size_t sample
 }
 #endif
 
+static void audio_mix_scale_C(float *out, const float *in,
+      float vol, size_t samples)
+{
+   size_t i;
+   for (i = 0; i < samples; i++)
+      out[i] = in[i] * vol;
+}
+
+static void audio_mix_clamp_C(float *buf, size_t samples)
+{
+   size_t i;
+   for (i = 0; i < samples; i++)
+   {
+      if (buf[i] < -1.0f)
+         buf[i] = -1.0f;
+      else if (buf[i] > 1.0f)
+         buf[i] = 1.0f;
+   }
+}
+
+#ifdef __SSE2__
+static void audio_mix_scale_SSE2(float *out, const float *in,
+      float vol, size_t samples)
+{
+   size_t i;
+   __m128 volume = _mm_set1_ps(vol);
+
+   for (i = 0; i + 8 <= samples; i += 8)
+   {
+      _mm_storeu_ps(out + i + 0,
+            _mm_mul_ps(volume, _mm_loadu_ps(in + i + 0)));
+      _mm_storeu_ps(out + i + 4,
+            _mm_mul_ps(volume, _mm_loadu_ps(in + i + 4)));
+   }
+
+   audio_mix_scale_C(out + i, in + i, vol, samples - i);
+}
+
+static void audio_mix_clamp_SSE2(float *buf, size_t samples)
+{
+   size_t i;
+   __m128 lo = _mm_set1_ps(-1.0f);
+   __m128 hi = _mm_set1_ps( 1.0f);
+
+   for (i = 0; i + 8 <= samples; i += 8)
+   {
+      _mm_storeu_ps(buf + i + 0,
+            _mm_min_ps(_mm_max_ps(_mm_loadu_ps(buf + i + 0), lo), hi));
+      _mm_storeu_ps(buf + i + 4,
+            _mm_min_ps(_mm_max_ps(_mm_loadu_ps(buf + i + 4), lo), hi));
+   }
+
+   audio_mix_clamp_C(buf + i, samples - i);
+}
+#endif
+
+#ifdef AUDIO_MIX_AVX
+static AUDIO_MIX_AVX_TARGET void audio_mix_volume_AVX(float *out,
+      const float *in, float vol, size_t samples)
+{
+   size_t i;
+   __m256 volume = _mm256_set1_ps(vol);
+
+   /* No FMA here; AVX without FMA3 exists (Sandy Bridge, Jaguar)
+    * and the C version rounds after the multiply as well. */
+   for (i = 0; i + 16 <= samples; i += 16)
+   {
+      __m256 a = _mm256_mul_ps(volume, _mm256_loadu_ps(in + i + 0));
+      __m256 b = _mm256_mul_ps(volume, _mm256_loadu_ps(in + i + 8));
+      _mm256_storeu_ps(out + i + 0,
+            _mm256_add_ps(_mm256_loadu_ps(out + i + 0), a));
+      _mm256_storeu_ps(out + i + 8,
+            _mm256_add_ps(_mm256_loadu_ps(out + i + 8), b));
+   }
+
+   audio_mix_volume_C(out + i, in + i, vol, samples - i);
+}
+
+static AUDIO_MIX_AVX_TARGET void audio_mix_scale_AVX(float *out,
+      const float *in, float vol, size_t samples)
+{
+   size_t i;
+   __m256 volume = _mm256_set1_ps(vol);
+
+   for (i = 0; i + 16 <= samples; i += 16)
+   {
+      _mm256_storeu_ps(out + i + 0,
+            _mm256_mul_ps(volume, _mm256_loadu_ps(in + i + 0)));
+      _mm256_storeu_ps(out + i + 8,
+            _mm256_mul_ps(volume, _mm256_loadu_ps(in + i + 8)));
+   }
+
+   audio_mix_scale_C(out + i, in + i, vol, samples - i);
+}
+
+static AUDIO_MIX_AVX_TARGET void audio_mix_clamp_AVX(float *buf,
+      size_t samples)
+{
+   size_t i;
+   __m256 lo = _mm256_set1_ps(-1.0f);
+   __m256 hi = _mm256_set1_ps( 1.0f);
+
+   for (i = 0; i + 16 <= samples; i += 16)
+   {
+      _mm256_storeu_ps(buf + i + 0, _mm256_min_ps(
+               _mm256_max_ps(_mm256_loadu_ps(buf + i + 0), lo), hi));
+      _mm256_storeu_ps(buf + i + 8, _mm256_min_ps(
+               _mm256_max_ps(_mm256_loadu_ps(buf + i + 8), lo), hi));
+   }
+
+   audio_mix_clamp_C(buf + i, samples - i);
+}
+#endif
+
+#ifdef AUDIO_MIX_NEON
+static void audio_mix_volume_NEON(float *out, const float *in,
+      float vol, size_t samples)
+{
+   size_t i;
+   float32x4_t volume = vdupq_n_f32(vol);
+
+   /* vmlaq_f32 is not fused, so this matches the C version. */
+   for (i = 0; i + 8 <= samples; i += 8)
+   {
+      vst1q_f32(out + i + 0, vmlaq_f32(vld1q_f32(out + i + 0),
+               vld1q_f32(in + i + 0), volume));
+      vst1q_f32(out + i + 4, vmlaq_f32(vld1q_f32(out + i + 4),
+               vld1q_f32(in + i + 4), volume));
+   }
+
+   audio_mix_volume_C(out + i, in + i, vol, samples - i);
+}
+
+static void audio_mix_scale_NEON(float *out, const float *in,
+      float vol, size_t samples)
+{
+   size_t i;
+   float32x4_t volume = vdupq_n_f32(vol);
+
+   for (i = 0; i + 8 <= samples; i += 8)
+   {
+      vst1q_f32(out + i + 0, vmulq_f32(vld1q_f32(in + i + 0), volume));
+      vst1q_f32(out + i + 4, vmulq_f32(vld1q_f32(in + i + 4), volume));
+   }
+
+   audio_mix_scale_C(out + i, in + i, vol, samples - i);
+}
+
+static void audio_mix_clamp_NEON(float *buf, size_t samples)
+{
+   size_t i;
+   float32x4_t lo = vdupq_n_f32(-1.0f);
+   float32x4_t hi = vdupq_n_f32( 1.0f);
+
+   for (i = 0; i + 8 <= samples; i += 8)
+   {
+      vst1q_f32(buf + i + 0,
+            vminq_f32(vmaxq_f32(vld1q_f32(buf + i + 0), lo), hi));
+      vst1q_f32(buf + i + 4,
+            vminq_f32(vmaxq_f32(vld1q_f32(buf + i + 4), lo), hi));
+   }
+
+   audio_mix_clamp_C(buf + i, samples - i);
+}
+#endif
+
+unsigned audio_mix_kernels_list(uint64_t cpu,
+      audio_mix_kernels_t *list, unsigned len)
+{
+   unsigned count = 0;
+
+#ifdef AUDIO_MIX_AVX
+   if (count < len && (cpu & RETRO_SIMD_AVX))
+   {
+      list[count].mix    = audio_mix_volume_AVX;
+      list[count].scale  = audio_mix_scale_AVX;
+      list[count].clamp  = audio_mix_clamp_AVX;
+      list[count].ident  = "avx";
+      count++;
+   }
+#endif
+
+#ifdef __SSE2__
+   if (count < len)
+   {
+      list[count].mix    = audio_mix_volume_SSE2;
+      list[count].scale  = audio_mix_scale_SSE2;
+      list[count].clamp  = audio_mix_clamp_SSE2;
+      list[count].ident  = "sse2";
+      count++;
+   }
+#endif
+
+#ifdef AUDIO_MIX_NEON
+   if (count < len && (cpu & RETRO_SIMD_NEON))
+   {
+      list[count].mix    = audio_mix_volume_NEON;
+      list[count].scale  = audio_mix_scale_NEON;
+      list[count].clamp  = audio_mix_clamp_NEON;
+      list[count].ident  = "neon";
+      count++;
+   }
+#endif
+
+   if (count < len)
+   {
+      list[count].mix    = audio_mix_volume_C;
+      list[count].scale  = audio_mix_scale_C;
+      list[count].clamp  = audio_mix_clamp_C;
+      list[count].ident  = "c";
+      count++;
+   }
+
+   (void)cpu;
+
+   return count;
+}
+
+const audio_mix_kernels_t *audio_mix_kernels_find(void)
+{
+   static audio_mix_kernels_t kernels;
+
+   if (!kernels.mix)
+      audio_mix_kernels_list(cpu_features_get(), &kernels, 1);
+
+   return &kernels;
+}
+
 void audio_mix_free_chunk(audio_chunk_t *chunk)
 {
    if (!chunk)
@@ -21,10 +21,12 @@
  */
 
 #include <audio/audio_mixer.h>
+#include <audio/audio_mix.h>
 #include <audio/audio_resampler.h>
 
 #include <formats/rwav.h>
 #include <memalign.h>
+#include <queues/fifo_spsc.h>
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
@@ -65,6 +67,12 @@
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
 
+/* Decoded chunks each voice keeps queued ahead of the mixer. */
+#define AUDIO_MIXER_RING_CHUNKS 3
+
+/* Samples the mixer pulls from a ring at once. */
+#define AUDIO_MIXER_MIX_CHUNK   1024
+
 struct audio_mixer_sound
 {
    enum audio_mixer_type type;
@@ -73,9 +81,8 @@ struct audio_mixer_sound
    {
       struct
       {
-         /* wav */
-         unsigned frames;
-         const float* pcm;
+         /* wav, kept as loaded and converted as it plays */
+         rwav_t wav;
       } wav;
 
 #ifdef HAVE_STB_VORBIS
@@ -116,6 +123,13 @@ struct audio_mixer_sound
    } types;
 };
 
+/* Every sound type is decoded ahead into the voice's ring, at the
+ * mixer rate, so mixing a voice is only a scaled add.
+ *
+ * 'decoding' and the decoder state below it are owned by whoever
+ * holds s_decoder_lock (the decoder thread, or play/stop).
+ * 'type', 'finished' and 'repeats' are changed with s_locker held,
+ * which the mixer only ever holds for bookkeeping. */
 struct audio_mixer_voice
 {
    bool     repeat;
@@ -124,62 +138,51 @@ struct audio_mixer_voice
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
 
+   fifo_spsc_t *ring;
+   bool     finished;
+   unsigned repeats;
+
+   bool     decoding;
+   unsigned buf_samples;
+   float*   buffer;
+   float    ratio;
+   void     *resampler_data;
+   const retro_resampler_t *resampler;
+
    union
    {
       struct
       {
-         unsigned position;
+         size_t position;
       } wav;
 
 #ifdef HAVE_STB_VORBIS
       struct
       {
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float*      buffer;
-         float       ratio;
          stb_vorbis *stream;
-         void       *resampler_data;
-         const retro_resampler_t *resampler;
       } ogg;
 #endif
 
 #ifdef HAVE_DR_FLAC
       struct
       {
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float*      buffer;
-         float       ratio;
          drflac      *stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
       } flac;
 #endif
 
 #ifdef HAVE_DR_MP3
       struct
       {
-         unsigned    position;
-         unsigned    samples;
-         unsigned    buf_samples;
-         float*      buffer;
-         float       ratio;
          drmp3       stream;
-         void        *resampler_data;
-         const retro_resampler_t *resampler;
       } mp3;
 #endif
 
 #ifdef HAVE_IBXM
       struct
       {
-         unsigned    		position;
-         unsigned    		samples;
          unsigned    		buf_samples;
          int*               buffer;
+         struct module*     module;
          struct replay*		stream;
       } mod;
 #endif
@@ -191,28 +194,36 @@ static unsigned s_rate = 0;
 
 #ifdef HAVE_THREADS
 static slock_t* s_locker = NULL;
+
+/* Decode-ahead worker. */
+static slock_t* s_decoder_lock    = NULL;
+static slock_t* s_decoder_wait    = NULL;
+static scond_t* s_decoder_cond    = NULL;
+static sthread_t* s_decoder_thread = NULL;
+static bool s_decoder_die         = false;
 #endif
 
-static bool wav2float(const rwav_t* wav, float** pcm, size_t samples_out)
+/* Converts up to 'frames' frames starting at 'frame' to
+ * interleaved stereo float. */
+static unsigned wav2float(const rwav_t* wav, float* f,
+      size_t frame, unsigned frames)
 {
-   size_t i;
-   /* Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes */
-   float *f           = (float*)memalign_alloc(16,
-         ((samples_out + 15) & ~15) * sizeof(float));
-
-   if (!f)
-      return false;
+   unsigned i;
 
-   *pcm = f;
+   if (frame >= wav->numsamples)
+      return 0;
+   if (frames > wav->numsamples - frame)
+      frames = (unsigned)(wav->numsamples - frame);
 
    if (wav->bitspersample == 8)
    {
       float sample      = 0.0f;
-      const uint8_t *u8 = (const uint8_t*)wav->samples;
+      const uint8_t *u8 = (const uint8_t*)wav->samples
+         + frame * wav->numchannels;
 
       if (wav->numchannels == 1)
       {
-         for (i = wav->numsamples; i != 0; i--)
+         for (i = frames; i != 0; i--)
          {
             sample = (float)*u8++ / 255.0f;
             sample = sample * 2.0f - 1.0f;
@@ -222,7 +233,7 @@ static bool wav2float(const rwav_t* wav, float** pcm, size_t samples_out)
       }
       else if (wav->numchannels == 2)
       {
-         for (i = wav->numsamples; i != 0; i--)
+         for (i = frames; i != 0; i--)
          {
             sample = (float)*u8++ / 255.0f;
             sample = sample * 2.0f - 1.0f;
@@ -239,11 +250,12 @@ static bool wav2float(const rwav_t* wav, float** pcm, size_t samples_out)
        * functions here? */
 
       float sample       = 0.0f;
-      const int16_t *s16 = (const int16_t*)wav->samples;
+      const int16_t *s16 = (const int16_t*)wav->samples
+         + frame * wav->numchannels;
 
       if (wav->numchannels == 1)
       {
-         for (i = wav->numsamples; i != 0; i--)
+         for (i = frames; i != 0; i--)
          {
             sample = (float)((int)*s16++ + 32768) / 65535.0f;
             sample = sample * 2.0f - 1.0f;
@@ -253,7 +265,7 @@ static bool wav2float(const rwav_t* wav, float** pcm, size_t samples_out)
       }
       else if (wav->numchannels == 2)
       {
-         for (i = wav->numsamples; i != 0; i--)
+         for (i = frames; i != 0; i--)
          {
             sample = (float)((int)*s16++ + 32768) / 65535.0f;
             sample = sample * 2.0f - 1.0f;
@@ -265,46 +277,12 @@ static bool wav2float(const rwav_t* wav, float** pcm, size_t samples_out)
       }
    }
 
-   return true;
+   return frames * 2;
 }
 
-static bool one_shot_resample(const float* in, size_t samples_in,
-      unsigned rate, float** out, size_t* samples_out)
-{
-   struct resampler_data info;
-   void* data                         = NULL;
-   const retro_resampler_t* resampler = NULL;
-   float ratio                        = (double)s_rate / (double)rate;
-
-   if (!retro_resampler_realloc(&data, &resampler, NULL, 
-            RESAMPLER_QUALITY_DONTCARE, ratio))
-      return false;
-
-   /*
-    * Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes. We
-    * add four more samples in the formula below just as safeguard, because
-    * resampler->process sometimes reports more output samples than the
-    * formula below calculates. Ideally, audio resamplers should have a
-    * function to return the number of samples they will output given a
-    * count of input samples.
-    */
-   *samples_out                       = samples_in * ratio + 4;
-   *out                               = (float*)memalign_alloc(16,
-         ((*samples_out + 15) & ~15) * sizeof(float));
-
-   if (*out == NULL)
-      return false;
-
-   info.data_in                       = in;
-   info.data_out                      = *out;
-   info.input_frames                  = samples_in / 2;
-   info.output_frames                 = 0;
-   info.ratio                         = ratio;
-
-   resampler->process(data, &info);
-   resampler->free(data);
-   return true;
-}
+#ifdef HAVE_THREADS
+static void audio_mixer_decoder_loop(void *data);
+#endif
 
 void audio_mixer_init(unsigned rate)
 {
@@ -316,31 +294,19 @@ void audio_mixer_init(unsigned rate)
       s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
 
 #ifdef HAVE_THREADS
-   s_locker = slock_new();
-#endif
-}
-
-void audio_mixer_done(void)
-{
-   unsigned i;
-
-#ifdef HAVE_THREADS
-   /* Dont call audio mixer functions after this point */
-   slock_free(s_locker);
-   s_locker = NULL;
+   s_locker         = slock_new();
+   s_decoder_lock   = slock_new();
+   s_decoder_wait   = slock_new();
+   s_decoder_cond   = scond_new();
+   s_decoder_die    = false;
+   s_decoder_thread = sthread_create(audio_mixer_decoder_loop, NULL);
 #endif
-
-   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
 {
    /* WAV data */
    rwav_t wav;
-   /* WAV samples converted to float */
-   float* pcm                 = NULL;
-   size_t samples             = 0;
    /* Result */
    audio_mixer_sound_t* sound = NULL;
    enum rwav_state rwav_ret   = rwav_load(&wav, buffer, size);
@@ -348,36 +314,26 @@ audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size)
    if (rwav_ret != RWAV_ITERATE_DONE)
       return NULL;
 
-   samples       = wav.numsamples * 2;
-
-   if (!wav2float(&wav, &pcm, samples))
-      return NULL;
-
-   if (wav.samplerate != s_rate)
+   if (     (wav.numchannels != 1 && wav.numchannels != 2)
+         || !wav.samplerate)
    {
-      float* resampled           = NULL;
-
-      if (!one_shot_resample(pcm, samples,
-               wav.samplerate, &resampled, &samples))
-         return NULL;
-
-      memalign_free((void*)pcm);
-      pcm = resampled;
+      rwav_free(&wav);
+      return NULL;
    }
 
    sound = (audio_mixer_sound_t*)calloc(1, sizeof(*sound));
 
    if (!sound)
    {
-      memalign_free((void*)pcm);
+      rwav_free(&wav);
       return NULL;
    }
 
-   sound->type             = AUDIO_MIXER_TYPE_WAV;
-   sound->types.wav.frames = (unsigned)(samples / 2);
-   sound->types.wav.pcm    = pcm;
+   sound->type          = AUDIO_MIXER_TYPE_WAV;
+   sound->types.wav.wav = wav;
 
-   rwav_free(&wav);
+   /* rwav_load() made its own copy of the samples. */
+   free(buffer);
 
    return sound;
 }
@@ -464,9 +420,7 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
    switch (sound->type)
    {
       case AUDIO_MIXER_TYPE_WAV:
-         handle = (void*)sound->types.wav.pcm;
-         if (handle)
-            memalign_free(handle);
+         rwav_free(&sound->types.wav.wav);
          break;
       case AUDIO_MIXER_TYPE_OGG:
 #ifdef HAVE_STB_VORBIS
@@ -503,12 +457,122 @@ void audio_mixer_destroy(audio_mixer_sound_t* sound)
    free(sound);
 }
 
+/* Sets up the resampler and the chunk buffer for a stream
+ * decoded at 'rate'. 'samples' is the largest chunk the decoder
+ * returns at that rate. */
+static bool audio_mixer_voice_init_stream(audio_mixer_voice_t* voice,
+      unsigned rate, unsigned samples)
+{
+   size_t ring_size;
+   float ratio                     = 1.0f;
+   void *resampler_data            = NULL;
+   const retro_resampler_t* resamp = NULL;
+
+   if (rate != s_rate)
+   {
+      ratio = (double)s_rate / (double)rate;
+
+      if (!retro_resampler_realloc(&resampler_data,
+               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
+               ratio))
+         return false;
+   }
+
+   /* Plus a few frames, resamplers can overshoot slightly. */
+   samples                 = (unsigned)(samples * ratio) + 16;
+   voice->buffer           = (float*)memalign_alloc(16,
+         ((samples + 15) & ~15) * sizeof(float));
+
+   if (!voice->buffer)
+   {
+      if (resamp)
+         resamp->free(resampler_data);
+      return false;
+   }
+
+   ring_size = AUDIO_MIXER_RING_CHUNKS * samples * sizeof(float);
+
+   if (!voice->ring || fifo_spsc_size(voice->ring) < ring_size)
+   {
+      fifo_spsc_free(voice->ring);
+      voice->ring = fifo_spsc_new(ring_size);
+   }
+   else
+      fifo_spsc_clear(voice->ring);
+
+   if (!voice->ring)
+   {
+      memalign_free(voice->buffer);
+      voice->buffer = NULL;
+      if (resamp)
+         resamp->free(resampler_data);
+      return false;
+   }
+
+   voice->resampler      = resamp;
+   voice->resampler_data = resampler_data;
+   voice->buf_samples    = samples;
+   voice->ratio          = ratio;
+   voice->finished       = false;
+   voice->repeats        = 0;
+
+   return true;
+}
+
+/* Closes the decoder; the ring stays allocated for the next
+ * sound played on this voice. */
+static void audio_mixer_voice_release(audio_mixer_voice_t* voice)
+{
+   if (!voice->decoding)
+      return;
+
+   switch (voice->sound->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         stb_vorbis_close(voice->types.ogg.stream);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         memalign_free(voice->types.mod.buffer);
+         dispose_replay(voice->types.mod.stream);
+         dispose_module(voice->types.mod.module);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         drflac_close(voice->types.flac.stream);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         drmp3_uninit(&voice->types.mp3.stream);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_WAV:
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+
+   if (voice->resampler)
+      voice->resampler->free(voice->resampler_data);
+   if (voice->buffer)
+      memalign_free(voice->buffer);
+
+   voice->resampler      = NULL;
+   voice->resampler_data = NULL;
+   voice->buffer         = NULL;
+   voice->decoding       = false;
+}
+
 static bool audio_mixer_play_wav(audio_mixer_sound_t* sound,
       audio_mixer_voice_t* voice, bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
    voice->types.wav.position = 0;
-   return true;
+   return audio_mixer_voice_init_stream(voice,
+         sound->types.wav.wav.samplerate, AUDIO_MIXER_TEMP_BUFFER);
 }
 
 #ifdef HAVE_STB_VORBIS
@@ -520,11 +584,6 @@ static bool audio_mixer_play_ogg(
 {
    stb_vorbis_info info;
    int res                         = 0;
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *ogg_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
    stb_vorbis *stb_vorbis          = stb_vorbis_open_memory(
          (const unsigned char*)sound->types.ogg.data,
          sound->types.ogg.size, &res, NULL);
@@ -534,40 +593,16 @@ static bool audio_mixer_play_ogg(
 
    info                    = stb_vorbis_get_info(stb_vorbis);
 
-   if (info.sample_rate != s_rate)
-   {
-      ratio = (double)s_rate / (double)info.sample_rate;
-
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
-   }
-
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   ogg_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
-
-   if (!ogg_buffer)
+   if (!audio_mixer_voice_init_stream(voice, info.sample_rate,
+            AUDIO_MIXER_TEMP_BUFFER))
    {
-      resamp->free(resampler_data);
-      goto error;
+      stb_vorbis_close(stb_vorbis);
+      return false;
    }
 
-   voice->types.ogg.resampler      = resamp;
-   voice->types.ogg.resampler_data = resampler_data;
-   voice->types.ogg.buffer         = (float*)ogg_buffer;
-   voice->types.ogg.buf_samples    = samples;
-   voice->types.ogg.ratio          = ratio;
    voice->types.ogg.stream         = stb_vorbis;
-   voice->types.ogg.position       = 0;
-   voice->types.ogg.samples        = 0;
 
    return true;
-
-error:
-   stb_vorbis_close(stb_vorbis);
-   return false;
 }
 #endif
 
@@ -581,7 +616,6 @@ static bool audio_mixer_play_mod(
    struct data data;
    char message[64];
    int buf_samples               = 0;
-   int samples                   = 0;
    void *mod_buffer              = NULL;
    struct module* module         = NULL;
    struct replay* replay         = NULL;
@@ -613,25 +647,22 @@ static bool audio_mixer_play_mod(
       goto error;
    }
 
-   samples = replay_calculate_duration(replay);
-
-   if (!samples)
-   {
-      printf("audio_mixer_play_mod cannot retrieve duration !\n");
+   /* Replays at the mixer rate, so this never resamples. */
+   if (!audio_mixer_voice_init_stream(voice, s_rate, buf_samples))
       goto error;
-   }
 
    voice->types.mod.buffer         = (int*)mod_buffer;
    voice->types.mod.buf_samples    = buf_samples;
+   voice->types.mod.module         = module;
    voice->types.mod.stream         = replay;
-   voice->types.mod.position       = 0;
-    voice->types.mod.samples       = 0; /* samples; */
 
    return true;
 
 error:
    if (mod_buffer)
       memalign_free(mod_buffer);
+   if (replay)
+      dispose_replay(replay);
    if (module)
       dispose_module(module);
    return false;
@@ -647,51 +678,21 @@ static bool audio_mixer_play_flac(
       bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *flac_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
    drflac *dr_flac          = drflac_open_memory((const unsigned char*)sound->types.flac.data,sound->types.flac.size);
-   
 
    if (!dr_flac)
       return false;
-   if (dr_flac->sampleRate != s_rate)
-   {
-      ratio = (double)s_rate / (double)(dr_flac->sampleRate);
-
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
-   }
 
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   flac_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
-
-   if (!flac_buffer)
+   if (!audio_mixer_voice_init_stream(voice, dr_flac->sampleRate,
+            AUDIO_MIXER_TEMP_BUFFER))
    {
-      if (resamp && resamp->free)
-         resamp->free(resampler_data);
-      goto error;
+      drflac_close(dr_flac);
+      return false;
    }
 
-   voice->types.flac.resampler      = resamp;
-   voice->types.flac.resampler_data = resampler_data;
-   voice->types.flac.buffer         = (float*)flac_buffer;
-   voice->types.flac.buf_samples    = samples;
-   voice->types.flac.ratio          = ratio;
    voice->types.flac.stream         = dr_flac;
-   voice->types.flac.position       = 0;
-   voice->types.flac.samples        = 0;
 
    return true;
-
-error:
-   drflac_close(dr_flac);
-   return false;
 }
 #endif
 
@@ -702,50 +703,248 @@ static bool audio_mixer_play_mp3(
       bool repeat, float volume,
       audio_mixer_stop_cb_t stop_cb)
 {
-   float ratio                     = 1.0f;
-   unsigned samples                = 0;
-   void *mp3_buffer                = NULL;
-   void *resampler_data            = NULL;
-   const retro_resampler_t* resamp = NULL;
    bool res =drmp3_init_memory(&voice->types.mp3.stream,(const unsigned char*)sound->types.mp3.data,sound->types.mp3.size,NULL);
    if (!res)
       return false;
-   if (voice->types.mp3.stream.sampleRate != s_rate)
+
+   if (!audio_mixer_voice_init_stream(voice,
+            voice->types.mp3.stream.sampleRate, AUDIO_MIXER_TEMP_BUFFER))
    {
-      ratio = (double)s_rate / (double)(voice->types.mp3.stream.sampleRate);
+      drmp3_uninit(&voice->types.mp3.stream);
+      return false;
+   }
 
-      if (!retro_resampler_realloc(&resampler_data,
-               &resamp, NULL, RESAMPLER_QUALITY_DONTCARE,
-               ratio))
-         goto error;
+   return true;
+}
+#endif
+
+/* Reads the next chunk at the source rate into 'temp'.
+ * Returns the number of samples, 0 at the end of the sound. */
+static unsigned audio_mixer_voice_read(audio_mixer_voice_t* voice,
+      float* temp)
+{
+   unsigned temp_samples = 0;
+
+   switch (voice->sound->type)
+   {
+      case AUDIO_MIXER_TYPE_WAV:
+         temp_samples = wav2float(&voice->sound->types.wav.wav, temp,
+               voice->types.wav.position, AUDIO_MIXER_TEMP_BUFFER / 2);
+         voice->types.wav.position += temp_samples / 2;
+         break;
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         temp_samples = stb_vorbis_get_samples_float_interleaved(
+               voice->types.ogg.stream, 2, temp,
+               AUDIO_MIXER_TEMP_BUFFER) * 2;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         {
+            unsigned i;
+            const int *pcm = voice->types.mod.buffer;
+
+            temp_samples   = replay_get_audio(
+                  voice->types.mod.stream, voice->types.mod.buffer) * 2;
+
+            for (i = 0; i < temp_samples; i++)
+            {
+               float samplef = (float)((int)pcm[i] + 32768) / 65535.0f;
+               temp[i]       = samplef * 2.0f - 1.0f;
+            }
+         }
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         temp_samples = (unsigned)drflac_read_f32(voice->types.flac.stream,
+               AUDIO_MIXER_TEMP_BUFFER, temp);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         temp_samples = (unsigned)drmp3_read_f32(&voice->types.mp3.stream,
+               AUDIO_MIXER_TEMP_BUFFER / 2, temp) * 2;
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
    }
 
-   samples                         = (unsigned)(AUDIO_MIXER_TEMP_BUFFER * ratio);
-   mp3_buffer                      = (float*)memalign_alloc(16,
-         ((samples + 15) & ~15) * sizeof(float));
+   return temp_samples;
+}
 
-   if (!mp3_buffer)
+static void audio_mixer_voice_rewind(audio_mixer_voice_t* voice)
+{
+   switch (voice->sound->type)
    {
-      resamp->free(resampler_data);
-      goto error;
+      case AUDIO_MIXER_TYPE_WAV:
+         voice->types.wav.position = 0;
+         break;
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         stb_vorbis_seek_start(voice->types.ogg.stream);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         replay_seek(voice->types.mod.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         drflac_seek_to_sample(voice->types.flac.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         drmp3_seek_to_frame(&voice->types.mp3.stream, 0);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_NONE:
+         break;
+   }
+}
+
+/* Decodes and resamples one chunk into the voice's ring, if it has
+ * room for it. Call with s_decoder_lock held.
+ *
+ * Returns: true if a chunk was queued. */
+static bool audio_mixer_voice_decode(audio_mixer_voice_t* voice)
+{
+   struct resampler_data info;
+   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER];
+   unsigned temp_samples = 0;
+   unsigned out_samples  = 0;
+
+   if (!voice->decoding || fifo_spsc_write_avail(voice->ring)
+         < voice->buf_samples * sizeof(float))
+      return false;
+
+   temp_samples = audio_mixer_voice_read(voice, temp_buffer);
+
+   if (temp_samples == 0 && voice->repeat)
+   {
+      audio_mixer_voice_rewind(voice);
+      temp_samples = audio_mixer_voice_read(voice, temp_buffer);
+
+#ifdef HAVE_THREADS
+      slock_lock(s_locker);
+#endif
+      voice->repeats++;
+#ifdef HAVE_THREADS
+      slock_unlock(s_locker);
+#endif
+   }
+
+   if (temp_samples == 0)
+   {
+      /* Nothing reads the decoder past this point, the mixer only
+       * drains what is left in the ring. */
+      audio_mixer_voice_release(voice);
+
+#ifdef HAVE_THREADS
+      slock_lock(s_locker);
+#endif
+      voice->finished = true;
+#ifdef HAVE_THREADS
+      slock_unlock(s_locker);
+#endif
+      return false;
    }
 
-   voice->types.mp3.resampler      = resamp;
-   voice->types.mp3.resampler_data = resampler_data;
-   voice->types.mp3.buffer         = (float*)mp3_buffer;
-   voice->types.mp3.buf_samples    = samples;
-   voice->types.mp3.ratio          = ratio;
-   voice->types.mp3.position       = 0;
-   voice->types.mp3.samples        = 0;
+   if (voice->resampler)
+   {
+      info.data_in       = temp_buffer;
+      info.data_out      = voice->buffer;
+      info.input_frames  = temp_samples / 2;
+      info.output_frames = 0;
+      info.ratio         = voice->ratio;
+
+      voice->resampler->process(voice->resampler_data, &info);
+      out_samples        = (unsigned)info.output_frames * 2;
+   }
+   else
+   {
+      memcpy(voice->buffer, temp_buffer, temp_samples * sizeof(float));
+      out_samples        = temp_samples;
+   }
 
+   fifo_spsc_write(voice->ring, voice->buffer, out_samples * sizeof(float));
    return true;
+}
 
-error:
-   drmp3_uninit(&voice->types.mp3.stream);
-   return false;
+#ifdef HAVE_THREADS
+static void audio_mixer_decoder_loop(void *data)
+{
+   (void)data;
+
+   for (;;)
+   {
+      unsigned i;
+      bool busy = false;
+
+      slock_lock(s_decoder_lock);
+      if (s_decoder_die)
+      {
+         slock_unlock(s_decoder_lock);
+         break;
+      }
+
+      for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+         if (audio_mixer_voice_decode(&s_voices[i]))
+            busy = true;
+      slock_unlock(s_decoder_lock);
+
+      if (busy)
+         continue;
+
+      /* The mixer signals after draining, the timeout
+       * covers the wakeups it can miss that way. */
+      slock_lock(s_decoder_wait);
+      scond_wait_timeout(s_decoder_cond, s_decoder_wait, 20000);
+      slock_unlock(s_decoder_wait);
+   }
 }
 #endif
 
+void audio_mixer_done(void)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (s_decoder_thread)
+   {
+      slock_lock(s_decoder_lock);
+      s_decoder_die = true;
+      slock_unlock(s_decoder_lock);
+      scond_signal(s_decoder_cond);
+      sthread_join(s_decoder_thread);
+   }
+   s_decoder_thread = NULL;
+#endif
+
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+   {
+      audio_mixer_voice_release(&s_voices[i]);
+      fifo_spsc_free(s_voices[i].ring);
+      s_voices[i].ring = NULL;
+      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   }
+
+#ifdef HAVE_THREADS
+   /* Dont call audio mixer functions after this point */
+   slock_free(s_locker);
+   slock_free(s_decoder_lock);
+   slock_free(s_decoder_wait);
+   scond_free(s_decoder_cond);
+   s_locker       = NULL;
+   s_decoder_lock = NULL;
+   s_decoder_wait = NULL;
+   s_decoder_cond = NULL;
+#endif
+}
 
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       float volume, audio_mixer_stop_cb_t stop_cb)
@@ -758,7 +957,7 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       return NULL;
 
 #ifdef HAVE_THREADS
-   slock_lock(s_locker);
+   slock_lock(s_decoder_lock);
 #endif
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
@@ -766,6 +965,9 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
       if (voice->type != AUDIO_MIXER_TYPE_NONE)
          continue;
 
+      /* Normally a no-op: stop and end of stream release already. */
+      audio_mixer_voice_release(voice);
+
       switch (sound->type)
       {
          case AUDIO_MIXER_TYPE_WAV:
@@ -800,17 +1002,31 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound, bool repeat,
 
    if (res)
    {
-      voice->type     = sound->type;
+      voice->sound    = sound;
       voice->repeat   = repeat;
+      voice->decoding = true;
+
+      /* Queue the first chunk right away so the sound
+       * starts with the next mix. */
+      audio_mixer_voice_decode(voice);
+
+#ifdef HAVE_THREADS
+      slock_lock(s_locker);
+#endif
+      voice->type     = sound->type;
       voice->volume   = volume;
-      voice->sound    = sound;
       voice->stop_cb  = stop_cb;
+#ifdef HAVE_THREADS
+      slock_unlock(s_locker);
+#endif
    }
    else
       voice = NULL;
 
 #ifdef HAVE_THREADS
-   slock_unlock(s_locker);
+   slock_unlock(s_decoder_lock);
+   if (voice)
+      scond_signal(s_decoder_cond);
 #endif
 
    return voice;
@@ -827,6 +1043,7 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       sound   = voice->sound;
 
 #ifdef HAVE_THREADS
+      slock_lock(s_decoder_lock);
       slock_lock(s_locker);
 #endif
 
@@ -836,406 +1053,114 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       slock_unlock(s_locker);
 #endif
 
+      audio_mixer_voice_release(voice);
+
+#ifdef HAVE_THREADS
+      slock_unlock(s_decoder_lock);
+#endif
+
       if (stop_cb)
          stop_cb(sound, AUDIO_MIXER_SOUND_STOPPED);
    }
 }
 
-static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+static void audio_mixer_mix_voice(const audio_mix_kernels_t *kernels,
+      float* buffer, size_t num_frames,
+      audio_mixer_voice_t* voice, float volume)
 {
-   int i;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   const audio_mixer_sound_t* sound = voice->sound;
-   unsigned pcm_available           = sound->types.wav.frames
-      * 2 - voice->types.wav.position;
-   const float* pcm                 = sound->types.wav.pcm +
-      voice->types.wav.position;
-
-again:
-   if (pcm_available < buf_free)
-   {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+   float pcm[AUDIO_MIXER_MIX_CHUNK];
+   size_t samples = num_frames * 2;
 
-      if (voice->repeat)
-      {
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-         buf_free                  -= pcm_available;
-         pcm_available              = sound->types.wav.frames * 2;
-         pcm                        = sound->types.wav.pcm;
-         voice->types.wav.position  = 0;
-         goto again;
-      }
+   while (samples)
+   {
+      size_t count = (samples < AUDIO_MIXER_MIX_CHUNK)
+         ? samples : AUDIO_MIXER_MIX_CHUNK;
+      size_t read  = fifo_spsc_read(voice->ring, pcm,
+            count * sizeof(float)) / sizeof(float);
 
-      if (voice->stop_cb)
-         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
+      /* Muted voices still drain their ring. */
+      if (volume != 0.0f)
+         kernels->mix(buffer, pcm, volume, read);
 
-      voice->type = AUDIO_MIXER_TYPE_NONE;
-   }
-   else
-   {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      /* Underrun, or the end of the sound. */
+      if (read < count)
+         break;
 
-      voice->types.wav.position += buf_free;
+      buffer  += read;
+      samples -= read;
    }
 }
 
-#ifdef HAVE_STB_VORBIS
-static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bool override)
 {
-   int i;
-   struct resampler_data info = { 0 };
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.ogg.position == voice->types.ogg.samples)
-   {
-again:
-      temp_samples = stb_vorbis_get_samples_float_interleaved(
-            voice->types.ogg.stream, 2, temp_buffer,
-            AUDIO_MIXER_TEMP_BUFFER) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            stb_vorbis_seek_start(voice->types.ogg.stream);
-            goto again;
-         }
-         else
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
-            return;
-         }
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.ogg.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.ogg.ratio;
-
-      if (voice->types.ogg.resampler)
-        voice->types.ogg.resampler->process(voice->types.ogg.resampler_data, &info);
-      else
-        memcpy(voice->types.ogg.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.ogg.position = 0;
-      voice->types.ogg.samples  = voice->types.ogg.buf_samples;
-   }
-
-   pcm = voice->types.ogg.buffer + voice->types.ogg.position;
-
-   if (voice->types.ogg.samples < buf_free)
-   {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+   unsigned i;
+   audio_mixer_voice_t* voice = s_voices;
+   const audio_mix_kernels_t *kernels = audio_mix_kernels_find();
+   /* Callbacks may play or stop voices, so they run unlocked. */
+   audio_mixer_sound_t* sounds[AUDIO_MIXER_MAX_VOICES];
+   audio_mixer_stop_cb_t callbacks[AUDIO_MIXER_MAX_VOICES];
+   unsigned reasons[AUDIO_MIXER_MAX_VOICES];
+   unsigned num_callbacks     = 0;
 
-      buf_free -= voice->types.ogg.samples;
-      goto again;
-   }
-   else
+#ifdef HAVE_THREADS
+   /* No decoder thread, decode inline like a threadless build. */
+   if (!s_decoder_thread)
    {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
-
-      voice->types.ogg.position += buf_free;
-      voice->types.ogg.samples  -= buf_free;
+      slock_lock(s_decoder_lock);
+#endif
+      for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
+         while (audio_mixer_voice_decode(&s_voices[i]) &&
+               fifo_spsc_read_avail(s_voices[i].ring)
+               < num_frames * 2 * sizeof(float));
+#ifdef HAVE_THREADS
+      slock_unlock(s_decoder_lock);
    }
-}
 #endif
 
-#ifdef HAVE_IBXM
-static void audio_mixer_mix_mod(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   float samplef                    = 0.0f;
-   int samplei                      = 0;
-   unsigned temp_samples            = 0;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   int* pcm                         = NULL;
-
-   if (voice->types.mod.position == voice->types.mod.samples)
-   {
-again:
-      temp_samples = replay_get_audio(
-            voice->types.mod.stream, voice->types.mod.buffer );
-
-      temp_samples *= 2; /* stereo */
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            replay_seek( voice->types.mod.stream, 0);
-            goto again;
-         }
-         else
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
-            return;
-         }
-      }
-
-      voice->types.mod.position = 0;
-      voice->types.mod.samples  = temp_samples;
-   }
-   pcm = voice->types.mod.buffer + voice->types.mod.position;
+#ifdef HAVE_THREADS
+   slock_lock(s_locker);
+#endif
 
-   if (voice->types.mod.samples < buf_free)
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
    {
-      for (i = voice->types.mod.samples; i != 0; i--)
-      {
-         samplei     = *pcm++ * volume;
-         samplef     = (float)((int)samplei + 32768) / 65535.0f;
-         samplef     = samplef * 2.0f - 1.0f;
-         *buffer++  += samplef;
-      }
+      float volume = (override) ? volume_override : voice->volume;
 
-      buf_free -= voice->types.mod.samples;
-      goto again;
-   }
-   else
-   {
-      int i;
-      for (i = buf_free; i != 0; --i )
-      {
-         samplei     = *pcm++ * volume;
-         samplef     = (float)((int)samplei + 32768) / 65535.0f;
-         samplef     = samplef * 2.0f - 1.0f;
-         *buffer++  += samplef;
-      }
+      if (voice->type == AUDIO_MIXER_TYPE_NONE)
+         continue;
 
-      voice->types.mod.position += buf_free;
-      voice->types.mod.samples  -= buf_free;
-   }
-}
-#endif
+      audio_mixer_mix_voice(kernels, buffer, num_frames, voice, volume);
 
-#ifdef HAVE_DR_FLAC
-static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info = { 0 };
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.flac.position == voice->types.flac.samples)
-   {
-again:
-      temp_samples = (unsigned)drflac_read_f32( voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER, temp_buffer);
-      if (temp_samples == 0)
+      if (voice->repeats)
       {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drflac_seek_to_sample(voice->types.flac.stream,0);
-            goto again;
-         }
-         else
+         voice->repeats = 0;
+         if (voice->stop_cb)
          {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
-            return;
+            sounds[num_callbacks]    = voice->sound;
+            callbacks[num_callbacks] = voice->stop_cb;
+            reasons[num_callbacks++] = AUDIO_MIXER_SOUND_REPEATED;
          }
       }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.flac.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.flac.ratio;
-
-      if (voice->types.flac.resampler)
-        voice->types.flac.resampler->process(voice->types.flac.resampler_data, &info);
-      else
-        memcpy(voice->types.flac.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.flac.position = 0;
-      voice->types.flac.samples  = voice->types.flac.buf_samples;
-   }
-
-   pcm = voice->types.flac.buffer + voice->types.flac.position;
-
-   if (voice->types.flac.samples < buf_free)
-   {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.flac.samples;
-      goto again;
-   }
-   else
-   {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
-
-      voice->types.flac.position += buf_free;
-      voice->types.flac.samples  -= buf_free;
-   }
-}
-#endif
-
-#ifdef HAVE_DR_MP3
-static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   struct resampler_data info = { 0 };
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.mp3.position == voice->types.mp3.samples)
-   {
-again:
-      temp_samples = (unsigned)drmp3_read_f32(&voice->types.mp3.stream, AUDIO_MIXER_TEMP_BUFFER/2, temp_buffer) * 2;
-      
-      if (temp_samples == 0)
+      else if (voice->finished && !fifo_spsc_read_avail(voice->ring))
       {
-         if (voice->repeat)
+         voice->type = AUDIO_MIXER_TYPE_NONE;
+         if (voice->stop_cb)
          {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drmp3_seek_to_frame(&voice->types.mp3.stream,0);
-            goto again;
+            sounds[num_callbacks]    = voice->sound;
+            callbacks[num_callbacks] = voice->stop_cb;
+            reasons[num_callbacks++] = AUDIO_MIXER_SOUND_FINISHED;
          }
-         else
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-            voice->type = AUDIO_MIXER_TYPE_NONE;
-            return;
-         }
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.mp3.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.mp3.ratio;
-
-      if (voice->types.mp3.resampler)
-        voice->types.mp3.resampler->process(voice->types.mp3.resampler_data, &info);
-      else
-        memcpy(voice->types.mp3.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.mp3.position = 0;
-      voice->types.mp3.samples  = voice->types.mp3.buf_samples;
-   }
-
-   pcm = voice->types.mp3.buffer + voice->types.mp3.position;
-
-   if (voice->types.mp3.samples < buf_free)
-   {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.mp3.samples;
-      goto again;
-   }
-   else
-   {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
-
-      voice->types.mp3.position += buf_free;
-      voice->types.mp3.samples  -= buf_free;
-   }
-}
-#endif
-
-void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bool override)
-{
-   unsigned i;
-   size_t j                   = 0;
-   float* sample              = NULL;
-   audio_mixer_voice_t* voice = s_voices;
-
-#ifdef HAVE_THREADS
-   slock_lock(s_locker);
-#endif
-
-   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
-   {
-      float volume = (override) ? volume_override : voice->volume;
-
-      switch (voice->type)
-      {
-         case AUDIO_MIXER_TYPE_WAV:
-            audio_mixer_mix_wav(buffer, num_frames, voice, volume);
-            break;
-         case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            audio_mixer_mix_mod(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
-#endif
-            break;
-            case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
-#endif
-            break;
-         case AUDIO_MIXER_TYPE_NONE:
-            break;
       }
    }
 
 #ifdef HAVE_THREADS
    slock_unlock(s_locker);
+   scond_signal(s_decoder_cond);
 #endif
 
-   for (j = 0, sample = buffer; j < num_frames; j++, sample++)
-   {
-      if (*sample < -1.0f)
-         *sample = -1.0f;
-      else if (*sample > 1.0f)
-         *sample = 1.0f;
-   }
+   for (i = 0; i < num_callbacks; i++)
+      callbacks[i](sounds[i], reasons[i]);
+
+   kernels->clamp(buffer, num_frames * 2);
 }
 
 float audio_mixer_voice_get_volume(audio_mixer_voice_t *voice)
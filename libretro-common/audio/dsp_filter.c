@@ -23,6 +23,7 @@
 #include <stdlib.h>
 
 #include <retro_miscellaneous.h>
+#include <memalign.h>
 
 #include <compat/posix_string.h>
 #include <dynamic/dylib.h>
@@ -36,6 +37,13 @@
 
 #include <audio/dsp_filter.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define DSP_FILTER_NEON
+#include <arm_neon.h>
+#endif
+
 struct retro_dsp_plug
 {
 #ifdef HAVE_DYLIB
@@ -47,6 +55,7 @@ struct retro_dsp_plug
 struct retro_dsp_instance
 {
    const struct dspfilter_implementation *impl;
+   dspfilter_process_planar_t planar;
    void *impl_data;
 };
 
@@ -59,6 +68,9 @@ struct retro_dsp_filter
 
    struct retro_dsp_instance *instances;
    unsigned num_instances;
+
+   /* One DSPFILTER_PLANAR_BLOCK per channel. */
+   float *planar[2];
 };
 
 static const struct dspfilter_implementation *find_implementation(
@@ -119,6 +131,13 @@ static bool create_filter_graph(retro_dsp_filter_t *dsp, float sample_rate)
       if (!dsp->instances[i].impl)
          return false;
 
+      /* Version 1 plugins end before process_planar. */
+      if (dsp->instances[i].impl->api_version >= 2)
+         dsp->instances[i].planar = dsp->instances[i].impl->process_planar;
+
+      if (!dsp->instances[i].planar && !dsp->instances[i].impl->process)
+         return false;
+
       userdata.conf = dsp->conf;
       /* Index-specific configs take priority over ident-specific. */
       userdata.prefix[0] = key;
@@ -206,7 +225,8 @@ static bool append_plugs(retro_dsp_filter_t *dsp, struct string_list *list)
          continue;
       }
 
-      if (impl->api_version != DSPFILTER_API_VERSION)
+      if (     impl->api_version < 1
+            || impl->api_version > DSPFILTER_API_VERSION)
       {
          dylib_close(lib);
          continue;
@@ -265,6 +285,12 @@ retro_dsp_filter_t *retro_dsp_filter_new(
    if (!create_filter_graph(dsp, sample_rate))
       goto error;
 
+   dsp->planar[0] = (float*)memalign_alloc(16,
+         2 * DSPFILTER_PLANAR_BLOCK * sizeof(float));
+   if (!dsp->planar[0])
+      goto error;
+   dsp->planar[1] = dsp->planar[0] + DSPFILTER_PLANAR_BLOCK;
+
    return dsp;
 
 error:
@@ -299,25 +325,124 @@ void retro_dsp_filter_free(retro_dsp_filter_t *dsp)
    if (dsp->conf)
       config_file_free(dsp->conf);
 
+   memalign_free(dsp->planar[0]);
    free(dsp);
 }
 
+static void dsp_deinterleave(float *left, float *right,
+      const float *in, unsigned frames)
+{
+   unsigned i = 0;
+
+#if defined(__SSE__)
+   for (; i + 4 <= frames; i += 4, in += 8)
+   {
+      __m128 a = _mm_loadu_ps(in + 0);
+      __m128 b = _mm_loadu_ps(in + 4);
+      _mm_store_ps(left  + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_store_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+   }
+#elif defined(DSP_FILTER_NEON)
+   for (; i + 4 <= frames; i += 4, in += 8)
+   {
+      float32x4x2_t v = vld2q_f32(in);
+      vst1q_f32(left  + i, v.val[0]);
+      vst1q_f32(right + i, v.val[1]);
+   }
+#endif
+
+   for (; i < frames; i++, in += 2)
+   {
+      left[i]  = in[0];
+      right[i] = in[1];
+   }
+}
+
+static void dsp_interleave(float *out, const float *left,
+      const float *right, unsigned frames)
+{
+   unsigned i = 0;
+
+#if defined(__SSE__)
+   for (; i + 4 <= frames; i += 4, out += 8)
+   {
+      __m128 l = _mm_load_ps(left  + i);
+      __m128 r = _mm_load_ps(right + i);
+      _mm_storeu_ps(out + 0, _mm_unpacklo_ps(l, r));
+      _mm_storeu_ps(out + 4, _mm_unpackhi_ps(l, r));
+   }
+#elif defined(DSP_FILTER_NEON)
+   for (; i + 4 <= frames; i += 4, out += 8)
+   {
+      float32x4x2_t v;
+      v.val[0] = vld1q_f32(left  + i);
+      v.val[1] = vld1q_f32(right + i);
+      vst2q_f32(out, v);
+   }
+#endif
+
+   for (; i < frames; i++, out += 2)
+   {
+      out[0] = left[i];
+      out[1] = right[i];
+   }
+}
+
+/* Runs instances [first, last), which are all planar, in place
+ * over the interleaved buffer. Every block goes through the whole
+ * run before the next one is touched. */
+static void dsp_process_planar(retro_dsp_filter_t *dsp,
+      unsigned first, unsigned last, float *samples, unsigned frames)
+{
+   while (frames)
+   {
+      unsigned i;
+      unsigned block = MIN(frames, DSPFILTER_PLANAR_BLOCK);
+
+      dsp_deinterleave(dsp->planar[0], dsp->planar[1], samples, block);
+
+      for (i = first; i < last; i++)
+         dsp->instances[i].planar(dsp->instances[i].impl_data,
+               dsp->planar, block);
+
+      dsp_interleave(samples, dsp->planar[0], dsp->planar[1], block);
+
+      samples += block * 2;
+      frames  -= block;
+   }
+}
+
 void retro_dsp_filter_process(retro_dsp_filter_t *dsp,
       struct retro_dsp_data *data)
 {
-   unsigned i;
+   unsigned i                     = 0;
    struct dspfilter_output output = {0};
    struct dspfilter_input input   = {0};
 
    output.samples = data->input;
    output.frames  = data->input_frames;
 
-   for (i = 0; i < dsp->num_instances; i++)
+   while (i < dsp->num_instances)
    {
+      unsigned last = i;
+
+      while (last < dsp->num_instances && dsp->instances[last].planar)
+         last++;
+
+      if (last > i)
+      {
+         /* As with process(), the previous output may be
+          * overwritten, it's the input of this run. */
+         dsp_process_planar(dsp, i, last, output.samples, output.frames);
+         i = last;
+         continue;
+      }
+
       input.samples = output.samples;
       input.frames  = output.frames;
       dsp->instances[i].impl->process(
             dsp->instances[i].impl_data, &output, &input);
+      i++;
    }
 
    data->output        = output.samples;
@@ -27,6 +27,7 @@
 
 struct echo_channel
 {
+   /* Left delay line, followed by the right one. */
    float *buffer;
    unsigned ptr;
    unsigned frames;
@@ -51,49 +52,69 @@ static void echo_free(void *data)
    free(echo);
 }
 
-static void echo_process(void *data, struct dspfilter_output *output,
-      const struct dspfilter_input *input)
+static void echo_process_planar(void *data, float **samples, unsigned frames)
 {
-   unsigned i, c;
-   float *out             = NULL;
+   unsigned i, c, ch;
+   float echo_buf[DSPFILTER_PLANAR_BLOCK];
    struct echo_data *echo = (struct echo_data*)data;
+   float *out[2];
 
-   output->samples        = input->samples;
-   output->frames         = input->frames;
+   out[0] = samples[0];
+   out[1] = samples[1];
 
-   out                    = output->samples;
-
-   for (i = 0; i < input->frames; i++, out += 2)
+   while (frames)
    {
-      float left, right;
-      float echo_left  = 0.0f;
-      float echo_right = 0.0f;
+      /* Within a run where no delay line wraps, every slot is read
+       * once and then written once, so there is no dependency
+       * between iterations and the inner loops vectorize. */
+      unsigned run = frames;
 
       for (c = 0; c < echo->num_channels; c++)
+         run = MIN(run, echo->channels[c].frames - echo->channels[c].ptr);
+
+      for (ch = 0; ch < 2; ch++)
       {
-         echo_left  += echo->channels[c].buffer[(echo->channels[c].ptr << 1) + 0];
-         echo_right += echo->channels[c].buffer[(echo->channels[c].ptr << 1) + 1];
-      }
+         float *x = out[ch];
 
-      echo_left  *= echo->amp;
-      echo_right *= echo->amp;
+         for (i = 0; i < run; i++)
+            echo_buf[i] = 0.0f;
 
-      left        = out[0] + echo_left;
-      right       = out[1] + echo_right;
+         for (c = 0; c < echo->num_channels; c++)
+         {
+            const float *line = echo->channels[c].buffer
+               + ch * echo->channels[c].frames + echo->channels[c].ptr;
 
-      for (c = 0; c < echo->num_channels; c++)
-      {
-         float feedback_left  = out[0] + echo->channels[c].feedback * echo_left;
-         float feedback_right = out[1] + echo->channels[c].feedback * echo_right;
+            for (i = 0; i < run; i++)
+               echo_buf[i] += line[i];
+         }
+
+         for (i = 0; i < run; i++)
+            echo_buf[i] *= echo->amp;
 
-         echo->channels[c].buffer[(echo->channels[c].ptr << 1) + 0] = feedback_left;
-         echo->channels[c].buffer[(echo->channels[c].ptr << 1) + 1] = feedback_right;
+         for (c = 0; c < echo->num_channels; c++)
+         {
+            float *line    = echo->channels[c].buffer
+               + ch * echo->channels[c].frames + echo->channels[c].ptr;
+            float feedback = echo->channels[c].feedback;
 
-         echo->channels[c].ptr = (echo->channels[c].ptr + 1) % echo->channels[c].frames;
+            for (i = 0; i < run; i++)
+               line[i] = x[i] + feedback * echo_buf[i];
+         }
+
+         for (i = 0; i < run; i++)
+            x[i] += echo_buf[i];
+
+         out[ch] += run;
+      }
+
+      for (c = 0; c < echo->num_channels; c++)
+      {
+         echo->channels[c].ptr += run;
+         if (echo->channels[c].ptr == echo->channels[c].frames)
+            echo->channels[c].ptr = 0;
       }
 
-      out[0] = left;
-      out[1] = right;
+      frames -= run;
    }
 }
 
@@ -160,12 +181,13 @@ error:
 
 static const struct dspfilter_implementation echo_plug = {
    echo_init,
-   echo_process,
+   NULL,
    echo_free,
 
    DSPFILTER_API_VERSION,
    "Multi-Echo",
    "echo",
+   echo_process_planar,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
@@ -95,15 +95,18 @@ static void eq_process(void *data, struct dspfilter_output *output,
       // Convolve a new block.
       if (eq->block_ptr == eq->block_size)
       {
-         unsigned i, c;
-
-         for (c = 0; c < 2; c++)
-         {
-            fft_process_forward(eq->fft, eq->fftblock, eq->block + c, 2);
-            for (i = 0; i < 2 * eq->block_size; i++)
-               eq->fftblock[i] = fft_complex_mul(eq->fftblock[i], eq->filter[i]);
-            fft_process_inverse(eq->fft, out + c, eq->fftblock, 2);
-         }
+         unsigned i;
+
+         /* The filter is real in the time domain, so both channels
+          * go through one complex FFT, left as the real part and
+          * right as the imaginary part. An interleaved stereo block
+          * already has that layout. */
+         fft_process_forward_complex(eq->fft, eq->fftblock,
+               (const fft_complex_t*)eq->block, 1);
+         for (i = 0; i < 2 * eq->block_size; i++)
+            eq->fftblock[i] = fft_complex_mul(eq->fftblock[i], eq->filter[i]);
+         fft_process_inverse_complex(eq->fft, (fft_complex_t*)out,
+               eq->fftblock, 1);
 
          // Overlap add method, so add in saved block now.
          for (i = 0; i < 2 * eq->block_size; i++)
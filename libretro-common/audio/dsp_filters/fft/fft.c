@@ -154,52 +154,107 @@ static void butterflies(fft_complex_t *butterfly_buf,
    }
 }
 
+/* Two consecutive radix-2 passes (step_size and 2 * step_size)
+ * fused into one radix-4 pass. That's one trip through memory
+ * instead of two, and the fourth twiddle is the third one turned
+ * by a quarter, so it needs no multiply. */
+static void butterflies_radix4(fft_complex_t *butterfly_buf,
+      const fft_complex_t *phase_lut,
+      int phase_dir, unsigned step_size, unsigned samples)
+{
+   unsigned i, j;
+   int phase_step  = (int)samples * phase_dir / (int)step_size;
+   int phase_step2 = phase_step / 2;
+
+   for (i = 0; i < samples; i += step_size << 2)
+   {
+      fft_complex_t *a = butterfly_buf + i;
+      fft_complex_t *b = a + step_size;
+      fft_complex_t *c = b + step_size;
+      fft_complex_t *d = c + step_size;
+
+      for (j = 0; j < step_size; j++)
+      {
+         fft_complex_t a1, b1, c1, d1, t;
+         fft_complex_t w1 = phase_lut[phase_step  * (int)j];
+         fft_complex_t w2 = phase_lut[phase_step2 * (int)j];
+
+         t         = fft_complex_mul(w1, b[j]);
+         a1        = fft_complex_add(a[j], t);
+         b1        = fft_complex_sub(a[j], t);
+         t         = fft_complex_mul(w1, d[j]);
+         c1        = fft_complex_add(c[j], t);
+         d1        = fft_complex_sub(c[j], t);
+
+         t         = fft_complex_mul(w2, c1);
+         a[j]      = fft_complex_add(a1, t);
+         c[j]      = fft_complex_sub(a1, t);
+
+         /* Multiply by phase_dir * i. */
+         t         = fft_complex_mul(w2, d1);
+         d1.real   = -phase_dir * t.imag;
+         d1.imag   =  phase_dir * t.real;
+         b[j]      = fft_complex_add(b1, d1);
+         d[j]      = fft_complex_sub(b1, d1);
+      }
+   }
+}
+
+static void fft_passes(fft_complex_t *buf, const fft_complex_t *phase_lut,
+      int phase_dir, unsigned samples)
+{
+   unsigned step_size;
+
+   for (step_size = 1; (step_size << 2) <= samples; step_size <<= 2)
+      butterflies_radix4(buf, phase_lut, phase_dir, step_size, samples);
+
+   /* Odd log2 size, one radix-2 pass left. */
+   if (step_size < samples)
+      butterflies(buf, phase_lut, phase_dir, step_size, samples);
+}
+
 void fft_process_forward_complex(fft_t *fft,
       fft_complex_t *out, const fft_complex_t *in, unsigned step)
 {
-   unsigned step_size;
    unsigned samples = fft->size;
    interleave_complex(fft->bitinverse_buffer, out, in, samples, step);
-
-   for (step_size = 1; step_size < samples; step_size <<= 1)
-   {
-      butterflies(out,
-            fft->phase_lut + samples,
-            -1, step_size, samples);
-   }
+   fft_passes(out, fft->phase_lut + samples, -1, samples);
 }
 
 void fft_process_forward(fft_t *fft,
       fft_complex_t *out, const float *in, unsigned step)
 {
-   unsigned step_size;
    unsigned samples = fft->size;
    interleave_float(fft->bitinverse_buffer, out, in, samples, step);
-
-   for (step_size = 1; step_size < fft->size; step_size <<= 1)
-   {
-      butterflies(out,
-            fft->phase_lut + samples,
-            -1, step_size, samples);
-   }
+   fft_passes(out, fft->phase_lut + samples, -1, samples);
 }
 
 void fft_process_inverse(fft_t *fft,
       float *out, const fft_complex_t *in, unsigned step)
 {
-   unsigned step_size;
    unsigned samples = fft->size;
 
    interleave_complex(fft->bitinverse_buffer, fft->interleave_buffer,
          in, samples, 1);
-
-   for (step_size = 1; step_size < samples; step_size <<= 1)
-   {
-      butterflies(fft->interleave_buffer,
-            fft->phase_lut + samples,
-            1, step_size, samples);
-   }
+   fft_passes(fft->interleave_buffer, fft->phase_lut + samples, 1, samples);
 
    resolve_float(out, fft->interleave_buffer, samples, 1.0f / samples, step);
 }
 
+void fft_process_inverse_complex(fft_t *fft,
+      fft_complex_t *out, const fft_complex_t *in, unsigned step)
+{
+   unsigned i;
+   unsigned samples = fft->size;
+   float gain       = 1.0f / samples;
+
+   interleave_complex(fft->bitinverse_buffer, fft->interleave_buffer,
+         in, samples, 1);
+   fft_passes(fft->interleave_buffer, fft->phase_lut + samples, 1, samples);
+
+   for (i = 0; i < samples; i++, out += step)
+   {
+      out->real = gain * fft->interleave_buffer[i].real;
+      out->imag = gain * fft->interleave_buffer[i].imag;
+   }
+}
@@ -41,6 +41,9 @@ void fft_process_forward(fft_t *fft,
 void fft_process_inverse(fft_t *fft,
       float *out, const fft_complex_t *in, unsigned step);
 
+void fft_process_inverse_complex(fft_t *fft,
+      fft_complex_t *out, const fft_complex_t *in, unsigned step);
+
 
 #endif
 
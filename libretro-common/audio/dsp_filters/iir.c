@@ -64,12 +64,12 @@ static void iir_free(void *data)
    free(data);
 }
 
-static void iir_process(void *data, struct dspfilter_output *output,
-      const struct dspfilter_input *input)
+static void iir_process_planar(void *data, float **samples, unsigned frames)
 {
    unsigned i;
    struct iir_data *iir = (struct iir_data*)data;
-   float *out           = output->samples;
+   float *left          = samples[0];
+   float *right         = samples[1];
 
    float b0             = iir->b0;
    float b1             = iir->b1;
@@ -88,13 +88,12 @@ static void iir_process(void *data, struct dspfilter_output *output,
    float yn1_r          = iir->r.yn1;
    float yn2_r          = iir->r.yn2;
 
-   output->samples      = input->samples;
-   output->frames       = input->frames;
-
-   for (i = 0; i < input->frames; i++, out += 2)
+   /* Both channels in one loop, the recursions are latency bound
+    * and this keeps two of them in flight. */
+   for (i = 0; i < frames; i++)
    {
-      float in_l = out[0];
-      float in_r = out[1];
+      float in_l = left[i];
+      float in_r = right[i];
 
       float l    = (b0 * in_l + b1 * xn1_l + b2 * xn2_l - a1 * yn1_l - a2 * yn2_l) / a0;
       float r    = (b0 * in_r + b1 * xn1_r + b2 * xn2_r - a1 * yn1_r - a2 * yn2_r) / a0;
@@ -109,8 +108,8 @@ static void iir_process(void *data, struct dspfilter_output *output,
       yn2_r      = yn1_r;
       yn1_r      = r;
 
-      out[0]     = l;
-      out[1]     = r;
+      left[i]    = l;
+      right[i]   = r;
    }
 
    iir->l.xn1 = xn1_l;
@@ -223,7 +222,9 @@ static void iir_filter_init(struct iir_data *iir,
       case RIAA_phono: /* http://www.dsprelated.com/showmessage/73300/3.php */
       {
          double y, b_re, a_re, b_im, a_im, g;
-         float b[3], a[3];
+         /* Unlisted rates fall back to a passthrough. */
+         float b[3] = { 1.0f, 0.0f, 0.0f };
+         float a[3] = { 1.0f, 0.0f, 0.0f };
 
          if ((int)sample_rate == 44100)
          {
@@ -350,12 +351,13 @@ static void *iir_init(const struct dspfilter_info *info,
 
 static const struct dspfilter_implementation iir_plug = {
    iir_init,
-   iir_process,
+   NULL,
    iir_free,
 
    DSPFILTER_API_VERSION,
    "IIR",
    "iir",
+   iir_process_planar,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
@@ -37,22 +37,26 @@ static void panning_free(void *data)
    free(data);
 }
 
-static void panning_process(void *data, struct dspfilter_output *output,
-      const struct dspfilter_input *input)
+static void panning_process_planar(void *data,
+      float **samples, unsigned frames)
 {
    unsigned i;
    struct panning_data *pan = (struct panning_data*)data;
-   float *out               = output->samples;
-
-   output->samples          = input->samples;
-   output->frames           = input->frames;
-
-   for (i = 0; i < input->frames; i++, out += 2)
+   float *l                 = samples[0];
+   float *r                 = samples[1];
+   float ll                 = pan->left[0];
+   float lr                 = pan->left[1];
+   float rl                 = pan->right[0];
+   float rr                 = pan->right[1];
+
+   /* Straight-line over separate channels, the compiler
+    * vectorizes this. */
+   for (i = 0; i < frames; i++)
    {
-      float left  = out[0];
-      float right = out[1];
-      out[0]      = left * pan->left[0]  + right * pan->left[1];
-      out[1]      = left * pan->right[0] + right * pan->right[1];
+      float left  = l[i];
+      float right = r[i];
+      l[i]        = left * ll + right * lr;
+      r[i]        = left * rl + right * rr;
    }
 }
 
@@ -89,12 +93,13 @@ static void *panning_init(const struct dspfilter_info *info,
 
 static const struct dspfilter_implementation panning = {
    panning_init,
-   panning_process,
+   NULL,
    panning_free,
 
    DSPFILTER_API_VERSION,
    "Panning",
    "panning",
+   panning_process_planar,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <libretro_dspfilter.h>
 
 struct comb
@@ -46,32 +47,32 @@ struct allpass
    unsigned bufidx;
 };
 
-static INLINE float comb_process(struct comb *c, float input)
+/* The block versions below walk the delay lines in runs that
+ * stop where one wraps, instead of testing the index per sample. */
+static void allpass_process_block(struct allpass *a,
+      float *samples, unsigned frames)
 {
-   float output         = c->buffer[c->bufidx];
-   c->filterstore       = (output * c->damp2) + (c->filterstore * c->damp1);
-
-   c->buffer[c->bufidx] = input + (c->filterstore * c->feedback);
-
-   c->bufidx++;
-   if (c->bufidx >= c->bufsize)
-      c->bufidx = 0;
-
-   return output;
-}
-
-
-static INLINE float allpass_process(struct allpass *a, float input)
-{
-   float bufout         = a->buffer[a->bufidx];
-   float output         = -input + bufout;
-   a->buffer[a->bufidx] = input + bufout * a->feedback;
-
-   a->bufidx++;
-   if (a->bufidx >= a->bufsize)
-      a->bufidx = 0;
-
-   return output;
+   while (frames)
+   {
+      unsigned i;
+      unsigned run = MIN(frames, a->bufsize - a->bufidx);
+      float *buf   = a->buffer + a->bufidx;
+
+      /* No recursion within a run, this vectorizes. */
+      for (i = 0; i < run; i++)
+      {
+         float input  = samples[i];
+         float bufout = buf[i];
+         samples[i]   = -input + bufout;
+         buf[i]       = input + bufout * a->feedback;
+      }
+
+      a->bufidx += run;
+      if (a->bufidx >= a->bufsize)
+         a->bufidx = 0;
+      samples += run;
+      frames  -= run;
+   }
 }
 
 #define numcombs 8
@@ -108,20 +109,77 @@ struct revmodel
    float mode;
 };
 
-static float revmodel_process(struct revmodel *rev, float in)
+static void revmodel_process_combs(struct revmodel *rev,
+      const float *input, float *mono_out, unsigned frames)
 {
-   int i;
-   float mono_out = 0.0f;
-   float mono_in  = in;
-   float input    = mono_in * rev->gain;
+   unsigned c;
+   float filterstore[numcombs];
 
-   for (i = 0; i < numcombs; i++)
-      mono_out += comb_process(&rev->combL[i], input);
+   for (c = 0; c < numcombs; c++)
+      filterstore[c] = rev->combL[c].filterstore;
 
+   while (frames)
+   {
+      unsigned i;
+      unsigned run = frames;
+      float *buf[numcombs];
+
+      for (c = 0; c < numcombs; c++)
+      {
+         run    = MIN(run, rev->combL[c].bufsize - rev->combL[c].bufidx);
+         buf[c] = rev->combL[c].buffer + rev->combL[c].bufidx;
+      }
+
+      /* All combs per sample, each one is a recursion and
+       * this keeps them in flight together. */
+      for (i = 0; i < run; i++)
+      {
+         float out = 0.0f;
+
+         for (c = 0; c < numcombs; c++)
+         {
+            struct comb *cb = &rev->combL[c];
+            float output    = buf[c][i];
+            filterstore[c]  = (output * cb->damp2) + (filterstore[c] * cb->damp1);
+            buf[c][i]       = input[i] + (filterstore[c] * cb->feedback);
+            out            += output;
+         }
+
+         mono_out[i] = out;
+      }
+
+      for (c = 0; c < numcombs; c++)
+      {
+         rev->combL[c].bufidx += run;
+         if (rev->combL[c].bufidx >= rev->combL[c].bufsize)
+            rev->combL[c].bufidx = 0;
+      }
+
+      input    += run;
+      mono_out += run;
+      frames   -= run;
+   }
+
+   for (c = 0; c < numcombs; c++)
+      rev->combL[c].filterstore = filterstore[c];
+}
+
+static void revmodel_process(struct revmodel *rev,
+      float *samples, unsigned frames)
+{
+   unsigned i;
+   float input[DSPFILTER_PLANAR_BLOCK];
+   float mono_out[DSPFILTER_PLANAR_BLOCK];
+
+   for (i = 0; i < frames; i++)
+      input[i] = samples[i] * rev->gain;
+
+   revmodel_process_combs(rev, input, mono_out, frames);
    for (i = 0; i < numallpasses; i++)
-      mono_out = allpass_process(&rev->allpassL[i], mono_out);
+      allpass_process_block(&rev->allpassL[i], mono_out, frames);
 
-   return mono_in * rev->dry + mono_out * rev->wet1;
+   for (i = 0; i < frames; i++)
+      samples[i] = samples[i] * rev->dry + mono_out[i] * rev->wet1;
 }
 
 static void revmodel_update(struct revmodel *rev)
@@ -241,24 +299,12 @@ static void reverb_free(void *data)
    free(data);
 }
 
-static void reverb_process(void *data, struct dspfilter_output *output,
-      const struct dspfilter_input *input)
+static void reverb_process_planar(void *data, float **samples, unsigned frames)
 {
-   unsigned i;
-   float *out;
    struct reverb_data *rev = (struct reverb_data*)data;
 
-   output->samples         = input->samples;
-   output->frames          = input->frames;
-   out                     = output->samples;
-
-   for (i = 0; i < input->frames; i++, out += 2)
-   {
-      float in[2] = { out[0], out[1] };
-
-      out[0] = revmodel_process(&rev->left, in[0]);
-      out[1] = revmodel_process(&rev->right, in[1]);
-   }
+   revmodel_process(&rev->left,  samples[0], frames);
+   revmodel_process(&rev->right, samples[1], frames);
 }
 
 static void *reverb_init(const struct dspfilter_info *info,
@@ -296,12 +342,13 @@ static void *reverb_init(const struct dspfilter_info *info,
 
 static const struct dspfilter_implementation reverb_plug = {
    reverb_init,
-   reverb_process,
+   NULL,
    reverb_free,
 
    DSPFILTER_API_VERSION,
    "Reverb",
    "reverb",
+   reverb_process_planar,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
@@ -68,30 +68,34 @@ static void tremolocore_init(struct tremolo_core *core,float depth,int samplerat
       }	
 }
 
-float tremolocore_core(struct tremolo_core *core,float in)
+static void tremolocore_process(struct tremolo_core *core,
+      float *samples, unsigned frames)
 {
+   /* Multiply by contiguous runs of the wavetable. */
+   while (frames)
+   {
+      unsigned i, run;
+      const float *table;
+
       core->index = core->index % core->maxindex;
-      return in * core->wavetable[core->index++];
+      run         = MIN(frames, (unsigned)(core->maxindex - core->index));
+      table       = core->wavetable + core->index;
+
+      for (i = 0; i < run; i++)
+         samples[i] *= table[i];
+
+      core->index += run;
+      samples     += run;
+      frames      -= run;
+   }
 }
 
-static void tremolo_process(void *data, struct dspfilter_output *output,
-      const struct dspfilter_input *input)
+static void tremolo_process_planar(void *data, float **samples, unsigned frames)
 {
-   unsigned i;
-   float *out;
    struct tremolo *tre = (struct tremolo*)data;
 
-   output->samples         = input->samples;
-   output->frames          = input->frames;
-   out                     = output->samples;
-
-   for (i = 0; i < input->frames; i++, out += 2)
-   {
-      float in[2] = { out[0], out[1] };
-
-      out[0] = tremolocore_core(&tre->left, in[0]);
-      out[1] = tremolocore_core(&tre->right, in[1]);
-   }
+   tremolocore_process(&tre->left,  samples[0], frames);
+   tremolocore_process(&tre->right, samples[1], frames);
 }
 
 static void *tremolo_init(const struct dspfilter_info *info,
@@ -111,12 +115,13 @@ static void *tremolo_init(const struct dspfilter_info *info,
 
 static const struct dspfilter_implementation tremolo_plug = {
    tremolo_init,
-   tremolo_process,
+   NULL,
    tremolo_free,
 
    DSPFILTER_API_VERSION,
    "Tremolo",
    "tremolo",
+   tremolo_process_planar,
 };
 
 #ifdef HAVE_FILTERS_BUILTIN
@@ -38,10 +38,40 @@
 #include <xmmintrin.h>
 #endif
 
+/* AVX and AVX-512 are dispatched at runtime, so build them even
+ * when the rest of the frontend isn't compiled with -mavx. */
+#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
+#define SINC_CPU_X86
+#endif
+
 #if defined(__AVX__)
+#define SINC_AVX
+#define SINC_AVX_TARGET
+#elif defined(SINC_CPU_X86) && defined(__GNUC__) && \
+   (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define SINC_AVX
+#define SINC_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+#if defined(__AVX512F__)
+#define SINC_AVX512
+#define SINC_AVX512_TARGET
+#elif defined(SINC_CPU_X86) && defined(__GNUC__) && \
+   (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define SINC_AVX512
+#define SINC_AVX512_TARGET __attribute__((target("avx512f")))
+#endif
+
+#if defined(SINC_AVX) || defined(SINC_AVX512)
 #include <immintrin.h>
 #endif
 
+/* SVE has no fixed vector length, the build has to target it. */
+#if defined(__ARM_FEATURE_SVE)
+#define SINC_SVE
+#include <arm_sve.h>
+#endif
+
 /* Rough SNR values for upsampling:
  * LOWEST: 40 dB
  * LOWER: 55 dB
@@ -67,7 +97,13 @@ enum sinc_window
 
 typedef struct rarch_sinc_resampler
 {
+   void (*process)(void *re_, struct resampler_data *data);
    unsigned enable_avx;
+   /* Kaiser tables store, for every phase, 'block' sinc taps
+    * followed by their 'block' deltas, so each vector load of the
+    * kernel below reads one contiguous line. 0 keeps all sinc taps
+    * ahead of all deltas. */
+   unsigned block;
    unsigned phase_bits;
    unsigned subphase_bits;
    unsigned subphase_mask;
@@ -149,8 +185,9 @@ static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
 }
 #endif
 
-#if defined(__AVX__)
-static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
+#if defined(SINC_AVX)
+static SINC_AVX_TARGET void resampler_sinc_process_avx(
+      void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -183,52 +220,54 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
       while (resamp->time < phases)
       {
          unsigned i;
-         __m256 delta, sum_l, sum_r;
-         float *delta_table       = NULL;
-         float *phase_table       = NULL;
+         __m256 delta, sum_l, sum_r, res_l, res_r;
+         const float *phase_table = NULL;
          const float *buffer_l    = resamp->buffer_l + resamp->ptr;
          const float *buffer_r    = resamp->buffer_r + resamp->ptr;
          unsigned taps            = resamp->taps;
          unsigned phase           = resamp->time >> resamp->subphase_bits;
 
-         phase_table              = resamp->phase_table + phase * taps;
-
-         if (resamp->window_type == SINC_WINDOW_KAISER)
-         {
-            phase_table              = resamp->phase_table + phase * taps * 2;
-            delta_table              = phase_table + taps;
-            delta                    = _mm256_set1_ps((float)
-                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
-         }
-
          sum_l                    = _mm256_setzero_ps();
          sum_r                    = _mm256_setzero_ps();
 
-         for (i = 0; i < taps; i += 8)
+         if (resamp->window_type == SINC_WINDOW_KAISER)
          {
-            __m256 sinc;
-            __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
-            __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+            phase_table           = resamp->phase_table + phase * taps * 2;
+            delta                 = _mm256_set1_ps((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
 
-            if (resamp->window_type == SINC_WINDOW_KAISER)
+            for (i = 0; i < taps; i += 8)
             {
-               __m256 deltas = _mm256_load_ps(delta_table + i);
-               sinc          = _mm256_add_ps(_mm256_load_ps((const float*)phase_table + i),
-                     _mm256_mul_ps(deltas, delta));
+               __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+               __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+               __m256 sinc   = _mm256_add_ps(
+                     _mm256_load_ps(phase_table + 2 * i),
+                     _mm256_mul_ps(_mm256_load_ps(phase_table + 2 * i + 8),
+                        delta));
+
+               sum_l         = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
+               sum_r         = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
             }
-            else
+         }
+         else
+         {
+            phase_table           = resamp->phase_table + phase * taps;
+
+            for (i = 0; i < taps; i += 8)
             {
-               sinc          = _mm256_load_ps((const float*)phase_table + i);
-            }
+               __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+               __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+               __m256 sinc   = _mm256_load_ps(phase_table + i);
 
-            sum_l         = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
-            sum_r         = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
+               sum_l         = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
+               sum_r         = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
+            }
          }
 
          /* hadd on AVX is weird, and acts on low-lanes
           * and high-lanes separately. */
-         __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
-         __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
+         res_l        = _mm256_hadd_ps(sum_l, sum_l);
+         res_r        = _mm256_hadd_ps(sum_r, sum_r);
          res_l        = _mm256_hadd_ps(res_l, res_l);
          res_r        = _mm256_hadd_ps(res_r, res_r);
          res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
@@ -236,8 +275,8 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 
          /* This is optimized to mov %xmmN, [mem].
           * There doesn't seem to be any _mm256_store_ss intrinsic. */
-         _mm_store_ss(output + 0, _mm256_extractf128_ps(res_l, 0));
-         _mm_store_ss(output + 1, _mm256_extractf128_ps(res_r, 0));
+         _mm_store_ss(output + 0, _mm256_castps256_ps128(res_l));
+         _mm_store_ss(output + 1, _mm256_castps256_ps128(res_r));
 
          output += 2;
          out_frames++;
@@ -249,8 +288,9 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
-#if defined(__SSE__)
-static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
+#if defined(SINC_AVX512)
+static SINC_AVX512_TARGET void resampler_sinc_process_avx512(
+      void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
    unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
@@ -283,47 +323,254 @@ static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
       while (resamp->time < phases)
       {
          unsigned i;
-         __m128 sum, sum_l, sum_r, delta;
-         float *phase_table       = NULL;
-         float *delta_table       = NULL;
+         __m512 delta, sum_l, sum_r;
+         __m256 half_l, half_r;
+         __m128 sum;
+         const float *phase_table = NULL;
          const float *buffer_l    = resamp->buffer_l + resamp->ptr;
          const float *buffer_r    = resamp->buffer_r + resamp->ptr;
          unsigned taps            = resamp->taps;
          unsigned phase           = resamp->time >> resamp->subphase_bits;
 
+         sum_l                    = _mm512_setzero_ps();
+         sum_r                    = _mm512_setzero_ps();
+
          if (resamp->window_type == SINC_WINDOW_KAISER)
          {
-            phase_table              = resamp->phase_table + phase * taps * 2;
-            delta_table              = phase_table + taps;
-            delta                    = _mm_set1_ps((float)
+            phase_table           = resamp->phase_table + phase * taps * 2;
+            delta                 = _mm512_set1_ps((float)
                   (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+            for (i = 0; i < taps; i += 16)
+            {
+               __m512 sinc  = _mm512_fmadd_ps(
+                     _mm512_load_ps(phase_table + 2 * i + 16), delta,
+                     _mm512_load_ps(phase_table + 2 * i));
+
+               sum_l        = _mm512_fmadd_ps(
+                     _mm512_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r        = _mm512_fmadd_ps(
+                     _mm512_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
          }
          else
          {
-            phase_table              = resamp->phase_table + phase * taps;
+            phase_table           = resamp->phase_table + phase * taps;
+
+            for (i = 0; i < taps; i += 16)
+            {
+               __m512 sinc  = _mm512_load_ps(phase_table + i);
+
+               sum_l        = _mm512_fmadd_ps(
+                     _mm512_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r        = _mm512_fmadd_ps(
+                     _mm512_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+         }
+
+         /* Fold 16 lanes down to 4, then finish L and R together.
+          * The high 256 bits can only be extracted as doubles
+          * without AVX-512DQ. */
+         half_l = _mm256_add_ps(_mm512_castps512_ps256(sum_l),
+               _mm256_castpd_ps(_mm512_extractf64x4_pd(
+                     _mm512_castps_pd(sum_l), 1)));
+         half_r = _mm256_add_ps(_mm512_castps512_ps256(sum_r),
+               _mm256_castpd_ps(_mm512_extractf64x4_pd(
+                     _mm512_castps_pd(sum_r), 1)));
+
+         {
+            __m128 l = _mm_add_ps(_mm256_castps256_ps128(half_l),
+                  _mm256_extractf128_ps(half_l, 1));
+            __m128 r = _mm_add_ps(_mm256_castps256_ps128(half_r),
+                  _mm256_extractf128_ps(half_r, 1));
+
+            /* { l0 + l2, r0 + r2, l1 + l3, r1 + r3 } */
+            sum      = _mm_add_ps(_mm_unpacklo_ps(l, r),
+                  _mm_unpackhi_ps(l, r));
+            /* { L, R, X, X } */
+            sum      = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+         }
+
+         _mm_storel_pi((__m64*)output, sum);
+
+         output += 2;
+         out_frames++;
+         resamp->time += ratio;
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
+#if defined(SINC_SVE)
+static void resampler_sinc_process_sve(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+         resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+         resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      while (resamp->time < phases)
+      {
+         unsigned i;
+         svfloat32_t sum_l, sum_r;
+         const svbool_t pg        = svptrue_b32();
+         /* Taps are a multiple of the vector length. */
+         unsigned vl              = (unsigned)svcntw();
+         const float *phase_table = NULL;
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         unsigned phase           = resamp->time >> resamp->subphase_bits;
+
+         sum_l                    = svdup_n_f32(0.0f);
+         sum_r                    = svdup_n_f32(0.0f);
+
+         if (resamp->window_type == SINC_WINDOW_KAISER)
+         {
+            svfloat32_t delta     = svdup_n_f32((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+            phase_table           = resamp->phase_table + phase * taps * 2;
+
+            for (i = 0; i < taps; i += vl)
+            {
+               svfloat32_t sinc = svmla_f32_x(pg,
+                     svld1_f32(pg, phase_table + 2 * i),
+                     svld1_f32(pg, phase_table + 2 * i + vl), delta);
+
+               sum_l            = svmla_f32_x(pg, sum_l,
+                     svld1_f32(pg, buffer_l + i), sinc);
+               sum_r            = svmla_f32_x(pg, sum_r,
+                     svld1_f32(pg, buffer_r + i), sinc);
+            }
+         }
+         else
+         {
+            phase_table           = resamp->phase_table + phase * taps;
+
+            for (i = 0; i < taps; i += vl)
+            {
+               svfloat32_t sinc = svld1_f32(pg, phase_table + i);
+
+               sum_l            = svmla_f32_x(pg, sum_l,
+                     svld1_f32(pg, buffer_l + i), sinc);
+               sum_r            = svmla_f32_x(pg, sum_r,
+                     svld1_f32(pg, buffer_r + i), sinc);
+            }
          }
 
+         output[0] = svaddv_f32(pg, sum_l);
+         output[1] = svaddv_f32(pg, sum_r);
+
+         output += 2;
+         out_frames++;
+         resamp->time += ratio;
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
+#if defined(__SSE__)
+static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+         resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+         resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      while (resamp->time < phases)
+      {
+         unsigned i;
+         __m128 sum, sum_l, sum_r, delta;
+         const float *phase_table = NULL;
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         unsigned phase           = resamp->time >> resamp->subphase_bits;
+
          sum_l                    = _mm_setzero_ps();
          sum_r                    = _mm_setzero_ps();
 
-         for (i = 0; i < taps; i += 4)
+         if (resamp->window_type == SINC_WINDOW_KAISER)
          {
-            __m128 deltas, _sinc;
-            __m128 buf_l = _mm_loadu_ps(buffer_l + i);
-            __m128 buf_r = _mm_loadu_ps(buffer_r + i);
+            phase_table              = resamp->phase_table + phase * taps * 2;
+            delta                    = _mm_set1_ps((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
 
-            if (resamp->window_type == SINC_WINDOW_KAISER)
+            /* Four sinc taps, then their four deltas. */
+            for (i = 0; i < taps; i += 4)
             {
-               deltas = _mm_load_ps(delta_table + i);
-               _sinc  = _mm_add_ps(_mm_load_ps((const float*)phase_table + i),
-                     _mm_mul_ps(deltas, delta));
+               __m128 buf_l = _mm_loadu_ps(buffer_l + i);
+               __m128 buf_r = _mm_loadu_ps(buffer_r + i);
+               __m128 _sinc = _mm_add_ps(_mm_load_ps(phase_table + 2 * i),
+                     _mm_mul_ps(_mm_load_ps(phase_table + 2 * i + 4), delta));
+
+               sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
+               sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
             }
-            else
+         }
+         else
+         {
+            phase_table              = resamp->phase_table + phase * taps;
+
+            for (i = 0; i < taps; i += 4)
             {
-               _sinc  = _mm_load_ps((const float*)phase_table + i);
+               __m128 buf_l = _mm_loadu_ps(buffer_l + i);
+               __m128 buf_r = _mm_loadu_ps(buffer_r + i);
+               __m128 _sinc = _mm_load_ps(phase_table + i);
+
+               sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
+               sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
             }
-            sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
-            sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
          }
 
          /* Them annoying shuffles.
@@ -506,6 +753,36 @@ static void sinc_init_table_kaiser(rarch_sinc_resampler_t *resamp,
    }
 }
 
+/* Reorders each phase of a Kaiser table from all sinc taps followed
+ * by all deltas into alternating lines of 'block' taps and 'block'
+ * deltas, matching the vector width of the selected kernel. */
+static bool sinc_interleave_table(float *phase_table,
+      unsigned phases, unsigned taps, unsigned block)
+{
+   unsigned p;
+   float *tmp = (float*)malloc(2 * taps * sizeof(float));
+
+   if (!tmp)
+      return false;
+
+   for (p = 0; p < phases; p++)
+   {
+      unsigned i;
+      float *table = phase_table + p * taps * 2;
+
+      memcpy(tmp, table, 2 * taps * sizeof(float));
+
+      for (i = 0; i < taps; i += block)
+      {
+         memcpy(table + 2 * i,         tmp + i,        block * sizeof(float));
+         memcpy(table + 2 * i + block, tmp + taps + i, block * sizeof(float));
+      }
+   }
+
+   free(tmp);
+   return true;
+}
+
 static void sinc_init_table_lanczos(rarch_sinc_resampler_t *resamp, double cutoff,
       float *phase_table, int phases, int taps, bool calculate_delta)
 {
@@ -571,6 +848,7 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    size_t phase_elems             = 0;
    size_t elems                   = 0;
    unsigned sidelobes             = 0;
+   unsigned width                 = 0;
    rarch_sinc_resampler_t *re     = (rarch_sinc_resampler_t*)
       calloc(1, sizeof(*re));
 
@@ -639,19 +917,54 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
-   /* Be SIMD-friendly. */
-#if defined(__AVX__)
-   if (re->enable_avx)
-      re->taps  = (re->taps + 7) & ~7;
-   else
+   /* Pick the kernel first, taps are rounded up to its width.
+    * Later checks override earlier ones, so keep them ordered
+    * from slowest to fastest. */
+   re->process = resampler_sinc_process_c;
+   width       = 4;
+
+#if defined(WANT_NEON)
+   if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
+   {
+      re->process = resampler_sinc_process_neon;
+      width       = 8;
+   }
 #endif
+#if defined(__SSE__)
+   if (mask & RESAMPLER_SIMD_SSE)
    {
-#if defined(WANT_NEON)
-      re->taps     = (re->taps + 7) & ~7;
-#else
-      re->taps     = (re->taps + 3) & ~3;
+      re->process = resampler_sinc_process_sse;
+      re->block   = 4;
+      width       = 4;
+   }
+#endif
+#if defined(SINC_SVE)
+   if (mask & RESAMPLER_SIMD_SVE)
+   {
+      re->process = resampler_sinc_process_sve;
+      re->block   = (unsigned)svcntw();
+      width       = re->block;
+   }
+#endif
+#if defined(SINC_AVX)
+   if (mask & RESAMPLER_SIMD_AVX && re->enable_avx)
+   {
+      re->process = resampler_sinc_process_avx;
+      re->block   = 8;
+      width       = 8;
+   }
 #endif
+#if defined(SINC_AVX512)
+   if (mask & RESAMPLER_SIMD_AVX512 && re->enable_avx)
+   {
+      re->process = resampler_sinc_process_avx512;
+      re->block   = 16;
+      width       = 16;
    }
+#endif
+
+   /* Be SIMD-friendly. */
+   re->taps        = (re->taps + width - 1) / width * width;
 
    phase_elems     = ((1 << re->phase_bits) * re->taps);
    if (re->window_type == SINC_WINDOW_KAISER)
@@ -666,6 +979,9 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    re->buffer_l    = re->main_buffer + phase_elems;
    re->buffer_r    = re->buffer_l + 2 * re->taps;
 
+   /* The history is read before it has been filled. */
+   memset(re->buffer_l, 0, sizeof(float) * 4 * re->taps);
+
    switch (re->window_type)
    {
       case SINC_WINDOW_LANCZOS:
@@ -675,32 +991,15 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       case SINC_WINDOW_KAISER:
          sinc_init_table_kaiser(re, cutoff, re->phase_table,
                1 << re->phase_bits, re->taps, true);
+         if (re->block && re->block < re->taps
+               && !sinc_interleave_table(re->phase_table,
+                  1 << re->phase_bits, re->taps, re->block))
+            goto error;
          break;
       case SINC_WINDOW_NONE:
          goto error;
    }
 
-   sinc_resampler.process = resampler_sinc_process_c;
-
-   if (mask & RESAMPLER_SIMD_AVX && re->enable_avx)
-   {
-#if defined(__AVX__)
-      sinc_resampler.process = resampler_sinc_process_avx;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_SSE)
-   {
-#if defined(__SSE__)
-      sinc_resampler.process = resampler_sinc_process_sse;
-#endif
-   }
-   else if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
-   {
-#if defined(WANT_NEON)
-      sinc_resampler.process = resampler_sinc_process_neon;
-#endif
-   }
-
    return re;
 
 error:
@@ -708,9 +1007,17 @@ error:
    return NULL;
 }
 
+/* Instances can end up with different kernels (and table layouts),
+ * so dispatch per instance rather than through the driver struct. */
+static void resampler_sinc_process(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   resamp->process(resamp, data);
+}
+
 retro_resampler_t sinc_resampler = {
    resampler_sinc_new,
-   resampler_sinc_process_c,
+   resampler_sinc_process,
    resampler_sinc_free,
    RESAMPLER_API_VERSION,
    "sinc",
@@ -594,7 +594,7 @@ uint64_t cpu_features_get(void)
    const int avx_flags = (1 << 27) | (1 << 28);
 #endif
 
-   char buf[sizeof(" MMX MMXEXT SSE SSE2 SSE3 SSSE3 SS4 SSE4.2 AES AVX AVX2 NEON VMX VMX128 VFPU PS")];
+   char buf[sizeof(" MMX MMXEXT SSE SSE2 SSE3 SSSE3 SS4 SSE4.2 AES PCLMUL AVX AVX2 AVX512 NEON SVE CRC32 VFPv3 VFPv4 VMX VMX128 VFPU PS ASIMD")];
 
    memset(buf, 0, sizeof(buf));
 
@@ -663,6 +663,10 @@ uint64_t cpu_features_get(void)
    if (sysctlbyname("hw.optional.neon", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_NEON;
 
+   len            = sizeof(size_t);
+   if (sysctlbyname("hw.optional.armv8_crc32", NULL, &len, NULL, 0) == 0)
+      cpu |= RETRO_SIMD_CRC32;
+
 #elif defined(_XBOX1)
    cpu |= RETRO_SIMD_MMX;
    cpu |= RETRO_SIMD_SSE;
@@ -729,6 +733,9 @@ uint64_t cpu_features_get(void)
    if (flags[2] & (1 << 25))
       cpu |= RETRO_SIMD_AES;
 
+   if (flags[2] & (1 << 1))
+      cpu |= RETRO_SIMD_PCLMUL;
+
 
    /* Must only perform xgetbv check if we have
     * AVX CPU support (guaranteed to have at least i686). */
@@ -741,6 +748,12 @@ uint64_t cpu_features_get(void)
       x86_cpuid(7, flags);
       if (flags[1] & (1 << 5))
          cpu |= RETRO_SIMD_AVX2;
+
+      /* AVX-512F, the OS must also save the opmask
+       * and all of the ZMM state. */
+      if ((cpu & RETRO_SIMD_AVX) && (flags[1] & (1 << 16))
+            && ((xgetbv_x86(0) & 0xe6) == 0xe6))
+         cpu |= RETRO_SIMD_AVX512;
    }
 
    x86_cpuid(0x80000000, flags);
@@ -777,6 +790,12 @@ uint64_t cpu_features_get(void)
 #endif
    }
 
+   if (check_arm_cpu_feature("sve"))
+      cpu |= RETRO_SIMD_SVE;
+
+   if (check_arm_cpu_feature("crc32"))
+      cpu |= RETRO_SIMD_CRC32;
+
 #if 0
     check_arm_cpu_feature("swp");
     check_arm_cpu_feature("half");
@@ -812,9 +831,13 @@ uint64_t cpu_features_get(void)
    if (cpu & RETRO_SIMD_SSE4)   strlcat(buf, " SSE4", sizeof(buf));
    if (cpu & RETRO_SIMD_SSE42)  strlcat(buf, " SSE4.2", sizeof(buf));
    if (cpu & RETRO_SIMD_AES)    strlcat(buf, " AES", sizeof(buf));
+   if (cpu & RETRO_SIMD_PCLMUL) strlcat(buf, " PCLMUL", sizeof(buf));
    if (cpu & RETRO_SIMD_AVX)    strlcat(buf, " AVX", sizeof(buf));
    if (cpu & RETRO_SIMD_AVX2)   strlcat(buf, " AVX2", sizeof(buf));
+   if (cpu & RETRO_SIMD_AVX512) strlcat(buf, " AVX512", sizeof(buf));
    if (cpu & RETRO_SIMD_NEON)   strlcat(buf, " NEON", sizeof(buf));
+   if (cpu & RETRO_SIMD_SVE)    strlcat(buf, " SVE", sizeof(buf));
+   if (cpu & RETRO_SIMD_CRC32)  strlcat(buf, " CRC32", sizeof(buf));
    if (cpu & RETRO_SIMD_VFPV3)  strlcat(buf, " VFPv3", sizeof(buf));
    if (cpu & RETRO_SIMD_VFPV4)  strlcat(buf, " VFPv4", sizeof(buf));
    if (cpu & RETRO_SIMD_VMX)    strlcat(buf, " VMX", sizeof(buf));
@@ -46,6 +46,10 @@
 #include <lists/string_list.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 struct file_archive_file_data
 {
 #ifdef HAVE_MMAP
@@ -55,6 +59,11 @@ struct file_archive_file_data
    size_t size;
 };
 
+static bool file_archive_cache_enabled   = false;
+#ifdef HAVE_THREADS
+static slock_t *file_archive_cache_slock = NULL;
+#endif
+
 static size_t file_archive_size(file_archive_file_data_t *data)
 {
    if (!data)
@@ -595,6 +604,7 @@ struct string_list *file_archive_get_file_list(const char *path,
 {
    int ret;
    struct archive_extract_userdata userdata;
+   const struct file_archive_file_backend *backend = NULL;
 
    strlcpy(userdata.archive_path, path, sizeof(userdata.archive_path));
    userdata.first_extracted_file_path       = NULL;
@@ -618,8 +628,14 @@ struct string_list *file_archive_get_file_list(const char *path,
    if (!userdata.list)
       goto error;
 
-   ret = file_archive_walk(path, valid_exts,
-         file_archive_get_file_list_cb, &userdata);
+   backend = file_archive_get_file_backend(path);
+
+   if (backend && backend->archive_index_walk)
+      ret = backend->archive_index_walk(path, valid_exts,
+            file_archive_get_file_list_cb, &userdata);
+   else
+      ret = file_archive_walk(path, valid_exts,
+            file_archive_get_file_list_cb, &userdata);
 
    if (ret <= 0)
    {
@@ -829,6 +845,60 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
    return NULL;
 }
 
+struct file_archive_extract_stream
+{
+   const struct file_archive_file_backend *backend;
+   void *state;
+};
+
+file_archive_extract_stream_t *file_archive_extract_stream_new(
+      const char *path, const char *target_dir)
+{
+   file_archive_extract_stream_t *stream       = NULL;
+   const struct file_archive_file_backend *backend =
+      file_archive_get_file_backend(path);
+
+   if (!backend || !backend->extract_stream_new || string_is_empty(target_dir))
+      return NULL;
+
+   stream = (file_archive_extract_stream_t*)calloc(1, sizeof(*stream));
+
+   if (!stream)
+      return NULL;
+
+   stream->backend = backend;
+   stream->state   = backend->extract_stream_new(target_dir);
+
+   if (!stream->state)
+   {
+      free(stream);
+      return NULL;
+   }
+
+   return stream;
+}
+
+bool file_archive_extract_stream_write(file_archive_extract_stream_t *stream,
+      const uint8_t *data, size_t len)
+{
+   if (!stream)
+      return false;
+   return stream->backend->extract_stream_write(stream->state, data, len);
+}
+
+bool file_archive_extract_stream_free(file_archive_extract_stream_t *stream)
+{
+   bool complete;
+
+   if (!stream)
+      return false;
+
+   complete = stream->backend->extract_stream_free(stream->state);
+   free(stream);
+
+   return complete;
+}
+
 /**
  * file_archive_get_file_crc32:
  * @path                         : filename path of archive
@@ -860,6 +930,16 @@ uint32_t file_archive_get_file_crc32(const char *path)
          archive_path += 1;
    }
 
+   if (backend->archive_index_find)
+   {
+      uint32_t crc  = 0;
+      uint32_t size = 0;
+
+      if (backend->archive_index_find(path, archive_path, &crc, &size))
+         return crc;
+      return 0;
+   }
+
    state.type          = ARCHIVE_TRANSFER_INIT;
    state.archive_size  = 0;
    state.handle        = NULL;
@@ -906,3 +986,56 @@ uint32_t file_archive_get_file_crc32(const char *path)
 
    return 0;
 }
+
+void file_archive_cache_enable(bool enable)
+{
+   const struct file_archive_file_backend *backends[2];
+   unsigned i;
+
+   if (enable == file_archive_cache_enabled)
+      return;
+
+   if (enable)
+   {
+#ifdef HAVE_THREADS
+      if (!(file_archive_cache_slock = slock_new()))
+         return;
+#endif
+      file_archive_cache_enabled = true;
+      return;
+   }
+
+   backends[0] = file_archive_get_zlib_file_backend();
+   backends[1] = file_archive_get_7z_file_backend();
+
+   for (i = 0; i < ARRAY_SIZE(backends); i++)
+      if (backends[i] && backends[i]->cache_clear)
+         backends[i]->cache_clear();
+
+   file_archive_cache_enabled = false;
+#ifdef HAVE_THREADS
+   slock_free(file_archive_cache_slock);
+   file_archive_cache_slock   = NULL;
+#endif
+}
+
+bool file_archive_cache_is_enabled(void)
+{
+   return file_archive_cache_enabled;
+}
+
+void file_archive_cache_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (file_archive_cache_slock)
+      slock_lock(file_archive_cache_slock);
+#endif
+}
+
+void file_archive_cache_unlock(void)
+{
+#ifdef HAVE_THREADS
+   if (file_archive_cache_slock)
+      slock_unlock(file_archive_cache_slock);
+#endif
+}
@@ -39,6 +39,9 @@
 #define SEVENZIP_MAGIC "7z\xBC\xAF\x27\x1C"
 #define SEVENZIP_MAGIC_LEN 6
 
+/* Largest decoded block file_archive_cache_enable() keeps around */
+#define SEVENZIP_BLOCK_CACHE_MAX (64 * 1024 * 1024)
+
 /* Assume W-functions do not work below Win2K and Xbox platforms */
 #if defined(_WIN32_WINNT) && _WIN32_WINNT < 0x0500 || defined(_XBOX)
 #ifndef LEGACY_WIN32
@@ -83,6 +86,88 @@ static void *sevenzip_stream_alloc_tmp_impl(void *p, size_t size)
    return malloc(size);
 }
 
+/* Last solid block sevenzip_file_read() decoded, so reading the
+ * other members of that block needn't decode it all over again
+ * from its start. Taken out while in use, so a concurrent read
+ * of the same archive simply decodes its own. */
+static struct
+{
+   char *path;
+   uint8_t *output;
+   int64_t mtime;
+   size_t output_size;
+   int32_t file_size;
+   uint32_t block_index;
+} sevenzip_block_cache;
+
+static bool sevenzip_block_cache_take(const char *path,
+      int32_t file_size, int64_t mtime,
+      uint8_t **output, size_t *output_size, uint32_t *block_index)
+{
+   bool found = false;
+
+   file_archive_cache_lock();
+   if (     sevenzip_block_cache.output
+         && sevenzip_block_cache.mtime     == mtime
+         && sevenzip_block_cache.file_size == file_size
+         && string_is_equal(sevenzip_block_cache.path, path))
+   {
+      *output                          = sevenzip_block_cache.output;
+      *output_size                     = sevenzip_block_cache.output_size;
+      *block_index                     = sevenzip_block_cache.block_index;
+      sevenzip_block_cache.output      = NULL;
+      found                            = true;
+   }
+   file_archive_cache_unlock();
+
+   return found;
+}
+
+static void sevenzip_block_cache_put(const char *path,
+      int32_t file_size, int64_t mtime,
+      uint8_t *output, size_t output_size, uint32_t block_index)
+{
+   char *new_path      = strdup(path);
+   char *old_path      = NULL;
+   uint8_t *old_output = NULL;
+
+   if (!new_path)
+   {
+      free(output);
+      return;
+   }
+
+   file_archive_cache_lock();
+   old_path                         = sevenzip_block_cache.path;
+   old_output                       = sevenzip_block_cache.output;
+   sevenzip_block_cache.path        = new_path;
+   sevenzip_block_cache.output      = output;
+   sevenzip_block_cache.output_size = output_size;
+   sevenzip_block_cache.block_index = block_index;
+   sevenzip_block_cache.mtime       = mtime;
+   sevenzip_block_cache.file_size   = file_size;
+   file_archive_cache_unlock();
+
+   free(old_path);
+   free(old_output);
+}
+
+static void sevenzip_block_cache_clear(void)
+{
+   char *path      = NULL;
+   uint8_t *output = NULL;
+
+   file_archive_cache_lock();
+   path                        = sevenzip_block_cache.path;
+   output                      = sevenzip_block_cache.output;
+   sevenzip_block_cache.path   = NULL;
+   sevenzip_block_cache.output = NULL;
+   file_archive_cache_unlock();
+
+   free(path);
+   free(output);
+}
+
 static void* sevenzip_stream_new(void)
 {
    struct sevenzip_context_t *sevenzip_context =
@@ -134,8 +219,14 @@ static int sevenzip_file_read(
    ISzAlloc allocImp;
    ISzAlloc allocTempImp;
    CSzArEx db;
+   int32_t file_size;
+   int64_t mtime;
    uint8_t *output      = 0;
    long outsize         = -1;
+   size_t output_size   = 0;
+   uint32_t block_index = 0xFFFFFFFF;
+   bool cache           = file_archive_cache_is_enabled()
+      && path_get_size_mtime(path, &file_size, &mtime);
 
    /*These are the allocation routines.
     * Currently using the non-standard 7zip choices. */
@@ -193,13 +284,18 @@ static int sevenzip_file_read(
 
    SzArEx_Init(&db);
 
+   /* SzArEx_Extract() only decodes again should the member
+    * live in another block. */
+   if (cache)
+      sevenzip_block_cache_take(path, file_size, mtime,
+            &output, &output_size, &block_index);
+
    if (SzArEx_Open(&db, &lookStream.s, &allocImp, &allocTempImp) == SZ_OK)
    {
       uint32_t i;
       bool file_found      = false;
       uint16_t *temp       = NULL;
       size_t temp_size     = 0;
-      uint32_t block_index = 0xFFFFFFFF;
       SRes res             = SZ_OK;
 
       for (i = 0; i < db.db.NumFiles; i++)
@@ -241,8 +337,6 @@ static int sevenzip_file_read(
 
          if (string_is_equal(infile, needle))
          {
-            size_t output_size   = 0;
-
             /* C LZMA SDK does not support chunked extraction - see here:
              * sourceforge.net/p/sevenzip/discussion/45798/thread/6fb59aaf/
              * */
@@ -267,16 +361,40 @@ static int sevenzip_file_read(
                   outsize    = -1;
                }
             }
+            else if (cache && output_size <= SEVENZIP_BLOCK_CACHE_MAX)
+            {
+               /* The block is kept, copy the member out. */
+               if ((*buf = malloc(outsize + 1)))
+               {
+                  ((char*)(*buf))[outsize] = '\0';
+                  memcpy(*buf, output + offset, outsize);
+               }
+               else
+                  res = SZ_ERROR_MEM;
+            }
             else
             {
-               /*We could either use the 7Zip allocated buffer,
-                * or create our own and use it.
-                * We would however need to realloc anyways, because RetroArch
-                * expects a \0 at the end, therefore we allocate new,
-                * copy and free the old one. */
-               *buf = malloc(outsize + 1);
-               ((char*)(*buf))[outsize] = '\0';
-               memcpy(*buf,output + offset,outsize);
+               /* Hand the 7Zip allocated buffer over instead of
+                * copying the member out of it. RetroArch expects a \0
+                * at the end, so slide the member to the front and
+                * resize the block to fit, which at worst costs the
+                * copy we would have made anyway. */
+               uint8_t *member = output;
+
+               if (offset)
+                  memmove(output, output + offset, outsize);
+
+               if (outsize + 1 != (long)output_size)
+                  member = (uint8_t*)realloc(output, outsize + 1);
+
+               if (member)
+               {
+                  member[outsize] = '\0';
+                  *buf            = member;
+                  output          = NULL;
+               }
+               else
+                  res             = SZ_ERROR_MEM;
             }
             break;
          }
@@ -284,7 +402,6 @@ static int sevenzip_file_read(
 
       if (temp)
          free(temp);
-      IAlloc_Free(&allocImp, output);
 
       if (!(file_found && res == SZ_OK))
       {
@@ -295,8 +412,15 @@ static int sevenzip_file_read(
 
          outsize    = -1;
       }
+      else if (cache && output && output_size <= SEVENZIP_BLOCK_CACHE_MAX)
+      {
+         sevenzip_block_cache_put(path, file_size, mtime,
+               output, output_size, block_index);
+         output = NULL;
+      }
    }
 
+   IAlloc_Free(&allocImp, output);
    SzArEx_Free(&db, &allocImp);
    File_Close(&archiveStream.file);
 
@@ -512,5 +636,11 @@ const struct file_archive_file_backend sevenzip_backend = {
    sevenzip_file_read,
    sevenzip_parse_file_init,
    sevenzip_parse_file_iterate_step,
-   "7z"
+   "7z",
+   NULL, /* archive_index_walk */
+   NULL, /* archive_index_find */
+   sevenzip_block_cache_clear,
+   NULL, /* extract_stream_new */
+   NULL, /* extract_stream_write */
+   NULL  /* extract_stream_free */
 };
@@ -23,9 +23,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <compat/strl.h>
 #include <file/archive_file.h>
+#include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <streams/trans_stream.h>
+#include <string/stdstring.h>
 #include <retro_inline.h>
 #include <retro_miscellaneous.h>
 #include <encodings/crc32.h>
@@ -41,6 +44,44 @@
 #define END_OF_CENTRAL_DIR_SIGNATURE 0x06054b50
 #endif
 
+#ifndef LOCAL_FILE_HEADER_SIGNATURE
+#define LOCAL_FILE_HEADER_SIGNATURE 0x04034b50
+#endif
+
+/* Archives whose index file_archive_cache_enable() keeps */
+#define ZIP_INDEX_CACHE_SIZE 4
+
+typedef struct zip_index_entry
+{
+   uint32_t name;   /* offset in zip_index_t.names */
+   uint32_t hash;
+   uint32_t crc32;
+   uint32_t csize;
+   uint32_t size;
+   uint32_t offset; /* of the local file header */
+   unsigned cmode;
+} zip_index_entry_t;
+
+/* Central directory of an archive, as of the mtime and size it
+ * had when read. Members keep the directory's order; buckets
+ * hash them by name, holding entry index + 1. */
+typedef struct zip_index
+{
+   char *path;
+   char *names;
+   zip_index_entry_t *entries;
+   uint32_t *buckets;
+   int64_t mtime;
+   int32_t file_size;
+   uint32_t count;
+   uint32_t bucket_mask;
+   unsigned refs;
+   unsigned used;
+} zip_index_t;
+
+static zip_index_t *zip_index_cache[ZIP_INDEX_CACHE_SIZE];
+static unsigned zip_index_clock = 0;
+
 static INLINE uint32_t read_le(const uint8_t *data, unsigned size)
 {
    unsigned i;
@@ -53,6 +94,368 @@ static INLINE uint32_t read_le(const uint8_t *data, unsigned size)
    return val;
 }
 
+static uint32_t zip_index_hash(const char *name)
+{
+   uint32_t hash = 5381;
+
+   while (*name)
+      hash = (hash << 5) + hash + (uint8_t)*name++;
+
+   return hash;
+}
+
+static void zip_index_free(zip_index_t *index)
+{
+   if (!index)
+      return;
+
+   free(index->path);
+   free(index->names);
+   free(index->entries);
+   free(index->buckets);
+   free(index);
+}
+
+static zip_index_t *zip_index_read(const char *path)
+{
+   uint32_t i;
+   int64_t file_size, tail;
+   uint32_t cd_offset, cd_size, capacity;
+   const uint8_t *footer = NULL;
+   const uint8_t *cd_end = NULL;
+   const uint8_t *cd_ptr = NULL;
+   uint8_t *buf          = NULL;
+   size_t names_size     = 0;
+   zip_index_t *index    = NULL;
+   RFILE *file           = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return NULL;
+
+   file_size = filestream_get_size(file);
+   if (file_size < 22)
+      goto error;
+
+   /* The end of central directory record, followed by at most
+    * 64K of comment. */
+   tail = file_size < 22 + 0xFFFF ? file_size : 22 + 0xFFFF;
+   if (!(buf = (uint8_t*)malloc((size_t)tail)))
+      goto error;
+   filestream_seek(file, file_size - tail, RETRO_VFS_SEEK_POSITION_START);
+   if (filestream_read(file, buf, tail) != tail)
+      goto error;
+
+   for (footer = buf + tail - 22; ; footer--)
+   {
+      if (     read_le(footer, 4) == END_OF_CENTRAL_DIR_SIGNATURE
+            && footer + 22 + read_le(footer + 20, 2) == buf + tail)
+         break;
+      if (footer == buf)
+         goto error;
+   }
+
+   cd_size   = read_le(footer + 12, 4);
+   cd_offset = read_le(footer + 16, 4);
+   free(buf);
+   buf       = NULL;
+
+   if ((int64_t)cd_offset + cd_size > file_size)
+      goto error;
+
+   if (!(buf = (uint8_t*)malloc(cd_size ? cd_size : 1)))
+      goto error;
+   filestream_seek(file, cd_offset, RETRO_VFS_SEEK_POSITION_START);
+   if (filestream_read(file, buf, cd_size) != cd_size)
+      goto error;
+
+   filestream_close(file);
+   file = NULL;
+
+   /* Every central directory header has 46 bytes besides the
+    * name, so neither the entries nor the names need more. */
+   capacity = cd_size / 46;
+
+   if (!(index = (zip_index_t*)calloc(1, sizeof(*index))))
+      goto error;
+
+   index->entries = (zip_index_entry_t*)malloc(
+         (capacity ? capacity : 1) * sizeof(*index->entries));
+   index->names   = (char*)malloc(cd_size ? cd_size : 1);
+
+   if (!index->entries || !index->names)
+      goto error;
+
+   cd_ptr = buf;
+   cd_end = buf + cd_size;
+
+   while (      cd_ptr + 46 <= cd_end
+         && read_le(cd_ptr, 4) == CENTRAL_FILE_HEADER_SIGNATURE)
+   {
+      zip_index_entry_t *entry = &index->entries[index->count];
+      uint32_t namelength      = read_le(cd_ptr + 28, 2);
+      uint32_t extralength     = read_le(cd_ptr + 30, 2);
+      uint32_t commentlength   = read_le(cd_ptr + 32, 2);
+      char *name               = index->names + names_size;
+
+      if (     namelength >= PATH_MAX_LENGTH
+            || cd_ptr + 46 + namelength > cd_end)
+         goto error;
+
+      memcpy(name, cd_ptr + 46, namelength);
+      name[namelength] = '\0';
+
+      entry->name      = (uint32_t)names_size;
+      entry->hash      = zip_index_hash(name);
+      entry->cmode     = read_le(cd_ptr + 10, 2);
+      entry->crc32     = read_le(cd_ptr + 16, 4);
+      entry->csize     = read_le(cd_ptr + 20, 4);
+      entry->size      = read_le(cd_ptr + 24, 4);
+      entry->offset    = read_le(cd_ptr + 42, 4);
+
+      names_size      += namelength + 1;
+      index->count++;
+      cd_ptr          += 46 + namelength + extralength + commentlength;
+   }
+
+   free(buf);
+   buf = NULL;
+
+   for (index->bucket_mask = 15;
+         index->bucket_mask < index->count * 2; )
+      index->bucket_mask = index->bucket_mask * 2 + 1;
+
+   if (!(index->buckets = (uint32_t*)calloc(
+               index->bucket_mask + 1, sizeof(*index->buckets))))
+      goto error;
+
+   /* The first of several members with the same name wins,
+    * as it would walking the directory. */
+   for (i = 0; i < index->count; i++)
+   {
+      uint32_t slot = index->entries[i].hash & index->bucket_mask;
+
+      while (index->buckets[slot])
+         slot = (slot + 1) & index->bucket_mask;
+      index->buckets[slot] = i + 1;
+   }
+
+   return index;
+
+error:
+   if (file)
+      filestream_close(file);
+   free(buf);
+   zip_index_free(index);
+   return NULL;
+}
+
+static const zip_index_entry_t *zip_index_find(const zip_index_t *index,
+      const char *name, bool partial)
+{
+   uint32_t i;
+   uint32_t hash = zip_index_hash(name);
+   uint32_t slot = hash & index->bucket_mask;
+
+   for (; index->buckets[slot]; slot = (slot + 1) & index->bucket_mask)
+   {
+      const zip_index_entry_t *entry =
+         &index->entries[index->buckets[slot] - 1];
+
+      if (     entry->hash == hash
+            && string_is_equal(index->names + entry->name, name))
+         return entry;
+   }
+
+   if (!partial)
+      return NULL;
+
+   /* Partial names used to match as well, so keep them working
+    * the slow way. */
+   for (i = 0; i < index->count; i++)
+   {
+      const zip_index_entry_t *entry = &index->entries[i];
+      const char *member             = index->names + entry->name;
+      size_t len                     = strlen(member);
+
+      if (!len || member[len - 1] == '/' || member[len - 1] == '\\')
+         continue;
+      if (strstr(member, name))
+         return entry;
+   }
+
+   return NULL;
+}
+
+static void zip_index_release(zip_index_t *index)
+{
+   bool unused;
+
+   file_archive_cache_lock();
+   unused = --index->refs == 0;
+   file_archive_cache_unlock();
+
+   if (unused)
+      zip_index_free(index);
+}
+
+/* Index of the archive at @path, cached while
+ * file_archive_cache_enable() for as long as the archive
+ * keeps its mtime and size. Give it back with
+ * zip_index_release(). */
+static zip_index_t *zip_index_acquire(const char *path)
+{
+   char archive[PATH_MAX_LENGTH];
+   unsigned i;
+   int32_t file_size;
+   int64_t mtime;
+   char *delim         = NULL;
+   zip_index_t *index  = NULL;
+   bool cache          = file_archive_cache_is_enabled();
+
+   strlcpy(archive, path, sizeof(archive));
+   if ((delim = (char*)path_get_archive_delim(archive)))
+      *delim = '\0';
+
+   if (!path_get_size_mtime(archive, &file_size, &mtime))
+      return NULL;
+
+   if (cache)
+   {
+      file_archive_cache_lock();
+      for (i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+      {
+         zip_index_t *cached = zip_index_cache[i];
+
+         if (     cached
+               && cached->mtime     == mtime
+               && cached->file_size == file_size
+               && string_is_equal(cached->path, archive))
+         {
+            cached->refs++;
+            cached->used = ++zip_index_clock;
+            index        = cached;
+            break;
+         }
+      }
+      file_archive_cache_unlock();
+
+      if (index)
+         return index;
+   }
+
+   if (!(index = zip_index_read(archive)))
+      return NULL;
+
+   index->mtime     = mtime;
+   index->file_size = file_size;
+   index->refs      = 1;
+
+   if (cache && (index->path = strdup(archive)))
+   {
+      unsigned slot  = 0;
+      zip_index_t *evicted;
+
+      file_archive_cache_lock();
+      for (i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+      {
+         zip_index_t *cached = zip_index_cache[i];
+
+         /* Stale index of the same archive */
+         if (!cached || string_is_equal(cached->path, archive))
+         {
+            slot = i;
+            break;
+         }
+         if (cached->used < zip_index_cache[slot]->used)
+            slot = i;
+      }
+
+      evicted               = zip_index_cache[slot];
+      zip_index_cache[slot] = index;
+      index->refs++;
+      index->used           = ++zip_index_clock;
+      file_archive_cache_unlock();
+
+      if (evicted)
+         zip_index_release(evicted);
+   }
+
+   return index;
+}
+
+static void zip_index_cache_clear(void)
+{
+   unsigned i;
+
+   for (i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+   {
+      zip_index_t *cached;
+
+      file_archive_cache_lock();
+      cached             = zip_index_cache[i];
+      zip_index_cache[i] = NULL;
+      file_archive_cache_unlock();
+
+      if (cached)
+         zip_index_release(cached);
+   }
+}
+
+static bool zip_index_walk(const char *path, const char *valid_exts,
+      file_archive_file_cb file_cb,
+      struct archive_extract_userdata *userdata)
+{
+   uint32_t i;
+   zip_index_t *index = zip_index_acquire(path);
+
+   if (!index)
+      return false;
+
+   for (i = 0; i < index->count; i++)
+   {
+      const zip_index_entry_t *entry = &index->entries[i];
+      char *name                     = index->names + entry->name;
+
+      userdata->extracted_file_path  = name;
+      userdata->crc                  = entry->crc32;
+
+      if (!file_cb(name, valid_exts, NULL, entry->cmode,
+               entry->csize, entry->size, entry->crc32, userdata))
+         break;
+   }
+
+   userdata->extracted_file_path     = NULL;
+   zip_index_release(index);
+
+   return true;
+}
+
+static bool zip_index_find_member(const char *path, const char *member,
+      uint32_t *crc32, uint32_t *size)
+{
+   const zip_index_entry_t *entry = NULL;
+   zip_index_t *index             = zip_index_acquire(path);
+
+   if (!index)
+      return false;
+
+   if (!member)
+      entry = index->count ? &index->entries[0] : NULL;
+   else
+      entry = zip_index_find(index, member, false);
+
+   if (entry)
+   {
+      *crc32 = entry->crc32;
+      *size  = entry->size;
+   }
+
+   zip_index_release(index);
+
+   return entry != NULL;
+}
+
 static void *zlib_stream_new(void)
 {
    return zlib_inflate_backend.stream_new();
@@ -144,6 +547,9 @@ static bool zip_file_decompressed_handle(
             handle->stream);
    }while(ret == 0);
 
+   if (ret < 0)
+      goto error;
+
 #if 0
    handle->real_checksum = handle->backend->stream_crc_calculate(0,
          handle->data, size);
@@ -152,130 +558,124 @@ static bool zip_file_decompressed_handle(
       goto error;
 #endif
 
-   if (handle->stream)
-      free(handle->stream);
+   zlib_inflate_backend.stream_free(handle->stream);
+   handle->stream = NULL;
 
    return true;
-#if 0
+
 error:
-   if (handle->stream)
-      free(handle->stream);
-   if (handle->data)
-      free(handle->data);
+   zlib_inflate_backend.stream_free(handle->stream);
+   free(handle->data);
 
    handle->stream = NULL;
    handle->data   = NULL;
    return false;
-#endif
 }
 
-/* Extract the relative path (needle) from a
- * ZIP archive (path) and allocate a buffer for it to write it in.
- *
- * optional_outfile if not NULL will be used to extract the file to.
- * buf will be 0 then.
- */
-
-static int zip_file_decompressed(
-      const char *name, const char *valid_exts,
-      const uint8_t *cdata, unsigned cmode,
-      uint32_t csize, uint32_t size,
-      uint32_t crc32, struct archive_extract_userdata *userdata)
+/* Reads and inflates one member, seeking straight to it. */
+static uint8_t *zip_index_read_member(const char *path,
+      const zip_index_entry_t *entry)
 {
-   /* Ignore directories. */
-   if (name[strlen(name) - 1] == '/' || name[strlen(name) - 1] == '\\')
-      return 1;
-
-   if (strstr(name, userdata->decomp_state.needle))
+   uint8_t header[30];
+   file_archive_file_handle_t handle = {0};
+   uint8_t *cdata                    = NULL;
+   uint8_t *data                     = NULL;
+   RFILE *file                       = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return NULL;
+
+   /* Nothing to inflate, but still a buffer to hand out */
+   if (!entry->size)
    {
-      bool goto_error = false;
-      file_archive_file_handle_t handle = {0};
-
-      userdata->decomp_state.found = true;
-
-      if (zip_file_decompressed_handle(&handle,
-               cdata, csize, size, crc32))
-      {
-         if (userdata->decomp_state.opt_file != 0)
-         {
-            /* Called in case core has need_fullpath enabled. */
-            char *buf       = (char*)malloc(size);
-
-            if (buf)
-            {
-               memcpy(buf, handle.data, size);
-
-               if (!filestream_write_file(userdata->decomp_state.opt_file, buf, size))
-                  goto_error = true;
-            }
-
-            free(buf);
+      data = (uint8_t*)calloc(1, 1);
+      goto end;
+   }
 
-            userdata->decomp_state.size = 0;
-         }
-         else
-         {
-            /* Called in case core has need_fullpath disabled.
-             * Will copy decompressed content directly into
-             * RetroArch's ROM buffer. */
-            *userdata->decomp_state.buf = malloc(size);
-            memcpy(*userdata->decomp_state.buf, handle.data, size);
+   filestream_seek(file, entry->offset, RETRO_VFS_SEEK_POSITION_START);
+   if (     filestream_read(file, header, sizeof(header)) != sizeof(header)
+         || read_le(header, 4) != LOCAL_FILE_HEADER_SIGNATURE)
+      goto end;
 
-            userdata->decomp_state.size = size;
-         }
-      }
+   filestream_seek(file, entry->offset + sizeof(header)
+         + read_le(header + 26, 2) + read_le(header + 28, 2),
+         RETRO_VFS_SEEK_POSITION_START);
 
-      if (handle.data)
-         free(handle.data);
+   if (!(cdata = (uint8_t*)malloc(entry->csize ? entry->csize : 1)))
+      goto end;
+   if (filestream_read(file, cdata, entry->csize) != entry->csize)
+      goto end;
 
-      if (goto_error)
-         return 0;
+   switch (entry->cmode)
+   {
+      case ARCHIVE_MODE_UNCOMPRESSED:
+         /* Stored, as is */
+         if (entry->csize < entry->size)
+            goto end;
+         data  = cdata;
+         cdata = NULL;
+         break;
+      case ARCHIVE_MODE_COMPRESSED:
+         /* Inflated right into the buffer handed out */
+         if (zip_file_decompressed_handle(&handle,
+                  cdata, entry->csize, entry->size, entry->crc32))
+            data = handle.data;
+         break;
+      default:
+         break;
    }
 
-   return 1;
+end:
+   free(cdata);
+   filestream_close(file);
+   return data;
 }
 
+/* Extract the relative path (needle) from a
+ * ZIP archive (path) and allocate a buffer for it to write it in.
+ *
+ * optional_outfile if not NULL will be used to extract the file to.
+ * buf will be 0 then.
+ */
 static int zip_file_read(
       const char *path,
       const char *needle, void **buf,
       const char *optional_outfile)
 {
-   file_archive_transfer_t zlib             = {ARCHIVE_TRANSFER_NONE, 0, NULL, NULL, NULL, NULL, NULL, NULL };
-   struct archive_extract_userdata userdata = {{0}};
-   bool returnerr                           = true;
-   int ret                                  = 0;
+   const zip_index_entry_t *entry = NULL;
+   uint8_t *data                  = NULL;
+   int ret                        = -1;
+   zip_index_t *index             = zip_index_acquire(path);
 
-   zlib.type                                = ARCHIVE_TRANSFER_INIT;
-
-   userdata.decomp_state.needle             = NULL;
-   userdata.decomp_state.opt_file           = NULL;
-   userdata.decomp_state.found              = false;
-   userdata.decomp_state.buf                = buf;
+   if (!index)
+      return -1;
 
-   if (needle)
-      userdata.decomp_state.needle          = strdup(needle);
-   if (optional_outfile)
-      userdata.decomp_state.opt_file        = strdup(optional_outfile);
+   if (needle && (entry = zip_index_find(index, needle, true)))
+      data = zip_index_read_member(path, entry);
 
-   do
+   if (data)
    {
-      ret = file_archive_parse_file_iterate(&zlib, &returnerr, path,
-            "", zip_file_decompressed, &userdata);
-      if (!returnerr)
-         break;
-   }while(ret == 0 && !userdata.decomp_state.found);
-
-   file_archive_parse_file_iterate_stop(&zlib);
-
-   if (userdata.decomp_state.opt_file)
-      free(userdata.decomp_state.opt_file);
-   if (userdata.decomp_state.needle)
-      free(userdata.decomp_state.needle);
+      if (optional_outfile)
+      {
+         /* Called in case core has need_fullpath enabled. */
+         if (filestream_write_file(optional_outfile, data, entry->size))
+            ret = 0;
+         free(data);
+      }
+      else
+      {
+         /* Called in case core has need_fullpath disabled.
+          * The decompressed content goes straight into
+          * RetroArch's ROM buffer. */
+         *buf = data;
+         ret  = (int)entry->size;
+      }
+   }
 
-   if (!userdata.decomp_state.found)
-      return -1;
+   zip_index_release(index);
 
-   return (int)userdata.decomp_state.size;
+   return ret;
 }
 
 static int zip_parse_file_init(file_archive_transfer_t *state,
@@ -371,6 +771,410 @@ static int zip_parse_file_iterate_step(file_archive_transfer_t *state,
    return 1;
 }
 
+#ifndef DATA_DESCRIPTOR_SIGNATURE
+#define DATA_DESCRIPTOR_SIGNATURE 0x08074b50
+#endif
+
+/* Inflated data is written out in pieces of this size */
+#define ZIP_STREAM_OUT_SIZE (64 * 1024)
+
+enum zip_stream_part
+{
+   ZIP_STREAM_HEADER = 0,
+   ZIP_STREAM_DATA,
+   ZIP_STREAM_DESCRIPTOR,
+   ZIP_STREAM_DONE
+};
+
+/* An archive read in order, a piece at a time, with the members
+ * taken from their local headers. Each one is written next to its
+ * target as '<name>.tmp' and moved into place once the CRC checks
+ * out, so an archive that is cut short leaves the old files be. */
+typedef struct zip_stream
+{
+   char *target_dir;
+   uint8_t *buf;          /* header or data descriptor so far */
+   uint8_t *out;
+   void *inflate;
+   RFILE *file;
+   size_t buf_len;
+   size_t buf_cap;
+   uint32_t flags;
+   uint32_t cmode;
+   uint32_t crc32;
+   uint32_t real_crc32;
+   uint32_t remaining;    /* compressed bytes left, when sized */
+   bool sized;
+   enum zip_stream_part part;
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+} zip_stream_t;
+
+/* Collects input into buf until it holds 'need' bytes.
+ * Returns -1 on allocation failure, 1 once complete. */
+static int zip_stream_gather(zip_stream_t *zs,
+      const uint8_t **data, size_t *len, size_t need)
+{
+   size_t take;
+
+   if (zs->buf_cap < need)
+   {
+      uint8_t *buf = (uint8_t*)realloc(zs->buf, need);
+
+      if (!buf)
+         return -1;
+
+      zs->buf     = buf;
+      zs->buf_cap = need;
+   }
+
+   take = MIN(*len, need - zs->buf_len);
+   memcpy(zs->buf + zs->buf_len, *data, take);
+
+   zs->buf_len += take;
+   *data       += take;
+   *len        -= take;
+
+   return zs->buf_len == need;
+}
+
+/* Keeps members from being written outside of the target */
+static bool zip_stream_name_is_safe(const char *name)
+{
+   const char *s = name;
+
+   if (*name == '/' || *name == '\\' || strchr(name, ':'))
+      return false;
+
+   while (*s)
+   {
+      size_t len = strcspn(s, "/\\");
+
+      if (len == 2 && s[0] == '.' && s[1] == '.')
+         return false;
+
+      s += len;
+      if (*s)
+         s++;
+   }
+
+   return true;
+}
+
+static void zip_stream_close_entry(zip_stream_t *zs)
+{
+   if (zs->inflate)
+      zlib_inflate_backend.stream_free(zs->inflate);
+   zs->inflate = NULL;
+
+   if (zs->file)
+   {
+      filestream_close(zs->file);
+      filestream_delete(zs->tmp_path);
+   }
+   zs->file = NULL;
+}
+
+static bool zip_stream_begin_entry(zip_stream_t *zs)
+{
+   char name[PATH_MAX_LENGTH];
+   uint32_t csize   = read_le(zs->buf + 18, 4);
+   uint32_t size    = read_le(zs->buf + 22, 4);
+   unsigned namelen = read_le(zs->buf + 26, 2);
+   size_t name_end;
+
+   zs->flags      = read_le(zs->buf + 6, 2);
+   zs->cmode      = read_le(zs->buf + 8, 2);
+   zs->crc32      = read_le(zs->buf + 14, 4);
+   /* Bit 3: sizes and CRC follow the data instead */
+   zs->sized      = !(zs->flags & 8);
+   zs->remaining  = csize;
+   zs->real_crc32 = 0;
+
+   /* Encrypted, ZIP64 or a stored member of unknown size
+    * can't be taken apart on the fly */
+   if (     (zs->flags & 1)
+         || (zs->sized && (csize == 0xffffffff || size == 0xffffffff))
+         || (zs->cmode != ARCHIVE_MODE_UNCOMPRESSED
+            && zs->cmode != ARCHIVE_MODE_COMPRESSED)
+         || (zs->cmode == ARCHIVE_MODE_UNCOMPRESSED && !zs->sized)
+         || namelen == 0 || namelen >= sizeof(name))
+      return false;
+
+   memcpy(name, zs->buf + 30, namelen);
+   name[namelen] = '\0';
+
+   if (!zip_stream_name_is_safe(name))
+      return false;
+
+   fill_pathname_join(zs->path, zs->target_dir, name, sizeof(zs->path));
+
+   name_end = namelen - 1;
+   if (name[name_end] == '/' || name[name_end] == '\\')
+   {
+      if (!path_mkdir(zs->path))
+         return false;
+   }
+   else
+   {
+      char dir[PATH_MAX_LENGTH];
+
+      strlcpy(dir, zs->path, sizeof(dir));
+      path_basedir_wrapper(dir);
+
+      if (!path_mkdir(dir))
+         return false;
+
+      strlcpy(zs->tmp_path, zs->path, sizeof(zs->tmp_path));
+      strlcat(zs->tmp_path, ".tmp",   sizeof(zs->tmp_path));
+
+      zs->file = filestream_open(zs->tmp_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (!zs->file)
+         return false;
+   }
+
+   if (zs->cmode == ARCHIVE_MODE_COMPRESSED)
+   {
+      zs->inflate = zlib_inflate_backend.stream_new();
+
+      if (!zs->inflate)
+         return false;
+
+      zlib_inflate_backend.define(zs->inflate,
+            "window_bits", (uint32_t)-MAX_WBITS);
+   }
+
+   zs->part = ZIP_STREAM_DATA;
+   return true;
+}
+
+static bool zip_stream_end_entry(zip_stream_t *zs)
+{
+   if (zs->inflate)
+      zlib_inflate_backend.stream_free(zs->inflate);
+   zs->inflate = NULL;
+
+   if (zs->file)
+   {
+      bool ok  = filestream_close(zs->file) == 0
+         && zs->real_crc32 == zs->crc32;
+
+      zs->file = NULL;
+
+      if (!ok)
+      {
+         filestream_delete(zs->tmp_path);
+         return false;
+      }
+
+      if (filestream_exists(zs->path))
+         filestream_delete(zs->path);
+
+      if (filestream_rename(zs->tmp_path, zs->path) != 0)
+         return false;
+   }
+
+   zs->part    = ZIP_STREAM_HEADER;
+   zs->buf_len = 0;
+   return true;
+}
+
+static bool zip_stream_output(zip_stream_t *zs,
+      const uint8_t *data, size_t len)
+{
+   zs->real_crc32 = encoding_crc32(zs->real_crc32, data, len);
+
+   return !zs->file || filestream_write(zs->file, data, len) == (int64_t)len;
+}
+
+/* Inflates what there is of the member. 'used' gets how much of
+ * the input went in, 'ended' whether the deflate stream did. */
+static bool zip_stream_inflate(zip_stream_t *zs,
+      const uint8_t *data, size_t len, size_t *used, bool *ended)
+{
+   *used  = 0;
+   *ended = false;
+
+   zlib_inflate_backend.set_in(zs->inflate, data, (uint32_t)len);
+
+   for (;;)
+   {
+      uint32_t rd = 0;
+      uint32_t wn = 0;
+      enum trans_stream_error terror;
+      bool ok;
+
+      zlib_inflate_backend.set_out(zs->inflate, zs->out, ZIP_STREAM_OUT_SIZE);
+      ok = zlib_inflate_backend.trans(zs->inflate, false, &rd, &wn, &terror);
+
+      /* With all input taken, the only failure left
+       * is having nothing more to put out */
+      if (!ok && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
+         return *used == len;
+
+      *used += rd;
+
+      if (wn && !zip_stream_output(zs, zs->out, wn))
+         return false;
+
+      if (ok && terror == TRANS_STREAM_ERROR_NONE)
+      {
+         *ended = true;
+         return true;
+      }
+
+      if (*used == len && wn < ZIP_STREAM_OUT_SIZE)
+         return true;
+   }
+}
+
+static bool zip_stream_data(zip_stream_t *zs,
+      const uint8_t **data, size_t *len)
+{
+   size_t take = zs->sized ? MIN(*len, zs->remaining) : *len;
+   size_t used = take;
+   bool ended  = zs->sized && take == zs->remaining;
+
+   if (zs->cmode == ARCHIVE_MODE_COMPRESSED)
+   {
+      if (!zip_stream_inflate(zs, *data, take, &used, &ended))
+         return false;
+
+      /* The deflate stream has to end with the member */
+      if (zs->sized && ended != (used == zs->remaining))
+         return false;
+   }
+   else if (!zip_stream_output(zs, *data, take))
+      return false;
+
+   *data         += used;
+   *len          -= used;
+   zs->remaining -= (uint32_t)used;
+
+   if (!ended)
+      return true;
+
+   if (zs->flags & 8)
+   {
+      zs->part    = ZIP_STREAM_DESCRIPTOR;
+      zs->buf_len = 0;
+      return true;
+   }
+
+   return zip_stream_end_entry(zs);
+}
+
+static void *zip_extract_stream_new(const char *target_dir)
+{
+   zip_stream_t *zs = (zip_stream_t*)calloc(1, sizeof(*zs));
+
+   if (!zs)
+      return NULL;
+
+   zs->target_dir = strdup(target_dir);
+   zs->out        = (uint8_t*)malloc(ZIP_STREAM_OUT_SIZE);
+
+   if (!zs->target_dir || !zs->out)
+   {
+      free(zs->target_dir);
+      free(zs->out);
+      free(zs);
+      return NULL;
+   }
+
+   return zs;
+}
+
+static bool zip_extract_stream_write(void *state,
+      const uint8_t *data, size_t len)
+{
+   zip_stream_t *zs = (zip_stream_t*)state;
+
+   while (len && zs->part != ZIP_STREAM_DONE)
+   {
+      int ret;
+
+      switch (zs->part)
+      {
+         case ZIP_STREAM_HEADER:
+            ret = zip_stream_gather(zs, &data, &len,
+                  zs->buf_len < 4 ? 4 : zs->buf_len < 30 ? 30
+                  : 30 + read_le(zs->buf + 26, 2) + read_le(zs->buf + 28, 2));
+
+            if (ret < 0)
+               return false;
+            if (!ret)
+               break;
+
+            if (zs->buf_len == 4)
+            {
+               uint32_t signature = read_le(zs->buf, 4);
+
+               /* The central directory holds nothing new */
+               if (     signature == CENTRAL_FILE_HEADER_SIGNATURE
+                     || signature == END_OF_CENTRAL_DIR_SIGNATURE)
+                  zs->part = ZIP_STREAM_DONE;
+               else if (signature != LOCAL_FILE_HEADER_SIGNATURE)
+                  return false;
+            }
+            /* Members always have a name, so done past 30 */
+            else if (zs->buf_len == 30 && !read_le(zs->buf + 26, 2))
+               return false;
+            else if (zs->buf_len > 30)
+            {
+               if (!zip_stream_begin_entry(zs))
+                  return false;
+
+               /* Directories and empty files */
+               if (zs->sized && !zs->remaining
+                     && !zip_stream_end_entry(zs))
+                  return false;
+            }
+            break;
+         case ZIP_STREAM_DATA:
+            if (!zip_stream_data(zs, &data, &len))
+               return false;
+            break;
+         case ZIP_STREAM_DESCRIPTOR:
+            ret = zip_stream_gather(zs, &data, &len,
+                  zs->buf_len < 4 ? 4
+                  : read_le(zs->buf, 4) == DATA_DESCRIPTOR_SIGNATURE ? 16 : 12);
+
+            if (ret < 0)
+               return false;
+            if (!ret || zs->buf_len == 4)
+               break;
+
+            zs->crc32 = read_le(zs->buf + zs->buf_len - 12, 4);
+
+            if (!zip_stream_end_entry(zs))
+               return false;
+            break;
+         default:
+            break;
+      }
+   }
+
+   return true;
+}
+
+static bool zip_extract_stream_free(void *state)
+{
+   zip_stream_t *zs = (zip_stream_t*)state;
+   bool complete    = zs->part == ZIP_STREAM_DONE;
+
+   zip_stream_close_entry(zs);
+
+   free(zs->target_dir);
+   free(zs->buf);
+   free(zs->out);
+   free(zs);
+
+   return complete;
+}
+
 const struct file_archive_file_backend zlib_backend = {
    zlib_stream_new,
    zlib_stream_free,
@@ -380,5 +1184,11 @@ const struct file_archive_file_backend zlib_backend = {
    zip_file_read,
    zip_parse_file_init,
    zip_parse_file_iterate_step,
-   "zlib"
+   "zlib",
+   zip_index_walk,
+   zip_index_find_member,
+   zip_index_cache_clear,
+   zip_extract_stream_new,
+   zip_extract_stream_write,
+   zip_extract_stream_free
 };
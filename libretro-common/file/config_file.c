@@ -54,6 +54,7 @@ struct config_entry_list
     * do not allow overwrite. */
    bool readonly;
 
+   uint32_t hash;
    char *key;
    char *value;
    struct config_entry_list *next;
@@ -68,6 +69,109 @@ struct config_include_list
 static config_file_t *config_file_new_internal(
       const char *path, unsigned depth, config_file_cb_t *cb);
 
+static uint32_t config_key_hash(const char *key)
+{
+   uint32_t hash = 5381;
+
+   while (*key)
+      hash = (hash << 5) + hash + (uint8_t)*key++;
+
+   return hash;
+}
+
+static void config_index_init(config_file_t *conf)
+{
+   conf->index_valid = true;
+   conf->index       = NULL;
+   conf->index_cap   = 0;
+   conf->index_count = 0;
+}
+
+static bool config_index_grow(config_file_t *conf)
+{
+   size_t i;
+   size_t cap                              = conf->index_cap
+      ? conf->index_cap * 2 : 64;
+   struct config_entry_list **index        = (struct config_entry_list**)
+      calloc(cap, sizeof(*index));
+
+   if (!index)
+      return false;
+
+   for (i = 0; i < conf->index_cap; i++)
+   {
+      struct config_entry_list *entry = conf->index[i];
+      size_t slot;
+
+      if (!entry)
+         continue;
+
+      for (slot = entry->hash & (cap - 1); index[slot];
+            slot = (slot + 1) & (cap - 1));
+      index[slot] = entry;
+   }
+
+   free(conf->index);
+   conf->index     = index;
+   conf->index_cap = cap;
+   return true;
+}
+
+/* Entries are only ever added behind the existing ones, so the
+ * first one seen for a key stays the one config_get_entry()
+ * returns. Anything that reorders or drops entries clears
+ * 'index_valid' instead, and the next lookup rebuilds it. */
+static void config_index_insert(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t slot;
+
+   if (!conf->index_valid || !entry->key)
+      return;
+
+   if ((conf->index_count + 1) * 2 > conf->index_cap
+         && !config_index_grow(conf))
+   {
+      conf->index_valid = false;
+      return;
+   }
+
+   entry->hash = config_key_hash(entry->key);
+
+   for (slot = entry->hash & (conf->index_cap - 1); conf->index[slot];
+         slot = (slot + 1) & (conf->index_cap - 1))
+   {
+      const struct config_entry_list *other = conf->index[slot];
+
+      if (other->hash == entry->hash
+            && string_is_equal(other->key, entry->key))
+         return;
+   }
+
+   conf->index[slot] = entry;
+   conf->index_count++;
+}
+
+static bool config_index_build(config_file_t *conf)
+{
+   struct config_entry_list *entry = NULL;
+
+   if (conf->index_valid)
+      return true;
+
+   if (conf->index)
+      memset(conf->index, 0, conf->index_cap * sizeof(*conf->index));
+
+   conf->index_count = 0;
+   conf->index_valid = true;
+
+   for (entry = conf->entries; entry && conf->index_valid;
+         entry = entry->next)
+      config_index_insert(conf, entry);
+
+   return conf->index_valid;
+}
+
 static int config_sort_compare_func(struct config_entry_list *a,
       struct config_entry_list *b)
 {
@@ -236,6 +340,7 @@ static void add_child_list(config_file_t *parent, config_file_t *child)
       while (list)
       {
          list->readonly = true;
+         config_index_insert(parent, list);
          list           = list->next;
       }
       head->next        = child->entries;
@@ -246,6 +351,7 @@ static void add_child_list(config_file_t *parent, config_file_t *child)
       while (list)
       {
          list->readonly = true;
+         config_index_insert(parent, list);
          list           = list->next;
       }
       parent->entries   = child->entries;
@@ -410,6 +516,8 @@ static config_file_t *config_file_new_internal(
    conf->includes                 = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false ;
+   conf->modified                 = false;
+   config_index_init(conf);
 
    if (!path || !*path)
       return conf;
@@ -465,6 +573,7 @@ static config_file_t *config_file_new_internal(
             conf->entries = list;
 
          conf->tail = list;
+         config_index_insert(conf, list);
 
          if (cb != NULL && list->key != NULL && list->value != NULL)
             cb->config_file_new_entry_cb(list->key, list->value) ;
@@ -524,6 +633,7 @@ void config_file_free(config_file_t *conf)
 
    if (conf->path)
       free(conf->path);
+   free(conf->index);
    free(conf);
 }
 
@@ -536,7 +646,10 @@ bool config_append_file(config_file_t *conf, const char *path)
    if (new_conf->tail)
    {
       new_conf->tail->next = conf->entries;
+      if (!conf->entries)
+         conf->tail        = new_conf->tail;
       conf->entries        = new_conf->entries; /* Pilfer. */
+      conf->index_valid    = false;
       new_conf->entries    = NULL;
    }
 
@@ -553,9 +666,6 @@ config_file_t *config_file_new_from_string(const char *from_string)
    if (!conf)
       return NULL;
 
-   if (!from_string)
-      return conf;
-
    conf->path                     = NULL;
    conf->entries                  = NULL;
    conf->tail                     = NULL;
@@ -563,6 +673,11 @@ config_file_t *config_file_new_from_string(const char *from_string)
    conf->includes                 = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false ;
+   conf->modified                 = false;
+   config_index_init(conf);
+
+   if (!from_string)
+      return conf;
 
    lines = string_split(from_string, "\n");
    if (!lines)
@@ -595,6 +710,7 @@ config_file_t *config_file_new_from_string(const char *from_string)
                conf->entries = list;
 
             conf->tail = list;
+            config_index_insert(conf, list);
          }
       }
 
@@ -616,29 +732,43 @@ config_file_t *config_file_new(const char *path)
    return config_file_new_internal(path, 0, NULL);
 }
 
-static struct config_entry_list *config_get_entry(const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
+static struct config_entry_list *config_get_entry(config_file_t *conf,
+      const char *key)
 {
-   struct config_entry_list *entry    = NULL;
-   struct config_entry_list *previous = prev ? *prev : NULL;
+   struct config_entry_list *entry = NULL;
 
-   for (entry = conf->entries; entry; entry = entry->next)
+   if (!key)
+      return NULL;
+
+   if (config_index_build(conf))
    {
-      if (string_is_equal(key, entry->key))
-         return entry;
+      size_t slot;
+      uint32_t hash = config_key_hash(key);
 
-      previous = entry;
+      if (!conf->index_cap)
+         return NULL;
+
+      for (slot = hash & (conf->index_cap - 1);
+            (entry = conf->index[slot]);
+            slot = (slot + 1) & (conf->index_cap - 1))
+      {
+         if (entry->hash == hash && string_is_equal(key, entry->key))
+            return entry;
+      }
+
+      return NULL;
    }
 
-   if (prev)
-      *prev = previous;
+   for (entry = conf->entries; entry; entry = entry->next)
+      if (string_is_equal(key, entry->key))
+         return entry;
 
    return NULL;
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -651,7 +781,7 @@ bool config_get_double(config_file_t *conf, const char *key, double *in)
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -664,7 +794,7 @@ bool config_get_float(config_file_t *conf, const char *key, float *in)
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -683,7 +813,7 @@ bool config_get_int(config_file_t *conf, const char *key, int *in)
 
 bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -702,7 +832,7 @@ bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 #if defined(__STDC_VERSION__) && __STDC_VERSION__>=199901L
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -721,7 +851,7 @@ bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -740,7 +870,7 @@ bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -759,7 +889,7 @@ bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -775,7 +905,7 @@ bool config_get_char(config_file_t *conf, const char *key, char *in)
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -796,7 +926,7 @@ bool config_get_config_path(config_file_t *conf, char *s, size_t len)
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       return strlcpy(buf, entry->value, size) < size;
@@ -810,7 +940,7 @@ bool config_get_path(config_file_t *conf, const char *key,
    if (config_get_array(conf, key, buf, size))
       return true;
 #else
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -823,7 +953,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -844,13 +974,16 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = (conf->guaranteed_no_duplicates && conf->last) ? conf->last : conf->entries;
-   struct config_entry_list *entry = conf->guaranteed_no_duplicates?NULL:config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = conf->guaranteed_no_duplicates
+      ? NULL : config_get_entry(conf, key);
 
    if (entry && !entry->readonly)
    {
+      if (entry->value && val && string_is_equal(entry->value, val))
+         return;
       free(entry->value);
-      entry->value = strdup(val);
+      entry->value   = strdup(val);
+      conf->modified = true;
       return;
    }
 
@@ -866,27 +999,32 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
    entry->value     = strdup(val);
    entry->next      = NULL;
 
-   if (last)
-      last->next    = entry;
+   if (conf->tail)
+      conf->tail->next = entry;
    else
-      conf->entries = entry;
-
-   conf->last = entry ;
+      conf->entries    = entry;
 
+   conf->tail     = entry;
+   conf->last     = entry;
+   conf->modified = true;
+   config_index_insert(conf, entry);
 }
 
 void config_unset(config_file_t *conf, const char *key)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (!entry)
       return;
 
-   entry->key   = NULL;
-   entry->value = NULL;
    free(entry->key);
    free(entry->value);
+   entry->key        = NULL;
+   entry->value      = NULL;
+
+   /* A later entry with the same key may show through now. */
+   conf->index_valid = false;
+   conf->modified    = true;
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -980,8 +1118,17 @@ bool config_file_write(config_file_t *conf, const char *path)
 {
    if (!string_is_empty(path))
    {
+      char tmp_path[PATH_MAX_LENGTH];
+      bool ok    = false;
       void* buf  = NULL;
-      FILE *file = (FILE*)fopen_utf8(path, "wb");
+      FILE *file = NULL;
+
+      /* Written next to the real file and renamed over it, so a crash
+       * or power loss halfway through leaves the old one intact */
+      strlcpy(tmp_path, path, sizeof(tmp_path));
+      strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+      file = (FILE*)fopen_utf8(tmp_path, "wb");
       if (!file)
          return false;
 
@@ -991,9 +1138,26 @@ bool config_file_write(config_file_t *conf, const char *path)
 
       config_file_dump(conf, file);
 
-      if (file != stdout)
-         fclose(file);
+      ok = !ferror(file);
+      ok = fclose(file) == 0 && ok;
       free(buf);
+
+      if (ok)
+      {
+#ifdef _WIN32
+         /* rename() won't replace an existing file there */
+         filestream_delete(path);
+#endif
+         ok = filestream_rename(tmp_path, path) == 0;
+      }
+
+      if (!ok)
+      {
+         filestream_delete(tmp_path);
+         return false;
+      }
+
+      conf->modified = false;
    }
    else
       config_file_dump(conf, stdout);
@@ -1013,28 +1177,22 @@ void config_file_dump(config_file_t *conf, FILE *file)
    }
 
    list = merge_sort_linked_list((struct config_entry_list*)conf->entries, config_sort_compare_func);
-   conf->entries = list;
+   conf->entries     = list;
+   conf->tail        = NULL;
+   conf->index_valid = false;
 
    while (list)
    {
       if (!list->readonly && list->key)
          fprintf(file, "%s = \"%s\"\n", list->key, list->value);
-      list = list->next;
+      conf->tail = list;
+      list       = list->next;
    }
 }
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (string_is_equal(entry, list->key))
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
@@ -112,7 +112,8 @@ enum stat_mode
    IS_VALID
 };
 
-static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
+static bool path_stat(const char *path, enum stat_mode mode, int32_t *size,
+      int64_t *mtime)
 {
 #if defined(VITA) || defined(PSP)
    SceIoStat buf;
@@ -189,6 +190,14 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
 #else
       *size = (int32_t)buf.st_size;
 #endif
+
+   /* Only where it's a plain time_t */
+   if (mtime)
+#if defined(VITA) || defined(PSP) || defined(PS2)
+      *mtime = -1;
+#else
+      *mtime = (int64_t)buf.st_mtime;
+#endif
    switch (mode)
    {
       case IS_DIRECTORY:
@@ -226,28 +235,49 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
  */
 bool path_is_directory(const char *path)
 {
-   return path_stat(path, IS_DIRECTORY, NULL);
+   return path_stat(path, IS_DIRECTORY, NULL, NULL);
 }
 
 bool path_is_character_special(const char *path)
 {
-   return path_stat(path, IS_CHARACTER_SPECIAL, NULL);
+   return path_stat(path, IS_CHARACTER_SPECIAL, NULL, NULL);
 }
 
 bool path_is_valid(const char *path)
 {
-   return path_stat(path, IS_VALID, NULL);
+   return path_stat(path, IS_VALID, NULL, NULL);
 }
 
 int32_t path_get_size(const char *path)
 {
    int32_t filesize = 0;
-   if (path_stat(path, IS_VALID, &filesize))
+   if (path_stat(path, IS_VALID, &filesize, NULL))
       return filesize;
 
    return -1;
 }
 
+int64_t path_get_mtime(const char *path)
+{
+   int64_t mtime = -1;
+   if (path_stat(path, IS_VALID, NULL, &mtime))
+      return mtime;
+
+   return -1;
+}
+
+bool path_get_size_mtime(const char *path, int32_t *size, int64_t *mtime)
+{
+   *size  = 0;
+   *mtime = -1;
+   if (path_stat(path, IS_VALID, size, mtime))
+      return true;
+
+   *size  = -1;
+   *mtime = -1;
+   return false;
+}
+
 static bool path_mkdir_error(int ret)
 {
 #if defined(VITA)
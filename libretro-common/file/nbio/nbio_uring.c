@@ -0,0 +1,554 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (nbio_uring.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <file/nbio.h>
+
+#if defined(__linux__) && defined(HAVE_IO_URING)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+/* Requests a handle keeps in flight at most */
+#define NBIO_URING_ENTRIES 16
+
+/* Transfers are split into requests of this size, all submitted
+ * together, so the device sees a deep queue even for one file. */
+#define NBIO_URING_CHUNK   (128 * 1024)
+
+struct nbio_uring_slot
+{
+   struct iovec iov;
+   size_t offset;
+};
+
+struct nbio_uring_t
+{
+   int fd;
+   int ring_fd; /* -1 without io_uring, everything is done with pread() */
+
+   void *sq_ptr;
+   void *cq_ptr;
+   size_t sq_size;
+   size_t cq_size;
+   struct io_uring_sqe *sqes;
+   size_t sqes_size;
+   struct io_uring_cqe *cqes;
+   unsigned *sq_tail;
+   unsigned *sq_array;
+   unsigned *cq_head;
+   unsigned *cq_tail;
+   unsigned sq_mask;
+   unsigned cq_mask;
+
+   struct nbio_uring_slot slots[NBIO_URING_ENTRIES];
+   unsigned free_slots;  /* bitmask */
+   unsigned inflight;
+
+   void *ptr;
+   size_t len;
+   size_t queued;        /* bytes handed to a request so far */
+   signed char op;       /* NBIO_READ, NBIO_WRITE or -1 when idle */
+   signed char mode;
+};
+
+/* No liburing, for the same reason nbio_linux does without
+ * libaio: three syscalls are all it takes. */
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+   return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int io_uring_enter(int fd, unsigned to_submit,
+      unsigned min_complete, unsigned flags)
+{
+   return (int)syscall(__NR_io_uring_enter, fd, to_submit,
+         min_complete, flags, NULL, 0);
+}
+
+static void nbio_uring_ring_free(struct nbio_uring_t *handle)
+{
+   if (handle->sqes)
+      munmap(handle->sqes, handle->sqes_size);
+   if (handle->cq_ptr && handle->cq_ptr != handle->sq_ptr)
+      munmap(handle->cq_ptr, handle->cq_size);
+   if (handle->sq_ptr)
+      munmap(handle->sq_ptr, handle->sq_size);
+   if (handle->ring_fd >= 0)
+      close(handle->ring_fd);
+
+   handle->sqes    = NULL;
+   handle->cq_ptr  = NULL;
+   handle->sq_ptr  = NULL;
+   handle->ring_fd = -1;
+}
+
+static bool nbio_uring_ring_init(struct nbio_uring_t *handle)
+{
+   struct io_uring_params p;
+   uint8_t *sq;
+   uint8_t *cq;
+
+   memset(&p, 0, sizeof(p));
+
+   /* Older kernels, or sandboxes filtering the syscall */
+   if ((handle->ring_fd = io_uring_setup(NBIO_URING_ENTRIES, &p)) < 0)
+   {
+      handle->ring_fd = -1;
+      return false;
+   }
+
+   handle->sq_size   = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+   handle->cq_size   = p.cq_off.cqes
+      + p.cq_entries * sizeof(struct io_uring_cqe);
+   handle->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+   if (p.features & IORING_FEAT_SINGLE_MMAP)
+   {
+      if (handle->cq_size > handle->sq_size)
+         handle->sq_size = handle->cq_size;
+      handle->cq_size    = handle->sq_size;
+   }
+#endif
+
+   handle->sq_ptr = mmap(NULL, handle->sq_size, PROT_READ | PROT_WRITE,
+         MAP_SHARED | MAP_POPULATE, handle->ring_fd, IORING_OFF_SQ_RING);
+   if (handle->sq_ptr == MAP_FAILED)
+   {
+      handle->sq_ptr = NULL;
+      goto error;
+   }
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+   if (p.features & IORING_FEAT_SINGLE_MMAP)
+      handle->cq_ptr = handle->sq_ptr;
+   else
+#endif
+   {
+      handle->cq_ptr = mmap(NULL, handle->cq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, handle->ring_fd, IORING_OFF_CQ_RING);
+      if (handle->cq_ptr == MAP_FAILED)
+      {
+         handle->cq_ptr = NULL;
+         goto error;
+      }
+   }
+
+   handle->sqes = (struct io_uring_sqe*)mmap(NULL, handle->sqes_size,
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+         handle->ring_fd, IORING_OFF_SQES);
+   if (handle->sqes == MAP_FAILED)
+   {
+      handle->sqes = NULL;
+      goto error;
+   }
+
+   sq                = (uint8_t*)handle->sq_ptr;
+   cq                = (uint8_t*)handle->cq_ptr;
+   handle->sq_tail   = (unsigned*)(sq + p.sq_off.tail);
+   handle->sq_array  = (unsigned*)(sq + p.sq_off.array);
+   handle->sq_mask   = *(unsigned*)(sq + p.sq_off.ring_mask);
+   handle->cq_head   = (unsigned*)(cq + p.cq_off.head);
+   handle->cq_tail   = (unsigned*)(cq + p.cq_off.tail);
+   handle->cq_mask   = *(unsigned*)(cq + p.cq_off.ring_mask);
+   handle->cqes      = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+
+   return true;
+
+error:
+   nbio_uring_ring_free(handle);
+   return false;
+}
+
+/* Blocking transfer of what a request couldn't do. */
+static void nbio_uring_sync(struct nbio_uring_t *handle,
+      size_t offset, size_t len)
+{
+   while (len)
+   {
+      ssize_t ret;
+      uint8_t *ptr = (uint8_t*)handle->ptr + offset;
+
+      if (handle->op == NBIO_WRITE)
+         ret = pwrite(handle->fd, ptr, len, (off_t)offset);
+      else
+         ret = pread(handle->fd, ptr, len, (off_t)offset);
+
+      if (ret < 0 && errno == EINTR)
+         continue;
+      if (ret <= 0)
+         return;
+
+      offset += ret;
+      len    -= ret;
+   }
+}
+
+static void nbio_uring_queue(struct nbio_uring_t *handle,
+      unsigned slot_index)
+{
+   struct nbio_uring_slot *slot = &handle->slots[slot_index];
+   unsigned tail                = *handle->sq_tail;
+   unsigned index               = tail & handle->sq_mask;
+   struct io_uring_sqe *sqe     = &handle->sqes[index];
+
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode                  = handle->op == NBIO_WRITE
+      ? IORING_OP_WRITEV : IORING_OP_READV;
+   sqe->fd                      = handle->fd;
+   sqe->addr                    = (uint64_t)(uintptr_t)&slot->iov;
+   sqe->len                     = 1;
+   sqe->off                     = slot->offset;
+   sqe->user_data               = slot_index;
+
+   handle->sq_array[index]      = index;
+   __atomic_store_n(handle->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/* Hands out the rest of the transfer in chunks, as far as there
+ * are free slots, and submits them along with @queued requests
+ * already in the ring. */
+static void nbio_uring_submit(struct nbio_uring_t *handle,
+      unsigned queued, unsigned min_complete)
+{
+   while (handle->free_slots && handle->queued < handle->len)
+   {
+      unsigned slot_index          = __builtin_ctz(handle->free_slots);
+      struct nbio_uring_slot *slot = &handle->slots[slot_index];
+      size_t amount                = handle->len - handle->queued;
+
+      if (amount > NBIO_URING_CHUNK)
+         amount = NBIO_URING_CHUNK;
+
+      slot->offset       = handle->queued;
+      slot->iov.iov_base = (uint8_t*)handle->ptr + handle->queued;
+      slot->iov.iov_len  = amount;
+      handle->free_slots &= ~(1u << slot_index);
+      handle->queued    += amount;
+
+      nbio_uring_queue(handle, slot_index);
+      queued++;
+   }
+
+   handle->inflight += queued;
+
+   while (queued || min_complete)
+   {
+      int ret = io_uring_enter(handle->ring_fd, queued, min_complete,
+            min_complete ? IORING_ENTER_GETEVENTS : 0);
+
+      if (ret < 0)
+      {
+         if (errno == EINTR || errno == EAGAIN)
+            continue;
+         /* The ring never holds more than it has room for, the
+          * kernel won't refuse these for any other reason. */
+         puts("ERROR - io_uring_enter() failed");
+         abort();
+      }
+
+      queued      -= (unsigned)ret < queued ? (unsigned)ret : queued;
+      min_complete = 0;
+   }
+}
+
+/* Reaps completions, requeueing short transfers. Returns how
+ * many requests it put back in the ring. */
+static unsigned nbio_uring_reap(struct nbio_uring_t *handle)
+{
+   unsigned requeued = 0;
+   unsigned head     = *handle->cq_head;
+   unsigned tail     = __atomic_load_n(handle->cq_tail, __ATOMIC_ACQUIRE);
+
+   for (; head != tail; head++)
+   {
+      struct io_uring_cqe *cqe     = &handle->cqes[head & handle->cq_mask];
+      unsigned slot_index          = (unsigned)cqe->user_data;
+      struct nbio_uring_slot *slot = &handle->slots[slot_index];
+      int res                      = cqe->res;
+
+      if (res > 0 && (size_t)res < slot->iov.iov_len)
+      {
+         slot->offset       += res;
+         slot->iov.iov_base  = (uint8_t*)slot->iov.iov_base + res;
+         slot->iov.iov_len  -= res;
+         nbio_uring_queue(handle, slot_index);
+         requeued++;
+         continue;
+      }
+
+      if (res != (int)slot->iov.iov_len)
+         nbio_uring_sync(handle, slot->offset, slot->iov.iov_len);
+
+      handle->free_slots |= 1u << slot_index;
+      handle->inflight--;
+   }
+
+   __atomic_store_n(handle->cq_head, head, __ATOMIC_RELEASE);
+
+   handle->inflight -= requeued;
+   return requeued;
+}
+
+/* Waits for everything in flight, for the buffer to be ours again. */
+static void nbio_uring_drain(struct nbio_uring_t *handle)
+{
+   size_t len = handle->len;
+
+   /* Nothing new gets handed out. */
+   handle->len = handle->queued;
+
+   while (handle->inflight)
+   {
+      unsigned requeued = nbio_uring_reap(handle);
+      if (requeued || handle->inflight)
+         nbio_uring_submit(handle, requeued, 1);
+   }
+
+   handle->len = len;
+}
+
+static void *nbio_uring_open(const char * filename, unsigned mode)
+{
+   static const int o_flags[]  =   { O_RDONLY, O_RDWR|O_CREAT|O_TRUNC, O_RDWR, O_RDONLY, O_RDWR|O_CREAT|O_TRUNC };
+
+   struct nbio_uring_t* handle = NULL;
+   off_t len                   = 0;
+   int fd                      = open(filename, o_flags[mode]|O_CLOEXEC, 0644);
+
+   if (fd < 0)
+      return NULL;
+
+   if (mode != NBIO_WRITE && mode != BIO_WRITE)
+      len = lseek(fd, 0, SEEK_END);
+
+   handle             = (struct nbio_uring_t*)calloc(1, sizeof(*handle));
+
+   if (!handle || len < 0)
+      goto error;
+
+   handle->fd         = fd;
+   handle->len        = (size_t)len;
+   handle->op         = -1;
+   handle->mode       = mode;
+   handle->free_slots = (1u << NBIO_URING_ENTRIES) - 1;
+
+   if (handle->len && !(handle->ptr = malloc(handle->len)))
+      goto error;
+
+   nbio_uring_ring_init(handle);
+
+   return handle;
+
+error:
+   free(handle);
+   close(fd);
+   return NULL;
+}
+
+static void nbio_uring_begin_op(struct nbio_uring_t *handle, signed char op)
+{
+   if (handle->op >= 0)
+   {
+      puts("ERROR - attempted file operation while busy");
+      abort();
+   }
+
+   handle->op     = op;
+   handle->queued = 0;
+
+   if (handle->ring_fd >= 0)
+      nbio_uring_submit(handle, 0, 0);
+}
+
+static void nbio_uring_begin_read(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, NBIO_READ);
+}
+
+static void nbio_uring_begin_write(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (handle)
+      nbio_uring_begin_op(handle, NBIO_WRITE);
+}
+
+static bool nbio_uring_iterate(void *data)
+{
+   bool blocking               = false;
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+
+   if (!handle)
+      return false;
+   if (handle->op < 0)
+      return true;
+
+   blocking = handle->mode == BIO_READ || handle->mode == BIO_WRITE;
+
+   if (handle->ring_fd < 0)
+   {
+      size_t amount = handle->len - handle->queued;
+
+      if (!blocking && amount > NBIO_URING_CHUNK)
+         amount = NBIO_URING_CHUNK;
+
+      nbio_uring_sync(handle, handle->queued, amount);
+      handle->queued += amount;
+   }
+   else
+   {
+      do
+      {
+         unsigned requeued = nbio_uring_reap(handle);
+         if (     requeued
+               || (handle->free_slots && handle->queued < handle->len)
+               || (blocking && handle->inflight))
+            nbio_uring_submit(handle, requeued,
+                  blocking && handle->inflight ? 1 : 0);
+      } while (blocking && handle->inflight);
+   }
+
+   if (handle->queued == handle->len && !handle->inflight)
+      handle->op = -1;
+
+   return handle->op < 0;
+}
+
+static void nbio_uring_resize(void *data, size_t len)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   if (handle->op >= 0)
+   {
+      puts("ERROR - attempted file resize operation while busy");
+      abort();
+   }
+
+   if (len < handle->len)
+   {
+      /* this works perfectly fine if this check is removed, but it
+       * won't work on other nbio implementations */
+      /* therefore, it's blocked so nobody accidentally relies on it */
+      puts("ERROR - attempted file shrink operation, not implemented");
+      abort();
+   }
+
+   if (ftruncate(handle->fd, len) != 0)
+   {
+      puts("ERROR - couldn't resize file (ftruncate)");
+      abort(); /* this one returns void and I can't find any other way
+                  for it to report failure */
+   }
+
+   handle->ptr = realloc(handle->ptr, len);
+   handle->len = len;
+}
+
+static void *nbio_uring_get_ptr(void *data, size_t* len)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return NULL;
+   if (len)
+      *len = handle->len;
+   if (handle->op < 0)
+      return handle->ptr;
+   return NULL;
+}
+
+static void nbio_uring_cancel(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   if (handle->ring_fd >= 0)
+      nbio_uring_drain(handle);
+
+   handle->op     = -1;
+   handle->queued = handle->len;
+}
+
+static void nbio_uring_free(void *data)
+{
+   struct nbio_uring_t* handle = (struct nbio_uring_t*)data;
+   if (!handle)
+      return;
+
+   if (handle->ring_fd >= 0)
+   {
+      nbio_uring_drain(handle);
+      nbio_uring_ring_free(handle);
+   }
+
+   close(handle->fd);
+   free(handle->ptr);
+   free(handle);
+}
+
+nbio_intf_t nbio_uring = {
+   nbio_uring_open,
+   nbio_uring_begin_read,
+   nbio_uring_begin_write,
+   nbio_uring_iterate,
+   nbio_uring_resize,
+   nbio_uring_get_ptr,
+   nbio_uring_cancel,
+   nbio_uring_free,
+   "nbio_uring",
+};
+#else
+nbio_intf_t nbio_uring = {
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   "nbio_uring",
+};
+
+#endif
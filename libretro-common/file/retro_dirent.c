@@ -101,9 +101,30 @@ struct RDIR
 #else
    DIR *directory;
    const struct dirent *entry;
+   /* stat() of the current entry, done at most once and shared
+    * by retro_dirent_is_dir() and retro_dirent_get_size(). */
+   struct stat entry_stat;
+   int entry_stat_ret;
+   bool entry_stat_done;
 #endif
 };
 
+#if !defined(_WIN32) && !defined(VITA) && !defined(PSP) && !defined(PS2) && !defined(__CELLOS_LV2__)
+static const struct stat *retro_dirent_stat(struct RDIR *rdir,
+      const char *path)
+{
+   if (!rdir->entry_stat_done)
+   {
+      rdir->entry_stat_ret  = stat(path, &rdir->entry_stat);
+      rdir->entry_stat_done = true;
+   }
+
+   if (rdir->entry_stat_ret < 0)
+      return NULL;
+   return &rdir->entry_stat;
+}
+#endif
+
 struct RDIR *retro_opendir(const char *name)
 {
 #if defined(_WIN32)
@@ -208,6 +229,7 @@ int retro_readdir(struct RDIR *rdir)
    rdir->error = cellFsReaddir(rdir->directory, &rdir->entry, &nread);
    return (nread != 0);
 #else
+   rdir->entry_stat_done = false;
    return ((rdir->entry = readdir(rdir->directory)) != NULL);
 #endif
 }
@@ -271,7 +293,7 @@ bool retro_dirent_is_dir(struct RDIR *rdir, const char *path)
    CellFsDirent *entry = (CellFsDirent*)&rdir->entry;
    return (entry->d_type == CELL_FS_TYPE_DIRECTORY);
 #else
-   struct stat buf;
+   const struct stat *buf;
 #if defined(DT_DIR)
    const struct dirent *entry = (const struct dirent*)rdir->entry;
    if (entry->d_type == DT_DIR)
@@ -281,9 +303,44 @@ bool retro_dirent_is_dir(struct RDIR *rdir, const char *path)
       return false;
 #endif
    /* dirent struct doesn't have d_type, do it the slow way ... */
-   if (stat(path, &buf) < 0)
+   if (!(buf = retro_dirent_stat(rdir, path)))
       return false;
-   return S_ISDIR(buf.st_mode);
+   return S_ISDIR(buf->st_mode);
+#endif
+}
+
+/**
+ *
+ * retro_dirent_get_size:
+ * @rdir         : pointer to the directory entry.
+ * @path         : path to the directory entry.
+ *
+ * Size of the directory listing entry. Comes straight from
+ * the listing where the platform has it there, otherwise from
+ * a single stat() also used by retro_dirent_is_dir().
+ *
+ * Returns: size in bytes, -1 if unknown.
+ */
+int64_t retro_dirent_get_size(struct RDIR *rdir, const char *path)
+{
+#if defined(_WIN32)
+   return ((int64_t)rdir->entry.nFileSizeHigh << 32)
+      | (int64_t)rdir->entry.nFileSizeLow;
+#elif defined(PSP) || defined(VITA)
+   return (int64_t)rdir->entry.d_stat.st_size;
+#elif defined(PS2)
+   return ((int64_t)rdir->entry.stat.hisize << 32)
+      | (int64_t)rdir->entry.stat.size;
+#elif defined(__CELLOS_LV2__)
+   CellFsStat buf;
+   if (cellFsStat(path, &buf) < 0)
+      return -1;
+   return (int64_t)buf.st_size;
+#else
+   const struct stat *buf = retro_dirent_stat(rdir, path);
+   if (!buf)
+      return -1;
+   return (int64_t)buf->st_size;
 #endif
 }
 
@@ -87,16 +87,6 @@ struct rjpeg
 #define RJPEG__X86_TARGET
 #endif
 
-#if defined(__GNUC__) && (defined(RJPEG__X86_TARGET) || defined(RJPEG__X64_TARGET)) && !defined(__SSE2__) && !defined(RJPEG_NO_SIMD)
-/* NOTE: not clear do we actually need this for the 64-bit path?
- * gcc doesn't support sse2 intrinsics unless you compile with -msse2,
- * (but compiling with -msse2 allows the compiler to use SSE2 everywhere;
- * this is just broken and gcc are jerks for not fixing it properly
- * http://www.virtualdub.org/blog/pivot/entry.php?id=363 )
- */
-#define RJPEG_NO_SIMD
-#endif
-
 #if defined(__MINGW32__) && defined(RJPEG__X86_TARGET) && !defined(RJPEG_MINGW_ENABLE_SSE2) && !defined(RJPEG_NO_SIMD)
 /* Note that __MINGW32__ doesn't actually mean 32-bit, so we have to avoid RJPEG__X64_TARGET
  *
@@ -113,7 +103,21 @@ struct rjpeg
 #define RJPEG_NO_SIMD
 #endif
 
-#if defined(__SSE2__)
+/* MSVC never defines __SSE2__, x64 always has it and /arch:SSE2
+ * shows up in _M_IX86_FP. 32-bit GCC builds without -msse2 still get
+ * the SSE2 kernels through the target attribute, rjpeg__setup_jpeg()
+ * then only picks them when the CPU has it. */
+#if !defined(RJPEG_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RJPEG_SSE2
+#elif defined(RJPEG__X86_TARGET) && defined(__GNUC__) && !defined(__clang__) \
+   && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define RJPEG_SSE2
+#define RJPEG_SIMD_TARGET __attribute__((target("sse2")))
+#endif
+#endif
+
+#ifdef RJPEG_SSE2
 #include <emmintrin.h>
 
 #ifdef _MSC_VER
@@ -125,6 +129,11 @@ struct rjpeg
 #endif
 
 /* ARM NEON */
+#if !defined(RJPEG_NEON) && (defined(__ARM_NEON__) || defined(__ARM_NEON)) \
+   && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define RJPEG_NEON
+#endif
+
 #if defined(RJPEG_NO_SIMD) && defined(RJPEG_NEON)
 #undef RJPEG_NEON
 #endif
@@ -139,6 +148,10 @@ struct rjpeg
 #define RJPEG_SIMD_ALIGN(type, name) type name
 #endif
 
+#ifndef RJPEG_SIMD_TARGET
+#define RJPEG_SIMD_TARGET
+#endif
+
 typedef struct
 {
    uint32_t img_x;
@@ -234,6 +247,7 @@ typedef struct
          const uint8_t *pcr, int count, int step);
    uint8_t *(*resample_row_hv_2_kernel)(uint8_t *out, uint8_t *in_near,
          uint8_t *in_far, int w, int hs);
+   void (*RGBA_to_ARGB_kernel)(uint32_t *pixels, size_t count);
 } rjpeg__jpeg;
 
 #define rjpeg__f2f(x)  ((int) (((x) * 4096 + 0.5)))
@@ -775,7 +789,7 @@ static INLINE uint8_t rjpeg__clamp(int x)
 {
    /* trick to use a single test to catch both cases */
    if ((unsigned int) x > 255)
-      return 255;
+      return x < 0 ? 0 : 255;
    return (uint8_t) x;
 }
 
@@ -882,12 +896,12 @@ static void rjpeg__idct_block(uint8_t *out, int out_stride, short data[64])
    }
 }
 
-#if defined(__SSE2__)
+#ifdef RJPEG_SSE2
 /* sse2 integer IDCT. not the fastest possible implementation but it
  * produces bit-identical results to the generic C version so it's
  * fully "transparent".
  */
-static void rjpeg__idct_simd(uint8_t *out, int out_stride, short data[64])
+static RJPEG_SIMD_TARGET void rjpeg__idct_simd(uint8_t *out, int out_stride, short data[64])
 {
    /* This is constructed to match our regular (generic) integer IDCT exactly. */
    __m128i row0, row1, row2, row3, row4, row5, row6, row7;
@@ -2042,8 +2056,8 @@ static uint8_t *rjpeg__resample_row_hv_2(uint8_t *out, uint8_t *in_near,
    return out;
 }
 
-#if defined(__SSE2__) || defined(RJPEG_NEON)
-static uint8_t *rjpeg__resample_row_hv_2_simd(uint8_t *out, uint8_t *in_near,
+#if defined(RJPEG_SSE2) || defined(RJPEG_NEON)
+static RJPEG_SIMD_TARGET uint8_t *rjpeg__resample_row_hv_2_simd(uint8_t *out, uint8_t *in_near,
       uint8_t *in_far, int w, int hs)
 {
    /* need to generate 2x2 samples for every one in input */
@@ -2062,7 +2076,7 @@ static uint8_t *rjpeg__resample_row_hv_2_simd(uint8_t *out, uint8_t *in_near,
     */
    for (; i < ((w-1) & ~7); i += 8)
    {
-#if defined(__SSE2__)
+#if defined(RJPEG_SSE2)
       /* load and perform the vertical filtering pass
        * this uses 3*x + y = 4*x + (y - x) */
       __m128i zero  = _mm_setzero_si128();
@@ -2200,27 +2214,21 @@ static void rjpeg__YCbCr_to_RGB_row(uint8_t *out, const uint8_t *y,
       r >>= 20;
       g >>= 20;
       b >>= 20;
-      if ((unsigned) r > 255)
-         r = 255;
-      if ((unsigned) g > 255)
-         g = 255;
-      if ((unsigned) b > 255)
-         b = 255;
-      out[0] = (uint8_t)r;
-      out[1] = (uint8_t)g;
-      out[2] = (uint8_t)b;
+      out[0] = rjpeg__clamp(r);
+      out[1] = rjpeg__clamp(g);
+      out[2] = rjpeg__clamp(b);
       out[3] = 255;
       out += step;
    }
 }
 
-#if defined(__SSE2__) || defined(RJPEG_NEON)
-static void rjpeg__YCbCr_to_RGB_simd(uint8_t *out, const uint8_t *y,
+#if defined(RJPEG_SSE2) || defined(RJPEG_NEON)
+static RJPEG_SIMD_TARGET void rjpeg__YCbCr_to_RGB_simd(uint8_t *out, const uint8_t *y,
       const uint8_t *pcb, const uint8_t *pcr, int count, int step)
 {
    int i = 0;
 
-#if defined(__SSE2__)
+#if defined(RJPEG_SSE2)
    /* step == 3 is pretty ugly on the final interleave, and i'm not convinced
     * it's useful in practice (you wouldn't use it for textures, for example).
     * so just accelerate step == 4 case.
@@ -2344,21 +2352,65 @@ static void rjpeg__YCbCr_to_RGB_simd(uint8_t *out, const uint8_t *y,
       r >>= 20;
       g >>= 20;
       b >>= 20;
-      if ((unsigned) r > 255)
-         r = 255;
-      if ((unsigned) g > 255)
-         g = 255;
-      if ((unsigned) b > 255)
-         b = 255;
-      out[0] = (uint8_t)r;
-      out[1] = (uint8_t)g;
-      out[2] = (uint8_t)b;
+      out[0] = rjpeg__clamp(r);
+      out[1] = rjpeg__clamp(g);
+      out[2] = rjpeg__clamp(b);
       out[3] = 255;
       out += step;
    }
 }
 #endif
 
+/* swaps R and B of every pixel, in place */
+static void rjpeg__RGBA_to_ARGB(uint32_t *pixels, size_t count)
+{
+   size_t i;
+
+   for (i = 0; i < count; i++)
+   {
+      uint32_t texel = pixels[i];
+      pixels[i]      = (texel & 0xFF00FF00) | ((texel & 0xFF) << 16)
+         | ((texel >> 16) & 0xFF);
+   }
+}
+
+#if defined(RJPEG_SSE2) || defined(RJPEG_NEON)
+static RJPEG_SIMD_TARGET void rjpeg__RGBA_to_ARGB_simd(uint32_t *pixels,
+      size_t count)
+{
+   size_t i = 0;
+
+#if defined(RJPEG_SSE2)
+   __m128i ga_mask = _mm_set1_epi32(0xFF00FF00);
+   __m128i rb_mask = _mm_set1_epi32(0x00FF00FF);
+
+   for (; i + 4 <= count; i += 4)
+   {
+      __m128i texel = _mm_loadu_si128((const __m128i*)(pixels + i));
+      __m128i rb    = _mm_and_si128(texel, rb_mask);
+      rb            = _mm_or_si128(_mm_slli_epi32(rb, 16),
+            _mm_srli_epi32(rb, 16));
+      _mm_storeu_si128((__m128i*)(pixels + i),
+            _mm_or_si128(_mm_and_si128(texel, ga_mask), rb));
+   }
+#elif defined(RJPEG_NEON)
+   uint32x4_t ga_mask = vdupq_n_u32(0xFF00FF00);
+   uint32x4_t rb_mask = vdupq_n_u32(0x00FF00FF);
+
+   for (; i + 4 <= count; i += 4)
+   {
+      uint32x4_t texel = vld1q_u32(pixels + i);
+      /* swapping the halves of 0x00BB00RR gives 0x00RR00BB */
+      uint32x4_t rb    = vreinterpretq_u32_u16(vrev32q_u16(
+               vreinterpretq_u16_u32(vandq_u32(texel, rb_mask))));
+      vst1q_u32(pixels + i, vorrq_u32(vandq_u32(texel, ga_mask), rb));
+   }
+#endif
+
+   rjpeg__RGBA_to_ARGB(pixels + i, count - i);
+}
+#endif
+
 /* set up the kernels */
 static void rjpeg__setup_jpeg(rjpeg__jpeg *j)
 {
@@ -2369,14 +2421,15 @@ static void rjpeg__setup_jpeg(rjpeg__jpeg *j)
    j->idct_block_kernel        = rjpeg__idct_block;
    j->YCbCr_to_RGB_kernel      = rjpeg__YCbCr_to_RGB_row;
    j->resample_row_hv_2_kernel = rjpeg__resample_row_hv_2;
+   j->RGBA_to_ARGB_kernel      = rjpeg__RGBA_to_ARGB;
 
-
-#if defined(__SSE2__)
+#if defined(RJPEG_SSE2)
    if (mask & RETRO_SIMD_SSE2)
    {
       j->idct_block_kernel        = rjpeg__idct_simd;
       j->YCbCr_to_RGB_kernel      = rjpeg__YCbCr_to_RGB_simd;
       j->resample_row_hv_2_kernel = rjpeg__resample_row_hv_2_simd;
+      j->RGBA_to_ARGB_kernel      = rjpeg__RGBA_to_ARGB_simd;
    }
 #endif
 
@@ -2384,6 +2437,7 @@ static void rjpeg__setup_jpeg(rjpeg__jpeg *j)
    j->idct_block_kernel           = rjpeg__idct_simd;
    j->YCbCr_to_RGB_kernel         = rjpeg__YCbCr_to_RGB_simd;
    j->resample_row_hv_2_kernel    = rjpeg__resample_row_hv_2_simd;
+   j->RGBA_to_ARGB_kernel         = rjpeg__RGBA_to_ARGB_simd;
 #endif
 }
 
@@ -2546,11 +2600,13 @@ error:
    return NULL;
 }
 
+/* With req_comp 4 this hands out ARGB words instead of RGBA bytes. */
 static uint8_t *rjpeg_load_from_memory(const uint8_t *buffer, int len,
       unsigned *x, unsigned *y, int *comp, int req_comp)
 {
    rjpeg__jpeg j;
    rjpeg__context s;
+   uint8_t *img;
 
    s.img_buffer          = (uint8_t*)buffer;
    s.img_buffer_original = (uint8_t*)buffer;
@@ -2559,7 +2615,12 @@ static uint8_t *rjpeg_load_from_memory(const uint8_t *buffer, int len,
    j.s                   = &s;
    rjpeg__setup_jpeg(&j);
 
-   return rjpeg_load_jpeg_image(&j, x,y,comp,req_comp);
+   img                   = rjpeg_load_jpeg_image(&j, x,y,comp,req_comp);
+
+   if (img && req_comp == 4)
+      j.RGBA_to_ARGB_kernel((uint32_t*)img, (size_t)*x * *y);
+
+   return img;
 }
 
 int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
@@ -2567,8 +2628,6 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
 {
    int comp;
    uint32_t *img         = NULL;
-   uint32_t *pixels      = NULL;
-   unsigned size_tex     = 0;
 
    if (!rjpeg)
       return IMAGE_PROCESS_ERROR;
@@ -2578,29 +2637,7 @@ int rjpeg_process_image(rjpeg_t *rjpeg, void **buf_data,
    if (!img)
       return IMAGE_PROCESS_ERROR;
 
-   size_tex = (*width) * (*height);
-   pixels   = (uint32_t*)malloc(size_tex * sizeof(uint32_t));
-
-   if (!pixels)
-   {
-      free(img);
-      return IMAGE_PROCESS_ERROR;
-   }
-
-   *buf_data = pixels;
-
-   /* Convert RGBA to ARGB */
-   while (size_tex--)
-   {
-      unsigned int texel = img[size_tex];
-      unsigned int A     = texel & 0xFF000000;
-      unsigned int B     = texel & 0x00FF0000;
-      unsigned int G     = texel & 0x0000FF00;
-      unsigned int R     = texel & 0x000000FF;
-      ((unsigned int*)pixels)[size_tex] = A | (R << 16) | G | (B >> 16);
-   }
-
-   free(img);
+   *buf_data = img;
 
    return IMAGE_PROCESS_END;
 }
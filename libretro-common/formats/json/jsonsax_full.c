@@ -23,6 +23,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /* Ensure uint32_t type (compiler-dependent). */
 #if defined(_MSC_VER)
 typedef unsigned __int32 uint32_t;
@@ -2391,6 +2395,100 @@ static JSON_Status JSON_Parser_ProcessUnknownByte(JSON_Parser parser, byte b)
    return JSON_Success;
 }
 
+/* Returns the number of leading bytes that can be copied straight into a
+   UTF-8 string token: printable ASCII other than '"' and '\\'. */
+static size_t ScanPlainStringBytes(const byte* pBytes, size_t length)
+{
+   size_t i = 0;
+#if defined(__SSE2__)
+   const __m128i quote     = _mm_set1_epi8('"');
+   const __m128i backslash = _mm_set1_epi8('\\');
+   const __m128i space     = _mm_set1_epi8(0x20);
+   for (; i + 16 <= length; i += 16)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)(pBytes + i));
+      /* The signed compare catches both control characters and bytes
+         with the high bit set. */
+      __m128i special = _mm_or_si128(_mm_cmplt_epi8(v, space),
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+               _mm_cmpeq_epi8(v, backslash)));
+      if (_mm_movemask_epi8(special))
+         break;
+   }
+#endif
+   for (; i < length; i++)
+   {
+      byte b = pBytes[i];
+      if (b < 0x20 || b >= 0x80 || b == '"' || b == '\\')
+         break;
+   }
+   return i;
+}
+
+/* Consumes a run of plain bytes without going through the decoder and
+   lexer one codepoint at a time. Only runs that the slow path would handle
+   identically are taken: UTF-8 input with no pending decoder sequence, and
+   either blanks between tokens or plain ASCII inside a UTF-8 string. */
+static JSON_Status JSON_Parser_ProcessPlainBytes(JSON_Parser parser,
+      const byte* pBytes, size_t length, size_t* pConsumed)
+{
+   size_t run = 0;
+
+   *pConsumed = 0;
+   if (parser->inputEncoding != JSON_UTF8 ||
+         parser->decoderData.state != DECODER_RESET ||
+         GET_FLAGS(parser->state, PARSER_AFTER_CARRIAGE_RETURN))
+      return JSON_Success;
+
+   if (parser->lexerState == LEXING_WHITESPACE)
+   {
+      for (; run < length; run++)
+      {
+         if (pBytes[run] == ' ' || pBytes[run] == TAB_CODEPOINT)
+            parser->codepointLocationColumn++;
+         else if (pBytes[run] == LINE_FEED_CODEPOINT)
+         {
+            parser->codepointLocationLine++;
+            parser->codepointLocationColumn = 0;
+         }
+         else
+            break;
+      }
+   }
+   else if (parser->lexerState == LEXING_STRING &&
+         parser->stringEncoding == JSON_UTF8)
+   {
+      run = ScanPlainStringBytes(pBytes, length);
+
+      /* Leave the byte that overflows the limit to the slow path, which
+         reports the error. */
+      if (run > parser->maxStringLength - parser->tokenBytesUsed)
+         run = parser->maxStringLength - parser->tokenBytesUsed;
+
+      /* Keep LONGEST_ENCODING_SEQUENCE bytes free, as the slow path does. */
+      while (parser->tokenBytesUsed + run >
+            parser->tokenBytesLength - LONGEST_ENCODING_SEQUENCE)
+      {
+         byte* pBiggerBuffer = DoubleBuffer(&parser->memorySuite, parser->defaultTokenBytes, parser->pTokenBytes, parser->tokenBytesLength);
+         if (!pBiggerBuffer)
+         {
+            JSON_Parser_SetErrorAtCodepoint(parser, JSON_Error_OutOfMemory);
+            return JSON_Failure;
+         }
+         parser->pTokenBytes = pBiggerBuffer;
+         parser->tokenBytesLength *= 2;
+      }
+
+      memcpy(parser->pTokenBytes + parser->tokenBytesUsed, pBytes, run);
+      parser->tokenBytesUsed          += run;
+      parser->codepointLocationColumn += run;
+   }
+
+   parser->codepointLocationByte += run;
+   *pConsumed                     = run;
+   return JSON_Success;
+}
+
 JSON_Status JSON_Parser_ProcessInputBytes(JSON_Parser parser, const byte* pBytes, size_t length)
 {
    /* Note that if length is 0, pBytes is allowed to be NULL. */
@@ -2403,6 +2501,13 @@ JSON_Status JSON_Parser_ProcessInputBytes(JSON_Parser parser, const byte* pBytes
    }
    while (i < length)
    {
+      size_t consumed;
+      if (!JSON_Parser_ProcessPlainBytes(parser, pBytes + i, length - i, &consumed))
+         return JSON_Failure;
+      i += consumed;
+      if (i == length)
+         break;
+
       DecoderOutput output     = Decoder_ProcessByte(
             &parser->decoderData, parser->inputEncoding, pBytes[i]);
       DecoderResultCode result = DECODER_RESULT_CODE(output);
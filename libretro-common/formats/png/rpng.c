@@ -29,14 +29,34 @@
 #include <malloc.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#include <arm_neon.h>
+#define RPNG_NEON
+#endif
+
 #include <boolean.h>
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <formats/image.h>
 #include <formats/rpng.h>
 #include <streams/trans_stream.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "rpng_internal.h"
 
+/* Threaded images smaller than this inflate on the caller's thread,
+ * starting a thread would cost more than it saves. */
+#define RPNG_THREAD_MIN_SIZE (512 * 1024)
+
+/* Output the inflate thread publishes at a time. */
+#define RPNG_THREAD_CHUNK    (64 * 1024)
+
 enum png_ihdr_color_type
 {
    PNG_IHDR_COLOR_GRAY       = 0,
@@ -114,11 +134,24 @@ struct rpng_process
    uint32_t *palette;
    void *stream;
    const struct trans_stream_backend *stream_backend;
+#ifdef HAVE_THREADS
+   /* Inflating runs ahead on this thread while lines are unfiltered
+    * as soon as they are complete, see rpng_set_threaded(). */
+   sthread_t *inflate_thread;
+   slock_t *inflate_lock;
+   scond_t *inflate_cond;
+   uint8_t *inflate_base;
+   /* Everything below is under inflate_lock. */
+   size_t inflate_done;
+   bool inflate_finished;
+   bool inflate_abort;
+#endif
 };
 
 struct rpng
 {
    struct rpng_process *process;
+   bool threaded;
    bool has_ihdr;
    bool has_idat;
    bool has_iend;
@@ -231,11 +264,27 @@ end:
 static void png_reverse_filter_copy_line_rgb(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+#if defined(RPNG_NEON) && !defined(__ARM_BIG_ENDIAN)
+   if (bpp == 1)
+   {
+      for (; i + 8 <= width; i += 8, decoded += 24)
+      {
+         uint8x8x3_t v = vld3_u8(decoded);
+         uint8x8x4_t o;
+         o.val[0]      = v.val[2];
+         o.val[1]      = v.val[1];
+         o.val[2]      = v.val[0];
+         o.val[3]      = vdup_n_u8(0xff);
+         vst4_u8((uint8_t*)(data + i), o);
+      }
+   }
+#endif
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b;
 
@@ -252,11 +301,39 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 static void png_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+   /* 8-bit RGBA in memory is ABGR as a little-endian word, so
+    * this is just an R/B swap. */
+   if (bpp == 1)
+   {
+#if defined(__SSE2__)
+      const __m128i rb = _mm_set1_epi32(0x00ff00ff);
+
+      for (; i + 4 <= width; i += 4, decoded += 16)
+      {
+         __m128i v = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i s = _mm_and_si128(v, rb);
+         s         = _mm_or_si128(_mm_slli_epi32(s, 16),
+               _mm_srli_epi32(s, 16));
+         _mm_storeu_si128((__m128i*)(data + i),
+               _mm_or_si128(_mm_andnot_si128(rb, v), s));
+      }
+#elif defined(RPNG_NEON) && !defined(__ARM_BIG_ENDIAN)
+      for (; i + 8 <= width; i += 8, decoded += 32)
+      {
+         uint8x8x4_t v = vld4_u8(decoded);
+         uint8x8_t r   = v.val[0];
+         v.val[0]      = v.val[2];
+         v.val[2]      = r;
+         vst4_u8((uint8_t*)(data + i), v);
+      }
+#endif
+   }
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -558,6 +635,10 @@ static int png_reverse_filter_init(const struct png_ihdr *ihdr,
 
    png_pass_geom(ihdr, ihdr->width, ihdr->height, &pngp->bpp, &pngp->pitch, &pass_size);
 
+#ifdef HAVE_THREADS
+   /* Still coming in, png_inflate_wait() checks each line instead. */
+   if (!pngp->inflate_thread)
+#endif
    if (pngp->total_out < pass_size)
       return -1;
 
@@ -579,49 +660,296 @@ error:
    return -1;
 }
 
-static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
-      struct rpng_process *pngp, unsigned filter)
+/* Sub, Average and Paeth depend on the pixel to the left, so there
+ * is no vectorizing across a line. For 8-bit RGB(A) the vector unit
+ * still does all channels of a pixel at once though, branch-free for
+ * Paeth, which is what boxart and wallpapers are nearly always made
+ * of. Pixels are moved through a uint32_t, never read past the line. */
+#if defined(__SSE2__) || defined(RPNG_NEON)
+static INLINE uint32_t png_load_pixel(const uint8_t *p, unsigned bpp)
+{
+   uint32_t pixel;
+   if (bpp == 4)
+      memcpy(&pixel, p, 4);
+   else
+      pixel = p[0] | (p[1] << 8) | (p[2] << 16);
+   return pixel;
+}
+
+static INLINE void png_store_pixel(uint8_t *p, uint32_t pixel, unsigned bpp)
+{
+   if (bpp == 4)
+      memcpy(p, &pixel, 4);
+   else
+   {
+      p[0] = (uint8_t)pixel;
+      p[1] = (uint8_t)(pixel >> 8);
+      p[2] = (uint8_t)(pixel >> 16);
+   }
+}
+#endif
+
+#if defined(__SSE2__)
+#define PNG_SIMD_UNFILTER
+
+static INLINE void png_unfilter_up_simd(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch)
+{
+   unsigned i;
+
+   for (i = 0; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(in + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
+static INLINE void png_unfilter_sub_simd(uint8_t *out, const uint8_t *in,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, _mm_cvtsi32_si128(png_load_pixel(in + i, bpp)));
+      png_store_pixel(out + i, _mm_cvtsi128_si32(a), bpp);
+   }
+}
+
+static INLINE void png_unfilter_avg_simd(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a          = _mm_setzero_si128();
+   const __m128i ones = _mm_set1_epi8(1);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b   = _mm_cvtsi32_si128(png_load_pixel(prev + i, bpp));
+      /* pavgb rounds up, PNG rounds down. */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), ones));
+      a           = _mm_add_epi8(avg,
+            _mm_cvtsi32_si128(png_load_pixel(in + i, bpp)));
+      png_store_pixel(out + i, _mm_cvtsi128_si32(a), bpp);
+   }
+}
+
+static INLINE __m128i png_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __m128i png_select(__m128i mask, __m128i x, __m128i y)
+{
+   return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y));
+}
+
+static INLINE void png_unfilter_paeth_simd(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a          = zero;
+   __m128i c          = zero;
+
+   /* Channels widened to 16 bits, where |a + b - 2c| fits. */
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i smallest, nearest;
+      __m128i b  = _mm_unpacklo_epi8(
+            _mm_cvtsi32_si128(png_load_pixel(prev + i, bpp)), zero);
+      __m128i x  = _mm_unpacklo_epi8(
+            _mm_cvtsi32_si128(png_load_pixel(in + i, bpp)), zero);
+      __m128i pa = _mm_sub_epi16(b, c);
+      __m128i pb = _mm_sub_epi16(a, c);
+      __m128i pc = _mm_add_epi16(pa, pb);
+
+      pa         = png_abs_epi16(pa);
+      pb         = png_abs_epi16(pb);
+      pc         = png_abs_epi16(pc);
+
+      smallest   = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      nearest    = png_select(_mm_cmpeq_epi16(smallest, pa), a,
+            png_select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+      a          = _mm_and_si128(_mm_add_epi16(nearest, x),
+            _mm_set1_epi16(0xff));
+      png_store_pixel(out + i,
+            _mm_cvtsi128_si32(_mm_packus_epi16(a, a)), bpp);
+      c          = b;
+   }
+}
+#elif defined(RPNG_NEON)
+#define PNG_SIMD_UNFILTER
+
+static INLINE uint8x8_t png_neon_load_pixel(const uint8_t *p, unsigned bpp)
+{
+   return vreinterpret_u8_u32(vdup_n_u32(png_load_pixel(p, bpp)));
+}
+
+static INLINE void png_neon_store_pixel(uint8_t *p, uint8x8_t v,
+      unsigned bpp)
+{
+   png_store_pixel(p, vget_lane_u32(vreinterpret_u32_u8(v), 0), bpp);
+}
+
+static INLINE void png_unfilter_up_simd(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch)
 {
    unsigned i;
 
+   for (i = 0; i + 16 <= pitch; i += 16)
+      vst1q_u8(out + i, vaddq_u8(vld1q_u8(in + i), vld1q_u8(prev + i)));
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
+static INLINE void png_unfilter_sub_simd(uint8_t *out, const uint8_t *in,
+      unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = vadd_u8(a, png_neon_load_pixel(in + i, bpp));
+      png_neon_store_pixel(out + i, a, bpp);
+   }
+}
+
+static INLINE void png_unfilter_avg_simd(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = vadd_u8(vhadd_u8(a, png_neon_load_pixel(prev + i, bpp)),
+            png_neon_load_pixel(in + i, bpp));
+      png_neon_store_pixel(out + i, a, bpp);
+   }
+}
+
+static INLINE void png_unfilter_paeth_simd(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+   uint8x8_t c = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      uint8x8_t e;
+      uint8x8_t b    = png_neon_load_pixel(prev + i, bpp);
+      uint16x8_t pa  = vabdl_u8(b, c);
+      uint16x8_t pb  = vabdl_u8(a, c);
+      uint16x8_t pc  = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+      uint16x8_t sel = vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc));
+
+      e = vbsl_u8(vmovn_u16(vcleq_u16(pb, pc)), b, c);
+      e = vbsl_u8(vmovn_u16(sel), a, e);
+      a = vadd_u8(e, png_neon_load_pixel(in + i, bpp));
+      png_neon_store_pixel(out + i, a, bpp);
+      c = b;
+   }
+}
+#endif
+
+static void png_unfilter_line(uint8_t *out, const uint8_t *in,
+      const uint8_t *prev, unsigned pitch, unsigned bpp, unsigned filter)
+{
+   unsigned i;
+#ifdef PNG_SIMD_UNFILTER
+   /* Constant bpp for the compiler to fold the pixel moves. */
+   bool simd = (bpp == 3 || bpp == 4);
+#endif
+
    switch (filter)
    {
-      case PNG_FILTER_NONE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
-         break;
       case PNG_FILTER_SUB:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
+#ifdef PNG_SIMD_UNFILTER
+         if (simd)
+         {
+            if (bpp == 4)
+               png_unfilter_sub_simd(out, in, pitch, 4);
+            else
+               png_unfilter_sub_simd(out, in, pitch, 3);
+            break;
+         }
+#endif
+         for (i = 0; i < bpp; i++)
+            out[i] = in[i];
+         for (i = bpp; i < pitch; i++)
+            out[i] = out[i - bpp] + in[i];
          break;
       case PNG_FILTER_UP:
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+#ifdef PNG_SIMD_UNFILTER
+         png_unfilter_up_simd(out, in, prev, pitch);
+#else
+         for (i = 0; i < pitch; i++)
+            out[i] = prev[i] + in[i];
+#endif
          break;
       case PNG_FILTER_AVERAGE:
-         for (i = 0; i < pngp->bpp; i++)
+#ifdef PNG_SIMD_UNFILTER
+         if (simd)
          {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
+            if (bpp == 4)
+               png_unfilter_avg_simd(out, in, prev, pitch, 4);
+            else
+               png_unfilter_avg_simd(out, in, prev, pitch, 3);
+            break;
          }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
+#endif
+         for (i = 0; i < bpp; i++)
          {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
+            uint8_t avg = prev[i] >> 1;
+            out[i] = avg + in[i];
+         }
+         for (i = bpp; i < pitch; i++)
+         {
+            uint8_t avg = (out[i - bpp] + prev[i]) >> 1;
+            out[i] = avg + in[i];
          }
          break;
       case PNG_FILTER_PAETH:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]) + pngp->inflate_buf[i];
+#ifdef PNG_SIMD_UNFILTER
+         if (simd)
+         {
+            if (bpp == 4)
+               png_unfilter_paeth_simd(out, in, prev, pitch, 4);
+            else
+               png_unfilter_paeth_simd(out, in, prev, pitch, 3);
+            break;
+         }
+#endif
+         for (i = 0; i < bpp; i++)
+            out[i] = paeth(0, prev[i], 0) + in[i];
+         for (i = bpp; i < pitch; i++)
+            out[i] = paeth(out[i - bpp], prev[i], prev[i - bpp]) + in[i];
          break;
-
-      default:
-         return IMAGE_PROCESS_ERROR_END;
    }
+}
+
+static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
+      struct rpng_process *pngp, unsigned filter)
+{
+   uint8_t *swap;
+
+   if (filter > PNG_FILTER_PAETH)
+      return IMAGE_PROCESS_ERROR_END;
+
+   if (filter == PNG_FILTER_NONE)
+      memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
+   else
+      png_unfilter_line(pngp->decoded_scanline, pngp->inflate_buf,
+            pngp->prev_scanline, pngp->pitch, pngp->bpp, filter);
 
    switch (ihdr->color_type)
    {
@@ -644,11 +972,114 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          break;
    }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   /* This line is the next one's previous. */
+   swap                   = pngp->prev_scanline;
+   pngp->prev_scanline    = pngp->decoded_scanline;
+   pngp->decoded_scanline = swap;
 
    return IMAGE_PROCESS_NEXT;
 }
 
+#ifdef HAVE_THREADS
+static void png_inflate_thread(void *data)
+{
+   struct rpng_process *pngp = (struct rpng_process*)data;
+   size_t done               = 0;
+   bool finished             = false;
+
+   while (!finished)
+   {
+      uint32_t rd = 0;
+      uint32_t wn = 0;
+      enum trans_stream_error terror = TRANS_STREAM_ERROR_NONE;
+      bool zstatus;
+
+      pngp->stream_backend->set_out(pngp->stream, pngp->inflate_base + done,
+            (uint32_t)MIN(RPNG_THREAD_CHUNK, pngp->inflate_buf_size - done));
+
+      zstatus = pngp->stream_backend->trans(pngp->stream, false,
+            &rd, &wn, &terror);
+      done   += wn;
+
+      /* A full chunk with input left is the normal case here. */
+      finished = (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
+         || (zstatus && terror == TRANS_STREAM_ERROR_NONE)
+         || done >= pngp->inflate_buf_size
+         || (!rd && !wn);
+
+      slock_lock(pngp->inflate_lock);
+      pngp->inflate_done     = done;
+      pngp->inflate_finished = finished;
+      if (pngp->inflate_abort)
+         finished = true;
+      scond_signal(pngp->inflate_cond);
+      slock_unlock(pngp->inflate_lock);
+   }
+}
+
+static void png_inflate_thread_free(struct rpng_process *pngp)
+{
+   if (!pngp->inflate_thread)
+      return;
+
+   slock_lock(pngp->inflate_lock);
+   pngp->inflate_abort = true;
+   slock_unlock(pngp->inflate_lock);
+
+   sthread_join(pngp->inflate_thread);
+   scond_free(pngp->inflate_cond);
+   slock_free(pngp->inflate_lock);
+
+   pngp->inflate_thread = NULL;
+   pngp->inflate_cond   = NULL;
+   pngp->inflate_lock   = NULL;
+
+   pngp->stream_backend->stream_free(pngp->stream);
+   pngp->stream         = NULL;
+}
+
+static bool png_inflate_thread_new(struct rpng_process *pngp)
+{
+   pngp->inflate_base   = pngp->inflate_buf;
+   pngp->inflate_lock   = slock_new();
+   pngp->inflate_cond   = scond_new();
+
+   if (pngp->inflate_lock && pngp->inflate_cond)
+      pngp->inflate_thread = sthread_create(png_inflate_thread, pngp);
+
+   if (pngp->inflate_thread)
+      return true;
+
+   if (pngp->inflate_cond)
+      scond_free(pngp->inflate_cond);
+   if (pngp->inflate_lock)
+      slock_free(pngp->inflate_lock);
+   pngp->inflate_cond   = NULL;
+   pngp->inflate_lock   = NULL;
+   return false;
+}
+#endif
+
+/* Waits until the first @size bytes of inflated data are in. */
+static bool png_inflate_wait(struct rpng_process *pngp, size_t size)
+{
+#ifdef HAVE_THREADS
+   if (pngp->inflate_thread)
+   {
+      bool ret;
+
+      slock_lock(pngp->inflate_lock);
+      while (pngp->inflate_done < size && !pngp->inflate_finished)
+         scond_wait(pngp->inflate_cond, pngp->inflate_lock);
+      ret = pngp->inflate_done >= size;
+      slock_unlock(pngp->inflate_lock);
+
+      return ret;
+   }
+#endif
+   return true;
+}
+
 static int png_reverse_filter_regular_iterate(uint32_t **data, const struct png_ihdr *ihdr,
       struct rpng_process *pngp)
 {
@@ -656,7 +1087,16 @@ static int png_reverse_filter_regular_iterate(uint32_t **data, const struct png_
 
    if (pngp->h < ihdr->height)
    {
-      unsigned filter = *pngp->inflate_buf++;
+      unsigned filter;
+
+      if (!png_inflate_wait(pngp,
+               (size_t)(pngp->h + 1) * (pngp->pitch + 1)))
+      {
+         ret = IMAGE_PROCESS_ERROR_END;
+         goto end;
+      }
+
+      filter = *pngp->inflate_buf++;
       pngp->restore_buf_size += 1;
       ret = png_reverse_filter_copy_line(*data,
             ihdr, pngp, filter);
@@ -676,6 +1116,9 @@ static int png_reverse_filter_regular_iterate(uint32_t **data, const struct png_
 
 end:
    png_reverse_filter_deinit(pngp);
+#ifdef HAVE_THREADS
+   png_inflate_thread_free(pngp);
+#endif
 
    pngp->inflate_buf -= pngp->restore_buf_size;
    *data             -= pngp->data_restore_buf_size;
@@ -783,6 +1226,14 @@ static int rpng_load_image_argb_process_inflate_init(rpng_t *rpng,
    bool to_continue        = (process->avail_in > 0
          && process->avail_out > 0);
 
+#ifdef HAVE_THREADS
+   /* Adam7 passes need all of the data up front. */
+   if (to_continue && rpng->threaded && rpng->ihdr.interlace != 1
+         && process->inflate_buf_size >= RPNG_THREAD_MIN_SIZE
+         && png_inflate_thread_new(process))
+      goto alloc;
+#endif
+
    if (!to_continue)
       goto end;
 
@@ -802,6 +1253,9 @@ end:
    process->stream_backend->stream_free(process->stream);
    process->stream = NULL;
 
+#ifdef HAVE_THREADS
+alloc:
+#endif
    *width  = rpng->ihdr.width;
    *height = rpng->ihdr.height;
 #ifdef GEKKO
@@ -1112,6 +1566,9 @@ int rpng_process_image(rpng_t *rpng,
 error:
    if (rpng->process)
    {
+#ifdef HAVE_THREADS
+      png_inflate_thread_free(rpng->process);
+#endif
       if (rpng->process->inflate_buf)
          free(rpng->process->inflate_buf);
       if (rpng->process->stream)
@@ -1130,6 +1587,9 @@ void rpng_free(rpng_t *rpng)
       free(rpng->idat_buf.data);
    if (rpng->process)
    {
+#ifdef HAVE_THREADS
+      png_inflate_thread_free(rpng->process);
+#endif
       if (rpng->process->inflate_buf)
          free(rpng->process->inflate_buf);
       if (rpng->process->stream)
@@ -1190,6 +1650,12 @@ bool rpng_set_buf_ptr(rpng_t *rpng, void *data)
    return true;
 }
 
+void rpng_set_threaded(rpng_t *rpng, bool threaded)
+{
+   if (rpng)
+      rpng->threaded = threaded;
+}
+
 rpng_t *rpng_alloc(void)
 {
    rpng_t *rpng = (rpng_t*)calloc(1, sizeof(*rpng));
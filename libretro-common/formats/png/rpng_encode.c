@@ -24,10 +24,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#include <arm_neon.h>
+#define RPNG_ENCODE_NEON
+#endif
+
+#include <compat/zlib.h>
 #include <encodings/crc32.h>
 #include <streams/file_stream.h>
 #include <streams/trans_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rjob.h>
+#endif
+
 #include "rpng_internal.h"
 
 #undef GOTO_END_ERROR
@@ -208,9 +220,211 @@ static unsigned filter_paeth(uint8_t *target,
    return count_sad(target, width);
 }
 
+/* The fast mode uses the Up filter on every line, which is
+ * a plain byte-wise subtraction. */
+static void filter_up_fast(uint8_t *target, const uint8_t *line,
+      const uint8_t *prev, size_t size)
+{
+   size_t i = 0;
+
+#if defined(__SSE2__)
+   for (; i + 16 <= size; i += 16)
+      _mm_storeu_si128((__m128i*)(target + i), _mm_sub_epi8(
+               _mm_loadu_si128((const __m128i*)(line + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+#elif defined(RPNG_ENCODE_NEON)
+   for (; i + 16 <= size; i += 16)
+      vst1q_u8(target + i, vsubq_u8(vld1q_u8(line + i), vld1q_u8(prev + i)));
+#endif
+
+   for (; i < size; i++)
+      target[i] = line[i] - prev[i];
+}
+
+/* Deflate blocks smaller than this lose too much ratio. */
+#define RPNG_DEFLATE_BLOCK_MIN (256 * 1024)
+
+struct rpng_deflate_block
+{
+   const uint8_t *in;
+   uint8_t *out;
+   size_t in_size;
+   size_t out_size;
+   uLong adler;
+   bool last;
+   bool ok;
+};
+
+struct rpng_deflate_job
+{
+   struct rpng_deflate_block *blocks;
+   int level;
+};
+
+/* Each block is a raw deflate stream of its own, ended with
+ * a sync flush so the next one starts on a byte boundary, and
+ * the last one is finished. Concatenated behind a zlib header
+ * they form a valid stream. */
+static void rpng_deflate_blocks(void *data, unsigned begin, unsigned end)
+{
+   struct rpng_deflate_job *job = (struct rpng_deflate_job*)data;
+   unsigned i;
+
+   for (i = begin; i < end; i++)
+   {
+      z_stream z;
+      struct rpng_deflate_block *block = &job->blocks[i];
+
+      block->adler = adler32(adler32(0L, Z_NULL, 0),
+            block->in, (uInt)block->in_size);
+
+      memset(&z, 0, sizeof(z));
+      if (deflateInit2(&z, job->level, Z_DEFLATED, -MAX_WBITS,
+               8, Z_DEFAULT_STRATEGY) != Z_OK)
+         continue;
+
+      z.next_in   = (Bytef*)block->in;
+      z.avail_in  = (uInt)block->in_size;
+      z.next_out  = block->out;
+      z.avail_out = (uInt)block->out_size;
+
+      block->ok   = deflate(&z, block->last ? Z_FINISH : Z_SYNC_FLUSH)
+         == (block->last ? Z_STREAM_END : Z_OK) && !z.avail_in;
+      block->out_size = z.total_out;
+
+      deflateEnd(&z);
+   }
+}
+
+/* Filters every line with Up and deflates the result in blocks,
+ * on the job pool when there is one. Returns the IDAT chunk. */
+static uint8_t *rpng_encode_fast(const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned bpp,
+      size_t *chunk_size)
+{
+   unsigned h, i;
+   struct rpng_deflate_job job;
+   size_t line_size     = (size_t)width * bpp;
+   size_t encode_size   = (line_size + 1) * height;
+   size_t rows_per      = 0;
+   size_t out_size      = 0;
+   unsigned num_blocks  = 1;
+   uLong adler          = adler32(0L, Z_NULL, 0);
+   uint8_t *encode_buf  = (uint8_t*)malloc(encode_size);
+   uint8_t *lines       = (uint8_t*)calloc(2, line_size);
+   uint8_t *chunk       = NULL;
+   uint8_t *target      = encode_buf;
+
+   job.blocks           = NULL;
+   job.level            = Z_BEST_SPEED;
+
+   if (!encode_buf || !lines)
+      goto error;
+
+   for (h = 0; h < height; h++, data += pitch)
+   {
+      uint8_t *line = lines + (h & 1) * line_size;
+      uint8_t *prev = lines + (~h & 1) * line_size;
+
+      if (bpp == sizeof(uint32_t))
+         copy_argb_line(line, (const uint32_t*)data, width);
+      else
+         copy_bgr24_line(line, data, width);
+
+      /* The line above the first one is all zero */
+      *target++ = 2;
+      filter_up_fast(target, line, prev, line_size);
+      target   += line_size;
+   }
+
+#ifdef HAVE_THREADS
+   num_blocks = rjob_worker_count() + 1;
+   if (num_blocks > encode_size / RPNG_DEFLATE_BLOCK_MIN)
+      num_blocks = (unsigned)(encode_size / RPNG_DEFLATE_BLOCK_MIN);
+   if (num_blocks < 1)
+      num_blocks = 1;
+#endif
+
+   job.blocks = (struct rpng_deflate_block*)
+      calloc(num_blocks, sizeof(*job.blocks));
+   if (!job.blocks)
+      goto error;
+
+   /* Blocks are cut on line boundaries */
+   rows_per = (height + num_blocks - 1) / num_blocks;
+   for (i = 0; i < num_blocks; i++)
+   {
+      struct rpng_deflate_block *block = &job.blocks[i];
+      size_t first = (size_t)i * rows_per;
+      size_t last  = first + rows_per;
+
+      if (last > height)
+         last = height;
+      if (first > last)
+         first = last;
+
+      block->in       = encode_buf + first * (line_size + 1);
+      block->in_size  = (last - first) * (line_size + 1);
+      block->out_size = deflateBound(NULL, (uLong)block->in_size) + 16;
+      block->out      = (uint8_t*)malloc(block->out_size);
+      block->last     = (i == num_blocks - 1);
+
+      if (!block->out)
+         goto error;
+   }
+
+#ifdef HAVE_THREADS
+   rjob_parallel_for(num_blocks, 1, rpng_deflate_blocks, &job);
+#else
+   rpng_deflate_blocks(&job, 0, num_blocks);
+#endif
+
+   for (i = 0; i < num_blocks; i++)
+   {
+      if (!job.blocks[i].ok)
+         goto error;
+      out_size += job.blocks[i].out_size;
+   }
+
+   /* Length, "IDAT", zlib header, blocks, Adler-32 */
+   *chunk_size = 4 + 4 + 2 + out_size + 4;
+   chunk       = (uint8_t*)malloc(*chunk_size);
+   if (!chunk)
+      goto error;
+
+   dword_write_be(chunk, (uint32_t)(*chunk_size - 8));
+   memcpy(chunk + 4, "IDAT", 4);
+   chunk[8]    = 0x78;
+   chunk[9]    = 0x01;
+   target      = chunk + 10;
+
+   for (i = 0; i < num_blocks; i++)
+   {
+      struct rpng_deflate_block *block = &job.blocks[i];
+
+      memcpy(target, block->out, block->out_size);
+      target += block->out_size;
+      adler   = adler32_combine(adler, block->adler,
+            (z_off_t)block->in_size);
+   }
+   dword_write_be(target, (uint32_t)adler);
+
+error:
+   if (job.blocks)
+   {
+      for (i = 0; i < num_blocks; i++)
+         free(job.blocks[i].out);
+      free(job.blocks);
+   }
+   free(encode_buf);
+   free(lines);
+   return chunk;
+}
+
 static bool rpng_save_image(const char *path,
       const uint8_t *data,
-      unsigned width, unsigned height, unsigned pitch, unsigned bpp)
+      unsigned width, unsigned height, unsigned pitch, unsigned bpp,
+      bool fast)
 {
    unsigned h;
    bool ret = true;
@@ -248,6 +462,21 @@ static bool rpng_save_image(const char *path,
    if (!png_write_ihdr(file, &ihdr))
       GOTO_END_ERROR();
 
+   if (fast)
+   {
+      if (!(deflate_buf = rpng_encode_fast(data, width, height,
+                  pitch, bpp, &encode_buf_size)))
+         GOTO_END_ERROR();
+
+      if (!png_write_idat(file, deflate_buf, encode_buf_size))
+         GOTO_END_ERROR();
+
+      if (!png_write_iend(file))
+         GOTO_END_ERROR();
+
+      goto end;
+   }
+
    encode_buf_size = (width * bpp + 1) * height;
    encode_buf = (uint8_t*)malloc(encode_buf_size);
    if (!encode_buf)
@@ -383,12 +612,26 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, sizeof(uint32_t));
+         width, height, pitch, sizeof(uint32_t), false);
 }
 
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, 3);
+         width, height, pitch, 3, false);
+}
+
+bool rpng_save_image_argb_fast(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch)
+{
+   return rpng_save_image(path, (const uint8_t*)data,
+         width, height, pitch, sizeof(uint32_t), true);
+}
+
+bool rpng_save_image_bgr24_fast(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch)
+{
+   return rpng_save_image(path, (const uint8_t*)data,
+         width, height, pitch, 3, true);
 }
@@ -324,6 +324,32 @@ bool gl_check_capability(enum gl_capability_enum enum_idx)
 #else
          if (gl_query_extension("EXT_texture_storage"))
             return true;
+#endif
+         break;
+      case GL_CAPS_MAP_BUFFER_RANGE:
+#ifdef HAVE_OPENGLES
+         if (major >= 3)
+            return true;
+#else
+         if ((major >= 3 || gl_query_extension("ARB_map_buffer_range")) &&
+               glMapBufferRange && glUnmapBuffer)
+            return true;
+#endif
+         break;
+      case GL_CAPS_BUFFER_STORAGE:
+#ifndef HAVE_OPENGLES
+         if ((major > 4 || (major == 4 && minor >= 4) ||
+                  gl_query_extension("ARB_buffer_storage")) &&
+               glBufferStorage && glMapBufferRange)
+            return true;
+#endif
+         break;
+      case GL_CAPS_TIMER_QUERY:
+#ifndef HAVE_OPENGLES
+         if ((major > 3 || (major == 3 && minor >= 3) ||
+                  gl_query_extension("ARB_timer_query")) &&
+               glGenQueries && glQueryCounter && glGetQueryObjectui64v)
+            return true;
 #endif
          break;
       case GL_CAPS_NONE:
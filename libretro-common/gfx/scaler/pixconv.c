@@ -25,7 +25,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
+#include <features/features_cpu.h>
 
 #include <gfx/scaler/pixconv.h>
 
@@ -35,6 +37,98 @@
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(SCALER_NO_SIMD)
+#include <arm_neon.h>
+#define PIXCONV_NEON
+#endif
+
+/* SSE2 is the x86 baseline, wider variants are built with
+ * target attributes and picked at runtime. */
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__)) && \
+   (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#include <immintrin.h>
+#define PIXCONV_X86_DISPATCH
+#define PIXCONV_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+typedef void (*pixconv_func_t)(void *output, const void *input,
+      int width, int height,
+      int out_stride, int in_stride);
+
+static void conv_0rgb1555_argb8888_base(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride);
+static void conv_rgb565_argb8888_base(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride);
+static void conv_bgr24_argb8888_base(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride);
+
+#ifdef PIXCONV_X86_DISPATCH
+static void conv_0rgb1555_argb8888_avx2(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride);
+static void conv_rgb565_argb8888_avx2(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride);
+static void conv_bgr24_argb8888_ssse3(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride);
+
+/* Converters with a variant the baseline can't assume. Every
+ * entry is valid from the start, so threads racing through
+ * pixconv_dispatch_init() only ever see a usable function. */
+static struct
+{
+   pixconv_func_t conv_0rgb1555_argb8888;
+   pixconv_func_t conv_rgb565_argb8888;
+   pixconv_func_t conv_bgr24_argb8888;
+   bool ready;
+} pixconv_dispatch = {
+   conv_0rgb1555_argb8888_base,
+   conv_rgb565_argb8888_base,
+   conv_bgr24_argb8888_base,
+   false
+};
+
+static void pixconv_dispatch_init(void)
+{
+   uint64_t cpu = cpu_features_get();
+
+   if (cpu & RETRO_SIMD_AVX2)
+   {
+      pixconv_dispatch.conv_0rgb1555_argb8888 = conv_0rgb1555_argb8888_avx2;
+      pixconv_dispatch.conv_rgb565_argb8888   = conv_rgb565_argb8888_avx2;
+   }
+   if (cpu & RETRO_SIMD_SSSE3)
+      pixconv_dispatch.conv_bgr24_argb8888    = conv_bgr24_argb8888_ssse3;
+
+   pixconv_dispatch.ready = true;
+}
+
+#define PIXCONV_CALL(name) \
+   ((pixconv_dispatch.ready ? (void)0 : pixconv_dispatch_init()), \
+    pixconv_dispatch.name)
+#else
+#define PIXCONV_CALL(name) name##_base
+#endif
+
+#ifdef PIXCONV_NEON
+static INLINE uint8x8_t pixconv_expand5_neon(uint8x8_t x)
+{
+   return vorr_u8(vshl_n_u8(x, 3), vshr_n_u8(x, 2));
+}
+
+static INLINE uint8x8_t pixconv_expand6_neon(uint8x8_t x)
+{
+   return vorr_u8(vshl_n_u8(x, 2), vshr_n_u8(x, 4));
+}
+
+static INLINE uint8x8_t pixconv_expand4_neon(uint8x8_t x)
+{
+   return vsli_n_u8(x, x, 4);
+}
 #endif
 
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
@@ -45,24 +139,36 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
    const uint16_t *input = (const uint16_t*)input_;
    uint16_t *output = (uint16_t*)output_;
 
-#if defined(__SSE2_)
+#if defined(__SSE2__)
    int max_width           = width - 7;
    const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
+#elif defined(PIXCONV_NEON)
+   int max_width           = width - 7;
+   const uint16x8_t hi_mask = vdupq_n_u16(0x7fe0);
+   const uint16x8_t lo_mask = vdupq_n_u16(0x1f);
 #endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__SSE2_)
+#if defined(__SSE2__)
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+         __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
          __m128i lo = _mm_and_si128(in, lo_mask);
          _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t hi       = vandq_u16(vshrq_n_u16(in, 1), hi_mask);
+         uint16x8_t lo       = vandq_u16(in, lo_mask);
+         vst1q_u16(output + w, vorrq_u16(hi, lo));
+      }
 #endif
 
       for (; w < width; w++)
@@ -90,6 +196,12 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          (int16_t)((0x1f << 11) | (0x1f << 6)));
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
    const __m128i glow_mask = _mm_set1_epi16(1 << 5);
+#elif defined(PIXCONV_NEON)
+   int max_width              = width - 7;
+
+   const uint16x8_t hi_mask   = vdupq_n_u16((0x1f << 11) | (0x1f << 6));
+   const uint16x8_t lo_mask   = vdupq_n_u16(0x1f);
+   const uint16x8_t glow_mask = vdupq_n_u16(1 << 5);
 #endif
 
    for (h = 0; h < height;
@@ -106,6 +218,15 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w),
                _mm_or_si128(rg, _mm_or_si128(b, glow)));
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t rg       = vandq_u16(vshlq_n_u16(in, 1), hi_mask);
+         uint16x8_t b        = vandq_u16(in, lo_mask);
+         uint16x8_t glow     = vandq_u16(vshrq_n_u16(in, 4), glow_mask);
+         vst1q_u16(output + w, vorrq_u16(rg, vorrq_u16(b, glow)));
+      }
 #endif
 
       for (; w < width; w++)
@@ -119,7 +240,7 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
    }
 }
 
-void conv_0rgb1555_argb8888(void *output_, const void *input_,
+static void conv_0rgb1555_argb8888_base(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
@@ -134,6 +255,11 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
    const __m128i mul15_hi    = _mm_set1_epi16(0x0210);
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
+   int max_width = width - 7;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask      = vdup_n_u8(0x1f);
+   const uint8x8_t a         = vdup_n_u8(0xff);
+
    int max_width = width - 7;
 #endif
 
@@ -169,6 +295,20 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+
+         res.val[0] = pixconv_expand5_neon(vand_u8(vmovn_u16(in), mask));
+         res.val[1] = pixconv_expand5_neon(vand_u8(vshrn_n_u16(in, 5), mask));
+         res.val[2] = pixconv_expand5_neon(vand_u8(
+                  vmovn_u16(vshrq_n_u16(in, 10)), mask));
+         res.val[3] = a;
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -186,7 +326,68 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
    }
 }
 
-void conv_rgb565_argb8888(void *output_, const void *input_,
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static void conv_0rgb1555_argb8888_avx2(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input     = (const uint16_t*)input_;
+   uint32_t *output          = (uint32_t*)output_;
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+   const __m256i a           = _mm256_set1_epi16(0x00ff);
+   int vec_width             = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i res_lo, res_hi;
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i r = _mm256_and_si256(in, pix_mask_r);
+         __m256i g = _mm256_and_si256(in, pix_mask_gb);
+         __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_gb);
+
+         r = _mm256_mulhi_epi16(r, mul15_hi);
+         g = _mm256_mulhi_epi16(g, mul15_mid);
+         b = _mm256_mulhi_epi16(b, mul15_mid);
+
+         /* Unpacking stays within 128-bit lanes, so these hold
+          * pixels 0-3 + 8-11 and 4-7 + 12-15. */
+         res_lo = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+               _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+         res_hi = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+               _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+         _mm256_storeu_si256((__m256i*)(output + w + 0),
+               _mm256_permute2x128_si256(res_lo, res_hi, 0x20));
+         _mm256_storeu_si256((__m256i*)(output + w + 8),
+               _mm256_permute2x128_si256(res_lo, res_hi, 0x31));
+      }
+   }
+
+   if (vec_width < width)
+      conv_0rgb1555_argb8888_base((uint32_t*)output_ + vec_width,
+            (const uint16_t*)input_ + vec_width, width - vec_width, height,
+            out_stride, in_stride);
+}
+#endif
+
+void conv_0rgb1555_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   PIXCONV_CALL(conv_0rgb1555_argb8888)(output_, input_,
+         width, height, out_stride, in_stride);
+}
+
+static void conv_rgb565_argb8888_base(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
@@ -203,6 +404,12 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    const __m128i mul16_b    = _mm_set1_epi16(0x4200);
    const __m128i a          = _mm_set1_epi16(0x00ff);
 
+   int max_width            = width - 7;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask5    = vdup_n_u8(0x1f);
+   const uint8x8_t mask6    = vdup_n_u8(0x3f);
+   const uint8x8_t a        = vdup_n_u8(0xff);
+
    int max_width            = width - 7;
 #endif
 
@@ -237,6 +444,19 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+
+         res.val[0] = pixconv_expand5_neon(vand_u8(vmovn_u16(in), mask5));
+         res.val[1] = pixconv_expand6_neon(vand_u8(vshrn_n_u16(in, 5), mask6));
+         res.val[2] = pixconv_expand5_neon(vmovn_u16(vshrq_n_u16(in, 11)));
+         res.val[3] = a;
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -254,6 +474,68 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static void conv_rgb565_argb8888_avx2(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input    = (const uint16_t*)input_;
+   uint32_t *output         = (uint32_t*)output_;
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+   const __m256i a          = _mm256_set1_epi16(0x00ff);
+   int vec_width            = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < vec_width; w += 16)
+      {
+         __m256i res_lo, res_hi;
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i        r = _mm256_and_si256(_mm256_srli_epi16(in, 1), pix_mask_r);
+         __m256i        g = _mm256_and_si256(in, pix_mask_g);
+         __m256i        b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_b);
+
+         r                = _mm256_mulhi_epi16(r, mul16_r);
+         g                = _mm256_mulhi_epi16(g, mul16_g);
+         b                = _mm256_mulhi_epi16(b, mul16_b);
+
+         /* Pixels 0-3 + 8-11 and 4-7 + 12-15, see above. */
+         res_lo           = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+               _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+         res_hi           = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+               _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+         _mm256_storeu_si256((__m256i*)(output + w + 0),
+               _mm256_permute2x128_si256(res_lo, res_hi, 0x20));
+         _mm256_storeu_si256((__m256i*)(output + w + 8),
+               _mm256_permute2x128_si256(res_lo, res_hi, 0x31));
+      }
+   }
+
+   if (vec_width < width)
+      conv_rgb565_argb8888_base((uint32_t*)output_ + vec_width,
+            (const uint16_t*)input_ + vec_width, width - vec_width, height,
+            out_stride, in_stride);
+}
+#endif
+
+void conv_rgb565_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   PIXCONV_CALL(conv_rgb565_argb8888)(output_, input_,
+         width, height, out_stride, in_stride);
+}
+
 void conv_rgb565_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -261,7 +543,8 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    int h;
    const uint16_t *input    = (const uint16_t*)input_;
    uint32_t *output         = (uint32_t*)output_;
- #if defined(__SSE2__)
+
+#if defined(__SSE2__)
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -269,9 +552,17 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    const __m128i mul16_g    = _mm_set1_epi16(0x2080);
    const __m128i mul16_b    = _mm_set1_epi16(0x4200);
    const __m128i a          = _mm_set1_epi16(0x00ff);
-    int max_width            = width - 7;
+
+   int max_width            = width - 7;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask5    = vdup_n_u8(0x1f);
+   const uint8x8_t mask6    = vdup_n_u8(0x3f);
+   const uint8x8_t a        = vdup_n_u8(0xff);
+
+   int max_width            = width - 7;
 #endif
-    for (h = 0; h < height;
+
+   for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
@@ -279,27 +570,45 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
       for (; w < max_width; w += 8)
       {
          __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+         __m128i res_lo_rg, res_hi_rg, res_lo_ba, res_hi_ba;
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
          __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
          __m128i        g = _mm_and_si128(in, pix_mask_g);
          __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_b);
-          r                = _mm_mulhi_epi16(r, mul16_r);
+
+         r                = _mm_mulhi_epi16(r, mul16_r);
          g                = _mm_mulhi_epi16(g, mul16_g);
          b                = _mm_mulhi_epi16(b, mul16_b);
-          res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-          res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
-          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+
+         res_lo_rg        = _mm_unpacklo_epi8(r, g);
+         res_hi_rg        = _mm_unpackhi_epi8(r, g);
+         res_lo_ba        = _mm_unpacklo_epi8(b, a);
+         res_hi_ba        = _mm_unpackhi_epi8(b, a);
+
+         res_lo           = _mm_or_si128(res_lo_rg,
+               _mm_slli_si128(res_lo_ba, 2));
+         res_hi           = _mm_or_si128(res_hi_rg,
+               _mm_slli_si128(res_hi_ba, 2));
+
+         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+
+         res.val[0] = pixconv_expand5_neon(vmovn_u16(vshrq_n_u16(in, 11)));
+         res.val[1] = pixconv_expand6_neon(vand_u8(vshrn_n_u16(in, 5), mask6));
+         res.val[2] = pixconv_expand5_neon(vand_u8(vmovn_u16(in), mask5));
+         res.val[3] = a;
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
 #endif
-       for (; w < width; w++)
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 11) & 0x1f;
@@ -317,24 +626,70 @@ void conv_argb8888_rgba4444(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0xf000);
+   const __m128i mask_g  = _mm_set1_epi32(0x0f00);
+   const __m128i mask_b  = _mm_set1_epi32(0x00f0);
+
+   int max_width         = width - 7;
+#elif defined(PIXCONV_NEON)
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i res0, res1;
+         const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 4));
+
+         res0 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in0, 8), mask_r),
+                  _mm_and_si128(_mm_srli_epi32(in0, 4), mask_g)),
+               _mm_or_si128(_mm_and_si128(in0, mask_b),
+                  _mm_srli_epi32(in0, 28)));
+         res1 = _mm_or_si128(
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in1, 8), mask_r),
+                  _mm_and_si128(_mm_srli_epi32(in1, 4), mask_g)),
+               _mm_or_si128(_mm_and_si128(in1, mask_b),
+                  _mm_srli_epi32(in1, 28)));
+
+         /* Sign extend so the signed pack keeps the top bit */
+         res0 = _mm_srai_epi32(_mm_slli_epi32(res0, 16), 16);
+         res1 = _mm_srai_epi32(_mm_slli_epi32(res1, 16), 16);
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_packs_epi32(res0, res1));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x2_t res;
+         const uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+
+         /* Low byte is B:A, high byte is R:G */
+         res.val[0] = vsri_n_u8(in.val[0], in.val[3], 4);
+         res.val[1] = vsri_n_u8(in.val[2], in.val[1], 4);
+
+         vst2_u8((uint8_t*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r   = (col >> 16) & 0xf;
-         uint32_t g   = (col >>  8) & 0xf;
-         uint32_t b   = (col) & 0xf;
-         uint32_t a   = (col >>  24) & 0xf;
-         r            = (r >> 4) | r;
-         g            = (g >> 4) | g;
-         b            = (b >> 4) | b;
-         a            = (a >> 4) | a;
+         uint32_t r   = (col >> 20) & 0xf;
+         uint32_t g   = (col >> 12) & 0xf;
+         uint32_t b   = (col >>  4) & 0xf;
+         uint32_t a   = (col >> 28) & 0xf;
 
          output[w]    = (r << 12) | (g << 8) | (b << 4) | a;
       }
@@ -345,14 +700,62 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint16_t *input = (const uint16_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_lo = _mm_set1_epi16(0x000f);
+   const __m128i mask_hi = _mm_set1_epi16(0x0f00);
+
+   int max_width         = width - 7;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask  = vdup_n_u8(0x0f);
+
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         /* B and G in the low nibble of each byte, then R and A */
+         __m128i bg = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi16(in, 4), mask_lo),
+               _mm_and_si128(in, mask_hi));
+         __m128i ra = _mm_or_si128(_mm_srli_epi16(in, 12),
+               _mm_slli_epi16(_mm_and_si128(in, mask_lo), 8));
+
+         bg = _mm_or_si128(bg, _mm_slli_epi16(bg, 4));
+         ra = _mm_or_si128(ra, _mm_slli_epi16(ra, 4));
+
+         _mm_storeu_si128((__m128i*)(output + w + 0),
+               _mm_unpacklo_epi16(bg, ra));
+         _mm_storeu_si128((__m128i*)(output + w + 4),
+               _mm_unpackhi_epi16(bg, ra));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+         const uint8x8_t ba  = vmovn_u16(in);
+         const uint8x8_t rg  = vshrn_n_u16(in, 8);
+
+         res.val[0] = pixconv_expand4_neon(vshr_n_u8(ba, 4));
+         res.val[1] = pixconv_expand4_neon(vand_u8(rg, mask));
+         res.val[2] = pixconv_expand4_neon(vshr_n_u8(rg, 4));
+         res.val[3] = pixconv_expand4_neon(vand_u8(ba, mask));
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 12) & 0xf;
@@ -373,14 +776,50 @@ void conv_rgba4444_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint16_t *input = (const uint16_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi16((int16_t)0xf000);
+   const __m128i mask_g  = _mm_set1_epi16(0x0780);
+   const __m128i mask_b  = _mm_set1_epi16(0x001e);
+
+   int max_width         = width - 7;
+#elif defined(PIXCONV_NEON)
+   const uint16x8_t mask_r = vdupq_n_u16(0xf000);
+   const uint16x8_t mask_g = vdupq_n_u16(0x0780);
+   const uint16x8_t mask_b = vdupq_n_u16(0x001e);
+
+   int max_width           = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i r        = _mm_and_si128(in, mask_r);
+         __m128i g        = _mm_and_si128(_mm_srli_epi16(in, 1), mask_g);
+         __m128i b        = _mm_and_si128(_mm_srli_epi16(in, 3), mask_b);
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_or_si128(r, _mm_or_si128(g, b)));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t r        = vandq_u16(in, mask_r);
+         uint16x8_t g        = vandq_u16(vshrq_n_u16(in, 1), mask_g);
+         uint16x8_t b        = vandq_u16(vshrq_n_u16(in, 3), mask_b);
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 12) & 0xf;
@@ -455,6 +894,10 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
    int max_width             = width - 15;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask      = vdup_n_u8(0x1f);
+
+   int max_width             = width - 7;
 #endif
 
    for (h = 0; h < height;
@@ -506,6 +949,19 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
          /* Non-POT pixel sizes for the loss */
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8, out += 24)
+      {
+         uint8x8x3_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+
+         res.val[0] = pixconv_expand5_neon(vand_u8(vmovn_u16(in), mask));
+         res.val[1] = pixconv_expand5_neon(vand_u8(vshrn_n_u16(in, 5), mask));
+         res.val[2] = pixconv_expand5_neon(vand_u8(
+                  vmovn_u16(vshrq_n_u16(in, 10)), mask));
+
+         vst3_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -543,6 +999,11 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    const __m128i a          = _mm_set1_epi16(0x00ff);
 
    int max_width            = width - 15;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask5    = vdup_n_u8(0x1f);
+   const uint8x8_t mask6    = vdup_n_u8(0x3f);
+
+   int max_width            = width - 7;
 #endif
 
    for (h = 0; h < height; h++, output += out_stride, input += in_stride >> 1)
@@ -591,6 +1052,18 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
 
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8, out += 24)
+      {
+         uint8x8x3_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+
+         res.val[0] = pixconv_expand5_neon(vand_u8(vmovn_u16(in), mask5));
+         res.val[1] = pixconv_expand6_neon(vand_u8(vshrn_n_u16(in, 5), mask6));
+         res.val[2] = pixconv_expand5_neon(vmovn_u16(vshrq_n_u16(in, 11)));
+
+         vst3_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -610,19 +1083,41 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    }
 }
 
-void conv_bgr24_argb8888(void *output_, const void *input_,
+static void conv_bgr24_argb8888_base(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint8_t *input = (const uint8_t*)input_;
    uint32_t *output     = (uint32_t*)output_;
 
+#if defined(PIXCONV_NEON)
+   const uint8x8_t a    = vdup_n_u8(0xff);
+
+   int max_width        = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride)
    {
       const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int              w = 0;
+#if defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8, inp += 24)
+      {
+         uint8x8x4_t res;
+         const uint8x8x3_t in = vld3_u8(inp);
+
+         res.val[0] = in.val[0];
+         res.val[1] = in.val[1];
+         res.val[2] = in.val[2];
+         res.val[3] = a;
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t b = *inp++;
          uint32_t g = *inp++;
@@ -632,18 +1127,113 @@ void conv_bgr24_argb8888(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("ssse3")
+static void conv_bgr24_argb8888_ssse3(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint32_t *output     = (uint32_t*)output_;
+   const __m128i shuf   = _mm_setr_epi8(
+         0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+   const __m128i a      = _mm_set1_epi32((int)0xff000000u);
+   int vec_width        = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride)
+   {
+      const uint8_t *inp = input;
+      int w;
+      for (w = 0; w < vec_width; w += 16, inp += 48)
+      {
+         const __m128i in0 = _mm_loadu_si128((const __m128i*)(inp +  0));
+         const __m128i in1 = _mm_loadu_si128((const __m128i*)(inp + 16));
+         const __m128i in2 = _mm_loadu_si128((const __m128i*)(inp + 32));
+
+         /* Line up bytes 0, 12, 24 and 36 before spreading
+          * each group of four pixels out. */
+         _mm_storeu_si128((__m128i*)(output + w +  0), _mm_or_si128(a,
+                  _mm_shuffle_epi8(in0, shuf)));
+         _mm_storeu_si128((__m128i*)(output + w +  4), _mm_or_si128(a,
+                  _mm_shuffle_epi8(_mm_alignr_epi8(in1, in0, 12), shuf)));
+         _mm_storeu_si128((__m128i*)(output + w +  8), _mm_or_si128(a,
+                  _mm_shuffle_epi8(_mm_alignr_epi8(in2, in1, 8), shuf)));
+         _mm_storeu_si128((__m128i*)(output + w + 12), _mm_or_si128(a,
+                  _mm_shuffle_epi8(_mm_srli_si128(in2, 4), shuf)));
+      }
+   }
+
+   if (vec_width < width)
+      conv_bgr24_argb8888_base((uint32_t*)output_ + vec_width,
+            (const uint8_t*)input_ + vec_width * 3, width - vec_width, height,
+            out_stride, in_stride);
+}
+#endif
+
+void conv_bgr24_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   PIXCONV_CALL(conv_bgr24_argb8888)(output_, input_,
+         width, height, out_stride, in_stride);
+}
+
 void conv_argb8888_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0x1f << 10);
+   const __m128i mask_g  = _mm_set1_epi32(0x1f <<  5);
+   const __m128i mask_b  = _mm_set1_epi32(0x1f <<  0);
+
+   int max_width         = width - 7;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask  = vdup_n_u8(0xf8);
+
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 4));
+         __m128i res0      = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in0, 9), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in0, 6), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in0, 3), mask_b)));
+         __m128i res1      = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in1, 9), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in1, 6), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in1, 3), mask_b)));
+
+         /* Top bit is clear, so the signed pack can't saturate */
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_packs_epi32(res0, res1));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+         uint16x8_t r = vshll_n_u8(vand_u8(in.val[2], mask), 7);
+         uint16x8_t g = vshll_n_u8(vand_u8(in.val[1], mask), 2);
+         uint16x8_t b = vmovl_u8(vshr_n_u8(in.val[0], 3));
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint16_t r   = (col >> 19) & 0x1f;
@@ -654,6 +1244,74 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
    }
 }
 
+void conv_argb8888_rgb565(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0x1f << 11);
+   const __m128i mask_g  = _mm_set1_epi32(0x3f <<  5);
+   const __m128i mask_b  = _mm_set1_epi32(0x1f <<  0);
+
+   int max_width         = width - 7;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask5 = vdup_n_u8(0xf8);
+   const uint8x8_t mask6 = vdup_n_u8(0xfc);
+
+   int max_width         = width - 7;
+#endif
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+         const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 4));
+         __m128i res0      = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in0, 8), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in0, 5), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in0, 3), mask_b)));
+         __m128i res1      = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi32(in1, 8), mask_r),
+               _mm_or_si128(_mm_and_si128(_mm_srli_epi32(in1, 5), mask_g),
+                  _mm_and_si128(_mm_srli_epi32(in1, 3), mask_b)));
+
+         /* Sign extend so the signed pack keeps the top bit */
+         res0 = _mm_srai_epi32(_mm_slli_epi32(res0, 16), 16);
+         res1 = _mm_srai_epi32(_mm_slli_epi32(res1, 16), 16);
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_packs_epi32(res0, res1));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+         uint16x8_t r = vshll_n_u8(vand_u8(in.val[2], mask5), 8);
+         uint16x8_t g = vshll_n_u8(vand_u8(in.val[1], mask6), 3);
+         uint16x8_t b = vmovl_u8(vshr_n_u8(in.val[0], 3));
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
+      {
+         uint32_t col = input[w];
+         uint16_t r   = (col >> 19) & 0x1f;
+         uint16_t g   = (col >> 10) & 0x3f;
+         uint16_t b   = (col >>  3) & 0x1f;
+         output[w]    = (r << 11) | (g << 5) | (b << 0);
+      }
+   }
+}
+
 void conv_argb8888_bgr24(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -664,6 +1322,8 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
 
 #if defined(__SSE2__)
    int max_width = width - 15;
+#elif defined(PIXCONV_NEON)
+   int max_width = width - 7;
 #endif
 
    for (h = 0; h < height;
@@ -680,6 +1340,18 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
                _mm_loadu_si128((const __m128i*)(input + w +  8)),
                _mm_loadu_si128((const __m128i*)(input + w + 12)));
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8, out += 24)
+      {
+         uint8x8x3_t res;
+         const uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+
+         res.val[0] = in.val[0];
+         res.val[1] = in.val[1];
+         res.val[2] = in.val[2];
+
+         vst3_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -696,14 +1368,45 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_ag = _mm_set1_epi32((int)0xff00ff00u);
+   const __m128i mask_b  = _mm_set1_epi32(0x00ff0000);
+   const __m128i mask_r  = _mm_set1_epi32(0x000000ff);
+
+   int max_width         = width - 3;
+#elif defined(PIXCONV_NEON)
+   int max_width         = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 4)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(
+                  _mm_and_si128(in, mask_ag),
+                  _mm_or_si128(_mm_and_si128(_mm_slli_epi32(in, 16), mask_b),
+                     _mm_and_si128(_mm_srli_epi32(in, 16), mask_r))));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t px = vld4_u8((const uint8_t*)(input + w));
+         uint8x8_t b    = px.val[0];
+         px.val[0]      = px.val[2];
+         px.val[2]      = b;
+         vst4_u8((uint8_t*)(output + w), px);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
@@ -742,6 +1445,9 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
    const __m128i v_g_mul       = _mm_set1_epi16(YUV_MAT_V_G);
    const __m128i a             = _mm_cmpeq_epi16(
          _mm_setzero_si128(), _mm_setzero_si128());
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t chroma_offset = vdup_n_u8(128);
+   const uint8x8_t a             = vdup_n_u8(0xff);
 #endif
 
    for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride)
@@ -833,6 +1539,43 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(dst +  8), res2);
          _mm_storeu_si128((__m128i*)(dst + 12), res3);
       }
+#elif defined(PIXCONV_NEON)
+      /* Each loop processes 16 pixels, even and odd ones apart. */
+      for (; w + 16 <= width; w += 16, src += 32, dst += 16)
+      {
+         uint8x8x4_t res;
+         uint8x8x2_t r, g, b;
+         const uint8x8x4_t yuv = vld4_u8(src); /* Y0, U, Y1, V */
+         int16x8_t y0  = vreinterpretq_s16_u16(vshll_n_u8(yuv.val[0], 6));
+         int16x8_t y1  = vreinterpretq_s16_u16(vshll_n_u8(yuv.val[2], 6));
+         int16x8_t u   = vreinterpretq_s16_u16(
+               vsubl_u8(yuv.val[1], chroma_offset));
+         int16x8_t v   = vreinterpretq_s16_u16(
+               vsubl_u8(yuv.val[3], chroma_offset));
+         int16x8_t r_c = vmulq_n_s16(v, YUV_MAT_V_R);
+         int16x8_t g_c = vmlaq_n_s16(vmulq_n_s16(u, YUV_MAT_U_G),
+               v, YUV_MAT_V_G);
+         int16x8_t b_c = vmulq_n_s16(u, YUV_MAT_U_B);
+
+         /* Rounds, shifts and saturates into 8-bit. */
+         r = vzip_u8(vqrshrun_n_s16(vaddq_s16(y0, r_c), YUV_SHIFT),
+               vqrshrun_n_s16(vaddq_s16(y1, r_c), YUV_SHIFT));
+         g = vzip_u8(vqrshrun_n_s16(vaddq_s16(y0, g_c), YUV_SHIFT),
+               vqrshrun_n_s16(vaddq_s16(y1, g_c), YUV_SHIFT));
+         b = vzip_u8(vqrshrun_n_s16(vaddq_s16(y0, b_c), YUV_SHIFT),
+               vqrshrun_n_s16(vaddq_s16(y1, b_c), YUV_SHIFT));
+
+         res.val[3] = a;
+         res.val[0] = b.val[0];
+         res.val[1] = g.val[0];
+         res.val[2] = r.val[0];
+         vst4_u8((uint8_t*)(dst + 0), res);
+
+         res.val[0] = b.val[1];
+         res.val[1] = g.val[1];
+         res.val[2] = r.val[1];
+         vst4_u8((uint8_t*)(dst + 8), res);
+      }
 #endif
 
       /* Finish off the rest (if any) in C. */
@@ -873,4 +1616,3 @@ void conv_copy(void *output_, const void *input_,
          h++, output += out_stride, input += in_stride)
       memcpy(output, input, copy_len);
 }
-
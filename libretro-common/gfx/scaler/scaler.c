@@ -30,6 +30,49 @@
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Bands shorter than this cost more to hand off than to scale. */
+#define SCALER_MIN_BAND_ROWS 32
+
+enum scaler_pass
+{
+   SCALER_PASS_HORIZ = 0,
+   SCALER_PASS_VERT
+};
+
+/* Rows [first, last) of one pass. Horizontal bands are counted in
+ * input rows, vertical bands in output rows. */
+struct scaler_band
+{
+   const struct scaler_ctx *ctx;
+   const void *input;
+   void *output;
+   int first;
+   int last;
+   enum scaler_pass pass;
+};
+
+#ifdef HAVE_THREADS
+struct scaler_worker
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   struct scaler_band band;
+   bool die;
+   bool done;
+};
+
+struct scaler_pool
+{
+   struct scaler_worker *workers;
+   unsigned count;
+};
+#endif
+
 static bool allocate_frames(struct scaler_ctx *ctx)
 {
    uint64_t *scaled_frame = NULL;
@@ -74,9 +117,275 @@ static bool allocate_frames(struct scaler_ctx *ctx)
    return true;
 }
 
+/* Runs one band of the generic filter path. Both passes only
+ * ever write the rows of their band, and the filters are shared
+ * read-only, so bands can run concurrently and give the same
+ * result as scaling the whole image in one go. */
+static void scaler_ctx_scale_band(const struct scaler_band *band)
+{
+   const struct scaler_ctx *ctx = band->ctx;
+   struct scaler_ctx part       = *ctx;
+   int rows                     = band->last - band->first;
+
+   if (rows <= 0)
+      return;
+
+   if (band->pass == SCALER_PASS_HORIZ)
+   {
+      const uint8_t *input = (const uint8_t*)band->input
+         + band->first * ctx->in_stride;
+      int input_stride     = ctx->in_stride;
+
+      if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+      {
+         uint8_t *conv = (uint8_t*)ctx->input.frame
+            + band->first * ctx->input.stride;
+
+         ctx->in_pixconv(conv, input,
+               ctx->in_width, rows,
+               ctx->input.stride, ctx->in_stride);
+
+         input        = conv;
+         input_stride = ctx->input.stride;
+      }
+
+      part.scaled.frame  = ctx->scaled.frame
+         + band->first * (ctx->scaled.stride >> 3);
+      part.scaled.height = rows;
+
+      if (ctx->scaler_horiz)
+         ctx->scaler_horiz(&part, input, input_stride);
+   }
+   else
+   {
+      uint8_t *output   = (uint8_t*)band->output
+         + band->first * ctx->out_stride;
+
+      part.out_height      = rows;
+      part.vert.filter     = ctx->vert.filter
+         + band->first * ctx->vert.filter_stride;
+      part.vert.filter_pos = ctx->vert.filter_pos + band->first;
+
+      if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+      {
+         uint8_t *conv = (uint8_t*)ctx->output.frame
+            + band->first * ctx->output.stride;
+
+         if (ctx->scaler_vert)
+            ctx->scaler_vert(&part, conv, ctx->output.stride);
+
+         ctx->out_pixconv(output, conv,
+               ctx->out_width, rows,
+               ctx->out_stride, ctx->output.stride);
+      }
+      else if (ctx->scaler_vert)
+         ctx->scaler_vert(&part, output, ctx->out_stride);
+   }
+}
+
+#ifdef HAVE_THREADS
+static void scaler_worker_loop(void *data)
+{
+   struct scaler_worker *worker = (struct scaler_worker*)data;
+
+   for (;;)
+   {
+      bool die;
+      slock_lock(worker->lock);
+      while (worker->done && !worker->die)
+         scond_wait(worker->cond, worker->lock);
+      die = worker->die;
+      slock_unlock(worker->lock);
+
+      if (die)
+         break;
+
+      scaler_ctx_scale_band(&worker->band);
+
+      slock_lock(worker->lock);
+      worker->done = true;
+      scond_signal(worker->cond);
+      slock_unlock(worker->lock);
+   }
+}
+
+static void scaler_pool_free(struct scaler_pool *pool)
+{
+   unsigned i;
+
+   if (!pool)
+      return;
+
+   for (i = 0; i < pool->count; i++)
+   {
+      struct scaler_worker *worker = &pool->workers[i];
+
+      if (worker->thread)
+      {
+         slock_lock(worker->lock);
+         worker->die = true;
+         scond_signal(worker->cond);
+         slock_unlock(worker->lock);
+         sthread_join(worker->thread);
+      }
+
+      if (worker->lock)
+         slock_free(worker->lock);
+      if (worker->cond)
+         scond_free(worker->cond);
+   }
+
+   free(pool->workers);
+   free(pool);
+}
+
+static struct scaler_pool *scaler_pool_new(unsigned count)
+{
+   unsigned i;
+   struct scaler_pool *pool = (struct scaler_pool*)
+      calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   pool->workers = (struct scaler_worker*)
+      calloc(count, sizeof(*pool->workers));
+
+   if (!pool->workers)
+   {
+      free(pool);
+      return NULL;
+   }
+
+   pool->count = count;
+
+   for (i = 0; i < count; i++)
+   {
+      struct scaler_worker *worker = &pool->workers[i];
+
+      worker->done   = true;
+      worker->lock   = slock_new();
+      worker->cond   = scond_new();
+
+      if (!worker->lock || !worker->cond)
+         goto error;
+
+      worker->thread = sthread_create(scaler_worker_loop, worker);
+
+      if (!worker->thread)
+         goto error;
+   }
+
+   return pool;
+
+error:
+   scaler_pool_free(pool);
+   return NULL;
+}
+#endif
+
+/* Splits one pass into bands, hands all but the first to the
+ * worker threads and scales the first one on the calling thread. */
+static void scaler_ctx_scale_pass(const struct scaler_ctx *ctx,
+      enum scaler_pass pass, void *output, const void *input, int rows)
+{
+   struct scaler_band band;
+   unsigned bands = 1;
+#ifdef HAVE_THREADS
+   unsigned i;
+
+   if (ctx->pool)
+   {
+      unsigned max_bands = rows / SCALER_MIN_BAND_ROWS;
+
+      bands = ctx->pool->count + 1;
+      if (bands > max_bands)
+         bands = max_bands ? max_bands : 1;
+   }
+#endif
+
+   band.ctx    = ctx;
+   band.input  = input;
+   band.output = output;
+   band.pass   = pass;
+   band.first  = 0;
+   band.last   = rows / bands;
+
+#ifdef HAVE_THREADS
+   for (i = 1; i < bands; i++)
+   {
+      struct scaler_worker *worker = &ctx->pool->workers[i - 1];
+
+      worker->band       = band;
+      worker->band.first = (int)((int64_t)rows * i / bands);
+      worker->band.last  = (int)((int64_t)rows * (i + 1) / bands);
+
+      slock_lock(worker->lock);
+      worker->done = false;
+      scond_signal(worker->cond);
+      slock_unlock(worker->lock);
+   }
+#endif
+
+   scaler_ctx_scale_band(&band);
+
+#ifdef HAVE_THREADS
+   for (i = 1; i < bands; i++)
+   {
+      struct scaler_worker *worker = &ctx->pool->workers[i - 1];
+
+      slock_lock(worker->lock);
+      while (!worker->done)
+         scond_wait(worker->cond, worker->lock);
+      slock_unlock(worker->lock);
+   }
+#endif
+}
+
+static void scaler_ctx_free_filter(struct scaler_ctx *ctx)
+{
+   if (ctx->horiz.filter)
+      free(ctx->horiz.filter);
+   if (ctx->horiz.filter_pos)
+      free(ctx->horiz.filter_pos);
+   if (ctx->vert.filter)
+      free(ctx->vert.filter);
+   if (ctx->vert.filter_pos)
+      free(ctx->vert.filter_pos);
+   if (ctx->scaled.frame)
+      free(ctx->scaled.frame);
+   if (ctx->input.frame)
+      free(ctx->input.frame);
+   if (ctx->output.frame)
+      free(ctx->output.frame);
+
+   ctx->horiz.filter        = NULL;
+   ctx->horiz.filter_len    = 0;
+   ctx->horiz.filter_stride = 0;
+   ctx->horiz.filter_pos    = NULL;
+
+   ctx->vert.filter         = NULL;
+   ctx->vert.filter_len     = 0;
+   ctx->vert.filter_stride  = 0;
+   ctx->vert.filter_pos     = NULL;
+
+   ctx->scaled.frame        = NULL;
+   ctx->scaled.width        = 0;
+   ctx->scaled.height       = 0;
+   ctx->scaled.stride       = 0;
+
+   ctx->input.frame         = NULL;
+   ctx->input.stride        = 0;
+
+   ctx->output.frame        = NULL;
+   ctx->output.stride       = 0;
+}
+
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 {
-   scaler_ctx_gen_reset(ctx);
+   /* Keep the worker threads, only the filters depend
+    * on the new dimensions. */
+   scaler_ctx_free_filter(ctx);
 
    ctx->scaler_special = NULL;
    ctx->unscaled       = false;
@@ -195,8 +504,11 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
    }
    else
    {
-      ctx->scaler_horiz = scaler_argb8888_horiz;
-      ctx->scaler_vert  = scaler_argb8888_vert;
+      const scaler_argb8888_kernels_t *kernels =
+         scaler_argb8888_kernels_find();
+
+      ctx->scaler_horiz = kernels->horiz;
+      ctx->scaler_vert  = kernels->vert;
 
       switch (ctx->in_fmt)
       {
@@ -259,41 +571,12 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 {
-   if (ctx->horiz.filter)
-      free(ctx->horiz.filter);
-   if (ctx->horiz.filter_pos)
-      free(ctx->horiz.filter_pos);
-   if (ctx->vert.filter)
-      free(ctx->vert.filter);
-   if (ctx->vert.filter_pos)
-      free(ctx->vert.filter_pos);
-   if (ctx->scaled.frame)
-      free(ctx->scaled.frame);
-   if (ctx->input.frame)
-      free(ctx->input.frame);
-   if (ctx->output.frame)
-      free(ctx->output.frame);
-
-   ctx->horiz.filter        = NULL;
-   ctx->horiz.filter_len    = 0;
-   ctx->horiz.filter_stride = 0;
-   ctx->horiz.filter_pos    = NULL;
+   scaler_ctx_free_filter(ctx);
 
-   ctx->vert.filter         = NULL;
-   ctx->vert.filter_len     = 0;
-   ctx->vert.filter_stride  = 0;
-   ctx->vert.filter_pos     = NULL;
-
-   ctx->scaled.frame        = NULL;
-   ctx->scaled.width        = 0;
-   ctx->scaled.height       = 0;
-   ctx->scaled.stride       = 0;
-
-   ctx->input.frame         = NULL;
-   ctx->input.stride        = 0;
-
-   ctx->output.frame        = NULL;
-   ctx->output.stride       = 0;
+#ifdef HAVE_THREADS
+   scaler_pool_free(ctx->pool);
+#endif
+   ctx->pool = NULL;
 }
 
 /**
@@ -312,6 +595,31 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
    int input_stride        = ctx->in_stride;
    int output_stride       = ctx->out_stride;
 
+   if (!ctx->unscaled && !ctx->scaler_special)
+   {
+#ifdef HAVE_THREADS
+      unsigned workers = ctx->threads > 1 ? ctx->threads - 1 : 0;
+
+      if (ctx->pool && ctx->pool->count != workers)
+      {
+         scaler_pool_free(ctx->pool);
+         ctx->pool = NULL;
+      }
+
+      /* If the threads can't be started, just scale on this one. */
+      if (!ctx->pool && workers)
+         ctx->pool = scaler_pool_new(workers);
+#endif
+
+      /* Take generic filter path, pixel conversion is done
+       * per band as well. */
+      scaler_ctx_scale_pass(ctx, SCALER_PASS_HORIZ,
+            NULL, input, ctx->in_height);
+      scaler_ctx_scale_pass(ctx, SCALER_PASS_VERT,
+            output, NULL, ctx->out_height);
+      return;
+   }
+
    if (ctx->in_fmt != SCALER_FMT_ARGB8888)
    {
       ctx->in_pixconv(ctx->input.frame, input,
@@ -336,11 +644,10 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
             output_stride, input_stride);
    else
    {
-      /* Take generic filter path. */
       if (ctx->scaler_horiz)
          ctx->scaler_horiz(ctx, input_frame, input_stride);
       if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
+         ctx->scaler_vert (ctx, output_frame, output_stride);
    }
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
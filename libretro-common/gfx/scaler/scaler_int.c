@@ -20,9 +20,12 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <string.h>
+
 #include <gfx/scaler/scaler_int.h>
 
 #include <retro_inline.h>
+#include <features/features_cpu.h>
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
@@ -35,6 +38,40 @@
 #endif
 #endif
 
+/* SSE4.1 and AVX2 are dispatched at runtime, so build them even
+ * when the rest of the frontend isn't compiled with them. */
+#if !defined(SCALER_NO_SIMD) && defined(__SSE2__)
+#if defined(__GNUC__) && \
+   (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define SCALER_SSE41
+#define SCALER_AVX2
+#ifdef __SSE4_1__
+#define SCALER_SSE41_TARGET
+#else
+#define SCALER_SSE41_TARGET __attribute__((target("sse4.1")))
+#endif
+#ifdef __AVX2__
+#define SCALER_AVX2_TARGET
+#else
+#define SCALER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__AVX2__)
+#define SCALER_SSE41
+#define SCALER_AVX2
+#define SCALER_SSE41_TARGET
+#define SCALER_AVX2_TARGET
+#endif
+#endif
+
+#if defined(SCALER_SSE41) || defined(SCALER_AVX2)
+#include <immintrin.h>
+#endif
+
+#if !defined(SCALER_NO_SIMD) && (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define SCALER_NEON
+#include <arm_neon.h>
+#endif
+
 /* ARGB8888 scaler is split in two:
  *
  * First, horizontal scaler is applied.
@@ -86,7 +123,7 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
          for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
                input_base_y += (ctx->scaled.stride >> 2))
          {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x((uint16_t)filter_vert[y + 1] * 0x0001000100010001ull, (uint16_t)filter_vert[y + 0] * 0x0001000100010001ull);
             __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
 
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
@@ -94,7 +131,7 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int strid
 
          for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x(0, (uint16_t)filter_vert[y] * 0x0001000100010001ull);
             __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
 
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
@@ -165,7 +202,7 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 
          for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
          {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x((uint16_t)filter_horiz[x + 1] * 0x0001000100010001ull, (uint16_t)filter_horiz[x + 0] * 0x0001000100010001ull);
 
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi64x(0,
                      ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
@@ -176,7 +213,7 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
 
          for (; x < ctx->horiz.filter_len; x++)
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
+            __m128i coeff = _mm_set_epi64x(0, (uint16_t)filter_horiz[x] * 0x0001000100010001ull);
             __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
 
             col           = _mm_slli_epi16(col, 7);
@@ -230,6 +267,387 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
    }
 }
 
+#ifdef SCALER_SSE41
+/* Two output pixels per iteration; the scaled frame is padded
+ * to 8 pixels, so only the output needs a tail. */
+static void scaler_argb8888_vert_wide_sse2(const struct scaler_ctx *ctx,
+      void *output_, int stride)
+{
+   int h, w, y;
+   const uint64_t      *input = ctx->scaled.frame;
+   uint32_t           *output = (uint32_t*)output_;
+   const int16_t *filter_vert = ctx->vert.filter;
+   int              in_stride = ctx->scaled.stride >> 3;
+
+   for (h = 0; h < ctx->out_height; h++,
+         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
+         * in_stride;
+
+      for (w = 0; w < ctx->out_width; w += 2)
+      {
+         const uint64_t *input_base_y = input_base + w;
+         __m128i res                  = _mm_setzero_si128();
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += in_stride)
+         {
+            __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+            __m128i col   = _mm_loadu_si128((const __m128i*)input_base_y);
+
+            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+         }
+
+         res = _mm_srai_epi16(res, (7 - 2 - 2));
+         res = _mm_packus_epi16(res, res);
+
+         if (w + 1 < ctx->out_width)
+            _mm_storel_epi64((__m128i*)(output + w), res);
+         else
+            output[w] = _mm_cvtsi128_si32(res);
+      }
+   }
+}
+#endif
+
+#ifdef SCALER_SSE41
+static SCALER_SSE41_TARGET void scaler_argb8888_horiz_sse41(
+      const struct scaler_ctx *ctx, const void *input_, int stride)
+{
+   int h, w, x;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint64_t *output      = ctx->scaled.frame;
+   /* Broadcasts two coefficients over the four
+    * channels of two pixels. */
+   const __m128i dup2    = _mm_setr_epi8(
+         0, 1, 0, 1, 0, 1, 0, 1, 2, 3, 2, 3, 2, 3, 2, 3);
+
+   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2,
+         output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
+
+      for (w = 0; w < ctx->scaled.width; w++,
+            filter_horiz += ctx->horiz.filter_stride)
+      {
+         const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
+         __m128i res                  = _mm_setzero_si128();
+
+         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            int32_t c;
+            __m128i coeff, col;
+
+            memcpy(&c, filter_horiz + x, sizeof(c));
+            coeff = _mm_shuffle_epi8(_mm_cvtsi32_si128(c), dup2);
+            col   = _mm_cvtepu8_epi16(
+                  _mm_loadl_epi64((const __m128i*)(input_base_x + x)));
+            col   = _mm_slli_epi16(col, 7);
+            res   = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+         }
+
+         for (; x < ctx->horiz.filter_len; x++)
+         {
+            __m128i coeff = _mm_set1_epi16(filter_horiz[x]);
+            __m128i col   = _mm_cvtepu8_epi16(
+                  _mm_cvtsi32_si128(input_base_x[x]));
+
+            col           = _mm_slli_epi16(col, 7);
+            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+         }
+
+         res = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+         _mm_storel_epi64((__m128i*)(output + w), res);
+      }
+   }
+}
+#endif
+
+#ifdef SCALER_AVX2
+/* Four output pixels per iteration. */
+static SCALER_AVX2_TARGET void scaler_argb8888_vert_avx2(
+      const struct scaler_ctx *ctx, void *output_, int stride)
+{
+   int h, w, y;
+   const uint64_t      *input = ctx->scaled.frame;
+   uint32_t           *output = (uint32_t*)output_;
+   const int16_t *filter_vert = ctx->vert.filter;
+   int              in_stride = ctx->scaled.stride >> 3;
+
+   for (h = 0; h < ctx->out_height; h++,
+         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
+         * in_stride;
+
+      for (w = 0; w < ctx->out_width; w += 4)
+      {
+         const uint64_t *input_base_y = input_base + w;
+         __m256i res                  = _mm256_setzero_si256();
+         __m128i final;
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += in_stride)
+         {
+            __m256i coeff = _mm256_set1_epi16(filter_vert[y]);
+            __m256i col   = _mm256_loadu_si256((const __m256i*)input_base_y);
+
+            res           = _mm256_adds_epi16(
+                  _mm256_mulhi_epi16(col, coeff), res);
+         }
+
+         res   = _mm256_srai_epi16(res, (7 - 2 - 2));
+         /* Packs within each 128-bit lane, gather both low halves. */
+         res   = _mm256_packus_epi16(res, res);
+         res   = _mm256_permute4x64_epi64(res, _MM_SHUFFLE(3, 1, 2, 0));
+         final = _mm256_castsi256_si128(res);
+
+         if (w + 3 < ctx->out_width)
+            _mm_storeu_si128((__m128i*)(output + w), final);
+         else
+         {
+            int i;
+            for (i = 0; w + i < ctx->out_width; i++,
+                  final = _mm_srli_si128(final, 4))
+               output[w + i] = _mm_cvtsi128_si32(final);
+         }
+      }
+   }
+}
+
+static SCALER_AVX2_TARGET void scaler_argb8888_horiz_avx2(
+      const struct scaler_ctx *ctx, const void *input_, int stride)
+{
+   int h, w, x;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint64_t *output      = ctx->scaled.frame;
+   const __m128i dup2    = _mm_setr_epi8(
+         0, 1, 0, 1, 0, 1, 0, 1, 2, 3, 2, 3, 2, 3, 2, 3);
+   /* Same per 128-bit lane, the upper lane takes
+    * the third and fourth coefficient. */
+   const __m256i dup4    = _mm256_setr_epi8(
+         0, 1, 0, 1, 0, 1, 0, 1, 2, 3, 2, 3, 2, 3, 2, 3,
+         4, 5, 4, 5, 4, 5, 4, 5, 6, 7, 6, 7, 6, 7, 6, 7);
+
+   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2,
+         output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
+
+      for (w = 0; w < ctx->scaled.width; w++,
+            filter_horiz += ctx->horiz.filter_stride)
+      {
+         const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
+         __m256i res4                 = _mm256_setzero_si256();
+         __m128i res;
+
+         for (x = 0; (x + 3) < ctx->horiz.filter_len; x += 4)
+         {
+            int64_t c;
+            __m256i coeff, col;
+
+            memcpy(&c, filter_horiz + x, sizeof(c));
+            coeff = _mm256_shuffle_epi8(_mm256_set1_epi64x(c), dup4);
+            col   = _mm256_cvtepu8_epi16(
+                  _mm_loadu_si128((const __m128i*)(input_base_x + x)));
+            col   = _mm256_slli_epi16(col, 7);
+            res4  = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res4);
+         }
+
+         res = _mm_adds_epi16(_mm256_castsi256_si128(res4),
+               _mm256_extracti128_si256(res4, 1));
+
+         for (; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            int32_t c;
+            __m128i coeff, col;
+
+            memcpy(&c, filter_horiz + x, sizeof(c));
+            coeff = _mm_shuffle_epi8(_mm_cvtsi32_si128(c), dup2);
+            col   = _mm_cvtepu8_epi16(
+                  _mm_loadl_epi64((const __m128i*)(input_base_x + x)));
+            col   = _mm_slli_epi16(col, 7);
+            res   = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+         }
+
+         for (; x < ctx->horiz.filter_len; x++)
+         {
+            __m128i coeff = _mm_set1_epi16(filter_horiz[x]);
+            __m128i col   = _mm_cvtepu8_epi16(
+                  _mm_cvtsi32_si128(input_base_x[x]));
+
+            col           = _mm_slli_epi16(col, 7);
+            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+         }
+
+         res = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+         _mm_storel_epi64((__m128i*)(output + w), res);
+      }
+   }
+}
+#endif
+
+#ifdef SCALER_NEON
+/* (a * b) >> 16, same as _mm_mulhi_epi16. */
+static INLINE int16x4_t scaler_neon_mulhi(int16x4_t a, int16x4_t b)
+{
+   return vshrn_n_s32(vmull_s16(a, b), 16);
+}
+
+static void scaler_argb8888_vert_neon(const struct scaler_ctx *ctx,
+      void *output_, int stride)
+{
+   int h, w, y;
+   const uint64_t      *input = ctx->scaled.frame;
+   uint32_t           *output = (uint32_t*)output_;
+   const int16_t *filter_vert = ctx->vert.filter;
+   int              in_stride = ctx->scaled.stride >> 3;
+
+   for (h = 0; h < ctx->out_height; h++,
+         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
+         * in_stride;
+
+      for (w = 0; w < ctx->out_width; w += 2)
+      {
+         const uint64_t *input_base_y = input_base + w;
+         int16x8_t res                = vdupq_n_s16(0);
+         uint8x8_t final;
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += in_stride)
+         {
+            int16x4_t coeff = vdup_n_s16(filter_vert[y]);
+            int16x8_t col   = vld1q_s16((const int16_t*)input_base_y);
+
+            res             = vqaddq_s16(vcombine_s16(
+                     scaler_neon_mulhi(vget_low_s16(col), coeff),
+                     scaler_neon_mulhi(vget_high_s16(col), coeff)), res);
+         }
+
+         final = vqmovun_s16(vshrq_n_s16(res, (7 - 2 - 2)));
+
+         if (w + 1 < ctx->out_width)
+            vst1_u8((uint8_t*)(output + w), final);
+         else
+            output[w] = vget_lane_u32(vreinterpret_u32_u8(final), 0);
+      }
+   }
+}
+
+static void scaler_argb8888_horiz_neon(const struct scaler_ctx *ctx,
+      const void *input_, int stride)
+{
+   int h, w, x;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint64_t *output      = ctx->scaled.frame;
+
+   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2,
+         output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
+
+      for (w = 0; w < ctx->scaled.width; w++,
+            filter_horiz += ctx->horiz.filter_stride)
+      {
+         const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
+         /* Even and odd taps, summed at the end like the SSE2 code. */
+         int16x4_t res_lo             = vdup_n_s16(0);
+         int16x4_t res_hi             = vdup_n_s16(0);
+
+         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            int16x8_t col = vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(
+                        vreinterpret_u8_u32(vld1_u32(input_base_x + x))), 7));
+
+            res_lo        = vqadd_s16(scaler_neon_mulhi(vget_low_s16(col),
+                     vdup_n_s16(filter_horiz[x + 0])), res_lo);
+            res_hi        = vqadd_s16(scaler_neon_mulhi(vget_high_s16(col),
+                     vdup_n_s16(filter_horiz[x + 1])), res_hi);
+         }
+
+         for (; x < ctx->horiz.filter_len; x++)
+         {
+            int16x8_t col = vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(
+                        vreinterpret_u8_u32(vdup_n_u32(input_base_x[x]))), 7));
+
+            res_lo        = vqadd_s16(scaler_neon_mulhi(vget_low_s16(col),
+                     vdup_n_s16(filter_horiz[x])), res_lo);
+         }
+
+         vst1_s16((int16_t*)(output + w), vqadd_s16(res_hi, res_lo));
+      }
+   }
+}
+#endif
+
+unsigned scaler_argb8888_kernels_list(uint64_t cpu,
+      scaler_argb8888_kernels_t *list, unsigned len)
+{
+   unsigned count = 0;
+
+#ifdef SCALER_AVX2
+   /* AVX2 needs the AVX check for OS support of the YMM state. */
+   if (count < len
+         && (cpu & RETRO_SIMD_AVX)
+         && (cpu & RETRO_SIMD_AVX2))
+   {
+      list[count].horiz = scaler_argb8888_horiz_avx2;
+      list[count].vert  = scaler_argb8888_vert_avx2;
+      list[count].ident = "avx2";
+      count++;
+   }
+#endif
+
+#ifdef SCALER_SSE41
+   if (count < len && (cpu & RETRO_SIMD_SSE4))
+   {
+      list[count].horiz = scaler_argb8888_horiz_sse41;
+      list[count].vert  = scaler_argb8888_vert_wide_sse2;
+      list[count].ident = "sse4.1";
+      count++;
+   }
+#endif
+
+#ifdef SCALER_NEON
+   if (count < len && (cpu & RETRO_SIMD_NEON))
+   {
+      list[count].horiz = scaler_argb8888_horiz_neon;
+      list[count].vert  = scaler_argb8888_vert_neon;
+      list[count].ident = "neon";
+      count++;
+   }
+#endif
+
+   if (count < len)
+   {
+      list[count].horiz = scaler_argb8888_horiz;
+      list[count].vert  = scaler_argb8888_vert;
+#if defined(__SSE2__)
+      list[count].ident = "sse2";
+#else
+      list[count].ident = "c";
+#endif
+      count++;
+   }
+
+   (void)cpu;
+
+   return count;
+}
+
+const scaler_argb8888_kernels_t *scaler_argb8888_kernels_find(void)
+{
+   static scaler_argb8888_kernels_t kernels;
+
+   if (!kernels.horiz)
+      scaler_argb8888_kernels_list(cpu_features_get(), &kernels, 1);
+
+   return &kernels;
+}
+
 void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output_, const void *input_,
       int out_width, int out_height,
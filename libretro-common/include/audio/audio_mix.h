@@ -66,6 +66,38 @@ void audio_mix_volume_SSE2(float *out,
 
 void audio_mix_volume_C(float *dst, const float *src, float vol, size_t samples);
 
+/* Sample loops shared by the mixer and the audio driver.
+ * All of them take interleaved float samples, any alignment. */
+typedef struct audio_mix_kernels
+{
+   /* dst[i] += src[i] * vol */
+   void (*mix)(float *dst, const float *src, float vol, size_t samples);
+   /* dst[i] = src[i] * vol, dst may equal src */
+   void (*scale)(float *dst, const float *src, float vol, size_t samples);
+   /* buf[i] = clamp(buf[i], -1.0, 1.0) */
+   void (*clamp)(float *buf, size_t samples);
+   const char *ident;
+} audio_mix_kernels_t;
+
+/**
+ * audio_mix_kernels_list:
+ * @cpu                 : CPU feature mask, see cpu_features_get().
+ * @list                : filled with the kernels usable on @cpu,
+ *                        fastest first.
+ * @len                 : number of entries in @list.
+ *
+ * Returns: number of entries written to @list.
+ **/
+unsigned audio_mix_kernels_list(uint64_t cpu,
+      audio_mix_kernels_t *list, unsigned len);
+
+/**
+ * audio_mix_kernels_find:
+ *
+ * Returns: the fastest mix kernels for the running CPU.
+ **/
+const audio_mix_kernels_t *audio_mix_kernels_find(void);
+
 void audio_mix_free_chunk(audio_chunk_t *chunk);
 
 audio_chunk_t* audio_mix_load_wav_file(const char *path, int sample_rate);
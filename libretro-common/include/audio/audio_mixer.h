@@ -60,6 +60,7 @@ void audio_mixer_init(unsigned rate);
 
 void audio_mixer_done(void);
 
+/* All loaders take ownership of @buffer on success. */
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_ogg(void *buffer, int32_t size);
 audio_mixer_sound_t* audio_mixer_load_mod(void *buffer, int32_t size);
@@ -31,6 +31,7 @@
 RETRO_BEGIN_DECLS
 
 uint32_t encoding_crc32(uint32_t crc, const uint8_t *buf, size_t len);
+uint32_t encoding_crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
 uint32_t file_crc32(uint32_t crc, const char *path);
 
 RETRO_END_DECLS
@@ -143,6 +143,23 @@ struct file_archive_file_backend
       struct archive_extract_userdata *userdata,
       file_archive_file_cb file_cb);
    const char *ident;
+   /* Optional. Enumerates the members from an index of the
+    * archive instead of reading through it; file_cb gets no
+    * cdata. Returns false if the archive couldn't be parsed. */
+   bool (*archive_index_walk)(const char *path, const char *valid_exts,
+         file_archive_file_cb file_cb,
+         struct archive_extract_userdata *userdata);
+   /* Optional. Looks a member up by name, the first one if NULL. */
+   bool (*archive_index_find)(const char *path, const char *member,
+         uint32_t *crc32, uint32_t *size);
+   /* Optional. Drops what was kept since file_archive_cache_enable(). */
+   void (*cache_clear)(void);
+   /* Optional. Extracts an archive that comes in order, a piece
+    * at a time, without it being on disk. The free call returns
+    * whether all of the archive went through. */
+   void *(*extract_stream_new)(const char *target_dir);
+   bool (*extract_stream_write)(void *state, const uint8_t *data, size_t len);
+   bool (*extract_stream_free)(void *state);
 };
 
 int file_archive_parse_file_iterate(
@@ -207,6 +224,48 @@ const struct file_archive_file_backend* file_archive_get_file_backend(const char
  **/
 uint32_t file_archive_get_file_crc32(const char *path);
 
+typedef struct file_archive_extract_stream file_archive_extract_stream_t;
+
+/**
+ * file_archive_extract_stream_new:
+ * @path                         : name of the archive, picks the backend
+ * @target_dir                   : directory to extract to
+ *
+ * Starts extracting an archive as it is read, e.g. downloaded,
+ * instead of from a file. Members are put in place one by one as
+ * they are complete and their CRC matches.
+ *
+ * Returns: NULL if the archive type can't be extracted that way.
+ **/
+file_archive_extract_stream_t *file_archive_extract_stream_new(
+      const char *path, const char *target_dir);
+
+/* Feeds the next part of the archive. Returns false on an error,
+ * after which the stream can only be freed. */
+bool file_archive_extract_stream_write(file_archive_extract_stream_t *stream,
+      const uint8_t *data, size_t len);
+
+/* Returns true if the whole archive was extracted. */
+bool file_archive_extract_stream_free(file_archive_extract_stream_t *stream);
+
+/**
+ * file_archive_cache_enable:
+ * @enable                       : keep archive state between calls?
+ *
+ * While enabled, backends may keep what they parsed or decoded
+ * of the archives used last (e.g. a member index) for the next
+ * call on the same archive, from any thread. Disabling frees it
+ * all. To be called with no archive operation in progress.
+ **/
+void file_archive_cache_enable(bool enable);
+
+/* For backends: is caching enabled, and the lock guarding it. */
+bool file_archive_cache_is_enabled(void);
+
+void file_archive_cache_lock(void);
+
+void file_archive_cache_unlock(void);
+
 extern const struct file_archive_file_backend zlib_backend;
 extern const struct file_archive_file_backend sevenzip_backend;
 
@@ -60,6 +60,16 @@ struct config_file
    struct config_entry_list *last;
    unsigned include_depth;
    bool guaranteed_no_duplicates;
+   bool index_valid;
+   /* An entry was added, changed or removed since the file
+    * was read or last written. */
+   bool modified;
+
+   /* Open addressing table holding the first entry for every key,
+    * so lookups don't walk the list. */
+   struct config_entry_list **index;
+   size_t index_cap;
+   size_t index_count;
 
    struct config_include_list *includes;
 };
@@ -490,6 +490,28 @@ bool path_is_valid(const char *path);
 
 int32_t path_get_size(const char *path);
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Returns: last modification time of @path in seconds,
+ * or -1 if unknown on this platform or @path doesn't exist.
+ */
+int64_t path_get_mtime(const char *path);
+
+/**
+ * path_get_size_mtime:
+ * @path               : path
+ * @size               : size of @path in bytes
+ * @mtime              : last modification time of @path in seconds
+ *
+ * path_get_size() and path_get_mtime() with a single stat.
+ *
+ * Returns: true (1) if @path exists, otherwise false (0)
+ * and both are set to -1.
+ */
+bool path_get_size_mtime(const char *path, int32_t *size, int64_t *mtime);
+
 RETRO_END_DECLS
 
 #endif
@@ -44,6 +44,11 @@ rpng_t *rpng_alloc(void);
 
 void rpng_free(rpng_t *rpng);
 
+/* Inflates on a second thread while rpng_process_image() unfilters
+ * the lines already in, for big non-interlaced images. Set before
+ * the first rpng_process_image(). No-op without HAVE_THREADS. */
+void rpng_set_threaded(rpng_t *rpng, bool threaded);
+
 bool rpng_iterate_image(rpng_t *rpng);
 
 int rpng_process_image(rpng_t *rpng,
@@ -56,6 +61,15 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
 
+/* Trade file size for speed: every line uses the Up filter instead
+ * of the best of the five, deflate runs at its fastest level, and
+ * with HAVE_THREADS big images are deflated in independent blocks
+ * on the rjob pool. */
+bool rpng_save_image_argb_fast(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch);
+bool rpng_save_image_bgr24_fast(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch);
+
 RETRO_END_DECLS
 
 #endif
@@ -48,7 +48,10 @@ enum gl_capability_enum
    GL_CAPS_BGRA8888,
    GL_CAPS_GLES3_SUPPORTED,
    GL_CAPS_TEX_STORAGE,
-   GL_CAPS_TEX_STORAGE_EXT
+   GL_CAPS_TEX_STORAGE_EXT,
+   GL_CAPS_MAP_BUFFER_RANGE,
+   GL_CAPS_BUFFER_STORAGE,
+   GL_CAPS_TIMER_QUERY
 };
 
 bool gl_check_error(char **error_string);
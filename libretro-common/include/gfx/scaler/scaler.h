@@ -43,6 +43,8 @@ enum scaler_pix_fmt
    SCALER_FMT_RGBA4444
 };
 
+struct scaler_pool;
+
 enum scaler_type
 {
    SCALER_TYPE_UNKNOWN = 0,
@@ -87,6 +89,13 @@ struct scaler_ctx
    bool unscaled;
    struct scaler_filter horiz, vert;
 
+   /* Number of horizontal bands scaler_ctx_scale() splits the
+    * image into, each on its own thread. 0 or 1 scales on the
+    * calling thread. The worker threads are started on first use
+    * and kept until scaler_ctx_gen_reset(). */
+   unsigned threads;
+   struct scaler_pool *pool;
+
    struct
    {
       uint32_t *frame;
@@ -35,6 +35,35 @@ void scaler_argb8888_vert(const struct scaler_ctx *ctx,
 void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
       const void *input, int stride);
 
+typedef struct scaler_argb8888_kernels
+{
+   void (*horiz)(const struct scaler_ctx *ctx,
+         const void *input, int stride);
+   void (*vert)(const struct scaler_ctx *ctx,
+         void *output, int stride);
+   const char *ident;
+} scaler_argb8888_kernels_t;
+
+/**
+ * scaler_argb8888_kernels_list:
+ * @cpu                 : CPU feature mask, see cpu_features_get().
+ * @list                : filled with the kernels usable on @cpu,
+ *                        fastest first.
+ * @len                 : number of entries in @list.
+ *
+ * Returns: number of entries written to @list.
+ **/
+unsigned scaler_argb8888_kernels_list(uint64_t cpu,
+      scaler_argb8888_kernels_t *list, unsigned len);
+
+/**
+ * scaler_argb8888_kernels_find:
+ *
+ * Returns: the fastest horizontal/vertical kernels
+ * for the running CPU.
+ **/
+const scaler_argb8888_kernels_t *scaler_argb8888_kernels_find(void);
+
 void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output, const void *input,
       int out_width, int out_height,
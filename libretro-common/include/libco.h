@@ -23,6 +23,16 @@
 #ifndef LIBCO_H
 #define LIBCO_H
 
+/* Build options, for libco.c:
+ *
+ * LIBCO_STACK_POOL: amd64 and aarch64 map stacks with a guard page below
+ * them and keep deleted ones per thread for reuse, see libco/stack.c.
+ *
+ * LIBCO_NO_SIMD: Win64 and aarch64 skip saving the callee-saved SIMD
+ * registers (xmm6-xmm15, d8-d15) on co_switch. Only for code that keeps no
+ * floating point or vector values live across a switch. SysV amd64 has no
+ * callee-saved SIMD registers to begin with. */
+
 #include <retro_common_api.h>
 
 #ifdef LIBCO_C
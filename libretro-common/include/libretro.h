@@ -1169,6 +1169,27 @@ typedef int (RETRO_CALLCONV *retro_vfs_remove_t)(const char *path);
  * Introduced in VFS API v1 */
 typedef int (RETRO_CALLCONV *retro_vfs_rename_t)(const char *old_path, const char *new_path);
 
+/* Opaque asynchronous read request
+ * Introduced in VFS API v3 */
+struct retro_vfs_async_request;
+
+/* Returned by async_poll while the request is still in flight
+ * Introduced in VFS API v3 */
+#define RETRO_VFS_ASYNC_PENDING -2
+
+/* Start reading len bytes at offset from the start of the file into s, in the background, e.g. to prefetch
+ * upcoming sectors without stalling the emulation thread. The file position is left untouched.
+ * Both s and the file handle must remain valid until async_poll no longer returns RETRO_VFS_ASYNC_PENDING.
+ * Frontends may complete the request before returning. Returns the request, or NULL for error.
+ * Introduced in VFS API v3 */
+typedef struct retro_vfs_async_request *(RETRO_CALLCONV *retro_vfs_read_async_t)(struct retro_vfs_file_handle *stream, void *s, uint64_t len, uint64_t offset);
+
+/* Check on a read started with read_async. If wait is set, block until it completes. Returns RETRO_VFS_ASYNC_PENDING
+ * while in flight, otherwise the number of bytes read, or -1 for error, and the request becomes invalid.
+ * Every request must be polled to completion, waiting for it if its data is not wanted anymore.
+ * Introduced in VFS API v3 */
+typedef int64_t (RETRO_CALLCONV *retro_vfs_async_poll_t)(struct retro_vfs_async_request *request, bool wait);
+
 struct retro_vfs_interface
 {
    /* VFS API v1 */
@@ -1185,6 +1206,9 @@ struct retro_vfs_interface
 	retro_vfs_rename_t rename;
    /* VFS API v2 */
    retro_vfs_truncate_t truncate;
+   /* VFS API v3 */
+   retro_vfs_read_async_t read_async;
+   retro_vfs_async_poll_t async_poll;
 };
 
 struct retro_vfs_interface_info
@@ -1605,6 +1629,10 @@ struct retro_log_callback
 #define RETRO_SIMD_MOVBE    (1 << 19)
 #define RETRO_SIMD_CMOV     (1 << 20)
 #define RETRO_SIMD_ASIMD    (1 << 21)
+#define RETRO_SIMD_AVX512   (1 << 22)
+#define RETRO_SIMD_SVE      (1 << 23)
+#define RETRO_SIMD_PCLMUL   (1 << 24)
+#define RETRO_SIMD_CRC32    (1 << 25)
 
 typedef uint64_t retro_perf_tick_t;
 typedef int64_t retro_time_t;
@@ -58,7 +58,12 @@ typedef const struct dspfilter_implementation *(
 const struct dspfilter_implementation *dspfilter_get_implementation(
       dspfilter_simd_mask_t mask);
 
-#define DSPFILTER_API_VERSION 1
+/* Version 2 added process_planar. Hosts still accept version 1
+ * plugins, which simply end before that member. */
+#define DSPFILTER_API_VERSION 2
+
+/* Largest block handed to dspfilter_process_planar_t. */
+#define DSPFILTER_PLANAR_BLOCK 256
 
 struct dspfilter_info
 {
@@ -165,9 +170,22 @@ typedef void (*dspfilter_free_t)(void *data);
 typedef void (*dspfilter_process_t)(void *data,
       struct dspfilter_output *output, const struct dspfilter_input *input);
 
+/* Processes one block of planar audio in place.
+ * samples[0] is the left channel, samples[1] the right one.
+ * Both are 16-byte aligned, frames is never more than
+ * DSPFILTER_PLANAR_BLOCK.
+ *
+ * Only for filters which output one frame per input frame.
+ * The host runs consecutive planar filters block by block,
+ * deinterleaving once for the whole run, so each filter works
+ * on cache-resident channel arrays it can vectorize over. */
+typedef void (*dspfilter_process_planar_t)(void *data,
+      float **samples, unsigned frames);
+
 struct dspfilter_implementation
 {
    dspfilter_init_t     init;
+   /* May be NULL if process_planar is set. */
    dspfilter_process_t  process;
    dspfilter_free_t     free;
 
@@ -180,6 +198,9 @@ struct dspfilter_implementation
    /* Computer-friendly short version of ident.
     * Lower case, no spaces and special characters, etc. */
    const char *short_ident;
+
+   /* Optional, used instead of process when set. */
+   dspfilter_process_planar_t process_planar;
 };
 
 RETRO_END_DECLS
@@ -65,6 +65,24 @@ void dir_list_sort(struct string_list *list, bool dir_first);
  **/
 void dir_list_free(struct string_list *list);
 
+/**
+ * dir_list_cache_enable:
+ * @enable : keep directory listings around?
+ *
+ * While enabled, listings of the last few directories read are
+ * shared by all dir_list_new() callers, on any thread, and only
+ * read again once the directory itself was modified.
+ * Disabling frees them. To be called with no listing in progress.
+ **/
+void dir_list_cache_enable(bool enable);
+
+/**
+ * dir_list_cache_clear:
+ *
+ * Forgets all cached directory listings.
+ **/
+void dir_list_cache_clear(void);
+
 RETRO_END_DECLS
 
 #endif
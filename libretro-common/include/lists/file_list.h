@@ -48,6 +48,12 @@ typedef struct file_list
 {
    struct item_file *list;
 
+   /* Holds path, label and alt of every entry if set,
+    * see file_list_use_arena(). */
+   struct rarena *arena;
+   /* Labels of arena lists, interned. */
+   struct string_pool *labels;
+
    size_t capacity;
    size_t size;
 } file_list_t;
@@ -83,6 +89,19 @@ void file_list_free(file_list_t *list);
  */
 bool file_list_reserve(file_list_t *list, size_t nitems);
 
+/**
+ * @brief allocates the strings of the list from an arena
+ *
+ * Lists that are rebuilt often then release their strings in
+ * one go on file_list_clear(). The strings must not be freed
+ * or replaced other than through the file_list functions.
+ * Only works on an empty list.
+ *
+ * @param list
+ * @return whether the list uses an arena
+ */
+bool file_list_use_arena(file_list_t *list);
+
 bool file_list_append(file_list_t *userdata, const char *path,
       const char *label, unsigned type, size_t current_directory_ptr,
       size_t entry_index);
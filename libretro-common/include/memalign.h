@@ -35,6 +35,14 @@ void *memalign_alloc_aligned(size_t size);
 
 void memalign_free(void *ptr);
 
+/* For big buffers that are touched all over every frame, like
+ * savestates. Blocks of 2 MiB and up are backed by huge pages where
+ * the OS hands them out, which cuts TLB misses. The memory is zeroed.
+ * Free with memalign_free_large(). */
+void *memalign_alloc_large(size_t size);
+
+void memalign_free_large(void *ptr);
+
 RETRO_END_DECLS
 
 #endif
@@ -34,6 +34,11 @@ RETRO_BEGIN_DECLS
 struct http_t;
 struct http_connection_t;
 
+/* Gets the body of a response as it comes in. Returning false
+ * fails the transfer. */
+typedef bool (*net_http_sink_t)(void *userdata,
+      const uint8_t *data, size_t len);
+
 struct http_connection_t *net_http_connection_new(const char *url, const char *method, const char *data);
 
 bool net_http_connection_iterate(struct http_connection_t *conn);
@@ -44,12 +49,24 @@ void net_http_connection_free(struct http_connection_t *conn);
 
 const char *net_http_connection_url(struct http_connection_t *conn);
 
+/* Asks for the body from byte 'start' on, to resume a transfer.
+ * The server answers 206 if it did, or 200 with the whole body. */
+void net_http_connection_set_range(struct http_connection_t *conn,
+      size_t start);
+
 struct http_t *net_http_new(struct http_connection_t *conn);
 
 /* You can use this to call net_http_update
  * only when something will happen; select() it for reading. */
 int net_http_fd(struct http_t *state);
 
+/* Hands the body to 'sink' instead of keeping it in memory, so
+ * net_http_data has nothing to return. Check net_http_status in
+ * the sink before using the data. To be set before the first
+ * net_http_update. */
+void net_http_set_sink(struct http_t *state,
+      net_http_sink_t sink, void *userdata);
+
 /* Returns true if it's done, or if something broke.
  * 'total' will be 0 if it's not known. */
 bool net_http_update(struct http_t *state, size_t* progress, size_t* total);
@@ -68,6 +85,13 @@ uint8_t* net_http_data(struct http_t *state, size_t* len, bool accept_error);
 /* Cleans up all memory. */
 void net_http_delete(struct http_t *state);
 
+/* While enabled, requests ask the server to keep the connection
+ * open and net_http_delete keeps the connections of complete
+ * transfers, so the next request to the same host and port skips
+ * the TCP and TLS handshakes. Disabling closes them all. To be
+ * called with no transfer in progress. */
+void net_http_pool_enable(bool enable);
+
 /* URL Encode a string */
 void net_http_urlencode(char **dest, const char *source);
 
@@ -0,0 +1,60 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (fifo_spsc.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_FIFO_SPSC_H
+#define __LIBRETRO_SDK_FIFO_SPSC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Lock-free byte FIFO for exactly one writer thread and one reader
+ * thread, e.g. the main thread feeding an audio callback. Neither
+ * side ever blocks; write and read move as much as fits. */
+typedef struct fifo_spsc fifo_spsc_t;
+
+fifo_spsc_t *fifo_spsc_new(size_t size);
+
+void fifo_spsc_free(fifo_spsc_t *fifo);
+
+/* Writer side. Returns the number of bytes written. */
+size_t fifo_spsc_write(fifo_spsc_t *fifo, const void *in_buf, size_t size);
+
+size_t fifo_spsc_write_avail(fifo_spsc_t *fifo);
+
+/* Reader side. Returns the number of bytes read. */
+size_t fifo_spsc_read(fifo_spsc_t *fifo, void *out_buf, size_t size);
+
+size_t fifo_spsc_read_avail(fifo_spsc_t *fifo);
+
+/* Empties the FIFO. Only while neither side is using it. */
+void fifo_spsc_clear(fifo_spsc_t *fifo);
+
+/* Capacity in bytes, as passed to fifo_spsc_new(). */
+size_t fifo_spsc_size(fifo_spsc_t *fifo);
+
+RETRO_END_DECLS
+
+#endif
@@ -42,6 +42,19 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/* Which task a free worker picks next. In threaded mode several
+ * workers run tasks side by side, so this only orders tasks that
+ * are waiting, it never stops one from progressing while a worker
+ * is idle. */
+enum task_priority
+{
+   TASK_PRIORITY_NORMAL = 0,
+   /* Something the user is waiting to see, e.g. a thumbnail */
+   TASK_PRIORITY_HIGH,
+   /* Long running background work, e.g. a content scan */
+   TASK_PRIORITY_LOW
+};
+
 
 typedef struct retro_task retro_task_t;
 typedef void (*retro_task_callback_t)(void *task_data,
@@ -59,6 +72,8 @@ typedef bool (*retro_task_retriever_t)(retro_task_t *task, void *data);
 
 typedef bool (*retro_task_condition_fn_t)(void *data);
 
+typedef void (*retro_task_trace_t)(retro_task_t *task, bool begin);
+
 typedef struct
 {
    char *source_file;
@@ -110,6 +125,8 @@ struct retro_task
 
    enum task_type type;
 
+   enum task_priority priority;
+
    /* don't touch this. */
    retro_task_t *next;
 };
@@ -179,6 +196,10 @@ void task_queue_unset_threaded(void);
 
 bool task_queue_is_threaded(void);
 
+/* Sets a function to be called right before and after each run
+ * of a task handler, on the thread running it. NULL to disable. */
+void task_queue_set_trace(retro_task_trace_t trace);
+
 /**
  * Calls func for every running task
  * until it returns true.
@@ -194,6 +215,9 @@ bool task_queue_find(task_finder_data_t *find_data);
  */
 void task_queue_retrieve(task_retriever_data_t *data);
 
+/* Number of tasks which haven't finished running yet. */
+unsigned task_queue_count(void);
+
  /* Checks for finished tasks
   * Takes the finished tasks, if any,
   * and runs their callbacks.
@@ -0,0 +1,71 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rarena.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBRETRO_RARENA_H
+#define _LIBRETRO_RARENA_H
+
+#include <stddef.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* A bump allocator for many small allocations that share a lifetime,
+ * like the strings of a menu list. Nothing is freed on its own, the
+ * whole arena is reset or freed at once. */
+typedef struct rarena rarena_t;
+
+/**
+ * rarena_new:
+ * @chunk_size          : size of the blocks taken from malloc(),
+ *                        0 for the default of 4 KiB.
+ *
+ * Returns: a new, empty arena, or NULL.
+ **/
+rarena_t *rarena_new(size_t chunk_size);
+
+void rarena_free(rarena_t *arena);
+
+/**
+ * rarena_reset:
+ * @arena               : the arena.
+ *
+ * Drops every allocation at once. One block is kept for the
+ * allocations that follow, the others go back to the heap.
+ **/
+void rarena_reset(rarena_t *arena);
+
+/**
+ * rarena_alloc:
+ * @arena               : the arena.
+ * @size                : size in bytes.
+ *
+ * Returns: memory aligned for any basic type, valid until the
+ * arena is reset or freed, or NULL.
+ **/
+void *rarena_alloc(rarena_t *arena, size_t size);
+
+char *rarena_strdup(rarena_t *arena, const char *str);
+
+RETRO_END_DECLS
+
+#endif
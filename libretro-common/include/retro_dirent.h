@@ -23,6 +23,8 @@
 #ifndef __RETRO_DIRENT_H
 #define __RETRO_DIRENT_H
 
+#include <stdint.h>
+
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
 
@@ -64,6 +66,19 @@ const char *retro_dirent_get_name(struct RDIR *rdir);
  */
 bool retro_dirent_is_dir(struct RDIR *rdir, const char *path);
 
+/**
+ *
+ * retro_dirent_get_size:
+ * @rdir         : pointer to the directory entry.
+ * @path         : path to the directory entry.
+ *
+ * Size of the directory listing entry, without a separate
+ * stat() on platforms whose listing carries it.
+ *
+ * Returns: size in bytes, -1 if unknown.
+ */
+int64_t retro_dirent_get_size(struct RDIR *rdir, const char *path);
+
 void retro_closedir(struct RDIR *rdir);
 
 RETRO_END_DECLS
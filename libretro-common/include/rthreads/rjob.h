@@ -0,0 +1,113 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rjob.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_RJOB_H
+#define __LIBRETRO_SDK_RJOB_H
+
+#include <retro_common_api.h>
+
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+#define RJOB_MAX_WORKERS 31
+
+typedef void (*rjob_func_t)(void *userdata);
+typedef void (*rjob_range_func_t)(void *userdata,
+      unsigned begin, unsigned end);
+
+/* Counts the jobs submitted with it that haven't finished yet.
+ * Zero it before the first use, it needs no cleanup. */
+typedef struct rjob_group
+{
+   unsigned pending;
+} rjob_group_t;
+
+/**
+ * rjob_init:
+ * @workers             : number of worker threads, 0 picks one
+ *                        less than the number of cores, leaving
+ *                        a core to the thread that runs the
+ *                        libretro core.
+ *
+ * Starts the shared job pool or takes another reference to it.
+ * Only the first call decides the number of workers.
+ *
+ * Returns: true if the pool can be used, which is also the case
+ * when it has no workers and every job runs on the caller.
+ **/
+bool rjob_init(unsigned workers);
+
+/**
+ * rjob_deinit:
+ *
+ * Drops a reference taken by rjob_init(). The last one waits
+ * for queued jobs and stops the workers.
+ **/
+void rjob_deinit(void);
+
+/**
+ * rjob_worker_count:
+ *
+ * Returns: number of worker threads in the pool. Waiting threads
+ * help with the work, so up to this many plus one jobs run at once.
+ **/
+unsigned rjob_worker_count(void);
+
+/**
+ * rjob_submit:
+ * @group               : wait group the job is counted in, can be NULL.
+ * @func                : job function.
+ * @userdata            : passed to @func.
+ *
+ * Queues a job. A worker submitting a job keeps it on its own queue,
+ * idle workers steal from the others. The job runs right away on the
+ * calling thread if the pool has no workers or the queue is full.
+ **/
+void rjob_submit(rjob_group_t *group, rjob_func_t func, void *userdata);
+
+/**
+ * rjob_wait:
+ * @group               : wait group.
+ *
+ * Runs queued jobs on the calling thread until every job
+ * submitted with @group has finished. Can be called from a job.
+ **/
+void rjob_wait(rjob_group_t *group);
+
+/**
+ * rjob_parallel_for:
+ * @count               : number of items.
+ * @grain               : minimum number of items per job.
+ * @func                : called with consecutive, disjoint ranges
+ *                        covering [0, @count).
+ * @userdata            : passed to @func.
+ *
+ * Splits the items over the pool, runs the first range on the
+ * calling thread and returns once every range is done.
+ **/
+void rjob_parallel_for(unsigned count, unsigned grain,
+      rjob_range_func_t func, void *userdata);
+
+RETRO_END_DECLS
+
+#endif
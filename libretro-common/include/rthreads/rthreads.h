@@ -40,6 +40,18 @@ typedef struct scond scond_t;
 typedef unsigned sthread_tls_t;
 #endif
 
+enum sthread_role
+{
+   STHREAD_ROLE_DEFAULT = 0,
+   /* Runs the libretro core */
+   STHREAD_ROLE_CORE,
+   STHREAD_ROLE_VIDEO,
+   STHREAD_ROLE_AUDIO,
+   /* I/O, saving, encoding and other work that can wait */
+   STHREAD_ROLE_BACKGROUND,
+   STHREAD_ROLE_LAST
+};
+
 /**
  * sthread_create:
  * @start_routine           : thread entry callback function
@@ -103,6 +115,14 @@ void sthread_join(sthread_t *thread);
  */
 bool sthread_isself(sthread_t *thread);
 
+/**
+ * sthread_get_current_thread_id:
+ *
+ * Returns: an identifier for the calling thread, only meant to tell
+ * threads apart (e.g. in log lines).
+ */
+uintptr_t sthread_get_current_thread_id(void);
+
 /**
  * slock_new:
  *
@@ -199,6 +219,33 @@ int scond_broadcast(scond_t *cond);
  **/
 void scond_signal(scond_t *cond);
 
+/**
+ * sthread_set_role_policy:
+ * @role                    : thread role.
+ * @affinity_mask           : CPUs threads of @role may run on, bit n
+ *                            stands for CPU n. 0 leaves it to the OS.
+ * @priority                : schedule core, video and audio threads
+ *                            ahead of the rest (SCHED_FIFO, MMCSS,
+ *                            QoS classes) and background threads
+ *                            behind it.
+ *
+ * Sets what sthread_set_role() does for @role. Has to be called
+ * before the threads taking the role are started.
+ **/
+void sthread_set_role_policy(enum sthread_role role,
+      uint64_t affinity_mask, bool priority);
+
+/**
+ * sthread_set_role:
+ * @role                    : thread role.
+ *
+ * Applies the policy of @role to the calling thread.
+ *
+ * Returns: false if part of the policy couldn't be applied, usually
+ * because the system doesn't allow it or doesn't support it.
+ **/
+bool sthread_set_role(enum sthread_role role);
+
 #ifdef HAVE_THREAD_STORAGE
 /**
  * @brief Creates a thread local storage key
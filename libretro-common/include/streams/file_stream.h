@@ -66,6 +66,30 @@ int64_t filestream_seek(RFILE *stream, int64_t offset, int seek_position);
 
 int64_t filestream_read(RFILE *stream, void *data, int64_t len);
 
+/**
+ * filestream_read_async:
+ * @offset             : where to read from, the file position is kept
+ * @request            : set while the read is in flight
+ *
+ * Starts reading @len bytes into @data in the background, when the
+ * frontend can. Returns RETRO_VFS_ASYNC_PENDING then, and the read
+ * must be waited for with filestream_async_poll() before @data or
+ * @stream go away. Otherwise it is done already and this returns
+ * what filestream_read() would.
+ **/
+int64_t filestream_read_async(RFILE *stream, void *data, int64_t len,
+      int64_t offset, struct retro_vfs_async_request **request);
+
+/**
+ * filestream_async_poll:
+ * @wait               : block until the read is done
+ *
+ * Returns RETRO_VFS_ASYNC_PENDING while @request is in flight,
+ * otherwise the bytes read or -1, after which @request is gone.
+ **/
+int64_t filestream_async_poll(struct retro_vfs_async_request *request,
+      bool wait);
+
 int64_t filestream_write(RFILE *stream, const void *data, int64_t len);
 
 int64_t filestream_tell(RFILE *stream);
@@ -94,6 +94,8 @@ int64_t intfstream_get_size(intfstream_internal_t *intf);
 
 int intfstream_flush(intfstream_internal_t *intf);
 
+int64_t intfstream_truncate(intfstream_internal_t *intf, int64_t length);
+
 intfstream_t* intfstream_open_file(const char *path,
       unsigned mode, unsigned hints);
 
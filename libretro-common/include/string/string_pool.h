@@ -0,0 +1,99 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (string_pool.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIBRETRO_STRING_POOL_H
+#define _LIBRETRO_STRING_POOL_H
+
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Stores each distinct string once. Strings given out by the same
+ * pool are equal if and only if their pointers are, and stay valid
+ * until released as many times as they were interned. A pool is not
+ * thread-safe. */
+typedef struct string_pool string_pool_t;
+
+string_pool_t *string_pool_new(void);
+
+void string_pool_free(string_pool_t *pool);
+
+/**
+ * string_pool_clear:
+ * @pool                : the pool.
+ *
+ * Drops every string at once, whatever its reference count.
+ **/
+void string_pool_clear(string_pool_t *pool);
+
+/**
+ * string_pool_intern:
+ * @pool                : the pool.
+ * @str                 : string to add.
+ *
+ * Takes a reference to the pooled copy of @str, adding it
+ * if it isn't in the pool yet.
+ *
+ * Returns: the pooled string, NULL if @str is NULL or on
+ * allocation failure.
+ **/
+const char *string_pool_intern(string_pool_t *pool, const char *str);
+
+/**
+ * string_pool_intern_len:
+ * @pool                : the pool.
+ * @str                 : characters to add, need not be terminated.
+ * @len                 : number of characters in @str.
+ *
+ * Same as string_pool_intern() for the first @len characters of @str.
+ **/
+const char *string_pool_intern_len(string_pool_t *pool,
+      const char *str, size_t len);
+
+/**
+ * string_pool_find:
+ * @pool                : the pool.
+ * @str                 : string to look for.
+ *
+ * Returns: the pooled copy of @str without taking a reference,
+ * or NULL if the pool doesn't hold it.
+ **/
+const char *string_pool_find(const string_pool_t *pool, const char *str);
+
+/**
+ * string_pool_release:
+ * @pool                : the pool.
+ * @str                 : string returned by string_pool_intern(),
+ *                        or NULL.
+ *
+ * Drops a reference, the string is freed with the last one.
+ **/
+void string_pool_release(string_pool_t *pool, const char *str);
+
+size_t string_pool_count(const string_pool_t *pool);
+
+RETRO_END_DECLS
+
+#endif
@@ -38,6 +38,12 @@ typedef struct retro_vfs_file_handle libretro_vfs_implementation_file;
 typedef struct libretro_vfs_implementation_file libretro_vfs_implementation_file;
 #endif
 
+#ifdef VFS_FRONTEND
+typedef struct retro_vfs_async_request libretro_vfs_implementation_async;
+#else
+typedef struct libretro_vfs_implementation_async libretro_vfs_implementation_async;
+#endif
+
 libretro_vfs_implementation_file *retro_vfs_file_open_impl(const char *path, unsigned mode, unsigned hints);
 
 int retro_vfs_file_close_impl(libretro_vfs_implementation_file *stream);
@@ -64,4 +70,16 @@ int retro_vfs_file_rename_impl(const char *old_path, const char *new_path);
 
 const char *retro_vfs_file_get_path_impl(libretro_vfs_implementation_file *stream);
 
+libretro_vfs_implementation_async *retro_vfs_file_read_async_impl(libretro_vfs_implementation_file *stream, void *s, uint64_t len, uint64_t offset);
+
+int64_t retro_vfs_async_poll_impl(libretro_vfs_implementation_async *request, bool wait);
+
+/* Frontends: starts and stops the thread asynchronous reads are
+ * done on. Without it, or without threads, reads complete before
+ * retro_vfs_file_read_async_impl() returns. Stopping waits for
+ * every request left, so it must come before their buffers go. */
+void retro_vfs_async_init_impl(void);
+
+void retro_vfs_async_deinit_impl(void);
+
 #endif
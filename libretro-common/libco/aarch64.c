@@ -22,15 +22,34 @@ extern "C" {
 static thread_local uint64_t co_active_buffer[64];
 static thread_local cothread_t co_active_handle;
 
+#include "stack.c"
+
+/* Callee-saved per AAPCS64: x19-x29, sp, lr and the low halves of v8-v15
+ * (d8-d15). x8-x15 are caller-saved and need no saving. LIBCO_NO_SIMD
+ * skips d8-d15 for code that keeps no floating point or SIMD values in
+ * them across co_switch. */
+#ifdef LIBCO_NO_SIMD
+#define CO_SAVE_SIMD ""
+#define CO_LOAD_SIMD ""
+#else
+#define CO_SAVE_SIMD \
+      "  stp d8,  d9,  [x1]\n" \
+      "  stp d10, d11, [x1, #16]\n" \
+      "  stp d12, d13, [x1, #32]\n" \
+      "  stp d14, d15, [x1, #48]\n"
+#define CO_LOAD_SIMD \
+      "  ldp d8,  d9,  [x0]\n" \
+      "  ldp d10, d11, [x0, #16]\n" \
+      "  ldp d12, d13, [x0, #32]\n" \
+      "  ldp d14, d15, [x0, #48]\n"
+#endif
+
 asm (
       ".globl co_switch_aarch64\n"
       ".globl _co_switch_aarch64\n"
       "co_switch_aarch64:\n"
       "_co_switch_aarch64:\n"
-      "  stp x8,  x9,  [x1]\n"
-      "  stp x10, x11, [x1, #16]\n"
-      "  stp x12, x13, [x1, #32]\n"
-      "  stp x14, x15, [x1, #48]\n"
+      CO_SAVE_SIMD
       "  str x19, [x1, #72]\n"
       "  stp x20, x21, [x1, #80]\n"
       "  stp x22, x23, [x1, #96]\n"
@@ -40,10 +59,7 @@ asm (
       "  mov x16, sp\n"
       "  stp x16, x30, [x1, #160]\n"
 
-      "  ldp x8,  x9,  [x0]\n"
-      "  ldp x10, x11, [x0, #16]\n"
-      "  ldp x12, x13, [x0, #32]\n"
-      "  ldp x14, x15, [x0, #48]\n"
+      CO_LOAD_SIMD
       "  ldr x19, [x0, #72]\n"
       "  ldp x20, x21, [x0, #80]\n"
       "  ldp x22, x23, [x0, #96]\n"
@@ -68,7 +84,12 @@ cothread_t co_create(unsigned int size, void (*entrypoint)(void))
 {
    size = (size + 1023) & ~1023;
    cothread_t handle = 0;
-#if HAVE_POSIX_MEMALIGN >= 1
+#ifdef LIBCO_STACK_POOL
+   /* Page aligned, the stack top ends up at handle + size */
+   size += 512;
+   handle = co_stack_alloc(&size);
+   size -= 512;
+#elif HAVE_POSIX_MEMALIGN >= 1
    if (posix_memalign(&handle, 1024, size + 512) < 0)
       return 0;
 #else
@@ -80,14 +101,14 @@ cothread_t co_create(unsigned int size, void (*entrypoint)(void))
 
    uint64_t *ptr = (uint64_t*)handle;
    /* Non-volatiles.  */
-   ptr[0]  = 0; /* x8  */
-   ptr[1]  = 0; /* x9  */
-   ptr[2]  = 0; /* x10 */
-   ptr[3]  = 0; /* x11 */
-   ptr[4]  = 0; /* x12 */
-   ptr[5]  = 0; /* x13 */
-   ptr[6]  = 0; /* x14 */
-   ptr[7]  = 0; /* x15 */
+   ptr[0]  = 0; /* d8  */
+   ptr[1]  = 0; /* d9  */
+   ptr[2]  = 0; /* d10 */
+   ptr[3]  = 0; /* d11 */
+   ptr[4]  = 0; /* d12 */
+   ptr[5]  = 0; /* d13 */
+   ptr[6]  = 0; /* d14 */
+   ptr[7]  = 0; /* d15 */
    ptr[8]  = 0; /* padding */
    ptr[9]  = 0; /* x19 */
    ptr[10] = 0; /* x20 */
@@ -114,7 +135,11 @@ cothread_t co_active(void)
 
 void co_delete(cothread_t handle)
 {
+#ifdef LIBCO_STACK_POOL
+   co_stack_free(handle);
+#else
    free(handle);
+#endif
 }
 
 void co_switch(cothread_t handle)
@@ -23,8 +23,36 @@ static thread_local cothread_t co_active_handle = 0;
 static void (*co_swap)(cothread_t, cothread_t) = 0;
 #endif
 
+#include "stack.c"
+
 #ifdef _WIN32
 /* ABI: Win64 */
+#ifdef LIBCO_NO_SIMD
+/* xmm6-xmm15 are callee-saved on Win64, only safe if no code running on
+ * the cothreads keeps values in them across co_switch */
+static unsigned char co_swap_function[] = {
+  0x48, 0x89, 0x22,                                 /* mov    [rdx],rsp        */
+  0x48, 0x8b, 0x21,                                 /* mov    rsp,[rcx]        */
+  0x58,                                             /* pop    rax              */
+  0x48, 0x89, 0x6a, 0x08,                           /* mov    [rdx+0x8],rbp    */
+  0x48, 0x89, 0x72, 0x10,                           /* mov    [rdx+0x10],rsi   */
+  0x48, 0x89, 0x7a, 0x18,                           /* mov    [rdx+0x18],rdi   */
+  0x48, 0x89, 0x5a, 0x20,                           /* mov    [rdx+0x20],rbx   */
+  0x4c, 0x89, 0x62, 0x28,                           /* mov    [rdx+0x28],r12   */
+  0x4c, 0x89, 0x6a, 0x30,                           /* mov    [rdx+0x30],r13   */
+  0x4c, 0x89, 0x72, 0x38,                           /* mov    [rdx+0x38],r14   */
+  0x4c, 0x89, 0x7a, 0x40,                           /* mov    [rdx+0x40],r15   */
+  0x48, 0x8b, 0x69, 0x08,                           /* mov    rbp,[rcx+0x8]    */
+  0x48, 0x8b, 0x71, 0x10,                           /* mov    rsi,[rcx+0x10]   */
+  0x48, 0x8b, 0x79, 0x18,                           /* mov    rdi,[rcx+0x18]   */
+  0x48, 0x8b, 0x59, 0x20,                           /* mov    rbx,[rcx+0x20]   */
+  0x4c, 0x8b, 0x61, 0x28,                           /* mov    r12,[rcx+0x28]   */
+  0x4c, 0x8b, 0x69, 0x30,                           /* mov    r13,[rcx+0x30]   */
+  0x4c, 0x8b, 0x71, 0x38,                           /* mov    r14,[rcx+0x38]   */
+  0x4c, 0x8b, 0x79, 0x40,                           /* mov    r15,[rcx+0x40]   */
+  0xff, 0xe0,                                       /* jmp    rax              */
+};
+#else
 static unsigned char co_swap_function[] = {
   0x48, 0x89, 0x22,                                 /* mov    [rdx],rsp        */
   0x48, 0x8b, 0x21,                                 /* mov    rsp,[rcx]        */
@@ -59,18 +87,19 @@ static unsigned char co_swap_function[] = {
   0x4c, 0x8b, 0x79, 0x40,                           /* mov    r15,[rcx+0x40]   */
   0x48, 0x81, 0xc1, 0x80, 0x00, 0x00, 0x00,         /* add    rcx,0x80         */
   0x48, 0x83, 0xe1, 0xf0,                           /* and    rcx,-0x10        */
-  0x0f, 0x29, 0x31,                                 /* movaps [rcx],xmm6       */
-  0x0f, 0x29, 0x79, 0x10,                           /* movaps [rcx+0x10],xmm7  */
-  0x44, 0x0f, 0x29, 0x41, 0x20,                     /* movaps [rcx+0x20],xmm8  */
-  0x44, 0x0f, 0x29, 0x49, 0x30,                     /* movaps [rcx+0x30],xmm9  */
-  0x44, 0x0f, 0x29, 0x51, 0x40,                     /* movaps [rcx+0x40],xmm10 */
-  0x44, 0x0f, 0x29, 0x59, 0x50,                     /* movaps [rcx+0x50],xmm11 */
-  0x44, 0x0f, 0x29, 0x61, 0x60,                     /* movaps [rcx+0x60],xmm12 */
-  0x44, 0x0f, 0x29, 0x69, 0x70,                     /* movaps [rcx+0x70],xmm13 */
-  0x44, 0x0f, 0x29, 0xb1, 0x80, 0x00, 0x00, 0x00,   /* movaps [rcx+0x80],xmm14 */
-  0x44, 0x0f, 0x29, 0xb9, 0x90, 0x00, 0x00, 0x00,   /* movaps [rcx+0x90],xmm15 */
+  0x0f, 0x28, 0x31,                                 /* movaps xmm6,[rcx]       */
+  0x0f, 0x28, 0x79, 0x10,                           /* movaps xmm7,[rcx+0x10]  */
+  0x44, 0x0f, 0x28, 0x41, 0x20,                     /* movaps xmm8,[rcx+0x20]  */
+  0x44, 0x0f, 0x28, 0x49, 0x30,                     /* movaps xmm9,[rcx+0x30]  */
+  0x44, 0x0f, 0x28, 0x51, 0x40,                     /* movaps xmm10,[rcx+0x40] */
+  0x44, 0x0f, 0x28, 0x59, 0x50,                     /* movaps xmm11,[rcx+0x50] */
+  0x44, 0x0f, 0x28, 0x61, 0x60,                     /* movaps xmm12,[rcx+0x60] */
+  0x44, 0x0f, 0x28, 0x69, 0x70,                     /* movaps xmm13,[rcx+0x70] */
+  0x44, 0x0f, 0x28, 0xb1, 0x80, 0x00, 0x00, 0x00,   /* movaps xmm14,[rcx+0x80] */
+  0x44, 0x0f, 0x28, 0xb9, 0x90, 0x00, 0x00, 0x00,   /* movaps xmm15,[rcx+0x90] */
   0xff, 0xe0,                                       /* jmp    rax              */
 };
+#endif
 
 #include <windows.h>
 
@@ -112,8 +141,6 @@ static void co_init(void)
    unsigned long long size = (addr - base) + sizeof(co_swap_function);
    mprotect((void*)base, size, PROT_READ | PROT_WRITE | PROT_EXEC);
 }
-#else
-static void co_init(void) {}
 #endif
 #endif
 
@@ -154,8 +181,12 @@ cothread_t co_create(unsigned int size, void (*entrypoint)(void))
       *--p = (long long)entrypoint;               /* start of function */
       *(long long*)handle = (long long)p;         /* stack pointer */
    }
+#else
+#ifdef LIBCO_STACK_POOL
+   if((handle = (cothread_t)co_stack_alloc(&size)))
 #else
    if((handle = (cothread_t)malloc(size)))
+#endif
    {
       long long *p = (long long*)((char*)handle + size); /* seek to top of stack */
       *--p = (long long)crash;                           /* crash if entrypoint returns */
@@ -171,6 +202,8 @@ void co_delete(cothread_t handle)
 {
 #ifdef __GENODE__
    genode_free_secondary_stack(handle);
+#elif defined(LIBCO_STACK_POOL)
+   co_stack_free(handle);
 #else
    free(handle);
 #endif
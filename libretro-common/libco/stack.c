@@ -0,0 +1,113 @@
+/*
+  libco stack pool
+  license: public domain
+
+  Included by the backends when built with LIBCO_STACK_POOL. Stacks are
+  mapped from the OS with a guard page between the context storage at the
+  bottom and the stack above it, so an overflow faults instead of
+  trashing the context or the heap. co_delete keeps up to
+  CO_STACK_POOL_SIZE stacks per thread, so a core that creates and
+  deletes threads of the same size gets them back without a syscall.
+
+    [ context page | guard page | stack ... top ]
+    ^ handle
+*/
+
+#ifdef LIBCO_STACK_POOL
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#define CO_STACK_POOL_SIZE 16
+
+static thread_local void *co_stack_pool[CO_STACK_POOL_SIZE];
+static thread_local unsigned co_stack_pool_count;
+
+static size_t co_stack_page_size(void)
+{
+   static size_t page = 0;
+   if (!page)
+   {
+#ifdef _WIN32
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      page = info.dwPageSize;
+#else
+      page = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+   }
+   return page;
+}
+
+/* The mapping size lives at the end of the context page */
+#define CO_STACK_TOTAL(handle) \
+   (((size_t*)((char*)(handle) + co_stack_page_size()))[-1])
+
+/* Returns a stack of at least *size bytes, counting the context storage,
+ * and sets *size to the distance from the handle to the top. */
+static void *co_stack_alloc(unsigned int *size)
+{
+   unsigned i;
+   void *base;
+   size_t page  = co_stack_page_size();
+   size_t total = 2 * page + ((*size + page - 1) & ~(page - 1));
+
+   for (i = 0; i < co_stack_pool_count; i++)
+   {
+      if (CO_STACK_TOTAL(co_stack_pool[i]) == total)
+      {
+         base = co_stack_pool[i];
+         co_stack_pool[i] = co_stack_pool[--co_stack_pool_count];
+         *size = (unsigned int)total;
+         return base;
+      }
+   }
+
+#ifdef _WIN32
+   {
+      DWORD old_protect;
+      base = VirtualAlloc(NULL, total, MEM_RESERVE | MEM_COMMIT,
+            PAGE_READWRITE);
+      if (!base)
+         return 0;
+      VirtualProtect((char*)base + page, page, PAGE_NOACCESS, &old_protect);
+   }
+#else
+   base = mmap(NULL, total, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (base == MAP_FAILED)
+      return 0;
+   mprotect((char*)base + page, page, PROT_NONE);
+#endif
+
+   CO_STACK_TOTAL(base) = total;
+   *size                = (unsigned int)total;
+   return base;
+}
+
+static void co_stack_free(void *handle)
+{
+   if (!handle)
+      return;
+
+   if (co_stack_pool_count < CO_STACK_POOL_SIZE)
+   {
+      co_stack_pool[co_stack_pool_count++] = handle;
+      return;
+   }
+
+#ifdef _WIN32
+   VirtualFree(handle, 0, MEM_RELEASE);
+#else
+   munmap(handle, CO_STACK_TOTAL(handle));
+#endif
+}
+
+#endif
@@ -21,6 +21,8 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #if defined(_WIN32) && defined(_XBOX)
 #include <xtl.h>
@@ -38,6 +40,307 @@
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Directories whose listing dir_list_cache_enable() keeps around. */
+#define DIR_LIST_CACHE_DIRS 32
+
+/* Everything in a directory but '.' and '..', in readdir order.
+ * Names are NUL separated in one buffer. */
+typedef struct dir_list_listing
+{
+   char *names;
+   size_t names_size;
+   size_t names_cap;
+   size_t *offsets;
+   bool *is_dir;
+   size_t count;
+   size_t cap;
+} dir_list_listing_t;
+
+typedef struct dir_list_cache_entry
+{
+   char *dir;
+   int64_t mtime;
+   int64_t listed;
+   unsigned used;
+   dir_list_listing_t listing;
+} dir_list_cache_entry_t;
+
+static bool dir_list_cache_enabled              = false;
+static unsigned dir_list_cache_clock            = 0;
+static dir_list_cache_entry_t dir_list_cache[DIR_LIST_CACHE_DIRS];
+#ifdef HAVE_THREADS
+static slock_t *dir_list_cache_lock             = NULL;
+#endif
+
+static void dir_list_listing_free(dir_list_listing_t *listing)
+{
+   free(listing->names);
+   free(listing->offsets);
+   free(listing->is_dir);
+   memset(listing, 0, sizeof(*listing));
+}
+
+static bool dir_list_listing_append(dir_list_listing_t *listing,
+      const char *name, bool is_dir)
+{
+   size_t len = strlen(name) + 1;
+
+   if (listing->count == listing->cap)
+   {
+      size_t cap      = listing->cap ? listing->cap * 2 : 64;
+      size_t *offsets = (size_t*)realloc(listing->offsets,
+            cap * sizeof(*offsets));
+      bool *dirs;
+
+      if (!offsets)
+         return false;
+      listing->offsets = offsets;
+
+      if (!(dirs = (bool*)realloc(listing->is_dir, cap * sizeof(*dirs))))
+         return false;
+      listing->is_dir  = dirs;
+      listing->cap     = cap;
+   }
+
+   if (listing->names_size + len > listing->names_cap)
+   {
+      size_t cap  = listing->names_cap ? listing->names_cap : 1024;
+      char *names = NULL;
+
+      while (listing->names_size + len > cap)
+         cap *= 2;
+
+      if (!(names = (char*)realloc(listing->names, cap)))
+         return false;
+      listing->names     = names;
+      listing->names_cap = cap;
+   }
+
+   memcpy(listing->names + listing->names_size, name, len);
+   listing->offsets[listing->count] = listing->names_size;
+   listing->is_dir[listing->count]  = is_dir;
+   listing->names_size             += len;
+   listing->count++;
+
+   return true;
+}
+
+static bool dir_list_listing_copy(dir_list_listing_t *dst,
+      const dir_list_listing_t *src)
+{
+   memset(dst, 0, sizeof(*dst));
+
+   if (!src->count)
+      return true;
+
+   dst->names   = (char*)malloc(src->names_size);
+   dst->offsets = (size_t*)malloc(src->count * sizeof(*dst->offsets));
+   dst->is_dir  = (bool*)malloc(src->count * sizeof(*dst->is_dir));
+
+   if (!dst->names || !dst->offsets || !dst->is_dir)
+   {
+      dir_list_listing_free(dst);
+      return false;
+   }
+
+   memcpy(dst->names, src->names, src->names_size);
+   memcpy(dst->offsets, src->offsets, src->count * sizeof(*dst->offsets));
+   memcpy(dst->is_dir, src->is_dir, src->count * sizeof(*dst->is_dir));
+   dst->names_size = dst->names_cap = src->names_size;
+   dst->count      = dst->cap       = src->count;
+
+   return true;
+}
+
+static bool dir_list_listing_read(const char *dir,
+      dir_list_listing_t *listing)
+{
+   struct RDIR *entry = retro_opendir(dir);
+
+   if (!entry || retro_dirent_error(entry))
+      goto error;
+
+   retro_dirent_include_hidden(entry, true);
+
+   while (retro_readdir(entry))
+   {
+      char file_path[PATH_MAX_LENGTH];
+      const char *name = retro_dirent_get_name(entry);
+
+      if (string_is_equal(name, ".") || string_is_equal(name, ".."))
+         continue;
+
+      file_path[0] = '\0';
+      fill_pathname_join(file_path, dir, name, sizeof(file_path));
+
+      if (!dir_list_listing_append(listing, name,
+               retro_dirent_is_dir(entry, file_path)))
+         goto error;
+   }
+
+   retro_closedir(entry);
+   return true;
+
+error:
+   if (entry)
+      retro_closedir(entry);
+   dir_list_listing_free(listing);
+   return false;
+}
+
+static void dir_list_cache_lock_acquire(void)
+{
+#ifdef HAVE_THREADS
+   slock_lock(dir_list_cache_lock);
+#endif
+}
+
+static void dir_list_cache_lock_release(void)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(dir_list_cache_lock);
+#endif
+}
+
+static void dir_list_cache_entry_free(dir_list_cache_entry_t *entry)
+{
+   free(entry->dir);
+   dir_list_listing_free(&entry->listing);
+   memset(entry, 0, sizeof(*entry));
+}
+
+/* A listing is still good for as long as the directory keeps
+ * the mtime it had when it was read, unless that mtime is no
+ * older than the read itself: mtimes only have a resolution of
+ * seconds, so the directory could have changed again since
+ * without it showing. */
+static bool dir_list_cache_get(const char *dir, int64_t mtime,
+      dir_list_listing_t *listing)
+{
+   unsigned i;
+   bool found = false;
+
+   dir_list_cache_lock_acquire();
+
+   for (i = 0; i < DIR_LIST_CACHE_DIRS; i++)
+   {
+      dir_list_cache_entry_t *entry = &dir_list_cache[i];
+
+      if (!entry->dir || !string_is_equal(entry->dir, dir))
+         continue;
+
+      if (     entry->mtime == mtime
+            && entry->mtime <  entry->listed
+            && dir_list_listing_copy(listing, &entry->listing))
+      {
+         entry->used = ++dir_list_cache_clock;
+         found       = true;
+      }
+      else
+         dir_list_cache_entry_free(entry);
+      break;
+   }
+
+   dir_list_cache_lock_release();
+
+   return found;
+}
+
+static void dir_list_cache_put(const char *dir, int64_t mtime,
+      int64_t listed, const dir_list_listing_t *listing)
+{
+   unsigned i;
+   dir_list_cache_entry_t *slot = &dir_list_cache[0];
+
+   /* Couldn't be reused anyway. */
+   if (mtime >= listed)
+      return;
+
+   dir_list_cache_lock_acquire();
+
+   for (i = 0; i < DIR_LIST_CACHE_DIRS; i++)
+   {
+      dir_list_cache_entry_t *entry = &dir_list_cache[i];
+
+      if (entry->dir && string_is_equal(entry->dir, dir))
+      {
+         slot = entry;
+         break;
+      }
+
+      if (!entry->dir || entry->used < slot->used)
+         slot = entry;
+   }
+
+   dir_list_cache_entry_free(slot);
+
+   if (     (slot->dir = strdup(dir))
+         && dir_list_listing_copy(&slot->listing, listing))
+   {
+      slot->mtime  = mtime;
+      slot->listed = listed;
+      slot->used   = ++dir_list_cache_clock;
+   }
+   else
+      dir_list_cache_entry_free(slot);
+
+   dir_list_cache_lock_release();
+}
+
+/**
+ * dir_list_cache_enable:
+ * @enable : keep directory listings around?
+ *
+ * While enabled, listings of the last few directories read are
+ * shared by all dir_list_new() callers, on any thread, and only
+ * read again once the directory itself was modified.
+ * Disabling frees them. To be called with no listing in progress.
+ **/
+void dir_list_cache_enable(bool enable)
+{
+   if (enable == dir_list_cache_enabled)
+      return;
+
+   if (enable)
+   {
+#ifdef HAVE_THREADS
+      if (!(dir_list_cache_lock = slock_new()))
+         return;
+#endif
+      dir_list_cache_enabled = true;
+      return;
+   }
+
+   dir_list_cache_clear();
+   dir_list_cache_enabled = false;
+#ifdef HAVE_THREADS
+   slock_free(dir_list_cache_lock);
+   dir_list_cache_lock    = NULL;
+#endif
+}
+
+/**
+ * dir_list_cache_clear:
+ *
+ * Forgets all cached directory listings.
+ **/
+void dir_list_cache_clear(void)
+{
+   unsigned i;
+
+   if (!dir_list_cache_enabled)
+      return;
+
+   dir_list_cache_lock_acquire();
+   for (i = 0; i < DIR_LIST_CACHE_DIRS; i++)
+      dir_list_cache_entry_free(&dir_list_cache[i]);
+   dir_list_cache_lock_release();
+}
+
 static int qstrcmp_plain(const void *a_, const void *b_)
 {
    const struct string_list_elem *a = (const struct string_list_elem*)a_;
@@ -172,25 +475,44 @@ static int dir_list_read(const char *dir,
       bool include_dirs, bool include_hidden,
       bool include_compressed, bool recursive)
 {
-   struct RDIR *entry = retro_opendir(dir);
+   size_t i;
+   dir_list_listing_t listing;
+   int64_t mtime  = -1;
+   int64_t listed = 0;
 
-   if (!entry || retro_dirent_error(entry))
-      goto error;
+   memset(&listing, 0, sizeof(listing));
 
-   retro_dirent_include_hidden(entry, include_hidden);
+   if (dir_list_cache_enabled)
+   {
+      /* Taken before reading, so that a change made while
+       * reading keeps the listing from being reused. */
+      mtime  = path_get_mtime(dir);
+      listed = (int64_t)time(NULL);
 
-   while (retro_readdir(entry))
+      if (mtime < 0)
+         return -1;
+   }
+
+   if (mtime < 0 || !dir_list_cache_get(dir, mtime, &listing))
+   {
+      if (!dir_list_listing_read(dir, &listing))
+         return -1;
+
+      if (mtime >= 0)
+         dir_list_cache_put(dir, mtime, listed, &listing);
+   }
+
+   for (i = 0; i < listing.count; i++)
    {
       char file_path[PATH_MAX_LENGTH];
-      bool is_dir                     = false;
+      bool is_dir                     = listing.is_dir[i];
       int ret                         = 0;
-      const char *name                = retro_dirent_get_name(entry);
+      const char *name                = listing.names + listing.offsets[i];
       const char *file_ext            = "";
 
       file_path[0] = '\0';
 
       fill_pathname_join(file_path, dir, name, sizeof(file_path));
-      is_dir = retro_dirent_is_dir(entry, file_path);
 
       if(!is_dir)
          file_ext = path_get_extension(name);
@@ -202,32 +524,22 @@ static int dir_list_read(const char *dir,
       }
 
       if(is_dir && recursive)
-      {
-         if(strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
-            continue;
-
          dir_list_read(file_path, list, ext_list, include_dirs,
                include_hidden, include_compressed, recursive);
-      }
 
       ret    = parse_dir_entry(name, file_path, is_dir,
             include_dirs, include_compressed, list, ext_list, file_ext);
 
       if (ret == -1)
-         goto error;
-
-      if (ret == 1)
-         continue;
+      {
+         dir_list_listing_free(&listing);
+         return -1;
+      }
    }
 
-   retro_closedir(entry);
+   dir_list_listing_free(&listing);
 
    return 0;
-
-error:
-   if (entry)
-      retro_closedir(entry);
-   return -1;
 }
 
 /**
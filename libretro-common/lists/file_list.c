@@ -25,8 +25,10 @@
 #include <string.h>
 
 #include <retro_common.h>
+#include <rarena.h>
 #include <lists/file_list.h>
 #include <string/stdstring.h>
+#include <string/string_pool.h>
 #include <compat/strcasestr.h>
 
 bool file_list_reserve(file_list_t *list, size_t nitems)
@@ -50,6 +52,74 @@ bool file_list_reserve(file_list_t *list, size_t nitems)
    return new_data != NULL;
 }
 
+bool file_list_use_arena(file_list_t *list)
+{
+   if (!list)
+      return false;
+
+   if (!list->arena && !list->size)
+   {
+      list->arena  = rarena_new(0);
+      list->labels = string_pool_new();
+   }
+
+   return list->arena != NULL;
+}
+
+static char *file_list_strdup(file_list_t *list, const char *str)
+{
+   if (list->arena)
+      return rarena_strdup(list->arena, str);
+   return strdup(str);
+}
+
+static void file_list_free_str(const file_list_t *list, char *str)
+{
+   if (str && !list->arena)
+      free(str);
+}
+
+/* Labels mostly name the handful of entry kinds a list is made
+ * of, so arena lists keep each distinct one once. */
+static char *file_list_label_dup(file_list_t *list, const char *label)
+{
+   if (list->labels)
+   {
+      const char *str = string_pool_intern(list->labels, label);
+      if (str)
+         return (char*)str;
+   }
+   return file_list_strdup(list, label);
+}
+
+static void file_list_label_free(file_list_t *list, char *label)
+{
+   /* Falls back to the arena when the pool is out of memory */
+   if (label && string_pool_find(list->labels, label) == label)
+      string_pool_release(list->labels, label);
+   else
+      file_list_free_str(list, label);
+}
+
+static void file_list_free_strings(file_list_t *list)
+{
+   size_t i;
+
+   for (i = 0; i < list->size; i++)
+   {
+      file_list_free_str(list, list->list[i].path);
+      list->list[i].path = NULL;
+
+      file_list_label_free(list, list->list[i].label);
+      list->list[i].label = NULL;
+
+      file_list_free_str(list, list->list[i].alt);
+      list->list[i].alt = NULL;
+   }
+
+   rarena_reset(list->arena);
+}
+
 static void file_list_add(file_list_t *list, unsigned idx,
       const char *path, const char *label,
       unsigned type, size_t directory_ptr,
@@ -65,9 +135,9 @@ static void file_list_add(file_list_t *list, unsigned idx,
    list->list[idx].actiondata    = NULL;
 
    if (label)
-      list->list[idx].label      = strdup(label);
+      list->list[idx].label      = file_list_label_dup(list, label);
    if (path)
-      list->list[idx].path       = strdup(path);
+      list->list[idx].path       = file_list_strdup(list, path);
 
    list->size++;
 }
@@ -145,13 +215,14 @@ void file_list_pop(file_list_t *list, size_t *directory_ptr)
    if (list->size != 0)
    {
       --list->size;
-      if (list->list[list->size].path)
-         free(list->list[list->size].path);
+      file_list_free_str(list, list->list[list->size].path);
       list->list[list->size].path = NULL;
 
-      if (list->list[list->size].label)
-         free(list->list[list->size].label);
+      file_list_label_free(list, list->list[list->size].label);
       list->list[list->size].label = NULL;
+
+      if (!list->size)
+         rarena_reset(list->arena);
    }
 
    if (directory_ptr)
@@ -169,19 +240,11 @@ void file_list_free(file_list_t *list)
    {
       file_list_free_userdata(list, i);
       file_list_free_actiondata(list, i);
-
-      if (list->list[i].path)
-         free(list->list[i].path);
-      list->list[i].path = NULL;
-
-      if (list->list[i].label)
-         free(list->list[i].label);
-      list->list[i].label = NULL;
-
-      if (list->list[i].alt)
-         free(list->list[i].alt);
-      list->list[i].alt = NULL;
    }
+   file_list_free_strings(list);
+   rarena_free(list->arena);
+   string_pool_free(list->labels);
+
    if (list->list)
       free(list->list);
    list->list = NULL;
@@ -190,25 +253,10 @@ void file_list_free(file_list_t *list)
 
 void file_list_clear(file_list_t *list)
 {
-   size_t i;
-
    if (!list)
       return;
 
-   for (i = 0; i < list->size; i++)
-   {
-      if (list->list[i].path)
-         free(list->list[i].path);
-      list->list[i].path = NULL;
-
-      if (list->list[i].label)
-         free(list->list[i].label);
-      list->list[i].label = NULL;
-
-      if (list->list[i].alt)
-         free(list->list[i].alt);
-      list->list[i].alt = NULL;
-   }
+   file_list_free_strings(list);
 
    list->size = 0;
 }
@@ -222,23 +270,7 @@ void file_list_copy(const file_list_t *src, file_list_t *dst)
 
    if (dst->list)
    {
-      for (item = dst->list; item < &dst->list[dst->size]; ++item)
-      {
-         if (!item)
-            continue;
-
-         if (item->path)
-            free(item->path);
-         item->path = NULL;
-
-         if (item->label)
-            free(item->label);
-         item->label = NULL;
-
-         if (item->alt)
-            free(item->alt);
-         item->alt = NULL;
-      }
+      file_list_free_strings(dst);
 
       free(dst->list);
       dst->list = NULL;
@@ -258,13 +290,13 @@ void file_list_copy(const file_list_t *src, file_list_t *dst)
    for (item = dst->list; item < &dst->list[dst->size]; ++item)
    {
       if (item->path)
-         item->path  = strdup(item->path);
+         item->path  = file_list_strdup(dst, item->path);
 
       if (item->label)
-         item->label = strdup(item->label);
+         item->label = file_list_label_dup(dst, item->label);
 
       if (item->alt)
-         item->alt   = strdup(item->alt);
+         item->alt   = file_list_strdup(dst, item->alt);
    }
 }
 
@@ -274,12 +306,11 @@ void file_list_set_label_at_offset(file_list_t *list, size_t idx,
    if (!list)
       return;
 
-   if (list->list[idx].label)
-      free(list->list[idx].label);
-   list->list[idx].alt      = NULL;
+   file_list_label_free(list, list->list[idx].label);
+   list->list[idx].label    = NULL;
 
    if (label)
-      list->list[idx].label = strdup(label);
+      list->list[idx].label = file_list_label_dup(list, label);
 }
 
 void file_list_get_label_at_offset(const file_list_t *list, size_t idx,
@@ -299,12 +330,11 @@ void file_list_set_alt_at_offset(file_list_t *list, size_t idx,
    if (!list || !alt)
       return;
 
-   if (list->list[idx].alt)
-      free(list->list[idx].alt);
+   file_list_free_str(list, list->list[idx].alt);
    list->list[idx].alt      = NULL;
 
    if (alt)
-      list->list[idx].alt   = strdup(alt);
+      list->list[idx].alt   = file_list_strdup(list, alt);
 }
 
 void file_list_get_alt_at_offset(const file_list_t *list, size_t idx,
@@ -23,8 +23,31 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#if defined(_WIN32) && !defined(_XBOX)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 #include <memalign.h>
 
+#define MEMALIGN_HUGE_PAGE    (2 * 1024 * 1024)
+/* Keeps the caller's block 64 byte aligned past the header */
+#define MEMALIGN_LARGE_HEADER 64
+
+enum memalign_large_kind
+{
+   MEMALIGN_LARGE_HEAP = 0,
+   MEMALIGN_LARGE_MMAP,
+   MEMALIGN_LARGE_VIRTUAL
+};
+
+struct memalign_large_header
+{
+   size_t size;
+   enum memalign_large_kind kind;
+};
+
 
 void *memalign_alloc(size_t boundary, size_t size)
 {
@@ -52,6 +75,124 @@ void memalign_free(void *ptr)
    free(p[-1]);
 }
 
+static void *memalign_map_large(size_t *size,
+      enum memalign_large_kind *kind)
+{
+#if defined(__linux__)
+   uint8_t *raw, *base;
+   size_t len = (*size + MEMALIGN_HUGE_PAGE - 1)
+      & ~(size_t)(MEMALIGN_HUGE_PAGE - 1);
+   size_t map = len + MEMALIGN_HUGE_PAGE;
+
+#ifdef MAP_HUGETLB
+   /* Only works if the admin reserved huge pages */
+   base = (uint8_t*)mmap(NULL, len, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+   if (base != (uint8_t*)MAP_FAILED)
+   {
+      *size = len;
+      *kind = MEMALIGN_LARGE_MMAP;
+      return base;
+   }
+#endif
+
+   /* Transparent huge pages only back aligned 2 MiB ranges, so map
+    * one more and trim the ends. */
+   raw = (uint8_t*)mmap(NULL, map, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (raw == (uint8_t*)MAP_FAILED)
+      return NULL;
+
+   base = (uint8_t*)(((uintptr_t)raw + MEMALIGN_HUGE_PAGE - 1)
+         & ~(uintptr_t)(MEMALIGN_HUGE_PAGE - 1));
+   if (base > raw)
+      munmap(raw, base - raw);
+   if (raw + map > base + len)
+      munmap(base + len, (raw + map) - (base + len));
+
+#ifdef MADV_HUGEPAGE
+   madvise(base, len, MADV_HUGEPAGE);
+#endif
+
+   *size = len;
+   *kind = MEMALIGN_LARGE_MMAP;
+   return base;
+#elif defined(_WIN32) && !defined(_XBOX) && defined(MEM_LARGE_PAGES) && _WIN32_WINNT >= 0x0600
+   void *base;
+   SIZE_T page = GetLargePageMinimum();
+   size_t len;
+
+   if (!page)
+      return NULL;
+
+   /* Fails without SeLockMemoryPrivilege, the heap does as well as a
+    * plain VirtualAlloc then. */
+   len  = (*size + page - 1) & ~(size_t)(page - 1);
+   base = VirtualAlloc(NULL, len,
+         MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+   if (!base)
+      return NULL;
+
+   *size = len;
+   *kind = MEMALIGN_LARGE_VIRTUAL;
+   return base;
+#else
+   return NULL;
+#endif
+}
+
+void *memalign_alloc_large(size_t size)
+{
+   struct memalign_large_header *header;
+   enum memalign_large_kind kind = MEMALIGN_LARGE_HEAP;
+   size_t total                  = size + MEMALIGN_LARGE_HEADER;
+   uint8_t *base                 = NULL;
+
+   if (size >= MEMALIGN_HUGE_PAGE)
+      base = (uint8_t*)memalign_map_large(&total, &kind);
+
+   if (!base)
+   {
+      base = (uint8_t*)calloc(1, total);
+      if (!base)
+         return NULL;
+   }
+
+   header       = (struct memalign_large_header*)base;
+   header->size = total;
+   header->kind = kind;
+
+   return base + MEMALIGN_LARGE_HEADER;
+}
+
+void memalign_free_large(void *ptr)
+{
+   struct memalign_large_header *header;
+
+   if (!ptr)
+      return;
+
+   header = (struct memalign_large_header*)
+      ((uint8_t*)ptr - MEMALIGN_LARGE_HEADER);
+
+   switch (header->kind)
+   {
+#if defined(__linux__)
+      case MEMALIGN_LARGE_MMAP:
+         munmap(header, header->size);
+         break;
+#endif
+#if defined(_WIN32) && !defined(_XBOX)
+      case MEMALIGN_LARGE_VIRTUAL:
+         VirtualFree(header, 0, MEM_RELEASE);
+         break;
+#endif
+      default:
+         free(header);
+         break;
+   }
+}
+
 void *memalign_alloc_aligned(size_t size)
 {
 #if defined(__x86_64__) || defined(__LP64) || defined(__IA64__) || defined(_M_X64) || defined(_WIN64)
@@ -0,0 +1,183 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rarena.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rarena.h>
+
+#define RARENA_CHUNK_SIZE 4096
+#define RARENA_ALIGN      (sizeof(void*) > 8 ? sizeof(void*) : 8)
+#define RARENA_ROUND(x)   (((x) + RARENA_ALIGN - 1) & ~(RARENA_ALIGN - 1))
+
+struct rarena_chunk
+{
+   struct rarena_chunk *next;
+   size_t size;
+   size_t used;
+};
+
+/* The newest block is first. Allocations bigger than a quarter of
+ * a block get a block of their own, behind the current one, so the
+ * rest of the current block isn't wasted. */
+struct rarena
+{
+   struct rarena_chunk *chunks;
+   size_t chunk_size;
+};
+
+#define RARENA_HEADER RARENA_ROUND(sizeof(struct rarena_chunk))
+
+static struct rarena_chunk *rarena_chunk_new(size_t size)
+{
+   struct rarena_chunk *chunk = (struct rarena_chunk*)
+      malloc(RARENA_HEADER + size);
+
+   if (!chunk)
+      return NULL;
+
+   chunk->next = NULL;
+   chunk->size = size;
+   chunk->used = 0;
+   return chunk;
+}
+
+rarena_t *rarena_new(size_t chunk_size)
+{
+   rarena_t *arena = (rarena_t*)calloc(1, sizeof(*arena));
+
+   if (!arena)
+      return NULL;
+
+   arena->chunk_size = chunk_size
+      ? RARENA_ROUND(chunk_size) : RARENA_CHUNK_SIZE;
+   return arena;
+}
+
+void rarena_free(rarena_t *arena)
+{
+   struct rarena_chunk *chunk;
+
+   if (!arena)
+      return;
+
+   chunk = arena->chunks;
+   while (chunk)
+   {
+      struct rarena_chunk *next = chunk->next;
+      free(chunk);
+      chunk = next;
+   }
+
+   free(arena);
+}
+
+void rarena_reset(rarena_t *arena)
+{
+   struct rarena_chunk *chunk;
+   struct rarena_chunk *keep = NULL;
+
+   if (!arena)
+      return;
+
+   chunk = arena->chunks;
+   while (chunk)
+   {
+      struct rarena_chunk *next = chunk->next;
+
+      if (!keep && chunk->size == arena->chunk_size)
+      {
+         keep       = chunk;
+         keep->next = NULL;
+         keep->used = 0;
+      }
+      else
+         free(chunk);
+
+      chunk = next;
+   }
+
+   arena->chunks = keep;
+}
+
+void *rarena_alloc(rarena_t *arena, size_t size)
+{
+   struct rarena_chunk *chunk;
+
+   if (!arena)
+      return NULL;
+
+   size  = RARENA_ROUND(size ? size : 1);
+   chunk = arena->chunks;
+
+   if (chunk && chunk->size - chunk->used >= size)
+   {
+      void *ptr    = (uint8_t*)chunk + RARENA_HEADER + chunk->used;
+      chunk->used += size;
+      return ptr;
+   }
+
+   if (size > arena->chunk_size / 4)
+   {
+      if (!(chunk = rarena_chunk_new(size)))
+         return NULL;
+
+      chunk->used = size;
+
+      if (arena->chunks)
+      {
+         chunk->next         = arena->chunks->next;
+         arena->chunks->next = chunk;
+      }
+      else
+         arena->chunks       = chunk;
+
+      return (uint8_t*)chunk + RARENA_HEADER;
+   }
+
+   if (!(chunk = rarena_chunk_new(arena->chunk_size)))
+      return NULL;
+
+   chunk->next   = arena->chunks;
+   chunk->used   = size;
+   arena->chunks = chunk;
+
+   return (uint8_t*)chunk + RARENA_HEADER;
+}
+
+char *rarena_strdup(rarena_t *arena, const char *str)
+{
+   size_t len;
+   char *copy;
+
+   if (!str)
+      return NULL;
+
+   len  = strlen(str) + 1;
+   copy = (char*)rarena_alloc(arena, len);
+
+   if (copy)
+      memcpy(copy, str, len);
+
+   return copy;
+}
@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <net/net_http.h>
 #include <net/net_compat.h>
@@ -34,6 +35,17 @@
 #include <string/stdstring.h>
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Idle keep-alive connections kept for reuse, over all hosts */
+#define HTTP_POOL_SIZE 8
+/* Seconds before an idle connection is dropped, servers tend
+ * to close theirs after 5 to 15 */
+#define HTTP_POOL_IDLE 10
+/* Receive buffer of a transfer that streams its body to a sink */
+#define HTTP_SINK_BUFLEN (64 * 1024)
 
 enum
 {
@@ -66,12 +78,37 @@ struct http_t
    char part;
    char bodytype;
    bool error;
+   /* Can the connection take another request once this is done? */
+   bool keep_alive;
+   /* Came from the pool, the server may have closed it meanwhile */
+   bool reused;
 
    size_t pos;
    size_t len;
    size_t buflen;
    char *data;
    struct http_socket_state_t sock_state;
+
+   /* Kept to return the connection to the pool, and to send
+    * the request again if a reused connection was stale */
+   char *domain;
+   int port;
+   char *request;
+   size_t request_len;
+
+   /* Takes the body as it comes in, data then only holds
+    * what hasn't been handed over yet */
+   net_http_sink_t sink;
+   void *sink_userdata;
+   size_t written;
+};
+
+struct http_pool_entry
+{
+   char *domain;
+   int port;
+   time_t idle_since;
+   struct http_socket_state_t sock_state;
 };
 
 struct http_connection_t
@@ -84,12 +121,19 @@ struct http_connection_t
    char *contenttypecopy;
    char *postdatacopy;
    int port;
+   size_t range_start;
    struct http_socket_state_t sock_state;
 };
 
 static char urlencode_lut[256];
 static bool urlencode_lut_inited = false;
 
+static struct http_pool_entry http_pool[HTTP_POOL_SIZE];
+static bool http_pool_enabled    = false;
+#ifdef HAVE_THREADS
+static slock_t *http_pool_lock   = NULL;
+#endif
+
 void urlencode_lut_init(void)
 {
    unsigned i;
@@ -218,22 +262,222 @@ static int net_http_new_socket(struct http_connection_t *conn)
    return fd;
 }
 
-static void net_http_send_str(struct http_socket_state_t *sock_state, bool *error, const char *text)
+static void net_http_close_socket(struct http_socket_state_t *sock_state)
 {
-   if (*error)
-      return;
 #ifdef HAVE_SSL
-   if (sock_state->ssl)
+   if (sock_state->ssl && sock_state->ssl_ctx)
    {
-      if (!ssl_socket_send_all_blocking(sock_state->ssl_ctx, text, strlen(text), true))
-         *error = true;
+      ssl_socket_close(sock_state->ssl_ctx);
+      ssl_socket_free(sock_state->ssl_ctx);
+      sock_state->ssl_ctx = NULL;
+      sock_state->fd      = -1;
+      return;
    }
-   else
 #endif
+   if (sock_state->fd >= 0)
+      socket_close(sock_state->fd);
+   sock_state->fd = -1;
+}
+
+/* An idle connection has nothing to read, if it is readable
+ * the server closed it (or sent something unasked for). */
+static bool net_http_socket_is_idle(int fd)
+{
+#ifdef VITA
+   return true;
+#else
+   fd_set fds;
+   struct timeval tv;
+
+   tv.tv_sec  = 0;
+   tv.tv_usec = 0;
+
+   FD_ZERO(&fds);
+   FD_SET(fd, &fds);
+
+   return socket_select(fd + 1, &fds, NULL, NULL, &tv) == 0;
+#endif
+}
+
+static void net_http_pool_lock(void)
+{
+#ifdef HAVE_THREADS
+   if (http_pool_lock)
+      slock_lock(http_pool_lock);
+#endif
+}
+
+static void net_http_pool_unlock(void)
+{
+#ifdef HAVE_THREADS
+   if (http_pool_lock)
+      slock_unlock(http_pool_lock);
+#endif
+}
+
+/* Takes an idle connection to the server out of the pool */
+static bool net_http_pool_take(struct http_connection_t *conn)
+{
+   unsigned i;
+   time_t now = time(NULL);
+
+   for (;;)
+   {
+      struct http_socket_state_t sock_state;
+      bool found = false;
+
+      net_http_pool_lock();
+      for (i = 0; i < HTTP_POOL_SIZE && http_pool_enabled; i++)
+      {
+         struct http_pool_entry *entry = &http_pool[i];
+
+         if (     !entry->domain
+               || entry->port != conn->port
+               || entry->sock_state.ssl != conn->sock_state.ssl
+               || !string_is_equal(entry->domain, conn->domain))
+            continue;
+
+         sock_state      = entry->sock_state;
+         found           = now - entry->idle_since < HTTP_POOL_IDLE;
+         free(entry->domain);
+         entry->domain   = NULL;
+         break;
+      }
+      net_http_pool_unlock();
+
+      if (i == HTTP_POOL_SIZE || !http_pool_enabled)
+         return false;
+
+      if (found && net_http_socket_is_idle(sock_state.fd))
+      {
+         conn->sock_state = sock_state;
+         return true;
+      }
+
+      net_http_close_socket(&sock_state);
+   }
+}
+
+/* Hands the connection of a finished transfer to the pool */
+static void net_http_pool_put(struct http_t *state)
+{
+   unsigned i;
+   unsigned slot = 0;
+   struct http_socket_state_t evicted;
+
+   evicted.fd      = -1;
+   evicted.ssl     = false;
+   evicted.ssl_ctx = NULL;
+
+   net_http_pool_lock();
+   if (!http_pool_enabled)
+   {
+      net_http_pool_unlock();
+      net_http_close_socket(&state->sock_state);
+      return;
+   }
+
+   /* A free slot, otherwise the one idle for the longest */
+   for (i = 0; i < HTTP_POOL_SIZE; i++)
+   {
+      if (!http_pool[i].domain)
+      {
+         slot = i;
+         break;
+      }
+      if (http_pool[i].idle_since < http_pool[slot].idle_since)
+         slot = i;
+   }
+
+   if (http_pool[slot].domain)
+   {
+      evicted = http_pool[slot].sock_state;
+      free(http_pool[slot].domain);
+   }
+
+   http_pool[slot].domain     = state->domain;
+   http_pool[slot].port       = state->port;
+   http_pool[slot].idle_since = time(NULL);
+   http_pool[slot].sock_state = state->sock_state;
+   state->domain              = NULL;
+   state->sock_state.fd       = -1;
+   state->sock_state.ssl_ctx  = NULL;
+   net_http_pool_unlock();
+
+   net_http_close_socket(&evicted);
+}
+
+void net_http_pool_enable(bool enable)
+{
+   unsigned i;
+
+   if (enable == http_pool_enabled)
+      return;
+
+   if (enable)
+   {
+#ifdef HAVE_THREADS
+      if (!(http_pool_lock = slock_new()))
+         return;
+#endif
+      http_pool_enabled = true;
+      return;
+   }
+
+   http_pool_enabled = false;
+
+   for (i = 0; i < HTTP_POOL_SIZE; i++)
+   {
+      if (!http_pool[i].domain)
+         continue;
+
+      net_http_close_socket(&http_pool[i].sock_state);
+      free(http_pool[i].domain);
+      http_pool[i].domain = NULL;
+   }
+
+#ifdef HAVE_THREADS
+   slock_free(http_pool_lock);
+   http_pool_lock = NULL;
+#endif
+}
+
+static bool net_http_send_request(struct http_t *state)
+{
+#ifdef HAVE_SSL
+   if (state->sock_state.ssl)
+      return ssl_socket_send_all_blocking(state->sock_state.ssl_ctx,
+            state->request, state->request_len, true);
+#endif
+   return socket_send_all_blocking(state->sock_state.fd,
+         state->request, state->request_len, true);
+}
+
+static void net_http_append(char **buf, size_t *len, size_t *cap,
+      bool *error, const char *text)
+{
+   size_t text_len = strlen(text);
+
+   if (*error)
+      return;
+
+   if (*len + text_len + 1 > *cap)
    {
-      if (!socket_send_all_blocking(sock_state->fd, text, strlen(text), true))
+      size_t new_cap = MAX(*cap * 2, *len + text_len + 1);
+      char *new_buf  = (char*)realloc(*buf, new_cap);
+
+      if (!new_buf)
+      {
          *error = true;
+         return;
+      }
+
+      *buf = new_buf;
+      *cap = new_cap;
    }
+
+   memcpy(*buf + *len, text, text_len + 1);
+   *len += text_len;
 }
 
 struct http_connection_t *net_http_connection_new(const char *url,
@@ -369,38 +613,41 @@ const char *net_http_connection_url(struct http_connection_t *conn)
    return conn->urlcopy;
 }
 
+void net_http_connection_set_range(struct http_connection_t *conn,
+      size_t start)
+{
+   if (conn)
+      conn->range_start = start;
+}
+
 struct http_t *net_http_new(struct http_connection_t *conn)
 {
    bool error            = false;
-   int fd                = -1;
+   bool reused           = false;
    struct http_t *state  = NULL;
+   char *request         = NULL;
+   size_t request_len    = 0;
+   size_t request_cap    = 0;
 
    if (!conn)
       goto error;
 
-   fd = net_http_new_socket(conn);
-
-   if (fd < 0)
-      goto error;
-
-   error = false;
-
    /* This is a bit lazy, but it works. */
    if (conn->methodcopy)
    {
-      net_http_send_str(&conn->sock_state, &error, conn->methodcopy);
-      net_http_send_str(&conn->sock_state, &error, " /");
+      net_http_append(&request, &request_len, &request_cap, &error, conn->methodcopy);
+      net_http_append(&request, &request_len, &request_cap, &error, " /");
    }
    else
    {
-      net_http_send_str(&conn->sock_state, &error, "GET /");
+      net_http_append(&request, &request_len, &request_cap, &error, "GET /");
    }
 
-   net_http_send_str(&conn->sock_state, &error, conn->location);
-   net_http_send_str(&conn->sock_state, &error, " HTTP/1.1\r\n");
+   net_http_append(&request, &request_len, &request_cap, &error, conn->location);
+   net_http_append(&request, &request_len, &request_cap, &error, " HTTP/1.1\r\n");
 
-   net_http_send_str(&conn->sock_state, &error, "Host: ");
-   net_http_send_str(&conn->sock_state, &error, conn->domain);
+   net_http_append(&request, &request_len, &request_cap, &error, "Host: ");
+   net_http_append(&request, &request_len, &request_cap, &error, conn->domain);
 
    if (!conn->port)
    {
@@ -409,73 +656,114 @@ struct http_t *net_http_new(struct http_connection_t *conn)
       portstr[0] = '\0';
 
       snprintf(portstr, sizeof(portstr), ":%i", conn->port);
-      net_http_send_str(&conn->sock_state, &error, portstr);
+      net_http_append(&request, &request_len, &request_cap, &error, portstr);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+   net_http_append(&request, &request_len, &request_cap, &error, "\r\n");
 
    /* this is not being set anywhere yet */
    if (conn->contenttypecopy)
    {
-      net_http_send_str(&conn->sock_state, &error, "Content-Type: ");
-      net_http_send_str(&conn->sock_state, &error, conn->contenttypecopy);
-      net_http_send_str(&conn->sock_state, &error, "\r\n");
+      net_http_append(&request, &request_len, &request_cap, &error, "Content-Type: ");
+      net_http_append(&request, &request_len, &request_cap, &error, conn->contenttypecopy);
+      net_http_append(&request, &request_len, &request_cap, &error, "\r\n");
    }
 
    if (conn->methodcopy && (string_is_equal(conn->methodcopy, "POST")))
    {
-      size_t post_len, len;
-      char *len_str        = NULL;
+      char len_str[32];
 
       if (!conn->postdatacopy)
          goto error;
 
       if (!conn->contenttypecopy)
-         net_http_send_str(&conn->sock_state, &error,
+         net_http_append(&request, &request_len, &request_cap, &error,
                "Content-Type: application/x-www-form-urlencoded\r\n");
 
-      net_http_send_str(&conn->sock_state, &error, "Content-Length: ");
+      net_http_append(&request, &request_len, &request_cap, &error, "Content-Length: ");
 
-      post_len = strlen(conn->postdatacopy);
 #ifdef _WIN32
-      len = snprintf(NULL, 0, "%" PRIuPTR, post_len);
-      len_str = (char*)malloc(len + 1);
-      snprintf(len_str, len + 1, "%" PRIuPTR, post_len);
+      snprintf(len_str, sizeof(len_str), "%" PRIuPTR, strlen(conn->postdatacopy));
 #else
-      len = snprintf(NULL, 0, "%llu", (long long unsigned)post_len);
-      len_str = (char*)malloc(len + 1);
-      snprintf(len_str, len + 1, "%llu", (long long unsigned)post_len);
+      snprintf(len_str, sizeof(len_str), "%llu",
+            (long long unsigned)strlen(conn->postdatacopy));
 #endif
 
-      len_str[len] = '\0';
+      net_http_append(&request, &request_len, &request_cap, &error, len_str);
+      net_http_append(&request, &request_len, &request_cap, &error, "\r\n");
+   }
+
+   if (conn->range_start)
+   {
+      char range_str[64];
 
-      net_http_send_str(&conn->sock_state, &error, len_str);
-      net_http_send_str(&conn->sock_state, &error, "\r\n");
+#ifdef _WIN32
+      snprintf(range_str, sizeof(range_str), "Range: bytes=%" PRIuPTR "-\r\n",
+            conn->range_start);
+#else
+      snprintf(range_str, sizeof(range_str), "Range: bytes=%llu-\r\n",
+            (long long unsigned)conn->range_start);
+#endif
 
-      free(len_str);
+      net_http_append(&request, &request_len, &request_cap, &error, range_str);
    }
 
-   net_http_send_str(&conn->sock_state, &error, "User-Agent: libretro\r\n");
-   net_http_send_str(&conn->sock_state, &error, "Connection: close\r\n");
-   net_http_send_str(&conn->sock_state, &error, "\r\n");
+   net_http_append(&request, &request_len, &request_cap, &error, "User-Agent: libretro\r\n");
+   if (http_pool_enabled)
+      net_http_append(&request, &request_len, &request_cap, &error, "Connection: keep-alive\r\n");
+   else
+      net_http_append(&request, &request_len, &request_cap, &error, "Connection: close\r\n");
+   net_http_append(&request, &request_len, &request_cap, &error, "\r\n");
 
    if (conn->methodcopy && (string_is_equal(conn->methodcopy, "POST")))
-      net_http_send_str(&conn->sock_state, &error, conn->postdatacopy);
+      net_http_append(&request, &request_len, &request_cap, &error, conn->postdatacopy);
 
    if (error)
       goto error;
 
-   state          = (struct http_t*)malloc(sizeof(struct http_t));
+   state = (struct http_t*)calloc(1, sizeof(struct http_t));
+
+   if (!state)
+      goto error;
+
+   state->sock_state.fd = -1;
+   state->request       = request;
+   state->request_len   = request_len;
+   state->domain        = strdup(conn->domain);
+   state->port          = conn->port;
+   request              = NULL;
+
+   if (!state->domain)
+      goto error;
+
+   reused = net_http_pool_take(conn);
+
+   if (!reused && net_http_new_socket(conn) < 0)
+      goto error;
+
    state->sock_state = conn->sock_state;
-   state->status  = -1;
-   state->data    = NULL;
-   state->part    = P_HEADER_TOP;
-   state->bodytype= T_FULL;
-   state->error   = false;
-   state->pos     = 0;
-   state->len     = 0;
-   state->buflen  = 512;
-   state->data    = (char*)malloc(state->buflen);
+
+   if (!net_http_send_request(state))
+   {
+      net_http_close_socket(&state->sock_state);
+
+      /* The server dropped the idle connection, start a new one */
+      if (!reused || net_http_new_socket(conn) < 0)
+         goto error;
+
+      reused            = false;
+      state->sock_state = conn->sock_state;
+
+      if (!net_http_send_request(state))
+         goto error;
+   }
+
+   state->status   = -1;
+   state->part     = P_HEADER_TOP;
+   state->bodytype = T_FULL;
+   state->reused   = reused;
+   state->buflen   = 512;
+   state->data     = (char*)malloc(state->buflen);
 
    if (!state->data)
       goto error;
@@ -483,29 +771,100 @@ struct http_t *net_http_new(struct http_connection_t *conn)
    return state;
 
 error:
-   if (conn->methodcopy)
-      free(conn->methodcopy);
-   if (conn->contenttypecopy)
-      free(conn->contenttypecopy);
-   conn->methodcopy = NULL;
-   conn->contenttypecopy = NULL;
-   conn->postdatacopy = NULL;
-#ifdef HAVE_SSL
-   if (conn->sock_state.ssl && conn->sock_state.ssl_ctx && fd >= 0)
+   if (conn)
    {
-      ssl_socket_close(conn->sock_state.ssl_ctx);
-      ssl_socket_free(conn->sock_state.ssl_ctx);
-      conn->sock_state.ssl_ctx = NULL;
+      if (conn->methodcopy)
+         free(conn->methodcopy);
+      if (conn->contenttypecopy)
+         free(conn->contenttypecopy);
+      conn->methodcopy = NULL;
+      conn->contenttypecopy = NULL;
+      conn->postdatacopy = NULL;
    }
-#else
-   if (fd >= 0)
-      socket_close(fd);
-#endif
+   free(request);
    if (state)
+   {
+      net_http_close_socket(&state->sock_state);
+      free(state->request);
+      free(state->domain);
       free(state);
+   }
    return NULL;
 }
 
+/* A reused connection that fails before a byte of the response
+ * came in was closed by the server, send the request again on
+ * a new one. */
+static bool net_http_retry(struct http_t *state)
+{
+   struct http_connection_t conn;
+
+   if (!state->reused || state->status != -1 || state->pos)
+      return false;
+
+   net_http_close_socket(&state->sock_state);
+
+   memset(&conn, 0, sizeof(conn));
+   conn.domain         = state->domain;
+   conn.port           = state->port;
+   conn.sock_state.ssl = state->sock_state.ssl;
+
+   state->reused       = false;
+   state->error        = false;
+
+   if (net_http_new_socket(&conn) < 0)
+      return false;
+
+   state->sock_state   = conn.sock_state;
+
+   return net_http_send_request(state);
+}
+
+void net_http_set_sink(struct http_t *state,
+      net_http_sink_t sink, void *userdata)
+{
+   if (!state)
+      return;
+
+   if (sink && state->buflen < HTTP_SINK_BUFLEN)
+   {
+      char *data = (char*)realloc(state->data, HTTP_SINK_BUFLEN);
+
+      /* A small buffer only slows the transfer down */
+      if (data)
+      {
+         state->data   = data;
+         state->buflen = HTTP_SINK_BUFLEN;
+      }
+   }
+
+   state->sink          = sink;
+   state->sink_userdata = userdata;
+}
+
+/* Hands the body received so far over to the sink. A chunked body
+ * keeps the unparsed bytes after it, everything else ends up empty. */
+static bool net_http_flush(struct http_t *state)
+{
+   size_t len = state->pos;
+
+   if (state->bodytype == T_CHUNK && state->part != P_BODY)
+      len = state->len;
+
+   if (len && !state->sink(state->sink_userdata,
+            (const uint8_t*)state->data, len))
+      return false;
+
+   memmove(state->data, state->data + len, state->pos - len);
+   state->pos     -= len;
+   state->written += len;
+
+   if (state->bodytype == T_CHUNK && state->part != P_BODY)
+      state->len = 0;
+
+   return true;
+}
+
 int net_http_fd(struct http_t *state)
 {
    if (!state)
@@ -539,7 +898,11 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
       }
 
       if (newlen < 0)
+      {
+         if (net_http_retry(state))
+            return false;
          goto fail;
+      }
 
       if (state->pos + newlen >= state->buflen - 64)
       {
@@ -563,10 +926,21 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
 
          if (state->part == P_HEADER_TOP)
          {
+            /* Line ends the previous response on this
+             * connection may have left behind */
+            if (state->data[0] == '\0')
+            {
+               memmove(state->data, lineend + 1, dataend-(lineend+1));
+               state->pos = (dataend-(lineend + 1));
+               continue;
+            }
             if (strncmp(state->data, "HTTP/1.", strlen("HTTP/1."))!=0)
                goto fail;
-            state->status = (int)strtoul(state->data + strlen("HTTP/1.1 "), NULL, 10);
-            state->part   = P_HEADER;
+            state->status     = (int)strtoul(state->data + strlen("HTTP/1.1 "), NULL, 10);
+            state->part       = P_HEADER;
+            /* HTTP/1.0 servers close unless asked otherwise */
+            state->keep_alive = http_pool_enabled &&
+               !strncmp(state->data, "HTTP/1.1", strlen("HTTP/1.1"));
          }
          else
          {
@@ -579,6 +953,8 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
             }
             if (string_is_equal(state->data, "Transfer-Encoding: chunked"))
                state->bodytype = T_CHUNK;
+            if (string_is_equal_noncase(state->data, "Connection: close"))
+               state->keep_alive = false;
 
             /* TODO: save headers somewhere */
             if (state->data[0]=='\0')
@@ -586,6 +962,21 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
                state->part = P_BODY;
                if (state->bodytype == T_CHUNK)
                   state->part = P_BODY_CHUNKLEN;
+
+               /* These never have a body, a kept-alive connection
+                * would otherwise wait for one until the server
+                * gives up on it */
+               if (     state->status == 204 || state->status == 304
+                     || (state->bodytype == T_LEN && state->len == 0))
+               {
+                  state->part     = P_DONE;
+                  state->bodytype = T_LEN;
+                  state->len      = 0;
+               }
+               /* Without a length the body ends when the
+                * connection does */
+               else if (state->bodytype == T_FULL)
+                  state->keep_alive = false;
             }
          }
 
@@ -597,6 +988,15 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
          newlen = state->pos;
          state->pos = 0;
       }
+
+      if (state->part == P_DONE)
+      {
+         /* A body that shouldn't be there can't be told apart
+          * from the next response */
+         if (newlen)
+            state->keep_alive = false;
+         newlen = 0;
+      }
    }
 
    if (state->part >= P_BODY && state->part < P_DONE)
@@ -628,7 +1028,8 @@ bool net_http_update(struct http_t *state, size_t* progress, size_t* total)
             if (state->bodytype == T_FULL)
             {
                state->part = P_DONE;
-               state->data = (char*)realloc(state->data, state->len);
+               if (!state->sink)
+                  state->data = (char*)realloc(state->data, state->len);
             }
             else
                goto fail;
@@ -681,7 +1082,8 @@ parse_again:
                   {
                      state->part = P_DONE;
                      state->len  = state->pos;
-                     state->data = (char*)realloc(state->data, state->len);
+                     if (!state->sink)
+                        state->data = (char*)realloc(state->data, state->len);
                   }
                   goto parse_again;
                }
@@ -708,18 +1110,22 @@ parse_again:
       {
          state->pos += newlen;
 
-         if (state->pos == state->len)
+         if (state->written + state->pos == state->len)
          {
             state->part = P_DONE;
-            state->data = (char*)realloc(state->data, state->len);
+            if (!state->sink)
+               state->data = (char*)realloc(state->data, state->len);
          }
-         if (state->pos > state->len)
+         if (state->written + state->pos > state->len)
             goto fail;
       }
+
+      if (state->sink && !net_http_flush(state))
+         goto fail;
    }
 
    if (progress)
-      *progress = state->pos;
+      *progress = state->written + state->pos;
 
    if (total)
    {
@@ -762,7 +1168,7 @@ uint8_t* net_http_data(struct http_t *state, size_t* len, bool accept_error)
    }
 
    if (len)
-      *len=state->len;
+      *len = state->sink ? 0 : state->len;
 
    return (uint8_t*)state->data;
 }
@@ -772,7 +1178,15 @@ void net_http_delete(struct http_t *state)
    if (!state)
       return;
 
-   if (state->sock_state.fd >= 0)
+   /* Only a connection that is exactly at the end of a
+    * complete response can take the next request */
+   if (     state->keep_alive
+         && state->part == P_DONE
+         && !state->error
+         && state->sock_state.fd >= 0
+         && state->domain)
+      net_http_pool_put(state);
+   else if (state->sock_state.fd >= 0)
    {
       socket_close(state->sock_state.fd);
 #ifdef HAVE_SSL
@@ -783,6 +1197,8 @@ void net_http_delete(struct http_t *state)
       }
 #endif
    }
+   free(state->request);
+   free(state->domain);
    free(state);
 }
 
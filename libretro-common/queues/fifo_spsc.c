@@ -0,0 +1,206 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (fifo_spsc.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/fifo_spsc.h>
+
+/* Each index is only ever stored by one side, so all that's needed
+ * is for the data to be visible before the index that publishes it
+ * (release), and for the other side to see it after loading that
+ * index (acquire). */
+#if defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define FIFO_SPSC_LOAD(ptr)       __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define FIFO_SPSC_STORE(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#elif defined(__GNUC__)
+static size_t fifo_spsc_load(volatile size_t *ptr)
+{
+   size_t val = *ptr;
+   __sync_synchronize();
+   return val;
+}
+#define FIFO_SPSC_LOAD(ptr)       fifo_spsc_load(ptr)
+#define FIFO_SPSC_STORE(ptr, val) do { __sync_synchronize(); *(ptr) = (val); } while (0)
+#elif defined(_MSC_VER)
+#include <windows.h>
+static size_t fifo_spsc_load(volatile size_t *ptr)
+{
+   size_t val = *ptr;
+   MemoryBarrier();
+   return val;
+}
+#define FIFO_SPSC_LOAD(ptr)       fifo_spsc_load(ptr)
+#define FIFO_SPSC_STORE(ptr, val) do { MemoryBarrier(); *(ptr) = (val); } while (0)
+#else
+/* Good enough for the single-core targets left over. */
+#define FIFO_SPSC_LOAD(ptr)       (*(ptr))
+#define FIFO_SPSC_STORE(ptr, val) (*(ptr) = (val))
+#endif
+
+/* Keeps the two indices out of each other's cache line, so the
+ * writer storing end doesn't keep evicting the line the reader is
+ * storing first into. */
+#define FIFO_SPSC_CACHE_LINE 64
+
+/* The buffer is a power of two long and the indices run freely,
+ * wrapping only when masked, so end - first is always the fill level
+ * and no byte has to be kept free to tell full from empty. */
+struct fifo_spsc
+{
+   uint8_t *buffer;
+   size_t size;
+   size_t mask;
+   uint8_t pad0[FIFO_SPSC_CACHE_LINE - sizeof(uint8_t*) - 2 * sizeof(size_t)];
+
+   /* Only stored by the writer. */
+   volatile size_t end;
+   /* Writer's last look at first; refreshed only when it shows
+    * too little room. */
+   size_t first_cached;
+   uint8_t pad1[FIFO_SPSC_CACHE_LINE - 2 * sizeof(size_t)];
+
+   /* Only stored by the reader. */
+   volatile size_t first;
+   /* Reader's last look at end; refreshed only when it shows too
+    * little data. */
+   size_t end_cached;
+   uint8_t pad2[FIFO_SPSC_CACHE_LINE - 2 * sizeof(size_t)];
+};
+
+fifo_spsc_t *fifo_spsc_new(size_t size)
+{
+   size_t len        = 1;
+   fifo_spsc_t *fifo = (fifo_spsc_t*)calloc(1, sizeof(*fifo));
+
+   if (!fifo)
+      return NULL;
+
+   while (len < size)
+      len <<= 1;
+
+   fifo->buffer = (uint8_t*)calloc(1, len);
+
+   if (!fifo->buffer)
+   {
+      free(fifo);
+      return NULL;
+   }
+
+   fifo->size = size;
+   fifo->mask = len - 1;
+
+   return fifo;
+}
+
+void fifo_spsc_free(fifo_spsc_t *fifo)
+{
+   if (!fifo)
+      return;
+
+   free(fifo->buffer);
+   free(fifo);
+}
+
+/* Capacity is the requested size rather than the rounded-up buffer, so
+ * callers that size latency off fifo_spsc_size() see what they asked
+ * for. */
+size_t fifo_spsc_write_avail(fifo_spsc_t *fifo)
+{
+   size_t first = FIFO_SPSC_LOAD(&fifo->first);
+   return fifo->size - (fifo->end - first);
+}
+
+size_t fifo_spsc_read_avail(fifo_spsc_t *fifo)
+{
+   size_t end = FIFO_SPSC_LOAD(&fifo->end);
+   return end - fifo->first;
+}
+
+void fifo_spsc_clear(fifo_spsc_t *fifo)
+{
+   fifo->first        = 0;
+   fifo->end          = 0;
+   fifo->first_cached = 0;
+   fifo->end_cached   = 0;
+}
+
+size_t fifo_spsc_size(fifo_spsc_t *fifo)
+{
+   return fifo->size;
+}
+
+size_t fifo_spsc_write(fifo_spsc_t *fifo, const void *in_buf, size_t size)
+{
+   size_t first_write, pos;
+   size_t end   = fifo->end;
+   size_t avail = fifo->size - (end - fifo->first_cached);
+
+   if (size > avail)
+   {
+      fifo->first_cached = FIFO_SPSC_LOAD(&fifo->first);
+      avail              = fifo->size - (end - fifo->first_cached);
+      if (size > avail)
+         size = avail;
+   }
+
+   pos         = end & fifo->mask;
+   first_write = size;
+   if (pos + size > fifo->mask + 1)
+      first_write = fifo->mask + 1 - pos;
+
+   memcpy(fifo->buffer + pos, in_buf, first_write);
+   memcpy(fifo->buffer, (const uint8_t*)in_buf + first_write,
+         size - first_write);
+
+   FIFO_SPSC_STORE(&fifo->end, end + size);
+
+   return size;
+}
+
+size_t fifo_spsc_read(fifo_spsc_t *fifo, void *out_buf, size_t size)
+{
+   size_t first_read, pos;
+   size_t first = fifo->first;
+   size_t avail = fifo->end_cached - first;
+
+   if (size > avail)
+   {
+      fifo->end_cached = FIFO_SPSC_LOAD(&fifo->end);
+      avail            = fifo->end_cached - first;
+      if (size > avail)
+         size = avail;
+   }
+
+   pos        = first & fifo->mask;
+   first_read = size;
+   if (pos + size > fifo->mask + 1)
+      first_read = fifo->mask + 1 - pos;
+
+   memcpy(out_buf, fifo->buffer + pos, first_read);
+   memcpy((uint8_t*)out_buf + first_read, fifo->buffer,
+         size - first_read);
+
+   FIFO_SPSC_STORE(&fifo->first, first + size);
+
+   return size;
+}
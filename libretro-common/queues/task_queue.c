@@ -21,6 +21,7 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdarg.h>
 
@@ -28,6 +29,7 @@
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
 #define SLOCK_LOCK(x) slock_lock(x)
 #define SLOCK_UNLOCK(x) slock_unlock(x)
 #else
@@ -61,6 +63,7 @@ static task_queue_t tasks_finished = {NULL, NULL};
 
 static struct retro_task_impl *impl_current = NULL;
 static bool task_threaded_enable            = false;
+static retro_task_trace_t task_queue_trace  = NULL;
 
 static void task_queue_msg_push(retro_task_t *task,
       unsigned prio, unsigned duration,
@@ -179,7 +182,12 @@ static void retro_task_regular_gather(void)
    for (task = queue; task; task = next)
    {
       next = task->next;
+
+      if (task_queue_trace)
+         task_queue_trace(task, true);
       task->handler(task);
+      if (task_queue_trace)
+         task_queue_trace(task, false);
 
       task_queue_push_progress(task);
 
@@ -285,12 +293,19 @@ static struct retro_task_impl impl_regular = {
 };
 
 #ifdef HAVE_THREADS
+/* Tasks are sliced: a worker runs one handler call, then puts the
+ * task back at the end of the running queue. Any worker may take
+ * any task that isn't being run already. */
+#define TASK_QUEUE_MAX_WORKERS 4
+
 static slock_t *running_lock    = NULL;
 static slock_t *finished_lock   = NULL;
 static slock_t *property_lock   = NULL;
 static slock_t *queue_lock      = NULL;
 static scond_t *worker_cond     = NULL;
-static sthread_t *worker_thread = NULL;
+static sthread_t *worker_threads[TASK_QUEUE_MAX_WORKERS];
+static retro_task_t *worker_tasks[TASK_QUEUE_MAX_WORKERS]; /* use running_lock */
+static unsigned worker_count    = 0;
 static bool worker_continue     = true; /* use running_lock when touching it */
 
 static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
@@ -434,22 +449,72 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
    slock_unlock(running_lock);
 }
 
+static unsigned task_priority_rank(const retro_task_t *task)
+{
+   switch (task->priority)
+   {
+      case TASK_PRIORITY_HIGH:
+         return 0;
+      case TASK_PRIORITY_LOW:
+         return 2;
+      default:
+         break;
+   }
+   return 1;
+}
+
+/* Must hold running_lock */
+static retro_task_t *threaded_worker_pick(void)
+{
+   retro_task_t *task = NULL;
+   retro_task_t *best = NULL;
+
+   for (task = tasks_running.front; task; task = task->next)
+   {
+      unsigned i;
+      bool taken = false;
+
+      for (i = 0; i < worker_count; i++)
+      {
+         if (worker_tasks[i] == task)
+         {
+            taken = true;
+            break;
+         }
+      }
+
+      if (taken)
+         continue;
+
+      if (!best || task_priority_rank(task) < task_priority_rank(best))
+         best = task;
+   }
+
+   return best;
+}
+
 static void threaded_worker(void *userdata)
 {
-   (void)userdata;
+   unsigned id = (unsigned)(uintptr_t)userdata;
+
+   sthread_set_role(STHREAD_ROLE_BACKGROUND);
 
    for (;;)
    {
       retro_task_t *task  = NULL;
       bool finished = false;
 
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
-
       slock_lock(running_lock);
 
-      /* Get first task to run */
-      task = tasks_running.front;
+      if (!worker_continue)
+      {
+         /* should we keep running until all tasks finished? */
+         slock_unlock(running_lock);
+         break;
+      }
+
+      /* Get the most important task nobody else is running */
+      task = threaded_worker_pick();
       if (task == NULL)
       {
          scond_wait(worker_cond, running_lock);
@@ -457,9 +522,14 @@ static void threaded_worker(void *userdata)
          continue;
       }
 
+      worker_tasks[id] = task;
       slock_unlock(running_lock);
 
+      if (task_queue_trace)
+         task_queue_trace(task, true);
       task->handler(task);
+      if (task_queue_trace)
+         task_queue_trace(task, false);
 
       slock_lock(property_lock);
       finished = task->finished;
@@ -467,6 +537,7 @@ static void threaded_worker(void *userdata)
 
       slock_lock(running_lock);
       task_queue_remove(&tasks_running, task);
+      worker_tasks[id] = NULL;
       slock_unlock(running_lock);
 
       /* Update queue */
@@ -487,27 +558,51 @@ static void threaded_worker(void *userdata)
 
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+   unsigned cores = cpu_features_get_core_amount();
+
    running_lock  = slock_new();
    finished_lock = slock_new();
    property_lock = slock_new();
    queue_lock    = slock_new();
    worker_cond   = scond_new();
 
+   /* Tasks mostly wait on I/O, so one worker per core is plenty */
+   if (cores < 1)
+      cores = 1;
+   else if (cores > TASK_QUEUE_MAX_WORKERS)
+      cores = TASK_QUEUE_MAX_WORKERS;
+
+   /* Workers can't pick anything until they all count */
    slock_lock(running_lock);
    worker_continue = true;
+   worker_count    = 0;
+   for (i = 0; i < cores; i++)
+   {
+      worker_tasks[i]   = NULL;
+      worker_threads[i] = sthread_create(threaded_worker, (void*)(uintptr_t)i);
+      if (!worker_threads[i])
+         break;
+      worker_count++;
+   }
    slock_unlock(running_lock);
-
-   worker_thread = sthread_create(threaded_worker, NULL);
 }
 
 static void retro_task_threaded_deinit(void)
 {
+   unsigned i;
+
    slock_lock(running_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
+   scond_broadcast(worker_cond);
    slock_unlock(running_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < worker_count; i++)
+   {
+      sthread_join(worker_threads[i]);
+      worker_threads[i] = NULL;
+   }
+   worker_count = 0;
 
    scond_free(worker_cond);
    slock_free(running_lock);
@@ -515,7 +610,6 @@ static void retro_task_threaded_deinit(void)
    slock_free(property_lock);
    slock_free(queue_lock);
 
-   worker_thread = NULL;
    worker_cond   = NULL;
    running_lock  = NULL;
    finished_lock = NULL;
@@ -581,6 +675,11 @@ bool task_queue_is_threaded(void)
    return task_threaded_enable;
 }
 
+void task_queue_set_trace(retro_task_trace_t trace)
+{
+   task_queue_trace = trace;
+}
+
 bool task_queue_find(task_finder_data_t *find_data)
 {
    if (!impl_current->find(find_data->func, find_data->userdata))
@@ -593,6 +692,19 @@ void task_queue_retrieve(task_retriever_data_t *data)
    impl_current->retrieve(data);
 }
 
+unsigned task_queue_count(void)
+{
+   unsigned count     = 0;
+   retro_task_t *task = NULL;
+
+   SLOCK_LOCK(running_lock);
+   for (task = tasks_running.front; task; task = task->next)
+      count++;
+   SLOCK_UNLOCK(running_lock);
+
+   return count;
+}
+
 void task_queue_check(void)
 {
 #ifdef HAVE_THREADS
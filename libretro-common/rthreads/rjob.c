@@ -0,0 +1,413 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rjob.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/rjob.h>
+
+/* Must be a power of two */
+#define RJOB_QUEUE_SIZE 256
+
+struct rjob
+{
+   rjob_func_t func;
+   void *userdata;
+   rjob_group_t *group;
+};
+
+/* Each worker owns a queue. The owner pushes and pops the newest
+ * job, so nested jobs stay on the core whose cache is warm, and
+ * idle workers steal the oldest one. */
+struct rjob_worker
+{
+   sthread_t *thread;
+   slock_t *lock;
+   unsigned head;
+   unsigned tail;
+   struct rjob queue[RJOB_QUEUE_SIZE];
+};
+
+static struct
+{
+   struct rjob_worker *workers;
+   unsigned count;
+   unsigned refs;
+
+   /* Everything below is protected by lock. */
+   slock_t *lock;
+   scond_t *work_cond;
+   scond_t *done_cond;
+   unsigned next;
+   unsigned sleeping;
+   int queued;
+   bool quit;
+} rjob_pool;
+
+static unsigned rjob_self(void)
+{
+   unsigned i;
+
+   for (i = 0; i < rjob_pool.count; i++)
+      if (sthread_isself(rjob_pool.workers[i].thread))
+         return i;
+
+   return rjob_pool.count;
+}
+
+static bool rjob_push(struct rjob_worker *worker, const struct rjob *job)
+{
+   bool pushed = false;
+
+   slock_lock(worker->lock);
+   if (worker->tail - worker->head < RJOB_QUEUE_SIZE)
+   {
+      worker->queue[worker->tail++ & (RJOB_QUEUE_SIZE - 1)] = *job;
+      pushed = true;
+   }
+   slock_unlock(worker->lock);
+
+   return pushed;
+}
+
+static bool rjob_pop(struct rjob_worker *worker, struct rjob *job, bool newest)
+{
+   bool popped = false;
+
+   slock_lock(worker->lock);
+   if (worker->tail != worker->head)
+   {
+      if (newest)
+         *job = worker->queue[--worker->tail & (RJOB_QUEUE_SIZE - 1)];
+      else
+         *job = worker->queue[worker->head++ & (RJOB_QUEUE_SIZE - 1)];
+      popped = true;
+   }
+   slock_unlock(worker->lock);
+
+   return popped;
+}
+
+/* Takes a job from the queue of worker 'self' if it has one,
+ * otherwise steals from the next workers in turn. */
+static bool rjob_take(unsigned self, struct rjob *job)
+{
+   unsigned i;
+   unsigned count = rjob_pool.count;
+
+   if (self < count && rjob_pop(&rjob_pool.workers[self], job, true))
+      goto taken;
+
+   for (i = 1; i <= count; i++)
+   {
+      unsigned victim = (self + i) % count;
+
+      if (victim != self && rjob_pop(&rjob_pool.workers[victim], job, false))
+         goto taken;
+   }
+
+   return false;
+
+taken:
+   slock_lock(rjob_pool.lock);
+   rjob_pool.queued--;
+   slock_unlock(rjob_pool.lock);
+   return true;
+}
+
+static void rjob_run(const struct rjob *job)
+{
+   job->func(job->userdata);
+
+   if (!job->group)
+      return;
+
+   slock_lock(rjob_pool.lock);
+   if (--job->group->pending == 0)
+      scond_broadcast(rjob_pool.done_cond);
+   slock_unlock(rjob_pool.lock);
+}
+
+static void rjob_worker(void *data)
+{
+   struct rjob_worker *worker = (struct rjob_worker*)data;
+   unsigned self;
+
+   /* Wait for rjob_init() to finish filling the pool */
+   slock_lock(rjob_pool.lock);
+   slock_unlock(rjob_pool.lock);
+
+   self = (unsigned)(worker - rjob_pool.workers);
+
+   for (;;)
+   {
+      struct rjob job;
+
+      if (rjob_take(self, &job))
+      {
+         rjob_run(&job);
+         continue;
+      }
+
+      slock_lock(rjob_pool.lock);
+      if (rjob_pool.queued <= 0)
+      {
+         if (rjob_pool.quit)
+         {
+            slock_unlock(rjob_pool.lock);
+            break;
+         }
+
+         rjob_pool.sleeping++;
+         scond_wait(rjob_pool.work_cond, rjob_pool.lock);
+         rjob_pool.sleeping--;
+      }
+      slock_unlock(rjob_pool.lock);
+   }
+}
+
+bool rjob_init(unsigned workers)
+{
+   unsigned i;
+
+   if (rjob_pool.refs++)
+      return true;
+
+   if (!workers)
+   {
+      unsigned cores = cpu_features_get_core_amount();
+      workers        = cores > 1 ? cores - 1 : 0;
+   }
+   if (workers > RJOB_MAX_WORKERS)
+      workers = RJOB_MAX_WORKERS;
+
+   rjob_pool.lock      = slock_new();
+   rjob_pool.work_cond = scond_new();
+   rjob_pool.done_cond = scond_new();
+
+   if (!rjob_pool.lock || !rjob_pool.work_cond || !rjob_pool.done_cond)
+      goto error;
+
+   if (!workers)
+      return true;
+
+   rjob_pool.workers = (struct rjob_worker*)
+      calloc(workers, sizeof(*rjob_pool.workers));
+   if (!rjob_pool.workers)
+      goto error;
+
+   slock_lock(rjob_pool.lock);
+   for (i = 0; i < workers; i++)
+   {
+      struct rjob_worker *worker = &rjob_pool.workers[i];
+
+      worker->lock = slock_new();
+      if (!worker->lock)
+         break;
+
+      worker->thread = sthread_create(rjob_worker, worker);
+      if (!worker->thread)
+      {
+         slock_free(worker->lock);
+         worker->lock = NULL;
+         break;
+      }
+   }
+   rjob_pool.count = i;
+   slock_unlock(rjob_pool.lock);
+
+   return true;
+
+error:
+   rjob_pool.refs = 1;
+   rjob_deinit();
+   return false;
+}
+
+void rjob_deinit(void)
+{
+   unsigned i;
+
+   if (!rjob_pool.refs || --rjob_pool.refs)
+      return;
+
+   if (rjob_pool.lock)
+   {
+      slock_lock(rjob_pool.lock);
+      rjob_pool.quit = true;
+      if (rjob_pool.work_cond)
+         scond_broadcast(rjob_pool.work_cond);
+      slock_unlock(rjob_pool.lock);
+   }
+
+   for (i = 0; i < rjob_pool.count; i++)
+   {
+      sthread_join(rjob_pool.workers[i].thread);
+      slock_free(rjob_pool.workers[i].lock);
+   }
+   free(rjob_pool.workers);
+
+   if (rjob_pool.lock)
+      slock_free(rjob_pool.lock);
+   if (rjob_pool.work_cond)
+      scond_free(rjob_pool.work_cond);
+   if (rjob_pool.done_cond)
+      scond_free(rjob_pool.done_cond);
+
+   memset(&rjob_pool, 0, sizeof(rjob_pool));
+}
+
+unsigned rjob_worker_count(void)
+{
+   return rjob_pool.count;
+}
+
+void rjob_submit(rjob_group_t *group, rjob_func_t func, void *userdata)
+{
+   struct rjob job;
+   unsigned self;
+
+   if (!rjob_pool.count)
+   {
+      func(userdata);
+      return;
+   }
+
+   job.func     = func;
+   job.userdata = userdata;
+   job.group    = group;
+
+   self = rjob_self();
+
+   slock_lock(rjob_pool.lock);
+   if (group)
+      group->pending++;
+   if (self == rjob_pool.count)
+      self = rjob_pool.next++ % rjob_pool.count;
+   slock_unlock(rjob_pool.lock);
+
+   if (!rjob_push(&rjob_pool.workers[self], &job))
+   {
+      rjob_run(&job);
+      return;
+   }
+
+   slock_lock(rjob_pool.lock);
+   rjob_pool.queued++;
+   if (rjob_pool.sleeping)
+      scond_signal(rjob_pool.work_cond);
+   slock_unlock(rjob_pool.lock);
+}
+
+void rjob_wait(rjob_group_t *group)
+{
+   unsigned self;
+
+   if (!group || !rjob_pool.count)
+      return;
+
+   self = rjob_self();
+
+   for (;;)
+   {
+      struct rjob job;
+
+      slock_lock(rjob_pool.lock);
+      if (!group->pending)
+      {
+         slock_unlock(rjob_pool.lock);
+         break;
+      }
+      slock_unlock(rjob_pool.lock);
+
+      if (rjob_take(self, &job))
+      {
+         rjob_run(&job);
+         continue;
+      }
+
+      /* The rest of the group is running on other threads */
+      slock_lock(rjob_pool.lock);
+      if (group->pending)
+         scond_wait(rjob_pool.done_cond, rjob_pool.lock);
+      slock_unlock(rjob_pool.lock);
+   }
+}
+
+struct rjob_range
+{
+   rjob_range_func_t func;
+   void *userdata;
+   unsigned begin;
+   unsigned end;
+};
+
+static void rjob_range_run(void *data)
+{
+   struct rjob_range *range = (struct rjob_range*)data;
+   range->func(range->userdata, range->begin, range->end);
+}
+
+void rjob_parallel_for(unsigned count, unsigned grain,
+      rjob_range_func_t func, void *userdata)
+{
+   struct rjob_range ranges[RJOB_MAX_WORKERS + 1];
+   rjob_group_t group;
+   unsigned i, chunks, size, extra, begin;
+
+   if (!count)
+      return;
+   if (!grain)
+      grain  = 1;
+
+   chunks    = rjob_pool.count + 1;
+   if (chunks > (count + grain - 1) / grain)
+      chunks = (count + grain - 1) / grain;
+
+   if (chunks <= 1)
+   {
+      func(userdata, 0, count);
+      return;
+   }
+
+   size          = count / chunks;
+   extra         = count % chunks;
+   begin         = 0;
+   group.pending = 0;
+
+   for (i = 0; i < chunks; i++)
+   {
+      ranges[i].func     = func;
+      ranges[i].userdata = userdata;
+      ranges[i].begin    = begin;
+      begin             += size + (i < extra ? 1 : 0);
+      ranges[i].end      = begin;
+   }
+
+   for (i = 1; i < chunks; i++)
+      rjob_submit(&group, rjob_range_run, &ranges[i]);
+
+   rjob_range_run(&ranges[0]);
+   rjob_wait(&group);
+}
@@ -20,6 +20,11 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* For sched_setaffinity() */
+#define _GNU_SOURCE
+#endif
+
 #ifdef __unix__
 #ifndef __sun__
 #define _POSIX_C_SOURCE 199309
@@ -69,6 +74,27 @@
 #include <mach/mach.h>
 #endif
 
+#if defined(__linux__)
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__APPLE__) && defined(__MACH__)
+#include <Availability.h>
+#if (defined(__MAC_OS_X_VERSION_MIN_REQUIRED) && __MAC_OS_X_VERSION_MIN_REQUIRED >= 101000) || (defined(__IPHONE_OS_VERSION_MIN_REQUIRED) && __IPHONE_OS_VERSION_MIN_REQUIRED >= 80000)
+#include <pthread/qos.h>
+#define HAVE_PTHREAD_QOS
+#endif
+#endif
+
+#if defined(USE_WIN32_THREADS) && !defined(_XBOX) && !defined(__WINRT__)
+#define HAVE_WIN32_THREAD_POLICY
+typedef HANDLE (WINAPI *avset_mm_thread_characteristics_t)(LPCSTR, LPDWORD);
+#endif
+
 struct thread_data
 {
    void (*func)(void*);
@@ -136,6 +162,8 @@ struct scond
 #endif
 };
 
+static void sthread_reset_role(void);
+
 #ifdef USE_WIN32_THREADS
 static DWORD CALLBACK thread_wrap(void *data_)
 #else
@@ -145,6 +173,7 @@ static void *thread_wrap(void *data_)
    struct thread_data *data = (struct thread_data*)data_;
    if (!data)
 	   return 0;
+   sthread_reset_role();
    data->func(data->userdata);
    free(data);
    return 0;
@@ -317,6 +346,26 @@ bool sthread_isself(sthread_t *thread)
 #endif
 }
 
+/**
+ * sthread_get_current_thread_id:
+ *
+ * Returns: an identifier for the calling thread, only meant to tell
+ * threads apart (e.g. in log lines).
+ */
+uintptr_t sthread_get_current_thread_id(void)
+{
+#ifdef USE_WIN32_THREADS
+   return (uintptr_t)GetCurrentThreadId();
+#else
+   /* pthread_t is opaque; it is an integer or a pointer nearly
+    * everywhere, and anything else only has to stay distinct. */
+   uintptr_t id    = 0;
+   pthread_t self  = pthread_self();
+   memcpy(&id, &self, MIN(sizeof(id), sizeof(self)));
+   return id;
+#endif
+}
+
 /**
  * slock_new:
  *
@@ -923,3 +972,205 @@ bool sthread_tls_set(sthread_tls_t *tls, const void *data)
 #endif
 }
 #endif
+
+struct sthread_role_policy
+{
+   uint64_t affinity_mask;
+   bool priority;
+};
+
+static struct sthread_role_policy sthread_role_policies[STHREAD_ROLE_LAST];
+static bool sthread_role_policy_set = false;
+
+#if defined(__linux__) && defined(CPU_SET)
+static cpu_set_t sthread_default_affinity;
+static bool sthread_default_affinity_valid = false;
+#endif
+#if defined(__linux__) && defined(SYS_gettid)
+static int sthread_default_nice = 0;
+#endif
+
+/* Threads inherit the affinity and scheduling of the thread that
+ * starts them on Linux and Apple platforms, which would hand the
+ * core thread policy to everything it starts. Remember what the
+ * process started with and go back to it in each new thread. */
+static void sthread_save_default_role(void)
+{
+#if defined(__linux__) && defined(CPU_SET)
+   sthread_default_affinity_valid = sched_getaffinity(0,
+         sizeof(sthread_default_affinity), &sthread_default_affinity) == 0;
+#endif
+#if defined(__linux__) && defined(SYS_gettid)
+   errno                = 0;
+   sthread_default_nice = getpriority(PRIO_PROCESS,
+         (id_t)syscall(SYS_gettid));
+   if (errno)
+      sthread_default_nice = 0;
+#endif
+}
+
+static void sthread_reset_role(void)
+{
+   if (!sthread_role_policy_set)
+      return;
+
+#if defined(HAVE_PTHREAD_QOS)
+   pthread_set_qos_class_self_np(QOS_CLASS_DEFAULT, 0);
+#elif defined(__unix__) && defined(HAVE_THREAD_ATTR)
+   {
+      struct sched_param sp;
+      int policy = SCHED_OTHER;
+
+      memset(&sp, 0, sizeof(sp));
+      if (pthread_getschedparam(pthread_self(), &policy, &sp) == 0
+            && policy != SCHED_OTHER)
+      {
+         memset(&sp, 0, sizeof(sp));
+         pthread_setschedparam(pthread_self(), SCHED_OTHER, &sp);
+      }
+   }
+#endif
+#if defined(__linux__) && defined(SYS_gettid)
+   setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid),
+         sthread_default_nice);
+#endif
+#if defined(__linux__) && defined(CPU_SET)
+   if (sthread_default_affinity_valid)
+      sched_setaffinity(0, sizeof(sthread_default_affinity),
+            &sthread_default_affinity);
+#endif
+}
+
+static bool sthread_set_affinity(uint64_t mask)
+{
+#if defined(HAVE_WIN32_THREAD_POLICY)
+   return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)mask) != 0;
+#elif defined(__linux__) && defined(CPU_SET)
+   unsigned i;
+   cpu_set_t set;
+
+   CPU_ZERO(&set);
+   for (i = 0; i < 64 && i < CPU_SETSIZE; i++)
+      if (mask & ((uint64_t)1 << i))
+         CPU_SET(i, &set);
+
+   /* 0 is the calling thread, not the whole process */
+   return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+   return false;
+#endif
+}
+
+static bool sthread_set_priority(enum sthread_role role)
+{
+#if defined(HAVE_WIN32_THREAD_POLICY)
+   DWORD task_index                       = 0;
+   HMODULE avrt                           = NULL;
+   avset_mm_thread_characteristics_t mmcss = NULL;
+
+   if (role == STHREAD_ROLE_BACKGROUND)
+      return SetThreadPriority(GetCurrentThread(),
+            THREAD_PRIORITY_BELOW_NORMAL) != 0;
+
+   /* MMCSS is Vista and later. The library stays loaded, the
+    * thread is registered until it exits. */
+   avrt = LoadLibraryA("avrt.dll");
+   if (avrt)
+      mmcss = (avset_mm_thread_characteristics_t)
+         GetProcAddress(avrt, "AvSetMmThreadCharacteristicsA");
+   if (mmcss && mmcss(role == STHREAD_ROLE_AUDIO
+            ? "Pro Audio" : "Games", &task_index))
+      return true;
+   if (avrt)
+      FreeLibrary(avrt);
+
+   return SetThreadPriority(GetCurrentThread(),
+         role == STHREAD_ROLE_AUDIO
+         ? THREAD_PRIORITY_TIME_CRITICAL
+         : THREAD_PRIORITY_ABOVE_NORMAL) != 0;
+#elif defined(HAVE_PTHREAD_QOS)
+   return pthread_set_qos_class_self_np(
+         role == STHREAD_ROLE_BACKGROUND
+         ? QOS_CLASS_UTILITY : QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#elif defined(__unix__) && defined(HAVE_THREAD_ATTR)
+   struct sched_param sp;
+
+   if (role == STHREAD_ROLE_BACKGROUND)
+   {
+#if defined(__linux__) && defined(SYS_gettid)
+      return setpriority(PRIO_PROCESS,
+            (id_t)syscall(SYS_gettid), 10) == 0;
+#else
+      return false;
+#endif
+   }
+
+   /* Audio wakes up briefly and often, it may preempt the others */
+   memset(&sp, 0, sizeof(sp));
+   sp.sched_priority = sched_get_priority_min(SCHED_FIFO)
+      + (role == STHREAD_ROLE_AUDIO ? 2 : 1);
+#if defined(__linux__) && defined(SCHED_RESET_ON_FORK)
+   /* Libraries start threads of their own, which
+    * shouldn't inherit the priority. */
+   if (sched_setscheduler(0, SCHED_FIFO | SCHED_RESET_ON_FORK, &sp) == 0)
+      return true;
+#else
+   if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0)
+      return true;
+#endif
+
+#if defined(__linux__) && defined(SYS_gettid)
+   /* Realtime scheduling needs privileges. Raising the nice level
+    * of a thread usually doesn't, Android uses the same levels
+    * for its own audio and display threads. */
+   if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid),
+         role == STHREAD_ROLE_AUDIO ? -16 : -4) != 0)
+      return false;
+#if defined(SCHED_RESET_ON_FORK)
+   sp.sched_priority = 0;
+   sched_setscheduler(0, SCHED_OTHER | SCHED_RESET_ON_FORK, &sp);
+#endif
+   return true;
+#else
+   return false;
+#endif
+#else
+   return false;
+#endif
+}
+
+void sthread_set_role_policy(enum sthread_role role,
+      uint64_t affinity_mask, bool priority)
+{
+   if (role <= STHREAD_ROLE_DEFAULT || role >= STHREAD_ROLE_LAST)
+      return;
+   if (!affinity_mask && !priority && !sthread_role_policy_set)
+      return;
+
+   if (!sthread_role_policy_set)
+   {
+      sthread_save_default_role();
+      sthread_role_policy_set = true;
+   }
+
+   sthread_role_policies[role].affinity_mask = affinity_mask;
+   sthread_role_policies[role].priority      = priority;
+}
+
+bool sthread_set_role(enum sthread_role role)
+{
+   bool ret = true;
+   const struct sthread_role_policy *policy = NULL;
+
+   if (role <= STHREAD_ROLE_DEFAULT || role >= STHREAD_ROLE_LAST)
+      return true;
+
+   policy = &sthread_role_policies[role];
+
+   if (policy->affinity_mask && !sthread_set_affinity(policy->affinity_mask))
+      ret = false;
+   if (policy->priority && !sthread_set_priority(role))
+      ret = false;
+
+   return ret;
+}
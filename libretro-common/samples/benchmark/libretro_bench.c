@@ -0,0 +1,1013 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (libretro_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Microbenchmarks for the hot paths in libretro-common, meant to be
+ * diffed between releases:
+ *
+ *    libretro_bench [--time=MS] [--jpeg=FILE] [--png=FILE] [name ...]
+ *
+ * Every benchmark prints one CSV line to stdout,
+ *
+ *    name,iterations,usec_per_iter,mb_per_s
+ *
+ * where mb_per_s is empty for benchmarks without a natural byte count.
+ * Only benchmarks whose name contains one of the given strings are run.
+ * Without --png a generated image is encoded and decoded, rjpeg is
+ * only measured when a JPEG is given.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <boolean.h>
+
+#include <features/features_cpu.h>
+#include <gfx/scaler/scaler.h>
+#include <gfx/scaler/pixconv.h>
+#include <audio/audio_resampler.h>
+#include <audio/conversion/s16_to_float.h>
+#include <audio/conversion/float_to_s16.h>
+#include <encodings/crc32.h>
+#include <file/config_file.h>
+#include <formats/image.h>
+#include <formats/rpng.h>
+#include <formats/rjpeg.h>
+#include <libco.h>
+
+#ifdef HAVE_RMSGPACK
+#include "rmsgpack_dom.h"
+#endif
+#ifdef HAVE_STATE_DELTA
+#include "state_delta.h"
+#endif
+
+#define BENCH_WIDTH         320
+#define BENCH_HEIGHT        240
+#define BENCH_SCALE         4
+#define BENCH_AUDIO_FRAMES  1024
+#define BENCH_CRC32_SIZE    (1 << 20)
+#define BENCH_PNG_SIZE      512
+#define BENCH_CONFIG_KEYS   1024
+#define BENCH_RDB_ENTRIES   4096
+#define BENCH_STATE_SIZE    (1 << 20)
+#define BENCH_CO_SWITCHES   1000
+#define BENCH_CO_STACK      (64 * 1024)
+
+typedef void (*bench_func_t)(void *data);
+
+static retro_time_t bench_min_usec = 250000;
+static char **bench_filters        = NULL;
+static int bench_filter_count      = 0;
+static int bench_failures          = 0;
+
+static bool bench_selected(const char *name)
+{
+   int i;
+
+   if (!bench_filter_count)
+      return true;
+
+   for (i = 0; i < bench_filter_count; i++)
+      if (strstr(name, bench_filters[i]))
+         return true;
+
+   return false;
+}
+
+/* Runs 'func' once to warm up, then until bench_min_usec has passed.
+ * 'bytes' is the amount of data one call processes, or 0. */
+static void bench_run(const char *name, bench_func_t func,
+      void *data, size_t bytes)
+{
+   retro_time_t start, elapsed;
+   unsigned iterations = 0;
+
+   if (!bench_selected(name))
+      return;
+
+   func(data);
+
+   start = cpu_features_get_time_usec();
+   do
+   {
+      func(data);
+      iterations++;
+      elapsed = cpu_features_get_time_usec() - start;
+   } while (elapsed < bench_min_usec);
+
+   if (elapsed <= 0)
+      elapsed = 1;
+
+   printf("%s,%u,%.3f,", name, iterations,
+         (double)elapsed / iterations);
+   if (bytes)
+      printf("%.1f", (double)bytes * iterations / (double)elapsed);
+   putchar('\n');
+   fflush(stdout);
+}
+
+static void bench_fail(const char *name)
+{
+   fprintf(stderr, "%s: setup failed.\n", name);
+   bench_failures++;
+}
+
+static void bench_fill(void *data, size_t len)
+{
+   size_t i;
+   uint8_t *p = (uint8_t*)data;
+   uint32_t x = 0x12345678;
+
+   for (i = 0; i < len; i++)
+   {
+      x    = x * 1103515245 + 12345;
+      p[i] = (uint8_t)(x >> 16);
+   }
+}
+
+static void *bench_read_file(const char *path, size_t *len)
+{
+   long size;
+   void *ret = NULL;
+   FILE *f   = fopen(path, "rb");
+
+   if (!f)
+      return NULL;
+
+   fseek(f, 0, SEEK_END);
+   size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   if (size > 0 && (ret = malloc((size_t)size)))
+   {
+      if (fread(ret, 1, (size_t)size, f) == (size_t)size)
+         *len = (size_t)size;
+      else
+      {
+         free(ret);
+         ret = NULL;
+      }
+   }
+
+   fclose(f);
+   return ret;
+}
+
+/* Scaler */
+
+typedef struct
+{
+   struct scaler_ctx ctx;
+   void *output;
+   const void *input;
+} bench_scaler_t;
+
+static void bench_scaler_run(void *data)
+{
+   bench_scaler_t *b = (bench_scaler_t*)data;
+   scaler_ctx_scale(&b->ctx, b->output, b->input);
+}
+
+static void bench_scaler(void)
+{
+   unsigned i;
+   static const struct
+   {
+      enum scaler_type type;
+      enum scaler_pix_fmt in_fmt;
+      unsigned in_bpp;
+      const char *name;
+   } list[] = {
+      { SCALER_TYPE_POINT,    SCALER_FMT_ARGB8888, 4, "scaler/point/argb8888"    },
+      { SCALER_TYPE_BILINEAR, SCALER_FMT_ARGB8888, 4, "scaler/bilinear/argb8888" },
+      { SCALER_TYPE_SINC,     SCALER_FMT_ARGB8888, 4, "scaler/sinc/argb8888"     },
+      { SCALER_TYPE_BILINEAR, SCALER_FMT_RGB565,   2, "scaler/bilinear/rgb565"   },
+      { SCALER_TYPE_BILINEAR, SCALER_FMT_0RGB1555, 2, "scaler/bilinear/0rgb1555" },
+   };
+   size_t out_size = (size_t)BENCH_WIDTH * BENCH_SCALE
+      * BENCH_HEIGHT * BENCH_SCALE * sizeof(uint32_t);
+   void *input     = malloc(BENCH_WIDTH * BENCH_HEIGHT * sizeof(uint32_t));
+   void *output    = malloc(out_size);
+
+   if (!input || !output)
+   {
+      bench_fail("scaler");
+      goto end;
+   }
+
+   bench_fill(input, BENCH_WIDTH * BENCH_HEIGHT * sizeof(uint32_t));
+
+   for (i = 0; i < sizeof(list) / sizeof(list[0]); i++)
+   {
+      bench_scaler_t b;
+
+      if (!bench_selected(list[i].name))
+         continue;
+
+      memset(&b, 0, sizeof(b));
+      b.ctx.in_width    = BENCH_WIDTH;
+      b.ctx.in_height   = BENCH_HEIGHT;
+      b.ctx.in_stride   = BENCH_WIDTH * list[i].in_bpp;
+      b.ctx.out_width   = BENCH_WIDTH * BENCH_SCALE;
+      b.ctx.out_height  = BENCH_HEIGHT * BENCH_SCALE;
+      b.ctx.out_stride  = BENCH_WIDTH * BENCH_SCALE * sizeof(uint32_t);
+      b.ctx.in_fmt      = list[i].in_fmt;
+      b.ctx.out_fmt     = SCALER_FMT_ARGB8888;
+      b.ctx.scaler_type = list[i].type;
+      b.output          = output;
+      b.input           = input;
+
+      if (!scaler_ctx_gen_filter(&b.ctx))
+      {
+         bench_fail(list[i].name);
+         continue;
+      }
+
+      bench_run(list[i].name, bench_scaler_run, &b, out_size);
+      scaler_ctx_gen_reset(&b.ctx);
+   }
+
+end:
+   free(input);
+   free(output);
+}
+
+/* Pixel conversion */
+
+typedef void (*bench_pixconv_t)(void *output, const void *input,
+      int width, int height, int out_stride, int in_stride);
+
+typedef struct
+{
+   bench_pixconv_t conv;
+   void *output;
+   const void *input;
+   int out_stride;
+   int in_stride;
+} bench_conv_t;
+
+static void bench_pixconv_run(void *data)
+{
+   bench_conv_t *b = (bench_conv_t*)data;
+   b->conv(b->output, b->input, BENCH_WIDTH, BENCH_HEIGHT,
+         b->out_stride, b->in_stride);
+}
+
+static void bench_pixconv(void)
+{
+   unsigned i;
+   static const struct
+   {
+      bench_pixconv_t conv;
+      unsigned in_bpp;
+      unsigned out_bpp;
+      const char *name;
+   } list[] = {
+      { conv_0rgb1555_argb8888, 2, 4, "pixconv/0rgb1555_argb8888" },
+      { conv_rgb565_argb8888,   2, 4, "pixconv/rgb565_argb8888"   },
+      { conv_rgb565_abgr8888,   2, 4, "pixconv/rgb565_abgr8888"   },
+      { conv_argb8888_abgr8888, 4, 4, "pixconv/argb8888_abgr8888" },
+      { conv_bgr24_argb8888,    3, 4, "pixconv/bgr24_argb8888"    },
+      { conv_argb8888_bgr24,    4, 3, "pixconv/argb8888_bgr24"    },
+      { conv_yuyv_argb8888,     2, 4, "pixconv/yuyv_argb8888"     },
+   };
+   size_t size  = BENCH_WIDTH * BENCH_HEIGHT * sizeof(uint32_t);
+   void *input  = malloc(size);
+   void *output = malloc(size);
+
+   if (!input || !output)
+   {
+      bench_fail("pixconv");
+      goto end;
+   }
+
+   bench_fill(input, size);
+
+   for (i = 0; i < sizeof(list) / sizeof(list[0]); i++)
+   {
+      bench_conv_t b;
+
+      b.conv       = list[i].conv;
+      b.output     = output;
+      b.input      = input;
+      b.out_stride = BENCH_WIDTH * list[i].out_bpp;
+      b.in_stride  = BENCH_WIDTH * list[i].in_bpp;
+
+      bench_run(list[i].name, bench_pixconv_run, &b,
+            (size_t)BENCH_WIDTH * BENCH_HEIGHT * list[i].out_bpp);
+   }
+
+end:
+   free(input);
+   free(output);
+}
+
+/* Sample conversion */
+
+typedef struct
+{
+   int16_t *s16;
+   float *f;
+} bench_samples_t;
+
+static void bench_s16_to_float_run(void *data)
+{
+   bench_samples_t *b = (bench_samples_t*)data;
+   convert_s16_to_float(b->f, b->s16, BENCH_AUDIO_FRAMES * 2, 1.0f);
+}
+
+static void bench_float_to_s16_run(void *data)
+{
+   bench_samples_t *b = (bench_samples_t*)data;
+   convert_float_to_s16(b->s16, b->f, BENCH_AUDIO_FRAMES * 2);
+}
+
+static void bench_conversion(void)
+{
+   bench_samples_t b;
+
+   b.s16 = (int16_t*)malloc(BENCH_AUDIO_FRAMES * 2 * sizeof(int16_t));
+   b.f   = (float*)malloc(BENCH_AUDIO_FRAMES * 2 * sizeof(float));
+
+   if (!b.s16 || !b.f)
+      bench_fail("audio");
+   else
+   {
+      convert_s16_to_float_init_simd();
+      convert_float_to_s16_init_simd();
+
+      bench_fill(b.s16, BENCH_AUDIO_FRAMES * 2 * sizeof(int16_t));
+      bench_run("audio/s16_to_float", bench_s16_to_float_run, &b,
+            BENCH_AUDIO_FRAMES * 2 * sizeof(int16_t));
+      bench_run("audio/float_to_s16", bench_float_to_s16_run, &b,
+            BENCH_AUDIO_FRAMES * 2 * sizeof(int16_t));
+   }
+
+   free(b.s16);
+   free(b.f);
+}
+
+/* Resamplers */
+
+typedef struct
+{
+   const retro_resampler_t *backend;
+   void *handle;
+   float *input;
+   float *output;
+} bench_resampler_t;
+
+static void bench_resampler_run(void *data)
+{
+   struct resampler_data rd;
+   bench_resampler_t *b = (bench_resampler_t*)data;
+
+   rd.data_in       = b->input;
+   rd.data_out      = b->output;
+   rd.input_frames  = BENCH_AUDIO_FRAMES;
+   rd.output_frames = 0;
+   rd.ratio         = 48000.0 / 44100.0;
+
+   b->backend->process(b->handle, &rd);
+}
+
+static void bench_resampler(void)
+{
+   unsigned i;
+   static const struct
+   {
+      const retro_resampler_t *backend;
+      enum resampler_quality quality;
+      const char *name;
+   } list[] = {
+      { &sinc_resampler,    RESAMPLER_QUALITY_LOWER,  "resampler/sinc/lower"   },
+      { &sinc_resampler,    RESAMPLER_QUALITY_NORMAL, "resampler/sinc/normal"  },
+      { &sinc_resampler,    RESAMPLER_QUALITY_HIGHER, "resampler/sinc/higher"  },
+#ifdef HAVE_CC_RESAMPLER
+      { &CC_resampler,      RESAMPLER_QUALITY_NORMAL, "resampler/cc/normal"    },
+#endif
+      { &nearest_resampler, RESAMPLER_QUALITY_NORMAL, "resampler/nearest/normal" },
+   };
+   size_t in_size  = BENCH_AUDIO_FRAMES * 2 * sizeof(float);
+   float *input    = (float*)malloc(in_size);
+   /* Room for the ratio plus the frames a filter may flush. */
+   float *output   = (float*)malloc(in_size * 2 + 1024 * sizeof(float));
+
+   if (!input || !output)
+   {
+      bench_fail("resampler");
+      goto end;
+   }
+
+   for (i = 0; i < BENCH_AUDIO_FRAMES; i++)
+   {
+      input[2 * i + 0] = (float)sin(i * 0.1);
+      input[2 * i + 1] = (float)cos(i * 0.1);
+   }
+
+   for (i = 0; i < sizeof(list) / sizeof(list[0]); i++)
+   {
+      bench_resampler_t b;
+
+      if (!bench_selected(list[i].name))
+         continue;
+
+      b.backend = list[i].backend;
+      b.handle  = b.backend->init(NULL, 48000.0 / 44100.0,
+            list[i].quality, cpu_features_get());
+      b.input   = input;
+      b.output  = output;
+
+      if (!b.handle)
+      {
+         bench_fail(list[i].name);
+         continue;
+      }
+
+      bench_run(list[i].name, bench_resampler_run, &b, in_size);
+      b.backend->free(b.handle);
+   }
+
+end:
+   free(input);
+   free(output);
+}
+
+/* CRC32 */
+
+static volatile uint32_t bench_crc32_sink;
+
+static void bench_crc32_run(void *data)
+{
+   bench_crc32_sink = encoding_crc32(0, (const uint8_t*)data, BENCH_CRC32_SIZE);
+}
+
+static void bench_crc32(void)
+{
+   uint8_t *buf = (uint8_t*)malloc(BENCH_CRC32_SIZE);
+
+   if (!buf)
+   {
+      bench_fail("crc32");
+      return;
+   }
+
+   bench_fill(buf, BENCH_CRC32_SIZE);
+   bench_run("crc32/1M", bench_crc32_run, buf, BENCH_CRC32_SIZE);
+   free(buf);
+}
+
+/* libco */
+
+static cothread_t bench_co_main;
+
+static void bench_co_entry(void)
+{
+   for (;;)
+      co_switch(bench_co_main);
+}
+
+/* BENCH_CO_SWITCHES round trips, two switches each */
+static void bench_co_switch_run(void *data)
+{
+   unsigned i;
+   cothread_t co = (cothread_t)data;
+
+   for (i = 0; i < BENCH_CO_SWITCHES; i++)
+      co_switch(co);
+}
+
+static void bench_co_create_run(void *data)
+{
+   cothread_t co = co_create(BENCH_CO_STACK, bench_co_entry);
+   co_delete(co);
+}
+
+static void bench_libco(void)
+{
+   cothread_t co;
+
+   bench_co_main = co_active();
+   if (!(co = co_create(BENCH_CO_STACK, bench_co_entry)))
+   {
+      bench_fail("libco");
+      return;
+   }
+
+   bench_run("libco/switch_x1000", bench_co_switch_run, co, 0);
+   bench_run("libco/create_64k", bench_co_create_run, NULL, 0);
+   co_delete(co);
+}
+
+/* Image decoders */
+
+typedef struct
+{
+   void *data;
+   size_t len;
+   unsigned width;
+   unsigned height;
+   bool valid;
+} bench_image_t;
+
+static void bench_rpng_run(void *data)
+{
+   int ret;
+   uint32_t *out      = NULL;
+   bench_image_t *b   = (bench_image_t*)data;
+   rpng_t *rpng       = rpng_alloc();
+
+   if (  !rpng
+       || !rpng_set_buf_ptr(rpng, b->data)
+       || !rpng_start(rpng))
+   {
+      b->valid = false;
+      rpng_free(rpng);
+      return;
+   }
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      b->valid = false;
+   else
+   {
+      do
+      {
+         ret = rpng_process_image(rpng, (void**)&out,
+               b->len, &b->width, &b->height);
+      } while (ret == IMAGE_PROCESS_NEXT);
+
+      if (ret != IMAGE_PROCESS_END)
+         b->valid = false;
+   }
+
+   free(out);
+   rpng_free(rpng);
+}
+
+static void bench_rjpeg_run(void *data)
+{
+   void *out        = NULL;
+   bench_image_t *b = (bench_image_t*)data;
+   rjpeg_t *rjpeg   = rjpeg_alloc();
+
+   if (  !rjpeg
+       || !rjpeg_set_buf_ptr(rjpeg, b->data)
+       || rjpeg_process_image(rjpeg, &out, b->len, &b->width, &b->height)
+          != IMAGE_PROCESS_END)
+      b->valid = false;
+
+   free(out);
+   rjpeg_free(rjpeg);
+}
+
+#define BENCH_PNG_PATH "libretro_bench.tmp.png"
+
+/* The PNG is encoded from a smooth gradient, which deflates about
+ * as well as typical thumbnails do. */
+static uint32_t *bench_png_pixels(void)
+{
+   unsigned x, y;
+   uint32_t *pixels = (uint32_t*)malloc(
+         BENCH_PNG_SIZE * BENCH_PNG_SIZE * sizeof(uint32_t));
+
+   if (!pixels)
+      return NULL;
+
+   for (y = 0; y < BENCH_PNG_SIZE; y++)
+      for (x = 0; x < BENCH_PNG_SIZE; x++)
+         pixels[y * BENCH_PNG_SIZE + x] = 0xff000000u
+            | ((x & 0xff) << 16) | ((y & 0xff) << 8)
+            | ((x ^ y) & 0xff);
+
+   return pixels;
+}
+
+static void *bench_encode_png(size_t *len)
+{
+   void *ret        = NULL;
+   const char *path = BENCH_PNG_PATH;
+   uint32_t *pixels = bench_png_pixels();
+
+   if (!pixels)
+      return NULL;
+
+   if (rpng_save_image_argb(path, pixels, BENCH_PNG_SIZE, BENCH_PNG_SIZE,
+            BENCH_PNG_SIZE * sizeof(uint32_t)))
+      ret = bench_read_file(path, len);
+
+   remove(path);
+   free(pixels);
+   return ret;
+}
+
+static void bench_image(const char *name, bench_func_t func,
+      void *data, size_t len)
+{
+   bench_image_t b;
+
+   if (!bench_selected(name))
+      return;
+
+   b.data   = data;
+   b.len    = len;
+   b.width  = 0;
+   b.height = 0;
+   b.valid  = true;
+
+   func(&b);
+   if (!b.valid)
+   {
+      fprintf(stderr, "%s: could not decode image.\n", name);
+      bench_failures++;
+      return;
+   }
+
+   /* Throughput is given in decoded bytes. */
+   bench_run(name, func, &b, (size_t)b.width * b.height * sizeof(uint32_t));
+}
+
+/* Image encoders */
+
+typedef struct
+{
+   const uint32_t *pixels;
+   bool fast;
+   bool valid;
+} bench_png_encode_t;
+
+static void bench_png_encode_run(void *data)
+{
+   bench_png_encode_t *b = (bench_png_encode_t*)data;
+   unsigned pitch        = BENCH_PNG_SIZE * sizeof(uint32_t);
+
+   if (!(b->fast
+         ? rpng_save_image_argb_fast(BENCH_PNG_PATH, b->pixels,
+            BENCH_PNG_SIZE, BENCH_PNG_SIZE, pitch)
+         : rpng_save_image_argb(BENCH_PNG_PATH, b->pixels,
+            BENCH_PNG_SIZE, BENCH_PNG_SIZE, pitch)))
+      b->valid = false;
+}
+
+static void bench_png_encode(void)
+{
+   unsigned i;
+   static const char *names[] = {
+      "image/rpng_encode",
+      "image/rpng_encode_fast",
+   };
+   uint32_t *pixels = bench_png_pixels();
+
+   if (!pixels)
+   {
+      bench_fail("image/rpng_encode");
+      return;
+   }
+
+   for (i = 0; i < 2; i++)
+   {
+      bench_png_encode_t b;
+
+      b.pixels = pixels;
+      b.fast   = (i == 1);
+      b.valid  = true;
+
+      bench_run(names[i], bench_png_encode_run, &b,
+            BENCH_PNG_SIZE * BENCH_PNG_SIZE * sizeof(uint32_t));
+      if (!b.valid)
+         bench_fail(names[i]);
+   }
+
+   remove(BENCH_PNG_PATH);
+   free(pixels);
+}
+
+static void bench_images(const char *png_path, const char *jpeg_path)
+{
+   size_t len = 0;
+   void *data = NULL;
+
+   if (bench_selected("image/rpng"))
+   {
+      data = png_path
+         ? bench_read_file(png_path, &len)
+         : bench_encode_png(&len);
+
+      if (!data)
+         bench_fail("image/rpng");
+      else
+         bench_image("image/rpng", bench_rpng_run, data, len);
+      free(data);
+   }
+
+   if (jpeg_path && bench_selected("image/rjpeg"))
+   {
+      if (!(data = bench_read_file(jpeg_path, &len)))
+         bench_fail("image/rjpeg");
+      else
+         bench_image("image/rjpeg", bench_rjpeg_run, data, len);
+      free(data);
+   }
+}
+
+/* Config files */
+
+static void bench_config_run(void *data)
+{
+   config_file_t *conf = config_file_new_from_string((const char*)data);
+
+   if (conf)
+      config_file_free(conf);
+}
+
+static void bench_config(void)
+{
+   unsigned i;
+   size_t len   = 0;
+   size_t size  = BENCH_CONFIG_KEYS * 64;
+   char *string = (char*)malloc(size);
+
+   if (!string)
+   {
+      bench_fail("config");
+      return;
+   }
+
+   /* Shaped like a retroarch.cfg: quoted values, some comments. */
+   for (i = 0; i < BENCH_CONFIG_KEYS; i++)
+   {
+      if (!(i % 16))
+         len += snprintf(string + len, size - len, "# section %u\n", i / 16);
+      len += snprintf(string + len, size - len,
+            "bench_setting_%u = \"%u\"\n", i, i * 7);
+   }
+
+   bench_run("config/parse", bench_config_run, string, len);
+   free(string);
+}
+
+#ifdef HAVE_RMSGPACK
+/* rmsgpack */
+
+typedef struct
+{
+   uint8_t *data;
+   size_t len;
+   struct rmsgpack_dom_scratch scratch;
+   bool valid;
+} bench_msgpack_t;
+
+static size_t bench_msgpack_str(uint8_t *out, const char *s)
+{
+   size_t len = strlen(s);
+
+   out[0] = 0xd9;
+   out[1] = (uint8_t)len;
+   memcpy(out + 2, s, len);
+   return len + 2;
+}
+
+static size_t bench_msgpack_be32(uint8_t *out, uint32_t val)
+{
+   out[0] = (uint8_t)(val >> 24);
+   out[1] = (uint8_t)(val >> 16);
+   out[2] = (uint8_t)(val >>  8);
+   out[3] = (uint8_t)(val >>  0);
+   return 4;
+}
+
+/* An array of maps, the shape of a libretro database. */
+static size_t bench_msgpack_build(uint8_t *out)
+{
+   unsigned i;
+   size_t len = 0;
+
+   out[len++] = 0xdd;
+   len       += bench_msgpack_be32(out + len, BENCH_RDB_ENTRIES);
+
+   for (i = 0; i < BENCH_RDB_ENTRIES; i++)
+   {
+      char name[64];
+      uint32_t crc = encoding_crc32(0, (const uint8_t*)&i, sizeof(i));
+
+      snprintf(name, sizeof(name), "Benchmark Game %u (World) (Rev %u)",
+            i, i % 3);
+
+      out[len++] = 0x84;
+      len += bench_msgpack_str(out + len, "name");
+      len += bench_msgpack_str(out + len, name);
+      len += bench_msgpack_str(out + len, "rom_name");
+      len += bench_msgpack_str(out + len, name);
+      len += bench_msgpack_str(out + len, "size");
+      out[len++] = 0xce;
+      len += bench_msgpack_be32(out + len, i * 1024);
+      len += bench_msgpack_str(out + len, "crc");
+      out[len++] = 0xc4;
+      out[len++] = 4;
+      len += bench_msgpack_be32(out + len, crc);
+   }
+
+   return len;
+}
+
+static void bench_msgpack_run(void *data)
+{
+   struct rmsgpack_dom_value value;
+   size_t offset      = 0;
+   bench_msgpack_t *b = (bench_msgpack_t*)data;
+
+   if (rmsgpack_dom_read_buf(b->data, b->len, &offset,
+            &value, &b->scratch) < 0 || offset != b->len)
+      b->valid = false;
+}
+
+static void bench_msgpack(void)
+{
+   bench_msgpack_t b;
+
+   if (!bench_selected("rmsgpack/dom_read_buf"))
+      return;
+
+   memset(&b, 0, sizeof(b));
+   b.valid = true;
+
+   if (!(b.data = (uint8_t*)malloc(BENCH_RDB_ENTRIES * 192)))
+   {
+      bench_fail("rmsgpack");
+      return;
+   }
+
+   b.len = bench_msgpack_build(b.data);
+
+   bench_msgpack_run(&b);
+   if (!b.valid)
+      bench_fail("rmsgpack/dom_read_buf");
+   else
+      bench_run("rmsgpack/dom_read_buf", bench_msgpack_run, &b, b.len);
+
+   rmsgpack_dom_scratch_free(&b.scratch);
+   free(b.data);
+}
+#endif
+
+#ifdef HAVE_STATE_DELTA
+/* Rewind delta scan */
+
+typedef struct
+{
+   const state_delta_kernels_t *kernels;
+   const uint16_t *old16;
+   const uint16_t *new16;
+} bench_delta_t;
+
+/* The walk state_manager_raw_compress() does, without the output. */
+static void bench_delta_run(void *data)
+{
+   bench_delta_t *b      = (bench_delta_t*)data;
+   const uint16_t *old16 = b->old16;
+   const uint16_t *new16 = b->new16;
+   size_t num16s         = BENCH_STATE_SIZE / sizeof(uint16_t);
+
+   while (num16s)
+   {
+      size_t changed;
+      size_t skip = b->kernels->find_change(old16, new16);
+
+      if (skip >= num16s)
+         break;
+
+      old16  += skip;
+      new16  += skip;
+      num16s -= skip;
+
+      if (skip > 0xffff)
+         continue;
+
+      changed = b->kernels->find_same(old16, new16);
+      if (changed > 0xffff)
+         changed = 0xffff;
+
+      old16  += changed;
+      new16  += changed;
+      num16s -= (changed < num16s) ? changed : num16s;
+   }
+}
+
+static void bench_state_delta(void)
+{
+   unsigned i, count;
+   state_delta_kernels_t list[8];
+   /* Same layout as state_manager_raw_alloc(): a sentinel word that
+    * differs between the two states stops find_change(). */
+   size_t words    = BENCH_STATE_SIZE / sizeof(uint16_t) + 4
+      + STATE_DELTA_PADDING / sizeof(uint16_t);
+   uint16_t *old16 = (uint16_t*)calloc(words, sizeof(uint16_t));
+   uint16_t *new16 = (uint16_t*)calloc(words, sizeof(uint16_t));
+
+   if (!old16 || !new16)
+   {
+      bench_fail("state_delta");
+      goto end;
+   }
+
+   bench_fill(old16, BENCH_STATE_SIZE);
+   memcpy(new16, old16, BENCH_STATE_SIZE);
+   /* A frame of emulation usually touches small scattered runs. */
+   for (i = 0; i < BENCH_STATE_SIZE / sizeof(uint16_t); i += 997)
+      new16[i] ^= 0x5a5a;
+   new16[BENCH_STATE_SIZE / sizeof(uint16_t) + 3] = 1;
+
+   count = state_delta_kernels_list(cpu_features_get(), list,
+         sizeof(list) / sizeof(list[0]));
+
+   for (i = 0; i < count; i++)
+   {
+      char name[64];
+      bench_delta_t b;
+
+      b.kernels = &list[i];
+      b.old16   = old16;
+      b.new16   = new16;
+
+      snprintf(name, sizeof(name), "state_delta/%s", list[i].ident);
+      bench_run(name, bench_delta_run, &b, BENCH_STATE_SIZE);
+   }
+
+end:
+   free(old16);
+   free(new16);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+   int i;
+   const char *png_path  = NULL;
+   const char *jpeg_path = NULL;
+
+   bench_filters = (char**)calloc(argc, sizeof(char*));
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strncmp(argv[i], "--time=", 7))
+         bench_min_usec = (retro_time_t)atoi(argv[i] + 7) * 1000;
+      else if (!strncmp(argv[i], "--png=", 6))
+         png_path = argv[i] + 6;
+      else if (!strncmp(argv[i], "--jpeg=", 7))
+         jpeg_path = argv[i] + 7;
+      else if (argv[i][0] == '-')
+      {
+         fprintf(stderr,
+               "Usage: %s [--time=MS] [--jpeg=FILE] [--png=FILE] [name ...]\n",
+               argv[0]);
+         free(bench_filters);
+         return 1;
+      }
+      else if (bench_filters)
+         bench_filters[bench_filter_count++] = argv[i];
+   }
+
+   printf("name,iterations,usec_per_iter,mb_per_s\n");
+
+   bench_scaler();
+   bench_pixconv();
+   bench_conversion();
+   bench_resampler();
+   bench_crc32();
+   bench_libco();
+   bench_images(png_path, jpeg_path);
+   bench_png_encode();
+   bench_config();
+#ifdef HAVE_RMSGPACK
+   bench_msgpack();
+#endif
+#ifdef HAVE_STATE_DELTA
+   bench_state_delta();
+#endif
+
+   free(bench_filters);
+   return bench_failures ? 1 : 0;
+}
@@ -30,10 +30,35 @@
 #include <retro_endianness.h>
 #include <libchdr/chd.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Decompressed hunks kept per stream */
+#define CHDSTREAM_CACHE_HUNKS 8
+/* Hunks decompressed ahead of a sequential reader; less than the
+ * cache holds so read-ahead never evicts what is being read. */
+#define CHDSTREAM_READ_AHEAD 4
+
+enum chdstream_hunk_state
+{
+   CHDSTREAM_HUNK_EMPTY = 0,
+   CHDSTREAM_HUNK_LOADING,
+   CHDSTREAM_HUNK_READY
+};
+
+typedef struct chdstream_hunk
+{
+   uint8_t *mem;
+   uint32_t hunknum;
+   unsigned used;
+   enum chdstream_hunk_state state;
+} chdstream_hunk_t;
+
 struct chdstream
 {
    chd_file *chd;
@@ -53,10 +78,23 @@ struct chdstream
    size_t track_end;
    /* Byte offset of read cursor */
    size_t offset;
-   /* Loaded hunk number */
-   int32_t hunknum;
-   /* Loaded hunk */
-   uint8_t *hunkmem;
+   /* Hunk being read from, never evicted */
+   chdstream_hunk_t *hunk;
+   /* Decompressed hunks, least recently used evicted first */
+   chdstream_hunk_t hunks[CHDSTREAM_CACHE_HUNKS];
+   unsigned clock;
+#ifdef HAVE_THREADS
+   /* Worker decompressing hunks [ahead_next, ahead_end) */
+   sthread_t *thread;
+   /* Guards the cache, the read-ahead range and quit */
+   slock_t *lock;
+   /* The chd itself is used by one thread at a time */
+   slock_t *chd_lock;
+   scond_t *cond;
+   uint32_t ahead_next;
+   uint32_t ahead_end;
+   bool quit;
+#endif
 };
 
 typedef struct metadata {
@@ -202,6 +240,7 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
+   unsigned i;
    uint32_t pregap      = 0;
    const chd_header *hd = NULL;
    chdstream_t *stream  = NULL;
@@ -219,9 +258,12 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
       goto error;
 
    hd              = chd_get_header(chd);
-   stream->hunkmem = (uint8_t*)malloc(hd->hunkbytes);
-   if (!stream->hunkmem)
-      goto error;
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      stream->hunks[i].mem = (uint8_t*)malloc(hd->hunkbytes);
+      if (!stream->hunks[i].mem)
+         goto error;
+   }
 
    if (!strcmp(meta.type, "MODE1_RAW"))
    {
@@ -259,12 +301,21 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    stream->track_end       = stream->track_start +
       (size_t) meta.frames * stream->frame_size;
    stream->offset          = 0;
-   stream->hunknum         = -1;
+
+#ifdef HAVE_THREADS
+   stream->lock            = slock_new();
+   stream->chd_lock        = slock_new();
+   stream->cond            = scond_new();
+   if (!stream->lock || !stream->chd_lock || !stream->cond)
+      goto error;
+#endif
 
    return stream;
 
 error:
 
+   if (stream)
+      stream->chd = NULL;
    chdstream_close(stream);
 
    if (chd)
@@ -275,43 +326,261 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
-   if (stream)
+   unsigned i;
+
+   if (!stream)
+      return;
+
+#ifdef HAVE_THREADS
+   if (stream->thread)
    {
-      if (stream->hunkmem)
-         free(stream->hunkmem);
-      if (stream->chd)
-         chd_close(stream->chd);
-      free(stream);
+      slock_lock(stream->lock);
+      stream->quit = true;
+      scond_broadcast(stream->cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->thread);
    }
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->chd_lock)
+      slock_free(stream->chd_lock);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+      free(stream->hunks[i].mem);
+   if (stream->chd)
+      chd_close(stream->chd);
+   free(stream);
+}
+
+static void chdstream_lock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+#endif
+}
+
+static void chdstream_unlock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
 }
 
+static chdstream_hunk_t *
+chdstream_find_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   unsigned i;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      chdstream_hunk_t *hunk = &stream->hunks[i];
+      if (hunk->state != CHDSTREAM_HUNK_EMPTY && hunk->hunknum == hunknum)
+         return hunk;
+   }
+
+   return NULL;
+}
+
+/* Least recently used hunk neither being read from nor being
+ * decompressed into, NULL if there is none. Hunks read ahead
+ * that the reader has yet to get to are kept as well. */
+static chdstream_hunk_t *chdstream_evict_hunk(chdstream_t *stream)
+{
+   unsigned i;
+   chdstream_hunk_t *victim = NULL;
+
+   for (i = 0; i < CHDSTREAM_CACHE_HUNKS; i++)
+   {
+      chdstream_hunk_t *hunk = &stream->hunks[i];
+
+      if (hunk == stream->hunk || hunk->state == CHDSTREAM_HUNK_LOADING)
+         continue;
+#ifdef HAVE_THREADS
+      if (     stream->hunk
+            && hunk->state   == CHDSTREAM_HUNK_READY
+            && hunk->hunknum >  stream->hunk->hunknum
+            && hunk->hunknum <  stream->ahead_end)
+         continue;
+#endif
+      if (hunk->state == CHDSTREAM_HUNK_EMPTY)
+         return hunk;
+      if (!victim || hunk->used < victim->used)
+         victim = hunk;
+   }
+
+   return victim;
+}
+
+/* Decompresses into a hunk marked LOADING, with the cache lock
+ * released. */
 static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+chdstream_decompress_hunk(chdstream_t *stream, chdstream_hunk_t *hunk)
 {
    chd_error err;
-   uint16_t *array;
-   uint32_t i;
-   uint32_t count;
 
-   if (hunknum == stream->hunknum)
-      return true;
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   err = chd_read(stream->chd, hunk->hunknum, hunk->mem);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
 
-   err = chd_read(stream->chd, hunknum, stream->hunkmem);
    if (err != CHDERR_NONE)
       return false;
 
    if (stream->swab)
    {
-      count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array = (uint16_t*) stream->hunkmem;
+      uint32_t i;
+      uint32_t count  = chd_get_header(stream->chd)->hunkbytes / 2;
+      uint16_t *array = (uint16_t*)hunk->mem;
       for (i = 0; i < count; ++i)
          array[i] = SWAP16(array[i]);
    }
 
-   stream->hunknum = hunknum;
    return true;
 }
 
+#ifdef HAVE_THREADS
+static void chdstream_read_ahead_thread(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+
+   slock_lock(stream->lock);
+
+   while (!stream->quit)
+   {
+      bool ok;
+      chdstream_hunk_t *hunk = NULL;
+
+      if (stream->ahead_next >= stream->ahead_end)
+      {
+         scond_wait(stream->cond, stream->lock);
+         continue;
+      }
+
+      if (chdstream_find_hunk(stream, stream->ahead_next)
+            || !(hunk = chdstream_evict_hunk(stream)))
+      {
+         stream->ahead_next++;
+         continue;
+      }
+
+      hunk->hunknum = stream->ahead_next++;
+      hunk->state   = CHDSTREAM_HUNK_LOADING;
+      slock_unlock(stream->lock);
+
+      ok            = chdstream_decompress_hunk(stream, hunk);
+
+      slock_lock(stream->lock);
+      hunk->state   = ok ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+      hunk->used    = ++stream->clock;
+      scond_broadcast(stream->cond);
+   }
+
+   slock_unlock(stream->lock);
+}
+
+/* Reading hunk 'hunknum' after the one before it: have the worker
+ * start on the hunks that come next. */
+static void chdstream_read_ahead(chdstream_t *stream, uint32_t hunknum)
+{
+   uint32_t total = chd_get_header(stream->chd)->totalhunks;
+   uint32_t end   = hunknum + 1 + CHDSTREAM_READ_AHEAD;
+
+   if (end > total)
+      end = total;
+   if (stream->ahead_next < hunknum + 1 || stream->ahead_next > end)
+      stream->ahead_next = hunknum + 1;
+   if (stream->ahead_next >= end)
+      return;
+
+   stream->ahead_end = end;
+
+   if (!stream->thread)
+      stream->thread = sthread_create(chdstream_read_ahead_thread, stream);
+
+   scond_broadcast(stream->cond);
+}
+#endif
+
+static bool
+chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   chdstream_hunk_t *hunk     = NULL;
+   chdstream_hunk_t *previous = stream->hunk;
+   bool ok                    = true;
+
+   if (previous && previous->hunknum == hunknum)
+      return true;
+
+   chdstream_lock(stream);
+
+#ifdef HAVE_THREADS
+   if (previous && previous->hunknum + 1 == hunknum)
+      chdstream_read_ahead(stream, hunknum);
+   else
+   {
+      /* Seeked away, what was ahead is of no use now */
+      stream->ahead_next = 0;
+      stream->ahead_end  = 0;
+   }
+#endif
+
+   for (;;)
+   {
+      if ((hunk = chdstream_find_hunk(stream, hunknum)))
+      {
+#ifdef HAVE_THREADS
+         /* The worker is on it already */
+         if (hunk->state == CHDSTREAM_HUNK_LOADING)
+         {
+            scond_wait(stream->cond, stream->lock);
+            continue;
+         }
+#endif
+         break;
+      }
+
+      if (!(hunk = chdstream_evict_hunk(stream)))
+      {
+#ifdef HAVE_THREADS
+         scond_wait(stream->cond, stream->lock);
+         continue;
+#else
+         ok = false;
+         break;
+#endif
+      }
+
+      hunk->hunknum = hunknum;
+      hunk->state   = CHDSTREAM_HUNK_LOADING;
+      chdstream_unlock(stream);
+
+      ok            = chdstream_decompress_hunk(stream, hunk);
+
+      chdstream_lock(stream);
+      hunk->state   = ok ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+#ifdef HAVE_THREADS
+      scond_broadcast(stream->cond);
+#endif
+      break;
+   }
+
+   if (ok)
+   {
+      hunk->used   = ++stream->clock;
+      stream->hunk = hunk;
+   }
+
+   chdstream_unlock(stream);
+
+   return ok;
+}
+
 ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
 {
    size_t end;
@@ -350,7 +619,7 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
             return -1;
          }
          memcpy(out + data_offset,
-                stream->hunkmem + frame_offset
+                stream->hunk->mem + frame_offset
                 + hunk_offset + stream->frame_offset, amount);
       }
 
@@ -49,6 +49,8 @@ static retro_vfs_write_t filestream_write_cb       = NULL;
 static retro_vfs_flush_t filestream_flush_cb       = NULL;
 static retro_vfs_remove_t filestream_remove_cb     = NULL;
 static retro_vfs_rename_t filestream_rename_cb     = NULL;
+static retro_vfs_read_async_t filestream_read_async_cb = NULL;
+static retro_vfs_async_poll_t filestream_async_poll_cb = NULL;
 
 struct RFILE
 {
@@ -75,6 +77,8 @@ void filestream_vfs_init(const struct retro_vfs_interface_info* vfs_info)
    filestream_flush_cb    = NULL;
    filestream_remove_cb   = NULL;
    filestream_rename_cb   = NULL;
+   filestream_read_async_cb = NULL;
+   filestream_async_poll_cb = NULL;
 
    vfs_iface              = vfs_info->iface;
 
@@ -94,6 +98,12 @@ void filestream_vfs_init(const struct retro_vfs_interface_info* vfs_info)
    filestream_flush_cb    = vfs_iface->flush;
    filestream_remove_cb   = vfs_iface->remove;
    filestream_rename_cb   = vfs_iface->rename;
+
+   if (vfs_info->required_interface_version >= 3)
+   {
+      filestream_read_async_cb = vfs_iface->read_async;
+      filestream_async_poll_cb = vfs_iface->async_poll;
+   }
 }
 
 /* Callback wrappers */
@@ -366,6 +376,49 @@ int64_t filestream_read(RFILE *stream, void *s, int64_t len)
    return output;
 }
 
+int64_t filestream_read_async(RFILE *stream, void *s, int64_t len,
+      int64_t offset, struct retro_vfs_async_request **request)
+{
+   int64_t pos;
+   int64_t output = vfs_error_return_value;
+
+   *request       = NULL;
+
+   if (filestream_read_async_cb != NULL)
+   {
+      if ((*request = filestream_read_async_cb(stream->hfile, s, len, offset)))
+         return RETRO_VFS_ASYNC_PENDING;
+   }
+   else if (filestream_open_cb == NULL)
+   {
+      if ((*request = retro_vfs_file_read_async_impl(
+                  (libretro_vfs_implementation_file*)stream->hfile,
+                  s, len, offset)))
+         return RETRO_VFS_ASYNC_PENDING;
+   }
+   /* Frontend VFS without asynchronous reads */
+   else if ((pos = filestream_tell(stream)) >= 0)
+   {
+      if (filestream_seek(stream, offset, RETRO_VFS_SEEK_POSITION_START) >= 0)
+         output = filestream_read_cb(stream->hfile, s, len);
+      filestream_seek(stream, pos, RETRO_VFS_SEEK_POSITION_START);
+   }
+
+   if (output == vfs_error_return_value)
+      stream->error_flag = true;
+
+   return output;
+}
+
+int64_t filestream_async_poll(struct retro_vfs_async_request *request,
+      bool wait)
+{
+   if (filestream_async_poll_cb != NULL)
+      return filestream_async_poll_cb(request, wait);
+   return retro_vfs_async_poll_impl(
+         (libretro_vfs_implementation_async*)request, wait);
+}
+
 int filestream_flush(RFILE *stream)
 {
    int output;
@@ -154,6 +154,23 @@ int intfstream_flush(intfstream_internal_t *intf)
    return 0;
 }
 
+int64_t intfstream_truncate(intfstream_internal_t *intf, int64_t length)
+{
+   if (!intf)
+      return -1;
+
+   switch (intf->type)
+   {
+      case INTFSTREAM_FILE:
+         return filestream_truncate(intf->file.fp, length);
+      case INTFSTREAM_MEMORY:
+      case INTFSTREAM_CHD:
+         break;
+   }
+
+   return -1;
+}
+
 int intfstream_close(intfstream_internal_t *intf)
 {
    if (!intf)
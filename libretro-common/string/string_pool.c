@@ -0,0 +1,235 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (string_pool.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string/string_pool.h>
+
+struct string_pool_str
+{
+   uint32_t hash;
+   uint32_t refs;
+   char str[1];
+};
+
+/* Open addressing with linear probing, slots hold the strings
+ * themselves. Removal shifts the following run back instead of
+ * leaving tombstones. */
+struct string_pool
+{
+   struct string_pool_str **slots;
+   size_t cap;
+   size_t count;
+};
+
+#define STRING_POOL_HDR(s) ((struct string_pool_str*)((s) \
+         - offsetof(struct string_pool_str, str)))
+
+static uint32_t string_pool_hash(const char *str, size_t len)
+{
+   const uint8_t *p = (const uint8_t*)str;
+   uint32_t hash    = 2166136261u;
+
+   while (len--)
+      hash = (hash ^ *p++) * 16777619u;
+
+   return hash;
+}
+
+static size_t string_pool_slot(const string_pool_t *pool,
+      const char *str, size_t len, uint32_t hash)
+{
+   size_t mask = pool->cap - 1;
+   size_t i    = hash & mask;
+
+   while (pool->slots[i])
+   {
+      if (     pool->slots[i]->hash == hash
+            && !memcmp(pool->slots[i]->str, str, len)
+            && pool->slots[i]->str[len] == '\0')
+         break;
+      i = (i + 1) & mask;
+   }
+
+   return i;
+}
+
+static bool string_pool_grow(string_pool_t *pool)
+{
+   size_t i;
+   size_t cap                    = pool->cap ? pool->cap * 2 : 64;
+   struct string_pool_str **old  = pool->slots;
+   size_t old_cap                = pool->cap;
+
+   pool->slots = (struct string_pool_str**)calloc(cap, sizeof(*pool->slots));
+   if (!pool->slots)
+   {
+      pool->slots = old;
+      return false;
+   }
+   pool->cap   = cap;
+
+   for (i = 0; i < old_cap; i++)
+   {
+      size_t mask = cap - 1;
+      size_t j;
+
+      if (!old[i])
+         continue;
+
+      for (j = old[i]->hash & mask; pool->slots[j]; j = (j + 1) & mask);
+      pool->slots[j] = old[i];
+   }
+
+   free(old);
+   return true;
+}
+
+string_pool_t *string_pool_new(void)
+{
+   return (string_pool_t*)calloc(1, sizeof(string_pool_t));
+}
+
+void string_pool_clear(string_pool_t *pool)
+{
+   size_t i;
+
+   if (!pool)
+      return;
+
+   for (i = 0; i < pool->cap; i++)
+   {
+      free(pool->slots[i]);
+      pool->slots[i] = NULL;
+   }
+
+   pool->count = 0;
+}
+
+void string_pool_free(string_pool_t *pool)
+{
+   if (!pool)
+      return;
+
+   string_pool_clear(pool);
+   free(pool->slots);
+   free(pool);
+}
+
+const char *string_pool_intern(string_pool_t *pool, const char *str)
+{
+   if (!str)
+      return NULL;
+   return string_pool_intern_len(pool, str, strlen(str));
+}
+
+const char *string_pool_intern_len(string_pool_t *pool,
+      const char *str, size_t len)
+{
+   size_t i;
+   uint32_t hash;
+   struct string_pool_str *entry;
+
+   if (!pool || !str)
+      return NULL;
+
+   /* Keep the load factor under 3/4 */
+   if ((pool->count + 1) * 4 > pool->cap * 3 && !string_pool_grow(pool))
+      return NULL;
+
+   hash = string_pool_hash(str, len);
+   i    = string_pool_slot(pool, str, len, hash);
+
+   if (pool->slots[i])
+   {
+      pool->slots[i]->refs++;
+      return pool->slots[i]->str;
+   }
+
+   entry = (struct string_pool_str*)malloc(
+         offsetof(struct string_pool_str, str) + len + 1);
+   if (!entry)
+      return NULL;
+
+   entry->hash    = hash;
+   entry->refs    = 1;
+   memcpy(entry->str, str, len);
+   entry->str[len] = '\0';
+
+   pool->slots[i] = entry;
+   pool->count++;
+
+   return entry->str;
+}
+
+const char *string_pool_find(const string_pool_t *pool, const char *str)
+{
+   size_t i, len;
+
+   if (!pool || !str || !pool->count)
+      return NULL;
+
+   len = strlen(str);
+   i   = string_pool_slot(pool, str, len, string_pool_hash(str, len));
+
+   return pool->slots[i] ? pool->slots[i]->str : NULL;
+}
+
+void string_pool_release(string_pool_t *pool, const char *str)
+{
+   size_t i, j, mask;
+   struct string_pool_str *entry;
+
+   if (!pool || !str || !pool->cap)
+      return;
+
+   entry = STRING_POOL_HDR(str);
+   if (--entry->refs)
+      return;
+
+   mask = pool->cap - 1;
+   for (i = entry->hash & mask; pool->slots[i] != entry; i = (i + 1) & mask);
+
+   free(entry);
+   pool->slots[i] = NULL;
+   pool->count--;
+
+   /* Move back the entries that probed past the freed slot */
+   for (j = (i + 1) & mask; pool->slots[j]; j = (j + 1) & mask)
+   {
+      size_t home = pool->slots[j]->hash & mask;
+
+      if (((j - home) & mask) >= ((j - i) & mask))
+      {
+         pool->slots[i] = pool->slots[j];
+         pool->slots[j] = NULL;
+         i              = j;
+      }
+   }
+}
+
+size_t string_pool_count(const string_pool_t *pool)
+{
+   return pool ? pool->count : 0;
+}
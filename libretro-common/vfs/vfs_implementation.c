@@ -98,6 +98,13 @@
 
 #define RFILE_HINT_UNBUFFERED (1 << 8)
 
+/* Positional reads, and so a worker thread reading while the
+ * core goes on with the same file */
+#if defined(VFS_FRONTEND) && defined(HAVE_THREADS) && (defined(__unix__) || defined(__APPLE__)) && !defined(__CELLOS_LV2__)
+#define VFS_ASYNC_THREADED
+#include <rthreads/rthreads.h>
+#endif
+
 #ifdef VFS_FRONTEND
 struct retro_vfs_file_handle
 #else
@@ -171,10 +178,7 @@ int64_t retro_vfs_file_seek_internal(libretro_vfs_implementation_file *stream, i
    }
 #endif
 
-   if (lseek(stream->fd, offset, whence) < 0)
-      goto error;
-
-   return 0;
+   return lseek(stream->fd, offset, whence);
 
 error:
    return -1;
@@ -429,10 +433,7 @@ int64_t retro_vfs_file_tell_impl(libretro_vfs_implementation_file *stream)
    if (stream->mapped && stream->hints & RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS)
       return stream->mappos;
 #endif
-   if (lseek(stream->fd, 0, SEEK_CUR) < 0)
-      return -1;
-
-   return 0;
+   return lseek(stream->fd, 0, SEEK_CUR);
 }
 
 int64_t retro_vfs_file_seek_impl(libretro_vfs_implementation_file *stream, int64_t offset, int seek_position)
@@ -619,3 +620,235 @@ const char *retro_vfs_file_get_path_impl(libretro_vfs_implementation_file *strea
       abort();
    return stream->orig_path;
 }
+
+#ifdef VFS_FRONTEND
+struct retro_vfs_async_request
+#else
+struct libretro_vfs_implementation_async
+#endif
+{
+   libretro_vfs_implementation_file *stream;
+   libretro_vfs_implementation_async *next;
+   void *s;
+   uint64_t len;
+   uint64_t offset;
+   int64_t result;
+   bool done;
+};
+
+#ifdef VFS_ASYNC_THREADED
+static slock_t *vfs_async_lock        = NULL;
+static scond_t *vfs_async_cond        = NULL;
+static scond_t *vfs_async_done_cond   = NULL;
+static sthread_t *vfs_async_thread    = NULL;
+static libretro_vfs_implementation_async *vfs_async_head = NULL;
+static libretro_vfs_implementation_async *vfs_async_tail = NULL;
+static bool vfs_async_quit            = false;
+
+/* Leaves the file position alone, unlike seeking around
+ * a read, so it can race with the core's own reads. */
+static int64_t retro_vfs_file_pread_internal(
+      libretro_vfs_implementation_file *stream,
+      void *s, uint64_t len, uint64_t offset)
+{
+   uint64_t done = 0;
+   int fd        = stream->fd;
+
+#ifdef HAVE_MMAP
+   if (     (stream->hints & RFILE_HINT_UNBUFFERED)
+         && (stream->hints & RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS))
+   {
+      if (offset > stream->mapsize)
+         return -1;
+      if (offset + len > stream->mapsize)
+         len = stream->mapsize - offset;
+      memcpy(s, &stream->mapped[offset], len);
+      return len;
+   }
+#endif
+
+   if ((stream->hints & RFILE_HINT_UNBUFFERED) == 0)
+      fd = fileno(stream->fp);
+
+   while (done < len)
+   {
+      ssize_t ret = pread(fd, (uint8_t*)s + done,
+            (size_t)(len - done), (off_t)(offset + done));
+
+      if (ret < 0 && errno == EINTR)
+         continue;
+      if (ret < 0)
+         return -1;
+      if (ret == 0)
+         break;
+
+      done += ret;
+   }
+
+   return done;
+}
+
+static void retro_vfs_async_worker(void *data)
+{
+   slock_lock(vfs_async_lock);
+
+   for (;;)
+   {
+      int64_t result;
+      libretro_vfs_implementation_async *request;
+
+      while (!vfs_async_head && !vfs_async_quit)
+         scond_wait(vfs_async_cond, vfs_async_lock);
+
+      /* Whatever is queued still gets done before quitting. */
+      if (!(request = vfs_async_head))
+         break;
+
+      if (!(vfs_async_head = request->next))
+         vfs_async_tail = NULL;
+      slock_unlock(vfs_async_lock);
+
+      result = retro_vfs_file_pread_internal(request->stream,
+            request->s, request->len, request->offset);
+
+      slock_lock(vfs_async_lock);
+      request->result = result;
+      request->done   = true;
+      scond_broadcast(vfs_async_done_cond);
+   }
+
+   slock_unlock(vfs_async_lock);
+}
+#endif
+
+void retro_vfs_async_init_impl(void)
+{
+#ifdef VFS_ASYNC_THREADED
+   if (vfs_async_lock)
+      return;
+
+   vfs_async_lock      = slock_new();
+   vfs_async_cond      = scond_new();
+   vfs_async_done_cond = scond_new();
+   vfs_async_quit      = false;
+
+   if (!vfs_async_lock || !vfs_async_cond || !vfs_async_done_cond)
+      retro_vfs_async_deinit_impl();
+#endif
+}
+
+void retro_vfs_async_deinit_impl(void)
+{
+#ifdef VFS_ASYNC_THREADED
+   if (vfs_async_thread)
+   {
+      slock_lock(vfs_async_lock);
+      vfs_async_quit = true;
+      scond_signal(vfs_async_cond);
+      slock_unlock(vfs_async_lock);
+
+      sthread_join(vfs_async_thread);
+      vfs_async_thread = NULL;
+   }
+
+   if (vfs_async_done_cond)
+      scond_free(vfs_async_done_cond);
+   if (vfs_async_cond)
+      scond_free(vfs_async_cond);
+   if (vfs_async_lock)
+      slock_free(vfs_async_lock);
+
+   vfs_async_done_cond = NULL;
+   vfs_async_cond      = NULL;
+   vfs_async_lock      = NULL;
+#endif
+}
+
+libretro_vfs_implementation_async *retro_vfs_file_read_async_impl(
+      libretro_vfs_implementation_file *stream,
+      void *s, uint64_t len, uint64_t offset)
+{
+   int64_t pos;
+   libretro_vfs_implementation_async *request = NULL;
+
+   if (!stream || !s)
+      return NULL;
+
+   request = (libretro_vfs_implementation_async*)
+      calloc(1, sizeof(*request));
+
+   if (!request)
+      return NULL;
+
+   request->stream = stream;
+   request->s      = s;
+   request->len    = len;
+   request->offset = offset;
+
+#ifdef VFS_ASYNC_THREADED
+   if (vfs_async_lock)
+   {
+      slock_lock(vfs_async_lock);
+
+      if (!vfs_async_thread)
+         vfs_async_thread = sthread_create(retro_vfs_async_worker, NULL);
+
+      if (vfs_async_thread)
+      {
+         if (vfs_async_tail)
+            vfs_async_tail->next = request;
+         else
+            vfs_async_head       = request;
+         vfs_async_tail          = request;
+         scond_signal(vfs_async_cond);
+         slock_unlock(vfs_async_lock);
+         return request;
+      }
+
+      slock_unlock(vfs_async_lock);
+   }
+#endif
+
+   /* No thread to hand it to, read it right away. */
+   request->result = -1;
+   request->done   = true;
+
+   if ((pos = retro_vfs_file_tell_impl(stream)) < 0)
+      return request;
+
+   if (retro_vfs_file_seek_impl(stream, (int64_t)offset,
+            RETRO_VFS_SEEK_POSITION_START) >= 0)
+      request->result = retro_vfs_file_read_impl(stream, s, len);
+
+   retro_vfs_file_seek_impl(stream, pos, RETRO_VFS_SEEK_POSITION_START);
+
+   return request;
+}
+
+int64_t retro_vfs_async_poll_impl(
+      libretro_vfs_implementation_async *request, bool wait)
+{
+   int64_t result = RETRO_VFS_ASYNC_PENDING;
+
+   if (!request)
+      return -1;
+
+#ifdef VFS_ASYNC_THREADED
+   if (vfs_async_lock)
+   {
+      slock_lock(vfs_async_lock);
+      while (wait && !request->done)
+         scond_wait(vfs_async_done_cond, vfs_async_lock);
+      if (request->done)
+         result = request->result;
+      slock_unlock(vfs_async_lock);
+   }
+   else
+#endif
+   result = request->result;
+
+   if (result != RETRO_VFS_ASYNC_PENDING)
+      free(request);
+
+   return result;
+}
@@ -33,6 +33,8 @@
 #include <retro_assert.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
+#include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
 
 #include "libretrodb.h"
 
@@ -574,6 +576,66 @@ static dat_converter_list_t* dat_converter_parser(
    return target;
 }
 
+/* DAT files are lexed and parsed by a pool of workers, each into its
+ * own list; the lists are merged afterwards in command line order. */
+typedef struct
+{
+   char* buffer;
+   const char* path;
+   dat_converter_list_t* parsed;
+} dat_converter_job_t;
+
+typedef struct
+{
+   dat_converter_job_t* jobs;
+   dat_converter_match_key_t* match_key;
+   slock_t* lock;
+   int count;
+   int next;
+} dat_converter_queue_t;
+
+static void dat_converter_worker(void* data)
+{
+   dat_converter_queue_t* queue = (dat_converter_queue_t*)data;
+
+   for (;;)
+   {
+      dat_converter_list_t* dat_lexer_list = NULL;
+      dat_converter_job_t* job             = NULL;
+
+      slock_lock(queue->lock);
+      if (queue->next < queue->count)
+         job = &queue->jobs[queue->next++];
+      slock_unlock(queue->lock);
+
+      if (!job)
+         return;
+
+      dat_lexer_list = dat_converter_lexer(job->buffer, job->path);
+      job->parsed    = dat_converter_parser(
+            NULL, dat_lexer_list, queue->match_key);
+
+      dat_converter_list_free(dat_lexer_list);
+   }
+}
+
+/* Entries that share a match key are merged the same way whether
+ * they come from one file or several, so merging the per-file lists
+ * in order gives the same result as parsing the files serially. */
+static void dat_converter_merge(dat_converter_list_t* target,
+      dat_converter_list_t* source)
+{
+   int i;
+
+   /* Entry 0 is the end marker every parsed list starts with. */
+   for (i = 1; i < source->count; i++)
+      dat_converter_list_append(target, &source->values[i].map);
+
+   /* The entries belong to target now. */
+   source->count = 0;
+   dat_converter_list_free(source);
+}
+
 typedef enum
 {
    DAT_CONVERTER_RDB_TYPE_STRING,
@@ -776,11 +838,18 @@ int main(int argc, char** argv)
       malloc(dat_count * sizeof(*dat_buffers));
    char** dat_buffer                     = dat_buffers;
    dat_converter_list_t* dat_parser_list = NULL;
+   dat_converter_queue_t queue           = {0};
+   sthread_t* workers[16];
+   unsigned worker_count;
+   unsigned i;
+
+   queue.jobs      = (dat_converter_job_t*)calloc(dat_count,
+         sizeof(*queue.jobs));
+   queue.match_key = match_key;
 
    while (argc)
    {
       size_t dat_file_size;
-      dat_converter_list_t* dat_lexer_list = NULL;
       FILE* dat_file                       = fopen(*argv, "r");
 
       if (!dat_file)
@@ -799,17 +868,49 @@ int main(int argc, char** argv)
       (*dat_buffer)[dat_file_size] = '\0';
 
       printf("Parsing dat file '%s'...\n", *argv);
-      dat_lexer_list  = dat_converter_lexer(*dat_buffer, *argv);
-      dat_parser_list = dat_converter_parser(
-            dat_parser_list, dat_lexer_list, match_key);
-
-      dat_converter_list_free(dat_lexer_list);
+      queue.jobs[queue.count].buffer = *dat_buffer;
+      queue.jobs[queue.count].path   = *argv;
+      queue.count++;
 
       argc--;
       argv++;
       dat_buffer++;
    }
 
+   worker_count = cpu_features_get_core_amount();
+   if (worker_count > (unsigned)dat_count)
+      worker_count = (unsigned)dat_count;
+   if (worker_count > sizeof(workers) / sizeof(*workers))
+      worker_count = sizeof(workers) / sizeof(*workers);
+
+   queue.lock = worker_count > 1 ? slock_new() : NULL;
+
+   if (!queue.lock)
+      dat_converter_worker(&queue);
+   else
+   {
+      for (i = 0; i < worker_count; i++)
+         workers[i] = sthread_create(dat_converter_worker, &queue);
+
+      /* A worker that failed to start leaves its share to the others;
+       * if none started, the main thread parses everything. */
+      for (i = 0; i < worker_count; i++)
+         if (workers[i])
+            sthread_join(workers[i]);
+      dat_converter_worker(&queue);
+
+      slock_free(queue.lock);
+   }
+
+   for (i = 0; i < (unsigned)queue.count; i++)
+   {
+      if (!dat_parser_list)
+         dat_parser_list = queue.jobs[i].parsed;
+      else
+         dat_converter_merge(dat_parser_list, queue.jobs[i].parsed);
+   }
+   free(queue.jobs);
+
    rdb_file = filestream_open(rdb_path,
          RETRO_VFS_FILE_ACCESS_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -31,27 +31,22 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <stdlib.h>
+#include <fcntl.h>
 
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
 #include <compat/strl.h>
+#include <memmap.h>
 
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 #include "rmsgpack.h"
-#include "bintree.h"
 #include "query.h"
 #include "libretrodb.h"
 
 #define MAGIC_NUMBER "RARCHDB"
 
-struct node_iter_ctx
-{
-	libretrodb_t *db;
-	libretrodb_index_t *idx;
-};
-
 struct libretrodb
 {
 	RFILE *fd;
@@ -59,6 +54,10 @@ struct libretrodb
 	uint64_t count;
 	uint64_t first_index_offset;
    char *path;
+   /* Whole file, when it could be mapped; cursors then
+    * decode records in place instead of going through fd. */
+   const uint8_t *map;
+   size_t map_size;
 };
 
 struct libretrodb_index
@@ -66,6 +65,10 @@ struct libretrodb_index
 	char name[50];
 	uint64_t key_size;
 	uint64_t next;
+   /* Empty for indexes written before cursors could use them;
+    * those store host-endian offsets. */
+   char field[50];
+   uint64_t key_type;
 };
 
 typedef struct libretrodb_metadata
@@ -86,6 +89,23 @@ struct libretrodb_cursor
 	int eof;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   size_t offset;
+   struct rmsgpack_dom_scratch scratch;
+   /* Without a mapping, records are decoded from this copy
+    * of the file starting at window_start. */
+   uint8_t *window;
+   size_t window_size;
+   size_t window_len;
+   size_t window_start;
+   int window_eof;
+   /* Set when an index narrowed the query down to these
+    * records, kept in file order. */
+   int indexed;
+   uint64_t *offsets;
+   size_t offsets_count;
+   size_t offsets_pos;
+   libretrodb_filter_t filter;
+   void *filter_data;
 };
 
 static struct rmsgpack_dom_value sentinal;
@@ -184,24 +204,120 @@ clean:
    return rv;
 }
 
+static const struct rmsgpack_dom_value *libretrodb_map_get(
+      const struct rmsgpack_dom_value *map, const char *name)
+{
+   struct rmsgpack_dom_value key;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(name);
+   key.val.string.buff = (char*)name;
+
+   return rmsgpack_dom_value_map_value(map, &key);
+}
+
+/* Small uints are written as positive fixints, which read back as ints. */
+static int libretrodb_map_get_uint(const struct rmsgpack_dom_value *map,
+      const char *name, uint64_t *out)
+{
+   const struct rmsgpack_dom_value *v = libretrodb_map_get(map, name);
+
+   if (!v)
+      return 0;
+
+   if (v->type == RDT_UINT)
+      *out = v->val.uint_;
+   else if (v->type == RDT_INT && v->val.int_ >= 0)
+      *out = (uint64_t)v->val.int_;
+   else
+      return 0;
+
+   return 1;
+}
+
 static int libretrodb_read_index_header(RFILE *fd, libretrodb_index_t *idx)
 {
-   uint64_t name_len = 50;
-   return rmsgpack_dom_read_into(fd,
-         "name", idx->name, &name_len,
-         "key_size", &idx->key_size,
-         "next", &idx->next, NULL);
+   struct rmsgpack_dom_value map;
+   const struct rmsgpack_dom_value *v = NULL;
+   int rv                             = rmsgpack_dom_read(fd, &map);
+
+   if (rv < 0)
+      return rv;
+
+   memset(idx, 0, sizeof(*idx));
+   rv = -EINVAL;
+
+   if (map.type != RDT_MAP)
+      goto end;
+
+   if (!(v = libretrodb_map_get(&map, "name")) || v->type != RDT_STRING)
+      goto end;
+   strlcpy(idx->name, v->val.string.buff, sizeof(idx->name));
+
+   if (     !libretrodb_map_get_uint(&map, "key_size", &idx->key_size)
+         || !libretrodb_map_get_uint(&map, "next", &idx->next))
+      goto end;
+
+   if ((v = libretrodb_map_get(&map, "field")) && v->type == RDT_STRING)
+      strlcpy(idx->field, v->val.string.buff, sizeof(idx->field));
+   libretrodb_map_get_uint(&map, "key_type", &idx->key_type);
+
+   rv = 0;
+
+end:
+   rmsgpack_dom_value_free(&map);
+   return rv;
 }
 
 static void libretrodb_write_index_header(RFILE *fd, libretrodb_index_t *idx)
 {
-   rmsgpack_write_map_header(fd, 3);
+   rmsgpack_write_map_header(fd, 5);
    rmsgpack_write_string(fd, "name", strlen("name"));
    rmsgpack_write_string(fd, idx->name, (uint32_t)strlen(idx->name));
    rmsgpack_write_string(fd, "key_size", (uint32_t)strlen("key_size"));
    rmsgpack_write_uint(fd, idx->key_size);
    rmsgpack_write_string(fd, "next", strlen("next"));
    rmsgpack_write_uint(fd, idx->next);
+   rmsgpack_write_string(fd, "field", strlen("field"));
+   rmsgpack_write_string(fd, idx->field, (uint32_t)strlen(idx->field));
+   rmsgpack_write_string(fd, "key_type", strlen("key_type"));
+   rmsgpack_write_uint(fd, idx->key_type);
+}
+
+static void libretrodb_map(libretrodb_t *db, const char *path)
+{
+#ifdef HAVE_MMAN
+   void *map;
+   struct stat st;
+   int fd = open(path, O_RDONLY);
+
+   if (fd < 0)
+      return;
+
+   if (fstat(fd, &st) == 0 && st.st_size > 0)
+   {
+      map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (map != MAP_FAILED)
+      {
+         db->map      = (const uint8_t*)map;
+         db->map_size = (size_t)st.st_size;
+      }
+   }
+
+   /* The mapping outlives the descriptor. */
+   close(fd);
+#endif
+}
+
+static void libretrodb_unmap(libretrodb_t *db)
+{
+#ifdef HAVE_MMAN
+   if (db->map)
+      munmap((void*)db->map, db->map_size);
+#endif
+   db->map      = NULL;
+   db->map_size = 0;
 }
 
 void libretrodb_close(libretrodb_t *db)
@@ -210,6 +326,7 @@ void libretrodb_close(libretrodb_t *db)
       filestream_close(db->fd);
    if (!string_is_empty(db->path))
       free(db->path);
+   libretrodb_unmap(db);
    db->path = NULL;
    db->fd   = NULL;
 }
@@ -238,7 +355,8 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
-   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+   if (memcmp(header.magic_number, MAGIC_NUMBER,
+            sizeof(header.magic_number)) != 0)
    {
       rv = -EINVAL;
       goto error;
@@ -257,6 +375,11 @@ int libretrodb_open(const char *path, libretrodb_t *db)
    db->count              = md.count;
    db->first_index_offset = filestream_tell(fd);
    db->fd                 = fd;
+
+   /* Falls back to reading through fd if this fails. */
+   libretrodb_unmap(db);
+   libretrodb_map(db, path);
+
    return 0;
 
 error:
@@ -289,69 +412,287 @@ static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
    return -1;
 }
 
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+/* Index entries are key_size bytes of key followed by the
+ * record offset, sorted by key. Keys compare with memcmp:
+ * strings and binaries are cut or zero-padded to key_size,
+ * numbers are big-endian, with the sign bit flipped for ints. */
+static int libretrodb_index_key(const libretrodb_index_t *idx,
+      const struct rmsgpack_dom_value *v, uint8_t *key)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint64_t *current  = (uint64_t *)buff + (mid * item_size);
-   int rv             = memcmp(current, item, field_size);
+   unsigned i;
+   uint64_t n = 0;
 
-   if (rv == 0)
+   switch (idx->key_type)
    {
-      *offset = *(uint64_t *)(current + field_size);
-      return 0;
+      case RDT_STRING:
+      case RDT_BINARY:
+         if (v->type != (enum rmsgpack_dom_type)idx->key_type)
+            return 0;
+         n = (v->val.string.len < idx->key_size)
+            ? v->val.string.len : idx->key_size;
+         memcpy(key, v->val.string.buff, (size_t)n);
+         memset(key + n, 0, (size_t)(idx->key_size - n));
+         return 1;
+      case RDT_UINT:
+         /* Same conversion as func_equals() in query.c */
+         if (v->type == RDT_UINT)
+            n = v->val.uint_;
+         else if (v->type == RDT_INT)
+            n = (uint64_t)v->val.int_;
+         else
+            return 0;
+         break;
+      case RDT_INT:
+         if (v->type != RDT_INT)
+            return 0;
+         n = (uint64_t)v->val.int_ ^ (UINT64_C(1) << 63);
+         break;
+      default:
+         return 0;
    }
 
-   if (count == 0)
-      return -1;
+   for (i = 0; i < 8; i++)
+      key[i] = (uint8_t)(n >> (56 - i * 8));
+
+   return 1;
+}
+
+static uint64_t libretrodb_index_offset(const libretrodb_index_t *idx,
+      const uint8_t *entry)
+{
+   uint64_t offset;
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+   memcpy(&offset, entry + idx->key_size, sizeof(offset));
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+   if (!idx->field[0])
+      return offset;
+   return swap_if_little64(offset);
+}
+
+/* First entry whose key is >= key, or > key if 'upper' is set. */
+static uint64_t libretrodb_index_bound(const libretrodb_index_t *idx,
+      const uint8_t *entries, uint64_t count, const uint8_t *key, int upper)
+{
+   uint64_t lo     = 0;
+   uint64_t hi     = count;
+   size_t stride   = (size_t)idx->key_size + sizeof(uint64_t);
+
+   while (lo < hi)
+   {
+      uint64_t mid = lo + (hi - lo) / 2;
+      int cmp      = memcmp(entries + mid * stride, key,
+            (size_t)idx->key_size);
+
+      if (cmp < 0 || (upper && cmp == 0))
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return lo;
+}
+
+/* Loads the entries following the index header just read
+ * from db->fd; *owned is set if they had to be copied. */
+static const uint8_t *libretrodb_index_load(libretrodb_t *db,
+      const libretrodb_index_t *idx, uint8_t **owned)
+{
+   uint64_t pos = (uint64_t)filestream_tell(db->fd);
+
+   *owned = NULL;
+
+   if (!idx->next)
+      return NULL;
+
+   if (db->map && pos + idx->next <= db->map_size)
+      return db->map + pos;
+
+   if (!(*owned = (uint8_t*)malloc((size_t)idx->next)))
+      return NULL;
+
+   if (filestream_read(db->fd, *owned, (ssize_t)idx->next)
+         != (ssize_t)idx->next)
+   {
+      free(*owned);
+      *owned = NULL;
+   }
+
+   return *owned;
 }
 
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
       const void *key, struct rmsgpack_dom_value *out)
 {
    libretrodb_index_t idx;
-   int rv;
-   void *buff;
-   uint64_t offset;
-   ssize_t bufflen, nread = 0;
+   uint64_t i, count;
+   size_t stride;
+   const uint8_t *entries = NULL;
+   uint8_t *owned         = NULL;
+   int rv                 = -1;
 
    if (libretrodb_find_index(db, index_name, &idx) < 0)
       return -1;
 
-   bufflen = idx.next;
-   buff = malloc(bufflen);
+   if (!(entries = libretrodb_index_load(db, &idx, &owned)))
+      return -1;
 
-   if (!buff)
-      return -ENOMEM;
+   stride = (size_t)idx.key_size + sizeof(uint64_t);
+   count  = idx.next / stride;
+   i      = libretrodb_index_bound(&idx, entries, count,
+         (const uint8_t*)key, 0);
 
-   while (nread < bufflen)
+   if (i < count && memcmp(entries + i * stride, key,
+            (size_t)idx.key_size) == 0)
    {
-      void *buff_ = (uint64_t *)buff + nread;
-      rv = (int)filestream_read(db->fd, buff_, bufflen - nread);
+      filestream_seek(db->fd,
+            (ssize_t)libretrodb_index_offset(&idx, entries + i * stride),
+            RETRO_VFS_SEEK_POSITION_START);
+      rv = rmsgpack_dom_read(db->fd, out);
+   }
 
-      if (rv <= 0)
-      {
-         free(buff);
-         return -errno;
-      }
-      nread += rv;
+   free(owned);
+   return rv;
+}
+
+static int libretrodb_cmp_offset(const void *a, const void *b)
+{
+   uint64_t oa = *(const uint64_t*)a;
+   uint64_t ob = *(const uint64_t*)b;
+   return (oa > ob) - (oa < ob);
+}
+
+/* Turns the query's constraint on the indexed field into a key
+ * range. Returns -1 if the index can't be used for it, 0 if
+ * nothing can match, 1 otherwise. */
+static int libretrodb_index_range(const libretrodb_index_t *idx,
+      const struct rmsgpack_dom_value *min,
+      const struct rmsgpack_dom_value *max,
+      uint8_t *lo, uint8_t *hi)
+{
+   struct rmsgpack_dom_value a, b;
+
+   if (min == max)
+      return (libretrodb_index_key(idx, min, lo)
+            && libretrodb_index_key(idx, min, hi)) ? 1 : -1;
+
+   /* between() bounds are always ints, see query_func_between() */
+   a = *min;
+   b = *max;
+
+   if (idx->key_type == RDT_UINT)
+   {
+      if (b.val.int_ < 0)
+         return 0;
+      if (a.val.int_ < 0)
+         a.val.int_ = 0;
+   }
+   else if (idx->key_type != RDT_INT)
+      return -1;
+
+   if (a.val.int_ > b.val.int_)
+      return 0;
+
+   return (libretrodb_index_key(idx, &a, lo)
+         && libretrodb_index_key(idx, &b, hi)) ? 1 : -1;
+}
+
+static int libretrodb_cursor_index_lookup(libretrodb_cursor_t *cursor,
+      const libretrodb_index_t *idx,
+      const struct rmsgpack_dom_value *min,
+      const struct rmsgpack_dom_value *max)
+{
+   uint64_t i, first, last;
+   size_t stride          = (size_t)idx->key_size + sizeof(uint64_t);
+   uint64_t count         = idx->next / stride;
+   uint8_t *owned         = NULL;
+   const uint8_t *entries = NULL;
+   uint8_t *lo            = (uint8_t*)malloc((size_t)idx->key_size);
+   uint8_t *hi            = (uint8_t*)malloc((size_t)idx->key_size);
+   int rv                 = 0;
+
+   if (!lo || !hi)
+      goto end;
+
+   switch (libretrodb_index_range(idx, min, max, lo, hi))
+   {
+      case 0:
+         cursor->indexed       = 1;
+         cursor->offsets_count = 0;
+         rv                    = 1;
+         goto end;
+      case 1:
+         break;
+      default:
+         goto end;
    }
 
-   rv = binsearch(buff, key, db->count, (ssize_t)idx.key_size, &offset);
-   free(buff);
+   if (!(entries = libretrodb_index_load(cursor->db, idx, &owned)))
+      goto end;
+
+   first = libretrodb_index_bound(idx, entries, count, lo, 0);
+   last  = libretrodb_index_bound(idx, entries, count, hi, 1);
+
+   cursor->offsets_count = 0;
+
+   if (last > first)
+   {
+      if (!(cursor->offsets = (uint64_t*)malloc(
+                  (size_t)(last - first) * sizeof(uint64_t))))
+         goto end;
+
+      for (i = first; i < last; i++)
+         cursor->offsets[cursor->offsets_count++] =
+            libretrodb_index_offset(idx, entries + i * stride);
 
-   if (rv == 0)
-      filestream_seek(db->fd, (ssize_t)offset,
+      qsort(cursor->offsets, cursor->offsets_count,
+            sizeof(uint64_t), libretrodb_cmp_offset);
+   }
+
+   cursor->indexed = 1;
+   rv              = 1;
+
+end:
+   free(owned);
+   free(lo);
+   free(hi);
+   return rv;
+}
+
+/* Narrows the cursor down to the records an index says can
+ * match, when the query pins the indexed field to a value or
+ * a between() range. Returns 1 if an index was used. */
+static int libretrodb_cursor_use_index(libretrodb_cursor_t *cursor)
+{
+   libretrodb_index_t idx;
+   libretrodb_t *db = cursor->db;
+   ssize_t eof      = filestream_get_size(db->fd);
+   ssize_t offset   = 0;
+
+   filestream_seek(db->fd, (ssize_t)db->first_index_offset,
+         RETRO_VFS_SEEK_POSITION_START);
+
+   while ((offset = filestream_tell(db->fd)) >= 0 && offset < eof)
+   {
+      const struct rmsgpack_dom_value *min = NULL;
+      const struct rmsgpack_dom_value *max = NULL;
+
+      if (libretrodb_read_index_header(db->fd, &idx) < 0)
+         break;
+
+      offset = filestream_tell(db->fd);
+
+      if (     idx.field[0]
+            && idx.key_size
+            && libretrodb_query_field_range(cursor->query,
+               idx.field, &min, &max)
+            && libretrodb_cursor_index_lookup(cursor, &idx, min, max))
+         return 1;
+
+      filestream_seek(db->fd, offset + (ssize_t)idx.next,
             RETRO_VFS_SEEK_POSITION_START);
+   }
 
-   return rmsgpack_dom_read(db->fd, out);
+   return 0;
 }
 
 /**
@@ -364,13 +705,92 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
-   return (int)filestream_seek(cursor->fd,
-         (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
-         RETRO_VFS_SEEK_POSITION_START);
+   cursor->eof         = 0;
+   cursor->offset      = (size_t)(cursor->db->root + sizeof(libretrodb_header_t));
+   cursor->offsets_pos = 0;
+   return 0;
 }
 
-int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+/* Reads the file into the window starting at the cursor
+ * offset, doubling the window first if @grow is set. */
+static int libretrodb_cursor_fill(libretrodb_cursor_t *cursor, int grow)
+{
+   int64_t len;
+
+   if (!cursor->window || grow)
+   {
+      size_t size    = cursor->window_size ? cursor->window_size * 2 : 65536;
+      uint8_t *data  = (uint8_t*)realloc(cursor->window, size);
+
+      if (!data)
+         return -ENOMEM;
+
+      cursor->window      = data;
+      cursor->window_size = size;
+   }
+
+   cursor->window_start = cursor->offset;
+   cursor->window_len   = 0;
+   cursor->window_eof   = 1;
+
+   if (filestream_seek(cursor->fd, (ssize_t)cursor->offset,
+            RETRO_VFS_SEEK_POSITION_START) < 0)
+      return -EIO;
+
+   if ((len = filestream_read(cursor->fd, cursor->window,
+               cursor->window_size)) < 0)
+      return -EIO;
+
+   cursor->window_len = (size_t)len;
+   cursor->window_eof = cursor->window_len < cursor->window_size;
+   return 0;
+}
+
+/* Decodes the record at the cursor offset into the scratch
+ * space and moves past it. */
+static int libretrodb_cursor_decode(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   if (!cursor->fd)
+      return rmsgpack_dom_read_buf(cursor->db->map,
+            cursor->db->map_size, &cursor->offset,
+            out, &cursor->scratch);
+
+   for (;;)
+   {
+      int rv;
+      int grow = 0;
+
+      if (     cursor->window
+            && cursor->offset >= cursor->window_start
+            && cursor->offset - cursor->window_start <= cursor->window_len)
+      {
+         size_t pos = cursor->offset - cursor->window_start;
+
+         rv = rmsgpack_dom_read_buf(cursor->window, cursor->window_len,
+               &pos, out, &cursor->scratch);
+
+         if (rv == 0)
+         {
+            cursor->offset = cursor->window_start + pos;
+            return 0;
+         }
+
+         /* Short reads are only an error at the end of the
+          * file, otherwise the record ran past the window. */
+         if (rv != -EINVAL || cursor->window_eof)
+            return rv;
+
+         grow = cursor->offset == cursor->window_start;
+      }
+
+      if ((rv = libretrodb_cursor_fill(cursor, grow)) < 0)
+         return rv;
+   }
+}
+
+/* Decodes the next record the query and filter accept. */
+static int libretrodb_cursor_next(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out)
 {
    int rv;
@@ -378,29 +798,63 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
    if (cursor->eof)
       return EOF;
 
-retry:
-   rv = rmsgpack_dom_read(cursor->fd, out);
-   if (rv < 0)
-      return rv;
-
-   if (out->type == RDT_NULL)
+   /* Records that are rejected are never copied. */
+   do
    {
-      cursor->eof = 1;
-      return EOF;
-   }
+      if (cursor->indexed)
+      {
+         if (cursor->offsets_pos >= cursor->offsets_count)
+         {
+            cursor->eof = 1;
+            return EOF;
+         }
+         cursor->offset = (size_t)cursor->offsets[cursor->offsets_pos++];
+      }
 
-   if (cursor->query)
-   {
-      if (!libretrodb_query_filter(cursor->query, out))
+      if ((rv = libretrodb_cursor_decode(cursor, out)) < 0)
+         return rv;
+
+      if (out->type == RDT_NULL)
       {
-         rmsgpack_dom_value_free(out);
-         goto retry;
+         cursor->eof = 1;
+         return EOF;
       }
-   }
+   } while ((cursor->query
+            && !libretrodb_query_filter(cursor->query, out))
+         || (cursor->filter
+            && !cursor->filter(out, cursor->filter_data)));
 
    return 0;
 }
 
+int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   int rv;
+   struct rmsgpack_dom_value view;
+
+   cursor->scratch.copy_strings = 0;
+
+   if ((rv = libretrodb_cursor_next(cursor, &view)) != 0)
+      return rv;
+
+   return rmsgpack_dom_value_copy(&view, out);
+}
+
+int libretrodb_cursor_read_item_view(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   cursor->scratch.copy_strings = 1;
+   return libretrodb_cursor_next(cursor, out);
+}
+
+void libretrodb_cursor_set_filter(libretrodb_cursor_t *cursor,
+      libretrodb_filter_t filter, void *userdata)
+{
+   cursor->filter      = filter;
+   cursor->filter_data = userdata;
+}
+
 /**
  * libretrodb_cursor_close:
  * @cursor              : Handle to database cursor.
@@ -418,7 +872,16 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
+   rmsgpack_dom_scratch_free(&cursor->scratch);
+   free(cursor->offsets);
+   free(cursor->window);
+
+   cursor->is_valid      = 0;
+   cursor->indexed       = 0;
+   cursor->offsets       = NULL;
+   cursor->offsets_count = 0;
+   cursor->window        = NULL;
+   cursor->window_size   = 0;
    cursor->eof      = 1;
    cursor->fd       = NULL;
    cursor->db       = NULL;
@@ -442,71 +905,94 @@ int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
    if (!db || string_is_empty(db->path))
       return -errno;
 
-   fd = filestream_open(db->path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!db->map)
+   {
+      fd = filestream_open(db->path,
+            RETRO_VFS_FILE_ACCESS_READ,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
-   if (!fd)
-      return -errno;
+      if (!fd)
+         return -errno;
+   }
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
+   memset(&cursor->scratch, 0, sizeof(cursor->scratch));
+
+   cursor->window        = NULL;
+   cursor->window_size   = 0;
+   cursor->window_len    = 0;
+   cursor->window_start  = 0;
+   cursor->window_eof    = 0;
+   cursor->fd            = fd;
+   cursor->db            = db;
+   cursor->is_valid      = 1;
+   cursor->indexed       = 0;
+   cursor->offsets       = NULL;
+   cursor->offsets_count = 0;
+   cursor->filter        = NULL;
+   cursor->filter_data   = NULL;
    libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->query         = q;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      libretrodb_cursor_use_index(cursor);
+   }
 
    return 0;
 }
 
-static int node_iter(void *value, void *ctx)
+static uint64_t libretrodb_cursor_tell(libretrodb_cursor_t *cursor)
 {
-   struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
-
-   if (filestream_write(nictx->db->fd, value,
-            (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
-      return 0;
-
-   return -1;
+   return cursor->offset;
 }
 
-static uint64_t libretrodb_tell(libretrodb_t *db)
+struct libretrodb_index_item
 {
-   return filestream_tell(db->fd);
-}
+   const uint8_t *entry;
+   size_t len;
+};
 
-static int node_compare(const void *a, const void *b, void *ctx)
+/* Entries end with the big-endian offset, so this sorts
+ * equal keys in file order. */
+static int libretrodb_index_item_cmp(const void *a, const void *b)
 {
-   return memcmp(a, b, *(uint8_t *)ctx);
+   const struct libretrodb_index_item *ia =
+      (const struct libretrodb_index_item*)a;
+   const struct libretrodb_index_item *ib =
+      (const struct libretrodb_index_item*)b;
+   return memcmp(ia->entry, ib->entry, ia->len);
 }
 
 int libretrodb_create_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
-   struct node_iter_ctx nictx;
-   struct rmsgpack_dom_value key;
+   return libretrodb_create_prefix_index(db, name, field_name, 0);
+}
+
+int libretrodb_create_prefix_index(libretrodb_t *db,
+      const char *name, const char *field_name, unsigned prefix_len)
+{
    libretrodb_index_t idx;
    struct rmsgpack_dom_value item;
-   libretrodb_cursor_t cur          = {0};
-   struct rmsgpack_dom_value *field = NULL;
-   void *buff                       = NULL;
-   uint64_t *buff_u64               = NULL;
-   uint8_t field_size               = 0;
-   uint64_t item_loc                = libretrodb_tell(db);
-   bintree_t *tree                  = bintree_new(node_compare, &field_size);
-
-   item.type                        = RDT_NULL;
-
-   if (!tree || (libretrodb_cursor_open(db, &cur, NULL) != 0))
+   size_t i, stride;
+   libretrodb_cursor_t cur                    = {0};
+   const struct rmsgpack_dom_value *field     = NULL;
+   struct libretrodb_index_item *items        = NULL;
+   uint8_t *entries                           = NULL;
+   RFILE *fd                                  = NULL;
+   size_t count                               = 0;
+   uint64_t max_len                           = 0;
+   int rv                                     = -1;
+
+   memset(&idx, 0, sizeof(idx));
+
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
       goto clean;
 
-   key.type            = RDT_STRING;
-   key.val.string.len  = (uint32_t)strlen(field_name);
-   key.val.string.buff = (char *) field_name;   /* We know we aren't going to change it */
-
-   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   /* First pass: the key type and size. Records without
+    * the field are left out of the index. */
+   while (libretrodb_cursor_read_item_view(&cur, &item) == 0)
    {
       if (item.type != RDT_MAP)
       {
@@ -514,79 +1000,114 @@ int libretrodb_create_index(libretrodb_t *db,
          goto clean;
       }
 
-      field = rmsgpack_dom_value_map_value(&item, &key);
-
-      if (!field)
+      if ((field = libretrodb_map_get(&item, field_name)))
       {
-         printf("field not found in item\n");
-         goto clean;
+         switch (field->type)
+         {
+            case RDT_STRING:
+            case RDT_BINARY:
+               if (field->val.string.len > max_len)
+                  max_len = field->val.string.len;
+               /* fall-through */
+            case RDT_UINT:
+            case RDT_INT:
+               if (!count)
+                  idx.key_type = field->type;
+               else if (idx.key_type != (uint64_t)field->type)
+               {
+                  printf("field has mixed types\n");
+                  goto clean;
+               }
+               count++;
+               break;
+            default:
+               printf("field type can't be indexed\n");
+               goto clean;
+         }
       }
+   }
 
-      if (field->type != RDT_BINARY)
-      {
-         printf("field is not binary\n");
-         goto clean;
-      }
+   if (!count)
+   {
+      printf("field not found in any item\n");
+      goto clean;
+   }
 
-      if (field->val.binary.len == 0)
-      {
-         printf("field is empty\n");
-         goto clean;
-      }
+   if (idx.key_type == RDT_UINT || idx.key_type == RDT_INT)
+      idx.key_size = sizeof(uint64_t);
+   else if (prefix_len && prefix_len < max_len)
+      idx.key_size = prefix_len;
+   else
+      idx.key_size = max_len;
 
-      if (field_size == 0)
-         field_size = field->val.binary.len;
-      else if (field->val.binary.len != field_size)
-      {
-         printf("field is not of correct size\n");
-         goto clean;
-      }
+   if (idx.key_size == 0)
+   {
+      printf("field is empty\n");
+      goto clean;
+   }
 
-      buff = malloc(field_size + sizeof(uint64_t));
-      if (!buff)
-         goto clean;
+   strlcpy(idx.name,  name,       sizeof(idx.name));
+   strlcpy(idx.field, field_name, sizeof(idx.field));
 
-      memcpy(buff, field->val.binary.buff, field_size);
+   stride  = (size_t)idx.key_size + sizeof(uint64_t);
+   entries = (uint8_t*)malloc(count * stride);
+   items   = (struct libretrodb_index_item*)malloc(count * sizeof(*items));
 
-      buff_u64 = (uint64_t *)buff + field_size;
+   if (!entries || !items)
+      goto clean;
 
-      memcpy(buff_u64, &item_loc, sizeof(uint64_t));
+   libretrodb_cursor_reset(&cur);
 
-      if (bintree_insert(tree, buff) != 0)
+   /* Second pass: the entries themselves. */
+   for (i = 0; i < count; )
+   {
+      uint64_t offset = libretrodb_cursor_tell(&cur);
+
+      if (libretrodb_cursor_read_item_view(&cur, &item) != 0)
+         break;
+
+      if ((field = libretrodb_map_get(&item, field_name)))
       {
-         printf("Value is not unique: ");
-         rmsgpack_dom_value_print(field);
-         printf("\n");
-         goto clean;
+         uint8_t *entry = entries + i * stride;
+
+         libretrodb_index_key(&idx, field, entry);
+         offset = swap_if_little64(offset);
+         memcpy(entry + idx.key_size, &offset, sizeof(offset));
+
+         items[i].entry = entry;
+         items[i].len   = stride;
+         i++;
       }
-      buff     = NULL;
-      rmsgpack_dom_value_free(&item);
-      item_loc = libretrodb_tell(db);
    }
 
-   filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
+   count    = i;
+   idx.next = count * stride;
+   qsort(items, count, sizeof(*items), libretrodb_index_item_cmp);
 
-   strncpy(idx.name, name, 50);
+   /* db->fd is read-only, append through a second handle. */
+   fd = filestream_open(db->path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
-   idx.name[49] = '\0';
-   idx.key_size = field_size;
-   idx.next     = db->count * (field_size + sizeof(uint64_t));
-   libretrodb_write_index_header(db->fd, &idx);
+   if (!fd)
+      goto clean;
+
+   filestream_seek(fd, 0, RETRO_VFS_SEEK_POSITION_END);
+   libretrodb_write_index_header(fd, &idx);
+
+   for (i = 0; i < count; i++)
+      filestream_write(fd, items[i].entry, (ssize_t)stride);
 
-   nictx.db  = db;
-   nictx.idx = &idx;
-   bintree_iterate(tree, node_iter, &nictx);
+   filestream_close(fd);
+   rv = 0;
 
 clean:
-   rmsgpack_dom_value_free(&item);
-   if (buff)
-      free(buff);
+   free(entries);
+   free(items);
    if (cur.is_valid)
       libretrodb_cursor_close(&cur);
-   if (tree)
-      bintree_free(tree);
-   free(tree);
-   return 0;
+   return rv;
 }
 
 libretrodb_cursor_t *libretrodb_cursor_new(void)
@@ -45,6 +45,9 @@ typedef struct libretrodb_index libretrodb_index_t;
 
 typedef int (*libretrodb_value_provider)(void *ctx, struct rmsgpack_dom_value *out);
 
+typedef int (*libretrodb_filter_t)(const struct rmsgpack_dom_value *item,
+      void *userdata);
+
 int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider, void *ctx);
 
 void libretrodb_close(libretrodb_t *db);
@@ -54,6 +57,24 @@ int libretrodb_open(const char *path, libretrodb_t *db);
 int libretrodb_create_index(libretrodb_t *db, const char *name,
       const char *field_name);
 
+/**
+ * libretrodb_create_prefix_index:
+ * @db                  : Handle to database.
+ * @name                : Name of the new index.
+ * @field_name          : Field to index; strings, binaries, ints
+ *                        and uints can be indexed.
+ * @prefix_len          : Only keep this many bytes of string and
+ *                        binary keys, 0 for all of them.
+ *
+ * Appends an index on @field_name to the database. Keys don't
+ * have to be unique, and cursors whose query pins @field_name to
+ * a value or a between() range only read the records it lists.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_create_prefix_index(libretrodb_t *db, const char *name,
+      const char *field_name, unsigned prefix_len);
+
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
         const void *key, struct rmsgpack_dom_value *out);
 
@@ -105,6 +126,37 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_cursor_read_item_view:
+ * @cursor              : Handle to an open database cursor.
+ * @out                 : Next record the query accepts.
+ *
+ * Like libretrodb_cursor_read_item(), but @out lives in the
+ * cursor's scratch space instead of being copied to the heap,
+ * so walking a database doesn't allocate per record. Strings
+ * are NUL-terminated. @out is only valid until the next read
+ * or until the cursor is closed, and must not be passed to
+ * rmsgpack_dom_value_free().
+ *
+ * Returns: 0 if successful, EOF at the end, otherwise negative.
+ **/
+int libretrodb_cursor_read_item_view(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out);
+
+/**
+ * libretrodb_cursor_set_filter:
+ * @cursor              : Handle to an open database cursor.
+ * @filter              : Called for every record the query accepts;
+ *                        records it returns 0 for are skipped.
+ * @userdata            : Passed to @filter.
+ *
+ * For checks the query language can't express cheaply. On a
+ * mapped database the record is decoded in place, so strings
+ * aren't NUL-terminated, see rmsgpack_dom_read_buf().
+ **/
+void libretrodb_cursor_set_filter(libretrodb_cursor_t *cursor,
+      libretrodb_filter_t filter, void *userdata);
+
 RETRO_END_DECLS
 
 #endif
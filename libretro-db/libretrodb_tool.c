@@ -21,6 +21,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <string/stdstring.h>
@@ -42,7 +43,7 @@ int main(int argc, char ** argv)
       printf("Usage: %s <db file> <command> [extra args...]\n", argv[0]);
       printf("Available Commands:\n");
       printf("\tlist\n");
-      printf("\tcreate-index <index name> <field name>\n");
+      printf("\tcreate-index <index name> <field name> [prefix length]\n");
       printf("\tfind <query expression>\n");
       printf("\tget-names <query expression>\n");
       return 1;
@@ -76,11 +77,10 @@ int main(int argc, char ** argv)
          goto error;
       }
 
-      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      while (libretrodb_cursor_read_item_view(cur, &item) == 0)
       {
          rmsgpack_dom_value_print(&item);
          printf("\n");
-         rmsgpack_dom_value_free(&item);
       }
    }
    else if (memcmp(command, "find", 4) == 0)
@@ -107,11 +107,10 @@ int main(int argc, char ** argv)
          goto error;
       }
 
-      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      while (libretrodb_cursor_read_item_view(cur, &item) == 0)
       {
          rmsgpack_dom_value_print(&item);
          printf("\n");
-         rmsgpack_dom_value_free(&item);
       }
    }
    else if (memcmp(command, "get-names", 9) == 0)
@@ -138,7 +137,7 @@ int main(int argc, char ** argv)
          goto error;
       }
 
-      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      while (libretrodb_cursor_read_item_view(cur, &item) == 0)
       {
          if (item.type == RDT_MAP) //should always be true, but if false the program would segfault
          {
@@ -152,24 +151,28 @@ int main(int argc, char ** argv)
                }
             }
          }
-
-         rmsgpack_dom_value_free(&item);
       }
    }
    else if (memcmp(command, "create-index", 12) == 0)
    {
       const char * index_name, * field_name;
+      unsigned prefix_len = 0;
 
-      if (argc != 5)
+      if (argc != 5 && argc != 6)
       {
-         printf("Usage: %s <db file> create-index <index name> <field name>\n", argv[0]);
+         printf("Usage: %s <db file> create-index <index name> <field name> [prefix length]\n", argv[0]);
          goto error;
       }
 
       index_name = argv[3];
       field_name = argv[4];
 
-      libretrodb_create_index(db, index_name, field_name);
+      if (argc == 6)
+         prefix_len = (unsigned)strtoul(argv[5], NULL, 10);
+
+      if (libretrodb_create_prefix_index(db, index_name,
+               field_name, prefix_len) != 0)
+         printf("Could not create index %s\n", index_name);
    }
    else
    {
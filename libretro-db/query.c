@@ -241,8 +241,10 @@ static struct rmsgpack_dom_value query_func_between(
          break;
       case RDT_UINT:
          res.val.bool_ = (
-               ((unsigned)input.val.int_ >= argv[0].a.value.val.uint_)
-               && (input.val.int_ <= argv[1].a.value.val.int_));
+               (argv[1].a.value.val.int_ >= 0)
+               && (argv[0].a.value.val.int_ < 0
+                  || input.val.uint_ >= (uint64_t)argv[0].a.value.val.int_)
+               && (input.val.uint_ <= (uint64_t)argv[1].a.value.val.int_));
          break;
       default:
          return res;
@@ -256,6 +258,7 @@ static struct rmsgpack_dom_value query_func_glob(
       unsigned argc, const struct argument * argv)
 {
    struct rmsgpack_dom_value res;
+   char *str  = NULL;
    unsigned i = 0;
 
    res.type      = RDT_BOOL;
@@ -269,11 +272,21 @@ static struct rmsgpack_dom_value query_func_glob(
       return res;
    if (input.type != RDT_STRING)
       return res;
+
+   /* Strings decoded in place from a mapped database
+    * aren't NUL-terminated. */
+   str = (char*)malloc(input.val.string.len + 1);
+   if (!str)
+      return res;
+   memcpy(str, input.val.string.buff, input.val.string.len);
+   str[input.val.string.len] = '\0';
+
    res.val.bool_ = rl_fnmatch(
          argv[0].a.value.val.string.buff,
-         input.val.string.buff,
+         str,
          0
          ) == 0;
+   free(str);
    return res;
 }
 
@@ -970,6 +983,51 @@ void libretrodb_query_inc_ref(libretrodb_query_t *q)
       rq->ref_count += 1;
 }
 
+int libretrodb_query_field_range(libretrodb_query_t *q, const char *field,
+      const struct rmsgpack_dom_value **min,
+      const struct rmsgpack_dom_value **max)
+{
+   unsigned i;
+   struct invocation *inv = &((struct query *)q)->root;
+   size_t len             = strlen(field);
+
+   /* Only tables, where every pair has to match. */
+   if (inv->func != query_func_all_map)
+      return 0;
+
+   for (i = 0; i + 1 < inv->argc; i += 2)
+   {
+      const struct argument *key = &inv->argv[i];
+      const struct argument *arg = &inv->argv[i + 1];
+
+      if (     key->type != AT_VALUE
+            || key->a.value.type != RDT_STRING
+            || key->a.value.val.string.len != len
+            || strncmp(key->a.value.val.string.buff, field, len))
+         continue;
+
+      if (arg->type == AT_VALUE)
+      {
+         *min = *max = &arg->a.value;
+         return 1;
+      }
+
+      if (     arg->a.invocation.func == query_func_between
+            && arg->a.invocation.argc == 2
+            && arg->a.invocation.argv[0].type == AT_VALUE
+            && arg->a.invocation.argv[1].type == AT_VALUE
+            && arg->a.invocation.argv[0].a.value.type == RDT_INT
+            && arg->a.invocation.argv[1].a.value.type == RDT_INT)
+      {
+         *min = &arg->a.invocation.argv[0].a.value;
+         *max = &arg->a.invocation.argv[1].a.value;
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
 int libretrodb_query_filter(libretrodb_query_t *q,
       struct rmsgpack_dom_value *v)
 {
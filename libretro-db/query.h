@@ -38,6 +38,23 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_field_range:
+ * @q                   : Compiled query.
+ * @field               : Field name.
+ * @min                 : Lowest value a match can have.
+ * @max                 : Highest value a match can have.
+ *
+ * Looks for a top-level predicate of @q on @field that every
+ * match has to satisfy: an exact value (then @min == @max) or
+ * a between() range, whose bounds are RDT_INT.
+ *
+ * Returns: 1 if found, otherwise 0.
+ **/
+int libretrodb_query_field_range(libretrodb_query_t *q, const char *field,
+      const struct rmsgpack_dom_value **min,
+      const struct rmsgpack_dom_value **max);
+
 RETRO_END_DECLS
 
 #endif
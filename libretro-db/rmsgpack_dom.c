@@ -503,3 +503,321 @@ clean:
    rmsgpack_dom_value_free(&map);
    return 0;
 }
+
+/* Returned by dom_read_buf_value() when the scratch space
+ * runs out; the value is decoded again with more. */
+#define DOM_SCRATCH_FULL 1
+
+static void *dom_scratch_alloc(struct rmsgpack_dom_scratch *scratch,
+      size_t size)
+{
+   void *ptr;
+
+   /* Keep the items aligned for the 64-bit members. */
+   size = (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+
+   if (size > scratch->size - scratch->used)
+      return NULL;
+
+   ptr            = scratch->data + scratch->used;
+   scratch->used += size;
+   return ptr;
+}
+
+static int dom_read_buf_uint(const uint8_t *buf, size_t len, size_t *pos,
+      size_t size, uint64_t *out)
+{
+   size_t i;
+
+   if (size > len - *pos)
+      return -EINVAL;
+
+   *out = 0;
+   for (i = 0; i < size; i++)
+      *out = (*out << 8) | buf[(*pos)++];
+
+   return 0;
+}
+
+static int dom_read_buf_value(const uint8_t *buf, size_t len, size_t *pos,
+      struct rmsgpack_dom_value *v, struct rmsgpack_dom_scratch *scratch,
+      unsigned depth)
+{
+   int rv;
+   uint8_t type;
+   uint32_t i;
+   uint64_t tmp = 0;
+
+   if (depth >= MAX_DEPTH)
+      return -ENOMEM;
+
+   if (*pos >= len)
+      return -EINVAL;
+
+   type = buf[(*pos)++];
+
+   if (type < _MPF_FIXMAP)
+   {
+      v->type     = RDT_INT;
+      v->val.int_ = type;
+      return 0;
+   }
+   else if (type < _MPF_FIXARRAY)
+   {
+      tmp = type - _MPF_FIXMAP;
+      goto map;
+   }
+   else if (type < _MPF_FIXSTR)
+   {
+      tmp = type - _MPF_FIXARRAY;
+      goto array;
+   }
+   else if (type < _MPF_NIL)
+   {
+      tmp = type - _MPF_FIXSTR;
+      goto string;
+   }
+   else if (type > _MPF_MAP32)
+   {
+      v->type     = RDT_INT;
+      v->val.int_ = type - 0xff - 1;
+      return 0;
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         v->type = RDT_NULL;
+         return 0;
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         v->type      = RDT_BOOL;
+         v->val.bool_ = type == _MPF_TRUE;
+         return 0;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+         if ((rv = dom_read_buf_uint(buf, len, pos,
+                     (size_t)1 << (type - _MPF_BIN8), &tmp)) < 0)
+            return rv;
+         v->type = RDT_BINARY;
+         goto string_data;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         if ((rv = dom_read_buf_uint(buf, len, pos,
+                     (size_t)1 << (type - _MPF_UINT8), &tmp)) < 0)
+            return rv;
+         v->type      = RDT_UINT;
+         v->val.uint_ = tmp;
+         return 0;
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         {
+            unsigned bits = 8u << (type - _MPF_INT8);
+            if ((rv = dom_read_buf_uint(buf, len, pos, bits / 8, &tmp)) < 0)
+               return rv;
+            /* Sign-extend */
+            if (bits < 64 && (tmp & (UINT64_C(1) << (bits - 1))))
+               tmp |= ~UINT64_C(0) << bits;
+            v->type     = RDT_INT;
+            v->val.int_ = (int64_t)tmp;
+         }
+         return 0;
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         if ((rv = dom_read_buf_uint(buf, len, pos,
+                     (size_t)1 << (type - _MPF_STR8), &tmp)) < 0)
+            return rv;
+         goto string;
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+         if ((rv = dom_read_buf_uint(buf, len, pos,
+                     (size_t)2 << (type - _MPF_ARRAY16), &tmp)) < 0)
+            return rv;
+         goto array;
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         if ((rv = dom_read_buf_uint(buf, len, pos,
+                     (size_t)2 << (type - _MPF_MAP16), &tmp)) < 0)
+            return rv;
+         goto map;
+   }
+
+   /* Reserved types decode as nil, as in rmsgpack_read(). */
+   v->type = RDT_NULL;
+   return 0;
+
+string:
+   v->type = RDT_STRING;
+
+string_data:
+   /* string and binary share their layout */
+   if (tmp > len - *pos)
+      return -EINVAL;
+   v->val.string.len  = (uint32_t)tmp;
+   v->val.string.buff = (char*)buf + *pos;
+   if (scratch->copy_strings)
+   {
+      char *copy = (char*)dom_scratch_alloc(scratch, (size_t)tmp + 1);
+      if (!copy)
+         return DOM_SCRATCH_FULL;
+      memcpy(copy, buf + *pos, (size_t)tmp);
+      copy[tmp]          = '\0';
+      v->val.string.buff = copy;
+   }
+   *pos += (size_t)tmp;
+   return 0;
+
+map:
+   /* Every item takes at least two bytes, which also
+    * bounds the allocation for corrupt lengths. */
+   if (tmp > (len - *pos) / 2)
+      return -EINVAL;
+   v->type          = RDT_MAP;
+   v->val.map.len   = (uint32_t)tmp;
+   v->val.map.items = (struct rmsgpack_dom_pair*)dom_scratch_alloc(
+         scratch, (size_t)tmp * sizeof(struct rmsgpack_dom_pair));
+   if (tmp && !v->val.map.items)
+      return DOM_SCRATCH_FULL;
+   for (i = 0; i < v->val.map.len; i++)
+   {
+      if ((rv = dom_read_buf_value(buf, len, pos,
+                  &v->val.map.items[i].key, scratch, depth + 1)) != 0)
+         return rv;
+      if ((rv = dom_read_buf_value(buf, len, pos,
+                  &v->val.map.items[i].value, scratch, depth + 1)) != 0)
+         return rv;
+   }
+   return 0;
+
+array:
+   if (tmp > len - *pos)
+      return -EINVAL;
+   v->type            = RDT_ARRAY;
+   v->val.array.len   = (uint32_t)tmp;
+   v->val.array.items = (struct rmsgpack_dom_value*)dom_scratch_alloc(
+         scratch, (size_t)tmp * sizeof(struct rmsgpack_dom_value));
+   if (tmp && !v->val.array.items)
+      return DOM_SCRATCH_FULL;
+   for (i = 0; i < v->val.array.len; i++)
+   {
+      if ((rv = dom_read_buf_value(buf, len, pos,
+                  &v->val.array.items[i], scratch, depth + 1)) != 0)
+         return rv;
+   }
+   return 0;
+}
+
+int rmsgpack_dom_read_buf(const uint8_t *buf, size_t len, size_t *offset,
+      struct rmsgpack_dom_value *out, struct rmsgpack_dom_scratch *scratch)
+{
+   for (;;)
+   {
+      uint8_t *data;
+      size_t size;
+      size_t pos    = *offset;
+      int rv;
+
+      scratch->used = 0;
+      rv            = dom_read_buf_value(buf, len, &pos, out, scratch, 0);
+
+      if (rv < 0)
+         return rv;
+
+      if (rv != DOM_SCRATCH_FULL)
+      {
+         *offset = pos;
+         return 0;
+      }
+
+      /* Items handed out so far point into the old block,
+       * so start over rather than realloc under them. */
+      size = scratch->size ? scratch->size * 2 : 4096;
+      data = (uint8_t*)malloc(size);
+
+      if (!data)
+         return -ENOMEM;
+
+      free(scratch->data);
+      scratch->data = data;
+      scratch->size = size;
+   }
+}
+
+void rmsgpack_dom_scratch_free(struct rmsgpack_dom_scratch *scratch)
+{
+   free(scratch->data);
+   scratch->data = NULL;
+   scratch->size = 0;
+   scratch->used = 0;
+}
+
+int rmsgpack_dom_value_copy(const struct rmsgpack_dom_value *src,
+      struct rmsgpack_dom_value *dst)
+{
+   uint32_t i;
+
+   *dst = *src;
+
+   switch (src->type)
+   {
+      case RDT_STRING:
+      case RDT_BINARY:
+         /* string and binary share their layout */
+         dst->val.string.buff = (char*)malloc(src->val.string.len + 1);
+         if (!dst->val.string.buff)
+            goto error;
+         memcpy(dst->val.string.buff, src->val.string.buff,
+               src->val.string.len);
+         dst->val.string.buff[src->val.string.len] = '\0';
+         break;
+      case RDT_MAP:
+         dst->val.map.items = (struct rmsgpack_dom_pair*)calloc(
+               src->val.map.len, sizeof(struct rmsgpack_dom_pair));
+         if (src->val.map.len && !dst->val.map.items)
+            goto error;
+         for (i = 0; i < src->val.map.len; i++)
+         {
+            if (rmsgpack_dom_value_copy(&src->val.map.items[i].key,
+                     &dst->val.map.items[i].key) < 0
+                  || rmsgpack_dom_value_copy(&src->val.map.items[i].value,
+                     &dst->val.map.items[i].value) < 0)
+            {
+               /* Cut the map short so only the copies get freed. */
+               dst->val.map.len = i + 1;
+               rmsgpack_dom_value_free(dst);
+               goto error;
+            }
+         }
+         break;
+      case RDT_ARRAY:
+         dst->val.array.items = (struct rmsgpack_dom_value*)calloc(
+               src->val.array.len, sizeof(struct rmsgpack_dom_value));
+         if (src->val.array.len && !dst->val.array.items)
+            goto error;
+         for (i = 0; i < src->val.array.len; i++)
+         {
+            if (rmsgpack_dom_value_copy(&src->val.array.items[i],
+                     &dst->val.array.items[i]) < 0)
+            {
+               dst->val.array.len = i + 1;
+               rmsgpack_dom_value_free(dst);
+               goto error;
+            }
+         }
+         break;
+      default:
+         break;
+   }
+
+   return 0;
+
+error:
+   dst->type = RDT_NULL;
+   return -ENOMEM;
+}
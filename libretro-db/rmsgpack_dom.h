@@ -24,6 +24,7 @@
 #define __LIBRETRODB_MSGPACK_DOM_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <retro_common_api.h>
 #include <streams/file_stream.h>
@@ -79,6 +80,18 @@ struct rmsgpack_dom_pair
 	struct rmsgpack_dom_value value;
 };
 
+/* Backing store for the map and array items of values
+ * decoded with rmsgpack_dom_read_buf(). */
+struct rmsgpack_dom_scratch
+{
+   uint8_t *data;
+   size_t size;
+   size_t used;
+   /* Also copy strings and binaries here, NUL-terminated,
+    * instead of pointing them into the input. */
+   int copy_strings;
+};
+
 void rmsgpack_dom_value_print(struct rmsgpack_dom_value *obj);
 void rmsgpack_dom_value_free(struct rmsgpack_dom_value *v);
 
@@ -95,6 +108,40 @@ int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
 
+/**
+ * rmsgpack_dom_read_buf:
+ * @buf                 : msgpack data.
+ * @len                 : size of @buf in bytes.
+ * @offset              : position of the value in @buf, advanced
+ *                        past it on success.
+ * @out                 : decoded value.
+ * @scratch             : holds the map and array items of @out.
+ *
+ * Decodes one value in place: strings and binaries in @out point
+ * into @buf and are NOT NUL-terminated, unless @scratch has
+ * copy_strings set. Either way @out stays valid until
+ * @scratch is reused or freed, and must not be passed to
+ * rmsgpack_dom_value_free(); use rmsgpack_dom_value_copy() to
+ * keep it.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int rmsgpack_dom_read_buf(const uint8_t *buf, size_t len, size_t *offset,
+      struct rmsgpack_dom_value *out, struct rmsgpack_dom_scratch *scratch);
+
+void rmsgpack_dom_scratch_free(struct rmsgpack_dom_scratch *scratch);
+
+/**
+ * rmsgpack_dom_value_copy:
+ * @src                 : value to copy, owned or decoded in place.
+ * @dst                 : heap-allocated deep copy of @src, with
+ *                        NUL-terminated strings.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int rmsgpack_dom_value_copy(const struct rmsgpack_dom_value *src,
+      struct rmsgpack_dom_value *dst);
+
 RETRO_END_DECLS
 
 #endif
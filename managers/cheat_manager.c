@@ -28,6 +28,10 @@
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
 
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -73,6 +77,8 @@ void cheat_manager_apply_cheats(void)
    if (!cheat_manager_state.cheats)
       return;
 
+   cheat_manager_state.patches_valid = false;
+
    core_reset_cheat();
 
    for (i = 0; i < cheat_manager_state.size; i++)
@@ -266,6 +272,7 @@ bool cheat_manager_copy_working_to_idx(unsigned idx)
       free(cheat_manager_state.cheats[idx].code);
 
    cheat_manager_state.cheats[idx].code = strdup(cheat_manager_state.working_code);
+   cheat_manager_state.patches_valid    = false;
    return true;
 }
 static void cheat_manager_new(unsigned size)
@@ -498,8 +505,9 @@ bool cheat_manager_realloc(unsigned new_size, unsigned default_handler)
       return false;
    }
 
-   cheat_manager_state.buf_size = new_size;
-   cheat_manager_state.size     = new_size;
+   cheat_manager_state.buf_size      = new_size;
+   cheat_manager_state.size          = new_size;
+   cheat_manager_state.patches_valid = false;
 
    for (i = orig_size; i < cheat_manager_state.size; i++)
    {
@@ -537,8 +545,11 @@ void cheat_manager_free(void)
    if (cheat_manager_state.prev_memory_buf)
       free(cheat_manager_state.prev_memory_buf);
 
-   if (cheat_manager_state.matches)
-      free(cheat_manager_state.matches);
+   if (cheat_manager_state.match_bits)
+      free(cheat_manager_state.match_bits);
+
+   if (cheat_manager_state.match_list)
+      free(cheat_manager_state.match_list);
 
    if (cheat_manager_state.memory_buf_list)
       free(cheat_manager_state.memory_buf_list);
@@ -546,6 +557,12 @@ void cheat_manager_free(void)
    if (cheat_manager_state.memory_size_list)
       free(cheat_manager_state.memory_size_list);
 
+   if (cheat_manager_state.patches)
+      free(cheat_manager_state.patches);
+
+   if (cheat_manager_state.patch_writes)
+      free(cheat_manager_state.patch_writes);
+
    cheat_manager_state.cheats                    = NULL;
    cheat_manager_state.size                      = 0;
    cheat_manager_state.buf_size                  = 0;
@@ -553,11 +570,18 @@ void cheat_manager_free(void)
    cheat_manager_state.curr_memory_buf           = NULL;
    cheat_manager_state.memory_buf_list           = NULL;
    cheat_manager_state.memory_size_list          = NULL;
-   cheat_manager_state.matches                   = NULL;
+   cheat_manager_state.match_bits                = NULL;
+   cheat_manager_state.match_list                = NULL;
+   cheat_manager_state.num_match_items           = 0;
+   cheat_manager_state.num_matches               = 0;
    cheat_manager_state.num_memory_buffers        = 0;
    cheat_manager_state.total_memory_size         = 0;
    cheat_manager_state.memory_initialized        = false;
    cheat_manager_state.memory_search_initialized = false;
+   cheat_manager_state.patches                   = NULL;
+   cheat_manager_state.patch_writes              = NULL;
+   cheat_manager_state.num_patches               = 0;
+   cheat_manager_state.patches_valid             = false;
 
 }
 
@@ -584,6 +608,7 @@ void cheat_manager_toggle_index(unsigned i)
       return;
 
    cheat_manager_state.cheats[i].state = !cheat_manager_state.cheats[i].state;
+   cheat_manager_state.patches_valid   = false;
    cheat_manager_update(&cheat_manager_state, i);
 
    if (!settings)
@@ -600,6 +625,7 @@ void cheat_manager_toggle(void)
       return;
 
    cheat_manager_state.cheats[cheat_manager_state.ptr].state ^= true;
+   cheat_manager_state.patches_valid                         = false;
    cheat_manager_apply_cheats();
    cheat_manager_update(&cheat_manager_state, cheat_manager_state.ptr);
 }
@@ -715,7 +741,7 @@ bool cheat_manager_alloc_if_empty(void)
 
 int cheat_manager_initialize_memory(rarch_setting_t *setting, bool wraparound)
 {
-   unsigned i;
+   unsigned i, words;
    retro_ctx_memory_info_t meminfo;
    bool refresh                           = false;
    bool is_search_initialization          = (setting != NULL);
@@ -725,6 +751,7 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, bool wraparound)
    cheat_manager_state.num_memory_buffers = 0;
    cheat_manager_state.total_memory_size  = 0;
    cheat_manager_state.curr_memory_buf    = NULL;
+   cheat_manager_state.patches_valid      = false;
 
    if (cheat_manager_state.memory_buf_list)
    {
@@ -792,8 +819,6 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, bool wraparound)
 
    }
 
-   cheat_manager_state.num_matches        = (cheat_manager_state.total_memory_size*8)/((int)pow(2,cheat_manager_state.search_bit_size));
-
    /* Ensure we're aligned on 4-byte boundary */
 #if 0
    if (meminfo.size % 4 > 0)
@@ -815,14 +840,24 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, bool wraparound)
          return 0;
       }
 
-      if (cheat_manager_state.matches)
+      if (cheat_manager_state.match_list)
+      {
+         free(cheat_manager_state.match_list);
+         cheat_manager_state.match_list = NULL;
+      }
+
+      if (cheat_manager_state.match_bits)
       {
-         free(cheat_manager_state.matches);
-         cheat_manager_state.matches  = NULL;
+         free(cheat_manager_state.match_bits);
+         cheat_manager_state.match_bits = NULL;
       }
 
-      cheat_manager_state.matches = (uint8_t*) calloc(cheat_manager_state.total_memory_size, sizeof(uint8_t));
-      if (!cheat_manager_state.matches)
+      cheat_manager_state.match_bit_size  = cheat_manager_state.search_bit_size;
+      cheat_manager_state.num_match_items = (cheat_manager_state.total_memory_size * 8) >> cheat_manager_state.search_bit_size;
+      words                               = (cheat_manager_state.num_match_items + 31) / 32;
+
+      cheat_manager_state.match_bits = (uint32_t*)malloc(MAX(words, 1) * sizeof(uint32_t));
+      if (!cheat_manager_state.match_bits)
       {
          free(cheat_manager_state.prev_memory_buf);
          cheat_manager_state.prev_memory_buf = NULL;
@@ -830,7 +865,14 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, bool wraparound)
          return 0;
       }
 
-      memset(cheat_manager_state.matches, 0xFF, cheat_manager_state.total_memory_size);
+      /* Every item is a candidate, past the last one isn't */
+      memset(cheat_manager_state.match_bits, 0xFF, MAX(words, 1) * sizeof(uint32_t));
+      if (cheat_manager_state.num_match_items % 32)
+         cheat_manager_state.match_bits[words - 1] = (1u << (cheat_manager_state.num_match_items % 32)) - 1;
+      else if (!words)
+         cheat_manager_state.match_bits[0] = 0;
+
+      cheat_manager_state.num_matches = cheat_manager_state.num_match_items;
 
       offset = 0;
 
@@ -915,6 +957,514 @@ static void cheat_manager_setup_search_meta(unsigned int bitsize, unsigned int *
    }
 }
 
+/* Search candidates are kept in match_bits, one bit per item.
+ * Items are numbered from the start of the flattened memory:
+ * bit fields for searches narrower than a byte, then bytes, then
+ * 16/32-bit words. Once few are left they are also listed in
+ * match_list, so later searches only look at the survivors. */
+
+/* A list entry takes as much room as 32 bits of the bitset */
+#define CHEAT_MATCH_LIST_RATIO 32
+
+struct cheat_search
+{
+   enum cheat_search_type type;
+   unsigned value;
+   unsigned bytes;
+   unsigned mask;
+   unsigned bits;
+   bool big_endian;
+   bool vector;
+};
+
+static unsigned cheat_manager_popcount(uint32_t x)
+{
+   x = x - ((x >> 1) & 0x55555555);
+   x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+   return (((x + (x >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+static unsigned cheat_manager_load_value(const uint8_t *data,
+      unsigned bytes, bool big_endian)
+{
+   switch (bytes)
+   {
+      case 2:
+         return big_endian ?
+            (data[0] << 8) | data[1] :
+            data[0] | (data[1] << 8);
+      case 4:
+         return big_endian ?
+            ((unsigned)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3] :
+            data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned)data[3] << 24);
+      default:
+         break;
+   }
+
+   return data[0];
+}
+
+/* Reads the item at a flattened address, which can run
+ * into the next memory buffer. */
+static unsigned cheat_manager_read_item(const uint8_t *prev,
+      unsigned address, unsigned bytes, bool big_endian)
+{
+   uint8_t data[4] = {0};
+   unsigned i;
+
+   for (i = 0; i < bytes; i++)
+   {
+      unsigned char *curr = cheat_manager_state.curr_memory_buf;
+
+      if (address + i >= cheat_manager_state.total_memory_size)
+         data[i] = 0;
+      else if (prev)
+         data[i] = prev[address + i];
+      else
+      {
+         unsigned offset = translate_address(address + i, &curr);
+         data[i]         = curr[address + i - offset];
+      }
+   }
+
+   return cheat_manager_load_value(data, bytes, big_endian);
+}
+
+static void cheat_manager_setup_search(struct cheat_search *search,
+      enum cheat_search_type search_type)
+{
+   search->type       = search_type;
+   search->big_endian = cheat_manager_state.big_endian;
+   search->bytes      = 1;
+   search->mask       = 0;
+   search->bits       = 8;
+
+   cheat_manager_setup_search_meta(cheat_manager_state.match_bit_size,
+         &search->bytes, &search->mask, &search->bits);
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         search->value = cheat_manager_state.search_exact_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         search->value = cheat_manager_state.search_eqplus_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         search->value = cheat_manager_state.search_eqminus_value;
+         break;
+      default:
+         search->value = 0;
+         break;
+   }
+
+   /* The vector kernels compare at the width of the items,
+    * a wider value has to go through the scalar test. */
+   search->vector = search->value <= search->mask;
+}
+
+static bool cheat_manager_search_test(const struct cheat_search *search,
+      unsigned curr, unsigned prev)
+{
+   switch (search->type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT :
+         return (curr == search->value);
+      case CHEAT_SEARCH_TYPE_LT :
+         return (curr < prev);
+      case CHEAT_SEARCH_TYPE_GT :
+         return (curr > prev);
+      case CHEAT_SEARCH_TYPE_LTE :
+         return (curr <= prev);
+      case CHEAT_SEARCH_TYPE_GTE :
+         return (curr >= prev);
+      case CHEAT_SEARCH_TYPE_EQ :
+         return (curr == prev);
+      case CHEAT_SEARCH_TYPE_NEQ :
+         return (curr != prev);
+      case CHEAT_SEARCH_TYPE_EQPLUS :
+         return (curr == prev + search->value);
+      case CHEAT_SEARCH_TYPE_EQMINUS :
+         return (curr == prev - search->value);
+   }
+
+   return false;
+}
+
+static unsigned cheat_manager_item_address(const struct cheat_search *search,
+      unsigned item, unsigned *address_mask)
+{
+   if (search->bits < 8)
+   {
+      unsigned per  = 8 / search->bits;
+      *address_mask = search->mask << ((item % per) * search->bits);
+      return item / per;
+   }
+
+   *address_mask = 0xFF;
+   return item * search->bytes;
+}
+
+static bool cheat_manager_search_item(const struct cheat_search *search,
+      unsigned item)
+{
+   unsigned address_mask;
+   unsigned address = cheat_manager_item_address(search, item, &address_mask);
+   unsigned curr    = cheat_manager_read_item(NULL,
+         address, search->bytes, search->big_endian);
+   unsigned prev    = cheat_manager_read_item(cheat_manager_state.prev_memory_buf,
+         address, search->bytes, search->big_endian);
+
+   if (search->bits < 8)
+   {
+      unsigned shift = (item % (8 / search->bits)) * search->bits;
+      curr           = (curr >> shift) & search->mask;
+      prev           = (prev >> shift) & search->mask;
+   }
+
+   return cheat_manager_search_test(search, curr, prev);
+}
+
+static void cheat_manager_drop_matches(unsigned item, uint32_t drop)
+{
+   cheat_manager_state.match_bits[item >> 5] &= ~(drop << (item & 31));
+   cheat_manager_state.num_matches           -= cheat_manager_popcount(drop);
+}
+
+#if __SSE2__
+/* Arguments are biased by the sign bit, SSE2 only has signed
+ * comparisons. Below 32 bits prev + value must not wrap. */
+#define CHEAT_SEARCH_SSE2(name, cmpeq, cmpgt, sub, wraps) \
+static __m128i name(const struct cheat_search *search, \
+      __m128i c, __m128i p, __m128i bias, __m128i value) \
+{ \
+   const __m128i ones = _mm_cmpeq_epi8(c, c); \
+   __m128i cb         = _mm_xor_si128(c, bias); \
+   __m128i pb         = _mm_xor_si128(p, bias); \
+   switch (search->type) \
+   { \
+      case CHEAT_SEARCH_TYPE_EXACT : \
+         return cmpeq(c, value); \
+      case CHEAT_SEARCH_TYPE_LT : \
+         return cmpgt(pb, cb); \
+      case CHEAT_SEARCH_TYPE_GT : \
+         return cmpgt(cb, pb); \
+      case CHEAT_SEARCH_TYPE_LTE : \
+         return _mm_andnot_si128(cmpgt(cb, pb), ones); \
+      case CHEAT_SEARCH_TYPE_GTE : \
+         return _mm_andnot_si128(cmpgt(pb, cb), ones); \
+      case CHEAT_SEARCH_TYPE_EQ : \
+         return cmpeq(c, p); \
+      case CHEAT_SEARCH_TYPE_NEQ : \
+         return _mm_andnot_si128(cmpeq(c, p), ones); \
+      case CHEAT_SEARCH_TYPE_EQPLUS : \
+         return wraps ? cmpeq(sub(c, p), value) : \
+            _mm_andnot_si128(cmpgt(pb, cb), cmpeq(sub(c, p), value)); \
+      case CHEAT_SEARCH_TYPE_EQMINUS : \
+         return wraps ? cmpeq(sub(p, c), value) : \
+            _mm_andnot_si128(cmpgt(cb, pb), cmpeq(sub(p, c), value)); \
+   } \
+   return _mm_setzero_si128(); \
+}
+
+CHEAT_SEARCH_SSE2(cheat_manager_search_sse2_8,
+      _mm_cmpeq_epi8, _mm_cmpgt_epi8, _mm_sub_epi8, 0)
+CHEAT_SEARCH_SSE2(cheat_manager_search_sse2_16,
+      _mm_cmpeq_epi16, _mm_cmpgt_epi16, _mm_sub_epi16, 0)
+CHEAT_SEARCH_SSE2(cheat_manager_search_sse2_32,
+      _mm_cmpeq_epi32, _mm_cmpgt_epi32, _mm_sub_epi32, 1)
+
+static INLINE __m128i cheat_manager_swap16_sse2(__m128i x)
+{
+   return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+static INLINE __m128i cheat_manager_swap32_sse2(__m128i x)
+{
+   const __m128i mask = _mm_set1_epi32(0x00ff00ff);
+   x = _mm_or_si128(_mm_slli_epi32(x, 16), _mm_srli_epi32(x, 16));
+   return _mm_or_si128(_mm_slli_epi32(_mm_and_si128(x, mask), 8),
+         _mm_and_si128(_mm_srli_epi32(x, 8), mask));
+}
+
+/* Compares 32 items, returns a bit for each that passes */
+static uint32_t cheat_manager_search_sse2(const struct cheat_search *search,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   __m128i m[8];
+   unsigned i;
+
+   switch (search->bytes)
+   {
+      case 2:
+      {
+         const __m128i bias  = _mm_set1_epi16((short)0x8000);
+         const __m128i value = _mm_set1_epi16((short)search->value);
+
+         for (i = 0; i < 4; i++)
+         {
+            __m128i c = _mm_loadu_si128((const __m128i*)(curr + i * 16));
+            __m128i p = _mm_loadu_si128((const __m128i*)(prev + i * 16));
+            /* x86 is little endian */
+            if (search->big_endian)
+            {
+               c = cheat_manager_swap16_sse2(c);
+               p = cheat_manager_swap16_sse2(p);
+            }
+            m[i] = cheat_manager_search_sse2_16(search, c, p, bias, value);
+         }
+
+         m[0] = _mm_packs_epi16(m[0], m[1]);
+         m[1] = _mm_packs_epi16(m[2], m[3]);
+         break;
+      }
+      case 4:
+      {
+         const __m128i bias  = _mm_set1_epi32((int)0x80000000u);
+         const __m128i value = _mm_set1_epi32((int)search->value);
+
+         for (i = 0; i < 8; i++)
+         {
+            __m128i c = _mm_loadu_si128((const __m128i*)(curr + i * 16));
+            __m128i p = _mm_loadu_si128((const __m128i*)(prev + i * 16));
+            if (search->big_endian)
+            {
+               c = cheat_manager_swap32_sse2(c);
+               p = cheat_manager_swap32_sse2(p);
+            }
+            m[i] = cheat_manager_search_sse2_32(search, c, p, bias, value);
+         }
+
+         for (i = 0; i < 4; i++)
+            m[i] = _mm_packs_epi32(m[i * 2], m[i * 2 + 1]);
+         m[0] = _mm_packs_epi16(m[0], m[1]);
+         m[1] = _mm_packs_epi16(m[2], m[3]);
+         break;
+      }
+      default:
+      {
+         const __m128i bias  = _mm_set1_epi8((char)0x80);
+         const __m128i value = _mm_set1_epi8((char)search->value);
+
+         for (i = 0; i < 2; i++)
+            m[i] = cheat_manager_search_sse2_8(search,
+                  _mm_loadu_si128((const __m128i*)(curr + i * 16)),
+                  _mm_loadu_si128((const __m128i*)(prev + i * 16)),
+                  bias, value);
+         break;
+      }
+   }
+
+   return (uint32_t)_mm_movemask_epi8(m[0]) |
+      ((uint32_t)_mm_movemask_epi8(m[1]) << 16);
+}
+#endif
+
+/* Compares n <= 32 items stored back to back */
+static uint32_t cheat_manager_search_block(const struct cheat_search *search,
+      const uint8_t *curr, const uint8_t *prev, unsigned n)
+{
+   unsigned i;
+   uint32_t keep = 0;
+
+#if __SSE2__
+   if (search->vector && n == 32)
+      return cheat_manager_search_sse2(search, curr, prev);
+#endif
+
+   for (i = 0; i < n; i++, curr += search->bytes, prev += search->bytes)
+      if (cheat_manager_search_test(search,
+               cheat_manager_load_value(curr, search->bytes, search->big_endian),
+               cheat_manager_load_value(prev, search->bytes, search->big_endian)))
+         keep |= 1u << i;
+
+   return keep;
+}
+
+/* Items [item, end) of a single memory buffer, whole bitset
+ * words without a candidate are skipped. */
+static void cheat_manager_search_range(const struct cheat_search *search,
+      unsigned item, unsigned end, const uint8_t *curr, const uint8_t *prev)
+{
+   while (item < end)
+   {
+      unsigned shift = item & 31;
+      unsigned n     = MIN(32 - shift, end - item);
+      uint32_t live  = cheat_manager_state.match_bits[item >> 5] >> shift;
+
+      if (n < 32)
+         live &= (1u << n) - 1;
+
+      if (live)
+         cheat_manager_drop_matches(item, live &
+               ~cheat_manager_search_block(search, curr, prev, n));
+
+      item += n;
+      curr += n * search->bytes;
+      prev += n * search->bytes;
+   }
+}
+
+/* Bit fields in size bytes starting at a flattened address */
+static void cheat_manager_search_fields(const struct cheat_search *search,
+      unsigned address, unsigned size, const uint8_t *curr, const uint8_t *prev)
+{
+   unsigned i, part;
+   unsigned per = 8 / search->bits;
+
+   for (i = 0; i < size; i++)
+   {
+      unsigned item = (address + i) * per;
+      uint32_t live = (cheat_manager_state.match_bits[item >> 5] >>
+            (item & 31)) & ((1u << per) - 1);
+      uint32_t drop = 0;
+
+      if (!live)
+         continue;
+
+      for (part = 0; part < per; part++)
+      {
+         unsigned shift = part * search->bits;
+
+         if ((live & (1u << part)) && !cheat_manager_search_test(search,
+                  (curr[i] >> shift) & search->mask,
+                  (prev[i] >> shift) & search->mask))
+            drop |= 1u << part;
+      }
+
+      cheat_manager_drop_matches(item, drop);
+   }
+}
+
+static void cheat_manager_search_bits(const struct cheat_search *search)
+{
+   unsigned i;
+   unsigned start = 0;
+
+   for (i = 0; i < cheat_manager_state.num_memory_buffers; i++)
+   {
+      const uint8_t *curr = cheat_manager_state.memory_buf_list[i];
+      const uint8_t *prev = cheat_manager_state.prev_memory_buf;
+      unsigned end        = start + cheat_manager_state.memory_size_list[i];
+
+      if (search->bits < 8)
+         cheat_manager_search_fields(search, start, end - start,
+               curr, prev + start);
+      else
+      {
+         unsigned bytes = search->bytes;
+         unsigned first = (start + bytes - 1) / bytes;
+         unsigned last  = end / bytes;
+
+         if (first < last)
+            cheat_manager_search_range(search, first, last,
+                  curr + first * bytes - start, prev + first * bytes);
+
+         /* An item running into the next buffer */
+         if (     last * bytes >= start
+               && last * bytes <  end
+               && last         <  cheat_manager_state.num_match_items
+               && (cheat_manager_state.match_bits[last >> 5] >> (last & 31)) & 1
+               && !cheat_manager_search_item(search, last))
+            cheat_manager_drop_matches(last, 1);
+      }
+
+      start = end;
+   }
+}
+
+static void cheat_manager_search_list(const struct cheat_search *search)
+{
+   unsigned i;
+   unsigned kept = 0;
+
+   for (i = 0; i < cheat_manager_state.num_matches; i++)
+   {
+      unsigned item = cheat_manager_state.match_list[i];
+
+      if (cheat_manager_search_item(search, item))
+         cheat_manager_state.match_list[kept++] = item;
+      else
+         cheat_manager_state.match_bits[item >> 5] &= ~(1u << (item & 31));
+   }
+
+   cheat_manager_state.num_matches = kept;
+}
+
+/* Switches to a candidate list once it is smaller than the bitset */
+static void cheat_manager_compact_matches(void)
+{
+   unsigned i, count = 0;
+   unsigned words    = (cheat_manager_state.num_match_items + 31) / 32;
+
+   if (cheat_manager_state.match_list || cheat_manager_state.num_matches >
+         cheat_manager_state.num_match_items / CHEAT_MATCH_LIST_RATIO)
+      return;
+
+   cheat_manager_state.match_list = (unsigned*)malloc(
+         MAX(cheat_manager_state.num_matches, 1) * sizeof(unsigned));
+
+   /* The bitset keeps working without it */
+   if (!cheat_manager_state.match_list)
+      return;
+
+   for (i = 0; i < words; i++)
+   {
+      uint32_t bits = cheat_manager_state.match_bits[i];
+
+      while (bits && count < cheat_manager_state.num_matches)
+      {
+         cheat_manager_state.match_list[count++] = i * 32 +
+            cheat_manager_popcount((bits & (~bits + 1)) - 1);
+         bits &= bits - 1;
+      }
+   }
+}
+
+/* Finds the item of the n-th candidate */
+static bool cheat_manager_find_match(unsigned n, unsigned *item)
+{
+   unsigned i;
+   unsigned words = (cheat_manager_state.num_match_items + 31) / 32;
+
+   if (n >= cheat_manager_state.num_matches)
+      return false;
+
+   if (cheat_manager_state.match_list)
+   {
+      *item = cheat_manager_state.match_list[n];
+      return true;
+   }
+
+   for (i = 0; i < words; i++)
+   {
+      uint32_t bits  = cheat_manager_state.match_bits[i];
+      unsigned count = cheat_manager_popcount(bits);
+
+      if (n < count)
+      {
+         for (; n > 0; n--)
+            bits &= bits - 1;
+         *item = i * 32 + cheat_manager_popcount((bits & (~bits + 1)) - 1);
+         return true;
+      }
+
+      n -= count;
+   }
+
+   return false;
+}
+
+static void cheat_manager_remove_match(unsigned n, unsigned item)
+{
+   cheat_manager_drop_matches(item, 1);
+
+   if (cheat_manager_state.match_list)
+      memmove(cheat_manager_state.match_list + n,
+            cheat_manager_state.match_list + n + 1,
+            (cheat_manager_state.num_matches - n) * sizeof(unsigned));
+}
+
 int cheat_manager_search_exact(rarch_setting_t *setting, bool wraparound)
 {
    return cheat_manager_search(CHEAT_SEARCH_TYPE_EXACT);
@@ -955,118 +1505,25 @@ int cheat_manager_search_eqminus(rarch_setting_t *setting, bool wraparound)
 int cheat_manager_search(enum cheat_search_type search_type)
 {
    char msg[100];
-   unsigned char *curr         = cheat_manager_state.curr_memory_buf;
-   unsigned char *prev         = cheat_manager_state.prev_memory_buf;
-   unsigned int idx            = 0;
-   unsigned int curr_val       = 0;
-   unsigned int prev_val       = 0;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
+   struct cheat_search search;
    unsigned int offset         = 0;
    unsigned int i              = 0;
    bool refresh                = false;
 
-   if (cheat_manager_state.num_memory_buffers == 0)
+   if (cheat_manager_state.num_memory_buffers == 0 || !cheat_manager_state.match_bits)
    {
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), 1, 180, true);
       return 0;
    }
 
+   cheat_manager_setup_search(&search, search_type);
 
-   cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits);
-
-   /* little endian FF000000 = 256 */
-   for (idx = 0; idx < cheat_manager_state.total_memory_size; idx = idx + bytes_per_item)
-   {
-      unsigned byte_part;
-
-      offset = translate_address(idx, &curr);
-
-      switch (bytes_per_item)
-      {
-         case 2 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx-offset)*256) + *(curr+idx+1-offset) :
-                  *(curr+idx-offset) + (*(curr+idx+1-offset)*256);
-            prev_val = cheat_manager_state.big_endian ?
-                  (*(prev+idx)*256) + *(prev+idx+1) :
-                  *(prev+idx) + (*(prev+idx+1)*256);
-            break;
-         case 4 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx-offset)*256*256*256) + (*(curr+idx+1-offset)*256*256) + (*(curr+idx+2-offset)*256) + *(curr+idx+3-offset) :
-                  *(curr+idx-offset) + (*(curr+idx+1-offset)*256) + (*(curr+idx+2-offset)*256*256) + (*(curr+idx+3-offset)*256*256*256);
-            prev_val = cheat_manager_state.big_endian ?
-                  (*(prev+idx)*256*256*256) + (*(prev+idx+1)*256*256) + (*(prev+idx+2)*256) + *(prev+idx+3) :
-                  *(prev+idx) + (*(prev+idx+1)*256) + (*(prev+idx+2)*256*256) + (*(prev+idx+3)*256*256*256);
-            break;
-         case 1 :
-         default :
-            curr_val = *(curr-offset+idx);
-            prev_val = *(prev+idx);
-            break;
-      }
-
-      for (byte_part = 0; byte_part < 8/bits; byte_part++)
-      {
-         unsigned int curr_subval = (curr_val >> (byte_part*bits)) & mask;
-         unsigned int prev_subval = (prev_val >> (byte_part*bits)) & mask;
-         unsigned int prev_match;
-
-         if (bits < 8)
-            prev_match = *(cheat_manager_state.matches+idx) & (mask << (byte_part*bits));
-         else
-            prev_match = *(cheat_manager_state.matches+idx);
-
-         if (prev_match > 0)
-         {
-            bool match = false;
-            switch (search_type)
-            {
-               case CHEAT_SEARCH_TYPE_EXACT :
-                  match = (curr_subval == cheat_manager_state.search_exact_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_LT :
-                  match = (curr_subval < prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GT :
-                  match = (curr_subval > prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_LTE :
-                  match = (curr_subval <= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GTE :
-                  match = (curr_subval >= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQ :
-                  match = (curr_subval == prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_NEQ :
-                  match = (curr_subval != prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQPLUS :
-                  match = (curr_subval == prev_subval+cheat_manager_state.search_eqplus_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQMINUS :
-                  match = (curr_subval == prev_subval-cheat_manager_state.search_eqminus_value);
-                  break;
-            }
-            if (!match)
-            {
-               if (bits < 8)
-                  *(cheat_manager_state.matches+idx) = *(cheat_manager_state.matches+idx) &
-                        (( ~(mask << (byte_part*bits))) & 0xFF);
-               else
-                  memset(cheat_manager_state.matches+idx,0,bytes_per_item);
-               if (cheat_manager_state.num_matches > 0)
-                  cheat_manager_state.num_matches--;
-            }
-         }
-      }
-   }
+   if (cheat_manager_state.match_list)
+      cheat_manager_search_list(&search);
+   else
+      cheat_manager_search_bits(&search);
 
-   offset = 0;
+   cheat_manager_compact_matches();
 
    for (i = 0; i < cheat_manager_state.num_memory_buffers; i++)
    {
@@ -1106,78 +1563,39 @@ int cheat_manager_add_matches(const char *path,
       const char *label, unsigned type, size_t menuidx, size_t entry_idx)
 {
    char msg[100];
+   struct cheat_search search;
    bool refresh                = false;
-   unsigned byte_part          = 0;
-   unsigned int idx            = 0;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
-   unsigned int curr_val       = 0;
-   unsigned int num_added      = 0;
-   unsigned int offset         = 0;
-   unsigned char *curr         = cheat_manager_state.curr_memory_buf;
+   unsigned int i              = 0;
+   unsigned int words          = (cheat_manager_state.num_match_items + 31) / 32;
 
    if (cheat_manager_state.num_matches + cheat_manager_state.size > 100)
    {
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_TOO_MANY), 1, 180, true);
       return 0;
    }
-   cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits);
 
-   for (idx = 0; idx < cheat_manager_state.total_memory_size; idx = idx + bytes_per_item)
+   cheat_manager_setup_search(&search, CHEAT_SEARCH_TYPE_EXACT);
+
+   for (i = 0; i < words && cheat_manager_state.match_bits; i++)
    {
-      offset = translate_address(idx, &curr);
+      uint32_t bits = cheat_manager_state.match_bits[i];
 
-      switch (bytes_per_item)
+      while (bits)
       {
-         case 2 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx-offset)*256) + *(curr+idx+1-offset) :
-                  *(curr+idx-offset) + (*(curr+idx+1-offset)*256);
-            break;
-         case 4 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx-offset)*256*256*256) + (*(curr+idx+1-offset)*256*256) + (*(curr+idx+2-offset)*256) + *(curr+idx+3-offset) :
-                  *(curr+idx-offset) + (*(curr+idx+1-offset)*256) + (*(curr+idx+2-offset)*256*256) + (*(curr+idx+3-offset)*256*256*256);
-            break;
-         case 1 :
-         default :
-            curr_val = *(curr-offset+idx);
-            break;
-      }
-      for (byte_part = 0; byte_part < 8/bits; byte_part++)
-      {
-         unsigned int prev_match;
+         unsigned address_mask;
+         unsigned item     = i * 32 + cheat_manager_popcount((bits & (~bits + 1)) - 1);
+         unsigned address  = cheat_manager_item_address(&search, item, &address_mask);
+         unsigned curr_val = cheat_manager_read_item(NULL, address,
+               search.bytes, search.big_endian);
 
-         if (bits < 8)
-         {
-            prev_match = *(cheat_manager_state.matches+idx) & (mask << (byte_part*bits));
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, (mask << (byte_part*bits)),
-                     cheat_manager_state.big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true);
-                  return 0;
-               }
-               num_added++;
-            }
-         }
-         else
+         bits &= bits - 1;
+
+         if (!cheat_manager_add_new_code(cheat_manager_state.match_bit_size, address, address_mask,
+                  cheat_manager_state.big_endian, curr_val))
          {
-            prev_match = *(cheat_manager_state.matches+idx);
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, 0xFF,
-                     cheat_manager_state.big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true);
-                  return 0;
-               }
-               num_added++;
-            }
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true);
+            return 0;
          }
-
       }
    }
 
@@ -1275,205 +1693,283 @@ void cheat_manager_apply_rumble(struct item_cheat *cheat, unsigned int curr_valu
       input_driver_set_rumble_state(cheat->rumble_port, RETRO_RUMBLE_WEAK, cheat->rumble_secondary_strength);
 }
 
+/* Active RetroArch-handled cheats are compiled into patches, with
+ * every address already resolved to a pointer, so applying them
+ * each frame only has to read and write memory. The list is rebuilt
+ * when the cheats or the memory maps change. */
+struct cheat_patch_write
+{
+   uint8_t *ptr;
+   uint8_t mask;
+   uint8_t value;
+   uint8_t shift;
+};
+
+struct cheat_patch
+{
+   uint8_t *read[4];
+   unsigned cheat;
+   unsigned cheat_type;
+   unsigned value;
+   unsigned add;
+   unsigned mod;
+   unsigned bytes;
+   unsigned first_write;
+   unsigned num_writes;
+   bool big_endian;
+   bool reads;
+};
+
+static uint8_t *cheat_manager_resolve_address(unsigned address)
+{
+   unsigned offset;
+   unsigned char *curr = NULL;
+
+   if (address >= cheat_manager_state.total_memory_size)
+      return NULL;
+
+   offset = translate_address(address, &curr);
+   return curr + address - offset;
+}
+
+static bool cheat_manager_compile_patches(void)
+{
+   unsigned i, j;
+   unsigned num_patches = 0;
+   unsigned num_writes  = 0;
+
+   for (i = 0; i < cheat_manager_state.size; i++)
+   {
+      struct item_cheat *cheat = &cheat_manager_state.cheats[i];
+
+      if (cheat->handler != CHEAT_HANDLER_TYPE_RETRO || !cheat->state)
+         continue;
+
+      num_patches++;
+      num_writes += cheat->repeat_count * 4;
+   }
+
+   free(cheat_manager_state.patches);
+   free(cheat_manager_state.patch_writes);
+   cheat_manager_state.patches      = NULL;
+   cheat_manager_state.patch_writes = NULL;
+   cheat_manager_state.num_patches  = 0;
+
+   if (!num_patches)
+      return true;
+
+   cheat_manager_state.patches      = (struct cheat_patch*)
+      calloc(num_patches, sizeof(*cheat_manager_state.patches));
+   cheat_manager_state.patch_writes = (struct cheat_patch_write*)
+      calloc(MAX(num_writes, 1), sizeof(*cheat_manager_state.patch_writes));
+
+   if (!cheat_manager_state.patches || !cheat_manager_state.patch_writes)
+      return false;
+
+   num_writes = 0;
+
+   for (i = 0; i < cheat_manager_state.size; i++)
+   {
+      unsigned repeat_iter;
+      struct item_cheat *cheat   = &cheat_manager_state.cheats[i];
+      struct cheat_patch *patch  = &cheat_manager_state.patches[cheat_manager_state.num_patches];
+      unsigned int mask          = 0;
+      unsigned int bytes         = 1;
+      unsigned int bits          = 8;
+      unsigned int idx           = cheat->address;
+      unsigned int address_mask  = cheat->address_mask;
+      unsigned int value_to_set  = cheat->value;
+
+      if (cheat->handler != CHEAT_HANDLER_TYPE_RETRO || !cheat->state)
+         continue;
+
+      cheat_manager_setup_search_meta(cheat->memory_search_size, &bytes, &mask, &bits);
+
+      patch->cheat       = i;
+      patch->cheat_type  = cheat->cheat_type;
+      patch->value       = cheat->value;
+      patch->add         = cheat->repeat_add_to_value;
+      patch->mod         = mask;
+      patch->bytes       = bytes;
+      patch->big_endian  = cheat_manager_state.big_endian;
+      patch->reads       = cheat->cheat_type != CHEAT_TYPE_SET_TO_VALUE
+         || cheat->rumble_type != RUMBLE_TYPE_DISABLED;
+      patch->first_write = num_writes;
+
+      cheat_manager_state.num_patches++;
+
+      for (j = 0; j < bytes; j++)
+         patch->read[j] = cheat_manager_resolve_address(idx + j);
+
+      if (     cheat->cheat_type != CHEAT_TYPE_SET_TO_VALUE
+            && cheat->cheat_type != CHEAT_TYPE_INCREASE_VALUE
+            && cheat->cheat_type != CHEAT_TYPE_DECREASE_VALUE)
+         continue;
+
+      for (repeat_iter = 0; repeat_iter < cheat->repeat_count && mask; repeat_iter++)
+      {
+         for (j = 0; j < bytes; j++)
+         {
+            struct cheat_patch_write *write = &cheat_manager_state.patch_writes[num_writes + j];
+
+            write->ptr   = cheat_manager_resolve_address(idx + j);
+            write->shift = cheat->big_endian ? (bytes - 1 - j) * 8 : j * 8;
+            write->mask  = bits < 8 ? (address_mask & 0xFF) : 0xFF;
+
+            /* Values the cheat sets regardless of memory are final */
+            write->value = (value_to_set >> write->shift) & write->mask;
+         }
+
+         num_writes        += bytes;
+         patch->num_writes += bytes;
+
+         value_to_set += cheat->repeat_add_to_value;
+         value_to_set  = value_to_set % mask;
+
+         if (bits < 8)
+         {
+            unsigned int bit_iter;
+            for (bit_iter = 0; bit_iter < cheat->repeat_add_to_address; bit_iter++)
+            {
+               address_mask = (address_mask << bits) & 0xFF;
+               if (address_mask == 0)
+               {
+                  address_mask = mask;
+                  idx++;
+               }
+            }
+         }
+         else
+            idx += cheat->repeat_add_to_address * bytes;
+
+         idx = idx % cheat_manager_state.total_memory_size;
+      }
+   }
+
+   return true;
+}
+
+static unsigned cheat_manager_read_patch(const struct cheat_patch *patch)
+{
+   unsigned j;
+   unsigned int curr_val = 0;
+
+   for (j = 0; j < patch->bytes; j++)
+   {
+      unsigned int byte = patch->read[j] ? *patch->read[j] : 0;
+
+      if (patch->big_endian)
+         curr_val = (curr_val << 8) | byte;
+      else
+         curr_val |= byte << (j * 8);
+   }
+
+   return curr_val;
+}
+
 void cheat_manager_apply_retro_cheats(void)
 {
-   unsigned i;
-   unsigned int offset;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
-   unsigned int curr_val       = 0;
+   unsigned i, j;
    bool run_cheat              = true;
 
    if ((!cheat_manager_state.cheats))
       return;
 
-   for (i = 0; i < cheat_manager_state.size; i++)
+   if (     cheat_manager_state.patches_valid
+         && cheat_manager_state.patches_big_endian != cheat_manager_state.big_endian)
+      cheat_manager_state.patches_valid = false;
+
+   if (!cheat_manager_state.patches_valid)
    {
-      unsigned char *curr;
-      unsigned int    idx;
-      bool set_value            = false;
-      unsigned int value_to_set = 0;
-      unsigned int repeat_iter  = 0;
-      unsigned int address_mask = cheat_manager_state.cheats[i].address_mask;
-
-      if (cheat_manager_state.cheats[i].handler != CHEAT_HANDLER_TYPE_RETRO || !cheat_manager_state.cheats[i].state)
-         continue;
-      if (!cheat_manager_state.memory_initialized)
+      for (i = 0; i < cheat_manager_state.size; i++)
+         if (cheat_manager_state.cheats[i].handler == CHEAT_HANDLER_TYPE_RETRO && cheat_manager_state.cheats[i].state)
+            break;
+
+      if (i < cheat_manager_state.size && !cheat_manager_state.memory_initialized)
          cheat_manager_initialize_memory(NULL, false);
 
       /* If we're still not initialized, something 
        * must have gone wrong - just bail */
-      if (!cheat_manager_state.memory_initialized)
+      if (i < cheat_manager_state.size && !cheat_manager_state.memory_initialized)
+         return;
+
+      if (!cheat_manager_compile_patches())
          return;
 
+      cheat_manager_state.patches_valid      = true;
+      cheat_manager_state.patches_big_endian = cheat_manager_state.big_endian;
+   }
+
+   for (i = 0; i < cheat_manager_state.num_patches; i++)
+   {
+      const struct cheat_patch *patch        = &cheat_manager_state.patches[i];
+      const struct cheat_patch_write *writes = &cheat_manager_state.patch_writes[patch->first_write];
+      unsigned int curr_val                  = 0;
+      unsigned int value_to_set              = 0;
+
       if (!run_cheat)
       {
          run_cheat = true;
          continue;
       }
-      cheat_manager_setup_search_meta(cheat_manager_state.cheats[i].memory_search_size, &bytes_per_item, &mask, &bits);
-      
-      curr = cheat_manager_state.curr_memory_buf;
-      idx  = cheat_manager_state.cheats[i].address;
 
-      offset = translate_address(idx, &curr);
-
-      switch (bytes_per_item)
+      if (patch->reads)
       {
-         case 2 :
-            curr_val = cheat_manager_state.big_endian ?
-               (*(curr+idx-offset)*256) + *(curr+idx+1-offset) :
-               *(curr+idx-offset) + (*(curr+idx+1-offset)*256);
-            break;
-         case 4 :
-            curr_val = cheat_manager_state.big_endian ?
-               (*(curr+idx-offset)*256*256*256) + (*(curr+idx+1-offset)*256*256) + (*(curr+idx+2-offset)*256) + *(curr+idx+3-offset) :
-               *(curr+idx-offset) + (*(curr+idx+1-offset)*256) + (*(curr+idx+2-offset)*256*256) + (*(curr+idx+3-offset)*256*256*256);
-            break;
-         case 1 :
-         default :
-            curr_val = *(curr+idx-offset);
-            break;
+         curr_val = cheat_manager_read_patch(patch);
+         cheat_manager_apply_rumble(&cheat_manager_state.cheats[patch->cheat], curr_val);
       }
 
-      cheat_manager_apply_rumble(&cheat_manager_state.cheats[i], curr_val);
-
-      switch (cheat_manager_state.cheats[i].cheat_type)
+      switch (patch->cheat_type)
       {
          case CHEAT_TYPE_SET_TO_VALUE :
-            set_value = true;
-            value_to_set = cheat_manager_state.cheats[i].value;
+            for (j = 0; j < patch->num_writes; j++)
+               if (writes[j].ptr)
+                  *writes[j].ptr = (*writes[j].ptr & ~writes[j].mask) | writes[j].value;
             break;
          case CHEAT_TYPE_INCREASE_VALUE:
-            set_value = true;
-            value_to_set = curr_val + cheat_manager_state.cheats[i].value;
-            break;
          case CHEAT_TYPE_DECREASE_VALUE:
-            set_value = true;
-            value_to_set = curr_val - cheat_manager_state.cheats[i].value;
+            value_to_set = patch->cheat_type == CHEAT_TYPE_INCREASE_VALUE ?
+               curr_val + patch->value : curr_val - patch->value;
+
+            for (j = 0; j < patch->num_writes; j++)
+            {
+               if (writes[j].ptr)
+                  *writes[j].ptr = (*writes[j].ptr & ~writes[j].mask) |
+                     ((value_to_set >> writes[j].shift) & writes[j].mask);
+
+               if ((j + 1) % patch->bytes == 0)
+                  value_to_set = (value_to_set + patch->add) % patch->mod;
+            }
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_EQ:
-            if (!(curr_val == cheat_manager_state.cheats[i].value))
+            if (!(curr_val == patch->value))
                run_cheat = false;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_NEQ:
-            if (!(curr_val != cheat_manager_state.cheats[i].value))
+            if (!(curr_val != patch->value))
                run_cheat = false;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_LT:
-            if (!(cheat_manager_state.cheats[i].value <  curr_val))
+            if (!(patch->value <  curr_val))
                run_cheat = false;
             break;
          case CHEAT_TYPE_RUN_NEXT_IF_GT:
-            if (!(cheat_manager_state.cheats[i].value > curr_val))
+            if (!(patch->value > curr_val))
                run_cheat = false;
             break;
-
-      }
-      if (set_value)
-      {
-         for (repeat_iter = 1; repeat_iter <= cheat_manager_state.cheats[i].repeat_count; repeat_iter++)
-         {
-            switch (bytes_per_item)
-            {
-               case 2 :
-                  if  (cheat_manager_state.cheats[i].big_endian)
-                  {
-                     *(curr+idx-offset)   = (value_to_set >> 8) & 0xFF;
-                     *(curr+idx+1-offset) =  value_to_set & 0xFF;
-                  }
-                  else
-                  {
-                     *(curr+idx-offset)   =  value_to_set & 0xFF;
-                     *(curr+idx+1-offset) = (value_to_set >> 8) & 0xFF;
-
-                  }
-                  break;
-               case 4 :
-                  if  (cheat_manager_state.cheats[i].big_endian)
-                  {
-                     *(curr+idx-offset)   = (value_to_set >> 24) & 0xFF;
-                     *(curr+idx+1-offset) = (value_to_set >> 16) & 0xFF;
-                     *(curr+idx+2-offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr+idx+3-offset) =  value_to_set & 0xFF;
-                  }
-                  else
-                  {
-                     *(curr+idx-offset)   =  value_to_set & 0xFF;
-                     *(curr+idx+1-offset) = (value_to_set >> 8) & 0xFF;
-                     *(curr+idx+2-offset) = (value_to_set >> 16) & 0xFF;
-                     *(curr+idx+3-offset) = (value_to_set >> 24) & 0xFF;
-
-                  }
-                  break;
-               case 1 :
-                  if (bits < 8)
-                  {
-                     unsigned bitpos;
-                     unsigned char val = *(curr+idx-offset);
-
-                     for (bitpos = 0; bitpos < 8; bitpos++)
-                     {
-                        if ((address_mask>>bitpos)&0x01)
-                        {
-                           mask = (~(1<<bitpos)&0xFF);
-                           /* Clear current bit value */
-                           val = val & mask;
-                           /* Inject cheat bit value */
-                           val = val | (((value_to_set>>bitpos)&0x01)<<bitpos);
-                        }
-                     }
-                     *(curr+idx-offset) = val;
-                  }
-                  else
-                     *(curr+idx-offset)   =  value_to_set & 0xFF;
-                  break;
-               default :
-                  *(curr+idx-offset)   =  value_to_set & 0xFF;
-                  break;
-            }
-            value_to_set += cheat_manager_state.cheats[i].repeat_add_to_value;
-            value_to_set = value_to_set%mask;
-
-            if (bits < 8)
-            {
-               unsigned int bit_iter;
-               for (bit_iter = 0; bit_iter < cheat_manager_state.cheats[i].repeat_add_to_address; bit_iter++)
-               {
-                  address_mask = (address_mask<<mask)&0xFF;
-                  if (address_mask == 0)
-                  {
-                     address_mask = mask;
-                     idx++;
-                  }
-               }
-            }
-            else
-               idx += (cheat_manager_state.cheats[i].repeat_add_to_address*bytes_per_item);
-
-            idx = idx%cheat_manager_state.total_memory_size;
-
-            offset = translate_address(idx, &curr);
-         }
       }
    }
 }
 void cheat_manager_match_action(enum cheat_match_action_type match_action, unsigned int target_match_idx, unsigned int *address, unsigned int *address_mask,
       unsigned int *prev_value, unsigned int *curr_value)
 {
-   unsigned int byte_part;
-   unsigned int idx;
-   unsigned int start_idx;
-   unsigned int mask           = 0;
-   unsigned int bytes_per_item = 1;
-   unsigned int bits           = 8;
+   struct cheat_search search;
+   unsigned int item;
+   unsigned int match_address;
+   unsigned int match_mask;
    unsigned int curr_val       = 0;
    unsigned int prev_val       = 0;
-   unsigned int offset         = 0;
-   unsigned char *curr         = cheat_manager_state.curr_memory_buf;
    unsigned char *prev         = cheat_manager_state.prev_memory_buf;
-   unsigned int curr_match_idx = 0;
 
    if (target_match_idx > cheat_manager_state.num_matches-1)
       return;
@@ -1481,140 +1977,59 @@ void cheat_manager_match_action(enum cheat_match_action_type match_action, unsig
    if (cheat_manager_state.num_memory_buffers == 0)
       return;
 
-   cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits);
-
    if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      start_idx = *address;
-   else
-      start_idx = 0;
-
-   for (idx = start_idx; idx < cheat_manager_state.total_memory_size; idx = idx + bytes_per_item)
    {
-      offset = translate_address(idx, &curr);
+      unsigned int mask           = 0;
+      unsigned int bytes_per_item = 1;
+      unsigned int bits           = 8;
 
-      switch (bytes_per_item)
-      {
-         case 2 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx-offset)*256) + *(curr+idx+1-offset) :
-                  *(curr+idx-offset) + (*(curr+idx+1-offset)*256);
-            if (prev)
-               prev_val = cheat_manager_state.big_endian ?
-                     (*(prev+idx)*256) + *(prev+idx+1) :
-                     *(prev+idx) + (*(prev+idx+1)*256);
-            break;
-         case 4 :
-            curr_val = cheat_manager_state.big_endian ?
-                  (*(curr+idx-offset)*256*256*256) + (*(curr+idx+1-offset)*256*256) + (*(curr+idx+2-offset)*256) + *(curr+idx+3-offset) :
-                  *(curr+idx-offset) + (*(curr+idx+1-offset)*256) + (*(curr+idx+2-offset)*256*256) + (*(curr+idx+3-offset)*256*256*256);
-            if (prev)
-               prev_val = cheat_manager_state.big_endian ?
-                     (*(prev+idx)*256*256*256) + (*(prev+idx+1)*256*256) + (*(prev+idx+2)*256) + *(prev+idx+3) :
-                     *(prev+idx) + (*(prev+idx+1)*256) + (*(prev+idx+2)*256*256) + (*(prev+idx+3)*256*256*256);
-            break;
-         case 1 :
-         default :
-            curr_val = *(curr+idx-offset);
-            if (prev)
-               prev_val = *(prev+idx);
-            break;
-      }
-
-      if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      {
-         *curr_value = curr_val;
-         *prev_value = prev_val;
+      if (*address >= cheat_manager_state.total_memory_size)
          return;
-      }
 
-      if (!prev)
-         return;
+      cheat_manager_setup_search_meta(cheat_manager_state.search_bit_size, &bytes_per_item, &mask, &bits);
 
-      for (byte_part = 0; byte_part < 8/bits; byte_part++)
-      {
-         unsigned int prev_match;
+      *curr_value = cheat_manager_read_item(NULL, *address,
+            bytes_per_item, cheat_manager_state.big_endian);
+      *prev_value = prev ? cheat_manager_read_item(prev, *address,
+            bytes_per_item, cheat_manager_state.big_endian) : 0;
+      return;
+   }
 
-         if (bits < 8)
-         {
-            prev_match = *(cheat_manager_state.matches+idx) & (mask << (byte_part*bits));
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                     case CHEAT_MATCH_ACTION_TYPE_BROWSE :
-                        return;
-                     case CHEAT_MATCH_ACTION_TYPE_VIEW :
-                        *address      = idx;
-                        *address_mask = (mask << (byte_part*bits));
-                        *curr_value   = curr_val;
-                        *prev_value   = prev_val;
-                        return;
-                     case CHEAT_MATCH_ACTION_TYPE_COPY :
-                        if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, (mask << (byte_part*bits)),
-                                 cheat_manager_state.big_endian, curr_val))
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true);
-                        else
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true);
-                        return;
-                     case CHEAT_MATCH_ACTION_TYPE_DELETE :
-                        if (bits < 8)
-                           *(cheat_manager_state.matches+idx) = *(cheat_manager_state.matches+idx) &
-                              (( ~(mask << (byte_part*bits))) & 0xFF);
-                        else
-                           memset(cheat_manager_state.matches+idx,0,bytes_per_item);
-                        if (cheat_manager_state.num_matches > 0)
-                           cheat_manager_state.num_matches--;
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true);
-                        return;
-                  }
-                  return;
-               }
-               curr_match_idx++;
-            }
-         }
-         else
-         {
-            prev_match = *(cheat_manager_state.matches+idx);
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                     case CHEAT_MATCH_ACTION_TYPE_BROWSE :
-                        return;
-                     case CHEAT_MATCH_ACTION_TYPE_VIEW :
-                        *address = idx;
-                        *address_mask = 0xFF;
-                        *curr_value = curr_val;
-                        *prev_value = prev_val;
-                        return;
-                     case CHEAT_MATCH_ACTION_TYPE_COPY :
-                        if (!cheat_manager_add_new_code(cheat_manager_state.search_bit_size, idx, 0xFF,
-                                 cheat_manager_state.big_endian, curr_val))
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true);
-                        else
-                           runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true);
-                        return;
-                     case CHEAT_MATCH_ACTION_TYPE_DELETE :
-                        if (bits < 8)
-                           *(cheat_manager_state.matches+idx) = *(cheat_manager_state.matches+idx) &
-                              (( ~(mask << (byte_part*bits))) & 0xFF);
-                        else
-                           memset(cheat_manager_state.matches+idx,0,bytes_per_item);
-                        if (cheat_manager_state.num_matches > 0)
-                           cheat_manager_state.num_matches--;
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true);
-                        return;
-                  }
-               }
-               curr_match_idx++;
-            }
-         }
+   if (!prev || !cheat_manager_state.match_bits)
+      return;
 
-      }
+   if (!cheat_manager_find_match(target_match_idx, &item))
+      return;
+
+   cheat_manager_setup_search(&search, CHEAT_SEARCH_TYPE_EXACT);
+
+   match_address = cheat_manager_item_address(&search, item, &match_mask);
+   curr_val      = cheat_manager_read_item(NULL, match_address,
+         search.bytes, search.big_endian);
+   prev_val      = cheat_manager_read_item(prev, match_address,
+         search.bytes, search.big_endian);
+
+   switch (match_action)
+   {
+      case CHEAT_MATCH_ACTION_TYPE_BROWSE :
+         return;
+      case CHEAT_MATCH_ACTION_TYPE_VIEW :
+         *address      = match_address;
+         *address_mask = match_mask;
+         *curr_value   = curr_val;
+         *prev_value   = prev_val;
+         return;
+      case CHEAT_MATCH_ACTION_TYPE_COPY :
+         if (!cheat_manager_add_new_code(cheat_manager_state.match_bit_size, match_address, match_mask,
+                  cheat_manager_state.big_endian, curr_val))
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true);
+         else
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true);
+         return;
+      case CHEAT_MATCH_ACTION_TYPE_DELETE :
+         cheat_manager_remove_match(target_match_idx, item);
+         runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true);
+         return;
    }
 }
 int cheat_manager_copy_match(rarch_setting_t *setting, bool wraparound)
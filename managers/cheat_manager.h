@@ -161,7 +161,10 @@ struct cheat_manager
    unsigned total_memory_size ;
    uint8_t *curr_memory_buf ;
    uint8_t *prev_memory_buf ;
-   uint8_t *matches ;
+   uint32_t *match_bits ;
+   unsigned *match_list ;
+   unsigned num_match_items ;
+   unsigned match_bit_size ;
    uint8_t **memory_buf_list ;
    unsigned *memory_size_list ;
    unsigned num_memory_buffers ;
@@ -183,6 +186,12 @@ struct cheat_manager
    char working_code[CHEAT_CODE_SCRATCH_SIZE] ;
    unsigned int loading_cheat_size;
    unsigned int loading_cheat_offset;
+   /* Active RetroArch-handled cheats with resolved addresses */
+   struct cheat_patch *patches;
+   struct cheat_patch_write *patch_writes;
+   unsigned num_patches;
+   bool patches_valid;
+   bool patches_big_endian;
 };
 
 typedef struct cheat_manager cheat_manager_t;
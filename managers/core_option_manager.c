@@ -33,6 +33,89 @@
 #include "../runahead/secondary_core.h"
 #endif
 
+static uint32_t core_option_manager_hash(const char *key)
+{
+   uint32_t hash = 5381;
+
+   while (*key)
+      hash = (hash << 5) + hash + (uint8_t)*key++;
+
+   return hash;
+}
+
+static bool core_option_manager_build_index(core_option_manager_t *opt)
+{
+   size_t i;
+   size_t cap = 16;
+
+   while (cap < opt->size * 2)
+      cap *= 2;
+
+   opt->index = (size_t*)calloc(cap, sizeof(*opt->index));
+   if (!opt->index)
+      return false;
+
+   opt->index_cap = cap;
+
+   for (i = 0; i < opt->size; i++)
+   {
+      size_t slot;
+      struct core_option *option = &opt->opts[i];
+
+      if (string_is_empty(option->key))
+         continue;
+
+      option->key_hash = core_option_manager_hash(option->key);
+
+      /* The first option declared with a key wins, as it did
+       * with the linear search */
+      for (slot = option->key_hash & (cap - 1); opt->index[slot];
+            slot = (slot + 1) & (cap - 1))
+      {
+         const struct core_option *other = &opt->opts[opt->index[slot] - 1];
+
+         if (other->key_hash == option->key_hash
+               && string_is_equal(other->key, option->key))
+            break;
+      }
+
+      if (!opt->index[slot])
+         opt->index[slot] = i + 1;
+   }
+
+   return true;
+}
+
+static struct core_option *core_option_manager_find(
+      core_option_manager_t *opt, const char *key)
+{
+   size_t slot;
+   uint32_t hash;
+
+   if (!opt->index_cap || string_is_empty(key))
+      return NULL;
+
+   hash = core_option_manager_hash(key);
+
+   for (slot = hash & (opt->index_cap - 1); opt->index[slot];
+         slot = (slot + 1) & (opt->index_cap - 1))
+   {
+      struct core_option *option = &opt->opts[opt->index[slot] - 1];
+
+      if (option->key_hash == hash && string_is_equal(option->key, key))
+         return option;
+   }
+
+   return NULL;
+}
+
+/* Marks the value of option idx as changed */
+static void core_option_manager_touch(core_option_manager_t *opt, size_t idx)
+{
+   opt->opts[idx].generation = ++opt->generation;
+   opt->updated              = true;
+}
+
 static bool core_option_manager_parse_variable(
       core_option_manager_t *opt, size_t idx,
       const struct retro_variable *var)
@@ -120,13 +203,14 @@ void core_option_manager_free(core_option_manager_t *opt)
 
    if (opt->conf)
       config_file_free(opt->conf);
+   free(opt->index);
    free(opt->opts);
    free(opt);
 }
 
 void core_option_manager_get(core_option_manager_t *opt, void *data)
 {
-   size_t i;
+   struct core_option *option = NULL;
    struct retro_variable *var = (struct retro_variable*)data;
 
    if (!opt)
@@ -141,21 +225,25 @@ void core_option_manager_get(core_option_manager_t *opt, void *data)
 
    opt->updated = false;
 
-   for (i = 0; i < opt->size; i++)
-   {
-      if (string_is_empty(opt->opts[i].key))
-         continue;
+   option       = core_option_manager_find(opt, var->key);
 
-      if (string_is_equal(opt->opts[i].key, var->key))
-      {
-         var->value = core_option_manager_get_val(opt, i);
-         return;
-      }
+   if (!option)
+   {
+      RARCH_LOG("Environ GET_VARIABLE %s: not found\n", var->key);
+      var->value = NULL;
+      return;
    }
 
-   var->value = NULL;
-}
+   var->value = option->vals->elems[option->index].data;
 
+   /* Cores polling their options every frame would flood the
+    * log, only report values the core hasn't seen yet */
+   if (option->fetched != option->generation)
+   {
+      option->fetched = option->generation;
+      RARCH_LOG("Environ GET_VARIABLE %s: %s\n", var->key, var->value);
+   }
+}
 
 /**
  * core_option_manager_new:
@@ -205,8 +293,14 @@ core_option_manager_t *core_option_manager_new(const char *conf_path,
    {
       if (!core_option_manager_parse_variable(opt, size, var))
          goto error;
+
+      /* Reported to the core once, even if never changed */
+      opt->opts[size].generation = 1;
    }
 
+   if (!core_option_manager_build_index(opt))
+      goto error;
+
    return opt;
 
 error:
@@ -342,7 +436,7 @@ void core_option_manager_set_val(core_option_manager_t *opt,
    option        = (struct core_option*)&opt->opts[idx];
    option->index = val_idx % option->vals->size;
 
-   opt->updated  = true;
+   core_option_manager_touch(opt, idx);
 }
 
 /**
@@ -363,7 +457,7 @@ void core_option_manager_next(core_option_manager_t *opt, size_t idx)
    option        = (struct core_option*)&opt->opts[idx];
 
    option->index = (option->index + 1) % option->vals->size;
-   opt->updated  = true;
+   core_option_manager_touch(opt, idx);
 }
 
 /**
@@ -386,7 +480,7 @@ void core_option_manager_prev(core_option_manager_t *opt, size_t idx)
    option->index = (option->index + option->vals->size - 1) %
       option->vals->size;
 
-   opt->updated  = true;
+   core_option_manager_touch(opt, idx);
 }
 
 /**
@@ -402,5 +496,5 @@ void core_option_manager_set_default(core_option_manager_t *opt, size_t idx)
       return;
 
    opt->opts[idx].index = 0;
-   opt->updated         = true;
+   core_option_manager_touch(opt, idx);
 }
@@ -18,6 +18,7 @@
 #define CORE_OPTION_MANAGER_H__
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <boolean.h>
 #include <retro_common_api.h>
@@ -31,6 +32,11 @@ struct core_option
   char *key;
   struct string_list *vals;
   size_t index;
+  uint32_t key_hash;
+  /* opt->generation when the value last changed,
+   * and when the core last fetched it */
+  unsigned generation;
+  unsigned fetched;
 };
 
 struct core_option_manager
@@ -41,6 +47,12 @@ struct core_option_manager
   struct core_option *opts;
   size_t size;
   bool updated;
+
+  /* Open addressed key index, slots hold option index + 1 */
+  size_t *index;
+  size_t index_cap;
+  /* Bumped on every value change */
+  unsigned generation;
 };
 
 typedef struct core_option_manager core_option_manager_t;
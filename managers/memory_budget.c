@@ -0,0 +1,276 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_CONFIG_H
+#include "../config.h"
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "memory_budget.h"
+#include "../frontend/frontend_driver.h"
+#include "../verbosity.h"
+
+/* An eighth of the system memory, within these bounds. Used as is
+ * when the frontend driver can't tell how much there is. */
+#define MEMORY_BUDGET_MIN          (16  * 1024 * 1024)
+#define MEMORY_BUDGET_MAX          (512 * 1024 * 1024)
+#define MEMORY_BUDGET_DEFAULT      (128 * 1024 * 1024)
+/* Memory queries read /proc on some platforms, once a second is
+ * plenty to notice pressure building up. */
+#define MEMORY_BUDGET_QUERY_USEC   1000000
+
+typedef struct memory_budget_cache
+{
+   const char *name;
+   memory_budget_evict_t evict;
+   void *userdata;
+   size_t size;
+} memory_budget_cache_t;
+
+static memory_budget_cache_t memory_budget_caches[MEMORY_BUDGET_MAX_CACHES];
+static memory_budget_stats_t memory_budget_state;
+static retro_time_t memory_budget_next_query = 0;
+/* Set when an update takes the total over the budget, so the next
+ * iteration evicts without waiting for the next query. */
+static bool memory_budget_over               = false;
+
+#ifdef HAVE_THREADS
+/* Caches filled from the video thread or tasks report from there */
+static slock_t *memory_budget_lock           = NULL;
+#endif
+
+static void memory_budget_lock_acquire(void)
+{
+#ifdef HAVE_THREADS
+   if (memory_budget_lock)
+      slock_lock(memory_budget_lock);
+#endif
+}
+
+static void memory_budget_lock_release(void)
+{
+#ifdef HAVE_THREADS
+   if (memory_budget_lock)
+      slock_unlock(memory_budget_lock);
+#endif
+}
+
+static size_t memory_budget_used(void)
+{
+   unsigned i;
+   size_t used = 0;
+
+   for (i = 0; i < MEMORY_BUDGET_MAX_CACHES; i++)
+      used += memory_budget_caches[i].size;
+
+   return used;
+}
+
+void memory_budget_init(void)
+{
+#ifdef HAVE_THREADS
+   if (!memory_budget_lock)
+      memory_budget_lock = slock_new();
+#endif
+
+   memory_budget_lock_acquire();
+   memory_budget_state.budget = MEMORY_BUDGET_DEFAULT;
+   memory_budget_next_query   = 0;
+   memory_budget_lock_release();
+}
+
+unsigned memory_budget_register(const char *name,
+      memory_budget_evict_t evict, void *userdata)
+{
+   unsigned i;
+   unsigned id = 0;
+
+   memory_budget_lock_acquire();
+
+   for (i = 0; i < MEMORY_BUDGET_MAX_CACHES; i++)
+   {
+      memory_budget_cache_t *cache = &memory_budget_caches[i];
+
+      if (cache->name)
+         continue;
+
+      cache->name     = name;
+      cache->evict    = evict;
+      cache->userdata = userdata;
+      cache->size     = 0;
+      id              = i + 1;
+      break;
+   }
+
+   memory_budget_lock_release();
+
+   if (!id)
+      RARCH_WARN("[Memory budget]: No slot left for \"%s\".\n", name);
+
+   return id;
+}
+
+void memory_budget_unregister(unsigned id)
+{
+   if (!id || id > MEMORY_BUDGET_MAX_CACHES)
+      return;
+
+   memory_budget_lock_acquire();
+   memset(&memory_budget_caches[id - 1], 0, sizeof(memory_budget_caches[0]));
+   memory_budget_lock_release();
+}
+
+void memory_budget_update(unsigned id, size_t size)
+{
+   if (!id || id > MEMORY_BUDGET_MAX_CACHES)
+      return;
+
+   memory_budget_lock_acquire();
+   memory_budget_caches[id - 1].size = size;
+   if (memory_budget_used() > memory_budget_state.budget)
+      memory_budget_over = true;
+   memory_budget_lock_release();
+}
+
+/* Below a sixteenth of the memory free, the caches are halved every
+ * query until the pressure goes away. */
+static size_t memory_budget_compute(uint64_t total, uint64_t free_mem,
+      size_t used)
+{
+   uint64_t budget = total / 8;
+
+   if (!total)
+      return MEMORY_BUDGET_DEFAULT;
+
+   if (budget < MEMORY_BUDGET_MIN)
+      budget = MEMORY_BUDGET_MIN;
+   if (budget > MEMORY_BUDGET_MAX)
+      budget = MEMORY_BUDGET_MAX;
+
+   if (free_mem < total / 16)
+      budget = MIN(budget, used / 2);
+
+   return (size_t)budget;
+}
+
+void memory_budget_iterate(void)
+{
+   unsigned i;
+   size_t used, budget;
+   memory_budget_cache_t caches[MEMORY_BUDGET_MAX_CACHES];
+   unsigned order[MEMORY_BUDGET_MAX_CACHES];
+   unsigned count     = 0;
+   retro_time_t now   = cpu_features_get_time_usec();
+   bool query         = now >= memory_budget_next_query;
+
+   if (!query && !memory_budget_over)
+      return;
+
+   if (query)
+   {
+      uint64_t total    = frontend_driver_get_total_memory();
+      uint64_t used_mem = frontend_driver_get_used_memory();
+      uint64_t free_mem = total > used_mem ? total - used_mem : 0;
+
+      memory_budget_next_query = now + MEMORY_BUDGET_QUERY_USEC;
+
+      memory_budget_lock_acquire();
+      memory_budget_state.total_memory = total;
+      memory_budget_state.free_memory  = free_mem;
+      memory_budget_state.budget       = memory_budget_compute(
+            total, free_mem, memory_budget_used());
+      memory_budget_lock_release();
+   }
+
+   memory_budget_lock_acquire();
+   memcpy(caches, memory_budget_caches, sizeof(caches));
+   budget             = memory_budget_state.budget;
+   memory_budget_over = false;
+   memory_budget_lock_release();
+
+   used = 0;
+   for (i = 0; i < MEMORY_BUDGET_MAX_CACHES; i++)
+      used += caches[i].size;
+
+   if (used <= budget)
+      return;
+
+   /* Largest first, there are only a handful */
+   for (i = 0; i < MEMORY_BUDGET_MAX_CACHES; i++)
+   {
+      unsigned j;
+
+      if (!caches[i].evict || !caches[i].size)
+         continue;
+
+      for (j = count; j > 0 && caches[order[j - 1]].size < caches[i].size; j--)
+         order[j] = order[j - 1];
+      order[j] = i;
+      count++;
+   }
+
+   /* The callbacks run unlocked, they report back through
+    * memory_budget_update() */
+   for (i = 0; i < count && used > budget; i++)
+   {
+      memory_budget_cache_t *cache = &caches[order[i]];
+      size_t freed = cache->evict(cache->userdata, used - budget);
+
+      if (!freed)
+         continue;
+
+      freed = MIN(freed, used);
+      used -= freed;
+
+      memory_budget_lock_acquire();
+      memory_budget_state.evicted += freed;
+      memory_budget_state.evictions++;
+      memory_budget_lock_release();
+
+      RARCH_LOG("[Memory budget]: %s gave back %u KiB.\n",
+            cache->name, (unsigned)(freed / 1024));
+   }
+}
+
+void memory_budget_get_stats(memory_budget_stats_t *stats)
+{
+   unsigned i;
+
+   memory_budget_lock_acquire();
+
+   *stats        = memory_budget_state;
+   stats->used   = 0;
+   stats->caches = 0;
+
+   for (i = 0; i < MEMORY_BUDGET_MAX_CACHES; i++)
+   {
+      if (!memory_budget_caches[i].name)
+         continue;
+
+      stats->cache[stats->caches].name = memory_budget_caches[i].name;
+      stats->cache[stats->caches].size = memory_budget_caches[i].size;
+      stats->used += memory_budget_caches[i].size;
+      stats->caches++;
+   }
+
+   memory_budget_lock_release();
+}
@@ -0,0 +1,85 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MEMORY_BUDGET_H
+#define __MEMORY_BUDGET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* One budget shared by the caches which only exist to save work,
+ * so they don't each take what they like and add up to more than a
+ * 512 MB device has. Caches report what they hold, and are asked to
+ * give some of it back, largest first, once the sum goes over the
+ * budget. The budget follows the memory the frontend driver reports,
+ * and shrinks when the system runs low. */
+
+#define MEMORY_BUDGET_MAX_CACHES 8
+
+/* Asked to free at least @want bytes, or as much as it can. Returns
+ * what was freed. Always called on the main thread, and the cache is
+ * expected to report its new size through memory_budget_update(). */
+typedef size_t (*memory_budget_evict_t)(void *userdata, size_t want);
+
+typedef struct memory_budget_stats
+{
+   /* As reported by the frontend driver, 0 if unknown */
+   uint64_t total_memory;
+   uint64_t free_memory;
+   size_t budget;
+   size_t used;
+   uint64_t evicted;
+   unsigned evictions;
+   unsigned caches;
+   struct
+   {
+      const char *name;
+      size_t size;
+   } cache[MEMORY_BUDGET_MAX_CACHES];
+} memory_budget_stats_t;
+
+/* Called once at startup, before any cache registers. */
+void memory_budget_init(void);
+
+/**
+ * memory_budget_register:
+ * @name                : short name shown in the statistics,
+ *                        must stay valid.
+ * @evict               : eviction callback, see memory_budget_evict_t.
+ * @userdata            : passed to @evict.
+ *
+ * Returns: an id for memory_budget_update(), 0 if all slots are taken.
+ **/
+unsigned memory_budget_register(const char *name,
+      memory_budget_evict_t evict, void *userdata);
+
+void memory_budget_unregister(unsigned id);
+
+/* Bytes now held by the cache @id, from any thread. */
+void memory_budget_update(unsigned id, size_t size);
+
+/* Checks the budget and evicts if over it. Called once per frame
+ * from the main loop. */
+void memory_budget_iterate(void);
+
+void memory_budget_get_stats(memory_budget_stats_t *stats);
+
+RETRO_END_DECLS
+
+#endif
@@ -0,0 +1,337 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+
+#include "state_delta.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
+#define STATE_DELTA_CPU_X86
+#endif
+
+/* Other arches SIGBUS (usually) on unaligned accesses. */
+#ifndef STATE_DELTA_CPU_X86
+#define STATE_DELTA_NO_UNALIGNED_MEM
+#endif
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* AVX2 is dispatched at runtime, so build it even when
+ * the rest of the frontend isn't compiled with -mavx2. */
+#if defined(__AVX2__)
+#define STATE_DELTA_AVX2
+#define STATE_DELTA_AVX2_TARGET
+#elif defined(STATE_DELTA_CPU_X86) && defined(__GNUC__) && \
+   (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define STATE_DELTA_AVX2
+#define STATE_DELTA_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef STATE_DELTA_AVX2
+#include <immintrin.h>
+#endif
+
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define STATE_DELTA_NEON
+#include <arm_neon.h>
+#endif
+
+/* There's no equivalent in libc, you'd think so ...
+ * std::mismatch exists, but it's not optimized at all. */
+static size_t state_delta_find_change_c(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+#ifdef STATE_DELTA_NO_UNALIGNED_MEM
+   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a == *b)
+#endif
+   {
+      const size_t *a_big = (const size_t*)a;
+      const size_t *b_big = (const size_t*)b;
+
+      while (*a_big == *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      while (*a == *b)
+      {
+         a++;
+         b++;
+      }
+   }
+   return a - a_org;
+}
+
+static size_t state_delta_find_same_c(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+#ifdef STATE_DELTA_NO_UNALIGNED_MEM
+   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a != *b)
+#endif
+   {
+      /* With this, it's random whether two consecutive identical
+       * words are caught.
+       *
+       * Luckily, compression rate is the same for both cases, and
+       * three is always caught.
+       *
+       * (We prefer to miss two-word blocks, anyways; fewer iterations
+       * of the outer loop, as well as in the decompressor.) */
+      const uint32_t *a_big = (const uint32_t*)a;
+      const uint32_t *b_big = (const uint32_t*)b;
+
+      while (*a_big != *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      if (a != a_org && a[-1] == b[-1])
+      {
+         a--;
+         b--;
+      }
+   }
+   return a - a_org;
+}
+
+#if __SSE2__
+static size_t state_delta_find_change_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask != 0xffff) /* Something has changed, figure out where. */
+      {
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
+               (compat_ctz(~mask))) >> 1;
+         return ret | (a[ret] == b[ret]);
+      }
+
+      a128++;
+      b128++;
+   }
+}
+#endif
+
+#ifdef STATE_DELTA_AVX2
+static STATE_DELTA_AVX2_TARGET size_t state_delta_find_change_avx2(
+      const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffffu)
+      {
+         size_t ret = (((const uint8_t*)a256 - (const uint8_t*)a) |
+               (size_t)__builtin_ctz(~mask)) >> 1;
+         return ret | (a[ret] == b[ret]);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+static STATE_DELTA_AVX2_TARGET size_t state_delta_find_same_avx2(
+      const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   /* Same rules as the C version: find the first identical
+    * 32-bit word, then step back one uint16 if that matches too.
+    * The first lane always contains a changed word, so this
+    * never returns 0. */
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask)
+      {
+         size_t ret = (((const uint8_t*)a256 - (const uint8_t*)a) +
+               (size_t)__builtin_ctz(mask)) >> 1;
+         return ret - (a[ret - 1] == b[ret - 1]);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+#endif
+
+#ifdef STATE_DELTA_NEON
+static size_t state_delta_find_change_neon(const uint16_t *a, const uint16_t *b)
+{
+   size_t i;
+   const uint8_t *a8 = (const uint8_t*)a;
+   const uint8_t *b8 = (const uint8_t*)b;
+
+   for (;;)
+   {
+      /* vld1q_u8 has no alignment requirement. */
+      uint32x4_t c = vceqq_u32(
+            vreinterpretq_u32_u8(vld1q_u8(a8)),
+            vreinterpretq_u32_u8(vld1q_u8(b8)));
+      uint32x2_t m = vand_u32(vget_low_u32(c), vget_high_u32(c));
+
+      if ((vget_lane_u32(m, 0) & vget_lane_u32(m, 1)) != 0xffffffffu)
+         break;
+
+      a8 += 16;
+      b8 += 16;
+   }
+
+   i = (a8 - (const uint8_t*)a) >> 1;
+   while (a[i] == b[i])
+      i++;
+   return i;
+}
+
+static size_t state_delta_find_same_neon(const uint16_t *a, const uint16_t *b)
+{
+   size_t i;
+   unsigned lane = 0;
+   uint32_t lanes[4];
+   const uint8_t *a8 = (const uint8_t*)a;
+   const uint8_t *b8 = (const uint8_t*)b;
+
+   for (;;)
+   {
+      uint32x4_t c = vceqq_u32(
+            vreinterpretq_u32_u8(vld1q_u8(a8)),
+            vreinterpretq_u32_u8(vld1q_u8(b8)));
+      uint32x2_t m = vorr_u32(vget_low_u32(c), vget_high_u32(c));
+
+      if (vget_lane_u32(m, 0) | vget_lane_u32(m, 1))
+      {
+         vst1q_u32(lanes, c);
+         break;
+      }
+
+      a8 += 16;
+      b8 += 16;
+   }
+
+   while (!lanes[lane])
+      lane++;
+
+   i = ((a8 - (const uint8_t*)a) >> 1) + lane * 2;
+   return i - (a[i - 1] == b[i - 1]);
+}
+#endif
+
+unsigned state_delta_kernels_list(uint64_t cpu,
+      state_delta_kernels_t *list, unsigned len)
+{
+   unsigned count = 0;
+
+#ifdef STATE_DELTA_AVX2
+   /* AVX2 needs the AVX check for OS support of the YMM state. */
+   if (count < len
+         && (cpu & RETRO_SIMD_AVX)
+         && (cpu & RETRO_SIMD_AVX2))
+   {
+      list[count].find_change = state_delta_find_change_avx2;
+      list[count].find_same   = state_delta_find_same_avx2;
+      list[count].ident       = "avx2";
+      count++;
+   }
+#endif
+
+#if __SSE2__
+   if (count < len)
+   {
+      list[count].find_change = state_delta_find_change_sse2;
+      list[count].find_same   = state_delta_find_same_c;
+      list[count].ident       = "sse2";
+      count++;
+   }
+#endif
+
+#ifdef STATE_DELTA_NEON
+   if (count < len && (cpu & RETRO_SIMD_NEON))
+   {
+      list[count].find_change = state_delta_find_change_neon;
+      list[count].find_same   = state_delta_find_same_neon;
+      list[count].ident       = "neon";
+      count++;
+   }
+#endif
+
+   if (count < len)
+   {
+      list[count].find_change = state_delta_find_change_c;
+      list[count].find_same   = state_delta_find_same_c;
+      list[count].ident       = "c";
+      count++;
+   }
+
+   (void)cpu;
+
+   return count;
+}
+
+const state_delta_kernels_t *state_delta_kernels_find(void)
+{
+   static state_delta_kernels_t kernels;
+
+   if (!kernels.find_change)
+      state_delta_kernels_list(cpu_features_get(), &kernels, 1);
+
+   return &kernels;
+}
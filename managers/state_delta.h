@@ -0,0 +1,67 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STATE_DELTA_H
+#define __STATE_DELTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Returns the offset (in uint16 units) of the first
+ * differing (find_change) or matching (find_same) word.
+ *
+ * Neither kernel checks bounds; the buffers must be terminated
+ * as described in state_manager_raw_alloc(), with at least
+ * STATE_DELTA_PADDING bytes of readable padding. */
+typedef size_t (*state_delta_scan_t)(const uint16_t *a, const uint16_t *b);
+
+/* Largest vector width used by any kernel, in bytes. */
+#define STATE_DELTA_PADDING 32
+
+typedef struct state_delta_kernels
+{
+   state_delta_scan_t find_change;
+   state_delta_scan_t find_same;
+   const char *ident;
+} state_delta_kernels_t;
+
+/**
+ * state_delta_kernels_list:
+ * @cpu                 : CPU feature mask, see cpu_features_get().
+ * @list                : filled with the kernels usable on @cpu,
+ *                        fastest first.
+ * @len                 : number of entries in @list.
+ *
+ * Returns: number of entries written to @list.
+ **/
+unsigned state_delta_kernels_list(uint64_t cpu,
+      state_delta_kernels_t *list, unsigned len);
+
+/**
+ * state_delta_kernels_find:
+ *
+ * Returns: the fastest delta kernels for the running CPU.
+ **/
+const state_delta_kernels_t *state_delta_kernels_find(void);
+
+RETRO_END_DECLS
+
+#endif
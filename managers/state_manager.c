@@ -24,13 +24,23 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
-#include <compat/intrinsics.h>
+#include <memalign.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "state_manager.h"
+#include "state_delta.h"
 #include "../msg_hash.h"
 #include "../movie.h"
 #include "../core.h"
+#include "../configuration.h"
 #include "../verbosity.h"
 #include "../audio/audio_driver.h"
 
@@ -50,115 +60,19 @@
 #define UINT32_MAX 0xffffffffu
 #endif
 
-#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__)
-#define CPU_X86
-#endif
-
-/* Other arches SIGBUS (usually) on unaligned accesses. */
-#ifndef CPU_X86
-#define NO_UNALIGNED_MEM
-#endif
-
-#if __SSE2__
-#include <emmintrin.h>
-#endif
-
-/* There's no equivalent in libc, you'd think so ...
- * std::mismatch exists, but it's not optimized at all. */
-static size_t find_change(const uint16_t *a, const uint16_t *b)
-{
-#if __SSE2__
-   const __m128i *a128 = (const __m128i*)a;
-   const __m128i *b128 = (const __m128i*)b;
-
-   for (;;)
-   {
-      __m128i v0    = _mm_loadu_si128(a128);
-      __m128i v1    = _mm_loadu_si128(b128);
-      __m128i c     = _mm_cmpeq_epi32(v0, v1);
-      uint32_t mask = _mm_movemask_epi8(c);
-
-      if (mask != 0xffff) /* Something has changed, figure out where. */
-      {
-         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
-               (compat_ctz(~mask))) >> 1;
-         return ret | (a[ret] == b[ret]);
-      }
-
-      a128++;
-      b128++;
-   }
-#else
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
-   {
-      a++;
-      b++;
-   }
-   if (*a == *b)
-#endif
-   {
-      const size_t *a_big = (const size_t*)a;
-      const size_t *b_big = (const size_t*)b;
-
-      while (*a_big == *b_big)
-      {
-         a_big++;
-         b_big++;
-      }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
-
-      while (*a == *b)
-      {
-         a++;
-         b++;
-      }
-   }
-   return a - a_org;
-#endif
-}
-
-static size_t find_same(const uint16_t *a, const uint16_t *b)
+/* Full copies of older states, taken every 'interval' pushes.
+ * Used as a ring; slot (first + i) % count holds the i-th oldest. */
+struct state_manager_keyframes
 {
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
-   {
-      a++;
-      b++;
-   }
-   if (*a != *b)
-#endif
-   {
-      /* With this, it's random whether two consecutive identical
-       * words are caught.
-       *
-       * Luckily, compression rate is the same for both cases, and
-       * three is always caught.
-       *
-       * (We prefer to miss two-word blocks, anyways; fewer iterations
-       * of the outer loop, as well as in the decompressor.) */
-      const uint32_t *a_big = (const uint32_t*)a;
-      const uint32_t *b_big = (const uint32_t*)b;
-
-      while (*a_big != *b_big)
-      {
-         a_big++;
-         b_big++;
-      }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
+   uint8_t *data;          /* RAM tier only, 'count' blocks. */
+   uint64_t *frames;
+   unsigned count;
+   unsigned first;
+   unsigned size;
+};
 
-      if (a != a_org && a[-1] == b[-1])
-      {
-         a--;
-         b--;
-      }
-   }
-   return a - a_org;
-}
+static state_delta_scan_t find_change = NULL;
+static state_delta_scan_t find_same   = NULL;
 
 struct state_manager
 {
@@ -182,6 +96,32 @@ struct state_manager
 
    unsigned entries;
    bool thisblock_valid;
+
+   /* Number of the state in 'thisblock', counted in pushes. */
+   uint64_t frame;
+
+   /* Long-horizon history: once the delta ring runs dry,
+    * rewinding continues one keyframe at a time, first from RAM,
+    * then from the ones spilled to disk. */
+   unsigned keyframe_interval;
+   struct state_manager_keyframes keyframes;
+   struct state_manager_keyframes spilled;
+   char spill_dir[PATH_MAX_LENGTH];
+#ifdef HAVE_THREADS
+   /* Threaded mode: the worker compresses 'job_old' against 'job_new'
+    * while the frame thread serializes the next state into a third
+    * block, so the frame thread never waits on compression unless
+    * the worker falls a full frame behind. */
+   uint8_t *spareblock;
+   const uint8_t *job_old;
+   const uint8_t *job_new;
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   unsigned job_dropped;
+   bool job_pending;
+   bool alive;
+#endif
 #if STRICT_BUF_SIZE
    size_t debugsize;
    uint8_t *debugblock;
@@ -239,7 +179,11 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
 static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)memalign_alloc_large(len16
+         + sizeof(uint16_t) * 4 + STATE_DELTA_PADDING);
+
+   if (!ret)
+      return NULL;
 
    /* Force in a different byte at the end, so we don't need to check
     * bounds in the innermost loop (it's expensive).
@@ -250,8 +194,8 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
+    * It doesn't make any difference to us, but sacrificing a vector's
+    * worth of bytes to get Valgrind happy is worth it. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
    return ret;
@@ -410,17 +354,268 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+static INLINE unsigned state_manager_keyframe_slot(
+      const struct state_manager_keyframes *kf, unsigned i)
+{
+   return (kf->first + i) % kf->count;
+}
+
+static void state_manager_spill_path(const state_manager_t *state,
+      unsigned slot, char *s, size_t len)
+{
+   char name[64];
+   snprintf(name, sizeof(name), "rewind_keyframe_%u.state", slot);
+   fill_pathname_join(s, state->spill_dir, name, len);
+}
+
+static bool state_manager_spill_write(const state_manager_t *state,
+      unsigned slot, const uint8_t *data)
+{
+   int64_t written;
+   RFILE *file = NULL;
+   char path[PATH_MAX_LENGTH];
+
+   state_manager_spill_path(state, slot, path, sizeof(path));
+
+   file = filestream_open(path, RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   written = filestream_write(file, data, state->blocksize);
+   filestream_close(file);
+
+   return written == (int64_t)state->blocksize;
+}
+
+static bool state_manager_spill_read(const state_manager_t *state,
+      unsigned slot, uint8_t *data)
+{
+   int64_t read;
+   RFILE *file = NULL;
+   char path[PATH_MAX_LENGTH];
+
+   state_manager_spill_path(state, slot, path, sizeof(path));
+
+   file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   read = filestream_read(file, data, state->blocksize);
+   filestream_close(file);
+
+   return read == (int64_t)state->blocksize;
+}
+
+/* Drops keyframes newer than 'frame'; after rewinding past them
+ * they belong to a timeline that no longer exists.
+ * Spilled keyframes are always older than the ones in RAM. */
+static void state_manager_keyframes_trim(state_manager_t *state,
+      uint64_t frame)
+{
+   struct state_manager_keyframes *kf = &state->keyframes;
+   struct state_manager_keyframes *sp = &state->spilled;
+
+   while (kf->size &&
+         kf->frames[state_manager_keyframe_slot(kf, kf->size - 1)] > frame)
+      kf->size--;
+
+   if (kf->size)
+      return;
+
+   while (sp->size &&
+         sp->frames[state_manager_keyframe_slot(sp, sp->size - 1)] > frame)
+      sp->size--;
+}
+
+static void state_manager_keyframes_push(state_manager_t *state,
+      const uint8_t *data)
+{
+   unsigned slot;
+   struct state_manager_keyframes *kf = &state->keyframes;
+   struct state_manager_keyframes *sp = &state->spilled;
+
+   if (kf->size == kf->count)
+   {
+      /* RAM tier is full, move the oldest keyframe to disk.
+       * This costs one write every 'keyframe_interval' pushes. */
+      if (sp->count)
+      {
+         if (sp->size == sp->count)
+         {
+            sp->first = (sp->first + 1) % sp->count;
+            sp->size--;
+         }
+
+         slot = state_manager_keyframe_slot(sp, sp->size);
+
+         if (state_manager_spill_write(state, slot,
+                  kf->data + kf->first * state->blocksize))
+         {
+            sp->frames[slot] = kf->frames[kf->first];
+            sp->size++;
+         }
+      }
+
+      kf->first = (kf->first + 1) % kf->count;
+      kf->size--;
+   }
+
+   slot             = state_manager_keyframe_slot(kf, kf->size);
+   memcpy(kf->data + slot * state->blocksize, data, state->blocksize);
+   kf->frames[slot] = state->frame;
+   kf->size++;
+}
+
+/* Loads the newest keyframe older than the current state into
+ * 'thisblock'. Each step back costs one copy (or one read from disk),
+ * no matter how far back the keyframe is. */
+static bool state_manager_pop_keyframe(state_manager_t *state,
+      const void **data)
+{
+   unsigned i;
+   struct state_manager_keyframes *kf = &state->keyframes;
+   struct state_manager_keyframes *sp = &state->spilled;
+
+   *data = state->thisblock;
+
+   state_manager_keyframes_trim(state, state->frame);
+
+   /* A keyframe of the current state itself is kept,
+    * but we want the one before it. */
+   for (i = kf->size; i-- > 0; )
+   {
+      unsigned slot = state_manager_keyframe_slot(kf, i);
+
+      if (kf->frames[slot] >= state->frame)
+         continue;
+
+      memcpy(state->thisblock,
+            kf->data + slot * state->blocksize, state->blocksize);
+      state->frame = kf->frames[slot];
+      return true;
+   }
+
+   for (i = sp->size; i-- > 0; )
+   {
+      unsigned slot = state_manager_keyframe_slot(sp, i);
+
+      if (sp->frames[slot] >= state->frame)
+         continue;
+
+      if (!state_manager_spill_read(state, slot, state->thisblock))
+      {
+         /* Everything older than an unreadable keyframe is lost. */
+         sp->size = 0;
+         return false;
+      }
+
+      state->frame = sp->frames[slot];
+      return true;
+   }
+
+   return false;
+}
+
+static void state_manager_free_keyframes(state_manager_t *state)
+{
+   unsigned i;
+   struct state_manager_keyframes *sp = &state->spilled;
+
+   /* Slots dropped by a trim still have their file around. */
+   for (i = 0; i < sp->count; i++)
+   {
+      char path[PATH_MAX_LENGTH];
+      state_manager_spill_path(state, i, path, sizeof(path));
+      filestream_delete(path);
+   }
+
+   if (state->keyframes.data)
+      memalign_free_large(state->keyframes.data);
+   if (state->keyframes.frames)
+      free(state->keyframes.frames);
+   if (sp->frames)
+      free(sp->frames);
+
+   memset(&state->keyframes, 0, sizeof(state->keyframes));
+   memset(sp, 0, sizeof(*sp));
+}
+
+static void state_manager_init_keyframes(state_manager_t *state,
+      unsigned interval, size_t buffer_size,
+      unsigned spill_count, const char *spill_dir)
+{
+   struct state_manager_keyframes *kf = &state->keyframes;
+   struct state_manager_keyframes *sp = &state->spilled;
+   unsigned count                     = (unsigned)
+      (buffer_size / state->blocksize);
+
+   if (!interval || !count)
+      return;
+
+   kf->data   = (uint8_t*)memalign_alloc_large(count * state->blocksize);
+   kf->frames = (uint64_t*)calloc(count, sizeof(*kf->frames));
+
+   if (!kf->data || !kf->frames)
+   {
+      state_manager_free_keyframes(state);
+      return;
+   }
+
+   kf->count                = count;
+   state->keyframe_interval = interval;
+
+   if (spill_count && !string_is_empty(spill_dir))
+   {
+      sp->frames = (uint64_t*)calloc(spill_count, sizeof(*sp->frames));
+      if (sp->frames)
+      {
+         sp->count = spill_count;
+         strlcpy(state->spill_dir, spill_dir, sizeof(state->spill_dir));
+      }
+   }
+
+   RARCH_LOG("[Rewind]: %u keyframes in RAM, %u on disk, every %u frames.\n",
+         kf->count, sp->count, interval);
+}
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      slock_lock(state->lock);
+      state->alive = false;
+      scond_broadcast(state->cond);
+      slock_unlock(state->lock);
+      sthread_join(state->thread);
+   }
+   if (state->lock)
+      slock_free(state->lock);
+   if (state->cond)
+      scond_free(state->cond);
+   if (state->spareblock)
+      memalign_free_large(state->spareblock);
+   state->thread     = NULL;
+   state->lock       = NULL;
+   state->cond       = NULL;
+   state->spareblock = NULL;
+#endif
+
+   state_manager_free_keyframes(state);
+
    if (state->data)
-      free(state->data);
+      memalign_free_large(state->data);
    if (state->thisblock)
-      free(state->thisblock);
+      memalign_free_large(state->thisblock);
    if (state->nextblock)
-      free(state->nextblock);
+      memalign_free_large(state->nextblock);
 #if STRICT_BUF_SIZE
    if (state->debugblock)
       free(state->debugblock);
@@ -431,7 +626,121 @@ static void state_manager_free(state_manager_t *state)
    state->nextblock  = NULL;
 }
 
-static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
+/* Appends the patch turning 'newb' back into 'oldb' at the head of
+ * the ring, dropping frames from the tail as needed.
+ * Returns the number of frames that were dropped. */
+static unsigned state_manager_push_compress(state_manager_t *state,
+      const uint8_t *oldb, const uint8_t *newb)
+{
+   uint8_t *compressed;
+   size_t headpos, tailpos, remaining;
+   unsigned dropped = 0;
+
+recheckcapacity:;
+
+   headpos = state->head - state->data;
+   tailpos = state->tail - state->data;
+   remaining = (tailpos + state->capacity -
+         sizeof(size_t) - headpos - 1) % state->capacity + 1;
+
+   if (remaining <= state->maxcompsize)
+   {
+      state->tail = state->data + read_size_t(state->tail);
+      dropped++;
+      goto recheckcapacity;
+   }
+
+   compressed  = state->head + sizeof(size_t);
+
+   compressed += state_manager_raw_compress(oldb, newb,
+         state->blocksize, compressed);
+
+   if (compressed - state->data + state->maxcompsize > state->capacity)
+   {
+      compressed = state->data;
+      if (state->tail == state->data + sizeof(size_t))
+         state->tail = state->data + read_size_t(state->tail);
+   }
+   write_size_t(compressed, state->head-state->data);
+   compressed += sizeof(size_t);
+   write_size_t(state->head, compressed-state->data);
+   state->head = compressed;
+
+   return dropped;
+}
+
+#ifdef HAVE_THREADS
+static void state_manager_thread(void *data)
+{
+   state_manager_t *state = (state_manager_t*)data;
+
+   slock_lock(state->lock);
+
+   for (;;)
+   {
+      unsigned dropped;
+
+      while (state->alive && !state->job_pending)
+         scond_wait(state->cond, state->lock);
+
+      if (!state->alive)
+         break;
+
+      /* The frame thread doesn't touch the ring
+       * while a job is pending, no need to hold the lock. */
+      slock_unlock(state->lock);
+      dropped = state_manager_push_compress(state,
+            state->job_old, state->job_new);
+      slock_lock(state->lock);
+
+      state->job_dropped += dropped;
+      state->job_pending  = false;
+      scond_broadcast(state->cond);
+   }
+
+   slock_unlock(state->lock);
+}
+
+/* Blocks until the worker has finished the pending job (if any)
+ * and folds its bookkeeping back into the state. */
+static void state_manager_wait(state_manager_t *state)
+{
+   if (!state->thread)
+      return;
+
+   slock_lock(state->lock);
+   while (state->job_pending)
+      scond_wait(state->cond, state->lock);
+   state->entries     -= state->job_dropped;
+   state->job_dropped  = 0;
+   slock_unlock(state->lock);
+}
+
+static bool state_manager_init_thread(state_manager_t *state,
+      size_t state_size)
+{
+   state->spareblock = (uint8_t*)state_manager_raw_alloc(state_size, 2);
+   state->lock       = slock_new();
+   state->cond       = scond_new();
+
+   if (!state->spareblock || !state->lock || !state->cond)
+      return false;
+
+   state->alive      = true;
+   state->thread     = sthread_create(state_manager_thread, state);
+
+   if (!state->thread)
+   {
+      state->alive   = false;
+      return false;
+   }
+
+   return true;
+}
+#endif
+
+static state_manager_t *state_manager_new(
+      size_t state_size, size_t buffer_size, bool threaded)
 {
    size_t max_comp_size, block_size;
    uint8_t *next_block    = NULL;
@@ -442,11 +751,19 @@ static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
    if (!state)
       return NULL;
 
+   if (!find_change)
+   {
+      const state_delta_kernels_t *kernels = state_delta_kernels_find();
+      find_change = kernels->find_change;
+      find_same   = kernels->find_same;
+      RARCH_LOG("[Rewind]: Using %s delta kernels.\n", kernels->ident);
+   }
+
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
 
    /* the compressed data is surrounded by pointers to the other side */
    max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
-   state_data         = (uint8_t*)malloc(buffer_size);
+   state_data         = (uint8_t*)memalign_alloc_large(buffer_size);
 
    if (!state_data)
       goto error;
@@ -472,11 +789,17 @@ static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
    state->debugblock  = (uint8_t*)malloc(state_size);
 #endif
 
+#ifdef HAVE_THREADS
+   if (threaded && !state_manager_init_thread(state, state_size))
+      RARCH_WARN("[Rewind]: Failed to start compression thread, "
+            "falling back to synchronous mode.\n");
+#endif
+
    return state;
 
 error:
    if (state_data)
-      free(state_data);
+      memalign_free_large(state_data);
    state_manager_free(state);
    free(state);
 
@@ -491,6 +814,10 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data = NULL;
 
+#ifdef HAVE_THREADS
+   state_manager_wait(state);
+#endif
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid = false;
@@ -513,6 +840,7 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
          state->maxcompsize, out, state->blocksize);
 
    state->entries--;
+   state->frame--;
    return true;
 }
 
@@ -546,45 +874,49 @@ static void state_manager_push_do(state_manager_t *state)
    memcpy(state->nextblock, state->debugblock, state->debugsize);
 #endif
 
-   if (state->thisblock_valid)
-   {
-      const uint8_t *oldb, *newb;
-      uint8_t *compressed;
-      size_t headpos, tailpos, remaining;
-      if (state->capacity < sizeof(size_t) + state->maxcompsize)
-         return;
+   if (     state->thisblock_valid
+         && state->capacity < sizeof(size_t) + state->maxcompsize)
+      return;
 
-recheckcapacity:;
+   if (state->keyframe_interval)
+      state_manager_keyframes_trim(state, state->frame);
 
-      headpos = state->head - state->data;
-      tailpos = state->tail - state->data;
-      remaining = (tailpos + state->capacity -
-            sizeof(size_t) - headpos - 1) % state->capacity + 1;
+   state->frame++;
 
-      if (remaining <= state->maxcompsize)
-      {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
-         goto recheckcapacity;
-      }
+   if (     state->keyframe_interval
+         && !(state->frame % state->keyframe_interval))
+      state_manager_keyframes_push(state, state->nextblock);
 
-      oldb        = state->thisblock;
-      newb        = state->nextblock;
-      compressed  = state->head + sizeof(size_t);
-
-      compressed += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
+   if (state->thisblock_valid)
+   {
 
-      if (compressed - state->data + state->maxcompsize > state->capacity)
+#ifdef HAVE_THREADS
+      if (state->thread)
       {
-         compressed = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+         /* Back-pressure: if the previous job is still running,
+          * wait for it, so at most one frame is ever in flight. */
+         state_manager_wait(state);
+
+         slock_lock(state->lock);
+         state->job_old     = state->thisblock;
+         state->job_new     = state->nextblock;
+         state->job_pending = true;
+         state->entries++;
+         scond_signal(state->cond);
+         slock_unlock(state->lock);
+
+         /* The worker owns 'thisblock' until the job completes;
+          * the spare block is free since the last job is done. */
+         swap              = state->spareblock;
+         state->spareblock = state->thisblock;
+         state->thisblock  = state->nextblock;
+         state->nextblock  = swap;
+         return;
       }
-      write_size_t(compressed, state->head-state->data);
-      compressed += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head = compressed;
+#endif
+
+      state->entries -= state_manager_push_compress(state,
+            state->thisblock, state->nextblock);
    }
    else
       state->thisblock_valid = true;
@@ -614,11 +946,12 @@ static void state_manager_capacity(state_manager_t *state,
 }
 #endif
 
-void state_manager_event_init(unsigned rewind_buffer_size)
+void state_manager_event_init(unsigned rewind_buffer_size, bool threaded)
 {
    retro_ctx_serialize_info_t serial_info;
    retro_ctx_size_info_t info;
    void *state          = NULL;
+   settings_t *settings = config_get_ptr();
 
    if (rewind_state.state)
       return;
@@ -645,10 +978,19 @@ void state_manager_event_init(unsigned rewind_buffer_size)
          (unsigned)(rewind_buffer_size / 1000000));
 
    rewind_state.state = state_manager_new(rewind_state.size,
-         rewind_buffer_size);
+         rewind_buffer_size, threaded);
 
    if (!rewind_state.state)
+   {
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
+      return;
+   }
+
+   state_manager_init_keyframes(rewind_state.state,
+         settings->uints.rewind_keyframe_interval,
+         settings->sizes.rewind_keyframe_buffer_size,
+         settings->uints.rewind_keyframe_spill_count,
+         settings->paths.directory_cache);
 
    state_manager_push_where(rewind_state.state, &state);
 
@@ -715,7 +1057,9 @@ bool state_manager_check_rewind(bool pressed,
    {
       const void *buf    = NULL;
 
-      if (state_manager_pop(rewind_state.state, &buf))
+      if (     state_manager_pop(rewind_state.state, &buf)
+            || (  !bsv_movie_ctl(BSV_MOVIE_CTL_IS_INITED, NULL)
+               && state_manager_pop_keyframe(rewind_state.state, &buf)))
       {
          retro_ctx_serialize_info_t serial_info;
 
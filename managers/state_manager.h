@@ -32,7 +32,14 @@ bool state_manager_frame_is_reversed(void);
 
 void state_manager_event_deinit(void);
 
-void state_manager_event_init(unsigned rewind_buffer_size);
+/**
+ * state_manager_event_init:
+ * @rewind_buffer_size   : size of the rewind ring buffer, in bytes.
+ * @threaded             : compress rewind states on a worker thread.
+ *
+ * Initializes the rewind state manager.
+ **/
+void state_manager_event_init(unsigned rewind_buffer_size, bool threaded);
 
 /**
  * check_rewind:
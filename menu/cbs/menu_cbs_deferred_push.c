@@ -126,6 +126,7 @@ generic_deferred_push(deferred_push_content_history_path,           DISPLAYLIST_
 generic_deferred_push(deferred_push_core_information,               DISPLAYLIST_CORE_INFO)
 generic_deferred_push(deferred_push_system_information,             DISPLAYLIST_SYSTEM_INFO)
 generic_deferred_push(deferred_push_network_information,            DISPLAYLIST_NETWORK_INFO)
+generic_deferred_push(deferred_push_shader_pass_times,              DISPLAYLIST_SHADER_PASS_TIMES)
 generic_deferred_push(deferred_push_achievement_list,               DISPLAYLIST_ACHIEVEMENT_LIST)
 generic_deferred_push(deferred_push_rdb_collection,                 DISPLAYLIST_PLAYLIST_COLLECTION)
 generic_deferred_push(deferred_main_menu_list,                      DISPLAYLIST_MAIN_MENU)
@@ -947,6 +948,11 @@ static int menu_cbs_init_bind_deferred_push_compare_label(
    {
       BIND_ACTION_DEFERRED_PUSH(cbs, deferred_push_network_information);
    }
+   else if (strstr(label,
+            msg_hash_to_str(MENU_ENUM_LABEL_SHADER_PASS_TIMES)))
+   {
+      BIND_ACTION_DEFERRED_PUSH(cbs, deferred_push_shader_pass_times);
+   }
 #ifdef HAVE_NETWORKING
    else if (strstr(label,
             msg_hash_to_str(MENU_ENUM_LABEL_DEFERRED_THUMBNAILS_UPDATER_LIST)))
@@ -1199,6 +1205,9 @@ static int menu_cbs_init_bind_deferred_push_compare_label(
             case MENU_ENUM_LABEL_NETWORK_INFORMATION:
                BIND_ACTION_DEFERRED_PUSH(cbs, deferred_push_network_information);
                break;
+            case MENU_ENUM_LABEL_SHADER_PASS_TIMES:
+               BIND_ACTION_DEFERRED_PUSH(cbs, deferred_push_shader_pass_times);
+               break;
             case MENU_ENUM_LABEL_ACHIEVEMENT_LIST:
                BIND_ACTION_DEFERRED_PUSH(cbs, deferred_push_achievement_list);
                break;
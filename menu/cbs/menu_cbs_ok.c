@@ -21,6 +21,7 @@
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 #include <lists/string_list.h>
+#include <encodings/crc32.h>
 
 #ifdef HAVE_CONFIG_H
 #include "../../config.h"
@@ -3196,24 +3197,25 @@ static int action_ok_undo_save_state(const char *path,
 #ifdef HAVE_NETWORKING
 
 #ifdef HAVE_ZLIB
+static void generic_decompressed(unsigned type_hash)
+{
+   switch (type_hash)
+   {
+      case CB_CORE_UPDATER_DOWNLOAD:
+         generic_action_ok_command(CMD_EVENT_CORE_INFO_INIT);
+         break;
+      case CB_UPDATE_ASSETS:
+         generic_action_ok_command(CMD_EVENT_REINIT);
+         break;
+   }
+}
+
 static void cb_decompressed(void *task_data, void *user_data, const char *err)
 {
    decompress_task_data_t *dec = (decompress_task_data_t*)task_data;
 
    if (dec && !err)
-   {
-      unsigned type_hash = (unsigned)(uintptr_t)user_data;
-
-      switch (type_hash)
-      {
-         case CB_CORE_UPDATER_DOWNLOAD:
-            generic_action_ok_command(CMD_EVENT_CORE_INFO_INIT);
-            break;
-         case CB_UPDATE_ASSETS:
-            generic_action_ok_command(CMD_EVENT_REINIT);
-            break;
-      }
-   }
+      generic_decompressed((unsigned)(uintptr_t)user_data);
 
    if (err)
       RARCH_ERR("%s", err);
@@ -3343,26 +3345,12 @@ static void cb_generic_dir_download(void *task_data,
 }
 
 /* expects http_transfer_t*, file_transfer_t* */
-static void cb_generic_download(void *task_data,
-      void *user_data, const char *err)
+/* Directory a download of this type goes to */
+static const char *generic_download_dir(const file_transfer_t *transf)
 {
-   char output_path[PATH_MAX_LENGTH];
-#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
-   bool extract                          = true;
-#endif
    const char             *dir_path      = NULL;
-   file_transfer_t     *transf      = (file_transfer_t*)user_data;
    settings_t              *settings     = config_get_ptr();
-   http_transfer_data_t        *data     = (http_transfer_data_t*)task_data;
-
-   if (!data || !data->data | !transf)
-      goto finish;
-
-   output_path[0] = '\0';
 
-   /* we have to determine dir_path at the time of writting or else
-    * we'd run into races when the user changes the setting during an
-    * http transfer. */
    switch (transf->enum_idx)
    {
       case MENU_ENUM_LABEL_CB_CORE_THUMBNAILS_DOWNLOAD:
@@ -3373,9 +3361,6 @@ static void cb_generic_download(void *task_data,
          break;
       case MENU_ENUM_LABEL_CB_CORE_CONTENT_DOWNLOAD:
          dir_path = settings->paths.directory_core_assets;
-#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
-         extract = settings->bools.network_buildbot_auto_extract_archive;
-#endif
          break;
       case MENU_ENUM_LABEL_CB_UPDATE_CORE_INFO_FILES:
          dir_path = settings->paths.path_libretro_info;
@@ -3415,7 +3400,7 @@ static void cb_generic_download(void *task_data,
                   sizeof(shaderdir));
 
             if (!filestream_exists(shaderdir) && !path_mkdir(shaderdir))
-               goto finish;
+               return NULL;
 
             dir_path = shaderdir;
          }
@@ -3429,6 +3414,47 @@ static void cb_generic_download(void *task_data,
          break;
    }
 
+   return dir_path;
+}
+
+static void cb_generic_download(void *task_data,
+      void *user_data, const char *err)
+{
+   char output_path[PATH_MAX_LENGTH];
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   bool extract                          = true;
+#endif
+   const char             *dir_path      = NULL;
+   file_transfer_t     *transf      = (file_transfer_t*)user_data;
+   http_transfer_data_t        *data     = (http_transfer_data_t*)task_data;
+
+   if (!data || !transf)
+      goto finish;
+
+   output_path[0] = '\0';
+
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   if (transf->enum_idx == MENU_ENUM_LABEL_CB_CORE_CONTENT_DOWNLOAD)
+      extract = config_get_ptr()->bools.network_buildbot_auto_extract_archive;
+#endif
+
+   /* Streamed to disk, the file is already in place */
+   if (!data->data)
+   {
+      if (string_is_empty(transf->dir_path))
+         goto finish;
+
+      dir_path = transf->dir_path;
+      fill_pathname_join(output_path, dir_path,
+            transf->path, sizeof(output_path));
+      goto written;
+   }
+
+   /* we have to determine dir_path at the time of writting or else
+    * we'd run into races when the user changes the setting during an
+    * http transfer. */
+   dir_path = generic_download_dir(transf);
+
    if (!string_is_empty(dir_path))
       fill_pathname_join(output_path, dir_path,
             transf->path, sizeof(output_path));
@@ -3463,7 +3489,16 @@ static void cb_generic_download(void *task_data,
       goto finish;
    }
 
+written:
+
 #if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+   if (transf->extracted)
+   {
+      generic_decompressed(
+            msg_hash_calculate(msg_hash_to_str(transf->enum_idx)));
+      goto finish;
+   }
+
    if (!extract)
       goto finish;
 
@@ -3506,13 +3541,156 @@ finish:
    if (transf)
       free(transf);
 }
+
+static int action_ok_download_generic(const char *path,
+      const char *label, const char *menu_label,
+      unsigned type, size_t idx, size_t entry_idx,
+      enum msg_hash_enums enum_idx, bool try_delta);
+
+/* Path of the installed core a core updater download replaces */
+static void core_delta_core_path(const file_transfer_t *transf,
+      char *s, size_t len)
+{
+   fill_pathname_join(s, transf->dir_path, transf->path, len);
+   path_remove_extension(s);
+}
+
+/* expects http_transfer_t*, file_transfer_t* */
+static void cb_core_delta_download(void *task_data,
+      void *user_data, const char *err)
+{
+   char core_path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   int64_t core_size          = 0;
+   void *core_data            = NULL;
+   file_transfer_t *transf    = (file_transfer_t*)user_data;
+   http_transfer_data_t *data = (http_transfer_data_t*)task_data;
+   bool patched               = false;
+
+   if (!transf)
+      goto finish;
+
+   if (!data || !data->data || err)
+      goto finish;
+
+   core_delta_core_path(transf, core_path, sizeof(core_path));
+
+   if (!filestream_read_file(core_path, &core_data, &core_size))
+      goto finish;
+
+   {
+      size_t size = (size_t)core_size;
+
+      if (!patch_apply_bps((const uint8_t*)data->data, data->len,
+               (uint8_t**)&core_data, &size))
+      {
+         RARCH_WARN("[updater] Patch for '%s' does not apply.\n", core_path);
+         goto finish;
+      }
+
+      /* Never leave a half written core behind */
+      strlcpy(tmp_path, core_path, sizeof(tmp_path));
+      strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+      if (!filestream_write_file(tmp_path, core_data, size))
+         goto finish;
+   }
+
+   filestream_delete(core_path);
+
+   if (filestream_rename(tmp_path, core_path) != 0)
+   {
+      filestream_delete(tmp_path);
+      goto finish;
+   }
+
+   RARCH_LOG("[updater] Patched '%s' to the latest build.\n", core_path);
+   generic_action_ok_command(CMD_EVENT_CORE_INFO_INIT);
+   patched = true;
+
+finish:
+   free(core_data);
+
+   if (data)
+   {
+      if (data->data)
+         free(data->data);
+      free(data);
+   }
+
+   if (!transf)
+      return;
+
+   /* No patch from this build, get the whole core */
+   if (!patched)
+      action_ok_download_generic(transf->path, NULL, NULL, 0, 0, 0,
+            transf->enum_idx, false);
+
+   free(transf);
+}
+
+/* Asks for '<core>.<crc32 of the installed core>.bps' next to the
+ * core's archive, which takes the installed build to the latest.
+ * Returns false if there is no installed core to patch. */
+static bool core_delta_push(const char *url,
+      file_transfer_t *transf, bool mute)
+{
+   char core_path[PATH_MAX_LENGTH];
+   char patch_url[PATH_MAX_LENGTH];
+   char encoded_url[PATH_MAX_LENGTH];
+   char suffix[32];
+   int64_t core_size    = 0;
+   void *core_data      = NULL;
+   const char *dir_path = generic_download_dir(transf);
+
+   if (string_is_empty(dir_path) || !path_is_compressed_file(transf->path))
+      return false;
+
+   strlcpy(transf->dir_path, dir_path, sizeof(transf->dir_path));
+   core_delta_core_path(transf, core_path, sizeof(core_path));
+
+   if (     !path_is_valid(core_path)
+         || !filestream_read_file(core_path, &core_data, &core_size))
+      return false;
+
+   snprintf(suffix, sizeof(suffix), ".%08x.bps",
+         encoding_crc32(0, (const uint8_t*)core_data, (size_t)core_size));
+   free(core_data);
+
+   strlcpy(patch_url, url, sizeof(patch_url));
+   path_remove_extension(patch_url);
+   strlcat(patch_url, suffix, sizeof(patch_url));
+
+   net_http_urlencode_full(encoded_url, patch_url, sizeof(encoded_url));
+
+   return task_push_http_transfer(encoded_url, mute,
+         msg_hash_to_str(transf->enum_idx), cb_core_delta_download, transf)
+      != NULL;
+}
+
+/* expects file_transfer_t* */
+static void cb_thumbnail_sync(void *task_data,
+      void *user_data, const char *err)
+{
+   file_transfer_t *transf = (file_transfer_t*)user_data;
+
+   if (!transf)
+      return;
+
+   /* The server has no manifest for this system, get the whole pack */
+   if (err)
+      action_ok_download_generic(transf->path, NULL, NULL, 0, 0, 0,
+            transf->enum_idx, false);
+
+   free(transf);
+}
 #endif
 
 
 static int action_ok_download_generic(const char *path,
       const char *label, const char *menu_label,
       unsigned type, size_t idx, size_t entry_idx,
-      enum msg_hash_enums enum_idx)
+      enum msg_hash_enums enum_idx, bool try_delta)
 {
 #ifdef HAVE_NETWORKING
    char s[PATH_MAX_LENGTH];
@@ -3595,6 +3773,84 @@ static int action_ok_download_generic(const char *path,
 
    net_http_urlencode_full(s3, s2, sizeof(s));
 
+   /* A patch against the installed core is much smaller */
+   if (     try_delta
+         && enum_idx == MENU_ENUM_LABEL_CB_CORE_UPDATER_DOWNLOAD
+         && core_delta_push(s2, transf, suppress_msg))
+      return 0;
+
+   /* Only fetch the thumbnails that changed since the last update */
+   if (     try_delta
+         && enum_idx == MENU_ENUM_LABEL_CB_CORE_THUMBNAILS_DOWNLOAD
+         && path_is_compressed_file(path))
+   {
+      char system[PATH_MAX_LENGTH];
+
+      strlcpy(system, path, sizeof(system));
+      path_remove_extension(system);
+
+      if (task_push_thumbnail_sync(s, system,
+               settings->paths.directory_thumbnails,
+               cb_thumbnail_sync, transf))
+         return 0;
+   }
+
+   /* Write straight to disk where the download is going to end up */
+   if (cb == cb_generic_download)
+   {
+      char output_path[PATH_MAX_LENGTH];
+      const char *dir_path = generic_download_dir(transf);
+
+      output_path[0] = '\0';
+
+      if (!string_is_empty(dir_path))
+      {
+         fill_pathname_join(output_path, dir_path,
+               transf->path, sizeof(output_path));
+         path_basedir_wrapper(output_path);
+      }
+
+      if (!string_is_empty(output_path) && path_mkdir(output_path))
+      {
+         strlcpy(transf->dir_path, dir_path, sizeof(transf->dir_path));
+         fill_pathname_join(output_path, dir_path,
+               transf->path, sizeof(output_path));
+
+#ifdef HAVE_COMPRESSION
+         if (path_is_compressed_file(output_path)
+               && task_check_decompress(output_path))
+         {
+            runloop_msg_queue_push(
+                  msg_hash_to_str(MSG_DECOMPRESSION_ALREADY_IN_PROGRESS),
+                  1, 180, true);
+            free(transf);
+            return 0;
+         }
+#endif
+
+#if defined(HAVE_COMPRESSION) && defined(HAVE_ZLIB)
+         /* Extract while downloading rather than from the archive
+          * afterwards, when the archive type allows for it */
+         if (     (enum_idx != MENU_ENUM_LABEL_CB_CORE_CONTENT_DOWNLOAD
+                  || settings->bools.network_buildbot_auto_extract_archive)
+               && path_is_compressed_file(output_path))
+         {
+            transf->extracted = true;
+
+            if (task_push_http_transfer_extract(s3, output_path, dir_path,
+                     suppress_msg, msg_hash_to_str(enum_idx), cb, transf))
+               return 0;
+
+            transf->extracted = false;
+         }
+#endif
+
+         task_push_http_transfer_file(s3, output_path, suppress_msg,
+               msg_hash_to_str(enum_idx), cb, transf);
+         return 0;
+      }
+   }
+
    task_push_http_transfer(s3, suppress_msg, msg_hash_to_str(enum_idx), cb, transf);
 #endif
    return 0;
@@ -3611,13 +3867,13 @@ static int action_ok_core_content_download(const char *path,
 
    return action_ok_download_generic(path, label,
          menu_path, type, idx, entry_idx,
-         MENU_ENUM_LABEL_CB_CORE_CONTENT_DOWNLOAD);
+         MENU_ENUM_LABEL_CB_CORE_CONTENT_DOWNLOAD, true);
 }
 
 #define default_action_ok_download(funcname, _id) \
 static int (funcname)(const char *path, const char *label, unsigned type, size_t idx, size_t entry_idx) \
 { \
-   return action_ok_download_generic(path, label, NULL, type, idx, entry_idx,_id); \
+   return action_ok_download_generic(path, label, NULL, type, idx, entry_idx,_id, true); \
 }
 
 default_action_ok_download(action_ok_core_content_thumbnails, MENU_ENUM_LABEL_CB_CORE_THUMBNAILS_DOWNLOAD)
@@ -5286,6 +5542,7 @@ static int menu_cbs_init_bind_ok_compare_label(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_CORE_INFORMATION:
          case MENU_ENUM_LABEL_SYSTEM_INFORMATION:
          case MENU_ENUM_LABEL_NETWORK_INFORMATION:
+         case MENU_ENUM_LABEL_SHADER_PASS_TIMES:
          case MENU_ENUM_LABEL_ACHIEVEMENT_LIST:
          case MENU_ENUM_LABEL_ACHIEVEMENT_LIST_HARDCORE:
          case MENU_ENUM_LABEL_DISK_OPTIONS:
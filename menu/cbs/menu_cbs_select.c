@@ -49,8 +49,8 @@ static int action_select_default(const char *path, const char *label, unsigned t
    menu_entry_get(&entry, 0, idx, NULL, false);
 
    if (selection_buf)
-      cbs                     = (menu_file_list_cbs_t*)
-         file_list_get_actiondata_at_offset(selection_buf, idx);
+      cbs                     = menu_entries_get_actiondata(
+            selection_buf, idx);
 
    if (!cbs)
    {
@@ -102,6 +102,7 @@ default_sublabel_macro(action_bind_sublabel_cheevos_leaderboards_enable,   MENU_
 default_sublabel_macro(action_bind_sublabel_cheevos_badges_enable,         MENU_ENUM_SUBLABEL_CHEEVOS_BADGES_ENABLE)
 default_sublabel_macro(action_bind_sublabel_cheevos_verbose_enable,        MENU_ENUM_SUBLABEL_CHEEVOS_VERBOSE_ENABLE)
 default_sublabel_macro(action_bind_sublabel_cheevos_auto_screenshot,       MENU_ENUM_SUBLABEL_CHEEVOS_AUTO_SCREENSHOT)
+default_sublabel_macro(action_bind_sublabel_cheevos_threaded,              MENU_ENUM_SUBLABEL_CHEEVOS_THREADED)
 default_sublabel_macro(action_bind_sublabel_menu_views_settings_list,      MENU_ENUM_SUBLABEL_MENU_VIEWS_SETTINGS)
 default_sublabel_macro(action_bind_sublabel_quick_menu_views_settings_list, MENU_ENUM_SUBLABEL_QUICK_MENU_VIEWS_SETTINGS)
 default_sublabel_macro(action_bind_sublabel_menu_settings_list,            MENU_ENUM_SUBLABEL_MENU_SETTINGS)
@@ -127,12 +128,14 @@ default_sublabel_macro(action_bind_sublabel_fps_show,                      MENU_
 default_sublabel_macro(action_bind_sublabel_framecount_show,               MENU_ENUM_SUBLABEL_FRAMECOUNT_SHOW)
 default_sublabel_macro(action_bind_sublabel_memory_show,                   MENU_ENUM_SUBLABEL_MEMORY_SHOW)
 default_sublabel_macro(action_bind_sublabel_statistics_show,               MENU_ENUM_SUBLABEL_STATISTICS_SHOW)
+default_sublabel_macro(action_bind_sublabel_perf_overlay_show,             MENU_ENUM_SUBLABEL_PERF_OVERLAY_SHOW)
 default_sublabel_macro(action_bind_sublabel_netplay_settings,              MENU_ENUM_SUBLABEL_NETPLAY)
 default_sublabel_macro(action_bind_sublabel_user_bind_settings,            MENU_ENUM_SUBLABEL_INPUT_USER_BINDS)
 default_sublabel_macro(action_bind_sublabel_input_hotkey_settings,         MENU_ENUM_SUBLABEL_INPUT_HOTKEY_BINDS)
 default_sublabel_macro(action_bind_sublabel_materialui_icons_enable,       MENU_ENUM_SUBLABEL_MATERIALUI_ICONS_ENABLE)
 default_sublabel_macro(action_bind_sublabel_add_content_list,              MENU_ENUM_SUBLABEL_ADD_CONTENT_LIST)
 default_sublabel_macro(action_bind_sublabel_video_frame_delay,             MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY)
+default_sublabel_macro(action_bind_sublabel_video_frame_delay_auto,        MENU_ENUM_SUBLABEL_VIDEO_FRAME_DELAY_AUTO)
 default_sublabel_macro(action_bind_sublabel_video_black_frame_insertion,   MENU_ENUM_SUBLABEL_VIDEO_BLACK_FRAME_INSERTION)
 default_sublabel_macro(action_bind_sublabel_systeminfo_cpu_cores,          MENU_ENUM_SUBLABEL_CPU_CORES)
 default_sublabel_macro(action_bind_sublabel_toggle_gamepad_combo,          MENU_ENUM_SUBLABEL_INPUT_MENU_ENUM_TOGGLE_GAMEPAD_COMBO)
@@ -143,6 +146,8 @@ default_sublabel_macro(action_bind_sublabel_video_refresh_rate_auto,       MENU_
 default_sublabel_macro(action_bind_sublabel_video_hard_sync,               MENU_ENUM_SUBLABEL_VIDEO_HARD_SYNC)
 default_sublabel_macro(action_bind_sublabel_video_hard_sync_frames,        MENU_ENUM_SUBLABEL_VIDEO_HARD_SYNC_FRAMES)
 default_sublabel_macro(action_bind_sublabel_video_threaded,                MENU_ENUM_SUBLABEL_VIDEO_THREADED)
+default_sublabel_macro(action_bind_sublabel_video_shader_parallel_record,  MENU_ENUM_SUBLABEL_VIDEO_SHADER_PARALLEL_RECORD)
+default_sublabel_macro(action_bind_sublabel_video_shader_dynamic_scale_min, MENU_ENUM_SUBLABEL_VIDEO_SHADER_DYNAMIC_SCALE_MIN)
 default_sublabel_macro(action_bind_sublabel_config_save_on_exit,           MENU_ENUM_SUBLABEL_CONFIG_SAVE_ON_EXIT)
 default_sublabel_macro(action_bind_sublabel_configuration_settings_list,   MENU_ENUM_SUBLABEL_CONFIGURATION_SETTINGS)
 default_sublabel_macro(action_bind_sublabel_configurations_list_list,      MENU_ENUM_SUBLABEL_CONFIGURATIONS_LIST)
@@ -155,12 +160,14 @@ default_sublabel_macro(action_bind_sublabel_camera_allow,                  MENU_
 default_sublabel_macro(action_bind_sublabel_location_allow,                MENU_ENUM_SUBLABEL_LOCATION_ALLOW)
 default_sublabel_macro(action_bind_sublabel_input_max_users,               MENU_ENUM_SUBLABEL_INPUT_MAX_USERS)
 default_sublabel_macro(action_bind_sublabel_input_poll_type_behavior,      MENU_ENUM_SUBLABEL_INPUT_POLL_TYPE_BEHAVIOR)
+default_sublabel_macro(action_bind_sublabel_input_poll_thread,             MENU_ENUM_SUBLABEL_INPUT_POLL_THREAD)
 default_sublabel_macro(action_bind_sublabel_input_all_users_control_menu,  MENU_ENUM_SUBLABEL_INPUT_ALL_USERS_CONTROL_MENU)
 default_sublabel_macro(action_bind_sublabel_input_bind_timeout,            MENU_ENUM_SUBLABEL_INPUT_BIND_TIMEOUT)
 default_sublabel_macro(action_bind_sublabel_input_bind_hold,               MENU_ENUM_SUBLABEL_INPUT_BIND_HOLD)
 default_sublabel_macro(action_bind_sublabel_audio_volume,                  MENU_ENUM_SUBLABEL_AUDIO_VOLUME)
 default_sublabel_macro(action_bind_sublabel_audio_mixer_volume,            MENU_ENUM_SUBLABEL_AUDIO_MIXER_VOLUME)
 default_sublabel_macro(action_bind_sublabel_audio_sync,                    MENU_ENUM_SUBLABEL_AUDIO_SYNC)
+default_sublabel_macro(action_bind_sublabel_audio_pull,                    MENU_ENUM_SUBLABEL_AUDIO_PULL)
 default_sublabel_macro(action_bind_sublabel_axis_threshold,                MENU_ENUM_SUBLABEL_INPUT_AXIS_THRESHOLD)
 default_sublabel_macro(action_bind_sublabel_input_turbo_period,            MENU_ENUM_SUBLABEL_INPUT_TURBO_PERIOD)
 default_sublabel_macro(action_bind_sublabel_input_duty_cycle,              MENU_ENUM_SUBLABEL_INPUT_DUTY_CYCLE)
@@ -168,6 +175,7 @@ default_sublabel_macro(action_bind_sublabel_video_vertical_sync,           MENU_
 default_sublabel_macro(action_bind_sublabel_video_adaptive_vsync,          MENU_ENUM_SUBLABEL_VIDEO_ADAPTIVE_VSYNC)
 default_sublabel_macro(action_bind_sublabel_core_allow_rotate,             MENU_ENUM_SUBLABEL_VIDEO_ALLOW_ROTATE)
 default_sublabel_macro(action_bind_sublabel_dummy_on_core_shutdown,        MENU_ENUM_SUBLABEL_DUMMY_ON_CORE_SHUTDOWN)
+default_sublabel_macro(action_bind_sublabel_core_cache_enable,             MENU_ENUM_SUBLABEL_CORE_CACHE_ENABLE)
 default_sublabel_macro(action_bind_sublabel_dummy_check_missing_firmware,  MENU_ENUM_SUBLABEL_CHECK_FOR_MISSING_FIRMWARE)
 default_sublabel_macro(action_bind_sublabel_video_refresh_rate,            MENU_ENUM_SUBLABEL_VIDEO_REFRESH_RATE)
 default_sublabel_macro(action_bind_sublabel_video_refresh_rate_polled,     MENU_ENUM_SUBLABEL_VIDEO_REFRESH_RATE_POLLED)
@@ -192,6 +200,7 @@ default_sublabel_macro(action_bind_sublabel_sideload_core_list,            MENU_
 default_sublabel_macro(action_bind_sublabel_content_list,                  MENU_ENUM_SUBLABEL_LOAD_CONTENT_LIST)
 default_sublabel_macro(action_bind_sublabel_content_special,               MENU_ENUM_SUBLABEL_LOAD_CONTENT_SPECIAL)
 default_sublabel_macro(action_bind_sublabel_network_information,           MENU_ENUM_SUBLABEL_NETWORK_INFORMATION)
+default_sublabel_macro(action_bind_sublabel_shader_pass_times,             MENU_ENUM_SUBLABEL_SHADER_PASS_TIMES)
 default_sublabel_macro(action_bind_sublabel_system_information,            MENU_ENUM_SUBLABEL_SYSTEM_INFORMATION)
 default_sublabel_macro(action_bind_sublabel_quit_retroarch,                MENU_ENUM_SUBLABEL_QUIT_RETROARCH)
 default_sublabel_macro(action_bind_sublabel_video_window_width,            MENU_ENUM_SUBLABEL_VIDEO_WINDOW_WIDTH)
@@ -202,30 +211,43 @@ default_sublabel_macro(action_bind_sublabel_video_save_window_position,    MENU_
 default_sublabel_macro(action_bind_sublabel_video_message_pos_x,           MENU_ENUM_SUBLABEL_VIDEO_MESSAGE_POS_X)
 default_sublabel_macro(action_bind_sublabel_video_message_pos_y,           MENU_ENUM_SUBLABEL_VIDEO_MESSAGE_POS_Y)
 default_sublabel_macro(action_bind_sublabel_video_font_size,               MENU_ENUM_SUBLABEL_VIDEO_FONT_SIZE)
+default_sublabel_macro(action_bind_sublabel_video_font_sdf,                MENU_ENUM_SUBLABEL_VIDEO_FONT_SDF)
 default_sublabel_macro(action_bind_sublabel_input_overlay_hide_in_menu,    MENU_ENUM_SUBLABEL_INPUT_OVERLAY_HIDE_IN_MENU)
 default_sublabel_macro(action_bind_sublabel_content_collection_list,       MENU_ENUM_SUBLABEL_CONTENT_COLLECTION_LIST)
 default_sublabel_macro(action_bind_sublabel_video_scale_integer,           MENU_ENUM_SUBLABEL_VIDEO_SCALE_INTEGER)
 default_sublabel_macro(action_bind_sublabel_video_gpu_screenshot,          MENU_ENUM_SUBLABEL_VIDEO_GPU_SCREENSHOT)
+default_sublabel_macro(action_bind_sublabel_screenshot_fast_encode,        MENU_ENUM_SUBLABEL_SCREENSHOT_FAST_ENCODE)
 default_sublabel_macro(action_bind_sublabel_video_rotation,                MENU_ENUM_SUBLABEL_VIDEO_ROTATION)
 default_sublabel_macro(action_bind_sublabel_video_force_srgb_enable,       MENU_ENUM_SUBLABEL_VIDEO_FORCE_SRGB_DISABLE)
 default_sublabel_macro(action_bind_sublabel_video_fullscreen,              MENU_ENUM_SUBLABEL_VIDEO_FULLSCREEN)
 default_sublabel_macro(action_bind_sublabel_video_windowed_fullscreen,     MENU_ENUM_SUBLABEL_VIDEO_WINDOWED_FULLSCREEN)
 default_sublabel_macro(action_bind_sublabel_video_gpu_record,              MENU_ENUM_SUBLABEL_VIDEO_GPU_RECORD)
+default_sublabel_macro(action_bind_sublabel_video_stream_record,           MENU_ENUM_SUBLABEL_VIDEO_STREAM_RECORD)
+default_sublabel_macro(action_bind_sublabel_video_record_hw_encoder,       MENU_ENUM_SUBLABEL_VIDEO_RECORD_HW_ENCODER)
 default_sublabel_macro(action_bind_sublabel_savestate_auto_index,          MENU_ENUM_SUBLABEL_SAVESTATE_AUTO_INDEX)
 default_sublabel_macro(action_bind_sublabel_block_sram_overwrite,          MENU_ENUM_SUBLABEL_BLOCK_SRAM_OVERWRITE)
 default_sublabel_macro(action_bind_sublabel_fastforward_ratio,             MENU_ENUM_SUBLABEL_FASTFORWARD_RATIO)
 default_sublabel_macro(action_bind_sublabel_vrr_runloop_enable,            MENU_ENUM_SUBLABEL_VRR_RUNLOOP_ENABLE)
+default_sublabel_macro(action_bind_sublabel_menu_skip_unchanged_frames,    MENU_ENUM_SUBLABEL_MENU_SKIP_UNCHANGED_FRAMES)
 default_sublabel_macro(action_bind_sublabel_slowmotion_ratio,              MENU_ENUM_SUBLABEL_SLOWMOTION_RATIO)
 default_sublabel_macro(action_bind_sublabel_run_ahead_enabled,             MENU_ENUM_SUBLABEL_RUN_AHEAD_ENABLED)
 default_sublabel_macro(action_bind_sublabel_run_ahead_secondary_instance,  MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_INSTANCE)
+default_sublabel_macro(action_bind_sublabel_run_ahead_secondary_threaded,  MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREADED)
+default_sublabel_macro(action_bind_sublabel_run_ahead_skip_rollback,       MENU_ENUM_SUBLABEL_RUN_AHEAD_SKIP_ROLLBACK)
+default_sublabel_macro(action_bind_sublabel_run_ahead_frames_auto,         MENU_ENUM_SUBLABEL_RUN_AHEAD_FRAMES_AUTO)
+default_sublabel_macro(action_bind_sublabel_run_ahead_detect_lag,          MENU_ENUM_SUBLABEL_RUN_AHEAD_DETECT_LAG)
 default_sublabel_macro(action_bind_sublabel_run_ahead_hide_warnings,       MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS)
 default_sublabel_macro(action_bind_sublabel_run_ahead_frames,              MENU_ENUM_SUBLABEL_RUN_AHEAD_FRAMES)
 default_sublabel_macro(action_bind_sublabel_rewind,                        MENU_ENUM_SUBLABEL_REWIND_ENABLE)
+default_sublabel_macro(action_bind_sublabel_rewind_threaded,               MENU_ENUM_SUBLABEL_REWIND_THREADED)
 default_sublabel_macro(action_bind_sublabel_cheat_apply_after_toggle,      MENU_ENUM_SUBLABEL_CHEAT_APPLY_AFTER_TOGGLE)
 default_sublabel_macro(action_bind_sublabel_cheat_apply_after_load,        MENU_ENUM_SUBLABEL_CHEAT_APPLY_AFTER_LOAD)
 default_sublabel_macro(action_bind_sublabel_rewind_granularity,            MENU_ENUM_SUBLABEL_REWIND_GRANULARITY)
 default_sublabel_macro(action_bind_sublabel_rewind_buffer_size,            MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE)
 default_sublabel_macro(action_bind_sublabel_rewind_buffer_size_step,       MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP)
+default_sublabel_macro(action_bind_sublabel_rewind_keyframe_interval,      MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_INTERVAL)
+default_sublabel_macro(action_bind_sublabel_rewind_keyframe_buffer_size,   MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_BUFFER_SIZE)
+default_sublabel_macro(action_bind_sublabel_rewind_keyframe_spill_count,   MENU_ENUM_SUBLABEL_REWIND_KEYFRAME_SPILL_COUNT)
 default_sublabel_macro(action_bind_sublabel_cheat_idx,                     MENU_ENUM_SUBLABEL_CHEAT_IDX)
 default_sublabel_macro(action_bind_sublabel_cheat_match_idx,               MENU_ENUM_SUBLABEL_CHEAT_MATCH_IDX)
 default_sublabel_macro(action_bind_sublabel_cheat_big_endian,              MENU_ENUM_SUBLABEL_CHEAT_BIG_ENDIAN)
@@ -255,6 +277,7 @@ default_sublabel_macro(action_bind_sublabel_perfcnt_enable,                MENU_
 default_sublabel_macro(action_bind_sublabel_savestate_auto_save,           MENU_ENUM_SUBLABEL_SAVESTATE_AUTO_SAVE)
 default_sublabel_macro(action_bind_sublabel_savestate_auto_load,           MENU_ENUM_SUBLABEL_SAVESTATE_AUTO_LOAD)
 default_sublabel_macro(action_bind_sublabel_savestate_thumbnail_enable,    MENU_ENUM_SUBLABEL_SAVESTATE_THUMBNAIL_ENABLE)
+default_sublabel_macro(action_bind_sublabel_savestate_file_compression,    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION)
 default_sublabel_macro(action_bind_sublabel_autosave_interval,             MENU_ENUM_SUBLABEL_AUTOSAVE_INTERVAL)
 default_sublabel_macro(action_bind_sublabel_input_remap_binds_enable,      MENU_ENUM_SUBLABEL_INPUT_REMAP_BINDS_ENABLE)
 default_sublabel_macro(action_bind_sublabel_input_autodetect_enable,       MENU_ENUM_SUBLABEL_INPUT_AUTODETECT_ENABLE)
@@ -277,6 +300,7 @@ default_sublabel_macro(action_bind_sublabel_dynamic_wallpaper,             MENU_
 default_sublabel_macro(action_bind_sublabel_audio_device,                  MENU_ENUM_SUBLABEL_AUDIO_DEVICE)
 default_sublabel_macro(action_bind_sublabel_audio_output_rate,             MENU_ENUM_SUBLABEL_AUDIO_OUTPUT_RATE)
 default_sublabel_macro(action_bind_sublabel_audio_dsp_plugin,              MENU_ENUM_SUBLABEL_AUDIO_DSP_PLUGIN)
+default_sublabel_macro(action_bind_sublabel_audio_alsa_mmap,               MENU_ENUM_SUBLABEL_AUDIO_ALSA_MMAP)
 default_sublabel_macro(action_bind_sublabel_audio_wasapi_exclusive_mode,   MENU_ENUM_SUBLABEL_AUDIO_WASAPI_EXCLUSIVE_MODE)
 default_sublabel_macro(action_bind_sublabel_audio_wasapi_float_format,     MENU_ENUM_SUBLABEL_AUDIO_WASAPI_FLOAT_FORMAT)
 default_sublabel_macro(action_bind_sublabel_audio_wasapi_sh_buffer_length, MENU_ENUM_SUBLABEL_AUDIO_WASAPI_SH_BUFFER_LENGTH)
@@ -295,6 +319,7 @@ default_sublabel_macro(action_bind_sublabel_netplay_require_slaves,        MENU_
 default_sublabel_macro(action_bind_sublabel_netplay_stateless_mode,        MENU_ENUM_SUBLABEL_NETPLAY_STATELESS_MODE)
 default_sublabel_macro(action_bind_sublabel_netplay_check_frames,          MENU_ENUM_SUBLABEL_NETPLAY_CHECK_FRAMES)
 default_sublabel_macro(action_bind_sublabel_netplay_nat_traversal,         MENU_ENUM_SUBLABEL_NETPLAY_NAT_TRAVERSAL)
+default_sublabel_macro(action_bind_sublabel_netplay_udp_input,             MENU_ENUM_SUBLABEL_NETPLAY_UDP_INPUT)
 default_sublabel_macro(action_bind_sublabel_stdin_cmd_enable,              MENU_ENUM_SUBLABEL_STDIN_CMD_ENABLE)
 default_sublabel_macro(action_bind_sublabel_mouse_enable,                  MENU_ENUM_SUBLABEL_MOUSE_ENABLE)
 default_sublabel_macro(action_bind_sublabel_pointer_enable,                MENU_ENUM_SUBLABEL_POINTER_ENABLE)
@@ -1356,6 +1381,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_NETPLAY_NAT_TRAVERSAL:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_netplay_nat_traversal);
             break;
+         case MENU_ENUM_LABEL_NETPLAY_UDP_INPUT:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_netplay_udp_input);
+            break;
          case MENU_ENUM_LABEL_NETPLAY_CHECK_FRAMES:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_netplay_check_frames);
             break;
@@ -1404,6 +1432,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_DEVICE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_device);
             break;
+         case MENU_ENUM_LABEL_AUDIO_ALSA_MMAP:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_alsa_mmap);
+            break;
          case MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_wasapi_exclusive_mode);
             break;
@@ -1473,6 +1504,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_SAVESTATE_THUMBNAIL_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_thumbnail_enable);
             break;
+         case MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_file_compression);
+            break;
          case MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_auto_save);
             break;
@@ -1488,6 +1522,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REWIND_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind);
             break;
+         case MENU_ENUM_LABEL_REWIND_THREADED:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_threaded);
+            break;
          case MENU_ENUM_LABEL_CHEAT_APPLY_AFTER_TOGGLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheat_apply_after_toggle);
             break;
@@ -1500,6 +1537,15 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_buffer_size_step);
             break;
+         case MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_keyframe_interval);
+            break;
+         case MENU_ENUM_LABEL_REWIND_KEYFRAME_BUFFER_SIZE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_keyframe_buffer_size);
+            break;
+         case MENU_ENUM_LABEL_REWIND_KEYFRAME_SPILL_COUNT:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_keyframe_spill_count);
+            break;
          case MENU_ENUM_LABEL_CHEAT_IDX:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheat_idx);
             break;
@@ -1581,6 +1627,18 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_secondary_instance);
             break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_secondary_threaded);
+            break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_SKIP_ROLLBACK:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_skip_rollback);
+            break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_FRAMES_AUTO:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_frames_auto);
+            break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_DETECT_LAG:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_detect_lag);
+            break;
          case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_hide_warnings);
             break;
@@ -1593,6 +1651,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VRR_RUNLOOP_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_vrr_runloop_enable);
             break;
+         case MENU_ENUM_LABEL_MENU_SKIP_UNCHANGED_FRAMES:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_menu_skip_unchanged_frames);
+            break;
          case MENU_ENUM_LABEL_BLOCK_SRAM_OVERWRITE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_block_sram_overwrite);
             break;
@@ -1602,6 +1663,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_GPU_RECORD:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_gpu_record);
             break;
+         case MENU_ENUM_LABEL_VIDEO_STREAM_RECORD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_stream_record);
+            break;
+         case MENU_ENUM_LABEL_VIDEO_RECORD_HW_ENCODER:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_record_hw_encoder);
+            break;
          case MENU_ENUM_LABEL_VIDEO_FULLSCREEN:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_fullscreen);
             break;
@@ -1617,6 +1684,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_gpu_screenshot);
             break;
+         case MENU_ENUM_LABEL_SCREENSHOT_FAST_ENCODE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_screenshot_fast_encode);
+            break;
          case MENU_ENUM_LABEL_VIDEO_SCALE_INTEGER:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_scale_integer);
             break;
@@ -1635,6 +1705,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_FONT_SIZE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_font_size);
             break;
+         case MENU_ENUM_LABEL_VIDEO_FONT_SDF:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_font_sdf);
+            break;
          case MENU_ENUM_LABEL_VIDEO_MESSAGE_POS_X:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_message_pos_x);
             break;
@@ -1662,6 +1735,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_NETWORK_INFORMATION:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_network_information);
             break;
+         case MENU_ENUM_LABEL_SHADER_PASS_TIMES:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_shader_pass_times);
+            break;
          case MENU_ENUM_LABEL_SYSTEM_INFORMATION:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_system_information);
             break;
@@ -1719,6 +1795,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_DUMMY_ON_CORE_SHUTDOWN:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_dummy_on_core_shutdown);
             break;
+         case MENU_ENUM_LABEL_CORE_CACHE_ENABLE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_core_cache_enable);
+            break;
          case MENU_ENUM_LABEL_CHECK_FOR_MISSING_FIRMWARE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_dummy_check_missing_firmware);
             break;
@@ -1749,6 +1828,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_SYNC:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_sync);
             break;
+         case MENU_ENUM_LABEL_AUDIO_PULL:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_pull);
+            break;
          case MENU_ENUM_LABEL_AUDIO_VOLUME:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_volume);
             break;
@@ -1761,6 +1843,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_poll_type_behavior);
             break;
+         case MENU_ENUM_LABEL_INPUT_POLL_THREAD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_poll_thread);
+            break;
          case MENU_ENUM_LABEL_INPUT_MAX_USERS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_max_users);
             break;
@@ -1816,6 +1901,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_CHEEVOS_AUTO_SCREENSHOT:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheevos_auto_screenshot);
             break;
+         case MENU_ENUM_LABEL_CHEEVOS_THREADED:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheevos_threaded);
+            break;
          case MENU_ENUM_LABEL_CONFIG_SAVE_ON_EXIT:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_config_save_on_exit);
             break;
@@ -1828,6 +1916,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_THREADED:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_threaded);
             break;
+         case MENU_ENUM_LABEL_VIDEO_SHADER_PARALLEL_RECORD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_shader_parallel_record);
+            break;
+         case MENU_ENUM_LABEL_VIDEO_SHADER_DYNAMIC_SCALE_MIN:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_shader_dynamic_scale_min);
+            break;
          case MENU_ENUM_LABEL_VIDEO_HARD_SYNC:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_hard_sync);
             break;
@@ -1861,6 +1955,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_VIDEO_FRAME_DELAY:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_frame_delay);
             break;
+         case MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_frame_delay_auto);
+            break;
          case MENU_ENUM_LABEL_ADD_CONTENT_LIST:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_add_content_list);
             break;
@@ -1900,6 +1997,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_STATISTICS_SHOW:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_statistics_show);
             break;
+         case MENU_ENUM_LABEL_PERF_OVERLAY_SHOW:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_perf_overlay_show);
+            break;
          case MENU_ENUM_LABEL_FPS_SHOW:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_fps_show);
             break;
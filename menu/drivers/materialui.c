@@ -178,8 +178,6 @@ typedef struct materialui_handle
    /* One font for the menu entries, one font for the labels */
    font_data_t *font;
    font_data_t *font2;
-   video_font_raster_block_t raster_block;
-   video_font_raster_block_t raster_block2;
 
 } materialui_handle_t;
 
@@ -299,6 +297,7 @@ static const char *materialui_texture_path(unsigned id)
 static void materialui_context_reset_textures(materialui_handle_t *mui)
 {
    unsigned i;
+   const char *paths[MUI_TEXTURE_LAST];
    char *iconpath = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
 
    iconpath[0]    = '\0';
@@ -308,7 +307,11 @@ static void materialui_context_reset_textures(materialui_handle_t *mui)
          APPLICATION_SPECIAL_DIRECTORY_ASSETS_MATERIALUI_ICONS);
 
    for (i = 0; i < MUI_TEXTURE_LAST; i++)
-      menu_display_reset_textures_list(materialui_texture_path(i), iconpath, &mui->textures.list[i], TEXTURE_FILTER_MIPMAP_LINEAR);
+      paths[i] = materialui_texture_path(i);
+
+   menu_display_reset_textures_lists(paths, iconpath,
+         mui->textures.list, NULL, MUI_TEXTURE_LAST,
+         TEXTURE_FILTER_MIPMAP_LINEAR);
    free(iconpath);
 }
 
@@ -937,9 +940,6 @@ static void materialui_render_menu_list(
    unsigned header_height                  =
       menu_display_get_header_height();
 
-   mui->raster_block.carr.coords.vertices  = 0;
-   mui->raster_block2.carr.coords.vertices = 0;
-
    menu_entries_ctl(MENU_ENTRIES_CTL_START_GET, &i);
 
    list                                    =
@@ -1416,32 +1416,19 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
             highlighted_entry_color ? &highlighted_entry_color[0] : NULL
             );
 
-   font_driver_bind_block(mui->font, &mui->raster_block);
-   font_driver_bind_block(mui->font2, &mui->raster_block2);
-
-   if (menu_display_get_update_pending())
-      materialui_render_menu_list(
-            video_info,
-            mui,
-            width,
-            height,
-            font_normal_color,
-            font_hover_color,
-            active_tab_marker_color ? &active_tab_marker_color[0] : NULL,
-            sublabel_color
-            );
-
-   font_driver_flush(video_info->width, video_info->height, mui->font,
-         video_info);
-   font_driver_bind_block(mui->font, NULL);
-
-   font_driver_flush(video_info->width,
-         video_info->height,
-         mui->font2,
-         video_info);
-   font_driver_bind_block(mui->font2, NULL);
+   materialui_render_menu_list(
+         video_info,
+         mui,
+         width,
+         height,
+         font_normal_color,
+         font_hover_color,
+         active_tab_marker_color ? &active_tab_marker_color[0] : NULL,
+         sublabel_color
+         );
 
-   menu_animation_ctl(MENU_ANIMATION_CTL_SET_ACTIVE, NULL);
+   menu_display_font_flush(video_info, mui->font);
+   menu_display_font_flush(video_info, mui->font2);
 
    /* header */
    menu_display_draw_quad(
@@ -1564,6 +1551,8 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
             header_height / 2 + mui->font->size / 3,
             width, height, font_header_color, TEXT_ALIGN_LEFT, 1.0f, false, 0, false);
 
+   menu_display_font_flush(video_info, mui->font);
+
    materialui_draw_scrollbar(mui, video_info, width, height, &grey_bg[0]);
 
    if (menu_input_dialog_get_display_kb())
@@ -1591,6 +1580,8 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
       mui->box_message    = NULL;
    }
 
+   menu_display_font_flush(video_info, mui->font);
+
    if (mui->mouse_show)
       menu_display_draw_cursor(
             video_info,
@@ -1705,9 +1696,6 @@ static void materialui_free(void *data)
    if (!mui)
       return;
 
-   video_coord_array_free(&mui->raster_block.carr);
-   video_coord_array_free(&mui->raster_block2.carr);
-
    font_driver_bind_block(NULL, NULL);
 }
 
@@ -132,8 +132,7 @@ int generic_menu_iterate(menu_handle_t *menu, void *userdata, enum menu_action a
             file_list_t *selection_buf = menu_entries_get_selection_buf_ptr(0);
             size_t selection           = menu_navigation_get_selection();
             menu_file_list_cbs_t *cbs  = selection_buf ?
-               (menu_file_list_cbs_t*)
-			   file_list_get_actiondata_at_offset(selection_buf, selection)
+               menu_entries_get_actiondata(selection_buf, selection)
                : NULL;
 
             if (cbs && cbs->enum_idx != MSG_UNKNOWN)
@@ -294,6 +294,11 @@ void nk_common_device_draw(struct nk_device *dev,
 #endif
 
    menu_display_blend_end();
+
+#if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
+   /* The bindings above went around the GL state cache. */
+   gl_state_invalidate();
+#endif
 }
 
 void* nk_common_mem_alloc(nk_handle a, void *old, nk_size b)
@@ -267,13 +267,6 @@ static void ozone_free(void *data)
 
    if (ozone)
    {
-      video_coord_array_free(&ozone->raster_blocks.footer.carr);
-      video_coord_array_free(&ozone->raster_blocks.title.carr);
-      video_coord_array_free(&ozone->raster_blocks.time.carr);
-      video_coord_array_free(&ozone->raster_blocks.entries_label.carr);
-      video_coord_array_free(&ozone->raster_blocks.entries_sublabel.carr);
-      video_coord_array_free(&ozone->raster_blocks.sidebar.carr);
-
       font_driver_bind_block(NULL, NULL);
 
       if (ozone->selection_buf_old)
@@ -299,6 +292,8 @@ static void ozone_context_reset(void *data, bool is_threaded)
    unsigned i;
    unsigned size;
    char font_path[PATH_MAX_LENGTH];
+   const char *icon_paths[OZONE_ENTRIES_ICONS_TEXTURE_LAST];
+   bool icons_loaded[OZONE_ENTRIES_ICONS_TEXTURE_LAST];
 
    ozone_handle_t *ozone = (ozone_handle_t*) data;
 
@@ -378,7 +373,14 @@ static void ozone_context_reset(void *data, bool is_threaded)
 
       /* Icons textures init */
       for (i = 0; i < OZONE_ENTRIES_ICONS_TEXTURE_LAST; i++)
-         if (!menu_display_reset_textures_list(ozone_entries_icon_texture_path(i), ozone->icons_path, &ozone->icons_textures[i], TEXTURE_FILTER_MIPMAP_LINEAR))
+         icon_paths[i] = ozone_entries_icon_texture_path(i);
+
+      menu_display_reset_textures_lists(icon_paths, ozone->icons_path,
+            ozone->icons_textures, icons_loaded,
+            OZONE_ENTRIES_ICONS_TEXTURE_LAST, TEXTURE_FILTER_MIPMAP_LINEAR);
+
+      for (i = 0; i < OZONE_ENTRIES_ICONS_TEXTURE_LAST; i++)
+         if (!icons_loaded[i])
          {
             ozone->has_all_assets = false;
             RARCH_WARN("[OZONE] Asset missing: %s%s%s\n", ozone->icons_path, path_default_slash(), ozone_entries_icon_texture_path(i));
@@ -1159,21 +1161,6 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
 
    menu_display_set_viewport(video_info->width, video_info->height);
 
-   /* Clear text */
-   font_driver_bind_block(ozone->fonts.footer,  &ozone->raster_blocks.footer);
-   font_driver_bind_block(ozone->fonts.title,  &ozone->raster_blocks.title);
-   font_driver_bind_block(ozone->fonts.time,  &ozone->raster_blocks.time);
-   font_driver_bind_block(ozone->fonts.entries_label,  &ozone->raster_blocks.entries_label);
-   font_driver_bind_block(ozone->fonts.entries_sublabel,  &ozone->raster_blocks.entries_sublabel);
-   font_driver_bind_block(ozone->fonts.sidebar,  &ozone->raster_blocks.sidebar);
-
-   ozone->raster_blocks.footer.carr.coords.vertices = 0;
-   ozone->raster_blocks.title.carr.coords.vertices = 0;
-   ozone->raster_blocks.time.carr.coords.vertices = 0;
-   ozone->raster_blocks.entries_label.carr.coords.vertices = 0;
-   ozone->raster_blocks.entries_sublabel.carr.coords.vertices = 0;
-   ozone->raster_blocks.sidebar.carr.coords.vertices = 0;
-
    /* Background */
    menu_display_draw_quad(video_info,
       0, 0, video_info->width, video_info->height,
@@ -1217,18 +1204,11 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
    menu_display_scissor_end(video_info);
 
    /* Flush first layer of text */
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.footer, video_info);
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.title, video_info);
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.time, video_info);
-
-   font_driver_bind_block(ozone->fonts.footer, NULL);
-   font_driver_bind_block(ozone->fonts.title, NULL);
-   font_driver_bind_block(ozone->fonts.time, NULL);
-   font_driver_bind_block(ozone->fonts.entries_label, NULL);
+   menu_display_font_flush(video_info, ozone->fonts.footer);
+   menu_display_font_flush(video_info, ozone->fonts.title);
+   menu_display_font_flush(video_info, ozone->fonts.time);
 
    /* Message box & OSK - second layer of text */
-   ozone->raster_blocks.footer.carr.coords.vertices = 0;
-   ozone->raster_blocks.entries_label.carr.coords.vertices = 0;
 
    if (ozone->should_draw_messagebox || draw_osk)
    {
@@ -1285,8 +1265,8 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
       }
    }
 
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.footer, video_info);
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.entries_label, video_info);
+   menu_display_font_flush(video_info, ozone->fonts.footer);
+   menu_display_font_flush(video_info, ozone->fonts.entries_label);
 
    menu_display_unset_viewport(video_info->width, video_info->height);
 }
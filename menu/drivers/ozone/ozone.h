@@ -56,16 +56,6 @@ struct ozone_handle
       font_data_t *sidebar;
    } fonts;
 
-   struct
-   {
-      video_font_raster_block_t footer;
-      video_font_raster_block_t title;
-      video_font_raster_block_t time;
-      video_font_raster_block_t entries_label;
-      video_font_raster_block_t entries_sublabel;
-      video_font_raster_block_t sidebar;
-   } raster_blocks;
-
    menu_texture_item textures[OZONE_THEME_TEXTURE_LAST];
    menu_texture_item icons_textures[OZONE_ENTRIES_ICONS_TEXTURE_LAST];
    menu_texture_item tab_textures[OZONE_TAB_TEXTURE_LAST];
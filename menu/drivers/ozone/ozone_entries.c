@@ -315,6 +315,6 @@ icons_iterate:
    }
 
    /* Text layer */
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.entries_label, video_info);
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.entries_sublabel, video_info);
+   menu_display_font_flush(video_info, ozone->fonts.entries_label);
+   menu_display_font_flush(video_info, ozone->fonts.entries_sublabel);
 }
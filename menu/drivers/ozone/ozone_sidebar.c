@@ -227,8 +227,7 @@ console_iterate:
 
    }
 
-   font_driver_flush(video_info->width, video_info->height, ozone->fonts.sidebar, video_info);
-   ozone->raster_blocks.sidebar.carr.coords.vertices = 0;
+   menu_display_font_flush(video_info, ozone->fonts.sidebar);
 
    menu_display_scissor_end(video_info);
 }
@@ -381,8 +380,7 @@ void ozone_change_tab(ozone_handle_t *ozone,
    file_list_t *selection_buf = menu_entries_get_selection_buf_ptr(0);
    size_t selection = menu_navigation_get_selection();
    menu_file_list_cbs_t *cbs = selection_buf ?
-      (menu_file_list_cbs_t*)file_list_get_actiondata_at_offset(selection_buf,
-            selection) : NULL;
+      menu_entries_get_actiondata(selection_buf, selection) : NULL;
 
    list_info.type = MENU_LIST_HORIZONTAL;
    list_info.action = MENU_ACTION_LEFT;
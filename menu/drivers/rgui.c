@@ -69,6 +69,12 @@ typedef struct
 
 static uint16_t *rgui_framebuf_data      = NULL;
 
+/* Copy of what the video driver was last handed, so that only
+ * the rows that changed since get uploaded again. */
+static uint16_t *rgui_upload_data        = NULL;
+static unsigned rgui_upload_width        = 0;
+static unsigned rgui_upload_height       = 0;
+
 #if defined(GEKKO)|| defined(PSP)
 #define HOVER_COLOR(settings)    ((3 << 0) | (10 << 4) | (3 << 8) | (7 << 12))
 #define NORMAL_COLOR(settings)   0x7FFF
@@ -127,6 +133,11 @@ static uint16_t rgui_green_filler(rgui_t *rgui, unsigned x, unsigned y)
 #endif
 }
 
+/* Both fillers are checkerboards that repeat every
+ * RGUI_FILLER_PERIOD rows, so only those get computed
+ * and the rest of the rectangle is copied from them. */
+#define RGUI_FILLER_PERIOD 4
+
 static void rgui_fill_rect(
       rgui_t *rgui,
       uint16_t *data,
@@ -136,10 +147,16 @@ static void rgui_fill_rect(
       uint16_t (*col)(rgui_t *rgui, unsigned x, unsigned y))
 {
    unsigned i, j;
+   size_t stride = pitch >> 1;
 
-   for (j = y; j < y + height; j++)
+   for (j = y; j < y + height && j < y + RGUI_FILLER_PERIOD; j++)
       for (i = x; i < x + width; i++)
-         data[j * (pitch >> 1) + i] = col(rgui, i, j);
+         data[j * stride + i] = col(rgui, i, j);
+
+   for (; j < y + height; j++)
+      memcpy(&data[j * stride + x],
+            &data[(j - RGUI_FILLER_PERIOD) * stride + x],
+            width * sizeof(uint16_t));
 }
 
 static void rgui_color_rect(
@@ -151,11 +168,21 @@ static void rgui_color_rect(
       uint16_t color)
 {
    unsigned i, j;
+   size_t stride = pitch >> 1;
+
+   if (x >= fb_width || y >= fb_height)
+      return;
+
+   width  = MIN(width,  fb_width  - x);
+   height = MIN(height, fb_height - y);
 
    for (j = y; j < y + height; j++)
-      for (i = x; i < x + width; i++)
-         if (i < fb_width && j < fb_height)
-            data[j * (pitch >> 1) + i] = color;
+   {
+      uint16_t *dst = &data[j * stride + x];
+
+      for (i = 0; i < width; i++)
+         dst[i] = color;
+   }
 }
 
 static void blit_line(int x, int y,
@@ -163,27 +190,33 @@ static void blit_line(int x, int y,
 {
    size_t pitch = menu_display_get_framebuffer_pitch();
    const uint8_t *font_fb = menu_display_get_font_framebuffer();
+   size_t stride = pitch >> 1;
 
    if (font_fb)
    {
       while (!string_is_empty(message))
       {
-         unsigned i, j;
-         char symbol = *message++;
+         unsigned i, j, bit;
+         const uint8_t *glyph;
+         uint16_t *dst;
+         uint8_t symbol = (uint8_t)*message++;
 
-         for (j = 0; j < FONT_HEIGHT; j++)
+         /* Entries are padded with these, and they're empty. */
+         if (symbol == ' ')
          {
-            for (i = 0; i < FONT_WIDTH; i++)
-            {
-               uint8_t rem = 1 << ((i + j * FONT_WIDTH) & 7);
-               int offset  = (i + j * FONT_WIDTH) >> 3;
-               bool col    = (font_fb[FONT_OFFSET(symbol) + offset] & rem);
-
-               if (col)
-                  rgui_framebuf_data[(y + j) * (pitch >> 1) + (x + i)] = color;
-            }
+            x += FONT_WIDTH_STRIDE;
+            continue;
          }
 
+         glyph = font_fb + FONT_OFFSET(symbol);
+         dst   = rgui_framebuf_data + y * stride + x;
+         bit   = 0;
+
+         for (j = 0; j < FONT_HEIGHT; j++, dst += stride)
+            for (i = 0; i < FONT_WIDTH; i++, bit++)
+               if (glyph[bit >> 3] & (1 << (bit & 7)))
+                  dst[i] = color;
+
          x += FONT_WIDTH_STRIDE;
       }
    }
@@ -717,7 +750,12 @@ static void rgui_framebuffer_free(void)
 {
    if (rgui_framebuf_data)
       free(rgui_framebuf_data);
+   if (rgui_upload_data)
+      free(rgui_upload_data);
    rgui_framebuf_data = NULL;
+   rgui_upload_data   = NULL;
+   rgui_upload_width  = 0;
+   rgui_upload_height = 0;
 }
 
 static void *rgui_init(void **userdata, bool video_is_threaded)
@@ -746,6 +784,12 @@ static void *rgui_init(void **userdata, bool video_is_threaded)
    if (!rgui_framebuf_data)
       goto error;
 
+   /* Not having it only means full uploads */
+   rgui_upload_data   = (uint16_t*)
+      malloc(400 * 240 * sizeof(uint16_t));
+   rgui_upload_width  = 0;
+   rgui_upload_height = 0;
+
    fb_width                   = 320;
    fb_height                  = 240;
    fb_pitch                   = fb_width * sizeof(uint16_t);
@@ -800,6 +844,8 @@ static void rgui_set_texture(void)
 {
    size_t fb_pitch;
    unsigned fb_width, fb_height;
+   unsigned first, last;
+   size_t row_size;
 
    if (!menu_display_get_framebuffer_dirty_flag())
       return;
@@ -809,8 +855,54 @@ static void rgui_set_texture(void)
 
    menu_display_unset_framebuffer_dirty_flag();
 
-   video_driver_set_texture_frame(rgui_framebuf_data,
-         false, fb_width, fb_height, 1.0f);
+   row_size = fb_width * sizeof(uint16_t);
+
+   if (     !rgui_upload_data
+         || rgui_upload_width  != fb_width
+         || rgui_upload_height != fb_height)
+   {
+      video_driver_set_texture_frame(rgui_framebuf_data,
+            false, fb_width, fb_height, 1.0f);
+
+      if (rgui_upload_data)
+      {
+         memcpy(rgui_upload_data, rgui_framebuf_data,
+               fb_height * row_size);
+         rgui_upload_width  = fb_width;
+         rgui_upload_height = fb_height;
+      }
+      return;
+   }
+
+   /* Redraws rebuild the whole framebuffer, but mostly
+    * only a ticker or the cursor moved. */
+   for (first = 0; first < fb_height; first++)
+      if (memcmp(rgui_framebuf_data + first * fb_width,
+               rgui_upload_data + first * fb_width, row_size))
+         break;
+
+   if (first == fb_height)
+      return;
+
+   for (last = fb_height - 1; last > first; last--)
+      if (memcmp(rgui_framebuf_data + last * fb_width,
+               rgui_upload_data + last * fb_width, row_size))
+         break;
+
+   memcpy(rgui_upload_data + first * fb_width,
+         rgui_framebuf_data + first * fb_width,
+         (last - first + 1) * row_size);
+
+   video_driver_set_texture_frame_rows(rgui_framebuf_data,
+         false, fb_width, fb_height, first, last - first + 1, 1.0f);
+}
+
+static void rgui_context_reset(void *data, bool is_threaded)
+{
+   /* The texture went away with the old context */
+   rgui_upload_width  = 0;
+   rgui_upload_height = 0;
+   menu_display_set_framebuffer_dirty_flag();
 }
 
 static void rgui_navigation_clear(void *data, bool pending_push)
@@ -943,7 +1035,7 @@ menu_ctx_driver_t menu_ctx_rgui = {
    rgui_frame,
    rgui_init,
    rgui_free,
-   NULL,
+   rgui_context_reset,
    NULL,
    rgui_populate_entries,
    NULL,
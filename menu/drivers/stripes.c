@@ -285,8 +285,6 @@ typedef struct stripes_handle
 
    font_data_t *font;
    font_data_t *font2;
-   video_font_raster_block_t raster_block;
-   video_font_raster_block_t raster_block2;
 } stripes_handle_t;
 
 float stripes_scale_mod[8] = {
@@ -2838,12 +2836,6 @@ static void stripes_frame(void *data, video_frame_info_t *video_info)
    title_msg[0]       = '\0';
    title_truncated[0] = '\0';
 
-   font_driver_bind_block(stripes->font,  &stripes->raster_block);
-   font_driver_bind_block(stripes->font2, &stripes->raster_block2);
-
-   stripes->raster_block.carr.coords.vertices  = 0;
-   stripes->raster_block2.carr.coords.vertices = 0;
-
    menu_display_set_alpha(stripes_coord_black, MIN(
          (float)video_info->xmb_alpha_factor/100, stripes->alpha));
    menu_display_set_alpha(stripes_coord_white, stripes->alpha);
@@ -2982,13 +2974,8 @@ static void stripes_frame(void *data, video_frame_info_t *video_info)
 //             width,
 //             height);
 
-   font_driver_flush(video_info->width, video_info->height, stripes->font,
-         video_info);
-   font_driver_bind_block(stripes->font, NULL);
-
-   font_driver_flush(video_info->width, video_info->height, stripes->font2,
-         video_info);
-   font_driver_bind_block(stripes->font2, NULL);
+   menu_display_font_flush(video_info, stripes->font);
+   menu_display_font_flush(video_info, stripes->font2);
 
    if (menu_input_dialog_get_display_kb())
    {
@@ -3013,6 +3000,7 @@ static void stripes_frame(void *data, video_frame_info_t *video_info)
       stripes_draw_dark_layer(stripes, video_info, width, height);
       stripes_render_messagebox_internal(
             video_info, stripes, msg);
+      menu_display_font_flush(video_info, stripes->font);
    }
 
    /* Cursor image */
@@ -3409,9 +3397,6 @@ static void stripes_free(void *data)
       stripes->selection_buf_old = NULL;
       stripes->horizontal_list   = NULL;
 
-      video_coord_array_free(&stripes->raster_block.carr);
-      video_coord_array_free(&stripes->raster_block2.carr);
-
       if (!string_is_empty(stripes->box_message))
          free(stripes->box_message);
       if (!string_is_empty(stripes->thumbnail_system))
@@ -3623,9 +3608,14 @@ static void stripes_context_reset_textures(
       stripes_handle_t *stripes, const char *iconpath)
 {
    unsigned i;
+   const char *paths[STRIPES_TEXTURE_LAST];
 
    for (i = 0; i < STRIPES_TEXTURE_LAST; i++)
-      menu_display_reset_textures_list(stripes_texture_path(i), iconpath, &stripes->textures.list[i], TEXTURE_FILTER_MIPMAP_LINEAR);
+      paths[i] = stripes_texture_path(i);
+
+   menu_display_reset_textures_lists(paths, iconpath,
+         stripes->textures.list, NULL, STRIPES_TEXTURE_LAST,
+         TEXTURE_FILTER_MIPMAP_LINEAR);
 
    menu_display_allocate_white_texture();
 
@@ -45,6 +45,7 @@
 #include "../menu_animation.h"
 #include "../menu_entries.h"
 #include "../menu_input.h"
+#include "../menu_thumbnail_cache.h"
 
 #include "../../core_info.h"
 #include "../../core.h"
@@ -307,6 +308,10 @@ typedef struct xmb_handle
    char *savestate_thumbnail_file_path;
    char *thumbnail_file_path;
    char *left_thumbnail_file_path;
+   /* What thumbnail and left_thumbnail show, looked up in the
+    * thumbnail cache every frame. */
+   char *thumbnail_cache_path;
+   char *left_thumbnail_cache_path;
    char *bg_file_path;
 
    file_list_t *selection_buf_old;
@@ -334,8 +339,6 @@ typedef struct xmb_handle
 
    font_data_t *font;
    font_data_t *font2;
-   video_font_raster_block_t raster_block;
-   video_font_raster_block_t raster_block2;
 } xmb_handle_t;
 
 float scale_mod[8] = {
@@ -939,6 +942,18 @@ end:
    string_list_free(list);
 }
 
+/* Takes ownership of @path, NULL hides the thumbnail. */
+static void xmb_set_thumbnail_cache_path(xmb_handle_t *xmb, char pos,
+      char *path)
+{
+   char **cache_path = (pos == 'R') ?
+      &xmb->thumbnail_cache_path : &xmb->left_thumbnail_cache_path;
+
+   if (*cache_path)
+      free(*cache_path);
+   *cache_path = path;
+}
+
 static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
 {
    menu_entry_t entry;
@@ -980,7 +995,7 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
    }
    else if (filebrowser_get_type() != FILEBROWSER_NONE)
    {
-      video_driver_texture_unload(&xmb->thumbnail);
+      xmb_set_thumbnail_cache_path(xmb, 'R', NULL);
       goto end;
    }
 
@@ -1008,7 +1023,7 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
                      sizeof(new_path));
          }
          else
-            video_driver_texture_unload(&xmb->left_thumbnail);
+            xmb_set_thumbnail_cache_path(xmb, 'L', NULL);
          goto end;
       }
    }
@@ -1155,27 +1170,20 @@ static void xmb_update_thumbnail_image(void *data)
    if (!xmb)
       return;
 
+   /* Missing files come back as MENU_THUMBNAIL_MISSING, which
+    * xmb_resolve_thumbnail() shows as nothing. */
    if (!(string_is_empty(xmb->thumbnail_file_path)))
    {
-      if (filestream_exists(xmb->thumbnail_file_path))
-         task_push_image_load(xmb->thumbnail_file_path,
-               menu_display_handle_thumbnail_upload, NULL);
-      else
-         video_driver_texture_unload(&xmb->thumbnail);
-
-      free(xmb->thumbnail_file_path);
+      menu_thumbnail_cache_fetch(xmb->thumbnail_file_path, false);
+      xmb_set_thumbnail_cache_path(xmb, 'R', xmb->thumbnail_file_path);
       xmb->thumbnail_file_path = NULL;
    }
 
    if (!(string_is_empty(xmb->left_thumbnail_file_path)))
    {
-      if (filestream_exists(xmb->left_thumbnail_file_path))
-         task_push_image_load(xmb->left_thumbnail_file_path,
-               menu_display_handle_left_thumbnail_upload, NULL);
-      else
-         video_driver_texture_unload(&xmb->left_thumbnail);
-
-      free(xmb->left_thumbnail_file_path);
+      menu_thumbnail_cache_fetch(xmb->left_thumbnail_file_path, false);
+      xmb_set_thumbnail_cache_path(xmb, 'L',
+            xmb->left_thumbnail_file_path);
       xmb->left_thumbnail_file_path = NULL;
    }
 }
@@ -1225,6 +1233,97 @@ static void xmb_update_savestate_thumbnail_image(void *data)
       video_driver_texture_unload(&xmb->savestate_thumbnail);
 }
 
+static bool xmb_prefetch_thumbnail(xmb_handle_t *xmb, unsigned i,
+      char pos)
+{
+   bool ret    = true;
+   char **path = (pos == 'R') ?
+      &xmb->thumbnail_file_path : &xmb->left_thumbnail_file_path;
+
+   xmb_update_thumbnail_path(xmb, i, pos);
+
+   if (!string_is_empty(*path))
+      ret = menu_thumbnail_cache_fetch(*path, true);
+
+   if (*path)
+      free(*path);
+   *path = NULL;
+
+   return ret;
+}
+
+/* Queues the thumbnails of the playlist entries around @selection,
+ * closest first, so they are resident by the time we scroll there. */
+static void xmb_prefetch_thumbnails(xmb_handle_t *xmb,
+      unsigned selection, unsigned size)
+{
+   unsigned d;
+   char *content       = xmb->thumbnail_content;
+   char *cache_path    = xmb->thumbnail_cache_path;
+   char *left_path     = xmb->left_thumbnail_cache_path;
+   bool right_enabled  = !string_is_equal(xmb_thumbnails_ident('R'),
+         msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF));
+   bool left_enabled   = !string_is_equal(xmb_thumbnails_ident('L'),
+         msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF));
+
+   /* xmb_update_thumbnail_path() works on the selection's state,
+    * lend it a blank one per neighbour. */
+   xmb->thumbnail_content          = NULL;
+   xmb->thumbnail_cache_path       = NULL;
+   xmb->left_thumbnail_cache_path  = NULL;
+
+   for (d = 1; d <= MENU_THUMBNAIL_CACHE_PREFETCH * 2; d++)
+   {
+      menu_entry_t entry;
+      unsigned i = (d & 1) ?
+         selection + (d + 1) / 2 : selection - d / 2;
+
+      if (i >= size)
+         continue;
+
+      menu_entry_init(&entry);
+      menu_entry_get(&entry, 0, i, NULL, true);
+
+      xmb_reset_thumbnail_content(xmb);
+      if (!string_is_empty(entry.path))
+         xmb_set_thumbnail_content(xmb, entry.path, 0 /* will be ignored */);
+
+      menu_entry_free(&entry);
+
+      if (right_enabled && !xmb_prefetch_thumbnail(xmb, i, 'R'))
+         break;
+      if (left_enabled  && !xmb_prefetch_thumbnail(xmb, i, 'L'))
+         break;
+   }
+
+   xmb_reset_thumbnail_content(xmb);
+   xmb_set_thumbnail_cache_path(xmb, 'R', cache_path);
+   xmb_set_thumbnail_cache_path(xmb, 'L', left_path);
+   xmb->thumbnail_content = content;
+}
+
+static void xmb_resolve_thumbnail(const char *path,
+      uintptr_t *texture, float width, float *height)
+{
+   menu_thumbnail_t thumb;
+
+   *texture = 0;
+
+   switch (menu_thumbnail_cache_get(path, &thumb))
+   {
+      case MENU_THUMBNAIL_READY:
+         *texture = thumb.texture;
+         *height  = width * (float)thumb.height / (float)thumb.width;
+         break;
+      case MENU_THUMBNAIL_NONE:
+         /* Evicted, or the context was reset. */
+         menu_thumbnail_cache_fetch(path, false);
+         break;
+      default:
+         break;
+   }
+}
+
 static unsigned xmb_get_system_tab(xmb_handle_t *xmb, unsigned i)
 {
    if (i <= xmb->system_tab_end)
@@ -1309,6 +1408,7 @@ static void xmb_selection_pointer_changed(
                   xmb_update_thumbnail_path(xmb, i, 'L');
                   xmb_update_thumbnail_image(xmb);
                }
+               xmb_prefetch_thumbnails(xmb, i, end);
             }
             else if (((entry_type == FILE_TYPE_IMAGE || entry_type == FILE_TYPE_IMAGEVIEWER ||
                         entry_type == FILE_TYPE_RDB || entry_type == FILE_TYPE_RDB_ENTRY)
@@ -3136,6 +3236,14 @@ static void xmb_render(void *data, bool is_idle)
     if (!xmb)
       return;
 
+   /* Here rather than in xmb_frame(), which may run on the video
+    * thread while the cache is only ever touched from this one. */
+   xmb_resolve_thumbnail(xmb->thumbnail_cache_path, &xmb->thumbnail,
+         xmb->thumbnail_width, &xmb->thumbnail_height);
+   xmb_resolve_thumbnail(xmb->left_thumbnail_cache_path,
+         &xmb->left_thumbnail, xmb->left_thumbnail_width,
+         &xmb->left_thumbnail_height);
+
    video_driver_get_size(&width, &height);
 
    scale_factor = (settings->uints.menu_xmb_scale_factor * (float)width) / (1920.0 * 100);
@@ -3274,6 +3382,9 @@ static void xmb_draw_bg(
       }
 
       menu_display_draw_pipeline(&draw, video_info);
+
+      /* The shader background moves on its own. */
+      menu_animation_ctl(MENU_ANIMATION_CTL_SET_ACTIVE, NULL);
    }
    else
 #endif
@@ -3385,12 +3496,6 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
    title_msg[0]       = '\0';
    title_truncated[0] = '\0';
 
-   font_driver_bind_block(xmb->font,  &xmb->raster_block);
-   font_driver_bind_block(xmb->font2, &xmb->raster_block2);
-
-   xmb->raster_block.carr.coords.vertices  = 0;
-   xmb->raster_block2.carr.coords.vertices = 0;
-
    menu_display_set_alpha(coord_black, MIN(
             (float)video_info->xmb_alpha_factor/100, xmb->alpha));
    menu_display_set_alpha(coord_white, xmb->alpha);
@@ -4082,13 +4187,8 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
             width,
             height);
 
-   font_driver_flush(video_info->width, video_info->height, xmb->font,
-         video_info);
-   font_driver_bind_block(xmb->font, NULL);
-
-   font_driver_flush(video_info->width, video_info->height, xmb->font2,
-         video_info);
-   font_driver_bind_block(xmb->font2, NULL);
+   menu_display_font_flush(video_info, xmb->font);
+   menu_display_font_flush(video_info, xmb->font2);
 
    if (menu_input_dialog_get_display_kb())
    {
@@ -4113,6 +4213,7 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
       xmb_draw_dark_layer(xmb, video_info, width, height);
       xmb_render_messagebox_internal(
             video_info, xmb, msg);
+      menu_display_font_flush(video_info, xmb->font);
    }
 
    /* Cursor image */
@@ -4551,9 +4652,6 @@ static void xmb_free(void *data)
       xmb->selection_buf_old = NULL;
       xmb->horizontal_list   = NULL;
 
-      video_coord_array_free(&xmb->raster_block.carr);
-      video_coord_array_free(&xmb->raster_block2.carr);
-
       if (!string_is_empty(xmb->box_message))
          free(xmb->box_message);
       if (!string_is_empty(xmb->thumbnail_system))
@@ -4566,6 +4664,10 @@ static void xmb_free(void *data)
          free(xmb->thumbnail_file_path);
       if (!string_is_empty(xmb->left_thumbnail_file_path))
          free(xmb->left_thumbnail_file_path);
+      if (xmb->thumbnail_cache_path)
+         free(xmb->thumbnail_cache_path);
+      if (xmb->left_thumbnail_cache_path)
+         free(xmb->left_thumbnail_cache_path);
       if (!string_is_empty(xmb->bg_file_path))
          free(xmb->bg_file_path);
    }
@@ -4601,24 +4703,8 @@ static bool xmb_load_image(void *userdata, void *data, enum menu_image_type type
          menu_display_allocate_white_texture();
          break;
       case MENU_IMAGE_THUMBNAIL:
-         {
-            struct texture_image *img  = (struct texture_image*)data;
-            xmb->thumbnail_height      = xmb->thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->thumbnail);
-         }
-         break;
       case MENU_IMAGE_LEFT_THUMBNAIL:
-         {
-            struct texture_image *img  = (struct texture_image*)data;
-            xmb->left_thumbnail_height      = xmb->left_thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->left_thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->left_thumbnail);
-         }
+         /* Loaded through the thumbnail cache. */
          break;
       case MENU_IMAGE_SAVESTATE_THUMBNAIL:
          {
@@ -4873,12 +4959,21 @@ static void xmb_context_reset_textures(
       xmb_handle_t *xmb, const char *iconpath)
 {
    unsigned i;
+   const char *paths[XMB_TEXTURE_LAST];
+   bool loaded[XMB_TEXTURE_LAST];
    settings_t *settings = config_get_ptr();
    xmb->assets_missing = false;
 
+   for (i = 0; i < XMB_TEXTURE_LAST; i++)
+      paths[i] = xmb_texture_path(i);
+
+   menu_display_reset_textures_lists(paths, iconpath,
+         xmb->textures.list, loaded, XMB_TEXTURE_LAST,
+         TEXTURE_FILTER_MIPMAP_LINEAR);
+
    for (i = 0; i < XMB_TEXTURE_LAST; i++)
    {
-      if (!menu_display_reset_textures_list(xmb_texture_path(i), iconpath, &xmb->textures.list[i], TEXTURE_FILTER_MIPMAP_LINEAR))
+      if (!loaded[i])
       {
          RARCH_WARN("[XMB] Asset missing: %s%s\n", iconpath, xmb_texture_path(i));
          /* If the icon is missing return the subsetting (because some themes are incomplete) */
@@ -5359,8 +5454,9 @@ static void xmb_context_destroy(void *data)
    for (i = 0; i < XMB_TEXTURE_LAST; i++)
       video_driver_texture_unload(&xmb->textures.list[i]);
 
-   video_driver_texture_unload(&xmb->thumbnail);
-   video_driver_texture_unload(&xmb->left_thumbnail);
+   menu_thumbnail_cache_clear();
+   xmb->thumbnail      = 0;
+   xmb->left_thumbnail = 0;
    video_driver_texture_unload(&xmb->savestate_thumbnail);
 
    xmb_context_destroy_horizontal_list(xmb);
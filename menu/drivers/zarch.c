@@ -105,7 +105,6 @@ typedef struct zarch_handle
    math_matrix_4x4 mvp;
    unsigned width;
    unsigned height;
-   video_font_raster_block_t tmp_block;
    unsigned hash;
    uint64_t frame_count;
 
@@ -913,10 +912,6 @@ static void zarch_frame(void *data, video_frame_info_t *video_info)
 
    menu_display_coords_array_reset();
 
-   zui->tmp_block.carr.coords.vertices = 0;
-
-   font_driver_bind_block(zui->font, &zui->tmp_block);
-
    menu_display_push_quad(zui->width, zui->height, zui_bg_screen,
          0, 0, zui->width, zui->height);
    menu_display_snow(zui->width, zui->height);
@@ -995,9 +990,7 @@ static void zarch_frame(void *data, video_frame_info_t *video_info)
 
    zui->rendering = false;
 
-   font_driver_flush(video_info->width, video_info->height, zui->font,
-         video_info);
-   font_driver_bind_block(zui->font, NULL);
+   menu_display_font_flush(video_info, zui->font);
 
    menu_display_unset_viewport(video_info->width, video_info->height);
 }
@@ -1034,11 +1027,6 @@ error:
 
 static void zarch_free(void *data)
 {
-   zui_t        *zui                       = (zui_t*)data;
-
-   if (zui)
-      video_coord_array_free(&zui->tmp_block.carr);
-
    font_driver_bind_block(NULL, NULL);
 }
 
@@ -98,14 +98,11 @@ static void menu_display_d3d12_draw(menu_display_ctx_draw_t *draw,
    if (!d3d12->sprites.enabled || vertex_count > d3d12->sprites.capacity)
       return;
 
-   if (d3d12->sprites.offset + vertex_count > d3d12->sprites.capacity)
-      d3d12->sprites.offset = 0;
-
    {
-      d3d12_sprite_t* sprite;
-      D3D12_RANGE     range = { 0, 0 };
-      D3D12Map(d3d12->sprites.vbo, 0, &range, (void**)&sprite);
-      sprite += d3d12->sprites.offset;
+      d3d12_sprite_t* sprite = d3d12_alloc_sprites(d3d12, vertex_count);
+
+      if (!sprite)
+         return;
 
       if (vertex_count == 1)
       {
@@ -167,10 +164,6 @@ static void menu_display_d3d12_draw(menu_display_ctx_draw_t *draw,
          D3D12IASetPrimitiveTopology(d3d12->queue.cmd,
                D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
       }
-
-      range.Begin = d3d12->sprites.offset * sizeof(*sprite);
-      range.End   = (d3d12->sprites.offset + vertex_count) * sizeof(*sprite);
-      D3D12Unmap(d3d12->sprites.vbo, 0, &range);
    }
 
    {
@@ -190,8 +183,7 @@ static void menu_display_d3d12_draw(menu_display_ctx_draw_t *draw,
       d3d12_set_texture_and_sampler(d3d12->queue.cmd, texture);
    }
 
-   D3D12DrawInstanced(d3d12->queue.cmd, vertex_count, 1, d3d12->sprites.offset, 0);
-   d3d12->sprites.offset += vertex_count;
+   D3D12DrawInstanced(d3d12->queue.cmd, vertex_count, 1, 0, 0);
 
    if (vertex_count > 1)
    {
@@ -254,14 +246,16 @@ static void menu_display_d3d12_draw_pipeline(menu_display_ctx_draw_t *draw,
    d3d12->ubo_values.time += 0.01f;
 
    {
-      D3D12_RANGE      read_range = { 0, 0 };
-      d3d12_uniform_t* mapped_ubo;
-      D3D12Map(d3d12->ubo, 0, &read_range, (void**)&mapped_ubo);
+      D3D12_GPU_VIRTUAL_ADDRESS gpu;
+      d3d12_uniform_t*          mapped_ubo = (d3d12_uniform_t*)d3d12_upload_ring_alloc(
+            d3d12, sizeof(*mapped_ubo), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, &gpu);
+
+      if (!mapped_ubo)
+         return;
+
       *mapped_ubo = d3d12->ubo_values;
-      D3D12Unmap(d3d12->ubo, 0, NULL);
+      D3D12SetGraphicsRootConstantBufferView(d3d12->queue.cmd, ROOT_ID_UBO, gpu);
    }
-   D3D12SetGraphicsRootConstantBufferView(
-         d3d12->queue.cmd, ROOT_ID_UBO, d3d12->ubo_view.BufferLocation);
 }
 
 static void menu_display_d3d12_restore_clear_color(void) {}
@@ -81,8 +81,8 @@ static void menu_display_gl_blend_begin(video_frame_info_t *video_info)
 {
    video_shader_ctx_info_t shader_info;
 
-   glEnable(GL_BLEND);
-   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+   gl_state_blend(true);
+   gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
    shader_info.data       = NULL;
    shader_info.idx        = VIDEO_SHADER_STOCK_BLEND;
@@ -93,14 +93,14 @@ static void menu_display_gl_blend_begin(video_frame_info_t *video_info)
 
 static void menu_display_gl_blend_end(video_frame_info_t *video_info)
 {
-   glDisable(GL_BLEND);
+   gl_state_blend(false);
 }
 
 static void menu_display_gl_viewport(menu_display_ctx_draw_t *draw,
       video_frame_info_t *video_info)
 {
    if (draw)
-      glViewport(draw->x, draw->y, draw->width, draw->height);
+      gl_state_viewport(draw->x, draw->y, draw->width, draw->height);
 }
 
 static void menu_display_gl_draw(menu_display_ctx_draw_t *draw,
@@ -123,7 +123,7 @@ static void menu_display_gl_draw(menu_display_ctx_draw_t *draw,
 
    menu_display_gl_viewport(draw, video_info);
    if (draw)
-      glBindTexture(GL_TEXTURE_2D, (GLuint)draw->texture);
+      gl_state_bind_texture(GL_TEXTURE_2D, (GLuint)draw->texture);
 
    coords.handle_data = gl;
    coords.data        = draw->coords;
@@ -160,10 +160,10 @@ static void menu_display_gl_draw_pipeline(menu_display_ctx_draw_t *draw,
    {
       case VIDEO_SHADER_MENU:
       case VIDEO_SHADER_MENU_2:
-         glBlendFunc(GL_ONE, GL_ONE);
+         gl_state_blend_func(GL_ONE, GL_ONE);
          break;
       default:
-         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+         gl_state_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
          break;
    }
 
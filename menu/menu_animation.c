@@ -16,6 +16,7 @@
 
 #include <math.h>
 #include <string.h>
+#include <limits.h>
 
 #include <compat/strl.h>
 #include <encodings/utf.h>
@@ -23,38 +24,47 @@
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
 
-#define DG_DYNARR_IMPLEMENTATION
-#include <array/dynarray.h>
-#undef DG_DYNARR_IMPLEMENTATION
-
 #include "menu_animation.h"
 #include "../configuration.h"
 #include "../performance_counters.h"
 
 #define IDEAL_DELTA_TIME (1.0 / 60.0 * 1000000.0)
 
-struct tween
-{
-   float       duration;
-   float       running_since;
-   float       initial_value;
-   float       target_value;
-   float       *subject;
-   uintptr_t   tag;
-   easing_cb   easing;
-   tween_cb    cb;
-   void        *userdata;
-   bool        deleted;
-};
-
-DA_TYPEDEF(struct tween, tween_array_t)
+#define TWEEN_NONE         UINT_MAX
+#define TWEEN_MIN_CAPACITY 64
 
+/* Tweens are stored as parallel arrays so the per-frame passes walk
+ * contiguous floats. All per-tween arrays live in one block that only
+ * grows, so pushing and finishing tweens doesn't allocate once the
+ * menu has reached its usual peak. Finished and killed tweens are
+ * flagged and compacted away at the end of the next update. */
 struct menu_animation
 {
-   tween_array_t list;
-   tween_array_t pending;
-   bool pending_deletes;
-   bool in_update;
+   void        *block;
+   float       **subject;
+   uintptr_t   *tag;
+   tween_cb    *cb;
+   void        **userdata;
+   float       *duration;
+   float       *running_since;
+   float       *initial_value;
+   float       *target_value;
+   float       *value;         /* scratch, eased value for this frame */
+   unsigned    *order;         /* scratch, indices grouped by easing */
+   unsigned    *tag_next;      /* next tween with the same tag */
+   uint8_t     *easing;
+   uint8_t     *deleted;
+
+   /* open addressing, tag -> most recent tween with that tag */
+   uintptr_t   *hash_tags;
+   unsigned    *hash_heads;
+   unsigned    hash_size;
+
+   unsigned    count;
+   unsigned    capacity;
+   unsigned    live;
+   bool        pending_deletes;
+   bool        in_update;
 };
 
 typedef struct menu_animation menu_animation_t;
@@ -318,210 +328,312 @@ static void menu_animation_ticker_generic(uint64_t idx,
    *width = max_width;
 }
 
-void menu_animation_init(void)
+static unsigned menu_animation_hash_slot(uintptr_t tag)
 {
-   da_init(anim.list);
-   da_init(anim.pending);
+   unsigned mask = anim.hash_size - 1;
+   unsigned slot = (unsigned)((size_t)(tag ^ (tag >> 16)) * 0x9E3779B1u) & mask;
+
+   while (anim.hash_heads[slot] != TWEEN_NONE && anim.hash_tags[slot] != tag)
+      slot = (slot + 1) & mask;
+
+   return slot;
 }
 
-void menu_animation_free(void)
+static void menu_animation_hash_insert(unsigned i)
 {
-   da_free(anim.list);
-   da_free(anim.pending);
+   unsigned slot = menu_animation_hash_slot(anim.tag[i]);
+
+   anim.tag_next[i]       = anim.hash_heads[slot];
+   anim.hash_tags[slot]   = anim.tag[i];
+   anim.hash_heads[slot]  = i;
 }
 
-bool menu_animation_push(menu_animation_ctx_entry_t *entry)
+static void menu_animation_hash_rebuild(void)
 {
-   struct tween t;
+   unsigned i;
+
+   memset(anim.hash_heads, 0xFF, anim.hash_size * sizeof(*anim.hash_heads));
+
+   for (i = 0; i < anim.count; i++)
+      menu_animation_hash_insert(i);
+}
 
-   t.duration           = entry->duration;
-   t.running_since      = 0;
-   t.initial_value      = *entry->subject;
-   t.target_value       = entry->target_value;
-   t.subject            = entry->subject;
-   t.tag                = entry->tag;
-   t.cb                 = entry->cb;
-   t.userdata           = entry->userdata;
-   t.easing             = NULL;
-   t.deleted            = false;
+static bool menu_animation_grow(void)
+{
+   menu_animation_t grown = anim;
+   unsigned capacity      = anim.capacity
+      ? anim.capacity * 2 : TWEEN_MIN_CAPACITY;
+   /* widest types first so every array stays aligned */
+   size_t per_tween       = sizeof(float*) + sizeof(uintptr_t)
+      + sizeof(tween_cb) + sizeof(void*) + 5 * sizeof(float)
+      + 2 * sizeof(unsigned) + 2 * sizeof(uint8_t);
+   uint8_t *p             = (uint8_t*)malloc(per_tween * capacity);
+
+   grown.hash_size        = capacity * 2;
+   grown.hash_tags        = (uintptr_t*)malloc(
+         grown.hash_size * sizeof(*grown.hash_tags));
+   grown.hash_heads       = (unsigned*)malloc(
+         grown.hash_size * sizeof(*grown.hash_heads));
 
-   switch (entry->easing_enum)
+   if (!p || !grown.hash_tags || !grown.hash_heads)
    {
-      case EASING_LINEAR:
-         t.easing       = &easing_linear;
-         break;
-         /* Quad */
-      case EASING_IN_QUAD:
-         t.easing       = &easing_in_quad;
-         break;
-      case EASING_OUT_QUAD:
-         t.easing       = &easing_out_quad;
-         break;
-      case EASING_IN_OUT_QUAD:
-         t.easing       = &easing_in_out_quad;
-         break;
-      case EASING_OUT_IN_QUAD:
-         t.easing       = &easing_out_in_quad;
-         break;
-         /* Cubic */
-      case EASING_IN_CUBIC:
-         t.easing       = &easing_in_cubic;
-         break;
-      case EASING_OUT_CUBIC:
-         t.easing       = &easing_out_cubic;
-         break;
-      case EASING_IN_OUT_CUBIC:
-         t.easing       = &easing_in_out_cubic;
-         break;
-      case EASING_OUT_IN_CUBIC:
-         t.easing       = &easing_out_in_cubic;
-         break;
-         /* Quart */
-      case EASING_IN_QUART:
-         t.easing       = &easing_in_quart;
-         break;
-      case EASING_OUT_QUART:
-         t.easing       = &easing_out_quart;
-         break;
-      case EASING_IN_OUT_QUART:
-         t.easing       = &easing_in_out_quart;
-         break;
-      case EASING_OUT_IN_QUART:
-         t.easing       = &easing_out_in_quart;
-         break;
-         /* Quint */
-      case EASING_IN_QUINT:
-         t.easing       = &easing_in_quint;
-         break;
-      case EASING_OUT_QUINT:
-         t.easing       = &easing_out_quint;
-         break;
-      case EASING_IN_OUT_QUINT:
-         t.easing       = &easing_in_out_quint;
-         break;
-      case EASING_OUT_IN_QUINT:
-         t.easing       = &easing_out_in_quint;
-         break;
-         /* Sine */
-      case EASING_IN_SINE:
-         t.easing       = &easing_in_sine;
-         break;
-      case EASING_OUT_SINE:
-         t.easing       = &easing_out_sine;
-         break;
-      case EASING_IN_OUT_SINE:
-         t.easing       = &easing_in_out_sine;
-         break;
-      case EASING_OUT_IN_SINE:
-         t.easing       = &easing_out_in_sine;
-         break;
-         /* Expo */
-      case EASING_IN_EXPO:
-         t.easing       = &easing_in_expo;
-         break;
-      case EASING_OUT_EXPO:
-         t.easing       = &easing_out_expo;
-         break;
-      case EASING_IN_OUT_EXPO:
-         t.easing       = &easing_in_out_expo;
-         break;
-      case EASING_OUT_IN_EXPO:
-         t.easing       = &easing_out_in_expo;
-         break;
-         /* Circ */
-      case EASING_IN_CIRC:
-         t.easing       = &easing_in_circ;
-         break;
-      case EASING_OUT_CIRC:
-         t.easing       = &easing_out_circ;
-         break;
-      case EASING_IN_OUT_CIRC:
-         t.easing       = &easing_in_out_circ;
-         break;
-      case EASING_OUT_IN_CIRC:
-         t.easing       = &easing_out_in_circ;
-         break;
-         /* Bounce */
-      case EASING_IN_BOUNCE:
-         t.easing       = &easing_in_bounce;
-         break;
-      case EASING_OUT_BOUNCE:
-         t.easing       = &easing_out_bounce;
-         break;
-      case EASING_IN_OUT_BOUNCE:
-         t.easing       = &easing_in_out_bounce;
-         break;
-      case EASING_OUT_IN_BOUNCE:
-         t.easing       = &easing_out_in_bounce;
-         break;
+      free(p);
+      free(grown.hash_tags);
+      free(grown.hash_heads);
+      return false;
+   }
+
+   grown.block            = p;
+   grown.capacity         = capacity;
+
+#define TWEEN_ARRAY(field, type) \
+   grown.field = (type*)p; \
+   p          += capacity * sizeof(type); \
+   if (anim.count) \
+      memcpy(grown.field, anim.field, anim.count * sizeof(type))
+
+   TWEEN_ARRAY(subject,       float*);
+   TWEEN_ARRAY(tag,           uintptr_t);
+   TWEEN_ARRAY(cb,            tween_cb);
+   TWEEN_ARRAY(userdata,      void*);
+   TWEEN_ARRAY(duration,      float);
+   TWEEN_ARRAY(running_since, float);
+   TWEEN_ARRAY(initial_value, float);
+   TWEEN_ARRAY(target_value,  float);
+   TWEEN_ARRAY(value,         float);
+   TWEEN_ARRAY(order,         unsigned);
+   TWEEN_ARRAY(tag_next,      unsigned);
+   TWEEN_ARRAY(easing,        uint8_t);
+   TWEEN_ARRAY(deleted,       uint8_t);
+
+#undef TWEEN_ARRAY
+
+   free(anim.block);
+   free(anim.hash_tags);
+   free(anim.hash_heads);
+
+   anim = grown;
+   menu_animation_hash_rebuild();
+
+   return true;
+}
+
+static void menu_animation_kill(unsigned i)
+{
+   if (anim.deleted[i])
+      return;
+
+   anim.deleted[i]      = 1;
+   anim.live--;
+   anim.pending_deletes = true;
+}
+
+/* Drops flagged tweens, keeping the others in push order */
+static void menu_animation_compact(void)
+{
+   unsigned i;
+   unsigned j = 0;
+
+   for (i = 0; i < anim.count; i++)
+   {
+      if (anim.deleted[i])
+         continue;
+
+      if (i != j)
+      {
+         anim.subject[j]       = anim.subject[i];
+         anim.tag[j]           = anim.tag[i];
+         anim.cb[j]            = anim.cb[i];
+         anim.userdata[j]      = anim.userdata[i];
+         anim.duration[j]      = anim.duration[i];
+         anim.running_since[j] = anim.running_since[i];
+         anim.initial_value[j] = anim.initial_value[i];
+         anim.target_value[j]  = anim.target_value[i];
+         anim.easing[j]        = anim.easing[i];
+         anim.deleted[j]       = 0;
+      }
+
+      j++;
+   }
+
+   anim.count           = j;
+   anim.pending_deletes = false;
+
+   menu_animation_hash_rebuild();
+}
+
+/* Evaluates one easing over a group of tweens. The switch is outside
+ * the loop, so each loop calls a known function the compiler can
+ * inline instead of going through a pointer per tween. */
+static void menu_animation_ease(enum menu_animation_easing_type type,
+      const unsigned *order, unsigned n)
+{
+   unsigned j;
+   float *value               = anim.value;
+   const float *running_since = anim.running_since;
+   const float *initial_value = anim.initial_value;
+   const float *target_value  = anim.target_value;
+   const float *duration      = anim.duration;
+
+#define TWEEN_EASE(func) \
+   for (j = 0; j < n; j++) \
+   { \
+      unsigned k = order[j]; \
+      value[k]   = func(running_since[k], initial_value[k], \
+            target_value[k] - initial_value[k], duration[k]); \
+   } \
+   break
+
+   switch (type)
+   {
+      case EASING_LINEAR:        TWEEN_EASE(easing_linear);
+      case EASING_IN_QUAD:       TWEEN_EASE(easing_in_quad);
+      case EASING_OUT_QUAD:      TWEEN_EASE(easing_out_quad);
+      case EASING_IN_OUT_QUAD:   TWEEN_EASE(easing_in_out_quad);
+      case EASING_OUT_IN_QUAD:   TWEEN_EASE(easing_out_in_quad);
+      case EASING_IN_CUBIC:      TWEEN_EASE(easing_in_cubic);
+      case EASING_OUT_CUBIC:     TWEEN_EASE(easing_out_cubic);
+      case EASING_IN_OUT_CUBIC:  TWEEN_EASE(easing_in_out_cubic);
+      case EASING_OUT_IN_CUBIC:  TWEEN_EASE(easing_out_in_cubic);
+      case EASING_IN_QUART:      TWEEN_EASE(easing_in_quart);
+      case EASING_OUT_QUART:     TWEEN_EASE(easing_out_quart);
+      case EASING_IN_OUT_QUART:  TWEEN_EASE(easing_in_out_quart);
+      case EASING_OUT_IN_QUART:  TWEEN_EASE(easing_out_in_quart);
+      case EASING_IN_QUINT:      TWEEN_EASE(easing_in_quint);
+      case EASING_OUT_QUINT:     TWEEN_EASE(easing_out_quint);
+      case EASING_IN_OUT_QUINT:  TWEEN_EASE(easing_in_out_quint);
+      case EASING_OUT_IN_QUINT:  TWEEN_EASE(easing_out_in_quint);
+      case EASING_IN_SINE:       TWEEN_EASE(easing_in_sine);
+      case EASING_OUT_SINE:      TWEEN_EASE(easing_out_sine);
+      case EASING_IN_OUT_SINE:   TWEEN_EASE(easing_in_out_sine);
+      case EASING_OUT_IN_SINE:   TWEEN_EASE(easing_out_in_sine);
+      case EASING_IN_EXPO:       TWEEN_EASE(easing_in_expo);
+      case EASING_OUT_EXPO:      TWEEN_EASE(easing_out_expo);
+      case EASING_IN_OUT_EXPO:   TWEEN_EASE(easing_in_out_expo);
+      case EASING_OUT_IN_EXPO:   TWEEN_EASE(easing_out_in_expo);
+      case EASING_IN_CIRC:       TWEEN_EASE(easing_in_circ);
+      case EASING_OUT_CIRC:      TWEEN_EASE(easing_out_circ);
+      case EASING_IN_OUT_CIRC:   TWEEN_EASE(easing_in_out_circ);
+      case EASING_OUT_IN_CIRC:   TWEEN_EASE(easing_out_in_circ);
+      case EASING_IN_BOUNCE:     TWEEN_EASE(easing_in_bounce);
+      case EASING_OUT_BOUNCE:    TWEEN_EASE(easing_out_bounce);
+      case EASING_IN_OUT_BOUNCE: TWEEN_EASE(easing_in_out_bounce);
+      case EASING_OUT_IN_BOUNCE: TWEEN_EASE(easing_out_in_bounce);
       default:
          break;
    }
 
+#undef TWEEN_EASE
+}
+
+void menu_animation_init(void)
+{
+   memset(&anim, 0, sizeof(anim));
+}
+
+void menu_animation_free(void)
+{
+   free(anim.block);
+   free(anim.hash_tags);
+   free(anim.hash_heads);
+
+   memset(&anim, 0, sizeof(anim));
+}
+
+bool menu_animation_push(menu_animation_ctx_entry_t *entry)
+{
+   unsigned i;
+
    /* ignore born dead tweens */
-   if (!t.easing || t.duration == 0 || t.initial_value == t.target_value)
+   if ((unsigned)entry->easing_enum >= EASING_LAST
+         || entry->duration == 0
+         || *entry->subject == entry->target_value)
       return false;
-   
-   if (anim.in_update)
-      da_push(anim.pending, t);
-   else
-      da_push(anim.list, t);
+
+   if (anim.count == anim.capacity && !menu_animation_grow())
+      return false;
+
+   /* Tweens pushed from a callback during an update are appended
+    * past the range being updated, so they start on the next frame. */
+   i                     = anim.count++;
+
+   anim.subject[i]       = entry->subject;
+   anim.tag[i]           = entry->tag;
+   anim.cb[i]            = entry->cb;
+   anim.userdata[i]      = entry->userdata;
+   anim.duration[i]      = entry->duration;
+   anim.running_since[i] = 0;
+   anim.initial_value[i] = *entry->subject;
+   anim.target_value[i]  = entry->target_value;
+   anim.easing[i]        = (uint8_t)entry->easing_enum;
+   anim.deleted[i]       = 0;
+   anim.live++;
+
+   menu_animation_hash_insert(i);
 
    return true;
 }
 
 bool menu_animation_update(float delta_time)
 {
-   unsigned i;
-   
+   unsigned i, e;
+   unsigned groups[EASING_LAST + 1];
+   unsigned cursor[EASING_LAST];
+   unsigned count       = anim.count;
+
    anim.in_update       = true;
-   anim.pending_deletes = false;
 
-   for(i = 0; i < da_count(anim.list); i++)
-   {
-      struct tween *tween = da_getptr(anim.list, i);
-      tween->running_since += delta_time;
+   for (i = 0; i < count; i++)
+      anim.running_since[i] += delta_time;
 
-      *tween->subject = tween->easing(
-            tween->running_since,
-            tween->initial_value,
-            tween->target_value - tween->initial_value,
-            tween->duration);
+   /* group the live tweens by easing, keeping push order in a group */
+   memset(groups, 0, sizeof(groups));
 
-      if (tween->running_since >= tween->duration)
-      {
-         *tween->subject = tween->target_value;
+   for (i = 0; i < count; i++)
+      if (!anim.deleted[i])
+         groups[anim.easing[i] + 1]++;
 
-         if (tween->cb)
-            tween->cb(tween->userdata);
-         
-         da_delete(anim.list, i);
-         i--;
-      }
+   for (e = 0; e < EASING_LAST; e++)
+   {
+      groups[e + 1] += groups[e];
+      cursor[e]      = groups[e];
    }
-   
-   if (anim.pending_deletes)
+
+   for (i = 0; i < count; i++)
+      if (!anim.deleted[i])
+         anim.order[cursor[anim.easing[i]]++] = i;
+
+   for (e = 0; e < EASING_LAST; e++)
+      if (groups[e + 1] > groups[e])
+         menu_animation_ease((enum menu_animation_easing_type)e,
+               anim.order + groups[e], groups[e + 1] - groups[e]);
+
+   /* Write back and finish in push order. Callbacks can push and
+    * kill tweens, which can grow the arrays, so nothing is cached
+    * across them. */
+   for (i = 0; i < count; i++)
    {
-      for(i = 0; i < da_count(anim.list); i++)
+      if (anim.deleted[i])
+         continue;
+
+      if (anim.running_since[i] >= anim.duration[i])
       {
-         struct tween *tween = da_getptr(anim.list, i);
-         if (tween->deleted)
-         {
-            da_delete(anim.list, i);
-            i--;
-         }
+         *anim.subject[i] = anim.target_value[i];
+
+         menu_animation_kill(i);
+
+         if (anim.cb[i])
+            anim.cb[i](anim.userdata[i]);
       }
-      anim.pending_deletes = false;
-   }
-   
-   if (da_count(anim.pending) > 0)
-   {
-      da_addn(anim.list, anim.pending.p, da_count(anim.pending));
-      da_clear(anim.pending);
+      else
+         *anim.subject[i] = anim.value[i];
    }
 
-   anim.in_update = false;
-   animation_is_active = da_count(anim.list) > 0;
+   if (anim.pending_deletes)
+      menu_animation_compact();
+
+   anim.in_update      = false;
+   animation_is_active = anim.live > 0;
 
    return animation_is_active;
 }
@@ -600,6 +712,11 @@ bool menu_animation_is_active(void)
    return animation_is_active;
 }
 
+bool menu_animation_has_tweens(void)
+{
+   return anim.live > 0;
+}
+
 bool menu_animation_kill_by_tag(menu_animation_ctx_tag *tag)
 {
    unsigned i;
@@ -607,23 +724,12 @@ bool menu_animation_kill_by_tag(menu_animation_ctx_tag *tag)
    if (!tag || *tag == (uintptr_t)-1)
       return false;
 
-   for (i = 0; i < da_count(anim.list); ++i)
-   {
-      struct tween *t = da_getptr(anim.list, i);
-      if (t->tag != *tag)
-         continue;
-   
-      if (anim.in_update)
-      {
-         t->deleted = true;
-         anim.pending_deletes = true;
-      }
-      else
-      {
-         da_delete(anim.list, i);
-         --i;
-      }
-   }
+   if (!anim.live)
+      return true;
+
+   for (i = anim.hash_heads[menu_animation_hash_slot(*tag)];
+         i != TWEEN_NONE; i = anim.tag_next[i])
+      menu_animation_kill(i);
 
    return true;
 }
@@ -633,26 +739,17 @@ void menu_animation_kill_by_subject(menu_animation_ctx_subject_t *subject)
    unsigned i, j,  killed = 0;
    float            **sub = (float**)subject->data;
 
-   for (i = 0; i < da_count(anim.list) && killed < subject->count; ++i)
+   for (i = 0; i < anim.count && killed < subject->count; ++i)
    {
-      struct tween *t = da_getptr(anim.list, i);
+      if (anim.deleted[i])
+         continue;
 
       for (j = 0; j < subject->count; ++j)
       {
-         if (t->subject != sub[j])
+         if (anim.subject[i] != sub[j])
             continue;
-         
-         if (anim.in_update)
-         {
-            t->deleted = true;
-            anim.pending_deletes = true;
-         }
-         else
-         {
-            da_delete(anim.list, i);
-            --i;
-         }
 
+         menu_animation_kill(i);
          killed++;
          break;
       }
@@ -669,20 +766,7 @@ bool menu_animation_ctl(enum menu_animation_ctl_state state, void *data)
    switch (state)
    {
       case MENU_ANIMATION_CTL_DEINIT:
-         {
-            size_t i;
-
-            for (i = 0; i < da_count(anim.list); i++)
-            {
-               struct tween *t = da_getptr(anim.list, i);
-               if (t->subject)
-                  t->subject = NULL;
-            }
-
-            da_free(anim.list);
-
-            memset(&anim, 0, sizeof(menu_animation_t));
-         }
+         menu_animation_free();
          cur_time                  = 0;
          old_time                  = 0;
          delta_time                = 0.0f;
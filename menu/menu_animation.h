@@ -145,6 +145,10 @@ void menu_animation_update_time(bool timedate_enable);
 
 bool menu_animation_is_active(void);
 
+/* Whether tweens are queued or running, regardless of what the
+ * menu drivers did to the active flag. */
+bool menu_animation_has_tweens(void);
+
 bool menu_animation_kill_by_tag(menu_animation_ctx_tag *tag);
 
 void menu_animation_kill_by_subject(menu_animation_ctx_subject_t *subject);
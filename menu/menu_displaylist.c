@@ -173,7 +173,7 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info)
 
    core_info_get_current_core(&core_info);
 
-   if (!core_info || !core_info->config_data)
+   if (!core_info || !core_info->has_info)
    {
       menu_entries_append_enum(info->list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_CORE_INFORMATION_AVAILABLE),
@@ -1286,6 +1286,10 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       playlist_t *playlist, const char *path_playlist, bool is_history)
 {
    unsigned i;
+   char *path_copy  = NULL;
+   char *fill_buf   = NULL;
+   char *path_short = NULL;
+   size_t path_size = PATH_MAX_LENGTH * sizeof(char);
    size_t selection = menu_navigation_get_selection();
    size_t list_size = playlist_size(playlist);
 
@@ -1306,11 +1310,13 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
    /* preallocate the file list */
    file_list_reserve(info->list, list_size);
 
+   /* Shared by all entries, playlists can be huge */
+   path_copy  = (char*)malloc(path_size);
+   fill_buf   = (char*)malloc(path_size);
+   path_short = (char*)malloc(path_size);
+
    for (i = 0; i < list_size; i++)
    {
-      size_t path_size                = PATH_MAX_LENGTH * sizeof(char);
-      char *path_copy                 = (char*)malloc(path_size);
-      char *fill_buf                  = (char*)malloc(path_size);
       const char *core_name           = NULL;
       const char *path                = NULL;
       const char *label               = NULL;
@@ -1340,9 +1346,6 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
 
       if (path)
       {
-         size_t path_size = PATH_MAX_LENGTH * sizeof(char);
-         char *path_short = (char*)malloc(path_size);
-
          path_short[0]    = '\0';
 
          fill_short_pathname_representation(path_short, path,
@@ -1366,25 +1369,24 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
                free(tmp);
             }
          }
-
-         free(path_short);
       }
 
       if (!path)
-         menu_entries_append_enum(info->list, fill_buf, path_playlist,
+         menu_entries_append_lazy(info->list, fill_buf, path_playlist,
                MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_PLAYLIST_ENTRY, 0, i);
       else if (is_history)
-         menu_entries_append_enum(info->list, fill_buf,
+         menu_entries_append_lazy(info->list, fill_buf,
                path, MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_RPL_ENTRY, 0, i);
       else
-         menu_entries_append_enum(info->list, label,
+         menu_entries_append_lazy(info->list, label,
                path, MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_RPL_ENTRY, 0, i);
       info->count++;
-
-      free(path_copy);
-      free(fill_buf);
    }
 
+   free(path_copy);
+   free(fill_buf);
+   free(path_short);
+
    return 0;
 
 error:
@@ -1447,6 +1449,17 @@ static int menu_displaylist_parse_shader_options(menu_displaylist_info_t *info)
          MENU_ENUM_LABEL_VIDEO_SHADER_NUM_PASSES,
          0, 0, 0);
 
+   {
+      perf_gpu_pass_t gpu_pass;
+
+      if (performance_gpu_passes_get(&gpu_pass, 1))
+         menu_entries_append_enum(info->list,
+               msg_hash_to_str(MENU_ENUM_LABEL_VALUE_SHADER_PASS_TIMES),
+               msg_hash_to_str(MENU_ENUM_LABEL_SHADER_PASS_TIMES),
+               MENU_ENUM_LABEL_SHADER_PASS_TIMES,
+               MENU_SETTING_ACTION, 0, 0);
+   }
+
    for (i = 0; i < pass_count; i++)
    {
       char buf_tmp[64];
@@ -1478,6 +1491,43 @@ static int menu_displaylist_parse_shader_options(menu_displaylist_info_t *info)
    return 0;
 }
 
+static unsigned menu_displaylist_parse_shader_pass_times(
+      menu_displaylist_info_t *info)
+{
+   unsigned i;
+   perf_gpu_pass_t passes[PERF_GPU_PASSES];
+   float total    = 0.0f;
+   unsigned count = performance_gpu_passes_get(passes, PERF_GPU_PASSES);
+
+   for (i = 0; i < count; i++)
+   {
+      char tmp[128];
+
+      tmp[0] = '\0';
+
+      snprintf(tmp, sizeof(tmp), "#%u %.63s: %.2f ms",
+            i, passes[i].name, passes[i].time_us / 1000.0);
+      menu_entries_append_enum(info->list, tmp, "",
+            MENU_ENUM_LABEL_SHADER_PASS_TIMES_ENTRY,
+            MENU_SETTINGS_CORE_INFO_NONE, 0, 0);
+      total += passes[i].time_us;
+   }
+
+   if (count)
+   {
+      char tmp[64];
+
+      tmp[0] = '\0';
+
+      snprintf(tmp, sizeof(tmp), "Total: %.2f ms", total / 1000.0);
+      menu_entries_append_enum(info->list, tmp, "",
+            MENU_ENUM_LABEL_SHADER_PASS_TIMES_ENTRY,
+            MENU_SETTINGS_CORE_INFO_NONE, 0, 0);
+   }
+
+   return count;
+}
+
 #ifdef HAVE_LIBRETRODB
 static int create_string_list_rdb_entry_string(
       enum msg_hash_enums enum_idx,
@@ -2945,7 +2995,7 @@ static int menu_displaylist_parse_information_list(
           !string_is_equal(system->library_name,
              msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_CORE))
          )
-         && core_info && core_info->config_data
+         && core_info && core_info->has_info
       )
       menu_entries_append_enum(info->list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_CORE_INFORMATION),
@@ -4891,6 +4941,20 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          count = menu_displaylist_parse_network_info(info);
 #endif
 
+         if (count == 0)
+            menu_entries_append_enum(info->list,
+                  msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_SETTINGS_FOUND),
+                  msg_hash_to_str(MENU_ENUM_LABEL_NO_SETTINGS_FOUND),
+                  MENU_ENUM_LABEL_NO_SETTINGS_FOUND,
+                  0, 0, 0);
+
+         info->need_push    = true;
+         info->need_refresh = true;
+         break;
+      case DISPLAYLIST_SHADER_PASS_TIMES:
+         menu_entries_ctl(MENU_ENTRIES_CTL_CLEAR, info->list);
+         count = menu_displaylist_parse_shader_pass_times(info);
+
          if (count == 0)
             menu_entries_append_enum(info->list,
                   msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_SETTINGS_FOUND),
@@ -5318,6 +5382,9 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_SAVESTATE_THUMBNAIL_ENABLE,
                PARSE_ONLY_BOOL, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,
+               PARSE_ONLY_BOOL, false);
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_SAVEFILES_IN_CONTENT_DIR_ENABLE,
                PARSE_ONLY_BOOL, false);
@@ -5371,9 +5438,14 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          {
             settings_t      *settings     = config_get_ptr();
             if (settings->bools.menu_show_advanced_settings)
+            {
                menu_displaylist_parse_settings_enum(menu, info,
                      MENU_ENUM_LABEL_MENU_THROTTLE_FRAMERATE,
                      PARSE_ONLY_BOOL, false);
+               menu_displaylist_parse_settings_enum(menu, info,
+                     MENU_ENUM_LABEL_MENU_SKIP_UNCHANGED_FRAMES,
+                     PARSE_ONLY_BOOL, false);
+            }
          }
 
          info->need_refresh = true;
@@ -5384,6 +5456,11 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_REWIND_ENABLE,
                PARSE_ONLY_BOOL, false);
+#ifdef HAVE_THREADS
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_REWIND_THREADED,
+               PARSE_ONLY_BOOL, false);
+#endif
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_REWIND_GRANULARITY,
                PARSE_ONLY_UINT, false);
@@ -5393,6 +5470,15 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
                PARSE_ONLY_UINT, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL,
+               PARSE_ONLY_UINT, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_REWIND_KEYFRAME_BUFFER_SIZE,
+               PARSE_ONLY_SIZE, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_REWIND_KEYFRAME_SPILL_COUNT,
+               PARSE_ONLY_UINT, false);
 
          info->need_refresh = true;
          info->need_push    = true;
@@ -5649,6 +5735,9 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_STATISTICS_SHOW,
                PARSE_ONLY_BOOL, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_PERF_OVERLAY_SHOW,
+               PARSE_ONLY_BOOL, false);
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_MEMORY_SHOW,
                PARSE_ONLY_BOOL, false);
@@ -5658,6 +5747,9 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_FONT_SIZE,
                PARSE_ONLY_FLOAT, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_VIDEO_FONT_SDF,
+               PARSE_ONLY_BOOL, false);
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_MESSAGE_POS_X,
                PARSE_ONLY_FLOAT, false);
@@ -6175,6 +6267,11 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_CHEEVOS_AUTO_SCREENSHOT,
                PARSE_ONLY_BOOL, false);
+#if defined(HAVE_NEW_CHEEVOS) && defined(HAVE_THREADS)
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_CHEEVOS_THREADED,
+               PARSE_ONLY_BOOL, false);
+#endif
 
          info->need_refresh = true;
          info->need_push    = true;
@@ -6308,6 +6405,10 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
                   MENU_ENUM_LABEL_NETPLAY_NAT_TRAVERSAL,
                   PARSE_ONLY_BOOL, false) != -1)
             count++;
+         if (menu_displaylist_parse_settings_enum(menu, info,
+                  MENU_ENUM_LABEL_NETPLAY_UDP_INPUT,
+                  PARSE_ONLY_BOOL, false) != -1)
+            count++;
          if (menu_displaylist_parse_settings_enum(menu, info,
                   MENU_ENUM_LABEL_NETPLAY_SHARE_DIGITAL,
                   PARSE_ONLY_UINT, false) != -1)
@@ -6685,6 +6786,14 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_THREADED,
                PARSE_ONLY_BOOL, false);
+#ifdef HAVE_VULKAN
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_VIDEO_SHADER_PARALLEL_RECORD,
+               PARSE_ONLY_BOOL, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_VIDEO_SHADER_DYNAMIC_SCALE_MIN,
+               PARSE_ONLY_UINT, false);
+#endif
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_VSYNC,
                PARSE_ONLY_BOOL, false);
@@ -6710,12 +6819,19 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
                MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
                PARSE_ONLY_UINT, false) == 0)
             count++;
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_BLACK_FRAME_INSERTION,
                PARSE_ONLY_BOOL, false);
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_GPU_SCREENSHOT,
                PARSE_ONLY_BOOL, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_SCREENSHOT_FAST_ENCODE,
+               PARSE_ONLY_BOOL, false);
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_CROP_OVERSCAN,
                PARSE_ONLY_BOOL, false);
@@ -6737,6 +6853,9 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_DUMMY_ON_CORE_SHUTDOWN,
                PARSE_ONLY_BOOL, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_CORE_CACHE_ENABLE,
+               PARSE_ONLY_BOOL, false);
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_CHECK_FOR_MISSING_FIRMWARE,
                PARSE_ONLY_BOOL, false);
@@ -6801,6 +6920,9 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_AUDIO_SYNC,
                PARSE_ONLY_BOOL, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_AUDIO_PULL,
+               PARSE_ONLY_BOOL, false);
          if (menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_AUDIO_LATENCY,
                PARSE_ONLY_UINT, false) == 0)
@@ -6833,6 +6955,9 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_AUDIO_DSP_PLUGIN,
                PARSE_ONLY_PATH, false);
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_AUDIO_ALSA_MMAP,
+               PARSE_ONLY_BOOL, false);
          menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE,
                PARSE_ONLY_BOOL, false);
@@ -6857,6 +6982,11 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
          ret = menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_INPUT_UNIFIED_MENU_CONTROLS,
                PARSE_ONLY_BOOL, false);
+#ifdef HAVE_THREADS
+         menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_INPUT_POLL_THREAD,
+               PARSE_ONLY_BOOL, false);
+#endif
          if (menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR,
                PARSE_ONLY_UINT, false) == 0)
@@ -6957,6 +7087,10 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
                MENU_ENUM_LABEL_VIDEO_FRAME_DELAY,
                PARSE_ONLY_UINT, false) == 0)
             count++;
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
          if (menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_AUDIO_LATENCY,
                PARSE_ONLY_UINT, false) == 0)
@@ -6965,6 +7099,12 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
                MENU_ENUM_LABEL_INPUT_POLL_TYPE_BEHAVIOR,
                PARSE_ONLY_UINT, false) == 0)
             count++;
+#ifdef HAVE_THREADS
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_INPUT_POLL_THREAD,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
+#endif
          if (menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_RUN_AHEAD_ENABLED,
                PARSE_ONLY_BOOL, false) == 0)
@@ -6973,10 +7113,28 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
                MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
                PARSE_ONLY_UINT, false) == 0)
             count++;
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_RUN_AHEAD_FRAMES_AUTO,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_RUN_AHEAD_DETECT_LAG,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
          if (menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,
                PARSE_ONLY_BOOL, false) == 0)
             count++;
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
+#endif
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_RUN_AHEAD_SKIP_ROLLBACK,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
          if (menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,
                PARSE_ONLY_BOOL, false) == 0)
@@ -7376,6 +7534,14 @@ bool menu_displaylist_ctl(enum menu_displaylist_ctl_state type, menu_displaylist
                MENU_ENUM_LABEL_VIDEO_GPU_RECORD,
                PARSE_ONLY_BOOL, false) == 0)
             count++;
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_VIDEO_RECORD_HW_ENCODER,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
+         if (menu_displaylist_parse_settings_enum(menu, info,
+               MENU_ENUM_LABEL_VIDEO_STREAM_RECORD,
+               PARSE_ONLY_BOOL, false) == 0)
+            count++;
          if (menu_displaylist_parse_settings_enum(menu, info,
                MENU_ENUM_LABEL_VIDEO_POST_FILTER_RECORD,
                PARSE_ONLY_BOOL, false) == 0)
@@ -113,6 +113,7 @@ enum menu_displaylist_ctl_state
    DISPLAYLIST_SHADER_PARAMETERS,
    DISPLAYLIST_SHADER_PARAMETERS_PRESET,
    DISPLAYLIST_NETWORK_INFO,
+   DISPLAYLIST_SHADER_PASS_TIMES,
    DISPLAYLIST_SYSTEM_INFO,
    DISPLAYLIST_ACHIEVEMENT_LIST,
       DISPLAYLIST_USER_BINDS_LIST,
@@ -25,6 +25,11 @@
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
 #include <encodings/utf.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_RPNG
+#include <formats/rpng.h>
+#endif
 
 #ifdef WIIU
 #include <wiiu/os/energy.h>
@@ -39,10 +44,13 @@
 #endif
 
 #ifdef HAVE_THREADS
+#include <rthreads/rjob.h>
+
 #include "../gfx/video_thread_wrapper.h"
 #endif
 
 #include "../gfx/video_driver.h"
+#include "../gfx/video_atlas.h"
 
 #include "menu_animation.h"
 #include "menu_driver.h"
@@ -50,6 +58,7 @@
 #include "menu_input.h"
 #include "menu_entries.h"
 #include "widgets/menu_dialog.h"
+#include "widgets/menu_input_dialog.h"
 #include "menu_shader.h"
 
 #include "../config.def.h"
@@ -58,6 +67,7 @@
 #include "../configuration.h"
 #include "../dynamic.h"
 #include "../driver.h"
+#include "../paths.h"
 #include "../retroarch.h"
 #include "../defaults.h"
 #include "../frontend/frontend.h"
@@ -65,6 +75,7 @@
 #include "../tasks/tasks_internal.h"
 #include "../ui/ui_companion_driver.h"
 #include "../verbosity.h"
+#include "../performance_counters.h"
 
 #define SCROLL_INDEX_SIZE          (2 * (26 + 2) + 1)
 
@@ -168,6 +179,43 @@ uintptr_t menu_display_white_texture;
 
 static video_coord_array_t menu_disp_ca;
 
+#define MENU_DISPLAY_FONT_BATCHES 16
+
+/* Text drawn with a menu font is gathered into that font's block
+ * over the whole frame and drawn once, see menu_display_font_flush(). */
+typedef struct menu_display_font_batch
+{
+   font_data_t *font;
+   video_font_raster_block_t block;
+} menu_display_font_batch_t;
+
+static menu_display_font_batch_t menu_display_font_batches[
+   MENU_DISPLAY_FONT_BATCHES];
+
+#define MENU_DISPLAY_QUAD_BATCH_SIZE 128
+
+/* Untextured quads, gathered while a batch is open and drawn as one
+ * triangle list the next time anything else is drawn or the blend,
+ * scissor or clear state changes, so the result looks the same as
+ * drawing them one after the other. Only the GL display driver draws
+ * triangle lists, the others get every quad on its own. */
+typedef struct menu_display_quad_batch
+{
+   float vertex[MENU_DISPLAY_QUAD_BATCH_SIZE * 6 * 2];
+   float tex_coord[MENU_DISPLAY_QUAD_BATCH_SIZE * 6 * 2];
+   float color[MENU_DISPLAY_QUAD_BATCH_SIZE * 6 * 4];
+   unsigned count;
+   unsigned width;
+   unsigned height;
+   bool active;
+} menu_display_quad_batch_t;
+
+static menu_display_quad_batch_t menu_display_quad_batch;
+
+/* Draw calls made through the display and font drivers, read back
+ * by the performance overlay. */
+static unsigned menu_display_draw_calls          = 0;
+
 static enum
 menu_toggle_reason menu_display_toggle_reason    = MENU_TOGGLE_REASON_NONE;
 
@@ -183,6 +231,19 @@ static bool menu_display_has_windowed            = false;
 static bool menu_display_msg_force               = false;
 static bool menu_display_font_alloc_framebuf     = false;
 static bool menu_display_framebuf_dirty          = false;
+
+/* Damage tracking for menu_skip_unchanged_frames: whether
+ * something changed since the last menu frame was drawn, whether
+ * the frame after things calmed down was drawn too, and whether
+ * the current frame was skipped. The rest is what it was last
+ * drawn with. */
+static bool menu_display_damaged                 = true;
+static bool menu_display_settled                 = false;
+static bool menu_display_frame_skipped           = false;
+static unsigned menu_display_damage_width        = 0;
+static unsigned menu_display_damage_height       = 0;
+static int16_t menu_display_damage_mouse[3]      = {0};
+static int16_t menu_display_damage_pointer[3]    = {0};
 static const uint8_t *menu_display_font_framebuf = NULL;
 static menu_display_ctx_driver_t *menu_disp      = NULL;
 
@@ -412,9 +473,124 @@ void menu_display_timedate(menu_display_ctx_datetime_t *datetime)
    }
 }
 
+static void menu_display_quad_batch_flush(video_frame_info_t *video_info)
+{
+   menu_display_ctx_draw_t draw;
+   struct video_coords coords;
+   menu_display_quad_batch_t *batch = &menu_display_quad_batch;
+
+   if (!batch->count || !menu_disp)
+      return;
+
+   coords.vertices      = batch->count * 6;
+   coords.vertex        = batch->vertex;
+   coords.tex_coord     = batch->tex_coord;
+   coords.lut_tex_coord = batch->tex_coord;
+   coords.color         = batch->color;
+
+   draw.x            = 0;
+   draw.y            = 0;
+   draw.width        = batch->width;
+   draw.height       = batch->height;
+   draw.coords       = &coords;
+   draw.matrix_data  = NULL;
+   draw.texture      = menu_display_white_texture;
+   draw.prim_type    = MENU_DISPLAY_PRIM_TRIANGLES;
+   draw.pipeline.id  = 0;
+   draw.scale_factor = 1.0f;
+   draw.rotation     = 0.0f;
+
+   batch->count      = 0;
+
+   if (menu_disp->blend_begin)
+      menu_disp->blend_begin(video_info);
+   menu_disp->draw(&draw, video_info);
+   menu_display_draw_calls++;
+   if (menu_disp->blend_end)
+      menu_disp->blend_end(video_info);
+}
+
+/* Returns false if the quad has to be drawn right away. */
+static bool menu_display_quad_batch_add(video_frame_info_t *video_info,
+      int x, int y, unsigned w, unsigned h,
+      unsigned width, unsigned height, const float *color)
+{
+   /* Triangle strip order of the four corners, split in two. */
+   static const unsigned corners[6] = { 0, 1, 2, 2, 1, 3 };
+   unsigned i;
+   float left, right, bottom, top;
+   menu_display_quad_batch_t *batch = &menu_display_quad_batch;
+
+   if (     !batch->active
+         || !menu_disp
+         || !menu_disp->draw
+         || menu_disp->type != MENU_VIDEO_DRIVER_OPENGL
+         || !width || !height)
+      return false;
+
+   if (     batch->count == MENU_DISPLAY_QUAD_BATCH_SIZE
+         || batch->width  != width
+         || batch->height != height)
+   {
+      menu_display_quad_batch_flush(video_info);
+      batch->width  = width;
+      batch->height = height;
+   }
+
+   /* What menu_display_draw() does to an empty viewport */
+   if (!h)
+      h = 1;
+
+   left   = x / (float)width;
+   right  = (x + (int)w) / (float)width;
+   bottom = ((int)height - y - (int)h) / (float)height;
+   top    = ((int)height - y) / (float)height;
+
+   for (i = 0; i < 6; i++)
+   {
+      unsigned corner = corners[i];
+      unsigned v      = batch->count * 6 + i;
+
+      batch->vertex[v * 2 + 0]    = (corner & 1) ? right : left;
+      batch->vertex[v * 2 + 1]    = (corner & 2) ? top   : bottom;
+      batch->tex_coord[v * 2 + 0] = 0.0f;
+      batch->tex_coord[v * 2 + 1] = 0.0f;
+      memcpy(&batch->color[v * 4], &color[corner * 4],
+            4 * sizeof(float));
+   }
+
+   batch->count++;
+   return true;
+}
+
+/* From here on, menu_display_draw_quad() calls are drawn together. */
+void menu_display_quad_batch_begin(void)
+{
+   menu_display_quad_batch.count  = 0;
+   menu_display_quad_batch.active = true;
+}
+
+/* Draws what is left and goes back to drawing quads immediately. */
+void menu_display_quad_batch_end(video_frame_info_t *video_info)
+{
+   menu_display_quad_batch_flush(video_info);
+   menu_display_quad_batch.active = false;
+}
+
+unsigned menu_display_get_draw_calls(bool reset)
+{
+   unsigned calls = menu_display_draw_calls;
+
+   if (reset)
+      menu_display_draw_calls = 0;
+
+   return calls;
+}
+
 /* Begin blending operation */
 void menu_display_blend_begin(video_frame_info_t *video_info)
 {
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->blend_begin)
       menu_disp->blend_begin(video_info);
 }
@@ -422,6 +598,7 @@ void menu_display_blend_begin(video_frame_info_t *video_info)
 /* End blending operation */
 void menu_display_blend_end(video_frame_info_t *video_info)
 {
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->blend_end)
       menu_disp->blend_end(video_info);
 }
@@ -429,6 +606,7 @@ void menu_display_blend_end(video_frame_info_t *video_info)
 /* Begin scissoring operation */
 void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, unsigned width, unsigned height)
 {
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->scissor_begin)
       menu_disp->scissor_begin(video_info, x, y, width, height);
 }
@@ -436,14 +614,118 @@ void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, un
 /* End scissoring operation */
 void menu_display_scissor_end(video_frame_info_t *video_info)
 {
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->scissor_end)
       menu_disp->scissor_end(video_info);
 }
 
+static menu_display_font_batch_t *menu_display_font_batch_find(
+      const font_data_t *font)
+{
+   unsigned i;
+
+   if (!font)
+      return NULL;
+
+   for (i = 0; i < MENU_DISPLAY_FONT_BATCHES; i++)
+      if (menu_display_font_batches[i].font == font)
+         return &menu_display_font_batches[i];
+
+   return NULL;
+}
+
+/* Fonts beyond MENU_DISPLAY_FONT_BATCHES simply draw every
+ * message on its own. */
+static void menu_display_font_batch_add(font_data_t *font)
+{
+   unsigned i;
+
+   if (!font || menu_display_font_batch_find(font))
+      return;
+
+   for (i = 0; i < MENU_DISPLAY_FONT_BATCHES; i++)
+   {
+      if (!menu_display_font_batches[i].font)
+      {
+         menu_display_font_batches[i].font = font;
+         break;
+      }
+   }
+}
+
+static void menu_display_font_batch_remove(font_data_t *font)
+{
+   menu_display_font_batch_t *batch = menu_display_font_batch_find(font);
+
+   if (!batch)
+      return;
+
+   font_driver_bind_block(font, NULL);
+   video_coord_array_free(&batch->block.carr);
+   memset(batch, 0, sizeof(*batch));
+}
+
+/* Starts gathering the text of every menu font. */
+static void menu_display_font_bind_blocks(void)
+{
+   unsigned i;
+
+   for (i = 0; i < MENU_DISPLAY_FONT_BATCHES; i++)
+   {
+      menu_display_font_batch_t *batch = &menu_display_font_batches[i];
+
+      if (!batch->font)
+         continue;
+
+      batch->block.carr.coords.vertices = 0;
+      font_driver_bind_block(batch->font, &batch->block);
+   }
+}
+
+/* Draws what is left of the frame's text and goes back to
+ * drawing it immediately, for anything outside the menu. */
+static void menu_display_font_unbind_blocks(video_frame_info_t *video_info)
+{
+   unsigned i;
+
+   for (i = 0; i < MENU_DISPLAY_FONT_BATCHES; i++)
+   {
+      menu_display_font_batch_t *batch = &menu_display_font_batches[i];
+
+      if (!batch->font)
+         continue;
+
+      menu_display_font_flush(video_info, batch->font);
+      font_driver_bind_block(batch->font, NULL);
+   }
+}
+
+/* Draws the text gathered for @font so far in one go. Menu drivers
+ * only need this to put text under something drawn later in the
+ * frame, or inside a scissor; anything left is drawn at the end. */
+void menu_display_font_flush(video_frame_info_t *video_info,
+      font_data_t *font)
+{
+   menu_display_font_batch_t *batch = menu_display_font_batch_find(font);
+
+   if (!batch)
+      return;
+
+   menu_display_quad_batch_flush(video_info);
+
+   if (batch->block.carr.coords.vertices)
+      menu_display_draw_calls++;
+
+   font_driver_flush(video_info->width, video_info->height,
+         font, video_info);
+   batch->block.carr.coords.vertices = 0;
+}
+
 /* Teardown; deinitializes and frees all
  * fonts associated to the menu driver */
 void menu_display_font_free(font_data_t *font)
 {
+   menu_display_font_batch_remove(font);
    font_driver_free(font);
 }
 
@@ -478,6 +760,8 @@ font_data_t *menu_display_font_file(char* fontpath, float font_size, bool is_thr
             fontpath, font_size, is_threaded))
       return NULL;
 
+   menu_display_font_batch_add(font_data);
+
    return font_data;
 }
 
@@ -624,6 +908,93 @@ bool menu_display_get_update_pending(void)
    return false;
 }
 
+/* Marks the menu as changed, so that it gets drawn again
+ * even when unchanged frames are skipped. */
+void menu_display_set_damaged(void)
+{
+   menu_display_damaged = true;
+}
+
+/* Returns true if the last menu_driver_render() didn't
+ * present anything, because nothing on screen would
+ * have changed. */
+bool menu_display_get_frame_skipped(void)
+{
+   return menu_display_frame_skipped;
+}
+
+static bool menu_display_find_any_task(retro_task_t *task, void *data)
+{
+   return true;
+}
+
+/* Whether the menu frame would look any different from the
+ * one on screen. Tweens, scrolling tickers, the clock and the
+ * XMB shader backgrounds all keep the animation flag up, OSD
+ * messages count down per presented frame and running tasks
+ * may deliver thumbnails or refresh lists at any time. */
+static bool menu_display_needs_redraw(void)
+{
+   task_finder_data_t find_data;
+   int16_t mouse[3];
+   int16_t pointer[3];
+   unsigned width                = 0;
+   unsigned height               = 0;
+   settings_t *settings          = config_get_ptr();
+   bool damaged                  = menu_display_damaged;
+
+   menu_display_damaged          = false;
+
+   if (!settings->bools.menu_skip_unchanged_frames)
+      return true;
+
+   video_driver_get_size(&width, &height);
+
+   mouse[0]   = menu_input_mouse_state(MENU_MOUSE_X_AXIS);
+   mouse[1]   = menu_input_mouse_state(MENU_MOUSE_Y_AXIS);
+   mouse[2]   = menu_input_mouse_state(MENU_MOUSE_LEFT_BUTTON);
+   pointer[0] = menu_input_pointer_state(MENU_POINTER_X_AXIS);
+   pointer[1] = menu_input_pointer_state(MENU_POINTER_Y_AXIS);
+   pointer[2] = menu_input_pointer_state(MENU_POINTER_PRESSED);
+
+   if (     width  != menu_display_damage_width
+         || height != menu_display_damage_height
+         || memcmp(mouse, menu_display_damage_mouse, sizeof(mouse))
+         || memcmp(pointer, menu_display_damage_pointer, sizeof(pointer)))
+   {
+      menu_display_damage_width  = width;
+      menu_display_damage_height = height;
+      memcpy(menu_display_damage_mouse, mouse, sizeof(mouse));
+      memcpy(menu_display_damage_pointer, pointer, sizeof(pointer));
+      damaged                    = true;
+   }
+
+   find_data.func     = menu_display_find_any_task;
+   find_data.userdata = NULL;
+
+   if (     damaged
+         || menu_animation_is_active()
+         || menu_animation_has_tweens()
+         || menu_input_dialog_get_display_kb()
+         || runloop_msg_queue_size() > 0
+         || task_queue_find(&find_data))
+   {
+      menu_display_settled = false;
+      return true;
+   }
+
+   /* Draw one more frame once everything stopped, so the final
+    * position of a tween or a message going away make it to
+    * the screen. */
+   if (!menu_display_settled)
+   {
+      menu_display_settled = true;
+      return true;
+   }
+
+   return false;
+}
+
 void menu_display_set_viewport(unsigned width, unsigned height)
 {
    video_driver_set_viewport(width, height, true, false);
@@ -646,6 +1017,7 @@ bool menu_display_get_framebuffer_dirty_flag(void)
 void menu_display_set_framebuffer_dirty_flag(void)
 {
    menu_display_framebuf_dirty = true;
+   menu_display_damaged        = true;
 }
 
 /* Unset the menu framebufer's 'dirty flag'. */
@@ -725,6 +1097,7 @@ bool menu_display_restore_clear_color(void)
 void menu_display_clear_color(menu_display_ctx_clearcolor_t *color,
       video_frame_info_t *video_info)
 {
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->clear_color)
       menu_disp->clear_color(color, video_info);
 }
@@ -739,14 +1112,20 @@ void menu_display_draw(menu_display_ctx_draw_t *draw,
    if (draw->height <= 0)
       draw->height = 1;
 
+   menu_display_quad_batch_flush(video_info);
    menu_disp->draw(draw, video_info);
+   menu_display_draw_calls++;
 }
 
 void menu_display_draw_pipeline(menu_display_ctx_draw_t *draw,
       video_frame_info_t *video_info)
 {
    if (menu_disp && draw && menu_disp->draw_pipeline)
+   {
+      menu_display_quad_batch_flush(video_info);
       menu_disp->draw_pipeline(draw, video_info);
+      menu_display_draw_calls++;
+   }
 }
 
 void menu_display_draw_bg(menu_display_ctx_draw_t *draw,
@@ -810,12 +1189,17 @@ void menu_display_draw_quad(
    menu_display_ctx_draw_t draw;
    struct video_coords coords;
 
+   if (menu_display_quad_batch_add(video_info,
+            x, y, w, h, width, height, color))
+      return;
+
    coords.vertices      = 4;
    coords.vertex        = NULL;
    coords.tex_coord     = NULL;
    coords.lut_tex_coord = NULL;
    coords.color         = color;
 
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->blend_begin)
       menu_disp->blend_begin(video_info);
 
@@ -866,6 +1250,7 @@ void menu_display_draw_polygon(
    coords.lut_tex_coord = NULL;
    coords.color         = color;
 
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->blend_begin)
       menu_disp->blend_begin(video_info);
 
@@ -1363,6 +1748,7 @@ void menu_display_draw_cursor(
    coords.lut_tex_coord = NULL;
    coords.color         = (const float*)color;
 
+   menu_display_quad_batch_flush(video_info);
    if (menu_disp && menu_disp->blend_begin)
       menu_disp->blend_begin(video_info);
 
@@ -1635,6 +2021,446 @@ bool menu_display_reset_textures_list(
    return true;
 }
 
+struct menu_display_texture_batch
+{
+   const char **texture_paths;
+   const char *iconpath;
+   struct texture_image *images;
+   bool *decoded;
+   bool supports_rgba;
+};
+
+static void menu_display_decode_textures(void *data,
+      unsigned begin, unsigned end)
+{
+   unsigned i;
+   struct menu_display_texture_batch *batch =
+      (struct menu_display_texture_batch*)data;
+
+   for (i = begin; i < end; i++)
+   {
+      char texpath[PATH_MAX_LENGTH];
+      struct texture_image *ti = &batch->images[i];
+
+      texpath[0]        = '\0';
+      ti->width         = 0;
+      ti->height        = 0;
+      ti->pixels        = NULL;
+      ti->supports_rgba = batch->supports_rgba;
+      batch->decoded[i] = false;
+
+      if (!string_is_empty(batch->texture_paths[i]))
+         fill_pathname_join(texpath, batch->iconpath,
+               batch->texture_paths[i], sizeof(texpath));
+
+      if (string_is_empty(texpath) || !filestream_exists(texpath))
+         continue;
+
+      batch->decoded[i] = image_texture_load(ti, texpath);
+   }
+}
+
+#ifdef HAVE_RPNG
+/* A theme's icons are also kept in the cache directory as one atlas
+ * PNG plus an index of where each icon sits in it, so the next
+ * context reset or switch back to the theme opens two files
+ * instead of one per icon. */
+#define MENU_ICON_ATLAS_MAGIC    0x54414952 /* "RIAT" */
+#define MENU_ICON_ATLAS_VERSION  1
+#define MENU_ICON_ATLAS_MAX_SIZE 4096
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   /* Over the size and mtime of every icon file. */
+   uint32_t signature;
+   uint32_t count;
+} menu_icon_atlas_header_t;
+
+typedef struct
+{
+   char png_path[PATH_MAX_LENGTH];
+   char idx_path[PATH_MAX_LENGTH];
+   uint32_t signature;
+   /* [count] each, 0 x 0 for an icon that isn't there */
+   unsigned *widths;
+   unsigned *heights;
+   unsigned *xs;
+   unsigned *ys;
+   struct texture_image atlas;
+} menu_icon_atlas_t;
+
+static bool menu_icon_atlas_init(menu_icon_atlas_t *cache,
+      const char **texture_paths, const char *iconpath, unsigned count)
+{
+   unsigned i;
+   char name[32];
+   uint32_t name_hash;
+   settings_t *settings = config_get_ptr();
+   const char *dir      = settings->paths.directory_cache;
+
+   memset(cache, 0, sizeof(*cache));
+
+   if (string_is_empty(dir) || !path_is_directory(dir))
+      return false;
+
+   /* The file name tells the icon sets apart, the signature
+    * tells whether the files changed since. */
+   name_hash = encoding_crc32(0, (const uint8_t*)iconpath, strlen(iconpath));
+   for (i = 0; i < count; i++)
+   {
+      char texpath[PATH_MAX_LENGTH];
+      int32_t size  = -1;
+      int64_t mtime = 0;
+
+      if (string_is_empty(texture_paths[i]))
+         continue;
+
+      name_hash = encoding_crc32(name_hash,
+            (const uint8_t*)texture_paths[i], strlen(texture_paths[i]) + 1);
+
+      fill_pathname_join(texpath, iconpath, texture_paths[i],
+            sizeof(texpath));
+      if (!path_get_size_mtime(texpath, &size, &mtime))
+         size = -1;
+      cache->signature = encoding_crc32(cache->signature,
+            (const uint8_t*)&size, sizeof(size));
+      cache->signature = encoding_crc32(cache->signature,
+            (const uint8_t*)&mtime, sizeof(mtime));
+   }
+
+   snprintf(name, sizeof(name), "menu_icons_%08x.png", name_hash);
+   fill_pathname_join(cache->png_path, dir, name, sizeof(cache->png_path));
+   strlcpy(cache->idx_path, cache->png_path, sizeof(cache->idx_path));
+   path_remove_extension(cache->idx_path);
+   strlcat(cache->idx_path, ".idx", sizeof(cache->idx_path));
+
+   return true;
+}
+
+static void menu_icon_atlas_free(menu_icon_atlas_t *cache)
+{
+   free(cache->widths);
+   cache->widths = NULL;
+   image_texture_free(&cache->atlas);
+}
+
+static bool menu_icon_atlas_load(menu_icon_atlas_t *cache,
+      uintptr_t *items, bool *loaded, unsigned count,
+      enum texture_filter_type filter_type, unsigned *done)
+{
+   unsigned i;
+   int64_t len                      = 0;
+   void *buf                        = NULL;
+   const menu_icon_atlas_header_t *header;
+   const uint32_t *rects;
+   struct texture_image tile;
+   bool ret                         = false;
+
+   if (!filestream_read_file(cache->idx_path, &buf, &len))
+      return false;
+
+   header = (const menu_icon_atlas_header_t*)buf;
+   rects  = (const uint32_t*)(header + 1);
+
+   if (     len != (int64_t)(sizeof(*header) + 4 * count * sizeof(uint32_t))
+         || header->magic     != MENU_ICON_ATLAS_MAGIC
+         || header->version   != MENU_ICON_ATLAS_VERSION
+         || header->signature != cache->signature
+         || header->count     != count)
+      goto end;
+
+   cache->atlas.supports_rgba = video_driver_supports_rgba();
+   if (!image_texture_load(&cache->atlas, cache->png_path))
+      goto end;
+
+   for (i = 0; i < count; i++)
+   {
+      const uint32_t *rect = &rects[4 * i];
+      if (     (uint64_t)rect[0] + rect[2] > cache->atlas.width
+            || (uint64_t)rect[1] + rect[3] > cache->atlas.height)
+         goto end;
+   }
+
+   /* The menu drivers own one texture per icon, so each is cut
+    * back out of the atlas. */
+   tile.supports_rgba = cache->atlas.supports_rgba;
+   tile.pixels        = (uint32_t*)malloc(
+         (size_t)cache->atlas.width * cache->atlas.height * sizeof(uint32_t));
+   if (!tile.pixels)
+      goto end;
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned row;
+      const uint32_t *rect = &rects[4 * i];
+
+      if (loaded)
+         loaded[i] = false;
+
+      if (!rect[2] || !rect[3])
+         continue;
+
+      tile.width  = rect[2];
+      tile.height = rect[3];
+      for (row = 0; row < tile.height; row++)
+         memcpy(tile.pixels + row * tile.width,
+               cache->atlas.pixels
+               + (rect[1] + row) * cache->atlas.width + rect[0],
+               tile.width * sizeof(uint32_t));
+
+      video_driver_texture_load(&tile, filter_type, &items[i]);
+      if (loaded)
+         loaded[i] = true;
+      (*done)++;
+   }
+
+   free(tile.pixels);
+   ret = true;
+
+end:
+   image_texture_free(&cache->atlas);
+   free(buf);
+   return ret;
+}
+
+/* Reads the size out of a PNG's IHDR, so the atlas can be laid out
+ * before anything is decoded. */
+static bool menu_icon_atlas_png_size(const char *path,
+      unsigned *width, unsigned *height)
+{
+   static const uint8_t png_magic[8] = {
+      0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+   uint8_t head[24];
+   bool ret = false;
+   RFILE *f = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!f)
+      return false;
+
+   if (     filestream_read(f, head, sizeof(head)) == sizeof(head)
+         && !memcmp(head, png_magic, sizeof(png_magic))
+         && !memcmp(head + 12, "IHDR", 4))
+   {
+      *width  = ((unsigned)head[16] << 24) | ((unsigned)head[17] << 16)
+              | ((unsigned)head[18] <<  8) |  (unsigned)head[19];
+      *height = ((unsigned)head[20] << 24) | ((unsigned)head[21] << 16)
+              | ((unsigned)head[22] <<  8) |  (unsigned)head[23];
+      ret     = *width && *height
+         && *width  < MENU_ICON_ATLAS_MAX_SIZE
+         && *height < MENU_ICON_ATLAS_MAX_SIZE;
+   }
+
+   filestream_close(f);
+   return ret;
+}
+
+/* Lays out the atlas the icons will be copied into as they are
+ * decoded. Any icon that isn't a readable PNG disables the cache. */
+static bool menu_icon_atlas_begin(menu_icon_atlas_t *cache,
+      const char **texture_paths, const char *iconpath, unsigned count)
+{
+   unsigned i;
+   unsigned width  = 0;
+   unsigned height = 0;
+
+   cache->widths   = (unsigned*)calloc(4 * count, sizeof(unsigned));
+   if (!cache->widths)
+      return false;
+   cache->heights  = cache->widths  + count;
+   cache->xs       = cache->heights + count;
+   cache->ys       = cache->xs      + count;
+
+   for (i = 0; i < count; i++)
+   {
+      char texpath[PATH_MAX_LENGTH];
+
+      if (string_is_empty(texture_paths[i]))
+         continue;
+
+      fill_pathname_join(texpath, iconpath, texture_paths[i],
+            sizeof(texpath));
+      if (!filestream_exists(texpath))
+         continue;
+      if (!menu_icon_atlas_png_size(texpath,
+               &cache->widths[i], &cache->heights[i]))
+         goto error;
+   }
+
+   if (!video_atlas_pack(cache->widths, cache->heights, count,
+            MENU_ICON_ATLAS_MAX_SIZE, &width, &height,
+            cache->xs, cache->ys))
+      goto error;
+
+   cache->atlas.width         = width;
+   cache->atlas.height        = height;
+   cache->atlas.supports_rgba = video_driver_supports_rgba();
+   cache->atlas.pixels        = (uint32_t*)calloc(
+         (size_t)width * height, sizeof(uint32_t));
+   if (!cache->atlas.pixels)
+      goto error;
+
+   return true;
+
+error:
+   menu_icon_atlas_free(cache);
+   return false;
+}
+
+/* Returns false once the icon turns out not to match its header,
+ * which drops the cache for this load. */
+static bool menu_icon_atlas_add(menu_icon_atlas_t *cache,
+      unsigned i, const struct texture_image *img, bool decoded)
+{
+   if (!decoded)
+   {
+      /* Not an icon after all; leave its slot empty. */
+      cache->widths[i] = cache->heights[i] = 0;
+      return true;
+   }
+
+   if (img->width != cache->widths[i] || img->height != cache->heights[i])
+      return false;
+
+   video_atlas_blit(&cache->atlas, img, cache->xs[i], cache->ys[i]);
+   return true;
+}
+
+static void menu_icon_atlas_save(menu_icon_atlas_t *cache, unsigned count)
+{
+   unsigned i;
+   size_t len                       = sizeof(menu_icon_atlas_header_t)
+      + 4 * count * sizeof(uint32_t);
+   menu_icon_atlas_header_t *header = (menu_icon_atlas_header_t*)
+      malloc(len);
+   uint32_t *rects                  = (uint32_t*)(header + 1);
+
+   if (!header)
+      return;
+
+   /* The PNG is always stored as ARGB. */
+   if (cache->atlas.supports_rgba)
+   {
+      size_t n = (size_t)cache->atlas.width * cache->atlas.height;
+      for (i = 0; i < n; i++)
+      {
+         uint32_t px             = cache->atlas.pixels[i];
+         cache->atlas.pixels[i]  = (px & 0xff00ff00)
+            | ((px & 0xff) << 16) | ((px >> 16) & 0xff);
+      }
+   }
+
+   header->magic     = MENU_ICON_ATLAS_MAGIC;
+   header->version   = MENU_ICON_ATLAS_VERSION;
+   header->signature = cache->signature;
+   header->count     = count;
+
+   for (i = 0; i < count; i++)
+   {
+      rects[4 * i + 0] = cache->xs[i];
+      rects[4 * i + 1] = cache->ys[i];
+      rects[4 * i + 2] = cache->widths[i];
+      rects[4 * i + 3] = cache->heights[i];
+   }
+
+   /* Index last, so a half-written atlas is never picked up. */
+   filestream_delete(cache->idx_path);
+   if (rpng_save_image_argb_fast(cache->png_path, cache->atlas.pixels,
+            cache->atlas.width, cache->atlas.height,
+            cache->atlas.width * sizeof(uint32_t)))
+      filestream_write_file(cache->idx_path, header, len);
+
+   free(header);
+}
+#endif
+
+unsigned menu_display_reset_textures_lists(
+      const char **texture_paths,
+      const char *iconpath,
+      uintptr_t *items, bool *loaded, unsigned count,
+      enum texture_filter_type filter_type)
+{
+   unsigned i, j;
+   unsigned done       = 0;
+   /* Only a few images are kept decoded at once,
+    * so peak memory stays close to loading one by one */
+   unsigned batch_size = 1;
+   struct texture_image images[64];
+   bool decoded[64];
+   struct menu_display_texture_batch batch;
+#ifdef HAVE_RPNG
+   menu_icon_atlas_t cache;
+   bool cached         = menu_icon_atlas_init(&cache,
+         texture_paths, iconpath, count);
+
+   if (cached && menu_icon_atlas_load(&cache, items, loaded, count,
+            filter_type, &done))
+      return done;
+
+   if (cached)
+      cached           = menu_icon_atlas_begin(&cache,
+            texture_paths, iconpath, count);
+#endif
+
+#ifdef HAVE_THREADS
+   batch_size          = (rjob_worker_count() + 1) * 2;
+   if (batch_size > ARRAY_SIZE(images))
+      batch_size       = ARRAY_SIZE(images);
+#endif
+
+   batch.iconpath      = iconpath;
+   batch.images        = images;
+   batch.decoded       = decoded;
+   batch.supports_rgba = video_driver_supports_rgba();
+
+   for (i = 0; i < count; i += batch_size)
+   {
+      unsigned n          = MIN(batch_size, count - i);
+
+      batch.texture_paths = texture_paths + i;
+
+#ifdef HAVE_THREADS
+      rjob_parallel_for(n, 1, menu_display_decode_textures, &batch);
+#else
+      menu_display_decode_textures(&batch, 0, n);
+#endif
+
+      for (j = 0; j < n; j++)
+      {
+#ifdef HAVE_RPNG
+         if (cached && !menu_icon_atlas_add(&cache,
+                  i + j, &images[j], decoded[j]))
+         {
+            menu_icon_atlas_free(&cache);
+            cached = false;
+         }
+#endif
+
+         if (loaded)
+            loaded[i + j] = decoded[j];
+
+         if (!decoded[j])
+            continue;
+
+         video_driver_texture_load(&images[j], filter_type, &items[i + j]);
+         image_texture_free(&images[j]);
+         done++;
+      }
+   }
+
+#ifdef HAVE_RPNG
+   if (cached)
+   {
+      menu_icon_atlas_save(&cache, count);
+      menu_icon_atlas_free(&cache);
+   }
+#endif
+
+   return done;
+}
+
 bool menu_driver_is_binding_state(void)
 {
    return menu_driver_is_binding;
@@ -1718,7 +2544,7 @@ static void bundle_decompressed(void *task_data,
 
    configuration_set_bool(settings, settings->bools.bundle_finished, true);
 
-   command_event(CMD_EVENT_MENU_SAVE_CURRENT_CONFIG, NULL);
+   config_save_file_deferred(path_get(RARCH_PATH_CONFIG));
 }
 #endif
 
@@ -1745,7 +2571,7 @@ static bool menu_init(menu_handle_t *menu_data)
             settings->bools.menu_show_start_screen, false);
 
       if (settings->bools.config_save_on_exit)
-         command_event(CMD_EVENT_MENU_SAVE_CURRENT_CONFIG, NULL);
+         config_save_file_deferred(path_get(RARCH_PATH_CONFIG));
    }
 
    if (      settings->bools.bundle_assets_extract_enable
@@ -1811,7 +2637,8 @@ static void menu_driver_toggle(bool on)
    bool enable_menu_sound                     = settings ?
       settings->bools.audio_enable_menu : false;
 
-   menu_driver_toggled = on;
+   menu_driver_toggled  = on;
+   menu_display_damaged = true;
 
    if (!on)
       menu_display_toggle_set_reason(MENU_TOGGLE_REASON_NONE);
@@ -1890,15 +2717,27 @@ const char *menu_driver_ident(void)
 void menu_driver_frame(video_frame_info_t *video_info)
 {
    if (menu_driver_alive && menu_driver_ctx->frame)
+   {
+      menu_display_font_bind_blocks();
+      menu_display_quad_batch_begin();
       menu_driver_ctx->frame(menu_userdata, video_info);
+      menu_display_quad_batch_end(video_info);
+      menu_display_font_unbind_blocks(video_info);
+   }
 }
 
 bool menu_driver_render(bool is_idle, bool rarch_is_inited,
       bool rarch_is_dummy_core)
 {
+   bool redraw                = true;
+
+   menu_display_frame_skipped = false;
+
    if (!menu_driver_data)
       return false;
 
+   performance_zone_begin(PERF_ZONE_MENU_RENDER);
+
    if (BIT64_GET(menu_driver_data->state, MENU_STATE_RENDER_FRAMEBUFFER)
          != BIT64_GET(menu_driver_data->state, MENU_STATE_RENDER_MESSAGEBOX))
       BIT64_SET(menu_driver_data->state, MENU_STATE_RENDER_FRAMEBUFFER);
@@ -1909,6 +2748,8 @@ bool menu_driver_render(bool is_idle, bool rarch_is_inited,
    if (BIT64_GET(menu_driver_data->state, MENU_STATE_RENDER_MESSAGEBOX)
          && !string_is_empty(menu_driver_data->menu_state_msg))
    {
+      menu_display_damaged = true;
+
       if (menu_driver_ctx->render_messagebox)
          menu_driver_ctx->render_messagebox(menu_userdata,
                menu_driver_data->menu_state_msg);
@@ -1926,18 +2767,32 @@ bool menu_driver_render(bool is_idle, bool rarch_is_inited,
       settings_t *settings = config_get_ptr();
       menu_animation_update_time(settings->bools.menu_timedate_enable);
 
+      /* Before the drivers had a chance to clear the
+       * animation flag for this frame. */
+      redraw = menu_display_needs_redraw();
+
       if (menu_driver_ctx->render)
          menu_driver_ctx->render(menu_userdata, is_idle);
    }
 
    if (menu_driver_alive && !is_idle)
-      menu_display_libretro(is_idle, rarch_is_inited, rarch_is_dummy_core);
+   {
+      /* A running core presents frames of its own. */
+      if (redraw || menu_display_libretro_running(
+               rarch_is_inited, rarch_is_dummy_core))
+         menu_display_libretro(is_idle,
+               rarch_is_inited, rarch_is_dummy_core);
+      else
+         menu_display_frame_skipped = true;
+   }
 
    if (menu_driver_ctx->set_texture)
       menu_driver_ctx->set_texture();
 
    menu_driver_data->state               = 0;
 
+   performance_zone_end(PERF_ZONE_MENU_RENDER);
+
    return true;
 }
 
@@ -1957,6 +2812,51 @@ bool menu_driver_is_texture_set(void)
    return false;
 }
 
+/* How long a playlist entry has to stay selected before its
+ * content is prefetched, in microseconds. */
+#define MENU_PREFETCH_DELAY 500000
+
+/* Prefetches the content of the selected playlist entry once the
+ * selection has stopped moving, and stops it when it moves. */
+static void menu_driver_prefetch_update(void)
+{
+   static const file_list_t *prefetch_list = NULL;
+   static size_t prefetch_selection        = 0;
+   static retro_time_t prefetch_since      = 0;
+   static bool prefetch_done               = false;
+   const file_list_t *list                 =
+      menu_entries_get_selection_buf_ptr(0);
+   size_t selection                        = menu_navigation_get_selection();
+   retro_time_t now                        = cpu_features_get_time_usec();
+   const char *path                        = NULL;
+   unsigned type                           = 0;
+
+   if (list != prefetch_list || selection != prefetch_selection)
+   {
+      if (prefetch_done)
+         task_content_prefetch_cancel();
+      prefetch_list      = list;
+      prefetch_selection = selection;
+      prefetch_since     = now;
+      prefetch_done      = false;
+      return;
+   }
+
+   if (prefetch_done || now - prefetch_since < MENU_PREFETCH_DELAY)
+      return;
+
+   prefetch_done = true;
+
+   if (!list || selection >= file_list_get_size(list))
+      return;
+
+   /* Playlist entries keep the content path as their label */
+   file_list_get_at_offset(list, selection, NULL, &path, &type, NULL);
+
+   if (type == FILE_TYPE_RPL_ENTRY && !string_is_empty(path))
+      task_push_content_prefetch(path);
+}
+
 /* Iterate the menu driver for one frame. */
 bool menu_driver_iterate(menu_ctx_iterate_t *iterate)
 {
@@ -1964,8 +2864,13 @@ bool menu_driver_iterate(menu_ctx_iterate_t *iterate)
     * be spawned during the previous frame, do this now
     * and exit the function to go to the next frame.
     */
+   if (     iterate->action != MENU_ACTION_NOOP
+         || menu_entries_ctl(MENU_ENTRIES_CTL_NEEDS_REFRESH, NULL))
+      menu_display_damaged = true;
+
    if (menu_driver_pending_quick_menu)
    {
+      menu_display_damaged           = true;
       menu_driver_pending_quick_menu = false;
       menu_entries_flush_stack(NULL, MENU_SETTINGS);
       menu_display_set_msg_force(true);
@@ -2009,6 +2914,9 @@ bool menu_driver_iterate(menu_ctx_iterate_t *iterate)
             menu_userdata, iterate->action) == -1)
       return false;
 
+   menu_entries_bind_pending(MENU_ENTRIES_BIND_PER_FRAME);
+   menu_driver_prefetch_update();
+
    return true;
 }
 
@@ -2094,6 +3002,7 @@ static bool menu_driver_context_reset(bool video_is_threaded)
    if (!menu_driver_ctx || !menu_driver_ctx->context_reset)
       return false;
    menu_driver_ctx->context_reset(menu_userdata, video_is_threaded);
+   menu_display_damaged = true;
    return true;
 }
 
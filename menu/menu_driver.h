@@ -707,7 +707,15 @@ void menu_display_blend_end(video_frame_info_t *video_info);
 void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, unsigned width, unsigned height);
 void menu_display_scissor_end(video_frame_info_t *video_info);
 
+void menu_display_quad_batch_begin(void);
+void menu_display_quad_batch_end(video_frame_info_t *video_info);
+
+/* Draw calls made so far, optionally starting the count over. */
+unsigned menu_display_get_draw_calls(bool reset);
+
 void menu_display_font_free(font_data_t *font);
+void menu_display_font_flush(video_frame_info_t *video_info,
+      font_data_t *font);
 
 void menu_display_coords_array_reset(void);
 video_coord_array_t *menu_display_get_coords_array(void);
@@ -731,6 +739,10 @@ void menu_display_set_msg_force(bool state);
 bool menu_display_get_font_data_init(void);
 void menu_display_set_font_data_init(bool state);
 bool menu_display_get_update_pending(void);
+
+void menu_display_set_damaged(void);
+
+bool menu_display_get_frame_skipped(void);
 void menu_display_set_viewport(unsigned width, unsigned height);
 void menu_display_unset_viewport(unsigned width, unsigned height);
 bool menu_display_get_framebuffer_dirty_flag(void);
@@ -836,6 +848,30 @@ bool menu_display_reset_textures_list(
       uintptr_t *item,
       enum texture_filter_type filter_type);
 
+/**
+ * menu_display_reset_textures_lists:
+ * @texture_paths       : file name of each texture, NULL to skip it.
+ * @iconpath            : directory of the textures.
+ * @items               : texture handle of each texture.
+ * @loaded              : set to whether each texture was loaded,
+ *                        can be NULL.
+ * @count               : number of textures.
+ * @filter_type         : texture filter.
+ *
+ * Same as menu_display_reset_textures_list() for several textures.
+ * The images are decoded a few at a time on the job pool and
+ * uploaded from the calling thread. With HAVE_RPNG the set is also
+ * cached as one atlas in the cache directory and loaded from there
+ * while none of the files changed.
+ *
+ * Returns: number of textures loaded.
+ **/
+unsigned menu_display_reset_textures_lists(
+      const char **texture_paths,
+      const char *iconpath,
+      uintptr_t *items, bool *loaded, unsigned count,
+      enum texture_filter_type filter_type);
+
 /* Returns the OSK key at a given position */
 int menu_display_osk_ptr_at_pos(void *data, int x, int y,
       unsigned width, unsigned height);
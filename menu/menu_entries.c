@@ -34,6 +34,11 @@ static size_t menu_entries_begin                   = 0;
 static rarch_setting_t *menu_entries_list_settings = NULL;
 static menu_list_t *menu_entries_list              = NULL;
 
+/* Lazily bound entries still waiting in menu_entries_lazy_list,
+ * from menu_entries_lazy_next on. */
+static file_list_t *menu_entries_lazy_list         = NULL;
+static size_t menu_entries_lazy_next               = 0;
+
 struct menu_list
 {
    size_t menu_stack_size;
@@ -127,9 +132,14 @@ static menu_list_t *menu_list_new(void)
       list->menu_stack[i]      = (file_list_t*)
          calloc(1, sizeof(*list->menu_stack[i]));
 
+   /* Entries are rebuilt every time a menu is displayed,
+    * their strings are released at once on clear. */
    for (i = 0; i < list->selection_buf_size; i++)
+   {
       list->selection_buf[i]   = (file_list_t*)
          calloc(1, sizeof(*list->selection_buf[i]));
+      file_list_use_arena(list->selection_buf[i]);
+   }
 
    return list;
 
@@ -255,6 +265,9 @@ static bool menu_entries_clear(file_list_t *list)
    for (i = 0; i < list->size; i++)
       file_list_free_actiondata(list, i);
 
+   if (list == menu_entries_lazy_list)
+      menu_entries_lazy_list = NULL;
+
    if (list)
       file_list_clear(list);
 
@@ -517,7 +530,7 @@ void menu_entries_append(file_list_t *list, const char *path, const char *label,
    list_info.fullpath = NULL;
 
    if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
+      list_info.fullpath = menu_path;
 
    list_info.label       = label;
    list_info.idx         = idx;
@@ -525,9 +538,6 @@ void menu_entries_append(file_list_t *list, const char *path, const char *label,
 
    menu_driver_list_insert(&list_info);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
    cbs = (menu_file_list_cbs_t*)
       calloc(1, sizeof(menu_file_list_cbs_t));
@@ -543,10 +553,11 @@ void menu_entries_append(file_list_t *list, const char *path, const char *label,
    menu_cbs_init(list, cbs, path, label, type, idx);
 }
 
-void menu_entries_append_enum(file_list_t *list, const char *path,
-      const char *label,
+static void menu_entries_append_internal(file_list_t *list,
+      const char *path, const char *label,
       enum msg_hash_enums enum_idx,
-      unsigned type, size_t directory_ptr, size_t entry_idx)
+      unsigned type, size_t directory_ptr, size_t entry_idx,
+      bool lazy)
 {
    menu_ctx_list_t list_info;
    size_t idx;
@@ -564,7 +575,7 @@ void menu_entries_append_enum(file_list_t *list, const char *path,
    list_info.fullpath    = NULL;
 
    if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
+      list_info.fullpath = menu_path;
    list_info.list        = list;
    list_info.path        = path;
    list_info.label       = label;
@@ -573,9 +584,6 @@ void menu_entries_append_enum(file_list_t *list, const char *path,
 
    menu_driver_list_insert(&list_info);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
    cbs = (menu_file_list_cbs_t*)
       calloc(1, sizeof(menu_file_list_cbs_t));
@@ -587,6 +595,18 @@ void menu_entries_append_enum(file_list_t *list, const char *path,
 
    cbs->enum_idx = enum_idx;
 
+   if (lazy)
+   {
+      cbs->lazy = true;
+
+      if (menu_entries_lazy_list != list)
+      {
+         menu_entries_lazy_list = list;
+         menu_entries_lazy_next = idx;
+      }
+      return;
+   }
+
    if (enum_idx != MENU_ENUM_LABEL_PLAYLIST_ENTRY
        && enum_idx != MENU_ENUM_LABEL_PLAYLIST_COLLECTION_ENTRY
        && enum_idx != MENU_ENUM_LABEL_RDB_ENTRY) {
@@ -596,6 +616,84 @@ void menu_entries_append_enum(file_list_t *list, const char *path,
    menu_cbs_init(list, cbs, path, label, type, idx);
 }
 
+void menu_entries_append_enum(file_list_t *list, const char *path,
+      const char *label,
+      enum msg_hash_enums enum_idx,
+      unsigned type, size_t directory_ptr, size_t entry_idx)
+{
+   menu_entries_append_internal(list, path, label, enum_idx,
+         type, directory_ptr, entry_idx, false);
+}
+
+void menu_entries_append_lazy(file_list_t *list, const char *path,
+      const char *label,
+      enum msg_hash_enums enum_idx,
+      unsigned type, size_t directory_ptr, size_t entry_idx)
+{
+   menu_entries_append_internal(list, path, label, enum_idx,
+         type, directory_ptr, entry_idx, true);
+}
+
+/* Binds the callbacks of a lazily appended entry. This has to
+ * happen while its list is on top, since what gets bound
+ * depends on the menu it is in. */
+static void menu_entries_bind_lazy(file_list_t *list, size_t idx,
+      menu_file_list_cbs_t *cbs)
+{
+   const char *path  = NULL;
+   const char *label = NULL;
+   unsigned type     = 0;
+
+   cbs->lazy         = false;
+
+   file_list_get_at_offset(list, idx, &path, &label, &type, NULL);
+
+   if (     cbs->enum_idx != MENU_ENUM_LABEL_PLAYLIST_ENTRY
+         && cbs->enum_idx != MENU_ENUM_LABEL_PLAYLIST_COLLECTION_ENTRY
+         && cbs->enum_idx != MENU_ENUM_LABEL_RDB_ENTRY)
+      cbs->setting = menu_setting_find_enum(cbs->enum_idx);
+
+   menu_cbs_init(list, cbs, path, label ? label : "", type, idx);
+}
+
+menu_file_list_cbs_t *menu_entries_get_actiondata(file_list_t *list,
+      size_t idx)
+{
+   menu_file_list_cbs_t *cbs = (menu_file_list_cbs_t*)
+      file_list_get_actiondata_at_offset(list, idx);
+
+   if (     cbs
+         && cbs->lazy
+         && list == menu_entries_get_selection_buf_ptr(0))
+      menu_entries_bind_lazy(list, idx, cbs);
+
+   return cbs;
+}
+
+void menu_entries_bind_pending(size_t count)
+{
+   file_list_t *list = menu_entries_lazy_list;
+
+   if (!list || list != menu_entries_get_selection_buf_ptr(0))
+      return;
+
+   for (; menu_entries_lazy_next < list->size && count > 0;
+         menu_entries_lazy_next++)
+   {
+      menu_file_list_cbs_t *cbs = (menu_file_list_cbs_t*)
+         file_list_get_actiondata_at_offset(list, menu_entries_lazy_next);
+
+      if (cbs && cbs->lazy)
+      {
+         menu_entries_bind_lazy(list, menu_entries_lazy_next, cbs);
+         count--;
+      }
+   }
+
+   if (menu_entries_lazy_next >= list->size)
+      menu_entries_lazy_list = NULL;
+}
+
 void menu_entries_prepend(file_list_t *list, const char *path, const char *label,
       enum msg_hash_enums enum_idx,
       unsigned type, size_t directory_ptr, size_t entry_idx)
@@ -616,7 +714,7 @@ void menu_entries_prepend(file_list_t *list, const char *path, const char *label
    list_info.fullpath    = NULL;
 
    if (!string_is_empty(menu_path))
-      list_info.fullpath = strdup(menu_path);
+      list_info.fullpath = menu_path;
    list_info.list        = list;
    list_info.path        = path;
    list_info.label       = label;
@@ -625,9 +723,6 @@ void menu_entries_prepend(file_list_t *list, const char *path, const char *label
 
    menu_driver_list_insert(&list_info);
 
-   if (list_info.fullpath)
-      free(list_info.fullpath);
-
    file_list_free_actiondata(list, idx);
    cbs = (menu_file_list_cbs_t*)
       calloc(1, sizeof(menu_file_list_cbs_t));
@@ -701,7 +796,7 @@ rarch_setting_t *menu_entries_get_setting(uint32_t i)
 {
    file_list_t *selection_buf = menu_entries_get_selection_buf_ptr(0);
    menu_file_list_cbs_t *cbs  = selection_buf ?
-      (menu_file_list_cbs_t*)file_list_get_actiondata_at_offset(selection_buf, i) : NULL;
+      menu_entries_get_actiondata(selection_buf, i) : NULL;
 
    if (!cbs)
       return NULL;
@@ -65,7 +65,7 @@ typedef struct menu_ctx_list
 {
    enum menu_list_type type;
    const char *path;
-   char       *fullpath;
+   const char *fullpath;
    const char *label;
    unsigned entry_type;
    unsigned action;
@@ -100,6 +100,8 @@ typedef struct menu_file_list_cbs
    const char *action_get_value_ident;
 
    bool checked;
+   /* Callbacks not bound yet, see menu_entries_append_lazy() */
+   bool lazy;
 
    rarch_setting_t *setting;
 
@@ -180,6 +182,27 @@ void menu_entries_append_enum(file_list_t *list, const char *path, const char *l
       enum msg_hash_enums enum_idx,
       unsigned type, size_t directory_ptr, size_t entry_idx);
 
+/* Like menu_entries_append_enum(), but only binds the entry's
+ * callbacks once it gets looked at through
+ * menu_entries_get_actiondata(), or menu_entries_bind_pending()
+ * gets to it. Meant for file browser and playlist entries, of
+ * which there can be tens of thousands. */
+void menu_entries_append_lazy(file_list_t *list, const char *path, const char *label,
+      enum msg_hash_enums enum_idx,
+      unsigned type, size_t directory_ptr, size_t entry_idx);
+
+/* Returns the callbacks of entry @idx in @list, binding them
+ * first if they were appended lazily and @list is on top. */
+menu_file_list_cbs_t *menu_entries_get_actiondata(file_list_t *list,
+      size_t idx);
+
+/* Binds up to @count lazily appended entries of the current list,
+ * MENU_ENTRIES_BIND_PER_FRAME every frame so the rest are ready
+ * before they're needed. */
+#define MENU_ENTRIES_BIND_PER_FRAME 128
+
+void menu_entries_bind_pending(size_t count);
+
 bool menu_entries_ctl(enum menu_entries_ctl_state state, void *data);
 
 void menu_entries_set_checked(file_list_t *list, size_t entry_idx,
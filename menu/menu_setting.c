@@ -348,6 +348,9 @@ static void setting_get_string_representation_video_stream_quality(
       case 11:
          strlcpy(s, "High", len);
          break;
+      case 12:
+         strlcpy(s, "Low Latency", len);
+         break;
    }
 }
 
@@ -2148,11 +2151,127 @@ int menu_action_handle_setting(rarch_setting_t *setting,
    return -1;
 }
 
+/* Open addressing tables of list indices + 1 of the first setting
+ * of each name and enum, built along with the settings list. */
+static struct
+{
+   rarch_setting_t *list;
+   uint32_t *names;
+   uint32_t *enums;
+   size_t cap;
+} menu_setting_index;
+
+/* Size of the last settings list, so the next one is
+ * allocated in one go instead of being grown. */
+static unsigned menu_setting_last_count = 0;
+
+static uint32_t menu_setting_enum_hash(enum msg_hash_enums enum_idx)
+{
+   return (uint32_t)enum_idx * 2654435761u;
+}
+
+static void menu_setting_index_free(void)
+{
+   free(menu_setting_index.names);
+   free(menu_setting_index.enums);
+   memset(&menu_setting_index, 0, sizeof(menu_setting_index));
+}
+
+static void menu_setting_index_build(rarch_setting_t *list, unsigned count)
+{
+   unsigned i;
+   size_t mask;
+   size_t cap = 64;
+
+   menu_setting_index_free();
+
+   while (cap < (size_t)count * 2)
+      cap <<= 1;
+
+   menu_setting_index.names = (uint32_t*)calloc(cap, sizeof(uint32_t));
+   menu_setting_index.enums = (uint32_t*)calloc(cap, sizeof(uint32_t));
+
+   /* Lookups fall back to walking the list */
+   if (!menu_setting_index.names || !menu_setting_index.enums)
+   {
+      menu_setting_index_free();
+      return;
+   }
+
+   mask = cap - 1;
+
+   for (i = 0; i < count; i++)
+   {
+      size_t slot;
+      rarch_setting_t *setting = &list[i];
+
+      if (setting_get_type(setting) > ST_GROUP)
+         continue;
+
+      if (setting->name)
+      {
+         for (slot = msg_hash_calculate(setting->name) & mask;
+               menu_setting_index.names[slot]; slot = (slot + 1) & mask)
+            if (string_is_equal(
+                     list[menu_setting_index.names[slot] - 1].name,
+                     setting->name))
+               break;
+
+         if (!menu_setting_index.names[slot])
+            menu_setting_index.names[slot] = i + 1;
+      }
+
+      if (setting->enum_idx)
+      {
+         for (slot = menu_setting_enum_hash(setting->enum_idx) & mask;
+               menu_setting_index.enums[slot]; slot = (slot + 1) & mask)
+            if (list[menu_setting_index.enums[slot] - 1].enum_idx
+                  == setting->enum_idx)
+               break;
+
+         if (!menu_setting_index.enums[slot])
+            menu_setting_index.enums[slot] = i + 1;
+      }
+   }
+
+   menu_setting_index.list = list;
+   menu_setting_index.cap  = cap;
+}
+
+static rarch_setting_t *menu_setting_found(rarch_setting_t *setting)
+{
+   if (string_is_empty(setting->short_description))
+      return NULL;
+
+   if (setting->read_handler)
+      setting->read_handler(setting);
+
+   return setting;
+}
+
 static rarch_setting_t *menu_setting_find_internal(rarch_setting_t *setting,
       const char *label)
 {
    rarch_setting_t **list = &setting;
 
+   if (setting == menu_setting_index.list)
+   {
+      size_t mask = menu_setting_index.cap - 1;
+      size_t slot;
+
+      for (slot = msg_hash_calculate(label) & mask;
+            menu_setting_index.names[slot]; slot = (slot + 1) & mask)
+      {
+         rarch_setting_t *entry =
+            &setting[menu_setting_index.names[slot] - 1];
+
+         if (string_is_equal(entry->name, label))
+            return menu_setting_found(entry);
+      }
+
+      return NULL;
+   }
+
    for (; setting_get_type(setting) != ST_NONE; (*list = *list + 1))
    {
       const char *name              = setting->name;
@@ -2179,6 +2298,25 @@ static rarch_setting_t *menu_setting_find_internal_enum(rarch_setting_t *setting
      enum msg_hash_enums enum_idx)
 {
    rarch_setting_t **list = &setting;
+
+   if (setting == menu_setting_index.list)
+   {
+      size_t mask = menu_setting_index.cap - 1;
+      size_t slot;
+
+      for (slot = menu_setting_enum_hash(enum_idx) & mask;
+            menu_setting_index.enums[slot]; slot = (slot + 1) & mask)
+      {
+         rarch_setting_t *entry =
+            &setting[menu_setting_index.enums[slot] - 1];
+
+         if (entry->enum_idx == enum_idx)
+            return menu_setting_found(entry);
+      }
+
+      return NULL;
+   }
+
    for (; setting_get_type(setting) != ST_NONE; (*list = *list + 1))
    {
       if (setting->enum_idx == enum_idx && setting_get_type(setting) <= ST_GROUP)
@@ -2260,7 +2398,7 @@ int menu_setting_set(unsigned type, unsigned action, bool wraparound)
    file_list_t *selection_buf = menu_entries_get_selection_buf_ptr(0);
    size_t selection           = menu_navigation_get_selection();
    menu_file_list_cbs_t *cbs  = selection_buf ?
-      (menu_file_list_cbs_t*)file_list_get_actiondata_at_offset(selection_buf, selection) : NULL;
+      menu_entries_get_actiondata(selection_buf, selection) : NULL;
 
    if (!cbs)
       return 0;
@@ -2856,12 +2994,17 @@ void general_write_handler(rarch_setting_t *setting)
          audio_set_float(AUDIO_ACTION_MIXER_VOLUME_GAIN, *setting->value.target.fraction);
          break;
       case MENU_ENUM_LABEL_AUDIO_LATENCY:
+      case MENU_ENUM_LABEL_AUDIO_PULL:
       case MENU_ENUM_LABEL_AUDIO_OUTPUT_RATE:
+      case MENU_ENUM_LABEL_AUDIO_ALSA_MMAP:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_FLOAT_FORMAT:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_SH_BUFFER_LENGTH:
          rarch_cmd = CMD_EVENT_AUDIO_REINIT;
          break;
+      case MENU_ENUM_LABEL_INPUT_POLL_THREAD:
+         rarch_cmd = CMD_EVENT_REINIT;
+         break;
       case MENU_ENUM_LABEL_PAL60_ENABLE:
          {
             global_t *global             = global_get_ptr();
@@ -4252,7 +4395,7 @@ static bool setting_append_list(
       case SETTINGS_LIST_CORE:
          {
             unsigned i;
-            struct bool_entry bool_entries[5];
+            struct bool_entry bool_entries[6];
 
             START_GROUP(list, list_info, &group_info,
                   msg_hash_to_str(MENU_ENUM_LABEL_VALUE_CORE_SETTINGS), parent_group);
@@ -4295,6 +4438,12 @@ static bool setting_append_list(
             bool_entries[4].default_value  = allow_rotate;
             bool_entries[4].flags          = SD_FLAG_ADVANCED;
 
+            bool_entries[5].target         = &settings->bools.core_cache_enable;
+            bool_entries[5].name_enum_idx  = MENU_ENUM_LABEL_CORE_CACHE_ENABLE;
+            bool_entries[5].SHORT_enum_idx = MENU_ENUM_LABEL_VALUE_CORE_CACHE_ENABLE;
+            bool_entries[5].default_value  = core_cache_enable;
+            bool_entries[5].flags          = SD_FLAG_ADVANCED;
+
             for (i = 0; i < ARRAY_SIZE(bool_entries); i++)
             {
                CONFIG_BOOL(
@@ -4551,6 +4700,23 @@ static bool setting_append_list(
                      bool_entries[i].flags);
             }
 
+#ifdef HAVE_ZLIB
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.savestate_file_compression,
+                  MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,
+                  MENU_ENUM_LABEL_VALUE_SAVESTATE_FILE_COMPRESSION,
+                  savestate_file_compression,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED);
+#endif
+
 #ifdef HAVE_THREADS
             CONFIG_UINT(
                   list, list_info,
@@ -4599,6 +4765,23 @@ static bool setting_append_list(
                SD_FLAG_CMD_APPLY_AUTO);
          menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_REWIND_TOGGLE);
 
+#ifdef HAVE_THREADS
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.rewind_threaded,
+               MENU_ENUM_LABEL_REWIND_THREADED,
+               MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+               rewind_threaded,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE);
+#endif
+
             CONFIG_UINT(
                   list, list_info,
                   &settings->uints.rewind_granularity,
@@ -4643,6 +4826,48 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.rewind_keyframe_interval,
+                  MENU_ENUM_LABEL_REWIND_KEYFRAME_INTERVAL,
+                  MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_INTERVAL,
+                  rewind_keyframe_interval,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 60, 36000, 60, true, true);
+
+            CONFIG_SIZE(
+                  list, list_info,
+                  &settings->sizes.rewind_keyframe_buffer_size,
+                  MENU_ENUM_LABEL_REWIND_KEYFRAME_BUFFER_SIZE,
+                  MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_BUFFER_SIZE,
+                  rewind_keyframe_buffer_size,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  &setting_get_string_representation_size_in_mb);
+            menu_settings_list_current_add_range(list, list_info, 0, 1024*1024*1024, settings->uints.rewind_buffer_size_step*1024*1024, true, true);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.rewind_keyframe_spill_count,
+                  MENU_ENUM_LABEL_REWIND_KEYFRAME_SPILL_COUNT,
+                  MENU_ENUM_LABEL_VALUE_REWIND_KEYFRAME_SPILL_COUNT,
+                  rewind_keyframe_spill_count,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 10000, 1, true, true);
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -5149,6 +5374,21 @@ static bool setting_append_list(
                   general_read_handler,
                   SD_FLAG_NONE);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_perf_overlay_show,
+                  MENU_ENUM_LABEL_PERF_OVERLAY_SHOW,
+                  MENU_ENUM_LABEL_VALUE_PERF_OVERLAY_SHOW,
+                  fps_show,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
 
 
          CONFIG_BOOL(
@@ -5690,6 +5930,44 @@ static bool setting_append_list(
             menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_REINIT);
 #endif
 
+#ifdef HAVE_VULKAN
+            if (string_is_equal(settings->arrays.video_driver, "vulkan"))
+            {
+               CONFIG_BOOL(
+                     list, list_info,
+                     &settings->bools.video_shader_parallel_record,
+                     MENU_ENUM_LABEL_VIDEO_SHADER_PARALLEL_RECORD,
+                     MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_PARALLEL_RECORD,
+                     video_shader_parallel_record,
+                     MENU_ENUM_LABEL_VALUE_OFF,
+                     MENU_ENUM_LABEL_VALUE_ON,
+                     &group_info,
+                     &subgroup_info,
+                     parent_group,
+                     general_write_handler,
+                     general_read_handler,
+                     SD_FLAG_CMD_APPLY_AUTO
+                     );
+               menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_REINIT);
+
+               CONFIG_UINT(
+                     list, list_info,
+                     &settings->uints.video_shader_dynamic_scale_min,
+                     MENU_ENUM_LABEL_VIDEO_SHADER_DYNAMIC_SCALE_MIN,
+                     MENU_ENUM_LABEL_VALUE_VIDEO_SHADER_DYNAMIC_SCALE_MIN,
+                     video_shader_dynamic_scale_min,
+                     &group_info,
+                     &subgroup_info,
+                     parent_group,
+                     general_write_handler,
+                     general_read_handler);
+               (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+               menu_settings_list_current_add_range(list, list_info, 25, 100, 5, true, true);
+               settings_data_list_current_add_flags(list, list_info, SD_FLAG_CMD_APPLY_AUTO);
+               menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_REINIT);
+            }
+#endif
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.video_vsync,
@@ -5820,6 +6098,22 @@ static bool setting_append_list(
             menu_settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
             settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_frame_delay_auto,
+                  MENU_ENUM_LABEL_VIDEO_FRAME_DELAY_AUTO,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_FRAME_DELAY_AUTO,
+                  frame_delay_auto,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
+
 #if !defined(RARCH_MOBILE)
             {
                gfx_ctx_flags_t flags;
@@ -5871,6 +6165,24 @@ static bool setting_append_list(
                   );
             settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 
+#ifdef HAVE_RPNG
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.screenshot_fast_encode,
+                  MENU_ENUM_LABEL_SCREENSHOT_FAST_ENCODE,
+                  MENU_ENUM_LABEL_VALUE_SCREENSHOT_FAST_ENCODE,
+                  screenshot_fast_encode,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_ADVANCED
+                  );
+#endif
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.video_crop_overscan,
@@ -6121,6 +6433,22 @@ static bool setting_append_list(
                );
          settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_pull,
+               MENU_ENUM_LABEL_AUDIO_PULL,
+               MENU_ENUM_LABEL_VALUE_AUDIO_PULL,
+               audio_pull,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE);
+         settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.audio_latency,
@@ -6274,6 +6602,29 @@ static bool setting_append_list(
          menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_DSP_FILTER_INIT);
          settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#ifdef HAVE_ALSA
+         if (     string_is_equal(settings->arrays.audio_driver, "alsa")
+               || string_is_equal(settings->arrays.audio_driver, "alsathread"))
+         {
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.audio_alsa_mmap,
+                  MENU_ENUM_LABEL_AUDIO_ALSA_MMAP,
+                  MENU_ENUM_LABEL_VALUE_AUDIO_ALSA_MMAP,
+                  alsa_mmap,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE
+                  );
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+         }
+#endif
+
 #ifdef HAVE_WASAPI
          if (string_is_equal(settings->arrays.audio_driver, "wasapi"))
          {
@@ -6393,6 +6744,24 @@ static bool setting_append_list(
             menu_settings_list_current_add_range(list, list_info, 0, 2, 1, true, true);
             settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#ifdef HAVE_THREADS
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.input_poll_thread,
+                  MENU_ENUM_LABEL_INPUT_POLL_THREAD,
+                  MENU_ENUM_LABEL_VALUE_INPUT_POLL_THREAD,
+                  input_poll_thread,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_LAKKA_ADVANCED);
+#endif
+
 #ifdef VITA
             CONFIG_BOOL(
                   list, list_info,
@@ -6812,7 +7181,7 @@ static bool setting_append_list(
                (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
                (*list)[list_info->index - 1].get_string_representation =
                &setting_get_string_representation_video_stream_quality;
-            menu_settings_list_current_add_range(list, list_info, RECORD_CONFIG_TYPE_STREAMING_CUSTOM, RECORD_CONFIG_TYPE_STREAMING_HIGH_QUALITY, 1, true, true);
+            menu_settings_list_current_add_range(list, list_info, RECORD_CONFIG_TYPE_STREAMING_CUSTOM, RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY, 1, true, true);
 
             CONFIG_PATH(
                list, list_info,
@@ -6909,6 +7278,36 @@ static bool setting_append_list(
                   SD_FLAG_NONE
                   );
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_record_hw_encoder,
+                  MENU_ENUM_LABEL_VIDEO_RECORD_HW_ENCODER,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_HW_ENCODER,
+                  record_hw_encoder,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.video_stream_record,
+                  MENU_ENUM_LABEL_VIDEO_STREAM_RECORD,
+                  MENU_ENUM_LABEL_VALUE_VIDEO_STREAM_RECORD,
+                  stream_record,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          break;
@@ -7036,6 +7435,36 @@ static bool setting_append_list(
          (*list)[list_info->index - 1].offset_by = 1;
          menu_settings_list_current_add_range(list, list_info, 1, 6, 1, true, true);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_frames_auto,
+               MENU_ENUM_LABEL_RUN_AHEAD_FRAMES_AUTO,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_FRAMES_AUTO,
+               run_ahead_frames_auto,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE);
+
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_detect_lag,
+               MENU_ENUM_LABEL_RUN_AHEAD_DETECT_LAG,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_DETECT_LAG,
+               run_ahead_detect_lag,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE);
+
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
          CONFIG_BOOL(
                list, list_info,
@@ -7054,6 +7483,38 @@ static bool setting_append_list(
                );
 #endif
 
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_secondary_threaded,
+               MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREADED,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREADED,
+               run_ahead_secondary_threaded,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE);
+#endif
+
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_skip_rollback,
+               MENU_ENUM_LABEL_RUN_AHEAD_SKIP_ROLLBACK,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SKIP_ROLLBACK,
+               run_ahead_skip_rollback,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE);
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.run_ahead_hide_warnings,
@@ -7086,6 +7547,22 @@ static bool setting_append_list(
                SD_FLAG_ADVANCED
                );
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.menu_skip_unchanged_frames,
+               MENU_ENUM_LABEL_MENU_SKIP_UNCHANGED_FRAMES,
+               MENU_ENUM_LABEL_VALUE_MENU_SKIP_UNCHANGED_FRAMES,
+               menu_skip_unchanged_frames,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -7145,6 +7622,23 @@ static bool setting_append_list(
          (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
          menu_settings_list_current_add_range(list, list_info, 1.00, 100.00, 1.0, true, true);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.video_font_sdf,
+               MENU_ENUM_LABEL_VIDEO_FONT_SDF,
+               MENU_ENUM_LABEL_VALUE_VIDEO_FONT_SDF,
+               font_sdf,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_CMD_APPLY_AUTO
+               );
+         menu_settings_list_current_add_cmd(list, list_info, CMD_EVENT_REINIT);
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.video_msg_pos_x,
@@ -9331,6 +9825,24 @@ static bool setting_append_list(
                SD_FLAG_NONE
                );
 
+#if defined(HAVE_NEW_CHEEVOS) && defined(HAVE_THREADS)
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.cheevos_threaded,
+               MENU_ENUM_LABEL_CHEEVOS_THREADED,
+               MENU_ENUM_LABEL_VALUE_CHEEVOS_THREADED,
+               false,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+#endif
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.cheevos_hardcore_mode_enable,
@@ -9648,6 +10160,22 @@ static bool setting_append_list(
                   SD_FLAG_NONE);
             settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.netplay_udp_input,
+                  MENU_ENUM_LABEL_NETPLAY_UDP_INPUT,
+                  MENU_ENUM_LABEL_VALUE_NETPLAY_UDP_INPUT,
+                  netplay_udp_input,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_UINT(
                   list, list_info,
                   &settings->uints.netplay_share_digital,
@@ -10639,6 +11167,9 @@ void menu_setting_free(rarch_setting_t *setting)
    if (!setting)
       return;
 
+   if (setting == menu_setting_index.list)
+      menu_setting_index_free();
+
    list                   = (rarch_setting_t**)&setting;
 
    /* Free data which was previously tagged */
@@ -10776,6 +11307,9 @@ static rarch_setting_t *menu_setting_new_internal(rarch_setting_info_t *list_inf
 
    list = resized_list;
 
+   menu_setting_last_count = list_info->index;
+   menu_setting_index_build(list, list_info->index);
+
    return list;
 
 error:
@@ -10803,7 +11337,8 @@ static rarch_setting_t *menu_setting_new(void)
       return NULL;
 
    list_info->index = 0;
-   list_info->size  = 32;
+   list_info->size  = menu_setting_last_count > 32
+      ? menu_setting_last_count : 32;
 
    list             = menu_setting_new_internal(list_info);
 
@@ -0,0 +1,463 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <formats/image.h>
+#ifdef HAVE_RPNG
+#include <formats/rpng.h>
+#endif
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "menu_thumbnail_cache.h"
+
+#include "../configuration.h"
+#include "../msg_hash.h"
+#include "../verbosity.h"
+#include "../gfx/video_driver.h"
+#include "../managers/memory_budget.h"
+#include "../tasks/tasks_internal.h"
+
+#define MENU_THUMBNAIL_CACHE_BUCKETS 256
+
+typedef struct menu_thumbnail_entry
+{
+   /* Bucket chain. */
+   struct menu_thumbnail_entry *next;
+   /* LRU list, newest first. */
+   struct menu_thumbnail_entry *newer;
+   struct menu_thumbnail_entry *older;
+   char *path;
+   /* Where to save the downscaled copy, NULL if loaded from one. */
+   char *variant;
+   uint32_t hash;
+   size_t size;
+   enum menu_thumbnail_status status;
+   menu_thumbnail_t thumb;
+} menu_thumbnail_entry_t;
+
+static struct
+{
+   menu_thumbnail_entry_t *buckets[MENU_THUMBNAIL_CACHE_BUCKETS];
+   menu_thumbnail_entry_t *newest;
+   menu_thumbnail_entry_t *oldest;
+   size_t size;
+   unsigned count;
+   unsigned pending;
+   unsigned budget_id;
+} menu_thumbnail_cache;
+
+static menu_thumbnail_entry_t *menu_thumbnail_cache_find(
+      const char *path, uint32_t hash)
+{
+   menu_thumbnail_entry_t *entry = menu_thumbnail_cache.buckets[
+      hash % MENU_THUMBNAIL_CACHE_BUCKETS];
+
+   for (; entry; entry = entry->next)
+      if (entry->hash == hash && string_is_equal(entry->path, path))
+         return entry;
+
+   return NULL;
+}
+
+static void menu_thumbnail_cache_unlink(menu_thumbnail_entry_t *entry)
+{
+   if (entry->newer)
+      entry->newer->older = entry->older;
+   else
+      menu_thumbnail_cache.newest = entry->older;
+
+   if (entry->older)
+      entry->older->newer = entry->newer;
+   else
+      menu_thumbnail_cache.oldest = entry->newer;
+
+   entry->newer = NULL;
+   entry->older = NULL;
+}
+
+static void menu_thumbnail_cache_link(menu_thumbnail_entry_t *entry)
+{
+   entry->older = menu_thumbnail_cache.newest;
+   if (entry->older)
+      entry->older->newer = entry;
+   else
+      menu_thumbnail_cache.oldest = entry;
+   menu_thumbnail_cache.newest = entry;
+}
+
+static void menu_thumbnail_cache_touch(menu_thumbnail_entry_t *entry)
+{
+   if (menu_thumbnail_cache.newest == entry)
+      return;
+
+   menu_thumbnail_cache_unlink(entry);
+   menu_thumbnail_cache_link(entry);
+}
+
+static void menu_thumbnail_cache_remove(menu_thumbnail_entry_t *entry)
+{
+   menu_thumbnail_entry_t **link = &menu_thumbnail_cache.buckets[
+      entry->hash % MENU_THUMBNAIL_CACHE_BUCKETS];
+
+   while (*link != entry)
+      link = &(*link)->next;
+   *link = entry->next;
+
+   menu_thumbnail_cache_unlink(entry);
+
+   if (entry->status == MENU_THUMBNAIL_READY)
+      video_driver_texture_unload(&entry->thumb.texture);
+   else if (entry->status == MENU_THUMBNAIL_PENDING)
+      menu_thumbnail_cache.pending--;
+
+   menu_thumbnail_cache.size -= entry->size;
+   menu_thumbnail_cache.count--;
+   if (entry->size)
+      memory_budget_update(menu_thumbnail_cache.budget_id,
+            menu_thumbnail_cache.size);
+
+   free(entry->variant);
+   free(entry->path);
+   free(entry);
+}
+
+/* Drops the least recently used entries until the cache fits again.
+ * Loads in flight and @keep, the entry that just came in, stay. */
+static void menu_thumbnail_cache_evict(menu_thumbnail_entry_t *keep)
+{
+   menu_thumbnail_entry_t *entry = menu_thumbnail_cache.oldest;
+
+   while (entry && (menu_thumbnail_cache.size > MENU_THUMBNAIL_CACHE_SIZE
+            || menu_thumbnail_cache.count > MENU_THUMBNAIL_CACHE_ENTRIES))
+   {
+      menu_thumbnail_entry_t *newer = entry->newer;
+
+      if (entry != keep && entry->status != MENU_THUMBNAIL_PENDING)
+         menu_thumbnail_cache_remove(entry);
+
+      entry = newer;
+   }
+}
+
+/* Asked by the memory budget, the same order as above but down to
+ * the entries shown right now if need be. */
+static size_t menu_thumbnail_cache_budget_evict(void *userdata, size_t want)
+{
+   size_t freed                  = 0;
+   menu_thumbnail_entry_t *entry = menu_thumbnail_cache.oldest;
+
+   while (entry && freed < want)
+   {
+      menu_thumbnail_entry_t *newer = entry->newer;
+
+      if (entry->status != MENU_THUMBNAIL_PENDING)
+      {
+         freed += entry->size;
+         menu_thumbnail_cache_remove(entry);
+      }
+
+      entry = newer;
+   }
+
+   return freed;
+}
+
+static menu_thumbnail_entry_t *menu_thumbnail_cache_add(
+      const char *path, uint32_t hash)
+{
+   menu_thumbnail_entry_t **bucket = &menu_thumbnail_cache.buckets[
+      hash % MENU_THUMBNAIL_CACHE_BUCKETS];
+   menu_thumbnail_entry_t *entry   = (menu_thumbnail_entry_t*)
+      calloc(1, sizeof(*entry));
+
+   if (!entry)
+      return NULL;
+
+   entry->path = strdup(path);
+   entry->hash = hash;
+
+   if (!entry->path)
+   {
+      free(entry);
+      return NULL;
+   }
+
+   entry->next = *bucket;
+   *bucket     = entry;
+
+   menu_thumbnail_cache.count++;
+   menu_thumbnail_cache_link(entry);
+
+   return entry;
+}
+
+/* Box filter, so the thousands of pixels boxart often comes with get
+ * averaged rather than skipped. Works on any 8-bit channel order. */
+static bool menu_thumbnail_cache_downscale(struct texture_image *img)
+{
+   unsigned x, y;
+   uint8_t *out;
+   const uint8_t *in = (const uint8_t*)img->pixels;
+   unsigned longest  = MAX(img->width, img->height);
+   unsigned width    = MAX(1, img->width  * MENU_THUMBNAIL_CACHE_MAX_DIM
+         / longest);
+   unsigned height   = MAX(1, img->height * MENU_THUMBNAIL_CACHE_MAX_DIM
+         / longest);
+
+   if (longest <= MENU_THUMBNAIL_CACHE_MAX_DIM)
+      return false;
+
+   out = (uint8_t*)malloc(width * height * sizeof(uint32_t));
+   if (!out)
+      return false;
+
+   for (y = 0; y < height; y++)
+   {
+      unsigned y0 = y * img->height / height;
+      unsigned y1 = (y + 1) * img->height / height;
+
+      for (x = 0; x < width; x++)
+      {
+         unsigned sx, sy, c;
+         uint32_t sum[4]  = {0};
+         unsigned x0      = x * img->width / width;
+         unsigned x1      = (x + 1) * img->width / width;
+         unsigned area    = (x1 - x0) * (y1 - y0);
+         uint8_t *dst     = out + (y * width + x) * sizeof(uint32_t);
+
+         for (sy = y0; sy < y1; sy++)
+         {
+            const uint8_t *src = in
+               + (sy * img->width + x0) * sizeof(uint32_t);
+
+            for (sx = x0; sx < x1; sx++, src += sizeof(uint32_t))
+               for (c = 0; c < 4; c++)
+                  sum[c] += src[c];
+         }
+
+         for (c = 0; c < 4; c++)
+            dst[c] = (uint8_t)((sum[c] + area / 2) / area);
+      }
+   }
+
+   free(img->pixels);
+   img->pixels = (uint32_t*)out;
+   img->width  = width;
+   img->height = height;
+
+   return true;
+}
+
+#ifdef HAVE_RPNG
+static void menu_thumbnail_cache_swap_rb(struct texture_image *img)
+{
+   size_t i;
+   size_t pixels = img->width * img->height;
+
+   for (i = 0; i < pixels; i++)
+   {
+      uint32_t col   = img->pixels[i];
+      img->pixels[i] = (col & 0xff00ff00)
+         | ((col >> 16) & 0xff) | ((col & 0xff) << 16);
+   }
+}
+
+static void menu_thumbnail_cache_save(struct texture_image *img,
+      const char *path)
+{
+   char dir[PATH_MAX_LENGTH];
+
+   fill_pathname_basedir(dir, path, sizeof(dir));
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return;
+
+   /* rpng wants ARGB, the loader may have handed us ABGR. */
+   if (img->supports_rgba)
+      menu_thumbnail_cache_swap_rb(img);
+
+   if (!rpng_save_image_argb(path, img->pixels, img->width, img->height,
+            img->width * sizeof(uint32_t)))
+      RARCH_WARN("[thumbnails] Failed to save \"%s\".\n", path);
+
+   if (img->supports_rgba)
+      menu_thumbnail_cache_swap_rb(img);
+}
+#endif
+
+/* Name of the downscaled copy of @path, tied to the size of the
+ * original so a replaced thumbnail doesn't keep the old one. */
+static bool menu_thumbnail_cache_variant_path(const char *path,
+      uint32_t hash, char *s, size_t len)
+{
+#ifdef HAVE_RPNG
+   char name[32];
+   settings_t *settings = config_get_ptr();
+   const char *dir      = settings ? settings->paths.directory_cache : NULL;
+
+   if (string_is_empty(dir))
+      return false;
+
+   snprintf(name, sizeof(name), "%08x-%x.png",
+         (unsigned)hash, (unsigned)path_get_size(path));
+   fill_pathname_join(s, dir, "thumbnails", len);
+   fill_pathname_join(s, s, name, len);
+   return true;
+#else
+   return false;
+#endif
+}
+
+static void menu_thumbnail_cache_upload(void *task_data,
+      void *user_data, const char *err)
+{
+   struct texture_image *img     = (struct texture_image*)task_data;
+   char *path                    = (char*)user_data;
+   menu_thumbnail_entry_t *entry = menu_thumbnail_cache_find(path,
+         msg_hash_calculate(path));
+
+   /* Nothing to do if the cache was cleared meanwhile. */
+   if (entry && entry->status == MENU_THUMBNAIL_PENDING)
+   {
+      menu_thumbnail_cache.pending--;
+      entry->status = MENU_THUMBNAIL_MISSING;
+
+      if (img && img->pixels && menu_thumbnail_cache_downscale(img)
+            && entry->variant)
+      {
+#ifdef HAVE_RPNG
+         menu_thumbnail_cache_save(img, entry->variant);
+#endif
+      }
+
+      if (img && img->pixels && video_driver_texture_load(img,
+               TEXTURE_FILTER_MIPMAP_LINEAR, &entry->thumb.texture))
+      {
+         entry->status              = MENU_THUMBNAIL_READY;
+         entry->thumb.width         = img->width;
+         entry->thumb.height        = img->height;
+         entry->size                = img->width * img->height
+            * sizeof(uint32_t);
+         menu_thumbnail_cache.size += entry->size;
+
+         if (!menu_thumbnail_cache.budget_id)
+            menu_thumbnail_cache.budget_id = memory_budget_register(
+                  "thumbnails", menu_thumbnail_cache_budget_evict, NULL);
+         memory_budget_update(menu_thumbnail_cache.budget_id,
+               menu_thumbnail_cache.size);
+      }
+
+      menu_thumbnail_cache_evict(entry);
+   }
+
+   if (img)
+   {
+      image_texture_free(img);
+      free(img);
+   }
+   free(path);
+}
+
+enum menu_thumbnail_status menu_thumbnail_cache_get(const char *path,
+      menu_thumbnail_t *thumb)
+{
+   menu_thumbnail_entry_t *entry = NULL;
+
+   if (string_is_empty(path))
+      return MENU_THUMBNAIL_NONE;
+
+   entry = menu_thumbnail_cache_find(path, msg_hash_calculate(path));
+
+   if (!entry)
+      return MENU_THUMBNAIL_NONE;
+
+   menu_thumbnail_cache_touch(entry);
+
+   if (entry->status == MENU_THUMBNAIL_READY && thumb)
+      *thumb = entry->thumb;
+
+   return entry->status;
+}
+
+bool menu_thumbnail_cache_fetch(const char *path, bool prefetch)
+{
+   uint32_t hash;
+   char *user_data               = NULL;
+   menu_thumbnail_entry_t *entry = NULL;
+
+   if (string_is_empty(path))
+      return false;
+
+   hash  = msg_hash_calculate(path);
+   entry = menu_thumbnail_cache_find(path, hash);
+
+   if (entry)
+   {
+      menu_thumbnail_cache_touch(entry);
+      return true;
+   }
+
+   if (prefetch &&
+         menu_thumbnail_cache.pending >= MENU_THUMBNAIL_CACHE_MAX_PENDING)
+      return false;
+
+   entry = menu_thumbnail_cache_add(path, hash);
+
+   if (!entry)
+      return false;
+
+   entry->status = MENU_THUMBNAIL_MISSING;
+
+   if (filestream_exists(path))
+   {
+      char variant[PATH_MAX_LENGTH];
+      const char *load = path;
+
+      if (menu_thumbnail_cache_variant_path(path, hash,
+               variant, sizeof(variant)))
+      {
+         if (filestream_exists(variant))
+            load = variant;
+         else
+            entry->variant = strdup(variant);
+      }
+
+      user_data = strdup(path);
+
+      if (user_data && task_push_image_load(load,
+               menu_thumbnail_cache_upload, user_data))
+      {
+         entry->status = MENU_THUMBNAIL_PENDING;
+         menu_thumbnail_cache.pending++;
+      }
+      else
+         free(user_data);
+   }
+
+   menu_thumbnail_cache_evict(entry);
+   return true;
+}
+
+void menu_thumbnail_cache_clear(void)
+{
+   while (menu_thumbnail_cache.newest)
+      menu_thumbnail_cache_remove(menu_thumbnail_cache.newest);
+}
@@ -0,0 +1,83 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MENU_THUMBNAIL_CACHE_H
+#define _MENU_THUMBNAIL_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Texture memory the cache may hold on to, in bytes. */
+#define MENU_THUMBNAIL_CACHE_SIZE         (64 * 1024 * 1024)
+
+/* Upper bound on known paths, mostly to cap the negative entries
+ * of playlists without thumbnails. */
+#define MENU_THUMBNAIL_CACHE_ENTRIES      1024
+
+/* Longest side thumbnails are kept at. Anything bigger is scaled
+ * down once and, given a cache directory, saved there as the PNG
+ * loaded from then on. */
+#define MENU_THUMBNAIL_CACHE_MAX_DIM      512
+
+/* Playlist entries to prefetch on each side of the selection. */
+#define MENU_THUMBNAIL_CACHE_PREFETCH     4
+
+/* Prefetch loads allowed in flight at once, so fast scrolling
+ * never floods the task queue with images nobody looks at. */
+#define MENU_THUMBNAIL_CACHE_MAX_PENDING  8
+
+enum menu_thumbnail_status
+{
+   MENU_THUMBNAIL_NONE = 0,
+   MENU_THUMBNAIL_PENDING,
+   MENU_THUMBNAIL_READY,
+   MENU_THUMBNAIL_MISSING
+};
+
+typedef struct menu_thumbnail
+{
+   uintptr_t texture;
+   unsigned width;
+   unsigned height;
+} menu_thumbnail_t;
+
+/* Shared cache of uploaded thumbnail textures, keyed by path. The
+ * cache owns the textures: drivers look them up every frame with
+ * menu_thumbnail_cache_get() and never unload or keep them, since
+ * anything not used recently may be evicted as new images come in. */
+
+/* Looks @path up and marks it recently used. Only READY fills in
+ * @thumb. */
+enum menu_thumbnail_status menu_thumbnail_cache_get(const char *path,
+      menu_thumbnail_t *thumb);
+
+/* Starts loading @path unless it is already known. Files that don't
+ * exist are remembered as MISSING without touching the disk again.
+ * @prefetch loads give up when MENU_THUMBNAIL_CACHE_MAX_PENDING are
+ * in flight, returning false. */
+bool menu_thumbnail_cache_fetch(const char *path, bool prefetch);
+
+/* Unloads every texture and forgets all paths, e.g. when the video
+ * context goes away. Loads still in flight are dropped on arrival. */
+void menu_thumbnail_cache_clear(void);
+
+RETRO_END_DECLS
+
+#endif
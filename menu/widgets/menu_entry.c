@@ -317,7 +317,7 @@ void menu_entry_get(menu_entry_t *entry, size_t stack_idx,
    file_list_get_at_offset(list, i, &path, &entry_label, &entry->type,
          &entry->entry_idx);
 
-   cbs = (menu_file_list_cbs_t*)file_list_get_actiondata_at_offset(list, i);
+   cbs = menu_entries_get_actiondata(list, i);
 
    if (cbs)
    {
@@ -426,7 +426,7 @@ int menu_entry_action(menu_entry_t *entry, unsigned i, enum menu_action action)
    file_list_t *selection_buf =
       menu_entries_get_selection_buf_ptr(0);
    menu_file_list_cbs_t *cbs  = selection_buf ?
-      (menu_file_list_cbs_t*)file_list_get_actiondata_at_offset(selection_buf, i) : NULL;
+      menu_entries_get_actiondata(selection_buf, i) : NULL;
 
    switch (action)
    {
@@ -490,7 +490,7 @@ int menu_entry_action(menu_entry_t *entry, unsigned i, enum menu_action action)
          break;
    }
 
-   cbs = selection_buf ? (menu_file_list_cbs_t*)file_list_get_actiondata_at_offset(selection_buf, i) : NULL;
+   cbs = selection_buf ? menu_entries_get_actiondata(selection_buf, i) : NULL;
 
    if (menu_entries_ctl(MENU_ENTRIES_CTL_NEEDS_REFRESH, NULL))
    {
@@ -286,7 +286,7 @@ void filebrowser_parse(menu_displaylist_info_t *info, unsigned type_data)
          }
 
          items_found++;
-         menu_entries_append_enum(info->list, path, label,
+         menu_entries_append_lazy(info->list, path, label,
                enum_idx,
                file_type, 0, 0);
       }
@@ -21,12 +21,20 @@
 #include <rhash.h>
 #include <compat/strl.h>
 #include <retro_endianness.h>
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
 #include <streams/interface_stream.h>
+#ifdef HAVE_ZLIB
+#include <streams/trans_stream.h>
+#endif
 
 #include "configuration.h"
 #include "movie.h"
 #include "core.h"
 #include "content.h"
+#include "audio/audio_driver.h"
+#include "gfx/video_driver.h"
 #include "retroarch.h"
 #include "msg_hash.h"
 #include "verbosity.h"
@@ -34,6 +42,56 @@
 #include "command.h"
 #include "file_path_special.h"
 
+/* BSV2 layout, all words little-endian except the magic:
+ *
+ * Header: magic, 0, content CRC, state size, keyframe interval,
+ * frame count, index offset (low, high). The last three are filled in
+ * when recording stops.
+ *
+ * Blocks of up to BSV2_BLOCK_FRAMES frames: magic, first frame, frame
+ * count, flags, raw size, stored size, then the payload, zlib-compressed
+ * if BSV2_BLOCK_ZLIB. The raw payload is the CRC-32 of the savestate at
+ * the first frame if BSV2_BLOCK_STATE_CRC, that savestate if
+ * BSV2_BLOCK_KEYFRAME, then per frame a 16-bit count followed by that
+ * many 16-bit input values, or 0x8000 | n to repeat the previous frame
+ * n times.
+ *
+ * Index: magic, block count, then per block its first frame, frame count,
+ * flags and file offset (low, high). A movie with no index (recording was
+ * interrupted) is indexed by scanning the blocks. */
+#define BSV2_HEADER_WORDS            8
+#define BSV2_KEYFRAME_INTERVAL_INDEX 4
+#define BSV2_FRAME_COUNT_INDEX       5
+#define BSV2_INDEX_OFFSET_INDEX      6
+
+#define BSV2_BLOCK_MAGIC          0x424c4b32
+#define BSV2_INDEX_MAGIC          0x49445832
+#define BSV2_BLOCK_WORDS          6
+#define BSV2_BLOCK_FRAMES         60
+#define BSV2_KEYFRAME_INTERVAL    600
+#define BSV2_BLOCK_KEYFRAME       (1 << 0)
+#define BSV2_BLOCK_ZLIB           (1 << 1)
+#define BSV2_BLOCK_STATE_CRC      (1 << 2)
+#define BSV2_REPEAT               0x8000
+#define BSV2_MAX_FRAME_INPUTS     0x7fff
+
+/* Playback timing and state checks for one keyframe interval */
+struct bsv2_segment
+{
+   uint32_t frames;
+   retro_time_t usec;
+   unsigned checks;
+   unsigned mismatches;
+};
+
+struct bsv2_block
+{
+   uint32_t first_frame;
+   uint32_t frames;
+   uint32_t flags;
+   int64_t offset;
+};
+
 struct bsv_movie
 {
    intfstream_t *file;
@@ -52,6 +110,44 @@ struct bsv_movie
    bool playback;
    bool first_rewind;
    bool did_rewind;
+
+   /* BSV2 only. The block holding the current frame is kept decoded:
+    * the input values and, per frame, where its values start. */
+   unsigned version;
+   uint32_t frame;
+   uint32_t frame_count;
+   uint32_t keyframe_interval;
+
+   struct bsv2_block *blocks;
+   size_t blocks_size;
+   size_t blocks_cap;
+
+   bool block_loaded;
+   bool block_has_crc;
+   uint32_t block_first;
+   uint32_t block_frames;
+   uint32_t block_crc;
+   uint32_t frame_inputs[BSV2_BLOCK_FRAMES + 1];
+   int16_t *inputs;
+   size_t inputs_size;
+   size_t inputs_cap;
+
+   /* Playback read position within the current frame */
+   uint32_t input_frame;
+   size_t input_ptr;
+
+   /* Scratch for encoding and decoding blocks */
+   uint8_t *raw;
+   size_t raw_cap;
+   uint8_t *stored;
+   size_t stored_cap;
+
+   /* Playback: check the recorded state CRCs and time each segment */
+   bool verify;
+   struct bsv2_segment *segments;
+   size_t segments_size;
+   size_t segment;
+   retro_time_t segment_start;
 };
 
 struct bsv_state
@@ -61,6 +157,7 @@ struct bsv_state
    bool movie_playback;
    bool eof_exit;
    bool movie_end;
+   bool verify;
 
    /* Movie playback/recording support. */
    char movie_path[PATH_MAX_LENGTH];
@@ -71,6 +168,756 @@ struct bsv_state
 static bsv_movie_t     *bsv_movie_state_handle = NULL;
 static struct bsv_state bsv_movie_state;
 
+static bool bsv2_reserve(void **buf, size_t *cap, size_t size)
+{
+   void *tmp;
+   size_t new_cap = *cap ? *cap : 256;
+
+   if (size <= *cap)
+      return true;
+   while (new_cap < size)
+      new_cap *= 2;
+   if (!(tmp = realloc(*buf, new_cap)))
+      return false;
+   *buf = tmp;
+   *cap = new_cap;
+   return true;
+}
+
+static bool bsv2_write_words(intfstream_t *file,
+      const uint32_t *words, size_t count)
+{
+   size_t i;
+   uint32_t tmp[BSV2_HEADER_WORDS];
+
+   for (i = 0; i < count; i++)
+      tmp[i] = swap_if_big32(words[i]);
+   return intfstream_write(file, tmp, count * sizeof(uint32_t))
+      == (int64_t)(count * sizeof(uint32_t));
+}
+
+static bool bsv2_read_words(intfstream_t *file,
+      uint32_t *words, size_t count)
+{
+   size_t i;
+
+   if (intfstream_read(file, words, count * sizeof(uint32_t))
+         != (int64_t)(count * sizeof(uint32_t)))
+      return false;
+   for (i = 0; i < count; i++)
+      words[i] = swap_if_big32(words[i]);
+   return true;
+}
+
+static bool bsv2_push_block(bsv_movie_t *handle,
+      const struct bsv2_block *block)
+{
+   if (!bsv2_reserve((void**)&handle->blocks, &handle->blocks_cap,
+            (handle->blocks_size + 1) * sizeof(*block)))
+      return false;
+   handle->blocks[handle->blocks_size++] = *block;
+   return true;
+}
+
+/* Index of the block holding @frame, or -1 */
+static int bsv2_find_block(bsv_movie_t *handle, uint32_t frame)
+{
+   size_t lo = 0;
+   size_t hi = handle->blocks_size;
+
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (handle->blocks[mid].first_frame <= frame)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   if (lo == 0)
+      return -1;
+   lo--;
+   if (frame - handle->blocks[lo].first_frame >= handle->blocks[lo].frames)
+      return -1;
+   return (int)lo;
+}
+
+/* Serializes the current block's input into 16-bit tokens at
+ * handle->raw + offset, returns the number of bytes. */
+static size_t bsv2_encode_inputs(bsv_movie_t *handle, size_t offset)
+{
+   uint32_t f;
+   uint32_t run  = 0;
+   uint16_t *out = (uint16_t*)(handle->raw + offset);
+   uint16_t *ptr = out;
+
+   for (f = 0; f < handle->block_frames; f++)
+   {
+      uint32_t start = handle->frame_inputs[f];
+      uint32_t count = handle->frame_inputs[f + 1] - start;
+
+      if (f > 0 && run < BSV2_MAX_FRAME_INPUTS
+            && count == handle->frame_inputs[f] - handle->frame_inputs[f - 1]
+            && !memcmp(handle->inputs + start,
+               handle->inputs + handle->frame_inputs[f - 1],
+               count * sizeof(int16_t)))
+      {
+         run++;
+         continue;
+      }
+
+      if (run)
+         *ptr++ = swap_if_big16((uint16_t)(BSV2_REPEAT | run));
+      run    = 0;
+      *ptr++ = swap_if_big16((uint16_t)count);
+      for (; start < handle->frame_inputs[f + 1]; start++)
+         *ptr++ = swap_if_big16((uint16_t)handle->inputs[start]);
+   }
+
+   if (run)
+      *ptr++ = swap_if_big16((uint16_t)(BSV2_REPEAT | run));
+
+   return (ptr - out) * sizeof(uint16_t);
+}
+
+static bool bsv2_decode_inputs(bsv_movie_t *handle,
+      const uint8_t *data, size_t size, uint32_t frames)
+{
+   size_t pos = 0;
+   uint32_t f = 0;
+
+   handle->inputs_size     = 0;
+   handle->frame_inputs[0] = 0;
+
+   while (f < frames && pos + 2 <= size)
+   {
+      uint16_t token;
+      memcpy(&token, data + pos, sizeof(token));
+      token = swap_if_big16(token);
+      pos  += 2;
+
+      if (token & BSV2_REPEAT)
+      {
+         uint32_t run   = token & ~BSV2_REPEAT;
+         uint32_t start, count;
+
+         if (f == 0 || f + run > frames)
+            return false;
+         start = handle->frame_inputs[f - 1];
+         count = handle->frame_inputs[f] - start;
+
+         if (!bsv2_reserve((void**)&handle->inputs, &handle->inputs_cap,
+                  (handle->inputs_size + (size_t)count * run)
+                  * sizeof(int16_t)))
+            return false;
+         while (run--)
+         {
+            memcpy(handle->inputs + handle->inputs_size,
+                  handle->inputs + start, count * sizeof(int16_t));
+            handle->inputs_size      += count;
+            handle->frame_inputs[++f] = (uint32_t)handle->inputs_size;
+         }
+      }
+      else
+      {
+         uint32_t i;
+
+         if (pos + (size_t)token * 2 > size ||
+               !bsv2_reserve((void**)&handle->inputs, &handle->inputs_cap,
+                  (handle->inputs_size + token) * sizeof(int16_t)))
+            return false;
+         for (i = 0; i < token; i++, pos += 2)
+         {
+            uint16_t val;
+            memcpy(&val, data + pos, sizeof(val));
+            handle->inputs[handle->inputs_size++] =
+               (int16_t)swap_if_big16(val);
+         }
+         handle->frame_inputs[++f] = (uint32_t)handle->inputs_size;
+      }
+   }
+
+   return f == frames && pos == size;
+}
+
+/* Writes the block being recorded at the current file position. */
+static bool bsv2_flush_block(bsv_movie_t *handle)
+{
+   uint32_t words[BSV2_BLOCK_WORDS];
+   struct bsv2_block block;
+   size_t raw_size;
+   size_t state_size   = 0;
+   size_t prefix       = 0;
+   const uint8_t *data = NULL;
+   size_t data_size    = 0;
+
+   block.first_frame = handle->block_first;
+   block.frames      = handle->block_frames;
+   block.flags       = 0;
+   block.offset      = intfstream_tell(handle->file);
+
+   if (handle->state_size &&
+         handle->block_first % handle->keyframe_interval == 0)
+   {
+      block.flags |= BSV2_BLOCK_KEYFRAME;
+      state_size   = handle->state_size;
+   }
+   if (handle->block_has_crc)
+      block.flags |= BSV2_BLOCK_STATE_CRC;
+   prefix = (handle->block_has_crc ? sizeof(uint32_t) : 0) + state_size;
+
+   /* Worst case one count per frame, one token per input */
+   if (!bsv2_reserve((void**)&handle->raw, &handle->raw_cap, prefix +
+            (handle->block_frames + handle->inputs_size) * sizeof(uint16_t)))
+      return false;
+   if (handle->block_has_crc)
+   {
+      uint32_t crc = swap_if_big32(handle->block_crc);
+      memcpy(handle->raw, &crc, sizeof(crc));
+   }
+   if (state_size)
+      memcpy(handle->raw + prefix - state_size, handle->state, state_size);
+   raw_size  = prefix + bsv2_encode_inputs(handle, prefix);
+   data      = handle->raw;
+   data_size = raw_size;
+
+#ifdef HAVE_ZLIB
+   if (bsv2_reserve((void**)&handle->stored, &handle->stored_cap, raw_size))
+   {
+      const struct trans_stream_backend *backend =
+         trans_stream_get_zlib_deflate_backend();
+      void *stream = backend->stream_new();
+
+      if (stream)
+      {
+         uint32_t rd, wn;
+         enum trans_stream_error err;
+
+         backend->define(stream, "level", 6);
+         backend->set_in(stream, handle->raw, (uint32_t)raw_size);
+         backend->set_out(stream, handle->stored, (uint32_t)raw_size);
+
+         /* Keep it raw if it doesn't shrink */
+         if (backend->trans(stream, true, &rd, &wn, &err) && wn < raw_size)
+         {
+            block.flags |= BSV2_BLOCK_ZLIB;
+            data         = handle->stored;
+            data_size    = wn;
+         }
+         backend->stream_free(stream);
+      }
+   }
+#endif
+
+   words[0] = BSV2_BLOCK_MAGIC;
+   words[1] = block.first_frame;
+   words[2] = block.frames;
+   words[3] = block.flags;
+   words[4] = (uint32_t)raw_size;
+   words[5] = (uint32_t)data_size;
+
+   if (!bsv2_write_words(handle->file, words, BSV2_BLOCK_WORDS) ||
+         intfstream_write(handle->file, data, data_size)
+         != (int64_t)data_size)
+      return false;
+
+   return bsv2_push_block(handle, &block);
+}
+
+/* Reads and decodes block @idx. Keyframes go to handle->state. */
+static bool bsv2_load_block(bsv_movie_t *handle, size_t idx)
+{
+   uint32_t words[BSV2_BLOCK_WORDS];
+   const struct bsv2_block *block = &handle->blocks[idx];
+   size_t state_size = (block->flags & BSV2_BLOCK_KEYFRAME)
+      ? handle->state_size : 0;
+   size_t prefix     = state_size
+      + ((block->flags & BSV2_BLOCK_STATE_CRC) ? sizeof(uint32_t) : 0);
+   uint32_t raw_size, stored_size;
+
+   handle->block_loaded = false;
+
+   if (intfstream_seek(handle->file, block->offset, SEEK_SET) < 0 ||
+         !bsv2_read_words(handle->file, words, BSV2_BLOCK_WORDS) ||
+         words[0] != BSV2_BLOCK_MAGIC ||
+         words[1] != block->first_frame ||
+         words[2] != block->frames)
+      return false;
+
+   raw_size    = words[4];
+   stored_size = words[5];
+
+   if (raw_size < prefix ||
+         !bsv2_reserve((void**)&handle->raw, &handle->raw_cap, raw_size) ||
+         !bsv2_reserve((void**)&handle->stored, &handle->stored_cap,
+            stored_size) ||
+         intfstream_read(handle->file, handle->stored, stored_size)
+         != (int64_t)stored_size)
+      return false;
+
+   if (block->flags & BSV2_BLOCK_ZLIB)
+   {
+#ifdef HAVE_ZLIB
+      const struct trans_stream_backend *backend =
+         trans_stream_get_zlib_inflate_backend();
+      void *stream = backend->stream_new();
+      uint32_t rd, wn;
+      enum trans_stream_error err;
+      bool ok;
+
+      if (!stream)
+         return false;
+      backend->set_in(stream, handle->stored, stored_size);
+      backend->set_out(stream, handle->raw, raw_size);
+      ok = backend->trans(stream, true, &rd, &wn, &err) && wn == raw_size;
+      backend->stream_free(stream);
+      if (!ok)
+         return false;
+#else
+      RARCH_ERR("[Movie] Compressed movie block but no zlib support.\n");
+      return false;
+#endif
+   }
+   else if (stored_size != raw_size)
+      return false;
+   else
+      memcpy(handle->raw, handle->stored, raw_size);
+
+   if (!bsv2_decode_inputs(handle, handle->raw + prefix,
+            raw_size - prefix, block->frames))
+      return false;
+
+   handle->block_has_crc = !!(block->flags & BSV2_BLOCK_STATE_CRC);
+   if (handle->block_has_crc)
+   {
+      memcpy(&handle->block_crc, handle->raw, sizeof(uint32_t));
+      handle->block_crc = swap_if_big32(handle->block_crc);
+   }
+   if (state_size)
+      memcpy(handle->state, handle->raw + prefix - state_size, state_size);
+
+   handle->block_first  = block->first_frame;
+   handle->block_frames = block->frames;
+   handle->block_loaded = true;
+   handle->input_frame  = (uint32_t)-1;
+   return true;
+}
+
+/* Builds the block index of a movie whose recording never finished. */
+static bool bsv2_scan_blocks(bsv_movie_t *handle)
+{
+   int64_t pos      = BSV2_HEADER_WORDS * sizeof(uint32_t);
+   int64_t size     = intfstream_get_size(handle->file);
+   uint32_t expect  = 0;
+
+   while (pos + (int64_t)(BSV2_BLOCK_WORDS * sizeof(uint32_t)) <= size)
+   {
+      uint32_t words[BSV2_BLOCK_WORDS];
+      struct bsv2_block block;
+
+      if (intfstream_seek(handle->file, pos, SEEK_SET) < 0 ||
+            !bsv2_read_words(handle->file, words, BSV2_BLOCK_WORDS) ||
+            words[0] != BSV2_BLOCK_MAGIC ||
+            words[1] != expect || !words[2] ||
+            words[2] > BSV2_BLOCK_FRAMES)
+         break;
+
+      block.first_frame = words[1];
+      block.frames      = words[2];
+      block.flags       = words[3];
+      block.offset      = pos;
+      pos              += BSV2_BLOCK_WORDS * sizeof(uint32_t) + words[5];
+      if (pos > size || !bsv2_push_block(handle, &block))
+         break;
+      expect           += block.frames;
+   }
+
+   handle->frame_count = expect;
+   return handle->blocks_size > 0;
+}
+
+static bool bsv2_read_index(bsv_movie_t *handle, int64_t offset)
+{
+   uint32_t words[2];
+   uint32_t i;
+
+   if (intfstream_seek(handle->file, offset, SEEK_SET) < 0 ||
+         !bsv2_read_words(handle->file, words, 2) ||
+         words[0] != BSV2_INDEX_MAGIC)
+      return false;
+
+   for (i = 0; i < words[1]; i++)
+   {
+      uint32_t entry[5];
+      struct bsv2_block block;
+
+      if (!bsv2_read_words(handle->file, entry, 5))
+         return false;
+      block.first_frame = entry[0];
+      block.frames      = entry[1];
+      block.flags       = entry[2];
+      block.offset      = (int64_t)entry[3] | ((int64_t)entry[4] << 32);
+      if (!bsv2_push_block(handle, &block))
+         return false;
+   }
+
+   return handle->blocks_size > 0;
+}
+
+static bool bsv2_init_playback(bsv_movie_t *handle, const uint32_t *header)
+{
+   uint32_t words[BSV2_HEADER_WORDS];
+   uint32_t content_crc = content_get_crc();
+   int64_t index_offset;
+   size_t i;
+   retro_ctx_size_info_t info;
+
+   words[0] = header[MAGIC_INDEX];
+   for (i = 1; i < 4; i++)
+      words[i] = swap_if_big32(header[i]);
+   if (!bsv2_read_words(handle->file, words + 4, BSV2_HEADER_WORDS - 4))
+      return false;
+
+   if (content_crc != 0 && words[CRC_INDEX] != content_crc)
+      RARCH_WARN("%s.\n", msg_hash_to_str(MSG_CRC32_CHECKSUM_MISMATCH));
+
+   handle->version           = 2;
+   handle->state_size        = words[STATE_SIZE_INDEX];
+   handle->keyframe_interval = words[BSV2_KEYFRAME_INTERVAL_INDEX];
+   handle->frame_count       = words[BSV2_FRAME_COUNT_INDEX];
+   index_offset              = (int64_t)words[BSV2_INDEX_OFFSET_INDEX]
+      | ((int64_t)words[BSV2_INDEX_OFFSET_INDEX + 1] << 32);
+
+   if (handle->state_size &&
+         !(handle->state = (uint8_t*)malloc(handle->state_size)))
+      return false;
+
+   if (!index_offset || !bsv2_read_index(handle, index_offset))
+   {
+      handle->blocks_size = 0;
+      RARCH_WARN("[Movie] No frame index, scanning blocks.\n");
+      if (!bsv2_scan_blocks(handle))
+         return false;
+   }
+
+   if (!bsv2_load_block(handle, 0))
+   {
+      RARCH_ERR("%s\n", msg_hash_to_str(MSG_COULD_NOT_READ_STATE_FROM_MOVIE));
+      return false;
+   }
+
+   if (!handle->keyframe_interval)
+      handle->keyframe_interval = BSV2_KEYFRAME_INTERVAL;
+
+   if (bsv_movie_state.verify)
+   {
+      handle->segments_size = handle->frame_count
+         / handle->keyframe_interval + 1;
+      handle->segments      = (struct bsv2_segment*)calloc(
+            handle->segments_size, sizeof(*handle->segments));
+      handle->verify        = handle->segments != NULL;
+   }
+
+   core_serialize_size(&info);
+
+   if (handle->state_size && (handle->blocks[0].flags & BSV2_BLOCK_KEYFRAME))
+   {
+      if (info.size == handle->state_size)
+      {
+         retro_ctx_serialize_info_t serial_info;
+         serial_info.data_const = handle->state;
+         serial_info.size       = handle->state_size;
+         core_unserialize(&serial_info);
+      }
+      else
+         RARCH_WARN("%s\n",
+               msg_hash_to_str(MSG_MOVIE_FORMAT_DIFFERENT_SERIALIZER_VERSION));
+   }
+
+   return true;
+}
+
+static bool bsv2_init_record(bsv_movie_t *handle)
+{
+   retro_ctx_size_info_t info;
+   uint32_t header[BSV2_HEADER_WORDS] = {0};
+
+   core_serialize_size(&info);
+
+   handle->version           = 2;
+   handle->state_size        = info.size;
+   handle->keyframe_interval = BSV2_KEYFRAME_INTERVAL;
+
+   if (handle->state_size &&
+         !(handle->state = (uint8_t*)malloc(handle->state_size)))
+      return false;
+
+   /* Shows up as BSV2 in a hex editor, like BSV1 */
+   header[MAGIC_INDEX]                  = swap_if_little32(BSV2_MAGIC);
+   header[CRC_INDEX]                    = swap_if_big32(content_get_crc());
+   header[STATE_SIZE_INDEX]             = swap_if_big32(
+         (uint32_t)handle->state_size);
+   header[BSV2_KEYFRAME_INTERVAL_INDEX] = swap_if_big32(
+         handle->keyframe_interval);
+
+   return intfstream_write(handle->file, header, sizeof(header))
+      == sizeof(header);
+}
+
+/* Flushes the last block and writes the index. */
+static void bsv2_finish_record(bsv_movie_t *handle)
+{
+   uint32_t words[2];
+   int64_t index_offset;
+   size_t i;
+
+   if (handle->block_frames && !bsv2_flush_block(handle))
+      RARCH_ERR("[Movie] Failed to write the last movie block.\n");
+
+   index_offset = intfstream_tell(handle->file);
+   words[0]     = BSV2_INDEX_MAGIC;
+   words[1]     = (uint32_t)handle->blocks_size;
+   bsv2_write_words(handle->file, words, 2);
+
+   for (i = 0; i < handle->blocks_size; i++)
+   {
+      uint32_t entry[5];
+      entry[0] = handle->blocks[i].first_frame;
+      entry[1] = handle->blocks[i].frames;
+      entry[2] = handle->blocks[i].flags;
+      entry[3] = (uint32_t)handle->blocks[i].offset;
+      entry[4] = (uint32_t)(handle->blocks[i].offset >> 32);
+      bsv2_write_words(handle->file, entry, 5);
+   }
+
+   /* Rewinding may have left older blocks past this point */
+   intfstream_truncate(handle->file, intfstream_tell(handle->file));
+
+   words[0] = handle->frame_count;
+   intfstream_seek(handle->file,
+         BSV2_FRAME_COUNT_INDEX * sizeof(uint32_t), SEEK_SET);
+   bsv2_write_words(handle->file, words, 1);
+
+   words[0] = (uint32_t)index_offset;
+   words[1] = (uint32_t)(index_offset >> 32);
+   bsv2_write_words(handle->file, words, 2);
+}
+
+/* Makes sure the block holding the current frame is decoded. */
+static bool bsv2_prepare_frame(bsv_movie_t *handle)
+{
+   int block;
+
+   if (handle->block_loaded &&
+         handle->frame - handle->block_first < handle->block_frames)
+      return true;
+
+   block = bsv2_find_block(handle, handle->frame);
+   return block >= 0 && bsv2_load_block(handle, block);
+}
+
+/* Playback: accounts the frame to its segment's time and, at the start of
+ * a block, checks the state against the one recorded. */
+static void bsv2_verify_frame(bsv_movie_t *handle)
+{
+   retro_time_t now = cpu_features_get_time_usec();
+   size_t segment   = handle->frame / handle->keyframe_interval;
+   struct bsv2_segment *seg;
+
+   if (handle->frame >= handle->frame_count ||
+         segment >= handle->segments_size)
+      return;
+
+   if (segment != handle->segment || !handle->segment_start)
+   {
+      if (handle->segment_start)
+         handle->segments[handle->segment].usec +=
+            now - handle->segment_start;
+      handle->segment       = segment;
+      handle->segment_start = now;
+   }
+
+   seg = &handle->segments[segment];
+   seg->frames++;
+
+   if (bsv2_prepare_frame(handle) &&
+         handle->block_first == handle->frame && handle->block_has_crc)
+   {
+      retro_ctx_serialize_info_t serial_info;
+      serial_info.data = handle->state;
+      serial_info.size = handle->state_size;
+
+      seg->checks++;
+      if (!core_serialize(&serial_info) || encoding_crc32(0,
+               handle->state, handle->state_size) != handle->block_crc)
+      {
+         seg->mismatches++;
+         RARCH_ERR("[Movie] State differs from the recording at frame %u.\n",
+               handle->frame);
+      }
+   }
+}
+
+static void bsv2_frame_start(bsv_movie_t *handle)
+{
+   if (handle->playback)
+   {
+      if (handle->verify)
+         bsv2_verify_frame(handle);
+      return;
+   }
+
+   if (handle->block_frames == BSV2_BLOCK_FRAMES)
+   {
+      if (!bsv2_flush_block(handle))
+         RARCH_ERR("[Movie] Failed to write movie block.\n");
+      handle->block_first    += handle->block_frames;
+      handle->block_frames    = 0;
+      handle->inputs_size     = 0;
+   }
+
+   /* (Re)starting a block: take its state now, before the core runs,
+    * as keyframe or just for the CRC playback can check against */
+   if (handle->block_frames == 0)
+   {
+      handle->frame_inputs[0] = 0;
+      handle->block_has_crc   = false;
+      if (handle->state_size)
+      {
+         retro_ctx_serialize_info_t serial_info;
+         serial_info.data = handle->state;
+         serial_info.size = handle->state_size;
+         if (core_serialize(&serial_info))
+         {
+            handle->block_crc     = encoding_crc32(0,
+                  handle->state, handle->state_size);
+            handle->block_has_crc = true;
+         }
+      }
+   }
+}
+
+static void bsv2_frame_end(bsv_movie_t *handle)
+{
+   if (!handle->playback && handle->block_frames < BSV2_BLOCK_FRAMES)
+   {
+      handle->frame_inputs[++handle->block_frames] =
+         (uint32_t)handle->inputs_size;
+      handle->frame_count = handle->frame + 1;
+   }
+   handle->frame++;
+}
+
+static void bsv2_set_input(bsv_movie_t *handle, int16_t value)
+{
+   if (handle->inputs_size - handle->frame_inputs[handle->block_frames]
+         >= BSV2_MAX_FRAME_INPUTS ||
+         !bsv2_reserve((void**)&handle->inputs, &handle->inputs_cap,
+            (handle->inputs_size + 1) * sizeof(int16_t)))
+      return;
+   handle->inputs[handle->inputs_size++] = value;
+}
+
+static bool bsv2_get_input(bsv_movie_t *handle, int16_t *value)
+{
+   uint32_t idx;
+
+   if (handle->frame >= handle->frame_count || !bsv2_prepare_frame(handle))
+      return false;
+
+   idx = handle->frame - handle->block_first;
+   if (handle->input_frame != handle->frame)
+   {
+      handle->input_frame = handle->frame;
+      handle->input_ptr   = handle->frame_inputs[idx];
+   }
+
+   /* Polled more often than when recorded: keep the frames aligned */
+   if (handle->input_ptr < handle->frame_inputs[idx + 1])
+      *value = handle->inputs[handle->input_ptr++];
+   else
+      *value = 0;
+   return true;
+}
+
+/* Recording: drop everything from @frame on. */
+static void bsv2_truncate(bsv_movie_t *handle, uint32_t frame)
+{
+   if (frame < handle->block_first)
+   {
+      int block = bsv2_find_block(handle, frame);
+
+      /* Reopen the block holding @frame and write over it and
+       * what follows */
+      if (block < 0 || !bsv2_load_block(handle, block))
+      {
+         RARCH_ERR("[Movie] Failed to rewind movie recording.\n");
+         return;
+      }
+      intfstream_seek(handle->file, handle->blocks[block].offset, SEEK_SET);
+      handle->blocks_size = block;
+   }
+
+   handle->block_frames = frame - handle->block_first;
+   handle->inputs_size  = handle->frame_inputs[handle->block_frames];
+   handle->frame        = frame;
+   handle->frame_count  = frame;
+}
+
+static void bsv2_frame_rewind(bsv_movie_t *handle)
+{
+   uint32_t back   = handle->first_rewind ? 1 : 2;
+   uint32_t target = handle->frame > back ? handle->frame - back : 0;
+
+   handle->did_rewind = true;
+
+   if (handle->playback)
+      handle->frame = target;
+   else
+      bsv2_truncate(handle, target);
+}
+
+/* Playback: restore the nearest keyframe at or before @frame and run the
+ * core up to it, without audio or video. */
+static bool bsv2_seek(bsv_movie_t *handle, uint32_t frame)
+{
+   retro_ctx_serialize_info_t serial_info;
+   int block;
+   bool video_active;
+
+   if (!handle->playback || frame > handle->frame_count)
+      return false;
+
+   block = bsv2_find_block(handle,
+         frame == handle->frame_count && frame ? frame - 1 : frame);
+   while (block > 0 && !(handle->blocks[block].flags & BSV2_BLOCK_KEYFRAME))
+      block--;
+   if (block < 0 || !(handle->blocks[block].flags & BSV2_BLOCK_KEYFRAME) ||
+         !bsv2_load_block(handle, block))
+      return false;
+
+   serial_info.data_const = handle->state;
+   serial_info.size       = handle->state_size;
+   if (!core_unserialize(&serial_info))
+      return false;
+
+   handle->frame = handle->block_first;
+   video_active  = video_driver_is_active();
+   audio_driver_suspend();
+   video_driver_unset_active();
+
+   while (handle->frame < frame)
+   {
+      core_run();
+      handle->frame++;
+   }
+
+   if (video_active)
+      video_driver_set_active();
+   audio_driver_resume();
+   return true;
+}
+
 static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
 {
    uint32_t state_size       = 0;
@@ -90,6 +937,9 @@ static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
    handle->playback          = true;
 
    intfstream_read(handle->file, header, sizeof(uint32_t) * 4);
+   if (swap_if_little32(header[MAGIC_INDEX]) == BSV2_MAGIC)
+      return bsv2_init_playback(handle, header);
+
    /* Compatibility with old implementation that
     * used incorrect documentation. */
    if (swap_if_little32(header[MAGIC_INDEX]) != BSV_MAGIC
@@ -152,12 +1002,9 @@ static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
 
 static bool bsv_movie_init_record(bsv_movie_t *handle, const char *path)
 {
-   retro_ctx_size_info_t info;
-   uint32_t state_size       = 0;
-   uint32_t content_crc      = 0;
-   uint32_t header[4]        = {0};
+   /* Read back too: rewinding a recording reopens written blocks */
    intfstream_t *file        = intfstream_open_file(path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
    if (!file)
@@ -168,48 +1015,7 @@ static bool bsv_movie_init_record(bsv_movie_t *handle, const char *path)
 
    handle->file             = file;
 
-   content_crc              = content_get_crc();
-
-   /* This value is supposed to show up as
-    * BSV1 in a HEX editor, big-endian. */
-   header[MAGIC_INDEX]      = swap_if_little32(BSV_MAGIC);
-   header[CRC_INDEX]        = swap_if_big32(content_crc);
-
-   core_serialize_size(&info);
-
-   state_size               = (unsigned)info.size;
-
-   header[STATE_SIZE_INDEX] = swap_if_big32(state_size);
-#if 0
-   RARCH_ERR("----- debug %u -----\n", header[0]);
-   RARCH_ERR("----- debug %u -----\n", header[1]);
-   RARCH_ERR("----- debug %u -----\n", header[2]);
-   RARCH_ERR("----- debug %u -----\n", header[3]);
-#endif
-
-   intfstream_write(handle->file, header, 4 * sizeof(uint32_t));
-
-   handle->min_file_pos     = sizeof(header) + state_size;
-   handle->state_size       = state_size;
-
-   if (state_size)
-   {
-      retro_ctx_serialize_info_t serial_info;
-
-      handle->state = (uint8_t*)malloc(state_size);
-      if (!handle->state)
-         return false;
-
-      serial_info.data = handle->state;
-      serial_info.size = state_size;
-
-      core_serialize(&serial_info);
-
-      intfstream_write(handle->file,
-            handle->state, state_size);
-   }
-
-   return true;
+   return bsv2_init_record(handle);
 }
 
 static void bsv_movie_free(bsv_movie_t *handle)
@@ -217,11 +1023,19 @@ static void bsv_movie_free(bsv_movie_t *handle)
    if (!handle)
       return;
 
+   if (handle->version == 2 && !handle->playback && handle->file)
+      bsv2_finish_record(handle);
+
    intfstream_close(handle->file);
    free(handle->file);
 
    free(handle->state);
    free(handle->frame_pos);
+   free(handle->blocks);
+   free(handle->inputs);
+   free(handle->raw);
+   free(handle->stored);
+   free(handle->segments);
    free(handle);
 }
 
@@ -242,6 +1056,10 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path,
    else if (!bsv_movie_init_record(handle, path))
       goto error;
 
+   /* BSV2 finds frames through its block index */
+   if (handle->version == 2)
+      return handle;
+
    /* Just pick something really large
     * ~1 million frames rewind should do the trick. */
    if (!(frame_pos = (size_t*)calloc((1 << 20), sizeof(size_t))))
@@ -262,7 +1080,9 @@ error:
 /* Used for rewinding while playback/record. */
 void bsv_movie_set_frame_start(void)
 {
-   if (bsv_movie_state_handle)
+   if (bsv_movie_state_handle && bsv_movie_state_handle->version == 2)
+      bsv2_frame_start(bsv_movie_state_handle);
+   else if (bsv_movie_state_handle)
       bsv_movie_state_handle->frame_pos[bsv_movie_state_handle->frame_ptr]
          = intfstream_tell(bsv_movie_state_handle->file);
 }
@@ -272,9 +1092,12 @@ void bsv_movie_set_frame_end(void)
    if (!bsv_movie_state_handle)
       return;
 
-   bsv_movie_state_handle->frame_ptr    =
-      (bsv_movie_state_handle->frame_ptr + 1)
-      & bsv_movie_state_handle->frame_mask;
+   if (bsv_movie_state_handle->version == 2)
+      bsv2_frame_end(bsv_movie_state_handle);
+   else
+      bsv_movie_state_handle->frame_ptr    =
+         (bsv_movie_state_handle->frame_ptr + 1)
+         & bsv_movie_state_handle->frame_mask;
 
    bsv_movie_state_handle->first_rewind =
       !bsv_movie_state_handle->did_rewind;
@@ -283,6 +1106,12 @@ void bsv_movie_set_frame_end(void)
 
 static void bsv_movie_frame_rewind(bsv_movie_t *handle)
 {
+   if (handle->version == 2)
+   {
+      bsv2_frame_rewind(handle);
+      return;
+   }
+
    handle->did_rewind = true;
 
    if (     (handle->frame_ptr <= 1)
@@ -395,6 +1224,9 @@ bool bsv_movie_init(void)
 
 bool bsv_movie_get_input(int16_t *bsv_data)
 {
+   if (bsv_movie_state_handle->version == 2)
+      return bsv2_get_input(bsv_movie_state_handle, bsv_data);
+
    if (intfstream_read(bsv_movie_state_handle->file, bsv_data, 1) != 1)
       return false;
 
@@ -439,6 +1271,9 @@ bool bsv_movie_ctl(enum bsv_ctl_state state, void *data)
       case BSV_MOVIE_CTL_SET_END_EOF:
          bsv_movie_state.eof_exit = true;
          break;
+      case BSV_MOVIE_CTL_SET_VERIFY:
+         bsv_movie_state.verify = true;
+         break;
       case BSV_MOVIE_CTL_SET_END:
          bsv_movie_state.movie_end = true;
          break;
@@ -451,10 +1286,21 @@ bool bsv_movie_ctl(enum bsv_ctl_state state, void *data)
       case BSV_MOVIE_CTL_FRAME_REWIND:
          bsv_movie_frame_rewind(bsv_movie_state_handle);
          break;
+      case BSV_MOVIE_CTL_SEEK:
+         if (!bsv_movie_state_handle ||
+               bsv_movie_state_handle->version != 2)
+            return false;
+         return bsv2_seek(bsv_movie_state_handle, *(uint32_t*)data);
       case BSV_MOVIE_CTL_SET_INPUT:
          {
             int16_t *bsv_data = (int16_t*)data;
 
+            if (bsv_movie_state_handle->version == 2)
+            {
+               bsv2_set_input(bsv_movie_state_handle, *bsv_data);
+               break;
+            }
+
             *bsv_data = swap_if_big16(*bsv_data);
             intfstream_write(bsv_movie_state_handle->file, bsv_data, 1);
          }
@@ -467,6 +1313,53 @@ bool bsv_movie_ctl(enum bsv_ctl_state state, void *data)
    return true;
 }
 
+void bsv_movie_print_report(FILE *fp)
+{
+   size_t i;
+   unsigned checks      = 0;
+   unsigned mismatches  = 0;
+   bsv_movie_t *handle  = bsv_movie_state_handle;
+
+   if (!handle || !handle->verify)
+      return;
+
+   if (handle->segment_start)
+   {
+      handle->segments[handle->segment].usec +=
+         cpu_features_get_time_usec() - handle->segment_start;
+      handle->segment_start = 0;
+   }
+
+   for (i = 0; i < handle->segments_size; i++)
+   {
+      checks     += handle->segments[i].checks;
+      mismatches += handle->segments[i].mismatches;
+   }
+
+   fprintf(fp, "Movie: %u of %u frames played, %u state checks, "
+         "%u mismatches.\n",
+         (unsigned)MIN(handle->frame, handle->frame_count),
+         (unsigned)handle->frame_count, checks, mismatches);
+
+   for (i = 0; i < handle->segments_size; i++)
+   {
+      const struct bsv2_segment *seg = &handle->segments[i];
+      double seconds                 = seg->usec / 1000000.0;
+      uint32_t first                 = (uint32_t)(i * handle->keyframe_interval);
+      uint32_t last                  = first + handle->keyframe_interval - 1;
+
+      if (!seg->frames)
+         continue;
+      if (last >= handle->frame_count)
+         last = handle->frame_count - 1;
+
+      fprintf(fp, "  frames %7u-%-7u %8.3f s %10.2f fps%s\n",
+            first, last, seconds,
+            seconds > 0.0 ? seg->frames / seconds : 0.0,
+            seg->mismatches ? "  DESYNC" : "");
+   }
+}
+
 void bsv_movie_set_path(const char *path)
 {
    strlcpy(bsv_movie_state.movie_path,
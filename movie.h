@@ -17,6 +17,7 @@
 #ifndef __RARCH_MOVIE_H
 #define __RARCH_MOVIE_H
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -26,6 +27,7 @@
 RETRO_BEGIN_DECLS
 
 #define BSV_MAGIC          0x42535631
+#define BSV2_MAGIC         0x42535632
 
 #define MAGIC_INDEX        0
 #define SERIALIZER_INDEX   1
@@ -51,7 +53,12 @@ enum bsv_ctl_state
    BSV_MOVIE_CTL_UNSET_START_PLAYBACK,
    BSV_MOVIE_CTL_UNSET_PLAYBACK,
    BSV_MOVIE_CTL_FRAME_REWIND,
+   /* Playback only: jump to the frame pointed to by data (uint32_t) */
+   BSV_MOVIE_CTL_SEEK,
    BSV_MOVIE_CTL_SET_END_EOF,
+   /* Check playback against the state CRCs recorded in the movie and
+    * time it, see bsv_movie_print_report */
+   BSV_MOVIE_CTL_SET_VERIFY,
    BSV_MOVIE_CTL_SET_END,
    BSV_MOVIE_CTL_UNSET_END
 };
@@ -82,6 +89,10 @@ bool bsv_movie_check(void);
 
 bool bsv_movie_init_handle(const char *path, enum rarch_movie_type type);
 
+/* Per-segment timing and state check results of the movie being
+ * played back, if BSV_MOVIE_CTL_SET_VERIFY was set */
+void bsv_movie_print_report(FILE *fp);
+
 RETRO_END_DECLS
 
 #endif
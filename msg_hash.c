@@ -29,6 +29,14 @@
 
 static unsigned uint_user_language;
 
+/* Strings of the current language by enum, filled in on first use
+ * so the language switches and the English fallback run once per
+ * string. The strings are constants, a thread racing a language
+ * change at worst gets the old translation. */
+static const char *msg_hash_cache[MSG_LAST];
+/* The language is also set through msg_hash_get_uint() */
+static unsigned msg_hash_cache_language;
+
 int menu_hash_get_help_enum(enum msg_hash_enums msg, char *s, size_t len)
 {
 #ifdef HAVE_MENU
@@ -99,7 +107,7 @@ int menu_hash_get_help_enum(enum msg_hash_enums msg, char *s, size_t len)
 #endif
 }
 
-const char *msg_hash_to_str(enum msg_hash_enums msg)
+static const char *msg_hash_to_str_lang(enum msg_hash_enums msg)
 {
    const char *ret = NULL;
 
@@ -168,6 +176,32 @@ const char *msg_hash_to_str(enum msg_hash_enums msg)
    return msg_hash_to_str_us(msg);
 }
 
+const char *msg_hash_to_str(enum msg_hash_enums msg)
+{
+   const char *ret;
+
+   if ((unsigned)msg >= MSG_LAST)
+      return msg_hash_to_str_lang(msg);
+
+   if (msg_hash_cache_language != uint_user_language)
+   {
+      memset((void*)msg_hash_cache, 0, sizeof(msg_hash_cache));
+      msg_hash_cache_language = uint_user_language;
+   }
+
+   if ((ret = msg_hash_cache[msg]))
+      return ret;
+
+   ret = msg_hash_to_str_lang(msg);
+
+   /* The hotkey labels are printed into a shared buffer */
+   if (     msg < MENU_ENUM_LABEL_INPUT_HOTKEY_BIND_BEGIN
+         || msg > MENU_ENUM_LABEL_INPUT_HOTKEY_BIND_END)
+      msg_hash_cache[msg] = ret;
+
+   return ret;
+}
+
 uint32_t msg_hash_calculate(const char *s)
 {
    return djb2_calculate(s);
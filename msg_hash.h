@@ -421,6 +421,9 @@ enum msg_hash_enums
    MSG_RUNAHEAD_FAILED_TO_SAVE_STATE,
    MSG_RUNAHEAD_FAILED_TO_LOAD_STATE,
    MSG_RUNAHEAD_FAILED_TO_CREATE_SECONDARY_INSTANCE,
+   MSG_RUNAHEAD_LAG_DETECTED,
+   MSG_RUNAHEAD_NO_LAG_DETECTED,
+   MSG_RUNAHEAD_LAG_DETECTION_FAILED,
    MSG_MISSING_ASSETS,
 
    MENU_LABEL(STREAMING_TITLE),
@@ -538,6 +541,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_URL_ENTRY,
    MENU_ENUM_LABEL_CORE_OPTION_ENTRY,
    MENU_ENUM_LABEL_NETWORK_INFO_ENTRY,
+   MENU_ENUM_LABEL_SHADER_PASS_TIMES_ENTRY,
    MENU_ENUM_LABEL_SYSTEM_INFO_ENTRY,
    MENU_ENUM_LABEL_CORE_INFO_ENTRY,
    MENU_ENUM_LABEL_PLAYLIST_ENTRY,
@@ -719,6 +723,7 @@ enum msg_hash_enums
    MENU_LABEL(INPUT_ICADE_ENABLE),
    MENU_LABEL(INPUT_ALL_USERS_CONTROL_MENU),
    MENU_LABEL(INPUT_POLL_TYPE_BEHAVIOR),
+   MENU_LABEL(INPUT_POLL_THREAD),
    MENU_LABEL(INPUT_UNIFIED_MENU_CONTROLS),
 
    /* Video */
@@ -730,6 +735,7 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_FONT_ENABLE),
    MENU_LABEL(VIDEO_FONT_PATH),
    MENU_LABEL(VIDEO_FONT_SIZE),
+   MENU_LABEL(VIDEO_FONT_SDF),
    MENU_LABEL(VIDEO_MESSAGE_POS_X),
    MENU_LABEL(VIDEO_MESSAGE_POS_Y),
    MENU_LABEL(VIDEO_MESSAGE_COLOR_RED),
@@ -744,8 +750,10 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_SOFT_FILTER),
    MENU_LABEL(VIDEO_MAX_SWAPCHAIN_IMAGES),
    MENU_LABEL(VIDEO_GPU_SCREENSHOT),
+   MENU_LABEL(SCREENSHOT_FAST_ENCODE),
    MENU_LABEL(VIDEO_BLACK_FRAME_INSERTION),
    MENU_LABEL(VIDEO_FRAME_DELAY),
+   MENU_LABEL(VIDEO_FRAME_DELAY_AUTO),
    MENU_LABEL(VIDEO_VSYNC),
    MENU_LABEL(VIDEO_ADAPTIVE_VSYNC),
    MENU_LABEL(VIDEO_HARD_SYNC),
@@ -773,6 +781,8 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_ALLOW_ROTATE),
    MENU_LABEL(VIDEO_SHARED_CONTEXT),
    MENU_LABEL(VIDEO_THREADED),
+   MENU_LABEL(VIDEO_SHADER_PARALLEL_RECORD),
+   MENU_LABEL(VIDEO_SHADER_DYNAMIC_SCALE_MIN),
 
 
    MENU_LABEL(VIDEO_SWAP_INTERVAL),
@@ -992,6 +1002,7 @@ enum msg_hash_enums
    MENU_LABEL(CHEEVOS_TEST_UNOFFICIAL),
    MENU_LABEL(CHEEVOS_VERBOSE_ENABLE),
    MENU_LABEL(CHEEVOS_AUTO_SCREENSHOT),
+   MENU_LABEL(CHEEVOS_THREADED),
    MENU_LABEL(CHEEVOS_ENABLE),
    MENU_LABEL(CHEEVOS_DESCRIPTION),
    MENU_LABEL(CHEEVOS_UNLOCKED_ACHIEVEMENTS),
@@ -1215,6 +1226,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_MUTE),
    MENU_LABEL(AUDIO_MIXER_MUTE),
    MENU_LABEL(AUDIO_SYNC),
+   MENU_LABEL(AUDIO_PULL),
    MENU_LABEL(AUDIO_VOLUME),
    MENU_LABEL(AUDIO_MIXER_VOLUME),
    MENU_LABEL(AUDIO_RATE_CONTROL_DELTA),
@@ -1223,6 +1235,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_WASAPI_EXCLUSIVE_MODE),
    MENU_LABEL(AUDIO_WASAPI_FLOAT_FORMAT),
    MENU_LABEL(AUDIO_WASAPI_SH_BUFFER_LENGTH),
+   MENU_LABEL(AUDIO_ALSA_MMAP),
 
    MENU_LABEL(SAVE_STATE),
    MENU_LABEL(LOAD_STATE),
@@ -1238,6 +1251,7 @@ enum msg_hash_enums
    MENU_LABEL(FPS_SHOW),
    MENU_LABEL(MEMORY_SHOW),
    MENU_LABEL(STATISTICS_SHOW),
+   MENU_LABEL(PERF_OVERLAY_SHOW),
    MENU_LABEL(FRAMECOUNT_SHOW),
    MENU_LABEL(BSV_RECORD_TOGGLE),
    MENU_ENUM_LABEL_L_X_PLUS,
@@ -1262,6 +1276,9 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_KEYFRAME_INTERVAL),
+   MENU_LABEL(REWIND_KEYFRAME_BUFFER_SIZE),
+   MENU_LABEL(REWIND_KEYFRAME_SPILL_COUNT),
    MENU_LABEL(INPUT_META_REWIND),
    MENU_LABEL(INPUT_META_CHEAT_DETAILS),
    MENU_LABEL(INPUT_META_CHEAT_SEARCH),
@@ -1322,6 +1339,7 @@ enum msg_hash_enums
    MENU_LABEL(SAVESTATE_AUTO_SAVE),
    MENU_LABEL(SAVESTATE_AUTO_LOAD),
    MENU_LABEL(SAVESTATE_THUMBNAIL_ENABLE),
+   MENU_LABEL(SAVESTATE_FILE_COMPRESSION),
 
    MENU_LABEL(SUSPEND_SCREENSAVER_ENABLE),
    MENU_LABEL(DPI_OVERRIDE_ENABLE),
@@ -1349,6 +1367,7 @@ enum msg_hash_enums
    MENU_LABEL(NETPLAY_SPECTATOR_MODE_ENABLE),
    MENU_LABEL(NETPLAY_TCP_UDP_PORT),
    MENU_LABEL(NETPLAY_NAT_TRAVERSAL),
+   MENU_LABEL(NETPLAY_UDP_INPUT),
    MENU_LABEL(NETPLAY_REQUEST_DEVICE_I),
    MENU_ENUM_LABEL_NETPLAY_REQUEST_DEVICE_1,
    MENU_ENUM_LABEL_NETPLAY_REQUEST_DEVICE_LAST = MENU_ENUM_LABEL_NETPLAY_REQUEST_DEVICE_1 + MAX_USERS,
@@ -1379,7 +1398,9 @@ enum msg_hash_enums
 
    MENU_LABEL(FASTFORWARD_RATIO),
    MENU_LABEL(VRR_RUNLOOP_ENABLE),
+   MENU_LABEL(MENU_SKIP_UNCHANGED_FRAMES),
    MENU_LABEL(REWIND_ENABLE),
+   MENU_LABEL(REWIND_THREADED),
    MENU_LABEL(CHEAT_APPLY_AFTER_TOGGLE),
    MENU_LABEL(CHEAT_APPLY_AFTER_LOAD),
 
@@ -1433,6 +1454,10 @@ enum msg_hash_enums
    MENU_LABEL(SLOWMOTION_RATIO),
    MENU_LABEL(RUN_AHEAD_ENABLED),
    MENU_LABEL(RUN_AHEAD_SECONDARY_INSTANCE),
+   MENU_LABEL(RUN_AHEAD_SECONDARY_THREADED),
+   MENU_LABEL(RUN_AHEAD_SKIP_ROLLBACK),
+   MENU_LABEL(RUN_AHEAD_FRAMES_AUTO),
+   MENU_LABEL(RUN_AHEAD_DETECT_LAG),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
    MENU_LABEL(RUN_AHEAD_FRAMES),
    MENU_LABEL(TURBO),
@@ -1551,6 +1576,7 @@ enum msg_hash_enums
    MENU_LABEL(NETWORK_USER_REMOTE_ENABLE),
 
    MENU_LABEL(DUMMY_ON_CORE_SHUTDOWN),
+   MENU_LABEL(CORE_CACHE_ENABLE),
    MENU_LABEL(CHECK_FOR_MISSING_FIRMWARE),
 
    MENU_LABEL(DETECT_CORE_LIST_OK_CURRENT_CORE),
@@ -1583,6 +1609,7 @@ enum msg_hash_enums
    MENU_LABEL(CORE_COUNTERS),
    MENU_LABEL(LOAD_CONTENT_HISTORY),
    MENU_LABEL(NETWORK_INFORMATION),
+   MENU_LABEL(SHADER_PASS_TIMES),
    MENU_LABEL(SYSTEM_INFORMATION),
    MENU_LABEL(ACHIEVEMENT_LIST),
    MENU_LABEL(ACHIEVEMENT_LIST_HARDCORE),
@@ -1726,6 +1753,8 @@ enum msg_hash_enums
    MENU_LABEL(VIDEO_ASPECT_RATIO_INDEX),
    MENU_LABEL(VIDEO_VFILTER),
    MENU_LABEL(VIDEO_GPU_RECORD),
+   MENU_LABEL(VIDEO_STREAM_RECORD),
+   MENU_LABEL(VIDEO_RECORD_HW_ENCODER),
    MENU_LABEL(RECORD_USE_OUTPUT_DIRECTORY),
    MENU_LABEL(RECORD_CONFIG),
    MENU_LABEL(STREAM_CONFIG),
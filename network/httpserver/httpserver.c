@@ -23,6 +23,11 @@
 #include <civetweb/civetweb.h>
 #include <string/stdstring.h>
 #include <compat/zlib.h>
+#include <queues/task_queue.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "../../core.h"
 #include "../../retroarch.h"
@@ -31,13 +36,59 @@
 #include "../../managers/core_option_manager.h"
 #include "../../cheevos/cheevos.h"
 #include "../../content.h"
+#include "../../audio/audio_driver.h"
+#include "../../gfx/video_pacing.h"
+#include "../../frontend/frontend_driver.h"
+#include "../../managers/memory_budget.h"
+#include "../../performance_counters.h"
+
+#ifdef HAVE_NETWORKING
+#include "../netplay/netplay.h"
+#endif
+
+#ifdef HAVE_RUNAHEAD
+#include "../../runahead/run_ahead.h"
+#endif
 
 #define BASIC_INFO "info"
 #define MEMORY_MAP "memoryMap"
+#define METRICS    "metrics"
+
+/* Frames between two samples of the statistics which can
+ * only be read from the main thread. */
+#define METRICS_UPDATE_FRAMES 30
+
+static const double metrics_quantiles[] = { 0.5, 0.9, 0.99 };
+
+#define METRICS_QUANTILES (sizeof(metrics_quantiles) / sizeof(metrics_quantiles[0]))
+
+typedef struct
+{
+   /* Frames of zone history the quantiles were taken from */
+   unsigned zone_frames;
+   uint32_t zone_quantiles[PERF_ZONE_LAST][METRICS_QUANTILES];
+   unsigned tasks;
+   uint64_t audio_underruns;
+   bool audio_stats_valid;
+   audio_statistics_t audio_stats;
+#ifdef HAVE_NETWORKING
+   bool netplay_valid;
+   struct netplay_stats netplay;
+#endif
+#ifdef HAVE_RUNAHEAD
+   runahead_stats_t runahead;
+#endif
+} httpserver_metrics_t;
 
 static struct mg_callbacks s_httpserver_callbacks;
 static struct mg_context   *s_httpserver_ctx       = NULL;
 
+static httpserver_metrics_t s_httpserver_metrics;
+static unsigned s_httpserver_metrics_frames        = 0;
+#ifdef HAVE_THREADS
+static slock_t *s_httpserver_metrics_lock          = NULL;
+#endif
+
 /* Based on https://github.com/zeromq/rfc/blob/master/src/spec_32.c */
 static void httpserver_z85_encode_inplace(Bytef* data, size_t size)
 {
@@ -462,9 +513,8 @@ static int httpserver_handle_get_mmap(struct mg_connection* conn, void* cbdata)
    unsigned id;
    uLong buflen;
    const struct mg_request_info         * req = mg_get_request_info(conn);
-   const char                         * comma = "";
-   const struct retro_memory_map* mmaps       = NULL;
-   const struct retro_memory_descriptor* mmap = NULL;
+   const rarch_memory_map_t* mmaps            = NULL;
+   const uint8_t* data                        = NULL;
    const char* param                          = NULL;
    Bytef* buffer                              = NULL;
    rarch_system_info_t *system                = runloop_get_system_info();
@@ -480,9 +530,8 @@ static int httpserver_handle_get_mmap(struct mg_connection* conn, void* cbdata)
    if (id >= mmaps->num_descriptors)
       return httpserver_error(conn, 404, "Invalid memory map id in %s: %u", __FUNCTION__, id);
 
-   mmap   = mmaps->descriptors + id;
    start  = 0;
-   length = mmap->len;
+   length = (size_t)-1;
 
    if (req->query_string != NULL)
    {
@@ -497,11 +546,10 @@ static int httpserver_handle_get_mmap(struct mg_connection* conn, void* cbdata)
          length = atoll(param + 7);
    }
 
-   if (start >= mmap->len)
-      start = mmap->len - 1;
+   data = rarch_memory_map_get(mmaps, id, start, &length);
 
-   if (length > mmap->len - start)
-      length = mmap->len - start;
+   if (!data)
+      return httpserver_error(conn, 404, "Invalid memory range in %s: %u", __FUNCTION__, id);
 
    buflen = compressBound(length);
    buffer = (Bytef*)malloc(((buflen + 3) / 4) * 5);
@@ -509,7 +557,7 @@ static int httpserver_handle_get_mmap(struct mg_connection* conn, void* cbdata)
    if (buffer == NULL)
       return httpserver_error(conn, 500, "Out of memory in %s", __FUNCTION__);
 
-   if (compress2(buffer, &buflen, (Bytef*)mmap->ptr + start, length, Z_BEST_COMPRESSION) != Z_OK)
+   if (compress2(buffer, &buflen, (const Bytef*)data, length, Z_BEST_COMPRESSION) != Z_OK)
    {
       free((void*)buffer);
       return httpserver_error(conn, 500, "Error during compression in %s", __FUNCTION__);
@@ -551,6 +599,211 @@ static int httpserver_handle_mmaps(struct mg_connection* conn, void* cbdata)
    return httpserver_handle_get_mmaps(conn, cbdata);
 }
 
+/*============================================================
+METRICS
+============================================================ */
+
+static int httpserver_metrics_compare(const void *a, const void *b)
+{
+   uint32_t x = *(const uint32_t*)a;
+   uint32_t y = *(const uint32_t*)b;
+   return x < y ? -1 : x > y;
+}
+
+void httpserver_update(void)
+{
+   unsigned i, j;
+   static uint32_t history[PERF_ZONE_HISTORY];
+   httpserver_metrics_t *metrics = &s_httpserver_metrics;
+
+   if (!s_httpserver_ctx || ++s_httpserver_metrics_frames < METRICS_UPDATE_FRAMES)
+      return;
+   s_httpserver_metrics_frames = 0;
+
+#ifdef HAVE_THREADS
+   slock_lock(s_httpserver_metrics_lock);
+#endif
+
+   metrics->zone_frames = 0;
+   for (i = 0; i < PERF_ZONE_LAST; i++)
+   {
+      unsigned count = performance_zone_history((enum perf_zone)i, false,
+            history, PERF_ZONE_HISTORY);
+
+      metrics->zone_frames = count;
+      if (!count)
+         break;
+
+      qsort(history, count, sizeof(*history), httpserver_metrics_compare);
+      for (j = 0; j < METRICS_QUANTILES; j++)
+         metrics->zone_quantiles[i][j] =
+            history[(unsigned)(metrics_quantiles[j] * (count - 1))];
+   }
+
+   metrics->tasks             = task_queue_count();
+   metrics->audio_underruns   = audio_driver_get_underruns();
+   metrics->audio_stats_valid = compute_audio_buffer_statistics(
+         &metrics->audio_stats);
+#ifdef HAVE_NETWORKING
+   metrics->netplay_valid     = netplay_driver_ctl(
+         RARCH_NETPLAY_CTL_GET_STATS, &metrics->netplay);
+#endif
+#ifdef HAVE_RUNAHEAD
+   runahead_get_stats(&metrics->runahead);
+#endif
+
+#ifdef HAVE_THREADS
+   slock_unlock(s_httpserver_metrics_lock);
+#endif
+}
+
+static void httpserver_metric_header(struct mg_connection* conn,
+      const char *name, const char *type, const char *help)
+{
+   mg_printf(conn, "# HELP retroarch_%s %s\n# TYPE retroarch_%s %s\n",
+         name, help, name, type);
+}
+
+static int httpserver_handle_metrics(struct mg_connection* conn, void* cbdata)
+{
+   unsigned i, j;
+   uint64_t cumulative = 0;
+   video_pacing_histogram_t pacing;
+   video_pacing_stats_t pacing_stats;
+   memory_budget_stats_t budget;
+   httpserver_metrics_t metrics;
+   const struct mg_request_info* req = mg_get_request_info(conn);
+
+   if (strcmp(req->request_method, "GET"))
+      return httpserver_error(conn, 405, "Unimplemented method in %s: %s", __FUNCTION__, req->request_method);
+
+#ifdef HAVE_THREADS
+   slock_lock(s_httpserver_metrics_lock);
+#endif
+   metrics = s_httpserver_metrics;
+#ifdef HAVE_THREADS
+   slock_unlock(s_httpserver_metrics_lock);
+#endif
+
+   video_pacing_get_histogram(&pacing);
+   video_pacing_get_stats(&pacing_stats);
+   memory_budget_get_stats(&budget);
+
+   mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n\r\n");
+
+   httpserver_metric_header(conn, "frame_interval_seconds", "histogram",
+         "Time between two frames reaching the display.");
+   for (i = 0; i < VIDEO_PACING_HISTOGRAM_BUCKETS - 1; i++)
+   {
+      cumulative += pacing.counts[i];
+      mg_printf(conn, "retroarch_frame_interval_seconds_bucket{le=\"%.3f\"} %" PRIu64 "\n",
+            pacing.bounds[i] / 1000000.0, cumulative);
+   }
+   mg_printf(conn, "retroarch_frame_interval_seconds_bucket{le=\"+Inf\"} %" PRIu64 "\n", pacing.frames);
+   mg_printf(conn, "retroarch_frame_interval_seconds_sum %f\n", pacing.sum / 1000000.0);
+   mg_printf(conn, "retroarch_frame_interval_seconds_count %" PRIu64 "\n", pacing.frames);
+
+   httpserver_metric_header(conn, "missed_vsyncs_total", "counter",
+         "Vsyncs which passed without a new frame.");
+   mg_printf(conn, "retroarch_missed_vsyncs_total %u\n", pacing_stats.missed_vsyncs);
+
+   httpserver_metric_header(conn, "frame_delay_seconds", "gauge",
+         "Frame delay picked by the automatic frame delay.");
+   mg_printf(conn, "retroarch_frame_delay_seconds %f\n", pacing_stats.frame_delay / 1000.0);
+
+   httpserver_metric_header(conn, "audio_latency_seconds", "gauge",
+         "Time from audio write to the speakers, as reported by the audio driver.");
+   mg_printf(conn, "retroarch_audio_latency_seconds %f\n", pacing_stats.audio_latency / 1000.0);
+
+   if (metrics.zone_frames)
+   {
+      httpserver_metric_header(conn, "perf_zone_seconds", "gauge",
+            "Time spent in each profiler zone per frame, over the recorded frames.");
+      for (i = 0; i < PERF_ZONE_LAST; i++)
+         for (j = 0; j < METRICS_QUANTILES; j++)
+            mg_printf(conn, "retroarch_perf_zone_seconds{zone=\"%s\",quantile=\"%g\"} %f\n",
+                  performance_zone_ident((enum perf_zone)i), metrics_quantiles[j],
+                  metrics.zone_quantiles[i][j] / 1000000.0);
+   }
+
+   httpserver_metric_header(conn, "audio_underruns_total", "counter",
+         "Times the audio buffer ran empty.");
+   mg_printf(conn, "retroarch_audio_underruns_total %" PRIu64 "\n", metrics.audio_underruns);
+
+   if (metrics.audio_stats_valid)
+   {
+      httpserver_metric_header(conn, "audio_buffer_saturation_ratio", "gauge",
+            "Average fill level of the audio buffer.");
+      mg_printf(conn, "retroarch_audio_buffer_saturation_ratio %f\n",
+            metrics.audio_stats.average_buffer_saturation / 100.0);
+      httpserver_metric_header(conn, "audio_close_to_underrun_ratio", "gauge",
+            "Share of time the audio buffer was almost empty.");
+      mg_printf(conn, "retroarch_audio_close_to_underrun_ratio %f\n",
+            metrics.audio_stats.close_to_underrun / 100.0);
+   }
+
+#ifdef HAVE_RUNAHEAD
+   httpserver_metric_header(conn, "runahead_rollbacks_total", "counter",
+         "States loaded by run-ahead.");
+   mg_printf(conn, "retroarch_runahead_rollbacks_total %" PRIu64 "\n", metrics.runahead.rollbacks);
+   httpserver_metric_header(conn, "runahead_hidden_frames_total", "counter",
+         "Frames run by run-ahead without being shown.");
+   mg_printf(conn, "retroarch_runahead_hidden_frames_total %" PRIu64 "\n", metrics.runahead.hidden_frames);
+#endif
+
+#ifdef HAVE_NETWORKING
+   if (metrics.netplay_valid)
+   {
+      httpserver_metric_header(conn, "netplay_rollbacks_total", "counter",
+            "Rewinds to correct a netplay misprediction.");
+      mg_printf(conn, "retroarch_netplay_rollbacks_total %" PRIu64 "\n", metrics.netplay.rollbacks);
+      httpserver_metric_header(conn, "netplay_replayed_frames_total", "counter",
+            "Frames run again by netplay rollbacks.");
+      mg_printf(conn, "retroarch_netplay_replayed_frames_total %" PRIu64 "\n", metrics.netplay.replayed_frames);
+      httpserver_metric_header(conn, "netplay_input_latency_frames", "gauge",
+            "Frames of input latency.");
+      mg_printf(conn, "retroarch_netplay_input_latency_frames %d\n", metrics.netplay.input_latency_frames);
+      httpserver_metric_header(conn, "netplay_connections", "gauge",
+            "Connected netplay peers.");
+      mg_printf(conn, "retroarch_netplay_connections %u\n", metrics.netplay.connection_count);
+      httpserver_metric_header(conn, "netplay_rtt_seconds", "gauge",
+            "Round trip time to each peer, 0 until measured.");
+      for (i = 0; i < metrics.netplay.connection_count; i++)
+         mg_printf(conn, "retroarch_netplay_rtt_seconds{client=\"%u\"} %f\n",
+               (unsigned)metrics.netplay.connections[i].client_num,
+               metrics.netplay.connections[i].rtt / 1000000.0);
+   }
+#endif
+
+   httpserver_metric_header(conn, "tasks", "gauge",
+         "Tasks waiting or running.");
+   mg_printf(conn, "retroarch_tasks %u\n", metrics.tasks);
+
+   httpserver_metric_header(conn, "memory_used_bytes", "gauge",
+         "Memory in use according to the frontend.");
+   mg_printf(conn, "retroarch_memory_used_bytes %" PRIu64 "\n", frontend_driver_get_used_memory());
+   httpserver_metric_header(conn, "memory_total_bytes", "gauge",
+         "Memory available to the system according to the frontend.");
+   mg_printf(conn, "retroarch_memory_total_bytes %" PRIu64 "\n", frontend_driver_get_total_memory());
+
+   httpserver_metric_header(conn, "cache_budget_bytes", "gauge",
+         "Memory the caches may hold together before being asked to evict.");
+   mg_printf(conn, "retroarch_cache_budget_bytes %" PRIu64 "\n", (uint64_t)budget.budget);
+   httpserver_metric_header(conn, "cache_bytes", "gauge",
+         "Memory held by each cache.");
+   for (i = 0; i < budget.caches; i++)
+      mg_printf(conn, "retroarch_cache_bytes{cache=\"%s\"} %" PRIu64 "\n",
+            budget.cache[i].name, (uint64_t)budget.cache[i].size);
+   httpserver_metric_header(conn, "cache_evicted_bytes_total", "counter",
+         "Memory given back by the caches to stay within the budget.");
+   mg_printf(conn, "retroarch_cache_evicted_bytes_total %" PRIu64 "\n", budget.evicted);
+   httpserver_metric_header(conn, "cache_evictions_total", "counter",
+         "Times a cache was asked to evict.");
+   mg_printf(conn, "retroarch_cache_evictions_total %u\n", budget.evictions);
+
+   return 1;
+}
+
 /*============================================================
 HTTP SERVER
 ============================================================ */
@@ -573,15 +826,30 @@ int httpserver_init(unsigned port)
    if (s_httpserver_ctx == NULL)
       return -1;
 
+#ifdef HAVE_THREADS
+   if (!s_httpserver_metrics_lock)
+      s_httpserver_metrics_lock = slock_new();
+#endif
+   memset(&s_httpserver_metrics, 0, sizeof(s_httpserver_metrics));
+   s_httpserver_metrics_frames = 0;
+
    mg_set_request_handler(s_httpserver_ctx, "/" BASIC_INFO, httpserver_handle_basic_info, NULL);
 
    mg_set_request_handler(s_httpserver_ctx, "/" MEMORY_MAP, httpserver_handle_mmaps, NULL);
    mg_set_request_handler(s_httpserver_ctx, "/" MEMORY_MAP "/", httpserver_handle_mmaps, NULL);
 
+   mg_set_request_handler(s_httpserver_ctx, "/" METRICS, httpserver_handle_metrics, NULL);
+
    return 0;
 }
 
 void httpserver_destroy(void)
 {
    mg_stop(s_httpserver_ctx);
+   s_httpserver_ctx = NULL;
+
+#ifdef HAVE_THREADS
+   slock_free(s_httpserver_metrics_lock);
+   s_httpserver_metrics_lock = NULL;
+#endif
 }
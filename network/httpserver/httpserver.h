@@ -24,6 +24,10 @@ int  httpserver_init(unsigned port);
 
 void httpserver_destroy(void);
 
+/* Samples the statistics served at /metrics which can only
+ * be read from the main thread. Called once per frame. */
+void httpserver_update(void);
+
 RETRO_END_DECLS
 
 #endif /* __RARCH_HTTPSERVR_H */
@@ -97,3 +97,14 @@ void logger_send_v(const char *__format, va_list args)
          (struct sockaddr*)&target,
          sizeof(target));
 }
+
+/* Matches verbosity_sink_t, for builds that log through the
+ * verbosity sinks instead of the logger_send macros. */
+void logger_send_entry(const verbosity_entry_t *entry, void *userdata)
+{
+   logger_send("[%u.%06u] [%lx] %s %s",
+         (unsigned)(entry->time_usec / 1000000),
+         (unsigned)(entry->time_usec % 1000000),
+         (unsigned long)entry->thread_id,
+         entry->tag, entry->msg);
+}
@@ -61,7 +61,49 @@ enum rarch_netplay_ctl_state
    RARCH_NETPLAY_CTL_DISCONNECT,
    RARCH_NETPLAY_CTL_FINISHED_NAT_TRAVERSAL,
    RARCH_NETPLAY_CTL_DESYNC_PUSH,
-   RARCH_NETPLAY_CTL_DESYNC_POP
+   RARCH_NETPLAY_CTL_DESYNC_POP,
+   RARCH_NETPLAY_CTL_GET_STATS
+};
+
+/* Rollbacks of 1 .. NETPLAY_STATS_ROLLBACK_DEPTHS frames, the last
+ * bucket also counting anything deeper */
+#define NETPLAY_STATS_ROLLBACK_DEPTHS   16
+#define NETPLAY_STATS_MAX_CONNECTIONS   32
+
+struct netplay_connection_stats
+{
+   char nick[32];
+   bool playing;
+   uint32_t client_num;
+
+   /* Round trip time and its mean deviation, in microseconds. 0 until
+    * measured, or if the peer can't answer pings. */
+   unsigned rtt;
+   unsigned jitter;
+
+   /* How many frames before we ran it their input for a frame arrived;
+    * negative means we had to predict it. The last one, and an average. */
+   int input_slack;
+   float input_slack_avg;
+};
+
+/* Filled by RARCH_NETPLAY_CTL_GET_STATS */
+struct netplay_stats
+{
+   bool is_server;
+   uint32_t frame;
+   int input_latency_frames;
+
+   /* Average time to run one frame, in microseconds */
+   unsigned frame_run_time;
+
+   /* Rewinds to correct a misprediction, and frames resimulated by them */
+   uint64_t rollbacks;
+   uint64_t replayed_frames;
+   uint32_t rollback_depths[NETPLAY_STATS_ROLLBACK_DEPTHS];
+
+   unsigned connection_count;
+   struct netplay_connection_stats connections[NETPLAY_STATS_MAX_CONNECTIONS];
 };
 
 /* Preferences for sharing digital devices */
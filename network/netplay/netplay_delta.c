@@ -18,8 +18,13 @@
 #include <stdlib.h>
 #include <sys/types.h>
 
+#include <string.h>
+
 #include <boolean.h>
+#include <retro_inline.h>
+#include <retro_endianness.h>
 #include <encodings/crc32.h>
+#include <memalign.h>
 
 #include "netplay_private.h"
 
@@ -81,6 +86,242 @@ uint32_t netplay_delta_frame_crc(netplay_t *netplay, struct delta_frame *delta)
    return encoding_crc32(0L, (const unsigned char*)delta->state, netplay->state_size);
 }
 
+/* XXH64 primes. The fast frame hash is XXH64 (seed 0) over the state,
+ * folded to 32 bits so that it fits the existing NETPLAY_CMD_CRC payload. */
+#define NETPLAY_HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define NETPLAY_HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define NETPLAY_HASH_PRIME3 0x165667B19E3779F9ULL
+#define NETPLAY_HASH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define NETPLAY_HASH_PRIME5 0x27D4EB2F165667C5ULL
+#define NETPLAY_HASH_ROTL(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static INLINE uint64_t netplay_hash_read64(const uint8_t *p)
+{
+   uint64_t v;
+   memcpy(&v, p, sizeof(v));
+   return swap_if_big64(v);
+}
+
+static INLINE uint64_t netplay_hash_round(uint64_t acc, uint64_t input)
+{
+   acc += input * NETPLAY_HASH_PRIME2;
+   acc  = NETPLAY_HASH_ROTL(acc, 31);
+   return acc * NETPLAY_HASH_PRIME1;
+}
+
+static INLINE uint64_t netplay_hash_merge(uint64_t acc, uint64_t val)
+{
+   acc ^= netplay_hash_round(0, val);
+   return acc * NETPLAY_HASH_PRIME1 + NETPLAY_HASH_PRIME4;
+}
+
+static uint32_t netplay_hash_state(const uint8_t *p, size_t len)
+{
+   const uint8_t *end = p + len;
+   uint64_t h;
+
+   if (len >= 32)
+   {
+      const uint8_t *limit = end - 32;
+      uint64_t v1 = NETPLAY_HASH_PRIME1 + NETPLAY_HASH_PRIME2;
+      uint64_t v2 = NETPLAY_HASH_PRIME2;
+      uint64_t v3 = 0;
+      uint64_t v4 = 0 - NETPLAY_HASH_PRIME1;
+
+      do
+      {
+         v1 = netplay_hash_round(v1, netplay_hash_read64(p));
+         v2 = netplay_hash_round(v2, netplay_hash_read64(p + 8));
+         v3 = netplay_hash_round(v3, netplay_hash_read64(p + 16));
+         v4 = netplay_hash_round(v4, netplay_hash_read64(p + 24));
+         p += 32;
+      } while (p <= limit);
+
+      h = NETPLAY_HASH_ROTL(v1, 1)  + NETPLAY_HASH_ROTL(v2, 7)
+        + NETPLAY_HASH_ROTL(v3, 12) + NETPLAY_HASH_ROTL(v4, 18);
+      h = netplay_hash_merge(h, v1);
+      h = netplay_hash_merge(h, v2);
+      h = netplay_hash_merge(h, v3);
+      h = netplay_hash_merge(h, v4);
+   }
+   else
+      h = NETPLAY_HASH_PRIME5;
+
+   h += (uint64_t)len;
+
+   for (; p + 8 <= end; p += 8)
+   {
+      h ^= netplay_hash_round(0, netplay_hash_read64(p));
+      h  = NETPLAY_HASH_ROTL(h, 27) * NETPLAY_HASH_PRIME1 + NETPLAY_HASH_PRIME4;
+   }
+
+   if (p + 4 <= end)
+   {
+      uint32_t v;
+      memcpy(&v, p, sizeof(v));
+      h ^= (uint64_t)swap_if_big32(v) * NETPLAY_HASH_PRIME1;
+      h  = NETPLAY_HASH_ROTL(h, 23) * NETPLAY_HASH_PRIME2 + NETPLAY_HASH_PRIME3;
+      p += 4;
+   }
+
+   for (; p < end; p++)
+   {
+      h ^= (*p) * NETPLAY_HASH_PRIME5;
+      h  = NETPLAY_HASH_ROTL(h, 11) * NETPLAY_HASH_PRIME1;
+   }
+
+   h ^= h >> 33;
+   h *= NETPLAY_HASH_PRIME2;
+   h ^= h >> 29;
+   h *= NETPLAY_HASH_PRIME3;
+   h ^= h >> 32;
+
+   return (uint32_t)(h ^ (h >> 32));
+}
+
+/**
+ * netplay_delta_frame_hash
+ *
+ * Get the hash used to check this frame against a peer: the fast hash if
+ * @fast (the peer negotiated NETPLAY_FEATURE_FAST_HASH), else the CRC-32.
+ */
+uint32_t netplay_delta_frame_hash(netplay_t *netplay,
+      struct delta_frame *delta, bool fast)
+{
+   if (!fast)
+      return netplay_delta_frame_crc(netplay, delta);
+   if (!netplay->state_size)
+      return 0;
+   return netplay_hash_state((const uint8_t*)delta->state,
+         netplay->state_size);
+}
+
+/**
+ * netplay_delta_frame_find
+ *
+ * Find the buffered frame holding the state of the given frame, if any.
+ */
+struct delta_frame *netplay_delta_frame_find(netplay_t *netplay,
+   uint32_t frame)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->buffer_size; i++)
+   {
+      struct delta_frame *delta = &netplay->buffer[i];
+      if (delta->used && delta->frame == frame && delta->state)
+         return delta;
+   }
+
+   return NULL;
+}
+
+/**
+ * netplay_delta_frame_savestate_base
+ *
+ * Choose the buffered frame to send a savestate as a delta against, or NULL
+ * if there is none the peer is likely to hold in the same state.
+ *
+ * Only frames whose input is final on our side qualify. With CRC checks on,
+ * we also want a check frame followed by another finished check, since a
+ * desync would have been reported there. The receiver verifies the base CRC
+ * either way.
+ */
+struct delta_frame *netplay_delta_frame_savestate_base(netplay_t *netplay)
+{
+   size_t i;
+   struct delta_frame *base = NULL;
+   uint32_t check_frames    = (uint32_t)abs(netplay->check_frames);
+
+   if (!netplay->state_size || !netplay->xbuffer)
+      return NULL;
+
+   for (i = 0; i < netplay->buffer_size; i++)
+   {
+      struct delta_frame *delta = &netplay->buffer[i];
+
+      if (!delta->used || !delta->state ||
+          delta->frame >= netplay->run_frame_count ||
+          delta->frame > netplay->other_frame_count)
+         continue;
+
+      if (check_frames &&
+          (delta->frame % check_frames ||
+           delta->frame + check_frames > netplay->other_frame_count))
+         continue;
+
+      if (!base || delta->frame > base->frame)
+         base = delta;
+   }
+
+   return base;
+}
+
+/**
+ * netplay_delta_frame_catch_up_base
+ *
+ * Choose the buffered frame a newly connected peer can start from, without
+ * anybody else loading a state, or NULL if there is none.
+ *
+ * The state must be final, and the input of every player from there up to
+ * @end_frame, the first frame we haven't sent our own input for yet, must be
+ * in the buffer, so the peer can be sent all it missed.
+ */
+struct delta_frame *netplay_delta_frame_catch_up_base(netplay_t *netplay,
+   uint32_t end_frame)
+{
+   size_t i, ptr;
+   uint32_t frame, client;
+   struct delta_frame *base = NULL;
+
+   if (!netplay->state_size || netplay->connected_slaves ||
+       (netplay->quirks & (NETPLAY_QUIRK_NO_SAVESTATES |
+                           NETPLAY_QUIRK_NO_TRANSMISSION |
+                           NETPLAY_QUIRK_INITIALIZATION)))
+      return NULL;
+
+   for (i = 0; i < netplay->buffer_size; i++)
+   {
+      struct delta_frame *delta = &netplay->buffer[i];
+
+      if (!delta->used || !delta->state ||
+          delta->frame >= netplay->run_frame_count ||
+          delta->frame > netplay->other_frame_count)
+         continue;
+
+      if (!base || delta->frame > base->frame)
+         base = delta;
+   }
+
+   if (!base || base->frame == 0 || base->frame > end_frame)
+      return NULL;
+
+   /* A player who joined since has no input before joining, which only a
+    * replay of the mode change could tell the peer */
+   ptr = base - netplay->buffer;
+   for (frame = base->frame; frame < end_frame; frame++)
+   {
+      struct delta_frame *delta = &netplay->buffer[ptr];
+
+      if (!delta->used || delta->frame != frame)
+         return NULL;
+
+      for (client = 0; client < MAX_CLIENTS; client++)
+      {
+         if (!(netplay->connected_players & (1<<client)))
+            continue;
+         if (netplay->read_frame_count[client] < base->frame ||
+             (frame < netplay->read_frame_count[client] &&
+              !delta->have_real[client]))
+            return NULL;
+      }
+
+      ptr = NEXT_PTR(ptr);
+   }
+
+   return base;
+}
+
 /*
  * Free an input state list
  */
@@ -108,7 +349,7 @@ void netplay_delta_frame_free(struct delta_frame *delta)
 
    if (delta->state)
    {
-      free(delta->state);
+      memalign_free_large(delta->state);
       delta->state = NULL;
    }
 
@@ -321,61 +321,14 @@ static bool netplay_poll(void)
 
    /* Figure out how many frames of input latency we should be using to hide
     * network latency */
-   if (netplay_data->frame_run_time_avg || netplay_data->stateless_mode)
    {
-      /* FIXME: Using fixed 60fps for this calculation */
-      unsigned frames_per_frame = netplay_data->frame_run_time_avg ?
-                                  (16666/netplay_data->frame_run_time_avg) :
-                                   0;
-      unsigned frames_ahead = (netplay_data->run_frame_count > netplay_data->unread_frame_count) ?
-                              (netplay_data->run_frame_count - netplay_data->unread_frame_count) :
-                              0;
       settings_t *settings  = config_get_ptr();
       int input_latency_frames_min = settings->uints.netplay_input_latency_frames_min -
             (settings->bools.run_ahead_enabled ? settings->uints.run_ahead_frames : 0);
       int input_latency_frames_max = input_latency_frames_min + settings->uints.netplay_input_latency_frames_range;
 
-      /* Assume we need a couple frames worth of time to actually run the
-       * current frame */
-      if (frames_per_frame > 2)
-         frames_per_frame -= 2;
-      else
-         frames_per_frame = 0;
-
-      /* Shall we adjust our latency? */
-      if (netplay_data->stateless_mode)
-      {
-         /* In stateless mode, we adjust up if we're "close" and down if we
-          * have a lot of slack */
-         if (netplay_data->input_latency_frames < input_latency_frames_min ||
-             (netplay_data->unread_frame_count == netplay_data->run_frame_count + 1 &&
-              netplay_data->input_latency_frames < input_latency_frames_max))
-         {
-            netplay_data->input_latency_frames++;
-         }
-         else if (netplay_data->input_latency_frames > input_latency_frames_max ||
-                  (netplay_data->unread_frame_count > netplay_data->run_frame_count + 2 &&
-                   netplay_data->input_latency_frames > input_latency_frames_min))
-         {
-            netplay_data->input_latency_frames--;
-         }
-
-      }
-      else if (netplay_data->input_latency_frames < input_latency_frames_min ||
-               (frames_per_frame < frames_ahead &&
-                netplay_data->input_latency_frames < input_latency_frames_max))
-      {
-         /* We can't hide this much network latency with replay, so hide some
-          * with input latency */
-         netplay_data->input_latency_frames++;
-      }
-      else if (netplay_data->input_latency_frames > input_latency_frames_max ||
-               (frames_per_frame > frames_ahead + 2 &&
-                netplay_data->input_latency_frames > input_latency_frames_min))
-      {
-         /* We don't need this much latency (any more) */
-         netplay_data->input_latency_frames--;
-      }
+      netplay_sync_input_latency(netplay_data,
+            input_latency_frames_min, input_latency_frames_max);
    }
 
    /* If we're stalled, consider unstalling */
@@ -1088,6 +1041,10 @@ void netplay_post_frame(netplay_t *netplay)
    netplay_update_unread_ptr(netplay);
    netplay_sync_post_frame(netplay, false);
 
+   /* Datagrams first, they're the reason to send input over UDP at all */
+   netplay_udp_flush(netplay);
+   netplay_cmd_ping(netplay);
+
    for (i = 0; i < netplay->connections_size; i++)
    {
       struct netplay_connection *connection = &netplay->connections[i];
@@ -1145,6 +1102,39 @@ static void netplay_force_future(netplay_t *netplay)
    }
 }
 
+/**
+ * netplay_compress_savestate
+ * @netplay              : pointer to netplay object
+ * @data                 : the data to compress
+ * @size                 : size of @data
+ * @z                    : compression backend to use
+ * @wn                   : set to the compressed size in netplay->zbuffer
+ *
+ * Returns true on success, hanging up every peer otherwise.
+ */
+static bool netplay_compress_savestate(netplay_t *netplay,
+   const void *data, size_t size, struct compression_transcoder *z,
+   uint32_t *wn)
+{
+   uint32_t rd;
+   size_t i;
+
+   z->compression_backend->set_in(z->compression_stream,
+      (const uint8_t*)data, (uint32_t)size);
+   z->compression_backend->set_out(z->compression_stream,
+      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
+         wn, NULL))
+   {
+      /* Catastrophe! */
+      for (i = 0; i < netplay->connections_size; i++)
+         netplay_hangup(netplay, &netplay->connections[i]);
+      return false;
+   }
+
+   return true;
+}
+
 /**
  * netplay_send_savestate
  * @netplay              : pointer to netplay object
@@ -1153,49 +1143,137 @@ static void netplay_force_future(netplay_t *netplay)
  * @z                    : compression backend to use
  *
  * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * scheme. Peers that accept it get an XOR delta against a recent frame we
+ * expect them to still hold, the others the full state.
  */
 void netplay_send_savestate(netplay_t *netplay,
    retro_ctx_serialize_info_t *serial_info, uint32_t cx,
    struct compression_transcoder *z)
 {
-   uint32_t header[4];
-   uint32_t rd, wn;
+   uint32_t header[6];
+   uint32_t wn           = 0;
+   bool compressed       = false;
+   struct delta_frame *base = NULL;
+   unsigned pass;
    size_t i;
 
-   /* Compress it */
-   z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
-   z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
-   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
-         &wn, NULL))
+   if (cx == NETPLAY_COMPRESSION_ZLIB &&
+       serial_info->size == netplay->state_size)
+      base = netplay_delta_frame_savestate_base(netplay);
+
+   /* First the delta to those who take it, then the full state */
+   for (pass = 0; pass < 2; pass++)
    {
-      /* Catastrophe! */
+      bool delta = (pass == 0);
+
+      if (delta && !base)
+         continue;
+
+      compressed = false;
+
       for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
+      {
+         struct netplay_connection *connection = &netplay->connections[i];
+         size_t header_size;
+
+         if (!connection->active ||
+             connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+             connection->compression_supported != cx) continue;
+
+         if (delta != (base && connection->delta_savestates &&
+               !connection->need_full_savestate))
+            continue;
+
+         if (!compressed)
+         {
+            if (delta)
+            {
+               size_t j;
+               const uint8_t *state = (const uint8_t*)serial_info->data_const;
+               const uint8_t *old   = (const uint8_t*)base->state;
+
+               for (j = 0; j < netplay->state_size; j++)
+                  netplay->xbuffer[j] = state[j] ^ old[j];
+
+               if (!netplay_compress_savestate(netplay, netplay->xbuffer,
+                     netplay->state_size, z, &wn))
+                  return;
+            }
+            else if (!netplay_compress_savestate(netplay,
+                     serial_info->data_const, serial_info->size, z, &wn))
+               return;
+
+            compressed = true;
+         }
+
+         header[2] = htonl(netplay->run_frame_count);
+         header[3] = htonl(serial_info->size);
+
+         if (delta)
+         {
+            header[0]   = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+            header[1]   = htonl(wn + 4*sizeof(uint32_t));
+            header[4]   = htonl(base->frame);
+            header[5]   = htonl(netplay_delta_frame_crc(netplay, base));
+            header_size = sizeof(header);
+         }
+         else
+         {
+            header[0]   = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+            header[1]   = htonl(wn + 2*sizeof(uint32_t));
+            header_size = 4*sizeof(uint32_t);
+            connection->need_full_savestate = false;
+         }
+
+         if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+               header, header_size) ||
+             !netplay_send(&connection->send_packet_buffer, connection->fd,
+               netplay->zbuffer, wn))
+            netplay_hangup(netplay, connection);
+         else
+            connection->udp_ctrl_sent++;
+      }
    }
+}
+
+/**
+ * netplay_send_cached_savestate
+ * @netplay              : pointer to netplay object
+ * @connection           : the peer to send it to
+ * @delta                : the buffered frame holding the state
+ *
+ * Send one peer a state we already have in the frame buffer, for a peer
+ * joining without the rest of us loading anything.
+ *
+ * Returns true on success.
+ */
+bool netplay_send_cached_savestate(netplay_t *netplay,
+   struct netplay_connection *connection, struct delta_frame *delta)
+{
+   uint32_t header[4];
+   uint32_t wn                      = 0;
+   struct compression_transcoder *z = &netplay->compress_nil;
+
+   if (connection->compression_supported == NETPLAY_COMPRESSION_ZLIB)
+      z = &netplay->compress_zlib;
+
+   if (!netplay_compress_savestate(netplay, delta->state,
+         netplay->state_size, z, &wn))
+      return false;
 
-   /* Send it to relevant peers */
    header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
    header[1] = htonl(wn + 2*sizeof(uint32_t));
-   header[2] = htonl(netplay->run_frame_count);
-   header[3] = htonl(serial_info->size);
+   header[2] = htonl(delta->frame);
+   header[3] = htonl((uint32_t)netplay->state_size);
 
-   for (i = 0; i < netplay->connections_size; i++)
-   {
-      struct netplay_connection *connection = &netplay->connections[i];
-      if (!connection->active ||
-          connection->mode < NETPLAY_CONNECTION_CONNECTED ||
-          connection->compression_supported != cx) continue;
+   if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+         header, sizeof(header)) ||
+       !netplay_send(&connection->send_packet_buffer, connection->fd,
+         netplay->zbuffer, wn))
+      return false;
 
-      if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
-            sizeof(header)) ||
-          !netplay_send(&connection->send_packet_buffer, connection->fd,
-            netplay->zbuffer, wn))
-         netplay_hangup(netplay, connection);
-   }
+   connection->udp_ctrl_sent++;
+   return true;
 }
 
 /**
@@ -1264,6 +1342,50 @@ void netplay_load_savestate(netplay_t *netplay,
          &netplay->compress_zlib);
 }
 
+/**
+ * netplay_get_stats
+ * @netplay              : pointer to netplay object
+ * @stats                : filled with the current telemetry
+ *
+ * Collect latency and rollback statistics, for tuning the input latency
+ * frames.
+ **/
+void netplay_get_stats(netplay_t *netplay, struct netplay_stats *stats)
+{
+   size_t i;
+
+   memset(stats, 0, sizeof(*stats));
+   stats->is_server            = netplay->is_server;
+   stats->frame                = netplay->self_frame_count;
+   stats->input_latency_frames = netplay->input_latency_frames;
+   stats->frame_run_time       = (unsigned)netplay->frame_run_time_avg;
+   stats->rollbacks            = netplay->stats_rollbacks;
+   stats->replayed_frames      = netplay->stats_replayed_frames;
+   memcpy(stats->rollback_depths, netplay->stats_rollback_depths,
+         sizeof(stats->rollback_depths));
+
+   for (i = 0; i < netplay->connections_size &&
+         stats->connection_count < NETPLAY_STATS_MAX_CONNECTIONS; i++)
+   {
+      struct netplay_connection_stats *cs;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      cs = &stats->connections[stats->connection_count++];
+      strlcpy(cs->nick, connection->nick, sizeof(cs->nick));
+      cs->playing         = connection->mode == NETPLAY_CONNECTION_PLAYING ||
+                            connection->mode == NETPLAY_CONNECTION_SLAVE;
+      cs->client_num      = netplay->is_server ? (uint32_t)(i + 1) : 0;
+      cs->rtt             = (unsigned)connection->rtt;
+      cs->jitter          = (unsigned)connection->rtt_jitter;
+      cs->input_slack     = connection->input_slack;
+      cs->input_slack_avg = connection->input_slack_avg;
+   }
+}
+
 /**
  * netplay_core_reset
  * @netplay              : pointer to netplay object
@@ -1292,6 +1414,8 @@ static void netplay_core_reset(netplay_t *netplay)
       if (!netplay_send(&connection->send_packet_buffer, connection->fd, cmd,
                sizeof(cmd)))
          netplay_hangup(netplay, connection);
+      else
+         connection->udp_ctrl_sent++;
    }
 }
 
@@ -1467,6 +1591,7 @@ bool init_netplay(void *direct_host, const char *server, unsigned port)
          settings->ints.netplay_check_frames,
          &cbs,
          settings->bools.netplay_nat_traversal,
+         settings->bools.netplay_udp_input,
          settings->paths.username,
          quirks);
 
@@ -1540,6 +1665,7 @@ bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data)
             goto done;
 
          case RARCH_NETPLAY_CTL_IS_CONNECTED:
+         case RARCH_NETPLAY_CTL_GET_STATS:
             ret = false;
             goto done;
 
@@ -1609,6 +1735,9 @@ bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data)
                netplay_load_savestate(netplay_data, NULL, true);
          }
          break;
+      case RARCH_NETPLAY_CTL_GET_STATS:
+         netplay_get_stats(netplay_data, (struct netplay_stats*)data);
+         goto done;
       default:
       case RARCH_NETPLAY_CTL_NONE:
          ret = false;
@@ -24,6 +24,7 @@
 #include <string/stdstring.h>
 #include <rhash.h>
 #include <retro_timers.h>
+#include <features/features_cpu.h>
 
 #include "netplay_private.h"
 
@@ -197,6 +198,13 @@ static uint32_t simple_rand_uint32(void)
             parts[2]);
 }
 
+/* With PCLMULQDQ or the ARMv8 CRC32 instructions, encoding_crc32 outruns
+ * the fast hash; without them it is several times slower. */
+static bool netplay_fast_hash_preferred(void)
+{
+   return !(cpu_features_get() & (RETRO_SIMD_PCLMUL | RETRO_SIMD_CRC32));
+}
+
 /**
  * netplay_handshake_init_send
  *
@@ -206,11 +214,18 @@ bool netplay_handshake_init_send(netplay_t *netplay,
    struct netplay_connection *connection)
 {
    uint32_t header[6];
+   uint32_t features    = NETPLAY_COMPRESSION_SUPPORTED | NETPLAY_FEATURE_PING
+      | NETPLAY_FEATURE_FAST_HASH;
    settings_t *settings = config_get_ptr();
 
+   if (netplay->is_server ? netplay->udp_fd >= 0 : netplay->udp_input)
+      features |= NETPLAY_FEATURE_UDP_INPUT;
+   if (netplay_fast_hash_preferred())
+      features |= NETPLAY_FEATURE_FAST_HASH_PREFERRED;
+
    header[0] = htonl(netplay_magic);
    header[1] = htonl(netplay_platform_magic());
-   header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED);
+   header[2] = htonl(features);
    header[3] = 0;
    header[4] = htonl(NETPLAY_PROTOCOL_VERSION);
    header[5] = htonl(netplay_impl_magic());
@@ -374,6 +389,17 @@ bool netplay_handshake_init(netplay_t *netplay,
 
    /* Check what compression is supported */
    compression  = ntohl(header[2]);
+
+   connection->udp_input      = (compression & NETPLAY_FEATURE_UDP_INPUT) &&
+      (netplay->is_server ? netplay->udp_fd >= 0 : netplay->udp_input);
+   connection->udp_addr_known = false;
+   connection->ping_supported = !!(compression & NETPLAY_FEATURE_PING);
+   connection->fast_hash      = (compression & NETPLAY_FEATURE_FAST_HASH) &&
+      ((compression & NETPLAY_FEATURE_FAST_HASH_PREFERRED) ||
+       netplay_fast_hash_preferred());
+   connection->ping_id        = 0;
+   connection->rtt            = 0;
+
    compression &= NETPLAY_COMPRESSION_SUPPORTED;
 
    if (compression & NETPLAY_COMPRESSION_ZLIB)
@@ -399,6 +425,11 @@ bool netplay_handshake_init(netplay_t *netplay,
       connection->compression_supported = 0;
    }
 
+   connection->delta_savestates    =
+      (compression & NETPLAY_COMPRESSION_DELTA) &&
+      connection->compression_supported == NETPLAY_COMPRESSION_ZLIB;
+   connection->need_full_savestate = false;
+
    if (!ctrans->decompression_backend)
       ctrans->decompression_backend = ctrans->compression_backend->reverse;
 
@@ -460,7 +491,7 @@ error:
 }
 
 static void netplay_handshake_ready(netplay_t *netplay,
-      struct netplay_connection *connection)
+      struct netplay_connection *connection, bool send_savestate)
 {
    char msg[512];
    msg[0] = '\0';
@@ -474,8 +505,8 @@ static void netplay_handshake_ready(netplay_t *netplay,
 
       RARCH_LOG("%s %u\n", msg_hash_to_str(MSG_CONNECTION_SLOT), slot);
 
-      /* Send them the savestate */
-      if (!(netplay->quirks &
+      /* Send them the savestate, unless they caught up from ours */
+      if (send_savestate && !(netplay->quirks &
                (NETPLAY_QUIRK_NO_SAVESTATES|NETPLAY_QUIRK_NO_TRANSMISSION)))
          netplay->force_send_savestate = true;
    }
@@ -561,6 +592,13 @@ bool netplay_handshake_sync(netplay_t *netplay,
    uint32_t device            = 0;
    size_t nicklen, nickmangle = 0;
    bool nick_matched          = false;
+   /* Our input for the current frame may be out already */
+   uint32_t end_frame         = netplay->self_frame_count +
+      (netplay->buffer[netplay->self_ptr].have_local ? 1 : 0);
+   /* Start them from a state we already have, rather than having
+    * everybody load a new one */
+   struct delta_frame *base   =
+      netplay_delta_frame_catch_up_base(netplay, end_frame);
 
    autosave_lock();
    mem_info.id = RETRO_MEMORY_SAVE_RAM;
@@ -584,7 +622,7 @@ bool netplay_handshake_sync(netplay_t *netplay,
 
          /* And finally, sram */
          + mem_info.size);
-   cmd[2]     = htonl(netplay->self_frame_count);
+   cmd[2]     = htonl(base ? base->frame : netplay->self_frame_count);
    client_num = (uint32_t)(connection - netplay->connections + 1);
     
    if (netplay->local_paused || netplay->remote_paused)
@@ -669,9 +707,33 @@ bool netplay_handshake_sync(netplay_t *netplay,
    }
    autosave_unlock();
 
+   /* Tell them how to identify their input datagrams */
+   if (connection->udp_input)
+   {
+      uint32_t token;
+
+      if (simple_rand_next == 1)
+         simple_srand((unsigned int) time(NULL));
+      do
+      {
+         connection->udp_token = simple_rand_uint32();
+      } while (connection->udp_token == 0);
+
+      token = htonl(connection->udp_token);
+      if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_UDP_INPUT,
+            &token, sizeof(token)))
+         return false;
+   }
+
+   /* Then what they missed since */
+   if (base &&
+         (!netplay_send_cached_savestate(netplay, connection, base) ||
+          !netplay_send_input_log(netplay, connection, base, end_frame)))
+      return false;
+
    /* Now we're ready! */
    connection->mode = NETPLAY_CONNECTION_SPECTATING;
-   netplay_handshake_ready(netplay, connection);
+   netplay_handshake_ready(netplay, connection, !base);
 
    return true;
 }
@@ -1118,7 +1180,7 @@ bool netplay_handshake_pre_sync(netplay_t *netplay,
    *had_input = true;
    netplay->self_mode = NETPLAY_CONNECTION_SPECTATING;
    connection->mode = NETPLAY_CONNECTION_PLAYING;
-   netplay_handshake_ready(netplay, connection);
+   netplay_handshake_ready(netplay, connection, false);
    netplay_recv_flush(&connection->recv_packet_buffer);
 
    /* Ask to switch to playing mode if we should */
@@ -25,6 +25,7 @@
 
 #include <boolean.h>
 #include <compat/strl.h>
+#include <memalign.h>
 
 #include "netplay_private.h"
 
@@ -219,6 +220,30 @@ static bool init_tcp_socket(netplay_t *netplay, void *direct_host,
    return ret;
 }
 
+static void init_udp_socket(netplay_t *netplay, uint16_t port)
+{
+   struct addrinfo *addr = NULL;
+   int fd = socket_init((void **) &addr, port, NULL, SOCKET_TYPE_DATAGRAM);
+
+   if (fd < 0)
+      goto error;
+
+   if (!socket_bind(fd, (void*)addr) || !socket_nonblock(fd))
+   {
+      socket_close(fd);
+      goto error;
+   }
+
+   netplay->udp_fd = fd;
+   freeaddrinfo_retro(addr);
+   return;
+
+error:
+   if (addr)
+      freeaddrinfo_retro(addr);
+   RARCH_WARN("Failed to open the UDP input socket, input will only be sent over TCP.\n");
+}
+
 static bool init_socket(netplay_t *netplay, void *direct_host,
       const char *server, uint16_t port)
 {
@@ -231,6 +256,10 @@ static bool init_socket(netplay_t *netplay, void *direct_host,
    if (netplay->is_server && netplay->nat_traversal)
       netplay_init_nat_traversal(netplay);
 
+   /* Clients open their UDP socket once the server has agreed to it */
+   if (netplay->is_server && netplay->udp_input)
+      init_udp_socket(netplay, port);
+
    return true;
 }
 
@@ -287,7 +316,7 @@ bool netplay_init_serialization(netplay_t *netplay)
 
    for (i = 0; i < netplay->buffer_size; i++)
    {
-      netplay->buffer[i].state = calloc(netplay->state_size, 1);
+      netplay->buffer[i].state = memalign_alloc_large(netplay->state_size);
 
       if (!netplay->buffer[i].state)
       {
@@ -305,6 +334,9 @@ bool netplay_init_serialization(netplay_t *netplay)
       return false;
    }
 
+   /* Without this, savestates are just always sent whole */
+   netplay->xbuffer = (uint8_t *) malloc(netplay->state_size);
+
    return true;
 }
 
@@ -407,6 +439,7 @@ static bool netplay_init_buffers(netplay_t *netplay)
  * @check_frames         : Frequency with which to check CRCs.
  * @cb                   : Libretro callbacks.
  * @nat_traversal        : If true, attempt NAT traversal.
+ * @udp_input            : If true, offer to send input over UDP.
  * @nick                 : Nickname of user.
  * @quirks               : Netplay quirks required for this session.
  *
@@ -417,19 +450,21 @@ static bool netplay_init_buffers(netplay_t *netplay)
  */
 netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
    bool stateless_mode, int check_frames,
-   const struct retro_callbacks *cb, bool nat_traversal, const char *nick,
-   uint64_t quirks)
+   const struct retro_callbacks *cb, bool nat_traversal, bool udp_input,
+   const char *nick, uint64_t quirks)
 {
    netplay_t *netplay = (netplay_t*)calloc(1, sizeof(*netplay));
    if (!netplay)
       return NULL;
 
    netplay->listen_fd            = -1;
+   netplay->udp_fd               = -1;
    netplay->tcp_port             = port;
    netplay->cbs                  = *cb;
    netplay->is_server            = (direct_host == NULL && server == NULL);
    netplay->is_connected         = false;;
    netplay->nat_traversal        = netplay->is_server ? nat_traversal : false;
+   netplay->udp_input            = udp_input;
    netplay->stateless_mode       = stateless_mode;
    netplay->check_frames         = check_frames;
    netplay->crc_validity_checked = false;
@@ -512,6 +547,9 @@ error:
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
+   if (netplay->udp_fd >= 0)
+      socket_close(netplay->udp_fd);
+
    if (netplay->connections && netplay->connections[0].fd >= 0)
       socket_close(netplay->connections[0].fd);
 
@@ -532,6 +570,9 @@ void netplay_free(netplay_t *netplay)
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
+   if (netplay->udp_fd >= 0)
+      socket_close(netplay->udp_fd);
+
    for (i = 0; i < netplay->connections_size; i++)
    {
       struct netplay_connection *connection = &netplay->connections[i];
@@ -559,6 +600,8 @@ void netplay_free(netplay_t *netplay)
 
    if (netplay->zbuffer)
       free(netplay->zbuffer);
+   if (netplay->xbuffer)
+      free(netplay->xbuffer);
 
    if (netplay->compress_nil.compression_stream)
    {
@@ -21,6 +21,7 @@
 
 #include <boolean.h>
 #include <compat/strl.h>
+#include <net/net_socket.h>
 
 #include "netplay_private.h"
 
@@ -210,6 +211,27 @@ void netplay_delayed_state_change(netplay_t *netplay)
    }
 }
 
+/* Remember an input payload for the next UDP datagram to this peer */
+static void netplay_udp_queue_input(struct netplay_connection *connection,
+      const uint32_t *data, size_t words)
+{
+   struct netplay_udp_record *record;
+
+   if (!connection->udp_input || words > NETPLAY_UDP_RECORD_WORDS)
+      return;
+
+   record           = &connection->udp_records[connection->udp_record_ptr];
+   record->ctrl_seq = connection->udp_ctrl_sent;
+   record->size     = (uint32_t)words;
+   memcpy(record->data, data, words * sizeof(uint32_t));
+
+   connection->udp_record_ptr =
+      (connection->udp_record_ptr + 1) % NETPLAY_UDP_INPUT_RECORDS;
+   if (connection->udp_record_count < NETPLAY_UDP_INPUT_RECORDS)
+      connection->udp_record_count++;
+   connection->udp_dirty = true;
+}
+
 /* Send the specified input data */
 static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
       struct netplay_connection *only, struct netplay_connection *except,
@@ -257,6 +279,7 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
          netplay_hangup(netplay, only);
          return false;
       }
+      netplay_udp_queue_input(only, buffer + 2, bufused - 2);
    }
    else
    {
@@ -272,6 +295,8 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
             if (!netplay_send(&connection->send_packet_buffer, connection->fd,
                   buffer, bufused*sizeof(uint32_t)))
                netplay_hangup(netplay, connection);
+            else
+               netplay_udp_queue_input(connection, buffer + 2, bufused - 2);
          }
       }
    }
@@ -342,6 +367,80 @@ bool netplay_send_cur_input(netplay_t *netplay,
    return true;
 }
 
+/**
+ * netplay_send_input_log
+ *
+ * Send a newly connected peer the buffered input from @base up to
+ * @end_frame, as netplay_send_cur_input would have sent it frame by frame.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool netplay_send_input_log(netplay_t *netplay,
+   struct netplay_connection *connection, struct delta_frame *base,
+   uint32_t end_frame)
+{
+   uint32_t frame, from_client;
+   uint32_t to_client = (uint32_t)(connection - netplay->connections + 1);
+   size_t ptr         = base - netplay->buffer;
+
+   for (frame = base->frame; frame < end_frame; frame++)
+   {
+      struct delta_frame *dframe = &netplay->buffer[ptr];
+
+      for (from_client = 1; from_client < MAX_CLIENTS; from_client++)
+      {
+         if (from_client == to_client ||
+             !(netplay->connected_players & (1<<from_client)) ||
+             !dframe->have_real[from_client])
+            continue;
+
+         if (!send_input_frame(netplay, dframe, connection, NULL,
+               from_client, false))
+            return false;
+      }
+
+      if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING)
+      {
+         if (!send_input_frame(netplay, dframe, connection, NULL,
+               netplay->self_client_num, false))
+            return false;
+      }
+      else
+      {
+         uint32_t payload = htonl(frame);
+         if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_NOINPUT,
+               &payload, sizeof(payload)))
+            return false;
+      }
+
+      ptr = NEXT_PTR(ptr);
+   }
+
+   return true;
+}
+
+/**
+ * netplay_cmd_orders_input
+ *
+ * Is this a command that UDP input must not overtake? These all change which
+ * input a frame expects, so every input record carries the number of them
+ * sent before it.
+ */
+bool netplay_cmd_orders_input(uint32_t cmd)
+{
+   switch (cmd)
+   {
+      case NETPLAY_CMD_MODE:
+      case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
+      case NETPLAY_CMD_RESET:
+         return true;
+      default:
+         break;
+   }
+   return false;
+}
+
 /**
  * netplay_send_raw_cmd
  *
@@ -366,6 +465,9 @@ bool netplay_send_raw_cmd(netplay_t *netplay,
       if (!netplay_send(&connection->send_packet_buffer, connection->fd, data, size))
          return false;
 
+   if (netplay_cmd_orders_input(cmd))
+      connection->udp_ctrl_sent++;
+
    return true;
 }
 
@@ -431,16 +533,30 @@ static bool netplay_cmd_nak(netplay_t *netplay,
 bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta)
 {
    uint32_t payload[2];
-   bool success = true;
+   uint32_t hashes[2];
+   bool have[2]  = {false, false};
+   bool success  = true;
    size_t i;
    payload[0] = htonl(delta->frame);
-   payload[1] = htonl(delta->crc);
    for (i = 0; i < netplay->connections_size; i++)
    {
-      if (netplay->connections[i].active &&
-            netplay->connections[i].mode >= NETPLAY_CONNECTION_CONNECTED)
-         success = netplay_send_raw_cmd(netplay, &netplay->connections[i],
-            NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
+      struct netplay_connection *connection = &netplay->connections[i];
+      unsigned kind                         = connection->fast_hash ? 1 : 0;
+
+      if (!connection->active ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      /* Each kind of hash is computed at most once per frame */
+      if (!have[kind])
+      {
+         hashes[kind] = netplay_delta_frame_hash(netplay, delta, kind == 1);
+         have[kind]   = true;
+      }
+
+      payload[1] = htonl(hashes[kind]);
+      success = netplay_send_raw_cmd(netplay, connection,
+         NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
    }
    return success;
 }
@@ -539,6 +655,46 @@ bool netplay_cmd_stall(netplay_t *netplay,
    return netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_STALL, &frames, sizeof(frames));
 }
 
+/**
+ * netplay_cmd_ping
+ *
+ * Ping every peer that supports it and hasn't been pinged recently.
+ */
+void netplay_cmd_ping(netplay_t *netplay)
+{
+   size_t i;
+   retro_time_t now = cpu_features_get_time_usec();
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      uint32_t payload;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active || !connection->ping_supported ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+            connection->ping_id ||
+            now - connection->ping_time < NETPLAY_PING_INTERVAL)
+         continue;
+
+      connection->ping_id   = (uint32_t)now | 1;
+      connection->ping_time = now;
+      payload               = htonl(connection->ping_id);
+      if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_PING,
+            &payload, sizeof(payload)))
+         netplay_hangup(netplay, connection);
+   }
+}
+
+/* Note when a peer's input arrives relative to when we need it */
+static void netplay_record_input_slack(netplay_t *netplay,
+   struct netplay_connection *connection, uint32_t frame_num)
+{
+   int slack = (int32_t)(frame_num - netplay->run_frame_count);
+
+   connection->input_slack      = slack;
+   connection->input_slack_avg += (slack - connection->input_slack_avg) / 16.0f;
+}
+
 /**
  * announce_play_spectate
  *
@@ -886,6 +1042,32 @@ static void handle_play_spectate(netplay_t *netplay, uint32_t client_num,
    }
 }
 
+/* The server's UDP socket shares its TCP port number */
+static bool netplay_udp_init_client(netplay_t *netplay,
+   struct netplay_connection *connection)
+{
+   connection->udp_addrlen = sizeof(connection->udp_addr);
+   if (getpeername(connection->fd, (struct sockaddr *) &connection->udp_addr,
+         &connection->udp_addrlen) < 0)
+      return false;
+
+   if (netplay->udp_fd < 0)
+   {
+      int fd = socket(connection->udp_addr.ss_family, SOCK_DGRAM, 0);
+      if (fd < 0)
+         return false;
+      if (!socket_nonblock(fd))
+      {
+         socket_close(fd);
+         return false;
+      }
+      netplay->udp_fd = fd;
+   }
+
+   connection->udp_addr_known = true;
+   return true;
+}
+
 #undef RECV
 #define RECV(buf, sz) \
 recvd = netplay_recv(&connection->recv_packet_buffer, connection->fd, (buf), \
@@ -1044,6 +1226,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * handling all network data this frame */
             if (connection->mode == NETPLAY_CONNECTION_PLAYING)
             {
+               netplay_record_input_slack(netplay, connection, frame_num);
                netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
                netplay->read_frame_count[client_num]++;
 
@@ -1524,8 +1707,8 @@ static bool netplay_get_cmd(netplay_t *netplay,
             {
                /* We've already replayed up to this frame, so we can check it
                 * directly */
-               uint32_t local_crc = netplay_delta_frame_crc(
-                     netplay, &netplay->buffer[tmp_ptr]);
+               uint32_t local_crc = netplay_delta_frame_hash(
+                     netplay, &netplay->buffer[tmp_ptr], connection->fast_hash);
 
                if (buffer[1] != local_crc)
                {
@@ -1548,11 +1731,19 @@ static bool netplay_get_cmd(netplay_t *netplay,
          netplay->force_send_savestate = true;
          break;
 
+      case NETPLAY_CMD_REQUEST_FULL_SAVESTATE:
+         connection->need_full_savestate = true;
+         netplay->force_send_savestate   = true;
+         break;
+
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
       case NETPLAY_CMD_RESET:
          {
             uint32_t frame;
             uint32_t isize;
+            uint32_t base_frame = 0, base_crc = 0;
+            size_t header_size = 2*sizeof(uint32_t);
             uint32_t rd, wn;
             uint32_t client;
             uint32_t load_frame_count;
@@ -1606,8 +1797,10 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * too many places. */
 
             /* Check the payload size */
-            if ((cmd == NETPLAY_CMD_LOAD_SAVESTATE &&
-                 (cmd_size < 2*sizeof(uint32_t) || cmd_size > netplay->zbuffer_size + 2*sizeof(uint32_t))) ||
+            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               header_size = 4*sizeof(uint32_t);
+            if ((cmd != NETPLAY_CMD_RESET &&
+                 (cmd_size < header_size || cmd_size > netplay->zbuffer_size + header_size)) ||
                 (cmd == NETPLAY_CMD_RESET && cmd_size != sizeof(uint32_t)))
             {
                RARCH_ERR("CMD_LOAD_SAVESTATE received an unexpected payload size.\n");
@@ -1645,8 +1838,12 @@ static bool netplay_get_cmd(netplay_t *netplay,
             }
 
             /* Now we switch based on whether we're loading a state or resetting */
-            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE)
+            if (cmd != NETPLAY_CMD_RESET)
             {
+               struct delta_frame *base = NULL;
+               uint8_t *out             = (uint8_t*)
+                  netplay->buffer[load_ptr].state;
+
                RECV(&isize, sizeof(isize))
                {
                   RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive inflated size.\n");
@@ -1660,12 +1857,46 @@ static bool netplay_get_cmd(netplay_t *netplay,
                   return netplay_cmd_nak(netplay, connection);
                }
 
-               RECV(netplay->zbuffer, cmd_size - 2*sizeof(uint32_t))
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               {
+                  RECV(&base_frame, sizeof(base_frame))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive delta base.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+                  RECV(&base_crc, sizeof(base_crc))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive delta base.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+                  base_frame = ntohl(base_frame);
+                  base_crc   = ntohl(base_crc);
+               }
+
+               RECV(netplay->zbuffer, cmd_size - header_size)
                {
                   RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive savestate.\n");
                   return netplay_cmd_nak(netplay, connection);
                }
 
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               {
+                  /* The base must be the exact state the sender had */
+                  if (netplay->xbuffer)
+                     base = netplay_delta_frame_find(netplay, base_frame);
+                  if (!base || netplay_delta_frame_crc(netplay, base) != base_crc)
+                  {
+                     RARCH_WARN("Netplay delta savestate base %u unusable, "
+                           "requesting the full state.\n", base_frame);
+                     netplay->savestate_request_outstanding = true;
+                     if (!netplay_send_raw_cmd(netplay, connection,
+                           NETPLAY_CMD_REQUEST_FULL_SAVESTATE, NULL, 0))
+                        netplay_hangup(netplay, connection);
+                     break;
+                  }
+                  out = netplay->xbuffer;
+               }
+
                /* And decompress it */
                switch (connection->compression_supported)
                {
@@ -1676,13 +1907,22 @@ static bool netplay_get_cmd(netplay_t *netplay,
                      ctrans = &netplay->compress_nil;
                }
                ctrans->decompression_backend->set_in(ctrans->decompression_stream,
-                  netplay->zbuffer, cmd_size - 2*sizeof(uint32_t));
+                  netplay->zbuffer, cmd_size - header_size);
                ctrans->decompression_backend->set_out(ctrans->decompression_stream,
-                  (uint8_t*)netplay->buffer[load_ptr].state,
-                  (unsigned)netplay->state_size);
+                  out, (unsigned)netplay->state_size);
                ctrans->decompression_backend->trans(ctrans->decompression_stream,
                   true, &rd, &wn, NULL);
 
+               if (base)
+               {
+                  size_t i;
+                  uint8_t *state     = (uint8_t*)netplay->buffer[load_ptr].state;
+                  const uint8_t *old = (const uint8_t*)base->state;
+
+                  for (i = 0; i < netplay->state_size; i++)
+                     state[i] = out[i] ^ old[i];
+               }
+
                /* Force a rewind to the relevant frame */
                netplay->force_rewind = true;
             }
@@ -1819,11 +2059,105 @@ static bool netplay_get_cmd(netplay_t *netplay,
             break;
          }
 
+      case NETPLAY_CMD_PING:
+      case NETPLAY_CMD_PONG:
+         {
+            uint32_t id;
+
+            if (cmd_size != sizeof(id))
+            {
+               RARCH_ERR("Invalid payload size for NETPLAY_CMD_PING.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(&id, sizeof(id))
+            {
+               RARCH_ERR("Failed to receive NETPLAY_CMD_PING payload.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (cmd == NETPLAY_CMD_PING)
+            {
+               /* Answer right away, any delay counts towards their RTT */
+               if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_PONG,
+                        &id, sizeof(id)) ||
+                   !netplay_send_flush(&connection->send_packet_buffer,
+                        connection->fd, false))
+                  return false;
+               break;
+            }
+
+            id = ntohl(id);
+            if (id && id == connection->ping_id)
+            {
+               retro_time_t sample = cpu_features_get_time_usec() -
+                  connection->ping_time;
+
+               /* Smoothed like TCP's retransmission timer (RFC 6298) */
+               if (!connection->rtt)
+               {
+                  connection->rtt        = sample;
+                  connection->rtt_jitter = sample / 2;
+               }
+               else
+               {
+                  retro_time_t dev = sample > connection->rtt ?
+                     sample - connection->rtt : connection->rtt - sample;
+                  connection->rtt_jitter += (dev - connection->rtt_jitter) / 4;
+                  connection->rtt        += (sample - connection->rtt) / 8;
+               }
+               if (!connection->rtt)
+                  connection->rtt = 1;
+               connection->ping_id = 0;
+            }
+            break;
+         }
+
+      case NETPLAY_CMD_UDP_INPUT:
+         {
+            uint32_t token;
+
+            if (netplay->is_server)
+            {
+               RARCH_ERR("NETPLAY_CMD_UDP_INPUT from a client.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (cmd_size != sizeof(token))
+            {
+               RARCH_ERR("Invalid payload size for NETPLAY_CMD_UDP_INPUT.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(&token, sizeof(token))
+            {
+               RARCH_ERR("Failed to receive NETPLAY_CMD_UDP_INPUT payload.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            /* We didn't ask for it */
+            if (!connection->udp_input)
+               break;
+
+            if (!netplay_udp_init_client(netplay, connection))
+            {
+               RARCH_WARN("Failed to open the UDP input socket, input will only be sent over TCP.\n");
+               connection->udp_input = false;
+               break;
+            }
+
+            connection->udp_token = ntohl(token);
+            break;
+         }
+
       default:
          RARCH_ERR("%s.\n", msg_hash_to_str(MSG_UNKNOWN_NETPLAY_COMMAND_RECEIVED));
          return netplay_cmd_nak(netplay, connection);
    }
 
+   if (netplay_cmd_orders_input(cmd))
+      connection->udp_ctrl_recvd++;
+
    netplay_recv_flush(&connection->recv_packet_buffer);
    netplay->timeout_cnt = 0;
    if (had_input)
@@ -1838,6 +2172,234 @@ shrt:
 #undef RECV
 }
 
+/**
+ * netplay_udp_apply_input
+ *
+ * Apply one input record from a UDP datagram. Anything TCP would reject is
+ * silently dropped, as is anything we already have.
+ *
+ * Returns false if the record can't be used yet, so neither can any later
+ * one in the same datagram.
+ */
+static bool netplay_udp_apply_input(netplay_t *netplay,
+   struct netplay_connection *connection,
+   const struct netplay_udp_record *record, bool *had_input)
+{
+   uint32_t frame_num, client_num, input_size, devices, device;
+   const uint32_t *data = record->data;
+   struct delta_frame *dframe;
+
+   /* Sent before a command we've handled: TCP already delivered it */
+   if (record->ctrl_seq < connection->udp_ctrl_recvd)
+      return true;
+   if (record->ctrl_seq > connection->udp_ctrl_recvd)
+      return false;
+
+   /* Slaves' input is handled separately, so leave it to TCP */
+   if (connection->mode != NETPLAY_CONNECTION_PLAYING || record->size < 2)
+      return true;
+
+   frame_num  = ntohl(data[0]);
+   client_num = ntohl(data[1]) & 0xFFFF;
+   if (netplay->is_server)
+      client_num = (uint32_t)(connection - netplay->connections + 1);
+
+   if (client_num >= MAX_CLIENTS ||
+       !(netplay->connected_players & (1<<client_num)))
+      return true;
+
+   devices    = netplay->client_devices[client_num];
+   input_size = netplay_expected_input_size(netplay, devices);
+   if (record->size != 2 + input_size)
+      return true;
+
+   if (frame_num < netplay->read_frame_count[client_num])
+      return true;
+   if (frame_num > netplay->read_frame_count[client_num])
+      return false;
+
+   dframe = &netplay->buffer[netplay->read_ptr[client_num]];
+   if (!netplay_delta_frame_ready(netplay, dframe, frame_num))
+      return false;
+
+   /* Copy in the input */
+   data += 2;
+   for (device = 0; device < MAX_INPUT_DEVICES; device++)
+   {
+      netplay_input_state_t istate;
+      uint32_t dsize, di;
+      if (!(devices & (1<<device)))
+         continue;
+
+      dsize  = netplay_expected_input_size(netplay, 1 << device);
+      istate = netplay_input_state_for(&dframe->real_input[device],
+            client_num, dsize, false, false);
+      if (!istate)
+         return false;
+      for (di = 0; di < dsize; di++)
+         istate->data[di] = ntohl(data[di]);
+      data += dsize;
+   }
+   dframe->have_real[client_num] = true;
+   netplay_record_input_slack(netplay, connection, frame_num);
+
+   netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
+   netplay->read_frame_count[client_num]++;
+
+   if (netplay->is_server)
+   {
+      /* Forward it on if it's past data */
+      if (dframe->frame <= netplay->self_frame_count)
+         send_input_frame(netplay, dframe, NULL, connection, client_num, false);
+   }
+   else if (client_num == 0)
+   {
+      netplay->server_ptr = netplay->read_ptr[0];
+      netplay->server_frame_count = netplay->read_frame_count[0];
+   }
+
+   *had_input = true;
+   return true;
+}
+
+/**
+ * netplay_udp_receive
+ *
+ * Read every pending UDP input datagram.
+ */
+static void netplay_udp_receive(netplay_t *netplay, bool *had_input)
+{
+   uint32_t buf[NETPLAY_UDP_MAX_DATAGRAM / sizeof(uint32_t)];
+
+   if (netplay->udp_fd < 0)
+      return;
+
+   for (;;)
+   {
+      size_t i, pos, words;
+      uint32_t token;
+      struct sockaddr_storage addr;
+      struct netplay_connection *connection = NULL;
+      socklen_t addrlen = sizeof(addr);
+      ssize_t recvd     = recvfrom(netplay->udp_fd, (char *) buf, sizeof(buf),
+            0, (struct sockaddr *) &addr, &addrlen);
+
+      if (recvd < (ssize_t) (2 * sizeof(uint32_t)))
+      {
+         if (recvd < 0)
+            break;
+         continue;
+      }
+
+      if (ntohl(buf[0]) != NETPLAY_UDP_MAGIC)
+         continue;
+
+      token = ntohl(buf[1]);
+      for (i = 0; i < netplay->connections_size; i++)
+      {
+         struct netplay_connection *c = &netplay->connections[i];
+         if (c->active && c->udp_input && c->udp_token == token &&
+               c->mode >= NETPLAY_CONNECTION_CONNECTED)
+         {
+            connection = c;
+            break;
+         }
+      }
+      if (!connection)
+         continue;
+
+      /* The server only learns where clients are from their datagrams */
+      if (netplay->is_server)
+      {
+         memcpy(&connection->udp_addr, &addr, addrlen);
+         connection->udp_addrlen    = addrlen;
+         connection->udp_addr_known = true;
+      }
+
+      words = (size_t)recvd / sizeof(uint32_t);
+      pos   = 2;
+      while (pos + 2 <= words)
+      {
+         struct netplay_udp_record record;
+
+         record.ctrl_seq = ntohl(buf[pos]);
+         record.size     = ntohl(buf[pos + 1]);
+         pos += 2;
+
+         if (record.size > NETPLAY_UDP_RECORD_WORDS ||
+               pos + record.size > words)
+            break;
+         memcpy(record.data, buf + pos, record.size * sizeof(uint32_t));
+         pos += record.size;
+
+         if (!netplay_udp_apply_input(netplay, connection, &record, had_input))
+            break;
+      }
+   }
+}
+
+/**
+ * netplay_udp_flush
+ *
+ * Send a datagram with the latest input records to every peer that takes
+ * UDP input. Clients send one every frame even without new input, so the
+ * server keeps their address.
+ */
+void netplay_udp_flush(netplay_t *netplay)
+{
+   size_t i;
+   uint32_t buf[NETPLAY_UDP_MAX_DATAGRAM / sizeof(uint32_t)];
+
+   if (netplay->udp_fd < 0)
+      return;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      size_t count, first, words, r;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active || !connection->udp_input ||
+            !connection->udp_addr_known ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+      if (netplay->is_server && !connection->udp_dirty)
+         continue;
+
+      /* As many of the newest records as fit */
+      words = 2;
+      for (count = 0; count < connection->udp_record_count; count++)
+      {
+         r = (connection->udp_record_ptr + NETPLAY_UDP_INPUT_RECORDS - 1 - count)
+               % NETPLAY_UDP_INPUT_RECORDS;
+         if ((words + 2 + connection->udp_records[r].size) * sizeof(uint32_t)
+               > sizeof(buf))
+            break;
+         words += 2 + connection->udp_records[r].size;
+      }
+
+      buf[0] = htonl(NETPLAY_UDP_MAGIC);
+      buf[1] = htonl(connection->udp_token);
+      words  = 2;
+      first  = (connection->udp_record_ptr + NETPLAY_UDP_INPUT_RECORDS - count)
+            % NETPLAY_UDP_INPUT_RECORDS;
+      for (; count; count--, first = (first + 1) % NETPLAY_UDP_INPUT_RECORDS)
+      {
+         const struct netplay_udp_record *record =
+            &connection->udp_records[first];
+         buf[words++] = htonl(record->ctrl_seq);
+         buf[words++] = htonl(record->size);
+         memcpy(buf + words, record->data, record->size * sizeof(uint32_t));
+         words += record->size;
+      }
+
+      /* Lost or refused datagrams are fine, TCP has the same input */
+      sendto(netplay->udp_fd, (const char *) buf, words * sizeof(uint32_t), 0,
+            (const struct sockaddr *) &connection->udp_addr,
+            connection->udp_addrlen);
+      connection->udp_dirty = false;
+   }
+}
+
 /**
  * netplay_poll_net_input
  *
@@ -1859,6 +2421,9 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
    if (max_fd == 0)
       return 0;
 
+   if (netplay->udp_fd >= max_fd)
+      max_fd = netplay->udp_fd + 1;
+
    netplay->timeout_cnt = 0;
 
    do
@@ -1875,6 +2440,9 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
             netplay_hangup(netplay, connection);
       }
 
+      /* UDP input may be ready now that TCP has caught up on commands */
+      netplay_udp_receive(netplay, &had_input);
+
       if (block)
       {
          netplay_update_unread_ptr(netplay);
@@ -1897,6 +2465,8 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
                if (connection->active)
                   FD_SET(connection->fd, &fds);
             }
+            if (netplay->udp_fd >= 0)
+               FD_SET(netplay->udp_fd, &fds);
 
             if (socket_select(max_fd, &fds, NULL, NULL, &tv) < 0)
                return -1;
@@ -89,8 +89,25 @@ typedef uint32_t client_bitmap_t;
 
 /* Compression protocols supported */
 #define NETPLAY_COMPRESSION_ZLIB (1<<0)
+/* Savestates may be sent as an XOR delta against a frame both sides still
+ * hold (NETPLAY_CMD_LOAD_SAVESTATE_DELTA). Only worth it when compressed. */
+#define NETPLAY_COMPRESSION_DELTA (1<<1)
+/* Not compression, but negotiated in the same header word: input is also
+ * sent over UDP (NETPLAY_CMD_UDP_INPUT). */
+#define NETPLAY_FEATURE_UDP_INPUT (1<<2)
+/* Likewise: the peer answers NETPLAY_CMD_PING */
+#define NETPLAY_FEATURE_PING      (1<<3)
+/* Likewise: the peer can check frames with the fast hash instead of CRC-32,
+ * and would rather do so because its CRC-32 is not hardware accelerated.
+ * The fast hash is used if both can and either would rather. */
+#define NETPLAY_FEATURE_FAST_HASH           (1<<4)
+#define NETPLAY_FEATURE_FAST_HASH_PREFERRED (1<<5)
+
+/* How often to measure the round trip time to each peer */
+#define NETPLAY_PING_INTERVAL     1000000 /* usec */
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED \
+   (NETPLAY_COMPRESSION_ZLIB | NETPLAY_COMPRESSION_DELTA)
 #else
 #define NETPLAY_COMPRESSION_SUPPORTED 0
 #endif
@@ -166,6 +183,12 @@ enum netplay_cmd
    /* Sends over cheats enabled on client (unsupported) */
    NETPLAY_CMD_CHEATS         = 0x0047,
 
+   /* Send a savestate as a delta against an earlier frame */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0048,
+
+   /* The delta base wasn't usable, send the whole savestate */
+   NETPLAY_CMD_REQUEST_FULL_SAVESTATE = 0x0049,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -175,7 +198,35 @@ enum netplay_cmd
    /* CMD_CFG streamlines sending multiple
       configurations. This acknowledges
       each one individually */
-   NETPLAY_CMD_CFG_ACK        = 0x0062
+   NETPLAY_CMD_CFG_ACK        = 0x0062,
+
+   /* Gives the token to put in UDP input datagrams */
+   NETPLAY_CMD_UDP_INPUT      = 0x0063,
+
+   /* Round trip time measurement */
+   NETPLAY_CMD_PING           = 0x0064,
+   NETPLAY_CMD_PONG           = 0x0065
+};
+
+/* UDP input datagrams start with this magic and the connection's token,
+ * followed by the last NETPLAY_UDP_INPUT_RECORDS input records sent to the
+ * peer, oldest first. Every input goes over TCP as well; UDP just lets it
+ * arrive before an earlier lost TCP segment is retransmitted. */
+#define NETPLAY_UDP_MAGIC          0x52414944 /* RAID */
+#define NETPLAY_UDP_INPUT_RECORDS  16
+#define NETPLAY_UDP_RECORD_WORDS   16
+#define NETPLAY_UDP_MAX_DATAGRAM   1200
+
+struct netplay_udp_record
+{
+   /* How many input-ordering commands (see netplay_cmd_orders_input) had
+    * been sent on TCP before this input. The receiver only applies it once
+    * it has handled as many, so it can't overtake a mode change or load. */
+   uint32_t ctrl_seq;
+
+   /* Size in words, and the NETPLAY_CMD_INPUT payload in network order */
+   uint32_t size;
+   uint32_t data[NETPLAY_UDP_RECORD_WORDS];
 };
 
 #define NETPLAY_CMD_SYNC_BIT_PAUSED    (1U<<31)
@@ -295,7 +346,8 @@ struct delta_frame
    /* The serialized state of the core at this frame, before input */
    void *state;
 
-   /* The CRC-32 of the serialized state if we've calculated it, else 0 */
+   /* The remote hash of the serialized state if we've received it, else 0.
+    * CRC-32 or the fast hash, as negotiated with the server. */
    uint32_t crc;
 
    /* The resolved input, i.e., what's actually going to the core. One input
@@ -359,6 +411,43 @@ struct netplay_connection
    /* What compression does this peer support? */
    uint32_t compression_supported;
 
+   /* Does this peer accept delta savestates, and does it need
+    * a full one because the last delta had no usable base? */
+   bool delta_savestates;
+   bool need_full_savestate;
+
+   /* Input over UDP: negotiated, and do we know where to send it yet? */
+   bool udp_input;
+   bool udp_addr_known;
+   uint32_t udp_token;
+   struct sockaddr_storage udp_addr;
+   socklen_t udp_addrlen;
+
+   /* Input-ordering commands sent and handled on TCP */
+   uint32_t udp_ctrl_sent;
+   uint32_t udp_ctrl_recvd;
+
+   /* The last input records sent to this peer, and whether there is
+    * anything new since the last datagram */
+   struct netplay_udp_record udp_records[NETPLAY_UDP_INPUT_RECORDS];
+   size_t udp_record_ptr, udp_record_count;
+   bool udp_dirty;
+
+   /* Are frame checks with this peer done with the fast hash? */
+   bool fast_hash;
+
+   /* Does the peer answer pings, and the one we're waiting on (0 if none) */
+   bool ping_supported;
+   uint32_t ping_id;
+   retro_time_t ping_time;
+
+   /* Smoothed round trip time and its mean deviation, 0 until measured */
+   retro_time_t rtt, rtt_jitter;
+
+   /* Frames between their input arriving and us running that frame */
+   int input_slack;
+   float input_slack_avg;
+
    /* Is this player paused? */
    bool paused;
 
@@ -394,6 +483,9 @@ struct netplay
    /* TCP connection for listening (server only) */
    int listen_fd;
 
+   /* UDP input socket, -1 if not in use */
+   int udp_fd;
+
    /* Our client number */
    uint32_t self_client_num;
 
@@ -448,6 +540,9 @@ struct netplay
    bool nat_traversal, nat_traversal_task_oustanding;
    struct natt_status nat_traversal_state;
 
+   /* Offer to send input over UDP? */
+   bool udp_input;
+
    struct delta_frame *buffer;
    size_t buffer_size;
 
@@ -459,6 +554,9 @@ struct netplay
    uint8_t *zbuffer;
    size_t zbuffer_size;
 
+   /* A state-sized buffer for building and applying delta savestates */
+   uint8_t *xbuffer;
+
    /* The size of our packet buffers */
    size_t packet_buffer_size;
 
@@ -544,6 +642,10 @@ struct netplay
    /* Latency frames; positive to hide network latency, negative to hide input latency */
    int input_latency_frames;
 
+   /* Telemetry for RARCH_NETPLAY_CTL_GET_STATS */
+   uint64_t stats_rollbacks, stats_replayed_frames;
+   uint32_t stats_rollback_depths[NETPLAY_STATS_ROLLBACK_DEPTHS];
+
    /* Are we stalled? */
    enum rarch_netplay_stall_reason stall;
 
@@ -663,6 +765,40 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
  */
 uint32_t netplay_delta_frame_crc(netplay_t *netplay, struct delta_frame *delta);
 
+/**
+ * netplay_delta_frame_hash
+ *
+ * Get the hash used to check this frame against a peer: the fast hash if
+ * @fast, else the CRC-32.
+ */
+uint32_t netplay_delta_frame_hash(netplay_t *netplay,
+      struct delta_frame *delta, bool fast);
+
+/**
+ * netplay_delta_frame_find
+ *
+ * Find the buffered frame holding the state of the given frame, if any.
+ */
+struct delta_frame *netplay_delta_frame_find(netplay_t *netplay,
+   uint32_t frame);
+
+/**
+ * netplay_delta_frame_savestate_base
+ *
+ * Choose the buffered frame to send a savestate as a delta against, or NULL
+ * if there is none the peer is likely to hold in the same state.
+ */
+struct delta_frame *netplay_delta_frame_savestate_base(netplay_t *netplay);
+
+/**
+ * netplay_delta_frame_catch_up_base
+ *
+ * Choose the buffered frame a newly connected peer can start from, without
+ * anybody else loading a state, or NULL if there is none.
+ */
+struct delta_frame *netplay_delta_frame_catch_up_base(netplay_t *netplay,
+   uint32_t end_frame);
+
 /**
  * netplay_delta_frame_free
  *
@@ -702,6 +838,17 @@ bool netplay_lan_ad_server(netplay_t *netplay);
  * NETPLAY-FRONTEND.C
  **************************************************************/
 
+/**
+ * netplay_send_cached_savestate
+ * @netplay              : pointer to netplay object
+ * @connection           : the peer to send it to
+ * @delta                : the buffered frame holding the state
+ *
+ * Send one peer a state we already have in the frame buffer.
+ **/
+bool netplay_send_cached_savestate(netplay_t *netplay,
+   struct netplay_connection *connection, struct delta_frame *delta);
+
 /**
  * netplay_load_savestate
  * @netplay              : pointer to netplay object
@@ -782,6 +929,7 @@ bool netplay_wait_and_init_serialization(netplay_t *netplay);
  * @check_frames         : Frequency with which to check CRCs.
  * @cb                   : Libretro callbacks.
  * @nat_traversal        : If true, attempt NAT traversal.
+ * @udp_input            : If true, offer to send input over UDP.
  * @nick                 : Nickname of user.
  * @quirks               : Netplay quirks required for this session.
  *
@@ -792,8 +940,8 @@ bool netplay_wait_and_init_serialization(netplay_t *netplay);
  */
 netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
    bool stateless_mode, int check_frames,
-   const struct retro_callbacks *cb, bool nat_traversal, const char *nick,
-   uint64_t quirks);
+   const struct retro_callbacks *cb, bool nat_traversal, bool udp_input,
+   const char *nick, uint64_t quirks);
 
 /**
  * netplay_free
@@ -823,6 +971,18 @@ void netplay_hangup(netplay_t *netplay, struct netplay_connection *connection);
  */
 void netplay_delayed_state_change(netplay_t *netplay);
 
+/**
+ * netplay_send_input_log
+ *
+ * Send a newly connected peer the buffered input from @base up to
+ * @end_frame.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool netplay_send_input_log(netplay_t *netplay,
+   struct netplay_connection *connection, struct delta_frame *base,
+   uint32_t end_frame);
+
 /**
  * netplay_send_cur_input
  *
@@ -886,6 +1046,20 @@ bool netplay_cmd_stall(netplay_t *netplay,
    struct netplay_connection *connection,
    uint32_t frames);
 
+/**
+ * netplay_cmd_ping
+ *
+ * Ping every peer that supports it and hasn't been pinged recently.
+ */
+void netplay_cmd_ping(netplay_t *netplay);
+
+/**
+ * netplay_get_stats
+ *
+ * Fill in the telemetry for RARCH_NETPLAY_CTL_GET_STATS.
+ */
+void netplay_get_stats(netplay_t *netplay, struct netplay_stats *stats);
+
 /**
  * netplay_poll_net_input
  *
@@ -893,6 +1067,21 @@ bool netplay_cmd_stall(netplay_t *netplay,
  */
 int netplay_poll_net_input(netplay_t *netplay, bool block);
 
+/**
+ * netplay_cmd_orders_input
+ *
+ * Is this a command that UDP input must not overtake?
+ */
+bool netplay_cmd_orders_input(uint32_t cmd);
+
+/**
+ * netplay_udp_flush
+ *
+ * Send a datagram with the latest input records to every peer that takes
+ * UDP input.
+ */
+void netplay_udp_flush(netplay_t *netplay);
+
 /**
  * netplay_handle_slaves
  *
@@ -985,4 +1174,14 @@ bool netplay_sync_pre_frame(netplay_t *netplay);
  */
 void netplay_sync_post_frame(netplay_t *netplay, bool stalled);
 
+/**
+ * netplay_sync_input_latency
+ * @netplay              : pointer to netplay object
+ * @min                  : fewest input latency frames to use
+ * @max                  : most input latency frames to use
+ *
+ * Adjust our input latency frames by at most one.
+ */
+void netplay_sync_input_latency(netplay_t *netplay, int min, int max);
+
 #endif
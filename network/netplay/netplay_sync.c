@@ -25,7 +25,11 @@
 
 #include "../../autosave.h"
 #include "../../driver.h"
+#include "../../gfx/video_driver.h"
 #include "../../input/input_driver.h"
+#ifdef HAVE_RUNAHEAD
+#include "../../runahead/run_ahead.h"
+#endif
 
 #if 0
 #define DEBUG_NONDETERMINISTIC_CORES
@@ -504,15 +508,13 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
    {
       if (netplay->check_frames &&
           delta->frame % abs(netplay->check_frames) == 0)
-      {
-         delta->crc = netplay_delta_frame_crc(netplay, delta);
          netplay_cmd_crc(netplay, delta);
-      }
    }
    else if (delta->crc && netplay->crcs_valid)
    {
       /* We have a remote CRC, so check it */
-      uint32_t local_crc = netplay_delta_frame_crc(netplay, delta);
+      uint32_t local_crc = netplay_delta_frame_hash(netplay, delta,
+            netplay->connections[0].fast_hash);
       if (local_crc != delta->crc)
       {
          /* If the very first check frame is wrong,
@@ -826,9 +828,22 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
        netplay->replay_frame_count < netplay->run_frame_count)
    {
       retro_ctx_serialize_info_t serial_info;
+      uint32_t depth = netplay->run_frame_count - netplay->replay_frame_count;
 
       /* Replay frames. */
       netplay->is_replay = true;
+#ifdef HAVE_RUNAHEAD
+      runahead_replay_begin();
+#endif
+
+      if (depth)
+      {
+         netplay->stats_rollbacks++;
+         netplay->stats_replayed_frames += depth;
+         netplay->stats_rollback_depths[
+            (depth < NETPLAY_STATS_ROLLBACK_DEPTHS ?
+             depth : NETPLAY_STATS_ROLLBACK_DEPTHS) - 1]++;
+      }
 
       /* If we have a keyboard device, we replay the previous frame's input
        * just to assert that the keydown/keyup events work if the core
@@ -922,6 +937,9 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
          netplay->other_ptr = netplay->run_ptr;
          netplay->other_frame_count = netplay->run_frame_count;
       }
+#ifdef HAVE_RUNAHEAD
+      runahead_replay_end();
+#endif
       netplay->is_replay = false;
       netplay->force_rewind = false;
    }
@@ -1032,3 +1050,90 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
    else
       netplay->catch_up_time =  0;
 }
+
+/**
+ * netplay_sync_input_latency
+ * @netplay              : pointer to netplay object
+ * @min                  : fewest input latency frames to use
+ * @max                  : most input latency frames to use
+ *
+ * Adjust our input latency frames by at most one. Latency hides what
+ * rollback can't: if the network would make us replay more frames than we
+ * can run in a frame's time, a frame of input lag is cheaper than
+ * stuttering through the resimulation.
+ */
+void netplay_sync_input_latency(netplay_t *netplay, int min, int max)
+{
+   size_t i;
+   unsigned frames_per_frame, frames_ahead, rtt_frames, rtt_latency;
+   retro_time_t frame_time                = 16666;
+   retro_time_t rtt                       = 0;
+   struct retro_system_av_info *av_info   = video_viewport_get_system_av_info();
+
+   if (!netplay->frame_run_time_avg && !netplay->stateless_mode)
+      return;
+
+   /* In stateless mode, we adjust up if we're "close" and down if we
+    * have a lot of slack */
+   if (netplay->stateless_mode)
+   {
+      if (netplay->input_latency_frames < min ||
+          (netplay->unread_frame_count == netplay->run_frame_count + 1 &&
+           netplay->input_latency_frames < max))
+         netplay->input_latency_frames++;
+      else if (netplay->input_latency_frames > max ||
+               (netplay->unread_frame_count > netplay->run_frame_count + 2 &&
+                netplay->input_latency_frames > min))
+         netplay->input_latency_frames--;
+      return;
+   }
+
+   if (av_info && av_info->timing.fps > 0)
+      frame_time = (retro_time_t)(1000000.0 / av_info->timing.fps);
+
+   /* How many frames we can replay in the time of one, assuming we need a
+    * couple frames worth of time to actually run the current frame */
+   frames_per_frame = (unsigned)(frame_time / netplay->frame_run_time_avg);
+   if (frames_per_frame > 2)
+      frames_per_frame -= 2;
+   else
+      frames_per_frame = 0;
+
+   frames_ahead = (netplay->run_frame_count > netplay->unread_frame_count) ?
+                  (netplay->run_frame_count - netplay->unread_frame_count) :
+                  0;
+
+   /* The one-way trip to the slowest player, with room for its jitter, is
+    * about how late their input will be. Assuming they run the same
+    * controller, their latency frames and ours split it evenly. */
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (connection->active &&
+          (connection->mode == NETPLAY_CONNECTION_PLAYING ||
+           connection->mode == NETPLAY_CONNECTION_SLAVE) &&
+          connection->rtt + connection->rtt_jitter > rtt)
+         rtt = connection->rtt + connection->rtt_jitter;
+   }
+   rtt_frames  = (unsigned)((rtt / 2 + frame_time - 1) / frame_time);
+   rtt_latency = (rtt_frames > frames_per_frame) ?
+                 (rtt_frames - frames_per_frame + 1) / 2 : 0;
+
+   if (netplay->input_latency_frames < min ||
+       ((netplay->input_latency_frames < (int)rtt_latency ||
+         frames_per_frame < frames_ahead) &&
+        netplay->input_latency_frames < max))
+   {
+      /* We can't hide this much network latency with replay, so hide some
+       * with input latency */
+      netplay->input_latency_frames++;
+   }
+   else if (netplay->input_latency_frames > max ||
+            (frames_per_frame > frames_ahead + 2 &&
+             netplay->input_latency_frames > (int)rtt_latency &&
+             netplay->input_latency_frames > min))
+   {
+      /* We don't need this much latency (any more) */
+      netplay->input_latency_frames--;
+   }
+}
@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef _WIN32
@@ -24,6 +25,13 @@
 #endif
 
 #include <compat/strl.h>
+#include <retro_miscellaneous.h>
+#include <queues/task_queue.h>
+#include <string/stdstring.h>
+#include <streams/file_stream.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "performance_counters.h"
 
@@ -41,6 +49,73 @@ static struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
 static unsigned perf_ptr_rarch;
 static unsigned perf_ptr_libretro;
 
+/* Deepest nesting of zones which is timed. */
+#define PERF_ZONE_STACK 8
+/* History entry of a frame in which a zone wasn't entered. */
+#define PERF_ZONE_UNUSED 0xffffffff
+
+typedef struct perf_zone_stats
+{
+   retro_time_t frame_time;   /* Time spent this frame */
+   uint32_t history[PERF_ZONE_HISTORY];
+   enum perf_zone parent;
+   bool entered;
+   bool seen;
+} perf_zone_stats_t;
+
+static const char *perf_zone_idents[PERF_ZONE_LAST] = {
+   "frame",
+   "core_run",
+   "input_poll",
+   "video_frame",
+   "audio_flush",
+   "menu_render"
+};
+
+static struct
+{
+   enum perf_zone zone;
+   retro_time_t start;
+} perf_zone_stack[PERF_ZONE_STACK];
+
+/* Trace events are collected in a buffer this large before
+ * being written out. */
+#define PERF_TRACE_BUFFER_SIZE (64 * 1024)
+
+static RFILE *perf_trace_file;
+static char *perf_trace_buffer;
+static size_t perf_trace_size;
+static retro_time_t perf_trace_start;
+static bool perf_trace_enabled;
+#ifdef HAVE_THREADS
+/* Kept around after deinit, other threads may still be
+ * in the middle of an event. */
+static slock_t *perf_trace_lock;
+#ifdef HAVE_THREAD_STORAGE
+static sthread_tls_t perf_trace_tid;
+static uintptr_t perf_trace_threads;
+static bool perf_trace_tid_created;
+#endif
+#endif
+
+/* Weight of the newest frame in the GPU pass averages, 1/n. */
+#define PERF_GPU_PASS_SMOOTHING 16
+
+static perf_gpu_pass_t perf_gpu_passes[PERF_GPU_PASSES];
+static unsigned perf_gpu_pass_count;
+static retro_time_t perf_gpu_passes_time;
+#ifdef HAVE_THREADS
+static slock_t *perf_gpu_passes_lock;
+#endif
+
+static perf_zone_stats_t perf_zones[PERF_ZONE_LAST];
+static retro_time_t perf_zones_frame_start;
+static unsigned perf_zone_depth;
+static unsigned perf_zones_frame_ptr;
+static unsigned perf_zones_frame_count;
+static bool perf_zones_active;
+static bool perf_zones_entered;
+
 struct retro_perf_counter **retro_get_perf_counter_rarch(void)
 {
    return perf_counters_rarch;
@@ -89,6 +164,545 @@ void performance_counters_clear(void)
    memset(perf_counters_libretro, 0, sizeof(perf_counters_libretro));
 }
 
+static unsigned performance_trace_tid(void)
+{
+#if defined(HAVE_THREADS) && defined(HAVE_THREAD_STORAGE)
+   uintptr_t tid = (uintptr_t)sthread_tls_get(&perf_trace_tid);
+
+   if (!tid)
+   {
+      tid = ++perf_trace_threads;
+      sthread_tls_set(&perf_trace_tid, (const void*)tid);
+   }
+
+   return (unsigned)tid;
+#else
+   return 1;
+#endif
+}
+
+static void performance_trace_escape(char *s, size_t len, const char *name)
+{
+   size_t i = 0;
+
+   for (; name && *name && i + 2 < len; name++)
+   {
+      if (*name == '"' || *name == '\\')
+         s[i++] = '\\';
+      s[i++] = ((unsigned char)*name < 0x20) ? ' ' : *name;
+   }
+
+   s[i] = '\0';
+}
+
+static void performance_trace_write(char ph, const char *name,
+      retro_time_t time, retro_time_t duration)
+{
+   char event[384];
+   char escaped[256];
+   int len;
+   unsigned tid;
+   long long ts = (long long)time;
+
+   performance_trace_escape(escaped, sizeof(escaped), name);
+
+#ifdef HAVE_THREADS
+   slock_lock(perf_trace_lock);
+#endif
+
+   if (!perf_trace_file)
+      goto end;
+
+   ts -= perf_trace_start;
+   tid = performance_trace_tid();
+
+   /* Events from before the trace started are cut at its start */
+   if (ts < 0)
+   {
+      duration += ts;
+      ts        = 0;
+      if (duration < 0)
+         duration = 0;
+   }
+
+   switch (ph)
+   {
+      case 'B':
+         len = snprintf(event, sizeof(event),
+               ",\n{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%lld,"
+               "\"pid\":1,\"tid\":%u}", escaped, ts, tid);
+         break;
+      case 'E':
+         len = snprintf(event, sizeof(event),
+               ",\n{\"ph\":\"E\",\"ts\":%lld,\"pid\":1,\"tid\":%u}",
+               ts, tid);
+         break;
+      case 'X':
+         len = snprintf(event, sizeof(event),
+               ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,"
+               "\"dur\":%lld,\"pid\":1,\"tid\":%u}",
+               escaped, ts, (long long)duration, tid);
+         break;
+      case 'i':
+         len = snprintf(event, sizeof(event),
+               ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+               "\"ts\":%lld,\"pid\":1,\"tid\":%u}", escaped, ts, tid);
+         break;
+      default: /* Thread name */
+         len = snprintf(event, sizeof(event),
+               ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+               "\"tid\":%u,\"args\":{\"name\":\"%s\"}}", tid, escaped);
+         break;
+   }
+
+   if (len <= 0 || (size_t)len >= sizeof(event))
+      goto end;
+
+   if (perf_trace_size + len > PERF_TRACE_BUFFER_SIZE)
+   {
+      filestream_write(perf_trace_file, perf_trace_buffer, perf_trace_size);
+      perf_trace_size = 0;
+   }
+
+   memcpy(perf_trace_buffer + perf_trace_size, event, len);
+   perf_trace_size += len;
+
+end:
+#ifdef HAVE_THREADS
+   slock_unlock(perf_trace_lock);
+#endif
+   return;
+}
+
+static void performance_trace_event(char ph, const char *name)
+{
+   performance_trace_write(ph, name, cpu_features_get_time_usec(), 0);
+}
+
+static void performance_trace_task(retro_task_t *task, bool begin)
+{
+   if (begin)
+   {
+      char name[128];
+      const char *title = task_get_title(task);
+
+      snprintf(name, sizeof(name), "task: %s", title ? title : "");
+      performance_trace_begin(name);
+   }
+   else
+      performance_trace_end();
+}
+
+bool performance_trace_init(const char *path)
+{
+   static const char header[] = "[\n{\"name\":\"process_name\",\"ph\":\"M\","
+      "\"pid\":1,\"args\":{\"name\":\"RetroArch\"}}";
+
+   performance_trace_deinit();
+
+#ifdef HAVE_THREADS
+   if (!perf_trace_lock && !(perf_trace_lock = slock_new()))
+      return false;
+#ifdef HAVE_THREAD_STORAGE
+   if (!perf_trace_tid_created)
+   {
+      if (!sthread_tls_create(&perf_trace_tid))
+         return false;
+      perf_trace_tid_created = true;
+   }
+#endif
+#endif
+
+   if (!perf_trace_buffer)
+      perf_trace_buffer = (char*)malloc(PERF_TRACE_BUFFER_SIZE);
+   if (!perf_trace_buffer)
+      return false;
+
+   perf_trace_file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!perf_trace_file)
+   {
+      RARCH_ERR("[PERF]: Could not open trace file \"%s\".\n", path);
+      return false;
+   }
+
+   memcpy(perf_trace_buffer, header, sizeof(header) - 1);
+   perf_trace_size    = sizeof(header) - 1;
+   perf_trace_start   = cpu_features_get_time_usec();
+   perf_trace_enabled = true;
+
+   performance_trace_thread("main");
+   task_queue_set_trace(performance_trace_task);
+
+   RARCH_LOG("[PERF]: Writing trace to \"%s\".\n", path);
+   return true;
+}
+
+void performance_trace_deinit(void)
+{
+   if (!perf_trace_enabled)
+      return;
+
+   task_queue_set_trace(NULL);
+   perf_trace_enabled = false;
+
+#ifdef HAVE_THREADS
+   slock_lock(perf_trace_lock);
+#endif
+   filestream_write(perf_trace_file, perf_trace_buffer, perf_trace_size);
+   filestream_write(perf_trace_file, "\n]\n", 3);
+   filestream_close(perf_trace_file);
+   perf_trace_file = NULL;
+   perf_trace_size = 0;
+#ifdef HAVE_THREADS
+   slock_unlock(perf_trace_lock);
+#endif
+}
+
+void performance_trace_begin(const char *name)
+{
+   if (perf_trace_enabled)
+      performance_trace_event('B', name);
+}
+
+void performance_trace_end(void)
+{
+   if (perf_trace_enabled)
+      performance_trace_event('E', NULL);
+}
+
+void performance_trace_complete(const char *name,
+      retro_time_t start, retro_time_t duration)
+{
+   if (perf_trace_enabled)
+      performance_trace_write('X', name, start, duration);
+}
+
+void performance_trace_thread(const char *name)
+{
+   if (perf_trace_enabled)
+      performance_trace_event('M', name);
+}
+
+void performance_zones_frame(bool force)
+{
+   unsigned i;
+   retro_time_t now = 0;
+   bool active      = force
+      || rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL);
+
+   if (perf_trace_enabled)
+      performance_trace_event('i', "frame");
+
+   if (active && !perf_zones_active)
+   {
+      memset(perf_zones, 0, sizeof(perf_zones));
+      perf_zones_frame_start = 0;
+      perf_zones_frame_ptr   = 0;
+      perf_zones_frame_count = 0;
+      perf_zones_entered     = false;
+   }
+
+   perf_zones_active = active;
+   perf_zone_depth   = 0;
+
+   if (!active)
+      return;
+
+   now = cpu_features_get_time_usec();
+
+   /* Iterations which didn't do anything (paused, sleeping)
+    * don't count as frames. The frame time is the interval
+    * since the last iteration, so it includes frame limiting. */
+   if (perf_zones_entered)
+   {
+      perf_zone_stats_t *frame = &perf_zones[PERF_ZONE_FRAME];
+
+      frame->history[perf_zones_frame_ptr] = perf_zones_frame_start
+         ? (uint32_t)MIN(now - perf_zones_frame_start, PERF_ZONE_UNUSED - 1)
+         : PERF_ZONE_UNUSED;
+      frame->seen = true;
+
+      for (i = PERF_ZONE_FRAME + 1; i < PERF_ZONE_LAST; i++)
+      {
+         perf_zone_stats_t *stats = &perf_zones[i];
+
+         stats->history[perf_zones_frame_ptr] = stats->entered
+            ? (uint32_t)MIN(stats->frame_time, PERF_ZONE_UNUSED - 1)
+            : PERF_ZONE_UNUSED;
+         stats->frame_time = 0;
+         stats->entered    = false;
+      }
+
+      perf_zones_frame_ptr = (perf_zones_frame_ptr + 1) % PERF_ZONE_HISTORY;
+      if (perf_zones_frame_count < PERF_ZONE_HISTORY)
+         perf_zones_frame_count++;
+   }
+
+   perf_zones_frame_start = now;
+   perf_zones_entered     = false;
+}
+
+void performance_zone_begin(enum perf_zone zone)
+{
+   if (perf_trace_enabled)
+      performance_trace_event('B', perf_zone_idents[zone]);
+
+   if (!perf_zones_active)
+      return;
+
+   /* Zones nested too deeply are only counted, so that the
+    * matching ends still line up. */
+   if (perf_zone_depth < PERF_ZONE_STACK)
+   {
+      perf_zone_stats_t *stats = &perf_zones[zone];
+
+      if (!stats->seen)
+      {
+         stats->parent = perf_zone_depth
+            ? perf_zone_stack[perf_zone_depth - 1].zone
+            : PERF_ZONE_FRAME;
+         stats->seen   = true;
+      }
+
+      perf_zone_stack[perf_zone_depth].zone  = zone;
+      perf_zone_stack[perf_zone_depth].start = cpu_features_get_time_usec();
+   }
+
+   perf_zone_depth++;
+}
+
+void performance_zone_end(enum perf_zone zone)
+{
+   if (perf_trace_enabled)
+      performance_trace_event('E', NULL);
+
+   if (!perf_zones_active || !perf_zone_depth)
+      return;
+
+   if (     --perf_zone_depth < PERF_ZONE_STACK
+         && perf_zone_stack[perf_zone_depth].zone == zone)
+   {
+      perf_zone_stats_t *stats = &perf_zones[zone];
+
+      stats->frame_time += cpu_features_get_time_usec()
+         - perf_zone_stack[perf_zone_depth].start;
+      stats->entered     = true;
+      perf_zones_entered = true;
+   }
+}
+
+void performance_gpu_passes_submit(const char *const *names,
+      const uint32_t *times_us, unsigned count)
+{
+   unsigned i;
+
+   if (count > PERF_GPU_PASSES)
+      count = PERF_GPU_PASSES;
+
+#ifdef HAVE_THREADS
+   if (!perf_gpu_passes_lock)
+      perf_gpu_passes_lock = slock_new();
+   if (perf_gpu_passes_lock)
+      slock_lock(perf_gpu_passes_lock);
+#endif
+
+   /* Start over when the chain changed shape */
+   if (count != perf_gpu_pass_count)
+   {
+      perf_gpu_pass_count = count;
+      for (i = 0; i < count; i++)
+         perf_gpu_passes[i].time_us = (float)times_us[i];
+   }
+   else
+   {
+      for (i = 0; i < count; i++)
+         perf_gpu_passes[i].time_us +=
+            ((float)times_us[i] - perf_gpu_passes[i].time_us)
+            / PERF_GPU_PASS_SMOOTHING;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      const char *name = names ? names[i] : NULL;
+
+      if (!string_is_empty(name))
+         strlcpy(perf_gpu_passes[i].name, name,
+               sizeof(perf_gpu_passes[i].name));
+      else
+         snprintf(perf_gpu_passes[i].name,
+               sizeof(perf_gpu_passes[i].name), "Pass #%u", i);
+   }
+
+   perf_gpu_passes_time = cpu_features_get_time_usec();
+
+#ifdef HAVE_THREADS
+   if (perf_gpu_passes_lock)
+      slock_unlock(perf_gpu_passes_lock);
+#endif
+}
+
+unsigned performance_gpu_passes_get(perf_gpu_pass_t *out, unsigned len)
+{
+   unsigned count = 0;
+
+#ifdef HAVE_THREADS
+   if (!perf_gpu_passes_lock)
+      return 0;
+   slock_lock(perf_gpu_passes_lock);
+#endif
+
+   if (perf_gpu_pass_count &&
+         cpu_features_get_time_usec() - perf_gpu_passes_time < 1000000)
+   {
+      count = MIN(len, perf_gpu_pass_count);
+      memcpy(out, perf_gpu_passes, count * sizeof(*out));
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(perf_gpu_passes_lock);
+#endif
+
+   return count;
+}
+
+void performance_gpu_passes_clear(void)
+{
+#ifdef HAVE_THREADS
+   if (perf_gpu_passes_lock)
+      slock_lock(perf_gpu_passes_lock);
+#endif
+
+   perf_gpu_pass_count = 0;
+
+#ifdef HAVE_THREADS
+   if (perf_gpu_passes_lock)
+      slock_unlock(perf_gpu_passes_lock);
+#endif
+}
+
+static void performance_gpu_passes_log(FILE *out)
+{
+   unsigned i;
+   perf_gpu_pass_t passes[PERF_GPU_PASSES];
+   unsigned count = performance_gpu_passes_get(passes, PERF_GPU_PASSES);
+
+   if (!count)
+      return;
+
+   if (out)
+      fprintf(out, "GPU shader passes:\n");
+   else
+      RARCH_LOG("[PERF]: GPU shader passes:\n");
+
+   for (i = 0; i < count; i++)
+   {
+      if (out)
+         fprintf(out, "  %s: %.1f us.\n",
+               passes[i].name, passes[i].time_us);
+      else
+         RARCH_LOG("[PERF]:   %s: %.1f us.\n",
+               passes[i].name, passes[i].time_us);
+   }
+}
+
+static int performance_zones_compare(const void *a, const void *b)
+{
+   uint32_t x = *(const uint32_t*)a;
+   uint32_t y = *(const uint32_t*)b;
+   return (x > y) - (x < y);
+}
+
+static void performance_zones_log_zone(enum perf_zone zone,
+      unsigned depth, FILE *out)
+{
+   char line[256];
+   unsigned i;
+   static uint32_t sorted[PERF_ZONE_HISTORY];
+   const perf_zone_stats_t *stats = &perf_zones[zone];
+   unsigned count                 = 0;
+
+   for (i = 0; i < perf_zones_frame_count; i++)
+      if (stats->history[i] != PERF_ZONE_UNUSED)
+         sorted[count++] = stats->history[i];
+
+   if (!count)
+      return;
+
+   qsort(sorted, count, sizeof(*sorted), performance_zones_compare);
+
+   snprintf(line, sizeof(line),
+         "%*s%s: p50 %u us, p99 %u us, max %u us (%u/%u frames).\n",
+         depth * 2, "",
+         perf_zone_idents[zone],
+         (unsigned)sorted[(count - 1) / 2],
+         (unsigned)sorted[(count - 1) * 99 / 100],
+         (unsigned)sorted[count - 1],
+         count, perf_zones_frame_count);
+
+   if (out)
+      fprintf(out, "  %s", line);
+   else
+      RARCH_LOG("[PERF]: %s", line);
+
+   for (i = PERF_ZONE_FRAME + 1; i < PERF_ZONE_LAST; i++)
+      if (perf_zones[i].seen && perf_zones[i].parent == zone)
+         performance_zones_log_zone((enum perf_zone)i, depth + 1, out);
+}
+
+unsigned performance_zone_history(enum perf_zone zone, bool exclusive,
+      uint32_t *out, unsigned len)
+{
+   unsigned i, j;
+   unsigned count = MIN(len, perf_zones_frame_count);
+   unsigned start = (perf_zones_frame_ptr + PERF_ZONE_HISTORY - count)
+      % PERF_ZONE_HISTORY;
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned index = (start + i) % PERF_ZONE_HISTORY;
+      uint32_t time  = perf_zones[zone].history[index];
+
+      if (time == PERF_ZONE_UNUSED)
+         time = 0;
+      else if (exclusive)
+      {
+         for (j = PERF_ZONE_FRAME + 1; j < PERF_ZONE_LAST; j++)
+         {
+            uint32_t nested;
+
+            if (     j == (unsigned)zone
+                  || !perf_zones[j].seen
+                  || perf_zones[j].parent != zone)
+               continue;
+
+            nested = perf_zones[j].history[index];
+            if (nested != PERF_ZONE_UNUSED)
+               time = nested < time ? time - nested : 0;
+         }
+      }
+
+      out[i] = time;
+   }
+
+   return count;
+}
+
+const char *performance_zone_ident(enum perf_zone zone)
+{
+   return perf_zone_idents[zone];
+}
+
+void performance_zones_print(FILE *out)
+{
+   if (!perf_zones_frame_count)
+      return;
+
+   fprintf(out, "Frame zones, last %u frames:\n", perf_zones_frame_count);
+   performance_zones_log_zone(PERF_ZONE_FRAME, 0, out);
+   performance_gpu_passes_log(out);
+}
+
 static void log_counters(struct retro_perf_counter **counters, unsigned num)
 {
    unsigned i;
@@ -112,6 +726,15 @@ void rarch_perf_log(void)
 
    RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
    log_counters(perf_counters_rarch, perf_ptr_rarch);
+
+   if (perf_zones_frame_count)
+   {
+      RARCH_LOG("[PERF]: Frame zones, last %u frames:\n",
+            perf_zones_frame_count);
+      performance_zones_log_zone(PERF_ZONE_FRAME, 0, NULL);
+   }
+
+   performance_gpu_passes_log(NULL);
 }
 
 void retro_perf_log(void)
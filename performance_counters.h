@@ -17,6 +17,7 @@
 #ifndef _PERFORMANCE_COUNTERS_H
 #define _PERFORMANCE_COUNTERS_H
 
+#include <stdio.h>
 #include <stdint.h>
 #include <boolean.h>
 
@@ -57,6 +58,162 @@ void rarch_perf_log(void);
 
 void rarch_perf_register(struct retro_perf_counter *perf);
 
+/* Zones of the frame profiler. Zones nest, each one is shown
+ * below the zone it was first entered from. */
+enum perf_zone
+{
+   PERF_ZONE_FRAME = 0,
+   PERF_ZONE_CORE_RUN,
+   PERF_ZONE_INPUT_POLL,
+   PERF_ZONE_VIDEO_FRAME,
+   PERF_ZONE_AUDIO_FLUSH,
+   PERF_ZONE_MENU_RENDER,
+   PERF_ZONE_LAST
+};
+
+/* Number of frames the profiler keeps the zone times of. */
+#ifndef PERF_ZONE_HISTORY
+#define PERF_ZONE_HISTORY 512
+#endif
+
+/**
+ * performance_zones_frame:
+ * @force              : profile even with performance
+ *                       counters disabled
+ *
+ * Ends the current frame of the frame profiler. To be called
+ * once per runloop iteration, from the main thread.
+ **/
+void performance_zones_frame(bool force);
+
+/**
+ * performance_zone_begin:
+ * @zone               : zone being entered
+ *
+ * Starts timing @zone, does nothing unless performance
+ * counters are enabled. Zones are main thread only.
+ **/
+void performance_zone_begin(enum perf_zone zone);
+
+/**
+ * performance_zone_end:
+ * @zone               : zone being left
+ *
+ * Stops timing @zone, adding the time to the current frame.
+ **/
+void performance_zone_end(enum perf_zone zone);
+
+/**
+ * performance_zone_history:
+ * @zone               : zone to get the times of
+ * @exclusive          : leave out the time spent in zones
+ *                       nested in @zone
+ * @out                : per frame times in microseconds,
+ *                       oldest first, 0 where @zone wasn't entered
+ * @len                : maximum number of frames to return
+ *
+ * Returns: number of frames written to @out.
+ **/
+unsigned performance_zone_history(enum perf_zone zone, bool exclusive,
+      uint32_t *out, unsigned len);
+
+/* Short lowercase name of @zone, as used in traces. */
+const char *performance_zone_ident(enum perf_zone zone);
+
+/**
+ * performance_zones_print:
+ * @out                : stream to print to
+ *
+ * Prints the zone statistics of the recorded frames,
+ * like rarch_perf_log() but regardless of verbosity.
+ **/
+void performance_zones_print(FILE *out);
+
+/* Most shader passes the GPU pass timings are kept for. */
+#define PERF_GPU_PASSES 32
+
+typedef struct perf_gpu_pass
+{
+   char name[64];
+   float time_us;    /* Moving average, in microseconds */
+} perf_gpu_pass_t;
+
+/**
+ * performance_gpu_passes_submit:
+ * @names              : name of each pass, entries or the
+ *                       array itself may be NULL
+ * @times_us           : GPU time each pass took, in microseconds
+ * @count              : number of passes
+ *
+ * Adds the GPU timings of one frame of the shader chain, as read
+ * back by the video driver. May be called from the video thread.
+ **/
+void performance_gpu_passes_submit(const char *const *names,
+      const uint32_t *times_us, unsigned count);
+
+/**
+ * performance_gpu_passes_get:
+ * @out                : averaged timings of each pass
+ * @len                : maximum number of passes to return
+ *
+ * Returns: number of passes written to @out, 0 if the video
+ * driver hasn't submitted any timings in the last second.
+ **/
+unsigned performance_gpu_passes_get(perf_gpu_pass_t *out, unsigned len);
+
+/* Forgets the timings, when the shader chain goes away. */
+void performance_gpu_passes_clear(void);
+
+/**
+ * performance_trace_init:
+ * @path               : file to write the trace to
+ *
+ * Starts writing zone, thread and task events to @path in the
+ * Chrome trace event format, to be loaded in chrome://tracing
+ * or Perfetto.
+ *
+ * Returns: true if the trace file could be opened.
+ **/
+bool performance_trace_init(const char *path);
+
+/**
+ * performance_trace_deinit:
+ *
+ * Finishes and closes the trace file, if any.
+ **/
+void performance_trace_deinit(void);
+
+/**
+ * performance_trace_begin:
+ * @name               : name of the event
+ *
+ * Opens an event on the calling thread, which lasts until the
+ * matching performance_trace_end(). May be called from any thread.
+ **/
+void performance_trace_begin(const char *name);
+
+void performance_trace_end(void);
+
+/**
+ * performance_trace_complete:
+ * @name               : name of the event
+ * @start              : start time, from cpu_features_get_time_usec()
+ * @duration           : length in microseconds
+ *
+ * Adds an event that has already ended to the calling thread.
+ * The part from before the trace was started is left out.
+ **/
+void performance_trace_complete(const char *name,
+      retro_time_t start, retro_time_t duration);
+
+/**
+ * performance_trace_thread:
+ * @name               : name of the calling thread
+ *
+ * Names the calling thread in the trace.
+ **/
+void performance_trace_thread(const char *name);
+
 #define performance_counter_init(perf, name) \
    perf.ident = name; \
    if (!perf.registered) \
@@ -284,7 +284,11 @@ $(function() {
       $('#icnRun').addClass('fa-play');
       $('#lblDrop').removeClass('active');
       $('#lblLocal').addClass('active');
-      idbfsInit();
+      // OPFS builds mount userdata themselves, see platform_emscripten.c
+      if (Module['opfs'])
+         preLoadingComplete();
+      else
+         idbfsInit();
    });
  });
 
@@ -15,17 +15,28 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <libretro.h>
 #include <boolean.h>
+#include <memmap.h>
 #include <compat/posix_string.h>
+#include <compat/strl.h>
 #include <string/stdstring.h>
+#include <string/string_pool.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
 #include <file/file_path.h>
 
+#ifdef HAVE_MMAN
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
 #include "playlist.h"
 #include "verbosity.h"
 
@@ -33,24 +44,59 @@
 #define PLAYLIST_ENTRIES 6
 #endif
 
+/* Binary copy of a playlist, written next to it, that
+ * playlist_init() loads instead of parsing the text file as
+ * long as the playlist's size and modification time still
+ * match the ones recorded in the header. All fields are in
+ * host byte order; 'version' doubles as the byte order check.
+ *
+ * The header is followed by 'count' entries, each made of the
+ * path hash, the lengths of the PLAYLIST_ENTRIES strings
+ * (PLAYLIST_CACHE_NULL for unset ones) and then the strings
+ * themselves, without terminators. */
+#define PLAYLIST_CACHE_EXTENSION ".cache"
+#define PLAYLIST_CACHE_MAGIC     "RAPLCACH"
+#define PLAYLIST_CACHE_VERSION   1
+#define PLAYLIST_CACHE_NULL      0xffffffffu
+
+typedef struct playlist_cache_header
+{
+   char magic[8];
+   uint32_t version;
+   uint32_t count;
+   int64_t lpl_mtime;
+   int64_t lpl_size;
+} playlist_cache_header_t;
+
 struct playlist_entry
 {
    char *path;
    char *label;
-   char *core_path;
-   char *core_name;
-   char *db_name;
-   char *crc32;
+   /* Interned in the playlist strings pool */
+   const char *core_path;
+   const char *core_name;
+   const char *db_name;
+   const char *crc32;
+   uint32_t path_hash;
 };
 
 struct content_playlist
 {
    bool modified;
+   bool index_valid;
    size_t size;
    size_t cap;
+   size_t index_cap;
 
    char *conf_path;
    struct playlist_entry *entries;
+   /* Open addressing table of entry indices + 1, by path hash.
+    * Entries move around on every push, so it is rebuilt from
+    * the stored hashes on the first lookup after a change. */
+   uint32_t *index;
+   /* Most entries share a handful of cores and databases, so those
+    * fields are kept once per playlist and compared by pointer. */
+   string_pool_t *strings;
 };
 static playlist_t *playlist_cached = NULL;
 
@@ -58,6 +104,160 @@ typedef int (playlist_sort_fun_t)(
       const struct playlist_entry *a,
       const struct playlist_entry *b);
 
+/* Case is folded so that the case-insensitive duplicate check
+ * on Windows finds the same candidates. */
+static uint32_t playlist_path_hash(const char *path)
+{
+   uint32_t hash = 5381;
+
+   if (!path)
+      return 0;
+
+   while (*path)
+      hash = (hash << 5) + hash + (uint8_t)tolower((uint8_t)*path++);
+
+   return hash;
+}
+
+static bool playlist_index_build(playlist_t *playlist)
+{
+   size_t i;
+   size_t mask;
+   size_t cap = 16;
+
+   if (playlist->index_valid)
+      return true;
+
+   while (cap < playlist->size * 2)
+      cap <<= 1;
+
+   if (cap > playlist->index_cap)
+   {
+      free(playlist->index);
+      playlist->index_cap = 0;
+      playlist->index     = (uint32_t*)malloc(cap * sizeof(*playlist->index));
+
+      if (!playlist->index)
+         return false;
+
+      playlist->index_cap = cap;
+   }
+
+   mask = playlist->index_cap - 1;
+   memset(playlist->index, 0, playlist->index_cap * sizeof(*playlist->index));
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      size_t slot = playlist->entries[i].path_hash & mask;
+
+      while (playlist->index[slot])
+         slot = (slot + 1) & mask;
+
+      playlist->index[slot] = (uint32_t)(i + 1);
+   }
+
+   playlist->index_valid = true;
+   return true;
+}
+
+static bool playlist_entry_matches(const struct playlist_entry *entry,
+      const char *path, const char *core_path, bool noncase)
+{
+   if (!path || !entry->path)
+   {
+      if (path || entry->path)
+         return false;
+   }
+   else if (noncase)
+   {
+      if (!string_is_equal_noncase(path, entry->path))
+         return false;
+   }
+   else if (!string_is_equal(path, entry->path))
+      return false;
+
+   return !core_path || entry->core_path == core_path;
+}
+
+/* Finds the first entry for 'path' (and 'core_path', if set). */
+static bool playlist_find_entry(playlist_t *playlist,
+      const char *path, const char *core_path, bool noncase,
+      size_t *idx)
+{
+   size_t i;
+   bool found = false;
+
+   /* A core path no entry uses isn't in the pool */
+   if (core_path && !(core_path = string_pool_find(
+               playlist->strings, core_path)))
+      return false;
+
+   if (playlist_index_build(playlist))
+   {
+      uint32_t hash = playlist_path_hash(path);
+      size_t mask   = playlist->index_cap - 1;
+
+      for (i = hash & mask; playlist->index[i]; i = (i + 1) & mask)
+      {
+         size_t j                           = playlist->index[i] - 1;
+         const struct playlist_entry *entry = &playlist->entries[j];
+
+         if (     entry->path_hash == hash
+               && (!found || j < *idx)
+               && playlist_entry_matches(entry, path, core_path, noncase))
+         {
+            *idx  = j;
+            found = true;
+         }
+      }
+
+      return found;
+   }
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      if (playlist_entry_matches(&playlist->entries[i],
+               path, core_path, noncase))
+      {
+         *idx = i;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/**
+ * playlist_free_entry:
+ * @playlist            : Playlist handle.
+ * @entry               : Playlist entry handle.
+ *
+ * Frees playlist entry.
+ **/
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
+{
+   if (!entry)
+      return;
+
+   if (entry->path != NULL)
+      free(entry->path);
+   if (entry->label != NULL)
+      free(entry->label);
+
+   string_pool_release(playlist->strings, entry->core_path);
+   string_pool_release(playlist->strings, entry->core_name);
+   string_pool_release(playlist->strings, entry->db_name);
+   string_pool_release(playlist->strings, entry->crc32);
+
+   entry->path      = NULL;
+   entry->label     = NULL;
+   entry->core_path = NULL;
+   entry->core_name = NULL;
+   entry->db_name   = NULL;
+   entry->crc32     = NULL;
+}
+
 uint32_t playlist_get_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -116,14 +316,16 @@ void playlist_get_index(playlist_t *playlist,
 void playlist_delete_index(playlist_t *playlist,
       size_t idx)
 {
-   if (!playlist)
+   if (!playlist || idx >= playlist->size)
       return;
 
+   playlist_free_entry(playlist, &playlist->entries[idx]);
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
-         (playlist->size - idx) * sizeof(struct playlist_entry));
+         (playlist->size - idx - 1) * sizeof(struct playlist_entry));
 
-   playlist->size     = playlist->size - 1;
-   playlist->modified = true;
+   playlist->size        = playlist->size - 1;
+   playlist->modified    = true;
+   playlist->index_valid = false;
 }
 
 void playlist_get_index_by_path(playlist_t *playlist,
@@ -134,28 +336,24 @@ void playlist_get_index_by_path(playlist_t *playlist,
       char **db_name)
 {
    size_t i;
-   if (!playlist)
+   if (!playlist || !search_path)
       return;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      if (!string_is_equal(playlist->entries[i].path, search_path))
-         continue;
+   if (!playlist_find_entry(playlist, search_path, NULL, false, &i))
+      return;
 
-      if (path)
-         *path      = playlist->entries[i].path;
-      if (label)
-         *label     = playlist->entries[i].label;
-      if (core_path)
-         *core_path = playlist->entries[i].core_path;
-      if (core_name)
-         *core_name = playlist->entries[i].core_name;
-      if (db_name)
-         *db_name   = playlist->entries[i].db_name;
-      if (crc32)
-         *crc32     = playlist->entries[i].crc32;
-      break;
-   }
+   if (path)
+      *path      = playlist->entries[i].path;
+   if (label)
+      *label     = playlist->entries[i].label;
+   if (core_path)
+      *core_path = (char*)playlist->entries[i].core_path;
+   if (core_name)
+      *core_name = (char*)playlist->entries[i].core_name;
+   if (db_name)
+      *db_name   = (char*)playlist->entries[i].db_name;
+   if (crc32)
+      *crc32     = (char*)playlist->entries[i].crc32;
 }
 
 bool playlist_entry_exists(playlist_t *playlist,
@@ -163,46 +361,26 @@ bool playlist_entry_exists(playlist_t *playlist,
       const char *crc32)
 {
    size_t i;
-   if (!playlist)
+   if (!playlist || !path)
       return false;
 
-   for (i = 0; i < playlist->size; i++)
-      if (string_is_equal(playlist->entries[i].path, path))
-         return true;
-
-   return false;
+   return playlist_find_entry(playlist, path, NULL, false, &i);
 }
 
-/**
- * playlist_free_entry:
- * @entry               : Playlist entry handle.
- *
- * Frees playlist entry.
- **/
-static void playlist_free_entry(struct playlist_entry *entry)
+/* The new string is interned before the old one is released,
+ * 'str' may be the pooled string itself. */
+static bool playlist_update_string(playlist_t *playlist,
+      const char **field, const char *str)
 {
-   if (!entry)
-      return;
+   const char *old = *field;
 
-   if (entry->path != NULL)
-      free(entry->path);
-   if (entry->label != NULL)
-      free(entry->label);
-   if (entry->core_path != NULL)
-      free(entry->core_path);
-   if (entry->core_name != NULL)
-      free(entry->core_name);
-   if (entry->db_name != NULL)
-      free(entry->db_name);
-   if (entry->crc32 != NULL)
-      free(entry->crc32);
+   if (!str || str == old)
+      return false;
 
-   entry->path      = NULL;
-   entry->label     = NULL;
-   entry->core_path = NULL;
-   entry->core_name = NULL;
-   entry->db_name   = NULL;
-   entry->crc32     = NULL;
+   *field = string_pool_intern(playlist->strings, str);
+   string_pool_release(playlist->strings, old);
+
+   return *field != old;
 }
 
 void playlist_update(playlist_t *playlist, size_t idx,
@@ -222,8 +400,10 @@ void playlist_update(playlist_t *playlist, size_t idx,
    {
       if (entry->path != NULL)
          free(entry->path);
-      entry->path        = strdup(path);
-      playlist->modified = true;
+      entry->path           = strdup(path);
+      entry->path_hash      = playlist_path_hash(entry->path);
+      playlist->modified    = true;
+      playlist->index_valid = false;
    }
 
    if (label && (label != entry->label))
@@ -234,38 +414,14 @@ void playlist_update(playlist_t *playlist, size_t idx,
       playlist->modified = true;
    }
 
-   if (core_path && (core_path != entry->core_path))
-   {
-      if (entry->core_path != NULL)
-         free(entry->core_path);
-      entry->core_path   = NULL;
-      entry->core_path   = strdup(core_path);
+   if (playlist_update_string(playlist, &entry->core_path, core_path))
       playlist->modified = true;
-   }
-
-   if (core_name && (core_name != entry->core_name))
-   {
-      if (entry->core_name != NULL)
-         free(entry->core_name);
-      entry->core_name   = strdup(core_name);
+   if (playlist_update_string(playlist, &entry->core_name, core_name))
       playlist->modified = true;
-   }
-
-   if (db_name && (db_name != entry->db_name))
-   {
-      if (entry->db_name != NULL)
-         free(entry->db_name);
-      entry->db_name     = strdup(db_name);
+   if (playlist_update_string(playlist, &entry->db_name, db_name))
       playlist->modified = true;
-   }
-
-   if (crc32 && (crc32 != entry->crc32))
-   {
-      if (entry->crc32 != NULL)
-         free(entry->crc32);
-      entry->crc32       = strdup(crc32);
+   if (playlist_update_string(playlist, &entry->crc32, crc32))
       playlist->modified = true;
-   }
 }
 
 /**
@@ -309,28 +465,16 @@ bool playlist_push(playlist_t *playlist,
    if (!playlist)
       return false;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry tmp;
-      bool equal_path;
-
-      equal_path = (!path && !playlist->entries[i].path) ||
-         (path && playlist->entries[i].path &&
+   /* Core name can have changed while still being the same core.
+    * Differentiate based on the core path only. */
 #ifdef _WIN32
-          /*prevent duplicates on case-insensitive operating systems*/
-          string_is_equal_noncase(path,playlist->entries[i].path)
+   /*prevent duplicates on case-insensitive operating systems*/
+   if (playlist_find_entry(playlist, path, core_path, true, &i))
 #else
-          string_is_equal(path,playlist->entries[i].path)
+   if (playlist_find_entry(playlist, path, core_path, false, &i))
 #endif
-          );
-
-      /* Core name can have changed while still being the same core.
-       * Differentiate based on the core path only. */
-      if (!equal_path)
-         continue;
-
-      if (!string_is_equal(playlist->entries[i].core_path, core_path))
-         continue;
+   {
+      struct playlist_entry tmp;
 
       /* If top entry, we don't want to push a new entry since
        * the top and the entry to be pushed are the same. */
@@ -351,7 +495,7 @@ bool playlist_push(playlist_t *playlist,
       struct playlist_entry *entry = &playlist->entries[playlist->cap - 1];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
       playlist->size--;
    }
 
@@ -370,22 +514,284 @@ bool playlist_push(playlist_t *playlist,
          playlist->entries[0].path      = strdup(path);
       if (!string_is_empty(label))
          playlist->entries[0].label     = strdup(label);
-      if (!string_is_empty(core_path))
-         playlist->entries[0].core_path = strdup(core_path);
-      if (!string_is_empty(core_name))
-         playlist->entries[0].core_name = strdup(core_name);
+      playlist->entries[0].core_path    =
+         string_pool_intern(playlist->strings, core_path);
+      playlist->entries[0].core_name    =
+         string_pool_intern(playlist->strings, core_name);
       if (!string_is_empty(db_name))
-         playlist->entries[0].db_name   = strdup(db_name);
+         playlist->entries[0].db_name   =
+            string_pool_intern(playlist->strings, db_name);
       if (!string_is_empty(crc32))
-         playlist->entries[0].crc32     = strdup(crc32);
+         playlist->entries[0].crc32     =
+            string_pool_intern(playlist->strings, crc32);
+      playlist->entries[0].path_hash    =
+         playlist_path_hash(playlist->entries[0].path);
    }
 
    playlist->size++;
 
 success:
-   playlist->modified = true;
+   playlist->modified    = true;
+   playlist->index_valid = false;
+
+   return true;
+}
+
+static char *playlist_cache_path(const char *path)
+{
+   size_t len = strlen(path) + sizeof(PLAYLIST_CACHE_EXTENSION);
+   char *ret  = (char*)malloc(len);
+
+   if (ret)
+   {
+      strlcpy(ret, path, len);
+      strlcat(ret, PLAYLIST_CACHE_EXTENSION, len);
+   }
+
+   return ret;
+}
+
+static void playlist_write_cache(playlist_t *playlist)
+{
+   size_t i, j;
+   size_t len                     = sizeof(playlist_cache_header_t);
+   int64_t lpl_mtime              = path_get_mtime(playlist->conf_path);
+   uint8_t *buf                   = NULL;
+   uint8_t *out                   = NULL;
+   char *cache_path               = NULL;
+   playlist_cache_header_t header;
+
+   /* Without modification times there's no telling
+    * whether the cache is still current. */
+   if (lpl_mtime < 0)
+      return;
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      const char *fields[PLAYLIST_ENTRIES];
+      const struct playlist_entry *entry = &playlist->entries[i];
+
+      fields[0] = entry->path;
+      fields[1] = entry->label;
+      fields[2] = entry->core_path;
+      fields[3] = entry->core_name;
+      fields[4] = entry->crc32;
+      fields[5] = entry->db_name;
+
+      len += sizeof(uint32_t) * (PLAYLIST_ENTRIES + 1);
+      for (j = 0; j < PLAYLIST_ENTRIES; j++)
+         if (fields[j])
+            len += strlen(fields[j]);
+   }
+
+   if (!(cache_path = playlist_cache_path(playlist->conf_path)))
+      return;
+
+   if (!(buf = (uint8_t*)malloc(len)))
+   {
+      free(cache_path);
+      return;
+   }
+
+   memcpy(header.magic, PLAYLIST_CACHE_MAGIC, sizeof(header.magic));
+   header.version   = PLAYLIST_CACHE_VERSION;
+   header.count     = (uint32_t)playlist->size;
+   header.lpl_mtime = lpl_mtime;
+   header.lpl_size  = path_get_size(playlist->conf_path);
+
+   memcpy(buf, &header, sizeof(header));
+   out = buf + sizeof(header);
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      const char *fields[PLAYLIST_ENTRIES];
+      uint32_t lens[PLAYLIST_ENTRIES];
+      const struct playlist_entry *entry = &playlist->entries[i];
+
+      fields[0] = entry->path;
+      fields[1] = entry->label;
+      fields[2] = entry->core_path;
+      fields[3] = entry->core_name;
+      fields[4] = entry->crc32;
+      fields[5] = entry->db_name;
+
+      memcpy(out, &entry->path_hash, sizeof(uint32_t));
+      out += sizeof(uint32_t);
+
+      for (j = 0; j < PLAYLIST_ENTRIES; j++)
+         lens[j] = fields[j]
+            ? (uint32_t)strlen(fields[j]) : PLAYLIST_CACHE_NULL;
+
+      memcpy(out, lens, sizeof(lens));
+      out += sizeof(lens);
+
+      for (j = 0; j < PLAYLIST_ENTRIES; j++)
+      {
+         if (lens[j] == PLAYLIST_CACHE_NULL)
+            continue;
+         memcpy(out, fields[j], lens[j]);
+         out += lens[j];
+      }
+   }
+
+   if (!filestream_write_file(cache_path, buf, (int64_t)len))
+      RARCH_WARN("Failed to write playlist cache: %s\n", cache_path);
+
+   free(buf);
+   free(cache_path);
+}
+
+static char *playlist_cache_string(const uint8_t *data, uint32_t len)
+{
+   char *ret;
+
+   /* Same as the text format, which can't tell
+    * empty strings from unset ones. */
+   if (len == PLAYLIST_CACHE_NULL || !len)
+      return NULL;
+
+   if ((ret = (char*)malloc(len + 1)))
+   {
+      memcpy(ret, data, len);
+      ret[len] = '\0';
+   }
+
+   return ret;
+}
+
+static bool playlist_parse_cache(playlist_t *playlist,
+      const uint8_t *data, size_t len)
+{
+   size_t i, j;
+   size_t count;
+   size_t offset   = sizeof(playlist_cache_header_t);
+   int64_t lpl_mtime;
+   playlist_cache_header_t header;
+
+   if (len < sizeof(header))
+      return false;
+
+   memcpy(&header, data, sizeof(header));
+
+   if (     memcmp(header.magic, PLAYLIST_CACHE_MAGIC, sizeof(header.magic))
+         || header.version != PLAYLIST_CACHE_VERSION)
+      return false;
+
+   lpl_mtime = path_get_mtime(playlist->conf_path);
+
+   if (     lpl_mtime < 0
+         || header.lpl_mtime != lpl_mtime
+         || header.lpl_size  != path_get_size(playlist->conf_path))
+      return false;
+
+   count = header.count;
+   if (count > playlist->cap)
+      count = playlist->cap;
+
+   for (i = 0; i < count; i++)
+   {
+      uint32_t lens[PLAYLIST_ENTRIES];
+      const char *fields[PLAYLIST_ENTRIES];
+      struct playlist_entry *entry = &playlist->entries[i];
+
+      if (len - offset < sizeof(uint32_t) + sizeof(lens))
+         goto error;
+
+      memcpy(&entry->path_hash, data + offset, sizeof(uint32_t));
+      memcpy(lens, data + offset + sizeof(uint32_t), sizeof(lens));
+      offset += sizeof(uint32_t) + sizeof(lens);
+
+      for (j = 0; j < PLAYLIST_ENTRIES; j++)
+      {
+         if (lens[j] != PLAYLIST_CACHE_NULL && len - offset < lens[j])
+         {
+            while (j--)
+            {
+               if (j < 2)
+                  free((char*)fields[j]);
+               else
+                  string_pool_release(playlist->strings, fields[j]);
+            }
+            goto error;
+         }
+
+         if (j < 2)
+            fields[j] = playlist_cache_string(data + offset, lens[j]);
+         else if (lens[j] == PLAYLIST_CACHE_NULL || !lens[j])
+            fields[j] = NULL;
+         else
+            fields[j] = string_pool_intern_len(playlist->strings,
+                  (const char*)data + offset, lens[j]);
+
+         if (lens[j] != PLAYLIST_CACHE_NULL)
+            offset += lens[j];
+      }
+
+      entry->path      = (char*)fields[0];
+      entry->label     = (char*)fields[1];
+      entry->core_path = fields[2];
+      entry->core_name = fields[3];
+      entry->crc32     = fields[4];
+      entry->db_name   = fields[5];
+      playlist->size++;
+   }
 
    return true;
+
+error:
+   playlist_clear(playlist);
+   return false;
+}
+
+/* Loads the playlist from its cache, mapping the file where
+ * possible. Returns false if there's no usable cache. */
+static bool playlist_read_cache(playlist_t *playlist)
+{
+   bool ret         = false;
+   char *cache_path = playlist_cache_path(playlist->conf_path);
+
+   if (!cache_path)
+      return false;
+
+#ifdef HAVE_MMAN
+   {
+      struct stat st;
+      int fd = open(cache_path, O_RDONLY);
+
+      if (fd >= 0)
+      {
+         if (fstat(fd, &st) == 0 && st.st_size > 0)
+         {
+            void *map = mmap(NULL, (size_t)st.st_size,
+                  PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (map != MAP_FAILED)
+            {
+               ret = playlist_parse_cache(playlist,
+                     (const uint8_t*)map, (size_t)st.st_size);
+               munmap(map, (size_t)st.st_size);
+            }
+         }
+
+         close(fd);
+      }
+   }
+#else
+   {
+      void *buf   = NULL;
+      int64_t len = 0;
+
+      if (     path_is_valid(cache_path)
+            && filestream_read_file(cache_path, &buf, &len))
+         ret = playlist_parse_cache(playlist, (const uint8_t*)buf,
+               (size_t)len);
+
+      free(buf);
+   }
+#endif
+
+   free(cache_path);
+   return ret;
 }
 
 void playlist_write_file(playlist_t *playlist)
@@ -420,6 +826,8 @@ void playlist_write_file(playlist_t *playlist)
    RARCH_LOG("Written to playlist file: %s\n", playlist->conf_path);
 
    filestream_close(file);
+
+   playlist_write_cache(playlist);
 }
 
 /**
@@ -445,12 +853,18 @@ void playlist_free(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
 
    free(playlist->entries);
    playlist->entries = NULL;
 
+   free(playlist->index);
+   playlist->index   = NULL;
+
+   string_pool_free(playlist->strings);
+   playlist->strings = NULL;
+
    free(playlist);
 }
 
@@ -471,9 +885,10 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
-   playlist->size = 0;
+   playlist->size        = 0;
+   playlist->index_valid = false;
 }
 
 /**
@@ -540,12 +955,13 @@ static bool playlist_read_file(
       if (*buf[1])
          entry->label     = strdup(buf[1]);
 
-      entry->core_path    = strdup(buf[2]);
-      entry->core_name    = strdup(buf[3]);
+      entry->core_path    = string_pool_intern(playlist->strings, buf[2]);
+      entry->core_name    = string_pool_intern(playlist->strings, buf[3]);
       if (*buf[4])
-         entry->crc32     = strdup(buf[4]);
+         entry->crc32     = string_pool_intern(playlist->strings, buf[4]);
       if (*buf[5])
-         entry->db_name   = strdup(buf[5]);
+         entry->db_name   = string_pool_intern(playlist->strings, buf[5]);
+      entry->path_hash    = playlist_path_hash(entry->path);
       playlist->size++;
    }
 
@@ -601,13 +1017,32 @@ playlist_t *playlist_init(const char *path, size_t size)
       return NULL;
    }
 
-   playlist->modified  = false;
-   playlist->size      = 0;
-   playlist->cap       = size;
-   playlist->conf_path = strdup(path);
-   playlist->entries   = entries;
+   playlist->strings     = string_pool_new();
+   if (!playlist->strings)
+   {
+      free(entries);
+      free(playlist);
+      return NULL;
+   }
+
+   playlist->modified    = false;
+   playlist->index_valid = false;
+   playlist->size        = 0;
+   playlist->cap         = size;
+   playlist->index_cap   = 0;
+   playlist->conf_path   = strdup(path);
+   playlist->entries     = entries;
+   playlist->index       = NULL;
 
-   playlist_read_file(playlist, path);
+   if (!playlist_read_cache(playlist))
+   {
+      playlist_read_file(playlist, path);
+
+      /* A full playlist may have been cut short,
+       * and the cache has to hold all of it. */
+      if (playlist->size < playlist->cap)
+         playlist_write_cache(playlist);
+   }
 
    return playlist;
 }
@@ -629,4 +1064,5 @@ void playlist_qsort(playlist_t *playlist)
    qsort(playlist->entries, playlist->size,
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+   playlist->index_valid = false;
 }
@@ -265,6 +265,7 @@ check_pkgconf RSOUND rsound 1.1
 check_pkgconf ROAR libroar
 check_pkgconf JACK jack 0.120.1
 check_pkgconf PULSE libpulse
+check_pkgconf PIPEWIRE libpipewire-0.3 0.3.19
 check_pkgconf SDL sdl 1.2.10
 check_pkgconf SDL2 sdl2 2.0.0
 
@@ -536,6 +537,7 @@ check_val '' UDEV "-ludev"
 check_header XSHM X11/Xlib.h X11/extensions/XShm.h
 check_header PARPORT linux/parport.h
 check_header PARPORT linux/ppdev.h
+check_header IO_URING linux/io_uring.h
 
 if [ "$OS" != 'Win32' ] && [ "$OS" != 'Linux' ]; then
    check_lib '' STRL "$CLIB" strlcpy
@@ -589,6 +591,11 @@ if [ "$HAVE_ZLIB" = 'no' ] && [ "$HAVE_RPNG" != 'no' ]; then
    die : 'Notice: zlib is not available, RPNG will also be disabled.'
 fi
 
+if [ "$HAVE_THREADS" = 'no' ] && [ "$HAVE_PIPEWIRE" != 'no' ]; then
+   HAVE_PIPEWIRE=no
+   die : 'Notice: Threads are not available, PipeWire will also be disabled.'
+fi
+
 if [ "$HAVE_THREADS" = 'no' ] && [ "$HAVE_LIBUSB" != 'no' ]; then
    HAVE_LIBUSB=no
    die : 'Notice: Threads are not available, libusb will also be disabled.'
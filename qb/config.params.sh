@@ -88,6 +88,8 @@ HAVE_JACK=auto             # JACK support
 HAVE_COREAUDIO=auto        # CoreAudio support
 HAVE_PULSE=auto            # PulseAudio support
 C89_PULSE=no
+HAVE_PIPEWIRE=auto         # PipeWire support
+C89_PIPEWIRE=no
 HAVE_FREETYPE=auto         # FreeType support
 HAVE_STB_FONT=yes          # stb_truetype font support
 HAVE_STB_IMAGE=yes         # stb image loading support
@@ -108,6 +110,7 @@ HAVE_BUILTINFLAC=yes       # Bake in flac support
 HAVE_UPDATE_ASSETS=yes     # Disable downloading assets with online updater
 HAVE_PRESERVE_DYLIB=no     # Enable dlclose() for Valgrind support
 HAVE_PARPORT=auto          # Parallel port joypad support
+HAVE_IO_URING=auto         # io_uring nbio backend (Linux)
 HAVE_IMAGEVIEWER=yes       # Built-in image viewer support.
 HAVE_MMAP=auto             # MMAP support
 HAVE_QT=auto               # Qt companion support
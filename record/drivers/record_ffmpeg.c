@@ -19,8 +19,10 @@
 #include <stdlib.h>
 
 #include <retro_assert.h>
+#include <retro_miscellaneous.h>
 #include <compat/msvc.h>
 #include <compat/strl.h>
+#include <string/stdstring.h>
 
 #include <boolean.h>
 #include <queues/fifo_queue.h>
@@ -59,6 +61,13 @@ extern "C" {
 #include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 
+/* Device frame contexts (av_hwdevice_ctx_create() and friends) are only
+ * relied on from FFmpeg 4.0 onwards. */
+#if LIBAVUTIL_VERSION_MAJOR >= 56
+#define HAVE_FFMPEG_HWCONTEXT
+#include <libavutil/hwcontext.h>
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -109,6 +118,10 @@ extern "C" {
 #define PIX_FMT_RGB565 AV_PIX_FMT_RGB565
 #endif
 
+#ifndef PIX_FMT_NV12
+#define PIX_FMT_NV12 AV_PIX_FMT_NV12
+#endif
+
 #ifndef PIX_FMT_NONE
 #define PIX_FMT_NONE AV_PIX_FMT_NONE
 #endif
@@ -122,13 +135,26 @@ extern "C" {
 #define av_frame_free avcodec_free_frame
 #endif
 
+/* Default depth of the input queue, in frames. */
+#define MAX_FRAMES 32
+
+/* Frames the convert stage may get ahead of the encode stage. */
+#define FF_CONV_FRAMES 4
+
 struct ff_video_info
 {
    AVCodecContext *codec;
    AVCodec *encoder;
 
-   AVFrame *conv_frame;
-   uint8_t *conv_frame_buf;
+   /* Ring of converted frames, conv_read being the oldest one.
+    * A slot is only released once it has been encoded. */
+   AVFrame *conv_frames[FF_CONV_FRAMES];
+   uint8_t *conv_frame_bufs[FF_CONV_FRAMES];
+   unsigned conv_read;
+   unsigned conv_count;
+   /* Last slot written, dupes are copied from it. */
+   AVFrame *conv_prev;
+   /* Frames pushed so far, dropped ones included. */
    int64_t frame_cnt;
 
    uint8_t *outbuf;
@@ -150,6 +176,14 @@ struct ff_video_info
    struct scaler_ctx scaler;
    struct SwsContext *sws;
    bool use_sws;
+
+#ifdef HAVE_FFMPEG_HWCONTEXT
+   /* Set when the encoder only takes device frames (VA-API);
+    * conv_frames are uploaded into hw_frame before encoding. */
+   AVBufferRef *hw_device;
+   AVBufferRef *hw_frames;
+   AVFrame *hw_frame;
+#endif
 };
 
 struct ff_audio_info
@@ -204,9 +238,18 @@ struct ff_config_param
    char vcodec[64];
    char acodec[64];
    char format[64];
+   /* "auto" or one of the ffmpeg_hw_encoders identifiers. */
+   char hwaccel[64];
    enum PixelFormat out_pix_fmt;
    unsigned threads;
    unsigned frame_drop_ratio;
+   /* Input queue depth in frames. Once it is full push_video()
+    * either drops the frame or waits for the encoder. */
+   unsigned queue_depth;
+   bool drop_frames;
+   /* Packets go out as soon as they are encoded instead of being
+    * interleaved, and every write is flushed to the network. */
+   bool low_latency;
    unsigned sample_rate;
    float scale_factor;
 
@@ -223,28 +266,75 @@ struct ff_config_param
    AVDictionary *audio_opts;
 };
 
+struct ff_video_attr
+{
+   struct record_video_data vid;
+   int64_t pts;
+};
+
+/* Encoded packets are queued as this header followed by the data. */
+struct ff_packet_header
+{
+   int64_t pts;
+   int64_t dts;
+   int size;
+   int flags;
+   int stream_index;
+};
+
+struct ff_stats
+{
+   unsigned frames;
+   unsigned dropped;
+   /* High-water marks of the input (frames) and packet (bytes)
+    * queues. */
+   size_t queue_peak;
+   size_t packet_peak;
+};
+
 typedef struct ffmpeg
 {
    struct ff_video_info video;
    struct ff_audio_info audio;
    struct ff_muxer_info muxer;
+   /* Optional second output (params.mirror_filename) fed the same
+    * packets as muxer, ctx is NULL when unused. */
+   struct ff_muxer_info mirror;
    struct ff_config_param config;
 
    struct record_params params;
 
+   /* push_video() -> convert -> encode (+ audio) -> mux, one thread
+    * per stage. All the queues share the lock, cond is broadcast on
+    * every push and pop. */
    scond_t *cond;
-   slock_t *cond_lock;
    slock_t *lock;
    fifo_buffer_t *audio_fifo;
    fifo_buffer_t *video_fifo;
    fifo_buffer_t *attr_fifo;
-   sthread_t *thread;
+   fifo_buffer_t *packet_fifo;
+   sthread_t *convert_thread;
+   sthread_t *encode_thread;
+   sthread_t *mux_thread;
 
+   struct ff_stats stats;
+
+   /* Cleared one stage at a time on shutdown, upstream first, so
+    * nothing in flight is lost. */
    volatile bool alive;
-   volatile bool can_sleep;
+   volatile bool encode_alive;
+   volatile bool mux_alive;
 } ffmpeg_t;
 
-AVFormatContext *ctx;
+/* Any output wanting global headers gets them for all of them,
+ * MPEG-TS repeats them in-band anyway. */
+static bool ffmpeg_need_global_header(ffmpeg_t *handle)
+{
+   if (handle->muxer.ctx->oformat->flags & AVFMT_GLOBALHEADER)
+      return true;
+   return handle->mirror.ctx
+      && (handle->mirror.ctx->oformat->flags & AVFMT_GLOBALHEADER);
+}
 
 static bool ffmpeg_codec_has_sample_format(enum AVSampleFormat fmt,
       const enum AVSampleFormat *fmts)
@@ -388,7 +478,7 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
    /* Allow experimental codecs. */
    audio->codec->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
 
-   if (handle->muxer.ctx->oformat->flags & AVFMT_GLOBALHEADER)
+   if (ffmpeg_need_global_header(handle))
       audio->codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
    if (avcodec_open2(audio->codec, codec, params->audio_opts ? &params->audio_opts : NULL) != 0)
@@ -417,9 +507,228 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
    return true;
 }
 
+struct ff_hw_encoder
+{
+   const char *ident;
+   const char *h264;
+   const char *hevc;
+   /* Option the presets' x264 "crf" translates to, if any. */
+   const char *quality_opt;
+   /* Only takes device frames, i.e. needs an upload (VA-API). */
+   bool upload;
+};
+
+/* In the order "auto" tries them. All of them are fed NV12. */
+static const struct ff_hw_encoder ffmpeg_hw_encoders[] = {
+#ifdef __APPLE__
+   { "videotoolbox", "h264_videotoolbox", "hevc_videotoolbox", NULL,             false },
+#endif
+   { "nvenc",        "h264_nvenc",        "hevc_nvenc",        "cq",             false },
+   { "qsv",          "h264_qsv",          "hevc_qsv",          "global_quality", false },
+   { "vaapi",        "h264_vaapi",        "hevc_vaapi",        "qp",             true  },
+};
+
+static const struct ff_hw_encoder *ffmpeg_hw_encoder_by_name(const char *name)
+{
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(ffmpeg_hw_encoders); i++)
+   {
+      const struct ff_hw_encoder *hw = &ffmpeg_hw_encoders[i];
+      if (string_is_equal(name, hw->h264) || string_is_equal(name, hw->hevc))
+         return hw;
+   }
+
+   return NULL;
+}
+
+static AVCodecContext *ffmpeg_init_video_codec(ffmpeg_t *handle,
+      AVCodec *codec)
+{
+   struct ff_config_param *params  = &handle->config;
+   struct ff_video_info *video     = &handle->video;
+   struct record_params *param     = &handle->params;
+   AVCodecContext *avctx           = avcodec_alloc_context3(codec);
+
+   if (!avctx)
+      return NULL;
+
+   avctx->codec_type          = AVMEDIA_TYPE_VIDEO;
+   avctx->width               = param->out_width;
+   avctx->height              = param->out_height;
+   avctx->time_base           = av_d2q((double)
+         params->frame_drop_ratio /param->fps, 1000000); /* Arbitrary big number. */
+   avctx->sample_aspect_ratio = av_d2q(
+         param->aspect_ratio * param->out_height / param->out_width, 255);
+   avctx->pix_fmt             = video->pix_fmt;
+
+   avctx->thread_count        = params->threads;
+
+   if (params->video_qscale)
+   {
+      avctx->flags |= AV_CODEC_FLAG_QSCALE;
+      avctx->global_quality = params->video_global_quality;
+   }
+   else if (params->video_bit_rate)
+      avctx->bit_rate = params->video_bit_rate;
+
+   if (ffmpeg_need_global_header(handle))
+      avctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+   return avctx;
+}
+
+static void ffmpeg_free_video_codec(struct ff_video_info *video)
+{
+   if (video->codec)
+   {
+      avcodec_close(video->codec);
+      av_free(video->codec);
+      video->codec = NULL;
+   }
+
+#ifdef HAVE_FFMPEG_HWCONTEXT
+   av_frame_free(&video->hw_frame);
+   av_buffer_unref(&video->hw_frames);
+   av_buffer_unref(&video->hw_device);
+#endif
+}
+
+static bool ffmpeg_init_video_hw_frames(ffmpeg_t *handle)
+{
+#ifdef HAVE_FFMPEG_HWCONTEXT
+   AVHWFramesContext *frames;
+   struct ff_video_info *video = &handle->video;
+
+   if (av_hwdevice_ctx_create(&video->hw_device, AV_HWDEVICE_TYPE_VAAPI,
+            NULL, NULL, 0) < 0)
+      return false;
+
+   video->hw_frames = av_hwframe_ctx_alloc(video->hw_device);
+   if (!video->hw_frames)
+      return false;
+
+   frames                    = (AVHWFramesContext*)video->hw_frames->data;
+   frames->format            = AV_PIX_FMT_VAAPI;
+   frames->sw_format         = PIX_FMT_NV12;
+   frames->width             = handle->params.out_width;
+   frames->height            = handle->params.out_height;
+   /* Room for the encoder's reference and lookahead surfaces. */
+   frames->initial_pool_size = 20;
+
+   if (av_hwframe_ctx_init(video->hw_frames) < 0)
+      return false;
+
+   video->codec->pix_fmt       = AV_PIX_FMT_VAAPI;
+   video->codec->hw_frames_ctx = av_buffer_ref(video->hw_frames);
+   video->hw_frame             = av_frame_alloc();
+
+   return video->codec->hw_frames_ctx && video->hw_frame;
+#else
+   return false;
+#endif
+}
+
+static bool ffmpeg_open_video_hw(ffmpeg_t *handle,
+      const struct ff_hw_encoder *hw, AVCodec *codec)
+{
+   AVDictionaryEntry *crf;
+   AVDictionary *opts              = NULL;
+   struct ff_config_param *params  = &handle->config;
+   struct ff_video_info *video     = &handle->video;
+   enum PixelFormat pix_fmt        = video->pix_fmt;
+
+   /* Our own scaler has no YUV output, sws does the conversion. */
+   video->pix_fmt = PIX_FMT_NV12;
+   video->codec   = ffmpeg_init_video_codec(handle, codec);
+
+   if (!video->codec)
+      goto error;
+
+   /* Work on a copy, the software encoder gets the options
+    * untouched if this one fails to open. */
+   if (params->video_opts)
+      av_dict_copy(&opts, params->video_opts, 0);
+
+   /* None of these understand x264's rate control. */
+   if (hw->quality_opt && (crf = av_dict_get(opts, "crf", NULL, 0)))
+   {
+      char quality[16];
+      strlcpy(quality, crf->value, sizeof(quality));
+      av_dict_set(&opts, hw->quality_opt, quality, 0);
+   }
+
+   if (hw->upload && !ffmpeg_init_video_hw_frames(handle))
+      goto error;
+
+   if (avcodec_open2(video->codec, codec, &opts) != 0)
+      goto error;
+
+   av_dict_free(&opts);
+
+   video->encoder = codec;
+   video->use_sws = true;
+   return true;
+
+error:
+   av_dict_free(&opts);
+   ffmpeg_free_video_codec(video);
+   video->pix_fmt = pix_fmt;
+   return false;
+}
+
+/* Swaps the software H.264/HEVC encoder for the first hardware one
+ * out of ffmpeg_hw_encoders that opens. */
+static bool ffmpeg_init_video_hw(ffmpeg_t *handle)
+{
+   unsigned i;
+   bool hevc;
+   struct ff_config_param *params  = &handle->config;
+
+   /* libx264rgb is only ever used for lossless output, which none
+    * of the hardware encoders can match. */
+   if (     string_is_equal(params->vcodec, "libx264")
+         || string_is_equal(params->vcodec, "h264"))
+      hevc = false;
+   else if (string_is_equal(params->vcodec, "libx265")
+         || string_is_equal(params->vcodec, "hevc"))
+      hevc = true;
+   else
+      return false;
+
+   for (i = 0; i < ARRAY_SIZE(ffmpeg_hw_encoders); i++)
+   {
+      const struct ff_hw_encoder *hw = &ffmpeg_hw_encoders[i];
+      const char *name               = hevc ? hw->hevc : hw->h264;
+      AVCodec *codec                 = NULL;
+
+      if (     !string_is_equal(params->hwaccel, "auto")
+            && !string_is_equal(params->hwaccel, hw->ident))
+         continue;
+
+      codec = avcodec_find_encoder_by_name(name);
+      if (!codec)
+         continue;
+
+      if (ffmpeg_open_video_hw(handle, hw, codec))
+      {
+         RARCH_LOG("[FFmpeg]: Using hardware encoder %s.\n", name);
+         return true;
+      }
+
+      RARCH_WARN("[FFmpeg]: Cannot open hardware encoder %s.\n", name);
+   }
+
+   RARCH_WARN("[FFmpeg]: No hardware encoder for %s, keeping the software one.\n",
+         params->vcodec);
+   return false;
+}
+
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
+   unsigned i;
    size_t size;
+   const struct ff_hw_encoder *hw;
    struct ff_config_param *params  = &handle->config;
    struct ff_video_info *video     = &handle->video;
    struct record_params *param     = &handle->params;
@@ -441,8 +750,6 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
       return false;
    }
 
-   video->encoder = codec;
-
    /* Don't use swscaler unless format is not something "in-house" scaler
     * supports.
     *
@@ -500,39 +807,39 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
          return false;
    }
 
-   video->codec = avcodec_alloc_context3(codec);
-
    /* Useful to set scale_factor to 2 for chroma subsampled formats to
     * maintain full chroma resolution. (Or just use 4:4:4 or RGB ...)
     */
    param->out_width  = (float)param->out_width  * params->scale_factor;
    param->out_height = (float)param->out_height * params->scale_factor;
 
-   video->codec->codec_type          = AVMEDIA_TYPE_VIDEO;
-   video->codec->width               = param->out_width;
-   video->codec->height              = param->out_height;
-   video->codec->time_base           = av_d2q((double)
-         params->frame_drop_ratio /param->fps, 1000000); /* Arbitrary big number. */
-   video->codec->sample_aspect_ratio = av_d2q(
-         param->aspect_ratio * param->out_height / param->out_width, 255);
-   video->codec->pix_fmt             = video->pix_fmt;
+   /* Large recordings spend a good part of the frame in the
+    * scaler, split it over the same number of threads. */
+   video->scaler.threads = params->threads;
 
-   video->codec->thread_count = params->threads;
+   /* A hardware encoder named outright has no software one to fall
+    * back to, but still needs its frames uploaded. */
+   hw = ffmpeg_hw_encoder_by_name(codec->name);
 
-   if (params->video_qscale)
+   if (hw && hw->upload)
    {
-      video->codec->flags |= AV_CODEC_FLAG_QSCALE;
-      video->codec->global_quality = params->video_global_quality;
+      if (!ffmpeg_open_video_hw(handle, hw, codec))
+      {
+         RARCH_ERR("[FFmpeg]: Cannot open hardware encoder %s.\n",
+               codec->name);
+         return false;
+      }
    }
-   else if (params->video_bit_rate)
-      video->codec->bit_rate = params->video_bit_rate;
-
-   if (handle->muxer.ctx->oformat->flags & AVFMT_GLOBALHEADER)
-      video->codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+   else if (!*params->hwaccel || string_is_equal(params->hwaccel, "none")
+         || !ffmpeg_init_video_hw(handle))
+   {
+      video->encoder = codec;
+      video->codec   = ffmpeg_init_video_codec(handle, codec);
 
-   if (avcodec_open2(video->codec, codec, params->video_opts ?
-            &params->video_opts : NULL) != 0)
-      return false;
+      if (!video->codec || avcodec_open2(video->codec, codec,
+               params->video_opts ? &params->video_opts : NULL) != 0)
+         return false;
+   }
 
    /* Allocate a big buffer. ffmpeg API doesn't seem to give us some
     * clues how big this buffer should be. */
@@ -543,15 +850,24 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
 
    size = avpicture_get_size(video->pix_fmt, param->out_width,
          param->out_height);
-   video->conv_frame_buf = (uint8_t*)av_malloc(size);
-   video->conv_frame = av_frame_alloc();
 
-   avpicture_fill((AVPicture*)video->conv_frame, video->conv_frame_buf,
-         video->pix_fmt, param->out_width, param->out_height);
+   for (i = 0; i < FF_CONV_FRAMES; i++)
+   {
+      AVFrame *frame              = av_frame_alloc();
+
+      video->conv_frames[i]       = frame;
+      video->conv_frame_bufs[i]   = (uint8_t*)av_malloc(size);
+
+      if (!frame || !video->conv_frame_bufs[i])
+         return false;
+
+      avpicture_fill((AVPicture*)frame, video->conv_frame_bufs[i],
+            video->pix_fmt, param->out_width, param->out_height);
 
-   video->conv_frame->width  = param->out_width;
-   video->conv_frame->height = param->out_height;
-   video->conv_frame->format = video->pix_fmt;
+      frame->width  = param->out_width;
+      frame->height = param->out_height;
+      frame->format = video->pix_fmt;
+   }
 
    return true;
 }
@@ -560,6 +876,14 @@ static bool ffmpeg_init_config_common(struct ff_config_param *params, unsigned p
 {
    settings_t *settings = config_get_ptr();
 
+   if (settings->bools.video_record_hw_encoder)
+      strlcpy(params->hwaccel, "auto", sizeof(params->hwaccel));
+
+   /* A stream that falls behind is better off losing frames than
+    * stalling the core, recordings keep every one of them. */
+   params->queue_depth = MAX_FRAMES;
+   params->drop_frames = preset >= RECORD_CONFIG_TYPE_STREAMING_CUSTOM;
+
    switch (preset)
    {
       case RECORD_CONFIG_TYPE_RECORDING_LOW_QUALITY:
@@ -666,6 +990,33 @@ static bool ffmpeg_init_config_common(struct ff_config_param *params, unsigned p
          av_dict_set(&params->video_opts, "framerate", "50", 0);
          av_dict_set(&params->audio_opts, "audio_global_quality", "0", 0);
          break;
+      case RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY:
+         /* Nothing waits for future frames: no B-frames or lookahead,
+          * sliced threads, and intra refresh instead of keyframes so
+          * no single frame is much bigger than the rest. Opus at 10 ms
+          * keeps audio from being the slower half. */
+         params->threads              = settings->uints.video_record_threads;
+         params->frame_drop_ratio     = 1;
+         params->audio_enable         = true;
+         params->audio_global_quality = 50;
+         params->out_pix_fmt          = PIX_FMT_YUV420P;
+         params->queue_depth          = 2;
+         params->low_latency          = true;
+
+         strlcpy(params->vcodec, "libx264", sizeof(params->vcodec));
+         strlcpy(params->acodec, "libopus", sizeof(params->acodec));
+
+         av_dict_set(&params->video_opts, "preset", "ultrafast", 0);
+         av_dict_set(&params->video_opts, "tune", "zerolatency", 0);
+         av_dict_set(&params->video_opts, "intra-refresh", "1", 0);
+         av_dict_set(&params->video_opts, "bf", "0", 0);
+         av_dict_set(&params->video_opts, "g", "60", 0);
+         av_dict_set(&params->video_opts, "flags", "+low_delay", 0);
+         av_dict_set(&params->video_opts, "crf", "23", 0);
+         av_dict_set(&params->audio_opts, "application", "lowdelay", 0);
+         av_dict_set(&params->audio_opts, "frame_duration", "10", 0);
+         av_dict_set(&params->audio_opts, "audio_global_quality", "50", 0);
+         break;
       case RECORD_CONFIG_TYPE_STREAMING_NETPLAY:
          params->threads              = settings->uints.video_record_threads;
          params->frame_drop_ratio     = 1;
@@ -724,6 +1075,15 @@ static bool ffmpeg_init_config_common(struct ff_config_param *params, unsigned p
       else
          strlcpy(params->format, "mpegts", sizeof(params->format));
    }
+   else if (preset == RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY)
+   {
+      if (!settings->bools.video_gpu_record)
+         params->scale_factor = settings->uints.video_stream_scale_factor > 0 ? 
+            settings->uints.video_stream_scale_factor : 1;
+      else
+         params->scale_factor = 1;
+      strlcpy(params->format, "mpegts", sizeof(params->format));
+   }
    else if (preset == RECORD_CONFIG_TYPE_STREAMING_NETPLAY)
    {
       params->scale_factor = 1;
@@ -763,6 +1123,8 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
    params->threads          = 1;
    params->frame_drop_ratio = 1;
    params->audio_enable     = true;
+   params->queue_depth      = MAX_FRAMES;
+   params->drop_frames      = false;
 
    if (!config)
       return true;
@@ -781,6 +1143,9 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
          sizeof(params->acodec));
    config_get_array(params->conf, "format", params->format,
          sizeof(params->format));
+   /* auto, none, nvenc, qsv, vaapi or videotoolbox. */
+   config_get_array(params->conf, "hwaccel", params->hwaccel,
+         sizeof(params->hwaccel));
 
    config_get_uint(params->conf, "threads", &params->threads);
 
@@ -791,6 +1156,11 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
    if (!config_get_bool(params->conf, "audio_enable", &params->audio_enable))
       params->audio_enable = true;
 
+   if (!config_get_uint(params->conf, "queue_depth",
+            &params->queue_depth) || !params->queue_depth)
+      params->queue_depth = MAX_FRAMES;
+   config_get_bool(params->conf, "drop_frames", &params->drop_frames);
+
    config_get_uint(params->conf, "sample_rate", &params->sample_rate);
    config_get_float(params->conf, "scale_factor", &params->scale_factor);
 
@@ -831,13 +1201,14 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
    return true;
 }
 
-static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
+static bool ffmpeg_init_muxer_ctx(struct ff_muxer_info *muxer,
+      const char *filename, const char *format)
 {
-   ctx = avformat_alloc_context();
-   av_strlcpy(ctx->filename, handle->params.filename, sizeof(ctx->filename));
+   AVFormatContext *ctx = avformat_alloc_context();
+   av_strlcpy(ctx->filename, filename, sizeof(ctx->filename));
 
-   if (*handle->config.format)
-      ctx->oformat = av_guess_format(handle->config.format, NULL, NULL);
+   if (*format)
+      ctx->oformat = av_guess_format(format, NULL, NULL);
    else
       ctx->oformat = av_guess_format(NULL, ctx->filename, NULL);
 
@@ -850,80 +1221,136 @@ static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
       return false;
    }
 
-   handle->muxer.ctx = ctx;
+   muxer->ctx = ctx;
    return true;
 }
 
-static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
+static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
 {
-   AVStream *stream = avformat_new_stream(handle->muxer.ctx,
+   if (!ffmpeg_init_muxer_ctx(&handle->muxer, handle->params.filename,
+            handle->config.format))
+      return false;
+
+   if (handle->config.low_latency)
+   {
+      handle->muxer.ctx->max_delay     = 0;
+      handle->muxer.ctx->flush_packets = 1;
+   }
+
+   /* Matroska takes anything the stream presets encode. Losing the
+    * local copy is no reason to stop the stream. */
+   if (handle->params.mirror_filename && !ffmpeg_init_muxer_ctx(
+            &handle->mirror, handle->params.mirror_filename, "matroska"))
+      RARCH_WARN("[FFmpeg]: Cannot open \"%s\", not recording locally.\n",
+            handle->params.mirror_filename);
+
+   return true;
+}
+
+static bool ffmpeg_init_muxer_streams(ffmpeg_t *handle,
+      struct ff_muxer_info *muxer)
+{
+   AVStream *stream = avformat_new_stream(muxer->ctx,
          handle->video.encoder);
 
    stream->codec = handle->video.codec;
    stream->time_base = stream->codec->time_base;
-   handle->muxer.vstream = stream;
-   handle->muxer.vstream->sample_aspect_ratio =
+   muxer->vstream = stream;
+   muxer->vstream->sample_aspect_ratio =
       handle->video.codec->sample_aspect_ratio;
 
    if (handle->config.audio_enable)
    {
-      stream = avformat_new_stream(handle->muxer.ctx,
+      stream = avformat_new_stream(muxer->ctx,
             handle->audio.encoder);
       stream->codec = handle->audio.codec;
       stream->time_base = stream->codec->time_base;
-      handle->muxer.astream = stream;
+      muxer->astream = stream;
    }
 
-   av_dict_set(&handle->muxer.ctx->metadata, "title",
+   av_dict_set(&muxer->ctx->metadata, "title",
          "RetroArch Video Dump", 0);
 
-   return avformat_write_header(handle->muxer.ctx, NULL) >= 0;
+   return avformat_write_header(muxer->ctx, NULL) >= 0;
+}
+
+static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
+{
+   if (handle->mirror.ctx && !ffmpeg_init_muxer_streams(handle,
+            &handle->mirror))
+   {
+      RARCH_WARN("[FFmpeg]: Cannot write \"%s\", not recording locally.\n",
+            handle->params.mirror_filename);
+      /* The streams share our codec contexts, so the context itself
+       * is leaked rather than freed. */
+      avio_close(handle->mirror.ctx->pb);
+      handle->mirror.ctx = NULL;
+   }
+
+   return ffmpeg_init_muxer_streams(handle, &handle->muxer);
 }
 
-#define MAX_FRAMES 32
 
-static void ffmpeg_thread(void *data);
+static void ffmpeg_convert_thread(void *data);
+static void ffmpeg_encode_thread(void *data);
+static void ffmpeg_mux_thread(void *data);
 
 static bool init_thread(ffmpeg_t *handle)
 {
    handle->lock = slock_new();
-   handle->cond_lock = slock_new();
    handle->cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct record_video_data) * MAX_FRAMES);
+   handle->attr_fifo = fifo_new(sizeof(struct ff_video_attr) *
+         handle->config.queue_depth);
    handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
-            handle->video.pix_size * MAX_FRAMES);
+            handle->video.pix_size * handle->config.queue_depth);
+   /* Has to fit the biggest packet encode_video() can return. */
+   handle->packet_fifo = fifo_new(2 * (sizeof(struct ff_packet_header)
+            + handle->video.outbuf_size));
+
+   handle->alive          = true;
+   handle->encode_alive   = true;
+   handle->mux_alive      = true;
+   handle->mux_thread     = sthread_create(ffmpeg_mux_thread, handle);
+   handle->encode_thread  = sthread_create(ffmpeg_encode_thread, handle);
+   handle->convert_thread = sthread_create(ffmpeg_convert_thread, handle);
+
+   retro_assert(handle->lock && handle->cond && handle->audio_fifo &&
+      handle->attr_fifo && handle->video_fifo && handle->packet_fifo &&
+      handle->mux_thread && handle->encode_thread && handle->convert_thread);
 
-   handle->alive = true;
-   handle->can_sleep = true;
-   handle->thread = sthread_create(ffmpeg_thread, handle);
+   return true;
+}
 
-   retro_assert(handle->lock && handle->cond_lock &&
-      handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+static void ffmpeg_stop_stage(ffmpeg_t *handle, volatile bool *alive,
+      sthread_t **thread)
+{
+   slock_lock(handle->lock);
+   *alive = false;
+   scond_broadcast(handle->cond);
+   slock_unlock(handle->lock);
 
-   return true;
+   sthread_join(*thread);
+   *thread = NULL;
 }
 
 static void deinit_thread(ffmpeg_t *handle)
 {
-   if (!handle->thread)
+   if (!handle->mux_thread)
       return;
 
-   slock_lock(handle->cond_lock);
-   handle->alive = false;
-   handle->can_sleep = false;
-   slock_unlock(handle->cond_lock);
-
-   scond_signal(handle->cond);
-   sthread_join(handle->thread);
+   /* Whatever a stage is still working on makes it into the next
+    * queue, ffmpeg_flush_buffers() picks it up from there. */
+   ffmpeg_stop_stage(handle, &handle->alive, &handle->convert_thread);
+   ffmpeg_stop_stage(handle, &handle->encode_alive, &handle->encode_thread);
+   ffmpeg_stop_stage(handle, &handle->mux_alive, &handle->mux_thread);
 
    slock_free(handle->lock);
-   slock_free(handle->cond_lock);
    scond_free(handle->cond);
 
-   handle->thread = NULL;
+   handle->lock = NULL;
+   handle->cond = NULL;
 }
 
 static void deinit_thread_buf(ffmpeg_t *handle)
@@ -945,10 +1372,17 @@ static void deinit_thread_buf(ffmpeg_t *handle)
       fifo_free(handle->video_fifo);
       handle->video_fifo = NULL;
    }
+
+   if (handle->packet_fifo)
+   {
+      fifo_free(handle->packet_fifo);
+      handle->packet_fifo = NULL;
+   }
 }
 
 static void ffmpeg_free(void *data)
 {
+   unsigned i;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    if (!handle)
       return;
@@ -964,15 +1398,14 @@ static void ffmpeg_free(void *data)
 
    av_free(handle->audio.buffer);
 
-   if (handle->video.codec)
+   ffmpeg_free_video_codec(&handle->video);
+
+   for (i = 0; i < FF_CONV_FRAMES; i++)
    {
-      avcodec_close(handle->video.codec);
-      av_free(handle->video.codec);
+      av_frame_free(&handle->video.conv_frames[i]);
+      av_free(handle->video.conv_frame_bufs[i]);
    }
 
-   av_frame_free(&handle->video.conv_frame);
-   av_free(handle->video.conv_frame_buf);
-
    scaler_ctx_gen_reset(&handle->video.scaler);
 
    if (handle->video.sws)
@@ -1018,6 +1451,13 @@ static void *ffmpeg_new(const struct record_params *params)
    else
       ffmpeg_init_config_common(&handle->config, params->preset);
 
+   /* MPEG-TS in RTP carries audio and video in one RTP stream, the
+    * plain rtp muxer only takes one. */
+   if (handle->config.low_latency
+         && strstr(params->filename, "rtp://") == params->filename)
+      strlcpy(handle->config.format, "rtp_mpegts",
+            sizeof(handle->config.format));
+
    if (!ffmpeg_init_muxer_pre(handle))
       goto error;
 
@@ -1045,7 +1485,8 @@ static bool ffmpeg_push_video(void *data,
 {
    unsigned y;
    bool drop_frame;
-   struct record_video_data attr_data;
+   size_t queued;
+   struct ff_video_attr attr;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    int       offset = 0;
 
@@ -1060,52 +1501,54 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->attr_fifo);
-      slock_unlock(handle->lock);
+   slock_lock(handle->lock);
+
+   /* Frames dropped below still take up their pts, so that the
+    * video stays in sync with the audio. */
+   attr.pts = handle->video.frame_cnt++;
+   handle->stats.frames++;
 
+   while (fifo_write_avail(handle->attr_fifo) < sizeof(attr))
+   {
       if (!handle->alive)
+      {
+         slock_unlock(handle->lock);
          return false;
+      }
 
-      if (avail >= sizeof(*vid))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
+      if (handle->config.drop_frames)
       {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
+         if (!handle->stats.dropped++)
+            RARCH_WARN("[FFmpeg]: Encoder can't keep up, dropping frames.\n");
+         slock_unlock(handle->lock);
+         return true;
       }
-      else
-         scond_signal(handle->cond);
 
-      slock_unlock(handle->cond_lock);
+      scond_wait(handle->cond, handle->lock);
    }
 
-   slock_lock(handle->lock);
-
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
     */
-   attr_data = *vid;
+   attr.vid = *vid;
 
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
+   if (attr.vid.is_dupe)
+      attr.vid.width = attr.vid.height = attr.vid.pitch = 0;
    else
-      attr_data.pitch = attr_data.width * handle->video.pix_size;
+      attr.vid.pitch = attr.vid.width * handle->video.pix_size;
 
-   fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+   fifo_write(handle->attr_fifo, &attr, sizeof(attr));
 
-   for (y = 0; y < attr_data.height; y++, offset += vid->pitch)
+   for (y = 0; y < attr.vid.height; y++, offset += vid->pitch)
       fifo_write(handle->video_fifo,
-            (const uint8_t*)vid->data + offset, attr_data.pitch);
+            (const uint8_t*)vid->data + offset, attr.vid.pitch);
+
+   queued = fifo_read_avail(handle->attr_fifo) / sizeof(attr);
+   if (queued > handle->stats.queue_peak)
+      handle->stats.queue_peak = queued;
 
+   scond_broadcast(handle->cond);
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
 
    return true;
 }
@@ -1113,6 +1556,7 @@ static bool ffmpeg_push_video(void *data,
 static bool ffmpeg_push_audio(void *data,
       const struct record_audio_data *audio_data)
 {
+   size_t size;
    ffmpeg_t *handle = (ffmpeg_t*)data;
 
    if (!handle || !audio_data)
@@ -1121,38 +1565,27 @@ static bool ffmpeg_push_audio(void *data,
    if (!handle->config.audio_enable)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->audio_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
+   size = audio_data->frames * handle->params.channels * sizeof(int16_t);
 
-      if (avail >= audio_data->frames * handle->params.channels
-            * sizeof(int16_t))
-         break;
+   slock_lock(handle->lock);
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
+   /* Never dropped, it's a fraction of the work and any gap
+    * in it is audible. */
+   while (fifo_write_avail(handle->audio_fifo) < size)
+   {
+      if (!handle->alive)
       {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
+         slock_unlock(handle->lock);
+         return false;
       }
-      else
-         scond_signal(handle->cond);
 
-      slock_unlock(handle->cond_lock);
+      scond_wait(handle->cond, handle->lock);
    }
 
-   slock_lock(handle->lock);
-   fifo_write(handle->audio_fifo, audio_data->data,
-         audio_data->frames * handle->params.channels * sizeof(int16_t));
+   fifo_write(handle->audio_fifo, audio_data->data, size);
+
+   scond_broadcast(handle->cond);
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
 
    return true;
 }
@@ -1176,23 +1609,108 @@ static bool encode_video(ffmpeg_t *handle, AVPacket *pkt, AVFrame *frame)
       return true;
    }
 
-   if (pkt->pts != (int64_t)AV_NOPTS_VALUE)
-   {
-      pkt->pts = av_rescale_q(pkt->pts, handle->video.codec->time_base,
-            handle->muxer.vstream->time_base);
-   }
+   /* Timestamps stay in the codec time base until they reach each
+    * muxer, see ffmpeg_mux_packet(). */
+   pkt->stream_index = handle->muxer.vstream->index;
+   return true;
+}
 
-   if (pkt->dts != (int64_t)AV_NOPTS_VALUE)
+static bool ffmpeg_mux_packet(ffmpeg_t *handle,
+      struct ff_muxer_info *muxer, const AVPacket *pkt)
+{
+   AVPacket out            = *pkt;
+   AVStream *stream        = muxer->astream;
+   AVCodecContext *codec   = handle->audio.codec;
+
+   if (pkt->stream_index == handle->muxer.vstream->index)
    {
-      pkt->dts = av_rescale_q(pkt->dts, handle->video.codec->time_base,
-            handle->muxer.vstream->time_base);
+      stream = muxer->vstream;
+      codec  = handle->video.codec;
    }
 
-   pkt->stream_index = handle->muxer.vstream->index;
+   /* The packet points into our own outbuf, not a refcounted buffer,
+    * so every muxer duplicates what it keeps and a shallow copy with
+    * its own stream index and timestamps is all it needs. */
+   out.stream_index    = stream->index;
+
+   if (out.pts != (int64_t)AV_NOPTS_VALUE)
+      out.pts = av_rescale_q(out.pts, codec->time_base, stream->time_base);
+
+   if (out.dts != (int64_t)AV_NOPTS_VALUE)
+      out.dts = av_rescale_q(out.dts, codec->time_base, stream->time_base);
+
+   /* Interleaving holds packets back until the other stream catches
+    * up, the local copy can afford that but a low latency stream
+    * can't. Packets are written before we return, so nothing keeps
+    * pointing at outbuf. */
+   if (handle->config.low_latency && muxer == &handle->muxer)
+      return av_write_frame(muxer->ctx, &out) >= 0;
+
+   return av_interleaved_write_frame(muxer->ctx, &out) >= 0;
+}
+
+/* Writes @pkt to all outputs. Only the main one decides success,
+ * a failing local copy doesn't stop a stream. */
+static bool ffmpeg_mux(ffmpeg_t *handle, const AVPacket *pkt)
+{
+   if (handle->mirror.ctx)
+      ffmpeg_mux_packet(handle, &handle->mirror, pkt);
+
+   return ffmpeg_mux_packet(handle, &handle->muxer, pkt);
+}
+
+/* Hands @pkt over to the mux stage, or straight to the muxers once
+ * the pipeline is gone. */
+static bool ffmpeg_write_packet(ffmpeg_t *handle, AVPacket *pkt)
+{
+   size_t queued;
+   struct ff_packet_header header;
+
+   if (!handle->mux_thread)
+      return ffmpeg_mux(handle, pkt);
+
+   header.pts          = pkt->pts;
+   header.dts          = pkt->dts;
+   header.size         = pkt->size;
+   header.flags        = pkt->flags;
+   header.stream_index = pkt->stream_index;
+
+   slock_lock(handle->lock);
+
+   while (fifo_write_avail(handle->packet_fifo) < sizeof(header) + pkt->size)
+      scond_wait(handle->cond, handle->lock);
+
+   fifo_write(handle->packet_fifo, &header, sizeof(header));
+   fifo_write(handle->packet_fifo, pkt->data, pkt->size);
+
+   queued = fifo_read_avail(handle->packet_fifo);
+   if (queued > handle->stats.packet_peak)
+      handle->stats.packet_peak = queued;
+
+   scond_broadcast(handle->cond);
+   slock_unlock(handle->lock);
+
    return true;
 }
 
-static void ffmpeg_scale_input(ffmpeg_t *handle,
+/* @buf has to hold video.outbuf_size bytes. */
+static void ffmpeg_read_packet(ffmpeg_t *handle, AVPacket *pkt, uint8_t *buf)
+{
+   struct ff_packet_header header;
+
+   fifo_read(handle->packet_fifo, &header, sizeof(header));
+   fifo_read(handle->packet_fifo, buf, header.size);
+
+   av_init_packet(pkt);
+   pkt->data         = buf;
+   pkt->size         = header.size;
+   pkt->pts          = header.pts;
+   pkt->dts          = header.dts;
+   pkt->flags        = header.flags;
+   pkt->stream_index = header.stream_index;
+}
+
+static void ffmpeg_scale_input(ffmpeg_t *handle, AVFrame *frame,
       const struct record_video_data *vid)
 {
    /* Attempt to preserve more information if we scale down. */
@@ -1210,18 +1728,17 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
             shrunk ? SWS_BILINEAR : SWS_POINT, NULL, NULL, NULL);
 
       sws_scale(handle->video.sws, (const uint8_t* const*)&vid->data,
-            &linesize, 0, vid->height, handle->video.conv_frame->data,
-            handle->video.conv_frame->linesize);
+            &linesize, 0, vid->height, frame->data, frame->linesize);
    }
    else
    {
       video_frame_record_scale(
             &handle->video.scaler,
-            handle->video.conv_frame->data[0],
+            frame->data[0],
             vid->data,
             handle->params.out_width,
             handle->params.out_height,
-            handle->video.conv_frame->linesize[0],
+            frame->linesize[0],
             vid->width,
             vid->height,
             vid->pitch,
@@ -1229,26 +1746,51 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
    }
 }
 
-static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+/* Convert stage, fills @frame from @attr. Dupes repeat whatever was
+ * converted last. */
+static void ffmpeg_convert_frame(ffmpeg_t *handle, AVFrame *frame,
+      const struct ff_video_attr *attr)
+{
+   struct ff_video_info *video = &handle->video;
+
+   if (!attr->vid.is_dupe)
+      ffmpeg_scale_input(handle, frame, &attr->vid);
+   else if (video->conv_prev && video->conv_prev != frame)
+      av_image_copy(frame->data, frame->linesize,
+            (const uint8_t**)video->conv_prev->data,
+            video->conv_prev->linesize, video->pix_fmt,
+            frame->width, frame->height);
+
+   frame->pts       = attr->pts;
+   video->conv_prev = frame;
+}
+
+/* Encode stage for a converted frame. */
+static bool ffmpeg_encode_frame(ffmpeg_t *handle, AVFrame *frame)
 {
    AVPacket pkt;
 
-   if (!vid->is_dupe)
-      ffmpeg_scale_input(handle, vid);
+#ifdef HAVE_FFMPEG_HWCONTEXT
+   if (handle->video.hw_frames)
+   {
+      AVFrame *hw_frame = handle->video.hw_frame;
+
+      av_frame_unref(hw_frame);
+      if (av_hwframe_get_buffer(handle->video.hw_frames, hw_frame, 0) < 0
+            || av_hwframe_transfer_data(hw_frame, frame, 0) < 0)
+         return false;
 
-   handle->video.conv_frame->pts = handle->video.frame_cnt;
+      hw_frame->pts = frame->pts;
+      frame         = hw_frame;
+   }
+#endif
 
-   if (!encode_video(handle, &pkt, handle->video.conv_frame))
+   if (!encode_video(handle, &pkt, frame))
       return false;
 
    if (pkt.size)
-   {
-      if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
-         return false;
-   }
+      return ffmpeg_write_packet(handle, &pkt);
 
-   handle->video.frame_cnt++;
    return true;
 }
 
@@ -1348,20 +1890,6 @@ static bool encode_audio(ffmpeg_t *handle, AVPacket *pkt, bool dry)
       return true;
    }
 
-   if (pkt->pts != (int64_t)AV_NOPTS_VALUE)
-   {
-      pkt->pts = av_rescale_q(pkt->pts,
-            handle->audio.codec->time_base,
-            handle->muxer.astream->time_base);
-   }
-
-   if (pkt->dts != (int64_t)AV_NOPTS_VALUE)
-   {
-      pkt->dts = av_rescale_q(pkt->dts,
-            handle->audio.codec->time_base,
-            handle->muxer.astream->time_base);
-   }
-
    av_frame_free(&frame);
 
    pkt->stream_index = handle->muxer.astream->index;
@@ -1473,7 +2001,7 @@ static bool ffmpeg_push_audio_thread(ffmpeg_t *handle,
 
       if (pkt.size)
       {
-         if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+         if (!ffmpeg_write_packet(handle, &pkt))
             return false;
       }
    }
@@ -1502,7 +2030,7 @@ static void ffmpeg_flush_audio(ffmpeg_t *handle, void *audio_buf,
    {
       AVPacket pkt;
       if (!encode_audio(handle, &pkt, true) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_write_packet(handle, &pkt))
          break;
    }
 }
@@ -1513,7 +2041,7 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
    {
       AVPacket pkt;
       if (!encode_video(handle, &pkt, NULL) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_write_packet(handle, &pkt))
          break;
    }
 }
@@ -1523,6 +2051,7 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    bool did_work;
    void *video_buf = av_malloc(2 * handle->params.fb_width *
          handle->params.fb_height * handle->video.pix_size);
+   uint8_t *packet_buf = (uint8_t*)av_malloc(handle->video.outbuf_size);
    size_t audio_buf_size = handle->config.audio_enable ?
       (handle->audio.codec->frame_size *
        handle->params.channels * sizeof(int16_t)) : 0;
@@ -1530,12 +2059,29 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    if (audio_buf_size)
       audio_buf = av_malloc(audio_buf_size);
+
+   /* What the stages left behind goes first, oldest queue first. */
+   while (fifo_read_avail(handle->packet_fifo)
+         >= sizeof(struct ff_packet_header))
+   {
+      AVPacket pkt;
+      ffmpeg_read_packet(handle, &pkt, packet_buf);
+      ffmpeg_write_packet(handle, &pkt);
+   }
+
+   for (; handle->video.conv_count; handle->video.conv_count--)
+   {
+      ffmpeg_encode_frame(handle,
+            handle->video.conv_frames[handle->video.conv_read]);
+      handle->video.conv_read = (handle->video.conv_read + 1)
+         % FF_CONV_FRAMES;
+   }
+
    /* Try pushing data in an interleaving pattern to
     * ease the work of the muxer a bit. */
-
    do
    {
-      struct record_video_data attr_buf;
+      struct ff_video_attr attr;
 
       did_work = false;
 
@@ -1555,13 +2101,17 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (fifo_read_avail(handle->attr_fifo) >= sizeof(attr_buf))
+      if (fifo_read_avail(handle->attr_fifo) >= sizeof(attr))
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
+         AVFrame *frame = handle->video.conv_frames[handle->video.conv_read];
+
+         fifo_read(handle->attr_fifo, &attr, sizeof(attr));
          fifo_read(handle->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
+               attr.vid.height * attr.vid.pitch);
+         attr.vid.data = video_buf;
+
+         ffmpeg_convert_frame(handle, frame, &attr);
+         ffmpeg_encode_frame(handle, frame);
 
          did_work = true;
       }
@@ -1575,6 +2125,7 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    ffmpeg_flush_video(handle);
 
    av_free(video_buf);
+   av_free(packet_buf);
    av_free(audio_buf);
 }
 
@@ -1594,91 +2145,165 @@ static bool ffmpeg_finalize(void *data)
    /* Write final data. */
    av_write_trailer(handle->muxer.ctx);
 
-   avio_close(ctx->pb);
+   avio_close(handle->muxer.ctx->pb);
+
+   if (handle->mirror.ctx)
+   {
+      av_write_trailer(handle->mirror.ctx);
+      avio_close(handle->mirror.ctx->pb);
+   }
+
+   RARCH_LOG("[FFmpeg]: %u of %u frames dropped, input queue peaked at %u/%u frames, packet queue at %u KiB.\n",
+         handle->stats.dropped, handle->stats.frames,
+         (unsigned)handle->stats.queue_peak, handle->config.queue_depth,
+         (unsigned)(handle->stats.packet_peak >> 10));
 
    return true;
 }
 
-static void ffmpeg_thread(void *data)
+static void ffmpeg_convert_thread(void *data)
 {
-   size_t audio_buf_size;
-   void *audio_buf = NULL;
    ffmpeg_t *ff    = (ffmpeg_t*)data;
    /* For some reason, FFmpeg has a tendency to crash
     * if we don't overallocate a bit. */
    void *video_buf = av_malloc(2 * ff->params.fb_width *
          ff->params.fb_height * ff->video.pix_size);
 
+   sthread_set_role(STHREAD_ROLE_BACKGROUND);
+
    retro_assert(video_buf);
 
-   audio_buf_size = ff->config.audio_enable ?
-      (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
-   audio_buf      = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
+   slock_lock(ff->lock);
 
    while (ff->alive)
    {
-      struct record_video_data attr_buf;
+      AVFrame *frame;
+      struct ff_video_attr attr;
 
-      bool avail_video = false;
-      bool avail_audio = false;
+      if (     fifo_read_avail(ff->attr_fifo) < sizeof(attr)
+            || ff->video.conv_count == FF_CONV_FRAMES)
+      {
+         scond_wait(ff->cond, ff->lock);
+         continue;
+      }
 
-      slock_lock(ff->lock);
-      if (fifo_read_avail(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
+      fifo_read(ff->attr_fifo, &attr, sizeof(attr));
+      fifo_read(ff->video_fifo, video_buf,
+            attr.vid.height * attr.vid.pitch);
+      scond_broadcast(ff->cond);
 
-      if (ff->config.audio_enable)
-         if (fifo_read_avail(ff->audio_fifo) >= audio_buf_size)
-            avail_audio = true;
+      /* Not counted until converted, the encoder leaves it alone. */
+      frame = ff->video.conv_frames[(ff->video.conv_read
+            + ff->video.conv_count) % FF_CONV_FRAMES];
       slock_unlock(ff->lock);
 
+      attr.vid.data = video_buf;
+      ffmpeg_convert_frame(ff, frame, &attr);
+
+      slock_lock(ff->lock);
+      ff->video.conv_count++;
+      scond_broadcast(ff->cond);
+   }
+
+   slock_unlock(ff->lock);
+
+   av_free(video_buf);
+}
+
+static void ffmpeg_encode_thread(void *data)
+{
+   ffmpeg_t *ff          = (ffmpeg_t*)data;
+   size_t audio_buf_size = ff->config.audio_enable ?
+      (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
+   void *audio_buf       = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
+
+   sthread_set_role(STHREAD_ROLE_BACKGROUND);
+
+   slock_lock(ff->lock);
+
+   while (ff->encode_alive)
+   {
+      bool avail_video = ff->video.conv_count > 0;
+      bool avail_audio = audio_buf &&
+         fifo_read_avail(ff->audio_fifo) >= audio_buf_size;
+
       if (!avail_video && !avail_audio)
       {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
-
-         slock_unlock(ff->cond_lock);
+         scond_wait(ff->cond, ff->lock);
+         continue;
       }
 
-      if (avail_video && video_buf)
+      if (avail_video)
       {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
+         /* Stays counted while encoding, the converter leaves it alone. */
+         AVFrame *frame = ff->video.conv_frames[ff->video.conv_read];
          slock_unlock(ff->lock);
-         scond_signal(ff->cond);
 
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
+         ffmpeg_encode_frame(ff, frame);
+
+         slock_lock(ff->lock);
+         ff->video.conv_read = (ff->video.conv_read + 1) % FF_CONV_FRAMES;
+         ff->video.conv_count--;
+         scond_broadcast(ff->cond);
       }
 
-      if (avail_audio && audio_buf)
+      if (avail_audio)
       {
          struct record_audio_data aud = {0};
 
-         slock_lock(ff->lock);
          fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
+         scond_broadcast(ff->cond);
          slock_unlock(ff->lock);
-         scond_signal(ff->cond);
 
          aud.frames = ff->audio.codec->frame_size;
          aud.data = audio_buf;
 
          ffmpeg_push_audio_thread(ff, &aud, true);
+
+         slock_lock(ff->lock);
       }
    }
 
-   av_free(video_buf);
+   slock_unlock(ff->lock);
+
    av_free(audio_buf);
 }
 
+static void ffmpeg_mux_thread(void *data)
+{
+   ffmpeg_t *ff = (ffmpeg_t*)data;
+   uint8_t *buf = (uint8_t*)av_malloc(ff->video.outbuf_size);
+
+   sthread_set_role(STHREAD_ROLE_BACKGROUND);
+
+   retro_assert(buf);
+
+   slock_lock(ff->lock);
+
+   while (ff->mux_alive)
+   {
+      AVPacket pkt;
+
+      if (fifo_read_avail(ff->packet_fifo) < sizeof(struct ff_packet_header))
+      {
+         scond_wait(ff->cond, ff->lock);
+         continue;
+      }
+
+      ffmpeg_read_packet(ff, &pkt, buf);
+      scond_broadcast(ff->cond);
+      slock_unlock(ff->lock);
+
+      ffmpeg_mux(ff, &pkt);
+
+      slock_lock(ff->lock);
+   }
+
+   slock_unlock(ff->lock);
+
+   av_free(buf);
+}
+
 const record_driver_t record_ffmpeg = {
    ffmpeg_new,
    ffmpeg_free,
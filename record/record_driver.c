@@ -321,6 +321,7 @@ void recording_push_audio(const int16_t *data, size_t samples)
 bool recording_init(void)
 {
    char output[PATH_MAX_LENGTH];
+   char mirror[PATH_MAX_LENGTH];
    char buf[PATH_MAX_LENGTH];
    struct record_params params          = {0};
    struct retro_system_av_info *av_info = video_viewport_get_system_av_info();
@@ -399,6 +400,15 @@ bool recording_init(void)
       FFEMU_PIX_ARGB8888 : FFEMU_PIX_RGB565;
    params.config     = NULL;
 
+   if (streaming_is_enabled() && settings->bools.video_stream_record)
+   {
+      const char *game_name = path_basename(path_get(RARCH_PATH_BASENAME));
+
+      fill_str_dated_filename(buf, game_name, "mkv", sizeof(buf));
+      fill_pathname_join(mirror, global->record.output_dir, buf, sizeof(mirror));
+      params.mirror_filename = mirror;
+   }
+
    if (!string_is_empty(global->record.config))
       params.config = global->record.config;
    else
@@ -498,6 +508,10 @@ bool recording_init(void)
          params.fb_width, params.fb_height,
          (unsigned)params.pix_fmt);
 
+   if (params.mirror_filename)
+      RARCH_LOG("[recording] %s %s\n", msg_hash_to_str(MSG_RECORDING_TO),
+            params.mirror_filename);
+
    if (!record_driver_init_first(&recording_driver, &recording_data, &params))
    {
       RARCH_ERR("[recording] %s\n", msg_hash_to_str(MSG_FAILED_TO_START_RECORDING));
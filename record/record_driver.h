@@ -53,6 +53,7 @@ enum record_config_type
    RECORD_CONFIG_TYPE_STREAMING_LOW_QUALITY,
    RECORD_CONFIG_TYPE_STREAMING_MED_QUALITY,
    RECORD_CONFIG_TYPE_STREAMING_HIGH_QUALITY,
+   RECORD_CONFIG_TYPE_STREAMING_LOW_LATENCY,
    RECORD_CONFIG_TYPE_STREAMING_NETPLAY
 
 };
@@ -89,6 +90,10 @@ struct record_params
    /* Filename to dump to. */
    const char *filename;
 
+   /* Second output muxed from the same encoded packets, e.g. a
+    * local copy of a stream. Optional. */
+   const char *mirror_filename;
+
    /* Path to config. Optional. */
    const char *config;
 };
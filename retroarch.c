@@ -37,6 +37,7 @@
 #include <boolean.h>
 #include <string/stdstring.h>
 #include <lists/string_list.h>
+#include <lists/dir_list.h>
 #include <retro_timers.h>
 
 #include <compat/strl.h>
@@ -45,6 +46,7 @@
 #include <compat/posix_string.h>
 #include <streams/file_stream.h>
 #include <file/file_path.h>
+#include <file/archive_file.h>
 #include <retro_assert.h>
 #include <retro_miscellaneous.h>
 #include <queues/message_queue.h>
@@ -75,6 +77,8 @@
 #endif
 
 #ifdef HAVE_NETWORKING
+#include <net/net_http.h>
+
 #include "network/netplay/netplay.h"
 #endif
 
@@ -84,6 +88,7 @@
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
+#include <rthreads/rjob.h>
 #endif
 
 #include "autosave.h"
@@ -105,6 +110,7 @@
 #include "frontend/frontend_driver.h"
 #include "audio/audio_driver.h"
 #include "camera/camera_driver.h"
+#include "gfx/video_pacing.h"
 #include "record/record_driver.h"
 #include "core.h"
 #include "configuration.h"
@@ -112,6 +118,7 @@
 #include "managers/core_option_manager.h"
 #include "managers/cheat_manager.h"
 #include "managers/state_manager.h"
+#include "managers/memory_budget.h"
 #include "tasks/tasks_internal.h"
 #include "performance_counters.h"
 
@@ -168,7 +175,10 @@ enum
    RA_OPT_LOG_FILE,
    RA_OPT_MAX_FRAMES,
    RA_OPT_MAX_FRAMES_SCREENSHOT,
-   RA_OPT_MAX_FRAMES_SCREENSHOT_PATH
+   RA_OPT_MAX_FRAMES_SCREENSHOT_PATH,
+   RA_OPT_TRACE,
+   RA_OPT_BENCHMARK,
+   RA_OPT_BENCHMARK_DRIVERS
 };
 
 enum  runloop_state
@@ -234,6 +244,21 @@ static bool rarch_bps_pref                                      = false;
 static bool rarch_ips_pref                                      = false;
 static bool rarch_patch_blocked                                 = false;
 static bool rarch_first_start                                   = true;
+#ifdef HAVE_THREADS
+static bool rarch_jobs_inited                                   = false;
+#endif
+
+#define RARCH_STARTUP_STEPS_MAX 16
+
+/* Timeline of retroarch_main_init() */
+static struct
+{
+   const char *name;
+   retro_time_t start;
+   retro_time_t usec;
+} rarch_startup_steps[RARCH_STARTUP_STEPS_MAX];
+static unsigned rarch_startup_step_count                        = 0;
+static bool rarch_startup_active                                = false;
 
 static bool runloop_force_nonblock                              = false;
 static bool runloop_paused                                      = false;
@@ -268,6 +293,10 @@ static unsigned runloop_pending_windowed_scale                  = 0;
 static unsigned runloop_max_frames                              = 0;
 static bool runloop_max_frames_screenshot                       = false;
 static char runloop_max_frames_screenshot_path[PATH_MAX_LENGTH] = {0};
+static bool runloop_benchmark                                   = false;
+static bool runloop_benchmark_drivers                           = false;
+static retro_time_t runloop_benchmark_start                     = 0;
+static uint64_t runloop_benchmark_start_frame                   = 0;
 static unsigned fastforward_after_frames                        = 0;
 
 static retro_usec_t runloop_frame_time_last                     = 0;
@@ -603,7 +632,59 @@ static void retroarch_print_help(const char *arg0)
    puts("      --max-frames-ss\n"
         "                        Takes a screenshot at the end of max-frames.");
    puts("      --max-frames-ss-path=FILE\n"
-        "                        Path to save the screenshot to at the end of max-frames.\n");
+        "                        Path to save the screenshot to at the end of max-frames.");
+   puts("      --trace=FILE      Writes a timeline of frames, threads and tasks\n"
+        "                        to FILE, for chrome://tracing or Perfetto.");
+   puts("      --benchmark=NUMBER\n"
+        "                        Runs the content for the specified number of frames\n"
+        "                        as fast as possible with null video and audio, then\n"
+        "                        prints frame rate and frame time statistics. Rewind,\n"
+        "                        run-ahead or shaders can be enabled with --appendconfig.\n"
+        "                        With --bsvplay, also checks the movie against the states\n"
+        "                        it recorded and times each segment; 0 frames plays the\n"
+        "                        whole movie.");
+   puts("      --benchmark-drivers\n"
+        "                        Benchmarks with the configured drivers instead.\n");
+}
+
+/* Lets the content run as fast as it can for --benchmark.
+ * None of this is saved to the config file. */
+static void retroarch_benchmark_init(settings_t *settings)
+{
+   if (!runloop_benchmark_drivers)
+   {
+      strlcpy(settings->arrays.video_driver, "null",
+            sizeof(settings->arrays.video_driver));
+      strlcpy(settings->arrays.audio_driver, "null",
+            sizeof(settings->arrays.audio_driver));
+   }
+
+   settings->bools.video_vsync            = false;
+   settings->bools.audio_sync             = false;
+   settings->bools.vrr_runloop_enable     = false;
+   settings->bools.video_frame_delay_auto = false;
+   settings->uints.video_frame_delay      = 0;
+   settings->bools.config_save_on_exit    = false;
+
+   /* Only applies if a movie gets played back */
+   bsv_movie_ctl(BSV_MOVIE_CTL_SET_VERIFY, NULL);
+   bsv_movie_ctl(BSV_MOVIE_CTL_SET_END_EOF, NULL);
+
+   rarch_ctl(RARCH_CTL_SET_PERFCNT_ENABLE, NULL);
+}
+
+static void retroarch_benchmark_report(uint64_t frame_count)
+{
+   uint64_t frames = frame_count - runloop_benchmark_start_frame;
+   double seconds  = (cpu_features_get_time_usec()
+         - runloop_benchmark_start) / 1000000.0;
+
+   printf("Benchmark: %u frames in %.3f s, %.2f fps.\n",
+         (unsigned)frames, seconds,
+         seconds > 0.0 ? frames / seconds : 0.0);
+   bsv_movie_print_report(stdout);
+   performance_zones_print(stdout);
+   fflush(stdout);
 }
 
 #define FFMPEG_RECORD_ARG "r:"
@@ -680,6 +761,9 @@ static void retroarch_parse_input_and_config(int argc, char *argv[])
       { "max-frames-ss",      0, NULL, RA_OPT_MAX_FRAMES_SCREENSHOT },
       { "max-frames-ss-path", 1, NULL, RA_OPT_MAX_FRAMES_SCREENSHOT_PATH },
       { "eof-exit",           0, NULL, RA_OPT_EOF_EXIT },
+      { "trace",              1, NULL, RA_OPT_TRACE },
+      { "benchmark",          1, NULL, RA_OPT_BENCHMARK },
+      { "benchmark-drivers",  0, NULL, RA_OPT_BENCHMARK_DRIVERS },
       { "version",            0, NULL, RA_OPT_VERSION },
 #ifdef HAVE_FILE_LOGGER
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
@@ -1100,6 +1184,19 @@ static void retroarch_parse_input_and_config(int argc, char *argv[])
             strlcpy(runloop_max_frames_screenshot_path, optarg, sizeof(runloop_max_frames_screenshot_path));
             break;
 
+         case RA_OPT_TRACE:
+            performance_trace_init(optarg);
+            break;
+
+         case RA_OPT_BENCHMARK:
+            runloop_benchmark   = true;
+            runloop_max_frames  = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+
+         case RA_OPT_BENCHMARK_DRIVERS:
+            runloop_benchmark_drivers = true;
+            break;
+
          case RA_OPT_SUBSYSTEM:
             path_set(RARCH_PATH_SUBSYSTEM, optarg);
             break;
@@ -1139,6 +1236,9 @@ static void retroarch_parse_input_and_config(int argc, char *argv[])
       }
    }
 
+   if (runloop_benchmark)
+      retroarch_benchmark_init(config_get_ptr());
+
 #ifdef HAVE_GIT_VERSION
    RARCH_LOG("RetroArch %s (Git %s)\n",
          PACKAGE_VERSION, retroarch_git_version);
@@ -1253,6 +1353,29 @@ static void retroarch_validate_cpu_features(void)
 #endif
 }
 
+#ifdef HAVE_THREADS
+/* Hands the thread settings to rthreads, threads apply them
+ * with sthread_set_role() once they start. The main thread
+ * runs the core. */
+static void retroarch_init_thread_policy(void)
+{
+   settings_t *settings = config_get_ptr();
+   bool priority        = settings->bools.thread_priority_enable;
+
+   sthread_set_role_policy(STHREAD_ROLE_CORE,
+         settings->uints.thread_affinity_core, priority);
+   sthread_set_role_policy(STHREAD_ROLE_VIDEO,
+         settings->uints.thread_affinity_video, priority);
+   sthread_set_role_policy(STHREAD_ROLE_AUDIO,
+         settings->uints.thread_affinity_audio, priority);
+   sthread_set_role_policy(STHREAD_ROLE_BACKGROUND,
+         settings->uints.thread_affinity_background, priority);
+
+   if (!sthread_set_role(STHREAD_ROLE_CORE))
+      RARCH_WARN("[Threads]: Could not apply the core thread policy.\n");
+}
+#endif
+
 static void retroarch_main_init_media(void)
 {
    settings_t *settings     = config_get_ptr();
@@ -1311,11 +1434,66 @@ static void retroarch_main_init_media(void)
  *
  * Returns: true on success, otherwise false if there was an error.
  **/
+void retroarch_startup_step(const char *name)
+{
+   retro_time_t now;
+
+   if (!rarch_startup_active)
+      return;
+
+   now = cpu_features_get_time_usec();
+
+   if (rarch_startup_step_count)
+   {
+      unsigned last                  = rarch_startup_step_count - 1;
+      rarch_startup_steps[last].usec = now - rarch_startup_steps[last].start;
+   }
+
+   if (!name || rarch_startup_step_count == RARCH_STARTUP_STEPS_MAX)
+      return;
+
+   rarch_startup_steps[rarch_startup_step_count].name  = name;
+   rarch_startup_steps[rarch_startup_step_count].start = now;
+   rarch_startup_steps[rarch_startup_step_count].usec  = 0;
+   rarch_startup_step_count++;
+}
+
+/* Logs the timeline and adds it to the trace. Steps from
+ * before the trace was opened by --trace are cut short. */
+static void retroarch_startup_finish(void)
+{
+   unsigned i;
+   retro_time_t total = 0;
+
+   retroarch_startup_step(NULL);
+   rarch_startup_active = false;
+
+   for (i = 0; i < rarch_startup_step_count; i++)
+   {
+      char name[64];
+
+      snprintf(name, sizeof(name), "startup: %s",
+            rarch_startup_steps[i].name);
+      performance_trace_complete(name,
+            rarch_startup_steps[i].start, rarch_startup_steps[i].usec);
+
+      RARCH_LOG("[Startup]: %-12s %8.2f ms\n", rarch_startup_steps[i].name,
+            rarch_startup_steps[i].usec / 1000.0);
+      total += rarch_startup_steps[i].usec;
+   }
+
+   RARCH_LOG("[Startup]: %-12s %8.2f ms\n", "total", total / 1000.0);
+}
+
 bool retroarch_main_init(int argc, char *argv[])
 {
    bool init_failed = false;
    global_t  *global = global_get_ptr();
 
+   rarch_startup_step_count = 0;
+   rarch_startup_active     = true;
+   retroarch_startup_step("config");
+
    retroarch_init_state();
 
    if (setjmp(error_sjlj_context) > 0)
@@ -1348,12 +1526,22 @@ bool retroarch_main_init(int argc, char *argv[])
       RARCH_LOG_OUTPUT("=================================================\n");
    }
 
+   retroarch_startup_step("tasks");
+
    retroarch_validate_cpu_features();
 
+#ifdef HAVE_THREADS
+   retroarch_init_thread_policy();
+#endif
+
    rarch_ctl(RARCH_CTL_TASK_INIT, NULL);
 
+   retroarch_startup_step("media");
+
    retroarch_main_init_media();
 
+   retroarch_startup_step("core");
+
    driver_ctl(RARCH_DRIVER_CTL_INIT_PRE, NULL);
 
    /* Attempt to initialize core */
@@ -1388,6 +1576,9 @@ bool retroarch_main_init(int argc, char *argv[])
 
    command_event(CMD_EVENT_CHEATS_INIT, NULL);
    drivers_init(DRIVERS_CMD_ALL);
+
+   retroarch_startup_step("services");
+
    command_event(CMD_EVENT_COMMAND_INIT, NULL);
    command_event(CMD_EVENT_REMOTE_INIT, NULL);
    command_event(CMD_EVENT_MAPPER_INIT, NULL);
@@ -1418,12 +1609,16 @@ bool retroarch_main_init(int argc, char *argv[])
 
    if (rarch_first_start)
       rarch_first_start = false;
+
+   retroarch_startup_finish();
    return true;
 
 error:
    command_event(CMD_EVENT_CORE_DEINIT, NULL);
    rarch_is_inited         = false;
 
+   retroarch_startup_finish();
+
    if (rarch_first_start)
          rarch_first_start = false;
 
@@ -1564,6 +1759,7 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
          command_event(CMD_EVENT_HISTORY_DEINIT, NULL);
 
          config_init();
+         memory_budget_init();
 
          driver_ctl(RARCH_DRIVER_CTL_DEINIT,  NULL);
          rarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
@@ -1867,6 +2063,25 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
 #endif
             task_queue_deinit();
             task_queue_init(threaded_enable, runloop_msg_queue_push);
+#ifdef HAVE_THREADS
+            /* Shared by the parallel features, so they don't
+             * each start a thread per core. */
+            if (!rarch_jobs_inited && rjob_init(0))
+            {
+               rarch_jobs_inited = true;
+               RARCH_LOG("[Jobs]: Pool has %u workers.\n",
+                     rjob_worker_count());
+            }
+#endif
+            /* Lets the file browser and the scanner tasks share
+             * directory listings and archive indexes. */
+            dir_list_cache_enable(true);
+            file_archive_cache_enable(true);
+#ifdef HAVE_NETWORKING
+            /* Thumbnails, badges and updater lists make many
+             * requests to the same few hosts */
+            net_http_pool_enable(true);
+#endif
          }
          break;
       case RARCH_CTL_SET_CORE_SHUTDOWN:
@@ -1879,6 +2094,16 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
          return runloop_shutdown_initiated;
       case RARCH_CTL_DATA_DEINIT:
          task_queue_deinit();
+#ifdef HAVE_THREADS
+         if (rarch_jobs_inited)
+            rjob_deinit();
+         rarch_jobs_inited = false;
+#endif
+         dir_list_cache_enable(false);
+         file_archive_cache_enable(false);
+#ifdef HAVE_NETWORKING
+         net_http_pool_enable(false);
+#endif
          break;
       case RARCH_CTL_IS_CORE_OPTION_UPDATED:
          if (!runloop_core_options)
@@ -1907,10 +2132,7 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
             if (!runloop_core_options || !var)
                return false;
 
-            RARCH_LOG("Environ GET_VARIABLE %s:\n", var->key);
             core_option_manager_get(runloop_core_options, var);
-            RARCH_LOG("\t%s\n", var->value ? var->value :
-                  msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NOT_AVAILABLE));
          }
          break;
       case RARCH_CTL_CORE_OPTIONS_INIT:
@@ -2267,6 +2489,8 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
                strlcat(s, "AVX ", len);
             if (cpu & RETRO_SIMD_AVX2)
                strlcat(s, "AVX2 ", len);
+            if (cpu & RETRO_SIMD_AVX512)
+               strlcat(s, "AVX512 ", len);
             if (cpu & RETRO_SIMD_VFPU)
                strlcat(s, "VFPU ", len);
             if (cpu & RETRO_SIMD_NEON)
@@ -2279,12 +2503,18 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
                strlcat(s, "PS ", len);
             if (cpu & RETRO_SIMD_AES)
                strlcat(s, "AES ", len);
+            if (cpu & RETRO_SIMD_PCLMUL)
+               strlcat(s, "PCLMUL ", len);
             if (cpu & RETRO_SIMD_VMX)
                strlcat(s, "VMX ", len);
             if (cpu & RETRO_SIMD_VMX128)
                strlcat(s, "VMX128 ", len);
             if (cpu & RETRO_SIMD_ASIMD)
                strlcat(s, "ASIMD ", len);
+            if (cpu & RETRO_SIMD_SVE)
+               strlcat(s, "SVE ", len);
+            if (cpu & RETRO_SIMD_CRC32)
+               strlcat(s, "CRC32 ", len);
          }
          break;
       case RARCH_CAPABILITIES_COMPILER:
@@ -2439,6 +2669,19 @@ bool runloop_msg_queue_pull(const char **ret)
    return true;
 }
 
+size_t runloop_msg_queue_size(void)
+{
+   size_t size;
+#ifdef HAVE_THREADS
+   runloop_msg_queue_lock();
+#endif
+   size = msg_queue_size(runloop_msg_queue);
+#ifdef HAVE_THREADS
+   runloop_msg_queue_unlock();
+#endif
+   return size;
+}
+
 /* Time to exit out of the main loop?
  * Reasons for exiting:
  * a) Shutdown environment callback was invoked.
@@ -2613,6 +2856,12 @@ static enum runloop_state runloop_check_state(
 
    video_driver_get_status(&frame_count, &is_alive, &is_focused);
 
+   if (runloop_benchmark && !runloop_benchmark_start)
+   {
+      runloop_benchmark_start       = cpu_features_get_time_usec();
+      runloop_benchmark_start_frame = frame_count;
+   }
+
 #ifdef HAVE_MENU
    if (menu_driver_binding_state)
       BIT256_CLEAR_ALL(current_input);
@@ -2696,7 +2945,14 @@ static enum runloop_state runloop_check_state(
 
       if (time_to_exit(trig_quit_key))
       {
-         if ((runloop_max_frames != 0) && (frame_count >= runloop_max_frames))
+         bool max_frames_reached = (runloop_max_frames != 0)
+            && (frame_count >= runloop_max_frames);
+
+         if (runloop_benchmark &&
+               (max_frames_reached || bsv_movie_is_end_of_file()))
+            retroarch_benchmark_report(frame_count);
+
+         if (max_frames_reached)
          {
             if (runloop_max_frames_screenshot)
             {
@@ -2922,6 +3178,11 @@ static enum runloop_state runloop_check_state(
 
    if (menu_driver_is_alive())
    {
+      /* Nothing was presented, so there is no vsync to wait on
+       * either; sleep instead of spinning on input. */
+      if (menu_display_get_frame_skipped())
+         return RUNLOOP_STATE_POLLED_AND_SLEEP;
+
       if (!settings->bools.menu_throttle_framerate && !settings->floats.fastforward_ratio)
          return RUNLOOP_STATE_MENU_ITERATE;
 
@@ -3460,6 +3721,16 @@ int runloop_iterate(unsigned *sleep_ms)
    settings_t *settings                         = config_get_ptr();
    unsigned max_users                           = *(input_driver_get_uint(INPUT_ACTION_MAX_USERS));
 
+   performance_zones_frame(settings->bools.video_perf_overlay_show);
+
+   config_save_file_iterate();
+
+   memory_budget_iterate();
+
+#if defined(HAVE_HTTPSERVER) && defined(HAVE_ZLIB)
+   httpserver_update();
+#endif
+
 #ifdef HAVE_DISCORD
    if (discord_is_inited)
       discord_run_callbacks();
@@ -3541,8 +3812,16 @@ int runloop_iterate(unsigned *sleep_ms)
       input_push_analog_dpad(auto_binds,    dpad_mode);
    }
 
-   if ((settings->uints.video_frame_delay > 0) && !input_nonblock_state)
-      retro_sleep(settings->uints.video_frame_delay);
+   {
+      unsigned frame_delay = settings->bools.video_frame_delay_auto
+         ? video_pacing_get_frame_delay()
+         : settings->uints.video_frame_delay;
+
+      if ((frame_delay > 0) && !input_nonblock_state)
+         retro_sleep(frame_delay);
+   }
+
+   video_pacing_frame_begin();
 
 #ifdef HAVE_RUNAHEAD
    /* Run Ahead Feature replaces the call to core_run in this loop */
@@ -3551,7 +3830,10 @@ int runloop_iterate(unsigned *sleep_ms)
       && !netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL)
 #endif
       )
-      run_ahead(settings->uints.run_ahead_frames, settings->bools.run_ahead_secondary_instance);
+      run_ahead(settings->uints.run_ahead_frames,
+            settings->bools.run_ahead_secondary_instance,
+            settings->bools.run_ahead_skip_rollback,
+            settings->bools.run_ahead_secondary_threaded);
    else
 #endif
       core_run();
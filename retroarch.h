@@ -356,6 +356,16 @@ void retroarch_fail(int error_code, const char *error);
  **/
 bool retroarch_main_init(int argc, char *argv[]);
 
+/**
+ * retroarch_startup_step:
+ * @name                 : step starting now, as shown in the
+ *                         log and the trace.
+ *
+ * Ends the current step of the startup timeline, which is logged
+ * when retroarch_main_init() returns. Does nothing outside of it.
+ **/
+void retroarch_startup_step(const char *name);
+
 bool retroarch_main_quit(void);
 
 global_t *global_get_ptr(void);
@@ -378,6 +388,8 @@ void runloop_msg_queue_push(const char *msg, unsigned prio,
 
 bool runloop_msg_queue_pull(const char **ret);
 
+size_t runloop_msg_queue_size(void);
+
 void runloop_get_status(bool *is_paused, bool *is_idle, bool *is_slowmotion,
       bool *is_perfcnt_enable);
 
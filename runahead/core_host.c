@@ -0,0 +1,508 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <libretro.h>
+
+#include "core_host.h"
+
+#if defined(HAVE_DYNAMIC) && defined(HAVE_THREADS) && defined(HAVE_THREAD_STORAGE)
+
+#include <dynamic/dylib.h>
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "secondary_core.h"
+
+#include "../core.h"
+#include "../dynamic.h"
+#include "../verbosity.h"
+
+#define CORE_HOST_MAX_WORKERS 32
+
+struct core_host_instance
+{
+   struct retro_core_t core;
+   struct retro_system_av_info av_info;
+   dylib_t module;
+   char *library_path;
+   void *content_data;
+   enum retro_pixel_format pixel_format;
+
+   uint8_t *frame;
+   size_t frame_capacity;
+   size_t frame_pitch;
+   unsigned frame_width;
+   unsigned frame_height;
+
+   int16_t *audio;
+   size_t audio_frames;
+   size_t audio_capacity;
+
+   uint16_t input[CORE_HOST_MAX_PORTS];
+};
+
+/* The core callbacks have no user pointer, so the thread running an
+ * instance keeps it here. */
+static sthread_tls_t core_host_current;
+static bool core_host_current_inited;
+
+static sthread_t *core_host_workers[CORE_HOST_MAX_WORKERS];
+static unsigned core_host_worker_count;
+static slock_t *core_host_lock;
+static scond_t *core_host_cond;
+static core_host_instance_t **core_host_jobs;
+static unsigned core_host_job_count;
+static unsigned core_host_job_next;
+static unsigned core_host_job_remaining;
+static bool core_host_quit;
+
+static core_host_instance_t *core_host_get_current(void)
+{
+   return (core_host_instance_t*)sthread_tls_get(&core_host_current);
+}
+
+/* Only read-only queries go to the frontend; anything that would
+ * change its state (pixel format, geometry, HW context) stays with
+ * the instance. */
+static bool core_host_environment(unsigned cmd, void *data)
+{
+   core_host_instance_t *inst = core_host_get_current();
+
+   if (!inst)
+      return false;
+
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+      {
+         enum retro_pixel_format format = *(const enum retro_pixel_format*)data;
+
+         switch (format)
+         {
+            case RETRO_PIXEL_FORMAT_0RGB1555:
+            case RETRO_PIXEL_FORMAT_RGB565:
+            case RETRO_PIXEL_FORMAT_XRGB8888:
+               inst->pixel_format = format;
+               return true;
+            default:
+               return false;
+         }
+      }
+      case RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO:
+         inst->av_info = *(const struct retro_system_av_info*)data;
+         return true;
+      case RETRO_ENVIRONMENT_SET_GEOMETRY:
+         inst->av_info.geometry = *(const struct retro_game_geometry*)data;
+         return true;
+      case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+         *(bool*)data = true;
+         return true;
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         if (data)
+            *(int*)data = 1 | 2;
+         return true;
+      case RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME:
+         return true;
+      case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_CORE_ASSETS_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+      case RETRO_ENVIRONMENT_GET_LANGUAGE:
+      case RETRO_ENVIRONMENT_GET_USERNAME:
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         return rarch_environment_cb(cmd, data);
+      default:
+         break;
+   }
+
+   return false;
+}
+
+static void core_host_video_refresh(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   unsigned y;
+   size_t row;
+   core_host_instance_t *inst = core_host_get_current();
+
+   /* Dupes keep the last frame */
+   if (!inst || !data || data == RETRO_HW_FRAME_BUFFER_VALID)
+      return;
+
+   row = width * (inst->pixel_format == RETRO_PIXEL_FORMAT_XRGB8888
+         ? sizeof(uint32_t) : sizeof(uint16_t));
+
+   if (row * height > inst->frame_capacity)
+   {
+      uint8_t *frame = (uint8_t*)realloc(inst->frame, row * height);
+      if (!frame)
+         return;
+      inst->frame          = frame;
+      inst->frame_capacity = row * height;
+   }
+
+   for (y = 0; y < height; y++)
+      memcpy(inst->frame + y * row, (const uint8_t*)data + y * pitch, row);
+
+   inst->frame_pitch  = row;
+   inst->frame_width  = width;
+   inst->frame_height = height;
+}
+
+static size_t core_host_audio_sample_batch(const int16_t *data,
+      size_t frames)
+{
+   core_host_instance_t *inst = core_host_get_current();
+
+   if (!inst)
+      return frames;
+
+   if (inst->audio_frames + frames > inst->audio_capacity)
+   {
+      size_t capacity = (inst->audio_frames + frames) * 2;
+      int16_t *audio  = (int16_t*)realloc(inst->audio,
+            capacity * 2 * sizeof(int16_t));
+      if (!audio)
+         return frames;
+      inst->audio          = audio;
+      inst->audio_capacity = capacity;
+   }
+
+   memcpy(inst->audio + inst->audio_frames * 2, data,
+         frames * 2 * sizeof(int16_t));
+   inst->audio_frames += frames;
+   return frames;
+}
+
+static void core_host_audio_sample(int16_t left, int16_t right)
+{
+   int16_t frame[2];
+   frame[0] = left;
+   frame[1] = right;
+   core_host_audio_sample_batch(frame, 1);
+}
+
+static void core_host_input_poll(void) { }
+
+static int16_t core_host_input_state(unsigned port, unsigned device,
+      unsigned index, unsigned id)
+{
+   core_host_instance_t *inst = core_host_get_current();
+
+   if (     !inst || port >= CORE_HOST_MAX_PORTS || index != 0
+         || (device & RETRO_DEVICE_MASK) != RETRO_DEVICE_JOYPAD
+         || id > RETRO_DEVICE_ID_JOYPAD_R3)
+      return 0;
+
+   return (inst->input[port] >> id) & 1;
+}
+
+static void core_host_run_instance(core_host_instance_t *inst)
+{
+   sthread_tls_set(&core_host_current, inst);
+   inst->audio_frames = 0;
+   inst->core.retro_run();
+   sthread_tls_set(&core_host_current, NULL);
+}
+
+/* Runs instances until the batch is used up. Called with the lock. */
+static void core_host_run_jobs(void)
+{
+   while (core_host_job_next < core_host_job_count)
+   {
+      core_host_instance_t *inst = core_host_jobs[core_host_job_next++];
+
+      slock_unlock(core_host_lock);
+      core_host_run_instance(inst);
+      slock_lock(core_host_lock);
+
+      if (--core_host_job_remaining == 0)
+         scond_broadcast(core_host_cond);
+   }
+}
+
+static void core_host_worker(void *data)
+{
+   slock_lock(core_host_lock);
+   while (!core_host_quit)
+   {
+      if (core_host_job_next < core_host_job_count)
+         core_host_run_jobs();
+      else
+         scond_wait(core_host_cond, core_host_lock);
+   }
+   slock_unlock(core_host_lock);
+}
+
+static bool core_host_init(void)
+{
+   unsigned i, count;
+
+   if (core_host_current_inited)
+      return true;
+
+   if (!sthread_tls_create(&core_host_current))
+      return false;
+   core_host_current_inited = true;
+
+   core_host_lock = slock_new();
+   core_host_cond = scond_new();
+   core_host_quit = false;
+
+   if (!core_host_lock || !core_host_cond)
+   {
+      core_host_deinit();
+      return false;
+   }
+
+   /* The thread calling core_host_run() takes jobs as well */
+   count = cpu_features_get_core_amount();
+   if (count > CORE_HOST_MAX_WORKERS + 1)
+      count = CORE_HOST_MAX_WORKERS + 1;
+
+   for (i = 1; i < count; i++)
+   {
+      sthread_t *thread = sthread_create(core_host_worker, NULL);
+      if (!thread)
+         break;
+      core_host_workers[core_host_worker_count++] = thread;
+   }
+
+   RARCH_LOG("[Core Host]: %u worker threads.\n", core_host_worker_count);
+   return true;
+}
+
+void core_host_deinit(void)
+{
+   unsigned i;
+
+   if (!core_host_current_inited)
+      return;
+
+   if (core_host_lock)
+   {
+      slock_lock(core_host_lock);
+      core_host_quit = true;
+      scond_broadcast(core_host_cond);
+      slock_unlock(core_host_lock);
+   }
+
+   for (i = 0; i < core_host_worker_count; i++)
+      sthread_join(core_host_workers[i]);
+   core_host_worker_count = 0;
+
+   if (core_host_cond)
+      scond_free(core_host_cond);
+   if (core_host_lock)
+      slock_free(core_host_lock);
+   core_host_cond = NULL;
+   core_host_lock = NULL;
+
+   sthread_tls_delete(&core_host_current);
+   core_host_current_inited = false;
+}
+
+static bool core_host_load_game(core_host_instance_t *inst,
+      const char *content_path)
+{
+   struct retro_system_info system;
+   struct retro_game_info game;
+
+   if (string_is_empty(content_path))
+      return inst->core.retro_load_game(NULL);
+
+   memset(&system, 0, sizeof(system));
+   memset(&game, 0, sizeof(game));
+   inst->core.retro_get_system_info(&system);
+
+   game.path = content_path;
+
+   if (!system.need_fullpath)
+   {
+      int64_t size = 0;
+
+      if (!filestream_read_file(content_path, &inst->content_data, &size))
+         return false;
+      game.data = inst->content_data;
+      game.size = (size_t)size;
+   }
+
+   return inst->core.retro_load_game(&game);
+}
+
+core_host_instance_t *core_host_instance_new(const char *core_path,
+      const char *content_path)
+{
+   core_host_instance_t *inst = NULL;
+
+   if (string_is_empty(core_path) || !core_host_init())
+      return NULL;
+
+   inst = (core_host_instance_t*)calloc(1, sizeof(*inst));
+   if (!inst)
+      return NULL;
+
+   inst->pixel_format = RETRO_PIXEL_FORMAT_0RGB1555;
+   inst->library_path = copy_core_to_temp_file(core_path, true);
+
+   if (     !inst->library_path
+         || !init_libretro_sym_custom(CORE_TYPE_PLAIN, &inst->core,
+            inst->library_path, &inst->module))
+   {
+      RARCH_ERR("[Core Host]: Failed to load core \"%s\".\n", core_path);
+      core_host_instance_free(inst);
+      return NULL;
+   }
+
+   inst->core.symbols_inited = true;
+
+   /* Init and load on this thread, with the instance current so the
+    * environment calls land in it */
+   sthread_tls_set(&core_host_current, inst);
+
+   inst->core.retro_set_environment(core_host_environment);
+   inst->core.retro_init();
+   inst->core.inited = true;
+
+   inst->core.game_loaded = core_host_load_game(inst, content_path);
+
+   if (inst->core.game_loaded)
+   {
+      inst->core.retro_get_system_av_info(&inst->av_info);
+      inst->core.retro_set_video_refresh(core_host_video_refresh);
+      inst->core.retro_set_audio_sample(core_host_audio_sample);
+      inst->core.retro_set_audio_sample_batch(core_host_audio_sample_batch);
+      inst->core.retro_set_input_poll(core_host_input_poll);
+      inst->core.retro_set_input_state(core_host_input_state);
+   }
+
+   sthread_tls_set(&core_host_current, NULL);
+
+   if (!inst->core.game_loaded)
+   {
+      RARCH_ERR("[Core Host]: Failed to load content \"%s\".\n",
+            content_path ? content_path : "");
+      core_host_instance_free(inst);
+      return NULL;
+   }
+
+   return inst;
+}
+
+void core_host_instance_free(core_host_instance_t *inst)
+{
+   if (!inst)
+      return;
+
+   if (inst->module)
+   {
+      sthread_tls_set(&core_host_current, inst);
+      if (inst->core.game_loaded)
+         inst->core.retro_unload_game();
+      if (inst->core.inited)
+         inst->core.retro_deinit();
+      sthread_tls_set(&core_host_current, NULL);
+      dylib_close(inst->module);
+   }
+
+   if (inst->library_path)
+   {
+      filestream_delete(inst->library_path);
+      free(inst->library_path);
+   }
+
+   free(inst->content_data);
+   free(inst->frame);
+   free(inst->audio);
+   free(inst);
+}
+
+void core_host_instance_set_input(core_host_instance_t *inst,
+      unsigned port, uint16_t buttons)
+{
+   if (port < CORE_HOST_MAX_PORTS)
+      inst->input[port] = buttons;
+}
+
+const void *core_host_instance_get_frame(core_host_instance_t *inst,
+      unsigned *width, unsigned *height, size_t *pitch,
+      enum retro_pixel_format *format)
+{
+   *width  = inst->frame_width;
+   *height = inst->frame_height;
+   *pitch  = inst->frame_pitch;
+   *format = inst->pixel_format;
+   return inst->frame_width ? inst->frame : NULL;
+}
+
+const int16_t *core_host_instance_get_audio(core_host_instance_t *inst,
+      size_t *frames)
+{
+   *frames = inst->audio_frames;
+   return inst->audio;
+}
+
+void core_host_instance_get_av_info(core_host_instance_t *inst,
+      struct retro_system_av_info *av_info)
+{
+   *av_info = inst->av_info;
+}
+
+void core_host_run(core_host_instance_t **instances, unsigned count)
+{
+   if (!count || !core_host_lock)
+      return;
+
+   slock_lock(core_host_lock);
+   core_host_jobs           = instances;
+   core_host_job_count      = count;
+   core_host_job_next       = 0;
+   core_host_job_remaining  = count;
+   scond_broadcast(core_host_cond);
+
+   core_host_run_jobs();
+
+   while (core_host_job_remaining)
+      scond_wait(core_host_cond, core_host_lock);
+
+   core_host_jobs           = NULL;
+   core_host_job_count      = 0;
+   core_host_job_next       = 0;
+   slock_unlock(core_host_lock);
+}
+
+#else
+
+core_host_instance_t *core_host_instance_new(const char *core_path,
+      const char *content_path)
+{
+   return NULL;
+}
+
+void core_host_instance_free(core_host_instance_t *inst) { }
+void core_host_instance_set_input(core_host_instance_t *inst,
+      unsigned port, uint16_t buttons) { }
+
+const void *core_host_instance_get_frame(core_host_instance_t *inst,
+      unsigned *width, unsigned *height, size_t *pitch,
+      enum retro_pixel_format *format)
+{
+   return NULL;
+}
+
+const int16_t *core_host_instance_get_audio(core_host_instance_t *inst,
+      size_t *frames)
+{
+   *frames = 0;
+   return NULL;
+}
+
+void core_host_instance_get_av_info(core_host_instance_t *inst,
+      struct retro_system_av_info *av_info) { }
+void core_host_run(core_host_instance_t **instances, unsigned count) { }
+void core_host_deinit(void) { }
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __CORE_HOST_H__
+#define __CORE_HOST_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+#include <libretro.h>
+
+RETRO_BEGIN_DECLS
+
+/* Extra, independent core instances hosted in this process, for
+ * servers that run many sessions side by side. Each instance loads its
+ * own copy of the core library the way the runahead secondary core
+ * does, renders into memory and keeps its audio, and talks to nothing
+ * but this module, so the frontend's drivers and settings are left
+ * alone. Core info, databases, directories and logging are shared
+ * with the frontend. */
+
+#define CORE_HOST_MAX_PORTS 8
+
+typedef struct core_host_instance core_host_instance_t;
+
+/* Loads @core_path and @content_path (NULL for contentless cores).
+ * Hardware rendered cores are refused. */
+core_host_instance_t *core_host_instance_new(const char *core_path,
+      const char *content_path);
+
+void core_host_instance_free(core_host_instance_t *inst);
+
+/* Joypad state for the next frame, one bit per RETRO_DEVICE_ID_JOYPAD. */
+void core_host_instance_set_input(core_host_instance_t *inst,
+      unsigned port, uint16_t buttons);
+
+/* The last frame the core rendered, NULL before the first one. */
+const void *core_host_instance_get_frame(core_host_instance_t *inst,
+      unsigned *width, unsigned *height, size_t *pitch,
+      enum retro_pixel_format *format);
+
+/* Interleaved stereo samples from the last core_host_run(). */
+const int16_t *core_host_instance_get_audio(core_host_instance_t *inst,
+      size_t *frames);
+
+void core_host_instance_get_av_info(core_host_instance_t *inst,
+      struct retro_system_av_info *av_info);
+
+/* Runs one frame of each of the @count instances on the shared worker
+ * pool, and returns once all of them are done. */
+void core_host_run(core_host_instance_t **instances, unsigned count);
+
+/* Stops the worker pool. Instances must be freed first. */
+void core_host_deinit(void);
+
+RETRO_END_DECLS
+
+#endif
@@ -2,6 +2,10 @@
 
 #include <boolean.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "../core.h"
 #include "../dynamic.h"
 
@@ -10,7 +14,13 @@
 #include "dirty_input.h"
 
 bool input_is_dirty             = false;
+bool core_state_is_replaced     = false;
 static MyList *input_state_list = NULL;
+#ifdef HAVE_THREADS
+/* A threaded secondary core reads the list while
+ * the primary core logs into it. */
+static slock_t *input_state_lock = NULL;
+#endif
 
 typedef struct InputListElement_t
 {
@@ -19,6 +29,7 @@ typedef struct InputListElement_t
    unsigned index;
    int16_t *state;
    unsigned int state_size;
+   unsigned int state_used;
 } InputListElement;
 
 extern struct retro_core_t current_core;
@@ -101,6 +112,8 @@ static void input_state_set_last(unsigned port, unsigned device,
          {
             InputListElementExpand(element, id);
          }
+         if (id >= element->state_used)
+            element->state_used = id + 1;
          element->state[id] = value;
          return;
       }
@@ -115,10 +128,11 @@ static void input_state_set_last(unsigned port, unsigned device,
    {
       InputListElementExpand(element, id);
    }
+   element->state_used = id + 1;
    element->state[id] = value;
 }
 
-int16_t input_state_get_last(unsigned port,
+static int16_t input_state_get_last_unlocked(unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
    unsigned i;
@@ -144,17 +158,68 @@ int16_t input_state_get_last(unsigned port,
    return 0;
 }
 
+int16_t input_state_get_last(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   int16_t result;
+#ifdef HAVE_THREADS
+   if (input_state_lock)
+      slock_lock(input_state_lock);
+#endif
+   result = input_state_get_last_unlocked(port, device, index, id);
+#ifdef HAVE_THREADS
+   if (input_state_lock)
+      slock_unlock(input_state_lock);
+#endif
+   return result;
+}
+
+bool input_state_is_unchanged(void)
+{
+   unsigned i, id;
+
+   if (!input_state_list || !input_state_callback_original)
+      return false;
+
+   /* Only ids the core has asked for are compared; an id it has
+    * never read before still marks the input dirty once it runs. */
+   for (i = 0; i < (unsigned)input_state_list->size; i++)
+   {
+      InputListElement *element =
+         (InputListElement*)input_state_list->data[i];
+
+      for (id = 0; id < element->state_used; id++)
+      {
+         if (input_state_callback_original(element->port,
+                  element->device, element->index, id)
+               != element->state[id])
+            return false;
+      }
+   }
+   return true;
+}
+
 static int16_t input_state_with_logging(unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
    if (input_state_callback_original)
    {
+      int16_t last_input;
       int16_t result     = input_state_callback_original(
             port, device, index, id);
-      int16_t last_input = input_state_get_last(port, device, index, id);
+#ifdef HAVE_THREADS
+      if (input_state_lock)
+         slock_lock(input_state_lock);
+#endif
+      last_input         = input_state_get_last_unlocked(
+            port, device, index, id);
       if (result != last_input)
          input_is_dirty = true;
       input_state_set_last(port, device, index, id, result);
+#ifdef HAVE_THREADS
+      if (input_state_lock)
+         slock_unlock(input_state_lock);
+#endif
       return result;
    }
    return 0;
@@ -162,14 +227,16 @@ static int16_t input_state_with_logging(unsigned port,
 
 static void reset_hook(void)
 {
-   input_is_dirty = true;
+   input_is_dirty         = true;
+   core_state_is_replaced = true;
    if (retro_reset_callback_original)
       retro_reset_callback_original();
 }
 
 static bool unserialze_hook(const void *buf, size_t size)
 {
-   input_is_dirty = true;
+   input_is_dirty         = true;
+   core_state_is_replaced = true;
    if (retro_unserialize_callback_original)
       return retro_unserialize_callback_original(buf, size);
    return false;
@@ -179,6 +246,9 @@ void add_input_state_hook(void)
 {
    if (!input_state_callback_original)
    {
+#ifdef HAVE_THREADS
+      input_state_lock              = slock_new();
+#endif
       input_state_callback_original = retro_ctx.state_cb;
       retro_ctx.state_cb            = input_state_with_logging;
       current_core.retro_set_input_state(retro_ctx.state_cb);
@@ -205,6 +275,11 @@ void remove_input_state_hook(void)
       current_core.retro_set_input_state(retro_ctx.state_cb);
       input_state_callback_original = NULL;
       input_state_destroy();
+#ifdef HAVE_THREADS
+      if (input_state_lock)
+         slock_free(input_state_lock);
+      input_state_lock              = NULL;
+#endif
    }
 
    if (retro_reset_callback_original)
@@ -7,11 +7,16 @@
 RETRO_BEGIN_DECLS
 
 extern bool input_is_dirty;
+extern bool core_state_is_replaced;
 void add_input_state_hook(void);
 void remove_input_state_hook(void);
 int16_t input_state_get_last(unsigned port,
    unsigned device, unsigned index, unsigned id);
 
+/* Queries every input the core has read so far and returns
+ * true if all of them still return their logged value. */
+bool input_state_is_unchanged(void);
+
 RETRO_END_DECLS
 
 #endif
@@ -1,8 +1,13 @@
+#include <stdio.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <boolean.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <compat/strl.h>
+#include <memalign.h>
 
 #include "dirty_input.h"
 #include "mylist.h"
@@ -10,15 +15,21 @@
 #include "run_ahead.h"
 
 #include "../core.h"
+#include "../input/input_driver.h"
 #include "../dynamic.h"
 #include "../audio/audio_driver.h"
 #include "../gfx/video_driver.h"
+#include "../gfx/video_pacing.h"
 #include "../configuration.h"
 #include "../retroarch.h"
+#include "../msg_hash.h"
+#include "../verbosity.h"
 
 static bool runahead_create(void);
 static bool runahead_save_state(void);
 static bool runahead_load_state(void);
+static bool runahead_save_state_index(int index);
+static bool runahead_load_state_index(int index);
 static bool runahead_load_state_secondary(void);
 static bool runahead_run_secondary(void);
 static void runahead_suspend_audio(void);
@@ -30,7 +41,11 @@ static void unset_fast_savestate(void);
 static void set_hard_disable_audio(void);
 static void unset_hard_disable_audio(void);
 
+static void runahead_error(void);
+static void runahead_input_poll_null(void);
+
 static bool core_run_use_last_input(void);
+static void runahead_core_run(void);
 
 static size_t runahead_save_state_size = 0;
 static bool runahead_save_state_size_known = false;
@@ -52,7 +67,7 @@ static void *runahead_save_state_alloc(void)
 
    if (runahead_save_state_size > 0 && runahead_save_state_size_known)
    {
-      savestate->data       = malloc(runahead_save_state_size);
+      savestate->data       = memalign_alloc_large(runahead_save_state_size);
       savestate->data_const = savestate->data;
       savestate->size       = runahead_save_state_size;
    }
@@ -65,7 +80,7 @@ static void runahead_save_state_free(void *state)
    retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)state;
    if (!savestate)
       return;
-   free(savestate->data);
+   memalign_free_large(savestate->data);
    free(savestate);
 }
 
@@ -107,6 +122,8 @@ extern struct retro_callbacks retro_ctx;
 
 static void remove_hooks(void)
 {
+   secondary_core_wait_async(false);
+
    if (originalRetroDeinit)
    {
       current_core.retro_deinit = originalRetroDeinit;
@@ -165,6 +182,40 @@ static bool runahead_secondary_core_available = true;
 static bool runahead_force_input_dirty        = true;
 static uint64_t runahead_last_frame_count     = 0;
 
+/* Skip rollback: the core is left at the speculative state and
+ * runahead_save_state_list holds the last 'runahead_ahead_count'
+ * states it passed through, the oldest (at 'runahead_ring_start')
+ * being the real, non-speculative state. */
+static int runahead_ahead_count               = 0;
+static int runahead_ring_start                = 0;
+
+static runahead_stats_t runahead_stats;
+
+/* Core frames run by the current run_ahead() call. */
+static unsigned runahead_frames_run           = 0;
+
+/* Automatic frame count, -1 until the first frame. */
+#define RUNAHEAD_AUTO_WINDOW 64
+#define RUNAHEAD_AUTO_HOLD   4
+static int runahead_auto_count                = -1;
+static retro_time_t runahead_auto_peak        = 0;
+static unsigned runahead_auto_frames          = 0;
+static unsigned runahead_auto_hold            = 0;
+
+/* Lag detection. The first attempt waits for the game to get past
+ * its boot screens, and a game that ignored every button gets
+ * another one a while later. */
+#define RUNAHEAD_DETECT_FRAMES   8
+#define RUNAHEAD_DETECT_START    600
+#define RUNAHEAD_DETECT_RETRY    300
+#define RUNAHEAD_DETECT_ATTEMPTS 10
+static int runahead_detect_lag                = -1;
+static unsigned runahead_detect_wait          = RUNAHEAD_DETECT_START;
+static unsigned runahead_detect_attempts      = 0;
+static int runahead_detect_button             = -1;
+static uint32_t runahead_detect_video_crc     = 0;
+static bool runahead_detect_video_seen        = false;
+
 static void runahead_clear_variables(void)
 {
    runahead_save_state_size          = 0;
@@ -174,6 +225,15 @@ static void runahead_clear_variables(void)
    runahead_secondary_core_available = true;
    runahead_force_input_dirty        = true;
    runahead_last_frame_count         = 0;
+   runahead_ahead_count              = 0;
+   runahead_ring_start               = 0;
+   runahead_auto_count               = -1;
+   runahead_auto_peak                = 0;
+   runahead_auto_frames              = 0;
+   runahead_auto_hold                = 0;
+   runahead_detect_lag               = -1;
+   runahead_detect_wait              = RUNAHEAD_DETECT_START;
+   runahead_detect_attempts          = 0;
 }
 
 static uint64_t runahead_get_frame_count()
@@ -196,11 +256,110 @@ static void runahead_check_for_gui(void)
    runahead_last_frame_count = frame_count;
 }
 
-void run_ahead(int runahead_count, bool useSecondary)
+/* Puts the core back at its real state, if it was left ahead. */
+static bool runahead_leave_ahead(void)
+{
+   bool okay = true;
+
+   if (runahead_ahead_count == 0)
+      return true;
+
+   if (!core_state_is_replaced)
+      okay = runahead_load_state_index(runahead_ring_start);
+
+   runahead_ahead_count   = 0;
+   runahead_ring_start    = 0;
+   core_state_is_replaced = false;
+   return okay;
+}
+
+/* Runs the real frame from the real state, then speculates
+ * 'runahead_count' frames with the same input, saving before each. */
+static bool runahead_run_from_real_state(int runahead_count)
+{
+   int frame_number;
+
+   mylist_resize(runahead_save_state_list, runahead_count, true);
+
+   runahead_suspend_audio();
+   runahead_suspend_video();
+   runahead_core_run();
+   runahead_resume_video();
+   runahead_resume_audio();
+
+   for (frame_number = 0; frame_number < runahead_count; frame_number++)
+   {
+      bool last_frame = frame_number == runahead_count - 1;
+
+      if (!runahead_save_state_index(frame_number))
+         return false;
+
+      if (!last_frame)
+      {
+         runahead_suspend_audio();
+         runahead_suspend_video();
+      }
+
+      core_run_use_last_input();
+
+      if (!last_frame)
+      {
+         runahead_resume_video();
+         runahead_resume_audio();
+      }
+   }
+
+   runahead_ahead_count   = runahead_count;
+   runahead_ring_start    = 0;
+   core_state_is_replaced = false;
+   input_is_dirty         = false;
+   return true;
+}
+
+static bool runahead_run_skip_rollback(int runahead_count)
+{
+   if (core_state_is_replaced)
+   {
+      /* A savestate load or reset already put the core at a real state. */
+      runahead_ahead_count   = 0;
+      core_state_is_replaced = false;
+   }
+
+   if (runahead_ahead_count != runahead_count || runahead_force_input_dirty)
+   {
+      if (!runahead_leave_ahead())
+         return false;
+      return runahead_run_from_real_state(runahead_count);
+   }
+
+   input_poll();
+
+   if (!input_state_is_unchanged())
+   {
+      /* Mispredicted, roll back to the real state. */
+      if (!runahead_load_state_index(runahead_ring_start))
+         return false;
+      return runahead_run_from_real_state(runahead_count);
+   }
+
+   /* The speculated frames used the right input, so the next real
+    * state is already in the list and only one frame has to run. */
+   if (!runahead_save_state_index(runahead_ring_start))
+      return false;
+   runahead_ring_start = (runahead_ring_start + 1) % runahead_count;
+
+   runahead_core_run();
+   return true;
+}
+
+static void runahead_run(int runahead_count, bool useSecondary,
+      bool skipRollback, bool threadedSecondary)
 {
    int frame_number        = 0;
    bool last_frame         = false;
    bool suspended_frame    = false;
+   bool threaded           = false;
+   bool presented          = false;
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    const bool have_dynamic = true;
 #else
@@ -209,7 +368,9 @@ void run_ahead(int runahead_count, bool useSecondary)
 
    if (runahead_count <= 0 || !runahead_available)
    {
-      core_run();
+      if (runahead_available)
+         runahead_leave_ahead();
+      runahead_core_run();
       runahead_force_input_dirty = true;
       return;
    }
@@ -223,7 +384,7 @@ void run_ahead(int runahead_count, bool useSecondary)
          {
             runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_CORE_DOES_NOT_SUPPORT_SAVESTATES), 0, 2 * 60, true);
          }
-         core_run();
+         runahead_core_run();
          runahead_force_input_dirty = true;
          return;
       }
@@ -231,10 +392,26 @@ void run_ahead(int runahead_count, bool useSecondary)
 
    runahead_check_for_gui();
 
-   if (!useSecondary || !have_dynamic || !runahead_secondary_core_available)
+   if (skipRollback && (!useSecondary || !have_dynamic
+            || !runahead_secondary_core_available))
+   {
+      if (!runahead_run_skip_rollback(runahead_count))
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true);
+         return;
+      }
+   }
+   else if (!runahead_leave_ahead())
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true);
+      return;
+   }
+   else if (!useSecondary || !have_dynamic || !runahead_secondary_core_available)
    {
       /* TODO: multiple savestates for higher performance 
        * when not using secondary core */
+      mylist_resize(runahead_save_state_list, 1, true);
+
       for (frame_number = 0; frame_number <= runahead_count; frame_number++)
       {
          last_frame      = frame_number == runahead_count;
@@ -247,7 +424,7 @@ void run_ahead(int runahead_count, bool useSecondary)
          }
 
          if (frame_number == 0)
-            core_run();
+            runahead_core_run();
          else
             core_run_use_last_input();
 
@@ -283,17 +460,33 @@ void run_ahead(int runahead_count, bool useSecondary)
       {
          runahead_secondary_core_available = false;
          runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_CREATE_SECONDARY_INSTANCE), 0, 3 * 60, true);
-         core_run();
+         runahead_core_run();
          runahead_force_input_dirty = true;
          return;
       }
 
-      /* run main core with video suspended */
+      /* Hardware rendered frames can't be handed over between threads. */
+      threaded = threadedSecondary &&
+         video_driver_get_hw_context()->context_type == RETRO_HW_CONTEXT_NONE;
+
+      /* A frame speculated by the worker advanced the secondary core. */
+      if (!threaded && secondary_core_wait_async(false))
+         runahead_force_input_dirty = true;
+
+      /* run main core with video suspended, the worker
+       * (if any) is running the secondary core meanwhile */
       runahead_suspend_video();
-      core_run();
+      runahead_core_run();
       runahead_resume_video();
 
-      if (input_is_dirty || runahead_force_input_dirty)
+      /* If the input matched the prediction, the worker's frame is
+       * the one the secondary would have produced now. */
+      if (     threaded
+            && !input_is_dirty
+            && !runahead_force_input_dirty
+            && secondary_core_wait_async(true))
+         presented = true;
+      else if (input_is_dirty || runahead_force_input_dirty)
       {
          input_is_dirty       = false;
 
@@ -320,16 +513,306 @@ void run_ahead(int runahead_count, bool useSecondary)
             runahead_resume_video();
          }
       }
-      runahead_suspend_audio();
-      set_hard_disable_audio();
-      runahead_run_secondary();
-      unset_hard_disable_audio();
-      runahead_resume_audio();
+
+      if (!presented)
+      {
+         runahead_suspend_audio();
+         set_hard_disable_audio();
+         runahead_run_secondary();
+         unset_hard_disable_audio();
+         runahead_resume_audio();
+      }
+
+      /* Speculate the next frame while the main thread presents. */
+      if (threaded)
+         secondary_core_run_async();
 #endif
    }
    runahead_force_input_dirty = false;
 }
 
+static void runahead_detect_video_cb(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   unsigned y;
+   size_t row = width *
+      (video_driver_get_pixel_format() == RETRO_PIXEL_FORMAT_XRGB8888
+       ? sizeof(uint32_t) : sizeof(uint16_t));
+
+   if (!data || data == RETRO_HW_FRAME_BUFFER_VALID)
+      return;
+
+   runahead_detect_video_crc  = 0;
+   runahead_detect_video_seen = true;
+
+   for (y = 0; y < height; y++)
+      runahead_detect_video_crc = encoding_crc32(runahead_detect_video_crc,
+            (const uint8_t*)data + y * pitch, row);
+}
+
+static int16_t runahead_detect_input_state(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   int16_t state = input_state_get_last(port, device, index, id);
+
+   if (     port == 0 && index == 0
+         && (device & RETRO_DEVICE_MASK) == RETRO_DEVICE_JOYPAD
+         && (int)id == runahead_detect_button)
+      return !state;
+   return state;
+}
+
+/* Runs RUNAHEAD_DETECT_FRAMES frames from the saved state with the
+ * last input, 'button' flipped on the first pad (-1 for none), and
+ * keeps a hash of each frame's picture and of the system RAM. */
+static bool runahead_detect_trial(retro_ctx_serialize_info_t *state,
+      int button, uint32_t *video, uint32_t *memory, bool *have_video)
+{
+   unsigned i;
+
+   set_fast_savestate();
+   if (!current_core.retro_unserialize(state->data_const, state->size))
+   {
+      unset_fast_savestate();
+      return false;
+   }
+   unset_fast_savestate();
+
+   runahead_detect_button = button;
+   *have_video            = true;
+
+   current_core.retro_set_input_poll(runahead_input_poll_null);
+   current_core.retro_set_input_state(runahead_detect_input_state);
+   current_core.retro_set_video_refresh(runahead_detect_video_cb);
+
+   for (i = 0; i < RUNAHEAD_DETECT_FRAMES; i++)
+   {
+      retro_ctx_memory_info_t mem_info;
+
+      runahead_detect_video_seen = false;
+      current_core.retro_run();
+
+      mem_info.id   = RETRO_MEMORY_SYSTEM_RAM;
+      mem_info.data = NULL;
+      mem_info.size = 0;
+      core_get_memory(&mem_info);
+
+      video[i]      = runahead_detect_video_crc;
+      memory[i]     = mem_info.data ? encoding_crc32(0,
+            (const uint8_t*)mem_info.data, mem_info.size) : 0;
+      if (!runahead_detect_video_seen)
+         *have_video = false;
+   }
+
+   current_core.retro_set_input_poll(retro_ctx.poll_cb);
+   current_core.retro_set_input_state(retro_ctx.state_cb);
+   current_core.retro_set_video_refresh(retro_ctx.frame_cb);
+   runahead_detect_button = -1;
+   return true;
+}
+
+/* Finds the first frame that shows a button press by replaying the
+ * same frames from a savestate with and without it. Picture hashes
+ * are compared when the core hands out software frames, RAM hashes
+ * otherwise. The core is put back at the state it started from. */
+static void runahead_detect(void)
+{
+   static const unsigned buttons[] = {
+      RETRO_DEVICE_ID_JOYPAD_B,    RETRO_DEVICE_ID_JOYPAD_A,
+      RETRO_DEVICE_ID_JOYPAD_Y,    RETRO_DEVICE_ID_JOYPAD_X,
+      RETRO_DEVICE_ID_JOYPAD_UP,   RETRO_DEVICE_ID_JOYPAD_DOWN,
+      RETRO_DEVICE_ID_JOYPAD_LEFT, RETRO_DEVICE_ID_JOYPAD_RIGHT,
+   };
+   unsigned i, j;
+   bool have_video, have_video2;
+   uint32_t video[RUNAHEAD_DETECT_FRAMES], memory[RUNAHEAD_DETECT_FRAMES];
+   uint32_t video2[RUNAHEAD_DETECT_FRAMES], memory2[RUNAHEAD_DETECT_FRAMES];
+   int lag                           = -1;
+   bool okay                         = false;
+   retro_ctx_serialize_info_t *state = (retro_ctx_serialize_info_t*)
+      runahead_save_state_alloc();
+
+   if (!state || !state->data)
+      goto end;
+
+   set_fast_savestate();
+   okay = core_serialize(state);
+   unset_fast_savestate();
+   if (!okay)
+      goto end;
+
+   runahead_suspend_audio();
+   set_hard_disable_audio();
+
+   /* A core that doesn't replay the same frames can't be measured. */
+   okay = runahead_detect_trial(state, -1, video, memory, &have_video)
+      &&  runahead_detect_trial(state, -1, video2, memory2, &have_video2)
+      &&  memcmp(have_video ? video : memory, have_video ? video2 : memory2,
+            sizeof(video)) == 0;
+
+   for (i = 0; okay && i < ARRAY_SIZE(buttons) && lag != 0; i++)
+   {
+      if (!runahead_detect_trial(state, buttons[i], video2, memory2,
+               &have_video2))
+      {
+         okay = false;
+         break;
+      }
+
+      for (j = 0; j < RUNAHEAD_DETECT_FRAMES; j++)
+      {
+         if (have_video ? video[j] != video2[j] : memory[j] != memory2[j])
+         {
+            if (lag < 0 || (int)j < lag)
+               lag = j;
+            break;
+         }
+      }
+   }
+
+   unset_hard_disable_audio();
+   runahead_resume_audio();
+
+   set_fast_savestate();
+   if (!current_core.retro_unserialize(state->data_const, state->size))
+      runahead_error();
+   unset_fast_savestate();
+
+   if (!okay)
+   {
+      RARCH_WARN("[Run-Ahead]: Can't detect input lag, the core doesn't replay the same frames.\n");
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_LAG_DETECTION_FAILED), 0, 3 * 60, true);
+      runahead_detect_attempts = RUNAHEAD_DETECT_ATTEMPTS;
+   }
+   else if (lag >= 0)
+   {
+      char msg[128];
+
+      RARCH_LOG("[Run-Ahead]: Game reacts to input after %d frames (%s).\n",
+            lag, have_video ? "video" : "memory");
+      runahead_detect_lag = lag;
+
+      if (lag > 0)
+         snprintf(msg, sizeof(msg),
+               msg_hash_to_str(MSG_RUNAHEAD_LAG_DETECTED), (unsigned)lag);
+      else
+         strlcpy(msg, msg_hash_to_str(MSG_RUNAHEAD_NO_LAG_DETECTED),
+               sizeof(msg));
+      runloop_msg_queue_push(msg, 0, 3 * 60, true);
+   }
+
+end:
+   runahead_save_state_free(state);
+   runahead_force_input_dirty = true;
+}
+
+/* Keeps RUNAHEAD_AUTO_WINDOW frames of the costliest core frame,
+ * savestates included, and checks what running 'count' of them
+ * plus the real one would take against the time left in the frame. */
+static int runahead_auto_update(int count, int max_count,
+      retro_time_t frame_cost)
+{
+   retro_time_t budget;
+   settings_t *settings = config_get_ptr();
+   unsigned frame_delay = settings->bools.video_frame_delay_auto
+      ? video_pacing_get_frame_delay()
+      : settings->uints.video_frame_delay;
+
+   budget = video_pacing_get_period();
+   if (!budget)
+   {
+      struct retro_system_av_info *av_info =
+         video_viewport_get_system_av_info();
+      if (av_info && av_info->timing.fps > 0.0)
+         budget = (retro_time_t)(1000000.0 / av_info->timing.fps);
+   }
+   budget -= frame_delay * 1000;
+
+   if (count > max_count)
+      count = max_count;
+
+   if (budget <= 0)
+      return count;
+
+   if (frame_cost > runahead_auto_peak)
+      runahead_auto_peak = frame_cost;
+
+   /* A frame that couldn't have made it backs off right away. */
+   if (count > 0 && frame_cost * (count + 1) > budget)
+   {
+      runahead_auto_hold = RUNAHEAD_AUTO_HOLD;
+      return count - 1;
+   }
+
+   if (++runahead_auto_frames < RUNAHEAD_AUTO_WINDOW)
+      return count;
+
+   /* Leave a quarter of the frame to the video driver, and only go
+    * up when the next count would still fit in half of it. */
+   if (count > 0 && runahead_auto_peak * (count + 1) > budget * 3 / 4)
+   {
+      runahead_auto_hold = RUNAHEAD_AUTO_HOLD;
+      count--;
+   }
+   else if (runahead_auto_hold)
+      runahead_auto_hold--;
+   else if (count < max_count
+         && runahead_auto_peak * (count + 2) < budget / 2)
+      count++;
+
+   runahead_auto_peak   = 0;
+   runahead_auto_frames = 0;
+   return count;
+}
+
+void run_ahead(int runahead_count, bool useSecondary, bool skipRollback,
+      bool threadedSecondary)
+{
+   retro_time_t start;
+   settings_t *settings = config_get_ptr();
+   int count            = runahead_count;
+
+   if (     settings->bools.run_ahead_detect_lag
+         && runahead_available && runahead_save_state_size_known
+         && runahead_detect_lag < 0
+         && runahead_detect_attempts < RUNAHEAD_DETECT_ATTEMPTS
+         && --runahead_detect_wait == 0)
+   {
+      runahead_detect_attempts++;
+      runahead_detect_wait = RUNAHEAD_DETECT_RETRY;
+      if (runahead_leave_ahead())
+      {
+         secondary_core_wait_async(false);
+         runahead_detect();
+      }
+   }
+
+   if (settings->bools.run_ahead_detect_lag && runahead_detect_lag >= 0)
+      count = runahead_detect_lag;
+
+   if (settings->bools.run_ahead_frames_auto)
+   {
+      if (runahead_auto_count < 0)
+         runahead_auto_count = count;
+      if (runahead_auto_count > count)
+         runahead_auto_count = count;
+      count = runahead_auto_count;
+   }
+
+   start               = cpu_features_get_time_usec();
+   runahead_frames_run = 0;
+
+   runahead_run(count, useSecondary, skipRollback, threadedSecondary);
+
+   runahead_stats.frames = count;
+
+   if (settings->bools.run_ahead_frames_auto && runahead_frames_run)
+      runahead_auto_count = runahead_auto_update(count,
+            settings->bools.run_ahead_detect_lag && runahead_detect_lag >= 0
+            ? runahead_detect_lag : runahead_count,
+            (cpu_features_get_time_usec() - start) / runahead_frames_run);
+}
+
 static void runahead_error(void)
 {
    runahead_available = false;
@@ -363,13 +846,18 @@ static bool runahead_create(void)
 }
 
 static bool runahead_save_state(void)
+{
+   return runahead_save_state_index(0);
+}
+
+static bool runahead_save_state_index(int index)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info;
    if (!runahead_save_state_list)
       return false;
    serialize_info =
-      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[0];
+      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[index];
    set_fast_savestate();
    okay = core_serialize(serialize_info);
    unset_fast_savestate();
@@ -382,11 +870,17 @@ static bool runahead_save_state(void)
 }
 
 static bool runahead_load_state(void)
+{
+   return runahead_load_state_index(0);
+}
+
+static bool runahead_load_state_index(int index)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      runahead_save_state_list->data[0];
+      runahead_save_state_list->data[index];
    bool last_dirty                            = input_is_dirty;
+   bool last_replaced                         = core_state_is_replaced;
 
    set_fast_savestate();
    /* calling core_unserialize has side effects with 
@@ -395,10 +889,13 @@ static bool runahead_load_state(void)
    okay = current_core.retro_unserialize(
          serialize_info->data_const, serialize_info->size);
    unset_fast_savestate();
-   input_is_dirty = last_dirty;
+   input_is_dirty         = last_dirty;
+   core_state_is_replaced = last_replaced;
 
    if (!okay)
       runahead_error();
+   else
+      runahead_stats.rollbacks++;
 
    return okay;
 }
@@ -421,11 +918,13 @@ static bool runahead_load_state_secondary(void)
       return false;
    }
 
+   runahead_stats.rollbacks++;
    return true;
 }
 
 static bool runahead_run_secondary(void)
 {
+   runahead_frames_run++;
    if (!secondary_core_run_use_last_input())
    {
       runahead_secondary_core_available = false;
@@ -446,6 +945,7 @@ static void runahead_resume_audio(void)
 
 static void runahead_suspend_video(void)
 {
+   runahead_stats.hidden_frames++;
    video_driver_unset_active();
 }
 
@@ -462,6 +962,27 @@ void runahead_destroy(void)
    runahead_save_state_list_destroy();
    remove_hooks();
    runahead_clear_variables();
+   memset(&runahead_stats, 0, sizeof(runahead_stats));
+}
+
+void runahead_get_stats(runahead_stats_t *stats)
+{
+   *stats = runahead_stats;
+}
+
+void runahead_replay_begin(void)
+{
+   runahead_video_driver_is_active = video_driver_is_active();
+   video_driver_unset_active();
+   runahead_suspend_audio();
+   set_fast_savestate();
+}
+
+void runahead_replay_end(void)
+{
+   unset_fast_savestate();
+   runahead_resume_audio();
+   runahead_resume_video();
 }
 
 static bool request_fast_savestate;
@@ -502,6 +1023,12 @@ static void runahead_input_poll_null(void)
 {
 }
 
+static void runahead_core_run(void)
+{
+   runahead_frames_run++;
+   core_run();
+}
+
 static bool core_run_use_last_input(void)
 {
    extern struct retro_callbacks retro_ctx;
@@ -510,6 +1037,8 @@ static bool core_run_use_last_input(void)
    retro_input_poll_t old_poll_function = retro_ctx.poll_cb;
    retro_input_state_t old_input_function = retro_ctx.state_cb;
 
+   runahead_frames_run++;
+
    retro_ctx.poll_cb = runahead_input_poll_null;
    retro_ctx.state_cb = input_state_get_last;
 
@@ -2,6 +2,7 @@
 #define __RUN_AHEAD_H__
 
 #include <stddef.h>
+#include <stdint.h>
 #include <boolean.h>
 
 #include <retro_common_api.h>
@@ -10,7 +11,28 @@ RETRO_BEGIN_DECLS
 
 void runahead_destroy(void);
 
-void run_ahead(int runAheadCount, bool useSecondary);
+void run_ahead(int runAheadCount, bool useSecondary, bool skipRollback,
+      bool threadedSecondary);
+
+typedef struct runahead_stats
+{
+   /* Times the core was put back at an earlier state. */
+   uint64_t rollbacks;
+   /* Frames run with video suspended, which never reach the screen. */
+   uint64_t hidden_frames;
+   /* Frames run ahead last frame, after the automatic count and
+    * lag detection have had their say. */
+   unsigned frames;
+} runahead_stats_t;
+
+void runahead_get_stats(runahead_stats_t *stats);
+
+/* Netplay replays are hidden frames too. These put the video and audio
+ * drivers to sleep and ask for fast savestates around them, the same
+ * way frames run ahead are. Hard Disable Audio isn't used, since every
+ * replayed frame is saved. */
+void runahead_replay_begin(void);
+void runahead_replay_end(void);
 
 bool want_fast_savestate(void);
 bool get_hard_disable_audio(void);
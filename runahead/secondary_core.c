@@ -15,6 +15,10 @@
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "mem_util.h"
 
 #include "../core.h"
@@ -32,6 +36,28 @@ static dylib_t secondary_module;
 static struct retro_core_t secondary_core;
 static struct retro_callbacks secondary_callbacks;
 
+#ifdef HAVE_THREADS
+/* Threaded speculation: the worker runs the secondary core one frame
+ * with the last input while the main thread runs the primary core.
+ * Its video frame is captured and only presented once the main thread
+ * knows the input did not change. */
+static sthread_t *secondary_thread;
+static slock_t *secondary_lock;
+static scond_t *secondary_cond;
+static bool secondary_thread_alive;
+static bool secondary_job_pending;
+static bool secondary_job_queued;
+static bool secondary_on_thread;
+
+static uint8_t *secondary_frame;
+static size_t secondary_frame_capacity;
+static size_t secondary_frame_pitch;
+static unsigned secondary_frame_width;
+static unsigned secondary_frame_height;
+static bool secondary_frame_valid;
+static bool secondary_frame_dupe;
+#endif
+
 extern retro_ctx_load_content_info_t *load_content_info;
 extern enum rarch_core_type last_core_type;
 extern struct retro_callbacks retro_ctx;
@@ -114,6 +140,9 @@ static bool write_file_with_random_name(char **tempDllPath,
       strcat_alloc(tempDllPath, prefix);
       strcat_alloc(tempDllPath, number_buf);
       strcat_alloc(tempDllPath, ext);
+      /* Don't write over a copy another instance has loaded */
+      if (path_is_valid(*tempDllPath))
+         continue;
       if (filestream_write_file(*tempDllPath, data, dataSize))
       {
          okay = true;
@@ -127,7 +156,7 @@ static bool write_file_with_random_name(char **tempDllPath,
    return okay;
 }
 
-static char *copy_core_to_temp_file(void)
+char *copy_core_to_temp_file(const char *corePath, bool unique)
 {
    bool failed              = false;
    char *tempDirectory      = NULL;
@@ -135,7 +164,6 @@ static char *copy_core_to_temp_file(void)
    char *tempDllPath        = NULL;
    void *dllFileData        = NULL;
    int64_t dllFileSize      = 0;
-   const char *corePath     = path_get(RARCH_PATH_CORE);
    const char *coreBaseName = path_basename(corePath);
 
    if (strlen(coreBaseName) == 0)
@@ -171,7 +199,7 @@ static char *copy_core_to_temp_file(void)
    strcat_alloc(&tempDllPath, retroarchTempPath);
    strcat_alloc(&tempDllPath, coreBaseName);
 
-   if (!filestream_write_file(tempDllPath, dllFileData, dllFileSize))
+   if (unique || !filestream_write_file(tempDllPath, dllFileData, dllFileSize))
    {
       /* try other file names */
       if (!write_file_with_random_name(&tempDllPath,
@@ -206,7 +234,18 @@ static bool has_variable_update = false;
 
 static bool rarch_environment_secondary_core_hook(unsigned cmd, void *data)
 {
-   bool result = rarch_environment_cb(cmd, data);
+   bool result;
+#ifdef HAVE_THREADS
+   /* The frontend's A/V state belongs to the primary core
+    * while the secondary runs on the worker. */
+   if (secondary_on_thread && cmd == RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE)
+   {
+      if (data)
+         *(int*)data = 1 | 8;
+      return true;
+   }
+#endif
+   result = rarch_environment_cb(cmd, data);
    if (has_variable_update)
    {
       if (cmd == RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE)
@@ -236,7 +275,8 @@ static bool secondary_core_create(void)
    if (secondary_library_path)
       free(secondary_library_path);
    secondary_library_path = NULL;
-   secondary_library_path = copy_core_to_temp_file();
+   secondary_library_path = copy_core_to_temp_file(
+         path_get(RARCH_PATH_CORE), false);
 
    if (!secondary_library_path)
       return false;
@@ -328,7 +368,7 @@ void secondary_core_set_variable_update(void)
 
 static void secondary_core_input_poll_null(void) { }
 
-bool secondary_core_run_use_last_input(void)
+static bool secondary_core_run_last_input(void)
 {
    if (secondary_core_ensure_exists())
    {
@@ -354,8 +394,193 @@ bool secondary_core_run_use_last_input(void)
    return false;
 }
 
+#ifdef HAVE_THREADS
+static void secondary_core_frame_capture(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   size_t size = height * pitch;
+
+   secondary_frame_width  = width;
+   secondary_frame_height = height;
+   secondary_frame_pitch  = pitch;
+   secondary_frame_dupe   = !data;
+
+   if (!data)
+      return;
+
+   if (data == RETRO_HW_FRAME_BUFFER_VALID)
+   {
+      secondary_frame_valid = false;
+      return;
+   }
+
+   if (size > secondary_frame_capacity)
+   {
+      uint8_t *frame = (uint8_t*)realloc(secondary_frame, size);
+      if (!frame)
+      {
+         secondary_frame_valid = false;
+         return;
+      }
+      secondary_frame          = frame;
+      secondary_frame_capacity = size;
+   }
+
+   memcpy(secondary_frame, data, size);
+}
+
+static void secondary_core_audio_sample_null(int16_t left, int16_t right) { }
+
+static size_t secondary_core_audio_sample_batch_null(
+      const int16_t *data, size_t frames)
+{
+   return frames;
+}
+
+static void secondary_core_thread(void *data)
+{
+   sthread_set_role(STHREAD_ROLE_CORE);
+
+   slock_lock(secondary_lock);
+
+   for (;;)
+   {
+      while (secondary_thread_alive && !secondary_job_queued)
+         scond_wait(secondary_cond, secondary_lock);
+
+      if (!secondary_thread_alive)
+         break;
+
+      /* The main thread doesn't touch the secondary
+       * core while a job is pending. */
+      slock_unlock(secondary_lock);
+
+      secondary_frame_valid = true;
+      secondary_frame_dupe  = true;
+      secondary_core.retro_set_video_refresh(secondary_core_frame_capture);
+      secondary_core.retro_set_audio_sample(secondary_core_audio_sample_null);
+      secondary_core.retro_set_audio_sample_batch(
+            secondary_core_audio_sample_batch_null);
+
+      secondary_on_thread = true;
+      if (!secondary_core_run_last_input())
+         secondary_frame_valid = false;
+      secondary_on_thread = false;
+
+      secondary_core.retro_set_video_refresh(secondary_callbacks.frame_cb);
+      secondary_core.retro_set_audio_sample(secondary_callbacks.sample_cb);
+      secondary_core.retro_set_audio_sample_batch(
+            secondary_callbacks.sample_batch_cb);
+
+      slock_lock(secondary_lock);
+      secondary_job_queued  = false;
+      scond_signal(secondary_cond);
+   }
+
+   slock_unlock(secondary_lock);
+}
+
+static void secondary_core_thread_destroy(void)
+{
+   if (secondary_thread)
+   {
+      slock_lock(secondary_lock);
+      secondary_thread_alive = false;
+      scond_signal(secondary_cond);
+      slock_unlock(secondary_lock);
+      sthread_join(secondary_thread);
+   }
+
+   if (secondary_cond)
+      scond_free(secondary_cond);
+   if (secondary_lock)
+      slock_free(secondary_lock);
+   free(secondary_frame);
+
+   secondary_thread         = NULL;
+   secondary_cond           = NULL;
+   secondary_lock           = NULL;
+   secondary_frame          = NULL;
+   secondary_frame_capacity = 0;
+   secondary_job_pending    = false;
+   secondary_job_queued     = false;
+}
+
+static bool secondary_core_thread_init(void)
+{
+   secondary_lock         = slock_new();
+   secondary_cond         = scond_new();
+   secondary_thread_alive = true;
+
+   if (secondary_lock && secondary_cond)
+      secondary_thread    = sthread_create(secondary_core_thread, NULL);
+
+   if (!secondary_thread)
+   {
+      secondary_core_thread_destroy();
+      return false;
+   }
+   return true;
+}
+#endif
+
+bool secondary_core_run_async(void)
+{
+#ifdef HAVE_THREADS
+   secondary_core_wait_async(false);
+
+   if (!secondary_core_ensure_exists())
+      return false;
+   if (!secondary_thread && !secondary_core_thread_init())
+      return false;
+
+   slock_lock(secondary_lock);
+   secondary_job_pending = true;
+   secondary_job_queued  = true;
+   scond_signal(secondary_cond);
+   slock_unlock(secondary_lock);
+   return true;
+#else
+   return false;
+#endif
+}
+
+bool secondary_core_wait_async(bool present)
+{
+#ifdef HAVE_THREADS
+   if (!secondary_job_pending)
+      return false;
+
+   slock_lock(secondary_lock);
+   while (secondary_job_queued)
+      scond_wait(secondary_cond, secondary_lock);
+   slock_unlock(secondary_lock);
+
+   secondary_job_pending = false;
+
+   if (!present || !secondary_frame_valid)
+      return !present;
+
+   secondary_callbacks.frame_cb(
+         secondary_frame_dupe ? NULL : secondary_frame,
+         secondary_frame_width, secondary_frame_height,
+         secondary_frame_pitch);
+   return true;
+#else
+   return false;
+#endif
+}
+
+bool secondary_core_run_use_last_input(void)
+{
+   secondary_core_wait_async(false);
+   return secondary_core_run_last_input();
+}
+
 bool secondary_core_deserialize(const void *buffer, int size)
 {
+   secondary_core_wait_async(false);
+
    if (secondary_core_ensure_exists())
       return secondary_core.retro_unserialize(buffer, size);
    return false;
@@ -376,6 +601,10 @@ bool secondary_core_ensure_exists(void)
 
 void secondary_core_destroy(void)
 {
+#ifdef HAVE_THREADS
+   secondary_core_thread_destroy();
+#endif
+
    if (!secondary_module)
       return;
 
@@ -425,6 +654,21 @@ bool secondary_core_deserialize(const void *buffer, int size)
    return false;
 }
 
+bool secondary_core_run_async(void)
+{
+   return false;
+}
+
+bool secondary_core_wait_async(bool present)
+{
+   return false;
+}
+
+char *copy_core_to_temp_file(const char *corePath, bool unique)
+{
+   return NULL;
+}
+
 void secondary_core_destroy(void) { }
 void remember_controller_port_device(long port, long device) { }
 void secondary_core_set_variable_update(void) { }
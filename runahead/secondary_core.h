@@ -10,9 +10,24 @@
 
 RETRO_BEGIN_DECLS
 
+/* Copies the core library at @corePath to the temp directory so
+ * it can be loaded again with its own globals. With @unique set the
+ * copy always gets a fresh name. Returns the allocated path, or NULL. */
+char *copy_core_to_temp_file(const char *corePath, bool unique);
+
 bool secondary_core_run_use_last_input(void);
 bool secondary_core_deserialize(const void *buffer, int size);
 bool secondary_core_ensure_exists(void);
+
+/* Starts running one frame of the secondary core with the last input
+ * on a worker thread. Returns false if threads are not available. */
+bool secondary_core_run_async(void);
+
+/* Waits for the frame started by secondary_core_run_async().
+ * If @present is true, its video frame is presented.
+ * Returns true if a frame was pending and, when @present is set,
+ * could be presented. */
+bool secondary_core_wait_async(bool present);
 void secondary_core_destroy(void);
 void set_last_core_type(enum rarch_core_type type);
 void remember_controller_port_device(long port, long device);
@@ -18,8 +18,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <compat/strl.h>
+#include <rhash.h>
 #include <lists/dir_list.h>
 #include <file/file_path.h>
 #include <file/config_file.h>
@@ -110,6 +112,38 @@ struct autoconfig_params
    char  *autoconfig_directory;
 };
 
+/* What matching needs from one profile in the autoconfig directory */
+typedef struct autoconfig_profile
+{
+   char *path;
+   char *ident;
+   int64_t mtime;
+   int32_t size;
+   int vid;
+   int pid;
+   uint32_t path_hash;
+} autoconfig_profile_t;
+
+/* Profiles of one directory, kept between hotplugs so that only
+ * new or changed files are parsed again. The tables are open
+ * addressed and hold a profile index + 1, 0 marking a free slot. */
+typedef struct autoconfig_index
+{
+   char dir[PATH_MAX_LENGTH];
+   int64_t dir_mtime;
+   size_t count;
+   size_t cap;
+   autoconfig_profile_t *profiles;
+   uint32_t *by_path;
+   uint32_t *by_device;
+   uint32_t *by_name;
+} autoconfig_index_t;
+
+/* The joypad driver's directory and the configured fallback.
+ * Only the connect task handler touches these, and task handlers
+ * never run concurrently. */
+static autoconfig_index_t autoconfig_indices[2];
+
 static bool input_autoconfigured[MAX_USERS];
 static unsigned input_device_name_index[MAX_INPUT_DEVICES];
 static bool input_autoconfigure_swap_override;
@@ -321,87 +355,364 @@ static int input_autoconfigure_joypad_from_conf(
    return ret;
 }
 
-static bool input_autoconfigure_joypad_from_conf_dir(
-      autoconfig_params_t *params, retro_task_t *task)
+static uint32_t autoconfig_device_hash(int vid, int pid)
 {
-   size_t i;
-   char path[PATH_MAX_LENGTH];
-   int ret                    = 0;
-   int index                  = -1;
-   int current_best           = 0;
-   config_file_t *conf        = NULL;
-   struct string_list *list   = NULL;
+   return ((uint32_t)vid * 0x9e3779b1u) ^ (uint32_t)pid;
+}
 
-   path[0]                    = '\0';
+static bool autoconfig_device_usable(const autoconfig_params_t *params)
+{
+   return params->vid != 0 && params->pid != 0
+      && params->vid != BLISSBOX_VID
+      && params->pid != BLISSBOX_PID;
+}
 
-   fill_pathname_application_special(path, sizeof(path),
-         APPLICATION_SPECIAL_DIRECTORY_AUTOCONFIG);
+static void autoconfig_profile_free(autoconfig_profile_t *profile)
+{
+   free(profile->path);
+   free(profile->ident);
+   profile->path  = NULL;
+   profile->ident = NULL;
+}
+
+static void autoconfig_profile_parse(autoconfig_profile_t *profile)
+{
+   char ident[256];
+   int tmp_int         = 0;
+   config_file_t *conf = config_file_new(profile->path);
+
+   free(profile->ident);
+   profile->ident      = NULL;
+   profile->vid        = 0;
+   profile->pid        = 0;
+
+   /* A profile that fails to load scores nothing */
+   if (!conf)
+      return;
+
+   ident[0] = '\0';
+
+   config_get_array(conf, "input_device", ident, sizeof(ident));
+   if (!string_is_empty(ident))
+      profile->ident = strdup(ident);
+
+   if (config_get_int(conf, "input_vendor_id", &tmp_int))
+      profile->vid = tmp_int;
+   if (config_get_int(conf, "input_product_id", &tmp_int))
+      profile->pid = tmp_int;
+
+   config_file_free(conf);
+}
+
+static void autoconfig_table_insert(uint32_t *table, size_t mask,
+      uint32_t hash, size_t i)
+{
+   size_t slot = hash & mask;
 
-   list = dir_list_new_special(path, DIR_LIST_AUTOCONFIG, "cfg");
+   while (table[slot])
+      slot = (slot + 1) & mask;
 
-   if (!list || !list->size)
+   table[slot] = (uint32_t)(i + 1);
+}
+
+static void autoconfig_index_free_tables(autoconfig_index_t *ix)
+{
+   free(ix->by_path);
+   free(ix->by_device);
+   free(ix->by_name);
+   ix->by_path   = NULL;
+   ix->by_device = NULL;
+   ix->by_name   = NULL;
+   ix->cap       = 0;
+}
+
+static bool autoconfig_index_build_tables(autoconfig_index_t *ix)
+{
+   size_t i, mask;
+   size_t cap = 16;
+
+   while (cap < ix->count * 2)
+      cap <<= 1;
+
+   autoconfig_index_free_tables(ix);
+
+   ix->by_path   = (uint32_t*)calloc(cap, sizeof(uint32_t));
+   ix->by_device = (uint32_t*)calloc(cap, sizeof(uint32_t));
+   ix->by_name   = (uint32_t*)calloc(cap, sizeof(uint32_t));
+
+   if (!ix->by_path || !ix->by_device || !ix->by_name)
+   {
+      autoconfig_index_free_tables(ix);
+      return false;
+   }
+
+   ix->cap = cap;
+   mask    = cap - 1;
+
+   for (i = 0; i < ix->count; i++)
    {
-      if (list)
+      const autoconfig_profile_t *profile = &ix->profiles[i];
+
+      autoconfig_table_insert(ix->by_path, mask, profile->path_hash, i);
+      autoconfig_table_insert(ix->by_device, mask,
+            autoconfig_device_hash(profile->vid, profile->pid), i);
+      if (profile->ident)
+         autoconfig_table_insert(ix->by_name, mask,
+               djb2_calculate(profile->ident), i);
+   }
+
+   return true;
+}
+
+static void autoconfig_index_clear(autoconfig_index_t *ix)
+{
+   size_t i;
+
+   for (i = 0; i < ix->count; i++)
+      autoconfig_profile_free(&ix->profiles[i]);
+   free(ix->profiles);
+   autoconfig_index_free_tables(ix);
+
+   ix->profiles  = NULL;
+   ix->count     = 0;
+   ix->dir_mtime = -1;
+   ix->dir[0]    = '\0';
+}
+
+/* Brings the index in line with the directory: the listing is only
+ * read again when the directory itself changed, and a profile is only
+ * parsed again when its size or mtime did. Returns whether the
+ * directory has any profiles. */
+static bool autoconfig_index_update(autoconfig_index_t *ix, const char *dir)
+{
+   size_t i;
+   struct string_list *list   = NULL;
+   autoconfig_profile_t *prev = ix->profiles;
+   size_t prev_count          = ix->count;
+   size_t prev_mask           = ix->cap ? ix->cap - 1 : 0;
+   int64_t dir_mtime          = path_get_mtime(dir);
+   int64_t listed             = (int64_t)time(NULL);
+   bool dirty                 = false;
+
+   if (     dir_mtime >= 0
+         && dir_mtime == ix->dir_mtime
+         && ix->by_path
+         && string_is_equal(ix->dir, dir))
+   {
+      for (i = 0; i < ix->count; i++)
       {
-         string_list_free(list);
-         list = NULL;
+         autoconfig_profile_t *profile = &ix->profiles[i];
+         int32_t size                  = 0;
+         int64_t mtime                 = -1;
+
+         if (     path_get_size_mtime(profile->path, &size, &mtime)
+               && size  == profile->size
+               && mtime == profile->mtime
+               && mtime >= 0)
+            continue;
+
+         profile->size  = size;
+         profile->mtime = mtime;
+         autoconfig_profile_parse(profile);
+         dirty          = true;
       }
-      if (!string_is_empty(params->autoconfig_directory))
-         list = dir_list_new_special(params->autoconfig_directory,
-               DIR_LIST_AUTOCONFIG, "cfg");
+
+      if (dirty)
+         autoconfig_index_build_tables(ix);
+      return ix->count > 0;
    }
 
-   if(!list)
+   list = dir_list_new_special(dir, DIR_LIST_AUTOCONFIG, "cfg");
+
+   ix->profiles = NULL;
+   ix->count    = 0;
+
+   if (list && list->size)
+      ix->profiles = (autoconfig_profile_t*)
+         calloc(list->size, sizeof(autoconfig_profile_t));
+
+   for (i = 0; ix->profiles && i < list->size; i++)
    {
-      RARCH_LOG("[autoconf]: No profiles found.\n");
-      return false;
+      autoconfig_profile_t *profile = &ix->profiles[ix->count];
+      autoconfig_profile_t *old     = NULL;
+      const char *path              = list->elems[i].data;
+
+      profile->path_hash = djb2_calculate(path);
+      path_get_size_mtime(path, &profile->size, &profile->mtime);
+
+      if (prev_count && ix->by_path)
+      {
+         size_t slot;
+
+         for (slot = profile->path_hash & prev_mask;
+               ix->by_path[slot]; slot = (slot + 1) & prev_mask)
+         {
+            autoconfig_profile_t *cand = &prev[ix->by_path[slot] - 1];
+
+            if (     cand->path
+                  && cand->path_hash == profile->path_hash
+                  && string_is_equal(cand->path, path))
+            {
+               old = cand;
+               break;
+            }
+         }
+      }
+
+      if (     old
+            && old->size  == profile->size
+            && old->mtime == profile->mtime
+            && old->mtime >= 0)
+      {
+         /* Unchanged, take the parsed fields over as they are */
+         profile->path  = old->path;
+         profile->ident = old->ident;
+         profile->vid   = old->vid;
+         profile->pid   = old->pid;
+         old->path      = NULL;
+         old->ident     = NULL;
+      }
+      else
+      {
+         if (!(profile->path = strdup(path)))
+            continue;
+         autoconfig_profile_parse(profile);
+      }
+
+      ix->count++;
    }
 
+   for (i = 0; i < prev_count; i++)
+      autoconfig_profile_free(&prev[i]);
+   free(prev);
    if (list)
+      string_list_free(list);
+
+   strlcpy(ix->dir, dir, sizeof(ix->dir));
+   /* A change within the second the listing was read in
+    * would not move the mtime, so that listing is not kept. */
+   ix->dir_mtime = (dir_mtime < listed) ? dir_mtime : -1;
+
+   if (!autoconfig_index_build_tables(ix))
    {
-      RARCH_LOG("[Autoconf]: %d profiles found.\n", list->size);
+      autoconfig_index_clear(ix);
+      return false;
    }
 
-   for (i = 0; i < list->size; i++)
-   {
-      conf = config_file_new(list->elems[i].data);
+   return ix->count > 0;
+}
+
+/* Same scoring as input_autoconfigure_joypad_try_from_conf(), but only
+ * the profiles sharing the pad's vid/pid or name are looked at. Ties go
+ * to the profile listed last. Returns the profile index or -1. */
+static int autoconfig_index_find(const autoconfig_index_t *ix,
+      const autoconfig_params_t *params)
+{
+   size_t slot;
+   int best          = -1;
+   int best_score    = 0;
+   size_t mask       = ix->cap - 1;
+   bool device       = autoconfig_device_usable(params);
+   bool name         = !string_is_empty(params->name);
 
-      if (conf)
-         ret  = input_autoconfigure_joypad_try_from_conf(conf, params);
+   if (!ix->cap)
+      return -1;
 
-      if(ret >= current_best)
+   if (device)
+   {
+      uint32_t hash = autoconfig_device_hash(params->vid, params->pid);
+
+      for (slot = hash & mask; ix->by_device[slot];
+            slot = (slot + 1) & mask)
       {
-         index        = (int)i;
-         current_best = ret;
+         int i                               = (int)ix->by_device[slot] - 1;
+         const autoconfig_profile_t *profile = &ix->profiles[i];
+         int score                           = 3;
+
+         if (     profile->vid != params->vid
+               || profile->pid != params->pid)
+            continue;
+
+         if (name && profile->ident
+               && string_is_equal(profile->ident, params->name))
+            score += 2;
+
+         if (score > best_score || (score == best_score && i > best))
+         {
+            best       = i;
+            best_score = score;
+         }
       }
-      config_file_free(conf);
    }
 
-   if(index >= 0 && current_best > 0)
+   if (name)
    {
-      conf = config_file_new(list->elems[index].data);
+      uint32_t hash = djb2_calculate(params->name);
 
-      if (conf)
+      for (slot = hash & mask; ix->by_name[slot];
+            slot = (slot + 1) & mask)
       {
-         char conf_path[PATH_MAX_LENGTH];
+         int i                               = (int)ix->by_name[slot] - 1;
+         const autoconfig_profile_t *profile = &ix->profiles[i];
+         int score                           = 2;
 
-         conf_path[0] = '\0';
+         if (!string_is_equal(profile->ident, params->name))
+            continue;
 
-         config_get_config_path(conf, conf_path, sizeof(conf_path));
+         if (device
+               && profile->vid == params->vid
+               && profile->pid == params->pid)
+            score += 3;
 
-         RARCH_LOG("[autoconf]: selected configuration: %s\n", conf_path);
-         input_autoconfigure_joypad_add(conf, params, task);
-         config_file_free(conf);
-         ret = 1;
+         if (score > best_score || (score == best_score && i > best))
+         {
+            best       = i;
+            best_score = score;
+         }
       }
    }
-   else
-      ret = 0;
 
-   string_list_free(list);
+   return best;
+}
 
-   if (ret == 0)
+static bool input_autoconfigure_joypad_from_conf_dir(
+      autoconfig_params_t *params, retro_task_t *task)
+{
+   char path[PATH_MAX_LENGTH];
+   int index                  = -1;
+   config_file_t *conf        = NULL;
+   autoconfig_index_t *ix     = &autoconfig_indices[0];
+
+   path[0]                    = '\0';
+
+   fill_pathname_application_special(path, sizeof(path),
+         APPLICATION_SPECIAL_DIRECTORY_AUTOCONFIG);
+
+   if (!autoconfig_index_update(ix, path))
+   {
+      ix = &autoconfig_indices[1];
+
+      if (  string_is_empty(params->autoconfig_directory)
+         || !autoconfig_index_update(ix, params->autoconfig_directory))
+      {
+         RARCH_LOG("[autoconf]: No profiles found.\n");
+         return false;
+      }
+   }
+
+   RARCH_LOG("[Autoconf]: %d profiles found.\n", (int)ix->count);
+
+   if ((index = autoconfig_index_find(ix, params)) < 0)
+      return false;
+
+   if (!(conf = config_file_new(ix->profiles[index].path)))
       return false;
+
+   RARCH_LOG("[autoconf]: selected configuration: %s\n",
+         ix->profiles[index].path);
+   input_autoconfigure_joypad_add(conf, params, task);
+   config_file_free(conf);
+
    return true;
 }
 
@@ -43,6 +43,13 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#endif
+
 #include <boolean.h>
 
 #include <encodings/crc32.h>
@@ -153,6 +160,41 @@ static char pending_subsystem_extensions[PATH_MAX_LENGTH];
 static char *pending_subsystem_roms[RARCH_MAX_SUBSYSTEM_ROMS];
 
 
+#ifdef HAVE_MMAP
+/* Content at least this big is mapped rather than read, when
+ * nothing has to be patched into it. */
+#define CONTENT_MMAP_MIN_SIZE (32 * 1024 * 1024)
+
+/* Maps @path copy-on-write, so pages are only read in as the core
+ * touches them and a core writing to its content can't reach the
+ * file. Undo with munmap(). */
+static bool content_file_mmap(const char *path, void **buf, int64_t *length)
+{
+   void *data;
+   int32_t size = path_get_size(path);
+   int fd       = -1;
+
+   if (size < CONTENT_MMAP_MIN_SIZE)
+      return false;
+
+   if ((fd = open(path, O_RDONLY)) < 0)
+      return false;
+
+   data = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE, fd, 0);
+   /* The mapping outlives the descriptor. */
+   close(fd);
+
+   if (data == MAP_FAILED)
+      return false;
+
+   *buf    = data;
+   *length = size;
+
+   return true;
+}
+#endif
+
 static int64_t content_file_read(const char *path, void **buf, int64_t *length)
 {
 #ifdef HAVE_COMPRESSION
@@ -316,23 +358,44 @@ end:
  * @path         : buffer of the content file.
  * @buf          : size   of the content file.
  * @length       : size of the content file that has been read from.
+ * @mapped       : set if the content was mapped instead of read.
  *
  * Read the content file. If read into memory, also performs soft patching
  * (see patch_content function) in case soft patching has not been
- * blocked by the enduser.
+ * blocked by the enduser. Large content which won't be patched
+ * is mapped instead, see content_file_mmap().
  *
  * Returns: true if successful, false on error.
  **/
 static bool load_content_into_memory(
       content_information_ctx_t *content_ctx,
       unsigned i, const char *path, void **buf,
-      int64_t *length)
+      int64_t *length, bool *mapped)
 {
    uint8_t *ret_buf          = NULL;
+   bool patch                = i == 0 && !content_ctx->patch_is_blocked
+      && patch_content_exists(
+            content_ctx->is_ips_pref,
+            content_ctx->is_bps_pref,
+            content_ctx->is_ups_pref,
+            content_ctx->name_ips,
+            content_ctx->name_bps,
+            content_ctx->name_ups);
+
+   *mapped                   = false;
 
    RARCH_LOG("%s: %s.\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), path);
 
+#ifdef HAVE_MMAP
+   if (     !patch
+#ifdef HAVE_COMPRESSION
+         && !path_contains_compressed_file(path)
+#endif
+         && content_file_mmap(path, (void**)&ret_buf, length))
+      *mapped = true;
+   else
+#endif
    if (!content_file_read(path, (void**) &ret_buf, length))
       return false;
 
@@ -349,9 +412,11 @@ static bool load_content_into_memory(
          /* First content file is significant, attempt to do patching,
           * CRC checking, etc. */
 
-         /* Attempt to apply a patch. */
-         if (!content_ctx->patch_is_blocked)
-            patch_content(
+         /* Attempt to apply a patch. Patching already
+          * yields the CRC32 of the result. */
+         if (     content_ctx->patch_is_blocked
+               || *mapped
+               || !patch_content(
                   content_ctx->is_ips_pref,
                   content_ctx->is_bps_pref,
                   content_ctx->is_ups_pref,
@@ -359,9 +424,9 @@ static bool load_content_into_memory(
                   content_ctx->name_bps,
                   content_ctx->name_ups,
                   (uint8_t**)&ret_buf,
-                  (void*)length);
-
-         content_rom_crc = encoding_crc32(0, ret_buf, (size_t)*length);
+                  (void*)length,
+                  &content_rom_crc))
+            content_rom_crc = encoding_crc32(0, ret_buf, (size_t)*length);
 
          RARCH_LOG("CRC32: 0x%x .\n", (unsigned)content_rom_crc);
       }
@@ -452,6 +517,36 @@ error:
    return false;
 }
 
+/* Points content entry @i at the first member of archive @path
+ * matching @valid_ext, i.e. "archive#member". */
+static bool content_file_init_archive_member(
+      struct string_list *content, unsigned i,
+      const char *path, const char *valid_ext)
+{
+   char new_path[PATH_MAX_LENGTH];
+   struct string_list *list = file_archive_get_file_list(path, valid_ext);
+
+   if (!list)
+      return false;
+
+   /* Archive paths are only split after their last slash,
+    * members in subdirectories still need extracting. */
+   if (     list->size == 0
+         || strchr(list->elems[0].data, '/')
+         || strchr(list->elems[0].data, '\\'))
+   {
+      string_list_free(list);
+      return false;
+   }
+
+   snprintf(new_path, sizeof(new_path), "%s#%s", path, list->elems[0].data);
+   string_list_free(list);
+
+   string_list_set(content, i, new_path);
+
+   return true;
+}
+
 /* Try to extract all content we're going to load if appropriate. */
 
 static bool content_file_init_extract(
@@ -468,8 +563,12 @@ static bool content_file_init_extract(
    for (i = 0; i < content->size; i++)
    {
       bool block_extract                 = content->elems[i].attr.i & 1;
+      bool need_fullpath                 = content->elems[i].attr.i & 2;
       const char *path                   = content->elems[i].data;
       bool contains_compressed           = path_contains_compressed_file(path);
+      const char *valid_ext              = special ?
+         special->roms[i].valid_extensions :
+         content_ctx->valid_extensions;
 
       /* Block extract check. */
       if (block_extract)
@@ -479,13 +578,24 @@ static bool content_file_init_extract(
       if (!contains_compressed && !path_is_compressed_file(path))
          continue;
 
+      /* Content loaded into memory is inflated straight into
+       * its buffer by content_file_read(), no temporary file
+       * needed. A bare archive only has to be pointed at its
+       * first valid member. */
+      if (!need_fullpath)
+      {
+         if (contains_compressed)
+            continue;
+
+         if (valid_ext && content_file_init_archive_member(
+                  content, i, path, valid_ext))
+            continue;
+      }
+
       {
          size_t temp_content_size = PATH_MAX_LENGTH * sizeof(char);
          size_t new_path_size     = PATH_MAX_LENGTH * sizeof(char);
          char *temp_content       = (char*)malloc(temp_content_size);
-         const char *valid_ext    = special ?
-            special->roms[i].valid_extensions :
-            content_ctx->valid_extensions;
 
          new_path        = (char*)malloc(new_path_size);
 
@@ -541,6 +651,7 @@ error:
  * content_file_load:
  * @special          : subsystem of content to be loaded. Can be NULL.
  * content           :
+ * @mapped           : set for each content whose data was mapped.
  *
  * Load content file (for libretro core).
  *
@@ -548,6 +659,7 @@ error:
  **/
 static bool content_file_load(
       struct retro_game_info *info,
+      bool *mapped,
       const struct string_list *content,
       content_information_ctx_t *content_ctx,
       char **error_string,
@@ -592,7 +704,7 @@ static bool content_file_load(
 
          if (!load_content_into_memory(
                   content_ctx,
-                  i, path, (void**)&info[i].data, &len))
+                  i, path, (void**)&info[i].data, &len, &mapped[i]))
          {
             snprintf(msg,
                   msg_size,
@@ -813,14 +925,23 @@ static bool content_file_init(
    {
       unsigned i;
       struct string_list *additional_path_allocs = string_list_new();
+      bool *mapped = (bool*)calloc(content->size, sizeof(*mapped));
 
-      ret = content_file_load(info, content, content_ctx, error_string,
-            special, additional_path_allocs);
+      ret = mapped && content_file_load(info, mapped, content, content_ctx,
+            error_string, special, additional_path_allocs);
       string_list_free(additional_path_allocs);
 
       for (i = 0; i < content->size; i++)
-         free((void*)info[i].data);
+      {
+#ifdef HAVE_MMAP
+         if (mapped && mapped[i])
+            munmap((void*)info[i].data, info[i].size);
+         else
+#endif
+            free((void*)info[i].data);
+      }
 
+      free(mapped);
       free(info);
    }
    else if (!special)
@@ -0,0 +1,300 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <boolean.h>
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <lists/string_list.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "tasks_internal.h"
+
+/* Warms the OS page cache for the content of a playlist entry while
+ * the user is still looking at it, so launching doesn't wait on a
+ * cold SD card or network share. Linux only asks the kernel to read
+ * ahead; elsewhere the data is read and thrown away. Either way it is
+ * done a chunk per handler call so a newer request or a launch stops
+ * it quickly. */
+
+#define CONTENT_PREFETCH_CHUNK  (4 * 1024 * 1024)
+#define CONTENT_PREFETCH_MAX    (256 * 1024 * 1024)
+/* Track files of a .cue/.gdi/.m3u worth warming up: the data track
+ * and whatever the core opens right after it. */
+#define CONTENT_PREFETCH_TRACKS 2
+
+typedef struct content_prefetch
+{
+   struct string_list *files;
+   unsigned generation;
+   unsigned file;
+   int64_t offset;
+   int64_t size;
+   int64_t total;
+#if defined(__linux__)
+   int fd;
+#else
+   RFILE *stream;
+   void *buf;
+#endif
+} content_prefetch_t;
+
+/* Bumped by every push and cancel, a task that sees a newer value
+ * stops. */
+static volatile unsigned content_prefetch_generation = 0;
+
+static void content_prefetch_add_tracks(struct string_list *files,
+      const char *path)
+{
+   union string_list_elem_attr attr;
+   char track[PATH_MAX_LENGTH];
+   const char *ext = path_get_extension(path);
+   bool cue        = string_is_equal_noncase(ext, "cue");
+   bool gdi        = string_is_equal_noncase(ext, "gdi");
+   bool m3u        = string_is_equal_noncase(ext, "m3u");
+   struct string_list *lines = NULL;
+   void *buf                 = NULL;
+   int64_t len               = 0;
+   unsigned tracks           = 0;
+   unsigned i;
+
+   if (!cue && !gdi && !m3u)
+      return;
+
+   if (!filestream_read_file(path, &buf, &len) || !buf)
+      return;
+
+   lines = string_split((const char*)buf, "\r\n");
+   free(buf);
+   if (!lines)
+      return;
+
+   attr.i = 0;
+
+   for (i = 0; i < lines->size && tracks < CONTENT_PREFETCH_TRACKS; i++)
+   {
+      char *line       = lines->elems[i].data;
+      const char *name = NULL;
+      char *end        = NULL;
+
+      while (*line == ' ' || *line == '\t')
+         line++;
+
+      if (m3u)
+      {
+         if (*line && *line != '#')
+            name = line;
+      }
+      else if (cue)
+      {
+         /* FILE "name" BINARY */
+         if (strncmp(line, "FILE", 4) == 0 && (name = strchr(line, '"')))
+            end = strchr(++name, '"');
+      }
+      /* <track> <lba> <type> <sector size> "name" <offset>, names
+       * without spaces may leave the quotes out */
+      else if ((name = strchr(line, '"')))
+         end = strchr(++name, '"');
+      else if (strchr(line, ' '))
+      {
+         unsigned field;
+         name = line;
+         for (field = 0; field < 4 && name; field++)
+         {
+            name = strchr(name, ' ');
+            while (name && *name == ' ')
+               name++;
+         }
+         if (name)
+            end = strchr((char*)name, ' ');
+      }
+
+      if (!name || !*name)
+         continue;
+      if (end)
+         *end = '\0';
+
+      fill_pathname_resolve_relative(track, path, name, sizeof(track));
+      string_list_append(files, track, attr);
+      tracks++;
+   }
+
+   string_list_free(lines);
+}
+
+static bool content_prefetch_open(content_prefetch_t *prefetch)
+{
+   const char *path = prefetch->files->elems[prefetch->file].data;
+
+   prefetch->offset = 0;
+#if defined(__linux__)
+   prefetch->fd     = open(path, O_RDONLY);
+   if (prefetch->fd < 0)
+      return false;
+   prefetch->size   = lseek(prefetch->fd, 0, SEEK_END);
+#else
+   prefetch->stream = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!prefetch->stream)
+      return false;
+   prefetch->size   = filestream_get_size(prefetch->stream);
+#endif
+   return prefetch->size > 0;
+}
+
+static void content_prefetch_close(content_prefetch_t *prefetch)
+{
+#if defined(__linux__)
+   if (prefetch->fd >= 0)
+      close(prefetch->fd);
+   prefetch->fd     = -1;
+#else
+   if (prefetch->stream)
+      filestream_close(prefetch->stream);
+   prefetch->stream = NULL;
+#endif
+}
+
+static void content_prefetch_free(content_prefetch_t *prefetch)
+{
+   content_prefetch_close(prefetch);
+#if !defined(__linux__)
+   free(prefetch->buf);
+#endif
+   string_list_free(prefetch->files);
+   free(prefetch);
+}
+
+static void task_content_prefetch_handler(retro_task_t *task)
+{
+   int64_t chunk;
+   content_prefetch_t *prefetch = (content_prefetch_t*)task->state;
+
+   if (     prefetch->generation != content_prefetch_generation
+         || task_get_cancelled(task)
+         || prefetch->file >= prefetch->files->size
+         || prefetch->total >= CONTENT_PREFETCH_MAX)
+      goto done;
+
+   if (prefetch->offset == 0 && !content_prefetch_open(prefetch))
+      goto next;
+
+   chunk = prefetch->size - prefetch->offset;
+   if (chunk > CONTENT_PREFETCH_CHUNK)
+      chunk = CONTENT_PREFETCH_CHUNK;
+   if (chunk > CONTENT_PREFETCH_MAX - prefetch->total)
+      chunk = CONTENT_PREFETCH_MAX - prefetch->total;
+
+#if defined(__linux__)
+   posix_fadvise(prefetch->fd, prefetch->offset, chunk,
+         POSIX_FADV_WILLNEED);
+#else
+   if (filestream_read(prefetch->stream, prefetch->buf, chunk) != chunk)
+      goto next;
+#endif
+
+   prefetch->offset += chunk;
+   prefetch->total  += chunk;
+
+   if (prefetch->offset < prefetch->size)
+      return;
+
+next:
+   content_prefetch_close(prefetch);
+   prefetch->file++;
+   prefetch->offset = 0;
+   return;
+
+done:
+   content_prefetch_free(prefetch);
+   task->state = NULL;
+   task_set_finished(task, true);
+}
+
+void task_push_content_prefetch(const char *path)
+{
+   union string_list_elem_attr attr;
+   char base[PATH_MAX_LENGTH];
+   const char *delim;
+   retro_task_t *task;
+   content_prefetch_t *prefetch;
+
+   content_prefetch_generation++;
+
+   if (string_is_empty(path))
+      return;
+
+   /* An archive is read as a whole, whatever entry was picked */
+   strlcpy(base, path, sizeof(base));
+   if ((delim = path_get_archive_delim(base)))
+      base[delim - base] = '\0';
+
+   if (!path_is_valid(base))
+      return;
+
+   task     = (retro_task_t*)calloc(1, sizeof(*task));
+   prefetch = (content_prefetch_t*)calloc(1, sizeof(*prefetch));
+
+   if (!task || !prefetch)
+      goto error;
+
+   prefetch->files      = string_list_new();
+   prefetch->generation = content_prefetch_generation;
+#if defined(__linux__)
+   prefetch->fd         = -1;
+#else
+   prefetch->buf        = malloc(CONTENT_PREFETCH_CHUNK);
+   if (!prefetch->buf)
+      goto error;
+#endif
+
+   if (!prefetch->files)
+      goto error;
+
+   attr.i = 0;
+   string_list_append(prefetch->files, base, attr);
+   content_prefetch_add_tracks(prefetch->files, base);
+
+   task->type    = TASK_TYPE_NONE;
+   task->state   = prefetch;
+   task->handler = task_content_prefetch_handler;
+   task->mute    = true;
+
+   task_queue_push(task);
+   return;
+
+error:
+   if (prefetch)
+   {
+      string_list_free(prefetch->files);
+#if !defined(__linux__)
+      free(prefetch->buf);
+#endif
+      free(prefetch);
+   }
+   free(task);
+}
+
+void task_content_prefetch_cancel(void)
+{
+   content_prefetch_generation++;
+}
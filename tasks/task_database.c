@@ -26,6 +26,10 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -56,16 +60,122 @@ typedef struct database_state_handle
    struct string_list *list;
 } database_state_handle_t;
 
+/* What task_database_iterate_playlist() needs to know about a file,
+ * computed without touching the scan state so that it can
+ * be done ahead of time on another thread or loaded from
+ * the scan cache. */
+typedef struct database_scan_result
+{
+   enum database_type type;
+   int ret;
+   uint32_t crc;
+   char *serial;
+   /* Of the file as it was before being looked at, for the
+    * scan cache. */
+   int32_t size;
+   int64_t mtime;
+} database_scan_result_t;
+
+typedef struct database_scan_entry
+{
+   char *path;
+   int32_t size;
+   int64_t mtime;
+   bool seen;
+   database_scan_result_t result;
+} database_scan_entry_t;
+
+/* Hashes and serials from earlier scans, keyed by path, size
+ * and modification time. 'entries' is sorted by path and is
+ * read-only while the prefetch threads run; files that weren't
+ * cached yet go to 'added'. */
+typedef struct database_scan_cache
+{
+   bool dirty;
+   size_t count;
+   size_t added_count;
+   size_t added_cap;
+   database_scan_entry_t *entries;
+   database_scan_entry_t *added;
+} database_scan_cache_t;
+
+#define DATABASE_SCAN_CACHE_FILE    "content_scan.cache"
+#define DATABASE_SCAN_CACHE_HEADER  "#content_scan_cache 1"
+#define DATABASE_SCAN_MAX_THREADS   4
+
+/* CHD tracks are checksummed in chunks spread over up to this
+ * many threads, each decompressing with a stream of its own. */
+#define DATABASE_CHD_CRC_CHUNK_SIZE (4 * 1024 * 1024)
+#define DATABASE_CHD_CRC_MAX_THREADS 8
+
+enum database_scan_slot
+{
+   DATABASE_SCAN_SLOT_PENDING = 0,
+   DATABASE_SCAN_SLOT_RUNNING,
+   DATABASE_SCAN_SLOT_DONE
+};
+
+/* Results for the files of the initial scan list, filled in
+ * by the prefetch threads in list order while the task walks
+ * the list and does the database lookups. Files appended later
+ * (archive contents) are handled inline. */
+typedef struct database_scan_prefetch
+{
+   bool quit;
+   size_t count;
+   size_t next;
+   char **paths;
+   uint8_t *slots;
+   database_scan_result_t *results;
+   const database_scan_cache_t *cache;
+#ifdef HAVE_THREADS
+   unsigned threads_count;
+   slock_t *lock;
+   scond_t *cond;
+   sthread_t *threads[DATABASE_SCAN_MAX_THREADS];
+#endif
+} database_scan_prefetch_t;
+
+#define DATABASE_CRC_BATCH_SIZE     128
+
+typedef struct database_crc_match
+{
+   uint32_t crc;
+   char *name;
+   char *db_path;
+} database_crc_match_t;
+
+/* CRCs of a run of already hashed files from the prefetched
+ * list, looked up with one read of each database instead of
+ * one read per file. 'matches' is in database, then record
+ * order, which is the order the per-file lookup finds them in. */
+typedef struct database_crc_batch
+{
+   bool resolved;
+   size_t first;
+   size_t count;
+   size_t db_index;
+   size_t matches_count;
+   size_t matches_cap;
+   uint32_t crcs[DATABASE_CRC_BATCH_SIZE];
+   uint32_t sorted[DATABASE_CRC_BATCH_SIZE];
+   database_crc_match_t *matches;
+} database_crc_batch_t;
+
 typedef struct db_handle
 {
    bool is_directory;
    bool scan_started;
+   bool scan_finished;
    bool show_hidden_files;
    unsigned status;
    char *playlist_directory;
    char *content_database_path;
    char *fullpath;
    database_info_handle_t *handle;
+   database_scan_cache_t *scan_cache;
+   database_scan_prefetch_t *prefetch;
+   database_crc_batch_t *crc_batch;
    database_state_handle_t state;
 } db_handle_t;
 
@@ -478,9 +588,159 @@ static int task_database_gdi_get_crc(const char *name, uint32_t *crc)
    return rv;
 }
 
+#ifdef HAVE_THREADS
+typedef struct database_chd_crc
+{
+   const char *name;
+   slock_t *lock;
+   int64_t size;
+   size_t chunks;
+   size_t next;
+   uint32_t *crcs;
+   bool failed;
+} database_chd_crc_t;
+
+static void task_database_chd_crc_thread(void *data)
+{
+   database_chd_crc_t *job = (database_chd_crc_t*)data;
+   uint8_t *buffer         = (uint8_t*)malloc(64 * 1024);
+   intfstream_t *fd        = intfstream_open_chd_track(
+         job->name,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE,
+         CHDSTREAM_TRACK_PRIMARY);
+   bool failed             = !fd || !buffer;
+
+   for (;;)
+   {
+      size_t chunk;
+      int64_t start, end;
+      uint32_t acc = 0;
+
+      slock_lock(job->lock);
+      if (failed)
+         job->failed = true;
+      if (job->failed || job->next >= job->chunks)
+      {
+         slock_unlock(job->lock);
+         break;
+      }
+      chunk = job->next++;
+      slock_unlock(job->lock);
+
+      start = (int64_t)chunk * DATABASE_CHD_CRC_CHUNK_SIZE;
+      end   = start + DATABASE_CHD_CRC_CHUNK_SIZE;
+      if (end > job->size)
+         end = job->size;
+
+      if (intfstream_seek(fd, start, SEEK_SET) < 0)
+      {
+         failed = true;
+         continue;
+      }
+
+      while (start < end)
+      {
+         int64_t read = end - start;
+         if (read > 64 * 1024)
+            read = 64 * 1024;
+
+         if ((read = intfstream_read(fd, buffer, read)) <= 0)
+            break;
+
+         acc    = encoding_crc32(acc, buffer, (size_t)read);
+         start += read;
+      }
+
+      if (start < end)
+         failed = true;
+
+      /* Every chunk has a slot of its own, read once all
+       * threads are joined. */
+      job->crcs[chunk] = acc;
+   }
+
+   if (fd)
+   {
+      intfstream_close(fd);
+      free(fd);
+   }
+   free(buffer);
+}
+
+/* Hunks are compressed independently, so large tracks are
+ * decompressed and checksummed in parallel chunks whose CRCs
+ * are then combined. Returns -1 when it isn't worth it or
+ * couldn't be done, for the caller to read the track itself. */
+static int task_database_chd_get_crc_threaded(const char *name,
+      int64_t size, uint32_t *crc)
+{
+   size_t i;
+   database_chd_crc_t job;
+   sthread_t *threads[DATABASE_CHD_CRC_MAX_THREADS];
+   unsigned threads_count = 0;
+   unsigned cores         = cpu_features_get_core_amount();
+   int ret                = -1;
+
+   job.name   = name;
+   job.size   = size;
+   job.chunks = (size_t)((size + DATABASE_CHD_CRC_CHUNK_SIZE - 1)
+         / DATABASE_CHD_CRC_CHUNK_SIZE);
+   job.next   = 0;
+   job.failed = false;
+
+   if (cores > DATABASE_CHD_CRC_MAX_THREADS)
+      cores = DATABASE_CHD_CRC_MAX_THREADS;
+   if (cores > job.chunks)
+      cores = (unsigned)job.chunks;
+   if (cores < 2)
+      return -1;
+
+   job.crcs = (uint32_t*)calloc(job.chunks, sizeof(*job.crcs));
+   job.lock = slock_new();
+
+   if (job.crcs && job.lock)
+   {
+      for (i = 0; i < cores; i++)
+      {
+         sthread_t *thread = sthread_create(
+               task_database_chd_crc_thread, &job);
+         if (!thread)
+            break;
+         threads[threads_count++] = thread;
+      }
+   }
+
+   for (i = 0; i < threads_count; i++)
+      sthread_join(threads[i]);
+
+   if (threads_count && job.next >= job.chunks && !job.failed)
+   {
+      uint32_t acc = 0;
+
+      for (i = 0; i < job.chunks; i++)
+      {
+         int64_t len = size - (int64_t)i * DATABASE_CHD_CRC_CHUNK_SIZE;
+         if (len > DATABASE_CHD_CRC_CHUNK_SIZE)
+            len = DATABASE_CHD_CRC_CHUNK_SIZE;
+         acc = encoding_crc32_combine(acc, job.crcs[i], (uint64_t)len);
+      }
+
+      *crc = acc;
+      ret  = 1;
+   }
+
+   if (job.lock)
+      slock_free(job.lock);
+   free(job.crcs);
+
+   return ret;
+}
+#endif
+
 static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
 {
-   int rv;
+   int rv           = -1;
    intfstream_t *fd = intfstream_open_chd_track(
          name,
          RETRO_VFS_FILE_ACCESS_READ,
@@ -489,7 +749,13 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
    if (!fd)
       return 0;
 
-   rv = intfstream_get_crc(fd, crc);
+#ifdef HAVE_THREADS
+   rv = task_database_chd_get_crc_threaded(name,
+         intfstream_get_size(fd), crc);
+#endif
+
+   if (rv < 0)
+      rv = intfstream_get_crc(fd, crc);
    if (rv == 1)
    {
       RARCH_LOG("CHD '%s' crc: %x\n", name, *crc);
@@ -609,71 +875,638 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+static void task_database_scan_file(const char *name,
+      database_scan_result_t *res)
 {
+   char *serial = (char*)malloc(4096);
+
+   serial[0]    = '\0';
+   res->type    = DATABASE_TYPE_CRC_LOOKUP;
+   res->ret     = 1;
+   res->crc     = 0;
+   res->serial  = NULL;
+
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
          /* first check crc of archive itself */
-         return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
+         res->ret = intfstream_file_get_crc(name, 0, SIZE_MAX, &res->crc);
 #else
-         break;
+         res->type = DATABASE_TYPE_ITERATE;
 #endif
+         break;
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (task_database_cue_get_serial(name, serial))
+            res->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
-         {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_cue_get_crc(name, &db_state->crc);
-         }
+            res->ret  = task_database_cue_get_crc(name, &res->crc);
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
          /* There are no serial databases, so don't bother with
             serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (0 && task_database_gdi_get_serial(name, serial))
+            res->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
-         {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_gdi_get_crc(name, &db_state->crc);
-         }
+            res->ret  = task_database_gdi_get_crc(name, &res->crc);
          break;
       /* Consider Wii WBFS files similar to ISO files. */
       case FILE_TYPE_WBFS:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial);
-         database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         intfstream_file_get_serial(name, 0, SIZE_MAX, serial);
+         res->type = DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (task_database_chd_get_serial(name, serial))
+            res->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
-         {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_chd_get_crc(name, &db_state->crc);
-         }
+            res->ret  = task_database_chd_get_crc(name, &res->crc);
          break;
       case FILE_TYPE_LUTRO:
-         database_info_set_type(db, DATABASE_TYPE_ITERATE_LUTRO);
+         res->type = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         res->ret = intfstream_file_get_crc(name, 0, SIZE_MAX, &res->crc);
+         break;
    }
 
-   return 1;
+   if (res->type == DATABASE_TYPE_SERIAL_LOOKUP)
+      res->serial = strdup(serial);
+
+   free(serial);
+}
+
+static int task_database_scan_cache_cmp(const void *a, const void *b)
+{
+   const database_scan_entry_t *ea = (const database_scan_entry_t*)a;
+   const database_scan_entry_t *eb = (const database_scan_entry_t*)b;
+   return strcmp(ea->path, eb->path);
+}
+
+static database_scan_entry_t *task_database_scan_cache_find(
+      const database_scan_cache_t *cache, const char *path)
+{
+   database_scan_entry_t key;
+
+   if (!cache || !cache->count)
+      return NULL;
+
+   key.path = (char*)path;
+   return (database_scan_entry_t*)bsearch(&key, cache->entries,
+         cache->count, sizeof(*cache->entries),
+         task_database_scan_cache_cmp);
+}
+
+static database_scan_cache_t *task_database_scan_cache_load(
+      const char *path)
+{
+   char *line                   = NULL;
+   size_t cap                   = 0;
+   database_scan_cache_t *cache = (database_scan_cache_t*)
+      calloc(1, sizeof(*cache));
+   RFILE *file                  = NULL;
+
+   if (!cache)
+      return NULL;
+
+   if (string_is_empty(path) || !path_is_valid(path))
+      return cache;
+
+   file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return cache;
+
+   line = filestream_getline(file);
+   if (!line || !string_is_equal(line, DATABASE_SCAN_CACHE_HEADER))
+      goto end;
+
+   /* size \t mtime \t type \t ret \t crc \t serial \t path */
+   for (free(line); (line = filestream_getline(file)); free(line))
+   {
+      database_scan_entry_t *entry = NULL;
+      char *fields[7];
+      char *tok                    = line;
+      unsigned i;
+
+      for (i = 0; i < 6 && tok; i++)
+      {
+         fields[i] = tok;
+         if ((tok = strchr(tok, '\t')))
+            *tok++ = '\0';
+      }
+
+      if (i < 6 || string_is_empty(tok))
+         continue;
+      fields[6] = tok;
+
+      if (cache->count == cap)
+      {
+         size_t new_cap                  = cap ? cap * 2 : 256;
+         database_scan_entry_t *entries  = (database_scan_entry_t*)
+            realloc(cache->entries, new_cap * sizeof(*entries));
+
+         if (!entries)
+            break;
+
+         cache->entries = entries;
+         cap            = new_cap;
+      }
+
+      entry               = &cache->entries[cache->count++];
+      entry->size         = (int32_t)strtol(fields[0], NULL, 10);
+      entry->mtime        = (int64_t)strtoll(fields[1], NULL, 10);
+      entry->result.type  = (enum database_type)strtol(fields[2], NULL, 10);
+      entry->result.ret   = (int)strtol(fields[3], NULL, 10);
+      entry->result.crc   = (uint32_t)strtoul(fields[4], NULL, 16);
+      entry->result.serial = (entry->result.type == DATABASE_TYPE_SERIAL_LOOKUP)
+         ? strdup(fields[5]) : NULL;
+      entry->path         = strdup(fields[6]);
+      entry->seen         = false;
+   }
+
+   if (cache->count)
+      qsort(cache->entries, cache->count, sizeof(*cache->entries),
+            task_database_scan_cache_cmp);
+
+   RARCH_LOG("Loaded %u entries from scan cache %s\n",
+         (unsigned)cache->count, path);
+
+end:
+   free(line);
+   filestream_close(file);
+   return cache;
+}
+
+static void task_database_scan_cache_write_entry(RFILE *file,
+      const database_scan_entry_t *entry)
+{
+   filestream_printf(file, "%d\t%lld\t%d\t%d\t%08x\t%s\t%s\n",
+         (int)entry->size,
+         (long long)entry->mtime,
+         (int)entry->result.type,
+         entry->result.ret,
+         (unsigned)entry->result.crc,
+         entry->result.serial ? entry->result.serial : "",
+         entry->path);
+}
+
+/* Entries below 'scanned_dir' that weren't seen during a
+ * completed scan of it are gone and are dropped. */
+static void task_database_scan_cache_save(
+      const database_scan_cache_t *cache, const char *path,
+      const char *scanned_dir)
+{
+   size_t i;
+   RFILE *file = NULL;
+   size_t len  = scanned_dir ? strlen(scanned_dir) : 0;
+
+   if (!cache || !cache->dirty || string_is_empty(path))
+      return;
+
+   file = filestream_open(path, RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+   {
+      RARCH_WARN("Could not write scan cache %s\n", path);
+      return;
+   }
+
+   filestream_printf(file, "%s\n", DATABASE_SCAN_CACHE_HEADER);
+
+   for (i = 0; i < cache->count; i++)
+   {
+      const database_scan_entry_t *entry = &cache->entries[i];
+
+      if (     len
+            && !entry->seen
+            && !strncmp(entry->path, scanned_dir, len)
+            && (path_char_is_slash(scanned_dir[len - 1])
+               || path_char_is_slash(entry->path[len])))
+         continue;
+
+      task_database_scan_cache_write_entry(file, entry);
+   }
+
+   for (i = 0; i < cache->added_count; i++)
+      task_database_scan_cache_write_entry(file, &cache->added[i]);
+
+   filestream_close(file);
+}
+
+static void task_database_scan_cache_free(database_scan_cache_t *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      free(cache->entries[i].path);
+      free(cache->entries[i].result.serial);
+   }
+   for (i = 0; i < cache->added_count; i++)
+   {
+      free(cache->added[i].path);
+      free(cache->added[i].result.serial);
+   }
+
+   free(cache->entries);
+   free(cache->added);
+   free(cache);
+}
+
+/* Only called from the task, once any prefetch thread
+ * that could be reading the entry is done with it. */
+static void task_database_scan_cache_store(database_scan_cache_t *cache,
+      const char *path, int32_t size, int64_t mtime,
+      const database_scan_result_t *res)
+{
+   database_scan_entry_t *entry = NULL;
+
+   /* Don't remember files that couldn't be read. */
+   if (!cache || mtime < 0 || !res->ret)
+      return;
+
+   entry = task_database_scan_cache_find(cache, path);
+
+   if (entry)
+   {
+      entry->seen = true;
+      if (     entry->size == size
+            && entry->mtime == mtime
+            && entry->result.type == res->type
+            && entry->result.ret == res->ret
+            && entry->result.crc == res->crc
+            && string_is_equal(
+               entry->result.serial ? entry->result.serial : "",
+               res->serial ? res->serial : ""))
+         return;
+
+      free(entry->result.serial);
+   }
+   else
+   {
+      if (cache->added_count == cache->added_cap)
+      {
+         size_t new_cap                 = cache->added_cap
+            ? cache->added_cap * 2 : 64;
+         database_scan_entry_t *added   = (database_scan_entry_t*)
+            realloc(cache->added, new_cap * sizeof(*added));
+
+         if (!added)
+            return;
+
+         cache->added     = added;
+         cache->added_cap = new_cap;
+      }
+
+      entry       = &cache->added[cache->added_count++];
+      entry->path = strdup(path);
+      entry->seen = true;
+   }
+
+   entry->size          = size;
+   entry->mtime         = mtime;
+   entry->result        = *res;
+   entry->result.serial = res->serial ? strdup(res->serial) : NULL;
+   cache->dirty         = true;
+}
+
+static void task_database_scan_compute(const database_scan_cache_t *cache,
+      const char *path, database_scan_result_t *res)
+{
+   int32_t size;
+   int64_t mtime;
+   database_scan_entry_t *entry = NULL;
+
+   if (path_get_size_mtime(path, &size, &mtime) && mtime >= 0)
+      entry = task_database_scan_cache_find(cache, path);
+
+   if (     entry
+         && entry->mtime == mtime
+         && entry->size  == size)
+   {
+      *res        = entry->result;
+      res->serial = entry->result.serial
+         ? strdup(entry->result.serial) : NULL;
+   }
+   else
+      task_database_scan_file(path, res);
+
+   res->size  = size;
+   res->mtime = mtime;
+}
+
+#ifdef HAVE_THREADS
+static void task_database_prefetch_thread(void *data)
+{
+   database_scan_prefetch_t *pf = (database_scan_prefetch_t*)data;
+
+   slock_lock(pf->lock);
+
+   for (;;)
+   {
+      size_t i;
+      database_scan_result_t res;
+
+      while (     !pf->quit
+            &&    pf->next < pf->count
+            &&   (!pf->paths[pf->next]
+               || pf->slots[pf->next] != DATABASE_SCAN_SLOT_PENDING))
+         pf->next++;
+
+      if (pf->quit || pf->next >= pf->count)
+         break;
+
+      i            = pf->next++;
+      pf->slots[i] = DATABASE_SCAN_SLOT_RUNNING;
+      slock_unlock(pf->lock);
+
+      task_database_scan_compute(pf->cache, pf->paths[i], &res);
+
+      slock_lock(pf->lock);
+      pf->results[i] = res;
+      pf->slots[i]   = DATABASE_SCAN_SLOT_DONE;
+      scond_broadcast(pf->cond);
+   }
+
+   slock_unlock(pf->lock);
+}
+#endif
+
+static void task_database_prefetch_free(database_scan_prefetch_t *pf)
+{
+   size_t i;
+
+   if (!pf)
+      return;
+
+#ifdef HAVE_THREADS
+   if (pf->lock)
+   {
+      slock_lock(pf->lock);
+      pf->quit = true;
+      slock_unlock(pf->lock);
+   }
+
+   for (i = 0; i < pf->threads_count; i++)
+      sthread_join(pf->threads[i]);
+
+   if (pf->cond)
+      scond_free(pf->cond);
+   if (pf->lock)
+      slock_free(pf->lock);
+#endif
+
+   for (i = 0; i < pf->count; i++)
+   {
+      free(pf->paths[i]);
+      if (pf->slots[i] == DATABASE_SCAN_SLOT_DONE)
+         free(pf->results[i].serial);
+   }
+
+   free(pf->paths);
+   free(pf->slots);
+   free(pf->results);
+   free(pf);
+}
+
+/* Takes a snapshot of the scan list, since archive contents
+ * get appended to it (and may move it) while the threads run. */
+static database_scan_prefetch_t *task_database_prefetch_new(
+      database_info_handle_t *db, const database_scan_cache_t *cache)
+{
+   size_t i;
+   database_scan_prefetch_t *pf = NULL;
+
+   if (!db || !db->list || !db->list->size)
+      return NULL;
+
+   pf = (database_scan_prefetch_t*)calloc(1, sizeof(*pf));
+   if (!pf)
+      return NULL;
+
+   pf->count   = db->list->size;
+   pf->cache   = cache;
+   pf->paths   = (char**)calloc(pf->count, sizeof(*pf->paths));
+   pf->slots   = (uint8_t*)calloc(pf->count, sizeof(*pf->slots));
+   pf->results = (database_scan_result_t*)
+      calloc(pf->count, sizeof(*pf->results));
+
+   if (!pf->paths || !pf->slots || !pf->results)
+   {
+      free(pf->paths);
+      free(pf->slots);
+      free(pf->results);
+      free(pf);
+      return NULL;
+   }
+
+   for (i = 0; i < pf->count; i++)
+   {
+      const char *path = db->list->elems[i].data;
+
+      /* Archive contents are expanded by the task itself. */
+      if (path && !path_contains_compressed_file(path))
+         pf->paths[i] = strdup(path);
+   }
+
+#ifdef HAVE_THREADS
+   {
+      unsigned threads = cpu_features_get_core_amount();
+
+      if (threads > DATABASE_SCAN_MAX_THREADS)
+         threads = DATABASE_SCAN_MAX_THREADS;
+
+      pf->lock = slock_new();
+      pf->cond = scond_new();
+
+      if (pf->lock && pf->cond)
+      {
+         /* The task keeps a core busy with lookups as well. */
+         for (i = 0; i < threads; i++)
+         {
+            sthread_t *thread = sthread_create(
+                  task_database_prefetch_thread, pf);
+            if (!thread)
+               break;
+            pf->threads[pf->threads_count++] = thread;
+         }
+      }
+   }
+#endif
+
+   return pf;
+}
+
+/* Makes sure pf->results[index] is filled in, waiting for
+ * a prefetch thread that's already hashing it, or computing
+ * it right here. The threads leave finished slots alone, so
+ * the result can be read without the lock afterwards. */
+static void task_database_prefetch_wait(database_scan_prefetch_t *pf,
+      size_t index)
+{
+   database_scan_result_t res;
+
+#ifdef HAVE_THREADS
+   if (pf->lock)
+   {
+      slock_lock(pf->lock);
+
+      if (pf->slots[index] == DATABASE_SCAN_SLOT_PENDING)
+      {
+         pf->slots[index] = DATABASE_SCAN_SLOT_RUNNING;
+         slock_unlock(pf->lock);
+
+         task_database_scan_compute(pf->cache, pf->paths[index], &res);
+
+         slock_lock(pf->lock);
+         pf->results[index] = res;
+         pf->slots[index]   = DATABASE_SCAN_SLOT_DONE;
+         scond_broadcast(pf->cond);
+      }
+      else
+      {
+         while (pf->slots[index] != DATABASE_SCAN_SLOT_DONE)
+            scond_wait(pf->cond, pf->lock);
+      }
+
+      slock_unlock(pf->lock);
+      return;
+   }
+#endif
+
+   if (pf->slots[index] != DATABASE_SCAN_SLOT_DONE)
+   {
+      task_database_scan_compute(pf->cache, pf->paths[index], &res);
+      pf->results[index] = res;
+      pf->slots[index]   = DATABASE_SCAN_SLOT_DONE;
+   }
+}
+
+/* Whether entry 'index' has been hashed yet, without waiting. */
+static bool task_database_prefetch_done(database_scan_prefetch_t *pf,
+      size_t index)
+{
+   bool done;
+
+#ifdef HAVE_THREADS
+   if (pf->lock)
+   {
+      slock_lock(pf->lock);
+      done = pf->slots[index] == DATABASE_SCAN_SLOT_DONE;
+      slock_unlock(pf->lock);
+      return done;
+   }
+#endif
+
+   done = pf->slots[index] == DATABASE_SCAN_SLOT_DONE;
+   return done;
+}
+
+/* Fetches the result for entry 'index' of the scan list. */
+static void task_database_scan_get(db_handle_t *_db, size_t index,
+      const char *name, database_scan_result_t *res)
+{
+   database_scan_prefetch_t *pf = _db->prefetch;
+
+   if (     !pf
+         || index >= pf->count
+         || !pf->paths[index]
+         || !string_is_equal(pf->paths[index], name))
+   {
+      task_database_scan_compute(_db->scan_cache, name, res);
+      return;
+   }
+
+   task_database_prefetch_wait(pf, index);
+
+   /* Ownership of 'serial' moves to the caller. */
+   *res                      = pf->results[index];
+   pf->results[index].serial = NULL;
+}
+
+/* Drops the files referenced by cue and gdi sheets from
+ * the whole list, so they aren't hashed on their own. */
+static void task_database_prune_sheets(database_info_handle_t *db)
+{
+   size_t i;
+   size_t list_ptr = db->list_ptr;
+
+   for (i = 0; i < db->list->size; i++)
+   {
+      const char *name = db->list->elems[i].data;
+
+      if (!name)
+         continue;
+
+      db->list_ptr = 0;
+
+      switch (extension_to_file_type(path_get_extension(name)))
+      {
+         case FILE_TYPE_CUE:
+            task_database_cue_prune(db, name);
+            break;
+         case FILE_TYPE_GDI:
+            gdi_prune(db, name);
+            break;
+         default:
+            break;
+      }
+   }
+
+   db->list_ptr = list_ptr;
+}
+
+static int task_database_iterate_playlist(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   database_scan_result_t res;
+   size_t prefetched = _db->prefetch ? _db->prefetch->count : 0;
+
+   /* Sheets in the initial list were pruned before prefetching. */
+   if (db->list_ptr >= prefetched)
+   {
+      switch (extension_to_file_type(path_get_extension(name)))
+      {
+         case FILE_TYPE_CUE:
+            task_database_cue_prune(db, name);
+            break;
+         case FILE_TYPE_GDI:
+            gdi_prune(db, name);
+            break;
+         default:
+            break;
+      }
+   }
+
+   task_database_scan_get(_db, db->list_ptr, name, &res);
+
+   task_database_scan_cache_store(_db->scan_cache, name,
+         res.size, res.mtime, &res);
+
+   if (res.type != DATABASE_TYPE_ITERATE)
+      database_info_set_type(db, res.type);
+
+   db_state->serial[0] = '\0';
+   if (res.serial)
+      strlcpy(db_state->serial, res.serial, sizeof(db_state->serial));
+
+   if (extension_to_file_type(path_get_extension(name))
+         == FILE_TYPE_COMPRESSED)
+      db_state->archive_crc = res.crc;
+   else if (res.type == DATABASE_TYPE_CRC_LOOKUP)
+      db_state->crc         = res.crc;
+
+   free(res.serial);
+
+   return res.ret;
 }
 
 static int database_info_list_iterate_end_no_match(
@@ -762,24 +1595,19 @@ static int database_info_list_iterate_new(database_state_handle_t *db_state,
    return 0;
 }
 
-static int database_info_list_iterate_found_match(
+static void task_database_add_to_playlist(
       db_handle_t *_db,
-      database_state_handle_t *db_state,
-      database_info_handle_t *db,
-      const char *archive_name
-      )
+      const char *db_path,
+      const char *entry_path,
+      const char *entry_name,
+      uint32_t entry_crc32,
+      const char *archive_name)
 {
    char *db_crc                   = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
    char *db_playlist_base_str     = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
    char *db_playlist_path         = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
    char *entry_path_str           = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
    playlist_t   *playlist         = NULL;
-   const char         *db_path    =
-      database_info_get_current_name(db_state);
-   const char         *entry_path =
-      database_info_get_current_element_name(db);
-   database_info_t *db_info_entry =
-      &db_state->info->list[db_state->entry_index];
    char *hash;
 
    db_crc[0]                      = '\0';
@@ -801,7 +1629,7 @@ static int database_info_list_iterate_found_match(
    playlist = playlist_init(db_playlist_path, COLLECTION_SIZE);
 
    snprintf(db_crc, PATH_MAX_LENGTH * sizeof(char),
-         "%08X|crc", db_info_entry->crc32);
+         "%08X|crc", entry_crc32);
 
    if (entry_path)
       strlcpy(entry_path_str, entry_path, PATH_MAX_LENGTH * sizeof(char));
@@ -811,8 +1639,7 @@ static int database_info_list_iterate_found_match(
             entry_path_str, archive_name,
             '#', PATH_MAX_LENGTH * sizeof(char));
 
-   if (core_info_database_match_archive_member(
-         db_state->list->elems[db_state->list_index].data) &&
+   if (core_info_database_match_archive_member(db_path) &&
        (hash = strchr(entry_path_str, '#')))
        *hash = '\0';
 
@@ -843,7 +1670,7 @@ static int database_info_list_iterate_found_match(
    if(!playlist_entry_exists(playlist, entry_path_str, db_crc))
    {
       playlist_push(playlist, entry_path_str,
-            db_info_entry->name,
+            entry_name,
             file_path_str(FILE_PATH_DETECT),
             file_path_str(FILE_PATH_DETECT),
             db_crc, db_playlist_base_str);
@@ -852,17 +1679,33 @@ static int database_info_list_iterate_found_match(
    playlist_write_file(playlist);
    playlist_free(playlist);
 
+   free(entry_path_str);
+   free(db_playlist_path);
+   free(db_playlist_base_str);
+   free(db_crc);
+}
+
+static int database_info_list_iterate_found_match(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db,
+      const char *archive_name
+      )
+{
+   database_info_t *db_info_entry =
+      &db_state->info->list[db_state->entry_index];
+
+   task_database_add_to_playlist(_db,
+         database_info_get_current_name(db_state),
+         database_info_get_current_element_name(db),
+         db_info_entry->name, db_info_entry->crc32, archive_name);
+
    database_info_list_free(db_state->info);
    free(db_state->info);
 
    db_state->info = NULL;
    db_state->crc  = 0;
 
-   free(entry_path_str);
-   free(db_playlist_path);
-   free(db_playlist_base_str);
-   free(db_crc);
-
    /* Move database to start since we are likely to match against it
       again */
    if (db_state->list_index != 0)
@@ -893,6 +1736,209 @@ static int database_info_list_iterate_next(
    return 1;
 }
 
+/* Don't scan files that can't be in this database. */
+static bool task_database_content_in_db(const char *db_path,
+      const char *name)
+{
+   return (path_contains_compressed_file(name)
+         && core_info_database_match_archive_member(db_path))
+      || core_info_database_supports_content_path(db_path, name);
+}
+
+static int task_database_crc_cmp(const void *a, const void *b)
+{
+   uint32_t ca = *(const uint32_t*)a;
+   uint32_t cb = *(const uint32_t*)b;
+   return (ca > cb) - (ca < cb);
+}
+
+static void task_database_crc_batch_free(database_crc_batch_t *batch)
+{
+   size_t i;
+
+   if (!batch)
+      return;
+
+   for (i = 0; i < batch->matches_count; i++)
+   {
+      free(batch->matches[i].name);
+      free(batch->matches[i].db_path);
+   }
+
+   free(batch->matches);
+   free(batch);
+}
+
+/* Starts a batch at entry 'first', which must be prefetched, and
+ * extends it over the following entries that are already hashed,
+ * so the lookup never waits on more than the current file. */
+static database_crc_batch_t *task_database_crc_batch_new(
+      database_scan_prefetch_t *pf, size_t first)
+{
+   size_t i;
+   database_crc_batch_t *batch = (database_crc_batch_t*)
+      calloc(1, sizeof(*batch));
+
+   if (!batch)
+      return NULL;
+
+   batch->first = first;
+
+   task_database_prefetch_wait(pf, first);
+
+   for (i = first; i < pf->count
+         && batch->count < DATABASE_CRC_BATCH_SIZE; i++)
+   {
+      const database_scan_result_t *res = &pf->results[i];
+
+      if (pf->paths[i])
+      {
+         if (i != first && !task_database_prefetch_done(pf, i))
+            break;
+
+         /* Archives go through the per-file lookup, which
+          * expands them when nothing matches. */
+         if (     res->type == DATABASE_TYPE_CRC_LOOKUP
+               && res->crc
+               && extension_to_file_type(path_get_extension(pf->paths[i]))
+                  != FILE_TYPE_COMPRESSED)
+            batch->crcs[batch->count] = res->crc;
+      }
+
+      batch->count++;
+   }
+
+   memcpy(batch->sorted, batch->crcs, batch->count * sizeof(*batch->crcs));
+   qsort(batch->sorted, batch->count, sizeof(*batch->sorted),
+         task_database_crc_cmp);
+
+   return batch;
+}
+
+/* Reads the next database that could hold any of the batch's
+ * files, recording the records that match one of their CRCs. */
+static void task_database_crc_batch_step(database_crc_batch_t *batch,
+      database_scan_prefetch_t *pf, database_state_handle_t *db_state)
+{
+   while (batch->db_index < db_state->list->size)
+   {
+      size_t i;
+      size_t count                 = 0;
+      uint32_t crcs[DATABASE_CRC_BATCH_SIZE];
+      database_info_list_t *info   = NULL;
+      const char *db_path          =
+         db_state->list->elems[batch->db_index++].data;
+
+      for (i = 0; i < batch->count; i++)
+         if (batch->crcs[i] && task_database_content_in_db(db_path,
+                  pf->paths[batch->first + i]))
+            crcs[count++] = batch->crcs[i];
+
+      if (!count)
+         continue;
+
+      qsort(crcs, count, sizeof(*crcs), task_database_crc_cmp);
+
+#ifndef RARCH_INTERNAL
+      fprintf(stderr, "Check database [%d/%d] : %s\n",
+            (unsigned)batch->db_index, (unsigned)db_state->list->size,
+            db_path);
+#endif
+
+      if (!(info = database_info_list_new_crcs(db_path, crcs, count)))
+         return;
+
+      for (i = 0; i < info->count; i++)
+      {
+         database_crc_match_t *match;
+
+         if (batch->matches_count == batch->matches_cap)
+         {
+            size_t cap = batch->matches_cap ? batch->matches_cap * 2 : 16;
+            database_crc_match_t *matches = (database_crc_match_t*)
+               realloc(batch->matches, cap * sizeof(*matches));
+
+            if (!matches)
+               break;
+
+            batch->matches     = matches;
+            batch->matches_cap = cap;
+         }
+
+         match          = &batch->matches[batch->matches_count++];
+         match->crc     = info->list[i].crc32;
+         match->name    = info->list[i].name
+            ? strdup(info->list[i].name) : NULL;
+         match->db_path = strdup(db_path);
+      }
+
+      database_info_list_free(info);
+      free(info);
+      return;
+   }
+
+   batch->resolved = true;
+}
+
+/* Returns -1 if 'name' isn't covered by a batch, in which
+ * case it goes through the per-file lookup below. */
+static int task_database_iterate_crc_batch(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db,
+      const char *name)
+{
+   size_t i;
+   database_scan_prefetch_t *pf = _db->prefetch;
+   database_crc_batch_t *batch  = _db->crc_batch;
+   size_t index                 = db->list_ptr;
+
+   if (     !pf
+         || !db_state->list
+         || !db_state->crc
+         || index >= pf->count
+         || !pf->paths[index]
+         || !string_is_equal(pf->paths[index], name))
+      return -1;
+
+   if (!batch || index < batch->first
+         || index >= batch->first + batch->count)
+   {
+      task_database_crc_batch_free(batch);
+      _db->crc_batch = batch = task_database_crc_batch_new(pf, index);
+
+      if (!batch)
+         return -1;
+   }
+
+   if (!bsearch(&db_state->crc, batch->sorted, batch->count,
+            sizeof(*batch->sorted), task_database_crc_cmp))
+      return -1;
+
+   if (!batch->resolved)
+   {
+      task_database_crc_batch_step(batch, pf, db_state);
+      return 1;
+   }
+
+   for (i = 0; i < batch->matches_count; i++)
+   {
+      const database_crc_match_t *match = &batch->matches[i];
+
+      if (     match->crc == db_state->crc
+            && match->db_path
+            && task_database_content_in_db(match->db_path, name))
+      {
+         task_database_add_to_playlist(_db, match->db_path, name,
+               match->name, match->crc, NULL);
+         db_state->crc = 0;
+         return 0;
+      }
+   }
+
+   return database_info_list_iterate_end_no_match(db, db_state, name);
+}
+
 static int task_database_iterate_crc_lookup(
       db_handle_t *_db,
       database_state_handle_t *db_state,
@@ -900,6 +1946,13 @@ static int task_database_iterate_crc_lookup(
       const char *name,
       const char *archive_entry)
 {
+   if (!archive_entry && db_state->list_index == 0
+         && db_state->entry_index == 0)
+   {
+      int ret = task_database_iterate_crc_batch(_db, db_state, db, name);
+      if (ret != -1)
+         return ret;
+   }
 
    if (!db_state->list ||
          (unsigned)db_state->list_index == (unsigned)db_state->list->size)
@@ -911,12 +1964,8 @@ static int task_database_iterate_crc_lookup(
 
       query[0] = '\0';
 
-      /* don't scan files that can't be in this database */
-      if (!(path_contains_compressed_file(name) &&
-         core_info_database_match_archive_member(
-         db_state->list->elems[db_state->list_index].data)) &&
-          !core_info_database_supports_content_path(
-         db_state->list->elems[db_state->list_index].data, name))
+      if (!task_database_content_in_db(
+               db_state->list->elems[db_state->list_index].data, name))
          return database_info_list_iterate_next(db_state);
 
       snprintf(query, sizeof(query),
@@ -1112,7 +2161,7 @@ static int task_database_iterate(
    switch (database_info_get_type(db))
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
          return task_database_iterate_playlist_archive(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_LUTRO:
@@ -1231,6 +2280,27 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+
+         if (!db->scan_cache)
+         {
+            char *cache_path = (char*)malloc(PATH_MAX_LENGTH);
+
+            cache_path[0] = '\0';
+            if (!string_is_empty(db->playlist_directory))
+               fill_pathname_join(cache_path, db->playlist_directory,
+                     DATABASE_SCAN_CACHE_FILE, PATH_MAX_LENGTH);
+
+            db->scan_cache = task_database_scan_cache_load(cache_path);
+            free(cache_path);
+         }
+
+         if (dbinfo->list && !db->prefetch)
+         {
+            task_database_prune_sheets(dbinfo);
+            db->prefetch = task_database_prefetch_new(dbinfo,
+                  db->scan_cache);
+         }
+
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
@@ -1266,6 +2336,7 @@ static void task_database_handler(retro_task_t *task)
             fprintf(stderr, "msg: %s\n", msg);
 #endif
             ui_companion_driver_notify_refresh();
+            db->scan_finished = true;
             goto task_finished;
          }
          break;
@@ -1288,6 +2359,27 @@ task_finished:
 
    if (db)
    {
+      task_database_crc_batch_free(db->crc_batch);
+
+      /* The threads read the cache, so they go first. */
+      task_database_prefetch_free(db->prefetch);
+
+      if (db->scan_cache)
+      {
+         char *cache_path = (char*)malloc(PATH_MAX_LENGTH);
+
+         cache_path[0] = '\0';
+         if (!string_is_empty(db->playlist_directory))
+            fill_pathname_join(cache_path, db->playlist_directory,
+                  DATABASE_SCAN_CACHE_FILE, PATH_MAX_LENGTH);
+
+         task_database_scan_cache_save(db->scan_cache, cache_path,
+               (db->scan_finished && db->is_directory)
+               ? db->fullpath : NULL);
+         task_database_scan_cache_free(db->scan_cache);
+         free(cache_path);
+      }
+
       if (!string_is_empty(db->playlist_directory))
          free(db->playlist_directory);
       if (!string_is_empty(db->content_database_path))
@@ -1323,6 +2415,7 @@ bool task_push_dbscan(
    t->handler                = task_database_handler;
    t->state                  = db;
    t->callback               = cb;
+   t->priority               = TASK_PRIORITY_LOW;
    t->title                  = strdup(msg_hash_to_str(MSG_PREPARING_FOR_CONTENT_SCAN));
 
    db->show_hidden_files     = show_hidden_files;
@@ -17,15 +17,24 @@
 
 #include <net/net_http.h>
 #include <string/stdstring.h>
+#include <streams/file_stream.h>
+#include <file/archive_file.h>
 #include <compat/strl.h>
 #include <file/file_path.h>
 #include <net/net_compat.h>
 #include <retro_timers.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "../verbosity.h"
 #include "../gfx/video_display_server.h"
 #include "tasks_internal.h"
 
+/* Downloads to disk running at the same time, the others wait
+ * before connecting. Small in-memory requests are not held back. */
+#define HTTP_MAX_FILE_TRANSFERS 3
+
 enum http_status_enum
 {
    HTTP_STATUS_CONNECTION_TRANSFER = 0,
@@ -52,6 +61,19 @@ struct http_handle
    } connection;
    struct http_t *handle;
    transfer_cb_t  cb;
+   /* Set when the body is streamed to disk, it goes to
+    * '<path>.part' and is renamed once complete, or is
+    * extracted as it comes in */
+   struct
+   {
+      file_archive_extract_stream_t *extract;
+      RFILE *handle;
+      char path[PATH_MAX_LENGTH];
+      /* Bytes of the .part file kept from an earlier attempt */
+      size_t offset;
+      size_t size;
+      bool slot;
+   } file;
    unsigned status;
    bool error;
 };
@@ -59,6 +81,157 @@ struct http_handle
 typedef struct http_transfer_info http_transfer_info_t;
 typedef struct http_handle http_handle_t;
 
+#ifdef HAVE_THREADS
+static slock_t *http_file_lock = NULL;
+#endif
+static unsigned http_file_transfers = 0;
+
+static bool task_http_take_slot(http_handle_t *http)
+{
+#ifdef HAVE_THREADS
+   if (http_file_lock)
+      slock_lock(http_file_lock);
+#endif
+   if (http_file_transfers < HTTP_MAX_FILE_TRANSFERS)
+   {
+      http_file_transfers++;
+      http->file.slot = true;
+   }
+#ifdef HAVE_THREADS
+   if (http_file_lock)
+      slock_unlock(http_file_lock);
+#endif
+   return http->file.slot;
+}
+
+static void task_http_release_slot(http_handle_t *http)
+{
+   if (!http->file.slot)
+      return;
+#ifdef HAVE_THREADS
+   if (http_file_lock)
+      slock_lock(http_file_lock);
+#endif
+   http_file_transfers--;
+#ifdef HAVE_THREADS
+   if (http_file_lock)
+      slock_unlock(http_file_lock);
+#endif
+   http->file.slot = false;
+}
+
+static void task_http_part_path(const http_handle_t *http,
+      char *s, size_t len)
+{
+   strlcpy(s, http->file.path, len);
+   strlcat(s, ".part", len);
+}
+
+static bool task_http_file_sink(void *userdata,
+      const uint8_t *data, size_t len)
+{
+   http_handle_t *http = (http_handle_t*)userdata;
+
+   if (http->file.extract)
+   {
+      if (net_http_status(http->handle) != 200
+            || !file_archive_extract_stream_write(http->file.extract, data, len))
+         return false;
+
+      http->file.size += len;
+      return true;
+   }
+
+   if (!http->file.handle)
+   {
+      char part_path[PATH_MAX_LENGTH];
+      unsigned mode = RETRO_VFS_FILE_ACCESS_WRITE;
+      int status    = net_http_status(http->handle);
+
+      /* 206 continues the .part file, 200 starts it over */
+      if (status == 206)
+         mode      |= RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING;
+      else if (status == 200)
+         http->file.offset = 0;
+      else
+         return false;
+
+      task_http_part_path(http, part_path, sizeof(part_path));
+
+      http->file.handle = filestream_open(part_path, mode,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (!http->file.handle)
+      {
+         RARCH_ERR("[http] Could not open '%s' for writing.\n", part_path);
+         return false;
+      }
+
+      if (filestream_seek(http->file.handle, http->file.offset,
+               RETRO_VFS_SEEK_POSITION_START) != 0)
+         return false;
+
+      http->file.size = http->file.offset;
+   }
+
+   if (filestream_write(http->file.handle, data, len) != (int64_t)len)
+      return false;
+
+   http->file.size += len;
+   return true;
+}
+
+/* Closes the .part file and puts it in place if the transfer
+ * went through. A failed one is kept to be resumed. */
+static bool task_http_file_finish(http_handle_t *http, bool success)
+{
+   char part_path[PATH_MAX_LENGTH];
+
+   if (http->file.extract)
+   {
+      /* Only a complete archive counts */
+      if (!file_archive_extract_stream_free(http->file.extract))
+         success = false;
+      http->file.extract = NULL;
+      return success;
+   }
+
+   task_http_part_path(http, part_path, sizeof(part_path));
+
+   /* An empty body never reached the sink */
+   if (success && !http->file.handle)
+      http->file.handle = filestream_open(part_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (http->file.handle)
+   {
+      if (filestream_close(http->file.handle) != 0)
+         success = false;
+      http->file.handle = NULL;
+   }
+   else
+      success = false;
+
+   if (!success)
+   {
+      /* The server won't resume from there, start over next time */
+      if (http->handle && net_http_status(http->handle) == 416)
+         filestream_delete(part_path);
+      return false;
+   }
+
+   if (filestream_exists(http->file.path))
+      filestream_delete(http->file.path);
+
+   if (filestream_rename(part_path, http->file.path) != 0)
+   {
+      RARCH_ERR("[http] Could not move '%s' into place.\n", part_path);
+      return false;
+   }
+
+   return true;
+}
+
 static int task_http_con_iterate_transfer(http_handle_t *http)
 {
    if (!net_http_connection_iterate(http->connection.handle))
@@ -101,6 +274,9 @@ static int cb_http_conn_default(void *data_, size_t len)
       return -1;
    }
 
+   if (*http->file.path)
+      net_http_set_sink(http->handle, task_http_file_sink, http);
+
    http->cb     = NULL;
 
    return 0;
@@ -125,6 +301,13 @@ static int task_http_iterate_transfer(retro_task_t *task)
 
    if (!net_http_update(http->handle, &pos, &tot))
    {
+      /* Count what an earlier attempt already got */
+      if (tot)
+      {
+         pos += http->file.offset;
+         tot += http->file.offset;
+      }
+
       task_set_progress(task, (tot == 0) ? -1 : (signed)(pos * 100 / tot));
       return -1;
    }
@@ -147,6 +330,14 @@ static void task_http_transfer_handler(retro_task_t *task)
          http->status = HTTP_STATUS_TRANSFER;
          break;
       case HTTP_STATUS_CONNECTION_TRANSFER:
+         if (*http->file.path && !http->file.slot
+               && !task_http_take_slot(http))
+         {
+            /* Wait for one of the other downloads to finish */
+            if (task_queue_is_threaded())
+               retro_sleep(10);
+            break;
+         }
          if (!task_http_con_iterate_transfer(http))
             http->status = HTTP_STATUS_CONNECTION_TRANSFER_PARSE;
          break;
@@ -169,19 +360,33 @@ task_finished:
 
    if (http->handle)
    {
-      size_t len = 0;
-      char  *tmp = (char*)net_http_data(http->handle, &len, false);
+      size_t len  = 0;
+      char  *tmp  = (char*)net_http_data(http->handle, &len, false);
+      bool failed = net_http_error(http->handle) || task_get_cancelled(task);
 
       if (tmp && http->cb)
          http->cb(tmp, len);
 
-      if (net_http_error(http->handle) || task_get_cancelled(task))
+      if (*http->file.path)
+      {
+         /* The body went to disk, the buffer holds nothing */
+         free(net_http_data(http->handle, NULL, true));
+         tmp = NULL;
+         len = http->file.size;
+
+         if (!task_http_file_finish(http, !failed))
+            failed = true;
+      }
+      else if (failed)
       {
          tmp = (char*)net_http_data(http->handle, &len, true);
 
          if (tmp)
             free(tmp);
+      }
 
+      if (failed)
+      {
          if (task_get_cancelled(task))
             task_set_error(task, strdup("Task cancelled."));
          else
@@ -200,6 +405,7 @@ task_finished:
    } else if (http->error)
       task_set_error(task, strdup("Internal error."));
 
+   task_http_release_slot(http);
    free(http);
 }
 
@@ -244,7 +450,8 @@ static void http_transfer_progress_cb(retro_task_t *task)
 
 static void* task_push_http_transfer_generic(
       struct http_connection_t *conn,
-      const char *url, bool mute, const char *type,
+      const char *url, const char *path, const char *extract_dir,
+      bool mute, const char *type,
       retro_task_callback_t cb, void *user_data)
 {
    task_finder_data_t find_data;
@@ -284,6 +491,40 @@ static void* task_push_http_transfer_generic(
 
    strlcpy(http->connection.url, url, sizeof(http->connection.url));
 
+   if (!string_is_empty(path))
+   {
+      strlcpy(http->file.path, path, sizeof(http->file.path));
+
+      if (extract_dir)
+      {
+         http->file.extract = file_archive_extract_stream_new(path, extract_dir);
+
+         if (!http->file.extract)
+            goto error;
+      }
+      else
+      {
+         char part_path[PATH_MAX_LENGTH];
+         int32_t part_size;
+
+         task_http_part_path(http, part_path, sizeof(part_path));
+
+         /* Pick up where an earlier attempt stopped */
+         part_size = path_get_size(part_path);
+         if (part_size > 0)
+         {
+            http->file.offset = part_size;
+            net_http_connection_set_range(conn, http->file.offset);
+         }
+      }
+
+#ifdef HAVE_THREADS
+      /* Downloads to disk are only pushed from the main thread */
+      if (!http_file_lock)
+         http_file_lock = slock_new();
+#endif
+   }
+
    http->status            = HTTP_STATUS_CONNECTION_TRANSFER;
    t                       = (retro_task_t*)calloc(1, sizeof(*t));
 
@@ -322,7 +563,11 @@ error:
    if (conn)
       net_http_connection_free(conn);
    if (http)
+   {
+      if (http->file.extract)
+         file_archive_extract_stream_free(http->file.extract);
       free(http);
+   }
 
    return NULL;
 }
@@ -335,7 +580,38 @@ void* task_push_http_transfer(const char *url, bool mute,
 
    conn = net_http_connection_new(url, "GET", NULL);
 
-   return task_push_http_transfer_generic(conn, url, mute, type, cb, user_data);
+   return task_push_http_transfer_generic(conn, url, NULL, NULL,
+         mute, type, cb, user_data);
+}
+
+void* task_push_http_transfer_file(const char *url, const char *path,
+      bool mute, const char *type,
+      retro_task_callback_t cb, void *user_data)
+{
+   struct http_connection_t *conn;
+
+   if (string_is_empty(path))
+      return NULL;
+
+   conn = net_http_connection_new(url, "GET", NULL);
+
+   return task_push_http_transfer_generic(conn, url, path, NULL,
+         mute, type, cb, user_data);
+}
+
+void* task_push_http_transfer_extract(const char *url, const char *path,
+      const char *target_dir, bool mute, const char *type,
+      retro_task_callback_t cb, void *user_data)
+{
+   struct http_connection_t *conn;
+
+   if (string_is_empty(path) || string_is_empty(target_dir))
+      return NULL;
+
+   conn = net_http_connection_new(url, "GET", NULL);
+
+   return task_push_http_transfer_generic(conn, url, path, target_dir,
+         mute, type, cb, user_data);
 }
 
 void* task_push_http_post_transfer(const char *url,
@@ -347,7 +623,7 @@ void* task_push_http_post_transfer(const char *url,
    conn = net_http_connection_new(url, "POST", post_data);
 
    return task_push_http_transfer_generic(conn,
-         url, mute, type, cb, user_data);
+         url, NULL, NULL, mute, type, cb, user_data);
 }
 
 task_retriever_info_t *http_task_get_transfer_list(void)
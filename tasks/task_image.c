@@ -20,6 +20,9 @@
 
 #include <file/nbio.h>
 #include <formats/image.h>
+#ifdef HAVE_RPNG
+#include <formats/rpng.h>
+#endif
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
@@ -190,6 +193,12 @@ static int cb_nbio_image_menu_thumbnail(void *data, size_t len)
    if (!handle)
       return -1;
 
+#ifdef HAVE_RPNG
+   /* Boxart is big enough to keep two cores busy. */
+   if (image->type == IMAGE_TYPE_PNG)
+      rpng_set_threaded((rpng_t*)handle, true);
+#endif
+
    image->handle                   = handle;
    image->size                     = len;
    image->cb                       = &cb_image_menu_thumbnail;
@@ -363,6 +372,7 @@ bool task_push_image_load(const char *fullpath, retro_task_callback_t cb, void *
    t->cleanup         = task_image_load_free;
    t->callback        = cb;
    t->user_data       = user_data;
+   t->priority        = TASK_PRIORITY_HIGH;
 
    task_queue_push(t);
 
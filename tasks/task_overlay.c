@@ -23,6 +23,9 @@
 #include <lists/string_list.h>
 #include <string/stdstring.h>
 #include <rhash.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rjob.h>
+#endif
 
 #include "tasks_internal.h"
 
@@ -45,6 +48,8 @@ struct overlay_loader
    struct overlay *active;
    bool overlay_enable;
    bool overlay_hide_in_menu;
+   bool build_atlas;
+   bool supports_rgba;
    size_t resolve_pos;
    unsigned size;
    unsigned pos;
@@ -61,44 +66,111 @@ static void task_overlay_image_done(struct overlay *overlay)
    overlay->pos_increment = (overlay->size / 2) ? ((unsigned)(overlay->size / 2)) : 8;
 }
 
-static void task_overlay_load_desc_image(
-      overlay_loader_t *loader,
-      struct overlay_desc *desc,
-      struct overlay *input_overlay,
-      unsigned ol_idx, unsigned desc_idx)
+typedef struct
 {
-   char overlay_desc_image_key[64];
-   char image_path[PATH_MAX_LENGTH];
-   config_file_t              *conf = loader->conf;
+   struct texture_image image;
+   /* Index of the desc the image belongs to, -1 for the base image. */
+   int desc;
+   bool loaded;
+   char path[PATH_MAX_LENGTH];
+} overlay_image_job_t;
+
+static void task_overlay_decode_images(void *data,
+      unsigned begin, unsigned end)
+{
+   unsigned i;
+   overlay_image_job_t *jobs = (overlay_image_job_t*)data;
 
-   overlay_desc_image_key[0]        = '\0';
-   image_path[0]                    = '\0';
+   for (i = begin; i < end; i++)
+      jobs[i].loaded = image_texture_load(&jobs[i].image, jobs[i].path);
+}
 
-   snprintf(overlay_desc_image_key, sizeof(overlay_desc_image_key),
-         "overlay%u_desc%u_overlay", ol_idx, desc_idx);
+/* Decodes the base image and every desc image of the overlay at
+ * once, spread over the job pool, then packs them into an atlas
+ * if the video driver can use one. load_images keeps the old
+ * order: base image first, then the descs that have one. */
+static bool task_overlay_load_images(overlay_loader_t *loader,
+      struct overlay *overlay, unsigned ol_idx)
+{
+   unsigned i;
+   unsigned count            = 0;
+   bool ret                  = true;
+   config_file_t *conf       = loader->conf;
+   overlay_image_job_t *jobs = (overlay_image_job_t*)
+      calloc(1 + overlay->size, sizeof(*jobs));
+
+   if (!jobs)
+      return false;
+
+   if (!string_is_empty(overlay->config.paths.path))
+   {
+      fill_pathname_resolve_relative(jobs[count].path,
+            loader->overlay_path,
+            overlay->config.paths.path, sizeof(jobs[count].path));
+      jobs[count++].desc = -1;
+   }
 
-   if (config_get_path(conf, overlay_desc_image_key,
-            image_path, sizeof(image_path)))
+   for (i = 0; i < overlay->size; i++)
    {
-      struct texture_image image_tex;
-      char path[PATH_MAX_LENGTH];
+      char overlay_desc_image_key[64];
+      char image_path[PATH_MAX_LENGTH];
+
+      overlay_desc_image_key[0] = '\0';
+      image_path[0]             = '\0';
 
-      path[0] = '\0';
+      snprintf(overlay_desc_image_key, sizeof(overlay_desc_image_key),
+            "overlay%u_desc%u_overlay", ol_idx, i);
 
-      fill_pathname_resolve_relative(path, loader->overlay_path,
-            image_path, sizeof(path));
+      if (!config_get_path(conf, overlay_desc_image_key,
+               image_path, sizeof(image_path)))
+         continue;
+
+      fill_pathname_resolve_relative(jobs[count].path,
+            loader->overlay_path, image_path, sizeof(jobs[count].path));
+      jobs[count++].desc = (int)i;
+   }
+
+   for (i = 0; i < count; i++)
+      jobs[i].image.supports_rgba = loader->supports_rgba;
+
+#ifdef HAVE_THREADS
+   rjob_parallel_for(count, 1, task_overlay_decode_images, jobs);
+#else
+   task_overlay_decode_images(jobs, 0, count);
+#endif
 
-      image_tex.supports_rgba = video_driver_supports_rgba();
+   if (count && jobs[0].desc < 0 && !jobs[0].loaded)
+   {
+      RARCH_ERR("[Overlay]: Failed to load image: %s.\n", jobs[0].path);
+      for (i = 0; i < count; i++)
+         image_texture_free(&jobs[i].image);
+      ret = false;
+      goto end;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      if (!jobs[i].loaded)
+         continue;
 
-      if (image_texture_load(&image_tex, path))
+      overlay->load_images[overlay->load_images_size++] = jobs[i].image;
+
+      if (jobs[i].desc < 0)
+         overlay->image = jobs[i].image;
+      else
       {
-         input_overlay->load_images[input_overlay->load_images_size++] = image_tex;
-         desc->image       = image_tex;
-         desc->image_index = input_overlay->load_images_size - 1;
+         struct overlay_desc *desc = &overlay->descs[jobs[i].desc];
+         desc->image               = jobs[i].image;
+         desc->image_index         = overlay->load_images_size - 1;
       }
    }
 
-   input_overlay->pos ++;
+   if (loader->build_atlas)
+      input_overlay_build_atlas(overlay);
+
+end:
+   free(jobs);
+   return ret;
 }
 
 static bool task_overlay_load_desc(
@@ -412,22 +484,14 @@ static void task_overlay_deferred_loading(retro_task_t *task)
          loader->overlays[loader->pos].pos = 0;
          break;
       case OVERLAY_IMAGE_TRANSFER_DESC_IMAGE_ITERATE:
-         for (i = 0; i < overlay->pos_increment; i++)
+         if (!task_overlay_load_images(loader, overlay, loader->pos))
          {
-            if (overlay->pos < overlay->size)
-            {
-               task_overlay_load_desc_image(loader,
-                     &overlay->descs[overlay->pos], overlay,
-                     loader->pos, (unsigned)overlay->pos);
-            }
-            else
-            {
-               overlay->pos       = 0;
-               loader->loading_status = OVERLAY_IMAGE_TRANSFER_DESC_ITERATE;
-               break;
-            }
-
+            task_set_cancelled(task, true);
+            loader->state   = OVERLAY_STATUS_DEFERRED_ERROR;
+            break;
          }
+         overlay->pos           = 0;
+         loader->loading_status = OVERLAY_IMAGE_TRANSFER_DESC_ITERATE;
          break;
       case OVERLAY_IMAGE_TRANSFER_DESC_ITERATE:
          for (i = 0; i < overlay->pos_increment; i++)
@@ -566,30 +630,8 @@ static void task_overlay_deferred_load(retro_task_t *task)
          strlcpy(overlay->config.paths.path,
                tmp_str, sizeof(overlay->config.paths.path));
 
-      if (!string_is_empty(overlay->config.paths.path))
-      {
-         struct texture_image image_tex;
-         char overlay_resolved_path[PATH_MAX_LENGTH];
-
-         overlay_resolved_path[0] = '\0';
-
-         fill_pathname_resolve_relative(overlay_resolved_path,
-               loader->overlay_path,
-               overlay->config.paths.path, sizeof(overlay_resolved_path));
-
-         image_tex.supports_rgba = video_driver_supports_rgba();
-
-         if (!image_texture_load(&image_tex, overlay_resolved_path))
-         {
-            RARCH_ERR("[Overlay]: Failed to load image: %s.\n",
-                  overlay_resolved_path);
-            loader->loading_status = OVERLAY_IMAGE_TRANSFER_ERROR;
-            goto error;
-         }
-
-         overlay->load_images[overlay->load_images_size++] = image_tex;
-         overlay->image = image_tex;
-      }
+      /* The base image is decoded along with the desc images,
+       * see task_overlay_load_images. */
 
       snprintf(overlay->config.names.key, sizeof(overlay->config.names.key),
             "overlay%u_name", loader->pos);
@@ -734,6 +776,7 @@ bool task_push_overlay_load_default(
    const char *overlay_path = settings->paths.path_overlay;
    retro_task_t *t          = NULL;
    config_file_t *conf      = NULL;
+   const video_overlay_interface_t *iface = NULL;
    overlay_loader_t *loader = (overlay_loader_t*)calloc(1, sizeof(*loader));
 
    if (!loader)
@@ -774,6 +817,9 @@ bool task_push_overlay_load_default(
    loader->conf                 = conf;
    loader->state                = OVERLAY_STATUS_DEFERRED_LOAD;
    loader->pos_increment        = (loader->size / 4) ? (loader->size / 4) : 4;
+   loader->supports_rgba        = video_driver_supports_rgba();
+   loader->build_atlas          = video_driver_overlay_interface(&iface)
+      && iface && iface->load_atlas;
 
    t                            = (retro_task_t*)calloc(1, sizeof(*t));
 
@@ -25,11 +25,16 @@
 #include <boolean.h>
 
 #include <compat/msvc.h>
+#include <retro_miscellaneous.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
 
 #include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "../msg_hash.h"
 #include "../verbosity.h"
@@ -55,9 +60,12 @@ enum patch_error
    PATCH_TARGET_INVALID,
    PATCH_SOURCE_CHECKSUM_INVALID,
    PATCH_TARGET_CHECKSUM_INVALID,
-   PATCH_PATCH_CHECKSUM_INVALID
+   PATCH_PATCH_CHECKSUM_INVALID,
+   PATCH_OUT_OF_MEMORY
 };
 
+#define PATCH_CHECKSUM_RUN 0x10000
+
 struct bps_data
 {
    const uint8_t *modify_data;
@@ -69,46 +77,105 @@ struct bps_data
    size_t modify_offset;
    size_t source_offset;
    size_t target_offset;
-   uint32_t modify_checksum;
-   uint32_t source_checksum;
-   uint32_t target_checksum;
-   size_t source_relative_offset;
-   size_t target_relative_offset;
    size_t output_offset;
 };
 
-struct ups_data
+/* The patch functions work on the content buffer directly: on success
+ * @buf and @len describe the patched content and @crc holds its CRC32,
+ * on failure the content is left as it was. */
+typedef enum patch_error (*patch_func_t)(const uint8_t*, uint64_t,
+      uint8_t**, uint64_t*, uint32_t*);
+
+#ifdef HAVE_THREADS
+/* Whole buffer checksums of at least two chunks are split over
+ * up to this many threads and joined with encoding_crc32_combine(). */
+#define PATCH_CRC_CHUNK_SIZE (8 * 1024 * 1024)
+#define PATCH_CRC_MAX_THREADS 8
+
+typedef struct patch_crc_part
 {
-   const uint8_t *patch_data;
-   const uint8_t *source_data;
-   uint8_t *target_data;
-   unsigned patch_length;
-   unsigned source_length;
-   unsigned target_length;
-   unsigned patch_offset;
-   unsigned source_offset;
-   unsigned target_offset;
-   unsigned patch_checksum;
-   unsigned source_checksum;
-   unsigned target_checksum;
-};
+   const uint8_t *data;
+   size_t length;
+   uint32_t crc;
+} patch_crc_part_t;
 
-typedef enum patch_error (*patch_func_t)(const uint8_t*, uint64_t,
-      const uint8_t*, uint64_t, uint8_t*, uint64_t*);
+static void patch_crc32_thread(void *data)
+{
+   patch_crc_part_t *part = (patch_crc_part_t*)data;
+   part->crc              = encoding_crc32(0, part->data, part->length);
+}
+#endif
+
+static uint32_t patch_crc32(const uint8_t *data, size_t length)
+{
+#ifdef HAVE_THREADS
+   unsigned cores = cpu_features_get_core_amount();
+
+   if (cores > PATCH_CRC_MAX_THREADS)
+      cores = PATCH_CRC_MAX_THREADS;
+   if (cores > length / PATCH_CRC_CHUNK_SIZE)
+      cores = (unsigned)(length / PATCH_CRC_CHUNK_SIZE);
+
+   if (cores > 1)
+   {
+      unsigned i;
+      patch_crc_part_t parts[PATCH_CRC_MAX_THREADS];
+      sthread_t *threads[PATCH_CRC_MAX_THREADS];
+      size_t part_length = length / cores;
+      uint32_t crc       = 0;
+
+      for (i = 0; i < cores; i++)
+      {
+         parts[i].data   = data + i * part_length;
+         parts[i].length = (i == cores - 1)
+            ? length - i * part_length : part_length;
+         threads[i]      = NULL;
+      }
+
+      /* The first part is done on this thread, as is any part
+       * whose thread couldn't be started. */
+      for (i = 1; i < cores; i++)
+         threads[i] = sthread_create(patch_crc32_thread, &parts[i]);
+      patch_crc32_thread(&parts[0]);
+
+      for (i = 1; i < cores; i++)
+      {
+         if (threads[i])
+            sthread_join(threads[i]);
+         else
+            patch_crc32_thread(&parts[i]);
+      }
+
+      for (i = 0; i < cores; i++)
+         crc = encoding_crc32_combine(crc, parts[i].crc, parts[i].length);
+
+      return crc;
+   }
+#endif
+
+   return encoding_crc32(0, data, length);
+}
+
+static uint32_t patch_read_le32(const uint8_t *data)
+{
+   return ((uint32_t)data[0] <<  0)
+      |   ((uint32_t)data[1] <<  8)
+      |   ((uint32_t)data[2] << 16)
+      |   ((uint32_t)data[3] << 24);
+}
 
 static uint8_t bps_read(struct bps_data *bps)
 {
-   uint8_t data         = bps->modify_data[bps->modify_offset++];
-   bps->modify_checksum = ~(encoding_crc32(
-         ~bps->modify_checksum, &data, 1));
-   return data;
+   if (bps->modify_offset < bps->modify_length)
+      return bps->modify_data[bps->modify_offset++];
+   return 0x00;
 }
 
 static uint64_t bps_decode(struct bps_data *bps)
 {
    uint64_t data = 0, shift = 1;
 
-   for (;;)
+   while (bps->modify_offset < bps->modify_length)
    {
       uint8_t x  = bps_read(bps);
       data      += (x & 0x7f) * shift;
@@ -121,23 +188,16 @@ static uint64_t bps_decode(struct bps_data *bps)
    return data;
 }
 
-static void bps_write(struct bps_data *bps, uint8_t data)
-{
-   bps->target_data[bps->output_offset++] = data;
-   bps->target_checksum = ~(encoding_crc32(~bps->target_checksum, &data, 1));
-}
-
 static enum patch_error bps_apply_patch(
       const uint8_t *modify_data, uint64_t modify_length,
-      const uint8_t *source_data, uint64_t source_length,
-      uint8_t *target_data, uint64_t *target_length)
+      uint8_t **buf, uint64_t *length, uint32_t *crc)
 {
-   size_t i;
-   uint32_t checksum;
    size_t modify_source_size;
    size_t modify_target_size;
    size_t modify_markup_size;
    struct bps_data bps;
+   size_t checksum_offset          = 0;
+   uint32_t target_checksum        = 0;
    uint32_t modify_source_checksum = 0;
    uint32_t modify_target_checksum = 0;
    uint32_t modify_modify_checksum = 0;
@@ -146,19 +206,14 @@ static enum patch_error bps_apply_patch(
       return PATCH_PATCH_TOO_SMALL;
 
    bps.modify_data            = modify_data;
-   bps.source_data            = source_data;
-   bps.target_data            = target_data;
+   bps.source_data            = *buf;
+   bps.target_data            = NULL;
    bps.modify_length          = modify_length;
-   bps.source_length          = source_length;
-   bps.target_length          = *target_length;
+   bps.source_length          = *length;
+   bps.target_length          = 0;
    bps.modify_offset          = 0;
    bps.source_offset          = 0;
    bps.target_offset          = 0;
-   bps.modify_checksum        = ~0;
-   bps.source_checksum        = 0;
-   bps.target_checksum        = ~0;
-   bps.source_relative_offset = 0;
-   bps.target_relative_offset = 0;
    bps.output_offset          = 0;
 
    if (  (bps_read(&bps) != 'B') ||
@@ -167,17 +222,38 @@ static enum patch_error bps_apply_patch(
          (bps_read(&bps) != '1'))
       return PATCH_PATCH_INVALID_HEADER;
 
+   modify_source_checksum = patch_read_le32(modify_data + modify_length - 12);
+   modify_target_checksum = patch_read_le32(modify_data + modify_length - 8);
+   modify_modify_checksum = patch_read_le32(modify_data + modify_length - 4);
+
+   /* Both checksums known up front are verified before anything
+    * is allocated, a patch for other content fails right here. */
+   if (patch_crc32(modify_data, (size_t)modify_length - 4)
+         != modify_modify_checksum)
+      return PATCH_PATCH_CHECKSUM_INVALID;
+
+   if (patch_crc32(bps.source_data, bps.source_length)
+         != modify_source_checksum)
+      return PATCH_SOURCE_CHECKSUM_INVALID;
+
    modify_source_size  = bps_decode(&bps);
    modify_target_size  = bps_decode(&bps);
    modify_markup_size  = bps_decode(&bps);
 
-   for (i = 0; i < modify_markup_size; i++)
-      bps_read(&bps);
+   if (modify_markup_size > bps.modify_length - bps.modify_offset)
+      return PATCH_PATCH_INVALID;
+   bps.modify_offset  += modify_markup_size;
 
    if (modify_source_size > bps.source_length)
       return PATCH_SOURCE_TOO_SMALL;
-   if (modify_target_size > bps.target_length)
-      return PATCH_TARGET_TOO_SMALL;
+
+   /* SourceCopy needs random access to the source, so this is the
+    * only format which can't be applied in place. The target is
+    * sized from the header instead of guessed. */
+   bps.target_length = modify_target_size;
+   if (!(bps.target_data = (uint8_t*)malloc(
+         modify_target_size ? modify_target_size : 1)))
+      return PATCH_OUT_OF_MEMORY;
 
    while (bps.modify_offset < bps.modify_length - 12)
    {
@@ -186,23 +262,33 @@ static enum patch_error bps_apply_patch(
 
       length = (length >> 2) + 1;
 
+      if (length > bps.target_length - bps.output_offset)
+         goto error;
+
       switch (mode)
       {
          case SOURCE_READ:
-            while (length--)
-               bps_write(&bps, bps.source_data[bps.output_offset]);
+            if (bps.output_offset + length > bps.source_length)
+               goto error;
+            memcpy(bps.target_data + bps.output_offset,
+                  bps.source_data + bps.output_offset, length);
+            bps.output_offset += length;
             break;
 
          case TARGET_READ:
-            while (length--)
-               bps_write(&bps, bps_read(&bps));
+            if (length > bps.modify_length - bps.modify_offset)
+               goto error;
+            memcpy(bps.target_data + bps.output_offset,
+                  bps.modify_data + bps.modify_offset, length);
+            bps.modify_offset += length;
+            bps.output_offset += length;
             break;
 
          case SOURCE_COPY:
          case TARGET_COPY:
          {
-            int    offset = (int)bps_decode(&bps);
-            bool negative = offset & 1;
+            int64_t offset = (int64_t)bps_decode(&bps);
+            bool negative  = offset & 1;
 
             offset >>= 1;
 
@@ -211,229 +297,216 @@ static enum patch_error bps_apply_patch(
 
             if (mode == SOURCE_COPY)
             {
-               bps.source_offset += offset;
-               while (length--)
-                  bps_write(&bps, bps.source_data[bps.source_offset++]);
+               bps.source_offset += (size_t)offset;
+               if (     bps.source_offset > bps.source_length
+                     || length > bps.source_length - bps.source_offset)
+                  goto error;
+               memcpy(bps.target_data + bps.output_offset,
+                     bps.source_data + bps.source_offset, length);
+               bps.source_offset += length;
+               bps.output_offset += length;
             }
             else
             {
-               bps.target_offset += offset;
+               /* May overlap the output on purpose (run-length),
+                * so this one has to go byte by byte. */
+               bps.target_offset += (size_t)offset;
+               if (bps.target_offset >= bps.output_offset)
+                  goto error;
                while (length--)
-                  bps_write(&bps, bps.target_data[bps.target_offset++]);
-               break;
+                  bps.target_data[bps.output_offset++] =
+                     bps.target_data[bps.target_offset++];
             }
             break;
          }
       }
-   }
 
-   for (i = 0; i < 32; i += 8)
-      modify_source_checksum |= bps_read(&bps) << i;
-   for (i = 0; i < 32; i += 8)
-      modify_target_checksum |= bps_read(&bps) << i;
-
-   checksum = ~bps.modify_checksum;
-   for (i = 0; i < 32; i += 8)
-      modify_modify_checksum |= bps_read(&bps) << i;
+      /* Checksum the output in runs while it is still in cache. */
+      if (bps.output_offset - checksum_offset >= PATCH_CHECKSUM_RUN)
+      {
+         target_checksum = encoding_crc32(target_checksum,
+               bps.target_data + checksum_offset,
+               bps.output_offset - checksum_offset);
+         checksum_offset = bps.output_offset;
+      }
+   }
 
-   bps.source_checksum = encoding_crc32(0,
-         bps.source_data, bps.source_length);
-   bps.target_checksum = ~bps.target_checksum;
+   if (bps.output_offset != bps.target_length)
+      goto error;
 
-   if (bps.source_checksum != modify_source_checksum)
-      return PATCH_SOURCE_CHECKSUM_INVALID;
+   target_checksum = encoding_crc32(target_checksum,
+         bps.target_data + checksum_offset,
+         bps.output_offset - checksum_offset);
 
-   if (bps.target_checksum != modify_target_checksum)
+   if (target_checksum != modify_target_checksum)
+   {
+      free(bps.target_data);
       return PATCH_TARGET_CHECKSUM_INVALID;
+   }
 
-   if (checksum != modify_modify_checksum)
-      return PATCH_PATCH_CHECKSUM_INVALID;
-
-   *target_length = modify_target_size;
+   free(*buf);
+   *buf    = bps.target_data;
+   *length = modify_target_size;
+   *crc    = target_checksum;
 
    return PATCH_SUCCESS;
-}
 
-static uint8_t ups_patch_read(struct ups_data *data)
-{
-   if (data && data->patch_offset < data->patch_length)
-   {
-      uint8_t n = data->patch_data[data->patch_offset++];
-      data->patch_checksum =
-         ~(encoding_crc32(~data->patch_checksum, &n, 1));
-      return n;
-   }
-   return 0x00;
-}
-
-static uint8_t ups_source_read(struct ups_data *data)
-{
-   if (data && data->source_offset < data->source_length)
-   {
-      uint8_t n = data->source_data[data->source_offset++];
-      data->source_checksum =
-         ~(encoding_crc32(~data->source_checksum, &n, 1));
-      return n;
-   }
-   return 0x00;
+error:
+   free(bps.target_data);
+   return PATCH_PATCH_INVALID;
 }
 
-static void ups_target_write(struct ups_data *data, uint8_t n)
+static uint64_t ups_decode(const uint8_t *data, size_t length,
+      size_t *offset)
 {
+   uint64_t value = 0, shift = 1;
 
-   if (data && data->target_offset < data->target_length)
+   while (*offset < length)
    {
-      data->target_data[data->target_offset] = n;
-      data->target_checksum =
-         ~(encoding_crc32(~data->target_checksum, &n, 1));
-   }
+      uint8_t x = data[(*offset)++];
+      value    += (x & 0x7f) * shift;
 
-   if (data)
-      data->target_offset++;
+      if (x & 0x80)
+         break;
+      shift <<= 7;
+      value  += shift;
+   }
+   return value;
 }
 
-static uint64_t ups_decode(struct ups_data *data)
+/**
+ * ups_xor_pass:
+ *
+ * XORs the UPS hunks starting at @offset into @data. Bytes past the
+ * end of the source are expected to be zero. Since this is its own
+ * inverse, running it a second time restores the source.
+ **/
+static void ups_xor_pass(const uint8_t *patch_data, size_t patch_length,
+      size_t offset, uint8_t *data, size_t length)
 {
-   uint64_t offset = 0, shift = 1;
-   while (true)
+   uint64_t position = 0;
+
+   while (offset < patch_length - 12)
    {
-      uint8_t x = ups_patch_read(data);
-      offset   += (x & 0x7f) * shift;
+      position += ups_decode(patch_data, patch_length - 12, &offset);
 
-      if (x & 0x80)
-         break;
-      shift <<= 7;
-      offset += shift;
+      while (offset < patch_length - 12)
+      {
+         uint8_t patch_xor = patch_data[offset++];
+         if (position < length)
+            data[position] ^= patch_xor;
+         position++;
+         if (patch_xor == 0)
+            break;
+      }
    }
-   return offset;
 }
 
 static enum patch_error ups_apply_patch(
       const uint8_t *patchdata, uint64_t patchlength,
-      const uint8_t *sourcedata, uint64_t sourcelength,
-      uint8_t *targetdata, uint64_t *targetlength)
+      uint8_t **buf, uint64_t *length, uint32_t *crc)
 {
-   size_t i;
-   struct ups_data data;
-   unsigned source_read_length;
-   unsigned target_read_length;
-   uint32_t patch_result_checksum;
-   uint32_t patch_read_checksum  = 0;
-   uint32_t source_read_checksum = 0;
-   uint32_t target_read_checksum = 0;
-
-   data.patch_data      = patchdata;
-   data.source_data     = sourcedata;
-   data.target_data     = targetdata;
-   data.patch_length    = (unsigned)patchlength;
-   data.source_length   = (unsigned)sourcelength;
-   data.target_length   = (unsigned)*targetlength;
-   data.patch_offset    = 0;
-   data.source_offset   = 0;
-   data.target_offset   = 0;
-   data.patch_checksum  = ~0;
-   data.source_checksum = ~0;
-   data.target_checksum = ~0;
-
-   if (data.patch_length < 18)
+   size_t offset = 4;
+   uint64_t source_read_length;
+   uint64_t target_read_length;
+   uint64_t target_length;
+   uint64_t buffer_length;
+   uint32_t source_checksum;
+   uint32_t target_checksum;
+   uint32_t expected_checksum;
+   uint32_t source_read_checksum;
+   uint32_t target_read_checksum;
+   uint8_t *data        = *buf;
+   uint64_t data_length = *length;
+
+   if (patchlength < 18)
       return PATCH_PATCH_INVALID;
 
    if (
-         (ups_patch_read(&data) != 'U') ||
-         (ups_patch_read(&data) != 'P') ||
-         (ups_patch_read(&data) != 'S') ||
-         (ups_patch_read(&data) != '1')
+         (patchdata[0] != 'U') ||
+         (patchdata[1] != 'P') ||
+         (patchdata[2] != 'S') ||
+         (patchdata[3] != '1')
       )
       return PATCH_PATCH_INVALID;
 
-   source_read_length = (unsigned)ups_decode(&data);
-   target_read_length = (unsigned)ups_decode(&data);
+   source_read_checksum = patch_read_le32(patchdata + patchlength - 12);
+   target_read_checksum = patch_read_le32(patchdata + patchlength - 8);
 
-   if (     (data.source_length != source_read_length)
-         && (data.source_length != target_read_length))
-      return PATCH_SOURCE_INVALID;
-
-   *targetlength = (data.source_length == source_read_length ?
-         target_read_length : source_read_length);
+   if (patch_crc32(patchdata, (size_t)patchlength - 4)
+         != patch_read_le32(patchdata + patchlength - 4))
+      return PATCH_PATCH_INVALID;
 
-   if (data.target_length < *targetlength)
-      return PATCH_TARGET_TOO_SMALL;
+   source_read_length = ups_decode(patchdata, (size_t)patchlength - 12,
+         &offset);
+   target_read_length = ups_decode(patchdata, (size_t)patchlength - 12,
+         &offset);
 
-   data.target_length = (unsigned)*targetlength;
+   /* UPS patches apply both ways, the source checksum tells which
+    * way this is. Verifying it first means the content is only
+    * touched by a patch that matches it. */
+   source_checksum = patch_crc32(data, (size_t)data_length);
 
-   while (data.patch_offset < data.patch_length - 12)
+   if (     data_length     == source_read_length
+         && source_checksum == source_read_checksum)
    {
-      unsigned length = (unsigned)ups_decode(&data);
-      while (length--)
-         ups_target_write(&data, ups_source_read(&data));
-      while (true)
-      {
-         uint8_t patch_xor = ups_patch_read(&data);
-         ups_target_write(&data, patch_xor ^ ups_source_read(&data));
-         if (patch_xor == 0)
-            break;
-      }
+      target_length     = target_read_length;
+      expected_checksum = target_read_checksum;
    }
+   else if (data_length     == target_read_length
+         && source_checksum == target_read_checksum)
+   {
+      target_length     = source_read_length;
+      expected_checksum = source_read_checksum;
+   }
+   else
+      return PATCH_SOURCE_INVALID;
 
-   while (data.source_offset < data.source_length)
-      ups_target_write(&data, ups_source_read(&data));
-   while (data.target_offset < data.target_length)
-      ups_target_write(&data, ups_source_read(&data));
-
-
-   for (i = 0; i < 4; i++)
-      source_read_checksum |= ups_patch_read(&data) << (i * 8);
-   for (i = 0; i < 4; i++)
-      target_read_checksum |= ups_patch_read(&data) << (i * 8);
+   buffer_length = MAX(data_length, target_length);
 
-   patch_result_checksum = ~data.patch_checksum;
-   data.source_checksum  = ~data.source_checksum;
-   data.target_checksum  = ~data.target_checksum;
+   if (buffer_length > data_length)
+   {
+      uint8_t *grown = (uint8_t*)realloc(data, (size_t)buffer_length);
+      if (!grown)
+         return PATCH_OUT_OF_MEMORY;
+      memset(grown + data_length, 0, (size_t)(buffer_length - data_length));
+      *buf = data = grown;
+   }
 
-   for (i = 0; i < 4; i++)
-      patch_read_checksum |= ups_patch_read(&data) << (i * 8);
+   /* Unchanged bytes are simply skipped over. */
+   ups_xor_pass(patchdata, (size_t)patchlength, offset,
+         data, (size_t)buffer_length);
 
-   if (patch_result_checksum != patch_read_checksum)
-      return PATCH_PATCH_INVALID;
+   target_checksum = patch_crc32(data, (size_t)target_length);
 
-   if (data.source_checksum == source_read_checksum
-         && data.source_length == source_read_length)
+   if (target_checksum != expected_checksum)
    {
-      if (data.target_checksum == target_read_checksum
-            && data.target_length == target_read_length)
-         return PATCH_SUCCESS;
-      return PATCH_TARGET_INVALID;
-   }
-   else if (data.source_checksum == target_read_checksum
-         && data.source_length == target_read_length)
-   {
-      if (data.target_checksum == source_read_checksum
-            && data.target_length == source_read_length)
-         return PATCH_SUCCESS;
+      ups_xor_pass(patchdata, (size_t)patchlength, offset,
+            data, (size_t)buffer_length);
       return PATCH_TARGET_INVALID;
    }
 
-   return PATCH_SOURCE_INVALID;
+   *length = target_length;
+   *crc    = target_checksum;
+
+   return PATCH_SUCCESS;
 }
 
-static enum patch_error ips_apply_patch(
+/**
+ * ips_walk:
+ *
+ * Walks the IPS records. With @targetdata NULL this only validates
+ * the patch, reporting the resulting size in @targetlength and the
+ * highest byte written in @extent, so the records can afterwards be
+ * applied without any further checks.
+ **/
+static enum patch_error ips_walk(
       const uint8_t *patchdata, uint64_t patchlen,
-      const uint8_t *sourcedata, uint64_t sourcelength,
-      uint8_t *targetdata, uint64_t *targetlength)
+      uint8_t *targetdata, uint64_t *targetlength, uint64_t *extent)
 {
    uint32_t offset = 5;
 
-   if (patchlen < 8 ||
-         patchdata[0] != 'P' ||
-         patchdata[1] != 'A' ||
-         patchdata[2] != 'T' ||
-         patchdata[3] != 'C' ||
-         patchdata[4] != 'H')
-      return PATCH_PATCH_INVALID;
-
-   memcpy(targetdata, sourcedata, (size_t)sourcelength);
-
-   *targetlength = sourcelength;
+   *extent = *targetlength;
 
    for (;;)
    {
@@ -472,8 +545,9 @@ static enum patch_error ips_apply_patch(
          if (offset > patchlen - length)
             break;
 
-         while (length--)
-            targetdata[address++] = patchdata[offset++];
+         if (targetdata)
+            memcpy(targetdata + address, patchdata + offset, length);
+         offset += length;
       }
       else /* RLE */
       {
@@ -486,51 +560,105 @@ static enum patch_error ips_apply_patch(
          if (length == 0) /* Illegal */
             break;
 
-         while (length--)
-            targetdata[address++] = patchdata[offset];
-
+         if (targetdata)
+            memset(targetdata + address, patchdata[offset], length);
          offset++;
       }
 
+      address += length;
+
       if (address > *targetlength)
          *targetlength = address;
+      if (address > *extent)
+         *extent = address;
    }
 
    return PATCH_PATCH_INVALID;
 }
 
+static enum patch_error ips_apply_patch(
+      const uint8_t *patchdata, uint64_t patchlen,
+      uint8_t **buf, uint64_t *length, uint32_t *crc)
+{
+   enum patch_error err;
+   uint64_t extent;
+   uint64_t buffer_length;
+   uint64_t target_length = *length;
+   uint8_t *data          = *buf;
+
+   if (patchlen < 8 ||
+         patchdata[0] != 'P' ||
+         patchdata[1] != 'A' ||
+         patchdata[2] != 'T' ||
+         patchdata[3] != 'C' ||
+         patchdata[4] != 'H')
+      return PATCH_PATCH_INVALID;
+
+   if ((err = ips_walk(patchdata, patchlen, NULL,
+         &target_length, &extent)) != PATCH_SUCCESS)
+      return err;
+
+   /* IPS records are plain overwrites, so they go straight into the
+    * content buffer, grown to whatever the records reach. */
+   buffer_length = MAX(extent, target_length);
+
+   if (buffer_length > *length)
+   {
+      uint8_t *grown = (uint8_t*)realloc(data, (size_t)buffer_length);
+      if (!grown)
+         return PATCH_OUT_OF_MEMORY;
+      memset(grown + *length, 0, (size_t)(buffer_length - *length));
+      *buf = data = grown;
+   }
+
+   target_length = *length;
+   ips_walk(patchdata, patchlen, data, &target_length, &extent);
+
+   *length = target_length;
+   *crc    = patch_crc32(data, (size_t)target_length);
+
+   return PATCH_SUCCESS;
+}
+
+bool patch_apply_bps(const uint8_t *patch, size_t patch_size,
+      uint8_t **buf, size_t *size)
+{
+   uint32_t crc    = 0;
+   uint64_t length = *size;
+
+   if (bps_apply_patch(patch, patch_size, buf, &length, &crc)
+         != PATCH_SUCCESS)
+      return false;
+
+   *size = (size_t)length;
+   return true;
+}
+
 static bool apply_patch_content(uint8_t **buf,
       ssize_t *size, const char *patch_desc, const char *patch_path,
-      patch_func_t func, void *patch_data, int64_t patch_size)
+      patch_func_t func, void *patch_data, int64_t patch_size,
+      uint32_t *crc, bool *patched)
 {
    enum patch_error err     = PATCH_UNKNOWN;
-   ssize_t ret_size         = *size;
-   uint8_t *ret_buf         = *buf;
-   uint64_t target_size     = ret_size * 4; /* Just to be sure. */
-   uint8_t *patched_content = (uint8_t*)malloc((size_t)target_size);
+   uint64_t target_size     = *size;
 
    RARCH_LOG("Found %s file in \"%s\", attempting to patch ...\n",
          patch_desc, patch_path);
 
-   if (!patched_content)
+   err = func((const uint8_t*)patch_data, patch_size, buf,
+         &target_size, crc);
+
+   if (err == PATCH_OUT_OF_MEMORY)
    {
       RARCH_ERR("%s\n",
             msg_hash_to_str(MSG_FAILED_TO_ALLOCATE_MEMORY_FOR_PATCHED_CONTENT));
-
-      *buf  = ret_buf;
-      *size = ret_size;
-
       return false;
    }
 
-   err = func((const uint8_t*)patch_data, patch_size, ret_buf,
-         ret_size, patched_content, &target_size);
-
    if (err == PATCH_SUCCESS)
    {
-      free(ret_buf);
-      *buf  = patched_content;
-      *size = target_size;
+      *size    = target_size;
+      *patched = true;
    }
    else
       RARCH_ERR("%s %s: %s #%u\n",
@@ -543,7 +671,7 @@ static bool apply_patch_content(uint8_t **buf,
 }
 
 static bool try_bps_patch(bool allow_bps, const char *name_bps,
-      uint8_t **buf, ssize_t *size)
+      uint8_t **buf, ssize_t *size, uint32_t *crc, bool *patched)
 {
    if (allow_bps && !string_is_empty(name_bps))
       if (path_is_valid(name_bps) && filestream_exists(name_bps))
@@ -559,7 +687,8 @@ static bool try_bps_patch(bool allow_bps, const char *name_bps,
          {
             ret                      = apply_patch_content(
                   buf, size, "BPS", name_bps,
-                  bps_apply_patch, patch_data, patch_size);
+                  bps_apply_patch, patch_data, patch_size,
+                  crc, patched);
          }
 
          if (patch_data)
@@ -570,7 +699,7 @@ static bool try_bps_patch(bool allow_bps, const char *name_bps,
 }
 
 static bool try_ups_patch(bool allow_ups, const char *name_ups,
-      uint8_t **buf, ssize_t *size)
+      uint8_t **buf, ssize_t *size, uint32_t *crc, bool *patched)
 {
    if (allow_ups && !string_is_empty(name_ups))
       if (path_is_valid(name_ups) && filestream_exists(name_ups))
@@ -586,7 +715,8 @@ static bool try_ups_patch(bool allow_ups, const char *name_ups,
          {
             ret                      = apply_patch_content(
                   buf, size, "UPS", name_ups,
-                  ups_apply_patch, patch_data, patch_size);
+                  ups_apply_patch, patch_data, patch_size,
+                  crc, patched);
          }
 
          if (patch_data)
@@ -597,7 +727,8 @@ static bool try_ups_patch(bool allow_ups, const char *name_ups,
 }
 
 static bool try_ips_patch(bool allow_ips,
-      const char *name_ips, uint8_t **buf, ssize_t *size)
+      const char *name_ips, uint8_t **buf, ssize_t *size,
+      uint32_t *crc, bool *patched)
 {
    if (allow_ips && !string_is_empty(name_ips))
       if (path_is_valid(name_ips) && filestream_exists(name_ips))
@@ -613,7 +744,8 @@ static bool try_ips_patch(bool allow_ips,
          {
             ret                      = apply_patch_content(
                   buf, size, "IPS", name_ips,
-                  ips_apply_patch, patch_data, patch_size);
+                  ips_apply_patch, patch_data, patch_size,
+                  crc, patched);
          }
 
          if (patch_data)
@@ -623,15 +755,49 @@ static bool try_ips_patch(bool allow_ips,
    return false;
 }
 
+/**
+ * patch_content_exists:
+ *
+ * Returns: true if patch_content() may find a patch to apply
+ * with these preferences and names.
+ **/
+static bool patch_content_exists(
+      bool is_ips_pref,
+      bool is_bps_pref,
+      bool is_ups_pref,
+      const char *name_ips,
+      const char *name_bps,
+      const char *name_ups)
+{
+   if (    (unsigned)is_ips_pref
+         + (unsigned)is_bps_pref
+         + (unsigned)is_ups_pref > 1)
+      return false;
+
+   if (!is_ups_pref && !is_bps_pref && !string_is_empty(name_ips)
+         && path_is_valid(name_ips))
+      return true;
+   if (!is_ups_pref && !is_ips_pref && !string_is_empty(name_bps)
+         && path_is_valid(name_bps))
+      return true;
+   if (!is_bps_pref && !is_ips_pref && !string_is_empty(name_ups)
+         && path_is_valid(name_ups))
+      return true;
+
+   return false;
+}
+
 /**
  * patch_content:
  * @buf          : buffer of the content file.
  * @size         : size   of the content file.
+ * @crc          : CRC32 of the patched content.
  *
  * Apply patch to the content file in-memory.
  *
+ * Returns: true if a patch was applied, in which case @crc is set.
  **/
-static void patch_content(
+static bool patch_content(
       bool is_ips_pref,
       bool is_bps_pref,
       bool is_ups_pref,
@@ -639,9 +805,11 @@ static void patch_content(
       const char *name_bps,
       const char *name_ups,
       uint8_t **buf,
-      void *data)
+      void *data,
+      uint32_t *crc)
 {
    ssize_t *size    = (ssize_t*)data;
+   bool patched     = false;
    bool allow_ups   = !is_bps_pref && !is_ips_pref;
    bool allow_ips   = !is_ups_pref && !is_bps_pref;
    bool allow_bps   = !is_ups_pref && !is_ips_pref;
@@ -652,14 +820,16 @@ static void patch_content(
    {
       RARCH_WARN("%s\n",
             msg_hash_to_str(MSG_SEVERAL_PATCHES_ARE_EXPLICITLY_DEFINED));
-      return;
+      return false;
    }
 
-   if (     !try_ips_patch(allow_ips, name_ips, buf, size)
-         && !try_bps_patch(allow_bps, name_bps, buf, size)
-         && !try_ups_patch(allow_ups, name_ups, buf, size))
+   if (     !try_ips_patch(allow_ips, name_ips, buf, size, crc, &patched)
+         && !try_bps_patch(allow_bps, name_bps, buf, size, crc, &patched)
+         && !try_ups_patch(allow_ups, name_ups, buf, size, crc, &patched))
    {
       RARCH_LOG("%s\n",
             msg_hash_to_str(MSG_DID_NOT_FIND_A_VALID_CONTENT_PATCH));
    }
+
+   return patched;
 }
@@ -31,6 +31,9 @@
 #include <lists/string_list.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
+#ifdef HAVE_ZLIB
+#include <streams/trans_stream.h>
+#endif
 #include <rthreads/rthreads.h>
 #include <file/file_path.h>
 #include <retro_miscellaneous.h>
@@ -56,6 +59,19 @@
 
 #define SAVE_STATE_CHUNK 4096
 
+/* Compressed states start with this header: the magic, the codec,
+ * three reserved bytes and the uncompressed size as a 64-bit little
+ * endian integer. The compressed stream follows. States without the
+ * magic are loaded as they are. */
+#define STATE_HEADER_MAGIC "RASZ"
+#define STATE_HEADER_SIZE  16
+
+enum state_codec
+{
+   STATE_CODEC_NONE = 0,
+   STATE_CODEC_DEFLATE
+};
+
 static bool save_state_in_background = false;
 static struct string_list *task_save_files = NULL;
 
@@ -95,8 +111,10 @@ typedef struct
    bool undo_save;
    bool mute;
    int state_slot;
-   bool thumbnail_enable;
    bool has_valid_framebuffer;
+   bool compress;
+   void *codec;
+   uint8_t *codec_buf;
 } save_task_state_t;
 
 typedef save_task_state_t load_task_data_t;
@@ -119,12 +137,19 @@ struct autosave_st
    unsigned num;
 };
 
+/* SRAM is compared and written in pages, so a change to a few bytes
+ * of a large flash or memory card image doesn't rewrite all of it. */
+#define AUTOSAVE_PAGE_SIZE 4096
+
 struct autosave
 {
    volatile bool quit;
+   bool rewrite;
    size_t bufsize;
+   size_t num_pages;
    unsigned interval;
    void *buffer;
+   uint8_t *dirty;
    const void *retro_buffer;
    const char *path;
    slock_t *lock;
@@ -135,6 +160,108 @@ struct autosave
 
 static struct autosave_st autosave_state;
 
+/* Copies the pages the core changed into the autosave buffer
+ * and returns how many there were. */
+static size_t autosave_update_pages(autosave_t *save)
+{
+   size_t i;
+   size_t count = 0;
+
+   for (i = 0; i < save->num_pages; i++)
+   {
+      size_t offset      = i * AUTOSAVE_PAGE_SIZE;
+      size_t len         = MIN(AUTOSAVE_PAGE_SIZE, save->bufsize - offset);
+      uint8_t *dst       = (uint8_t*)save->buffer + offset;
+      const uint8_t *src = (const uint8_t*)save->retro_buffer + offset;
+
+      if (memcmp(dst, src, len))
+      {
+         memcpy(dst, src, len);
+         save->dirty[i] = 1;
+         count++;
+      }
+   }
+
+   return count;
+}
+
+/* Writes the dirty pages over the existing file. Fails if the
+ * file isn't there or doesn't have the size of the buffer. */
+static bool autosave_write_pages(autosave_t *save)
+{
+   size_t i;
+   bool failed        = false;
+   intfstream_t *file = intfstream_open_file(save->path,
+         RETRO_VFS_FILE_ACCESS_WRITE | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (intfstream_get_size(file) != (int64_t)save->bufsize)
+      failed = true;
+
+   for (i = 0; i < save->num_pages && !failed; i++)
+   {
+      size_t offset, len;
+      size_t first = i;
+
+      if (!save->dirty[i])
+         continue;
+
+      /* Neighbouring dirty pages go out in one write */
+      while (i + 1 < save->num_pages && save->dirty[i + 1])
+         i++;
+
+      offset = first * AUTOSAVE_PAGE_SIZE;
+      len    = MIN((i + 1) * AUTOSAVE_PAGE_SIZE, save->bufsize) - offset;
+
+      failed |= (intfstream_seek(file, (int64_t)offset, SEEK_SET) == -1);
+      failed |= !failed && ((size_t)intfstream_write(file,
+               (const uint8_t*)save->buffer + offset, len) != len);
+   }
+
+   failed |= (intfstream_flush(file) != 0);
+   failed |= (intfstream_close(file) != 0);
+   free(file);
+
+   return !failed;
+}
+
+/* Writes the whole buffer to a temporary file and moves it over
+ * the save file, which is never left half written. */
+static bool autosave_write_file(autosave_t *save)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   bool failed        = false;
+   intfstream_t *file = NULL;
+
+   strlcpy(tmp_path, save->path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   file = intfstream_open_file(tmp_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!file)
+      return false;
+
+   failed |= ((size_t)intfstream_write(file, save->buffer, save->bufsize) != save->bufsize);
+   failed |= (intfstream_flush(file) != 0);
+   failed |= (intfstream_close(file) != 0);
+   free(file);
+
+   if (!failed && filestream_rename(tmp_path, save->path) != 0)
+   {
+      /* Renaming over an existing file fails on Windows */
+      filestream_delete(save->path);
+      failed = filestream_rename(tmp_path, save->path) != 0;
+   }
+
+   if (failed)
+      filestream_delete(tmp_path);
+
+   return !failed;
+}
+
 /**
  * autosave_thread:
  * @data            : pointer to autosave object
@@ -146,44 +273,41 @@ static void autosave_thread(void *data)
    bool first_log   = true;
    autosave_t *save = (autosave_t*)data;
 
+   sthread_set_role(STHREAD_ROLE_BACKGROUND);
+
    while (!save->quit)
    {
-      bool differ;
+      size_t pages;
 
       slock_lock(save->lock);
-      differ = string_is_not_equal_fast(save->buffer, save->retro_buffer,
-            save->bufsize);
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      pages = autosave_update_pages(save);
       slock_unlock(save->lock);
 
-      if (differ)
+      if (pages || save->rewrite)
       {
-         /* Should probably deal with this more elegantly. */
-         intfstream_t *file = intfstream_open_file(save->path,
-               RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         bool written;
 
-         if (file)
+         /* Avoid spamming down stderr ... */
+         if (first_log)
          {
-            bool failed = false;
-
-            /* Avoid spamming down stderr ... */
-            if (first_log)
-            {
-               RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
-                     save->path, save->interval);
-               first_log = false;
-            }
-            else
-               RARCH_LOG("SRAM changed ... autosaving ...\n");
-
-            failed |= ((size_t)intfstream_write(file, save->buffer, save->bufsize) != save->bufsize);
-            failed |= (intfstream_flush(file) != 0);
-            failed |= (intfstream_close(file) != 0);
-            free(file);
-            if (failed)
-               RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
+            RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
+                  save->path, save->interval);
+            first_log = false;
          }
+         else
+            RARCH_LOG("SRAM changed ... autosaving %u of %u pages ...\n",
+                  (unsigned)pages, (unsigned)save->num_pages);
+
+         written = !save->rewrite && autosave_write_pages(save);
+         if (!written)
+            written = autosave_write_file(save);
+
+         /* The buffer is ahead of the file until a write works */
+         save->rewrite = !written;
+         if (written)
+            memset(save->dirty, 0, save->num_pages);
+         else
+            RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
       }
 
       slock_lock(save->cond_lock);
@@ -220,13 +344,16 @@ static autosave_t *autosave_new(const char *path,
       goto error;
 
    handle->quit                  = false;
+   handle->rewrite               = false;
    handle->bufsize               = size;
+   handle->num_pages             = (size + AUTOSAVE_PAGE_SIZE - 1) / AUTOSAVE_PAGE_SIZE;
    handle->interval              = interval;
    handle->buffer                = malloc(size);
+   handle->dirty                 = (uint8_t*)calloc(handle->num_pages, 1);
    handle->retro_buffer          = data;
    handle->path                  = path;
 
-   if (!handle->buffer)
+   if (!handle->buffer || !handle->dirty)
       goto error;
 
    memcpy(handle->buffer, handle->retro_buffer, handle->bufsize);
@@ -240,7 +367,11 @@ static autosave_t *autosave_new(const char *path,
 
 error:
    if (handle)
+   {
+      free(handle->buffer);
+      free(handle->dirty);
       free(handle);
+   }
    return NULL;
 }
 
@@ -264,7 +395,10 @@ static void autosave_free(autosave_t *handle)
 
    if (handle->buffer)
       free(handle->buffer);
+   if (handle->dirty)
+      free(handle->dirty);
    handle->buffer = NULL;
+   handle->dirty  = NULL;
 }
 
 
@@ -537,6 +671,14 @@ static void task_save_handler_finished(retro_task_t *task,
    intfstream_close(state->file);
    free(state->file);
 
+#ifdef HAVE_ZLIB
+   if (state->codec)
+      trans_stream_get_zlib_deflate_backend()->stream_free(state->codec);
+#endif
+   free(state->codec_buf);
+   state->codec     = NULL;
+   state->codec_buf = NULL;
+
    if (!task_get_error(task) && task_get_cancelled(task))
       task_set_error(task, strdup("Task canceled"));
 
@@ -583,6 +725,77 @@ void* get_serialized_data(const char *path, size_t serial_size)
    return data ;
 }
 
+#ifdef HAVE_ZLIB
+/**
+ * task_save_write_compressed:
+ * @state : the state associated with the save task
+ * @len   : number of bytes of the state to take
+ *
+ * Feeds the next @len bytes of the state to the compressor and
+ * writes what comes out. The first call writes the header, the
+ * one that takes the last bytes finishes the stream.
+ **/
+static bool task_save_write_compressed(save_task_state_t *state, size_t len)
+{
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+   bool last = (state->written + (ssize_t)len == state->size);
+
+   if (!state->codec)
+   {
+      unsigned i;
+      uint8_t header[STATE_HEADER_SIZE];
+      uint64_t size    = (uint64_t)state->size;
+
+      state->codec     = backend->stream_new();
+      state->codec_buf = (uint8_t*)malloc(SAVE_STATE_CHUNK);
+
+      if (!state->codec || !state->codec_buf)
+         return false;
+
+      /* States are taken often and compress well even at the
+       * fastest level. */
+      backend->define(state->codec, "level", 1);
+
+      memset(header, 0, sizeof(header));
+      memcpy(header, STATE_HEADER_MAGIC, 4);
+      header[4] = STATE_CODEC_DEFLATE;
+      for (i = 0; i < 8; i++)
+         header[8 + i] = (uint8_t)(size >> (8 * i));
+
+      if (intfstream_write(state->file, header, sizeof(header))
+            != sizeof(header))
+         return false;
+   }
+
+   backend->set_in(state->codec,
+         (const uint8_t*)state->data + state->written, (uint32_t)len);
+
+   for (;;)
+   {
+      uint32_t rd                 = 0;
+      uint32_t wn                 = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+      backend->set_out(state->codec, state->codec_buf, SAVE_STATE_CHUNK);
+
+      if (!backend->trans(state->codec, last, &rd, &wn, &err)
+            && err != TRANS_STREAM_ERROR_BUFFER_FULL)
+         return false;
+
+      if (wn && intfstream_write(state->file, state->codec_buf, wn) != wn)
+         return false;
+
+      /* Until the end, zlib keeps what doesn't fit for later */
+      if (last ? (err == TRANS_STREAM_ERROR_NONE)
+            : (err != TRANS_STREAM_ERROR_BUFFER_FULL))
+         break;
+   }
+
+   return true;
+}
+#endif
+
 /**
  * task_save_handler:
  * @task : the task being worked on
@@ -611,8 +824,16 @@ static void task_save_handler(retro_task_t *task)
    remaining       = MIN(state->size - state->written, SAVE_STATE_CHUNK);
 
    if ( state->data )
-      written         = (int)intfstream_write(state->file,
-         (uint8_t*)state->data + state->written, remaining);
+   {
+#ifdef HAVE_ZLIB
+      if (state->compress)
+         written      = task_save_write_compressed(state, remaining)
+            ? (int)remaining : 0;
+      else
+#endif
+         written      = (int)intfstream_write(state->file,
+            (uint8_t*)state->data + state->written, remaining);
+   }
    else
       written = 0;
 
@@ -702,6 +923,7 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
    state->data                   = data;
    state->size                   = size;
    state->undo_save              = true;
+   state->compress               = settings->bools.savestate_file_compression;
    state->state_slot             = settings->ints.state_slot;
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
@@ -770,6 +992,86 @@ static void task_load_handler_finished(retro_task_t *task,
    free(state);
 }
 
+/**
+ * task_load_decompress:
+ * @state : the state associated with the load task
+ *
+ * Replaces a compressed state that has been read with the
+ * state itself. Uncompressed states are left alone.
+ *
+ * Returns: false if the state is compressed and can't be
+ * decompressed.
+ **/
+static bool task_load_decompress(save_task_state_t *state)
+{
+   unsigned i;
+   uint64_t size          = 0;
+   const uint8_t *header  = (const uint8_t*)state->data;
+#ifdef HAVE_ZLIB
+   uint32_t rd            = 0;
+   uint32_t wn            = 0;
+   void *stream           = NULL;
+   uint8_t *out           = NULL;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_inflate_backend();
+#endif
+
+   if (state->size < STATE_HEADER_SIZE
+         || memcmp(header, STATE_HEADER_MAGIC, 4))
+      return true;
+
+   for (i = 0; i < 8; i++)
+      size |= (uint64_t)header[8 + i] << (8 * i);
+
+   if (header[4] != STATE_CODEC_DEFLATE || !size || size > 0xffffffffU)
+   {
+      RARCH_ERR("Unsupported savestate compression.\n");
+      return false;
+   }
+
+#ifdef HAVE_ZLIB
+   out    = (uint8_t*)malloc((size_t)size + 1);
+   stream = backend->stream_new();
+
+   if (out && stream)
+   {
+      backend->set_in(stream, header + STATE_HEADER_SIZE,
+            (uint32_t)(state->size - STATE_HEADER_SIZE));
+      backend->set_out(stream, out, (uint32_t)size);
+      if (!backend->trans(stream, true, &rd, &wn, &err)
+            || err != TRANS_STREAM_ERROR_NONE || wn != size)
+      {
+         free(out);
+         out = NULL;
+      }
+   }
+   else
+   {
+      free(out);
+      out = NULL;
+   }
+
+   if (stream)
+      backend->stream_free(stream);
+
+   if (!out)
+   {
+      RARCH_ERR("Failed to decompress savestate.\n");
+      return false;
+   }
+
+   free(state->data);
+   state->data       = out;
+   state->size       = (ssize_t)size;
+   state->bytes_read = (ssize_t)size;
+   return true;
+#else
+   RARCH_ERR("Savestate is compressed, but this build has no zlib.\n");
+   return false;
+#endif
+}
+
 /**
  * task_load_handler:
  * @task : the task being worked on
@@ -814,6 +1116,11 @@ static void task_load_handler(retro_task_t *task)
    if (state->size > 0)
       task_set_progress(task, (state->bytes_read / (float)state->size) * 100);
 
+   if (!task_get_cancelled(task) && bytes_read == remaining
+         && state->bytes_read == state->size
+         && !task_load_decompress(state))
+      bytes_read = -1;
+
    if (task_get_cancelled(task) || bytes_read != remaining)
    {
       if (state->autoload)
@@ -1032,23 +1339,6 @@ error:
    free(load_data);
 }
 
-/**
- * save_state_cb:
- *
- * Called after the save state is done. Takes a screenshot if needed.
- **/
-static void save_state_cb(void *task_data,
-                           void *user_data, const char *error)
-{
-   save_task_state_t *state = (save_task_state_t*)task_data;
-   char               *path = strdup(state->path);
-
-   if (state->thumbnail_enable)
-      take_screenshot(path, true, state->has_valid_framebuffer, false, true);
-
-   free(path);
-}
-
 /**
  * task_push_save_state:
  * @path : file path of the save state
@@ -1071,14 +1361,13 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    state->size             = size;
    state->autosave         = autosave;
    state->mute             = autosave; /* don't show OSD messages if we are auto-saving */
-   state->thumbnail_enable = settings->bools.savestate_thumbnail_enable;
+   state->compress         = settings->bools.savestate_file_compression;
    state->state_slot       = settings->ints.state_slot;
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
    task->type              = TASK_TYPE_BLOCKING;
    task->state             = state;
    task->handler           = task_save_handler;
-   task->callback          = save_state_cb;
    task->title             = strdup(msg_hash_to_str(MSG_SAVING_STATE));
    task->mute              = state->mute;
 
@@ -1212,6 +1501,14 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
 
    if (save_to_disk)
    {
+      settings_t *settings = config_get_ptr();
+
+      /* Take the thumbnail now, a frame later it wouldn't
+       * match the state. */
+      if (settings->bools.savestate_thumbnail_enable)
+         take_savestate_thumbnail(path,
+               video_driver_cached_frame_has_valid_framebuffer());
+
       if (filestream_exists(path) && !autosave)
       {
          /* Before overwritting the savestate file, load it into a buffer
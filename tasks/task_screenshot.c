@@ -20,6 +20,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stddef.h>
 #include <time.h>
 #include <boolean.h>
@@ -63,6 +64,7 @@ struct screenshot_task_state
    bool is_idle;
    bool is_paused;
    bool history_list_enable;
+   bool fast_encode;
    int pitch;
    unsigned width;
    unsigned height;
@@ -88,6 +90,8 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
       scaler->in_fmt   = SCALER_FMT_BGR24;
    else if (state->pixel_format_type == RETRO_PIXEL_FORMAT_XRGB8888)
       scaler->in_fmt   = SCALER_FMT_ARGB8888;
+   else if (state->pixel_format_type == RETRO_PIXEL_FORMAT_0RGB1555)
+      scaler->in_fmt   = SCALER_FMT_0RGB1555;
    else
       scaler->in_fmt   = SCALER_FMT_RGB565;
 
@@ -101,13 +105,22 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
 
    scaler_ctx_gen_reset(&state->scaler);
 
-   ret = rpng_save_image_bgr24(
-         state->filename,
-         state->out_buffer,
-         state->width,
-         state->height,
-         state->width * 3
-         );
+   if (state->fast_encode)
+      ret = rpng_save_image_bgr24_fast(
+            state->filename,
+            state->out_buffer,
+            state->width,
+            state->height,
+            state->width * 3
+            );
+   else
+      ret = rpng_save_image_bgr24(
+            state->filename,
+            state->out_buffer,
+            state->width,
+            state->height,
+            state->width * 3
+            );
 
    free(state->out_buffer);
 #elif defined(HAVE_RBMP)
@@ -222,7 +235,8 @@ static bool screenshot_dump(
    state->userbuf             = userbuf;
    state->silence             = savestate;
    state->history_list_enable = settings->bools.history_list_enable;
-   state->pixel_format_type   = video_driver_get_pixel_format();
+   state->fast_encode         = settings->bools.screenshot_fast_encode;
+   state->pixel_format_type   = video_driver_get_frame_pixel_format();
 
    if (!fullpath)
    {
@@ -255,7 +269,10 @@ static bool screenshot_dump(
    state->out_buffer = buf;
 #endif
 
-   task->type        = TASK_TYPE_BLOCKING;
+   /* Only one blocking task can be queued at a time. Silent
+    * captures like savestate thumbnails are taken along with
+    * something else and must not keep it from being queued. */
+   task->type        = savestate ? TASK_TYPE_NONE : TASK_TYPE_BLOCKING;
    task->state       = state;
    task->handler     = task_screenshot_handler;
 
@@ -324,13 +341,31 @@ static bool take_screenshot_raw(const char *name_base, void *userbuf,
 
    video_driver_cached_frame_get(&data, &width, &height, &pitch);
 
+   if (!data || data == RETRO_HW_FRAME_BUFFER_VALID || !width || !height)
+      return false;
+
+   /* The core keeps drawing into its frame while the task
+    * encodes it, so the task gets a copy. */
+   if (!userbuf && use_thread)
+   {
+      userbuf = malloc(height * pitch);
+      if (!userbuf)
+         return false;
+      memcpy(userbuf, data, height * pitch);
+      data    = userbuf;
+   }
+
    /* Negative pitch is needed as screenshot takes bottom-up,
     * but we use top-down.
     */
    if (!screenshot_dump(name_base,
          (const uint8_t*)data + (height - 1) * pitch,
          width, height, (int)(-pitch), false, userbuf, savestate, is_idle, is_paused, fullpath, use_thread))
+   {
+      if (userbuf == data)
+         free(userbuf);
       return false;
+   }
 
    return true;
 }
@@ -338,11 +373,9 @@ static bool take_screenshot_raw(const char *name_base, void *userbuf,
 static bool take_screenshot_choice(const char *name_base, bool savestate,
       bool is_paused, bool is_idle, bool has_valid_framebuffer, bool fullpath, bool use_thread)
 {
-   size_t old_pitch;
-   unsigned old_width, old_height;
-   bool ret                    = false;
-   void *frame_data            = NULL;
-   const void* old_data        = NULL;
+   size_t pitch;
+   unsigned width, height;
+   uint8_t *frame_data         = NULL;
    settings_t *settings        = config_get_ptr();
    const char *screenshot_dir  = settings->paths.directory_screenshot;
 
@@ -370,23 +403,23 @@ static bool take_screenshot_choice(const char *name_base, bool savestate,
    if (!video_driver_supports_read_frame_raw())
       return false;
 
-   video_driver_cached_frame_get(&old_data, &old_width, &old_height,
-         &old_pitch);
+   /* Read straight from the core's framebuffer, the frame
+    * doesn't have to go through the shaders again. */
+   frame_data = (uint8_t*)video_driver_read_frame_raw(
+         &width, &height, &pitch);
 
-   frame_data = video_driver_read_frame_raw(
-         &old_width, &old_height, &old_pitch);
-
-   video_driver_cached_frame_set(old_data, old_width, old_height,
-         old_pitch);
+   if (!frame_data)
+      return false;
 
-   if (frame_data)
+   if (!screenshot_dump(name_base, frame_data, width, height,
+            (int)pitch, true, frame_data, savestate, is_idle, is_paused,
+            fullpath, use_thread))
    {
-      video_driver_set_cached_frame_ptr(frame_data);
-      if (take_screenshot_raw(name_base, frame_data, savestate, is_idle, is_paused, fullpath, use_thread))
-         ret = true;
+      free(frame_data);
+      return false;
    }
 
-   return ret;
+   return true;
 }
 
 bool take_screenshot(const char *name_base, bool silence, bool has_valid_framebuffer, bool fullpath, bool use_thread)
@@ -407,3 +440,37 @@ bool take_screenshot(const char *name_base, bool silence, bool has_valid_framebu
 
    return ret;
 }
+
+/**
+ * take_savestate_thumbnail:
+ * @name_base             : path of the savestate.
+ * @has_valid_framebuffer : whether the last frame was hardware rendered.
+ *
+ * Takes the thumbnail of a savestate that has just been serialized.
+ * The frame of software rendered content is copied and encoded on
+ * a task, instead of reading back the viewport, which waits for the
+ * GPU to finish drawing. Hardware rendered content is read from
+ * the core's framebuffer if the video driver can do that.
+ *
+ * Returns: true if the thumbnail is being written.
+ **/
+bool take_savestate_thumbnail(const char *name_base, bool has_valid_framebuffer)
+{
+   if (!has_valid_framebuffer)
+   {
+      bool is_paused         = false;
+      bool is_idle           = false;
+      bool is_slowmotion     = false;
+      bool is_perfcnt_enable = false;
+
+      runloop_get_status(&is_paused, &is_idle, &is_slowmotion,
+            &is_perfcnt_enable);
+
+      if (take_screenshot_raw(name_base, NULL, true, is_idle, is_paused,
+               false, true))
+         return true;
+   }
+
+   return take_screenshot(name_base, true, has_valid_framebuffer,
+         false, true);
+}
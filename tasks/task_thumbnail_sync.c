@@ -0,0 +1,634 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <net/net_http.h>
+#include <string/stdstring.h>
+#include <streams/file_stream.h>
+#include <encodings/crc32.h>
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <retro_timers.h>
+
+#include "../file_path_special.h"
+#include "../msg_hash.h"
+#include "../verbosity.h"
+#include "tasks_internal.h"
+
+/* Thumbnails downloaded at the same time, each keeps its
+ * connection to the server for the next one */
+#define THUMBNAIL_SYNC_TRANSFERS 4
+/* Local files looked at per handler call */
+#define THUMBNAIL_SYNC_DIFF_STEP 64
+
+enum thumbnail_sync_status
+{
+   THUMBNAIL_SYNC_MANIFEST = 0,
+   THUMBNAIL_SYNC_DIFF,
+   THUMBNAIL_SYNC_DOWNLOAD
+};
+
+/* A line of the manifest: 'date crc32 path', as in .index-extended */
+typedef struct thumbnail_sync_entry
+{
+   const char *date;
+   const char *path;
+   uint32_t crc;
+   bool wanted;
+   bool failed;
+} thumbnail_sync_entry_t;
+
+typedef struct thumbnail_sync_manifest
+{
+   char *data;
+   thumbnail_sync_entry_t *entries;
+   size_t count;
+   /* Entry index + 1 by hash of the path */
+   size_t *buckets;
+   size_t bucket_mask;
+} thumbnail_sync_manifest_t;
+
+typedef struct thumbnail_sync_transfer
+{
+   struct http_t *http;
+   RFILE *file;
+   size_t entry;
+   char part_path[PATH_MAX_LENGTH];
+} thumbnail_sync_transfer_t;
+
+typedef struct thumbnail_sync
+{
+   char *url;
+   char *system;
+   char *target_dir;
+   struct http_t *http;
+   thumbnail_sync_manifest_t manifest;
+   /* What the last sync left on disk */
+   thumbnail_sync_manifest_t local;
+   thumbnail_sync_transfer_t transfers[THUMBNAIL_SYNC_TRANSFERS];
+   size_t *queue;
+   size_t queued;
+   size_t next;
+   size_t finished;
+   size_t failed;
+   size_t diffed;
+   enum thumbnail_sync_status status;
+} thumbnail_sync_t;
+
+static uint32_t thumbnail_sync_hash(const char *path)
+{
+   uint32_t hash = 5381;
+
+   while (*path)
+      hash = (hash << 5) + hash + (uint8_t)*path++;
+
+   return hash;
+}
+
+/* Splits up the manifest in place, taking ownership of @data,
+ * which must have a '\0' at @len */
+static bool thumbnail_sync_manifest_parse(thumbnail_sync_manifest_t *manifest,
+      char *data, size_t len)
+{
+   size_t i, lines = 0;
+   size_t buckets  = 2;
+   char *line      = data;
+   char *end       = data + len;
+
+   manifest->data  = data;
+
+   for (i = 0; i < len; i++)
+      if (data[i] == '\n')
+         lines++;
+   lines++;
+
+   while (buckets < lines * 2)
+      buckets <<= 1;
+
+   manifest->entries     = (thumbnail_sync_entry_t*)
+      calloc(lines, sizeof(*manifest->entries));
+   manifest->buckets     = (size_t*)calloc(buckets, sizeof(*manifest->buckets));
+   manifest->bucket_mask = buckets - 1;
+
+   if (!manifest->entries || !manifest->buckets)
+      return false;
+
+   while (line < end)
+   {
+      thumbnail_sync_entry_t *entry = &manifest->entries[manifest->count];
+      char *date                    = line;
+      char *next                    = (char*)memchr(line, '\n', end - line);
+      char *crc                     = NULL;
+      char *path                    = NULL;
+      size_t bucket;
+
+      if (next)
+         *next = '\0';
+      else
+         next  = end;
+
+      line = next + 1;
+
+      string_trim_whitespace_right(date);
+
+      if ((crc = strchr(date, ' ')))
+      {
+         *crc++ = '\0';
+         if ((path = strchr(crc, ' ')))
+            *path++ = '\0';
+      }
+
+      if (string_is_empty(path))
+         continue;
+
+      entry->date = date;
+      entry->path = path;
+      entry->crc  = (uint32_t)strtoul(crc, NULL, 16);
+
+      bucket      = thumbnail_sync_hash(path) & manifest->bucket_mask;
+      while (manifest->buckets[bucket])
+         bucket   = (bucket + 1) & manifest->bucket_mask;
+      manifest->buckets[bucket] = ++manifest->count;
+   }
+
+   return true;
+}
+
+static const thumbnail_sync_entry_t *thumbnail_sync_manifest_find(
+      const thumbnail_sync_manifest_t *manifest, const char *path)
+{
+   size_t bucket;
+
+   if (!manifest->count)
+      return NULL;
+
+   bucket = thumbnail_sync_hash(path) & manifest->bucket_mask;
+
+   while (manifest->buckets[bucket])
+   {
+      const thumbnail_sync_entry_t *entry =
+         &manifest->entries[manifest->buckets[bucket] - 1];
+
+      if (string_is_equal(entry->path, path))
+         return entry;
+
+      bucket = (bucket + 1) & manifest->bucket_mask;
+   }
+
+   return NULL;
+}
+
+static void thumbnail_sync_manifest_free(thumbnail_sync_manifest_t *manifest)
+{
+   free(manifest->data);
+   free(manifest->entries);
+   free(manifest->buckets);
+   memset(manifest, 0, sizeof(*manifest));
+}
+
+/* The manifest comes from the network, keep it inside target_dir */
+static bool thumbnail_sync_path_is_safe(const char *path)
+{
+   const char *s = path;
+
+   if (*path == '/' || *path == '\\' || strchr(path, ':'))
+      return false;
+
+   while (*s)
+   {
+      size_t len = strcspn(s, "/\\");
+
+      if (len == 2 && s[0] == '.' && s[1] == '.')
+         return false;
+
+      s += len;
+      if (*s)
+         s++;
+   }
+
+   return true;
+}
+
+static void thumbnail_sync_local_path(const thumbnail_sync_t *sync,
+      const char *path, char *s, size_t len)
+{
+   char dir[PATH_MAX_LENGTH];
+
+   fill_pathname_join(dir, sync->target_dir, sync->system, sizeof(dir));
+   fill_pathname_join(s, dir, path, len);
+}
+
+static struct http_t *thumbnail_sync_connect(const char *url)
+{
+   struct http_t *http            = NULL;
+   struct http_connection_t *conn = net_http_connection_new(url, "GET", NULL);
+
+   if (!conn)
+      return NULL;
+
+   if (     net_http_connection_iterate(conn)
+         && net_http_connection_done(conn))
+      http = net_http_new(conn);
+
+   net_http_connection_free(conn);
+
+   return http;
+}
+
+/* Is the thumbnail missing, or not the one the manifest lists? */
+static bool thumbnail_sync_is_wanted(const thumbnail_sync_t *sync,
+      const thumbnail_sync_entry_t *entry)
+{
+   char path[PATH_MAX_LENGTH];
+   const thumbnail_sync_entry_t *local =
+      thumbnail_sync_manifest_find(&sync->local, entry->path);
+
+   thumbnail_sync_local_path(sync, entry->path, path, sizeof(path));
+
+   if (!path_is_valid(path))
+      return true;
+
+   /* Trust what the last sync wrote down over reading the file */
+   if (local)
+      return local->crc != entry->crc;
+
+   {
+      void *data     = NULL;
+      int64_t size   = 0;
+      uint32_t crc   = 0;
+
+      if (!filestream_read_file(path, &data, &size))
+         return true;
+
+      crc = encoding_crc32(0, (const uint8_t*)data, (size_t)size);
+      free(data);
+
+      return crc != entry->crc;
+   }
+}
+
+static bool thumbnail_sync_sink(void *userdata,
+      const uint8_t *data, size_t len)
+{
+   thumbnail_sync_transfer_t *transfer = (thumbnail_sync_transfer_t*)userdata;
+
+   if (net_http_status(transfer->http) != 200)
+      return false;
+
+   if (!transfer->file)
+      transfer->file = filestream_open(transfer->part_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   return transfer->file
+      && filestream_write(transfer->file, data, len) == (int64_t)len;
+}
+
+static void thumbnail_sync_start(thumbnail_sync_t *sync,
+      thumbnail_sync_transfer_t *transfer, size_t entry_idx)
+{
+   char url[PATH_MAX_LENGTH];
+   char encoded_url[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   thumbnail_sync_entry_t *entry = &sync->manifest.entries[entry_idx];
+
+   transfer->entry = entry_idx;
+   transfer->file  = NULL;
+
+   thumbnail_sync_local_path(sync, entry->path, path, sizeof(path));
+   strlcpy(transfer->part_path, path, sizeof(transfer->part_path));
+   strlcat(transfer->part_path, ".part", sizeof(transfer->part_path));
+
+   path_basedir_wrapper(path);
+
+   snprintf(url, sizeof(url), "%s/%s/%s",
+         sync->url, sync->system, entry->path);
+   net_http_urlencode_full(encoded_url, url, sizeof(encoded_url));
+
+   if (path_mkdir(path))
+      transfer->http = thumbnail_sync_connect(encoded_url);
+
+   if (transfer->http)
+      net_http_set_sink(transfer->http, thumbnail_sync_sink, transfer);
+   else
+   {
+      entry->failed = true;
+      sync->failed++;
+      sync->finished++;
+   }
+}
+
+static void thumbnail_sync_finish(thumbnail_sync_t *sync,
+      thumbnail_sync_transfer_t *transfer, bool cancelled)
+{
+   char path[PATH_MAX_LENGTH];
+   thumbnail_sync_entry_t *entry = &sync->manifest.entries[transfer->entry];
+   bool ok                       = !cancelled && !net_http_error(transfer->http);
+
+   free(net_http_data(transfer->http, NULL, true));
+   net_http_delete(transfer->http);
+   transfer->http = NULL;
+
+   /* An empty file never reached the sink */
+   if (ok && !transfer->file)
+      transfer->file = filestream_open(transfer->part_path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (transfer->file)
+   {
+      if (filestream_close(transfer->file) != 0)
+         ok = false;
+      transfer->file = NULL;
+   }
+   else
+      ok = false;
+
+   thumbnail_sync_local_path(sync, entry->path, path, sizeof(path));
+
+   if (ok)
+   {
+      if (filestream_exists(path))
+         filestream_delete(path);
+      ok = filestream_rename(transfer->part_path, path) == 0;
+   }
+
+   if (!ok)
+   {
+      filestream_delete(transfer->part_path);
+      entry->failed = true;
+      sync->failed++;
+   }
+
+   sync->finished++;
+}
+
+/* Notes what is on disk now, a thumbnail that failed is left
+ * out so the next sync looks at it again */
+static void thumbnail_sync_write_local(const thumbnail_sync_t *sync)
+{
+   size_t i;
+   char path[PATH_MAX_LENGTH];
+   RFILE *file = NULL;
+
+   thumbnail_sync_local_path(sync,
+         file_path_str(FILE_PATH_INDEX_EXTENDED_URL), path, sizeof(path));
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   for (i = 0; i < sync->manifest.count; i++)
+   {
+      const thumbnail_sync_entry_t *entry = &sync->manifest.entries[i];
+
+      if (!entry->failed)
+         filestream_printf(file, "%s %08x %s\n",
+               entry->date, entry->crc, entry->path);
+   }
+
+   filestream_close(file);
+}
+
+static void thumbnail_sync_free(thumbnail_sync_t *sync)
+{
+   unsigned i;
+
+   for (i = 0; i < THUMBNAIL_SYNC_TRANSFERS; i++)
+      if (sync->transfers[i].http)
+         thumbnail_sync_finish(sync, &sync->transfers[i], true);
+
+   if (sync->http)
+   {
+      free(net_http_data(sync->http, NULL, true));
+      net_http_delete(sync->http);
+   }
+
+   thumbnail_sync_manifest_free(&sync->manifest);
+   thumbnail_sync_manifest_free(&sync->local);
+   free(sync->queue);
+   free(sync->url);
+   free(sync->system);
+   free(sync->target_dir);
+   free(sync);
+}
+
+static bool thumbnail_sync_iterate_manifest(thumbnail_sync_t *sync)
+{
+   char path[PATH_MAX_LENGTH];
+   size_t len  = 0;
+   char *data  = NULL;
+   char *local = NULL;
+   int64_t local_len = 0;
+
+   if (!net_http_update(sync->http, NULL, NULL))
+      return true;
+
+   data = (char*)net_http_data(sync->http, &len, true);
+
+   if (net_http_error(sync->http) || !data)
+      return false;
+
+   net_http_delete(sync->http);
+   sync->http = NULL;
+
+   /* The body isn't terminated */
+   {
+      char *terminated = (char*)realloc(data, len + 1);
+
+      if (!terminated)
+      {
+         free(data);
+         return false;
+      }
+
+      data      = terminated;
+      data[len] = '\0';
+   }
+
+   if (!thumbnail_sync_manifest_parse(&sync->manifest, data, len))
+      return false;
+
+   thumbnail_sync_local_path(sync,
+         file_path_str(FILE_PATH_INDEX_EXTENDED_URL), path, sizeof(path));
+
+   if (     path_is_valid(path)
+         && filestream_read_file(path, (void**)&local, &local_len))
+      thumbnail_sync_manifest_parse(&sync->local, local, (size_t)local_len);
+
+   sync->queue = (size_t*)malloc(
+         (sync->manifest.count + 1) * sizeof(*sync->queue));
+
+   if (!sync->queue)
+      return false;
+
+   sync->status = THUMBNAIL_SYNC_DIFF;
+   return true;
+}
+
+static void thumbnail_sync_iterate_diff(thumbnail_sync_t *sync)
+{
+   size_t end = MIN(sync->diffed + THUMBNAIL_SYNC_DIFF_STEP,
+         sync->manifest.count);
+
+   for (; sync->diffed < end; sync->diffed++)
+   {
+      thumbnail_sync_entry_t *entry = &sync->manifest.entries[sync->diffed];
+
+      if (!thumbnail_sync_path_is_safe(entry->path))
+      {
+         entry->failed = true;
+         continue;
+      }
+
+      if (thumbnail_sync_is_wanted(sync, entry))
+      {
+         entry->wanted                 = true;
+         sync->queue[sync->queued++]   = sync->diffed;
+      }
+   }
+
+   if (sync->diffed == sync->manifest.count)
+   {
+      RARCH_LOG("[thumbnails] %s: %u of %u thumbnails to download.\n",
+            sync->system, (unsigned)sync->queued,
+            (unsigned)sync->manifest.count);
+      sync->status = THUMBNAIL_SYNC_DOWNLOAD;
+   }
+}
+
+/* Returns true once every thumbnail is done with */
+static bool thumbnail_sync_iterate_download(thumbnail_sync_t *sync)
+{
+   unsigned i;
+
+   for (i = 0; i < THUMBNAIL_SYNC_TRANSFERS; i++)
+   {
+      thumbnail_sync_transfer_t *transfer = &sync->transfers[i];
+
+      if (!transfer->http && sync->next < sync->queued)
+         thumbnail_sync_start(sync, transfer, sync->queue[sync->next++]);
+
+      if (transfer->http && net_http_update(transfer->http, NULL, NULL))
+         thumbnail_sync_finish(sync, transfer, false);
+   }
+
+   return sync->finished == sync->queued;
+}
+
+static void task_thumbnail_sync_handler(retro_task_t *task)
+{
+   thumbnail_sync_t *sync = (thumbnail_sync_t*)task->state;
+
+   if (task_get_cancelled(task))
+      goto finished;
+
+   /* FIXME: This wouldn't be needed if we could wait for a timeout */
+   if (sync->status != THUMBNAIL_SYNC_DIFF && task_queue_is_threaded())
+      retro_sleep(1);
+
+   switch (sync->status)
+   {
+      case THUMBNAIL_SYNC_MANIFEST:
+         if (!thumbnail_sync_iterate_manifest(sync))
+         {
+            task_set_error(task, strdup("No thumbnail manifest."));
+            goto finished;
+         }
+         break;
+      case THUMBNAIL_SYNC_DIFF:
+         thumbnail_sync_iterate_diff(sync);
+         task_set_progress(task, sync->manifest.count
+               ? (signed)(sync->diffed * 10 / sync->manifest.count) : 10);
+         break;
+      case THUMBNAIL_SYNC_DOWNLOAD:
+         if (thumbnail_sync_iterate_download(sync))
+         {
+            thumbnail_sync_write_local(sync);
+
+            if (sync->failed)
+               RARCH_WARN("[thumbnails] %s: %u thumbnails failed to download.\n",
+                     sync->system, (unsigned)sync->failed);
+            goto finished;
+         }
+         task_set_progress(task, 10 + (signed)(sync->finished * 90 / sync->queued));
+         break;
+   }
+
+   return;
+
+   /* Only a missing manifest is an error, so the caller knows
+    * to fall back to the whole archive */
+finished:
+   task_set_finished(task, true);
+   thumbnail_sync_free(sync);
+   task->state = NULL;
+}
+
+bool task_push_thumbnail_sync(const char *url, const char *system,
+      const char *target_dir, retro_task_callback_t cb, void *user_data)
+{
+   char manifest_url[PATH_MAX_LENGTH];
+   char encoded_url[PATH_MAX_LENGTH];
+   char title[255];
+   retro_task_t *task     = NULL;
+   thumbnail_sync_t *sync = NULL;
+
+   if (     string_is_empty(url)
+         || string_is_empty(system)
+         || string_is_empty(target_dir))
+      return false;
+
+   sync = (thumbnail_sync_t*)calloc(1, sizeof(*sync));
+
+   if (!sync)
+      return false;
+
+   sync->url        = strdup(url);
+   sync->system     = strdup(system);
+   sync->target_dir = strdup(target_dir);
+
+   /* '<url>/<system>/.index-extended' lists the thumbnails */
+   snprintf(manifest_url, sizeof(manifest_url), "%s/%s/%s",
+         url, system, file_path_str(FILE_PATH_INDEX_EXTENDED_URL));
+   net_http_urlencode_full(encoded_url, manifest_url, sizeof(encoded_url));
+
+   if (     !sync->url || !sync->system || !sync->target_dir
+         || !(sync->http = thumbnail_sync_connect(encoded_url)))
+      goto error;
+
+   task = (retro_task_t*)calloc(1, sizeof(*task));
+
+   if (!task)
+      goto error;
+
+   snprintf(title, sizeof(title), "%s '%s'",
+         msg_hash_to_str(MSG_DOWNLOADING), system);
+
+   task->handler   = task_thumbnail_sync_handler;
+   task->state     = sync;
+   task->callback  = cb;
+   task->user_data = user_data;
+   task->progress  = 0;
+   task->title     = strdup(title);
+
+   task_queue_push(task);
+
+   return true;
+
+error:
+   thumbnail_sync_free(sync);
+   return false;
+}
@@ -91,6 +91,10 @@ typedef struct
 {
    enum msg_hash_enums enum_idx;
    char path[PATH_MAX_LENGTH];
+   /* Where a download streamed to disk ended up in */
+   char dir_path[PATH_MAX_LENGTH];
+   /* It was extracted there as it came in, there is no archive */
+   bool extracted;
 } file_transfer_t;
 
 #ifdef HAVE_NETWORKING
@@ -103,6 +107,24 @@ typedef struct
 void *task_push_http_transfer(const char *url, bool mute, const char *type,
       retro_task_callback_t cb, void *userdata);
 
+/* Streams the body to '<path>.part' and renames it to 'path' once
+ * complete, the callback gets a http_transfer_data_t with no data
+ * and the size of the file. A .part file left by a failed attempt
+ * is resumed. */
+void *task_push_http_transfer_file(const char *url, const char *path,
+      bool mute, const char *type,
+      retro_task_callback_t cb, void *userdata);
+
+/* Extracts the archive into 'target_dir' as it downloads, without
+ * keeping it ('path' only tells the archive type). Returns NULL if
+ * that type can't be extracted on the fly. */
+void *task_push_http_transfer_extract(const char *url, const char *path,
+      const char *target_dir, bool mute, const char *type,
+      retro_task_callback_t cb, void *userdata);
+
+bool task_push_thumbnail_sync(const char *url, const char *system,
+      const char *target_dir, retro_task_callback_t cb, void *user_data);
+
 void *task_push_http_post_transfer(const char *url, const char *post_data, bool mute, const char *type,
       retro_task_callback_t cb, void *userdata);
 
@@ -138,6 +160,12 @@ bool task_push_overlay_load_default(
         retro_task_callback_t cb, void *user_data);
 #endif
 
+/* Applies a BPS patch to the malloc'd @buf, which is replaced by
+ * the patched data. Fails, leaving @buf alone, if the patch was
+ * made for other data. */
+bool patch_apply_bps(const uint8_t *patch, size_t patch_size,
+      uint8_t **buf, size_t *size);
+
 bool task_check_decompress(const char *source_file);
 
 bool task_push_decompress(
@@ -225,6 +253,8 @@ bool task_audio_mixer_load_handler(retro_task_t *task);
 
 bool take_screenshot(const char *path, bool silence, bool has_valid_framebuffer, bool fullpath, bool use_thread);
 
+bool take_savestate_thumbnail(const char *path, bool has_valid_framebuffer);
+
 bool event_load_save_files(void);
 
 bool event_save_files(void);
@@ -257,6 +287,13 @@ void input_autoconfigure_joypad_reindex_devices(void);
 
 void task_push_get_powerstate(void);
 
+/* Starts reading @path, and the first tracks it lists if it is a
+ * .cue/.gdi/.m3u, into the OS cache in the background. Any earlier
+ * prefetch stops. */
+void task_push_content_prefetch(const char *path);
+
+void task_content_prefetch_cancel(void);
+
 enum frontend_powerstate get_last_powerstate(int *percent);
 
 bool task_push_audio_mixer_load_and_play(
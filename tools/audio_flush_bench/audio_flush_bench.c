@@ -0,0 +1,295 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_flush_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Compares the two ways audio_driver_flush() can take a batch from
+ * the core to the driver: one full pass per stage (s16 -> float,
+ * resampler, gain, float -> s16) or AUDIO_FLUSH_BLOCK_FRAMES at a
+ * time through all of them. Each input rate is resampled to 48 kHz
+ * in batches of one 60 fps frame:
+ *
+ *    audio_flush_bench [seconds]
+ *
+ * Speed is given as a multiple of realtime. The blocked output is
+ * checked against the multi-pass one. It may be off by one LSB where
+ * a block edge moves a sample between the SIMD body of
+ * convert_float_to_s16(), which rounds, and its scalar tail, which
+ * truncates.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <boolean.h>
+
+#include <audio/audio_mix.h>
+#include <audio/audio_resampler.h>
+#include <audio/conversion/float_to_s16.h>
+#include <audio/conversion/s16_to_float.h>
+#include <features/features_cpu.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define OUT_RATE                 48000.0
+#define AUDIO_FLUSH_BLOCK_FRAMES 256
+#define GAIN                     0.7f
+#define PASSES                   2
+
+extern retro_resampler_t sinc_resampler;
+extern retro_resampler_t nearest_resampler;
+
+/* audio_mix.c also carries the WAV chunk loader,
+ * which this never calls. */
+int64_t filestream_read_file(const char *path, void **buf, int64_t *len)
+{
+   return 0;
+}
+
+bool retro_resampler_realloc(void **re, const retro_resampler_t **backend,
+      const char *ident, enum resampler_quality quality, double bw_ratio)
+{
+   return false;
+}
+
+static int max_diff(const int16_t *a, const int16_t *b, size_t samples)
+{
+   size_t i;
+   int ret = 0;
+
+   for (i = 0; i < samples; i++)
+   {
+      int d = abs(a[i] - b[i]);
+      if (d > ret)
+         ret = d;
+   }
+   return ret;
+}
+
+static const double rates[] = { 32000.0, 44100.0, 48000.0 };
+
+static const struct
+{
+   const retro_resampler_t *backend;
+   enum resampler_quality quality;
+   const char *ident;
+} resamplers[] = {
+   { &sinc_resampler,    RESAMPLER_QUALITY_LOWER,  "sinc lower"  },
+   { &sinc_resampler,    RESAMPLER_QUALITY_NORMAL, "sinc normal" },
+   { &nearest_resampler, RESAMPLER_QUALITY_NORMAL, "nearest"     },
+};
+
+typedef struct
+{
+   const audio_mix_kernels_t *kernels;
+   const retro_resampler_t *backend;
+   void *re;
+   double ratio;
+   float *in_buf;
+   float *out_buf;
+} flush_state_t;
+
+/* What audio_driver_flush() did before: every stage over the
+ * whole batch. Returns output samples. */
+static size_t flush_multipass(flush_state_t *st, const int16_t *data,
+      size_t samples, int16_t *out)
+{
+   struct resampler_data src;
+
+   convert_s16_to_float(st->in_buf, data, samples, 1.0f);
+
+   src.data_in       = st->in_buf;
+   src.data_out      = st->out_buf;
+   src.input_frames  = samples >> 1;
+   src.output_frames = 0;
+   src.ratio         = st->ratio;
+
+   st->backend->process(st->re, &src);
+
+   st->kernels->scale(st->out_buf, st->out_buf, GAIN,
+         src.output_frames * 2);
+   convert_float_to_s16(out, st->out_buf, src.output_frames * 2);
+
+   return src.output_frames * 2;
+}
+
+/* What audio_driver_flush() does now without the mixer. */
+static size_t flush_blocked(flush_state_t *st, const int16_t *data,
+      size_t samples, int16_t *out)
+{
+   size_t offset;
+   size_t out_samples = 0;
+
+   for (offset = 0; offset < samples;
+         offset += AUDIO_FLUSH_BLOCK_FRAMES * 2)
+   {
+      struct resampler_data src;
+      size_t block_samples = samples - offset;
+      float *block_out     = st->out_buf + out_samples;
+
+      if (block_samples > AUDIO_FLUSH_BLOCK_FRAMES * 2)
+         block_samples     = AUDIO_FLUSH_BLOCK_FRAMES * 2;
+
+      convert_s16_to_float(st->in_buf, data + offset, block_samples, 1.0f);
+
+      src.data_in       = st->in_buf;
+      src.data_out      = block_out;
+      src.input_frames  = block_samples >> 1;
+      src.output_frames = 0;
+      src.ratio         = st->ratio;
+
+      st->backend->process(st->re, &src);
+
+      block_samples     = src.output_frames * 2;
+      st->kernels->scale(block_out, block_out, GAIN, block_samples);
+      convert_float_to_s16(out + out_samples, block_out, block_samples);
+
+      out_samples      += block_samples;
+   }
+
+   return out_samples;
+}
+
+/* Runs all of 'in' through a fresh resampler, one batch at a
+ * time. Returns the microseconds spent flushing. */
+static retro_time_t run(unsigned r, double in_rate, bool blocked,
+      const int16_t *in, size_t in_samples, int16_t *out,
+      size_t *out_samples)
+{
+   size_t i;
+   flush_state_t st;
+   retro_time_t elapsed = 0;
+   size_t batch         = 2 * (size_t)(in_rate / 60.0);
+
+   st.kernels = audio_mix_kernels_find();
+   st.backend = resamplers[r].backend;
+   st.ratio   = OUT_RATE / in_rate;
+   st.re      = st.backend->init(NULL, st.ratio,
+         resamplers[r].quality,
+         (resampler_simd_mask_t)cpu_features_get());
+   st.in_buf  = (float*)malloc(batch * sizeof(float));
+   st.out_buf = (float*)malloc((size_t)(batch * st.ratio + 64)
+         * sizeof(float));
+
+   *out_samples = 0;
+
+   if (st.re && st.in_buf && st.out_buf)
+   {
+      for (i = 0; i < in_samples; i += batch)
+      {
+         size_t n           = (in_samples - i < batch)
+            ? in_samples - i : batch;
+         int16_t *dst       = out + *out_samples;
+         retro_time_t start = cpu_features_get_time_usec();
+
+         *out_samples += blocked
+            ? flush_blocked(&st, in + i, n, dst)
+            : flush_multipass(&st, in + i, n, dst);
+         elapsed      += cpu_features_get_time_usec() - start;
+      }
+   }
+
+   if (st.re)
+      st.backend->free(st.re);
+   free(st.in_buf);
+   free(st.out_buf);
+   return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned r, k, p;
+   int ret        = 0;
+   double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+
+   if (seconds < 1.0)
+      seconds = 1.0;
+
+   convert_s16_to_float_init_simd();
+   convert_float_to_s16_init_simd();
+
+   for (k = 0; k < sizeof(rates) / sizeof(rates[0]); k++)
+   {
+      size_t i;
+      size_t in_frames = (size_t)(seconds * rates[k]);
+      size_t max_out   = 2 * (size_t)(in_frames * OUT_RATE / rates[k])
+         + 4096;
+      int16_t *in      = (int16_t*)malloc(2 * in_frames * sizeof(int16_t));
+      int16_t *ref     = (int16_t*)malloc(max_out * sizeof(int16_t));
+      int16_t *out     = (int16_t*)malloc(max_out * sizeof(int16_t));
+
+      if (!in || !ref || !out)
+         return 1;
+
+      for (i = 0; i < in_frames; i++)
+      {
+         double t      = i / rates[k];
+         in[2 * i + 0] = (int16_t)(12000.0 * sin(2.0 * M_PI * 440.0 * t));
+         in[2 * i + 1] = (int16_t)(12000.0 * sin(2.0 * M_PI * 1000.0 * t));
+      }
+
+      printf("%.0f Hz -> %.0f Hz:\n", rates[k], OUT_RATE);
+
+      for (r = 0; r < sizeof(resamplers) / sizeof(resamplers[0]); r++)
+      {
+         size_t ref_samples = 0, out_samples = 0;
+         retro_time_t multi = 0, blocked    = 0;
+         int diff;
+
+         /* Alternated, best of PASSES each */
+         for (p = 0; p < PASSES; p++)
+         {
+            retro_time_t t = run(r, rates[k], false,
+                  in, 2 * in_frames, ref, &ref_samples);
+            if (!p || t < multi)
+               multi   = t;
+            t = run(r, rates[k], true,
+                  in, 2 * in_frames, out, &out_samples);
+            if (!p || t < blocked)
+               blocked = t;
+         }
+
+         diff = (ref_samples == out_samples)
+            ? max_diff(ref, out, out_samples) : 0x10000;
+
+         printf("  %-12s multi-pass %8.1fx  blocked %8.1fx  %+5.1f%%"
+               "  max diff %d%s\n",
+               resamplers[r].ident,
+               seconds * 1000000.0 / (double)(multi   ? multi   : 1),
+               seconds * 1000000.0 / (double)(blocked ? blocked : 1),
+               100.0 * ((double)multi / (double)(blocked ? blocked : 1) - 1.0),
+               diff, diff > 1 ? "  MISMATCH" : "");
+
+         if (diff > 1)
+            ret = 1;
+      }
+
+      free(in);
+      free(ref);
+      free(out);
+   }
+
+   return ret;
+}
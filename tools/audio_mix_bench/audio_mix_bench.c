@@ -0,0 +1,154 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_mix_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Measures the mix kernels the way audio_mixer_mix() uses them:
+ * 16 stereo voices summed into one buffer, then clamped:
+ *
+ *    audio_mix_bench [frames]
+ *
+ * Speed is given as a multiple of realtime at 48 kHz. Every kernel
+ * is checked against the portable C one.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <boolean.h>
+
+#include <audio/audio_mix.h>
+#include <features/features_cpu.h>
+#include <streams/file_stream.h>
+
+#define MAX_KERNELS 8
+#define VOICES      16
+
+/* audio_mix.c also carries the WAV chunk loader,
+ * which this never calls. */
+int64_t filestream_read_file(const char *path, void **buf, int64_t *len)
+{
+   return 0;
+}
+
+bool retro_resampler_realloc(void **re, const retro_resampler_t **backend,
+      const char *ident, enum resampler_quality quality, double bw_ratio)
+{
+   return false;
+}
+
+static void mix_voices(const audio_mix_kernels_t *k, float *out,
+      const float *base, float **voices, const float *volumes,
+      size_t samples)
+{
+   unsigned v;
+
+   memcpy(out, base, samples * sizeof(float));
+   for (v = 0; v < VOICES; v++)
+      k->mix(out, voices[v], volumes[v], samples);
+   k->clamp(out, samples);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, v;
+   int ret          = 0;
+   size_t frames    = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1024;
+   /* Odd on purpose, to exercise the scalar tails. */
+   size_t samples   = frames * 2 + 3;
+   float *base      = (float*)malloc(samples * sizeof(float));
+   float *ref       = (float*)malloc(samples * sizeof(float));
+   float *out       = (float*)malloc(samples * sizeof(float));
+   float *voices[VOICES];
+   float volumes[VOICES];
+   audio_mix_kernels_t list[MAX_KERNELS];
+   unsigned count   = audio_mix_kernels_list(cpu_features_get(),
+         list, MAX_KERNELS);
+
+   if (!frames || !base || !ref || !out)
+      return 1;
+
+   for (i = 0; i < samples; i++)
+      base[i] = 0.5f * sinf(i * 0.01f);
+
+   for (v = 0; v < VOICES; v++)
+   {
+      voices[v]  = (float*)malloc(samples * sizeof(float));
+      if (!voices[v])
+         return 1;
+      /* Loud enough that the clamp has work to do. */
+      volumes[v] = 0.05f + 0.01f * v;
+      for (i = 0; i < samples; i++)
+         voices[v][i] = sinf(i * (0.003f + 0.0007f * v) + v);
+   }
+
+   /* The portable C kernel is always last. */
+   mix_voices(&list[count - 1], ref, base, voices, volumes, samples);
+
+   printf("%u voices, %u frames per call\n", VOICES, (unsigned)frames);
+
+   for (i = 0; i < count; i++)
+   {
+      retro_time_t start, elapsed;
+      unsigned iterations = 0;
+      float max_diff      = 0.0f;
+      size_t j;
+
+      mix_voices(&list[i], out, base, voices, volumes, samples);
+      for (j = 0; j < samples; j++)
+      {
+         float diff = fabsf(out[j] - ref[j]);
+         if (diff > max_diff)
+            max_diff = diff;
+      }
+
+      start = cpu_features_get_time_usec();
+      do
+      {
+         mix_voices(&list[i], out, base, voices, volumes, samples);
+         iterations++;
+         elapsed = cpu_features_get_time_usec() - start;
+      } while (elapsed < 500000);
+
+      /* Compilers may contract the C loop into FMAs,
+       * so allow for a rounding step per voice. */
+      printf("  %-6s %10.1fx realtime  %7.3f ns/frame  max diff %g%s\n",
+            list[i].ident,
+            (double)frames * iterations / 48000.0
+            / ((double)elapsed / 1000000.0),
+            (double)elapsed * 1000.0 / ((double)frames * iterations),
+            max_diff,
+            max_diff > 1e-6f ? "  MISMATCH" : "");
+
+      if (max_diff > 1e-6f)
+         ret = 1;
+   }
+
+   for (v = 0; v < VOICES; v++)
+      free(voices[v]);
+   free(base);
+   free(ref);
+   free(out);
+
+   return ret;
+}
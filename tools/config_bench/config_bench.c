@@ -0,0 +1,199 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Times what config_load_file() does with a config: parse it, then
+ * look up every key it knows about, most of which are present.
+ * The lookups are done once through config_get_string() and once by
+ * walking the entry list, which is what every lookup used to cost.
+ *
+ *    config_bench [retroarch.cfg]
+ *
+ * Without a file, a config of BENCH_KEYS generated keys is used.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+
+#include <features/features_cpu.h>
+#include <file/config_file.h>
+#include <string/stdstring.h>
+
+#define BENCH_KEYS   1500
+#define BENCH_ROUNDS 20
+
+static char *generate_config(void)
+{
+   unsigned i;
+   size_t len = 0;
+   char *buf  = (char*)malloc(BENCH_KEYS * 64);
+
+   if (!buf)
+      return NULL;
+
+   for (i = 0; i < BENCH_KEYS; i++)
+      len += snprintf(buf + len, BENCH_KEYS * 64 - len,
+            "input_player%u_setting_%u = \"%u\"\n", i % 16, i, i);
+
+   return buf;
+}
+
+/* The keys of the config, plus as many that aren't in it,
+ * since config_load_file() asks for options users never set. */
+static char **collect_keys(config_file_t *conf, size_t *count)
+{
+   size_t i;
+   size_t n = 0;
+   size_t cap = 0;
+   char **keys = NULL;
+   struct config_file_entry entry;
+
+   if (!config_get_entry_list_head(conf, &entry))
+      return NULL;
+
+   do
+   {
+      char missing[256];
+
+      if (!entry.key)
+         continue;
+
+      if (n + 2 > cap)
+      {
+         cap  = cap ? cap * 2 : 256;
+         keys = (char**)realloc(keys, cap * sizeof(*keys));
+      }
+
+      snprintf(missing, sizeof(missing), "%s_unset", entry.key);
+      keys[n++] = strdup(entry.key);
+      keys[n++] = strdup(missing);
+   } while (config_get_entry_list_next(&entry));
+
+   /* Look up in a different order than the file's. */
+   for (i = 0; i + 1 < n; i += 2)
+   {
+      char *tmp      = keys[i];
+      keys[i]        = keys[n - 1 - i];
+      keys[n - 1 - i] = tmp;
+   }
+
+   *count = n;
+   return keys;
+}
+
+static bool linear_get(config_file_t *conf, const char *key,
+      const char **value)
+{
+   struct config_file_entry entry;
+
+   if (!config_get_entry_list_head(conf, &entry))
+      return false;
+
+   do
+   {
+      if (string_is_equal(key, entry.key))
+      {
+         *value = entry.value;
+         return true;
+      }
+   } while (config_get_entry_list_next(&entry));
+
+   return false;
+}
+
+int main(int argc, char *argv[])
+{
+   size_t i;
+   unsigned round;
+   size_t count            = 0;
+   size_t found_hash       = 0;
+   size_t found_list       = 0;
+   char **keys             = NULL;
+   char *generated         = NULL;
+   config_file_t *conf     = NULL;
+   retro_time_t start, parse_time, hash_time, list_time;
+
+   start = cpu_features_get_time_usec();
+   if (argc > 1)
+      conf = config_file_new(argv[1]);
+   else if ((generated = generate_config()))
+      conf = config_file_new_from_string(generated);
+   parse_time = cpu_features_get_time_usec() - start;
+
+   if (!conf || !(keys = collect_keys(conf, &count)))
+   {
+      fprintf(stderr, "Could not load config.\n");
+      return 1;
+   }
+
+   start = cpu_features_get_time_usec();
+   for (round = 0; round < BENCH_ROUNDS; round++)
+   {
+      for (i = 0; i < count; i++)
+      {
+         char *value = NULL;
+         if (config_get_string(conf, keys[i], &value))
+         {
+            found_hash++;
+            free(value);
+         }
+      }
+   }
+   hash_time = cpu_features_get_time_usec() - start;
+
+   start = cpu_features_get_time_usec();
+   for (round = 0; round < BENCH_ROUNDS; round++)
+   {
+      for (i = 0; i < count; i++)
+      {
+         const char *value = NULL;
+         if (linear_get(conf, keys[i], &value))
+         {
+            char *copy = strdup(value);
+            found_list++;
+            free(copy);
+         }
+      }
+   }
+   list_time = cpu_features_get_time_usec() - start;
+
+   printf("%u entries, %u lookups per load\n",
+         (unsigned)(count / 2), (unsigned)count);
+   printf("  parse          %8.3f ms\n", parse_time / 1000.0);
+   printf("  hashed lookups %8.3f ms per load\n",
+         hash_time / 1000.0 / BENCH_ROUNDS);
+   printf("  list walk      %8.3f ms per load (%.1fx)\n",
+         list_time / 1000.0 / BENCH_ROUNDS,
+         hash_time ? (double)list_time / (double)hash_time : 0.0);
+
+   for (i = 0; i < count; i++)
+      free(keys[i]);
+   free(keys);
+   free(generated);
+   config_file_free(conf);
+
+   if (found_hash != found_list)
+   {
+      fprintf(stderr, "Lookups disagree: %u vs. %u found.\n",
+            (unsigned)found_hash, (unsigned)found_list);
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,237 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (resampler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Measures the sinc resampler kernels at every quality level,
+ * resampling a 1 kHz sine from 44.1 kHz to 48 kHz:
+ *
+ *    resampler_bench [seconds]
+ *
+ * Speed is given as a multiple of realtime, quality as the SNR of
+ * the output against a fitted sine. Every kernel is checked against
+ * the portable C one.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <boolean.h>
+
+#include <features/features_cpu.h>
+#include <audio/audio_resampler.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define IN_RATE   44100.0
+#define OUT_RATE  48000.0
+#define TONE      1000.0
+#define CHUNK     512
+
+extern retro_resampler_t sinc_resampler;
+
+static const struct
+{
+   resampler_simd_mask_t mask;
+   uint64_t cpu;
+   const char *ident;
+} kernels[] = {
+   { 0, 0, "c" },
+   { RESAMPLER_SIMD_NEON, RETRO_SIMD_NEON, "neon" },
+   { RESAMPLER_SIMD_SSE, RETRO_SIMD_SSE, "sse" },
+   { RESAMPLER_SIMD_SVE, RETRO_SIMD_SVE, "sve" },
+   { RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_AVX,
+      RETRO_SIMD_SSE | RETRO_SIMD_AVX, "avx" },
+   { RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_AVX | RESAMPLER_SIMD_AVX512,
+      RETRO_SIMD_SSE | RETRO_SIMD_AVX | RETRO_SIMD_AVX512, "avx512" },
+};
+
+static const struct
+{
+   enum resampler_quality quality;
+   const char *ident;
+} qualities[] = {
+   { RESAMPLER_QUALITY_LOWEST,  "lowest"  },
+   { RESAMPLER_QUALITY_LOWER,   "lower"   },
+   { RESAMPLER_QUALITY_NORMAL,  "normal"  },
+   { RESAMPLER_QUALITY_HIGHER,  "higher"  },
+   { RESAMPLER_QUALITY_HIGHEST, "highest" },
+};
+
+/* Feeds all of 'in' through a fresh resampler in CHUNK sized
+ * pieces, like the audio driver would. Returns output frames. */
+static size_t resample(enum resampler_quality quality,
+      resampler_simd_mask_t mask, const float *in, size_t in_frames,
+      float *out)
+{
+   size_t i;
+   size_t out_frames = 0;
+   void *re          = sinc_resampler.init(NULL,
+         OUT_RATE / IN_RATE, quality, mask);
+
+   if (!re)
+      return 0;
+
+   for (i = 0; i < in_frames; i += CHUNK)
+   {
+      struct resampler_data data;
+
+      data.data_in      = in + 2 * i;
+      data.data_out     = out + 2 * out_frames;
+      data.input_frames = (in_frames - i < CHUNK) ? in_frames - i : CHUNK;
+      data.output_frames = 0;
+      data.ratio        = OUT_RATE / IN_RATE;
+
+      sinc_resampler.process(re, &data);
+      out_frames       += data.output_frames;
+   }
+
+   sinc_resampler.free(re);
+   return out_frames;
+}
+
+/* Least squares fit of a*sin + b*cos + c at the tone frequency,
+ * skipping the filter warm-up. */
+static double snr_db(const float *out, size_t frames)
+{
+   size_t i;
+   double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+   double det, a, b, signal = 0.0, noise = 0.0;
+   size_t skip = (size_t)OUT_RATE / 10;
+
+   if (frames <= 2 * skip)
+      return 0.0;
+
+   for (i = skip; i < frames - skip; i++)
+   {
+      double w = 2.0 * M_PI * TONE * i / OUT_RATE;
+      double s = sin(w);
+      double c = cos(w);
+      ss += s * s;
+      sc += s * c;
+      cc += c * c;
+      ys += out[2 * i] * s;
+      yc += out[2 * i] * c;
+   }
+
+   det = ss * cc - sc * sc;
+   a   = (ys * cc - yc * sc) / det;
+   b   = (yc * ss - ys * sc) / det;
+
+   for (i = skip; i < frames - skip; i++)
+   {
+      double w   = 2.0 * M_PI * TONE * i / OUT_RATE;
+      double fit = a * sin(w) + b * cos(w);
+      double err = out[2 * i] - fit;
+      signal    += fit * fit;
+      noise     += err * err;
+   }
+
+   if (noise <= 0.0)
+      return 999.0;
+   return 10.0 * log10(signal / noise);
+}
+
+static float max_diff(const float *a, const float *b, size_t samples)
+{
+   size_t i;
+   float ret = 0.0f;
+
+   for (i = 0; i < samples; i++)
+   {
+      float d = fabsf(a[i] - b[i]);
+      if (d > ret)
+         ret = d;
+   }
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   size_t i, in_frames, max_out;
+   unsigned q, k;
+   int ret        = 0;
+   double seconds = (argc > 1) ? atof(argv[1]) : 10.0;
+   uint64_t cpu   = cpu_features_get();
+   float *in, *out, *ref;
+
+   if (seconds < 1.0)
+      seconds = 1.0;
+
+   in_frames = (size_t)(seconds * IN_RATE);
+   max_out   = (size_t)(in_frames * OUT_RATE / IN_RATE) + 2 * CHUNK;
+   in        = (float*)malloc(2 * in_frames * sizeof(float));
+   out       = (float*)malloc(2 * max_out * sizeof(float));
+   ref       = (float*)malloc(2 * max_out * sizeof(float));
+
+   if (!in || !out || !ref)
+      return 1;
+
+   for (i = 0; i < in_frames; i++)
+   {
+      float v       = (float)(0.5 * sin(2.0 * M_PI * TONE * i / IN_RATE));
+      in[2 * i + 0] = v;
+      in[2 * i + 1] = -v;
+   }
+
+   for (q = 0; q < sizeof(qualities) / sizeof(qualities[0]); q++)
+   {
+      size_t ref_frames = resample(qualities[q].quality, 0,
+            in, in_frames, ref);
+
+      printf("%s:\n", qualities[q].ident);
+
+      for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+      {
+         retro_time_t start, elapsed;
+         size_t out_frames;
+         float diff;
+
+         if ((cpu & kernels[k].cpu) != kernels[k].cpu)
+            continue;
+
+         start      = cpu_features_get_time_usec();
+         out_frames = resample(qualities[q].quality, kernels[k].mask,
+               in, in_frames, out);
+         elapsed    = cpu_features_get_time_usec() - start;
+         diff       = (out_frames == ref_frames)
+            ? max_diff(out, ref, 2 * out_frames) : 1.0f;
+
+         printf("  %-7s %8.1fx realtime  SNR %6.1f dB  max diff %.2e%s\n",
+               kernels[k].ident,
+               seconds * 1000000.0 / (double)(elapsed ? elapsed : 1),
+               snr_db(out, out_frames), diff,
+               diff > 1e-4f ? "  MISMATCH" : "");
+
+         if (diff > 1e-4f)
+            ret = 1;
+      }
+   }
+
+   free(in);
+   free(out);
+   free(ref);
+   return ret;
+}
@@ -0,0 +1,207 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures the throughput of the rewind delta kernels on pairs of
+ * real savestates, e.g. two consecutive states saved from a core:
+ *
+ *    rewind_bench old.state new.state [old2.state new2.state ...]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+
+#include <features/features_cpu.h>
+
+#include "../../managers/state_delta.h"
+
+#define MAX_KERNELS 8
+
+/* Same layout as state_manager_raw_alloc(). */
+static uint16_t *load_state(const char *path, size_t *len, uint16_t uniq)
+{
+   size_t len16;
+   long size;
+   uint16_t *ret = NULL;
+   FILE *f       = fopen(path, "rb");
+
+   if (!f)
+      return NULL;
+
+   fseek(f, 0, SEEK_END);
+   size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   if (size <= 0)
+      goto end;
+
+   len16 = ((size_t)size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
+   ret   = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4
+         + STATE_DELTA_PADDING, 1);
+
+   if (!ret)
+      goto end;
+
+   if (fread(ret, 1, (size_t)size, f) != (size_t)size)
+   {
+      free(ret);
+      ret = NULL;
+      goto end;
+   }
+
+   ret[len16 / sizeof(uint16_t) + 3] = uniq;
+   *len = (size_t)size;
+
+end:
+   fclose(f);
+   return ret;
+}
+
+/* Walks the pair the same way state_manager_raw_compress() does,
+ * returning the size the patch would have.
+ *
+ * If 'ref' is set, every find_change() result is checked against it;
+ * find_change() is exact, so all kernels must agree, while find_same()
+ * is allowed to split runs differently as long as it makes progress. */
+static size_t scan_pair(const state_delta_kernels_t *k,
+      const state_delta_kernels_t *ref,
+      const uint16_t *old16, const uint16_t *new16, size_t len,
+      bool *valid)
+{
+   size_t num16s = (len + sizeof(uint16_t) - 1) / sizeof(uint16_t);
+   size_t out    = 0;
+
+   while (num16s)
+   {
+      size_t changed;
+      size_t skip = k->find_change(old16, new16);
+
+      if (ref && skip != ref->find_change(old16, new16))
+         *valid = false;
+
+      if (skip >= num16s)
+         break;
+
+      old16  += skip;
+      new16  += skip;
+      num16s -= skip;
+
+      if (skip > 0xffff)
+      {
+         out += 3 * sizeof(uint16_t);
+         continue;
+      }
+
+      changed = k->find_same(old16, new16);
+      if (!changed)
+      {
+         *valid = false;
+         break;
+      }
+      if (changed > 0xffff)
+         changed = 0xffff;
+
+      out    += (2 + changed) * sizeof(uint16_t);
+      old16  += changed;
+      new16  += changed;
+      num16s -= (changed < num16s) ? changed : num16s;
+   }
+
+   return out + 3 * sizeof(uint16_t);
+}
+
+static bool bench_pair(const state_delta_kernels_t *list, unsigned count,
+      const uint16_t *old16, const uint16_t *new16, size_t len)
+{
+   unsigned i;
+   bool ret = true;
+   /* The portable C kernels are always last. */
+   const state_delta_kernels_t *ref = &list[count - 1];
+
+   for (i = 0; i < count; i++)
+   {
+      retro_time_t start, elapsed;
+      unsigned iterations = 0;
+      bool valid          = true;
+      size_t patch        = scan_pair(&list[i], ref,
+            old16, new16, len, &valid);
+
+      start = cpu_features_get_time_usec();
+      do
+      {
+         scan_pair(&list[i], NULL, old16, new16, len, &valid);
+         iterations++;
+         elapsed = cpu_features_get_time_usec() - start;
+      } while (elapsed < 500000);
+
+      printf("  %-6s %9.1f MB/s  patch %8u bytes%s\n",
+            list[i].ident,
+            (double)len * iterations / (double)elapsed,
+            (unsigned)patch,
+            valid ? "" : "  MISMATCH");
+
+      if (!valid)
+         ret = false;
+   }
+
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   int ret = 0;
+   state_delta_kernels_t list[MAX_KERNELS];
+   unsigned count = state_delta_kernels_list(cpu_features_get(),
+         list, MAX_KERNELS);
+
+   if (argc < 3 || !(argc & 1))
+   {
+      fprintf(stderr, "Usage: %s old.state new.state [...]\n", argv[0]);
+      return 1;
+   }
+
+   for (i = 1; i + 1 < argc; i += 2)
+   {
+      size_t old_len   = 0;
+      size_t new_len   = 0;
+      uint16_t *old16  = load_state(argv[i], &old_len, 0);
+      uint16_t *new16  = load_state(argv[i + 1], &new_len, 1);
+
+      if (!old16 || !new16 || old_len != new_len)
+      {
+         fprintf(stderr, "Could not load state pair %s / %s.\n",
+               argv[i], argv[i + 1]);
+         free(old16);
+         free(new16);
+         return 1;
+      }
+
+      printf("%s -> %s (%u bytes)\n", argv[i], argv[i + 1],
+            (unsigned)old_len);
+      if (!bench_pair(list, count, old16, new16, old_len))
+         ret = 1;
+
+      free(old16);
+      free(new16);
+   }
+
+   return ret;
+}
@@ -0,0 +1,236 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rjpeg_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Measures rjpeg decode speed on a set of JPEGs, e.g. a boxart
+ * thumbnail directory:
+ *
+ *    rjpeg_bench *.jpg
+ *
+ * Every file is decoded with the SIMD kernels and with a second copy
+ * of rjpeg built with RJPEG_NO_SIMD. Both should agree bit for bit,
+ * the largest channel difference is printed next to the timings.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+
+#include <features/features_cpu.h>
+#include <formats/image.h>
+#include <formats/rjpeg.h>
+
+/* rjpeg_c.o, the same decoder built with RJPEG_NO_SIMD. */
+rjpeg_t *rjpeg_c_alloc(void);
+bool rjpeg_c_set_buf_ptr(rjpeg_t *rjpeg, void *data);
+int rjpeg_c_process_image(rjpeg_t *rjpeg, void **buf,
+      size_t size, unsigned *width, unsigned *height);
+void rjpeg_c_free(rjpeg_t *rjpeg);
+
+typedef struct
+{
+   const char *ident;
+   rjpeg_t *(*alloc)(void);
+   bool (*set_buf_ptr)(rjpeg_t *rjpeg, void *data);
+   int (*process_image)(rjpeg_t *rjpeg, void **buf,
+         size_t size, unsigned *width, unsigned *height);
+   void (*free)(rjpeg_t *rjpeg);
+} bench_decoder_t;
+
+static const bench_decoder_t decoders[] = {
+   { "simd", rjpeg_alloc, rjpeg_set_buf_ptr,
+      rjpeg_process_image, rjpeg_free },
+   { "c", rjpeg_c_alloc, rjpeg_c_set_buf_ptr,
+      rjpeg_c_process_image, rjpeg_c_free },
+};
+
+static uint8_t *load_file(const char *path, size_t *len)
+{
+   long size;
+   uint8_t *ret = NULL;
+   FILE *f      = fopen(path, "rb");
+
+   if (!f)
+      return NULL;
+
+   fseek(f, 0, SEEK_END);
+   size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   if (size > 0 && (ret = (uint8_t*)malloc((size_t)size)))
+   {
+      if (fread(ret, 1, (size_t)size, f) != (size_t)size)
+      {
+         free(ret);
+         ret = NULL;
+      }
+      else
+         *len = (size_t)size;
+   }
+
+   fclose(f);
+   return ret;
+}
+
+static uint32_t *decode(const bench_decoder_t *dec, uint8_t *data,
+      size_t len, unsigned *width, unsigned *height)
+{
+   void *pixels   = NULL;
+   rjpeg_t *rjpeg = dec->alloc();
+   int ret        = IMAGE_PROCESS_ERROR;
+
+   if (rjpeg && dec->set_buf_ptr(rjpeg, data))
+      ret = dec->process_image(rjpeg, &pixels, len, width, height);
+
+   dec->free(rjpeg);
+
+   if (ret != IMAGE_PROCESS_END)
+   {
+      free(pixels);
+      return NULL;
+   }
+
+   return (uint32_t*)pixels;
+}
+
+/* Best of a few runs, in microseconds. */
+static retro_time_t bench_decoder(const bench_decoder_t *dec,
+      uint8_t *data, size_t len)
+{
+   unsigned i;
+   retro_time_t best = 0;
+
+   for (i = 0; i < 8; i++)
+   {
+      unsigned width, height;
+      uint32_t *pixels;
+      retro_time_t elapsed;
+      retro_time_t start = cpu_features_get_time_usec();
+
+      pixels  = decode(dec, data, len, &width, &height);
+      elapsed = cpu_features_get_time_usec() - start;
+      free(pixels);
+
+      if (!best || elapsed < best)
+         best = elapsed;
+   }
+
+   return best;
+}
+
+static unsigned max_diff(const uint32_t *a, const uint32_t *b,
+      size_t count)
+{
+   size_t i;
+   unsigned diff = 0;
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned shift;
+
+      for (shift = 0; shift < 32; shift += 8)
+      {
+         int d = (int)((a[i] >> shift) & 0xff) - (int)((b[i] >> shift) & 0xff);
+
+         if (d < 0)
+            d = -d;
+         if ((unsigned)d > diff)
+            diff = (unsigned)d;
+      }
+   }
+
+   return diff;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   int ret               = 0;
+   retro_time_t total[2] = {0};
+   double megapixels     = 0.0;
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "Usage: %s file.jpg [file.jpg ...]\n", argv[0]);
+      return 1;
+   }
+
+   printf("%-32s %11s %9s %9s %7s %5s\n",
+         "file", "size", "simd ms", "c ms", "speedup", "diff");
+
+   for (i = 1; i < argc; i++)
+   {
+      unsigned d;
+      unsigned width, height, c_width, c_height;
+      retro_time_t simd, c;
+      size_t len        = 0;
+      uint8_t *data     = load_file(argv[i], &len);
+      uint32_t *pixels  = NULL;
+      uint32_t *ref     = NULL;
+
+      if (!data)
+      {
+         fprintf(stderr, "Could not read %s.\n", argv[i]);
+         ret = 1;
+         continue;
+      }
+
+      pixels = decode(&decoders[0], data, len, &width, &height);
+      ref    = decode(&decoders[1], data, len, &c_width, &c_height);
+
+      if (!pixels || !ref || width != c_width || height != c_height)
+      {
+         fprintf(stderr, "Could not decode %s.\n", argv[i]);
+         free(pixels);
+         free(ref);
+         free(data);
+         ret = 1;
+         continue;
+      }
+
+      d            = max_diff(pixels, ref, (size_t)width * height);
+      simd         = bench_decoder(&decoders[0], data, len);
+      c            = bench_decoder(&decoders[1], data, len);
+      total[0]    += simd;
+      total[1]    += c;
+      megapixels  += (double)width * height / 1000000.0;
+
+      printf("%-32.32s %5ux%-5u %9.2f %9.2f %6.2fx %5u\n", argv[i],
+            width, height, simd / 1000.0, c / 1000.0,
+            (double)c / (simd ? simd : 1), d);
+
+      free(pixels);
+      free(ref);
+      free(data);
+   }
+
+   if (total[0])
+      printf("%-32s %11s %9.2f %9.2f %6.2fx\n%.1f MP/s with SIMD, %.1f MP/s without\n",
+            "total", "", total[0] / 1000.0, total[1] / 1000.0,
+            (double)total[1] / total[0],
+            megapixels * 1000000.0 / total[0],
+            total[1] ? megapixels * 1000000.0 / total[1] : 0.0);
+
+   return ret;
+}
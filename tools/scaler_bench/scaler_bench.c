@@ -0,0 +1,226 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (scaler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Measures the ARGB8888 scaler kernels in megapixels (of output)
+ * per second, for every filter type:
+ *
+ *    scaler_bench [in_width in_height out_width out_height]
+ *
+ * Without arguments, a 4x upscale and a 3x downscale are run.
+ * The fastest kernels are run once more with one band per core,
+ * which must give the same output.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+
+#include <features/features_cpu.h>
+#include <gfx/scaler/scaler.h>
+#include <gfx/scaler/scaler_int.h>
+
+#define MAX_KERNELS 8
+
+static const struct
+{
+   enum scaler_type type;
+   const char *ident;
+} scaler_types[] = {
+   { SCALER_TYPE_POINT,    "point"    },
+   { SCALER_TYPE_BILINEAR, "bilinear" },
+   { SCALER_TYPE_SINC,     "sinc"     },
+};
+
+static double bench_ctx(struct scaler_ctx *ctx,
+      uint32_t *output, const uint32_t *input)
+{
+   retro_time_t start, elapsed;
+   unsigned iterations = 0;
+
+   start = cpu_features_get_time_usec();
+   do
+   {
+      scaler_ctx_scale(ctx, output, input);
+      iterations++;
+      elapsed = cpu_features_get_time_usec() - start;
+   } while (elapsed < 500000);
+
+   return (double)ctx->out_width * ctx->out_height
+      * iterations / (double)elapsed;
+}
+
+static bool bench_size(const scaler_argb8888_kernels_t *list,
+      unsigned count, int in_width, int in_height,
+      int out_width, int out_height)
+{
+   unsigned i, t;
+   unsigned threads  = cpu_features_get_core_amount();
+   bool ret          = true;
+   size_t out_pixels = (size_t)out_width * out_height;
+   uint32_t *input   = (uint32_t*)malloc(
+         (size_t)in_width * in_height * sizeof(uint32_t));
+   uint32_t *output  = (uint32_t*)malloc(out_pixels * sizeof(uint32_t));
+   uint32_t *ref     = (uint32_t*)malloc(out_pixels * sizeof(uint32_t));
+
+   if (!input || !output || !ref)
+   {
+      free(input);
+      free(output);
+      free(ref);
+      return false;
+   }
+
+   srand(0);
+   for (i = 0; i < (unsigned)(in_width * in_height); i++)
+      input[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+
+   printf("%dx%d -> %dx%d\n", in_width, in_height, out_width, out_height);
+
+   for (t = 0; t < sizeof(scaler_types) / sizeof(scaler_types[0]); t++)
+   {
+      struct scaler_ctx ctx;
+
+      memset(&ctx, 0, sizeof(ctx));
+      ctx.in_width    = in_width;
+      ctx.in_height   = in_height;
+      ctx.in_stride   = in_width * sizeof(uint32_t);
+      ctx.out_width   = out_width;
+      ctx.out_height  = out_height;
+      ctx.out_stride  = out_width * sizeof(uint32_t);
+      ctx.in_fmt      = SCALER_FMT_ARGB8888;
+      ctx.out_fmt     = SCALER_FMT_ARGB8888;
+      ctx.scaler_type = scaler_types[t].type;
+
+      if (!scaler_ctx_gen_filter(&ctx))
+      {
+         fprintf(stderr, "Could not create %s scaler.\n",
+               scaler_types[t].ident);
+         ret = false;
+         continue;
+      }
+
+      /* Point scaling never reaches the filter kernels. */
+      if (ctx.scaler_special)
+      {
+         printf("  %-8s %-7s %9.1f MP/s\n", scaler_types[t].ident,
+               "special", bench_ctx(&ctx, output, input));
+         scaler_ctx_gen_reset(&ctx);
+         continue;
+      }
+
+      /* The portable kernels are always last. */
+      ctx.scaler_horiz = list[count - 1].horiz;
+      ctx.scaler_vert  = list[count - 1].vert;
+      scaler_ctx_scale(&ctx, ref, input);
+
+      for (i = 0; i < count; i++)
+      {
+         bool valid;
+         double mps;
+
+         ctx.scaler_horiz = list[i].horiz;
+         ctx.scaler_vert  = list[i].vert;
+
+         memset(output, 0, out_pixels * sizeof(uint32_t));
+         scaler_ctx_scale(&ctx, output, input);
+         valid = !memcmp(output, ref, out_pixels * sizeof(uint32_t));
+         mps   = bench_ctx(&ctx, output, input);
+
+         printf("  %-8s %-7s %9.1f MP/s%s\n", scaler_types[t].ident,
+               list[i].ident, mps, valid ? "" : "  MISMATCH");
+
+         if (!valid)
+            ret = false;
+      }
+
+      if (threads > 1)
+      {
+         bool valid;
+         double mps;
+         char ident[32];
+
+         ctx.scaler_horiz = list[0].horiz;
+         ctx.scaler_vert  = list[0].vert;
+         ctx.threads      = threads;
+
+         memset(output, 0, out_pixels * sizeof(uint32_t));
+         scaler_ctx_scale(&ctx, output, input);
+         valid = !memcmp(output, ref, out_pixels * sizeof(uint32_t));
+         mps   = bench_ctx(&ctx, output, input);
+
+         snprintf(ident, sizeof(ident), "%sx%u", list[0].ident, threads);
+         printf("  %-8s %-7s %9.1f MP/s%s\n", scaler_types[t].ident,
+               ident, mps, valid ? "" : "  MISMATCH");
+
+         if (!valid)
+            ret = false;
+      }
+
+      scaler_ctx_gen_reset(&ctx);
+   }
+
+   free(input);
+   free(output);
+   free(ref);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int ret = 0;
+   scaler_argb8888_kernels_t list[MAX_KERNELS];
+   unsigned count = scaler_argb8888_kernels_list(cpu_features_get(),
+         list, MAX_KERNELS);
+
+   if (argc == 5)
+   {
+      int in_width   = atoi(argv[1]);
+      int in_height  = atoi(argv[2]);
+      int out_width  = atoi(argv[3]);
+      int out_height = atoi(argv[4]);
+
+      if (in_width <= 0 || in_height <= 0 || out_width <= 0 || out_height <= 0)
+      {
+         fprintf(stderr, "Invalid size.\n");
+         return 1;
+      }
+
+      return bench_size(list, count,
+            in_width, in_height, out_width, out_height) ? 0 : 1;
+   }
+   else if (argc != 1)
+   {
+      fprintf(stderr,
+            "Usage: %s [in_width in_height out_width out_height]\n", argv[0]);
+      return 1;
+   }
+
+   if (!bench_size(list, count, 320, 240, 1283, 961))
+      ret = 1;
+   if (!bench_size(list, count, 1920, 1080, 640, 360))
+      ret = 1;
+
+   return ret;
+}
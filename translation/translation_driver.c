@@ -1,67 +1,556 @@
-#include <string/stdstring.h>
-
-#include "translation_driver.h"
-#include "ocr_driver.h"
-#include "../configuration.h"
-
-static const translation_driver_t *translation_backends[] = {
-	&translation_cached_google,
-	&ocr_null,
-	NULL
-};
-
-static const translation_driver_t *current_translation_backend = NULL;
-static void *translation_data = NULL;
-
-static const translation_driver_t *translation_find_backend(
-      const char* ident)
-{
-	unsigned i;
-
-	for (i = 0; translation_backends[i]; i++)
-	{
-		if (string_is_equal(translation_backends[i]->ident, ident))
-			return translation_backends[i];
-	}
-
-	return NULL;
-}
-
-bool  translation_driver_init(void)
-{
-	settings_t *settings = config_get_ptr();
-
-   if (!settings)
-      return false;
-
-   current_translation_backend = translation_find_backend(
-         settings->arrays.translation_driver);
-	translation_data = NULL;
-	
-	if (current_translation_backend)
-		translation_data = (*current_translation_backend->init)();
-	return translation_data != NULL;
-}
-
-void  translation_driver_free(void)
-{
-   if (current_translation_backend && translation_data)
-      (*current_translation_backend->free)(translation_data);
-}
-
-char* translation_driver_translate_image(struct ocr_image_info image)
-{
-   char* translated_text = NULL;
-
-   if (current_translation_backend && translation_data)
-   {
-      if (current_translation_backend->translate_image)
-         translated_text = (*current_translation_backend->translate_image)
-            (translation_data, image);
-      else 
-         translated_text = (*current_translation_backend->translate_text)
-            (translation_data, ocr_driver_get_text(image));
-   }
-
-   return translated_text;
-}
+#include <stdlib.h>
+#include <string.h>
+
+#include <libretro.h>
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+#include <streams/file_stream.h>
+#include <file/file_path.h>
+#include <queues/task_queue.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "translation_driver.h"
+#include "ocr_driver.h"
+#include "../configuration.h"
+
+/* Text already translated, by hash of the game text */
+#define TRANSLATION_CACHE_SIZE 512
+/* Grid the image is reduced to for the frame hash */
+#define TRANSLATION_HASH_GRID 16
+/* Differing hash bits still taken for the same text, to ride over
+ * blinking cursors and palette effects */
+#define TRANSLATION_HASH_THRESHOLD 3
+
+typedef struct translation_cache_entry
+{
+   char *text;
+   char *translation;
+} translation_cache_entry_t;
+
+typedef struct translation_frame_hash
+{
+   uint32_t rows[TRANSLATION_HASH_GRID];
+} translation_frame_hash_t;
+
+static const translation_driver_t *translation_backends[] = {
+	&translation_cached_google,
+	&ocr_null,
+	NULL
+};
+
+static const translation_driver_t *current_translation_backend = NULL;
+static void *translation_data = NULL;
+
+static translation_cache_entry_t translation_cache[TRANSLATION_CACHE_SIZE];
+static translation_frame_hash_t translation_last_hash;
+static bool translation_has_last_hash = false;
+static char *translation_last = NULL;
+static bool translation_busy = false;
+#ifdef HAVE_THREADS
+static slock_t *translation_lock = NULL;
+#endif
+
+static uint32_t translation_text_hash(const char *text)
+{
+   uint32_t hash = 5381;
+
+   while (*text)
+      hash = (hash << 5) + hash + (uint8_t)*text++;
+
+   return hash;
+}
+
+static void translation_cache_path(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+   char name[64];
+
+   s[0] = '\0';
+
+   if (     !settings
+         || !current_translation_backend
+         || string_is_empty(settings->paths.directory_cache))
+      return;
+
+   snprintf(name, sizeof(name), "translation_%s.cache",
+         current_translation_backend->ident);
+   fill_pathname_join(s, settings->paths.directory_cache, name, len);
+}
+
+static void translation_cache_set(const char *text, const char *translation)
+{
+   translation_cache_entry_t *entry = &translation_cache[
+      translation_text_hash(text) & (TRANSLATION_CACHE_SIZE - 1)];
+   char *new_text                   = strdup(text);
+   char *new_translation            = strdup(translation);
+
+   if (!new_text || !new_translation)
+   {
+      free(new_text);
+      free(new_translation);
+      return;
+   }
+
+   /* A colliding line just takes the slot */
+   free(entry->text);
+   free(entry->translation);
+   entry->text        = new_text;
+   entry->translation = new_translation;
+}
+
+static const char *translation_cache_get(const char *text)
+{
+   const translation_cache_entry_t *entry = &translation_cache[
+      translation_text_hash(text) & (TRANSLATION_CACHE_SIZE - 1)];
+
+   if (entry->text && string_is_equal(entry->text, text))
+      return entry->translation;
+
+   return NULL;
+}
+
+static void translation_cache_clear(void)
+{
+   unsigned i;
+
+   for (i = 0; i < TRANSLATION_CACHE_SIZE; i++)
+   {
+      free(translation_cache[i].text);
+      free(translation_cache[i].translation);
+   }
+
+   memset(translation_cache, 0, sizeof(translation_cache));
+   free(translation_last);
+   translation_last          = NULL;
+   translation_has_last_hash = false;
+}
+
+/* The cache file is pairs of '\0' terminated strings, so
+ * dialogue spanning several lines survives */
+static void translation_cache_load(void)
+{
+   char path[PATH_MAX_LENGTH];
+   void *buf    = NULL;
+   int64_t len  = 0;
+   char *s      = NULL;
+   char *end    = NULL;
+
+   translation_cache_path(path, sizeof(path));
+
+   if (     string_is_empty(path)
+         || !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return;
+
+   s   = (char*)buf;
+   end = s + len;
+
+   while (s < end)
+   {
+      char *translation = s + strlen(s) + 1;
+
+      if (translation >= end)
+         break;
+
+      translation_cache_set(s, translation);
+      s = translation + strlen(translation) + 1;
+   }
+
+   free(buf);
+}
+
+static void translation_cache_save(void)
+{
+   unsigned i;
+   char path[PATH_MAX_LENGTH];
+   RFILE *file = NULL;
+
+   translation_cache_path(path, sizeof(path));
+
+   if (string_is_empty(path))
+      return;
+
+   if (!(file = filestream_open(path,
+               RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   for (i = 0; i < TRANSLATION_CACHE_SIZE; i++)
+   {
+      const translation_cache_entry_t *entry = &translation_cache[i];
+
+      if (!entry->text)
+         continue;
+
+      filestream_write(file, entry->text, strlen(entry->text) + 1);
+      filestream_write(file, entry->translation,
+            strlen(entry->translation) + 1);
+   }
+
+   filestream_close(file);
+}
+
+static unsigned translation_luma(const struct ocr_image_info *image,
+      unsigned x, unsigned y)
+{
+   unsigned r, g, b;
+
+   switch (image->pixel_format)
+   {
+      case RETRO_PIXEL_FORMAT_0RGB1555:
+         {
+            uint16_t px = ((const uint16_t*)image->data)[y * image->width + x];
+            r = (px >> 7) & 0xf8;
+            g = (px >> 2) & 0xf8;
+            b = (px << 3) & 0xf8;
+         }
+         break;
+      case RETRO_PIXEL_FORMAT_RGB565:
+         {
+            uint16_t px = ((const uint16_t*)image->data)[y * image->width + x];
+            r = (px >> 8) & 0xf8;
+            g = (px >> 3) & 0xfc;
+            b = (px << 3) & 0xf8;
+         }
+         break;
+      default:
+         {
+            uint32_t px = ((const uint32_t*)image->data)[y * image->width + x];
+            r = (px >> 16) & 0xff;
+            g = (px >>  8) & 0xff;
+            b =  px        & 0xff;
+         }
+         break;
+   }
+
+   return (r * 77 + g * 150 + b * 29) >> 8;
+}
+
+/* Difference hash of the image: the image is averaged down to a
+ * grid one cell wider than it is high and each bit says whether a
+ * cell is brighter than its right neighbour. Unlike a byte compare,
+ * video noise and small palette shifts leave it alone. */
+static bool translation_frame_hash(const struct ocr_image_info *image,
+      translation_frame_hash_t *hash)
+{
+   unsigned gx, gy;
+   unsigned cells[TRANSLATION_HASH_GRID + 1];
+
+   if (     !image->data
+         || image->width  < TRANSLATION_HASH_GRID + 1
+         || image->height < TRANSLATION_HASH_GRID)
+      return false;
+
+   for (gy = 0; gy < TRANSLATION_HASH_GRID; gy++)
+   {
+      unsigned y0 = gy       * image->height / TRANSLATION_HASH_GRID;
+      unsigned y1 = (gy + 1) * image->height / TRANSLATION_HASH_GRID;
+
+      for (gx = 0; gx < TRANSLATION_HASH_GRID + 1; gx++)
+      {
+         unsigned x, y;
+         unsigned x0  = gx       * image->width / (TRANSLATION_HASH_GRID + 1);
+         unsigned x1  = (gx + 1) * image->width / (TRANSLATION_HASH_GRID + 1);
+         unsigned sum = 0;
+
+         /* Every other pixel is plenty for an average */
+         for (y = y0; y < y1; y += 2)
+            for (x = x0; x < x1; x += 2)
+               sum += translation_luma(image, x, y);
+
+         cells[gx] = sum / (((y1 - y0 + 1) / 2) * ((x1 - x0 + 1) / 2));
+      }
+
+      hash->rows[gy] = 0;
+      for (gx = 0; gx < TRANSLATION_HASH_GRID; gx++)
+         if (cells[gx] > cells[gx + 1])
+            hash->rows[gy] |= 1 << gx;
+   }
+
+   return true;
+}
+
+static unsigned translation_frame_hash_distance(
+      const translation_frame_hash_t *a, const translation_frame_hash_t *b)
+{
+   unsigned i;
+   unsigned distance = 0;
+
+   for (i = 0; i < TRANSLATION_HASH_GRID; i++)
+   {
+      uint32_t bits = a->rows[i] ^ b->rows[i];
+
+      for (; bits; bits &= bits - 1)
+         distance++;
+   }
+
+   return distance;
+}
+
+/* Whether the frame shows the text that was translated last */
+static bool translation_frame_unchanged(const translation_frame_hash_t *hash)
+{
+   return translation_has_last_hash && translation_last
+      && translation_frame_hash_distance(hash, &translation_last_hash)
+         <= TRANSLATION_HASH_THRESHOLD;
+}
+
+/* Does the OCR and translation, translation_lock held */
+static const char *translation_translate(const struct ocr_image_info *image,
+      const translation_frame_hash_t *hash, bool has_hash)
+{
+   const char *translated_text = NULL;
+
+   if (!current_translation_backend || !translation_data)
+      return NULL;
+
+   if (current_translation_backend->translate_image)
+      translated_text = (*current_translation_backend->translate_image)
+         (translation_data, *image);
+   else
+   {
+      const char *game_text = ocr_driver_get_text(*image);
+
+      if (!game_text)
+         return NULL;
+
+      if (!(translated_text = translation_cache_get(game_text)))
+      {
+         translated_text = (*current_translation_backend->translate_text)
+            (translation_data, game_text);
+
+         if (translated_text)
+            translation_cache_set(game_text, translated_text);
+      }
+   }
+
+   if (!translated_text)
+      return NULL;
+
+   /* Backends only keep the result until the next call */
+   if (translation_last != translated_text)
+   {
+      free(translation_last);
+      translation_last = strdup(translated_text);
+   }
+
+   translation_has_last_hash = has_hash;
+   if (has_hash)
+      translation_last_hash  = *hash;
+
+   return translation_last;
+}
+
+static const translation_driver_t *translation_find_backend(
+      const char* ident)
+{
+	unsigned i;
+
+	for (i = 0; translation_backends[i]; i++)
+	{
+		if (string_is_equal(translation_backends[i]->ident, ident))
+			return translation_backends[i];
+	}
+
+	return NULL;
+}
+
+bool  translation_driver_init(void)
+{
+	settings_t *settings = config_get_ptr();
+
+   if (!settings)
+      return false;
+
+   current_translation_backend = translation_find_backend(
+         settings->arrays.translation_driver);
+	translation_data = NULL;
+	
+	if (current_translation_backend)
+		translation_data = (*current_translation_backend->init)();
+
+#ifdef HAVE_THREADS
+   if (!translation_lock)
+      translation_lock = slock_new();
+#endif
+
+   if (translation_data)
+      translation_cache_load();
+
+	return translation_data != NULL;
+}
+
+void  translation_driver_free(void)
+{
+   /* Wait for a translation still running on a worker */
+   while (translation_busy)
+      task_queue_check();
+
+   if (current_translation_backend && translation_data)
+   {
+      translation_cache_save();
+      (*current_translation_backend->free)(translation_data);
+   }
+
+   translation_cache_clear();
+   translation_data = NULL;
+
+#ifdef HAVE_THREADS
+   if (translation_lock)
+      slock_free(translation_lock);
+   translation_lock = NULL;
+#endif
+}
+
+char* translation_driver_translate_image(struct ocr_image_info image)
+{
+   translation_frame_hash_t hash;
+   const char *translated_text = NULL;
+   bool has_hash               = translation_frame_hash(&image, &hash);
+
+#ifdef HAVE_THREADS
+   if (translation_lock)
+      slock_lock(translation_lock);
+#endif
+
+   /* Dialogue still on screen, no need for OCR */
+   if (has_hash && translation_frame_unchanged(&hash))
+      translated_text = translation_last;
+   else
+      translated_text = translation_translate(&image, &hash, has_hash);
+
+#ifdef HAVE_THREADS
+   if (translation_lock)
+      slock_unlock(translation_lock);
+#endif
+
+   return (char*)translated_text;
+}
+
+typedef struct translation_task_state
+{
+   struct ocr_image_info image;
+   translation_frame_hash_t hash;
+   retro_task_callback_t cb;
+   void *user_data;
+   bool has_hash;
+} translation_task_state_t;
+
+static void task_translation_handler(retro_task_t *task)
+{
+   translation_task_state_t *state = (translation_task_state_t*)task->state;
+   const char *translated_text     = NULL;
+
+#ifdef HAVE_THREADS
+   if (translation_lock)
+      slock_lock(translation_lock);
+#endif
+
+   translated_text = translation_translate(&state->image,
+         &state->hash, state->has_hash);
+
+   if (translated_text)
+      task_set_data(task, strdup(translated_text));
+   else
+      task_set_error(task, strdup("Translation failed."));
+
+#ifdef HAVE_THREADS
+   if (translation_lock)
+      slock_unlock(translation_lock);
+#endif
+
+   free(state->image.data);
+   state->image.data = NULL;
+
+   task_set_progress(task, 100);
+   task_set_finished(task, true);
+}
+
+/* Runs on the main thread, then hands over to the caller */
+static void translation_task_done(void *task_data,
+      void *user_data, const char *error)
+{
+   translation_task_state_t *state = (translation_task_state_t*)user_data;
+
+   translation_busy = false;
+
+   if (state->cb)
+      state->cb(task_data, state->user_data, error);
+   else
+      free(task_data);
+
+   free(state);
+}
+
+static size_t translation_image_size(const struct ocr_image_info *image)
+{
+   switch (image->pixel_format)
+   {
+      case RETRO_PIXEL_FORMAT_0RGB1555:
+      case RETRO_PIXEL_FORMAT_RGB565:
+         return image->width * image->height * 2;
+      default:
+         break;
+   }
+
+   return image->width * image->height * 4;
+}
+
+bool translation_driver_translate_image_async(struct ocr_image_info image,
+      retro_task_callback_t cb, void *user_data)
+{
+   retro_task_t *task              = NULL;
+   translation_task_state_t *state = NULL;
+   size_t size                     = translation_image_size(&image);
+
+   /* Auto-translate asks every frame, one at a time is enough */
+   if (translation_busy || !current_translation_backend || !translation_data)
+      return false;
+
+   state = (translation_task_state_t*)calloc(1, sizeof(*state));
+
+   if (!state)
+      return false;
+
+   /* No worker is running, so the last translation is ours to read */
+   state->has_hash   = translation_frame_hash(&image, &state->hash);
+
+   if (state->has_hash && translation_frame_unchanged(&state->hash))
+   {
+      free(state);
+      return false;
+   }
+
+   state->image      = image;
+   state->cb         = cb;
+   state->user_data  = user_data;
+
+   /* The frame is gone by the time a worker gets to it */
+   if (!(state->image.data = malloc(size)))
+   {
+      free(state);
+      return false;
+   }
+   memcpy(state->image.data, image.data, size);
+
+   task = (retro_task_t*)calloc(1, sizeof(*task));
+
+   if (!task)
+   {
+      free(state->image.data);
+      free(state);
+      return false;
+   }
+
+   task->handler   = task_translation_handler;
+   task->state     = state;
+   task->callback  = translation_task_done;
+   task->user_data = state;
+   task->mute      = true;
+
+   translation_busy = true;
+   task_queue_push(task);
+
+   return true;
+}
@@ -0,0 +1,296 @@
+#include <QApplication>
+#include <QImageReader>
+#include <QPainter>
+#include <QPixmap>
+#include <QPixmapCache>
+#include <QRunnable>
+#include <QStyle>
+
+#include "gridview.h"
+
+#define THUMBNAIL_MARGIN 6
+#define THUMBNAIL_SIZE_MIN 128
+#define THUMBNAIL_SIZE_MAX 1024
+/* in KiB, about 250 thumbnails at 256x256 */
+#define THUMBNAIL_CACHE_LIMIT (64 * 1024)
+
+class ThumbnailLoader : public QRunnable
+{
+public:
+   ThumbnailLoader(QObject *model, int generation, const QString &path, const QString &key, int size) :
+      QRunnable()
+      ,m_model(model)
+      ,m_generation(generation)
+      ,m_path(path)
+      ,m_key(key)
+      ,m_size(size)
+   {
+   }
+
+   void run()
+   {
+      /* this runs in another thread */
+      QImageReader reader(m_path);
+      QSize imageSize = reader.size();
+      QImage image;
+
+      /* let the reader scale while decoding where the format supports it */
+      if (imageSize.isValid() && (imageSize.width() > m_size || imageSize.height() > m_size))
+         reader.setScaledSize(imageSize.scaled(m_size, m_size, Qt::KeepAspectRatio));
+
+      image = reader.read();
+
+      /* the model waits for the pool to finish before it is destroyed */
+      QMetaObject::invokeMethod(m_model, "onThumbnailLoaded", Qt::QueuedConnection,
+            Q_ARG(int, m_generation), Q_ARG(QString, m_key), Q_ARG(QImage, image));
+   }
+private:
+   QObject *m_model;
+   int m_generation;
+   QString m_path;
+   QString m_key;
+   int m_size;
+};
+
+PlaylistModel::PlaylistModel(QObject *parent) :
+   QAbstractListModel(parent)
+   ,m_contents()
+   ,m_imagePaths()
+   ,m_pendingThumbnails()
+   ,m_missingThumbnails()
+   ,m_threadPool()
+   ,m_generation(0)
+   ,m_requestPriority(0)
+   ,m_thumbnailSize(256)
+{
+   if (QPixmapCache::cacheLimit() < THUMBNAIL_CACHE_LIMIT)
+      QPixmapCache::setCacheLimit(THUMBNAIL_CACHE_LIMIT);
+}
+
+PlaylistModel::~PlaylistModel()
+{
+   m_threadPool.clear();
+   m_threadPool.waitForDone();
+}
+
+int PlaylistModel::rowCount(const QModelIndex &parent) const
+{
+   if (parent.isValid())
+      return 0;
+
+   return m_contents.count();
+}
+
+QVariant PlaylistModel::data(const QModelIndex &index, int role) const
+{
+   int row = index.row();
+
+   if (!index.isValid() || row < 0 || row >= m_contents.count())
+      return QVariant();
+
+   switch (role)
+   {
+      case Qt::DisplayRole:
+      case Qt::ToolTipRole:
+         return m_contents.at(row).value("label");
+      case Qt::DecorationRole:
+      {
+         const QString &path = m_imagePaths.at(row);
+         QString key;
+         QPixmap pixmap;
+
+         if (path.isEmpty())
+            return QVariant();
+
+         key = getThumbnailKey(path);
+
+         if (QPixmapCache::find(key, &pixmap))
+            return pixmap;
+
+         /* only rows the view actually paints get here, so a
+          * 10k entry playlist decodes a screenful at a time */
+         const_cast<PlaylistModel*>(this)->loadThumbnail(row, key);
+
+         return QVariant();
+      }
+      default:
+         break;
+   }
+
+   return QVariant();
+}
+
+QString PlaylistModel::getThumbnailKey(const QString &path) const
+{
+   return QString::number(m_thumbnailSize) + ":" + path;
+}
+
+void PlaylistModel::loadThumbnail(int row, const QString &key)
+{
+   QHash<QString, QVector<int> >::iterator pending;
+
+   if (m_missingThumbnails.contains(key))
+      return;
+
+   pending = m_pendingThumbnails.find(key);
+
+   if (pending != m_pendingThumbnails.end())
+   {
+      if (!pending.value().contains(row))
+         pending.value().append(row);
+      return;
+   }
+
+   m_pendingThumbnails[key].append(row);
+
+   /* newest requests first, so the rows scrolled to last show up first */
+   m_threadPool.start(new ThumbnailLoader(this, m_generation, m_imagePaths.at(row), key, m_thumbnailSize), ++m_requestPriority);
+}
+
+void PlaylistModel::onThumbnailLoaded(int generation, QString key, QImage image)
+{
+   QVector<int> rows;
+   int i;
+
+   if (generation != m_generation)
+      return;
+
+   rows = m_pendingThumbnails.take(key);
+
+   if (image.isNull())
+   {
+      m_missingThumbnails.insert(key);
+      return;
+   }
+
+   QPixmapCache::insert(key, QPixmap::fromImage(image));
+
+   for (i = 0; i < rows.count(); i++)
+   {
+      QModelIndex changed = index(rows.at(i), 0);
+      emit dataChanged(changed, changed);
+   }
+}
+
+void PlaylistModel::setContents(const QVector<QHash<QString, QString> > &items, const QVector<QString> &imagePaths)
+{
+   beginResetModel();
+
+   /* drop queued decodes for the old contents, running ones are ignored by generation */
+   m_threadPool.clear();
+   m_generation++;
+   m_requestPriority = 0;
+   m_pendingThumbnails.clear();
+   m_missingThumbnails.clear();
+   m_contents = items;
+   m_imagePaths = imagePaths;
+
+   endResetModel();
+}
+
+void PlaylistModel::clear()
+{
+   setContents(QVector<QHash<QString, QString> >(), QVector<QString>());
+}
+
+const QHash<QString, QString>& PlaylistModel::hashAt(int row) const
+{
+   return m_contents.at(row);
+}
+
+void PlaylistModel::setThumbnailSize(int size)
+{
+   int bucket = THUMBNAIL_SIZE_MIN;
+
+   /* decode at a few fixed sizes so dragging the zoom slider doesn't
+    * throw away the cache on every step */
+   while (bucket < size && bucket < THUMBNAIL_SIZE_MAX)
+      bucket *= 2;
+
+   if (bucket == m_thumbnailSize)
+      return;
+
+   m_thumbnailSize = bucket;
+
+   if (m_contents.count() > 0)
+      emit dataChanged(index(0, 0), index(m_contents.count() - 1, 0));
+}
+
+void PlaylistModel::reloadThumbnail(int row)
+{
+   QString key;
+   QModelIndex changed;
+
+   if (row < 0 || row >= m_contents.count() || m_imagePaths.at(row).isEmpty())
+      return;
+
+   key = getThumbnailKey(m_imagePaths.at(row));
+
+   QPixmapCache::remove(key);
+   m_missingThumbnails.remove(key);
+
+   changed = index(row, 0);
+   emit dataChanged(changed, changed);
+}
+
+void PlaylistModel::reloadThumbnails(const QString &labelNoExt)
+{
+   int i;
+
+   for (i = 0; i < m_contents.count(); i++)
+   {
+      if (m_contents.at(i).value("label_noext") == labelNoExt)
+         reloadThumbnail(i);
+   }
+}
+
+ThumbnailDelegate::ThumbnailDelegate(QObject *parent) :
+   QStyledItemDelegate(parent)
+   ,m_itemSize(256)
+{
+}
+
+void ThumbnailDelegate::setItemSize(int size)
+{
+   m_itemSize = size;
+}
+
+int ThumbnailDelegate::itemSize() const
+{
+   return m_itemSize;
+}
+
+QSize ThumbnailDelegate::sizeHint(const QStyleOptionViewItem &, const QModelIndex &) const
+{
+   return QSize(m_itemSize, m_itemSize);
+}
+
+void ThumbnailDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+   const QWidget *widget = option.widget;
+   QStyle *style = widget ? widget->style() : QApplication::style();
+   QRect rect = option.rect.adjusted(THUMBNAIL_MARGIN, THUMBNAIL_MARGIN, -THUMBNAIL_MARGIN, -THUMBNAIL_MARGIN);
+   int textHeight = option.fontMetrics.height();
+   QRect textRect(rect.left(), rect.bottom() - textHeight + 1, rect.width(), textHeight);
+   QRect imageRect(rect.left(), rect.top(), rect.width(), rect.height() - textHeight - THUMBNAIL_MARGIN);
+   QPixmap pixmap = qvariant_cast<QPixmap>(index.data(Qt::DecorationRole));
+   QString label = option.fontMetrics.elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, textRect.width());
+
+   style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, widget);
+
+   if (!pixmap.isNull() && imageRect.width() > 0 && imageRect.height() > 0)
+   {
+      QSize size = pixmap.size().scaled(imageRect.size(), Qt::KeepAspectRatio);
+      QRect target(imageRect.left() + (imageRect.width() - size.width()) / 2,
+            imageRect.top() + (imageRect.height() - size.height()) / 2,
+            size.width(), size.height());
+
+      painter->save();
+      painter->setRenderHint(QPainter::SmoothPixmapTransform);
+      painter->drawPixmap(target, pixmap);
+      painter->restore();
+   }
+
+   style->drawItemText(painter, textRect, Qt::AlignCenter, option.palette,
+         (option.state & QStyle::State_Enabled) != 0, label, QPalette::Text);
+}
@@ -0,0 +1,66 @@
+#ifndef GRIDVIEW_H
+#define GRIDVIEW_H
+
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <QThreadPool>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QImage>
+
+/* Playlist entries for the icon view. Thumbnails are decoded on a
+ * private thread pool the first time a row is painted, scaled down to
+ * the current grid size, and kept in the global QPixmapCache so rows
+ * sharing an image and later scrolls reuse the same pixmap. */
+class PlaylistModel : public QAbstractListModel
+{
+   Q_OBJECT
+public:
+   PlaylistModel(QObject *parent = 0);
+   ~PlaylistModel();
+
+   int rowCount(const QModelIndex &parent = QModelIndex()) const;
+   QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+   void setContents(const QVector<QHash<QString, QString> > &items, const QVector<QString> &imagePaths);
+   void clear();
+   const QHash<QString, QString>& hashAt(int row) const;
+   void setThumbnailSize(int size);
+   void reloadThumbnail(int row);
+   void reloadThumbnails(const QString &labelNoExt);
+private slots:
+   void onThumbnailLoaded(int generation, QString key, QImage image);
+private:
+   QString getThumbnailKey(const QString &path) const;
+   void loadThumbnail(int row, const QString &key);
+
+   QVector<QHash<QString, QString> > m_contents;
+   QVector<QString> m_imagePaths;
+   QHash<QString, QVector<int> > m_pendingThumbnails;
+   QSet<QString> m_missingThumbnails;
+   QThreadPool m_threadPool;
+   int m_generation;
+   int m_requestPriority;
+   int m_thumbnailSize;
+};
+
+/* Paints a thumbnail with the elided label below it. Selection and
+ * background come from the style, so QListView::item rules in the
+ * theme stylesheets apply. */
+class ThumbnailDelegate : public QStyledItemDelegate
+{
+   Q_OBJECT
+public:
+   ThumbnailDelegate(QObject *parent = 0);
+
+   void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+   QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+   void setItemSize(int size);
+   int itemSize() const;
+private:
+   int m_itemSize;
+};
+
+#endif
@@ -11,7 +11,7 @@
 #include <QRegularExpression>
 
 #include "../ui_qt.h"
-#include "flowlayout.h"
+#include "gridview.h"
 #include "playlistentrydialog.h"
 
 extern "C" {
@@ -1145,40 +1145,19 @@ finish:
 
 void MainWindow::addPlaylistHashToGrid(const QVector<QHash<QString, QString> > &items)
 {
-   QScreen *screen = qApp->primaryScreen();
-   QSize screenSize = screen->size();
-   QListWidgetItem *currentItem = m_listWidget->currentItem();
+   QVector<QString> imagePaths;
    settings_t *settings = config_get_ptr();
    int i = 0;
-   int zoomValue = m_zoomSlider->value();
 
-   m_gridProgressBar->setMinimum(0);
-   m_gridProgressBar->setMaximum(qMax(0, items.count() - 1));
-   m_gridProgressBar->setValue(0);
+   imagePaths.reserve(items.count());
 
    for (i = 0; i < items.count(); i++)
    {
       const QHash<QString, QString> &hash = items.at(i);
-      QPointer<GridItem> item;
-      QPointer<ThumbnailLabel> label;
       QString thumbnailFileNameNoExt;
-      QLabel *newLabel = NULL;
-      QSize thumbnailWidgetSizeHint(screenSize.width() / 8, screenSize.height() / 8);
       QByteArray extension;
       QString extensionStr;
-      QString imagePath;
-      int lastIndex = -1;
-
-      if (m_listWidget->currentItem() != currentItem)
-      {
-         /* user changed the current playlist before we finished loading... abort */
-         m_gridProgressWidget->hide();
-         break;
-      }
-
-      item = new GridItem();
-
-      lastIndex = hash["path"].lastIndexOf('.');
+      int lastIndex = hash["path"].lastIndexOf('.');
 
       if (lastIndex >= 0)
       {
@@ -1192,63 +1171,21 @@ void MainWindow::addPlaylistHashToGrid(const QVector<QHash<QString, QString> > &
 
       if (!extension.isEmpty() && m_imageFormats.contains(extension))
       {
-         /* use thumbnail widgets to show regular image files */
-         imagePath = hash["path"];
+         /* use thumbnails to show regular image files */
+         imagePaths.append(hash["path"]);
       }
       else
       {
          thumbnailFileNameNoExt = hash["label_noext"];
          thumbnailFileNameNoExt.replace(m_fileSanitizerRegex, "_");
-         imagePath = QString(settings->paths.directory_thumbnails) + "/" + hash.value("db_name") + "/" + THUMBNAIL_BOXART + "/" + thumbnailFileNameNoExt + ".png";
-      }
-
-      item->hash = hash;
-      item->widget = new ThumbnailWidget();
-      item->widget->setSizeHint(thumbnailWidgetSizeHint);
-      item->widget->setFixedSize(item->widget->sizeHint());
-      item->widget->setLayout(new QVBoxLayout());
-      item->widget->setObjectName("thumbnailWidget");
-      item->widget->setProperty("hash", QVariant::fromValue<QHash<QString, QString> >(hash));
-      item->widget->setProperty("image_path", imagePath);
-
-      connect(item->widget, SIGNAL(mouseDoubleClicked()), this, SLOT(onGridItemDoubleClicked()));
-      connect(item->widget, SIGNAL(mousePressed()), this, SLOT(onGridItemClicked()));
-
-      label = new ThumbnailLabel(item->widget);
-      label->setObjectName("thumbnailGridLabel");
-
-      item->label = label;
-      item->labelText = hash.value("label");
-
-      newLabel = new QLabel(item->labelText, item->widget);
-      newLabel->setObjectName("thumbnailQLabel");
-      newLabel->setAlignment(Qt::AlignCenter);
-      newLabel->setToolTip(item->labelText);
-
-      calcGridItemSize(item, zoomValue);
-
-      item->widget->layout()->addWidget(label);
-
-      item->widget->layout()->addWidget(newLabel);
-      qobject_cast<QVBoxLayout*>(item->widget->layout())->setStretchFactor(label, 1);
-
-      m_gridLayout->addWidgetDeferred(item->widget);
-      m_gridItems.append(item);
-
-      loadImageDeferred(item, imagePath);
-
-      if (i % 25 == 0)
-      {
-         /* Needed to update progress dialog while doing a lot of stuff on the main thread. */
-         qApp->processEvents();
+         imagePaths.append(QString(settings->paths.directory_thumbnails) + "/" + hash.value("db_name") + "/" + THUMBNAIL_BOXART + "/" + thumbnailFileNameNoExt + ".png");
       }
-
-      m_gridProgressBar->setValue(i);
    }
 
-   /* If there's only one entry, a min/max/value of all zero would make an indeterminate progress bar that never ends... so just hide it when we are done. */
-   if (m_gridProgressBar->value() == m_gridProgressBar->maximum())
-      m_gridProgressWidget->hide();
+   /* nothing is decoded here, the model loads thumbnails as rows get painted */
+   m_gridModel->setContents(items, imagePaths);
+
+   m_gridProgressWidget->hide();
 }
 
 QVector<QHash<QString, QString> > MainWindow::getPlaylistItems(QString pathString)
@@ -9,10 +9,11 @@ static const QString qt_theme_default_stylesheet = QStringLiteral(R"(
       background-color: transparent;
       border: 1px solid #ddd;
    }
-   ThumbnailWidget#thumbnailWidget, ThumbnailLabel#thumbnailGridLabel, QLabel#thumbnailQLabel {
+   QListView#contentGridView::item {
       background-color:#d4d4d4;
+      border:3px solid transparent;
    }
-   ThumbnailWidget#thumbnailWidgetSelected {
+   QListView#contentGridView::item:selected {
       background-color:#d4d4d4;
       border:3px solid %1;
    }
@@ -422,14 +423,15 @@ static const QString qt_theme_dark_stylesheet = QStringLiteral(R"(
    QSizeGrip {
       background-color:solid;
    }
-   ThumbnailWidget#thumbnailWidget, ThumbnailLabel#thumbnailGridLabel, QLabel#thumbnailQLabel {
+   QWidget#gridLayoutWidget, QListView#contentGridView {
+      background-color:rgb(25,25,25);
+   }
+   QListView#contentGridView::item {
       background-color:rgb(40,40,40);
+      border:3px solid transparent;
    }
-   ThumbnailWidget#thumbnailWidgetSelected {
+   QListView#contentGridView::item:selected {
       background-color:rgb(40,40,40);
       border:3px solid %1;
    }
-   QWidget#gridLayoutWidget {
-      background-color:rgb(25,25,25);
-   }
 )");
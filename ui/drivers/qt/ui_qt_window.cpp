@@ -33,7 +33,7 @@
 #include <QProgressDialog>
 #include <QDragEnterEvent>
 #include <QDropEvent>
-#include <QtConcurrentRun>
+#include <QListView>
 #include <QtNetwork>
 #include <cmath>
 
@@ -41,7 +41,7 @@
 #include "invader_png.h"
 #include "ui_qt_load_core_window.h"
 #include "ui_qt_themes.h"
-#include "flowlayout.h"
+#include "gridview.h"
 #include "shaderparamsdialog.h"
 #include "coreoptionsdialog.h"
 #include "filedropwidget.h"
@@ -152,27 +152,6 @@ static double expScale(double inputValue, double midValue, double maxValue)
    return returnValue;
 }
 
-/* https://gist.github.com/andrey-str/0f9c7709cbf0c9c49ef9 */
-static void setElidedText(QLabel *label, QWidget *clipWidget, int padding, const QString &text)
-{
-   QFontMetrics metrix(label->font());
-   int width = clipWidget->width() - padding;
-   QString clippedText = metrix.elidedText(text, Qt::ElideRight, width);
-   label->setText(clippedText);
-}
-
-GridItem::GridItem() :
-   QObject()
-   ,widget(NULL)
-   ,label(NULL)
-   ,hash()
-   ,image()
-   ,pixmap()
-   ,imageWatcher()
-   ,labelText()
-{
-}
-
 TreeView::TreeView(QWidget *parent) :
    QTreeView(parent)
 {
@@ -315,20 +294,18 @@ MainWindow::MainWindow(QWidget *parent) :
    ,m_historyPlaylistsItem(NULL)
    ,m_folderIcon()
    ,m_customThemeString()
-   ,m_gridLayout(NULL)
    ,m_gridWidget(new QWidget(this))
-   ,m_gridScrollArea(new QScrollArea(m_gridWidget))
-   ,m_gridItems()
    ,m_gridLayoutWidget(new FileDropWidget())
+   ,m_gridView(new QListView(m_gridLayoutWidget))
+   ,m_gridModel(new PlaylistModel(this))
+   ,m_gridDelegate(new ThumbnailDelegate(this))
    ,m_zoomSlider(NULL)
    ,m_lastZoomSliderValue(0)
-   ,m_pendingItemUpdates()
    ,m_viewType(VIEW_TYPE_LIST)
    ,m_gridProgressBar(NULL)
    ,m_gridProgressWidget(NULL)
    ,m_currentGridHash()
    ,m_lastViewType(m_viewType)
-   ,m_currentGridWidget(NULL)
    ,m_allPlaylistsListMaxCount(0)
    ,m_allPlaylistsGridMaxCount(0)
    ,m_playlistEntryDialog(NULL)
@@ -409,15 +386,27 @@ MainWindow::MainWindow(QWidget *parent) :
 
    m_gridWidget->setLayout(new QVBoxLayout());
 
-   m_gridLayout = new FlowLayout(m_gridLayoutWidget);
    m_gridLayoutWidget->setObjectName("gridLayoutWidget");
-
-   m_gridScrollArea->setAlignment(Qt::AlignCenter);
-   m_gridScrollArea->setFrameShape(QFrame::NoFrame);
-   m_gridScrollArea->setWidgetResizable(true);
-   m_gridScrollArea->setWidget(m_gridLayoutWidget);
-
-   m_gridWidget->layout()->addWidget(m_gridScrollArea);
+   m_gridLayoutWidget->setLayout(new QVBoxLayout());
+   m_gridLayoutWidget->layout()->setContentsMargins(0, 0, 0, 0);
+   m_gridLayoutWidget->layout()->addWidget(m_gridView);
+
+   /* one view over a model instead of a widget per entry, so only the
+    * visible rows are laid out, painted and have their thumbnails decoded */
+   m_gridView->setObjectName("contentGridView");
+   m_gridView->setViewMode(QListView::IconMode);
+   m_gridView->setMovement(QListView::Static);
+   m_gridView->setResizeMode(QListView::Adjust);
+   m_gridView->setUniformItemSizes(true);
+   m_gridView->setLayoutMode(QListView::Batched);
+   m_gridView->setSelectionMode(QAbstractItemView::SingleSelection);
+   m_gridView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+   m_gridView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+   m_gridView->setFrameShape(QFrame::NoFrame);
+   m_gridView->setItemDelegate(m_gridDelegate);
+   m_gridView->setModel(m_gridModel);
+
+   m_gridWidget->layout()->addWidget(m_gridLayoutWidget);
    m_gridWidget->layout()->setAlignment(Qt::AlignCenter);
    m_gridWidget->layout()->setContentsMargins(0, 0, 0, 0);
 
@@ -550,6 +539,7 @@ MainWindow::MainWindow(QWidget *parent) :
    m_dirTree->setContextMenuPolicy(Qt::CustomContextMenu);
    m_listWidget->setContextMenuPolicy(Qt::CustomContextMenu);
    m_gridLayoutWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+   m_gridView->setContextMenuPolicy(Qt::CustomContextMenu);
 
    connect(m_searchLineEdit, SIGNAL(returnPressed()), this, SLOT(onSearchEnterPressed()));
    connect(m_searchLineEdit, SIGNAL(textEdited(const QString&)), this, SLOT(onSearchLineEditEdited(const QString&)));
@@ -574,6 +564,9 @@ MainWindow::MainWindow(QWidget *parent) :
    connect(viewTypeListAction, SIGNAL(triggered()), this, SLOT(onListViewClicked()));
    connect(m_gridLayoutWidget, SIGNAL(filesDropped(QStringList)), this, SLOT(onPlaylistFilesDropped(QStringList)));
    connect(m_gridLayoutWidget, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(onFileDropWidgetContextMenuRequested(const QPoint&)));
+   connect(m_gridView, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(onFileDropWidgetContextMenuRequested(const QPoint&)));
+   connect(m_gridView, SIGNAL(doubleClicked(const QModelIndex&)), this, SLOT(onGridItemDoubleClicked(const QModelIndex&)));
+   connect(m_gridView->selectionModel(), SIGNAL(currentChanged(const QModelIndex&, const QModelIndex&)), this, SLOT(onCurrentGridItemChanged(const QModelIndex&, const QModelIndex&)));
    connect(m_dirModel, SIGNAL(directoryLoaded(const QString&)), this, SLOT(onFileSystemDirLoaded(const QString&)));
 
    /* must use queued connection */
@@ -651,8 +644,6 @@ MainWindow::~MainWindow()
       delete m_thumbnailPixmap2;
    if (m_thumbnailPixmap3)
       delete m_thumbnailPixmap3;
-
-   removeGridItems();
 }
 
 void MainWindow::onFileSystemDirLoaded(const QString &path)
@@ -697,19 +688,7 @@ QVector<QPair<QString, QString> > MainWindow::getPlaylists()
 
 void MainWindow::onGridItemChanged(QString title)
 {
-   int i;
-
-   for (i = 0; i < m_gridItems.count(); i++)
-   {
-      const QPointer<GridItem> &item = m_gridItems.at(i);
-      const QHash<QString, QString> &hash = item->hash;
-
-      if (hash.value("label_noext") == title)
-      {
-         loadImageDeferred(item.data(), item->widget->property("image_path").toString());
-         break;
-      }
-   }
+   m_gridModel->reloadThumbnails(title);
 }
 
 void MainWindow::onItemChanged()
@@ -719,20 +698,7 @@ void MainWindow::onItemChanged()
    currentItemChanged(getCurrentContentHash());
 
    if (viewType == VIEW_TYPE_ICONS)
-   {
-      int i;
-
-      for (i = 0; i < m_gridItems.count(); i++)
-      {
-         const QPointer<GridItem> &item = m_gridItems.at(i);
-
-         if (item->widget == m_currentGridWidget)
-         {
-            loadImageDeferred(item.data(), m_currentGridWidget->property("image_path").toString());
-            break;
-         }
-      }
-   }
+      m_gridModel->reloadThumbnail(m_gridView->currentIndex().row());
 }
 
 QString MainWindow::getSpecialPlaylistPath(SpecialPlaylist playlist)
@@ -750,48 +716,22 @@ double MainWindow::lerp(double x, double y, double a, double b, double d) {
   return a + (b - a) * ((double)(d - x) / (double)(y - x));
 }
 
-void MainWindow::onGridItemClicked(ThumbnailWidget *widget)
+void MainWindow::onCurrentGridItemChanged(const QModelIndex &current, const QModelIndex &)
 {
-   QHash<QString, QString> hash;
-   ThumbnailWidget *w = static_cast<ThumbnailWidget*>(sender());
-
-   if (!w)
-   {
-      if (widget)
-         w = widget;
-      else
-         return;
-   }
-
-   if (m_currentGridWidget)
-   {
-      m_currentGridWidget->setObjectName("thumbnailWidget");
-      m_currentGridWidget->style()->unpolish(m_currentGridWidget);
-      m_currentGridWidget->style()->polish(m_currentGridWidget);
-   }
-
-   hash = w->property("hash").value<QHash<QString, QString> >();
-   w->setObjectName("thumbnailWidgetSelected");
-   w->style()->unpolish(w);
-   w->style()->polish(w);
+   if (!current.isValid())
+      return;
 
-   m_currentGridWidget = w;
-   m_currentGridHash = hash;
+   m_currentGridHash = m_gridModel->hashAt(current.row());
 
-   currentItemChanged(hash);
+   currentItemChanged(m_currentGridHash);
 }
 
-void MainWindow::onGridItemDoubleClicked()
+void MainWindow::onGridItemDoubleClicked(const QModelIndex &index)
 {
-   QHash<QString, QString> hash;
-   ThumbnailWidget *w = static_cast<ThumbnailWidget*>(sender());
-
-   if (!w)
+   if (!index.isValid())
       return;
 
-   hash = w->property("hash").value<QHash<QString, QString> >();
-
-   loadContent(hash);
+   loadContent(m_gridModel->hashAt(index.row()));
 }
 
 void MainWindow::onIconViewClicked()
@@ -806,33 +746,20 @@ void MainWindow::onListViewClicked()
    onCurrentListItemChanged(m_listWidget->currentItem(), NULL);
 }
 
-void MainWindow::calcGridItemSize(GridItem *item, int zoomValue)
+void MainWindow::onZoomValueChanged(int value)
 {
    int newSize = 0;
-   QLabel *label = NULL;
 
-   if (zoomValue < 50)
-      newSize = expScale(lerp(0, 49, 25, 49, zoomValue) / 50.0, 102, 256);
+   if (value < 50)
+      newSize = expScale(lerp(0, 49, 25, 49, value) / 50.0, 102, 256);
    else
-      newSize = expScale(zoomValue / 100.0, 256, 1024);
+      newSize = expScale(value / 100.0, 256, 1024);
 
-   item->widget->setFixedSize(QSize(newSize, newSize));
+   m_gridDelegate->setItemSize(newSize);
+   m_gridModel->setThumbnailSize(newSize);
 
-   label = item->widget->findChild<QLabel*>("thumbnailQLabel");
-
-   if (label)
-      setElidedText(label, item->widget, item->widget->layout()->contentsMargins().left() + item->widget->layout()->spacing() + 2, item->labelText);
-}
-
-void MainWindow::onZoomValueChanged(int value)
-{
-   int i;
-
-   for (i = 0; i < m_gridItems.count(); i++)
-   {
-      GridItem *item = m_gridItems.at(i);
-      calcGridItemSize(item, value);
-   }
+   /* the grid size is what makes the view lay the items out again */
+   m_gridView->setGridSize(QSize(newSize + m_gridView->spacing() * 2, newSize + m_gridView->spacing() * 2));
 
    m_lastZoomSliderValue = value;
 }
@@ -1261,7 +1188,7 @@ QVector<QHash<QString, QString> > MainWindow::getCoreInfo()
       }
    }
 
-   if (currentCore["core_path"].isEmpty() || !core_info || !core_info->config_data)
+   if (currentCore["core_path"].isEmpty() || !core_info || !core_info->has_info)
    {
       QHash<QString, QString> hash;
 
@@ -2168,7 +2095,6 @@ void MainWindow::onSearchLineEditEdited(const QString &text)
 {
    int i = 0;
    QList<QTableWidgetItem*> items;
-   QVector<QPointer<GridItem> > gridItems;
    QVector<unsigned> textUnicode = text.toUcs4();
    QVector<unsigned> textHiraToKata;
    QVector<unsigned> textKataToHira;
@@ -2246,57 +2172,24 @@ void MainWindow::onSearchLineEditEdited(const QString &text)
       }
       case VIEW_TYPE_ICONS:
       {
+         QString textHiraToKataString = QString::fromUcs4(textHiraToKata.constData(), textHiraToKata.size());
+         QString textKataToHiraString = QString::fromUcs4(textKataToHira.constData(), textKataToHira.size());
+         int count = m_gridModel->rowCount();
          int i;
 
-         if (text.isEmpty())
+         for (i = 0; i < count; i++)
          {
-            for (i = 0; i < m_gridItems.size(); i++)
-            {
-               m_gridItems.at(i)->widget->show();
-            }
-            return;
-         }
+            const QString &label = m_gridModel->hashAt(i).value("label");
+            bool match = text.isEmpty() || label.contains(text, Qt::CaseInsensitive);
 
-         for (i = 0; i < m_gridItems.count(); i++)
-         {
-            const QPointer<GridItem> &item = m_gridItems.at(i);
-
-            if (item->hash.value("label").contains(text, Qt::CaseInsensitive))
-               gridItems.append(item);
-
-            if (foundHira)
-            {
-               if (item->hash.value("label").contains(QString::fromUcs4(textHiraToKata.constData(), textHiraToKata.size()), Qt::CaseInsensitive))
-                  gridItems.append(item);
-            }
-
-            if (foundKata)
-            {
-               if (item->hash.value("label").contains(QString::fromUcs4(textKataToHira.constData(), textKataToHira.size()), Qt::CaseInsensitive))
-                  gridItems.append(item);
-            }
-         }
+            if (!match && foundHira)
+               match = label.contains(textHiraToKataString, Qt::CaseInsensitive);
 
-         if (gridItems.isEmpty())
-         {
-            for (i = 0; i < m_gridItems.size(); i++)
-            {
-               m_gridItems.at(i)->widget->hide();
-            }
+            if (!match && foundKata)
+               match = label.contains(textKataToHiraString, Qt::CaseInsensitive);
 
-            return;
-         }
-         else
-         {
-            for (i = 0; i < m_gridItems.size(); i++)
-            {
-               const QPointer<GridItem> &item = m_gridItems.at(i);
-
-               if (gridItems.contains(item))
-                  item->widget->show();
-               else
-                  item->widget->hide();
-            }
+            if (m_gridView->isRowHidden(i) == match)
+               m_gridView->setRowHidden(i, !match);
          }
 
          break;
@@ -2676,9 +2569,9 @@ QWidget* MainWindow::contentGridWidget()
    return m_gridWidget;
 }
 
-FlowLayout* MainWindow::contentGridLayout()
+QListView* MainWindow::contentGridView()
 {
-   return m_gridLayout;
+   return m_gridView;
 }
 
 void MainWindow::onBrowserDownloadsClicked()
@@ -2883,106 +2776,6 @@ void MainWindow::onLoadCoreClicked(const QStringList &extensionFilters)
    m_loadCoreWindow->initCoreList(extensionFilters);
 }
 
-void MainWindow::removeGridItems()
-{
-   if (m_gridItems.count() > 0)
-   {
-      QMutableVectorIterator<QPointer<GridItem> > items(m_gridItems);
-
-      m_pendingItemUpdates.clear();
-
-      while (items.hasNext())
-      {
-         QPointer<GridItem> item = items.next();
-
-         if (item)
-         {
-            item->imageWatcher.waitForFinished();
-
-            items.remove();
-
-            m_gridLayout->removeWidget(item->widget);
-
-            delete item->widget;
-            delete item;
-         }
-      }
-   }
-}
-
-void MainWindow::onDeferredImageLoaded()
-{
-   const QFutureWatcher<GridItem*> *watcher = static_cast<QFutureWatcher<GridItem*>*>(sender());
-   GridItem *item = NULL;
-
-   if (!watcher)
-      return;
-
-   item = watcher->result();
-
-   if (!item)
-      return;
-
-   if (m_gridItems.contains(item))
-   {
-      if (!item->image.isNull())
-      {
-         m_pendingItemUpdates.append(item);
-         QTimer::singleShot(0, this, SLOT(onPendingItemUpdates()));
-      }
-   }
-}
-
-void MainWindow::onPendingItemUpdates()
-{
-   QMutableListIterator<GridItem*> list(m_pendingItemUpdates);
-
-   while (list.hasNext())
-   {
-      GridItem *item = list.next();
-
-      if (!item)
-         continue;
-
-      if (m_gridItems.contains(item))
-         onUpdateGridItemPixmapFromImage(item);
-
-      list.remove();
-   }
-}
-
-void MainWindow::onUpdateGridItemPixmapFromImage(GridItem *item)
-{
-   if (!item)
-      return;
-
-   if (!m_gridItems.contains(item))
-      return;
-
-   item->label->setPixmap(QPixmap::fromImage(item->image));
-   item->label->update();
-}
-
-void MainWindow::loadImageDeferred(GridItem *item, QString path)
-{
-   connect(&item->imageWatcher, SIGNAL(finished()), this, SLOT(onDeferredImageLoaded()), Qt::QueuedConnection);
-   item->imageWatcher.setFuture(QtConcurrent::run<GridItem*>(this, &MainWindow::doDeferredImageLoad, item, path));
-}
-
-GridItem* MainWindow::doDeferredImageLoad(GridItem *item, QString path)
-{
-   /* this runs in another thread */
-   if (!item)
-      return NULL;
-
-   /* While we are indeed writing across thread boundaries here, the image is never accessed until after
-    * its thread finishes, and the item is never deleted without first waiting for the thread to finish.
-    */
-   item->image = QImage(path);
-
-   return item;
-}
-
 void MainWindow::initContentGridLayout()
 {
    QListWidgetItem *item = m_listWidget->currentItem();
@@ -2996,19 +2789,10 @@ void MainWindow::initContentGridLayout()
    m_gridProgressBar->setValue(0);
    m_gridProgressWidget->show();
 
-   removeGridItems();
+   m_gridModel->clear();
 
    m_currentGridHash.clear();
 
-   if (m_currentGridWidget)
-   {
-      m_currentGridWidget->setObjectName("thumbnailWidget");
-      m_currentGridWidget->style()->unpolish(m_currentGridWidget);
-      m_currentGridWidget->style()->polish(m_currentGridWidget);
-   }
-
-   m_currentGridWidget = NULL;
-
    path = item->data(Qt::UserRole).toString();
 
    if (path == ALL_PLAYLISTS_TOKEN)
@@ -3034,24 +2818,20 @@ void MainWindow::initContentGridLayout()
 
 void MainWindow::onContentGridInited()
 {
-   ThumbnailWidget *thumbnailWidget = NULL;
-
-   m_gridLayoutWidget->resize(m_gridScrollArea->viewport()->size());
+   int count = m_gridModel->rowCount();
+   int i;
 
    onZoomValueChanged(m_zoomSlider->value());
 
    onSearchEnterPressed();
 
-   if (m_gridItems.count() > 0)
+   for (i = 0; i < count; i++)
    {
-      GridItem *gridItem = m_gridItems.at(0);
-
-      if (gridItem)
+      /* select the first non-hidden entry */
+      if (!m_gridView->isRowHidden(i))
       {
-         thumbnailWidget = m_gridItems.at(0)->widget.data();
-
-         if (thumbnailWidget)
-            onGridItemClicked(thumbnailWidget);
+         m_gridView->setCurrentIndex(m_gridModel->index(i, 0));
+         break;
       }
    }
 }
@@ -3068,15 +2848,6 @@ void MainWindow::initContentTableWidget()
 
    m_currentGridHash.clear();
 
-   if (m_currentGridWidget)
-   {
-      m_currentGridWidget->setObjectName("thumbnailWidget");
-      m_currentGridWidget->style()->unpolish(m_currentGridWidget);
-      m_currentGridWidget->style()->polish(m_currentGridWidget);
-   }
-
-   m_currentGridWidget = NULL;
-
    horizontal_header_labels << msg_hash_to_str(MENU_ENUM_LABEL_VALUE_QT_NAME);
 
    /* block this signal because setData() called in addPlaylistHashToTable() would trigger an infinite loop */
@@ -30,7 +30,6 @@
 #include <QRegularExpression>
 #include <QPalette>
 #include <QPlainTextEdit>
-#include <QFutureWatcher>
 #include <QPixmap>
 #include <QImage>
 #include <QPointer>
@@ -80,37 +79,24 @@ class QDropEvent;
 class QNetworkAccessManager;
 class QNetworkReply;
 class QProgressDialog;
+class QListView;
 class LoadCoreWindow;
 class MainWindow;
 class ThumbnailWidget;
 class ThumbnailLabel;
-class FlowLayout;
 class ShaderParamsDialog;
 class CoreOptionsDialog;
 class CoreInfoDialog;
 class PlaylistEntryDialog;
 class ViewOptionsDialog;
+class PlaylistModel;
+class ThumbnailDelegate;
 
 enum SpecialPlaylist
 {
    SPECIAL_PLAYLIST_HISTORY
 };
 
-class GridItem : public QObject
-{
-   Q_OBJECT
-public:
-   GridItem();
-
-   QPointer<ThumbnailWidget> widget;
-   QPointer<ThumbnailLabel> label;
-   QHash<QString, QString> hash;
-   QImage image;
-   QPixmap pixmap;
-   QFutureWatcher<GridItem*> imageWatcher;
-   QString labelText;
-};
-
 class ThumbnailWidget : public QFrame
 {
    Q_OBJECT
@@ -265,7 +251,7 @@ public:
    TreeView* dirTreeView();
    ListWidget* playlistListWidget();
    TableWidget* contentTableWidget();
-   FlowLayout* contentGridLayout();
+   QListView* contentGridView();
    QWidget* contentGridWidget();
    QWidget* searchWidget();
    QLineEdit* searchLineEdit();
@@ -289,7 +275,6 @@ public:
    bool setCustomThemeFile(QString filePath);
    void setCustomThemeString(QString qss);
    const QString& customThemeString() const;
-   GridItem* doDeferredImageLoad(GridItem *item, QString path);
    void setCurrentViewType(ViewType viewType);
    QString getCurrentViewTypeString();
    ViewType getCurrentViewType();
@@ -390,13 +375,10 @@ private slots:
    void onFileBrowserTreeContextMenuRequested(const QPoint &pos);
    void onPlaylistWidgetContextMenuRequested(const QPoint &pos);
    void onStopClicked();
-   void onDeferredImageLoaded();
    void onZoomValueChanged(int value);
    void onContentGridInited();
-   void onUpdateGridItemPixmapFromImage(GridItem *item);
-   void onPendingItemUpdates();
-   void onGridItemDoubleClicked();
-   void onGridItemClicked(ThumbnailWidget *thumbnailWidget = NULL);
+   void onCurrentGridItemChanged(const QModelIndex &current, const QModelIndex &previous);
+   void onGridItemDoubleClicked(const QModelIndex &index);
    void onPlaylistFilesDropped(QStringList files);
    void onShaderParamsClicked();
    void onCoreOptionsClicked();
@@ -444,9 +426,6 @@ private:
    void getPlaylistFiles();
    bool isCoreLoaded();
    bool isContentLessCore();
-   void removeGridItems();
-   void loadImageDeferred(GridItem *item, QString path);
-   void calcGridItemSize(GridItem *item, int zoomValue);
    bool updateCurrentPlaylistEntry(const QHash<QString, QString> &contentHash);
    int extractArchive(QString path);
    void removeUpdateTempFiles();
@@ -496,20 +475,18 @@ private:
    QListWidgetItem *m_historyPlaylistsItem;
    QIcon m_folderIcon;
    QString m_customThemeString;
-   FlowLayout *m_gridLayout;
    QWidget *m_gridWidget;
-   QScrollArea *m_gridScrollArea;
-   QVector<QPointer<GridItem> > m_gridItems;
    QWidget *m_gridLayoutWidget;
+   QListView *m_gridView;
+   PlaylistModel *m_gridModel;
+   ThumbnailDelegate *m_gridDelegate;
    QSlider *m_zoomSlider;
    int m_lastZoomSliderValue;
-   QList<GridItem*> m_pendingItemUpdates;
    ViewType m_viewType;
    QProgressBar *m_gridProgressBar;
    QWidget *m_gridProgressWidget;
    QHash<QString, QString> m_currentGridHash;
    ViewType m_lastViewType;
-   QPointer<ThumbnailWidget> m_currentGridWidget;
    int m_allPlaylistsListMaxCount;
    int m_allPlaylistsGridMaxCount;
    PlaylistEntryDialog *m_playlistEntryDialog;
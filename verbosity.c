@@ -28,6 +28,8 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef _MSC_VER
 #include <compat/msvc.h>
@@ -40,11 +42,79 @@
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 #include <compat/fopen_utf8.h>
+#include <compat/strl.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Everything but the platform loggers (ASL, OutputDebugString,
+ * logcat) goes through stdio and the sinks. */
+#if !defined(HAVE_LOGGER) && !TARGET_OS_IPHONE && !defined(_XBOX1) && !defined(ANDROID)
+#define HAVE_VERBOSITY_STDIO
+#endif
+
+/* The stdio path hands its lines to a log thread instead of
+ * writing them out on the caller's time. */
+#if defined(HAVE_VERBOSITY_STDIO) && defined(HAVE_THREADS) && !defined(IS_SALAMANDER) \
+   && (defined(__GNUC__) || defined(_MSC_VER))
+#define HAVE_VERBOSITY_ASYNC
+#endif
+
+#ifdef HAVE_VERBOSITY_ASYNC
+#if defined(__GNUC__) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define VERBOSITY_LOAD(ptr)       __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define VERBOSITY_STORE(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#elif defined(__GNUC__)
+static unsigned verbosity_load(volatile unsigned *ptr)
+{
+   unsigned val = *ptr;
+   __sync_synchronize();
+   return val;
+}
+#define VERBOSITY_LOAD(ptr)       verbosity_load(ptr)
+#define VERBOSITY_STORE(ptr, val) do { __sync_synchronize(); *(ptr) = (val); } while (0)
+#endif
+
+#if defined(__GNUC__)
+#define VERBOSITY_CAS(ptr, old, val) __sync_val_compare_and_swap(ptr, old, val)
+#define VERBOSITY_INC(ptr)           __sync_fetch_and_add(ptr, 1)
+#define VERBOSITY_XCHG(ptr, val)     __sync_lock_test_and_set(ptr, val)
+#else
+#include <windows.h>
+static unsigned verbosity_load(volatile unsigned *ptr)
+{
+   unsigned val = *ptr;
+   MemoryBarrier();
+   return val;
+}
+#define VERBOSITY_LOAD(ptr)       verbosity_load(ptr)
+#define VERBOSITY_STORE(ptr, val) do { MemoryBarrier(); *(ptr) = (val); } while (0)
+#define VERBOSITY_CAS(ptr, old, val) (unsigned)InterlockedCompareExchange( \
+      (volatile LONG*)(ptr), (LONG)(val), (LONG)(old))
+#define VERBOSITY_INC(ptr)           InterlockedIncrement((volatile LONG*)(ptr))
+#define VERBOSITY_XCHG(ptr, val)     (unsigned)InterlockedExchange( \
+      (volatile LONG*)(ptr), (LONG)(val))
+#endif
+
+#if !defined(va_copy) && defined(__va_copy)
+#define va_copy __va_copy
+#endif
+
+/* Power of two. Lines longer than the slot get a heap copy. */
+#define VERBOSITY_RING_SLOTS 256
+#define VERBOSITY_SLOT_MSG   480
+#define VERBOSITY_SLOT_TAG   32
+/* How long the log thread sleeps between looks at the ring;
+ * errors wake it straight away. */
+#define VERBOSITY_DRAIN_USEC 10000
+#endif
+
 #ifdef RARCH_INTERNAL
 #include "frontend/frontend_driver.h"
 #endif
@@ -68,6 +138,48 @@ static Mutex nxlink_mtx;
 bool nxlink_connected = false;
 #endif
 
+#define VERBOSITY_MAX_SINKS 4
+
+typedef struct
+{
+   verbosity_sink_t sink;
+   void *userdata;
+} verbosity_sink_entry_t;
+
+static verbosity_sink_entry_t verbosity_sinks[VERBOSITY_MAX_SINKS];
+static unsigned verbosity_sink_count = 0;
+
+#ifdef HAVE_VERBOSITY_ASYNC
+/* Bounded multi-producer ring (per-slot sequence numbers). A slot
+ * whose seq equals the claiming position is free; a producer claims
+ * it by moving head on, and publishes it by storing pos + 1. The
+ * log thread takes it back by storing pos + VERBOSITY_RING_SLOTS.
+ * Consumers are serialised by verbosity_async_lock. */
+typedef struct
+{
+   volatile unsigned seq;
+   enum verbosity_level level;
+   int64_t time_usec;
+   uintptr_t thread_id;
+   char *long_msg;
+   char tag[VERBOSITY_SLOT_TAG];
+   char msg[VERBOSITY_SLOT_MSG];
+} verbosity_slot_t;
+
+/* Static so a producer racing verbosity_async_stop never
+ * writes into freed memory; it only loses its line. */
+static verbosity_slot_t verbosity_ring[VERBOSITY_RING_SLOTS];
+static volatile unsigned verbosity_ring_head  = 0;
+static unsigned verbosity_ring_tail           = 0;
+static volatile unsigned verbosity_ring_dropped = 0;
+static bool verbosity_ring_inited             = false;
+
+static sthread_t *verbosity_async_thread      = NULL;
+static slock_t *verbosity_async_lock          = NULL;
+static scond_t *verbosity_async_cond          = NULL;
+static volatile bool verbosity_async_running  = false;
+#endif
+
 void verbosity_enable(void)
 {
    main_verbosity = true;
@@ -101,6 +213,339 @@ void *retro_main_log_file(void)
    return log_file_fp;
 }
 
+#ifdef HAVE_VERBOSITY_STDIO
+static FILE *verbosity_log_fp(void)
+{
+#ifdef HAVE_FILE_LOGGER
+   return (FILE*)retro_main_log_file();
+#else
+   return stderr;
+#endif
+}
+
+static int64_t verbosity_time_usec(void)
+{
+#ifdef IS_SALAMANDER
+   return 0;
+#else
+   return cpu_features_get_time_usec();
+#endif
+}
+
+static enum verbosity_level verbosity_tag_level(const char *tag)
+{
+   if (strstr(tag, "ERR"))
+      return VERBOSITY_LEVEL_ERROR;
+   if (strstr(tag, "WARN"))
+      return VERBOSITY_LEVEL_WARN;
+   if (strstr(tag, "DEBUG"))
+      return VERBOSITY_LEVEL_DEBUG;
+   return VERBOSITY_LEVEL_INFO;
+}
+
+/* Writes one line to the log file and the sinks. The caller
+ * flushes. */
+static void verbosity_emit(const verbosity_entry_t *entry)
+{
+   unsigned i;
+   FILE *fp = verbosity_log_fp();
+
+#if defined(NXLINK) && !defined(HAVE_FILE_LOGGER)
+   if (nxlink_connected)
+      mutexLock(&nxlink_mtx);
+#endif
+   if (fp)
+      fprintf(fp, "%s %s", entry->tag, entry->msg);
+#if defined(NXLINK) && !defined(HAVE_FILE_LOGGER)
+   if (nxlink_connected)
+      mutexUnlock(&nxlink_mtx);
+#endif
+
+#ifdef HAVE_QT
+   ui_companion_driver_log_msg(entry->msg);
+#endif
+
+   for (i = 0; i < verbosity_sink_count; i++)
+      verbosity_sinks[i].sink(entry, verbosity_sinks[i].userdata);
+}
+#endif
+
+#ifdef HAVE_VERBOSITY_ASYNC
+static verbosity_slot_t *verbosity_ring_claim(unsigned *claimed)
+{
+   unsigned pos = VERBOSITY_LOAD(&verbosity_ring_head);
+
+   for (;;)
+   {
+      verbosity_slot_t *slot =
+         &verbosity_ring[pos & (VERBOSITY_RING_SLOTS - 1)];
+      int diff = (int)(VERBOSITY_LOAD(&slot->seq) - pos);
+
+      if (diff == 0)
+      {
+         unsigned seen = VERBOSITY_CAS(&verbosity_ring_head, pos, pos + 1);
+         if (seen == pos)
+         {
+            *claimed = pos;
+            return slot;
+         }
+         pos = seen;
+      }
+      /* Still holds a line from the previous lap: full. */
+      else if (diff < 0)
+         return NULL;
+      else
+         pos = VERBOSITY_LOAD(&verbosity_ring_head);
+   }
+}
+
+/* Needs verbosity_async_lock. Stops at the first slot that
+ * isn't published yet, so lines come out in claim order. */
+static void verbosity_async_drain(void)
+{
+   unsigned dropped;
+   bool wrote = false;
+
+   for (;;)
+   {
+      verbosity_entry_t entry;
+      verbosity_slot_t *slot = &verbosity_ring[
+         verbosity_ring_tail & (VERBOSITY_RING_SLOTS - 1)];
+
+      if (VERBOSITY_LOAD(&slot->seq) != verbosity_ring_tail + 1)
+         break;
+
+      entry.time_usec = slot->time_usec;
+      entry.thread_id = slot->thread_id;
+      entry.tag       = slot->tag;
+      entry.msg       = slot->long_msg ? slot->long_msg : slot->msg;
+      entry.level     = slot->level;
+      verbosity_emit(&entry);
+
+      free(slot->long_msg);
+      slot->long_msg  = NULL;
+
+      VERBOSITY_STORE(&slot->seq,
+            verbosity_ring_tail + VERBOSITY_RING_SLOTS);
+      verbosity_ring_tail++;
+      wrote = true;
+   }
+
+   dropped = VERBOSITY_XCHG(&verbosity_ring_dropped, 0);
+   if (dropped)
+   {
+      char msg[64];
+      verbosity_entry_t entry;
+
+      snprintf(msg, sizeof(msg), "%u log lines dropped.\n", dropped);
+      entry.time_usec = verbosity_time_usec();
+      entry.thread_id = sthread_get_current_thread_id();
+      entry.tag       = file_path_str(FILE_PATH_LOG_WARN);
+      entry.msg       = msg;
+      entry.level     = VERBOSITY_LEVEL_WARN;
+      verbosity_emit(&entry);
+      wrote = true;
+   }
+
+   if (wrote && verbosity_log_fp())
+      fflush(verbosity_log_fp());
+}
+
+static bool verbosity_async_push(const char *tag,
+      const char *fmt, va_list ap)
+{
+   int len;
+   unsigned pos;
+   enum verbosity_level level = verbosity_tag_level(tag);
+#ifdef va_copy
+   va_list ap_copy;
+#endif
+   verbosity_slot_t *slot = verbosity_ring_claim(&pos);
+
+   if (!slot)
+   {
+      /* The log thread fell behind; do its work rather than
+       * lose the line. */
+      slock_lock(verbosity_async_lock);
+      verbosity_async_drain();
+      slock_unlock(verbosity_async_lock);
+
+      if (!(slot = verbosity_ring_claim(&pos)))
+      {
+         VERBOSITY_INC(&verbosity_ring_dropped);
+         return true;
+      }
+   }
+
+   slot->level     = level;
+   slot->time_usec = verbosity_time_usec();
+   slot->thread_id = sthread_get_current_thread_id();
+   slot->long_msg  = NULL;
+   strlcpy(slot->tag, tag, sizeof(slot->tag));
+
+#ifdef va_copy
+   va_copy(ap_copy, ap);
+#endif
+   len = vsnprintf(slot->msg, sizeof(slot->msg), fmt, ap);
+   slot->msg[sizeof(slot->msg) - 1] = '\0';
+#ifdef va_copy
+   if (len >= (int)sizeof(slot->msg))
+   {
+      slot->long_msg = (char*)malloc(len + 1);
+      if (slot->long_msg)
+         vsnprintf(slot->long_msg, len + 1, fmt, ap_copy);
+   }
+   va_end(ap_copy);
+#endif
+
+   VERBOSITY_STORE(&slot->seq, pos + 1);
+
+   /* The slot may already be reused from here on. An error may be
+    * the last thing we get to say, so don't let it wait. */
+   if (level == VERBOSITY_LEVEL_ERROR)
+      scond_signal(verbosity_async_cond);
+   return true;
+}
+
+static void verbosity_async_loop(void *data)
+{
+   slock_lock(verbosity_async_lock);
+   while (verbosity_async_running)
+   {
+      verbosity_async_drain();
+      scond_wait_timeout(verbosity_async_cond,
+            verbosity_async_lock, VERBOSITY_DRAIN_USEC);
+   }
+   verbosity_async_drain();
+   slock_unlock(verbosity_async_lock);
+}
+
+/* The lock and condition outlive the thread, since a producer
+ * may still be about to signal when it is stopped. */
+static void verbosity_async_start(void)
+{
+   if (verbosity_async_thread)
+      return;
+
+   if (!verbosity_ring_inited)
+   {
+      unsigned i;
+      for (i = 0; i < VERBOSITY_RING_SLOTS; i++)
+         verbosity_ring[i].seq = i;
+      verbosity_ring_inited = true;
+   }
+
+   if (!verbosity_async_lock)
+      verbosity_async_lock = slock_new();
+   if (!verbosity_async_cond)
+      verbosity_async_cond = scond_new();
+   if (!verbosity_async_lock || !verbosity_async_cond)
+      return;
+
+   verbosity_async_running = true;
+   verbosity_async_thread  = sthread_create(verbosity_async_loop, NULL);
+   if (!verbosity_async_thread)
+      verbosity_async_running = false;
+}
+
+static void verbosity_async_stop(void)
+{
+   if (!verbosity_async_thread)
+      return;
+
+   slock_lock(verbosity_async_lock);
+   verbosity_async_running = false;
+   scond_signal(verbosity_async_cond);
+   slock_unlock(verbosity_async_lock);
+
+   sthread_join(verbosity_async_thread);
+   verbosity_async_thread = NULL;
+}
+#endif
+
+void verbosity_flush(void)
+{
+#ifdef HAVE_VERBOSITY_ASYNC
+   if (!verbosity_async_lock)
+      return;
+   slock_lock(verbosity_async_lock);
+   verbosity_async_drain();
+   slock_unlock(verbosity_async_lock);
+#endif
+}
+
+bool verbosity_sink_add(verbosity_sink_t sink, void *userdata)
+{
+   bool ret = false;
+
+#ifdef HAVE_VERBOSITY_ASYNC
+   if (verbosity_async_lock)
+      slock_lock(verbosity_async_lock);
+#endif
+   if (verbosity_sink_count < VERBOSITY_MAX_SINKS)
+   {
+      verbosity_sinks[verbosity_sink_count].sink     = sink;
+      verbosity_sinks[verbosity_sink_count].userdata = userdata;
+      verbosity_sink_count++;
+      ret = true;
+   }
+#ifdef HAVE_VERBOSITY_ASYNC
+   if (verbosity_async_lock)
+      slock_unlock(verbosity_async_lock);
+#endif
+
+   return ret;
+}
+
+void verbosity_sink_remove(verbosity_sink_t sink, void *userdata)
+{
+   unsigned i;
+
+#ifdef HAVE_VERBOSITY_ASYNC
+   if (verbosity_async_lock)
+      slock_lock(verbosity_async_lock);
+#endif
+   for (i = 0; i < verbosity_sink_count; i++)
+   {
+      if (     verbosity_sinks[i].sink     == sink
+            && verbosity_sinks[i].userdata == userdata)
+      {
+         verbosity_sinks[i] = verbosity_sinks[--verbosity_sink_count];
+         break;
+      }
+   }
+#ifdef HAVE_VERBOSITY_ASYNC
+   if (verbosity_async_lock)
+      slock_unlock(verbosity_async_lock);
+#endif
+}
+
+#ifndef IS_SALAMANDER
+bool verbosity_ratelimit(verbosity_ratelimit_t *rl,
+      int64_t interval_usec, unsigned burst)
+{
+   int64_t now = cpu_features_get_time_usec();
+
+   if (!rl->start || now - rl->start >= interval_usec)
+   {
+      if (rl->suppressed)
+         RARCH_WARN("%u similar messages suppressed.\n", rl->suppressed);
+      rl->start      = now;
+      rl->count      = 0;
+      rl->suppressed = 0;
+   }
+
+   if (rl->count < burst)
+   {
+      rl->count++;
+      return true;
+   }
+
+   rl->suppressed++;
+   return false;
+}
+#endif
+
 void retro_main_log_file_init(const char *path)
 {
    if (log_file_initialized)
@@ -112,19 +557,26 @@ void retro_main_log_file_init(const char *path)
 #endif
 
    log_file_fp          = stderr;
-   if (path == NULL)
-      return;
+   if (path)
+   {
+      log_file_fp          = (FILE*)fopen_utf8(path, "wb");
+      log_file_initialized = true;
 
-   log_file_fp          = (FILE*)fopen_utf8(path, "wb");
-   log_file_initialized = true;
+      /* TODO: this is only useful for a few platforms, find which and add ifdef */
+      log_file_buf = calloc(1, 0x4000);
+      setvbuf(log_file_fp, (char*)log_file_buf, _IOFBF, 0x4000);
+   }
 
-   /* TODO: this is only useful for a few platforms, find which and add ifdef */
-   log_file_buf = calloc(1, 0x4000);
-   setvbuf(log_file_fp, (char*)log_file_buf, _IOFBF, 0x4000);
+#ifdef HAVE_VERBOSITY_ASYNC
+   verbosity_async_start();
+#endif
 }
 
 void retro_main_log_file_deinit(void)
 {
+#ifdef HAVE_VERBOSITY_ASYNC
+   verbosity_async_stop();
+#endif
    if (log_file_fp && log_file_fp != stderr)
    {
       fclose(log_file_fp);
@@ -189,46 +641,59 @@ void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap)
             ap);
    }
 #else
-
    {
-#ifdef HAVE_QT
-      char buffer[1024];
-#endif
-#ifdef HAVE_FILE_LOGGER
-      FILE *fp = (FILE*)retro_main_log_file();
-#else
-      FILE *fp = stderr;
-#endif
+      FILE *fp = verbosity_log_fp();
 
-#ifdef HAVE_QT
-      buffer[0] = '\0';
-      vsnprintf(buffer, sizeof(buffer), fmt, ap);
+      if (!tag)
+         tag = file_path_str(FILE_PATH_LOG_INFO);
 
-      if (fp)
-      {
-         fprintf(fp, "%s %s", tag ? tag : file_path_str(FILE_PATH_LOG_INFO), buffer);
-         fflush(fp);
-      }
+#ifdef HAVE_VERBOSITY_ASYNC
+      if (verbosity_async_running && verbosity_async_push(tag, fmt, ap))
+         return;
+#endif
 
-      ui_companion_driver_log_msg(buffer);
-#else
+#ifndef HAVE_QT
+      if (!verbosity_sink_count)
+      {
 #if defined(NXLINK) && !defined(HAVE_FILE_LOGGER)
-          if (nxlink_connected)
-             mutexLock(&nxlink_mtx);
+         if (nxlink_connected)
+            mutexLock(&nxlink_mtx);
 #endif
-      if (fp)
-      {
-         fprintf(fp, "%s ",
-               tag ? tag : file_path_str(FILE_PATH_LOG_INFO));
-         vfprintf(fp, fmt, ap);
-         fflush(fp);
-      }
+         if (fp)
+         {
+            fprintf(fp, "%s ", tag);
+            vfprintf(fp, fmt, ap);
+            fflush(fp);
+         }
 #if defined(NXLINK) && !defined(HAVE_FILE_LOGGER)
-      if (nxlink_connected)
-         mutexUnlock(&nxlink_mtx);
+         if (nxlink_connected)
+            mutexUnlock(&nxlink_mtx);
 #endif
+         return;
+      }
+#endif
+
+      {
+         char buffer[1024];
+         verbosity_entry_t entry;
+
+         buffer[0]       = '\0';
+         vsnprintf(buffer, sizeof(buffer), fmt, ap);
 
+         entry.time_usec = verbosity_time_usec();
+#ifdef HAVE_THREADS
+         entry.thread_id = sthread_get_current_thread_id();
+#else
+         entry.thread_id = 0;
 #endif
+         entry.tag       = tag;
+         entry.msg       = buffer;
+         entry.level     = verbosity_tag_level(tag);
+         verbosity_emit(&entry);
+
+         if (fp)
+            fflush(fp);
+      }
    }
 #endif
 }
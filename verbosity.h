@@ -17,6 +17,7 @@
 #define __RARCH_VERBOSITY_H
 
 #include <stdarg.h>
+#include <stdint.h>
 
 #include <boolean.h>
 #include <retro_common_api.h>
@@ -41,12 +42,75 @@ void retro_main_log_file_deinit(void);
 
 void retro_main_log_file_init(const char *path);
 
+enum verbosity_level
+{
+   VERBOSITY_LEVEL_DEBUG = 0,
+   VERBOSITY_LEVEL_INFO,
+   VERBOSITY_LEVEL_WARN,
+   VERBOSITY_LEVEL_ERROR
+};
+
+/* One formatted log line, as handed to the sinks. */
+typedef struct verbosity_entry
+{
+   int64_t time_usec;
+   uintptr_t thread_id;
+   const char *tag;
+   const char *msg;
+   enum verbosity_level level;
+} verbosity_entry_t;
+
+typedef void (*verbosity_sink_t)(const verbosity_entry_t *entry,
+      void *userdata);
+
+/* Sinks get every line after it has been written to the log file.
+ * With the log thread running they are called from it, so they
+ * must not log themselves. */
+bool verbosity_sink_add(verbosity_sink_t sink, void *userdata);
+
+void verbosity_sink_remove(verbosity_sink_t sink, void *userdata);
+
+/* Writes out whatever the log thread hasn't got to yet. */
+void verbosity_flush(void);
+
+typedef struct verbosity_ratelimit
+{
+   int64_t start;
+   unsigned count;
+   unsigned suppressed;
+} verbosity_ratelimit_t;
+
+/* Returns true while fewer than @burst messages went through @rl
+ * in the current @interval_usec window. */
+bool verbosity_ratelimit(verbosity_ratelimit_t *rl,
+      int64_t interval_usec, unsigned burst);
+
+/* For call sites that can fire every frame: lets @burst messages
+ * through per @interval_usec, then says how many were eaten. */
+#ifdef IS_SALAMANDER
+#define RARCH_RATELIMITED(log, interval_usec, burst, ...) log(__VA_ARGS__)
+#else
+#define RARCH_RATELIMITED(log, interval_usec, burst, ...) do { \
+   static verbosity_ratelimit_t verbosity_rl_; \
+   if (verbosity_ratelimit(&verbosity_rl_, interval_usec, burst)) \
+      log(__VA_ARGS__); \
+} while (0)
+#endif
+
+#define RARCH_LOG_RATELIMITED(interval_usec, burst, ...) \
+   RARCH_RATELIMITED(RARCH_LOG, interval_usec, burst, __VA_ARGS__)
+#define RARCH_WARN_RATELIMITED(interval_usec, burst, ...) \
+   RARCH_RATELIMITED(RARCH_WARN, interval_usec, burst, __VA_ARGS__)
+#define RARCH_ERR_RATELIMITED(interval_usec, burst, ...) \
+   RARCH_RATELIMITED(RARCH_ERR, interval_usec, burst, __VA_ARGS__)
+
 #if defined(HAVE_LOGGER)
 
 void logger_init (void);
 void logger_shutdown (void);
 void logger_send (const char *__format,...);
 void logger_send_v(const char *__format, va_list args);
+void logger_send_entry(const verbosity_entry_t *entry, void *userdata);
 
 #ifdef IS_SALAMANDER
 